@@ -48,6 +48,7 @@
 #include <gst/gstdeviceprovider.h>
 #include <gst/gstelement.h>
 #include <gst/gstelementmetadata.h>
+#include <gst/gstelementpool.h>
 #include <gst/gsterror.h>
 #include <gst/gstevent.h>
 #include <gst/gstghostpad.h>
@@ -55,6 +56,7 @@
 #include <gst/gstiterator.h>
 #include <gst/gstmessage.h>
 #include <gst/gstmemory.h>
+#include <gst/gstmemorybudget.h>
 #include <gst/gstmeta.h>
 #include <gst/gstminiobject.h>
 #include <gst/gstobject.h>
@@ -110,6 +112,9 @@ void            gst_segtrap_set_enabled         (gboolean enabled);
 gboolean        gst_registry_fork_is_enabled    (void);
 void            gst_registry_fork_set_enabled   (gboolean enabled);
 
+void            gst_registry_set_builtin_cache  (const guint8 * data, gsize size);
+void            gst_registry_set_feature_filter (const gchar * filter);
+
 gboolean        gst_update_registry             (void);
 
 G_END_DECLS
@@ -54,6 +54,9 @@ extern const char             g_log_domain_gstreamer[];
 /* for GstElement */
 #include "gstelement.h"
 
+/* for GstURIType */
+#include "gsturi.h"
+
 /* for GstDeviceProvider */
 #include "gstdeviceprovider.h"
 
@@ -64,6 +67,9 @@ extern const char             g_log_domain_gstreamer[];
 
 #include "gsttracerutils.h"
 
+/* static probe points */
+#include "gstsdt.h"
+
 G_BEGIN_DECLS
 
 /* used by gstparse.c and grammar.y */
@@ -108,10 +114,16 @@ G_GNUC_INTERNAL  void  _priv_gst_quarks_initialize (void);
 G_GNUC_INTERNAL  void  _priv_gst_mini_object_initialize (void);
 G_GNUC_INTERNAL  void  _priv_gst_memory_initialize (void);
 G_GNUC_INTERNAL  void  _priv_gst_allocator_initialize (void);
+
+/* the system memory allocator, it is never freed so the memory it
+ * allocates doesn't hold a ref to it */
+G_GNUC_INTERNAL  extern GstAllocator *_priv_gst_sysmem_allocator;
 G_GNUC_INTERNAL  void  _priv_gst_buffer_initialize (void);
 G_GNUC_INTERNAL  void  _priv_gst_buffer_list_initialize (void);
 G_GNUC_INTERNAL  void  _priv_gst_structure_initialize (void);
 G_GNUC_INTERNAL  void  _priv_gst_caps_initialize (void);
+G_GNUC_INTERNAL  void  _priv_gst_caps_cleanup (void);
+G_GNUC_INTERNAL  void  _priv_gst_caps_set_immutable (GstCaps * caps);
 G_GNUC_INTERNAL  void  _priv_gst_caps_features_initialize (void);
 G_GNUC_INTERNAL  void  _priv_gst_event_initialize (void);
 G_GNUC_INTERNAL  void  _priv_gst_format_initialize (void);
@@ -127,6 +139,11 @@ G_GNUC_INTERNAL  void  _priv_gst_context_initialize (void);
 G_GNUC_INTERNAL  void  _priv_gst_toc_initialize (void);
 G_GNUC_INTERNAL  void  _priv_gst_date_time_initialize (void);
 
+/* the core enum and flags types are registered lazily, use this instead of
+ * g_type_from_name() for type names coming from serialized data */
+G_GNUC_INTERNAL  void  _priv_gst_core_types_ensure (void);
+G_GNUC_INTERNAL  GType _priv_gst_type_from_name (const gchar * type_name);
+
 /* Private registry functions */
 G_GNUC_INTERNAL
 gboolean _priv_gst_registry_remove_cache_plugins (GstRegistry *registry);
@@ -143,6 +160,20 @@ G_GNUC_INTERNAL  GstPlugin * _priv_gst_plugin_load_file_for_registry (const gcha
 G_GNUC_INTERNAL  void _priv_gst_element_state_changed (GstElement *element,
                       GstState oldstate, GstState newstate, GstState pending);
 
+/* Used in GstElement to check if a parent bin needs messages of a type
+ * that nobody else wants */
+G_GNUC_INTERNAL  gboolean _priv_gst_bin_handles_message (struct _GstBin * bin,
+                      GstMessageType type);
+
+/* Used in GstElement to post messages of children directly on the bus of a
+ * bin that would only forward them */
+G_GNUC_INTERNAL  gboolean _priv_gst_bin_forwards_message (struct _GstBin * bin,
+                      GstMessageType type);
+
+/* Used in GstObject to skip syncing controlled properties while their
+ * values don't change, bumped in gstcontrolsource.c */
+G_GNUC_INTERNAL extern volatile gint _priv_gst_control_cookie;
+
 /* used in both gststructure.c and gstcaps.c; numbers are completely made up */
 #define STRUCTURE_ESTIMATED_STRING_LEN(s) (16 + gst_structure_n_fields(s) * 22)
 #define FEATURES_ESTIMATED_STRING_LEN(s) (16 + gst_caps_features_get_size(s) * 14)
@@ -151,6 +182,13 @@ G_GNUC_INTERNAL
 gboolean  priv_gst_structure_append_to_gstring (const GstStructure * structure,
                                                 GString            * s);
 G_GNUC_INTERNAL
+void      priv_gst_structure_append_to_gstring_cached (const GstStructure * structure,
+                                                       GString            * s);
+G_GNUC_INTERNAL
+gchar *   priv_gst_structure_to_string_cached (const GstStructure * structure);
+G_GNUC_INTERNAL
+gchar *   priv_gst_caps_to_string_cached (const GstCaps * caps);
+G_GNUC_INTERNAL
 gboolean priv__gst_structure_append_template_to_gstring (GQuark field_id,
                                                         const GValue *value,
                                                         gpointer user_data);
@@ -163,6 +201,16 @@ gboolean priv_gst_structure_parse_name (gchar * str, gchar **start, gchar ** end
 G_GNUC_INTERNAL
 gboolean priv_gst_structure_parse_fields (gchar *str, gchar ** end, GstStructure *structure);
 
+/* set on G_TYPE_STRING values with G_VALUE_NOCOPY_CONTENTS that hold an
+ * interned string, which copies share. Newer GLib versions use the same bit
+ * for G_VALUE_INTERNED_STRING */
+#define GST_VALUE_INTERNED_STRING (1 << 28)
+
+G_GNUC_INTERNAL
+void     priv_gst_value_intern_strings (GValue * value);
+G_GNUC_INTERNAL
+void     priv_gst_structure_intern_strings (GstStructure * structure);
+
 /* used in gstvalue.c and gststructure.c */
 
 #define GST_WRAPPED_PTR_FORMAT     "p\aa"
@@ -174,9 +222,30 @@ gchar *priv_gst_string_take_and_wrap (gchar * s);
 G_GNUC_INTERNAL
 gboolean		priv_gst_registry_binary_read_cache	(GstRegistry * registry, const char *location);
 
+G_GNUC_INTERNAL
+gboolean		priv_gst_registry_binary_read_cache_data (GstRegistry * registry, const guint8 * data, gsize size);
+
 G_GNUC_INTERNAL
 gboolean		priv_gst_registry_binary_write_cache	(GstRegistry * registry, GList * plugins, const char *location);
 
+G_GNUC_INTERNAL
+void			priv_gst_registry_keep_cache_data	(GstRegistry * registry, GBytes * data);
+
+G_GNUC_INTERNAL
+const GstStructure *	priv_gst_registry_ensure_metadata	(gpointer * metadata, const gchar * str);
+
+G_GNUC_INTERNAL
+GHashTable *		priv_gst_registry_get_factory_candidates (GstRegistry * registry, const GstCaps * caps, GstPadDirection direction, GHashTable ** indexed);
+
+G_GNUC_INTERNAL
+GList *			priv_gst_registry_get_uri_factories (GstRegistry * registry, GstURIType type, const gchar * protocol);
+
+G_GNUC_INTERNAL
+void			_priv_gst_pad_clear_caps_cache (GstPad * pad);
+
+G_GNUC_INTERNAL
+void			priv_gst_pad_invalidate_bypass (void);
+
 
 G_GNUC_INTERNAL
 void      __gst_element_factory_add_static_pad_template (GstElementFactory    * elementfactory,
@@ -204,10 +273,136 @@ _priv_gst_do_linear_regression (GstClockTime *times, guint n,
     GstClockTime * m_num, GstClockTime * m_denom, GstClockTime * b,
     GstClockTime * xbase, gdouble * r_squared);
 
+/* State of the streaming regression, see gstclock-linreg.c */
+typedef struct {
+  guint n;
+  /* reference observation, everything below is relative to it */
+  GstClockTime xref, yref;
+  gdouble xbar, ybar;
+  gdouble sxx, syy, sxy;
+} GstClockRegression;
+
+void
+_priv_gst_linear_regression_reset (GstClockRegression * reg);
+
+void
+_priv_gst_linear_regression_add (GstClockRegression * reg, GstClockTime x,
+    GstClockTime y);
+
+void
+_priv_gst_linear_regression_remove (GstClockRegression * reg, GstClockTime x,
+    GstClockTime y);
+
+void
+_priv_gst_linear_regression_rebuild (GstClockRegression * reg,
+    GstClockTime * times, guint n);
+
+gboolean
+_priv_gst_linear_regression_get (GstClockRegression * reg, GstClockTime xbase,
+    GstClockTime * m_num, GstClockTime * m_denom, GstClockTime * b,
+    gdouble * r_squared);
+
 /* For use in gstdebugutils */
 G_GNUC_INTERNAL
 GstCapsFeatures * __gst_caps_get_features_unchecked (const GstCaps * caps, guint idx);
 
+/* compact binary serialization of structures, caps and taglists. Bump the
+ * version whenever the format changes. */
+#define GST_BINARY_FORMAT_VERSION 1
+
+typedef struct {
+  const guint8 *data;
+  gsize size;
+  gsize pos;
+  /* nesting depth of lists, arrays, structures and caps */
+  guint depth;
+} GstBinaryReader;
+
+G_GNUC_INTERNAL
+void      _priv_gst_binary_write_version (GByteArray * array);
+
+G_GNUC_INTERNAL
+void      _priv_gst_binary_write_uint (GByteArray * array, guint64 val);
+
+G_GNUC_INTERNAL
+void      _priv_gst_binary_write_string (GByteArray * array, const gchar * str);
+
+G_GNUC_INTERNAL
+gboolean  _priv_gst_binary_read_version (GstBinaryReader * reader);
+
+G_GNUC_INTERNAL
+gboolean  _priv_gst_binary_read_uint8 (GstBinaryReader * reader, guint8 * val);
+
+G_GNUC_INTERNAL
+gboolean  _priv_gst_binary_read_uint (GstBinaryReader * reader, guint64 * val);
+
+G_GNUC_INTERNAL
+gboolean  _priv_gst_binary_read_string (GstBinaryReader * reader, const gchar ** str);
+
+G_GNUC_INTERNAL
+gboolean  _priv_gst_value_write_binary (GByteArray * array, const GValue * value);
+
+G_GNUC_INTERNAL
+gboolean  _priv_gst_value_read_binary (GstBinaryReader * reader, GValue * value);
+
+G_GNUC_INTERNAL
+gboolean  _priv_gst_structure_write_binary (GByteArray * array, const GstStructure * structure);
+
+G_GNUC_INTERNAL
+GstStructure * _priv_gst_structure_read_binary (GstBinaryReader * reader);
+
+G_GNUC_INTERNAL
+gboolean  _priv_gst_caps_write_binary (GByteArray * array, const GstCaps * caps);
+
+G_GNUC_INTERNAL
+GstCaps * _priv_gst_caps_read_binary (GstBinaryReader * reader);
+
+/* binary output of the tracer records, see gsttracerrecord.c */
+G_GNUC_INTERNAL
+void      _priv_gst_tracer_record_binary_init (void);
+
+G_GNUC_INTERNAL
+void      _priv_gst_tracer_record_binary_deinit (void);
+
+/* iterator over a copy of a list of objects, see gstiterator.c. Call with the
+ * lock protecting @list */
+G_GNUC_INTERNAL
+GstIterator * _priv_gst_iterator_new_list_snapshot (GType type, GList * list);
+
+/* dense indices of meta API types, see gstmeta.c. Buffers keep a bitmap of
+ * the indices of their metas. */
+#define GST_META_API_INDEX_MAX 64
+
+G_GNUC_INTERNAL
+gint      _priv_gst_meta_api_type_get_index (GType api);
+
+/* per-thread caches of the structs of the core mini objects, see
+ * gstminiobject.c */
+typedef enum {
+  GST_MINI_OBJECT_CACHE_BUFFER = 0,
+  GST_MINI_OBJECT_CACHE_EVENT,
+  GST_MINI_OBJECT_CACHE_MESSAGE,
+  GST_MINI_OBJECT_CACHE_QUERY,
+  GST_MINI_OBJECT_CACHE_BUFFER_LIST,
+  GST_MINI_OBJECT_CACHE_MEMORY,
+  GST_MINI_OBJECT_CACHE_LAST
+} GstMiniObjectCacheId;
+
+#ifndef GST_DISABLE_OBJECT_CACHE
+G_GNUC_INTERNAL
+gpointer  _priv_gst_mini_object_cache_alloc (GstMiniObjectCacheId id, gsize size);
+
+G_GNUC_INTERNAL
+gpointer  _priv_gst_mini_object_cache_alloc0 (GstMiniObjectCacheId id, gsize size);
+
+G_GNUC_INTERNAL
+void      _priv_gst_mini_object_cache_free (GstMiniObjectCacheId id, gsize size, gpointer mem);
+#else
+#define _priv_gst_mini_object_cache_alloc(id,size) g_slice_alloc (size)
+#define _priv_gst_mini_object_cache_alloc0(id,size) g_slice_alloc0 (size)
+#define _priv_gst_mini_object_cache_free(id,size,mem) g_slice_free1 (size, mem)
+#endif
+
 #ifndef GST_DISABLE_REGISTRY
 /* Secret variable to initialise gst without registry cache */
 GST_EXPORT gboolean _gst_disable_registry_cache;
@@ -275,7 +470,7 @@ extern GstDebugCategory *_priv_GST_CAT_POLL;
 #define GST_CAT_PROTECTION _priv_GST_CAT_PROTECTION
 extern GstDebugCategory *_priv_GST_CAT_PROTECTION;
 
-extern GstClockTime _priv_gst_start_time;
+GST_EXPORT GstClockTime _priv_gst_start_time;
 
 #else
 
@@ -393,6 +588,13 @@ struct _GstTypeFindFactory {
   GstTypeFindFunction           function;
   gchar **                      extensions;
   GstCaps *                     caps;
+  /* serialized caps in the registry cache, parsed on first use */
+  const gchar *                 caps_string;
+
+  /* bytes the stream must contain for the function to match */
+  gint64                        magic_offset;
+  guint8 *                      magic;
+  guint                         magic_len;
 
   gpointer                      user_data;
   GDestroyNotify                user_data_notify;
@@ -434,6 +636,8 @@ struct _GstElementFactory {
   GType                 type;                   /* unique GType of element or 0 if not loaded */
 
   gpointer              metadata;
+  /* serialized metadata in the registry cache, parsed on first use */
+  const gchar *         metadata_string;
 
   GList *               staticpadtemplates;     /* GstStaticPadTemplate list */
   guint                 numpadtemplates;
@@ -462,6 +666,8 @@ struct _GstDeviceProviderFactory {
 
   volatile GstDeviceProvider *provider;
   gpointer                   metadata;
+  /* serialized metadata in the registry cache, parsed on first use */
+  const gchar *              metadata_string;
 
   gpointer _gst_reserved[GST_PADDING];
 };
@@ -476,5 +682,19 @@ struct _GstDeviceProviderFactoryClass {
 /* privat flag used by GstBus / GstMessage */
 #define GST_MESSAGE_FLAG_ASYNC_DELIVERY (GST_MINI_OBJECT_FLAG_LAST << 0)
 
+/* private flag used by GstAllocator for memory counted in its statistics */
+#define GST_MEMORY_FLAG_IN_STATS (GST_MEMORY_FLAG_LAST >> 1)
+
+/* zero-filled GRecMutex and GCond are set up by GLib on first use, these
+ * only clear them when that happened */
+#define _priv_gst_rec_mutex_clear_lazy(m) G_STMT_START {  \
+  if ((m)->p)                                              \
+    g_rec_mutex_clear (m);                                 \
+} G_STMT_END
+#define _priv_gst_cond_clear_lazy(c) G_STMT_START {       \
+  if ((c)->p)                                              \
+    g_cond_clear (c);                                      \
+} G_STMT_END
+
 G_END_DECLS
 #endif /* __GST_PRIVATE_H__ */
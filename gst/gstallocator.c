@@ -35,6 +35,11 @@
  *
  * New memory can be created with gst_memory_new_wrapped() that wraps the memory
  * allocated elsewhere.
+ *
+ * Since 1.10, an allocator can keep statistics about the memory that is
+ * allocated with gst_allocator_alloc(). They are enabled with
+ * gst_allocator_set_stats_enabled() and retrieved with
+ * gst_allocator_get_stats().
  */
 
 #ifdef HAVE_CONFIG_H
@@ -43,6 +48,12 @@
 
 #include "gst_private.h"
 #include "gstmemory.h"
+#include "gstutils.h"
+
+#ifdef HAVE_MMAP
+#include <sys/mman.h>
+#include <errno.h>
+#endif
 
 GST_DEBUG_CATEGORY_STATIC (gst_allocator_debug);
 #define GST_CAT_DEFAULT gst_allocator_debug
@@ -52,7 +63,11 @@ GST_DEBUG_CATEGORY_STATIC (gst_allocator_debug);
 
 struct _GstAllocatorPrivate
 {
-  gpointer dummy;
+  gint stats_enabled;
+
+  /* protects stats */
+  GMutex stats_lock;
+  GstAllocationStats stats;
 };
 
 #if defined(MEMORY_ALIGNMENT_MALLOC)
@@ -70,7 +85,7 @@ gsize gst_memory_alignment = 0;
 /* the default allocator */
 static GstAllocator *_default_allocator;
 
-static GstAllocator *_sysmem_allocator;
+GstAllocator *_priv_gst_sysmem_allocator;
 
 /* registered allocators */
 static GRWLock lock;
@@ -78,11 +93,25 @@ static GHashTable *allocators;
 
 G_DEFINE_ABSTRACT_TYPE (GstAllocator, gst_allocator, GST_TYPE_OBJECT);
 
+static void
+gst_allocator_finalize (GObject * obj)
+{
+  GstAllocator *allocator = GST_ALLOCATOR_CAST (obj);
+
+  g_mutex_clear (&allocator->priv->stats_lock);
+
+  G_OBJECT_CLASS (gst_allocator_parent_class)->finalize (obj);
+}
+
 static void
 gst_allocator_class_init (GstAllocatorClass * klass)
 {
+  GObjectClass *gobject_class = (GObjectClass *) klass;
+
   g_type_class_add_private (klass, sizeof (GstAllocatorPrivate));
 
+  gobject_class->finalize = gst_allocator_finalize;
+
   GST_DEBUG_CATEGORY_INIT (gst_allocator_debug, "allocator", 0,
       "allocator debug");
 }
@@ -133,6 +162,7 @@ static void
 gst_allocator_init (GstAllocator * allocator)
 {
   allocator->priv = GST_ALLOCATOR_GET_PRIVATE (allocator);
+  g_mutex_init (&allocator->priv->stats_lock);
 
   allocator->mem_copy = _fallback_mem_copy;
   allocator->mem_is_span = _fallback_mem_is_span;
@@ -296,6 +326,9 @@ gst_allocator_alloc (GstAllocator * allocator, gsize size,
   GstMemory *mem;
   static GstAllocationParams defparams = { 0, 0, 0, 0, };
   GstAllocatorClass *aclass;
+  GstAllocatorPrivate *priv;
+  GstClockTime start = 0;
+  gboolean stats;
 
   if (params) {
     g_return_val_if_fail (((params->align + 1) & params->align) == 0, NULL);
@@ -306,12 +339,38 @@ gst_allocator_alloc (GstAllocator * allocator, gsize size,
   if (allocator == NULL)
     allocator = _default_allocator;
 
+  priv = allocator->priv;
+  stats = g_atomic_int_get (&priv->stats_enabled);
+  if (G_UNLIKELY (stats))
+    start = gst_util_get_timestamp ();
+
   aclass = GST_ALLOCATOR_GET_CLASS (allocator);
   if (aclass->alloc)
     mem = aclass->alloc (allocator, size, params);
   else
     mem = NULL;
 
+  if (G_UNLIKELY (stats)) {
+    GstClockTime elapsed = gst_util_get_timestamp () - start;
+
+    g_mutex_lock (&priv->stats_lock);
+    priv->stats.alloc_time += elapsed;
+    if (mem) {
+      priv->stats.allocated++;
+      priv->stats.live_bytes += mem->maxsize;
+      priv->stats.peak_bytes =
+          MAX (priv->stats.peak_bytes, priv->stats.live_bytes);
+    } else {
+      priv->stats.failed++;
+    }
+    g_mutex_unlock (&priv->stats_lock);
+
+    /* only memory with the flag is counted when freed, so that enabling
+     * the statistics later doesn't count memory that was never allocated */
+    if (mem)
+      GST_MINI_OBJECT_FLAG_SET (mem, GST_MEMORY_FLAG_IN_STATS);
+  }
+
   return mem;
 }
 
@@ -331,11 +390,79 @@ gst_allocator_free (GstAllocator * allocator, GstMemory * memory)
   g_return_if_fail (memory != NULL);
   g_return_if_fail (memory->allocator == allocator);
 
+  /* shared memory copies the flags of its parent */
+  if (G_UNLIKELY (GST_MEMORY_FLAG_IS_SET (memory, GST_MEMORY_FLAG_IN_STATS))
+      && memory->parent == NULL) {
+    GstAllocatorPrivate *priv = allocator->priv;
+
+    g_mutex_lock (&priv->stats_lock);
+    priv->stats.freed++;
+    priv->stats.live_bytes -= MIN (priv->stats.live_bytes, memory->maxsize);
+    g_mutex_unlock (&priv->stats_lock);
+  }
+
   aclass = GST_ALLOCATOR_GET_CLASS (allocator);
   if (aclass->free)
     aclass->free (allocator, memory);
 }
 
+/**
+ * gst_allocator_set_stats_enabled:
+ * @allocator: a #GstAllocator
+ * @enabled: whether to keep statistics
+ *
+ * Enable or disable the statistics of @allocator. When enabled, every
+ * gst_allocator_alloc() and gst_allocator_free() call on @allocator updates
+ * the #GstAllocationStats that can be retrieved with
+ * gst_allocator_get_stats(). The statistics are disabled by default because
+ * they add a lock and two timestamps to every allocation.
+ *
+ * Memory that is allocated while the statistics are enabled is accounted
+ * until it is freed, even when they are disabled in the meantime.
+ *
+ * Since: 1.10
+ */
+void
+gst_allocator_set_stats_enabled (GstAllocator * allocator, gboolean enabled)
+{
+  g_return_if_fail (GST_IS_ALLOCATOR (allocator));
+
+  g_atomic_int_set (&allocator->priv->stats_enabled, ! !enabled);
+}
+
+/**
+ * gst_allocator_get_stats:
+ * @allocator: a #GstAllocator
+ * @stats: (out caller-allocates): the #GstAllocationStats to fill
+ *
+ * Get the current statistics of @allocator. The statistics only cover
+ * memory allocated while they were enabled with
+ * gst_allocator_set_stats_enabled().
+ *
+ * Returns: %TRUE when @stats was filled, %FALSE when the statistics of
+ * @allocator are not enabled.
+ *
+ * Since: 1.10
+ */
+gboolean
+gst_allocator_get_stats (GstAllocator * allocator, GstAllocationStats * stats)
+{
+  GstAllocatorPrivate *priv;
+
+  g_return_val_if_fail (GST_IS_ALLOCATOR (allocator), FALSE);
+  g_return_val_if_fail (stats != NULL, FALSE);
+
+  priv = allocator->priv;
+  if (!g_atomic_int_get (&priv->stats_enabled))
+    return FALSE;
+
+  g_mutex_lock (&priv->stats_lock);
+  *stats = priv->stats;
+  g_mutex_unlock (&priv->stats_lock);
+
+  return TRUE;
+}
+
 /* default memory implementation */
 typedef struct
 {
@@ -368,8 +495,8 @@ _sysmem_init (GstMemorySystem * mem, GstMemoryFlags flags,
     gpointer data, gsize maxsize, gsize align, gsize offset, gsize size,
     gpointer user_data, GDestroyNotify notify)
 {
-  gst_memory_init (GST_MEMORY_CAST (mem),
-      flags, _sysmem_allocator, parent, maxsize, align, offset, size);
+  gst_memory_init (GST_MEMORY_CAST (mem), flags, _priv_gst_sysmem_allocator,
+      parent, maxsize, align, offset, size);
 
   mem->slice_size = slice_size;
   mem->data = data;
@@ -388,7 +515,10 @@ _sysmem_new (GstMemoryFlags flags,
 
   slice_size = sizeof (GstMemorySystem);
 
-  mem = g_slice_alloc (slice_size);
+  /* shared and wrapped memory are only a header, these come and go for
+   * every packet so keep them in the per-thread cache */
+  mem = _priv_gst_mini_object_cache_alloc (GST_MINI_OBJECT_CACHE_MEMORY,
+      slice_size);
   _sysmem_init (mem, flags, parent, slice_size,
       data, maxsize, align, offset, size, user_data, notify);
 
@@ -530,7 +660,11 @@ default_free (GstAllocator * allocator, GstMemory * mem)
   memset (mem, 0xff, sizeof (GstMemorySystem));
 #endif
 
-  g_slice_free1 (slice_size, mem);
+  if (slice_size == sizeof (GstMemorySystem))
+    _priv_gst_mini_object_cache_free (GST_MINI_OBJECT_CACHE_MEMORY,
+        slice_size, mem);
+  else
+    g_slice_free1 (slice_size, mem);
 }
 
 static void
@@ -569,6 +703,261 @@ gst_allocator_sysmem_init (GstAllocatorSysmem * allocator)
   alloc->mem_is_span = (GstMemoryIsSpanFunction) _sysmem_is_span;
 }
 
+#ifdef HAVE_MMAP
+/* huge page backed system memory.
+ *
+ * Memory is carved out of chunks that are aligned to the huge page size and
+ * advised for transparent huge pages. Small requests are served from
+ * power-of-two size classes, each with its own free list, so that every block
+ * is naturally aligned to its size. Requests bigger than the largest class get
+ * a dedicated mapping rounded up to whole huge pages. Chunks are kept around
+ * once mapped, the free lists only grow to the peak usage of each class. */
+#define HUGEPAGE_SIZE           (G_GSIZE_CONSTANT (2) * 1024 * 1024)
+#define HUGEPAGE_MIN_SHIFT      12
+#define HUGEPAGE_MAX_SHIFT      20
+#define HUGEPAGE_N_CLASSES      (HUGEPAGE_MAX_SHIFT - HUGEPAGE_MIN_SHIFT + 1)
+
+#if !defined(MAP_ANONYMOUS) && defined(MAP_ANON)
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+
+typedef struct
+{
+  GMutex lock;
+  gsize block_size;
+  /* free blocks, the link to the next block is stored in the block itself */
+  gpointer free_list;
+} GstHugepagesSlab;
+
+typedef struct
+{
+  GstAllocatorSysmem parent;
+
+  GstHugepagesSlab slabs[HUGEPAGE_N_CLASSES];
+} GstAllocatorHugepages;
+
+typedef struct
+{
+  GstAllocatorSysmemClass parent_class;
+} GstAllocatorHugepagesClass;
+
+GType gst_allocator_hugepages_get_type (void);
+G_DEFINE_TYPE (GstAllocatorHugepages, gst_allocator_hugepages,
+    gst_allocator_sysmem_get_type ());
+
+/* map @size bytes aligned to the huge page size, @size must be a multiple of
+ * the huge page size */
+static guint8 *
+_hugepages_map (gsize size)
+{
+  guint8 *area, *data;
+  gsize head, tail;
+
+  /* map more so that we can trim the area to a huge page boundary */
+  area = mmap (NULL, size + HUGEPAGE_SIZE, PROT_READ | PROT_WRITE,
+      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (area == MAP_FAILED) {
+    GST_CAT_WARNING (GST_CAT_MEMORY, "failed to map %" G_GSIZE_FORMAT
+        " bytes: %s", size, g_strerror (errno));
+    return NULL;
+  }
+
+  data = (guint8 *) (((guintptr) area + HUGEPAGE_SIZE - 1) &
+      ~((guintptr) HUGEPAGE_SIZE - 1));
+  head = data - area;
+  tail = HUGEPAGE_SIZE - head;
+  if (head)
+    munmap (area, head);
+  if (tail)
+    munmap (data + size, tail);
+
+#ifdef MADV_HUGEPAGE
+  /* not fatal, we simply get normal pages then */
+  if (madvise (data, size, MADV_HUGEPAGE) < 0)
+    GST_CAT_DEBUG (GST_CAT_MEMORY, "no transparent huge pages: %s",
+        g_strerror (errno));
+#endif
+
+  return data;
+}
+
+static guint8 *
+_hugepages_slab_alloc (GstHugepagesSlab * slab)
+{
+  guint8 *block;
+
+  g_mutex_lock (&slab->lock);
+  if (slab->free_list == NULL) {
+    guint8 *chunk;
+    gsize i;
+
+    if ((chunk = _hugepages_map (HUGEPAGE_SIZE)) == NULL) {
+      g_mutex_unlock (&slab->lock);
+      return NULL;
+    }
+    GST_CAT_DEBUG (GST_CAT_MEMORY, "new chunk %p for blocks of %"
+        G_GSIZE_FORMAT " bytes", chunk, slab->block_size);
+
+    /* put the blocks on the free list lowest address first */
+    for (i = HUGEPAGE_SIZE; i > 0; i -= slab->block_size) {
+      block = chunk + i - slab->block_size;
+      *(gpointer *) block = slab->free_list;
+      slab->free_list = block;
+    }
+  }
+  block = slab->free_list;
+  slab->free_list = *(gpointer *) block;
+  g_mutex_unlock (&slab->lock);
+
+  return block;
+}
+
+static void
+_hugepages_slab_free (GstHugepagesSlab * slab, guint8 * block)
+{
+  g_mutex_lock (&slab->lock);
+  *(gpointer *) block = slab->free_list;
+  slab->free_list = block;
+  g_mutex_unlock (&slab->lock);
+}
+
+static GstMemory *
+hugepages_alloc (GstAllocator * allocator, gsize size,
+    GstAllocationParams * params)
+{
+  GstAllocatorHugepages *hp = (GstAllocatorHugepages *) allocator;
+  GstHugepagesSlab *slab = NULL;
+  GstMemorySystem *mem;
+  gsize maxsize, align, needed, padding;
+  guint8 *data;
+  guint shift;
+
+  maxsize = size + params->prefix + params->padding;
+  /* ensure configured alignment */
+  align = params->align | gst_memory_alignment;
+
+  /* we can't align beyond the huge page size */
+  if (align >= HUGEPAGE_SIZE) {
+    GST_CAT_DEBUG (GST_CAT_MEMORY, "alignment %" G_GSIZE_FORMAT
+        " too big, using system memory", align);
+    return default_alloc (allocator, size, params);
+  }
+
+  /* blocks are aligned to their size, pick a class big enough for both */
+  needed = MAX (maxsize, align + 1);
+  for (shift = HUGEPAGE_MIN_SHIFT; shift <= HUGEPAGE_MAX_SHIFT; shift++) {
+    if ((G_GSIZE_CONSTANT (1) << shift) >= needed) {
+      slab = &hp->slabs[shift - HUGEPAGE_MIN_SHIFT];
+      break;
+    }
+  }
+
+  if (slab) {
+    maxsize = slab->block_size;
+    data = _hugepages_slab_alloc (slab);
+  } else {
+    maxsize = (needed + HUGEPAGE_SIZE - 1) & ~(HUGEPAGE_SIZE - 1);
+    data = _hugepages_map (maxsize);
+  }
+  if (data == NULL)
+    return NULL;
+
+  if (params->prefix && (params->flags & GST_MEMORY_FLAG_ZERO_PREFIXED))
+    memset (data, 0, params->prefix);
+
+  padding = maxsize - (params->prefix + size);
+  if (padding && (params->flags & GST_MEMORY_FLAG_ZERO_PADDED))
+    memset (data + params->prefix + size, 0, padding);
+
+  mem = g_slice_new (GstMemorySystem);
+  gst_memory_init (GST_MEMORY_CAST (mem), params->flags, allocator, NULL,
+      maxsize, align, params->prefix, size);
+  mem->slice_size = sizeof (GstMemorySystem);
+  mem->data = data;
+  /* the owning size class, NULL for dedicated mappings */
+  mem->user_data = slab;
+  mem->notify = NULL;
+
+  return (GstMemory *) mem;
+}
+
+static void
+hugepages_free (GstAllocator * allocator, GstMemory * mem)
+{
+  GstMemorySystem *dmem = (GstMemorySystem *) mem;
+
+  if (dmem->user_data)
+    _hugepages_slab_free (dmem->user_data, dmem->data);
+  else
+    munmap (dmem->data, mem->maxsize);
+
+  g_slice_free1 (dmem->slice_size, mem);
+}
+
+static GstMemorySystem *
+_hugepages_copy (GstMemorySystem * mem, gssize offset, gsize size)
+{
+  GstAllocationParams params = { 0, 0, 0, 0, };
+  GstMemorySystem *copy;
+
+  if (size == -1)
+    size = mem->mem.size > offset ? mem->mem.size - offset : 0;
+
+  params.align = mem->mem.align;
+  copy = (GstMemorySystem *) hugepages_alloc (mem->mem.allocator, size,
+      &params);
+  if (copy == NULL)
+    return NULL;
+
+  GST_CAT_DEBUG (GST_CAT_PERFORMANCE,
+      "memcpy %" G_GSIZE_FORMAT " memory %p -> %p", size, mem, copy);
+  memcpy (copy->data, mem->data + mem->mem.offset + offset, size);
+
+  return copy;
+}
+
+static void
+gst_allocator_hugepages_finalize (GObject * obj)
+{
+  g_warning ("The huge page memory allocator was freed!");
+}
+
+static void
+gst_allocator_hugepages_class_init (GstAllocatorHugepagesClass * klass)
+{
+  GObjectClass *gobject_class;
+  GstAllocatorClass *allocator_class;
+
+  gobject_class = (GObjectClass *) klass;
+  allocator_class = (GstAllocatorClass *) klass;
+
+  gobject_class->finalize = gst_allocator_hugepages_finalize;
+
+  allocator_class->alloc = hugepages_alloc;
+  allocator_class->free = hugepages_free;
+}
+
+static void
+gst_allocator_hugepages_init (GstAllocatorHugepages * allocator)
+{
+  GstAllocator *alloc = GST_ALLOCATOR_CAST (allocator);
+  guint i;
+
+  GST_CAT_DEBUG (GST_CAT_MEMORY, "init allocator %p", allocator);
+
+  for (i = 0; i < HUGEPAGE_N_CLASSES; i++) {
+    g_mutex_init (&allocator->slabs[i].lock);
+    allocator->slabs[i].block_size =
+        G_GSIZE_CONSTANT (1) << (i + HUGEPAGE_MIN_SHIFT);
+    allocator->slabs[i].free_list = NULL;
+  }
+
+  /* the memory is plain system memory, only where it comes from differs.
+   * map/unmap/share/is_span are inherited from the system allocator. */
+  alloc->mem_copy = (GstMemoryCopyFunction) _hugepages_copy;
+}
+#endif
+
 void
 _priv_gst_allocator_initialize (void)
 {
@@ -584,12 +973,18 @@ _priv_gst_allocator_initialize (void)
   GST_CAT_DEBUG (GST_CAT_MEMORY, "memory alignment: %" G_GSIZE_FORMAT,
       gst_memory_alignment);
 
-  _sysmem_allocator = g_object_new (gst_allocator_sysmem_get_type (), NULL);
+  _priv_gst_sysmem_allocator =
+      g_object_new (gst_allocator_sysmem_get_type (), NULL);
 
   gst_allocator_register (GST_ALLOCATOR_SYSMEM,
-      gst_object_ref (_sysmem_allocator));
+      gst_object_ref (_priv_gst_sysmem_allocator));
 
-  _default_allocator = gst_object_ref (_sysmem_allocator);
+  _default_allocator = gst_object_ref (_priv_gst_sysmem_allocator);
+
+#ifdef HAVE_MMAP
+  gst_allocator_register (GST_ALLOCATOR_SYSMEM_HUGEPAGES,
+      g_object_new (gst_allocator_hugepages_get_type (), NULL));
+#endif
 }
 
 /**
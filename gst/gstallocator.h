@@ -43,6 +43,7 @@ typedef struct _GstAllocatorClass GstAllocatorClass;
 GType gst_allocation_params_get_type(void);
 
 typedef struct _GstAllocationParams GstAllocationParams;
+typedef struct _GstAllocationStats GstAllocationStats;
 
 /**
  * gst_memory_alignment:
@@ -59,6 +60,18 @@ GST_EXPORT gsize gst_memory_alignment;
  */
 #define GST_ALLOCATOR_SYSMEM   "SystemMemory"
 
+/**
+ * GST_ALLOCATOR_SYSMEM_HUGEPAGES:
+ *
+ * The allocator name for the system memory allocator that serves memory from
+ * huge page aligned chunks. Memory from this allocator is system memory and
+ * honours the #GstAllocationParams prefix, padding and alignment. It is only
+ * registered on platforms with mmap().
+ *
+ * Since: 1.10
+ */
+#define GST_ALLOCATOR_SYSMEM_HUGEPAGES   "SystemMemoryHugePages"
+
 /**
  * GstAllocationParams:
  * @flags: flags to control allocation
@@ -78,6 +91,31 @@ struct _GstAllocationParams {
   gpointer _gst_reserved[GST_PADDING];
 };
 
+/**
+ * GstAllocationStats:
+ * @allocated: the number of successful allocations
+ * @freed: the number of freed allocations
+ * @failed: the number of failed allocations
+ * @live_bytes: the number of bytes that are currently allocated
+ * @peak_bytes: the maximum of @live_bytes
+ * @alloc_time: the total time in nanoseconds spent allocating
+ *
+ * Allocation statistics of a #GstAllocator or a #GstBufferPool.
+ *
+ * Since: 1.10
+ */
+struct _GstAllocationStats {
+  guint64 allocated;
+  guint64 freed;
+  guint64 failed;
+  guint64 live_bytes;
+  guint64 peak_bytes;
+  guint64 alloc_time;
+
+  /*< private >*/
+  gpointer _gst_reserved[GST_PADDING];
+};
+
 /**
  * GstAllocatorFlags:
  * @GST_ALLOCATOR_FLAG_CUSTOM_ALLOC: The allocator has a custom alloc function.
@@ -166,6 +204,10 @@ GstMemory *    gst_allocator_alloc           (GstAllocator * allocator, gsize si
                                               GstAllocationParams *params);
 void           gst_allocator_free            (GstAllocator * allocator, GstMemory *memory);
 
+/* statistics */
+void           gst_allocator_set_stats_enabled (GstAllocator * allocator, gboolean enabled);
+gboolean       gst_allocator_get_stats       (GstAllocator * allocator, GstAllocationStats *stats);
+
 GstMemory *    gst_memory_new_wrapped  (GstMemoryFlags flags, gpointer data, gsize maxsize,
                                         gsize offset, gsize size, gpointer user_data,
                                         GDestroyNotify notify);
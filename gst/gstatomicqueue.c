@@ -35,6 +35,11 @@
  *
  * The #GstAtomicQueue object implements a queue that can be used from multiple
  * threads without performing any blocking operations.
+ *
+ * A queue created with gst_atomic_queue_new() grows when needed. A queue
+ * created with gst_atomic_queue_new_bounded() has a fixed capacity and never
+ * allocates memory after it was created. Use gst_atomic_queue_try_push() to
+ * add items to a bounded queue without waiting for a free slot.
  */
 
 G_DEFINE_BOXED_TYPE (GstAtomicQueue, gst_atomic_queue,
@@ -101,6 +106,30 @@ free_queue_mem (GstAQueueMem * mem)
   g_free (mem);
 }
 
+/* The bounded queue is a fixed size array of cells where each cell has a
+ * sequence number. The sequence number tells if the cell can be written for
+ * a given tail position or read for a given head position, this way readers
+ * and writers only need a single compare-and-exchange on their own position
+ * counter. The counters are kept on separate cache lines. */
+#define CACHE_LINE_SIZE 64
+
+typedef struct
+{
+  volatile gint seq;
+  gpointer data;
+} GstAQueueCell;
+
+typedef struct
+{
+  guint8 pad0[CACHE_LINE_SIZE];
+  volatile gint tail;
+  guint8 pad1[CACHE_LINE_SIZE - sizeof (gint)];
+  volatile gint head;
+  guint8 pad2[CACHE_LINE_SIZE - sizeof (gint)];
+  guint mask;
+  GstAQueueCell *cells;
+} GstAQueueRing;
+
 struct _GstAtomicQueue
 {
   volatile gint refcount;
@@ -110,8 +139,117 @@ struct _GstAtomicQueue
   GstAQueueMem *head_mem;
   GstAQueueMem *tail_mem;
   GstAQueueMem *free_list;
+  /* non-NULL for bounded queues */
+  GstAQueueRing *ring;
 };
 
+static GstAQueueRing *
+new_queue_ring (guint capacity)
+{
+  GstAQueueRing *ring;
+  guint i, size;
+
+  size = clp2 (MAX (capacity, 2));
+
+  ring = g_new0 (GstAQueueRing, 1);
+  ring->mask = size - 1;
+  ring->cells = g_new (GstAQueueCell, size);
+  for (i = 0; i < size; i++) {
+    ring->cells[i].seq = i;
+    ring->cells[i].data = NULL;
+  }
+  ring->head = 0;
+  ring->tail = 0;
+
+  return ring;
+}
+
+static void
+free_queue_ring (GstAQueueRing * ring)
+{
+  g_free (ring->cells);
+  g_free (ring);
+}
+
+static gboolean
+ring_push (GstAQueueRing * ring, gpointer data)
+{
+  GstAQueueCell *cell;
+  guint pos, seq;
+  gint diff;
+
+  pos = g_atomic_int_get (&ring->tail);
+  while (TRUE) {
+    cell = &ring->cells[pos & ring->mask];
+    seq = g_atomic_int_get (&cell->seq);
+    diff = (gint) (seq - pos);
+
+    if (G_LIKELY (diff == 0)) {
+      /* the cell is free for this position, try to claim it */
+      if (g_atomic_int_compare_and_exchange (&ring->tail, pos, pos + 1))
+        break;
+      pos = g_atomic_int_get (&ring->tail);
+    } else if (diff < 0) {
+      /* the cell still contains an item from the previous round, full */
+      return FALSE;
+    } else {
+      /* another writer claimed the cell, retry with the new position */
+      pos = g_atomic_int_get (&ring->tail);
+    }
+  }
+  cell->data = data;
+  /* make the item visible to the readers */
+  g_atomic_int_set (&cell->seq, pos + 1);
+
+  return TRUE;
+}
+
+static gpointer
+ring_pop (GstAQueueRing * ring)
+{
+  GstAQueueCell *cell;
+  gpointer data;
+  guint pos, seq;
+  gint diff;
+
+  pos = g_atomic_int_get (&ring->head);
+  while (TRUE) {
+    cell = &ring->cells[pos & ring->mask];
+    seq = g_atomic_int_get (&cell->seq);
+    diff = (gint) (seq - (pos + 1));
+
+    if (G_LIKELY (diff == 0)) {
+      if (g_atomic_int_compare_and_exchange (&ring->head, pos, pos + 1))
+        break;
+      pos = g_atomic_int_get (&ring->head);
+    } else if (diff < 0) {
+      /* the cell was not written yet, empty */
+      return NULL;
+    } else {
+      pos = g_atomic_int_get (&ring->head);
+    }
+  }
+  data = cell->data;
+  /* make the cell available to the writers of the next round */
+  g_atomic_int_set (&cell->seq, pos + ring->mask + 1);
+
+  return data;
+}
+
+static gpointer
+ring_peek (GstAQueueRing * ring)
+{
+  GstAQueueCell *cell;
+  guint pos;
+
+  pos = g_atomic_int_get (&ring->head);
+  cell = &ring->cells[pos & ring->mask];
+  if ((guint) g_atomic_int_get (&cell->seq) != pos + 1)
+    return NULL;
+
+  return cell->data;
+}
+
 static void
 add_to_free_list (GstAtomicQueue * queue, GstAQueueMem * mem)
 {
@@ -165,6 +303,43 @@ gst_atomic_queue_new (guint initial_size)
 #endif
   queue->head_mem = queue->tail_mem = new_queue_mem (initial_size, 0);
   queue->free_list = NULL;
+  queue->ring = NULL;
+
+  return queue;
+}
+
+/**
+ * gst_atomic_queue_new_bounded:
+ * @capacity: the maximum number of items in the queue
+ *
+ * Create a new atomic queue instance that can hold at most @capacity items.
+ * @capacity will be rounded up to the nearest power of 2.
+ *
+ * Unlike a queue created with gst_atomic_queue_new(), a bounded queue
+ * preallocates all its memory and never allocates again. When the queue is
+ * full, gst_atomic_queue_try_push() fails and gst_atomic_queue_push() waits
+ * until a reader made room for the item.
+ *
+ * Returns: a new #GstAtomicQueue
+ *
+ * Since: 1.10
+ */
+GstAtomicQueue *
+gst_atomic_queue_new_bounded (guint capacity)
+{
+  GstAtomicQueue *queue;
+
+  g_return_val_if_fail (capacity > 0, NULL);
+
+  queue = g_new (GstAtomicQueue, 1);
+
+  queue->refcount = 1;
+#ifdef LOW_MEM
+  queue->num_readers = 0;
+#endif
+  queue->head_mem = queue->tail_mem = NULL;
+  queue->free_list = NULL;
+  queue->ring = new_queue_ring (capacity);
 
   return queue;
 }
@@ -186,6 +361,11 @@ gst_atomic_queue_ref (GstAtomicQueue * queue)
 static void
 gst_atomic_queue_free (GstAtomicQueue * queue)
 {
+  if (queue->ring) {
+    free_queue_ring (queue->ring);
+    g_free (queue);
+    return;
+  }
   free_queue_mem (queue->head_mem);
   if (queue->head_mem != queue->tail_mem)
     free_queue_mem (queue->tail_mem);
@@ -225,6 +405,9 @@ gst_atomic_queue_peek (GstAtomicQueue * queue)
 
   g_return_val_if_fail (queue != NULL, NULL);
 
+  if (queue->ring)
+    return ring_peek (queue->ring);
+
   while (TRUE) {
     GstAQueueMem *next;
 
@@ -276,6 +459,9 @@ gst_atomic_queue_pop (GstAtomicQueue * queue)
 
   g_return_val_if_fail (queue != NULL, NULL);
 
+  if (queue->ring)
+    return ring_pop (queue->ring);
+
 #ifdef LOW_MEM
   g_atomic_int_inc (&queue->num_readers);
 #endif
@@ -333,6 +519,9 @@ gst_atomic_queue_pop (GstAtomicQueue * queue)
  * @data: the data
  *
  * Append @data to the tail of the queue.
+ *
+ * When @queue is a bounded queue and it is full, this function waits until
+ * there is room for @data.
  */
 void
 gst_atomic_queue_push (GstAtomicQueue * queue, gpointer data)
@@ -342,6 +531,12 @@ gst_atomic_queue_push (GstAtomicQueue * queue, gpointer data)
 
   g_return_if_fail (queue != NULL);
 
+  if (queue->ring) {
+    while (G_UNLIKELY (!ring_push (queue->ring, data)))
+      g_thread_yield ();
+    return;
+  }
+
   do {
     while (TRUE) {
       GstAQueueMem *mem;
@@ -388,6 +583,32 @@ gst_atomic_queue_push (GstAtomicQueue * queue, gpointer data)
     (!g_atomic_int_compare_and_exchange (&tail_mem->tail_read, tail, tail + 1));
 }
 
+/**
+ * gst_atomic_queue_try_push:
+ * @queue: a #GstAtomicQueue
+ * @data: the data
+ *
+ * Append @data to the tail of the queue if there is room for it. A queue
+ * created with gst_atomic_queue_new() grows as needed and always accepts
+ * @data.
+ *
+ * Returns: %TRUE when @data was added, %FALSE when @queue is a bounded queue
+ * that is full.
+ *
+ * Since: 1.10
+ */
+gboolean
+gst_atomic_queue_try_push (GstAtomicQueue * queue, gpointer data)
+{
+  g_return_val_if_fail (queue != NULL, FALSE);
+
+  if (queue->ring)
+    return ring_push (queue->ring, data);
+
+  gst_atomic_queue_push (queue, data);
+  return TRUE;
+}
+
 /**
  * gst_atomic_queue_length:
  * @queue: a #GstAtomicQueue
@@ -404,6 +625,17 @@ gst_atomic_queue_length (GstAtomicQueue * queue)
 
   g_return_val_if_fail (queue != NULL, 0);
 
+  if (queue->ring) {
+    gint len;
+
+    head = g_atomic_int_get (&queue->ring->head);
+    tail = g_atomic_int_get (&queue->ring->tail);
+    /* readers might have claimed items that were not counted yet */
+    len = (gint) ((guint) tail - (guint) head);
+
+    return MAX (len, 0);
+  }
+
 #ifdef LOW_MEM
   g_atomic_int_inc (&queue->num_readers);
 #endif
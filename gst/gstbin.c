@@ -159,11 +159,15 @@
 
 #include "gstevent.h"
 #include "gstbin.h"
+#include "gstpipeline.h"
 #include "gstinfo.h"
 #include "gsterror.h"
 
 #include "gstutils.h"
 #include "gstchildproxy.h"
+#include "gstghostpad.h"
+#include "gsttask.h"
+#include "gsttaskpool.h"
 
 GST_DEBUG_CATEGORY_STATIC (bin_debug);
 #define GST_CAT_DEFAULT bin_debug
@@ -197,8 +201,37 @@ struct _GstBinPrivate
 
   gboolean posted_eos;
   gboolean posted_playing;
+
+  /* pool for the scheduleable tasks of our children */
+  GstTaskPool *task_pool;
+
+  /* children by name. Element names can't change while they have a parent
+   * so this only needs updating on add and remove */
+  GHashTable *children_names;
+
+  /* cached state change order of the children, without refs. Valid as long
+   * as structure_cookie and children_cookie didn't change */
+  GArray *state_order;
+  guint32 state_order_cookie;
+  guint32 state_order_children_cookie;
+
+  gboolean parallel_state_changes;
+
+  /* forward only one LATENCY message until the latency was recalculated */
+  gboolean coalesce_latency;
+  gboolean latency_pending;
 };
 
+/* a child in the state change order with its distance to the most
+ * downstream elements. Children with the same level are never linked to
+ * each other */
+typedef struct
+{
+  GstElement *element;
+  gint level;
+  guint pos;
+} GstBinOrderEntry;
+
 typedef struct
 {
   GstBin *bin;
@@ -207,6 +240,7 @@ typedef struct
 } BinContinueData;
 
 static void gst_bin_dispose (GObject * object);
+static void gst_bin_finalize (GObject * object);
 
 static void gst_bin_set_property (GObject * object, guint prop_id,
     const GValue * value, GParamSpec * pspec);
@@ -266,12 +300,17 @@ enum
 
 #define DEFAULT_ASYNC_HANDLING	FALSE
 #define DEFAULT_MESSAGE_FORWARD	FALSE
+#define DEFAULT_PARALLEL_STATE_CHANGES	FALSE
+#define DEFAULT_COALESCE_LATENCY	FALSE
 
 enum
 {
   PROP_0,
   PROP_ASYNC_HANDLING,
   PROP_MESSAGE_FORWARD,
+  PROP_TASK_POOL,
+  PROP_PARALLEL_STATE_CHANGES,
+  PROP_COALESCE_LATENCY,
   PROP_LAST
 };
 
@@ -441,7 +480,74 @@ gst_bin_class_init (GstBinClass * klass)
           "Forwards all children messages",
           DEFAULT_MESSAGE_FORWARD, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstBin:task-pool:
+   *
+   * A #GstTaskPool for the streaming tasks of all children, like the ones of
+   * queue src pads or push mode sources. Tasks created while this is set
+   * are made scheduleable on this pool: every iteration of the task function
+   * is a separate push on the pool and elements like queue give the thread
+   * back to the pool when they have nothing to do instead of waiting.
+   *
+   * Combined with a #GstWorkStealingTaskPool this allows many pipelines to
+   * share a small number of threads. A task blocking in a push, for example
+   * on a full queue downstream, keeps its thread, so the pool needs enough
+   * threads for all tasks that can block at the same time. Only tasks that are still using the
+   * default pool are changed, so an inner bin or a STREAM_STATUS sync handler
+   * can select a different pool.
+   *
+   * Since: 1.10
+   */
+  g_object_class_install_property (gobject_class, PROP_TASK_POOL,
+      g_param_spec_object ("task-pool", "Task Pool",
+          "Pool for running the streaming tasks of all children "
+          "cooperatively (NULL = a thread per task)", GST_TYPE_TASK_POOL,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstBin:parallel-state-changes:
+   *
+   * Change the state of children that are not linked to each other from
+   * several threads at the same time. Children are still changed in
+   * topological order: an element only changes state after all elements
+   * downstream of it did, but elements at the same distance from the
+   * sinks, like the branches after a tee, are changed in parallel.
+   *
+   * This helps pipelines with many children that are slow to change state,
+   * for example because they open devices or files. Note that state change
+   * messages of these children can then be posted in any order.
+   *
+   * Since: 1.10
+   */
+  g_object_class_install_property (gobject_class, PROP_PARALLEL_STATE_CHANGES,
+      g_param_spec_boolean ("parallel-state-changes", "Parallel state changes",
+          "Change the state of independent children in parallel",
+          DEFAULT_PARALLEL_STATE_CHANGES,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstBin:coalesce-latency:
+   *
+   * When set on a toplevel bin, only one #GST_MESSAGE_LATENCY is posted on
+   * the bus until gst_bin_recalculate_latency() is called on the bin. The
+   * LATENCY messages children post in the meantime are dropped, the pending
+   * recalculation will query the latency of the whole bin anyway.
+   *
+   * This avoids recalculating the latency once for every child when many
+   * children post LATENCY messages at the same time, like during startup or
+   * when branches are added. It must only be enabled when the application
+   * calls gst_bin_recalculate_latency() on this bin for LATENCY messages.
+   *
+   * Since: 1.10
+   */
+  g_object_class_install_property (gobject_class, PROP_COALESCE_LATENCY,
+      g_param_spec_boolean ("coalesce-latency", "Coalesce latency",
+          "Post only one LATENCY message until the latency was recalculated",
+          DEFAULT_COALESCE_LATENCY,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gobject_class->dispose = gst_bin_dispose;
+  gobject_class->finalize = gst_bin_finalize;
 
   gst_element_class_set_static_metadata (gstelement_class, "Generic bin",
       "Generic/Bin",
@@ -504,6 +610,12 @@ gst_bin_init (GstBin * bin)
   bin->priv->asynchandling = DEFAULT_ASYNC_HANDLING;
   bin->priv->structure_cookie = 0;
   bin->priv->message_forward = DEFAULT_MESSAGE_FORWARD;
+  bin->priv->task_pool = NULL;
+  bin->priv->children_names = g_hash_table_new_full (g_str_hash, g_str_equal,
+      g_free, NULL);
+  bin->priv->state_order = NULL;
+  bin->priv->parallel_state_changes = DEFAULT_PARALLEL_STATE_CHANGES;
+  bin->priv->coalesce_latency = DEFAULT_COALESCE_LATENCY;
 }
 
 static void
@@ -513,11 +625,13 @@ gst_bin_dispose (GObject * object)
   GstBus **child_bus_p = &bin->child_bus;
   GstClock **provided_clock_p = &bin->provided_clock;
   GstElement **clock_provider_p = &bin->clock_provider;
+  GstTaskPool **task_pool_p = &bin->priv->task_pool;
 
   GST_CAT_DEBUG_OBJECT (GST_CAT_REFCOUNTING, object, "dispose");
 
   GST_OBJECT_LOCK (object);
   gst_object_replace ((GstObject **) child_bus_p, NULL);
+  gst_object_replace ((GstObject **) task_pool_p, NULL);
   gst_object_replace ((GstObject **) provided_clock_p, NULL);
   gst_object_replace ((GstObject **) clock_provider_p, NULL);
   bin_remove_messages (bin, NULL, GST_MESSAGE_ANY);
@@ -534,6 +648,18 @@ gst_bin_dispose (GObject * object)
   G_OBJECT_CLASS (parent_class)->dispose (object);
 }
 
+static void
+gst_bin_finalize (GObject * object)
+{
+  GstBin *bin = GST_BIN_CAST (object);
+
+  g_hash_table_unref (bin->priv->children_names);
+  if (bin->priv->state_order)
+    g_array_free (bin->priv->state_order, TRUE);
+
+  G_OBJECT_CLASS (parent_class)->finalize (object);
+}
+
 /**
  * gst_bin_new:
  * @name: (allow-none): the name of the new bin
@@ -567,6 +693,23 @@ gst_bin_set_property (GObject * object, guint prop_id,
       gstbin->priv->message_forward = g_value_get_boolean (value);
       GST_OBJECT_UNLOCK (gstbin);
       break;
+    case PROP_TASK_POOL:
+      GST_OBJECT_LOCK (gstbin);
+      gst_object_replace ((GstObject **) & gstbin->priv->task_pool,
+          g_value_get_object (value));
+      GST_OBJECT_UNLOCK (gstbin);
+      break;
+    case PROP_PARALLEL_STATE_CHANGES:
+      GST_OBJECT_LOCK (gstbin);
+      gstbin->priv->parallel_state_changes = g_value_get_boolean (value);
+      GST_OBJECT_UNLOCK (gstbin);
+      break;
+    case PROP_COALESCE_LATENCY:
+      GST_OBJECT_LOCK (gstbin);
+      gstbin->priv->coalesce_latency = g_value_get_boolean (value);
+      gstbin->priv->latency_pending = FALSE;
+      GST_OBJECT_UNLOCK (gstbin);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -592,6 +735,21 @@ gst_bin_get_property (GObject * object, guint prop_id,
       g_value_set_boolean (value, gstbin->priv->message_forward);
       GST_OBJECT_UNLOCK (gstbin);
       break;
+    case PROP_TASK_POOL:
+      GST_OBJECT_LOCK (gstbin);
+      g_value_set_object (value, gstbin->priv->task_pool);
+      GST_OBJECT_UNLOCK (gstbin);
+      break;
+    case PROP_PARALLEL_STATE_CHANGES:
+      GST_OBJECT_LOCK (gstbin);
+      g_value_set_boolean (value, gstbin->priv->parallel_state_changes);
+      GST_OBJECT_UNLOCK (gstbin);
+      break;
+    case PROP_COALESCE_LATENCY:
+      GST_OBJECT_LOCK (gstbin);
+      g_value_set_boolean (value, gstbin->priv->coalesce_latency);
+      GST_OBJECT_UNLOCK (gstbin);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -699,7 +857,7 @@ gst_bin_set_clock_func (GstElement * element, GstClock * clock)
 
   bin = GST_BIN_CAST (element);
 
-  it = gst_bin_iterate_elements (bin);
+  it = gst_bin_iterate_elements_snapshot (bin);
 
   done = FALSE;
   while (!done) {
@@ -1120,7 +1278,8 @@ gst_bin_add_func (GstBin * bin, GstElement * element)
    * we can safely take the lock here. This check is probably bogus because
    * you can safely change the element name after this check and before setting
    * the object parent. The window is very small though... */
-  if (G_UNLIKELY (!gst_object_check_uniqueness (bin->children, elem_name)))
+  if (G_UNLIKELY (elem_name
+          && g_hash_table_contains (bin->priv->children_names, elem_name)))
     goto duplicate_name;
 
   /* set the element's parent and add the element to the bin's list of children */
@@ -1151,6 +1310,9 @@ gst_bin_add_func (GstBin * bin, GstElement * element)
   }
 
   bin->children = g_list_prepend (bin->children, element);
+  if (elem_name)
+    g_hash_table_insert (bin->priv->children_names, g_strdup (elem_name),
+        element);
   bin->numchildren++;
   bin->children_cookie++;
   if (!GST_BIN_IS_NO_RESYNC (bin))
@@ -1287,7 +1449,7 @@ no_state_recalc:
     gst_element_post_message (element, async_message);
 
   /* unlink all linked pads */
-  it = gst_element_iterate_pads (element);
+  it = gst_element_iterate_pads_snapshot (element);
   gst_iterator_foreach (it, (GstIteratorForeachFunction) unlink_pads, NULL);
   gst_iterator_free (it);
 
@@ -1446,6 +1608,8 @@ gst_bin_remove_func (GstBin * bin, GstElement * element)
       found = TRUE;
       /* remove the element */
       bin->children = g_list_delete_link (bin->children, walk);
+      if (elem_name)
+        g_hash_table_remove (bin->priv->children_names, elem_name);
     } else {
       gboolean child_sink, child_source, child_provider, child_requirer;
 
@@ -1622,7 +1786,7 @@ no_state_recalc:
     gst_element_post_message (GST_ELEMENT_CAST (bin), clock_message);
 
   /* unlink all linked pads */
-  it = gst_element_iterate_pads (element);
+  it = gst_element_iterate_pads_snapshot (element);
   gst_iterator_foreach (it, (GstIteratorForeachFunction) unlink_pads, NULL);
   gst_iterator_free (it);
 
@@ -1738,6 +1902,51 @@ gst_bin_iterate_elements (GstBin * bin)
   return result;
 }
 
+/**
+ * gst_bin_iterate_elements_snapshot:
+ * @bin: a #GstBin
+ *
+ * Gets an iterator for the elements in this bin at the time of the call.
+ * Unlike gst_bin_iterate_elements(), the iterator does not take the lock of
+ * @bin and never returns %GST_ITERATOR_RESYNC, children that are added or
+ * removed later are not reflected. This avoids resyncing repeatedly when
+ * the children of @bin change often.
+ *
+ * MT safe.  Caller owns returned value.
+ *
+ * Returns: (transfer full) (nullable): a #GstIterator of #GstElement,
+ * or %NULL
+ *
+ * Since: 1.10
+ */
+GstIterator *
+gst_bin_iterate_elements_snapshot (GstBin * bin)
+{
+  GstIterator *result;
+
+  g_return_val_if_fail (GST_IS_BIN (bin), NULL);
+
+  GST_OBJECT_LOCK (bin);
+  result = _priv_gst_iterator_new_list_snapshot (GST_TYPE_ELEMENT,
+      bin->children);
+  GST_OBJECT_UNLOCK (bin);
+
+  return result;
+}
+
+/* snapshot of the src or sink pads of @element */
+static GstIterator *
+element_iterate_pad_list_snapshot (GstElement * element, GList ** padlist)
+{
+  GstIterator *result;
+
+  GST_OBJECT_LOCK (element);
+  result = _priv_gst_iterator_new_list_snapshot (GST_TYPE_PAD, *padlist);
+  GST_OBJECT_UNLOCK (element);
+
+  return result;
+}
+
 static GstIteratorItem
 iterate_child_recurse (GstIterator * it, const GValue * item)
 {
@@ -1814,7 +2023,8 @@ sink_iterator_filter (const GValue * vchild, GValue * vbin)
  * @bin: a #GstBin
  *
  * Gets an iterator for all elements in the bin that have the
- * #GST_ELEMENT_FLAG_SINK flag set.
+ * #GST_ELEMENT_FLAG_SINK flag set. The iterator works on a snapshot of
+ * the children like gst_bin_iterate_elements_snapshot().
  *
  * MT safe.  Caller owns returned value.
  *
@@ -1833,7 +2043,7 @@ gst_bin_iterate_sinks (GstBin * bin)
   g_value_init (&vbin, GST_TYPE_BIN);
   g_value_set_object (&vbin, bin);
 
-  children = gst_bin_iterate_elements (bin);
+  children = gst_bin_iterate_elements_snapshot (bin);
   result = gst_iterator_filter (children,
       (GCompareFunc) sink_iterator_filter, &vbin);
 
@@ -1875,7 +2085,8 @@ src_iterator_filter (const GValue * vchild, GValue * vbin)
  * @bin: a #GstBin
  *
  * Gets an iterator for all elements in the bin that have the
- * #GST_ELEMENT_FLAG_SOURCE flag set.
+ * #GST_ELEMENT_FLAG_SOURCE flag set. The iterator works on a snapshot of
+ * the children like gst_bin_iterate_elements_snapshot().
  *
  * MT safe.  Caller owns returned value.
  *
@@ -1894,7 +2105,7 @@ gst_bin_iterate_sources (GstBin * bin)
   g_value_init (&vbin, GST_TYPE_BIN);
   g_value_set_object (&vbin, bin);
 
-  children = gst_bin_iterate_elements (bin);
+  children = gst_bin_iterate_elements_snapshot (bin);
   result = gst_iterator_filter (children,
       (GCompareFunc) src_iterator_filter, &vbin);
 
@@ -2508,7 +2719,8 @@ gst_bin_src_pads_activate (GstBin * bin, gboolean active)
 
   GST_DEBUG_OBJECT (bin, "%s pads", active ? "activate" : "deactivate");
 
-  iter = gst_element_iterate_src_pads ((GstElement *) bin);
+  iter = element_iterate_pad_list_snapshot ((GstElement *) bin,
+      &GST_ELEMENT_CAST (bin)->srcpads);
   fold_ok = iterator_activate_fold_with_resync (iter, &active);
   gst_iterator_free (iter);
   if (G_UNLIKELY (!fold_ok))
@@ -2546,6 +2758,11 @@ gst_bin_recalculate_latency (GstBin * bin)
 {
   gboolean res;
 
+  /* LATENCY messages posted from now on need another recalculation */
+  GST_OBJECT_LOCK (bin);
+  bin->priv->latency_pending = FALSE;
+  GST_OBJECT_UNLOCK (bin);
+
   g_signal_emit (bin, gst_bin_signals[DO_LATENCY], 0, &res);
   GST_DEBUG_OBJECT (bin, "latency returned %d", res);
 
@@ -2631,6 +2848,309 @@ gst_bin_post_message (GstElement * element, GstMessage * msg)
   return ret;
 }
 
+/* get the level of @element: one more than the highest level of the
+ * elements in @levels its source pads are linked to */
+static gint
+gst_bin_get_order_level (GstBin * bin, GstElement * element,
+    GHashTable * levels)
+{
+  GList *pads;
+  gint level = 0;
+
+  GST_OBJECT_LOCK (element);
+  for (pads = element->srcpads; pads; pads = g_list_next (pads)) {
+    GstPad *peer;
+
+    if ((peer = gst_pad_get_peer (GST_PAD_CAST (pads->data)))) {
+      GstElement *peer_element;
+
+      if ((peer_element = gst_pad_get_parent_element (peer))) {
+        gint peer_level;
+
+        /* elements outside of the bin or not handled yet are not in the
+         * table */
+        peer_level =
+            GPOINTER_TO_INT (g_hash_table_lookup (levels, peer_element));
+        if (peer_level > level)
+          level = peer_level;
+        gst_object_unref (peer_element);
+      }
+      gst_object_unref (peer);
+    }
+  }
+  GST_OBJECT_UNLOCK (element);
+
+  return level;
+}
+
+static void
+gst_bin_state_order_clear (GArray * order)
+{
+  guint i;
+
+  for (i = 0; i < order->len; i++)
+    gst_object_unref (g_array_index (order, GstBinOrderEntry, i).element);
+  g_array_set_size (order, 0);
+}
+
+static void
+gst_bin_state_order_free (GArray * order)
+{
+  gst_bin_state_order_clear (order);
+  g_array_free (order, TRUE);
+}
+
+/* build the state change order of the children of @bin, with a ref */
+static GArray *
+gst_bin_build_state_order (GstBin * bin)
+{
+  GstIterator *it;
+  GHashTable *levels;
+  GArray *order;
+  GValue data = { 0, };
+  gboolean done = FALSE;
+
+  order = g_array_new (FALSE, FALSE, sizeof (GstBinOrderEntry));
+  levels = g_hash_table_new (NULL, NULL);
+
+  it = gst_bin_iterate_sorted (bin);
+  while (!done) {
+    switch (gst_iterator_next (it, &data)) {
+      case GST_ITERATOR_OK:
+      {
+        GstBinOrderEntry entry;
+
+        entry.element = g_value_dup_object (&data);
+        entry.level = gst_bin_get_order_level (bin, entry.element, levels);
+        entry.pos = order->len;
+        /* store level + 1 so that 0 means not seen */
+        g_hash_table_insert (levels, entry.element,
+            GINT_TO_POINTER (entry.level + 1));
+        g_array_append_val (order, entry);
+        g_value_reset (&data);
+        break;
+      }
+      case GST_ITERATOR_RESYNC:
+        gst_iterator_resync (it);
+        gst_bin_state_order_clear (order);
+        g_hash_table_remove_all (levels);
+        break;
+      default:
+      case GST_ITERATOR_DONE:
+        done = TRUE;
+        break;
+    }
+  }
+  g_value_unset (&data);
+  gst_iterator_free (it);
+  g_hash_table_destroy (levels);
+
+  return order;
+}
+
+static gint
+compare_order_entry (gconstpointer a, gconstpointer b)
+{
+  const GstBinOrderEntry *ea = a, *eb = b;
+
+  if (ea->level != eb->level)
+    return ea->level - eb->level;
+  return (gint) ea->pos - (gint) eb->pos;
+}
+
+/* get the children of @bin in state change order, with a ref. The order is
+ * cached until the children or their links change. When @parallel is
+ * set, the entries are grouped by level. @cookie is set to the structure
+ * cookie the order is valid for. */
+static GArray *
+gst_bin_get_state_order (GstBin * bin, gboolean parallel, guint32 * cookie)
+{
+  GstBinPrivate *priv = bin->priv;
+  GArray *order;
+  guint32 structure_cookie, children_cookie;
+  guint i;
+
+  GST_OBJECT_LOCK (bin);
+  structure_cookie = priv->structure_cookie;
+  children_cookie = bin->children_cookie;
+  if (priv->state_order && priv->state_order_cookie == structure_cookie &&
+      priv->state_order_children_cookie == children_cookie) {
+    GST_DEBUG_OBJECT (bin, "using cached state change order");
+    order = g_array_sized_new (FALSE, FALSE, sizeof (GstBinOrderEntry),
+        priv->state_order->len);
+    g_array_append_vals (order, priv->state_order->data,
+        priv->state_order->len);
+    for (i = 0; i < order->len; i++)
+      gst_object_ref (g_array_index (order, GstBinOrderEntry, i).element);
+    GST_OBJECT_UNLOCK (bin);
+  } else {
+    GArray *cached;
+
+    GST_OBJECT_UNLOCK (bin);
+
+    order = gst_bin_build_state_order (bin);
+
+    GST_OBJECT_LOCK (bin);
+    /* only cache when nothing changed while building and no links are
+     * being changed, the order might not be complete then */
+    if (structure_cookie == priv->structure_cookie &&
+        children_cookie == bin->children_cookie &&
+        !find_message (bin, NULL, GST_MESSAGE_STRUCTURE_CHANGE)) {
+      cached = g_array_sized_new (FALSE, FALSE, sizeof (GstBinOrderEntry),
+          order->len);
+      g_array_append_vals (cached, order->data, order->len);
+      if (priv->state_order)
+        g_array_free (priv->state_order, TRUE);
+      priv->state_order = cached;
+      priv->state_order_cookie = structure_cookie;
+      priv->state_order_children_cookie = children_cookie;
+    }
+    GST_OBJECT_UNLOCK (bin);
+  }
+
+  if (parallel)
+    g_array_sort (order, compare_order_entry);
+
+  *cookie = structure_cookie;
+
+  return order;
+}
+
+/* a group of children changing state in parallel. The caller and the
+ * helper threads take the next child until all are done */
+typedef struct
+{
+  gint refcount;
+  GMutex lock;
+  GCond cond;
+
+  GstBin *bin;
+  GstElement **children;
+  GstStateChangeReturn *rets;
+  guint n_children;
+  guint next_child;
+  guint busy;
+
+  GstClockTime base_time;
+  GstClockTime start_time;
+  GstState current;
+  GstState next;
+} GstBinStateGroup;
+
+static void
+gst_bin_state_group_unref (GstBinStateGroup * group)
+{
+  if (!g_atomic_int_dec_and_test (&group->refcount))
+    return;
+
+  g_mutex_clear (&group->lock);
+  g_cond_clear (&group->cond);
+  g_free (group);
+}
+
+static void
+gst_bin_state_group_run (GstBinStateGroup * group)
+{
+  g_mutex_lock (&group->lock);
+  while (group->next_child < group->n_children) {
+    guint idx = group->next_child++;
+    GstStateChangeReturn ret;
+
+    group->busy++;
+    g_mutex_unlock (&group->lock);
+
+    ret = gst_bin_element_set_state (group->bin, group->children[idx],
+        group->base_time, group->start_time, group->current, group->next);
+
+    g_mutex_lock (&group->lock);
+    group->rets[idx] = ret;
+    if (--group->busy == 0)
+      g_cond_broadcast (&group->cond);
+  }
+  g_mutex_unlock (&group->lock);
+}
+
+static void
+gst_bin_state_group_func (GstBinStateGroup * group)
+{
+  gst_bin_state_group_run (group);
+  gst_bin_state_group_unref (group);
+}
+
+/* change the state of @n_entries children that are not linked to each
+ * other. The calling thread takes part in the work so that this never
+ * waits for a busy pool */
+static void
+gst_bin_set_state_parallel (GstBin * bin, GstBinOrderEntry * entries,
+    guint n_entries, GstStateChangeReturn * rets, GstClockTime base_time,
+    GstClockTime start_time, GstState current, GstState next)
+{
+  GstBinStateGroup *group;
+  GstTaskPool *pool;
+  gpointer *ids;
+  guint i, n_helpers;
+
+  group = g_new0 (GstBinStateGroup, 1);
+  group->refcount = 1;
+  g_mutex_init (&group->lock);
+  g_cond_init (&group->cond);
+  group->bin = bin;
+  group->children = g_new (GstElement *, n_entries);
+  for (i = 0; i < n_entries; i++)
+    group->children[i] = entries[i].element;
+  group->rets = rets;
+  group->n_children = n_entries;
+  group->base_time = base_time;
+  group->start_time = start_time;
+  group->current = current;
+  group->next = next;
+
+  GST_OBJECT_LOCK (bin);
+  if ((pool = bin->priv->task_pool))
+    gst_object_ref (pool);
+  GST_OBJECT_UNLOCK (bin);
+  if (pool == NULL)
+    pool = gst_task_pool_get_default ();
+
+  n_helpers = MIN (n_entries, g_get_num_processors ()) - 1;
+  GST_CAT_DEBUG_OBJECT (GST_CAT_STATES, bin,
+      "changing state of %u children with %u helpers", n_entries, n_helpers);
+
+  ids = g_new0 (gpointer, n_helpers + 1);
+  for (i = 0; i < n_helpers; i++) {
+    GError *err = NULL;
+
+    g_atomic_int_inc (&group->refcount);
+    ids[i] = gst_task_pool_push (pool,
+        (GstTaskPoolFunction) gst_bin_state_group_func, group, &err);
+    if (err != NULL) {
+      GST_CAT_WARNING_OBJECT (GST_CAT_STATES, bin,
+          "failed to start helper: %s", err->message);
+      g_error_free (err);
+      gst_bin_state_group_unref (group);
+      ids[i] = NULL;
+      break;
+    }
+  }
+
+  /* work ourselves and wait for the children the helpers took */
+  gst_bin_state_group_run (group);
+  g_mutex_lock (&group->lock);
+  while (group->busy > 0)
+    g_cond_wait (&group->cond, &group->lock);
+  g_mutex_unlock (&group->lock);
+
+  for (i = 0; i < n_helpers; i++) {
+    if (ids[i])
+      gst_task_pool_join (pool, ids[i]);
+  }
+  g_free (ids);
+  gst_object_unref (pool);
+
+  g_free (group->children);
+  gst_bin_state_group_unref (group);
+}
+
 static void
 reset_state (const GValue * data, gpointer user_data)
 {
@@ -2651,9 +3171,11 @@ gst_bin_change_state_func (GstElement * element, GstStateChange transition)
   gboolean have_async;
   gboolean have_no_preroll;
   GstClockTime base_time, start_time;
-  GstIterator *it;
-  gboolean done;
-  GValue data = { 0, };
+  GArray *order;
+  GstStateChangeReturn *rets;
+  guint32 order_cookie;
+  gboolean parallel;
+  guint i, k, n;
 
   /* we don't need to take the STATE_LOCK, it is already taken */
   current = (GstState) GST_STATE_TRANSITION_CURRENT (transition);
@@ -2727,8 +3249,12 @@ gst_bin_change_state_func (GstElement * element, GstStateChange transition)
   bin->polling = TRUE;
   GST_OBJECT_UNLOCK (bin);
 
-  /* iterate in state change order */
-  it = gst_bin_iterate_sorted (bin);
+  /* get the children in state change order */
+  GST_OBJECT_LOCK (bin);
+  parallel = bin->priv->parallel_state_changes;
+  GST_OBJECT_UNLOCK (bin);
+  order = gst_bin_get_state_order (bin, parallel, &order_cookie);
+  rets = g_new (GstStateChangeReturn, order->len);
 
   /* mark if we've seen an ASYNC element in the bin when we did a state change.
    * Note how we don't reset this value when a resync happens, the reason being
@@ -2743,86 +3269,100 @@ restart:
 
   have_no_preroll = FALSE;
 
-  done = FALSE;
-  while (!done) {
-    switch (gst_iterator_next (it, &data)) {
-      case GST_ITERATOR_OK:
-      {
-        GstElement *child;
-
-        child = g_value_get_object (&data);
-
-        /* set state and base_time now */
-        ret = gst_bin_element_set_state (bin, child, base_time, start_time,
-            current, next);
-
-        switch (ret) {
-          case GST_STATE_CHANGE_SUCCESS:
-            GST_CAT_INFO_OBJECT (GST_CAT_STATES, element,
-                "child '%s' changed state to %d(%s) successfully",
-                GST_ELEMENT_NAME (child), next,
-                gst_element_state_get_name (next));
-            break;
-          case GST_STATE_CHANGE_ASYNC:
-          {
-            GST_CAT_INFO_OBJECT (GST_CAT_STATES, element,
-                "child '%s' is changing state asynchronously to %s",
-                GST_ELEMENT_NAME (child), gst_element_state_get_name (next));
-            have_async = TRUE;
-            break;
-          }
-          case GST_STATE_CHANGE_FAILURE:{
-            GstObject *parent;
-
-            GST_CAT_INFO_OBJECT (GST_CAT_STATES, element,
-                "child '%s' failed to go to state %d(%s)",
-                GST_ELEMENT_NAME (child),
-                next, gst_element_state_get_name (next));
-
-            /* Only fail if the child is still inside
-             * this bin. It might've been removed already
-             * because of the error by the bin subclass
-             * to ignore the error.  */
-            parent = gst_object_get_parent (GST_OBJECT_CAST (child));
-            if (parent == GST_OBJECT_CAST (element)) {
-              /* element is still in bin, really error now */
-              gst_object_unref (parent);
-              goto undo;
-            }
-            /* child removed from bin, let the resync code redo the state
-             * change */
-            GST_CAT_INFO_OBJECT (GST_CAT_STATES, element,
-                "child '%s' was removed from the bin",
-                GST_ELEMENT_NAME (child));
+  for (i = 0; i < order->len; i = n) {
+    GstBinOrderEntry *entries = &g_array_index (order, GstBinOrderEntry, 0);
+    gboolean resync;
+
+    /* children of the same level don't depend on each other */
+    n = i + 1;
+    if (parallel) {
+      while (n < order->len && entries[n].level == entries[i].level)
+        n++;
+    }
 
-            if (parent)
-              gst_object_unref (parent);
+    if (n - i > 1) {
+      gst_bin_set_state_parallel (bin, entries + i, n - i, rets + i,
+          base_time, start_time, current, next);
+    } else {
+      /* set state and base_time now */
+      rets[i] = gst_bin_element_set_state (bin, entries[i].element, base_time,
+          start_time, current, next);
+    }
+
+    for (k = i; k < n; k++) {
+      GstElement *child = entries[k].element;
+
+      ret = rets[k];
 
-            break;
+      switch (ret) {
+        case GST_STATE_CHANGE_SUCCESS:
+          GST_CAT_INFO_OBJECT (GST_CAT_STATES, element,
+              "child '%s' changed state to %d(%s) successfully",
+              GST_ELEMENT_NAME (child), next,
+              gst_element_state_get_name (next));
+          break;
+        case GST_STATE_CHANGE_ASYNC:
+        {
+          GST_CAT_INFO_OBJECT (GST_CAT_STATES, element,
+              "child '%s' is changing state asynchronously to %s",
+              GST_ELEMENT_NAME (child), gst_element_state_get_name (next));
+          have_async = TRUE;
+          break;
+        }
+        case GST_STATE_CHANGE_FAILURE:{
+          GstObject *parent;
+
+          GST_CAT_INFO_OBJECT (GST_CAT_STATES, element,
+              "child '%s' failed to go to state %d(%s)",
+              GST_ELEMENT_NAME (child),
+              next, gst_element_state_get_name (next));
+
+          /* Only fail if the child is still inside
+           * this bin. It might've been removed already
+           * because of the error by the bin subclass
+           * to ignore the error.  */
+          parent = gst_object_get_parent (GST_OBJECT_CAST (child));
+          if (parent == GST_OBJECT_CAST (element)) {
+            /* element is still in bin, really error now */
+            gst_object_unref (parent);
+            goto undo;
           }
-          case GST_STATE_CHANGE_NO_PREROLL:
-            GST_CAT_INFO_OBJECT (GST_CAT_STATES, element,
-                "child '%s' changed state to %d(%s) successfully without preroll",
-                GST_ELEMENT_NAME (child), next,
-                gst_element_state_get_name (next));
-            have_no_preroll = TRUE;
-            break;
-          default:
-            g_assert_not_reached ();
-            break;
+          /* child removed from bin, let the resync code redo the state
+           * change */
+          GST_CAT_INFO_OBJECT (GST_CAT_STATES, element,
+              "child '%s' was removed from the bin",
+              GST_ELEMENT_NAME (child));
+
+          if (parent)
+            gst_object_unref (parent);
+
+          break;
         }
-        g_value_reset (&data);
-        break;
+        case GST_STATE_CHANGE_NO_PREROLL:
+          GST_CAT_INFO_OBJECT (GST_CAT_STATES, element,
+              "child '%s' changed state to %d(%s) successfully without preroll",
+              GST_ELEMENT_NAME (child), next,
+              gst_element_state_get_name (next));
+          have_no_preroll = TRUE;
+          break;
+        default:
+          g_assert_not_reached ();
+          break;
       }
-      case GST_ITERATOR_RESYNC:
-        GST_CAT_DEBUG_OBJECT (GST_CAT_STATES, element, "iterator doing resync");
-        gst_iterator_resync (it);
-        goto restart;
-      default:
-      case GST_ITERATOR_DONE:
-        GST_CAT_DEBUG_OBJECT (GST_CAT_STATES, element, "iterator done");
-        done = TRUE;
-        break;
+    }
+
+    /* the children changed, get the new order and start over */
+    GST_OBJECT_LOCK (bin);
+    resync = (bin->priv->structure_cookie != order_cookie);
+    GST_OBJECT_UNLOCK (bin);
+
+    if (resync) {
+      GST_CAT_DEBUG_OBJECT (GST_CAT_STATES, element, "doing resync");
+      gst_bin_state_order_free (order);
+      g_free (rets);
+      order = gst_bin_get_state_order (bin, parallel, &order_cookie);
+      rets = g_new (GstStateChangeReturn, order->len);
+      goto restart;
     }
   }
 
@@ -2843,8 +3383,8 @@ restart:
   }
 
 done:
-  g_value_unset (&data);
-  gst_iterator_free (it);
+  gst_bin_state_order_free (order);
+  g_free (rets);
 
   GST_OBJECT_LOCK (bin);
   bin->polling = FALSE;
@@ -2979,11 +3519,11 @@ gst_bin_send_event (GstElement * element, GstEvent * event)
   gst_iterator_free (iter);
 
   if (GST_EVENT_IS_DOWNSTREAM (event)) {
-    iter = gst_element_iterate_sink_pads (GST_ELEMENT (bin));
+    iter = element_iterate_pad_list_snapshot (element, &element->sinkpads);
     GST_DEBUG_OBJECT (bin, "Sending %s event to sink pads",
         GST_EVENT_TYPE_NAME (event));
   } else {
-    iter = gst_element_iterate_src_pads (GST_ELEMENT (bin));
+    iter = element_iterate_pad_list_snapshot (element, &element->srcpads);
     GST_DEBUG_OBJECT (bin, "Sending %s event to src pads",
         GST_EVENT_TYPE_NAME (event));
   }
@@ -3517,6 +4057,125 @@ gst_bin_update_context_unlocked (GstBin * bin, GstContext * context)
  *
  * OTHER: post upwards.
  */
+/* make the task of a CREATE stream-status message scheduleable on our
+ * task pool, unless it already uses a non-default pool */
+static void
+bin_configure_task (GstBin * bin, GstMessage * message)
+{
+  const GValue *val;
+  GstTaskPool *pool, *task_pool, *default_pool;
+  GstTask *task;
+
+  val = gst_message_get_stream_status_object (message);
+  if (val == NULL || !G_VALUE_HOLDS (val, GST_TYPE_TASK))
+    return;
+  task = g_value_get_object (val);
+  if (task == NULL)
+    return;
+
+  GST_OBJECT_LOCK (bin);
+  if ((pool = bin->priv->task_pool))
+    gst_object_ref (pool);
+  GST_OBJECT_UNLOCK (bin);
+
+  if (pool == NULL)
+    return;
+
+  default_pool = gst_task_pool_get_default ();
+  task_pool = gst_task_get_pool (task);
+  if (task_pool == default_pool) {
+    GST_DEBUG_OBJECT (bin, "making task %" GST_PTR_FORMAT " scheduleable on %"
+        GST_PTR_FORMAT, task, pool);
+    gst_task_set_pool (task, pool);
+    gst_task_set_scheduleable (task, TRUE);
+  }
+  gst_object_unref (task_pool);
+  gst_object_unref (default_pool);
+  gst_object_unref (pool);
+}
+
+/* message types of children that gst_bin_handle_message_func() and
+ * gst_pipeline_handle_message() act on instead of only forwarding them. The
+ * top-level bin coalesces LATENCY messages and STATE_DIRTY is dropped */
+#define BIN_HANDLED_MESSAGES (GST_MESSAGE_ERROR | GST_MESSAGE_EOS | \
+    GST_MESSAGE_STREAM_START | GST_MESSAGE_SEGMENT_START | \
+    GST_MESSAGE_SEGMENT_DONE | GST_MESSAGE_CLOCK_LOST | \
+    GST_MESSAGE_CLOCK_PROVIDE | GST_MESSAGE_ASYNC_START | \
+    GST_MESSAGE_ASYNC_DONE | GST_MESSAGE_STRUCTURE_CHANGE | \
+    GST_MESSAGE_NEED_CONTEXT | GST_MESSAGE_HAVE_CONTEXT | \
+    GST_MESSAGE_RESET_TIME | GST_MESSAGE_LATENCY | GST_MESSAGE_STATE_DIRTY)
+
+/**
+ * gst_bin_class_set_handled_messages:
+ * @klass: a #GstBinClass
+ * @types: the message types the @handle_message method of @klass acts on
+ *
+ * Declare which messages of its children the @handle_message method of
+ * @klass does something with besides chaining up to the parent class.
+ * Messages of other types that no bin further up acts on are then posted
+ * directly on the bus where they end up, without going through the
+ * @handle_message methods of the bins in between.
+ *
+ * Bin subclasses that override @handle_message and don't call this are
+ * assumed to act on all messages. Call this in the class_init function after
+ * setting @handle_message, overriding @handle_message again in a subclass
+ * invalidates the declaration.
+ *
+ * Since: 1.10
+ */
+void
+gst_bin_class_set_handled_messages (GstBinClass * klass, GstMessageType types)
+{
+  g_return_if_fail (GST_IS_BIN_CLASS (klass));
+
+  klass->handled_messages = types;
+  klass->handled_messages_func = (gpointer) klass->handle_message;
+}
+
+/* check if @bin needs child messages of @type itself, even when nobody
+ * further up is interested in them */
+gboolean
+_priv_gst_bin_handles_message (GstBin * bin, GstMessageType type)
+{
+  GstBinClass *klass = GST_BIN_GET_CLASS (bin);
+  gboolean res;
+
+  /* subclasses can do anything with the messages of their children unless
+   * they told us what they handle */
+  if (klass->handle_message != gst_bin_handle_message_func &&
+      !(GST_IS_PIPELINE (bin) && klass->handle_message ==
+          GST_BIN_CLASS (g_type_class_peek (GST_TYPE_PIPELINE))->
+          handle_message)) {
+    if (klass->handled_messages_func != (gpointer) klass->handle_message)
+      return TRUE;
+    if (type & klass->handled_messages)
+      return TRUE;
+  }
+
+  if (type & BIN_HANDLED_MESSAGES)
+    return TRUE;
+
+  if (type != GST_MESSAGE_STREAM_STATUS)
+    return FALSE;
+
+  /* we only configure tasks when we have a pool for them */
+  GST_OBJECT_LOCK (bin);
+  res = bin->priv->task_pool != NULL;
+  GST_OBJECT_UNLOCK (bin);
+
+  return res;
+}
+
+/* check if @bin would only post child messages of @type on its own bus */
+gboolean
+_priv_gst_bin_forwards_message (GstBin * bin, GstMessageType type)
+{
+  if (GST_ELEMENT_GET_CLASS (bin)->post_message != gst_bin_post_message)
+    return FALSE;
+
+  return !_priv_gst_bin_handles_message (bin, type);
+}
+
 static void
 gst_bin_handle_message_func (GstBin * bin, GstMessage * message)
 {
@@ -3849,6 +4508,25 @@ gst_bin_handle_message_func (GstBin * bin, GstMessage * message)
 
       break;
     }
+    case GST_MESSAGE_LATENCY:
+    {
+      gboolean drop = FALSE;
+
+      GST_OBJECT_LOCK (bin);
+      if (bin->priv->coalesce_latency && GST_OBJECT_PARENT (bin) == NULL) {
+        drop = bin->priv->latency_pending;
+        bin->priv->latency_pending = TRUE;
+      }
+      GST_OBJECT_UNLOCK (bin);
+
+      if (!drop)
+        goto forward;
+
+      GST_DEBUG_OBJECT (bin, "latency recalculation pending, dropping %"
+          GST_PTR_FORMAT, message);
+      gst_message_unref (message);
+      break;
+    }
     case GST_MESSAGE_HAVE_CONTEXT:{
       GstContext *context;
 
@@ -3859,6 +4537,18 @@ gst_bin_handle_message_func (GstBin * bin, GstMessage * message)
       goto forward;
       break;
     }
+    case GST_MESSAGE_STREAM_STATUS:{
+      GstStreamStatusType status;
+
+      /* children post this from the thread creating the task, before it
+       * is started, so we can still configure it */
+      gst_message_parse_stream_status (message, &status, NULL);
+      if (status == GST_STREAM_STATUS_TYPE_CREATE)
+        bin_configure_task (bin, message);
+
+      goto forward;
+      break;
+    }
     default:
       goto forward;
   }
@@ -4190,7 +4880,7 @@ gst_bin_query (GstElement * element, GstQuery * query)
 
   if (!res) {
     /* Query the source pads of the element */
-    iter = gst_element_iterate_src_pads (element);
+    iter = element_iterate_pad_list_snapshot (element, &element->srcpads);
     src_pads_query_result =
         bin_iterate_fold (bin, iter, fold_init, fold_done, fold_func,
         &fold_data, default_return);
@@ -4225,25 +4915,13 @@ gst_bin_set_context (GstElement * element, GstContext * context)
 
   GST_ELEMENT_CLASS (parent_class)->set_context (element, context);
 
-  children = gst_bin_iterate_elements (bin);
+  children = gst_bin_iterate_elements_snapshot (bin);
   while (gst_iterator_foreach (children, set_context,
           context) == GST_ITERATOR_RESYNC)
     gst_iterator_resync (children);
   gst_iterator_free (children);
 }
 
-static gint
-compare_name (const GValue * velement, const gchar * name)
-{
-  gint eq;
-  GstElement *element = g_value_get_object (velement);
-
-  GST_OBJECT_LOCK (element);
-  eq = strcmp (GST_ELEMENT_NAME (element), name);
-  GST_OBJECT_UNLOCK (element);
-
-  return eq;
-}
 
 /**
  * gst_bin_get_by_name:
@@ -4263,27 +4941,32 @@ compare_name (const GValue * velement, const gchar * name)
 GstElement *
 gst_bin_get_by_name (GstBin * bin, const gchar * name)
 {
-  GstIterator *children;
-  GValue result = { 0, };
   GstElement *element;
-  gboolean found;
+  GList *walk, *bins = NULL;
 
   g_return_val_if_fail (GST_IS_BIN (bin), NULL);
 
   GST_CAT_INFO (GST_CAT_PARENTAGE, "[%s]: looking up child element %s",
       GST_ELEMENT_NAME (bin), name);
 
-  children = gst_bin_iterate_recurse (bin);
-  found = gst_iterator_find_custom (children,
-      (GCompareFunc) compare_name, &result, (gpointer) name);
-  gst_iterator_free (children);
-
-  if (found) {
-    element = g_value_dup_object (&result);
-    g_value_unset (&result);
-  } else {
-    element = NULL;
+  /* first our own children, then the children of our child bins */
+  GST_OBJECT_LOCK (bin);
+  element = g_hash_table_lookup (bin->priv->children_names, name);
+  if (element) {
+    gst_object_ref (element);
+    GST_OBJECT_UNLOCK (bin);
+    return element;
   }
+  for (walk = bin->children; walk; walk = walk->next) {
+    if (GST_IS_BIN (walk->data))
+      bins = g_list_prepend (bins, gst_object_ref (walk->data));
+  }
+  GST_OBJECT_UNLOCK (bin);
+
+  bins = g_list_reverse (bins);
+  for (walk = bins; walk && element == NULL; walk = walk->next)
+    element = gst_bin_get_by_name (GST_BIN_CAST (walk->data), name);
+  g_list_free_full (bins, gst_object_unref);
 
   return element;
 }
@@ -4427,3 +5110,287 @@ gst_bin_iterate_all_by_interface (GstBin * bin, GType iface)
 
   return result;
 }
+
+/* copy all properties of @src that can be set and are not at their default
+ * value to @dest */
+static void
+gst_bin_clone_properties (GstElement * src, GstElement * dest)
+{
+  GParamSpec **pspecs;
+  guint i, n_pspecs;
+
+  pspecs = g_object_class_list_properties (G_OBJECT_GET_CLASS (src),
+      &n_pspecs);
+  for (i = 0; i < n_pspecs; i++) {
+    GParamSpec *pspec = pspecs[i];
+    GValue value = G_VALUE_INIT;
+
+    /* name and parent are handled by the caller */
+    if ((pspec->flags & G_PARAM_READWRITE) != G_PARAM_READWRITE ||
+        (pspec->flags & (G_PARAM_CONSTRUCT_ONLY | G_PARAM_DEPRECATED)) ||
+        pspec->owner_type == GST_TYPE_OBJECT)
+      continue;
+
+    g_value_init (&value, pspec->value_type);
+    g_object_get_property (G_OBJECT (src), pspec->name, &value);
+
+    /* elements can't be shared between the clones */
+    if (!g_param_value_defaults (pspec, &value) &&
+        !(G_VALUE_HOLDS_OBJECT (&value) &&
+            GST_IS_ELEMENT (g_value_get_object (&value)))) {
+      GST_LOG_OBJECT (dest, "copying property %s", pspec->name);
+      g_object_set_property (G_OBJECT (dest), pspec->name, &value);
+    }
+    g_value_unset (&value);
+  }
+  g_free (pspecs);
+}
+
+/* get the pad of @element that corresponds to the pad @orig of the cloned
+ * element, requesting it again when needed */
+static GstPad *
+gst_bin_clone_get_pad (GstElement * element, GstPad * orig)
+{
+  GstPadTemplate *templ;
+  GstPad *pad;
+
+  if ((pad = gst_element_get_static_pad (element, GST_PAD_NAME (orig))))
+    return pad;
+
+  templ = GST_PAD_PAD_TEMPLATE (orig);
+  if (templ && GST_PAD_TEMPLATE_PRESENCE (templ) == GST_PAD_REQUEST) {
+    templ = gst_element_class_get_pad_template (GST_ELEMENT_GET_CLASS (element),
+        GST_PAD_TEMPLATE_NAME_TEMPLATE (templ));
+    if (templ)
+      pad = gst_element_request_pad (element, templ, GST_PAD_NAME (orig),
+          NULL);
+  }
+  return pad;
+}
+
+static GList *
+gst_bin_clone_copy_pads (GstElement * element, gboolean src_only)
+{
+  GList *pads;
+
+  GST_OBJECT_LOCK (element);
+  pads = g_list_copy_deep (src_only ? element->srcpads : element->pads,
+      (GCopyFunc) gst_object_ref, NULL);
+  GST_OBJECT_UNLOCK (element);
+
+  return pads;
+}
+
+/* link @pad of @copy like the original @pad is linked, if its peer was
+ * cloned into @map */
+static gboolean
+gst_bin_clone_link (GstPad * pad, GstElement * copy, GHashTable * map)
+{
+  GstPad *peer, *src = NULL, *sink = NULL;
+  GstElement *peer_parent, *peer_copy;
+  gboolean res = TRUE;
+
+  if (!(peer = gst_pad_get_peer (pad)))
+    return TRUE;
+
+  peer_parent = gst_pad_get_parent_element (peer);
+  if (peer_parent && (peer_copy = g_hash_table_lookup (map, peer_parent))) {
+    src = gst_bin_clone_get_pad (copy, pad);
+    sink = gst_bin_clone_get_pad (peer_copy, peer);
+
+    if (!src || !sink || GST_PAD_LINK_FAILED (gst_pad_link (src, sink))) {
+      GST_WARNING_OBJECT (copy, "could not link %s:%s to %s:%s",
+          GST_DEBUG_PAD_NAME (pad), GST_DEBUG_PAD_NAME (peer));
+      res = FALSE;
+    }
+  }
+
+  if (src)
+    gst_object_unref (src);
+  if (sink)
+    gst_object_unref (sink);
+  if (peer_parent)
+    gst_object_unref (peer_parent);
+  gst_object_unref (peer);
+
+  return res;
+}
+
+static GstElement *gst_bin_clone_element (GstElement * element,
+    const gchar * name);
+
+/* clone the children of @bin into @copy, link them the same way and ghost
+ * the same pads */
+static gboolean
+gst_bin_clone_children (GstBin * bin, GstBin * copy)
+{
+  GHashTable *map;
+  GList *children, *walk, *pads, *l;
+  gboolean res = TRUE;
+
+  GST_OBJECT_LOCK (bin);
+  children = g_list_copy_deep (bin->children, (GCopyFunc) gst_object_ref,
+      NULL);
+  GST_OBJECT_UNLOCK (bin);
+  /* add the children in the order they were added to the original */
+  children = g_list_reverse (children);
+
+  /* original child -> copy, the copies are owned by the new bin */
+  map = g_hash_table_new (NULL, NULL);
+
+  for (walk = children; walk && res; walk = walk->next) {
+    GstElement *child = walk->data, *child_copy;
+
+    child_copy = gst_bin_clone_element (child, GST_OBJECT_NAME (child));
+    if (child_copy == NULL) {
+      res = FALSE;
+    } else if (!gst_bin_add (copy, child_copy)) {
+      gst_object_unref (child_copy);
+      res = FALSE;
+    } else {
+      g_hash_table_insert (map, child, child_copy);
+    }
+  }
+
+  /* links between the children */
+  for (walk = children; walk && res; walk = walk->next) {
+    GstElement *child = walk->data;
+
+    pads = gst_bin_clone_copy_pads (child, TRUE);
+    for (l = pads; l && res; l = l->next)
+      res = gst_bin_clone_link (l->data, g_hash_table_lookup (map, child), map);
+    g_list_free_full (pads, gst_object_unref);
+  }
+
+  /* ghost pads, the subclass might have made them already */
+  pads = gst_bin_clone_copy_pads (GST_ELEMENT_CAST (bin), FALSE);
+  for (l = pads; l && res; l = l->next) {
+    GstPad *pad = l->data, *ghost, *existing, *target, *target_copy = NULL;
+    GstElement *target_parent = NULL, *parent_copy;
+
+    if (!GST_IS_GHOST_PAD (pad))
+      continue;
+
+    if ((existing = gst_element_get_static_pad (GST_ELEMENT_CAST (copy),
+                GST_PAD_NAME (pad)))) {
+      gst_object_unref (existing);
+      continue;
+    }
+
+    if ((target = gst_ghost_pad_get_target (GST_GHOST_PAD_CAST (pad)))) {
+      target_parent = gst_pad_get_parent_element (target);
+      if (target_parent
+          && (parent_copy = g_hash_table_lookup (map, target_parent)))
+        target_copy = gst_bin_clone_get_pad (parent_copy, target);
+    }
+
+    if (target_copy) {
+      ghost = gst_ghost_pad_new (GST_PAD_NAME (pad), target_copy);
+    } else if (GST_PAD_PAD_TEMPLATE (pad)) {
+      ghost = gst_ghost_pad_new_no_target_from_template (GST_PAD_NAME (pad),
+          GST_PAD_PAD_TEMPLATE (pad));
+    } else {
+      ghost = gst_ghost_pad_new_no_target (GST_PAD_NAME (pad),
+          GST_PAD_DIRECTION (pad));
+    }
+
+    if (ghost == NULL || !gst_element_add_pad (GST_ELEMENT_CAST (copy), ghost)) {
+      GST_WARNING_OBJECT (copy, "could not ghost pad %s", GST_PAD_NAME (pad));
+      res = FALSE;
+    }
+
+    if (target_copy)
+      gst_object_unref (target_copy);
+    if (target_parent)
+      gst_object_unref (target_parent);
+    if (target)
+      gst_object_unref (target);
+  }
+  g_list_free_full (pads, gst_object_unref);
+
+  g_hash_table_destroy (map);
+  g_list_free_full (children, gst_object_unref);
+
+  return res;
+}
+
+static GstElement *
+gst_bin_clone_element (GstElement * element, const gchar * name)
+{
+  GstElementFactory *factory;
+  GstElement *copy;
+  gboolean empty;
+
+  if (!(factory = gst_element_get_factory (element)))
+    goto no_factory;
+
+  if (!(copy = gst_element_factory_create (factory, name)))
+    goto create_failed;
+
+  gst_bin_clone_properties (element, copy);
+  gst_element_set_locked_state (copy, gst_element_is_locked_state (element));
+
+  /* bins that make their own children, like decodebin, only need their
+   * properties */
+  if (GST_IS_BIN (element)) {
+    GST_OBJECT_LOCK (copy);
+    empty = (GST_BIN_CAST (copy)->numchildren == 0);
+    GST_OBJECT_UNLOCK (copy);
+
+    if (empty && !gst_bin_clone_children (GST_BIN_CAST (element),
+            GST_BIN_CAST (copy)))
+      goto children_failed;
+  }
+
+  return copy;
+
+  /* ERRORS */
+no_factory:
+  {
+    GST_WARNING_OBJECT (element, "element has no factory, can't clone it");
+    return NULL;
+  }
+create_failed:
+  {
+    GST_WARNING_OBJECT (element, "could not create a new %s",
+        GST_OBJECT_NAME (factory));
+    return NULL;
+  }
+children_failed:
+  {
+    GST_WARNING_OBJECT (element, "could not clone the children");
+    gst_object_unref (copy);
+    return NULL;
+  }
+}
+
+/**
+ * gst_bin_clone:
+ * @bin: a #GstBin
+ * @name: (allow-none): the name of the new bin, or %NULL to get a unique
+ *     name
+ *
+ * Creates a new bin that is structurally identical to @bin. All children
+ * are created again from the same factories, recursively, and get the same
+ * names and the same values for all properties that can be set and are not
+ * at their default value. Children are linked as in @bin, request pads are
+ * requested again and ghost pads of @bin and its child bins are recreated.
+ *
+ * Properties holding elements are not copied, and neither are links to
+ * sometimes pads that don't exist yet. Bins that create their own children,
+ * like decodebin, only get their properties copied.
+ *
+ * The new bin is in the NULL state and not linked to anything.
+ *
+ * Returns: (transfer floating) (nullable): a new #GstBin, or %NULL if some
+ *     element could not be cloned.
+ *
+ * Since: 1.10
+ */
+GstElement *
+gst_bin_clone (GstBin * bin, const gchar * name)
+{
+  g_return_val_if_fail (GST_IS_BIN (bin), NULL);
+
+  return gst_bin_clone_element (GST_ELEMENT_CAST (bin), name);
+}
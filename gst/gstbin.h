@@ -146,7 +146,9 @@ struct _GstBin {
  *
  * The @handle_message method can be overridden to implement custom
  * message handling.  @handle_message takes ownership of the message, just like
- * #gst_element_post_message.
+ * #gst_element_post_message. Subclasses that only act on some message types
+ * should declare them with gst_bin_class_set_handled_messages() so that
+ * other messages of their children can bypass them.
  */
 struct _GstBinClass {
   GstElementClass parent_class;
@@ -170,11 +172,20 @@ struct _GstBinClass {
   gboolean	(*do_latency)           (GstBin *bin);
 
   /*< private >*/
-  gpointer _gst_reserved[GST_PADDING];
+  /* set with gst_bin_class_set_handled_messages(), only valid while
+   * handle_message is handled_messages_func */
+  GstMessageType handled_messages;
+  gpointer       handled_messages_func;
+
+  gpointer _gst_reserved[GST_PADDING - 2];
 };
 
 GType		gst_bin_get_type		(void);
+
+void            gst_bin_class_set_handled_messages (GstBinClass *klass,
+                                                    GstMessageType types);
 GstElement*	gst_bin_new			(const gchar *name);
+GstElement*	gst_bin_clone			(GstBin *bin, const gchar *name);
 
 /* add and remove elements from the bin */
 gboolean	gst_bin_add			(GstBin *bin, GstElement *element);
@@ -187,6 +198,7 @@ GstElement*	gst_bin_get_by_interface	 (GstBin *bin, GType iface);
 
 /* retrieve multiple children */
 GstIterator*    gst_bin_iterate_elements	 (GstBin *bin);
+GstIterator*    gst_bin_iterate_elements_snapshot (GstBin *bin);
 GstIterator*    gst_bin_iterate_sorted		 (GstBin *bin);
 GstIterator*    gst_bin_iterate_recurse		 (GstBin *bin);
 
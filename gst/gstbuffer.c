@@ -141,14 +141,25 @@ struct _GstMetaItem
 };
 #define ITEM_SIZE(info) ((info)->size + sizeof (GstMetaItem))
 
+/* bytes inside the buffer struct used for the first metadata items */
+#define GST_BUFFER_META_AREA_SIZE  192
+#define GST_BUFFER_META_ALIGN      (2 * sizeof (gsize))
+
 #define GST_BUFFER_MEM_MAX         16
+/* first size of the memory array when it grows past GST_BUFFER_MEM_MAX */
+#define GST_BUFFER_MEM_GROW        32
 
 #define GST_BUFFER_SLICE_SIZE(b)   (((GstBufferImpl *)(b))->slice_size)
 #define GST_BUFFER_MEM_LEN(b)      (((GstBufferImpl *)(b))->len)
 #define GST_BUFFER_MEM_ARRAY(b)    (((GstBufferImpl *)(b))->mem)
+#define GST_BUFFER_MEM_ALLOC(b)    (((GstBufferImpl *)(b))->mem_alloc)
+#define GST_BUFFER_MEM_INLINE(b)   (((GstBufferImpl *)(b))->mem_inline)
 #define GST_BUFFER_MEM_PTR(b,i)    (((GstBufferImpl *)(b))->mem[i])
 #define GST_BUFFER_BUFMEM(b)       (((GstBufferImpl *)(b))->bufmem)
 #define GST_BUFFER_META(b)         (((GstBufferImpl *)(b))->item)
+#define GST_BUFFER_META_MASK(b)    (((GstBufferImpl *)(b))->meta_mask)
+#define GST_BUFFER_META_USED(b)    (((GstBufferImpl *)(b))->meta_used)
+#define GST_BUFFER_META_AREA(b)    ((guint8 *) ((GstBufferImpl *)(b))->meta_area)
 
 typedef struct
 {
@@ -156,18 +167,30 @@ typedef struct
 
   gsize slice_size;
 
-  /* the memory blocks */
+  /* the memory blocks, mem points to mem_inline unless the array was grown
+   * for a buffer with GST_BUFFER_FLAG_NO_MERGE */
   guint len;
-  GstMemory *mem[GST_BUFFER_MEM_MAX];
+  guint mem_alloc;
+  GstMemory **mem;
+  GstMemory *mem_inline[GST_BUFFER_MEM_MAX];
 
   /* memory of the buffer when allocated from 1 chunk */
   GstMemory *bufmem;
 
-  /* FIXME, make metadata allocation more efficient by using part of the
-   * GstBufferImpl */
   GstMetaItem *item;
+
+  /* bit n is set when a meta of the API with index n is on the buffer */
+  guint64 meta_mask;
+
+  /* metadata items are allocated from meta_area while they fit, the area
+   * is reused once all metadata is removed */
+  gsize meta_used;
+  guint64 meta_area[GST_BUFFER_META_AREA_SIZE / sizeof (guint64)];
 } GstBufferImpl;
 
+/* number of times memory was merged because the memory array was full */
+static volatile gint _gst_buffer_merge_count = 0;
+
 
 static gboolean
 _is_span (GstMemory ** mem, gsize len, gsize * poffset, GstMemory ** parent)
@@ -334,6 +357,32 @@ _memory_get_exclusive_reference (GstMemory * mem)
   return ret;
 }
 
+/* make the memory array hold twice as many memory blocks. The grown arrays
+ * come from the slice allocator so that buffers that keep many memory blocks
+ * recycle them instead of calling malloc for each buffer. */
+static void
+_memory_array_grow (GstBuffer * buffer)
+{
+  guint len = GST_BUFFER_MEM_LEN (buffer);
+  guint alloc = GST_BUFFER_MEM_ALLOC (buffer);
+  GstMemory **mem;
+
+  alloc = MAX (alloc * 2, GST_BUFFER_MEM_GROW);
+
+  GST_CAT_DEBUG (GST_CAT_BUFFER, "buffer %p, growing memory array to %u",
+      buffer, alloc);
+
+  mem = g_slice_alloc (alloc * sizeof (GstMemory *));
+  memcpy (mem, GST_BUFFER_MEM_ARRAY (buffer), len * sizeof (GstMemory *));
+
+  if (GST_BUFFER_MEM_ARRAY (buffer) != GST_BUFFER_MEM_INLINE (buffer))
+    g_slice_free1 (GST_BUFFER_MEM_ALLOC (buffer) * sizeof (GstMemory *),
+        GST_BUFFER_MEM_ARRAY (buffer));
+
+  GST_BUFFER_MEM_ARRAY (buffer) = mem;
+  GST_BUFFER_MEM_ALLOC (buffer) = alloc;
+}
+
 static inline void
 _memory_add (GstBuffer * buffer, gint idx, GstMemory * mem)
 {
@@ -341,13 +390,17 @@ _memory_add (GstBuffer * buffer, gint idx, GstMemory * mem)
 
   GST_CAT_LOG (GST_CAT_BUFFER, "buffer %p, idx %d, mem %p", buffer, idx, mem);
 
-  if (G_UNLIKELY (len >= GST_BUFFER_MEM_MAX)) {
+  if (G_UNLIKELY (len >= GST_BUFFER_MEM_ALLOC (buffer)) &&
+      GST_BUFFER_FLAG_IS_SET (buffer, GST_BUFFER_FLAG_NO_MERGE)) {
+    _memory_array_grow (buffer);
+  } else if (G_UNLIKELY (len >= GST_BUFFER_MEM_MAX)) {
     /* too many buffer, span them. */
     /* FIXME, there is room for improvement here: We could only try to merge
      * 2 buffers to make some room. If we can't efficiently merge 2 buffers we
      * could try to only merge the two smallest buffers to avoid memcpy, etc. */
     GST_CAT_DEBUG (GST_CAT_PERFORMANCE, "memory array overflow in buffer %p",
         buffer);
+    g_atomic_int_inc (&_gst_buffer_merge_count);
     _replace_memory (buffer, len, 0, len, _get_merged_memory (buffer, 0, len));
     /* we now have 1 single spanned buffer */
     len = 1;
@@ -367,6 +420,71 @@ _memory_add (GstBuffer * buffer, gint idx, GstMemory * mem)
   GST_BUFFER_FLAG_SET (buffer, GST_BUFFER_FLAG_TAG_MEMORY);
 }
 
+static inline gboolean
+_meta_item_is_inline (GstBuffer * buffer, GstMetaItem * item)
+{
+  guint8 *area = GST_BUFFER_META_AREA (buffer);
+
+  return (guint8 *) item >= area &&
+      (guint8 *) item < area + GST_BUFFER_META_AREA_SIZE;
+}
+
+/* allocate a metadata item, from the buffer struct when there is room */
+static GstMetaItem *
+_meta_item_alloc (GstBuffer * buffer, gsize size)
+{
+  guint8 *area = GST_BUFFER_META_AREA (buffer);
+  gsize offset, align;
+
+  /* align the absolute address, the struct itself is not aligned to
+   * GST_BUFFER_META_ALIGN */
+  offset = GST_BUFFER_META_USED (buffer);
+  align = ((gsize) (area + offset)) & (GST_BUFFER_META_ALIGN - 1);
+  if (align)
+    offset += GST_BUFFER_META_ALIGN - align;
+
+  if (offset + size > GST_BUFFER_META_AREA_SIZE)
+    return g_slice_alloc (size);
+
+  GST_BUFFER_META_USED (buffer) = offset + size;
+
+  return (GstMetaItem *) (area + offset);
+}
+
+/* free a metadata item that was removed from the list of metadata */
+static void
+_meta_item_free (GstBuffer * buffer, GstMetaItem * item, gsize size)
+{
+  if (!_meta_item_is_inline (buffer, item)) {
+    g_slice_free1 (size, item);
+  } else if ((guint8 *) item + size ==
+      GST_BUFFER_META_AREA (buffer) + GST_BUFFER_META_USED (buffer)) {
+    /* last allocated item, give back its room */
+    GST_BUFFER_META_USED (buffer) =
+        (guint8 *) item - GST_BUFFER_META_AREA (buffer);
+  }
+
+  /* all room is free when the last item is gone */
+  if (GST_BUFFER_META (buffer) == NULL)
+    GST_BUFFER_META_USED (buffer) = 0;
+}
+
+/* recalculate the bitmap of APIs after metadata was removed */
+static void
+_meta_update_mask (GstBuffer * buffer)
+{
+  GstMetaItem *walk;
+  guint64 mask = 0;
+
+  for (walk = GST_BUFFER_META (buffer); walk; walk = walk->next) {
+    gint idx = _priv_gst_meta_api_type_get_index (walk->meta.info->api);
+
+    if (idx >= 0)
+      mask |= G_GUINT64_CONSTANT (1) << idx;
+  }
+  GST_BUFFER_META_MASK (buffer) = mask;
+}
+
 GST_DEFINE_MINI_OBJECT_TYPE (GstBuffer, gst_buffer);
 
 void
@@ -382,7 +500,8 @@ _priv_gst_buffer_initialize (void)
  * compile time constant that can be queried with the function.
  *
  * When more memory blocks are added, existing memory blocks will be merged
- * together to make room for the new block.
+ * together to make room for the new block, unless the buffer has the
+ * %GST_BUFFER_FLAG_NO_MERGE flag set.
  *
  * Returns: the maximum amount of memory blocks that a buffer can hold.
  *
@@ -394,6 +513,26 @@ gst_buffer_get_max_memory (void)
   return GST_BUFFER_MEM_MAX;
 }
 
+/**
+ * gst_buffer_get_merge_count:
+ *
+ * Get the number of times the memory blocks of a buffer were merged because
+ * more than gst_buffer_get_max_memory() blocks were added to it. Each merge
+ * copies the contents of all the memory blocks of the buffer.
+ *
+ * This counter is global to the process and is useful to check if a pipeline
+ * should use %GST_BUFFER_FLAG_NO_MERGE to stay zero-copy.
+ *
+ * Returns: the number of memory merges since the library was initialized.
+ *
+ * Since: 1.10
+ */
+guint
+gst_buffer_get_merge_count (void)
+{
+  return (guint) g_atomic_int_get (&_gst_buffer_merge_count);
+}
+
 /**
  * gst_buffer_copy_into:
  * @dest: a destination #GstBuffer
@@ -662,8 +801,9 @@ _gst_buffer_free (GstBuffer * buffer)
       info->free_func (meta, buffer);
 
     next = walk->next;
-    /* and free the slice */
-    g_slice_free1 (ITEM_SIZE (info), walk);
+    /* and free the slice, items in the buffer struct go away with it */
+    if (!_meta_item_is_inline (buffer, walk))
+      g_slice_free1 (ITEM_SIZE (info), walk);
   }
 
   /* get the size, when unreffing the memory, we could also unref the buffer
@@ -676,13 +816,20 @@ _gst_buffer_free (GstBuffer * buffer)
     gst_memory_unlock (GST_BUFFER_MEM_PTR (buffer, i), GST_LOCK_FLAG_EXCLUSIVE);
     gst_memory_unref (GST_BUFFER_MEM_PTR (buffer, i));
   }
+  if (GST_BUFFER_MEM_ARRAY (buffer) != GST_BUFFER_MEM_INLINE (buffer))
+    g_slice_free1 (GST_BUFFER_MEM_ALLOC (buffer) * sizeof (GstMemory *),
+        GST_BUFFER_MEM_ARRAY (buffer));
 
   /* we set msize to 0 when the buffer is part of the memory block */
   if (msize) {
 #ifdef USE_POISONING
     memset (buffer, 0xff, msize);
 #endif
-    g_slice_free1 (msize, buffer);
+    if (msize == sizeof (GstBufferImpl))
+      _priv_gst_mini_object_cache_free (GST_MINI_OBJECT_CACHE_BUFFER, msize,
+          buffer);
+    else
+      g_slice_free1 (msize, buffer);
   } else {
     gst_memory_unref (GST_BUFFER_BUFMEM (buffer));
   }
@@ -706,7 +853,11 @@ gst_buffer_init (GstBufferImpl * buffer, gsize size)
   GST_BUFFER_OFFSET_END (buffer) = GST_BUFFER_OFFSET_NONE;
 
   GST_BUFFER_MEM_LEN (buffer) = 0;
+  GST_BUFFER_MEM_ALLOC (buffer) = GST_BUFFER_MEM_MAX;
+  GST_BUFFER_MEM_ARRAY (buffer) = GST_BUFFER_MEM_INLINE (buffer);
   GST_BUFFER_META (buffer) = NULL;
+  GST_BUFFER_META_MASK (buffer) = 0;
+  GST_BUFFER_META_USED (buffer) = 0;
 }
 
 /**
@@ -723,7 +874,8 @@ gst_buffer_new (void)
 {
   GstBufferImpl *newbuf;
 
-  newbuf = g_slice_new (GstBufferImpl);
+  newbuf = _priv_gst_mini_object_cache_alloc (GST_MINI_OBJECT_CACHE_BUFFER,
+      sizeof (GstBufferImpl));
   GST_CAT_LOG (GST_CAT_BUFFER, "new %p", newbuf);
 
   gst_buffer_init (newbuf, sizeof (GstBufferImpl));
@@ -900,7 +1052,8 @@ gst_buffer_new_wrapped (gpointer data, gsize size)
  * @buffer: a #GstBuffer.
  *
  * Get the amount of memory blocks that this buffer has. This amount is never
- * larger than what gst_buffer_get_max_memory() returns.
+ * larger than what gst_buffer_get_max_memory() returns, unless the buffer has
+ * the %GST_BUFFER_FLAG_NO_MERGE flag set.
  *
  * Returns: (transfer full): the amount of memory block in this buffer.
  */
@@ -957,7 +1110,8 @@ gst_buffer_append_memory (GstBuffer * buffer, GstMemory * mem)
  *
  * Only gst_buffer_get_max_memory() can be added to a buffer. If more memory is
  * added, existing memory blocks will automatically be merged to make room for
- * the new memory.
+ * the new memory. Buffers with %GST_BUFFER_FLAG_NO_MERGE set grow their
+ * memory array instead.
  */
 void
 gst_buffer_insert_memory (GstBuffer * buffer, gint idx, GstMemory * mem)
@@ -1577,6 +1731,99 @@ gst_buffer_resize_range (GstBuffer * buffer, guint idx, gint length,
   return TRUE;
 }
 
+/**
+ * gst_buffer_prepend_headroom:
+ * @buffer: a writable #GstBuffer.
+ * @size: the number of bytes to prepend
+ *
+ * Grow the first memory of @buffer by @size bytes at the front, using the
+ * prefix that was reserved when the memory was allocated (see the prefix
+ * field of #GstAllocationParams). The contents of the new bytes are
+ * undefined; the caller is expected to map @buffer and write a header into
+ * them.
+ *
+ * This only succeeds when the first memory is writable, which means it is
+ * not shared with other buffers, and has at least @size bytes of unused
+ * prefix. On failure @buffer is left untouched and the caller should fall
+ * back to gst_buffer_prepend_memory().
+ *
+ * Returns: %TRUE if @buffer was grown by @size bytes.
+ *
+ * Since: 1.10
+ */
+gboolean
+gst_buffer_prepend_headroom (GstBuffer * buffer, gsize size)
+{
+  GstMemory *mem;
+  gsize offset;
+
+  g_return_val_if_fail (gst_buffer_is_writable (buffer), FALSE);
+
+  if (size == 0)
+    return TRUE;
+
+  if (GST_BUFFER_MEM_LEN (buffer) == 0)
+    return FALSE;
+
+  mem = GST_BUFFER_MEM_PTR (buffer, 0);
+  gst_memory_get_sizes (mem, &offset, NULL);
+  if (offset < size || !gst_memory_is_writable (mem))
+    return FALSE;
+
+  GST_CAT_LOG (GST_CAT_BUFFER, "buffer %p, prepend %" G_GSIZE_FORMAT
+      " bytes of headroom", buffer, size);
+
+  gst_memory_resize (mem, -(gssize) size, mem->size + size);
+
+  return TRUE;
+}
+
+/**
+ * gst_buffer_append_tailroom:
+ * @buffer: a writable #GstBuffer.
+ * @size: the number of bytes to append
+ *
+ * Grow the last memory of @buffer by @size bytes at the end, using the
+ * padding that was reserved when the memory was allocated. The contents of
+ * the new bytes are undefined.
+ *
+ * This only succeeds when the last memory is writable and has at least
+ * @size bytes of unused padding. On failure @buffer is left untouched and
+ * the caller should fall back to gst_buffer_append_memory().
+ *
+ * Returns: %TRUE if @buffer was grown by @size bytes.
+ *
+ * Since: 1.10
+ */
+gboolean
+gst_buffer_append_tailroom (GstBuffer * buffer, gsize size)
+{
+  GstMemory *mem;
+  gsize offset, maxsize, msize;
+  guint len;
+
+  g_return_val_if_fail (gst_buffer_is_writable (buffer), FALSE);
+
+  if (size == 0)
+    return TRUE;
+
+  len = GST_BUFFER_MEM_LEN (buffer);
+  if (len == 0)
+    return FALSE;
+
+  mem = GST_BUFFER_MEM_PTR (buffer, len - 1);
+  msize = gst_memory_get_sizes (mem, &offset, &maxsize);
+  if (maxsize - offset - msize < size || !gst_memory_is_writable (mem))
+    return FALSE;
+
+  GST_CAT_LOG (GST_CAT_BUFFER, "buffer %p, append %" G_GSIZE_FORMAT
+      " bytes of tailroom", buffer, size);
+
+  gst_memory_resize (mem, 0, msize + size);
+
+  return TRUE;
+}
+
 /**
  * gst_buffer_map:
  * @buffer: a #GstBuffer.
@@ -1726,6 +1973,87 @@ gst_buffer_unmap (GstBuffer * buffer, GstMapInfo * info)
   }
 }
 
+/**
+ * gst_buffer_map_memories:
+ * @buffer: a #GstBuffer.
+ * @infos: (out caller-allocates) (array length=n_infos): info about the
+ *     mapping of each memory
+ * @n_infos: the number of elements in @infos
+ *
+ * Maps every memory of @buffer for reading, without merging them. The
+ * mapping of memory @i is stored in @infos[@i], the elements after the last
+ * memory are cleared. @n_infos must be at least gst_buffer_n_memory().
+ *
+ * This is cheaper than calling gst_buffer_map_range() for each memory: the
+ * memories are not reffed, and readonly system memory is mapped without
+ * touching its lock state. @buffer must therefore not be modified while
+ * its memories are mapped.
+ *
+ * The memories should be unmapped with gst_buffer_unmap_memories() after
+ * usage.
+ *
+ * Returns: %TRUE if all memories were mapped. On failure nothing stays
+ * mapped.
+ *
+ * Since: 1.10
+ */
+gboolean
+gst_buffer_map_memories (GstBuffer * buffer, GstMapInfo * infos, guint n_infos)
+{
+  guint i, len;
+
+  g_return_val_if_fail (GST_IS_BUFFER (buffer), FALSE);
+  g_return_val_if_fail (infos != NULL, FALSE);
+  len = GST_BUFFER_MEM_LEN (buffer);
+  g_return_val_if_fail (n_infos >= len, FALSE);
+
+  for (i = 0; i < len; i++) {
+    if (G_UNLIKELY (!gst_memory_map (GST_BUFFER_MEM_PTR (buffer, i),
+                &infos[i], GST_MAP_READ)))
+      goto cannot_map;
+  }
+  if (n_infos > len)
+    memset (&infos[len], 0, (n_infos - len) * sizeof (GstMapInfo));
+
+  return TRUE;
+
+  /* ERRORS */
+cannot_map:
+  {
+    GST_DEBUG_OBJECT (buffer, "cannot map memory %u", i);
+    while (i > 0) {
+      i--;
+      gst_memory_unmap (infos[i].memory, &infos[i]);
+    }
+    memset (infos, 0, n_infos * sizeof (GstMapInfo));
+    return FALSE;
+  }
+}
+
+/**
+ * gst_buffer_unmap_memories:
+ * @buffer: a #GstBuffer.
+ * @infos: (array length=n_infos): the mappings from
+ *     gst_buffer_map_memories()
+ * @n_infos: the number of elements in @infos
+ *
+ * Releases the memories mapped with gst_buffer_map_memories().
+ *
+ * Since: 1.10
+ */
+void
+gst_buffer_unmap_memories (GstBuffer * buffer, GstMapInfo * infos,
+    guint n_infos)
+{
+  guint i;
+
+  g_return_if_fail (GST_IS_BUFFER (buffer));
+  g_return_if_fail (infos != NULL);
+
+  for (i = 0; i < n_infos && infos[i].memory; i++)
+    gst_memory_unmap (infos[i].memory, &infos[i]);
+}
+
 /**
  * gst_buffer_fill:
  * @buffer: a #GstBuffer.
@@ -2052,10 +2380,18 @@ gst_buffer_get_meta (GstBuffer * buffer, GType api)
 {
   GstMetaItem *item;
   GstMeta *result = NULL;
+  gint idx;
 
   g_return_val_if_fail (buffer != NULL, NULL);
   g_return_val_if_fail (api != 0, NULL);
 
+  /* APIs with an index tell without walking the list when no such metadata
+   * is on the buffer */
+  idx = _priv_gst_meta_api_type_get_index (api);
+  if (idx >= 0 &&
+      !(GST_BUFFER_META_MASK (buffer) & (G_GUINT64_CONSTANT (1) << idx)))
+    return NULL;
+
   /* find GstMeta of the requested API */
   for (item = GST_BUFFER_META (buffer); item; item = item->next) {
     GstMeta *meta = &item->meta;
@@ -2084,14 +2420,15 @@ gst_buffer_add_meta (GstBuffer * buffer, const GstMetaInfo * info,
   GstMetaItem *item;
   GstMeta *result = NULL;
   gsize size;
+  gint idx;
 
   g_return_val_if_fail (buffer != NULL, NULL);
   g_return_val_if_fail (info != NULL, NULL);
   g_return_val_if_fail (gst_buffer_is_writable (buffer), NULL);
 
-  /* create a new slice */
+  /* create a new item */
   size = ITEM_SIZE (info);
-  item = g_slice_alloc (size);
+  item = _meta_item_alloc (buffer, size);
   result = &item->meta;
   result->info = info;
   result->flags = GST_META_FLAG_NONE;
@@ -2109,11 +2446,15 @@ gst_buffer_add_meta (GstBuffer * buffer, const GstMetaInfo * info,
   item->next = GST_BUFFER_META (buffer);
   GST_BUFFER_META (buffer) = item;
 
+  idx = _priv_gst_meta_api_type_get_index (info->api);
+  if (idx >= 0)
+    GST_BUFFER_META_MASK (buffer) |= G_GUINT64_CONSTANT (1) << idx;
+
   return result;
 
 init_failed:
   {
-    g_slice_free1 (size, item);
+    _meta_item_free (buffer, item, size);
     return NULL;
   }
 }
@@ -2155,8 +2496,9 @@ gst_buffer_remove_meta (GstBuffer * buffer, GstMeta * meta)
       if (info->free_func)
         info->free_func (m, buffer);
 
-      /* and free the slice */
-      g_slice_free1 (ITEM_SIZE (info), walk);
+      /* and free the item */
+      _meta_item_free (buffer, walk, ITEM_SIZE (info));
+      _meta_update_mask (buffer);
       break;
     }
     prev = walk;
@@ -2218,7 +2560,7 @@ gst_buffer_foreach_meta (GstBuffer * buffer, GstBufferForeachMetaFunc func,
     gpointer user_data)
 {
   GstMetaItem *walk, *prev, *next;
-  gboolean res = TRUE;
+  gboolean res = TRUE, removed = FALSE;
 
   g_return_val_if_fail (buffer != NULL, FALSE);
   g_return_val_if_fail (func != NULL, FALSE);
@@ -2253,12 +2595,16 @@ gst_buffer_foreach_meta (GstBuffer * buffer, GstBufferForeachMetaFunc func,
       if (info->free_func)
         info->free_func (m, buffer);
 
-      /* and free the slice */
-      g_slice_free1 (ITEM_SIZE (info), walk);
+      /* and free the item */
+      _meta_item_free (buffer, walk, ITEM_SIZE (info));
+      removed = TRUE;
     }
     if (!res)
       break;
   }
+  if (removed)
+    _meta_update_mask (buffer);
+
   return res;
 }
 
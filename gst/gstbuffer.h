@@ -207,6 +207,9 @@ typedef struct _GstBufferPool GstBufferPool;
  * @GST_BUFFER_FLAG_SYNC_AFTER:  Elements which write to disk or permanent
  * 				 storage should ensure the data is synced after
  * 				 writing the contents of this buffer. (Since 1.6)
+ * @GST_BUFFER_FLAG_NO_MERGE:    the memory blocks of the buffer are never merged
+ *                               when more than gst_buffer_get_max_memory() blocks
+ *                               are added, the memory array grows instead. (Since 1.10)
  * @GST_BUFFER_FLAG_LAST:        additional media specific flags can be added starting from
  *                               this flag.
  *
@@ -225,6 +228,7 @@ typedef enum {
   GST_BUFFER_FLAG_DELTA_UNIT  = (GST_MINI_OBJECT_FLAG_LAST << 9),
   GST_BUFFER_FLAG_TAG_MEMORY  = (GST_MINI_OBJECT_FLAG_LAST << 10),
   GST_BUFFER_FLAG_SYNC_AFTER  = (GST_MINI_OBJECT_FLAG_LAST << 11),
+  GST_BUFFER_FLAG_NO_MERGE    = (GST_MINI_OBJECT_FLAG_LAST << 12),
 
   GST_BUFFER_FLAG_LAST        = (GST_MINI_OBJECT_FLAG_LAST << 16)
 } GstBufferFlags;
@@ -271,6 +275,7 @@ struct _GstBuffer {
 GType       gst_buffer_get_type            (void);
 
 guint       gst_buffer_get_max_memory      (void);
+guint       gst_buffer_get_merge_count     (void);
 
 /* allocation */
 GstBuffer * gst_buffer_new                 (void);
@@ -323,11 +328,19 @@ gsize       gst_buffer_get_size            (GstBuffer *buffer);
 void        gst_buffer_resize              (GstBuffer *buffer, gssize offset, gssize size);
 void        gst_buffer_set_size            (GstBuffer *buffer, gssize size);
 
+gboolean    gst_buffer_prepend_headroom    (GstBuffer *buffer, gsize size);
+gboolean    gst_buffer_append_tailroom     (GstBuffer *buffer, gsize size);
+
 gboolean    gst_buffer_map_range           (GstBuffer *buffer, guint idx, gint length,
                                             GstMapInfo *info, GstMapFlags flags);
 gboolean    gst_buffer_map                 (GstBuffer *buffer, GstMapInfo *info, GstMapFlags flags);
 
 void        gst_buffer_unmap               (GstBuffer *buffer, GstMapInfo *info);
+
+gboolean    gst_buffer_map_memories        (GstBuffer *buffer, GstMapInfo *infos,
+                                            guint n_infos);
+void        gst_buffer_unmap_memories      (GstBuffer *buffer, GstMapInfo *infos,
+                                            guint n_infos);
 void        gst_buffer_extract_dup         (GstBuffer *buffer, gsize offset,
                                             gsize size, gpointer *dest,
                                             gsize *dest_size);
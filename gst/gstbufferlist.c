@@ -34,6 +34,11 @@
  * Buffer lists can be pushed on a srcpad with gst_pad_push_list(). This is
  * interesting when multiple buffers need to be pushed in one go because it
  * can reduce the amount of overhead for pushing each buffer individually.
+ *
+ * The buffer pointers of small lists are stored inline with the list, and
+ * the structs of freed lists are recycled per thread. Producers that want
+ * to reuse the same list for every burst can empty it with
+ * gst_buffer_list_reset(), which keeps the allocated storage.
  */
 #include "gst_private.h"
 
@@ -110,7 +115,8 @@ _gst_buffer_list_free (GstBufferList * list)
   if (GST_BUFFER_LIST_IS_USING_DYNAMIC_ARRAY (list))
     g_free (list->buffers);
 
-  g_slice_free1 (list->slice_size, list);
+  _priv_gst_mini_object_cache_free (GST_MINI_OBJECT_CACHE_BUFFER_LIST,
+      list->slice_size, list);
 }
 
 static void
@@ -152,7 +158,10 @@ gst_buffer_list_new_sized (guint size)
 
   slice_size = sizeof (GstBufferList) + (n_allocated - 1) * sizeof (gpointer);
 
-  list = g_slice_alloc0 (slice_size);
+  /* lists of the common size come from the cache of the thread, all the
+   * fields are set by the init function */
+  list = _priv_gst_mini_object_cache_alloc (GST_MINI_OBJECT_CACHE_BUFFER_LIST,
+      slice_size);
 
   GST_LOG ("new %p", list);
 
@@ -345,6 +354,25 @@ gst_buffer_list_insert (GstBufferList * list, gint idx, GstBuffer * buffer)
   list->buffers[idx] = buffer;
 }
 
+/**
+ * gst_buffer_list_reset:
+ * @list: (transfer none): a #GstBufferList
+ *
+ * Remove and unref all buffers of @list. The storage that was allocated for
+ * the buffer pointers is kept, so that @list can be filled again with the
+ * same number of buffers without allocating.
+ *
+ * Since: 1.10
+ */
+void
+gst_buffer_list_reset (GstBufferList * list)
+{
+  g_return_if_fail (GST_IS_BUFFER_LIST (list));
+  g_return_if_fail (gst_buffer_list_is_writable (list));
+
+  gst_buffer_list_remove_range_internal (list, 0, list->n_buffers, TRUE);
+}
+
 /**
  * gst_buffer_list_remove:
  * @list: a #GstBufferList
@@ -142,6 +142,7 @@ guint                    gst_buffer_list_length                (GstBufferList *l
 GstBuffer *              gst_buffer_list_get                   (GstBufferList *list, guint idx);
 void                     gst_buffer_list_insert                (GstBufferList *list, gint idx, GstBuffer *buffer);
 void                     gst_buffer_list_remove                (GstBufferList *list, guint idx, guint length);
+void                     gst_buffer_list_reset                 (GstBufferList *list);
 
 gboolean                 gst_buffer_list_foreach               (GstBufferList *list,
                                                                 GstBufferListFunc func,
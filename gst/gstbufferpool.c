@@ -61,6 +61,37 @@
  *
  * Use gst_object_unref() to release the reference to a bufferpool. If the
  * refcount of the pool reaches 0, the pool will be freed.
+ *
+ * Pools that are shared between many streaming threads can be configured with
+ * a per-thread cache of free buffers with
+ * gst_buffer_pool_config_set_thread_cache_size(). Buffers released by a thread
+ * are then kept in a small cache that is used for the next acquire call of the
+ * same thread, so that most acquire/release pairs don't need to touch the
+ * shared queue of the pool.
+ *
+ * The memory a pool allocates can be accounted in a #GstMemoryBudget that is
+ * shared with other pools and queues, see
+ * gst_buffer_pool_config_set_memory_budget(). When the budget is exhausted
+ * the pool does not allocate more buffers but waits for its own buffers to
+ * be released, like when the maximum number of buffers is reached.
+ *
+ * A pool that is configured with gst_buffer_pool_config_set_trim_idle_time()
+ * frees the buffers that were not used during the idle time, down to the
+ * minimum number of buffers. This gives memory back after a bitrate spike or
+ * when the pipeline is idle. Latency sensitive pools can use
+ * gst_buffer_pool_config_set_prefault() and
+ * gst_buffer_pool_config_set_lock_memory() so that freshly allocated buffers
+ * don't page fault when they are first written.
+ *
+ * With gst_buffer_pool_config_set_reuse_memory(), a pool keeps the buffers
+ * it frees when it is deactivated and reuses them after it is configured
+ * again, as long as they are big enough for the new configuration. A pool
+ * can also be given a new configuration that only changes the caps while it
+ * is active, by default for #GstBufferPool itself.
+ *
+ * gst_buffer_pool_get_stats() returns how many buffers the pool allocated and
+ * freed, how much memory they use and how long the pool spent allocating
+ * them. This helps to choose the minimum and maximum number of buffers.
  */
 
 #include "gst_private.h"
@@ -71,11 +102,15 @@
 #  include <unistd.h>
 #endif
 #include <sys/types.h>
+#ifdef HAVE_MMAP
+#include <sys/mman.h>
+#endif
 
 #include "gstatomicqueue.h"
-#include "gstpoll.h"
 #include "gstinfo.h"
 #include "gstquark.h"
+#include "gstsystemclock.h"
+#include "gstutils.h"
 #include "gstvalue.h"
 
 #include "gstbufferpool.h"
@@ -89,10 +124,46 @@ GST_DEBUG_CATEGORY_STATIC (gst_buffer_pool_debug);
 #define GST_BUFFER_POOL_LOCK(pool)   (g_rec_mutex_lock(&pool->priv->rec_lock))
 #define GST_BUFFER_POOL_UNLOCK(pool) (g_rec_mutex_unlock(&pool->priv->rec_lock))
 
+/* maximum number of buffers in the cache of one thread */
+#define THREAD_CACHE_MAX_SIZE   64
+/* maximum number of thread cache slots, must be a power of 2 */
+#define THREAD_CACHE_MAX_SLOTS  64
+#define CACHE_LINE_SIZE         64
+/* number of times a thread that waits for a buffer checks the queue before
+ * it blocks, on machines with more than one CPU */
+#define WAIT_SPIN_COUNT         100
+
+/* a small stack of free buffers for the threads that map to this slot */
+typedef struct
+{
+  GMutex lock;
+  guint n_buffers;
+  GstBuffer **buffers;
+} GstBufferPoolCacheSlot;
+
+/* pad the slots so that two threads never share a cache line */
+typedef union
+{
+  GstBufferPoolCacheSlot slot;
+  guint8 padding[CACHE_LINE_SIZE];
+} GstBufferPoolPaddedSlot;
+
 struct _GstBufferPoolPrivate
 {
   GstAtomicQueue *queue;
-  GstPoll *poll;
+
+  /* for waiting for a free buffer or flushing. Releasing threads only take
+   * the lock when someone is waiting */
+  GMutex wait_lock;
+  GCond wait_cond;
+  gint waiting;
+
+  /* per-thread cache, NULL when disabled */
+  gpointer cache_mem;
+  GstBufferPoolPaddedSlot *cache;
+  guint cache_size;
+  guint cache_mask;
+  gint cache_waiting;           /* number of threads waiting for a buffer */
 
   GRecMutex rec_lock;
 
@@ -109,12 +180,48 @@ struct _GstBufferPoolPrivate
   guint cur_buffers;
   GstAllocator *allocator;
   GstAllocationParams params;
+
+  GstMemoryBudget *budget;
+  GstMemoryBudgetClient *budget_client;
+
+  /* protects stats */
+  GMutex stats_lock;
+  GstAllocationStats stats;
+
+  /* trimming of idle buffers, trim_low is the lowest number of buffers in
+   * the queue since the last trim */
+  GstClockTime trim_idle_time;
+  GstClockID trim_id;
+  gint trim_low;
+
+  gboolean prefault;
+  gboolean lock_memory;
+
+  /* buffers kept from the last activation for the next configuration,
+   * protected by the pool lock */
+  gboolean reuse_memory;
+  GList *spares;
+
+  /* GstBufferPoolReclaim items, protected by reclaim_lock */
+  GMutex reclaim_lock;
+  GSList *reclaims;
 };
 
+typedef struct
+{
+  GstBufferPoolReclaimFunc func;
+  gpointer user_data;
+} GstBufferPoolReclaim;
+
 static void gst_buffer_pool_finalize (GObject * object);
 
 G_DEFINE_TYPE (GstBufferPool, gst_buffer_pool, GST_TYPE_OBJECT);
 
+/* every thread gets a small index that selects its cache slot */
+static GPrivate thread_cache_index;
+static gint thread_cache_counter = 0;
+static guint wait_spin_count = 0;
+
 static gboolean default_start (GstBufferPool * pool);
 static gboolean default_stop (GstBufferPool * pool);
 static gboolean default_set_config (GstBufferPool * pool,
@@ -127,6 +234,8 @@ static void default_reset_buffer (GstBufferPool * pool, GstBuffer * buffer);
 static void default_free_buffer (GstBufferPool * pool, GstBuffer * buffer);
 static void default_release_buffer (GstBufferPool * pool, GstBuffer * buffer);
 
+static void thread_cache_free (GstBufferPool * pool);
+
 static void
 gst_buffer_pool_class_init (GstBufferPoolClass * klass)
 {
@@ -136,6 +245,10 @@ gst_buffer_pool_class_init (GstBufferPoolClass * klass)
 
   gobject_class->finalize = gst_buffer_pool_finalize;
 
+  /* spinning only helps when the releasing thread can run meanwhile */
+  if (g_get_num_processors () > 1)
+    wait_spin_count = WAIT_SPIN_COUNT;
+
   klass->start = default_start;
   klass->stop = default_stop;
   klass->set_config = default_set_config;
@@ -157,8 +270,11 @@ gst_buffer_pool_init (GstBufferPool * pool)
   priv = pool->priv = GST_BUFFER_POOL_GET_PRIVATE (pool);
 
   g_rec_mutex_init (&priv->rec_lock);
+  g_mutex_init (&priv->stats_lock);
+  g_mutex_init (&priv->wait_lock);
+  g_cond_init (&priv->wait_cond);
+  g_mutex_init (&priv->reclaim_lock);
 
-  priv->poll = gst_poll_new_timer ();
   priv->queue = gst_atomic_queue_new (16);
   pool->flushing = 1;
   priv->active = FALSE;
@@ -170,10 +286,6 @@ gst_buffer_pool_init (GstBufferPool * pool)
   gst_allocation_params_init (&priv->params);
   gst_buffer_pool_config_set_allocator (priv->config, priv->allocator,
       &priv->params);
-  /* 1 control write for flushing */
-  gst_poll_write_control (priv->poll);
-  /* 1 control write for marking that we are not waiting for poll */
-  gst_poll_write_control (priv->poll);
 
   GST_DEBUG_OBJECT (pool, "created");
 }
@@ -190,12 +302,22 @@ gst_buffer_pool_finalize (GObject * object)
   GST_DEBUG_OBJECT (pool, "finalize");
 
   gst_buffer_pool_set_active (pool, FALSE);
+  thread_cache_free (pool);
   gst_atomic_queue_unref (priv->queue);
-  gst_poll_free (priv->poll);
   gst_structure_free (priv->config);
   g_rec_mutex_clear (&priv->rec_lock);
+  g_mutex_clear (&priv->stats_lock);
+  g_mutex_clear (&priv->wait_lock);
+  g_cond_clear (&priv->wait_cond);
+  g_mutex_clear (&priv->reclaim_lock);
+  g_slist_free_full (priv->reclaims, g_free);
   if (priv->allocator)
     gst_object_unref (priv->allocator);
+  if (priv->budget) {
+    gst_memory_budget_remove_client (priv->budget, priv->budget_client);
+    gst_object_unref (priv->budget);
+  }
+  g_list_free_full (priv->spares, (GDestroyNotify) gst_buffer_unref);
 
   G_OBJECT_CLASS (gst_buffer_pool_parent_class)->finalize (object);
 }
@@ -218,12 +340,244 @@ gst_buffer_pool_new (void)
   return result;
 }
 
+static inline guint
+get_thread_cache_index (void)
+{
+  guint idx;
+
+  idx = GPOINTER_TO_UINT (g_private_get (&thread_cache_index));
+  if (G_UNLIKELY (idx == 0)) {
+    /* index 0 means unset, so start counting from 1 */
+    idx = g_atomic_int_add (&thread_cache_counter, 1) + 1;
+    g_private_set (&thread_cache_index, GUINT_TO_POINTER (idx));
+  }
+  return idx - 1;
+}
+
+static inline GstBufferPoolCacheSlot *
+get_thread_cache_slot (GstBufferPool * pool)
+{
+  GstBufferPoolPrivate *priv = pool->priv;
+
+  return &priv->cache[get_thread_cache_index () & priv->cache_mask].slot;
+}
+
+/* wake up the threads waiting for a buffer or for flushing. This has to be
+ * called after changing the queue or the flushing state, the waiting thread
+ * announces itself before checking them */
+static inline void
+wake_waiters (GstBufferPool * pool)
+{
+  GstBufferPoolPrivate *priv = pool->priv;
+
+  if (G_UNLIKELY (g_atomic_int_get (&priv->waiting) > 0)) {
+    g_mutex_lock (&priv->wait_lock);
+    g_cond_broadcast (&priv->wait_cond);
+    g_mutex_unlock (&priv->wait_lock);
+  }
+}
+
+/* wait until there are buffers in the queue or the pool is flushing */
+static void
+wait_for_buffer (GstBufferPool * pool)
+{
+  GstBufferPoolPrivate *priv = pool->priv;
+  guint i;
+
+  g_atomic_int_inc (&priv->waiting);
+
+  for (i = 0; i < wait_spin_count; i++) {
+    if (gst_atomic_queue_length (priv->queue) > 0
+        || GST_BUFFER_POOL_IS_FLUSHING (pool))
+      goto done;
+  }
+
+  g_mutex_lock (&priv->wait_lock);
+  while (gst_atomic_queue_length (priv->queue) == 0
+      && !GST_BUFFER_POOL_IS_FLUSHING (pool))
+    g_cond_wait (&priv->wait_cond, &priv->wait_lock);
+  g_mutex_unlock (&priv->wait_lock);
+
+done:
+  g_atomic_int_add (&priv->waiting, -1);
+}
+
+/* move the buffers in @slot to the shared queue until only @keep are left.
+ * must be called with the slot lock */
+static guint
+thread_cache_slot_flush (GstBufferPool * pool, GstBufferPoolCacheSlot * slot,
+    guint keep)
+{
+  GstBufferPoolPrivate *priv = pool->priv;
+  guint moved = 0;
+
+  while (slot->n_buffers > keep) {
+    GstBuffer *buffer = slot->buffers[--slot->n_buffers];
+
+    gst_atomic_queue_push (priv->queue, buffer);
+    moved++;
+  }
+  if (moved)
+    wake_waiters (pool);
+  return moved;
+}
+
+/* move all cached buffers of all threads to the shared queue, returns the
+ * number of buffers that were moved */
+static guint
+thread_cache_drain (GstBufferPool * pool)
+{
+  GstBufferPoolPrivate *priv = pool->priv;
+  guint i, moved = 0;
+
+  for (i = 0; i <= priv->cache_mask; i++) {
+    GstBufferPoolCacheSlot *slot = &priv->cache[i].slot;
+
+    g_mutex_lock (&slot->lock);
+    moved += thread_cache_slot_flush (pool, slot, 0);
+    g_mutex_unlock (&slot->lock);
+  }
+  if (moved)
+    GST_LOG_OBJECT (pool, "drained %u buffers from thread caches", moved);
+
+  return moved;
+}
+
+static GstBuffer *
+thread_cache_pop (GstBufferPool * pool)
+{
+  GstBufferPoolPrivate *priv = pool->priv;
+  GstBufferPoolCacheSlot *slot;
+  GstBuffer *buffer = NULL;
+
+  slot = get_thread_cache_slot (pool);
+
+  g_mutex_lock (&slot->lock);
+  if (slot->n_buffers == 0) {
+    guint refill = MAX (priv->cache_size / 2, 1);
+
+    /* take a batch of buffers from the shared queue */
+    while (slot->n_buffers < refill) {
+      if (!(buffer = gst_atomic_queue_pop (priv->queue)))
+        break;
+      slot->buffers[slot->n_buffers++] = buffer;
+    }
+  }
+  if (slot->n_buffers > 0) {
+    buffer = slot->buffers[--slot->n_buffers];
+
+    /* don't keep the others for ourselves when someone is waiting */
+    if (G_UNLIKELY (g_atomic_int_get (&priv->cache_waiting) > 0))
+      thread_cache_slot_flush (pool, slot, 0);
+  }
+  g_mutex_unlock (&slot->lock);
+
+  return buffer;
+}
+
+static void
+thread_cache_push (GstBufferPool * pool, GstBuffer * buffer)
+{
+  GstBufferPoolPrivate *priv = pool->priv;
+  GstBufferPoolCacheSlot *slot;
+
+  slot = get_thread_cache_slot (pool);
+
+  g_mutex_lock (&slot->lock);
+  /* when full, give half of the buffers back to the shared queue */
+  if (slot->n_buffers == priv->cache_size)
+    thread_cache_slot_flush (pool, slot, priv->cache_size / 2);
+
+  slot->buffers[slot->n_buffers++] = buffer;
+
+  /* we need to check this after adding the buffer, a waiting thread first
+   * increments the counter and then drains all caches */
+  if (G_UNLIKELY (g_atomic_int_get (&priv->cache_waiting) > 0))
+    thread_cache_slot_flush (pool, slot, 0);
+  g_mutex_unlock (&slot->lock);
+}
+
+/* must be called when there are no buffers in the caches */
+static void
+thread_cache_free (GstBufferPool * pool)
+{
+  GstBufferPoolPrivate *priv = pool->priv;
+  guint i;
+
+  if (priv->cache == NULL)
+    return;
+
+  for (i = 0; i <= priv->cache_mask; i++) {
+    GstBufferPoolCacheSlot *slot = &priv->cache[i].slot;
+
+    g_warn_if_fail (slot->n_buffers == 0);
+    g_mutex_clear (&slot->lock);
+    g_free (slot->buffers);
+  }
+  g_free (priv->cache_mem);
+  priv->cache_mem = NULL;
+  priv->cache = NULL;
+  priv->cache_size = 0;
+  priv->cache_mask = 0;
+}
+
+/* must be called with the lock */
+static void
+thread_cache_configure (GstBufferPool * pool, guint size)
+{
+  GstBufferPoolPrivate *priv = pool->priv;
+  guint i, n_slots;
+
+  size = MIN (size, THREAD_CACHE_MAX_SIZE);
+  if (priv->cache_size == size)
+    return;
+
+  thread_cache_free (pool);
+  if (size == 0)
+    return;
+
+  /* one slot per CPU, rounded up to a power of 2 */
+  n_slots = 1;
+  while (n_slots < g_get_num_processors () && n_slots < THREAD_CACHE_MAX_SLOTS)
+    n_slots <<= 1;
+
+  priv->cache_mem = g_malloc0 (n_slots * sizeof (GstBufferPoolPaddedSlot) +
+      CACHE_LINE_SIZE - 1);
+  priv->cache = (GstBufferPoolPaddedSlot *)
+      (((guintptr) priv->cache_mem + CACHE_LINE_SIZE - 1) &
+      ~((guintptr) CACHE_LINE_SIZE - 1));
+  priv->cache_size = size;
+  priv->cache_mask = n_slots - 1;
+
+  for (i = 0; i < n_slots; i++) {
+    GstBufferPoolCacheSlot *slot = &priv->cache[i].slot;
+
+    g_mutex_init (&slot->lock);
+    slot->buffers = g_new (GstBuffer *, size);
+  }
+  GST_DEBUG_OBJECT (pool, "thread cache of %u buffers in %u slots", size,
+      n_slots);
+}
+
 static GstFlowReturn
 default_alloc_buffer (GstBufferPool * pool, GstBuffer ** buffer,
     GstBufferPoolAcquireParams * params)
 {
   GstBufferPoolPrivate *priv = pool->priv;
 
+  /* buffers kept from the previous configuration come first */
+  if (G_UNLIKELY (priv->spares)) {
+    GST_BUFFER_POOL_LOCK (pool);
+    if (priv->spares) {
+      *buffer = priv->spares->data;
+      priv->spares = g_list_delete_link (priv->spares, priv->spares);
+      GST_BUFFER_POOL_UNLOCK (pool);
+      GST_LOG_OBJECT (pool, "reusing spare buffer %p", *buffer);
+      return GST_FLOW_OK;
+    }
+    GST_BUFFER_POOL_UNLOCK (pool);
+  }
+
   *buffer =
       gst_buffer_new_allocate (priv->allocator, priv->size, &priv->params);
 
@@ -244,6 +598,55 @@ mark_meta_pooled (GstBuffer * buffer, GstMeta ** meta, gpointer user_data)
   return TRUE;
 }
 
+/* touch every page of the new buffer so that it doesn't page fault when it
+ * is first written, and lock it in RAM when configured */
+static void
+prefault_buffer (GstBufferPool * pool, GstBuffer * buffer)
+{
+  GstBufferPoolPrivate *priv = pool->priv;
+  guint i, n = gst_buffer_n_memory (buffer);
+
+  for (i = 0; i < n; i++) {
+    GstMemory *mem = gst_buffer_peek_memory (buffer, i);
+    GstMapInfo info;
+    gsize pos;
+
+    if (!gst_memory_map (mem, &info, GST_MAP_READWRITE))
+      continue;
+
+    if (priv->prefault) {
+      volatile guint8 *data = info.data;
+
+      for (pos = 0; pos < info.size; pos += 4096)
+        data[pos] = data[pos];
+    }
+#ifdef HAVE_MMAP
+    if (priv->lock_memory && mlock (info.data, info.size) < 0)
+      GST_WARNING_OBJECT (pool, "could not lock memory: %s",
+          g_strerror (errno));
+#endif
+    gst_memory_unmap (mem, &info);
+  }
+}
+
+static void
+unlock_buffer (GstBufferPool * pool, GstBuffer * buffer)
+{
+#ifdef HAVE_MMAP
+  guint i, n = gst_buffer_n_memory (buffer);
+
+  for (i = 0; i < n; i++) {
+    GstMemory *mem = gst_buffer_peek_memory (buffer, i);
+    GstMapInfo info;
+
+    if (!gst_memory_map (mem, &info, GST_MAP_READ))
+      continue;
+    munlock (info.data, info.size);
+    gst_memory_unmap (mem, &info);
+  }
+#endif
+}
+
 static GstFlowReturn
 do_alloc_buffer (GstBufferPool * pool, GstBuffer ** buffer,
     GstBufferPoolAcquireParams * params)
@@ -252,6 +655,7 @@ do_alloc_buffer (GstBufferPool * pool, GstBuffer ** buffer,
   GstFlowReturn result;
   gint cur_buffers, max_buffers;
   GstBufferPoolClass *pclass;
+  GstClockTime start, elapsed;
 
   pclass = GST_BUFFER_POOL_GET_CLASS (pool);
 
@@ -265,10 +669,42 @@ do_alloc_buffer (GstBufferPool * pool, GstBuffer ** buffer,
   if (max_buffers && cur_buffers >= max_buffers)
     goto max_reached;
 
+  /* a pool always gets its first buffer, after that it only grows while
+   * the budget allows and otherwise waits for its own buffers to return */
+  if (priv->budget_client) {
+    if (cur_buffers == 0)
+      gst_memory_budget_client_acquire (priv->budget_client, priv->size);
+    else if (!gst_memory_budget_client_try_acquire (priv->budget_client,
+            priv->size))
+      goto budget_exhausted;
+  }
+
+  start = gst_util_get_timestamp ();
   result = pclass->alloc_buffer (pool, buffer, params);
+  elapsed = gst_util_get_timestamp () - start;
+
+  g_mutex_lock (&priv->stats_lock);
+  priv->stats.alloc_time += elapsed;
+  if (G_LIKELY (result == GST_FLOW_OK)) {
+    priv->stats.allocated++;
+    priv->stats.live_bytes += priv->size;
+    priv->stats.peak_bytes =
+        MAX (priv->stats.peak_bytes, priv->stats.live_bytes);
+  } else {
+    priv->stats.failed++;
+  }
+  g_mutex_unlock (&priv->stats_lock);
+
   if (G_UNLIKELY (result != GST_FLOW_OK))
     goto alloc_failed;
 
+  if (G_UNLIKELY (priv->prefault || priv->lock_memory))
+    prefault_buffer (pool, *buffer);
+
+  /* the queue is certainly empty now */
+  if (priv->trim_id)
+    g_atomic_int_set (&priv->trim_low, 0);
+
   /* lock all metadata and mark as pooled, we want this to remain on
    * the buffer and we want to remove any other metadata that gets added
    * later */
@@ -295,9 +731,17 @@ max_reached:
     g_atomic_int_add (&priv->cur_buffers, -1);
     return GST_FLOW_EOS;
   }
+budget_exhausted:
+  {
+    GST_DEBUG_OBJECT (pool, "memory budget exhausted");
+    g_atomic_int_add (&priv->cur_buffers, -1);
+    return GST_FLOW_EOS;
+  }
 alloc_failed:
   {
     GST_WARNING_OBJECT (pool, "alloc function failed");
+    if (priv->budget_client)
+      gst_memory_budget_client_release (priv->budget_client, priv->size);
     g_atomic_int_add (&priv->cur_buffers, -1);
     return result;
   }
@@ -364,23 +808,94 @@ default_free_buffer (GstBufferPool * pool, GstBuffer * buffer)
   gst_buffer_unref (buffer);
 }
 
+/* remove @buffer from the accounting of the pool before it is freed */
 static void
-do_free_buffer (GstBufferPool * pool, GstBuffer * buffer)
+do_forget_buffer (GstBufferPool * pool, GstBuffer * buffer)
 {
-  GstBufferPoolPrivate *priv;
-  GstBufferPoolClass *pclass;
-
-  priv = pool->priv;
-  pclass = GST_BUFFER_POOL_GET_CLASS (pool);
+  GstBufferPoolPrivate *priv = pool->priv;
 
   g_atomic_int_add (&priv->cur_buffers, -1);
   GST_LOG_OBJECT (pool, "freeing buffer %p (%u left)", buffer,
       priv->cur_buffers);
 
+  if (priv->budget_client)
+    gst_memory_budget_client_release (priv->budget_client, priv->size);
+
+  g_mutex_lock (&priv->stats_lock);
+  priv->stats.freed++;
+  priv->stats.live_bytes -= MIN (priv->stats.live_bytes, priv->size);
+  g_mutex_unlock (&priv->stats_lock);
+
+  if (G_UNLIKELY (priv->lock_memory))
+    unlock_buffer (pool, buffer);
+}
+
+static void
+do_free_buffer (GstBufferPool * pool, GstBuffer * buffer)
+{
+  GstBufferPoolClass *pclass = GST_BUFFER_POOL_GET_CLASS (pool);
+
+  do_forget_buffer (pool, buffer);
+
   if (G_LIKELY (pclass->free_buffer))
     pclass->free_buffer (pool, buffer);
 }
 
+/* only buffers of the default implementation can be reused, subclasses
+ * might add metadata or use their own memory */
+static gboolean
+can_reuse_memory (GstBufferPool * pool)
+{
+  GstBufferPoolClass *pclass = GST_BUFFER_POOL_GET_CLASS (pool);
+
+  return pool->priv->reuse_memory &&
+      pclass->alloc_buffer == default_alloc_buffer &&
+      pclass->free_buffer == default_free_buffer;
+}
+
+/* must be called with the lock, keeps the spare buffers that fit the new
+ * configuration and frees the others */
+static void
+update_spares (GstBufferPool * pool)
+{
+  GstBufferPoolPrivate *priv = pool->priv;
+  GstAllocationParams *params = &priv->params;
+  GstAllocator *allocator;
+  GList *walk, *keep = NULL;
+
+  if (priv->spares == NULL)
+    return;
+
+  if (priv->allocator)
+    allocator = gst_object_ref (priv->allocator);
+  else
+    allocator = gst_allocator_find (NULL);
+
+  for (walk = priv->spares; walk; walk = walk->next) {
+    GstBuffer *buffer = walk->data;
+    GstMemory *mem = gst_buffer_peek_memory (buffer, 0);
+
+    /* zeroed prefix or padding would need to be cleared again */
+    if (can_reuse_memory (pool) && gst_buffer_n_memory (buffer) == 1 &&
+        mem->allocator == allocator &&
+        (mem->align & params->align) == params->align &&
+        mem->maxsize >= params->prefix + priv->size + params->padding &&
+        !(params->flags & (GST_MEMORY_FLAG_ZERO_PREFIXED |
+                GST_MEMORY_FLAG_ZERO_PADDED))) {
+      gst_memory_resize (mem, (gssize) params->prefix - (gssize) mem->offset,
+          priv->size);
+      keep = g_list_prepend (keep, buffer);
+    } else {
+      gst_buffer_unref (buffer);
+    }
+  }
+  g_list_free (priv->spares);
+  priv->spares = keep;
+  gst_object_unref (allocator);
+
+  GST_DEBUG_OBJECT (pool, "kept %u spare buffers", g_list_length (keep));
+}
+
 /* must be called with the lock */
 static gboolean
 default_stop (GstBufferPool * pool)
@@ -388,10 +903,19 @@ default_stop (GstBufferPool * pool)
   GstBufferPoolPrivate *priv = pool->priv;
   GstBuffer *buffer;
 
-  /* clear the pool */
+  /* buffers in the thread caches are freed from the queue as well */
+  if (priv->cache)
+    thread_cache_drain (pool);
+
+  /* clear the pool, keeping the buffers for the next configuration when
+   * asked to */
   while ((buffer = gst_atomic_queue_pop (priv->queue))) {
-    gst_poll_read_control (priv->poll);
-    do_free_buffer (pool, buffer);
+    if (can_reuse_memory (pool)) {
+      do_forget_buffer (pool, buffer);
+      priv->spares = g_list_prepend (priv->spares, buffer);
+    } else {
+      do_free_buffer (pool, buffer);
+    }
   }
   return priv->cur_buffers == 0;
 }
@@ -421,7 +945,6 @@ do_stop (GstBufferPool * pool)
 static void
 do_set_flushing (GstBufferPool * pool, gboolean flushing)
 {
-  GstBufferPoolPrivate *priv = pool->priv;
   GstBufferPoolClass *pclass;
 
   pclass = GST_BUFFER_POOL_GET_CLASS (pool);
@@ -431,7 +954,7 @@ do_set_flushing (GstBufferPool * pool, gboolean flushing)
 
   if (flushing) {
     g_atomic_int_set (&pool->flushing, 1);
-    gst_poll_write_control (priv->poll);
+    wake_waiters (pool);
 
     if (pclass->flush_start)
       pclass->flush_start (pool);
@@ -439,11 +962,96 @@ do_set_flushing (GstBufferPool * pool, gboolean flushing)
     if (pclass->flush_stop)
       pclass->flush_stop (pool);
 
-    gst_poll_read_control (priv->poll);
     g_atomic_int_set (&pool->flushing, 0);
   }
 }
 
+/* free the buffers that stayed in the queue since the last trim, but keep
+ * at least min_buffers */
+static gboolean
+trim_timeout (GstClock * clock, GstClockTime time, GstClockID id,
+    gpointer user_data)
+{
+  GstBufferPool *pool = g_weak_ref_get (user_data);
+  GstBufferPoolPrivate *priv;
+  GstBuffer *buffer;
+  gint idle, n_freed = 0;
+
+  if (pool == NULL)
+    return TRUE;
+
+  priv = pool->priv;
+
+  GST_BUFFER_POOL_LOCK (pool);
+  if (!priv->active || GST_BUFFER_POOL_IS_FLUSHING (pool))
+    goto done;
+
+  idle = g_atomic_int_get (&priv->trim_low);
+  while (n_freed < idle
+      && g_atomic_int_get (&priv->cur_buffers) > priv->min_buffers
+      && (buffer = gst_atomic_queue_pop (priv->queue))) {
+    do_free_buffer (pool, buffer);
+    n_freed++;
+  }
+  if (n_freed > 0)
+    GST_DEBUG_OBJECT (pool, "trimmed %d idle buffers, %d left", n_freed,
+        g_atomic_int_get (&priv->cur_buffers));
+
+  g_atomic_int_set (&priv->trim_low, gst_atomic_queue_length (priv->queue));
+
+done:
+  GST_BUFFER_POOL_UNLOCK (pool);
+  gst_object_unref (pool);
+
+  return TRUE;
+}
+
+static void
+free_weak_ref (GWeakRef * ref)
+{
+  g_weak_ref_clear (ref);
+  g_free (ref);
+}
+
+/* must be called with the lock */
+static void
+start_trim (GstBufferPool * pool)
+{
+  GstBufferPoolPrivate *priv = pool->priv;
+  GstClock *clock;
+  GWeakRef *ref;
+
+  if (!GST_CLOCK_TIME_IS_VALID (priv->trim_idle_time)
+      || priv->trim_idle_time == 0)
+    return;
+
+  g_atomic_int_set (&priv->trim_low, gst_atomic_queue_length (priv->queue));
+
+  clock = gst_system_clock_obtain ();
+  priv->trim_id = gst_clock_new_periodic_id (clock,
+      gst_clock_get_time (clock) + priv->trim_idle_time, priv->trim_idle_time);
+  gst_object_unref (clock);
+
+  /* the clock thread must not keep the pool alive */
+  ref = g_new (GWeakRef, 1);
+  g_weak_ref_init (ref, pool);
+  gst_clock_id_wait_async (priv->trim_id, trim_timeout, ref,
+      (GDestroyNotify) free_weak_ref);
+}
+
+/* must be called with the lock */
+static void
+stop_trim (GstBufferPool * pool)
+{
+  GstBufferPoolPrivate *priv = pool->priv;
+
+  if (priv->trim_id) {
+    gst_clock_id_unschedule (priv->trim_id);
+    gst_clock_id_unref (priv->trim_id);
+    priv->trim_id = NULL;
+  }
+}
+
 /**
  * gst_buffer_pool_set_active:
  * @pool: a #GstBufferPool
@@ -493,9 +1101,13 @@ gst_buffer_pool_set_active (GstBufferPool * pool, gboolean active)
 
     /* unset the flushing state now */
     do_set_flushing (pool, FALSE);
+
+    start_trim (pool);
   } else {
     gint outstanding;
 
+    stop_trim (pool);
+
     /* set to flushing first */
     do_set_flushing (pool, TRUE);
 
@@ -561,6 +1173,31 @@ gst_buffer_pool_is_active (GstBufferPool * pool)
   return res;
 }
 
+/**
+ * gst_buffer_pool_get_stats:
+ * @pool: a #GstBufferPool
+ * @stats: (out caller-allocates): the #GstAllocationStats to fill
+ *
+ * Get the allocation statistics of @pool. They count the buffers that the
+ * pool allocated and freed, failed allocations, the bytes of the buffers
+ * that currently exist and the time spent in the alloc_buffer vmethod.
+ *
+ * Since: 1.10
+ */
+void
+gst_buffer_pool_get_stats (GstBufferPool * pool, GstAllocationStats * stats)
+{
+  GstBufferPoolPrivate *priv;
+
+  g_return_if_fail (GST_IS_BUFFER_POOL (pool));
+  g_return_if_fail (stats != NULL);
+
+  priv = pool->priv;
+  g_mutex_lock (&priv->stats_lock);
+  *stats = priv->stats;
+  g_mutex_unlock (&priv->stats_lock);
+}
+
 static gboolean
 default_set_config (GstBufferPool * pool, GstStructure * config)
 {
@@ -569,6 +1206,8 @@ default_set_config (GstBufferPool * pool, GstStructure * config)
   guint size, min_buffers, max_buffers;
   GstAllocator *allocator;
   GstAllocationParams params;
+  guint cache_size;
+  GstMemoryBudget *budget;
 
   /* parse the config and keep around */
   if (!gst_buffer_pool_config_get_params (config, &caps, &size, &min_buffers,
@@ -578,6 +1217,13 @@ default_set_config (GstBufferPool * pool, GstStructure * config)
   if (!gst_buffer_pool_config_get_allocator (config, &allocator, &params))
     goto wrong_config;
 
+  cache_size = gst_buffer_pool_config_get_thread_cache_size (config);
+  budget = gst_buffer_pool_config_get_memory_budget (config);
+  priv->trim_idle_time = gst_buffer_pool_config_get_trim_idle_time (config);
+  priv->prefault = gst_buffer_pool_config_get_prefault (config);
+  priv->lock_memory = gst_buffer_pool_config_get_lock_memory (config);
+  priv->reuse_memory = gst_buffer_pool_config_get_reuse_memory (config);
+
   GST_DEBUG_OBJECT (pool, "config %" GST_PTR_FORMAT, config);
 
   priv->size = size;
@@ -591,6 +1237,23 @@ default_set_config (GstBufferPool * pool, GstStructure * config)
     gst_object_ref (allocator);
   priv->params = params;
 
+  thread_cache_configure (pool, cache_size);
+  update_spares (pool);
+
+  /* all buffers are freed at this point, so the client holds nothing */
+  if (budget != priv->budget) {
+    if (priv->budget) {
+      gst_memory_budget_remove_client (priv->budget, priv->budget_client);
+      gst_object_unref (priv->budget);
+      priv->budget_client = NULL;
+    }
+    if ((priv->budget = budget)) {
+      gst_object_ref (budget);
+      priv->budget_client = gst_memory_budget_add_client (budget,
+          GST_MEMORY_BUDGET_DEFAULT_PRIORITY);
+    }
+  }
+
   return TRUE;
 
 wrong_config:
@@ -600,6 +1263,23 @@ wrong_config:
   }
 }
 
+static gboolean
+config_only_caps_changed (const GstStructure * old, const GstStructure * new)
+{
+  GstStructure *s1, *s2;
+  gboolean res;
+
+  s1 = gst_structure_copy (old);
+  s2 = gst_structure_copy (new);
+  gst_structure_id_set (s1, GST_QUARK (CAPS), GST_TYPE_CAPS, NULL, NULL);
+  gst_structure_id_set (s2, GST_QUARK (CAPS), GST_TYPE_CAPS, NULL, NULL);
+  res = gst_structure_is_equal (s1, s2);
+  gst_structure_free (s1);
+  gst_structure_free (s2);
+
+  return res;
+}
+
 /**
  * gst_buffer_pool_set_config:
  * @pool: a #GstBufferPool
@@ -642,6 +1322,14 @@ gst_buffer_pool_set_config (GstBufferPool * pool, GstStructure * config)
   if (priv->configured && gst_structure_is_equal (config, priv->config))
     goto config_unchanged;
 
+  pclass = GST_BUFFER_POOL_GET_CLASS (pool);
+
+  /* the default implementation doesn't look at the caps, a caps change
+   * doesn't need to free the buffers */
+  if (priv->configured && pclass->set_config == default_set_config &&
+      config_only_caps_changed (priv->config, config))
+    goto caps_changed;
+
   /* can't change the settings when active */
   if (priv->active)
     goto was_active;
@@ -650,8 +1338,6 @@ gst_buffer_pool_set_config (GstBufferPool * pool, GstStructure * config)
   if (g_atomic_int_get (&priv->outstanding) != 0)
     goto have_outstanding;
 
-  pclass = GST_BUFFER_POOL_GET_CLASS (pool);
-
   /* set the new config */
   if (G_LIKELY (pclass->set_config))
     result = pclass->set_config (pool, config);
@@ -678,6 +1364,14 @@ config_unchanged:
     GST_BUFFER_POOL_UNLOCK (pool);
     return TRUE;
   }
+caps_changed:
+  {
+    GST_DEBUG_OBJECT (pool, "only the caps changed, keeping the buffers");
+    gst_structure_free (priv->config);
+    priv->config = config;
+    GST_BUFFER_POOL_UNLOCK (pool);
+    return TRUE;
+  }
   /* ERRORS */
 was_active:
   {
@@ -1026,6 +1720,285 @@ gst_buffer_pool_config_get_allocator (GstStructure * config,
   return TRUE;
 }
 
+/**
+ * gst_buffer_pool_config_set_thread_cache_size:
+ * @config: a #GstBufferPool configuration
+ * @size: the maximum number of free buffers to keep per thread, or 0 to
+ *     disable the thread cache.
+ *
+ * Configure a per-thread cache of free buffers in front of the shared queue
+ * of the pool. Buffers released into the pool are kept in the cache of the
+ * releasing thread and are handed out again to the next acquire call from
+ * that thread. The cache is filled from and drained to the shared queue in
+ * batches.
+ *
+ * Buffers in the thread caches are owned by the pool, they are taken into
+ * account for the maximum number of buffers and are handed to other threads
+ * when the pool would otherwise block.
+ *
+ * Since: 1.10
+ */
+void
+gst_buffer_pool_config_set_thread_cache_size (GstStructure * config,
+    guint size)
+{
+  g_return_if_fail (config != NULL);
+
+  gst_structure_id_set (config,
+      GST_QUARK (THREAD_CACHE_SIZE), G_TYPE_UINT, size, NULL);
+}
+
+/**
+ * gst_buffer_pool_config_get_thread_cache_size:
+ * @config: (transfer none): a #GstBufferPool configuration
+ *
+ * Get the per-thread cache size configured in @config.
+ *
+ * Returns: the maximum number of free buffers kept per thread, 0 when the
+ * thread cache is disabled.
+ *
+ * Since: 1.10
+ */
+guint
+gst_buffer_pool_config_get_thread_cache_size (GstStructure * config)
+{
+  guint size = 0;
+
+  g_return_val_if_fail (config != NULL, 0);
+
+  gst_structure_id_get (config,
+      GST_QUARK (THREAD_CACHE_SIZE), G_TYPE_UINT, &size, NULL);
+
+  return size;
+}
+
+/**
+ * gst_buffer_pool_config_set_memory_budget:
+ * @config: (transfer none): a #GstBufferPool configuration
+ * @budget: (allow-none): a #GstMemoryBudget, or %NULL
+ *
+ * Account the buffers allocated by the pool in @budget. When the budget is
+ * exhausted the pool waits for its buffers to be released instead of
+ * allocating new ones, but it can always allocate at least one buffer.
+ *
+ * Since: 1.10
+ */
+void
+gst_buffer_pool_config_set_memory_budget (GstStructure * config,
+    GstMemoryBudget * budget)
+{
+  g_return_if_fail (config != NULL);
+  g_return_if_fail (budget == NULL || GST_IS_MEMORY_BUDGET (budget));
+
+  gst_structure_id_set (config,
+      GST_QUARK (MEMORY_BUDGET), GST_TYPE_MEMORY_BUDGET, budget, NULL);
+}
+
+/**
+ * gst_buffer_pool_config_get_memory_budget:
+ * @config: (transfer none): a #GstBufferPool configuration
+ *
+ * Get the memory budget configured in @config.
+ *
+ * Returns: (transfer none) (nullable): the #GstMemoryBudget, or %NULL
+ *
+ * Since: 1.10
+ */
+GstMemoryBudget *
+gst_buffer_pool_config_get_memory_budget (GstStructure * config)
+{
+  const GValue *value;
+
+  g_return_val_if_fail (config != NULL, NULL);
+
+  value = gst_structure_id_get_value (config, GST_QUARK (MEMORY_BUDGET));
+  if (value == NULL)
+    return NULL;
+
+  return g_value_get_object (value);
+}
+
+/**
+ * gst_buffer_pool_config_set_trim_idle_time:
+ * @config: (transfer none): a #GstBufferPool configuration
+ * @idle_time: the idle time, or %GST_CLOCK_TIME_NONE to never trim
+ *
+ * Let the pool free the buffers that stayed unused in the pool for
+ * @idle_time, as long as it keeps at least its minimum number of buffers.
+ * The pool allocates new buffers again when it needs them.
+ *
+ * Since: 1.10
+ */
+void
+gst_buffer_pool_config_set_trim_idle_time (GstStructure * config,
+    GstClockTime idle_time)
+{
+  g_return_if_fail (config != NULL);
+
+  gst_structure_id_set (config,
+      GST_QUARK (TRIM_IDLE_TIME), G_TYPE_UINT64, idle_time, NULL);
+}
+
+/**
+ * gst_buffer_pool_config_get_trim_idle_time:
+ * @config: (transfer none): a #GstBufferPool configuration
+ *
+ * Get the idle time after which unused buffers are freed.
+ *
+ * Returns: the idle time, or %GST_CLOCK_TIME_NONE when the pool doesn't
+ * free unused buffers.
+ *
+ * Since: 1.10
+ */
+GstClockTime
+gst_buffer_pool_config_get_trim_idle_time (GstStructure * config)
+{
+  guint64 idle_time = GST_CLOCK_TIME_NONE;
+
+  g_return_val_if_fail (config != NULL, GST_CLOCK_TIME_NONE);
+
+  gst_structure_id_get (config,
+      GST_QUARK (TRIM_IDLE_TIME), G_TYPE_UINT64, &idle_time, NULL);
+
+  return idle_time;
+}
+
+/**
+ * gst_buffer_pool_config_set_prefault:
+ * @config: (transfer none): a #GstBufferPool configuration
+ * @prefault: whether to prefault new buffers
+ *
+ * Let the pool write to every page of the buffers it allocates, so that
+ * they are backed by RAM before they are handed out and the first write
+ * into them doesn't page fault.
+ *
+ * Since: 1.10
+ */
+void
+gst_buffer_pool_config_set_prefault (GstStructure * config, gboolean prefault)
+{
+  g_return_if_fail (config != NULL);
+
+  gst_structure_id_set (config,
+      GST_QUARK (PREFAULT), G_TYPE_BOOLEAN, prefault, NULL);
+}
+
+/**
+ * gst_buffer_pool_config_get_prefault:
+ * @config: (transfer none): a #GstBufferPool configuration
+ *
+ * Check if the pool prefaults the buffers it allocates.
+ *
+ * Returns: %TRUE when new buffers are prefaulted.
+ *
+ * Since: 1.10
+ */
+gboolean
+gst_buffer_pool_config_get_prefault (GstStructure * config)
+{
+  gboolean prefault = FALSE;
+
+  g_return_val_if_fail (config != NULL, FALSE);
+
+  gst_structure_id_get (config,
+      GST_QUARK (PREFAULT), G_TYPE_BOOLEAN, &prefault, NULL);
+
+  return prefault;
+}
+
+/**
+ * gst_buffer_pool_config_set_lock_memory:
+ * @config: (transfer none): a #GstBufferPool configuration
+ * @lock_memory: whether to lock the memory of new buffers
+ *
+ * Let the pool lock the memory of the buffers it allocates in RAM with
+ * mlock() until they are freed, so that they are never paged out. Locking
+ * can fail when it would go over the memory lock limit of the process, the
+ * buffers are then used without being locked.
+ *
+ * Since: 1.10
+ */
+void
+gst_buffer_pool_config_set_lock_memory (GstStructure * config,
+    gboolean lock_memory)
+{
+  g_return_if_fail (config != NULL);
+
+  gst_structure_id_set (config,
+      GST_QUARK (LOCK_MEMORY), G_TYPE_BOOLEAN, lock_memory, NULL);
+}
+
+/**
+ * gst_buffer_pool_config_get_lock_memory:
+ * @config: (transfer none): a #GstBufferPool configuration
+ *
+ * Check if the pool locks the memory of the buffers it allocates.
+ *
+ * Returns: %TRUE when the memory of new buffers is locked.
+ *
+ * Since: 1.10
+ */
+gboolean
+gst_buffer_pool_config_get_lock_memory (GstStructure * config)
+{
+  gboolean lock_memory = FALSE;
+
+  g_return_val_if_fail (config != NULL, FALSE);
+
+  gst_structure_id_get (config,
+      GST_QUARK (LOCK_MEMORY), G_TYPE_BOOLEAN, &lock_memory, NULL);
+
+  return lock_memory;
+}
+
+/**
+ * gst_buffer_pool_config_set_reuse_memory:
+ * @config: (transfer none): a #GstBufferPool configuration
+ * @reuse_memory: whether to keep buffers for the next configuration
+ *
+ * Let the pool keep its free buffers when it is deactivated instead of
+ * freeing them. When the pool is configured again, the buffers that are big
+ * enough for the new size and that match the new allocator and alignment are
+ * reused before new buffers are allocated, the others are freed.
+ *
+ * This only applies to pools that use the default alloc_buffer and
+ * free_buffer implementations. The kept buffers are freed with the pool.
+ *
+ * Since: 1.10
+ */
+void
+gst_buffer_pool_config_set_reuse_memory (GstStructure * config,
+    gboolean reuse_memory)
+{
+  g_return_if_fail (config != NULL);
+
+  gst_structure_id_set (config,
+      GST_QUARK (REUSE_MEMORY), G_TYPE_BOOLEAN, reuse_memory, NULL);
+}
+
+/**
+ * gst_buffer_pool_config_get_reuse_memory:
+ * @config: (transfer none): a #GstBufferPool configuration
+ *
+ * Check if the pool keeps its buffers for the next configuration.
+ *
+ * Returns: %TRUE when buffers are kept when the pool is deactivated.
+ *
+ * Since: 1.10
+ */
+gboolean
+gst_buffer_pool_config_get_reuse_memory (GstStructure * config)
+{
+  gboolean reuse_memory = FALSE;
+
+  g_return_val_if_fail (config != NULL, FALSE);
+
+  gst_structure_id_get (config,
+      GST_QUARK (REUSE_MEMORY), G_TYPE_BOOLEAN, &reuse_memory, NULL);
+
+  return reuse_memory;
+}
+
 /**
  * gst_buffer_pool_config_validate_params:
  * @config: (transfer none): a #GstBufferPool configuration
@@ -1066,21 +2039,61 @@ gst_buffer_pool_config_validate_params (GstStructure * config, GstCaps * caps,
   return ret;
 }
 
+static inline void
+update_trim_low (GstBufferPool * pool)
+{
+  GstBufferPoolPrivate *priv = pool->priv;
+  gint len = gst_atomic_queue_length (priv->queue);
+  gint low;
+
+  do {
+    low = g_atomic_int_get (&priv->trim_low);
+    if (len >= low)
+      break;
+  } while (!g_atomic_int_compare_and_exchange (&priv->trim_low, low, len));
+}
+
+static void
+reclaim_buffers (GstBufferPool * pool)
+{
+  GstBufferPoolPrivate *priv = pool->priv;
+  GSList *walk;
+
+  GST_DEBUG_OBJECT (pool, "no free buffers, reclaiming");
+
+  g_mutex_lock (&priv->reclaim_lock);
+  for (walk = priv->reclaims; walk; walk = walk->next) {
+    GstBufferPoolReclaim *reclaim = walk->data;
+
+    reclaim->func (pool, reclaim->user_data);
+  }
+  g_mutex_unlock (&priv->reclaim_lock);
+}
+
 static GstFlowReturn
 default_acquire_buffer (GstBufferPool * pool, GstBuffer ** buffer,
     GstBufferPoolAcquireParams * params)
 {
   GstFlowReturn result;
   GstBufferPoolPrivate *priv = pool->priv;
+  gboolean reclaimed = FALSE;
 
   while (TRUE) {
     if (G_UNLIKELY (GST_BUFFER_POOL_IS_FLUSHING (pool)))
       goto flushing;
 
+    /* first try the cache of this thread */
+    if (priv->cache && (*buffer = thread_cache_pop (pool))) {
+      result = GST_FLOW_OK;
+      GST_LOG_OBJECT (pool, "acquired buffer %p from thread cache", *buffer);
+      break;
+    }
+
     /* try to get a buffer from the queue */
     *buffer = gst_atomic_queue_pop (priv->queue);
     if (G_LIKELY (*buffer)) {
-      gst_poll_read_control (priv->poll);
+      if (priv->trim_id)
+        update_trim_low (pool);
       result = GST_FLOW_OK;
       GST_LOG_OBJECT (pool, "acquired buffer %p", *buffer);
       break;
@@ -1097,18 +2110,40 @@ default_acquire_buffer (GstBufferPool * pool, GstBuffer ** buffer,
       /* something went wrong, return error */
       break;
 
+    if (priv->cache) {
+      /* announce that we are waiting so that releasing threads don't keep
+       * buffers in their cache, then take the cached buffers of the other
+       * threads */
+      g_atomic_int_inc (&priv->cache_waiting);
+      if (thread_cache_drain (pool) > 0) {
+        g_atomic_int_add (&priv->cache_waiting, -1);
+        continue;
+      }
+    }
+
+    /* once, ask the holders of convenience references to release them */
+    if (!reclaimed && priv->reclaims) {
+      reclaimed = TRUE;
+      reclaim_buffers (pool);
+      if (priv->cache)
+        g_atomic_int_add (&priv->cache_waiting, -1);
+      continue;
+    }
+
     /* check if we need to wait */
     if (params && (params->flags & GST_BUFFER_POOL_ACQUIRE_FLAG_DONTWAIT)) {
       GST_LOG_OBJECT (pool, "no more buffers");
+      if (priv->cache)
+        g_atomic_int_add (&priv->cache_waiting, -1);
       break;
     }
 
-    /* now we release the control socket, we wait for a buffer release or
-     * flushing */
-    gst_poll_read_control (pool->priv->poll);
+    /* wait for a buffer release or flushing */
     GST_LOG_OBJECT (pool, "waiting for free buffers or flushing");
-    gst_poll_wait (priv->poll, GST_CLOCK_TIME_NONE);
-    gst_poll_write_control (pool->priv->poll);
+    wait_for_buffer (pool);
+
+    if (priv->cache)
+      g_atomic_int_add (&priv->cache_waiting, -1);
   }
 
   return result;
@@ -1195,6 +2230,9 @@ gst_buffer_pool_acquire_buffer (GstBufferPool * pool, GstBuffer ** buffer,
    * that concurrent set_active doesn't clear the buffers */
   g_atomic_int_inc (&pool->priv->outstanding);
 
+  GST_TRACER_BUFFER_POOL_ACQUIRE_PRE (pool);
+  GST_SDT_PROBE1 (buffer_pool_acquire, pool);
+
   if (G_LIKELY (pclass->acquire_buffer))
     result = pclass->acquire_buffer (pool, buffer, params);
   else
@@ -1208,9 +2246,41 @@ gst_buffer_pool_acquire_buffer (GstBufferPool * pool, GstBuffer ** buffer,
     dec_outstanding (pool);
   }
 
+  GST_SDT_PROBE3 (buffer_pool_acquire_done, pool,
+      result == GST_FLOW_OK ? *buffer : NULL, result);
+  GST_TRACER_BUFFER_POOL_ACQUIRE_POST (pool,
+      result == GST_FLOW_OK ? *buffer : NULL, result);
+
   return result;
 }
 
+/* give back the prefix and padding that gst_buffer_prepend_headroom() and
+ * gst_buffer_append_tailroom() took, so that the buffer keeps its headroom
+ * when it is recycled instead of being discarded for its changed size */
+static void
+restore_reserved_space (GstBufferPool * pool, GstBuffer * buffer)
+{
+  GstBufferPoolPrivate *priv = pool->priv;
+  GstMemory *mem;
+  gsize size, offset, maxsize;
+
+  if (gst_buffer_n_memory (buffer) != 1)
+    return;
+
+  mem = gst_buffer_peek_memory (buffer, 0);
+  size = gst_memory_get_sizes (mem, &offset, &maxsize);
+
+  if (offset > priv->params.prefix || (offset == priv->params.prefix
+          && size <= priv->size))
+    return;
+
+  if (priv->params.prefix + priv->size > maxsize
+      || !gst_memory_is_writable (mem))
+    return;
+
+  gst_memory_resize (mem, priv->params.prefix - offset, priv->size);
+}
+
 static void
 default_release_buffer (GstBufferPool * pool, GstBuffer * buffer)
 {
@@ -1221,6 +2291,8 @@ default_release_buffer (GstBufferPool * pool, GstBuffer * buffer)
   if (G_UNLIKELY (GST_BUFFER_FLAG_IS_SET (buffer, GST_BUFFER_FLAG_TAG_MEMORY)))
     goto memory_tagged;
 
+  restore_reserved_space (pool, buffer);
+
   /* size should have been reset. This is not a catch all, pool with
    * size requirement per memory should do their own check. */
   if (G_UNLIKELY (gst_buffer_get_size (buffer) != pool->priv->size))
@@ -1230,9 +2302,13 @@ default_release_buffer (GstBufferPool * pool, GstBuffer * buffer)
   if (G_UNLIKELY (!gst_buffer_is_all_memory_writable (buffer)))
     goto not_writable;
 
-  /* keep it around in our queue */
-  gst_atomic_queue_push (pool->priv->queue, buffer);
-  gst_poll_write_control (pool->priv->poll);
+  /* keep it around in the cache of this thread or in our queue */
+  if (pool->priv->cache) {
+    thread_cache_push (pool, buffer);
+  } else {
+    gst_atomic_queue_push (pool->priv->queue, buffer);
+    wake_waiters (pool);
+  }
 
   return;
 
@@ -1286,6 +2362,9 @@ gst_buffer_pool_release_buffer (GstBufferPool * pool, GstBuffer * buffer)
   if (!g_atomic_pointer_compare_and_exchange (&buffer->pool, pool, NULL))
     return;
 
+  GST_TRACER_BUFFER_POOL_RELEASE (pool, buffer);
+  GST_SDT_PROBE2 (buffer_pool_release, pool, buffer);
+
   pclass = GST_BUFFER_POOL_GET_CLASS (pool);
 
   /* reset the buffer when needed */
@@ -1334,3 +2413,75 @@ gst_buffer_pool_set_flushing (GstBufferPool * pool, gboolean flushing)
 done:
   GST_BUFFER_POOL_UNLOCK (pool);
 }
+
+/**
+ * gst_buffer_pool_add_reclaim_func:
+ * @pool: a #GstBufferPool
+ * @func: (scope notified): the #GstBufferPoolReclaimFunc to add
+ * @user_data: user data passed to @func
+ *
+ * Adds @func to the functions that @pool calls when a buffer is acquired
+ * while all its buffers are in use and no more can be allocated. Elements
+ * that keep a buffer of @pool around only as a convenience, like the last
+ * rendered buffer of a sink, can then give it back before anyone has to
+ * wait.
+ *
+ * Since: 1.10
+ */
+void
+gst_buffer_pool_add_reclaim_func (GstBufferPool * pool,
+    GstBufferPoolReclaimFunc func, gpointer user_data)
+{
+  GstBufferPoolPrivate *priv;
+  GstBufferPoolReclaim *reclaim;
+
+  g_return_if_fail (GST_IS_BUFFER_POOL (pool));
+  g_return_if_fail (func != NULL);
+
+  priv = pool->priv;
+
+  reclaim = g_new (GstBufferPoolReclaim, 1);
+  reclaim->func = func;
+  reclaim->user_data = user_data;
+
+  g_mutex_lock (&priv->reclaim_lock);
+  priv->reclaims = g_slist_prepend (priv->reclaims, reclaim);
+  g_mutex_unlock (&priv->reclaim_lock);
+}
+
+/**
+ * gst_buffer_pool_remove_reclaim_func:
+ * @pool: a #GstBufferPool
+ * @func: the #GstBufferPoolReclaimFunc to remove
+ * @user_data: the user data @func was added with
+ *
+ * Removes a function added with gst_buffer_pool_add_reclaim_func(). When
+ * this function returns, @func is not running and will not be called
+ * anymore.
+ *
+ * Since: 1.10
+ */
+void
+gst_buffer_pool_remove_reclaim_func (GstBufferPool * pool,
+    GstBufferPoolReclaimFunc func, gpointer user_data)
+{
+  GstBufferPoolPrivate *priv;
+  GSList *walk;
+
+  g_return_if_fail (GST_IS_BUFFER_POOL (pool));
+  g_return_if_fail (func != NULL);
+
+  priv = pool->priv;
+
+  g_mutex_lock (&priv->reclaim_lock);
+  for (walk = priv->reclaims; walk; walk = walk->next) {
+    GstBufferPoolReclaim *reclaim = walk->data;
+
+    if (reclaim->func == func && reclaim->user_data == user_data) {
+      priv->reclaims = g_slist_delete_link (priv->reclaims, walk);
+      g_free (reclaim);
+      break;
+    }
+  }
+  g_mutex_unlock (&priv->reclaim_lock);
+}
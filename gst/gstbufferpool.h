@@ -26,6 +26,7 @@
 #include <gst/gstminiobject.h>
 #include <gst/gstpad.h>
 #include <gst/gstbuffer.h>
+#include <gst/gstmemorybudget.h>
 
 G_BEGIN_DECLS
 
@@ -175,6 +176,22 @@ struct _GstBufferPoolClass {
   gpointer _gst_reserved[GST_PADDING - 2];
 };
 
+/**
+ * GstBufferPoolReclaimFunc:
+ * @pool: the #GstBufferPool
+ * @user_data: the user data passed to gst_buffer_pool_add_reclaim_func()
+ *
+ * Called when @pool has no free buffers left and can't allocate more. The
+ * function should give back the buffers of @pool it only keeps as a
+ * convenience, such as the last rendered buffer of a sink.
+ *
+ * The function is called with a lock held and must not add or remove
+ * reclaim functions.
+ *
+ * Since: 1.10
+ */
+typedef void (*GstBufferPoolReclaimFunc) (GstBufferPool *pool, gpointer user_data);
+
 GType       gst_buffer_pool_get_type (void);
 
 /* allocation */
@@ -184,6 +201,8 @@ GstBufferPool *  gst_buffer_pool_new  (void);
 gboolean         gst_buffer_pool_set_active      (GstBufferPool *pool, gboolean active);
 gboolean         gst_buffer_pool_is_active       (GstBufferPool *pool);
 
+void             gst_buffer_pool_get_stats       (GstBufferPool *pool, GstAllocationStats *stats);
+
 gboolean         gst_buffer_pool_set_config      (GstBufferPool *pool, GstStructure *config);
 GstStructure *   gst_buffer_pool_get_config      (GstBufferPool *pool);
 
@@ -201,6 +220,18 @@ void             gst_buffer_pool_config_set_allocator (GstStructure *config, Gst
                                                        const GstAllocationParams *params);
 gboolean         gst_buffer_pool_config_get_allocator (GstStructure *config, GstAllocator **allocator,
                                                        GstAllocationParams *params);
+void             gst_buffer_pool_config_set_thread_cache_size (GstStructure *config, guint size);
+guint            gst_buffer_pool_config_get_thread_cache_size (GstStructure *config);
+void             gst_buffer_pool_config_set_memory_budget     (GstStructure *config, GstMemoryBudget *budget);
+GstMemoryBudget * gst_buffer_pool_config_get_memory_budget    (GstStructure *config);
+void             gst_buffer_pool_config_set_trim_idle_time    (GstStructure *config, GstClockTime idle_time);
+GstClockTime     gst_buffer_pool_config_get_trim_idle_time    (GstStructure *config);
+void             gst_buffer_pool_config_set_prefault          (GstStructure *config, gboolean prefault);
+gboolean         gst_buffer_pool_config_get_prefault          (GstStructure *config);
+void             gst_buffer_pool_config_set_lock_memory       (GstStructure *config, gboolean lock_memory);
+gboolean         gst_buffer_pool_config_get_lock_memory       (GstStructure *config);
+void             gst_buffer_pool_config_set_reuse_memory      (GstStructure *config, gboolean reuse_memory);
+gboolean         gst_buffer_pool_config_get_reuse_memory      (GstStructure *config);
 
 /* options */
 guint            gst_buffer_pool_config_n_options   (GstStructure *config);
@@ -215,6 +246,11 @@ GstFlowReturn    gst_buffer_pool_acquire_buffer  (GstBufferPool *pool, GstBuffer
                                                   GstBufferPoolAcquireParams *params);
 void             gst_buffer_pool_release_buffer  (GstBufferPool *pool, GstBuffer *buffer);
 
+void             gst_buffer_pool_add_reclaim_func    (GstBufferPool *pool, GstBufferPoolReclaimFunc func,
+                                                      gpointer user_data);
+void             gst_buffer_pool_remove_reclaim_func (GstBufferPool *pool, GstBufferPoolReclaimFunc func,
+                                                      gpointer user_data);
+
 G_END_DECLS
 
 #endif /* __GST_BUFFER_POOL_H__ */
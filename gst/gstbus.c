@@ -73,6 +73,7 @@
 #include <sys/types.h>
 
 #include "gstatomicqueue.h"
+#include "gstenumtypes.h"
 #include "gstinfo.h"
 #include "gstpoll.h"
 
@@ -90,11 +91,18 @@ enum
 };
 
 #define DEFAULT_ENABLE_ASYNC (TRUE)
+#define DEFAULT_COALESCE_TYPES (0)
+
+/* maximum number of messages a bus watch dispatches per main loop
+ * iteration, so that a message storm doesn't take one main loop iteration
+ * per message but other sources still get a chance to run */
+#define BUS_SOURCE_MAX_DISPATCH 32
 
 enum
 {
   PROP_0,
-  PROP_ENABLE_ASYNC
+  PROP_ENABLE_ASYNC,
+  PROP_COALESCE_TYPES
 };
 
 static void gst_bus_dispose (GObject * object);
@@ -119,6 +127,12 @@ struct _GstBusPrivate
   gboolean enable_async;
   GstPoll *poll;
   GPollFD pollfd;
+
+  /* GstMessageType, only the newest of these is dispatched by watches */
+  volatile gint coalesce_types;
+
+  /* GstMessageType, other messages are dropped when posted */
+  volatile gint accept_types;
 };
 
 #define gst_bus_parent_class parent_class
@@ -134,6 +148,25 @@ gst_bus_set_property (GObject * object,
     case PROP_ENABLE_ASYNC:
       bus->priv->enable_async = g_value_get_boolean (value);
       break;
+    case PROP_COALESCE_TYPES:
+      g_atomic_int_set (&bus->priv->coalesce_types, g_value_get_flags (value));
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_bus_get_property (GObject * object,
+    guint prop_id, GValue * value, GParamSpec * pspec)
+{
+  GstBus *bus = GST_BUS_CAST (object);
+
+  switch (prop_id) {
+    case PROP_COALESCE_TYPES:
+      g_value_set_flags (value, g_atomic_int_get (&bus->priv->coalesce_types));
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -159,6 +192,7 @@ gst_bus_class_init (GstBusClass * klass)
   gobject_class->dispose = gst_bus_dispose;
   gobject_class->finalize = gst_bus_finalize;
   gobject_class->set_property = gst_bus_set_property;
+  gobject_class->get_property = gst_bus_get_property;
   gobject_class->constructed = gst_bus_constructed;
 
   /**
@@ -177,6 +211,26 @@ gst_bus_class_init (GstBusClass * klass)
           DEFAULT_ENABLE_ASYNC,
           G_PARAM_CONSTRUCT_ONLY | G_PARAM_WRITABLE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstBus:coalesce-types:
+   *
+   * Message types for which bus watches only dispatch the newest message of
+   * a source. When a message of one of these types is followed on the bus
+   * by one of the same type from the same source, it is dropped without
+   * being dispatched.
+   *
+   * This is useful for messages that are superseded by the next one, like
+   * #GST_MESSAGE_BUFFERING or #GST_MESSAGE_QOS, when many of them are
+   * posted. gst_bus_pop() and similar functions still return all messages.
+   *
+   * Since: 1.10
+   */
+  g_object_class_install_property (gobject_class, PROP_COALESCE_TYPES,
+      g_param_spec_flags ("coalesce-types", "Coalesce Types",
+          "Message types for which watches only dispatch the newest message "
+          "of a source", GST_TYPE_MESSAGE_TYPE, DEFAULT_COALESCE_TYPES,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   /**
    * GstBus::sync-message:
    * @bus: the object which received the signal
@@ -217,6 +271,7 @@ gst_bus_init (GstBus * bus)
 {
   bus->priv = G_TYPE_INSTANCE_GET_PRIVATE (bus, GST_TYPE_BUS, GstBusPrivate);
   bus->priv->enable_async = DEFAULT_ENABLE_ASYNC;
+  bus->priv->accept_types = GST_MESSAGE_ANY;
   g_mutex_init (&bus->priv->queue_lock);
   bus->priv->queue = gst_atomic_queue_new (32);
 
@@ -307,11 +362,17 @@ gst_bus_post (GstBus * bus, GstMessage * message)
 
   GST_DEBUG_OBJECT (bus, "[msg %p] posting on bus %" GST_PTR_FORMAT, message,
       message);
+  GST_SDT_PROBE3 (bus_post, bus, message, GST_MESSAGE_TYPE (message));
 
   /* check we didn't accidentally add a public flag that maps to same value */
   g_assert (!GST_MINI_OBJECT_FLAG_IS_SET (message,
           GST_MESSAGE_FLAG_ASYNC_DELIVERY));
 
+  /* check if anyone is interested in this type */
+  if (G_UNLIKELY (!(GST_MESSAGE_TYPE (message) &
+              g_atomic_int_get (&bus->priv->accept_types))))
+    goto not_accepted;
+
   GST_OBJECT_LOCK (bus);
   /* check if the bus is flushing */
   if (GST_OBJECT_FLAG_IS_SET (bus, GST_BUS_FLUSHING))
@@ -396,6 +457,14 @@ gst_bus_post (GstBus * bus, GstMessage * message)
   return TRUE;
 
   /* ERRORS */
+not_accepted:
+  {
+    GST_DEBUG_OBJECT (bus, "[msg %p] dropped, type %s not accepted", message,
+        GST_MESSAGE_TYPE_NAME (message));
+    gst_message_unref (message);
+
+    return TRUE;
+  }
 is_flushing:
   {
     GST_DEBUG_OBJECT (bus, "bus is flushing");
@@ -469,6 +538,55 @@ gst_bus_set_flushing (GstBus * bus, gboolean flushing)
   g_list_free_full (message_list, (GDestroyNotify) gst_message_unref);
 }
 
+/**
+ * gst_bus_set_accept_types:
+ * @bus: a #GstBus
+ * @types: message types to accept, GST_MESSAGE_ANY for any type
+ *
+ * Only accept messages whose type matches the message type mask @types
+ * on @bus. Other messages are dropped as soon as they are posted, before
+ * the sync handler is called and before they are queued, so they will not
+ * be seen by any handler or watch of @bus.
+ *
+ * Elements can check with gst_element_message_will_be_posted() if a message
+ * would be accepted and skip creating messages that nobody is interested in.
+ *
+ * Note that the bins in a pipeline still receive all messages of their
+ * children, only the bus of the top-level bin should be configured.
+ *
+ * MT safe.
+ *
+ * Since: 1.10
+ */
+void
+gst_bus_set_accept_types (GstBus * bus, GstMessageType types)
+{
+  g_return_if_fail (GST_IS_BUS (bus));
+
+  GST_DEBUG_OBJECT (bus, "accepting message types 0x%08x", (guint) types);
+  g_atomic_int_set (&bus->priv->accept_types, types);
+}
+
+/**
+ * gst_bus_get_accept_types:
+ * @bus: a #GstBus
+ *
+ * Get the message types accepted by @bus, see gst_bus_set_accept_types().
+ *
+ * Returns: the accepted message types of @bus.
+ *
+ * MT safe.
+ *
+ * Since: 1.10
+ */
+GstMessageType
+gst_bus_get_accept_types (GstBus * bus)
+{
+  g_return_val_if_fail (GST_IS_BUS (bus), 0);
+
+  return (GstMessageType) g_atomic_int_get (&bus->priv->accept_types);
+}
+
 /**
  * gst_bus_timed_pop_filtered:
  * @bus: a #GstBus to pop from
@@ -759,15 +877,52 @@ gst_bus_source_check (GSource * source)
   return bsrc->bus->priv->pollfd.revents & (G_IO_IN | G_IO_HUP | G_IO_ERR);
 }
 
+/* pops the next message for a watch, dropping the messages of
+ * @coalesce_types that are directly followed by one of the same type and
+ * source */
+static GstMessage *
+gst_bus_pop_coalesced (GstBus * bus, GstMessageType coalesce_types)
+{
+  GstMessage *message, *next;
+
+  if (!coalesce_types)
+    return gst_bus_pop (bus);
+
+  g_mutex_lock (&bus->priv->queue_lock);
+  while ((message = gst_atomic_queue_pop (bus->priv->queue))) {
+    gst_poll_read_control (bus->priv->poll);
+
+    /* messages delivered asynchronously are waited for, never drop them */
+    if (!(GST_MESSAGE_TYPE (message) & coalesce_types)
+        || GST_MESSAGE_TYPE_IS_EXTENDED (message)
+        || GST_MINI_OBJECT_FLAG_IS_SET (message,
+            GST_MESSAGE_FLAG_ASYNC_DELIVERY))
+      break;
+
+    next = gst_atomic_queue_peek (bus->priv->queue);
+    if (!next || GST_MESSAGE_TYPE (next) != GST_MESSAGE_TYPE (message)
+        || GST_MESSAGE_SRC (next) != GST_MESSAGE_SRC (message))
+      break;
+
+    GST_LOG_OBJECT (bus, "dropping superseded %" GST_PTR_FORMAT, message);
+    gst_message_unref (message);
+  }
+  g_mutex_unlock (&bus->priv->queue_lock);
+
+  return message;
+}
+
 static gboolean
 gst_bus_source_dispatch (GSource * source, GSourceFunc callback,
     gpointer user_data)
 {
   GstBusFunc handler = (GstBusFunc) callback;
   GstBusSource *bsource = (GstBusSource *) source;
+  GstMessageType coalesce_types;
   GstMessage *message;
-  gboolean keep;
+  gboolean keep = TRUE;
   GstBus *bus;
+  guint i;
 
   g_return_val_if_fail (bsource != NULL, FALSE);
 
@@ -775,23 +930,34 @@ gst_bus_source_dispatch (GSource * source, GSourceFunc callback,
 
   g_return_val_if_fail (GST_IS_BUS (bus), FALSE);
 
-  message = gst_bus_pop (bus);
+  coalesce_types = g_atomic_int_get (&bus->priv->coalesce_types);
 
-  /* The message queue might be empty if some other thread or callback set
-   * the bus to flushing between check/prepare and dispatch */
-  if (G_UNLIKELY (message == NULL))
-    return TRUE;
+  /* dispatch what is on the bus in one go instead of taking a main loop
+   * iteration per message. Messages posted meanwhile are dispatched too,
+   * up to the maximum. */
+  for (i = 0; i < BUS_SOURCE_MAX_DISPATCH && keep; i++) {
+    /* the handler may have removed this watch */
+    if (i > 0 && g_source_is_destroyed (source))
+      break;
 
-  if (!handler)
-    goto no_handler;
+    message = gst_bus_pop_coalesced (bus, coalesce_types);
 
-  GST_DEBUG_OBJECT (bus, "source %p calling dispatch with %" GST_PTR_FORMAT,
-      source, message);
+    /* The message queue might be empty if some other thread or callback set
+     * the bus to flushing between check/prepare and dispatch */
+    if (G_UNLIKELY (message == NULL))
+      break;
 
-  keep = handler (bus, message, user_data);
-  gst_message_unref (message);
+    if (!handler)
+      goto no_handler;
 
-  GST_DEBUG_OBJECT (bus, "source %p handler returns %d", source, keep);
+    GST_DEBUG_OBJECT (bus, "source %p calling dispatch with %" GST_PTR_FORMAT,
+        source, message);
+
+    keep = handler (bus, message, user_data);
+    gst_message_unref (message);
+
+    GST_DEBUG_OBJECT (bus, "source %p handler returns %d", source, keep);
+  }
 
   return keep;
 
@@ -145,6 +145,8 @@ GstMessage *            gst_bus_pop_filtered            (GstBus * bus, GstMessag
 GstMessage *            gst_bus_timed_pop               (GstBus * bus, GstClockTime timeout);
 GstMessage *            gst_bus_timed_pop_filtered      (GstBus * bus, GstClockTime timeout, GstMessageType types);
 void                    gst_bus_set_flushing            (GstBus * bus, gboolean flushing);
+void                    gst_bus_set_accept_types        (GstBus * bus, GstMessageType types);
+GstMessageType          gst_bus_get_accept_types        (GstBus * bus);
 
 /* synchronous dispatching */
 void                    gst_bus_set_sync_handler        (GstBus * bus, GstBusSyncHandler func,
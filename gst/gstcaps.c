@@ -81,6 +81,12 @@ typedef struct _GstCapsImpl
   GstCaps caps;
 
   GArray *array;
+
+  /* set on caps that are never modified after creation, like static and
+   * pad template caps. Results of operations on them are cached */
+  gboolean immutable;
+  /* lazily computed structural hash of immutable caps, 0 when unset */
+  guint hash;
 } GstCapsImpl;
 
 #define GST_CAPS_ARRAY(c) (((GstCapsImpl *)(c))->array)
@@ -119,13 +125,56 @@ typedef struct _GstCapsImpl
     g_array_append_val (GST_CAPS_ARRAY (caps), __e);                             \
 }G_STMT_END
 
+/* caps that we store the results of operations for */
+#define CAPS_IS_CACHEABLE(caps)				\
+  (((GstCapsImpl *)(caps))->immutable && !CAPS_IS_ANY (caps) &&	\
+   !CAPS_IS_EMPTY_SIMPLE (caps))
+
 /* lock to protect multiple invocations of static caps to caps conversion */
 G_LOCK_DEFINE_STATIC (static_caps_lock);
 
+/* operations stored in the cache, after the GstCapsIntersectMode values */
+#define CAPS_CACHE_CAN_INTERSECT 0x100
+#define CAPS_CACHE_IS_SUBSET     0x101
+
+/* maximum number of operation results we keep around */
+#define CAPS_CACHE_MAX_ENTRIES 512
+
+typedef struct _GstCapsCacheEntry
+{
+  /* link in caps_cache_lru, data points to the entry */
+  GList link;
+  guint hash;
+
+  guint op;
+  GstCaps *caps1;
+  GstCaps *caps2;
+
+  /* result of intersections or of the boolean operations */
+  GstCaps *result;
+  gboolean boolean;
+} GstCapsCacheEntry;
+
+/* lock to protect the caps operation cache */
+G_LOCK_DEFINE_STATIC (caps_cache_lock);
+static GHashTable *caps_cache;
+static GQueue caps_cache_lru = G_QUEUE_INIT;
+
+static guint gst_caps_cache_entry_hash (gconstpointer key);
+static gboolean gst_caps_cache_entry_equal (gconstpointer a, gconstpointer b);
+static gboolean gst_caps_cache_lookup (guint op, const GstCaps * caps1,
+    const GstCaps * caps2, GstCaps ** result, gboolean * boolean);
+static void gst_caps_cache_insert (guint op, const GstCaps * caps1,
+    const GstCaps * caps2, GstCaps * result, gboolean boolean);
+static guint gst_caps_structure_hash (const GstStructure * structure,
+    const GstCapsFeatures * features);
+
 static void gst_caps_transform_to_string (const GValue * src_value,
     GValue * dest_value);
 static gboolean gst_caps_from_string_inplace (GstCaps * caps,
     const gchar * string);
+static gchar *gst_caps_to_string_internal (const GstCaps * caps,
+    gboolean cached);
 
 GType _gst_caps_type = 0;
 GstCaps *_gst_caps_any;
@@ -141,6 +190,9 @@ _priv_gst_caps_initialize (void)
   _gst_caps_any = gst_caps_new_any ();
   _gst_caps_none = gst_caps_new_empty ();
 
+  caps_cache = g_hash_table_new (gst_caps_cache_entry_hash,
+      gst_caps_cache_entry_equal);
+
   g_value_register_transform_func (_gst_caps_type,
       G_TYPE_STRING, gst_caps_transform_to_string);
 }
@@ -151,6 +203,43 @@ __gst_caps_get_features_unchecked (const GstCaps * caps, guint idx)
   return gst_caps_get_features_unchecked (caps, idx);
 }
 
+static void
+gst_caps_cache_entry_free (GstCapsCacheEntry * entry)
+{
+  gst_caps_unref (entry->caps1);
+  gst_caps_unref (entry->caps2);
+  if (entry->result)
+    gst_caps_unref (entry->result);
+  g_slice_free (GstCapsCacheEntry, entry);
+}
+
+void
+_priv_gst_caps_cleanup (void)
+{
+  GList *entries;
+
+  G_LOCK (caps_cache_lock);
+  entries = caps_cache_lru.head;
+  g_queue_init (&caps_cache_lru);
+  g_hash_table_remove_all (caps_cache);
+  G_UNLOCK (caps_cache_lock);
+
+  while (entries) {
+    GstCapsCacheEntry *entry = entries->data;
+
+    entries = entries->next;
+    gst_caps_cache_entry_free (entry);
+  }
+}
+
+/* mark @caps as never being modified again so that the results of
+ * operations on it can be cached */
+void
+_priv_gst_caps_set_immutable (GstCaps * caps)
+{
+  ((GstCapsImpl *) caps)->immutable = TRUE;
+}
+
 static GstCaps *
 _gst_caps_copy (const GstCaps * caps)
 {
@@ -223,6 +312,8 @@ gst_caps_init (GstCaps * caps)
    */
   GST_CAPS_ARRAY (caps) =
       g_array_new (FALSE, TRUE, sizeof (GstCapsArrayElement));
+  ((GstCapsImpl *) caps)->immutable = FALSE;
+  ((GstCapsImpl *) caps)->hash = 0;
 }
 
 /**
@@ -417,6 +508,8 @@ gst_static_caps_get (GstStaticCaps * static_caps)
     /* convert to string */
     if (G_UNLIKELY (*caps == NULL))
       g_critical ("Could not convert static caps \"%s\"", string);
+    else
+      _priv_gst_caps_set_immutable (*caps);
 
     GST_CAT_TRACE (GST_CAT_CAPS, "created %p from string %s", static_caps,
         string);
@@ -548,6 +641,176 @@ gst_caps_append (GstCaps * caps1, GstCaps * caps2)
   }
 }
 
+/* from this number of structures on, merging and simplifying index the
+ * structures instead of comparing each new one with all others */
+#define CAPS_INDEX_MIN_STRUCTURES 16
+
+/* structures of a caps, grouped by name and features */
+typedef struct
+{
+  /* group key -> GArray of the indices of the structures in the group */
+  GHashTable *groups;
+  /* structure hash -> index of the first structure with that hash */
+  GHashTable *exact;
+} GstCapsIndex;
+
+static guint
+gst_caps_features_hash (const GstCapsFeatures * features)
+{
+  guint i, n, hash = 0;
+
+  /* NULL, empty and sysmem features are all equal */
+  if (features == NULL)
+    return 0;
+  if (gst_caps_features_is_any (features))
+    return 1;
+  if (gst_caps_features_is_equal (features,
+          GST_CAPS_FEATURES_MEMORY_SYSTEM_MEMORY))
+    return 0;
+
+  /* features are not ordered, combine them commutatively */
+  n = gst_caps_features_get_size (features);
+  for (i = 0; i < n; i++)
+    hash += gst_caps_features_get_nth_id (features, i);
+
+  return hash;
+}
+
+static guint
+gst_caps_index_group_key (const GstStructure * structure, guint features_hash)
+{
+  return gst_structure_get_name_id (structure) * 31 + features_hash;
+}
+
+static void
+gst_caps_index_insert (GstCapsIndex * index, guint key, guint hash, guint idx)
+{
+  GArray *group;
+
+  group = g_hash_table_lookup (index->groups, GUINT_TO_POINTER (key));
+  if (group == NULL) {
+    group = g_array_new (FALSE, FALSE, sizeof (guint));
+    g_hash_table_insert (index->groups, GUINT_TO_POINTER (key), group);
+  }
+  g_array_append_val (group, idx);
+
+  if (!g_hash_table_contains (index->exact, GUINT_TO_POINTER (hash)))
+    g_hash_table_insert (index->exact, GUINT_TO_POINTER (hash),
+        GUINT_TO_POINTER (idx));
+}
+
+static void
+gst_caps_index_init (GstCapsIndex * index, const GstCaps * caps)
+{
+  GstStructure *s;
+  GstCapsFeatures *f;
+  guint i, n;
+
+  index->groups = g_hash_table_new_full (NULL, NULL, NULL,
+      (GDestroyNotify) g_array_unref);
+  index->exact = g_hash_table_new (NULL, NULL);
+
+  n = GST_CAPS_LEN (caps);
+  for (i = 0; i < n; i++) {
+    s = gst_caps_get_structure_unchecked (caps, i);
+    f = gst_caps_get_features_unchecked (caps, i);
+
+    gst_caps_index_insert (index,
+        gst_caps_index_group_key (s, gst_caps_features_hash (f)),
+        gst_caps_structure_hash (s, f), i);
+  }
+}
+
+static void
+gst_caps_index_clear (GstCapsIndex * index)
+{
+  g_hash_table_unref (index->groups);
+  g_hash_table_unref (index->exact);
+}
+
+/* same check as gst_caps_merge_structure_full() */
+static gboolean
+gst_caps_structure_is_expressed (const GstStructure * structure,
+    const GstCapsFeatures * features, const GstStructure * structure1,
+    const GstCapsFeatures * features1)
+{
+  if (!features1)
+    features1 = GST_CAPS_FEATURES_MEMORY_SYSTEM_MEMORY;
+
+  return (!gst_caps_features_is_any (features)
+      || gst_caps_features_is_any (features1))
+      && gst_caps_features_is_equal (features, features1)
+      && gst_structure_is_subset (structure, structure1);
+}
+
+static gboolean
+gst_caps_index_group_expresses (GstCapsIndex * index, const GstCaps * caps,
+    guint key, const GstStructure * structure, const GstCapsFeatures * features)
+{
+  GArray *group;
+  guint i, idx;
+
+  group = g_hash_table_lookup (index->groups, GUINT_TO_POINTER (key));
+  if (group == NULL)
+    return FALSE;
+
+  for (i = 0; i < group->len; i++) {
+    idx = g_array_index (group, guint, i);
+    if (gst_caps_structure_is_expressed (structure, features,
+            gst_caps_get_structure_unchecked (caps, idx),
+            gst_caps_get_features_unchecked (caps, idx)))
+      return TRUE;
+  }
+  return FALSE;
+}
+
+/* checks if @structure with @features is expressed by the indexed structures
+ * of @caps and returns the keys to insert it with otherwise */
+static gboolean
+gst_caps_index_lookup (GstCapsIndex * index, const GstCaps * caps,
+    const GstStructure * structure, const GstCapsFeatures * features,
+    guint * key, guint * hash)
+{
+  GstStructure *structure1;
+  GstCapsFeatures *features1;
+  gpointer value;
+  guint idx;
+
+  if (!features)
+    features = GST_CAPS_FEATURES_MEMORY_SYSTEM_MEMORY;
+
+  /* exact duplicates first, structure hashes are cheaper than subset checks
+   * over a whole group */
+  *hash = gst_caps_structure_hash (structure, features);
+  if (g_hash_table_lookup_extended (index->exact, GUINT_TO_POINTER (*hash),
+          NULL, &value)) {
+    idx = GPOINTER_TO_UINT (value);
+    structure1 = gst_caps_get_structure_unchecked (caps, idx);
+    features1 = gst_caps_get_features_unchecked (caps, idx);
+    if (!features1)
+      features1 = GST_CAPS_FEATURES_MEMORY_SYSTEM_MEMORY;
+
+    if (gst_caps_features_is_any (features) ==
+        gst_caps_features_is_any (features1)
+        && gst_caps_features_is_equal (features, features1)
+        && gst_structure_is_equal (structure, structure1))
+      return TRUE;
+  }
+
+  /* only structures with the same name and features can express it, and
+   * ANY features express all others */
+  *key = gst_caps_index_group_key (structure, gst_caps_features_hash (features));
+  if (gst_caps_index_group_expresses (index, caps, *key, structure, features))
+    return TRUE;
+
+  if (!gst_caps_features_is_any (features) &&
+      gst_caps_index_group_expresses (index, caps,
+          gst_caps_index_group_key (structure, 1), structure, features))
+    return TRUE;
+
+  return FALSE;
+}
+
 /**
  * gst_caps_merge:
  * @caps1: (transfer full): the #GstCaps that will take the new entries
@@ -580,10 +843,34 @@ gst_caps_merge (GstCaps * caps1, GstCaps * caps2)
   } else {
     caps2 = gst_caps_make_writable (caps2);
 
-    for (i = GST_CAPS_LEN (caps2); i; i--) {
-      gst_caps_remove_and_get_structure_and_features (caps2, 0, &structure,
-          &features);
-      caps1 = gst_caps_merge_structure_full (caps1, structure, features);
+    if (GST_CAPS_LEN (caps1) + GST_CAPS_LEN (caps2) >=
+        CAPS_INDEX_MIN_STRUCTURES) {
+      GstCapsIndex index;
+      guint key = 0, hash = 0;
+
+      gst_caps_index_init (&index, caps1);
+      for (i = GST_CAPS_LEN (caps2); i; i--) {
+        gst_caps_remove_and_get_structure_and_features (caps2, 0, &structure,
+            &features);
+        if (gst_caps_index_lookup (&index, caps1, structure, features, &key,
+                &hash)) {
+          gst_structure_free (structure);
+          if (features)
+            gst_caps_features_free (features);
+        } else {
+          /* copies keep the order, the indices stay valid */
+          caps1 = gst_caps_make_writable (caps1);
+          gst_caps_append_structure_unchecked (caps1, structure, features);
+          gst_caps_index_insert (&index, key, hash, GST_CAPS_LEN (caps1) - 1);
+        }
+      }
+      gst_caps_index_clear (&index);
+    } else {
+      for (i = GST_CAPS_LEN (caps2); i; i--) {
+        gst_caps_remove_and_get_structure_and_features (caps2, 0, &structure,
+            &features);
+        caps1 = gst_caps_merge_structure_full (caps1, structure, features);
+      }
     }
     gst_caps_unref (caps2);
     result = caps1;
@@ -1187,31 +1474,14 @@ gst_caps_is_always_compatible (const GstCaps * caps1, const GstCaps * caps2)
   return gst_caps_is_subset (caps1, caps2);
 }
 
-/**
- * gst_caps_is_subset:
- * @subset: a #GstCaps
- * @superset: a potentially greater #GstCaps
- *
- * Checks if all caps represented by @subset are also represented by @superset.
- *
- * Returns: %TRUE if @subset is a subset of @superset
- */
-gboolean
-gst_caps_is_subset (const GstCaps * subset, const GstCaps * superset)
+static gboolean
+gst_caps_is_subset_uncached (const GstCaps * subset, const GstCaps * superset)
 {
   GstStructure *s1, *s2;
   GstCapsFeatures *f1, *f2;
   gboolean ret = TRUE;
   gint i, j;
 
-  g_return_val_if_fail (subset != NULL, FALSE);
-  g_return_val_if_fail (superset != NULL, FALSE);
-
-  if (CAPS_IS_EMPTY (subset) || CAPS_IS_ANY (superset))
-    return TRUE;
-  if (CAPS_IS_ANY (subset) || CAPS_IS_EMPTY (superset))
-    return FALSE;
-
   for (i = GST_CAPS_LEN (subset) - 1; i >= 0; i--) {
     for (j = GST_CAPS_LEN (superset) - 1; j >= 0; j--) {
       s1 = gst_caps_get_structure_unchecked (subset, i);
@@ -1241,6 +1511,40 @@ gst_caps_is_subset (const GstCaps * subset, const GstCaps * superset)
   return ret;
 }
 
+/**
+ * gst_caps_is_subset:
+ * @subset: a #GstCaps
+ * @superset: a potentially greater #GstCaps
+ *
+ * Checks if all caps represented by @subset are also represented by @superset.
+ *
+ * Returns: %TRUE if @subset is a subset of @superset
+ */
+gboolean
+gst_caps_is_subset (const GstCaps * subset, const GstCaps * superset)
+{
+  gboolean ret;
+
+  g_return_val_if_fail (subset != NULL, FALSE);
+  g_return_val_if_fail (superset != NULL, FALSE);
+
+  if (CAPS_IS_EMPTY (subset) || CAPS_IS_ANY (superset))
+    return TRUE;
+  if (CAPS_IS_ANY (subset) || CAPS_IS_EMPTY (superset))
+    return FALSE;
+
+  if (CAPS_IS_CACHEABLE (subset) && CAPS_IS_CACHEABLE (superset)) {
+    if (!gst_caps_cache_lookup (CAPS_CACHE_IS_SUBSET, subset, superset, NULL,
+            &ret)) {
+      ret = gst_caps_is_subset_uncached (subset, superset);
+      gst_caps_cache_insert (CAPS_CACHE_IS_SUBSET, subset, superset, NULL, ret);
+    }
+    return ret;
+  }
+
+  return gst_caps_is_subset_uncached (subset, superset);
+}
+
 /**
  * gst_caps_is_subset_structure:
  * @caps: a #GstCaps
@@ -1393,20 +1697,198 @@ gst_caps_is_strictly_equal (const GstCaps * caps1, const GstCaps * caps2)
   return TRUE;
 }
 
+/* operation cache */
+
+static gboolean
+gst_caps_hash_field (GQuark field_id, const GValue * value, gpointer user_data)
+{
+  guint *hash = user_data;
+  gchar *str;
+  guint h;
+
+  h = field_id * 31;
+  str = gst_value_serialize (value);
+  if (str) {
+    h ^= g_str_hash (str);
+    g_free (str);
+  } else {
+    h ^= (guint) G_VALUE_TYPE (value);
+  }
+  /* fields are not ordered, combine them commutatively */
+  *hash += h;
+
+  return TRUE;
+}
+
+/* hash of a structure and its features. Strictly equal structures with
+ * equal features have the same hash */
+static guint
+gst_caps_structure_hash (const GstStructure * structure,
+    const GstCapsFeatures * features)
+{
+  guint hash;
+
+  hash = gst_structure_get_name_id (structure);
+  gst_structure_foreach (structure, gst_caps_hash_field, &hash);
+  if (features && (gst_caps_features_is_any (features)
+          || !gst_caps_features_is_equal (features,
+              GST_CAPS_FEATURES_MEMORY_SYSTEM_MEMORY))) {
+    gchar *str = gst_caps_features_to_string (features);
+
+    hash ^= g_str_hash (str);
+    g_free (str);
+  }
+
+  return hash;
+}
+
+/* structural hash of immutable caps. Caps that are strictly equal have the
+ * same hash, unless their lists are ordered differently. It is only computed
+ * once, the caps never change. */
+static guint
+gst_caps_get_hash (const GstCaps * caps)
+{
+  GstCapsImpl *impl = (GstCapsImpl *) caps;
+  GstStructure *s;
+  GstCapsFeatures *f;
+  guint i, n, hash, shash;
+
+  hash = (guint) g_atomic_int_get ((gint *) & impl->hash);
+  if (G_LIKELY (hash != 0))
+    return hash;
+
+  hash = 5381;
+  n = GST_CAPS_LEN (caps);
+  for (i = 0; i < n; i++) {
+    s = gst_caps_get_structure_unchecked (caps, i);
+    f = gst_caps_get_features_unchecked (caps, i);
+
+    shash = gst_caps_structure_hash (s, f);
+    hash = (hash << 5) + hash + shash;
+  }
+  /* 0 means not computed yet */
+  if (hash == 0)
+    hash = 1;
+
+  g_atomic_int_set ((gint *) & impl->hash, (gint) hash);
+
+  return hash;
+}
+
+static gboolean
+gst_caps_cache_caps_equal (const GstCaps * caps1, const GstCaps * caps2)
+{
+  /* entries keep a ref to their caps so they can't be modified and the
+   * pointers can't be reused, comparing them is enough most of the time */
+  if (caps1 == caps2)
+    return TRUE;
+
+  return gst_caps_get_hash (caps1) == gst_caps_get_hash (caps2) &&
+      gst_caps_is_strictly_equal (caps1, caps2);
+}
+
+static guint
+gst_caps_cache_entry_hash (gconstpointer key)
+{
+  return ((const GstCapsCacheEntry *) key)->hash;
+}
+
+static gboolean
+gst_caps_cache_entry_equal (gconstpointer a, gconstpointer b)
+{
+  const GstCapsCacheEntry *ea = a, *eb = b;
+
+  return ea->op == eb->op &&
+      gst_caps_cache_caps_equal (ea->caps1, eb->caps1) &&
+      gst_caps_cache_caps_equal (ea->caps2, eb->caps2);
+}
+
+static void
+gst_caps_cache_entry_init (GstCapsCacheEntry * entry, guint op,
+    const GstCaps * caps1, const GstCaps * caps2)
+{
+  entry->link.data = entry;
+  entry->link.prev = entry->link.next = NULL;
+  entry->op = op;
+  entry->caps1 = (GstCaps *) caps1;
+  entry->caps2 = (GstCaps *) caps2;
+  entry->hash = (gst_caps_get_hash (caps1) * 31 + gst_caps_get_hash (caps2))
+      ^ op;
+  entry->result = NULL;
+  entry->boolean = FALSE;
+}
+
+/* look up the result of @op on @caps1 and @caps2, which must both be
+ * CAPS_IS_CACHEABLE. Intersections return a ref to the cached caps
+ * in @result, the other operations their outcome in @boolean. */
+static gboolean
+gst_caps_cache_lookup (guint op, const GstCaps * caps1, const GstCaps * caps2,
+    GstCaps ** result, gboolean * boolean)
+{
+  GstCapsCacheEntry key, *entry;
+
+  gst_caps_cache_entry_init (&key, op, caps1, caps2);
+
+  G_LOCK (caps_cache_lock);
+  entry = g_hash_table_lookup (caps_cache, &key);
+  if (entry) {
+    /* move to the front, the tail is evicted first */
+    g_queue_unlink (&caps_cache_lru, &entry->link);
+    g_queue_push_head_link (&caps_cache_lru, &entry->link);
+
+    if (result)
+      *result = gst_caps_ref (entry->result);
+    if (boolean)
+      *boolean = entry->boolean;
+  }
+  G_UNLOCK (caps_cache_lock);
+
+  if (entry)
+    GST_CAT_TRACE (GST_CAT_CAPS, "cached result for op %u on %p and %p", op,
+        caps1, caps2);
+
+  return entry != NULL;
+}
+
+static void
+gst_caps_cache_insert (guint op, const GstCaps * caps1, const GstCaps * caps2,
+    GstCaps * result, gboolean boolean)
+{
+  GstCapsCacheEntry *entry, *evicted = NULL;
+  GList *link;
+
+  entry = g_slice_new (GstCapsCacheEntry);
+  gst_caps_cache_entry_init (entry, op, caps1, caps2);
+  gst_caps_ref (entry->caps1);
+  gst_caps_ref (entry->caps2);
+  entry->result = result ? gst_caps_ref (result) : NULL;
+  entry->boolean = boolean;
+
+  G_LOCK (caps_cache_lock);
+  if (G_UNLIKELY (g_hash_table_contains (caps_cache, entry))) {
+    /* another thread was faster */
+    evicted = entry;
+  } else {
+    g_hash_table_add (caps_cache, entry);
+    g_queue_push_head_link (&caps_cache_lru, &entry->link);
+
+    if (caps_cache_lru.length > CAPS_CACHE_MAX_ENTRIES) {
+      link = g_queue_pop_tail_link (&caps_cache_lru);
+      evicted = link->data;
+      g_hash_table_remove (caps_cache, evicted);
+    }
+  }
+  G_UNLOCK (caps_cache_lock);
+
+  if (evicted)
+    gst_caps_cache_entry_free (evicted);
+}
+
 /* intersect operation */
 
-/**
- * gst_caps_can_intersect:
- * @caps1: a #GstCaps to intersect
- * @caps2: a #GstCaps to intersect
- *
- * Tries intersecting @caps1 and @caps2 and reports whether the result would not
- * be empty
- *
- * Returns: %TRUE if intersection would be not empty
- */
-gboolean
-gst_caps_can_intersect (const GstCaps * caps1, const GstCaps * caps2)
+static gboolean
+gst_caps_can_intersect_uncached (const GstCaps * caps1,
+    const GstCaps * caps2)
 {
   guint64 i;                    /* index can be up to 2 * G_MAX_UINT */
   guint j, k, len1, len2;
@@ -1415,21 +1897,6 @@ gst_caps_can_intersect (const GstCaps * caps1, const GstCaps * caps2)
   GstCapsFeatures *features1;
   GstCapsFeatures *features2;
 
-  g_return_val_if_fail (GST_IS_CAPS (caps1), FALSE);
-  g_return_val_if_fail (GST_IS_CAPS (caps2), FALSE);
-
-  /* caps are exactly the same pointers */
-  if (G_UNLIKELY (caps1 == caps2))
-    return TRUE;
-
-  /* empty caps on either side, return empty */
-  if (G_UNLIKELY (CAPS_IS_EMPTY (caps1) || CAPS_IS_EMPTY (caps2)))
-    return FALSE;
-
-  /* one of the caps is any */
-  if (G_UNLIKELY (CAPS_IS_ANY (caps1) || CAPS_IS_ANY (caps2)))
-    return TRUE;
-
   /* run zigzag on top line then right line, this preserves the caps order
    * much better than a simple loop.
    *
@@ -1481,6 +1948,49 @@ gst_caps_can_intersect (const GstCaps * caps1, const GstCaps * caps2)
   return FALSE;
 }
 
+/**
+ * gst_caps_can_intersect:
+ * @caps1: a #GstCaps to intersect
+ * @caps2: a #GstCaps to intersect
+ *
+ * Tries intersecting @caps1 and @caps2 and reports whether the result would not
+ * be empty
+ *
+ * Returns: %TRUE if intersection would be not empty
+ */
+gboolean
+gst_caps_can_intersect (const GstCaps * caps1, const GstCaps * caps2)
+{
+  gboolean ret;
+
+  g_return_val_if_fail (GST_IS_CAPS (caps1), FALSE);
+  g_return_val_if_fail (GST_IS_CAPS (caps2), FALSE);
+
+  /* caps are exactly the same pointers */
+  if (G_UNLIKELY (caps1 == caps2))
+    return TRUE;
+
+  /* empty caps on either side, return empty */
+  if (G_UNLIKELY (CAPS_IS_EMPTY (caps1) || CAPS_IS_EMPTY (caps2)))
+    return FALSE;
+
+  /* one of the caps is any */
+  if (G_UNLIKELY (CAPS_IS_ANY (caps1) || CAPS_IS_ANY (caps2)))
+    return TRUE;
+
+  if (CAPS_IS_CACHEABLE (caps1) && CAPS_IS_CACHEABLE (caps2)) {
+    if (!gst_caps_cache_lookup (CAPS_CACHE_CAN_INTERSECT, caps1, caps2, NULL,
+            &ret)) {
+      ret = gst_caps_can_intersect_uncached (caps1, caps2);
+      gst_caps_cache_insert (CAPS_CACHE_CAN_INTERSECT, caps1, caps2, NULL,
+          ret);
+    }
+    return ret;
+  }
+
+  return gst_caps_can_intersect_uncached (caps1, caps2);
+}
+
 static GstCaps *
 gst_caps_intersect_zig_zag (GstCaps * caps1, GstCaps * caps2)
 {
@@ -1655,18 +2165,33 @@ GstCaps *
 gst_caps_intersect_full (GstCaps * caps1, GstCaps * caps2,
     GstCapsIntersectMode mode)
 {
+  gboolean cacheable;
+  GstCaps *result;
+
   g_return_val_if_fail (GST_IS_CAPS (caps1), NULL);
   g_return_val_if_fail (GST_IS_CAPS (caps2), NULL);
 
+  cacheable = caps1 != caps2 && CAPS_IS_CACHEABLE (caps1) &&
+      CAPS_IS_CACHEABLE (caps2);
+  if (cacheable && gst_caps_cache_lookup (mode, caps1, caps2, &result, NULL))
+    return result;
+
   switch (mode) {
     case GST_CAPS_INTERSECT_FIRST:
-      return gst_caps_intersect_first (caps1, caps2);
+      result = gst_caps_intersect_first (caps1, caps2);
+      break;
     default:
       g_warning ("Unknown caps intersect mode: %d", mode);
       /* fallthrough */
     case GST_CAPS_INTERSECT_ZIG_ZAG:
-      return gst_caps_intersect_zig_zag (caps1, caps2);
+      result = gst_caps_intersect_zig_zag (caps1, caps2);
+      break;
   }
+
+  if (cacheable)
+    gst_caps_cache_insert (mode, caps1, caps2, result, FALSE);
+
+  return result;
 }
 
 /**
@@ -2040,6 +2565,51 @@ gst_caps_switch_structures (GstCaps * caps, GstStructure * old,
   g_array_index (GST_CAPS_ARRAY (caps), GstCapsArrayElement, i).structure = new;
 }
 
+/* removes the structures of @caps that are exact duplicates of an earlier
+ * one, using the structure hashes to find them */
+static void
+gst_caps_remove_duplicates (GstCaps * caps)
+{
+  GHashTable *exact;
+  GstStructure *s, *s1;
+  GstCapsFeatures *f, *f1;
+  gpointer value;
+  guint i, idx, hash;
+
+  exact = g_hash_table_new (NULL, NULL);
+
+  for (i = 0; i < GST_CAPS_LEN (caps);) {
+    s = gst_caps_get_structure_unchecked (caps, i);
+    f = gst_caps_get_features_unchecked (caps, i);
+    if (!f)
+      f = GST_CAPS_FEATURES_MEMORY_SYSTEM_MEMORY;
+
+    hash = gst_caps_structure_hash (s, f);
+    if (g_hash_table_lookup_extended (exact, GUINT_TO_POINTER (hash), NULL,
+            &value)) {
+      /* earlier structures are never moved by removing a later one */
+      idx = GPOINTER_TO_UINT (value);
+      s1 = gst_caps_get_structure_unchecked (caps, idx);
+      f1 = gst_caps_get_features_unchecked (caps, idx);
+      if (!f1)
+        f1 = GST_CAPS_FEATURES_MEMORY_SYSTEM_MEMORY;
+
+      if (gst_caps_features_is_any (f) == gst_caps_features_is_any (f1)
+          && gst_caps_features_is_equal (f, f1)
+          && gst_structure_is_equal (s, s1)) {
+        gst_caps_remove_structure (caps, i);
+        continue;
+      }
+    } else {
+      g_hash_table_insert (exact, GUINT_TO_POINTER (hash),
+          GUINT_TO_POINTER (i));
+    }
+    i++;
+  }
+
+  g_hash_table_unref (exact);
+}
+
 /**
  * gst_caps_simplify:
  * @caps: (transfer full): a #GstCaps to simplify
@@ -2073,6 +2643,12 @@ gst_caps_simplify (GstCaps * caps)
 
   caps = gst_caps_make_writable (caps);
 
+  /* drop exact duplicates before the pairwise comparisons below */
+  if (start + 1 >= CAPS_INDEX_MIN_STRUCTURES) {
+    gst_caps_remove_duplicates (caps);
+    start = GST_CAPS_LEN (caps) - 1;
+  }
+
   g_array_sort (GST_CAPS_ARRAY (caps), gst_caps_compare_structures);
 
   for (i = start; i >= 0; i--) {
@@ -2175,6 +2751,20 @@ gst_caps_fixate (GstCaps * caps)
  */
 gchar *
 gst_caps_to_string (const GstCaps * caps)
+{
+  return gst_caps_to_string_internal (caps, FALSE);
+}
+
+/* gst_caps_to_string() for the debug log, see
+ * priv_gst_structure_append_to_gstring_cached() */
+gchar *
+priv_gst_caps_to_string_cached (const GstCaps * caps)
+{
+  return gst_caps_to_string_internal (caps, TRUE);
+}
+
+static gchar *
+gst_caps_to_string_internal (const GstCaps * caps, gboolean cached)
 {
   guint i, slen, clen;
   GString *s;
@@ -2230,7 +2820,10 @@ gst_caps_to_string (const GstCaps * caps)
       priv_gst_caps_features_append_to_gstring (features, s);
       g_string_append_c (s, ')');
     }
-    priv_gst_structure_append_to_gstring (structure, s);
+    if (cached)
+      priv_gst_structure_append_to_gstring_cached (structure, s);
+    else
+      priv_gst_structure_append_to_gstring (structure, s);
   }
   if (s->len && s->str[s->len - 1] == ';') {
     /* remove latest ';' */
@@ -2324,6 +2917,9 @@ gst_caps_from_string_inplace (GstCaps * caps, const gchar * string)
       g_free (copy);
       return FALSE;
     }
+    /* caps strings mostly come from static and template caps and repeat
+     * the same few names, share them between all copies of the caps */
+    priv_gst_structure_intern_strings (structure);
 
   append:
     gst_caps_append_structure_unchecked (caps, structure, features);
@@ -2364,6 +2960,184 @@ gst_caps_from_string (const gchar * string)
   }
 }
 
+/* how the features of a caps structure are stored */
+enum
+{
+  BINARY_FEATURES_NONE = 0,
+  BINARY_FEATURES_ANY,
+  BINARY_FEATURES_LIST
+};
+
+gboolean
+_priv_gst_caps_write_binary (GByteArray * array, const GstCaps * caps)
+{
+  GstCapsFeatures *features;
+  guint8 b;
+  guint i, j, n, len;
+
+  b = CAPS_IS_ANY (caps) ? 1 : 0;
+  g_byte_array_append (array, &b, 1);
+  if (CAPS_IS_ANY (caps))
+    return TRUE;
+
+  len = GST_CAPS_LEN (caps);
+  _priv_gst_binary_write_uint (array, len);
+  for (i = 0; i < len; i++) {
+    if (!_priv_gst_structure_write_binary (array,
+            gst_caps_get_structure_unchecked (caps, i)))
+      return FALSE;
+
+    features = gst_caps_get_features_unchecked (caps, i);
+    if (features && gst_caps_features_is_any (features)) {
+      b = BINARY_FEATURES_ANY;
+      g_byte_array_append (array, &b, 1);
+    } else if (!features || gst_caps_features_is_equal (features,
+            GST_CAPS_FEATURES_MEMORY_SYSTEM_MEMORY)) {
+      b = BINARY_FEATURES_NONE;
+      g_byte_array_append (array, &b, 1);
+    } else {
+      b = BINARY_FEATURES_LIST;
+      g_byte_array_append (array, &b, 1);
+      n = gst_caps_features_get_size (features);
+      _priv_gst_binary_write_uint (array, n);
+      for (j = 0; j < n; j++)
+        _priv_gst_binary_write_string (array,
+            gst_caps_features_get_nth (features, j));
+    }
+  }
+
+  return TRUE;
+}
+
+GstCaps *
+_priv_gst_caps_read_binary (GstBinaryReader * reader)
+{
+  GstCaps *caps;
+  GstStructure *structure;
+  GstCapsFeatures *features;
+  const gchar *str;
+  guint64 i, j, n, len;
+  guint8 b;
+
+  if (!_priv_gst_binary_read_uint8 (reader, &b))
+    return NULL;
+  if (b)
+    return gst_caps_new_any ();
+
+  if (!_priv_gst_binary_read_uint (reader, &len))
+    return NULL;
+
+  caps = gst_caps_new_empty ();
+  for (i = 0; i < len; i++) {
+    structure = _priv_gst_structure_read_binary (reader);
+    if (structure == NULL)
+      goto error;
+
+    if (!_priv_gst_binary_read_uint8 (reader, &b)) {
+      gst_structure_free (structure);
+      goto error;
+    }
+
+    features = NULL;
+    if (b == BINARY_FEATURES_ANY) {
+      features = gst_caps_features_new_any ();
+    } else if (b == BINARY_FEATURES_LIST) {
+      features = gst_caps_features_new_empty ();
+      if (!_priv_gst_binary_read_uint (reader, &n))
+        goto features_error;
+      for (j = 0; j < n; j++) {
+        if (!_priv_gst_binary_read_string (reader, &str) || str == NULL)
+          goto features_error;
+        gst_caps_features_add (features, str);
+      }
+    } else if (b != BINARY_FEATURES_NONE) {
+      gst_structure_free (structure);
+      goto error;
+    }
+
+    gst_caps_append_structure_full (caps, structure, features);
+  }
+
+  return caps;
+
+  /* ERRORS */
+features_error:
+  {
+    gst_caps_features_free (features);
+    gst_structure_free (structure);
+    goto error;
+  }
+error:
+  {
+    GST_CAT_WARNING (GST_CAT_CAPS, "invalid binary data for caps");
+    gst_caps_unref (caps);
+    return NULL;
+  }
+}
+
+/**
+ * gst_caps_serialize_binary:
+ * @caps: a #GstCaps
+ *
+ * Serializes @caps into a compact, versioned binary representation. The
+ * result can be turned back into equal caps with
+ * gst_caps_deserialize_binary(), also in another process.
+ *
+ * Returns: (transfer full) (nullable): the serialized @caps, or %NULL if a
+ *     value could not be serialized.
+ *
+ * Since: 1.10
+ */
+GBytes *
+gst_caps_serialize_binary (const GstCaps * caps)
+{
+  GByteArray *array;
+
+  g_return_val_if_fail (GST_IS_CAPS (caps), NULL);
+
+  array = g_byte_array_new ();
+  _priv_gst_binary_write_version (array);
+  if (!_priv_gst_caps_write_binary (array, caps)) {
+    g_byte_array_unref (array);
+    return NULL;
+  }
+
+  return g_byte_array_free_to_bytes (array);
+}
+
+/**
+ * gst_caps_deserialize_binary:
+ * @data: (array length=size): data created with gst_caps_serialize_binary()
+ * @size: the size of @data
+ * @consumed: (out) (allow-none): the number of bytes of @data that were used
+ *
+ * Creates a #GstCaps from its binary representation in @data. Unlike
+ * gst_caps_from_string() this does not need to parse any values.
+ *
+ * Returns: (transfer full) (nullable): a new #GstCaps or %NULL when @data
+ *     is not valid serialized caps.
+ *
+ * Since: 1.10
+ */
+GstCaps *
+gst_caps_deserialize_binary (const guint8 * data, gsize size,
+    gsize * consumed)
+{
+  GstBinaryReader reader = { data, size, 0, 0 };
+  GstCaps *caps;
+
+  g_return_val_if_fail (data != NULL || size == 0, NULL);
+
+  if (!_priv_gst_binary_read_version (&reader))
+    return NULL;
+
+  caps = _priv_gst_caps_read_binary (&reader);
+  if (caps && consumed)
+    *consumed = reader.pos;
+
+  return caps;
+}
+
 static void
 gst_caps_transform_to_string (const GValue * src_value, GValue * dest_value)
 {
@@ -501,6 +501,11 @@ GstCaps *         gst_caps_fixate                  (GstCaps *caps) G_GNUC_WARN_U
 gchar *           gst_caps_to_string               (const GstCaps *caps) G_GNUC_MALLOC;
 GstCaps *         gst_caps_from_string             (const gchar   *string) G_GNUC_WARN_UNUSED_RESULT;
 
+GBytes *          gst_caps_serialize_binary        (const GstCaps *caps);
+GstCaps *         gst_caps_deserialize_binary      (const guint8  *data,
+                                                    gsize          size,
+                                                    gsize         *consumed) G_GNUC_WARN_UNUSED_RESULT;
+
 #ifdef G_DEFINE_AUTOPTR_CLEANUP_FUNC
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(GstCaps, gst_caps_unref)
 #endif
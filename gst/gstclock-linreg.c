@@ -60,7 +60,7 @@ _priv_gst_do_linear_regression (GstClockTime * times, guint n,
 {
   GstClockTime *newx, *newy;
   GstClockTime xmin, ymin, xbar, ybar, xbar4, ybar4;
-  GstClockTime xmax, ymax;
+  GstClockTime xmax, ymax, dmax;
   GstClockTimeDiff sxx, sxy, syy;
   GstClockTime *x, *y;
   gint i, j;
@@ -82,6 +82,18 @@ _priv_gst_do_linear_regression (GstClockTime * times, guint n,
     ymax = MAX (ymax, y[j]);
   }
 
+  /* quantities on the order of 1e10 to 1e13 -> 30-35 bits;
+   * window size a max of 2^10, so the sums for the means end up around
+   * 2^45 or so -- ample headroom. Just in case assumptions about headroom
+   * prove false, let's check */
+  if (G_UNLIKELY (xmax - xmin > G_MAXUINT64 / n
+          || ymax - ymin > G_MAXUINT64 / n)) {
+    GST_CAT_WARNING (GST_CAT_CLOCK,
+        "Regression overflowed in clock slaving! x range %" G_GUINT64_FORMAT
+        " y range %" G_GUINT64_FORMAT " n %u", xmax - xmin, ymax - ymin, n);
+    return FALSE;
+  }
+
   newx = times + 1;
   newy = times + 3;
 
@@ -89,7 +101,11 @@ _priv_gst_do_linear_regression (GstClockTime * times, guint n,
   for (i = j = 0; i < n; i++, j += 4) {
     newx[j] = x[j] - xmin;
     newy[j] = y[j] - ymin;
+    xbar += newx[j];
+    ybar += newy[j];
   }
+  xbar /= n;
+  ybar /= n;
 
 #ifdef DEBUGGING_ENABLED
   GST_CAT_DEBUG (GST_CAT_CLOCK, "reduced numbers:");
@@ -99,118 +115,34 @@ _priv_gst_do_linear_regression (GstClockTime * times, guint n,
 #endif
 
   /* have to do this precisely otherwise the results are pretty much useless.
-   * should guarantee that none of these accumulators can overflow */
-
-  /* quantities on the order of 1e10 to 1e13 -> 30-35 bits;
-   * window size a max of 2^10, so
-   this addition could end up around 2^45 or so -- ample headroom */
-  for (i = j = 0; i < n; i++, j += 4) {
-    /* Just in case assumptions about headroom prove false, let's check */
-    if ((newx[j] > 0 && G_MAXUINT64 - xbar <= newx[j]) ||
-        (newy[j] > 0 && G_MAXUINT64 - ybar <= newy[j])) {
-      GST_CAT_WARNING (GST_CAT_CLOCK,
-          "Regression overflowed in clock slaving! xbar %"
-          G_GUINT64_FORMAT " newx[j] %" G_GUINT64_FORMAT " ybar %"
-          G_GUINT64_FORMAT " newy[j] %" G_GUINT64_FORMAT, xbar, newx[j], ybar,
-          newy[j]);
-      return FALSE;
-    }
-
-    xbar += newx[j];
-    ybar += newy[j];
-  }
-  xbar /= n;
-  ybar /= n;
-
-  /* multiplying directly would give quantities on the order of 1e20-1e26 ->
+   * Multiplying directly would give quantities on the order of 1e20-1e26 ->
    * 60 bits to 70 bits times the window size that's 80 which is too much.
-   * Instead we (1) subtract off the xbar*ybar in the loop instead of after,
-   * to avoid accumulation; (2) shift off some estimated number of bits from
-   * each multiplicand to limit the expected ceiling. For strange
-   * distributions of input values, things can still overflow, in which
-   * case we drop precision and retry - at most a few times, in practice rarely
-   */
-
-  /* Guess how many bits we might need for the usual distribution of input,
-   * with a fallback loop that drops precision if things go pear-shaped */
-  max_bits = gst_log2 (MAX (xmax - xmin, ymax - ymin)) * 7 / 8 + gst_log2 (n);
-  if (max_bits > 64)
-    pshift = max_bits - 64;
-
-  i = 0;
-  do {
+   * Instead we sum the products of the deviations from the means, and shift
+   * off just enough bits from them up front so that none of the
+   * accumulators can overflow: no deviation is bigger than dmax, which
+   * leaves max_bits for the n products. Without any overflow checks in the
+   * loop, the compiler can vectorize it. */
+  dmax = MAX (MAX (xmax - xmin - xbar, xbar), MAX (ymax - ymin - ybar, ybar));
+  max_bits = 2 * (gst_log2 (dmax + 1) + 1) + gst_log2 (n) + 1;
+  if (max_bits > 63)
+    pshift = (max_bits - 63 + 1) / 2;
+
 #ifdef DEBUGGING_ENABLED
-    GST_CAT_DEBUG (GST_CAT_CLOCK,
-        "Restarting regression with precision shift %u", pshift);
+  GST_CAT_DEBUG (GST_CAT_CLOCK, "Regression with precision shift %u", pshift);
 #endif
 
-    xbar4 = xbar >> pshift;
-    ybar4 = ybar >> pshift;
-    sxx = syy = sxy = 0;
-    for (i = j = 0; i < n; i++, j += 4) {
-      GstClockTime newx4, newy4;
-      GstClockTimeDiff tmp;
-
-      newx4 = newx[j] >> pshift;
-      newy4 = newy[j] >> pshift;
-
-      tmp = (newx4 + xbar4) * (newx4 - xbar4);
-      if (G_UNLIKELY (tmp > 0 && sxx > 0 && (G_MAXINT64 - sxx <= tmp))) {
-        do {
-          /* Drop some precision and restart */
-          pshift++;
-          sxx /= 4;
-          tmp /= 4;
-        } while (G_MAXINT64 - sxx <= tmp);
-        break;
-      } else if (G_UNLIKELY (tmp < 0 && sxx < 0 && (G_MAXINT64 - sxx >= tmp))) {
-        do {
-          /* Drop some precision and restart */
-          pshift++;
-          sxx /= 4;
-          tmp /= 4;
-        } while (G_MININT64 - sxx >= tmp);
-        break;
-      }
-      sxx += tmp;
-
-      tmp = newy4 * newy4 - ybar4 * ybar4;
-      if (G_UNLIKELY (tmp > 0 && syy > 0 && (G_MAXINT64 - syy <= tmp))) {
-        do {
-          pshift++;
-          syy /= 4;
-          tmp /= 4;
-        } while (G_MAXINT64 - syy <= tmp);
-        break;
-      } else if (G_UNLIKELY (tmp < 0 && syy < 0 && (G_MAXINT64 - syy >= tmp))) {
-        do {
-          pshift++;
-          syy /= 4;
-          tmp /= 4;
-        } while (G_MININT64 - syy >= tmp);
-        break;
-      }
-      syy += tmp;
-
-      tmp = newx4 * newy4 - xbar4 * ybar4;
-      if (G_UNLIKELY (tmp > 0 && sxy > 0 && (G_MAXINT64 - sxy <= tmp))) {
-        do {
-          pshift++;
-          sxy /= 4;
-          tmp /= 4;
-        } while (G_MAXINT64 - sxy <= tmp);
-        break;
-      } else if (G_UNLIKELY (tmp < 0 && sxy < 0 && (G_MININT64 - sxy >= tmp))) {
-        do {
-          pshift++;
-          sxy /= 4;
-          tmp /= 4;
-        } while (G_MININT64 - sxy >= tmp);
-        break;
-      }
-      sxy += tmp;
-    }
-  } while (i < n);
+  xbar4 = xbar >> pshift;
+  ybar4 = ybar >> pshift;
+  for (i = j = 0; i < n; i++, j += 4) {
+    GstClockTimeDiff dx, dy;
+
+    dx = (GstClockTimeDiff) (newx[j] >> pshift) - (GstClockTimeDiff) xbar4;
+    dy = (GstClockTimeDiff) (newy[j] >> pshift) - (GstClockTimeDiff) ybar4;
+
+    sxx += dx * dx;
+    syy += dy * dy;
+    sxy += dx * dy;
+  }
 
   if (G_UNLIKELY (sxx == 0))
     goto invalid;
@@ -239,3 +171,150 @@ invalid:
     return FALSE;
   }
 }
+
+/* Streaming version of the regression above, for sliding windows of
+ * observations. Instead of going over the whole window for every new
+ * observation, the means and the sums of the squared deviations are
+ * updated when an observation enters or leaves the window (Welford's
+ * method). All values are kept relative to a reference observation so that
+ * the doubles only have to hold the spread of the window and not the
+ * absolute times.
+ *
+ * Rounding errors accumulate with every update, so the caller is expected
+ * to call _priv_gst_linear_regression_rebuild() every now and then, which
+ * also moves the reference closer to the current observations.
+ *
+ * with SLAVE_LOCK
+ */
+void
+_priv_gst_linear_regression_reset (GstClockRegression * reg)
+{
+  memset (reg, 0, sizeof (GstClockRegression));
+}
+
+void
+_priv_gst_linear_regression_add (GstClockRegression * reg, GstClockTime x,
+    GstClockTime y)
+{
+  gdouble dx, dy;
+
+  if (G_UNLIKELY (reg->n == 0)) {
+    reg->xref = x;
+    reg->yref = y;
+  }
+
+  dx = GST_CLOCK_DIFF (reg->xref, x) - reg->xbar;
+  dy = GST_CLOCK_DIFF (reg->yref, y) - reg->ybar;
+
+  reg->n++;
+  reg->xbar += dx / reg->n;
+  reg->ybar += dy / reg->n;
+
+  /* the deviation from the old mean times the deviation from the new mean */
+  reg->sxx += dx * (GST_CLOCK_DIFF (reg->xref, x) - reg->xbar);
+  reg->syy += dy * (GST_CLOCK_DIFF (reg->yref, y) - reg->ybar);
+  reg->sxy += dx * (GST_CLOCK_DIFF (reg->yref, y) - reg->ybar);
+}
+
+void
+_priv_gst_linear_regression_remove (GstClockRegression * reg,
+    GstClockTime x, GstClockTime y)
+{
+  gdouble rx, ry, dx, dy, xbar, ybar;
+
+  g_return_if_fail (reg->n > 0);
+
+  if (G_UNLIKELY (reg->n == 1)) {
+    _priv_gst_linear_regression_reset (reg);
+    return;
+  }
+
+  rx = GST_CLOCK_DIFF (reg->xref, x);
+  ry = GST_CLOCK_DIFF (reg->yref, y);
+
+  /* the means without this observation */
+  xbar = (reg->xbar * reg->n - rx) / (reg->n - 1);
+  ybar = (reg->ybar * reg->n - ry) / (reg->n - 1);
+
+  /* undo the update done by _add() */
+  dx = rx - xbar;
+  dy = ry - ybar;
+  reg->sxx -= dx * (rx - reg->xbar);
+  reg->syy -= dy * (ry - reg->ybar);
+  reg->sxy -= dx * (ry - reg->ybar);
+
+  reg->n--;
+  reg->xbar = xbar;
+  reg->ybar = ybar;
+
+  /* can only be rounding errors */
+  if (reg->sxx < 0.0)
+    reg->sxx = 0.0;
+  if (reg->syy < 0.0)
+    reg->syy = 0.0;
+}
+
+/* recalculate the state from the @n observations in @times, laid out as for
+ * _priv_gst_do_linear_regression() */
+void
+_priv_gst_linear_regression_rebuild (GstClockRegression * reg,
+    GstClockTime * times, guint n)
+{
+  gint i, j;
+
+  _priv_gst_linear_regression_reset (reg);
+  for (i = j = 0; i < n; i++, j += 4)
+    _priv_gst_linear_regression_add (reg, times[j], times[j + 2]);
+}
+
+/* The rate is returned as a fraction with a fixed denominator, the result
+ * of the streaming regression is a double anyway. @xbase is the most recent
+ * observation, as for _priv_gst_do_linear_regression(). */
+#define LINREG_RATE_DENOM (G_GUINT64_CONSTANT (1) << 40)
+
+gboolean
+_priv_gst_linear_regression_get (GstClockRegression * reg, GstClockTime xbase,
+    GstClockTime * m_num, GstClockTime * m_denom, GstClockTime * b,
+    gdouble * r_squared)
+{
+  gdouble m, y;
+
+  if (G_UNLIKELY (reg->n < 2 || reg->sxx <= 0.0))
+    goto invalid;
+
+  m = reg->sxy / reg->sxx;
+  if (G_UNLIKELY (m <= 0.0 || m * LINREG_RATE_DENOM >= G_MAXUINT64))
+    goto invalid;
+
+  /* the regression line goes through the means */
+  y = reg->ybar + m * (GST_CLOCK_DIFF (reg->xref, xbase) - reg->xbar);
+  if (G_UNLIKELY (y < 0.0 && -y > reg->yref))
+    goto invalid;
+
+  *m_num = (GstClockTime) (m * LINREG_RATE_DENOM + 0.5);
+  *m_denom = LINREG_RATE_DENOM;
+  if (y < 0.0)
+    *b = reg->yref - (GstClockTime) (-y + 0.5);
+  else
+    *b = reg->yref + (GstClockTime) (y + 0.5);
+
+  if (reg->syy > 0.0)
+    *r_squared = (reg->sxy * reg->sxy) / (reg->sxx * reg->syy);
+  else
+    *r_squared = 1.0;
+
+#ifdef DEBUGGING_ENABLED
+  GST_CAT_DEBUG (GST_CAT_CLOCK, "  m      = %g", m);
+  GST_CAT_DEBUG (GST_CAT_CLOCK, "  b      = %" G_GUINT64_FORMAT, *b);
+  GST_CAT_DEBUG (GST_CAT_CLOCK, "  xbase  = %" G_GUINT64_FORMAT, xbase);
+  GST_CAT_DEBUG (GST_CAT_CLOCK, "  r2     = %g", *r_squared);
+#endif
+
+  return TRUE;
+
+invalid:
+  {
+    GST_CAT_DEBUG (GST_CAT_CLOCK, "no valid regression");
+    return FALSE;
+  }
+}
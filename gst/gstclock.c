@@ -163,6 +163,7 @@ struct _GstClockPrivate
   gint time_index;
   GstClockTime timeout;
   GstClockTime *times;
+  GstClockRegression regression;
   GstClockID clockid;
 
   gint pre_count;
@@ -182,9 +183,13 @@ read_seqretry (GstClock * clock, gint seq)
   if (G_LIKELY (seq == g_atomic_int_get (&clock->priv->pre_count)))
     return FALSE;
 
-  /* wait for the writer to finish and retry */
-  GST_OBJECT_LOCK (clock);
-  GST_OBJECT_UNLOCK (clock);
+  /* wait for the writer to finish and retry. Readers never take the lock so
+   * that they don't contend with each other or with the writer, a write
+   * only stores a few values */
+  while (g_atomic_int_get (&clock->priv->pre_count) !=
+      g_atomic_int_get (&clock->priv->post_count))
+    g_thread_yield ();
+
   return TRUE;
 }
 
@@ -545,7 +550,9 @@ gst_clock_id_wait (GstClockID id, GstClockTimeDiff * jitter)
   if (G_UNLIKELY (cclass->wait == NULL))
     goto not_supported;
 
+  GST_SDT_PROBE3 (clock_wait, clock, id, requested);
   res = cclass->wait (clock, entry, jitter);
+  GST_SDT_PROBE3 (clock_wait_done, clock, id, res);
 
   GST_CAT_DEBUG_OBJECT (GST_CAT_CLOCK, clock,
       "done waiting entry %p, res: %d (%s)", id, res,
@@ -1082,21 +1089,51 @@ not_supported:
 GstClockTime
 gst_clock_get_time (GstClock * clock)
 {
-  GstClockTime ret;
+  GstClockTime ret, internal, cinternal, cexternal, cnum, cdenom;
+  GstClockPrivate *priv;
+  GstClockClass *cclass;
+  gboolean fast;
   gint seq;
 
   g_return_val_if_fail (GST_IS_CLOCK (clock), GST_CLOCK_TIME_NONE);
 
+  /* this is called a lot, so call the vfunc directly instead of going
+   * through gst_clock_get_internal_time() and its checks when we can */
+  priv = clock->priv;
+  cclass = GST_CLOCK_GET_CLASS (clock);
+  fast = cclass->get_internal_time != NULL
+      && (!GST_OBJECT_FLAG_IS_SET (clock, GST_CLOCK_FLAG_NEEDS_STARTUP_SYNC)
+      || clock->priv->synced);
+
   do {
     /* reget the internal time when we retry to get the most current
-     * timevalue */
-    ret = gst_clock_get_internal_time (clock);
+     * timevalue. The calibration is read without the lock, the seqlock
+     * makes us retry if it changed meanwhile. */
+    if (G_LIKELY (fast))
+      internal = cclass->get_internal_time (clock);
+    else
+      internal = gst_clock_get_internal_time (clock);
 
+    /* only copy the calibration here, values read during a write are
+     * garbage and must not end up in last_time */
     seq = read_seqbegin (clock);
-    /* this will scale for rate and offset */
-    ret = gst_clock_adjust_unlocked (clock, ret);
+    cinternal = priv->internal_calibration;
+    cexternal = priv->external_calibration;
+    cnum = priv->rate_numerator;
+    cdenom = priv->rate_denominator;
   } while (read_seqretry (clock, seq));
 
+  /* this will scale for rate and offset */
+  ret = gst_clock_adjust_with_calibration (clock, internal, cinternal,
+      cexternal, cnum, cdenom);
+
+  /* make sure the time is increasing, without writing to the shared
+   * last_time when not needed */
+  if (G_LIKELY (ret > priv->last_time))
+    priv->last_time = ret;
+  else
+    ret = priv->last_time;
+
   GST_CAT_DEBUG_OBJECT (GST_CAT_CLOCK, clock, "adjusted time %" GST_TIME_FORMAT,
       GST_TIME_ARGS (ret));
 
@@ -1148,13 +1185,14 @@ gst_clock_set_calibration (GstClock * clock, GstClockTime internal, GstClockTime
 
   priv = clock->priv;
 
-  write_seqlock (clock);
   GST_CAT_DEBUG_OBJECT (GST_CAT_CLOCK, clock,
       "internal %" GST_TIME_FORMAT " external %" GST_TIME_FORMAT " %"
       G_GUINT64_FORMAT "/%" G_GUINT64_FORMAT " = %f", GST_TIME_ARGS (internal),
       GST_TIME_ARGS (external), rate_num, rate_denom,
       gst_guint64_to_gdouble (rate_num) / gst_guint64_to_gdouble (rate_denom));
 
+  /* keep the write section short, readers spin while it runs */
+  write_seqlock (clock);
   priv->internal_calibration = internal;
   priv->external_calibration = external;
   priv->rate_numerator = rate_num;
@@ -1285,6 +1323,7 @@ gst_clock_set_master (GstClock * clock, GstClock * master)
   if (master) {
     priv->filling = TRUE;
     priv->time_index = 0;
+    _priv_gst_linear_regression_reset (&priv->regression);
     /* use the master periodic id to schedule sampling and
      * clock calibration. */
     priv->clockid = gst_clock_new_periodic_id (master,
@@ -1418,7 +1457,6 @@ gst_clock_add_observation_unapplied (GstClock * clock, GstClockTime slave,
 {
   GstClockTime m_num, m_denom, b, xbase;
   GstClockPrivate *priv;
-  guint n;
 
   g_return_val_if_fail (GST_IS_CLOCK (clock), FALSE);
   g_return_val_if_fail (r_squared != NULL, FALSE);
@@ -1431,21 +1469,33 @@ gst_clock_add_observation_unapplied (GstClock * clock, GstClockTime slave,
       "adding observation slave %" GST_TIME_FORMAT ", master %" GST_TIME_FORMAT,
       GST_TIME_ARGS (slave), GST_TIME_ARGS (master));
 
+  /* once the window is full, the observation we overwrite is the oldest
+   * one and leaves the window */
+  if (!priv->filling)
+    _priv_gst_linear_regression_remove (&priv->regression,
+        priv->times[(4 * priv->time_index)],
+        priv->times[(4 * priv->time_index) + 2]);
+
   priv->times[(4 * priv->time_index)] = slave;
   priv->times[(4 * priv->time_index) + 2] = master;
+  _priv_gst_linear_regression_add (&priv->regression, slave, master);
 
   priv->time_index++;
   if (G_UNLIKELY (priv->time_index == priv->window_size)) {
     priv->filling = FALSE;
     priv->time_index = 0;
+    /* get rid of accumulated rounding errors once per window, this keeps
+     * the cost per observation constant */
+    _priv_gst_linear_regression_rebuild (&priv->regression, priv->times,
+        priv->window_size);
   }
 
   if (G_UNLIKELY (priv->filling && priv->time_index < priv->window_threshold))
     goto filling;
 
-  n = priv->filling ? priv->time_index : priv->window_size;
-  if (!_priv_gst_do_linear_regression (priv->times, n, &m_num, &m_denom, &b,
-          &xbase, r_squared))
+  xbase = slave;
+  if (!_priv_gst_linear_regression_get (&priv->regression, xbase, &m_num,
+          &m_denom, &b, r_squared))
     goto invalid;
 
   GST_CLOCK_SLAVE_UNLOCK (clock);
@@ -1537,6 +1587,7 @@ gst_clock_set_property (GObject * object, guint prop_id,
       /* restart calibration */
       priv->filling = TRUE;
       priv->time_index = 0;
+      _priv_gst_linear_regression_reset (&priv->regression);
       GST_CLOCK_SLAVE_UNLOCK (clock);
       break;
     case PROP_WINDOW_THRESHOLD:
@@ -439,6 +439,40 @@ gst_control_binding_get_g_value_array (GstControlBinding * binding,
   return ret;
 }
 
+/**
+ * gst_control_binding_get_next_change:
+ * @binding: the control binding
+ * @timestamp: the time the property was synced for
+ *
+ * Gets the first time after @timestamp at which syncing @binding can give
+ * a different value than syncing at @timestamp. gst_object_sync_values()
+ * uses this to skip syncing until that time is reached.
+ *
+ * Returns: the time of the next change, @timestamp if the value can change
+ * at any time or #GST_CLOCK_TIME_NONE if it doesn't change anymore.
+ *
+ * Since: 1.10
+ */
+GstClockTime
+gst_control_binding_get_next_change (GstControlBinding * binding,
+    GstClockTime timestamp)
+{
+  GstControlBindingClass *klass;
+
+  g_return_val_if_fail (GST_IS_CONTROL_BINDING (binding), timestamp);
+
+  /* syncing does nothing until it is enabled again, which invalidates this */
+  if (binding->disabled)
+    return GST_CLOCK_TIME_NONE;
+
+  klass = GST_CONTROL_BINDING_GET_CLASS (binding);
+
+  if (klass->get_next_change != NULL)
+    return klass->get_next_change (binding, timestamp);
+
+  return timestamp;
+}
+
 /**
  * gst_control_binding_set_disabled:
  * @binding: the control binding
@@ -454,6 +488,8 @@ gst_control_binding_set_disabled (GstControlBinding * binding,
 {
   g_return_if_fail (GST_IS_CONTROL_BINDING (binding));
   binding->disabled = disabled;
+  /* the next change times of the owner don't apply anymore */
+  g_atomic_int_inc (&_priv_gst_control_cookie);
 }
 
 /**
@@ -80,6 +80,8 @@ struct _GstControlBinding {
  * @get_value_array: implementation to fetch a series of control-values
  * @get_g_value_array: implementation to fetch a series of control-values
  *                     as g_values
+ * @get_next_change: implementation to get the time until which the synced
+ *                   value stays the same. Since: 1.10
  *
  * The class structure of #GstControlBinding.
  */
@@ -93,9 +95,10 @@ struct _GstControlBindingClass
   GValue * (* get_value) (GstControlBinding *binding, GstClockTime timestamp);
   gboolean (* get_value_array) (GstControlBinding *binding, GstClockTime timestamp,GstClockTime interval, guint n_values, gpointer values);
   gboolean (* get_g_value_array) (GstControlBinding *binding, GstClockTime timestamp,GstClockTime interval, guint n_values, GValue *values);
+  GstClockTime (* get_next_change) (GstControlBinding *binding, GstClockTime timestamp);
 
   /*< private >*/
-  gpointer _gst_reserved[GST_PADDING];
+  gpointer _gst_reserved[GST_PADDING - 1];
 };
 
 #define GST_CONTROL_BINDING_PSPEC(cb) (((GstControlBinding *) cb)->pspec)
@@ -113,6 +116,8 @@ gboolean            gst_control_binding_get_value_array    (GstControlBinding *b
 gboolean            gst_control_binding_get_g_value_array  (GstControlBinding *binding, GstClockTime timestamp,
                                                             GstClockTime interval, guint n_values, GValue *values);
 
+GstClockTime        gst_control_binding_get_next_change    (GstControlBinding *binding, GstClockTime timestamp);
+
 void                gst_control_binding_set_disabled       (GstControlBinding * binding, gboolean disabled);
 gboolean            gst_control_binding_is_disabled        (GstControlBinding * binding);
 #ifdef G_DEFINE_AUTOPTR_CLEANUP_FUNC
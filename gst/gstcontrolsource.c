@@ -37,6 +37,11 @@
  * #GstControlSourceGetValue and #GstControlSourceGetValueArray functions.
  * These are then used by gst_control_source_get_value() and
  * gst_control_source_get_value_array() to get values for specific timestamps.
+ *
+ * Control sources that know when their values change can also implement
+ * #GstControlSourceGetNextChange, gst_object_sync_values() then skips the
+ * work until that time is reached. Those control sources must call
+ * gst_control_source_values_changed() whenever their values change.
  */
 
 #include "gst_private.h"
@@ -53,6 +58,12 @@ GST_DEBUG_CATEGORY_STATIC (GST_CAT_DEFAULT);
   GST_DEBUG_CATEGORY_INIT (GST_CAT_DEFAULT, "gstcontrolsource", 0, \
       "dynamic parameter control sources");
 
+/* bumped for every change of the values of any control source that reports
+ * when its values change, so that all the next change times handed out
+ * before can be invalidated with one compare. Editing happens rarely
+ * compared to syncing, a global counter is good enough. */
+volatile gint _priv_gst_control_cookie = 0;
+
 G_DEFINE_ABSTRACT_TYPE_WITH_CODE (GstControlSource, gst_control_source,
     GST_TYPE_OBJECT, _do_init);
 
@@ -72,6 +83,7 @@ gst_control_source_init (GstControlSource * self)
 {
   self->get_value = NULL;
   self->get_value_array = NULL;
+  self->get_next_change = NULL;
 }
 
 static GObject *
@@ -139,3 +151,47 @@ gst_control_source_get_value_array (GstControlSource * self,
     return FALSE;
   }
 }
+
+/**
+ * gst_control_source_get_next_change: (method)
+ * @self: the #GstControlSource object
+ * @timestamp: the time of the current value
+ *
+ * Gets the first time after @timestamp at which the value of @self can be
+ * different from the value at @timestamp. This is used by
+ * gst_object_sync_values() to skip syncing while the values stay the same.
+ *
+ * Returns: the time of the next change, @timestamp if the value can change
+ * at any time or #GST_CLOCK_TIME_NONE if it doesn't change anymore.
+ *
+ * Since: 1.10
+ */
+GstClockTime
+gst_control_source_get_next_change (GstControlSource * self,
+    GstClockTime timestamp)
+{
+  g_return_val_if_fail (GST_IS_CONTROL_SOURCE (self), timestamp);
+
+  if (self->get_next_change)
+    return self->get_next_change (self, timestamp);
+
+  return timestamp;
+}
+
+/**
+ * gst_control_source_values_changed: (method)
+ * @self: the #GstControlSource object
+ *
+ * Invalidates the times returned by gst_control_source_get_next_change().
+ * Control sources that implement #GstControlSourceGetNextChange must call
+ * this whenever the values they return change.
+ *
+ * Since: 1.10
+ */
+void
+gst_control_source_values_changed (GstControlSource * self)
+{
+  g_return_if_fail (GST_IS_CONTROL_SOURCE (self));
+
+  g_atomic_int_inc (&_priv_gst_control_cookie);
+}
@@ -92,10 +92,28 @@ typedef gboolean (* GstControlSourceGetValue) (GstControlSource *self,
 typedef gboolean (* GstControlSourceGetValueArray) (GstControlSource *self, 
     GstClockTime timestamp, GstClockTime interval, guint n_values, gdouble *values);
 
+/**
+ * GstControlSourceGetNextChange:
+ * @self: the #GstControlSource instance
+ * @timestamp: timestamp of the current value
+ *
+ * Function for returning until when the value at @timestamp stays the same.
+ *
+ * Returns: the first timestamp after @timestamp at which the value can be
+ * different, @timestamp if it can change at any time or
+ * #GST_CLOCK_TIME_NONE if it never changes again.
+ *
+ * Since: 1.10
+ */
+typedef GstClockTime (* GstControlSourceGetNextChange) (GstControlSource *self,
+    GstClockTime timestamp);
+
 /**
  * GstControlSource:
  * @get_value: Function for returning a value for a given timestamp
  * @get_value_array: Function for returning a values array for a given timestamp
+ * @get_next_change: Function for returning until when a value stays the
+ *     same. Since: 1.10
  *
  * The instance structure of #GstControlSource.
  */
@@ -105,9 +123,10 @@ struct _GstControlSource {
   /*< public >*/
   GstControlSourceGetValue get_value;             /* Returns the value for a property at a given timestamp */
   GstControlSourceGetValueArray get_value_array;  /* Returns values for a property in a given timespan */
+  GstControlSourceGetNextChange get_next_change;  /* Returns until when a value stays the same */
 
   /*< private >*/
-  gpointer _gst_reserved[GST_PADDING];
+  gpointer _gst_reserved[GST_PADDING - 1];
 };
 
 /**
@@ -133,6 +152,9 @@ gboolean       gst_control_source_get_value             (GstControlSource *self,
 gboolean       gst_control_source_get_value_array       (GstControlSource *self, GstClockTime timestamp,
                                                          GstClockTime interval, guint n_values,
                                                          gdouble *values);
+GstClockTime   gst_control_source_get_next_change       (GstControlSource *self, GstClockTime timestamp);
+void           gst_control_source_values_changed        (GstControlSource *self);
+
 #ifdef G_DEFINE_AUTOPTR_CLEANUP_FUNC
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(GstControlSource, gst_object_unref)
 #endif
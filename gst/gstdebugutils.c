@@ -851,6 +851,857 @@ gst_debug_bin_to_dot_file_with_ts (GstBin * bin,
   gst_debug_bin_to_dot_file (bin, details, ts_file_name);
   g_free (ts_file_name);
 }
+
+/*** TOPOLOGY SNAPSHOTS *******************************************************/
+
+/* A snapshot only copies what is needed to describe the graph while holding
+ * the object locks, one object at a time. Elements and pads are identified
+ * by their address, no reference is kept to them. The current caps are kept
+ * with a reference and only described when the snapshot is serialized, the
+ * caps of the two pads of a link are usually the same object. */
+
+typedef struct
+{
+  gpointer element;             /* id only */
+  gchar *name;
+  const gchar *type_name;
+  gint parent;                  /* index of the parent, -1 for the bin */
+  guint n_descendants;          /* elements following this one in a bin */
+  guint first_pad, n_pads;
+  gboolean is_bin;
+  GstState state, pending;
+  gboolean locked;
+} GraphElement;
+
+typedef struct
+{
+  gpointer pad;                 /* id only */
+  gchar *name;
+  guint element;
+  GstPadDirection direction;
+  GstPadPresence presence;
+  GstPadMode mode;
+  guint flags;
+  gint task_state;              /* -1 without a task */
+  gpointer peer;                /* id only */
+  GstCaps *caps;                /* (nullable) */
+  /* for ghost pads, ids only */
+  gpointer internal;
+  gpointer target;
+} GraphPad;
+
+struct _GstDebugGraphSnapshot
+{
+  GArray *elements;             /* GraphElement, in depth-first order */
+  GArray *pads;                 /* GraphPad, grouped by element */
+
+  /* id -> index + 1, created when needed */
+  GHashTable *element_index;
+  GHashTable *pad_index;
+  GHashTable *internal_index;
+};
+
+static void graph_snapshot_bin (GstDebugGraphSnapshot * snapshot, GstBin * bin,
+    gint parent);
+
+static void
+graph_snapshot_pad (GstDebugGraphSnapshot * snapshot, GstPad * pad,
+    guint element)
+{
+  GraphPad p = { NULL, };
+  GstPadTemplate *templ;
+  GstTask *task;
+
+  GST_OBJECT_LOCK (pad);
+  p.pad = pad;
+  p.name = g_strdup (GST_OBJECT_NAME (pad));
+  p.element = element;
+  p.direction = GST_PAD_DIRECTION (pad);
+  p.mode = GST_PAD_MODE (pad);
+  p.flags = GST_OBJECT_FLAGS (pad);
+  p.peer = GST_PAD_PEER (pad);
+  templ = GST_PAD_PAD_TEMPLATE (pad);
+  p.presence = templ ? GST_PAD_TEMPLATE_PRESENCE (templ) : GST_PAD_ALWAYS;
+  task = GST_PAD_TASK (pad);
+  p.task_state = task ? (gint) GST_TASK_STATE (task) : -1;
+  GST_OBJECT_UNLOCK (pad);
+
+  p.caps = gst_pad_get_current_caps (pad);
+
+  if (GST_IS_GHOST_PAD (pad)) {
+    GstProxyPad *internal;
+    GstPad *target;
+
+    if ((internal = gst_proxy_pad_get_internal (GST_PROXY_PAD (pad)))) {
+      p.internal = internal;
+      gst_object_unref (internal);
+    }
+    if ((target = gst_ghost_pad_get_target (GST_GHOST_PAD (pad)))) {
+      p.target = target;
+      gst_object_unref (target);
+    }
+  }
+
+  g_array_append_val (snapshot->pads, p);
+}
+
+static void
+graph_snapshot_element (GstDebugGraphSnapshot * snapshot,
+    GstElement * element, gint parent)
+{
+  GraphElement *e;
+  GList *pads = NULL, *l;
+  guint index;
+
+  index = snapshot->elements->len;
+  g_array_set_size (snapshot->elements, index + 1);
+  e = &g_array_index (snapshot->elements, GraphElement, index);
+
+  GST_OBJECT_LOCK (element);
+  e->element = element;
+  e->name = g_strdup (GST_OBJECT_NAME (element));
+  e->type_name = G_OBJECT_TYPE_NAME (element);
+  e->parent = parent;
+  e->is_bin = GST_IS_BIN (element);
+  e->state = GST_STATE (element);
+  e->pending = GST_STATE_PENDING (element);
+  e->locked = GST_ELEMENT_IS_LOCKED_STATE (element);
+  for (l = element->pads; l; l = l->next)
+    pads = g_list_prepend (pads, gst_object_ref (l->data));
+  GST_OBJECT_UNLOCK (element);
+
+  e->first_pad = snapshot->pads->len;
+  e->n_pads = g_list_length (pads);
+
+  pads = g_list_reverse (pads);
+  for (l = pads; l; l = l->next)
+    graph_snapshot_pad (snapshot, l->data, index);
+  g_list_free_full (pads, gst_object_unref);
+
+  if (GST_IS_BIN (element))
+    graph_snapshot_bin (snapshot, GST_BIN (element), index);
+
+  /* the array might have been reallocated */
+  e = &g_array_index (snapshot->elements, GraphElement, index);
+  e->n_descendants = snapshot->elements->len - index - 1;
+}
+
+static void
+graph_snapshot_bin (GstDebugGraphSnapshot * snapshot, GstBin * bin,
+    gint parent)
+{
+  GList *children = NULL, *l;
+
+  GST_OBJECT_LOCK (bin);
+  for (l = bin->children; l; l = l->next)
+    children = g_list_prepend (children, gst_object_ref (l->data));
+  GST_OBJECT_UNLOCK (bin);
+
+  children = g_list_reverse (children);
+  for (l = children; l; l = l->next)
+    graph_snapshot_element (snapshot, l->data, parent);
+  g_list_free_full (children, gst_object_unref);
+}
+
+/**
+ * gst_debug_graph_snapshot_new:
+ * @bin: the top-level pipeline that should be analyzed
+ *
+ * Copies the topology of @bin: the names and types of the elements, their
+ * pads and the links between them and the current caps of the pads.
+ *
+ * Unlike gst_debug_bin_to_dot_data(), only one object lock is held at a time
+ * and only for copying a few fields, nothing is serialized while a lock is
+ * held. This makes it suitable for taking snapshots of large pipelines
+ * periodically while they are running. Element properties are not part of
+ * the snapshot.
+ *
+ * Returns: (transfer full): a new #GstDebugGraphSnapshot, free with
+ * gst_debug_graph_snapshot_free()
+ *
+ * Since: 1.10
+ */
+GstDebugGraphSnapshot *
+gst_debug_graph_snapshot_new (GstBin * bin)
+{
+  GstDebugGraphSnapshot *snapshot;
+
+  g_return_val_if_fail (GST_IS_BIN (bin), NULL);
+
+  snapshot = g_slice_new0 (GstDebugGraphSnapshot);
+  snapshot->elements = g_array_new (FALSE, TRUE, sizeof (GraphElement));
+  snapshot->pads = g_array_new (FALSE, TRUE, sizeof (GraphPad));
+
+  /* the bin itself is the first element */
+  graph_snapshot_element (snapshot, GST_ELEMENT_CAST (bin), -1);
+
+  return snapshot;
+}
+
+/**
+ * gst_debug_graph_snapshot_free:
+ * @snapshot: (transfer full): a #GstDebugGraphSnapshot
+ *
+ * Frees a snapshot made with gst_debug_graph_snapshot_new().
+ *
+ * Since: 1.10
+ */
+void
+gst_debug_graph_snapshot_free (GstDebugGraphSnapshot * snapshot)
+{
+  guint i;
+
+  g_return_if_fail (snapshot != NULL);
+
+  for (i = 0; i < snapshot->elements->len; i++)
+    g_free (g_array_index (snapshot->elements, GraphElement, i).name);
+  for (i = 0; i < snapshot->pads->len; i++) {
+    GraphPad *p = &g_array_index (snapshot->pads, GraphPad, i);
+
+    g_free (p->name);
+    if (p->caps)
+      gst_caps_unref (p->caps);
+  }
+  g_array_free (snapshot->elements, TRUE);
+  g_array_free (snapshot->pads, TRUE);
+
+  if (snapshot->element_index) {
+    g_hash_table_unref (snapshot->element_index);
+    g_hash_table_unref (snapshot->pad_index);
+    g_hash_table_unref (snapshot->internal_index);
+  }
+
+  g_slice_free (GstDebugGraphSnapshot, snapshot);
+}
+
+static void
+graph_snapshot_ensure_index (GstDebugGraphSnapshot * snapshot)
+{
+  guint i;
+
+  if (snapshot->element_index)
+    return;
+
+  snapshot->element_index = g_hash_table_new (NULL, NULL);
+  snapshot->pad_index = g_hash_table_new (NULL, NULL);
+  snapshot->internal_index = g_hash_table_new (NULL, NULL);
+
+  for (i = 0; i < snapshot->elements->len; i++)
+    g_hash_table_insert (snapshot->element_index,
+        g_array_index (snapshot->elements, GraphElement, i).element,
+        GUINT_TO_POINTER (i + 1));
+  for (i = 0; i < snapshot->pads->len; i++) {
+    GraphPad *p = &g_array_index (snapshot->pads, GraphPad, i);
+
+    g_hash_table_insert (snapshot->pad_index, p->pad, GUINT_TO_POINTER (i + 1));
+    if (p->internal)
+      g_hash_table_insert (snapshot->internal_index, p->internal,
+          GUINT_TO_POINTER (i + 1));
+  }
+}
+
+static GraphPad *
+graph_snapshot_lookup_pad (GstDebugGraphSnapshot * snapshot, gpointer pad)
+{
+  guint index;
+
+  index = GPOINTER_TO_UINT (g_hash_table_lookup (snapshot->pad_index, pad));
+
+  return index ? &g_array_index (snapshot->pads, GraphPad, index - 1) : NULL;
+}
+
+static GraphElement *
+graph_snapshot_lookup_element (GstDebugGraphSnapshot * snapshot,
+    gpointer element)
+{
+  guint index;
+
+  index = GPOINTER_TO_UINT (g_hash_table_lookup (snapshot->element_index,
+          element));
+
+  return index ? &g_array_index (snapshot->elements, GraphElement,
+      index - 1) : NULL;
+}
+
+/* the peer of a src pad that a link is drawn to. Links to the internal pads
+ * of ghost pads are drawn as the dashed ghost pad edges and links leaving
+ * the snapshot are not drawn */
+static GraphPad *
+graph_snapshot_link_peer (GstDebugGraphSnapshot * snapshot, GraphPad * p)
+{
+  GraphPad *peer;
+
+  if (p->direction != GST_PAD_SRC || p->peer == NULL || p->element == 0)
+    return NULL;
+
+  if (!(peer = graph_snapshot_lookup_pad (snapshot, p->peer))
+      || peer->element == 0)
+    return NULL;
+
+  return peer;
+}
+
+static gchar *
+graph_make_name (const gchar * name, gpointer id)
+{
+  return g_strcanon (g_strdup_printf ("%s_%p", name, id),
+      G_CSET_A_2_Z G_CSET_a_2_z G_CSET_DIGITS "_", '_');
+}
+
+static gchar *
+graph_make_pad_name (GstDebugGraphSnapshot * snapshot, GraphPad * p)
+{
+  GraphElement *e = &g_array_index (snapshot->elements, GraphElement,
+      p->element);
+  gchar *element_name, *pad_name, *res;
+
+  element_name = graph_make_name (e->name, e->element);
+  pad_name = graph_make_name (p->name, p->pad);
+  res = g_strconcat (element_name, "_", pad_name, NULL);
+  g_free (element_name);
+  g_free (pad_name);
+
+  return res;
+}
+
+/* caps -> description, every caps is described once */
+static const gchar *
+graph_describe_caps (GHashTable * cache, GstCaps * caps,
+    GstDebugGraphDetails details)
+{
+  gchar *media;
+
+  if (!(media = g_hash_table_lookup (cache, caps))) {
+    media = debug_dump_describe_caps (caps, details);
+    g_hash_table_insert (cache, caps, media);
+  }
+  return media;
+}
+
+static gchar *
+graph_describe_link (GHashTable * cache, GraphPad * p, GraphPad * peer,
+    GstDebugGraphDetails details)
+{
+  if (!(details & (GST_DEBUG_GRAPH_SHOW_MEDIA_TYPE |
+              GST_DEBUG_GRAPH_SHOW_CAPS_DETAILS)) || p->caps == NULL)
+    return NULL;
+
+  if (peer->caps && peer->caps != p->caps
+      && !gst_caps_is_equal (peer->caps, p->caps)) {
+    return g_strdup_printf ("%s -> %s",
+        graph_describe_caps (cache, p->caps, details),
+        graph_describe_caps (cache, peer->caps, details));
+  }
+  return g_strdup (graph_describe_caps (cache, p->caps, details));
+}
+
+static void
+graph_dump_pad (GstDebugGraphSnapshot * snapshot, GraphPad * p,
+    const gchar * element_name, GstDebugGraphDetails details, GString * str,
+    const gint indent)
+{
+  const gchar *spc = MAKE_INDENT (indent);
+  const gchar *color_name, *style_name;
+  gchar *pad_name;
+  gboolean ghost = p->internal != NULL;
+
+  if (p->direction == GST_PAD_SRC)
+    color_name = ghost ? "#ffdddd" : "#ffaaaa";
+  else if (p->direction == GST_PAD_SINK)
+    color_name = ghost ? "#ddddff" : "#aaaaff";
+  else
+    color_name = ghost ? "#ffffff" : "#cccccc";
+
+  if (p->presence == GST_PAD_SOMETIMES)
+    style_name = "filled,dotted";
+  else if (p->presence == GST_PAD_REQUEST)
+    style_name = "filled,dashed";
+  else
+    style_name = "filled,solid";
+
+  pad_name = graph_make_name (p->name, p->pad);
+
+  if (details & GST_DEBUG_GRAPH_SHOW_STATES) {
+    const gchar *activation_mode = "-><";
+    const gchar *task_mode = "";
+
+    if (p->task_state == GST_TASK_STARTED)
+      task_mode = "[T]";
+    else if (p->task_state == GST_TASK_PAUSED)
+      task_mode = "[t]";
+
+    g_string_append_printf (str,
+        "%s  %s_%s [color=black, fillcolor=\"%s\", label=\"%s\\n[%c][%c%c%c]%s\", height=\"0.2\", style=\"%s\"];\n",
+        spc, element_name, pad_name, color_name, p->name,
+        activation_mode[p->mode],
+        (p->flags & GST_PAD_FLAG_BLOCKED) ? 'B' : 'b',
+        (p->flags & GST_PAD_FLAG_FLUSHING) ? 'F' : 'f',
+        (p->flags & GST_PAD_FLAG_BLOCKING) ? 'B' : 'b', task_mode, style_name);
+  } else {
+    g_string_append_printf (str,
+        "%s  %s_%s [color=black, fillcolor=\"%s\", label=\"%s\", height=\"0.2\", style=\"%s\"];\n",
+        spc, element_name, pad_name, color_name, p->name, style_name);
+  }
+  g_free (pad_name);
+}
+
+/* dump the pads of one direction in their own invisible cluster, returns
+ * the node name of the first one */
+static gchar *
+graph_dump_pads (GstDebugGraphSnapshot * snapshot, GraphElement * e,
+    GstPadDirection direction, const gchar * element_name,
+    GstDebugGraphDetails details, GString * str, const gint indent)
+{
+  const gchar *spc = MAKE_INDENT (indent);
+  gchar *first_pad_name = NULL;
+  guint i;
+
+  for (i = e->first_pad; i < e->first_pad + e->n_pads; i++) {
+    GraphPad *p = &g_array_index (snapshot->pads, GraphPad, i);
+
+    if (p->direction != direction)
+      continue;
+
+    if (first_pad_name == NULL) {
+      g_string_append_printf (str, "%ssubgraph cluster_%s_%s {\n", spc,
+          element_name, direction == GST_PAD_SRC ? "src" : "sink");
+      g_string_append_printf (str, "%s  label=\"\";\n", spc);
+      g_string_append_printf (str, "%s  style=\"invis\";\n", spc);
+      first_pad_name = graph_make_name (p->name, p->pad);
+    }
+    graph_dump_pad (snapshot, p, element_name, details, str, indent);
+  }
+  if (first_pad_name)
+    g_string_append_printf (str, "%s}\n\n", spc);
+
+  return first_pad_name;
+}
+
+static void
+graph_dump_links (GstDebugGraphSnapshot * snapshot, GraphElement * e,
+    GHashTable * cache, GstDebugGraphDetails details, GString * str,
+    const gint indent)
+{
+  const gchar *spc = MAKE_INDENT (indent);
+  guint i;
+
+  for (i = e->first_pad; i < e->first_pad + e->n_pads; i++) {
+    GraphPad *p = &g_array_index (snapshot->pads, GraphPad, i);
+    GraphPad *peer, *target;
+    gchar *pad_name, *peer_name, *media;
+
+    /* ghost pad to its target */
+    if (p->target && (target = graph_snapshot_lookup_pad (snapshot,
+                p->target))) {
+      pad_name = graph_make_pad_name (snapshot, p);
+      peer_name = graph_make_pad_name (snapshot, target);
+      if (p->direction == GST_PAD_SRC)
+        g_string_append_printf (str,
+            "%s%s -> %s [style=dashed, minlen=0]\n", spc, peer_name, pad_name);
+      else
+        g_string_append_printf (str,
+            "%s%s -> %s [style=dashed, minlen=0]\n", spc, pad_name, peer_name);
+      g_free (pad_name);
+      g_free (peer_name);
+    }
+
+    if (!(peer = graph_snapshot_link_peer (snapshot, p)))
+      continue;
+
+    pad_name = graph_make_pad_name (snapshot, p);
+    peer_name = graph_make_pad_name (snapshot, peer);
+    if ((media = graph_describe_link (cache, p, peer, details))) {
+      g_string_append_printf (str, "%s%s -> %s [label=\"%s\"]\n", spc,
+          pad_name, peer_name, media);
+      g_free (media);
+    } else {
+      g_string_append_printf (str, "%s%s -> %s\n", spc, pad_name, peer_name);
+    }
+    g_free (pad_name);
+    g_free (peer_name);
+  }
+}
+
+/* dump the elements from @first to @last, the children of one bin */
+static void
+graph_dump_elements (GstDebugGraphSnapshot * snapshot, guint first,
+    guint last, GHashTable * cache, GstDebugGraphDetails details,
+    GString * str, const gint indent)
+{
+  const gchar *spc = MAKE_INDENT (indent);
+  const gchar *state_icons = "~0-=>";
+  guint i;
+
+  for (i = first; i < last; i += 1 + g_array_index (snapshot->elements,
+          GraphElement, i).n_descendants) {
+    GraphElement *e = &g_array_index (snapshot->elements, GraphElement, i);
+    gchar *element_name, *src_pad_name, *sink_pad_name;
+    gchar *state_name = NULL;
+
+    element_name = graph_make_name (e->name, e->element);
+
+    if (details & GST_DEBUG_GRAPH_SHOW_STATES) {
+      if (e->pending == GST_STATE_VOID_PENDING)
+        state_name = g_strdup_printf ("\\n[%c]%s", state_icons[e->state],
+            e->locked ? "(locked)" : "");
+      else
+        state_name = g_strdup_printf ("\\n[%c] -> [%c]",
+            state_icons[e->state], state_icons[e->pending]);
+    }
+
+    g_string_append_printf (str, "%ssubgraph cluster_%s {\n", spc,
+        element_name);
+    g_string_append_printf (str, "%s  fontname=\"Bitstream Vera Sans\";\n",
+        spc);
+    g_string_append_printf (str, "%s  fontsize=\"8\";\n", spc);
+    g_string_append_printf (str, "%s  style=\"filled,rounded\";\n", spc);
+    g_string_append_printf (str, "%s  color=black;\n", spc);
+    g_string_append_printf (str, "%s  label=\"%s\\n%s%s\";\n", spc,
+        e->type_name, e->name, state_name ? state_name : "");
+    g_free (state_name);
+
+    sink_pad_name = graph_dump_pads (snapshot, e, GST_PAD_SINK, element_name,
+        details, str, indent + 1);
+    src_pad_name = graph_dump_pads (snapshot, e, GST_PAD_SRC, element_name,
+        details, str, indent + 1);
+    if (sink_pad_name && src_pad_name) {
+      /* add invisible link from first sink to first src pad */
+      g_string_append_printf (str,
+          "%s  %s_%s -> %s_%s [style=\"invis\"];\n",
+          spc, element_name, sink_pad_name, element_name, src_pad_name);
+    }
+
+    if (e->is_bin) {
+      g_string_append_printf (str, "%s  fillcolor=\"#ffffff\";\n", spc);
+      graph_dump_elements (snapshot, i + 1, i + 1 + e->n_descendants, cache,
+          details, str, indent + 1);
+    } else if (src_pad_name && !sink_pad_name) {
+      g_string_append_printf (str, "%s  fillcolor=\"#ffaaaa\";\n", spc);
+    } else if (!src_pad_name && sink_pad_name) {
+      g_string_append_printf (str, "%s  fillcolor=\"#aaaaff\";\n", spc);
+    } else if (src_pad_name && sink_pad_name) {
+      g_string_append_printf (str, "%s  fillcolor=\"#aaffaa\";\n", spc);
+    } else {
+      g_string_append_printf (str, "%s  fillcolor=\"#ffffff\";\n", spc);
+    }
+    g_string_append_printf (str, "%s}\n\n", spc);
+
+    graph_dump_links (snapshot, e, cache, details, str, indent);
+
+    g_free (sink_pad_name);
+    g_free (src_pad_name);
+    g_free (element_name);
+  }
+}
+
+/**
+ * gst_debug_graph_snapshot_to_dot_data:
+ * @snapshot: a #GstDebugGraphSnapshot
+ * @details: details to show in the graph
+ *
+ * Describes @snapshot in graphviz dot format, like
+ * gst_debug_bin_to_dot_data() does for a bin. This does not take any locks
+ * of the objects in the pipeline. #GST_DEBUG_GRAPH_SHOW_NON_DEFAULT_PARAMS
+ * and #GST_DEBUG_GRAPH_SHOW_FULL_PARAMS are ignored as properties are not
+ * part of a snapshot.
+ *
+ * Returns: (transfer full): a string containing the pipeline in graphviz
+ * dot format.
+ *
+ * Since: 1.10
+ */
+gchar *
+gst_debug_graph_snapshot_to_dot_data (GstDebugGraphSnapshot * snapshot,
+    GstDebugGraphDetails details)
+{
+  GraphElement *bin;
+  GHashTable *cache;
+  GString *str;
+  gchar *state_name = NULL;
+
+  g_return_val_if_fail (snapshot != NULL, NULL);
+
+  graph_snapshot_ensure_index (snapshot);
+  bin = &g_array_index (snapshot->elements, GraphElement, 0);
+
+  /* a few lines per pad */
+  str = g_string_sized_new (256 + snapshot->pads->len * 256);
+  cache = g_hash_table_new_full (NULL, NULL, NULL, g_free);
+
+  if (details & GST_DEBUG_GRAPH_SHOW_STATES) {
+    const gchar *state_icons = "~0-=>";
+
+    if (bin->pending == GST_STATE_VOID_PENDING)
+      state_name = g_strdup_printf ("\\n[%c]", state_icons[bin->state]);
+    else
+      state_name = g_strdup_printf ("\\n[%c] -> [%c]",
+          state_icons[bin->state], state_icons[bin->pending]);
+  }
+
+  g_string_append_printf (str,
+      "digraph pipeline {\n"
+      "  rankdir=LR;\n"
+      "  fontname=\"sans\";\n"
+      "  fontsize=\"10\";\n"
+      "  labelloc=t;\n"
+      "  nodesep=.1;\n"
+      "  ranksep=.2;\n"
+      "  label=\"<%s>\\n%s%s\";\n"
+      "  node [style=\"filled,rounded\", shape=box, fontsize=\"9\", fontname=\"sans\", margin=\"0.0,0.0\"];\n"
+      "  edge [labelfontsize=\"6\", fontsize=\"9\", fontname=\"monospace\"];\n"
+      "\n", bin->type_name, bin->name, state_name ? state_name : "");
+  g_free (state_name);
+
+  graph_dump_elements (snapshot, 1, snapshot->elements->len, cache, details,
+      str, 1);
+  debug_dump_footer (str);
+
+  g_hash_table_unref (cache);
+
+  return g_string_free (str, FALSE);
+}
+
+/* the same element in two snapshots, the address could have been reused */
+static GraphElement *
+graph_snapshot_find_element (GstDebugGraphSnapshot * snapshot,
+    GraphElement * e)
+{
+  GraphElement *found;
+
+  found = graph_snapshot_lookup_element (snapshot, e->element);
+  if (found && found->type_name == e->type_name
+      && strcmp (found->name, e->name) == 0)
+    return found;
+  return NULL;
+}
+
+static GraphPad *
+graph_snapshot_find_pad (GstDebugGraphSnapshot * snapshot,
+    GstDebugGraphSnapshot * other, GraphPad * p)
+{
+  GraphPad *found;
+  GraphElement *e;
+
+  found = graph_snapshot_lookup_pad (snapshot, p->pad);
+  if (found == NULL || strcmp (found->name, p->name) != 0)
+    return NULL;
+
+  /* and on the same element */
+  e = &g_array_index (other->elements, GraphElement, p->element);
+  if (graph_snapshot_find_element (snapshot, e) !=
+      &g_array_index (snapshot->elements, GraphElement, found->element))
+    return NULL;
+
+  return found;
+}
+
+static void
+graph_diff_removed (GstDebugGraphSnapshot * old,
+    GstDebugGraphSnapshot * snapshot, GString * str)
+{
+  guint i;
+
+  for (i = 0; i < old->pads->len; i++) {
+    GraphPad *p = &g_array_index (old->pads, GraphPad, i);
+    GraphPad *peer, *found, *found_peer = NULL;
+    gchar *pad_name, *peer_name;
+
+    if (!(peer = graph_snapshot_link_peer (old, p)))
+      continue;
+
+    if ((found = graph_snapshot_find_pad (snapshot, old, p)))
+      found_peer = graph_snapshot_link_peer (snapshot, found);
+    if (found_peer && found_peer == graph_snapshot_find_pad (snapshot, old,
+            peer))
+      continue;
+
+    pad_name = graph_make_pad_name (old, p);
+    peer_name = graph_make_pad_name (old, peer);
+    g_string_append_printf (str, "-link %s -> %s\n", pad_name, peer_name);
+    g_free (pad_name);
+    g_free (peer_name);
+  }
+
+  for (i = 0; i < old->pads->len; i++) {
+    GraphPad *p = &g_array_index (old->pads, GraphPad, i);
+    gchar *pad_name;
+
+    if (p->element == 0 || graph_snapshot_find_pad (snapshot, old, p))
+      continue;
+
+    pad_name = graph_make_pad_name (old, p);
+    g_string_append_printf (str, "-pad %s\n", pad_name);
+    g_free (pad_name);
+  }
+
+  for (i = 1; i < old->elements->len; i++) {
+    GraphElement *e = &g_array_index (old->elements, GraphElement, i);
+    gchar *element_name;
+
+    if (graph_snapshot_find_element (snapshot, e))
+      continue;
+
+    element_name = graph_make_name (e->name, e->element);
+    g_string_append_printf (str, "-element %s\n", element_name);
+    g_free (element_name);
+  }
+}
+
+static void
+graph_diff_added (GstDebugGraphSnapshot * old,
+    GstDebugGraphSnapshot * snapshot, GHashTable * cache,
+    GstDebugGraphDetails details, GString * str)
+{
+  guint i;
+
+  for (i = 1; i < snapshot->elements->len; i++) {
+    GraphElement *e = &g_array_index (snapshot->elements, GraphElement, i);
+    GraphElement *found = NULL;
+    gchar *element_name;
+
+    if (old && (found = graph_snapshot_find_element (old, e))
+        && (!(details & GST_DEBUG_GRAPH_SHOW_STATES)
+            || (found->state == e->state && found->pending == e->pending)))
+      continue;
+
+    element_name = graph_make_name (e->name, e->element);
+    if (found) {
+      g_string_append_printf (str, "~element %s %s", element_name,
+          gst_element_state_get_name (e->state));
+    } else {
+      GraphElement *parent;
+      gchar *parent_name;
+
+      parent = &g_array_index (snapshot->elements, GraphElement, e->parent);
+      parent_name = graph_make_name (parent->name, parent->element);
+      g_string_append_printf (str, "+element %s %s %s", element_name,
+          e->type_name, parent_name);
+      g_free (parent_name);
+      if (details & GST_DEBUG_GRAPH_SHOW_STATES)
+        g_string_append_printf (str, " %s",
+            gst_element_state_get_name (e->state));
+    }
+    if ((details & GST_DEBUG_GRAPH_SHOW_STATES)
+        && e->pending != GST_STATE_VOID_PENDING)
+      g_string_append_printf (str, " -> %s",
+          gst_element_state_get_name (e->pending));
+    g_string_append_c (str, '\n');
+    g_free (element_name);
+  }
+
+  for (i = 0; i < snapshot->pads->len; i++) {
+    GraphPad *p = &g_array_index (snapshot->pads, GraphPad, i);
+    GraphElement *e;
+    gchar *pad_name, *element_name;
+
+    if (p->element == 0 || (old && graph_snapshot_find_pad (old, snapshot, p)))
+      continue;
+
+    e = &g_array_index (snapshot->elements, GraphElement, p->element);
+    pad_name = graph_make_pad_name (snapshot, p);
+    element_name = graph_make_name (e->name, e->element);
+    g_string_append_printf (str, "+pad %s %s %s\n", pad_name, element_name,
+        p->direction == GST_PAD_SRC ? "src" :
+        p->direction == GST_PAD_SINK ? "sink" : "unknown");
+    g_free (pad_name);
+    g_free (element_name);
+  }
+
+  for (i = 0; i < snapshot->pads->len; i++) {
+    GraphPad *p = &g_array_index (snapshot->pads, GraphPad, i);
+    GraphPad *peer, *found = NULL, *found_peer = NULL;
+    gchar *pad_name, *peer_name, *media;
+    const gchar *change = "+link";
+
+    if (!(peer = graph_snapshot_link_peer (snapshot, p)))
+      continue;
+
+    if (old && (found = graph_snapshot_find_pad (old, snapshot, p)))
+      found_peer = graph_snapshot_link_peer (old, found);
+    if (found_peer && found_peer == graph_snapshot_find_pad (old, snapshot,
+            peer)) {
+      /* same link, only the caps can change */
+      if ((found->caps == p->caps && found_peer->caps == peer->caps)
+          || !(details & (GST_DEBUG_GRAPH_SHOW_MEDIA_TYPE |
+                  GST_DEBUG_GRAPH_SHOW_CAPS_DETAILS)))
+        continue;
+      if (found->caps && p->caps && found_peer->caps && peer->caps
+          && gst_caps_is_equal (found->caps, p->caps)
+          && gst_caps_is_equal (found_peer->caps, peer->caps))
+        continue;
+      change = "~link";
+    }
+
+    pad_name = graph_make_pad_name (snapshot, p);
+    peer_name = graph_make_pad_name (snapshot, peer);
+    g_string_append_printf (str, "%s %s -> %s", change, pad_name, peer_name);
+    if ((media = graph_describe_link (cache, p, peer, details))) {
+      g_string_append_printf (str, " %s", media);
+      g_free (media);
+    }
+    g_string_append_c (str, '\n');
+    g_free (pad_name);
+    g_free (peer_name);
+  }
+}
+
+/**
+ * gst_debug_graph_snapshot_diff:
+ * @old: (allow-none): an earlier #GstDebugGraphSnapshot of the same bin
+ * @snapshot: a #GstDebugGraphSnapshot
+ * @details: details to include
+ *
+ * Describes what changed in the topology between @old and @snapshot, one
+ * change per line:
+ * <itemizedlist>
+ *   <listitem><para>"-link SRC -> SINK", "-pad PAD" and
+ *   "-element ELEMENT" for the links, pads and elements that went
+ *   away</para></listitem>
+ *   <listitem><para>"+element ELEMENT TYPE PARENT" and
+ *   "+pad PAD ELEMENT DIRECTION" for new elements and pads</para></listitem>
+ *   <listitem><para>"+link SRC -> SINK CAPS" for new links and
+ *   "~link SRC -> SINK CAPS" for links of which the caps
+ *   changed</para></listitem>
+ *   <listitem><para>"~element ELEMENT STATE" for elements that changed
+ *   their state, with #GST_DEBUG_GRAPH_SHOW_STATES</para></listitem>
+ * </itemizedlist>
+ * The names are the node names used in the output of
+ * gst_debug_graph_snapshot_to_dot_data(). The caps are only described with
+ * #GST_DEBUG_GRAPH_SHOW_MEDIA_TYPE or #GST_DEBUG_GRAPH_SHOW_CAPS_DETAILS.
+ *
+ * Without @old, everything in @snapshot is described as new. Only the
+ * changed parts are serialized, which makes periodic snapshots of large
+ * pipelines cheap when they rarely change.
+ *
+ * Returns: (transfer full): the changes, an empty string when nothing
+ * changed.
+ *
+ * Since: 1.10
+ */
+gchar *
+gst_debug_graph_snapshot_diff (GstDebugGraphSnapshot * old,
+    GstDebugGraphSnapshot * snapshot, GstDebugGraphDetails details)
+{
+  GHashTable *cache;
+  GString *str;
+
+  g_return_val_if_fail (snapshot != NULL, NULL);
+
+  graph_snapshot_ensure_index (snapshot);
+  if (old)
+    graph_snapshot_ensure_index (old);
+
+  str = g_string_new (NULL);
+  cache = g_hash_table_new_full (NULL, NULL, NULL, g_free);
+
+  if (old)
+    graph_diff_removed (old, snapshot, str);
+  graph_diff_added (old, snapshot, cache, details, str);
+
+  g_hash_table_unref (cache);
+
+  return g_string_free (str, FALSE);
+}
 #else /* !GST_DISABLE_GST_DEBUG */
 #ifndef GST_REMOVE_DISABLED
 void
@@ -864,5 +1715,30 @@ gst_debug_bin_to_dot_file_with_ts (GstBin * bin, GstDebugGraphDetails details,
     const gchar * file_name)
 {
 }
+
+GstDebugGraphSnapshot *
+gst_debug_graph_snapshot_new (GstBin * bin)
+{
+  return NULL;
+}
+
+void
+gst_debug_graph_snapshot_free (GstDebugGraphSnapshot * snapshot)
+{
+}
+
+gchar *
+gst_debug_graph_snapshot_to_dot_data (GstDebugGraphSnapshot * snapshot,
+    GstDebugGraphDetails details)
+{
+  return NULL;
+}
+
+gchar *
+gst_debug_graph_snapshot_diff (GstDebugGraphSnapshot * old,
+    GstDebugGraphSnapshot * snapshot, GstDebugGraphDetails details)
+{
+  return NULL;
+}
 #endif /* GST_REMOVE_DISABLED */
 #endif /* GST_DISABLE_GST_DEBUG */
@@ -62,6 +62,20 @@ gchar * gst_debug_bin_to_dot_data (GstBin *bin, GstDebugGraphDetails details);
 void gst_debug_bin_to_dot_file (GstBin *bin, GstDebugGraphDetails details, const gchar *file_name);
 void gst_debug_bin_to_dot_file_with_ts (GstBin *bin, GstDebugGraphDetails details, const gchar *file_name);
 
+/**
+ * GstDebugGraphSnapshot:
+ *
+ * Opaque copy of the topology of a bin, see gst_debug_graph_snapshot_new().
+ *
+ * Since: 1.10
+ */
+typedef struct _GstDebugGraphSnapshot GstDebugGraphSnapshot;
+
+GstDebugGraphSnapshot * gst_debug_graph_snapshot_new (GstBin *bin);
+void gst_debug_graph_snapshot_free (GstDebugGraphSnapshot *snapshot);
+gchar * gst_debug_graph_snapshot_to_dot_data (GstDebugGraphSnapshot *snapshot, GstDebugGraphDetails details);
+gchar * gst_debug_graph_snapshot_diff (GstDebugGraphSnapshot *old, GstDebugGraphSnapshot *snapshot, GstDebugGraphDetails details);
+
 #ifndef GST_DISABLE_GST_DEBUG
 
 /**
@@ -192,6 +192,137 @@ gst_device_monitor_class_init (GstDeviceMonitorClass * klass)
           DEFAULT_SHOW_ALL, G_PARAM_STATIC_STRINGS | G_PARAM_READWRITE));
 }
 
+typedef gpointer (*GstDeviceMonitorProviderFunc) (GstDeviceProvider * provider);
+
+/* calls a function on a number of providers at once */
+typedef struct
+{
+  gint refcount;
+
+  GMutex lock;
+  GCond cond;
+
+  GstDeviceMonitorProviderFunc func;
+  GstDeviceProvider **providers;
+  gpointer *results;
+  guint n_providers;
+  guint next_provider;
+  guint busy;
+} GstDeviceMonitorJob;
+
+static void
+gst_device_monitor_job_unref (GstDeviceMonitorJob * job)
+{
+  if (!g_atomic_int_dec_and_test (&job->refcount))
+    return;
+
+  g_mutex_clear (&job->lock);
+  g_cond_clear (&job->cond);
+  g_free (job);
+}
+
+static void
+gst_device_monitor_job_run (GstDeviceMonitorJob * job)
+{
+  g_mutex_lock (&job->lock);
+  while (job->next_provider < job->n_providers) {
+    guint idx = job->next_provider++;
+    gpointer result;
+
+    job->busy++;
+    g_mutex_unlock (&job->lock);
+
+    result = job->func (job->providers[idx]);
+
+    g_mutex_lock (&job->lock);
+    job->results[idx] = result;
+    if (--job->busy == 0)
+      g_cond_broadcast (&job->cond);
+  }
+  g_mutex_unlock (&job->lock);
+}
+
+static void
+gst_device_monitor_job_func (GstDeviceMonitorJob * job)
+{
+  gst_device_monitor_job_run (job);
+  gst_device_monitor_job_unref (job);
+}
+
+/* Call @func on all @providers in parallel and collect the results. Probing
+ * mostly waits for the hardware or the network, so every provider gets a
+ * thread. The calling thread takes part in the work so that this never
+ * waits for a busy pool. Must be called without the monitor lock. */
+static gpointer *
+gst_device_monitor_run_parallel (GstDeviceMonitor * monitor,
+    GstDeviceProvider ** providers, guint n_providers,
+    GstDeviceMonitorProviderFunc func)
+{
+  GstDeviceMonitorJob *job;
+  GstTaskPool *pool;
+  gpointer *results, *ids;
+  guint i, n_helpers;
+
+  results = g_new0 (gpointer, n_providers);
+  if (n_providers == 0)
+    return results;
+
+  job = g_new0 (GstDeviceMonitorJob, 1);
+  job->refcount = 1;
+  g_mutex_init (&job->lock);
+  g_cond_init (&job->cond);
+  job->func = func;
+  job->providers = providers;
+  job->results = results;
+  job->n_providers = n_providers;
+
+  pool = gst_task_pool_get_default ();
+  n_helpers = n_providers - 1;
+  GST_DEBUG_OBJECT (monitor, "running %u providers with %u helpers",
+      n_providers, n_helpers);
+
+  ids = g_new0 (gpointer, n_helpers + 1);
+  for (i = 0; i < n_helpers; i++) {
+    GError *err = NULL;
+
+    g_atomic_int_inc (&job->refcount);
+    ids[i] = gst_task_pool_push (pool,
+        (GstTaskPoolFunction) gst_device_monitor_job_func, job, &err);
+    if (err != NULL) {
+      GST_WARNING_OBJECT (monitor, "failed to start helper: %s",
+          err->message);
+      g_error_free (err);
+      gst_device_monitor_job_unref (job);
+      ids[i] = NULL;
+      break;
+    }
+  }
+
+  /* work ourselves and wait for the providers the helpers took */
+  gst_device_monitor_job_run (job);
+  g_mutex_lock (&job->lock);
+  while (job->busy > 0)
+    g_cond_wait (&job->cond, &job->lock);
+  g_mutex_unlock (&job->lock);
+
+  for (i = 0; i < n_helpers; i++) {
+    if (ids[i])
+      gst_task_pool_join (pool, ids[i]);
+  }
+  g_free (ids);
+  gst_object_unref (pool);
+
+  gst_device_monitor_job_unref (job);
+
+  return results;
+}
+
+static void
+device_list_free (GList * devices)
+{
+  g_list_free_full (devices, gst_object_unref);
+}
+
 /* must be called with monitor lock */
 static gboolean
 is_provider_hidden (GstDeviceMonitor * monitor, GList * hidden,
@@ -340,7 +471,8 @@ gst_device_monitor_dispose (GObject * object)
  * @monitor: A #GstDeviceProvider
  *
  * Gets a list of devices from all of the relevant monitors. This may actually
- * probe the hardware if the monitor is not currently started.
+ * probe the hardware if the monitor is not currently started. All providers
+ * are probed at the same time.
  *
  * Returns: (transfer full) (element-type GstDevice): a #GList of
  *   #GstDevice
@@ -352,7 +484,10 @@ GList *
 gst_device_monitor_get_devices (GstDeviceMonitor * monitor)
 {
   GList *devices = NULL, *hidden = NULL;
-  guint i;
+  GstDeviceProvider **providers = NULL, **to_probe;
+  GHashTable *probed;
+  gpointer *results;
+  guint i, n_providers = 0, n_to_probe;
   guint cookie;
 
   g_return_val_if_fail (GST_IS_DEVICE_MONITOR (monitor), NULL);
@@ -371,32 +506,57 @@ gst_device_monitor_get_devices (GstDeviceMonitor * monitor)
     return FALSE;
   }
 
+  /* the devices of each provider, kept when the providers change while we
+   * probe so that only the new providers are probed again */
+  probed = g_hash_table_new_full (NULL, NULL, gst_object_unref,
+      (GDestroyNotify) device_list_free);
+
 again:
 
   g_list_free_full (devices, gst_object_unref);
   g_list_free_full (hidden, g_free);
   devices = NULL;
   hidden = NULL;
+  for (i = 0; i < n_providers; i++)
+    gst_object_unref (providers[i]);
+  g_free (providers);
 
   cookie = monitor->priv->cookie;
 
+  /* which providers are hidden does not depend on their devices */
+  providers = g_new (GstDeviceProvider *, monitor->priv->providers->len);
+  to_probe = g_new (GstDeviceProvider *, monitor->priv->providers->len);
+  n_providers = n_to_probe = 0;
   for (i = 0; i < monitor->priv->providers->len; i++) {
-    GList *tmpdev;
     GstDeviceProvider *provider =
-        gst_object_ref (g_ptr_array_index (monitor->priv->providers, i));
-    GList *item;
+        g_ptr_array_index (monitor->priv->providers, i);
 
-    if (!is_provider_hidden (monitor, hidden, provider)) {
-      GST_OBJECT_UNLOCK (monitor);
+    if (is_provider_hidden (monitor, hidden, provider))
+      continue;
 
-      tmpdev = gst_device_provider_get_devices (provider);
+    providers[n_providers++] = gst_object_ref (provider);
+    update_hidden_providers_list (&hidden, provider);
+    if (!g_hash_table_contains (probed, provider))
+      to_probe[n_to_probe++] = provider;
+  }
 
-      GST_OBJECT_LOCK (monitor);
-      update_hidden_providers_list (&hidden, provider);
-    } else {
-      tmpdev = NULL;
-    }
+  /* probe all providers at once, they are kept alive by @providers */
+  GST_OBJECT_UNLOCK (monitor);
+  results = gst_device_monitor_run_parallel (monitor, to_probe, n_to_probe,
+      (GstDeviceMonitorProviderFunc) gst_device_provider_get_devices);
+  GST_OBJECT_LOCK (monitor);
+
+  for (i = 0; i < n_to_probe; i++)
+    g_hash_table_insert (probed, gst_object_ref (to_probe[i]), results[i]);
+  g_free (results);
+  g_free (to_probe);
 
+  if (monitor->priv->cookie != cookie)
+    goto again;
+
+  for (i = 0; i < n_providers; i++) {
+    GList *tmpdev = g_hash_table_lookup (probed, providers[i]);
+    GList *item;
 
     for (item = tmpdev; item; item = item->next) {
       GstDevice *dev = GST_DEVICE (item->data);
@@ -415,27 +575,36 @@ again:
       }
       gst_caps_unref (caps);
     }
-
-    g_list_free_full (tmpdev, gst_object_unref);
-    gst_object_unref (provider);
-
-    if (monitor->priv->cookie != cookie)
-      goto again;
+    gst_object_unref (providers[i]);
   }
+  g_free (providers);
   g_list_free_full (hidden, g_free);
 
   GST_OBJECT_UNLOCK (monitor);
 
+  g_hash_table_destroy (probed);
+
   return g_list_reverse (devices);
 }
 
+static gpointer
+start_provider (GstDeviceProvider * provider)
+{
+  /* providers that can not monitor only probe, in get_devices */
+  if (!gst_device_provider_can_monitor (provider))
+    return GINT_TO_POINTER (TRUE);
+
+  return GINT_TO_POINTER (gst_device_provider_start (provider));
+}
+
 /**
  * gst_device_monitor_start:
  * @monitor: A #GstDeviceMonitor
  *
  * Starts monitoring the devices, one this has succeeded, the
  * %GST_MESSAGE_DEVICE_ADDED and %GST_MESSAGE_DEVICE_REMOVED messages
- * will be emitted on the bus when the list of devices changes.
+ * will be emitted on the bus when the list of devices changes. All providers
+ * are started at the same time.
  *
  * Returns: %TRUE if the device monitoring could be started
  *
@@ -445,8 +614,11 @@ again:
 gboolean
 gst_device_monitor_start (GstDeviceMonitor * monitor)
 {
-  guint cookie, i;
-  GList *pending = NULL, *started = NULL, *removed = NULL;
+  guint cookie, i, n_pending;
+  GList *pending = NULL, *started = NULL, *removed = NULL, *l;
+  GstDeviceProvider **providers;
+  gpointer *results;
+  gboolean failed = FALSE;
 
   g_return_val_if_fail (GST_IS_DEVICE_MONITOR (monitor), FALSE);
 
@@ -495,19 +667,37 @@ again:
   g_list_free_full (removed, gst_object_unref);
   removed = NULL;
 
-  while (pending) {
-    GstDeviceProvider *provider = pending->data;
+  /* start all new providers at once */
+  if (pending) {
+    n_pending = g_list_length (pending);
+    providers = g_new (GstDeviceProvider *, n_pending);
+    for (l = pending, i = 0; l; l = l->next, i++)
+      providers[i] = l->data;
 
-    if (gst_device_provider_can_monitor (provider)) {
-      GST_OBJECT_UNLOCK (monitor);
+    GST_OBJECT_UNLOCK (monitor);
+    results = gst_device_monitor_run_parallel (monitor, providers, n_pending,
+        start_provider);
+    GST_OBJECT_LOCK (monitor);
 
-      if (!gst_device_provider_start (provider))
-        goto start_failed;
+    for (l = pending, i = 0; l; l = l->next, i++) {
+      if (results[i]) {
+        started = g_list_prepend (started, l->data);
+      } else {
+        GST_WARNING_OBJECT (monitor, "failed to start %" GST_PTR_FORMAT,
+            l->data);
+        gst_object_unref (l->data);
+        failed = TRUE;
+      }
+    }
+    g_list_free (pending);
+    pending = NULL;
+    g_free (results);
+    g_free (providers);
 
-      GST_OBJECT_LOCK (monitor);
+    if (failed) {
+      GST_OBJECT_UNLOCK (monitor);
+      goto start_failed;
     }
-    started = g_list_prepend (started, provider);
-    pending = g_list_delete_link (pending, pending);
 
     if (monitor->priv->cookie != cookie)
       goto again;
@@ -528,7 +718,8 @@ start_failed:
     while (started) {
       GstDeviceProvider *provider = started->data;
 
-      gst_device_provider_stop (provider);
+      if (gst_device_provider_can_monitor (provider))
+        gst_device_provider_stop (provider);
       gst_object_unref (provider);
 
       started = g_list_delete_link (started, started);
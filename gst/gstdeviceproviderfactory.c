@@ -137,6 +137,7 @@ gst_device_provider_factory_cleanup (GstDeviceProviderFactory * factory)
     gst_structure_free ((GstStructure *) factory->metadata);
     factory->metadata = NULL;
   }
+  factory->metadata_string = NULL;
   if (factory->type) {
     factory->type = G_TYPE_INVALID;
   }
@@ -418,7 +419,12 @@ const gchar *
 gst_device_provider_factory_get_metadata (GstDeviceProviderFactory * factory,
     const gchar * key)
 {
-  return gst_structure_get_string ((GstStructure *) factory->metadata, key);
+  const GstStructure *metadata;
+
+  metadata = priv_gst_registry_ensure_metadata (&factory->metadata,
+      factory->metadata_string);
+
+  return gst_structure_get_string (metadata, key);
 }
 
 /**
@@ -443,7 +449,8 @@ gst_device_provider_factory_get_metadata_keys (GstDeviceProviderFactory *
 
   g_return_val_if_fail (GST_IS_DEVICE_PROVIDER_FACTORY (factory), NULL);
 
-  metadata = (GstStructure *) factory->metadata;
+  metadata = (GstStructure *) priv_gst_registry_ensure_metadata
+      (&factory->metadata, factory->metadata_string);
   if (metadata == NULL)
     return NULL;
 
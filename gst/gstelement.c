@@ -85,6 +85,7 @@
 #include "gstelementmetadata.h"
 #include "gstenumtypes.h"
 #include "gstbus.h"
+#include "gstbin.h"
 #include "gsterror.h"
 #include "gstevent.h"
 #include "gstutils.h"
@@ -272,6 +273,14 @@ gst_element_base_class_init (gpointer g_class)
     gst_object_ref (tmpl);
   }
   element_class->padtemplates = padtemplates;
+  element_class->padtemplates_by_name =
+      g_hash_table_new (g_str_hash, g_str_equal);
+  for (node = padtemplates; node != NULL; node = node->next) {
+    GstPadTemplate *tmpl = (GstPadTemplate *) node->data;
+
+    g_hash_table_insert (element_class->padtemplates_by_name,
+        tmpl->name_template, tmpl);
+  }
 
   /* set the factory, see gst_element_register() */
   element_class->elementfactory =
@@ -286,6 +295,7 @@ gst_element_base_class_finalize (gpointer g_class)
 {
   GstElementClass *klass = GST_ELEMENT_CLASS (g_class);
 
+  g_hash_table_unref (klass->padtemplates_by_name);
   g_list_foreach (klass->padtemplates, (GFunc) gst_object_unref, NULL);
   g_list_free (klass->padtemplates);
 
@@ -301,8 +311,8 @@ gst_element_init (GstElement * element)
   GST_STATE_PENDING (element) = GST_STATE_VOID_PENDING;
   GST_STATE_RETURN (element) = GST_STATE_CHANGE_SUCCESS;
 
-  g_rec_mutex_init (&element->state_lock);
-  g_cond_init (&element->state_cond);
+  /* state_lock and state_cond are zero-filled and set up by GLib when they
+   * are first used, most elements never wait on the cond */
 }
 
 static void
@@ -621,6 +631,31 @@ gst_element_get_index (GstElement * element)
 }
 #endif
 
+/* elements with fewer pads look up pads by name in the list of pads */
+#define PADS_BY_NAME_THRESHOLD 16
+
+/* with object LOCK, @pad was just added to the pads of @element. The table of
+ * pad names is only created when the element has many pads. The pad name can't
+ * change while the pad has a parent, so the table doesn't copy it */
+static void
+gst_element_index_pad_name (GstElement * element, GstPad * pad)
+{
+  GList *l;
+
+  if (element->pads_by_name) {
+    g_hash_table_insert (element->pads_by_name, GST_PAD_NAME (pad), pad);
+    return;
+  }
+
+  if (element->numpads < PADS_BY_NAME_THRESHOLD)
+    return;
+
+  element->pads_by_name = g_hash_table_new (g_str_hash, g_str_equal);
+  for (l = element->pads; l; l = l->next)
+    g_hash_table_insert (element->pads_by_name, GST_PAD_NAME (l->data),
+        l->data);
+}
+
 /**
  * gst_element_add_pad:
  * @element: a #GstElement to add the pad to.
@@ -663,7 +698,12 @@ gst_element_add_pad (GstElement * element, GstPad * pad)
 
   /* then check to see if there's already a pad by that name here */
   GST_OBJECT_LOCK (element);
-  if (G_UNLIKELY (!gst_object_check_uniqueness (element->pads, pad_name)))
+  if (element->pads_by_name) {
+    if (G_UNLIKELY (pad_name != NULL
+            && g_hash_table_contains (element->pads_by_name, pad_name)))
+      goto name_exists;
+  } else if (G_UNLIKELY (!gst_object_check_uniqueness (element->pads,
+              pad_name)))
     goto name_exists;
 
   /* try to set the pad's parent */
@@ -698,6 +738,7 @@ gst_element_add_pad (GstElement * element, GstPad * pad)
   element->pads = g_list_append (element->pads, pad);
   element->numpads++;
   element->pads_cookie++;
+  gst_element_index_pad_name (element, pad);
   GST_OBJECT_UNLOCK (element);
 
   /* emit the PAD_ADDED signal */
@@ -810,6 +851,8 @@ gst_element_remove_pad (GstElement * element, GstPad * pad)
   element->pads = g_list_remove (element->pads, pad);
   element->numpads--;
   element->pads_cookie++;
+  if (element->pads_by_name)
+    g_hash_table_remove (element->pads_by_name, GST_PAD_NAME (pad));
   GST_OBJECT_UNLOCK (element);
 
   /* emit the PAD_REMOVED signal before unparenting and losing the last ref. */
@@ -892,11 +935,17 @@ gst_element_get_static_pad (GstElement * element, const gchar * name)
   g_return_val_if_fail (name != NULL, NULL);
 
   GST_OBJECT_LOCK (element);
-  find =
-      g_list_find_custom (element->pads, name, (GCompareFunc) pad_compare_name);
-  if (find) {
-    result = GST_PAD_CAST (find->data);
-    gst_object_ref (result);
+  if (element->pads_by_name) {
+    result = g_hash_table_lookup (element->pads_by_name, name);
+    if (result)
+      gst_object_ref (result);
+  } else {
+    find = g_list_find_custom (element->pads, name,
+        (GCompareFunc) pad_compare_name);
+    if (find) {
+      result = GST_PAD_CAST (find->data);
+      gst_object_ref (result);
+    }
   }
 
   if (result == NULL) {
@@ -1147,6 +1196,38 @@ gst_element_iterate_pads (GstElement * element)
   return gst_element_iterate_pad_list (element, &element->pads);
 }
 
+/**
+ * gst_element_iterate_pads_snapshot:
+ * @element: a #GstElement to iterate pads of.
+ *
+ * Retrieves an iterator of the pads @element has at the time of the call.
+ * Unlike gst_element_iterate_pads(), the iterator does not take the lock of
+ * @element and never returns %GST_ITERATOR_RESYNC, pads that are added or
+ * removed later are not reflected.
+ *
+ * The order of pads returned by the iterator will be the order in which
+ * the pads were added to the element.
+ *
+ * Returns: (transfer full): the #GstIterator of #GstPad.
+ *
+ * MT safe.
+ *
+ * Since: 1.10
+ */
+GstIterator *
+gst_element_iterate_pads_snapshot (GstElement * element)
+{
+  GstIterator *result;
+
+  g_return_val_if_fail (GST_IS_ELEMENT (element), NULL);
+
+  GST_OBJECT_LOCK (element);
+  result = _priv_gst_iterator_new_list_snapshot (GST_TYPE_PAD, element->pads);
+  GST_OBJECT_UNLOCK (element);
+
+  return result;
+}
+
 /**
  * gst_element_iterate_src_pads:
  * @element: a #GstElement.
@@ -1215,6 +1296,8 @@ gst_element_class_add_pad_template (GstElementClass * klass,
 
     /* Found pad with the same name, replace and return */
     if (strcmp (templ->name_template, padtempl->name_template) == 0) {
+      g_hash_table_insert (klass->padtemplates_by_name, templ->name_template,
+          templ);
       gst_object_unref (padtempl);
       template_list->data = templ;
       return;
@@ -1227,6 +1310,8 @@ gst_element_class_add_pad_template (GstElementClass * klass,
 
   klass->padtemplates = g_list_append (klass->padtemplates, templ);
   klass->numpadtemplates++;
+  g_hash_table_insert (klass->padtemplates_by_name, templ->name_template,
+      templ);
 }
 
 /**
@@ -1437,23 +1522,10 @@ GstPadTemplate *
 gst_element_class_get_pad_template (GstElementClass *
     element_class, const gchar * name)
 {
-  GList *padlist;
-
   g_return_val_if_fail (GST_IS_ELEMENT_CLASS (element_class), NULL);
   g_return_val_if_fail (name != NULL, NULL);
 
-  padlist = element_class->padtemplates;
-
-  while (padlist) {
-    GstPadTemplate *padtempl = (GstPadTemplate *) padlist->data;
-
-    if (strcmp (padtempl->name_template, name) == 0)
-      return padtempl;
-
-    padlist = g_list_next (padlist);
-  }
-
-  return NULL;
+  return g_hash_table_lookup (element_class->padtemplates_by_name, name);
 }
 
 static GstPadTemplate *
@@ -1703,10 +1775,67 @@ gst_element_query (GstElement * element, GstQuery * query)
   return res;
 }
 
+/* walk up from @bin, the parent of the element that posts a message of
+ * @type on @bus, past the bins that would only forward the message. Returns
+ * the bus to post the message on or %NULL when it would be dropped on the
+ * way, @skipped is set when that is not @bus. Takes ownership of @bin and
+ * @bus. */
+static GstBus *
+gst_element_find_message_bus (GstBin * bin, GstBus * bus, GstMessageType type,
+    gboolean * skipped)
+{
+  GstBus *next_bus;
+  GstObject *parent;
+
+  *skipped = FALSE;
+  while (bin && _priv_gst_bin_forwards_message (bin, type)) {
+    *skipped = TRUE;
+
+    /* the skipped bus could drop it */
+    if (!(gst_bus_get_accept_types (bus) & type))
+      goto dropped;
+
+    GST_OBJECT_LOCK (bin);
+    next_bus = GST_ELEMENT_BUS (bin);
+    if (next_bus)
+      gst_object_ref (next_bus);
+    parent = GST_OBJECT_PARENT (bin);
+    if (parent && GST_IS_BIN (parent))
+      gst_object_ref (parent);
+    else
+      parent = NULL;
+    GST_OBJECT_UNLOCK (bin);
+
+    gst_object_unref (bin);
+    gst_object_unref (bus);
+    bin = GST_BIN_CAST (parent);
+    bus = next_bus;
+
+    if (bus == NULL)
+      goto dropped;
+  }
+
+  if (bin)
+    gst_object_unref (bin);
+
+  return bus;
+
+dropped:
+  {
+    if (bin)
+      gst_object_unref (bin);
+    if (bus)
+      gst_object_unref (bus);
+    return NULL;
+  }
+}
+
 static gboolean
 gst_element_post_message_default (GstElement * element, GstMessage * message)
 {
   GstBus *bus;
+  GstObject *parent;
+  gboolean skipped = FALSE;
   gboolean result = FALSE;
 
   g_return_val_if_fail (GST_IS_ELEMENT (element), FALSE);
@@ -1719,14 +1848,38 @@ gst_element_post_message_default (GstElement * element, GstMessage * message)
     goto no_bus;
 
   gst_object_ref (bus);
+  parent = GST_OBJECT_PARENT (element);
+  if (parent && GST_IS_BIN (parent))
+    gst_object_ref (parent);
+  else
+    parent = NULL;
   GST_OBJECT_UNLOCK (element);
 
+  /* messages the parent bins would only forward go straight to the bus they
+   * end up on, without going through every bin */
+  if (parent) {
+    bus = gst_element_find_message_bus (GST_BIN_CAST (parent), bus,
+        GST_MESSAGE_TYPE (message), &skipped);
+    if (bus == NULL)
+      goto dropped;
+  }
+
   /* we release the element lock when posting the message so that any
    * (synchronous) message handlers can operate on the element */
   result = gst_bus_post (bus, message);
   gst_object_unref (bus);
 
-  return result;
+  /* the bus of the parent always takes the message */
+  return result || skipped;
+
+dropped:
+  {
+    /* like the bus of the parent would have */
+    GST_CAT_DEBUG_OBJECT (GST_CAT_MESSAGE, element,
+        "message %p is dropped before reaching a bus", message);
+    gst_message_unref (message);
+    return TRUE;
+  }
 
   /* ERRORS */
 no_bus:
@@ -1774,6 +1927,72 @@ gst_element_post_message (GstElement * element, GstMessage * message)
   return res;
 }
 
+/**
+ * gst_element_message_will_be_posted:
+ * @element: a #GstElement
+ * @type: the #GstMessageType of a message
+ *
+ * Check if a message of @type, posted by @element now, would be delivered
+ * to anyone. This is not the case when @element has no bus, or when the
+ * message would only be forwarded up to a bus that does not accept @type,
+ * see gst_bus_set_accept_types().
+ *
+ * Elements that post many messages, like QoS or buffering messages, can use
+ * this to skip creating messages that would be dropped anyway.
+ *
+ * Returns: %TRUE if a message of @type would be posted.
+ *
+ * MT safe.
+ *
+ * Since: 1.10
+ */
+gboolean
+gst_element_message_will_be_posted (GstElement * element, GstMessageType type)
+{
+  GstElement *cur;
+  GstObject *parent;
+  GstBus *bus;
+  gboolean res;
+
+  g_return_val_if_fail (GST_IS_ELEMENT (element), FALSE);
+
+  cur = gst_object_ref (element);
+  do {
+    GST_OBJECT_LOCK (cur);
+    if ((bus = cur->bus))
+      gst_object_ref (bus);
+    if ((parent = GST_OBJECT_PARENT (cur)))
+      gst_object_ref (parent);
+    GST_OBJECT_UNLOCK (cur);
+    gst_object_unref (cur);
+
+    if (bus == NULL) {
+      res = FALSE;
+      break;
+    }
+    res = (gst_bus_get_accept_types (bus) & type) != 0;
+    gst_object_unref (bus);
+
+    /* stop when the bus drops it, when it reached the top-level bus or
+     * when a bin will do something with it */
+    if (!res || parent == NULL || !GST_IS_BIN (parent)
+        || _priv_gst_bin_handles_message (GST_BIN_CAST (parent), type))
+      break;
+
+    /* see if the bin would forward it to anyone */
+    cur = GST_ELEMENT_CAST (parent);
+    parent = NULL;
+  } while (TRUE);
+
+  if (parent)
+    gst_object_unref (parent);
+
+  GST_CAT_LOG_OBJECT (GST_CAT_MESSAGE, element, "message of type %s will %sbe "
+      "posted", gst_message_type_get_name (type), res ? "" : "not ");
+
+  return res;
+}
+
 /**
  * _gst_element_error_printf:
  * @format: (allow-none): the printf-like format to use, or %NULL
@@ -3022,8 +3241,11 @@ gst_element_finalize (GObject * object)
 
   GST_CAT_INFO_OBJECT (GST_CAT_REFCOUNTING, element, "finalize");
 
-  g_cond_clear (&element->state_cond);
-  g_rec_mutex_clear (&element->state_lock);
+  _priv_gst_cond_clear_lazy (&element->state_cond);
+  _priv_gst_rec_mutex_clear_lazy (&element->state_lock);
+
+  if (element->pads_by_name)
+    g_hash_table_unref (element->pads_by_name);
 
   GST_CAT_INFO_OBJECT (GST_CAT_REFCOUNTING, element, "finalize parent");
 
@@ -577,7 +577,10 @@ struct _GstElement
   GList                *contexts;
 
   /*< private >*/
-  gpointer _gst_reserved[GST_PADDING-1];
+  /* pad name -> pad, only for elements with many pads, with object LOCK */
+  GHashTable           *pads_by_name;
+
+  gpointer _gst_reserved[GST_PADDING-2];
 };
 
 /**
@@ -602,6 +605,10 @@ struct _GstElement
  * @post_message: called when a message is posted on the element. Chain up to
  *                the parent class' handler to have it posted on the bus.
  * @set_context: set a #GstContext on the element
+ * @reset: reset the element to the state it had right after construction,
+ *         for reuse by a #GstElementPool. Properties are already reset to
+ *         their default values. Return %FALSE if the element can not be
+ *         reused. Since: 1.10
  *
  * GStreamer element class. Override the vmethods to implement the element
  * functionality.
@@ -662,8 +669,13 @@ struct _GstElementClass
 
   void                  (*set_context)          (GstElement *element, GstContext *context);
 
+  gboolean              (*reset)                (GstElement *element);
+
   /*< private >*/
-  gpointer _gst_reserved[GST_PADDING_LARGE-2];
+  /* name template -> pad template */
+  GHashTable           *padtemplates_by_name;
+
+  gpointer _gst_reserved[GST_PADDING_LARGE-4];
 };
 
 /* element class pad templates */
@@ -772,6 +784,7 @@ GstPad*                 gst_element_request_pad         (GstElement *element, Gs
 void                    gst_element_release_request_pad (GstElement *element, GstPad *pad);
 
 GstIterator *           gst_element_iterate_pads        (GstElement * element);
+GstIterator *           gst_element_iterate_pads_snapshot (GstElement * element);
 GstIterator *           gst_element_iterate_src_pads    (GstElement * element);
 GstIterator *           gst_element_iterate_sink_pads   (GstElement * element);
 
@@ -785,6 +798,7 @@ gboolean                gst_element_query               (GstElement *element, Gs
 
 /* messages */
 gboolean                gst_element_post_message        (GstElement * element, GstMessage * message);
+gboolean                gst_element_message_will_be_posted (GstElement * element, GstMessageType type);
 
 /* error handling */
 /* gcc versions < 3.3 warn about NULL being passed as format to printf */
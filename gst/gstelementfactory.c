@@ -153,6 +153,7 @@ gst_element_factory_cleanup (GstElementFactory * factory)
     gst_structure_free ((GstStructure *) factory->metadata);
     factory->metadata = NULL;
   }
+  factory->metadata_string = NULL;
   if (factory->type) {
     factory->type = G_TYPE_INVALID;
   }
@@ -510,7 +511,12 @@ const gchar *
 gst_element_factory_get_metadata (GstElementFactory * factory,
     const gchar * key)
 {
-  return gst_structure_get_string ((GstStructure *) factory->metadata, key);
+  const GstStructure *metadata;
+
+  metadata = priv_gst_registry_ensure_metadata (&factory->metadata,
+      factory->metadata_string);
+
+  return gst_structure_get_string (metadata, key);
 }
 
 /**
@@ -532,7 +538,8 @@ gst_element_factory_get_metadata_keys (GstElementFactory * factory)
 
   g_return_val_if_fail (GST_IS_ELEMENT_FACTORY (factory), NULL);
 
-  metadata = (GstStructure *) factory->metadata;
+  metadata = (GstStructure *) priv_gst_registry_ensure_metadata
+      (&factory->metadata, factory->metadata_string);
   if (metadata == NULL)
     return NULL;
 
@@ -833,9 +840,16 @@ gst_element_factory_list_filter (GList * list,
     const GstCaps * caps, GstPadDirection direction, gboolean subsetonly)
 {
   GQueue results = G_QUEUE_INIT;
+  GHashTable *candidates = NULL, *indexed = NULL;
 
   GST_DEBUG ("finding factories");
 
+  /* the registry knows which factories have templates with the media types
+   * of @caps, only those need to be checked */
+  if (list && list->next)
+    candidates = priv_gst_registry_get_factory_candidates (gst_registry_get (),
+        caps, direction, &indexed);
+
   /* loop over all the factories */
   for (; list; list = list->next) {
     GstElementFactory *factory;
@@ -844,6 +858,10 @@ gst_element_factory_list_filter (GList * list,
 
     factory = (GstElementFactory *) list->data;
 
+    if (candidates && !g_hash_table_contains (candidates, factory) &&
+        g_hash_table_contains (indexed, factory))
+      continue;
+
     GST_DEBUG ("Trying %s",
         gst_plugin_feature_get_name ((GstPluginFeature *) factory));
 
@@ -874,5 +892,11 @@ gst_element_factory_list_filter (GList * list,
       }
     }
   }
+
+  if (candidates) {
+    g_hash_table_unref (candidates);
+    g_hash_table_unref (indexed);
+  }
+
   return results.head;
 }
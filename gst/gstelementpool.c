@@ -0,0 +1,610 @@
+/* GStreamer
+ *
+ * gstelementpool.c: pool of reusable elements
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/**
+ * SECTION:gstelementpool
+ * @short_description: Recycle elements instead of creating new ones
+ * @see_also: #GstElementFactory
+ *
+ * Applications that create and destroy many elements of the same type, for
+ * example one small pipeline per session, spend a lot of time constructing
+ * elements and their pads and freeing them again. A #GstElementPool keeps
+ * elements that are no longer used and hands them out again instead of
+ * creating new ones.
+ *
+ * gst_element_pool_acquire() and gst_element_pool_make() work like
+ * gst_element_factory_create() and gst_element_factory_make() and return a
+ * new floating reference. When the application is done with an element, it
+ * sets it to the NULL state, removes it from its bin and passes its last
+ * reference to gst_element_pool_release():
+ * |[<!-- language="C" -->
+ *   GstElement *queue = gst_element_pool_make (pool, "queue", NULL);
+ *
+ *   gst_bin_add (GST_BIN (pipeline), queue);
+ *   ...
+ *   gst_element_set_state (pipeline, GST_STATE_NULL);
+ *   gst_object_ref (queue);
+ *   gst_bin_remove (GST_BIN (pipeline), queue);
+ *   gst_element_pool_release (pool, queue);
+ * ]|
+ *
+ * Released elements are reset before they are reused: links are removed,
+ * request pads are released, contexts, clock and times are cleared and all
+ * writable properties are set back to the default values of their
+ * #GParamSpec. Elements that keep other state, or that change property
+ * values after construction, implement the #GstElementClass.reset()
+ * virtual method.
+ * Elements that can not be reset this way, bins and elements that were
+ * not created from a factory are destroyed instead.
+ *
+ * Signal handlers, pad probes and object data that the application added
+ * are not removed by the pool. The application has to remove them before
+ * it releases the element.
+ */
+
+#include "gst_private.h"
+
+#include "gstinfo.h"
+#include "gstbin.h"
+#include "gstelementpool.h"
+
+GST_DEBUG_CATEGORY_STATIC (element_pool_debug);
+#define GST_CAT_DEFAULT (element_pool_debug)
+
+struct _GstElementPoolPrivate
+{
+  guint max_idle;
+  guint n_idle;
+
+  /* GstElementFactory -> GQueue of idle elements */
+  GHashTable *idle;
+};
+
+enum
+{
+  PROP_0,
+  PROP_MAX_IDLE
+};
+
+static void gst_element_pool_finalize (GObject * object);
+static void gst_element_pool_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec);
+static void gst_element_pool_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec);
+
+#define _do_init \
+{ \
+  GST_DEBUG_CATEGORY_INIT (element_pool_debug, "elementpool", 0, \
+      "Element pool"); \
+}
+
+#define GST_ELEMENT_POOL_GET_PRIVATE(obj)  \
+   (G_TYPE_INSTANCE_GET_PRIVATE ((obj), GST_TYPE_ELEMENT_POOL, GstElementPoolPrivate))
+
+G_DEFINE_TYPE_WITH_CODE (GstElementPool, gst_element_pool, GST_TYPE_OBJECT,
+    _do_init);
+
+static void
+gst_element_pool_class_init (GstElementPoolClass * klass)
+{
+  GObjectClass *gobject_class = (GObjectClass *) klass;
+
+  g_type_class_add_private (klass, sizeof (GstElementPoolPrivate));
+
+  gobject_class->finalize = gst_element_pool_finalize;
+  gobject_class->set_property = gst_element_pool_set_property;
+  gobject_class->get_property = gst_element_pool_get_property;
+
+  /**
+   * GstElementPool:max-idle:
+   *
+   * The maximum number of idle elements kept per element factory. Elements
+   * released beyond that are destroyed.
+   *
+   * Since: 1.10
+   */
+  g_object_class_install_property (gobject_class, PROP_MAX_IDLE,
+      g_param_spec_uint ("max-idle", "Max idle",
+          "Maximum number of idle elements kept per factory",
+          0, G_MAXUINT, GST_ELEMENT_POOL_DEFAULT_MAX_IDLE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+}
+
+static void
+free_idle_queue (GQueue * queue)
+{
+  g_queue_free_full (queue, (GDestroyNotify) gst_object_unref);
+}
+
+static void
+gst_element_pool_init (GstElementPool * pool)
+{
+  pool->priv = GST_ELEMENT_POOL_GET_PRIVATE (pool);
+
+  pool->priv->max_idle = GST_ELEMENT_POOL_DEFAULT_MAX_IDLE;
+  pool->priv->idle = g_hash_table_new_full (NULL, NULL,
+      (GDestroyNotify) gst_object_unref, (GDestroyNotify) free_idle_queue);
+}
+
+static void
+gst_element_pool_finalize (GObject * object)
+{
+  GstElementPool *pool = GST_ELEMENT_POOL (object);
+
+  g_hash_table_unref (pool->priv->idle);
+
+  G_OBJECT_CLASS (gst_element_pool_parent_class)->finalize (object);
+}
+
+static void
+gst_element_pool_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstElementPool *pool = GST_ELEMENT_POOL (object);
+
+  switch (prop_id) {
+    case PROP_MAX_IDLE:
+      gst_element_pool_set_max_idle (pool, g_value_get_uint (value));
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_element_pool_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec)
+{
+  GstElementPool *pool = GST_ELEMENT_POOL (object);
+
+  switch (prop_id) {
+    case PROP_MAX_IDLE:
+      g_value_set_uint (value, gst_element_pool_get_max_idle (pool));
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+/**
+ * gst_element_pool_new:
+ *
+ * Create a new, empty element pool.
+ *
+ * Returns: (transfer full): a new #GstElementPool
+ *
+ * Since: 1.10
+ */
+GstElementPool *
+gst_element_pool_new (void)
+{
+  GstElementPool *pool;
+
+  pool = g_object_new (GST_TYPE_ELEMENT_POOL, NULL);
+
+  /* we don't want a floating ref */
+  gst_object_ref_sink (pool);
+
+  return pool;
+}
+
+/* must be called with the lock; removes elements beyond max_idle */
+static GList *
+trim_idle (GstElementPool * pool)
+{
+  GstElementPoolPrivate *priv = pool->priv;
+  GHashTableIter iter;
+  GQueue *queue;
+  GList *removed = NULL;
+
+  g_hash_table_iter_init (&iter, priv->idle);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer *) & queue)) {
+    while (queue->length > priv->max_idle) {
+      removed = g_list_prepend (removed, g_queue_pop_tail (queue));
+      priv->n_idle--;
+    }
+  }
+  return removed;
+}
+
+/**
+ * gst_element_pool_set_max_idle:
+ * @pool: a #GstElementPool
+ * @max_idle: the maximum number of idle elements per factory
+ *
+ * Set the maximum number of idle elements @pool keeps for each element
+ * factory. Idle elements beyond the new maximum are destroyed.
+ *
+ * Since: 1.10
+ */
+void
+gst_element_pool_set_max_idle (GstElementPool * pool, guint max_idle)
+{
+  GList *removed;
+
+  g_return_if_fail (GST_IS_ELEMENT_POOL (pool));
+
+  GST_OBJECT_LOCK (pool);
+  pool->priv->max_idle = max_idle;
+  removed = trim_idle (pool);
+  GST_OBJECT_UNLOCK (pool);
+
+  g_list_free_full (removed, (GDestroyNotify) gst_object_unref);
+}
+
+/**
+ * gst_element_pool_get_max_idle:
+ * @pool: a #GstElementPool
+ *
+ * Get the maximum number of idle elements @pool keeps for each element
+ * factory.
+ *
+ * Returns: the maximum number of idle elements per factory
+ *
+ * Since: 1.10
+ */
+guint
+gst_element_pool_get_max_idle (GstElementPool * pool)
+{
+  guint result;
+
+  g_return_val_if_fail (GST_IS_ELEMENT_POOL (pool), 0);
+
+  GST_OBJECT_LOCK (pool);
+  result = pool->priv->max_idle;
+  GST_OBJECT_UNLOCK (pool);
+
+  return result;
+}
+
+/**
+ * gst_element_pool_acquire:
+ * @pool: a #GstElementPool
+ * @factory: factory of the element
+ * @name: (allow-none): name of the element
+ *
+ * Get an element of @factory from @pool. When the pool has no idle element
+ * of @factory, a new one is created with gst_element_factory_create().
+ *
+ * The element gets the name @name, or a unique name when @name is %NULL.
+ *
+ * Returns: (transfer floating) (nullable): a #GstElement in the NULL state
+ * or %NULL if the element could not be created
+ *
+ * Since: 1.10
+ */
+GstElement *
+gst_element_pool_acquire (GstElementPool * pool, GstElementFactory * factory,
+    const gchar * name)
+{
+  GstElement *element = NULL;
+  GQueue *queue;
+
+  g_return_val_if_fail (GST_IS_ELEMENT_POOL (pool), NULL);
+  g_return_val_if_fail (GST_IS_ELEMENT_FACTORY (factory), NULL);
+
+  GST_OBJECT_LOCK (pool);
+  queue = g_hash_table_lookup (pool->priv->idle, factory);
+  if (queue && (element = g_queue_pop_head (queue)))
+    pool->priv->n_idle--;
+  GST_OBJECT_UNLOCK (pool);
+
+  if (element == NULL) {
+    GST_LOG_OBJECT (pool, "no idle element of factory %s",
+        GST_OBJECT_NAME (factory));
+    return gst_element_factory_create (factory, name);
+  }
+
+  gst_object_set_name (GST_OBJECT_CAST (element), name);
+
+  /* hand it out like a new element */
+  g_object_force_floating (G_OBJECT (element));
+
+  GST_DEBUG_OBJECT (pool, "reusing element %" GST_PTR_FORMAT, element);
+
+  return element;
+}
+
+/**
+ * gst_element_pool_make:
+ * @pool: a #GstElementPool
+ * @factoryname: a named factory to get the element from
+ * @name: (allow-none): name of the element
+ *
+ * Get an element of the factory named @factoryname from @pool, like
+ * gst_element_factory_make() does.
+ *
+ * Returns: (transfer floating) (nullable): a #GstElement in the NULL state
+ * or %NULL if the element could not be created
+ *
+ * Since: 1.10
+ */
+GstElement *
+gst_element_pool_make (GstElementPool * pool, const gchar * factoryname,
+    const gchar * name)
+{
+  GstElementFactory *factory;
+  GstElement *element;
+
+  g_return_val_if_fail (GST_IS_ELEMENT_POOL (pool), NULL);
+  g_return_val_if_fail (factoryname != NULL, NULL);
+
+  factory = gst_element_factory_find (factoryname);
+  if (factory == NULL)
+    goto no_factory;
+
+  element = gst_element_pool_acquire (pool, factory, name);
+  gst_object_unref (factory);
+
+  return element;
+
+  /* ERRORS */
+no_factory:
+  {
+    GST_INFO_OBJECT (pool, "no such element factory \"%s\"!", factoryname);
+    return NULL;
+  }
+}
+
+static void
+reset_pads (GstElement * element)
+{
+  GList *pads, *walk;
+
+  GST_OBJECT_LOCK (element);
+  pads = g_list_copy_deep (element->pads, (GCopyFunc) gst_object_ref, NULL);
+  GST_OBJECT_UNLOCK (element);
+
+  for (walk = pads; walk; walk = walk->next) {
+    GstPad *pad = walk->data;
+    GstPad *peer;
+    GstPadTemplate *templ;
+
+    if ((peer = gst_pad_get_peer (pad))) {
+      if (GST_PAD_IS_SRC (pad))
+        gst_pad_unlink (pad, peer);
+      else
+        gst_pad_unlink (peer, pad);
+      gst_object_unref (peer);
+    }
+
+    templ = GST_PAD_PAD_TEMPLATE (pad);
+    if (templ && GST_PAD_TEMPLATE_PRESENCE (templ) == GST_PAD_REQUEST)
+      gst_element_release_request_pad (element, pad);
+  }
+  g_list_free_full (pads, (GDestroyNotify) gst_object_unref);
+}
+
+/* only the always pads that were there after construction may remain */
+static gboolean
+pads_are_static (GstElement * element)
+{
+  GList *walk;
+  gboolean result = TRUE;
+
+  GST_OBJECT_LOCK (element);
+  for (walk = element->pads; walk; walk = walk->next) {
+    GstPadTemplate *templ = GST_PAD_PAD_TEMPLATE (walk->data);
+
+    if (templ == NULL || GST_PAD_TEMPLATE_PRESENCE (templ) != GST_PAD_ALWAYS) {
+      result = FALSE;
+      break;
+    }
+  }
+  GST_OBJECT_UNLOCK (element);
+
+  return result;
+}
+
+static void
+reset_properties (GstElement * element)
+{
+  GParamSpec **pspecs;
+  guint i, n_pspecs;
+  GValue value = G_VALUE_INIT;
+
+  pspecs = g_object_class_list_properties (G_OBJECT_GET_CLASS (element),
+      &n_pspecs);
+
+  g_object_freeze_notify (G_OBJECT (element));
+  for (i = 0; i < n_pspecs; i++) {
+    GParamSpec *pspec = pspecs[i];
+
+    /* name and parent are handled by the pool */
+    if (pspec->owner_type == GST_TYPE_OBJECT)
+      continue;
+    if ((pspec->flags & G_PARAM_READWRITE) != G_PARAM_READWRITE)
+      continue;
+    if (pspec->flags & (G_PARAM_CONSTRUCT_ONLY | G_PARAM_DEPRECATED))
+      continue;
+
+    g_value_init (&value, G_PARAM_SPEC_VALUE_TYPE (pspec));
+    g_object_get_property (G_OBJECT (element), pspec->name, &value);
+    if (g_param_values_cmp (pspec, &value,
+            g_param_spec_get_default_value (pspec)) != 0) {
+      GST_LOG_OBJECT (element, "resetting property %s", pspec->name);
+      g_object_set_property (G_OBJECT (element), pspec->name,
+          g_param_spec_get_default_value (pspec));
+    }
+    g_value_unset (&value);
+  }
+  g_object_thaw_notify (G_OBJECT (element));
+
+  g_free (pspecs);
+}
+
+static gboolean
+reset_element (GstElement * element)
+{
+  GstElementClass *klass = GST_ELEMENT_GET_CLASS (element);
+  GList *contexts;
+
+  reset_pads (element);
+  if (!pads_are_static (element)) {
+    GST_DEBUG_OBJECT (element, "element has dynamic pads");
+    return FALSE;
+  }
+
+  GST_OBJECT_LOCK (element);
+  contexts = element->contexts;
+  element->contexts = NULL;
+  element->base_time = 0;
+  element->start_time = 0;
+  GST_OBJECT_FLAG_UNSET (element, GST_ELEMENT_FLAG_LOCKED_STATE);
+  GST_OBJECT_UNLOCK (element);
+  g_list_free_full (contexts, (GDestroyNotify) gst_context_unref);
+
+  gst_element_set_bus (element, NULL);
+  gst_element_set_clock (element, NULL);
+
+  reset_properties (element);
+
+  if (klass->reset && !klass->reset (element)) {
+    GST_DEBUG_OBJECT (element, "element could not be reset");
+    return FALSE;
+  }
+  return TRUE;
+}
+
+/**
+ * gst_element_pool_release:
+ * @pool: a #GstElementPool
+ * @element: (transfer full): the #GstElement to release
+ *
+ * Give @element back to @pool for reuse. @element must be in the NULL state,
+ * have no parent and @pool must get its only reference.
+ *
+ * @element is reset as described in the overview and kept for
+ * gst_element_pool_acquire(). Elements that can not be reused are destroyed.
+ *
+ * Since: 1.10
+ */
+void
+gst_element_pool_release (GstElementPool * pool, GstElement * element)
+{
+  GstElementPoolPrivate *priv;
+  GstElementFactory *factory;
+  GQueue *queue;
+  gboolean reusable;
+
+  g_return_if_fail (GST_IS_ELEMENT_POOL (pool));
+  g_return_if_fail (GST_IS_ELEMENT (element));
+
+  priv = pool->priv;
+
+  factory = gst_element_get_factory (element);
+  if (factory == NULL || GST_IS_BIN (element))
+    goto not_reusable;
+
+  GST_OBJECT_LOCK (element);
+  reusable = GST_STATE (element) == GST_STATE_NULL
+      && GST_STATE_PENDING (element) == GST_STATE_VOID_PENDING
+      && GST_OBJECT_PARENT (element) == NULL;
+  GST_OBJECT_UNLOCK (element);
+  if (!reusable || GST_OBJECT_REFCOUNT_VALUE (element) != 1)
+    goto in_use;
+
+  if (!reset_element (element))
+    goto not_reusable;
+
+  GST_OBJECT_LOCK (pool);
+  queue = g_hash_table_lookup (priv->idle, factory);
+  if (queue == NULL) {
+    queue = g_queue_new ();
+    g_hash_table_insert (priv->idle, gst_object_ref (factory), queue);
+  }
+  if (queue->length >= priv->max_idle) {
+    GST_OBJECT_UNLOCK (pool);
+    goto not_reusable;
+  }
+  g_queue_push_head (queue, element);
+  priv->n_idle++;
+  GST_OBJECT_UNLOCK (pool);
+
+  GST_DEBUG_OBJECT (pool, "keeping element %" GST_PTR_FORMAT, element);
+
+  return;
+
+  /* ERRORS */
+in_use:
+  {
+    GST_WARNING_OBJECT (pool, "element %" GST_PTR_FORMAT " is still in use",
+        element);
+    gst_object_unref (element);
+    return;
+  }
+not_reusable:
+  {
+    GST_DEBUG_OBJECT (pool, "destroying element %" GST_PTR_FORMAT, element);
+    gst_object_unref (element);
+    return;
+  }
+}
+
+/**
+ * gst_element_pool_get_n_idle:
+ * @pool: a #GstElementPool
+ *
+ * Get the number of idle elements in @pool, for all factories together.
+ *
+ * Returns: the number of idle elements
+ *
+ * Since: 1.10
+ */
+guint
+gst_element_pool_get_n_idle (GstElementPool * pool)
+{
+  guint result;
+
+  g_return_val_if_fail (GST_IS_ELEMENT_POOL (pool), 0);
+
+  GST_OBJECT_LOCK (pool);
+  result = pool->priv->n_idle;
+  GST_OBJECT_UNLOCK (pool);
+
+  return result;
+}
+
+/**
+ * gst_element_pool_clear:
+ * @pool: a #GstElementPool
+ *
+ * Destroy all idle elements of @pool.
+ *
+ * Since: 1.10
+ */
+void
+gst_element_pool_clear (GstElementPool * pool)
+{
+  GHashTable *idle;
+
+  g_return_if_fail (GST_IS_ELEMENT_POOL (pool));
+
+  GST_OBJECT_LOCK (pool);
+  idle = pool->priv->idle;
+  pool->priv->idle = g_hash_table_new_full (NULL, NULL,
+      (GDestroyNotify) gst_object_unref, (GDestroyNotify) free_idle_queue);
+  pool->priv->n_idle = 0;
+  GST_OBJECT_UNLOCK (pool);
+
+  g_hash_table_unref (idle);
+}
@@ -0,0 +1,106 @@
+/* GStreamer
+ *
+ * gstelementpool.h: pool of reusable elements
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __GST_ELEMENT_POOL_H__
+#define __GST_ELEMENT_POOL_H__
+
+#include <gst/gstobject.h>
+#include <gst/gstelement.h>
+#include <gst/gstelementfactory.h>
+
+G_BEGIN_DECLS
+
+#define GST_TYPE_ELEMENT_POOL             (gst_element_pool_get_type ())
+#define GST_ELEMENT_POOL(obj)             (G_TYPE_CHECK_INSTANCE_CAST ((obj), GST_TYPE_ELEMENT_POOL, GstElementPool))
+#define GST_IS_ELEMENT_POOL(obj)          (G_TYPE_CHECK_INSTANCE_TYPE ((obj), GST_TYPE_ELEMENT_POOL))
+#define GST_ELEMENT_POOL_CLASS(klass)     (G_TYPE_CHECK_CLASS_CAST ((klass), GST_TYPE_ELEMENT_POOL, GstElementPoolClass))
+#define GST_IS_ELEMENT_POOL_CLASS(klass)  (G_TYPE_CHECK_CLASS_TYPE ((klass), GST_TYPE_ELEMENT_POOL))
+#define GST_ELEMENT_POOL_GET_CLASS(obj)   (G_TYPE_INSTANCE_GET_CLASS ((obj), GST_TYPE_ELEMENT_POOL, GstElementPoolClass))
+#define GST_ELEMENT_POOL_CAST(obj)        ((GstElementPool *)(obj))
+
+/**
+ * GST_ELEMENT_POOL_DEFAULT_MAX_IDLE:
+ *
+ * The default number of idle elements a #GstElementPool keeps per factory.
+ *
+ * Since: 1.10
+ */
+#define GST_ELEMENT_POOL_DEFAULT_MAX_IDLE 16
+
+typedef struct _GstElementPool GstElementPool;
+typedef struct _GstElementPoolClass GstElementPoolClass;
+typedef struct _GstElementPoolPrivate GstElementPoolPrivate;
+
+/**
+ * GstElementPool:
+ *
+ * The opaque #GstElementPool object.
+ *
+ * Since: 1.10
+ */
+struct _GstElementPool {
+  GstObject object;
+
+  /*< private >*/
+  GstElementPoolPrivate *priv;
+  gpointer _gst_reserved[GST_PADDING];
+};
+
+/**
+ * GstElementPoolClass:
+ * @parent_class: the parent class structure
+ *
+ * The #GstElementPoolClass structure.
+ *
+ * Since: 1.10
+ */
+struct _GstElementPoolClass {
+  GstObjectClass parent_class;
+
+  /*< private >*/
+  gpointer _gst_reserved[GST_PADDING];
+};
+
+GType                   gst_element_pool_get_type       (void);
+
+GstElementPool *        gst_element_pool_new            (void);
+
+void                    gst_element_pool_set_max_idle   (GstElementPool * pool, guint max_idle);
+guint                   gst_element_pool_get_max_idle   (GstElementPool * pool);
+
+GstElement *            gst_element_pool_acquire        (GstElementPool * pool,
+                                                         GstElementFactory * factory,
+                                                         const gchar * name);
+GstElement *            gst_element_pool_make           (GstElementPool * pool,
+                                                         const gchar * factoryname,
+                                                         const gchar * name);
+void                    gst_element_pool_release        (GstElementPool * pool,
+                                                         GstElement * element);
+
+guint                   gst_element_pool_get_n_idle     (GstElementPool * pool);
+void                    gst_element_pool_clear          (GstElementPool * pool);
+
+#ifdef G_DEFINE_AUTOPTR_CLEANUP_FUNC
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(GstElementPool, gst_object_unref)
+#endif
+
+G_END_DECLS
+
+#endif /* __GST_ELEMENT_POOL_H__ */
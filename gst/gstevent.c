@@ -225,7 +225,8 @@ _gst_event_free (GstEvent * event)
     gst_structure_free (s);
   }
 
-  g_slice_free1 (sizeof (GstEventImpl), event);
+  _priv_gst_mini_object_cache_free (GST_MINI_OBJECT_CACHE_EVENT,
+      sizeof (GstEventImpl), event);
 }
 
 static void gst_event_init (GstEventImpl * event, GstEventType type);
@@ -236,7 +237,8 @@ _gst_event_copy (GstEvent * event)
   GstEventImpl *copy;
   GstStructure *s;
 
-  copy = g_slice_new0 (GstEventImpl);
+  copy = _priv_gst_mini_object_cache_alloc0 (GST_MINI_OBJECT_CACHE_EVENT,
+      sizeof (GstEventImpl));
 
   gst_event_init (copy, GST_EVENT_TYPE (event));
 
@@ -296,7 +298,8 @@ gst_event_new_custom (GstEventType type, GstStructure * structure)
 {
   GstEventImpl *event;
 
-  event = g_slice_new0 (GstEventImpl);
+  event = _priv_gst_mini_object_cache_alloc0 (GST_MINI_OBJECT_CACHE_EVENT,
+      sizeof (GstEventImpl));
 
   GST_CAT_DEBUG (GST_CAT_EVENT, "creating new event %p %s %d", event,
       gst_event_type_get_name (type), type);
@@ -317,7 +320,8 @@ gst_event_new_custom (GstEventType type, GstStructure * structure)
   /* ERRORS */
 had_parent:
   {
-    g_slice_free1 (sizeof (GstEventImpl), event);
+    _priv_gst_mini_object_cache_free (GST_MINI_OBJECT_CACHE_EVENT,
+        sizeof (GstEventImpl), event);
     g_warning ("structure is already owned by another object");
     return NULL;
   }
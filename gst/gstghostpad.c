@@ -40,6 +40,8 @@
  * association later on.
  *
  * Note that GhostPads add overhead to the data processing of a pipeline.
+ * With gst_ghost_pad_set_bypass() buffers can skip the ghostpad and its
+ * internal pad when no probes are installed on them.
  */
 
 #include "gst_private.h"
@@ -866,6 +868,9 @@ gst_ghost_pad_set_target (GstGhostPad * gpad, GstPad * newtarget)
     GST_OBJECT_UNLOCK (gpad);
   }
 
+  /* the answers of the new target can be different */
+  _priv_gst_pad_clear_caps_cache (GST_PAD_CAST (gpad));
+
   if (newtarget) {
     /* FIXME: possible race condition:
      *        using internal out of critical section */
@@ -894,3 +899,61 @@ link_failed:
     return FALSE;
   }
 }
+
+/**
+ * gst_ghost_pad_set_bypass:
+ * @gpad: the #GstGhostPad
+ * @bypass: if buffers can bypass @gpad
+ *
+ * Enable or disable the bypass mode of @gpad. In bypass mode, buffers and
+ * buffer lists that flow through @gpad are passed directly from the peer
+ * of the ghostpad to the target, or the other way around, without going
+ * through the chain functions of the ghostpad and its internal pad.
+ *
+ * The bypass is only taken when no probes are installed on @gpad and its
+ * internal pad, when no sticky events are pending on them and when the
+ * default chain functions are in use. In all other cases the data takes
+ * the normal path. Events and queries are never bypassed.
+ *
+ * Tracers will not see the push on the bypassed pads.
+ *
+ * Since: 1.10
+ */
+void
+gst_ghost_pad_set_bypass (GstGhostPad * gpad, gboolean bypass)
+{
+  GstPad *internal;
+
+  g_return_if_fail (GST_IS_GHOST_PAD (gpad));
+
+  GST_OBJECT_LOCK (gpad);
+  internal = GST_PROXY_PAD_INTERNAL (gpad);
+  if (bypass) {
+    GST_OBJECT_FLAG_SET (gpad, GST_PAD_FLAG_BYPASS);
+    GST_OBJECT_FLAG_SET (internal, GST_PAD_FLAG_BYPASS);
+  } else {
+    GST_OBJECT_FLAG_UNSET (gpad, GST_PAD_FLAG_BYPASS);
+    GST_OBJECT_FLAG_UNSET (internal, GST_PAD_FLAG_BYPASS);
+  }
+  GST_OBJECT_UNLOCK (gpad);
+
+  priv_gst_pad_invalidate_bypass ();
+}
+
+/**
+ * gst_ghost_pad_get_bypass:
+ * @gpad: the #GstGhostPad
+ *
+ * Check if bypass mode is enabled on @gpad, see gst_ghost_pad_set_bypass().
+ *
+ * Returns: %TRUE if buffers can bypass @gpad.
+ *
+ * Since: 1.10
+ */
+gboolean
+gst_ghost_pad_get_bypass (GstGhostPad * gpad)
+{
+  g_return_val_if_fail (GST_IS_GHOST_PAD (gpad), FALSE);
+
+  return GST_PAD_IS_BYPASS (gpad);
+}
@@ -115,6 +115,9 @@ GstPad*          gst_ghost_pad_new_no_target_from_template (const gchar *name, G
 GstPad*          gst_ghost_pad_get_target        (GstGhostPad *gpad);
 gboolean         gst_ghost_pad_set_target        (GstGhostPad *gpad, GstPad *newtarget);
 
+void             gst_ghost_pad_set_bypass        (GstGhostPad *gpad, gboolean bypass);
+gboolean         gst_ghost_pad_get_bypass        (GstGhostPad *gpad);
+
 gboolean         gst_ghost_pad_construct         (GstGhostPad *gpad);
 
 gboolean         gst_ghost_pad_activate_mode_default  (GstPad * pad, GstObject * parent,
@@ -104,6 +104,8 @@
 #  include <process.h>          /* getpid on win32 */
 #endif
 #include <string.h>             /* G_VA_COPY */
+#include <stdlib.h>             /* atoi */
+#include <signal.h>             /* SIGUSR2 */
 #ifdef G_OS_WIN32
 #  define WIN32_LEAN_AND_MEAN   /* prevents from including too many things */
 #  include <windows.h>          /* GetStdHandle, windows console */
@@ -115,6 +117,7 @@
 #include "gstsegment.h"
 #include "gstvalue.h"
 #include "gstcapsfeatures.h"
+#include "gstatomicqueue.h"
 
 #ifdef HAVE_VALGRIND_VALGRIND_H
 #  include <valgrind/valgrind.h>
@@ -223,24 +226,100 @@ struct _GstDebugMessage
   gchar *message;
   const gchar *format;
   va_list arguments;
+  /* set if message points to the scratch buffer of the thread */
+  gpointer scratch;
 };
 
+/* messages are formatted into a per-thread buffer that is reused for the
+ * next message, it only grows up to MAX_SCRATCH_SIZE */
+typedef struct
+{
+  gchar *buf;
+  gsize size;
+  /* a log function or pointer extension is logging from within
+   * gst_debug_message_get(), those messages get their own allocation */
+  gboolean in_use;
+} GstDebugScratch;
+
+#define MAX_SCRATCH_SIZE (64 * 1024)
+
+static void
+gst_debug_scratch_free (gpointer data)
+{
+  GstDebugScratch *scratch = data;
+
+  g_free (scratch->buf);
+  g_slice_free (GstDebugScratch, scratch);
+}
+
+static GPrivate debug_scratch = G_PRIVATE_INIT (gst_debug_scratch_free);
+
+/* how a LevelNameEntry pattern is matched, most patterns are a plain
+ * category name or a name with a '*' at the start or end, which are checked
+ * without going through GPatternSpec */
+typedef enum
+{
+  LEVEL_NAME_MATCH_EXACT,
+  LEVEL_NAME_MATCH_PREFIX,
+  LEVEL_NAME_MATCH_SUFFIX,
+  LEVEL_NAME_MATCH_ALL,
+  LEVEL_NAME_MATCH_PATTERN
+} LevelNameMatch;
+
 /* list of all name/level pairs from --gst-debug and GST_DEBUG */
 static GMutex __level_name_mutex;
 static GSList *__level_name = NULL;
+/* the @N/s or @N/K part of a GST_DEBUG entry */
+typedef struct
+{
+  /* messages per second and call site, 0 for no limit */
+  guint rate;
+  /* log N of every K messages of a call site, K is 0 for no sampling */
+  guint sample_n, sample_k;
+} DebugLimit;
+
 typedef struct
 {
   GPatternSpec *pat;
   GstDebugLevel level;
+  DebugLimit limit;
+  LevelNameMatch match;
+  /* the literal part of the pattern for the non-PATTERN matches */
+  gchar *str;
+  gsize len;
 }
 LevelNameEntry;
 
+/* bumped whenever the default level or the name/level pairs change, so that
+ * a category that was registered at the same time can notice that it missed
+ * the update */
+static volatile gint __level_name_epoch = 0;
+
+/* the categories we hand out */
+typedef struct
+{
+  GstDebugCategory cat;
+
+  /* from the GST_DEBUG entry that set the threshold */
+  DebugLimit limit;
+} GstDebugCategoryImpl;
+
+#define GST_DEBUG_CATEGORY_LIMIT(cat) (((GstDebugCategoryImpl *) (cat))->limit)
+
 /* list of all categories */
 static GMutex __cat_mutex;
 static GSList *__categories = NULL;
+static GHashTable *__categories_by_name = NULL;
 
 static GstDebugCategory *_gst_debug_get_category_locked (const gchar * name);
 
+/* loggers set up from the environment in _priv_gst_debug_init() */
+static FILE *ring_buffer_dump_file;
+static FILE *async_log_file;
+#ifdef SIGUSR2
+static void ring_buffer_signal_handler (int signum);
+#endif
+
 
 /* all registered debug handlers */
 typedef struct
@@ -321,7 +400,38 @@ _priv_gst_debug_init (void)
   _GST_CAT_DEBUG = _gst_debug_category_new ("GST_DEBUG",
       GST_DEBUG_BOLD | GST_DEBUG_FG_YELLOW, "debugging subsystem");
 
-  gst_debug_add_log_function (gst_debug_log_default, log_file, NULL);
+  env = g_getenv ("GST_DEBUG_RING_BUFFER");
+  if (env != NULL && *env != '\0') {
+    /* flight recorder, only write out the recent messages when needed */
+    ring_buffer_dump_file = log_file;
+    gst_debug_add_ring_buffer_logger (MAX (atoi (env), 1024), 60);
+#ifdef SIGUSR2
+    signal (SIGUSR2, ring_buffer_signal_handler);
+#endif
+  } else if ((env = g_getenv ("GST_DEBUG_ASYNC")) && *env != '\0') {
+    GstDebugAsyncDropPolicy policy = GST_DEBUG_ASYNC_DROP_NEWEST;
+    gboolean json = FALSE;
+    gchar **options;
+    guint i;
+
+    /* <max records>[,json][,drop-newest|drop-oldest|wait] */
+    options = g_strsplit (env, ",", -1);
+    for (i = 1; options[i]; i++) {
+      if (strcmp (options[i], "json") == 0)
+        json = TRUE;
+      else if (strcmp (options[i], "drop-oldest") == 0)
+        policy = GST_DEBUG_ASYNC_DROP_OLDEST;
+      else if (strcmp (options[i], "wait") == 0)
+        policy = GST_DEBUG_ASYNC_WAIT;
+      else if (strcmp (options[i], "drop-newest") == 0)
+        policy = GST_DEBUG_ASYNC_DROP_NEWEST;
+    }
+    async_log_file = log_file;
+    gst_debug_add_async_logger (MAX (atoi (options[0]), 64), policy, json);
+    g_strfreev (options);
+  } else {
+    gst_debug_add_log_function (gst_debug_log_default, log_file, NULL);
+  }
 
   /* FIXME: add descriptions here */
   GST_CAT_GST_INIT = _gst_debug_category_new ("GST_INIT",
@@ -495,6 +605,7 @@ gst_debug_log_valist (GstDebugCategory * category, GstDebugLevel level,
 
   message.message = NULL;
   message.format = format;
+  message.scratch = NULL;
   G_VA_COPY (message.arguments, args);
 
   handler = __log_functions;
@@ -504,10 +615,102 @@ gst_debug_log_valist (GstDebugCategory * category, GstDebugLevel level,
     entry->func (category, level, file, function, line, object, &message,
         entry->user_data);
   }
-  g_free (message.message);
+  if (message.scratch)
+    ((GstDebugScratch *) message.scratch)->in_use = FALSE;
+  else
+    g_free (message.message);
   va_end (message.arguments);
 }
 
+/* returns %TRUE if the message at @site should be output, with the number of
+ * messages suppressed since it last was in *@suppressed */
+static gboolean
+gst_debug_call_site_check (GstDebugCallSite * site,
+    GstDebugCategory * category, guint * suppressed)
+{
+  const DebugLimit *limit = &GST_DEBUG_CATEGORY_LIMIT (category);
+
+  *suppressed = 0;
+
+  if (G_LIKELY (limit->rate == 0 && limit->sample_k == 0))
+    return TRUE;
+
+  if (limit->sample_k) {
+    guint n = (guint) g_atomic_int_add (&site->count, 1);
+
+    return (n % limit->sample_k) < limit->sample_n;
+  } else {
+    gint window, old;
+
+    /* fixed one second windows, the first message of a new window reports
+     * what was suppressed in the previous ones */
+    window = (gint) (g_get_monotonic_time () / G_USEC_PER_SEC);
+    old = g_atomic_int_get (&site->window);
+    if (window != old
+        && g_atomic_int_compare_and_exchange (&site->window, old, window)) {
+      gint s;
+
+      g_atomic_int_set (&site->count, 0);
+      do {
+        s = g_atomic_int_get (&site->suppressed);
+      } while (!g_atomic_int_compare_and_exchange (&site->suppressed, s, 0));
+      *suppressed = s;
+    }
+
+    if ((guint) g_atomic_int_add (&site->count, 1) >= limit->rate) {
+      g_atomic_int_inc (&site->suppressed);
+      return FALSE;
+    }
+    return TRUE;
+  }
+}
+
+/**
+ * gst_debug_log_site:
+ * @site: the state of the logging statement
+ * @category: category to log
+ * @level: level of the message is in
+ * @file: the file that emitted the message, usually the __FILE__ identifier
+ * @function: the function that emitted the message
+ * @line: the line from that the message was emitted, usually __LINE__
+ * @object: (transfer none) (allow-none): the object this message relates to,
+ *     or %NULL if none
+ * @format: a printf style format string
+ * @...: optional arguments for the format
+ *
+ * Like gst_debug_log(), but applies the rate limit or sampling configured
+ * for @category to the logging statement described by @site. Used by the
+ * GST_CAT_LEVEL_LOG() macros, messages which are dropped are not formatted.
+ *
+ * Since: 1.10
+ */
+void
+gst_debug_log_site (GstDebugCallSite * site, GstDebugCategory * category,
+    GstDebugLevel level, const gchar * file, const gchar * function,
+    gint line, GObject * object, const gchar * format, ...)
+{
+  va_list var_args;
+  guint suppressed;
+
+  g_return_if_fail (site != NULL);
+  g_return_if_fail (category != NULL);
+
+  if (level > gst_debug_category_get_threshold (category))
+    return;
+
+  if (!gst_debug_call_site_check (site, category, &suppressed))
+    return;
+
+  if (G_UNLIKELY (suppressed > 0))
+    gst_debug_log (category, level, file, function, line, object,
+        "(suppressed %u messages)", suppressed);
+
+  va_start (var_args, format);
+  gst_debug_log_valist (category, level, file, function, line, object, format,
+      var_args);
+  va_end (var_args);
+}
+
 /**
  * gst_debug_message_get:
  * @message: a debug message
@@ -515,21 +718,60 @@ gst_debug_log_valist (GstDebugCategory * category, GstDebugLevel level,
  * Gets the string representation of a #GstDebugMessage. This function is used
  * in debug handlers to extract the message.
  *
+ * The message is only formatted when this function is first called for it,
+ * log functions that filter messages should do so before calling it.
+ *
  * Returns: the string representation of a #GstDebugMessage.
  */
 const gchar *
 gst_debug_message_get (GstDebugMessage * message)
 {
-  if (message->message == NULL) {
-    int len;
+  GstDebugScratch *scratch;
+  size_t len;
+  gchar *str;
+
+  if (message->message != NULL)
+    return message->message;
 
-    len = __gst_vasprintf (&message->message, message->format,
-        message->arguments);
+  scratch = g_private_get (&debug_scratch);
+  if (G_UNLIKELY (scratch == NULL)) {
+    scratch = g_slice_new0 (GstDebugScratch);
+    g_private_set (&debug_scratch, scratch);
+  }
 
-    if (len < 0)
+  if (G_UNLIKELY (scratch->in_use)) {
+    if (__gst_vasprintf (&message->message, message->format,
+            message->arguments) < 0)
       message->message = NULL;
+    return message->message;
+  }
+
+  /* formatting can log, make sure that doesn't end up in the buffer we are
+   * writing to */
+  scratch->in_use = TRUE;
+  len = scratch->size;
+  str = __gst_vasnprintf (scratch->buf, &len, message->format,
+      message->arguments);
+  if (str == NULL) {
+    scratch->in_use = FALSE;
+    return NULL;
+  }
+
+  if (str != scratch->buf) {
+    /* did not fit, keep the bigger buffer for the next messages */
+    if (len >= MAX_SCRATCH_SIZE) {
+      scratch->in_use = FALSE;
+      message->message = str;
+      return str;
+    }
+    g_free (scratch->buf);
+    scratch->buf = str;
+    scratch->size = len + 1;
   }
-  return message->message;
+  message->message = str;
+  message->scratch = scratch;
+
+  return str;
 }
 
 #define MAX_BUFFER_DUMP_STRING_LEN  100
@@ -570,7 +812,7 @@ static inline gchar *
 gst_info_structure_to_string (const GstStructure * s)
 {
   if (G_LIKELY (s)) {
-    gchar *str = gst_structure_to_string (s);
+    gchar *str = priv_gst_structure_to_string_cached (s);
     if (G_UNLIKELY (pretty_tags && s->name == GST_QUARK (TAGLIST)))
       return prettify_structure_string (str);
     else
@@ -697,7 +939,7 @@ gst_debug_print_object (gpointer ptr)
     return g_strdup ("(NULL)");
   }
   if (GST_IS_CAPS (ptr)) {
-    return gst_caps_to_string ((const GstCaps *) ptr);
+    return priv_gst_caps_to_string_cached ((const GstCaps *) ptr);
   }
   if (GST_IS_STRUCTURE (ptr)) {
     return gst_info_structure_to_string ((const GstStructure *) ptr);
@@ -1118,6 +1360,650 @@ gst_debug_log_default (GstDebugCategory * category, GstDebugLevel level,
     g_free (obj);
 }
 
+/* ring buffer logger, keeps the last messages of each thread in memory */
+
+typedef struct
+{
+  gint refcount;
+  GMutex lock;
+  /* the logger instance this log was made for */
+  guint cookie;
+  GQueue lines;                 /* gchar * */
+  gsize size;
+  /* when the thread exited, in monotonic s */
+  gint64 gone_since;
+} GstRingBufferLog;
+
+static GMutex ring_buffer_lock;
+static GList *ring_buffer_logs = NULL;  /* GstRingBufferLog * */
+static guint ring_buffer_cookie = 0;
+static guint ring_buffer_max_size = 0;
+static guint ring_buffer_thread_timeout = 0;
+static gboolean ring_buffer_active = FALSE;
+/* set from GST_DEBUG_RING_BUFFER, dump to this file on errors and SIGUSR2 */
+static FILE *ring_buffer_dump_file = NULL;
+static volatile gint ring_buffer_dump_pending = 0;
+
+static void
+ring_buffer_log_unref (GstRingBufferLog * log)
+{
+  if (g_atomic_int_dec_and_test (&log->refcount)) {
+    g_queue_foreach (&log->lines, (GFunc) g_free, NULL);
+    g_queue_clear (&log->lines);
+    g_mutex_clear (&log->lock);
+    g_slice_free (GstRingBufferLog, log);
+  }
+}
+
+static void
+ring_buffer_log_thread_exit (GstRingBufferLog * log)
+{
+  g_mutex_lock (&log->lock);
+  log->gone_since = g_get_monotonic_time ();
+  g_mutex_unlock (&log->lock);
+  ring_buffer_log_unref (log);
+}
+
+static GPrivate ring_buffer_key =
+G_PRIVATE_INIT ((GDestroyNotify) ring_buffer_log_thread_exit);
+
+/* drop the logs of threads that exited more than thread-timeout seconds
+ * ago, call with the ring_buffer_lock */
+static void
+ring_buffer_prune (void)
+{
+  GList *l, *next;
+  gint64 now;
+
+  if (ring_buffer_thread_timeout == 0)
+    return;
+
+  now = g_get_monotonic_time ();
+  for (l = ring_buffer_logs; l; l = next) {
+    GstRingBufferLog *log = l->data;
+    gint64 gone_since;
+
+    next = l->next;
+
+    g_mutex_lock (&log->lock);
+    gone_since = log->gone_since;
+    g_mutex_unlock (&log->lock);
+
+    if (gone_since != 0 &&
+        now - gone_since > (gint64) ring_buffer_thread_timeout * G_USEC_PER_SEC) {
+      ring_buffer_logs = g_list_delete_link (ring_buffer_logs, l);
+      ring_buffer_log_unref (log);
+    }
+  }
+}
+
+static GstRingBufferLog *
+ring_buffer_get_log (void)
+{
+  GstRingBufferLog *log = g_private_get (&ring_buffer_key);
+
+  if (G_LIKELY (log
+          && log->cookie == (guint) g_atomic_int_get (&ring_buffer_cookie)))
+    return log;
+
+  log = g_slice_new0 (GstRingBufferLog);
+  /* one for the thread, one for the list */
+  log->refcount = 2;
+  g_mutex_init (&log->lock);
+  g_queue_init (&log->lines);
+
+  g_mutex_lock (&ring_buffer_lock);
+  log->cookie = ring_buffer_cookie;
+  ring_buffer_prune ();
+  ring_buffer_logs = g_list_prepend (ring_buffer_logs, log);
+  g_mutex_unlock (&ring_buffer_lock);
+
+  /* releases the log of a previous logger instance */
+  g_private_replace (&ring_buffer_key, log);
+
+  return log;
+}
+
+static gchar **
+ring_buffer_get_logs (gboolean clear)
+{
+  GPtrArray *logs;
+  GList *l;
+
+  logs = g_ptr_array_new ();
+
+  g_mutex_lock (&ring_buffer_lock);
+  ring_buffer_prune ();
+  for (l = ring_buffer_logs; l; l = l->next) {
+    GstRingBufferLog *log = l->data;
+    GString *str;
+    GList *line;
+
+    g_mutex_lock (&log->lock);
+    str = g_string_sized_new (log->size + 1);
+    for (line = log->lines.head; line; line = line->next)
+      g_string_append (str, line->data);
+    if (clear) {
+      g_queue_foreach (&log->lines, (GFunc) g_free, NULL);
+      g_queue_clear (&log->lines);
+      log->size = 0;
+    }
+    g_mutex_unlock (&log->lock);
+
+    g_ptr_array_add (logs, g_string_free (str, FALSE));
+  }
+  g_mutex_unlock (&ring_buffer_lock);
+
+  g_ptr_array_add (logs, NULL);
+  return (gchar **) g_ptr_array_free (logs, FALSE);
+}
+
+static void
+ring_buffer_dump (FILE * log_file)
+{
+  gchar **logs, **log;
+
+  logs = ring_buffer_get_logs (TRUE);
+  for (log = logs; *log; log++)
+    fputs (*log, log_file);
+  fflush (log_file);
+  g_strfreev (logs);
+}
+
+#ifdef SIGUSR2
+static void
+ring_buffer_signal_handler (int signum)
+{
+  /* dumped by the next thread that logs something */
+  g_atomic_int_set (&ring_buffer_dump_pending, 1);
+}
+#endif
+
+static void
+gst_debug_log_ring_buffer (GstDebugCategory * category, GstDebugLevel level,
+    const gchar * file, const gchar * function, gint line, GObject * object,
+    GstDebugMessage * message, gpointer user_data)
+{
+  GstRingBufferLog *log;
+  GstClockTime elapsed;
+  gchar *obj, *str;
+  gsize len;
+  gchar c;
+
+  c = file[0];
+  if (c == '.' || c == '/' || c == '\\' || (c != '\0' && file[1] == ':')) {
+    file = gst_path_basename (file);
+  }
+
+  obj = object ? gst_debug_print_object (object) : (gchar *) "";
+  elapsed = GST_CLOCK_DIFF (_priv_gst_start_time, gst_util_get_timestamp ());
+
+  /* same format as gst_debug_log_default() without colors */
+#define PRINT_FMT " "PID_FMT" "PTR_FMT" %s "CAT_FMT" %s\n"
+  str = g_strdup_printf ("%" GST_TIME_FORMAT PRINT_FMT,
+      GST_TIME_ARGS (elapsed), getpid (), g_thread_self (),
+      gst_debug_level_get_name (level), gst_debug_category_get_name (category),
+      file, line, function, obj, gst_debug_message_get (message));
+#undef PRINT_FMT
+
+  if (object != NULL)
+    g_free (obj);
+
+  len = strlen (str);
+  log = ring_buffer_get_log ();
+
+  /* only contended while the logs are read */
+  g_mutex_lock (&log->lock);
+  g_queue_push_tail (&log->lines, str);
+  log->size += len;
+  while (log->size > ring_buffer_max_size && log->lines.length > 1) {
+    gchar *old = g_queue_pop_head (&log->lines);
+
+    log->size -= strlen (old);
+    g_free (old);
+  }
+  g_mutex_unlock (&log->lock);
+
+  if (G_UNLIKELY (ring_buffer_dump_file != NULL) &&
+      (level == GST_LEVEL_ERROR ||
+          g_atomic_int_compare_and_exchange (&ring_buffer_dump_pending, 1, 0)))
+    ring_buffer_dump (ring_buffer_dump_file);
+}
+
+/**
+ * gst_debug_add_ring_buffer_logger:
+ * @max_size_per_thread: maximum size of the debug log in bytes kept for each
+ *     thread
+ * @thread_timeout: seconds to keep the log of a thread after it exited, 0
+ *     to keep it forever
+ *
+ * Adds a memory ringbuffer based debug logger that stores the most recent
+ * messages of each thread, up to @max_size_per_thread bytes. Messages are
+ * formatted like the default logger does, but only written to memory, so
+ * a high debug level can be used in production and the logs retrieved with
+ * gst_debug_ring_buffer_logger_get_logs() when something went wrong.
+ *
+ * If a ring buffer logger is already installed, only its settings are
+ * changed.
+ *
+ * Since: 1.10
+ */
+void
+gst_debug_add_ring_buffer_logger (guint max_size_per_thread,
+    guint thread_timeout)
+{
+  gboolean active;
+
+  g_mutex_lock (&ring_buffer_lock);
+  active = ring_buffer_active;
+  ring_buffer_max_size = max_size_per_thread;
+  ring_buffer_thread_timeout = thread_timeout;
+  ring_buffer_active = TRUE;
+  g_mutex_unlock (&ring_buffer_lock);
+
+  if (!active)
+    gst_debug_add_log_function (gst_debug_log_ring_buffer, NULL, NULL);
+}
+
+/**
+ * gst_debug_remove_ring_buffer_logger:
+ *
+ * Removes the ring buffer logger added with
+ * gst_debug_add_ring_buffer_logger() and frees all stored messages.
+ *
+ * Since: 1.10
+ */
+void
+gst_debug_remove_ring_buffer_logger (void)
+{
+  GList *logs;
+
+  gst_debug_remove_log_function (gst_debug_log_ring_buffer);
+
+  g_mutex_lock (&ring_buffer_lock);
+  ring_buffer_active = FALSE;
+  /* threads will not reuse their old log with a new logger */
+  g_atomic_int_inc (&ring_buffer_cookie);
+  logs = ring_buffer_logs;
+  ring_buffer_logs = NULL;
+  g_mutex_unlock (&ring_buffer_lock);
+
+  g_list_free_full (logs, (GDestroyNotify) ring_buffer_log_unref);
+}
+
+/**
+ * gst_debug_ring_buffer_logger_get_logs:
+ *
+ * Fetches the current logs of the ring buffer logger, one string per
+ * thread with the messages of that thread in the order they were logged.
+ *
+ * Returns: (transfer full) (array zero-terminated=1): a %NULL-terminated
+ *     array of strings with the debug output per thread, free with
+ *     g_strfreev()
+ *
+ * Since: 1.10
+ */
+gchar **
+gst_debug_ring_buffer_logger_get_logs (void)
+{
+  return ring_buffer_get_logs (FALSE);
+}
+
+/* async logger, hands the messages to a writer thread through a bounded
+ * lock-free queue */
+
+typedef struct
+{
+  GstClockTime elapsed;
+  GThread *thread;
+  GstDebugLevel level;
+  gint line;
+  const gchar *category;
+  const gchar *file;
+  const gchar *function;
+  const gchar *object;
+  const gchar *message;
+  /* the strings are stored after the record */
+} GstAsyncLogRecord;
+
+static GMutex async_log_lock;
+static GCond async_log_cond;
+static GstAtomicQueue *async_log_queue = NULL;
+static GThread *async_log_thread = NULL;
+static GstDebugAsyncDropPolicy async_log_policy;
+static gboolean async_log_json = FALSE;
+static gboolean async_log_running = FALSE;
+/* set by the writer before waiting, producers only signal when it is set */
+static volatile gint async_log_sleeping = 0;
+static volatile gint async_log_dropped = 0;
+static FILE *async_log_file = NULL;
+
+#define ASYNC_LOG_BATCH_SIZE 256
+
+static GstAsyncLogRecord *
+async_log_record_new (GstDebugCategory * category, GstDebugLevel level,
+    const gchar * file, const gchar * function, gint line,
+    const gchar * object, const gchar * message)
+{
+  GstAsyncLogRecord *record;
+  const gchar *strings[5];
+  gsize lens[5], size;
+  gchar *data;
+  guint i;
+
+  strings[0] = gst_debug_category_get_name (category);
+  strings[1] = file;
+  strings[2] = function;
+  strings[3] = object;
+  strings[4] = message;
+
+  size = sizeof (GstAsyncLogRecord);
+  for (i = 0; i < G_N_ELEMENTS (strings); i++) {
+    lens[i] = strlen (strings[i]) + 1;
+    size += lens[i];
+  }
+
+  /* everything in one allocation, the record is freed with g_free() */
+  record = g_malloc (size);
+  record->elapsed =
+      GST_CLOCK_DIFF (_priv_gst_start_time, gst_util_get_timestamp ());
+  record->thread = g_thread_self ();
+  record->level = level;
+  record->line = line;
+
+  data = (gchar *) (record + 1);
+  for (i = 0; i < G_N_ELEMENTS (strings); i++) {
+    memcpy (data, strings[i], lens[i]);
+    strings[i] = data;
+    data += lens[i];
+  }
+  record->category = strings[0];
+  record->file = strings[1];
+  record->function = strings[2];
+  record->object = strings[3];
+  record->message = strings[4];
+
+  return record;
+}
+
+static void
+async_log_append_json_string (GString * str, const gchar * s)
+{
+  g_string_append_c (str, '"');
+  for (; *s; s++) {
+    switch (*s) {
+      case '"':
+        g_string_append (str, "\\\"");
+        break;
+      case '\\':
+        g_string_append (str, "\\\\");
+        break;
+      case '\n':
+        g_string_append (str, "\\n");
+        break;
+      case '\r':
+        g_string_append (str, "\\r");
+        break;
+      case '\t':
+        g_string_append (str, "\\t");
+        break;
+      default:
+        if ((guchar) * s < 0x20)
+          g_string_append_printf (str, "\\u%04x", (guchar) * s);
+        else
+          g_string_append_c (str, *s);
+        break;
+    }
+  }
+  g_string_append_c (str, '"');
+}
+
+static void
+async_log_format_record (GString * str, GstAsyncLogRecord * record, gint pid)
+{
+  if (async_log_json) {
+    const gchar *level = gst_debug_level_get_name (record->level);
+
+    g_string_append_printf (str, "{\"time\":%" G_GUINT64_FORMAT
+        ",\"pid\":%d,\"thread\":\"%p\",\"level\":\"%.*s\",\"category\":",
+        (guint64) record->elapsed, pid, record->thread,
+        (gint) strcspn (level, " "), level);
+    async_log_append_json_string (str, record->category);
+    g_string_append (str, ",\"file\":");
+    async_log_append_json_string (str, record->file);
+    g_string_append_printf (str, ",\"line\":%d,\"function\":", record->line);
+    async_log_append_json_string (str, record->function);
+    if (*record->object) {
+      g_string_append (str, ",\"object\":");
+      async_log_append_json_string (str, record->object);
+    }
+    g_string_append (str, ",\"message\":");
+    async_log_append_json_string (str, record->message);
+    g_string_append (str, "}\n");
+  } else {
+    /* same format as gst_debug_log_default() without colors */
+#define PRINT_FMT " "PID_FMT" "PTR_FMT" %s "CAT_FMT" %s\n"
+    g_string_append_printf (str, "%" GST_TIME_FORMAT PRINT_FMT,
+        GST_TIME_ARGS (record->elapsed), pid, record->thread,
+        gst_debug_level_get_name (record->level), record->category,
+        record->file, record->line, record->function, record->object,
+        record->message);
+#undef PRINT_FMT
+  }
+}
+
+static gpointer
+async_log_writer (gpointer data)
+{
+  GString *str;
+  guint reported = 0;
+  gint pid = getpid ();
+
+  str = g_string_sized_new (ASYNC_LOG_BATCH_SIZE * 128);
+
+  for (;;) {
+    GstAsyncLogRecord *record;
+    guint n, dropped;
+    gboolean running;
+
+    /* batch up the queued records into a single write */
+    for (n = 0; n < ASYNC_LOG_BATCH_SIZE; n++) {
+      if (!(record = gst_atomic_queue_pop (async_log_queue)))
+        break;
+      async_log_format_record (str, record, pid);
+      g_free (record);
+    }
+
+    dropped = g_atomic_int_get (&async_log_dropped);
+    if (G_UNLIKELY (dropped != reported)) {
+      if (async_log_json)
+        g_string_append_printf (str, "{\"dropped\":%u}\n", dropped - reported);
+      else
+        g_string_append_printf (str, "dropped %u log records\n",
+            dropped - reported);
+      reported = dropped;
+    }
+
+    if (str->len > 0) {
+      fwrite (str->str, 1, str->len, async_log_file);
+      fflush (async_log_file);
+      g_string_truncate (str, 0);
+    }
+
+    if (n == ASYNC_LOG_BATCH_SIZE)
+      continue;
+
+    g_mutex_lock (&async_log_lock);
+    running = async_log_running;
+    /* announce that we sleep before checking the queue, so that a record
+     * pushed after the check always signals us */
+    g_atomic_int_set (&async_log_sleeping, 1);
+    if (running && gst_atomic_queue_length (async_log_queue) == 0) {
+      /* the timeout is only a safety net */
+      g_cond_wait_until (&async_log_cond, &async_log_lock,
+          g_get_monotonic_time () + 100 * G_TIME_SPAN_MILLISECOND);
+    }
+    g_atomic_int_set (&async_log_sleeping, 0);
+    g_mutex_unlock (&async_log_lock);
+
+    /* everything was written out */
+    if (!running && gst_atomic_queue_length (async_log_queue) == 0)
+      break;
+  }
+
+  g_string_free (str, TRUE);
+
+  return NULL;
+}
+
+static void
+async_log_wakeup (void)
+{
+  if (g_atomic_int_compare_and_exchange (&async_log_sleeping, 1, 0)) {
+    g_mutex_lock (&async_log_lock);
+    g_cond_signal (&async_log_cond);
+    g_mutex_unlock (&async_log_lock);
+  }
+}
+
+static void
+gst_debug_log_async (GstDebugCategory * category, GstDebugLevel level,
+    const gchar * file, const gchar * function, gint line, GObject * object,
+    GstDebugMessage * message, gpointer user_data)
+{
+  GstAsyncLogRecord *record, *old;
+  gchar *obj;
+  gchar c;
+
+  c = file[0];
+  if (c == '.' || c == '/' || c == '\\' || (c != '\0' && file[1] == ':')) {
+    file = gst_path_basename (file);
+  }
+
+  obj = object ? gst_debug_print_object (object) : (gchar *) "";
+  record = async_log_record_new (category, level, file, function, line, obj,
+      gst_debug_message_get (message));
+  if (object != NULL)
+    g_free (obj);
+
+  switch (async_log_policy) {
+    case GST_DEBUG_ASYNC_DROP_NEWEST:
+      if (!gst_atomic_queue_try_push (async_log_queue, record)) {
+        g_atomic_int_inc (&async_log_dropped);
+        g_free (record);
+      }
+      break;
+    case GST_DEBUG_ASYNC_DROP_OLDEST:
+      while (!gst_atomic_queue_try_push (async_log_queue, record)) {
+        if ((old = gst_atomic_queue_pop (async_log_queue))) {
+          g_atomic_int_inc (&async_log_dropped);
+          g_free (old);
+        }
+      }
+      break;
+    case GST_DEBUG_ASYNC_WAIT:
+      if (!gst_atomic_queue_try_push (async_log_queue, record)) {
+        async_log_wakeup ();
+        gst_atomic_queue_push (async_log_queue, record);
+      }
+      break;
+  }
+
+  async_log_wakeup ();
+}
+
+/**
+ * gst_debug_add_async_logger:
+ * @max_records: the maximum number of messages waiting to be written
+ * @policy: what to do with messages when @max_records are waiting
+ * @json: write JSON objects instead of the usual text lines
+ *
+ * Adds a debug logger that writes the messages to stderr (or the file set
+ * with GST_DEBUG_FILE) from a separate thread. The logging threads only
+ * format the message and add it to a lock-free queue, the writer thread
+ * then writes out the queued messages in batches.
+ *
+ * When @max_records messages are already waiting, @policy decides whether
+ * the new message or the oldest one is dropped, or if the logging thread
+ * waits for the writer. The number of dropped messages is available with
+ * gst_debug_async_logger_get_dropped() and also written to the log.
+ *
+ * With @json, each message is written as a JSON object on its own line
+ * with the members "time" (in nanoseconds since initialization), "pid",
+ * "thread", "level", "category", "file", "line", "function", "object" (only
+ * if the message is about an object) and "message".
+ *
+ * If an async logger is already installed, it is replaced.
+ *
+ * Since: 1.10
+ */
+void
+gst_debug_add_async_logger (guint max_records,
+    GstDebugAsyncDropPolicy policy, gboolean json)
+{
+  g_return_if_fail (max_records > 0);
+
+  gst_debug_remove_async_logger ();
+
+  async_log_queue = gst_atomic_queue_new_bounded (max_records);
+  async_log_policy = policy;
+  async_log_json = json;
+  if (async_log_file == NULL)
+    async_log_file = stderr;
+
+  g_mutex_lock (&async_log_lock);
+  async_log_running = TRUE;
+  g_mutex_unlock (&async_log_lock);
+
+  async_log_thread = g_thread_new ("gst-log-writer", async_log_writer, NULL);
+
+  gst_debug_add_log_function (gst_debug_log_async, NULL, NULL);
+}
+
+/**
+ * gst_debug_remove_async_logger:
+ *
+ * Removes the logger added with gst_debug_add_async_logger() after writing
+ * out all the messages that are still waiting.
+ *
+ * Since: 1.10
+ */
+void
+gst_debug_remove_async_logger (void)
+{
+  if (async_log_thread == NULL)
+    return;
+
+  gst_debug_remove_log_function (gst_debug_log_async);
+
+  g_mutex_lock (&async_log_lock);
+  async_log_running = FALSE;
+  g_cond_signal (&async_log_cond);
+  g_mutex_unlock (&async_log_lock);
+
+  g_thread_join (async_log_thread);
+  async_log_thread = NULL;
+
+  gst_atomic_queue_unref (async_log_queue);
+  async_log_queue = NULL;
+}
+
+/**
+ * gst_debug_async_logger_get_dropped:
+ *
+ * Get the number of messages the async logger had to drop because too many
+ * messages were waiting to be written.
+ *
+ * Returns: the number of dropped messages since initialization
+ *
+ * Since: 1.10
+ */
+guint
+gst_debug_async_logger_get_dropped (void)
+{
+  return g_atomic_int_get (&async_log_dropped);
+}
+
 /**
  * gst_debug_level_get_name:
  * @level: the level to get the name for
@@ -1444,29 +2330,114 @@ gst_debug_get_default_threshold (void)
   return (GstDebugLevel) g_atomic_int_get (&__default_level);
 }
 
+static LevelNameEntry *
+level_name_entry_new (const gchar * name, GstDebugLevel level,
+    const DebugLimit * limit)
+{
+  static const DebugLimit no_limit = { 0, };
+  LevelNameEntry *entry;
+  gsize len = strlen (name);
+  const gchar *wildcard;
+
+  entry = g_slice_new (LevelNameEntry);
+  entry->pat = g_pattern_spec_new (name);
+  entry->level = level;
+  entry->limit = limit ? *limit : no_limit;
+
+  wildcard = strpbrk (name, "*?");
+  if (wildcard == NULL) {
+    entry->match = LEVEL_NAME_MATCH_EXACT;
+    entry->str = g_strdup (name);
+  } else if (len == 1 && name[0] == '*') {
+    entry->match = LEVEL_NAME_MATCH_ALL;
+    entry->str = NULL;
+  } else if (wildcard == name + len - 1 && *wildcard == '*') {
+    entry->match = LEVEL_NAME_MATCH_PREFIX;
+    entry->str = g_strndup (name, len - 1);
+  } else if (wildcard == name && *wildcard == '*'
+      && strpbrk (name + 1, "*?") == NULL) {
+    entry->match = LEVEL_NAME_MATCH_SUFFIX;
+    entry->str = g_strdup (name + 1);
+  } else {
+    entry->match = LEVEL_NAME_MATCH_PATTERN;
+    entry->str = NULL;
+  }
+  entry->len = entry->str ? strlen (entry->str) : 0;
+
+  return entry;
+}
+
 static void
-gst_debug_reset_threshold (gpointer category, gpointer unused)
+level_name_entry_free (LevelNameEntry * entry)
 {
-  GstDebugCategory *cat = (GstDebugCategory *) category;
-  GSList *walk;
+  g_pattern_spec_free (entry->pat);
+  g_free (entry->str);
+  g_slice_free (LevelNameEntry, entry);
+}
 
-  g_mutex_lock (&__level_name_mutex);
-  walk = __level_name;
-  while (walk) {
-    LevelNameEntry *entry = walk->data;
+static gboolean
+level_name_entry_match (const LevelNameEntry * entry, const gchar * name,
+    gsize len)
+{
+  switch (entry->match) {
+    case LEVEL_NAME_MATCH_EXACT:
+      return len == entry->len && memcmp (name, entry->str, len) == 0;
+    case LEVEL_NAME_MATCH_PREFIX:
+      return len >= entry->len && memcmp (name, entry->str, entry->len) == 0;
+    case LEVEL_NAME_MATCH_SUFFIX:
+      return len >= entry->len
+          && memcmp (name + len - entry->len, entry->str, entry->len) == 0;
+    case LEVEL_NAME_MATCH_ALL:
+      return TRUE;
+    case LEVEL_NAME_MATCH_PATTERN:
+    default:
+      return g_pattern_match (entry->pat, len, name, NULL);
+  }
+}
 
-    walk = g_slist_next (walk);
-    if (g_pattern_match_string (entry->pat, cat->name)) {
-      if (gst_is_initialized ())
-        GST_LOG ("category %s matches pattern %p - gets set to level %d",
-            cat->name, entry->pat, entry->level);
-      gst_debug_category_set_threshold (cat, entry->level);
-      goto exit;
-    }
+/* finds the first entry of @list matching @cat, call with the
+ * __level_name_mutex */
+static LevelNameEntry *
+gst_debug_find_level_name_entry (GSList * list, GSList * end,
+    GstDebugCategory * cat)
+{
+  gsize len = strlen (cat->name);
+
+  for (; list != end; list = g_slist_next (list)) {
+    LevelNameEntry *entry = list->data;
+
+    if (level_name_entry_match (entry, cat->name, len))
+      return entry;
   }
-  gst_debug_category_set_threshold (cat, gst_debug_get_default_threshold ());
+  return NULL;
+}
 
-exit:
+/* call with the __level_name_mutex */
+static void
+gst_debug_reset_threshold_unlocked (gpointer category, gpointer unused)
+{
+  GstDebugCategory *cat = (GstDebugCategory *) category;
+  LevelNameEntry *entry;
+
+  entry = gst_debug_find_level_name_entry (__level_name, NULL, cat);
+  if (entry) {
+    if (gst_is_initialized ())
+      GST_LOG ("category %s matches pattern %p - gets set to level %d",
+          cat->name, entry->pat, entry->level);
+    GST_DEBUG_CATEGORY_LIMIT (cat) = entry->limit;
+    gst_debug_category_set_threshold (cat, entry->level);
+  } else {
+    memset (&GST_DEBUG_CATEGORY_LIMIT (cat), 0, sizeof (DebugLimit));
+    gst_debug_category_set_threshold (cat,
+        gst_debug_get_default_threshold ());
+  }
+}
+
+static void
+gst_debug_reset_threshold (gpointer category, gpointer unused)
+{
+  g_mutex_lock (&__level_name_mutex);
+  gst_debug_reset_threshold_unlocked (category, unused);
   g_mutex_unlock (&__level_name_mutex);
 }
 
@@ -1474,22 +2445,56 @@ static void
 gst_debug_reset_all_thresholds (void)
 {
   g_mutex_lock (&__cat_mutex);
-  g_slist_foreach (__categories, gst_debug_reset_threshold, NULL);
+  g_mutex_lock (&__level_name_mutex);
+  g_atomic_int_inc (&__level_name_epoch);
+  g_slist_foreach (__categories, gst_debug_reset_threshold_unlocked, NULL);
+  g_mutex_unlock (&__level_name_mutex);
   g_mutex_unlock (&__cat_mutex);
 }
 
+/* applies the entries from the start of __level_name up to @end, which were
+ * just added, to the categories they match */
 static void
-for_each_threshold_by_entry (gpointer data, gpointer user_data)
+gst_debug_apply_new_level_name_entries (GSList * end)
 {
-  GstDebugCategory *cat = (GstDebugCategory *) data;
-  LevelNameEntry *entry = (LevelNameEntry *) user_data;
+  GSList *walk;
 
-  if (g_pattern_match_string (entry->pat, cat->name)) {
-    if (gst_is_initialized ())
-      GST_LOG ("category %s matches pattern %p - gets set to level %d",
-          cat->name, entry->pat, entry->level);
-    gst_debug_category_set_threshold (cat, entry->level);
+  g_mutex_lock (&__cat_mutex);
+  g_mutex_lock (&__level_name_mutex);
+  for (walk = __categories; walk; walk = g_slist_next (walk)) {
+    GstDebugCategory *cat = walk->data;
+    LevelNameEntry *entry;
+
+    entry = gst_debug_find_level_name_entry (__level_name, end, cat);
+    if (entry) {
+      if (gst_is_initialized ())
+        GST_LOG ("category %s matches pattern %p - gets set to level %d",
+            cat->name, entry->pat, entry->level);
+      GST_DEBUG_CATEGORY_LIMIT (cat) = entry->limit;
+      gst_debug_category_set_threshold (cat, entry->level);
+    }
   }
+  g_mutex_unlock (&__level_name_mutex);
+  g_mutex_unlock (&__cat_mutex);
+}
+
+/* returns the previous head of the list, for
+ * gst_debug_apply_new_level_name_entries() */
+static GSList *
+gst_debug_add_level_name_entry (const gchar * name, GstDebugLevel level,
+    const DebugLimit * limit)
+{
+  LevelNameEntry *entry;
+  GSList *old;
+
+  entry = level_name_entry_new (name, level, limit);
+  g_mutex_lock (&__level_name_mutex);
+  old = __level_name;
+  __level_name = g_slist_prepend (__level_name, entry);
+  g_atomic_int_inc (&__level_name_epoch);
+  g_mutex_unlock (&__level_name_mutex);
+
+  return old;
 }
 
 /**
@@ -1503,21 +2508,12 @@ for_each_threshold_by_entry (gpointer data, gpointer user_data)
 void
 gst_debug_set_threshold_for_name (const gchar * name, GstDebugLevel level)
 {
-  GPatternSpec *pat;
-  LevelNameEntry *entry;
+  GSList *end;
 
   g_return_if_fail (name != NULL);
 
-  pat = g_pattern_spec_new (name);
-  entry = g_slice_new (LevelNameEntry);
-  entry->pat = pat;
-  entry->level = level;
-  g_mutex_lock (&__level_name_mutex);
-  __level_name = g_slist_prepend (__level_name, entry);
-  g_mutex_unlock (&__level_name_mutex);
-  g_mutex_lock (&__cat_mutex);
-  g_slist_foreach (__categories, for_each_threshold_by_entry, entry);
-  g_mutex_unlock (&__cat_mutex);
+  end = gst_debug_add_level_name_entry (name, level, NULL);
+  gst_debug_apply_new_level_name_entries (end);
 }
 
 /**
@@ -1543,8 +2539,7 @@ gst_debug_unset_threshold_for_name (const gchar * name)
 
     if (g_pattern_spec_equal (entry->pat, pat)) {
       __level_name = g_slist_remove_link (__level_name, walk);
-      g_pattern_spec_free (entry->pat);
-      g_slice_free (LevelNameEntry, entry);
+      level_name_entry_free (entry);
       g_slist_free_1 (walk);
       walk = __level_name;
     } else {
@@ -1561,10 +2556,19 @@ _gst_debug_category_new (const gchar * name, guint color,
     const gchar * description)
 {
   GstDebugCategory *cat, *catfound;
+  gint epoch;
 
   g_return_val_if_fail (name != NULL, NULL);
 
-  cat = g_slice_new (GstDebugCategory);
+  /* elements often register their categories for every new instance, don't
+   * bother creating and matching a new one in that case */
+  g_mutex_lock (&__cat_mutex);
+  catfound = _gst_debug_get_category_locked (name);
+  g_mutex_unlock (&__cat_mutex);
+  if (catfound)
+    return catfound;
+
+  cat = (GstDebugCategory *) g_slice_new0 (GstDebugCategoryImpl);
   cat->name = g_strdup (name);
   cat->color = color;
   if (description != NULL) {
@@ -1573,6 +2577,7 @@ _gst_debug_category_new (const gchar * name, guint color,
     cat->description = g_strdup ("no description");
   }
   g_atomic_int_set (&cat->threshold, 0);
+  epoch = g_atomic_int_get (&__level_name_epoch);
   gst_debug_reset_threshold (cat, NULL);
 
   /* add to category list */
@@ -1581,10 +2586,17 @@ _gst_debug_category_new (const gchar * name, guint color,
   if (catfound) {
     g_free ((gpointer) cat->name);
     g_free ((gpointer) cat->description);
-    g_slice_free (GstDebugCategory, cat);
+    g_slice_free (GstDebugCategoryImpl, (GstDebugCategoryImpl *) cat);
     cat = catfound;
   } else {
+    if (G_UNLIKELY (__categories_by_name == NULL))
+      __categories_by_name = g_hash_table_new (g_str_hash, g_str_equal);
     __categories = g_slist_prepend (__categories, cat);
+    g_hash_table_insert (__categories_by_name, (gpointer) cat->name, cat);
+
+    /* the thresholds changed while we were not in the list yet */
+    if (G_UNLIKELY (epoch != g_atomic_int_get (&__level_name_epoch)))
+      gst_debug_reset_threshold (cat, NULL);
   }
   g_mutex_unlock (&__cat_mutex);
 
@@ -1606,11 +2618,15 @@ gst_debug_category_free (GstDebugCategory * category)
   /* remove from category list */
   g_mutex_lock (&__cat_mutex);
   __categories = g_slist_remove (__categories, category);
+  if (__categories_by_name
+      && g_hash_table_lookup (__categories_by_name,
+          category->name) == category)
+    g_hash_table_remove (__categories_by_name, category->name);
   g_mutex_unlock (&__cat_mutex);
 
   g_free ((gpointer) category->name);
   g_free ((gpointer) category->description);
-  g_slice_free (GstDebugCategory, category);
+  g_slice_free (GstDebugCategoryImpl, (GstDebugCategoryImpl *) category);
 }
 
 /**
@@ -1739,16 +2755,10 @@ gst_debug_get_all_categories (void)
 static GstDebugCategory *
 _gst_debug_get_category_locked (const gchar * name)
 {
-  GstDebugCategory *ret = NULL;
-  GSList *node;
+  if (__categories_by_name == NULL)
+    return NULL;
 
-  for (node = __categories; node; node = g_slist_next (node)) {
-    ret = (GstDebugCategory *) node->data;
-    if (!strcmp (name, ret->name)) {
-      return ret;
-    }
-  }
-  return NULL;
+  return g_hash_table_lookup (__categories_by_name, name);
 }
 
 GstDebugCategory *
@@ -1820,6 +2830,37 @@ parse_debug_level (gchar * str, GstDebugLevel * level)
   return TRUE;
 }
 
+/* parses the part after the '@' in "category:level@limit", which is either
+ * "N/s" for at most N messages per second or "N/K" for N out of every K
+ * messages, per call site */
+static gboolean
+parse_debug_limit (gchar * str, DebugLimit * limit)
+{
+  guint64 n, k;
+  gchar *end;
+
+  g_strstrip (str);
+
+  n = g_ascii_strtoull (str, &end, 10);
+  if (end == str || *end != '/' || n == 0 || n > G_MAXUINT)
+    return FALSE;
+  str = end + 1;
+
+  memset (limit, 0, sizeof (DebugLimit));
+  if (strcmp (str, "s") == 0) {
+    limit->rate = n;
+    return TRUE;
+  }
+
+  k = g_ascii_strtoull (str, &end, 10);
+  if (end == str || *end != '\0' || k < n || k > G_MAXUINT)
+    return FALSE;
+  limit->sample_n = n;
+  limit->sample_k = k;
+
+  return TRUE;
+}
+
 /**
  * gst_debug_set_threshold_from_string:
  * @list: comma-separated list of "category:level" pairs to be used
@@ -1833,6 +2874,12 @@ parse_debug_level (gchar * str, GstDebugLevel * level)
  * the order matters when you use wild cards, e.g. "foosrc:6,*src:3,*:2" sets
  * everything to log level 2.
  *
+ * A level can be followed by "@N/s" to let every logging statement of the
+ * matching categories output at most N messages per second, or by "@N/K" to
+ * only output N of every K messages, e.g. "videodecoder:6@10/s,*sink:5@1/100".
+ * Rate limited statements log how many messages they suppressed when they
+ * output again.
+ *
  * Since: 1.2
  */
 void
@@ -1840,14 +2887,17 @@ gst_debug_set_threshold_from_string (const gchar * list, gboolean reset)
 {
   gchar **split;
   gchar **walk;
+  GSList *end = NULL;
+  gboolean added = FALSE, reset_all = reset;
 
   g_assert (list);
 
   if (reset)
-    gst_debug_set_default_threshold (0);
+    g_atomic_int_set (&__default_level, 0);
 
   split = g_strsplit (list, ",", 0);
 
+  /* collect everything first and then update the categories in one go */
   for (walk = split; *walk; walk++) {
     if (strchr (*walk, ':')) {
       gchar **values = g_strsplit (*walk, ":", 2);
@@ -1855,22 +2905,46 @@ gst_debug_set_threshold_from_string (const gchar * list, gboolean reset)
       if (values[0] && values[1]) {
         GstDebugLevel level;
         const gchar *category;
+        DebugLimit limit, *plimit = NULL;
+        gchar *at = strchr (values[1], '@');
+
+        if (at) {
+          *at = '\0';
+          if (!parse_debug_limit (at + 1, &limit)) {
+            g_strfreev (values);
+            continue;
+          }
+          plimit = &limit;
+        }
 
         if (parse_debug_category (values[0], &category)
-            && parse_debug_level (values[1], &level))
-          gst_debug_set_threshold_for_name (category, level);
+            && parse_debug_level (values[1], &level)) {
+          GSList *old =
+              gst_debug_add_level_name_entry (category, level, plimit);
+
+          if (!added)
+            end = old;
+          added = TRUE;
+        }
       }
 
       g_strfreev (values);
     } else {
       GstDebugLevel level;
 
-      if (parse_debug_level (*walk, &level))
-        gst_debug_set_default_threshold (level);
+      if (parse_debug_level (*walk, &level)) {
+        g_atomic_int_set (&__default_level, level);
+        reset_all = TRUE;
+      }
     }
   }
 
   g_strfreev (split);
+
+  if (reset_all)
+    gst_debug_reset_all_thresholds ();
+  else if (added)
+    gst_debug_apply_new_level_name_entries (end);
 }
 
 /*** FUNCTION POINTERS ********************************************************/
@@ -2025,6 +3099,13 @@ gst_debug_log_valist (GstDebugCategory * category, GstDebugLevel level,
 {
 }
 
+void
+gst_debug_log_site (GstDebugCallSite * site, GstDebugCategory * category,
+    GstDebugLevel level, const gchar * file, const gchar * function,
+    gint line, GObject * object, const gchar * format, ...)
+{
+}
+
 const gchar *
 gst_debug_message_get (GstDebugMessage * message)
 {
@@ -2038,6 +3119,40 @@ gst_debug_log_default (GstDebugCategory * category, GstDebugLevel level,
 {
 }
 
+void
+gst_debug_add_ring_buffer_logger (guint max_size_per_thread,
+    guint thread_timeout)
+{
+}
+
+void
+gst_debug_remove_ring_buffer_logger (void)
+{
+}
+
+void
+gst_debug_add_async_logger (guint max_records,
+    GstDebugAsyncDropPolicy policy, gboolean json)
+{
+}
+
+void
+gst_debug_remove_async_logger (void)
+{
+}
+
+guint
+gst_debug_async_logger_get_dropped (void)
+{
+  return 0;
+}
+
+gchar **
+gst_debug_ring_buffer_logger_get_logs (void)
+{
+  return NULL;
+}
+
 const gchar *
 gst_debug_level_get_name (GstDebugLevel level)
 {
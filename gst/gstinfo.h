@@ -188,6 +188,24 @@ typedef enum {
   GST_DEBUG_COLOR_MODE_UNIX = 2
 } GstDebugColorMode;
 
+/**
+ * GstDebugAsyncDropPolicy:
+ * @GST_DEBUG_ASYNC_DROP_NEWEST: drop the message that is being logged
+ * @GST_DEBUG_ASYNC_DROP_OLDEST: drop the oldest message that was not
+ *     written yet
+ * @GST_DEBUG_ASYNC_WAIT: wait until the writer made room for the message
+ *
+ * What the async logger does when a message is logged while the maximum
+ * number of messages are waiting to be written.
+ *
+ * Since: 1.10
+ */
+typedef enum {
+  GST_DEBUG_ASYNC_DROP_NEWEST = 0,
+  GST_DEBUG_ASYNC_DROP_OLDEST = 1,
+  GST_DEBUG_ASYNC_WAIT        = 2
+} GstDebugAsyncDropPolicy;
+
 
 #define GST_DEBUG_FG_MASK	(0x000F)
 #define GST_DEBUG_BG_MASK	(0x00F0)
@@ -209,6 +227,25 @@ struct _GstDebugCategory {
   const gchar *		description;
 };
 
+/**
+ * GstDebugCallSite:
+ *
+ * The state of a single logging statement. The GST_CAT_LEVEL_LOG() macros
+ * keep one of these per call site to implement the rate limiting and
+ * sampling that can be configured through the @N/s and @N/K suffixes of
+ * the GST_DEBUG levels.
+ *
+ * Since: 1.10
+ */
+typedef struct {
+  /*< private >*/
+  volatile gint window;
+  volatile gint count;
+  volatile gint suppressed;
+
+  gpointer _gst_reserved[GST_PADDING];
+} GstDebugCallSite;
+
 /********** some convenience macros for debugging **********/
 
 /**
@@ -319,6 +356,16 @@ void            gst_debug_log_valist     (GstDebugCategory * category,
                                           const gchar      * format,
                                           va_list            args) G_GNUC_NO_INSTRUMENT;
 
+void            gst_debug_log_site       (GstDebugCallSite * site,
+                                          GstDebugCategory * category,
+                                          GstDebugLevel      level,
+                                          const gchar      * file,
+                                          const gchar      * function,
+                                          gint               line,
+                                          GObject          * object,
+                                          const gchar      * format,
+                                          ...) G_GNUC_PRINTF (8, 9) G_GNUC_NO_INSTRUMENT;
+
 /* do not use this function, use the GST_DEBUG_CATEGORY_INIT macro */
 GstDebugCategory *_gst_debug_category_new (const gchar * name,
                                            guint         color,
@@ -365,6 +412,17 @@ void            gst_debug_add_log_function            (GstLogFunction func,
 guint           gst_debug_remove_log_function         (GstLogFunction func);
 guint           gst_debug_remove_log_function_by_data (gpointer       data);
 
+void            gst_debug_add_ring_buffer_logger      (guint max_size_per_thread,
+                                                       guint thread_timeout);
+void            gst_debug_remove_ring_buffer_logger   (void);
+gchar **        gst_debug_ring_buffer_logger_get_logs (void);
+
+void            gst_debug_add_async_logger            (guint max_records,
+                                                       GstDebugAsyncDropPolicy policy,
+                                                       gboolean json);
+void            gst_debug_remove_async_logger         (void);
+guint           gst_debug_async_logger_get_dropped    (void);
+
 void            gst_debug_set_active  (gboolean active);
 gboolean        gst_debug_is_active   (void);
 
@@ -528,6 +586,13 @@ GST_EXPORT gboolean			_gst_debug_enabled;
  * messages that fall under the threshold. */
 GST_EXPORT GstDebugLevel            _gst_debug_min;
 
+/* the threshold of the category is checked inline too, so that enabling a
+ * single category doesn't make every other log statement call into
+ * gst_debug_log(). A NULL category is passed on to be warned about there. */
+#define _GST_CAT_LEVEL_ENABLED(cat,level)				\
+  ((level) <= GST_LEVEL_MAX && (level) <= _gst_debug_min &&		\
+   ((cat) == NULL || (gint) (level) <= (cat)->threshold))
+
 /**
  * GST_CAT_LEVEL_LOG:
  * @cat: category to use
@@ -541,17 +606,19 @@ GST_EXPORT GstDebugLevel            _gst_debug_min;
  */
 #ifdef G_HAVE_ISO_VARARGS
 #define GST_CAT_LEVEL_LOG(cat,level,object,...) G_STMT_START{		\
-  if (G_UNLIKELY (level <= GST_LEVEL_MAX && level <= _gst_debug_min)) {						\
-    gst_debug_log ((cat), (level), __FILE__, GST_FUNCTION, __LINE__,	\
-        (GObject *) (object), __VA_ARGS__);				\
+  if (G_UNLIKELY (_GST_CAT_LEVEL_ENABLED (cat, level))) {		\
+    static GstDebugCallSite __gst_debug_site;				\
+    gst_debug_log_site (&__gst_debug_site, (cat), (level), __FILE__,	\
+        GST_FUNCTION, __LINE__, (GObject *) (object), __VA_ARGS__);	\
   }									\
 }G_STMT_END
 #else /* G_HAVE_GNUC_VARARGS */
 #ifdef G_HAVE_GNUC_VARARGS
 #define GST_CAT_LEVEL_LOG(cat,level,object,args...) G_STMT_START{	\
-  if (G_UNLIKELY (level <= GST_LEVEL_MAX && level <= _gst_debug_min)) {						\
-    gst_debug_log ((cat), (level), __FILE__, GST_FUNCTION, __LINE__,	\
-        (GObject *) (object), ##args );					\
+  if (G_UNLIKELY (_GST_CAT_LEVEL_ENABLED (cat, level))) {		\
+    static GstDebugCallSite __gst_debug_site;				\
+    gst_debug_log_site (&__gst_debug_site, (cat), (level), __FILE__,	\
+        GST_FUNCTION, __LINE__, (GObject *) (object), ##args );	\
   }									\
 }G_STMT_END
 #else /* no variadic macros, use inline */
@@ -559,7 +626,7 @@ static inline void
 GST_CAT_LEVEL_LOG_valist (GstDebugCategory * cat,
     GstDebugLevel level, gpointer object, const char *format, va_list varargs)
 {
-  if (G_UNLIKELY (level <= GST_LEVEL_MAX && level <= _gst_debug_min)) {
+  if (G_UNLIKELY (_GST_CAT_LEVEL_ENABLED (cat, level))) {
     gst_debug_log_valist (cat, level, "", "", 0, (GObject *) object, format,
         varargs);
   }
@@ -582,8 +649,7 @@ GST_CAT_LEVEL_LOG (GstDebugCategory * cat, GstDebugLevel level,
  * other macros and hence in a separate block right here. Docs chunks are
  * with the other doc chunks below though. */
 #define __GST_CAT_MEMDUMP_LOG(cat,object,msg,data,length) G_STMT_START{       \
-    if (G_UNLIKELY (GST_LEVEL_MEMDUMP <= GST_LEVEL_MAX &&		      \
-		    GST_LEVEL_MEMDUMP <= _gst_debug_min)) {		      \
+    if (G_UNLIKELY (_GST_CAT_LEVEL_ENABLED (cat, GST_LEVEL_MEMDUMP))) {       \
     _gst_debug_dump_mem ((cat), __FILE__, GST_FUNCTION, __LINE__,             \
         (GObject *) (object), (msg), (data), (length));                       \
   }                                                                           \
@@ -1264,6 +1330,7 @@ GST_TRACE (const char *format, ...)
 #if defined(__GNUC__) && __GNUC__ >= 3
 #  pragma GCC poison gst_debug_log
 #  pragma GCC poison gst_debug_log_valist
+#  pragma GCC poison gst_debug_log_site
 #  pragma GCC poison _gst_debug_category_new
 #endif
 
@@ -1275,6 +1342,12 @@ GST_TRACE (const char *format, ...)
 #define gst_debug_level_get_name(level)				("NONE")
 #define gst_debug_message_get(message)  			("")
 #define gst_debug_add_log_function(func,data,notify)    G_STMT_START{ }G_STMT_END
+#define gst_debug_add_ring_buffer_logger(max_size,timeout) G_STMT_START{ }G_STMT_END
+#define gst_debug_remove_ring_buffer_logger()		G_STMT_START{ }G_STMT_END
+#define gst_debug_ring_buffer_logger_get_logs()		(NULL)
+#define gst_debug_add_async_logger(max_records,policy,json) G_STMT_START{ }G_STMT_END
+#define gst_debug_remove_async_logger()		G_STMT_START{ }G_STMT_END
+#define gst_debug_async_logger_get_dropped()		(0)
 #define gst_debug_set_active(active)			G_STMT_START{ }G_STMT_END
 #define gst_debug_is_active()				(FALSE)
 #define gst_debug_set_colored(colored)			G_STMT_START{ }G_STMT_END
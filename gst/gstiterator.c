@@ -282,6 +282,85 @@ gst_iterator_new_list (GType type,
   return GST_ITERATOR (result);
 }
 
+/*
+ * snapshot iterator
+ */
+typedef struct _GstSnapshotIterator
+{
+  GstIterator iterator;
+  GObject **items;
+  guint n_items;
+  guint pos;
+} GstSnapshotIterator;
+
+/* the items of a snapshot never change */
+static guint32 _snapshot_dummy_cookie = 0;
+
+static void
+gst_snapshot_iterator_copy (const GstSnapshotIterator * it,
+    GstSnapshotIterator * copy)
+{
+  guint i;
+
+  copy->items = g_memdup (it->items, it->n_items * sizeof (GObject *));
+  for (i = 0; i < copy->n_items; i++)
+    g_object_ref (copy->items[i]);
+}
+
+static GstIteratorResult
+gst_snapshot_iterator_next (GstSnapshotIterator * it, GValue * elem)
+{
+  if (it->pos >= it->n_items)
+    return GST_ITERATOR_DONE;
+
+  g_value_set_object (elem, it->items[it->pos++]);
+
+  return GST_ITERATOR_OK;
+}
+
+static void
+gst_snapshot_iterator_resync (GstSnapshotIterator * it)
+{
+  it->pos = 0;
+}
+
+static void
+gst_snapshot_iterator_free (GstSnapshotIterator * it)
+{
+  guint i;
+
+  for (i = 0; i < it->n_items; i++)
+    g_object_unref (it->items[i]);
+  g_free (it->items);
+}
+
+/* Create an iterator over a copy of @list, a list of objects of @type. Call
+ * with the lock protecting @list, the iterator keeps a ref to every object
+ * and never needs the lock again, it never returns %GST_ITERATOR_RESYNC. */
+GstIterator *
+_priv_gst_iterator_new_list_snapshot (GType type, GList * list)
+{
+  GstSnapshotIterator *result;
+  GList *walk;
+  guint i;
+
+  g_return_val_if_fail (g_type_is_a (type, G_TYPE_OBJECT), NULL);
+
+  result = (GstSnapshotIterator *) gst_iterator_new (sizeof
+      (GstSnapshotIterator), type, NULL, &_snapshot_dummy_cookie,
+      (GstIteratorCopyFunction) gst_snapshot_iterator_copy,
+      (GstIteratorNextFunction) gst_snapshot_iterator_next, NULL,
+      (GstIteratorResyncFunction) gst_snapshot_iterator_resync,
+      (GstIteratorFreeFunction) gst_snapshot_iterator_free);
+
+  result->n_items = g_list_length (list);
+  result->items = g_new (GObject *, result->n_items);
+  for (walk = list, i = 0; walk; walk = walk->next, i++)
+    result->items[i] = g_object_ref (walk->data);
+
+  return GST_ITERATOR (result);
+}
+
 static void
 gst_iterator_pop (GstIterator * it)
 {
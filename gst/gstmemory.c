@@ -72,6 +72,9 @@
 GType _gst_memory_type = 0;
 GST_DEFINE_MINI_OBJECT_TYPE (GstMemory, gst_memory);
 
+/* set when the mapping didn't take a lock on the memory */
+#define MAP_INFO_UNLOCKED(info) ((info)->_gst_reserved[0])
+
 static GstMemory *
 _gst_memory_copy (GstMemory * mem)
 {
@@ -94,7 +97,8 @@ _gst_memory_free (GstMemory * mem)
   allocator = mem->allocator;
 
   gst_allocator_free (allocator, mem);
-  gst_object_unref (allocator);
+  if (allocator != _priv_gst_sysmem_allocator)
+    gst_object_unref (allocator);
 }
 
 /**
@@ -121,7 +125,10 @@ gst_memory_init (GstMemory * mem, GstMemoryFlags flags,
       (GstMiniObjectCopyFunction) _gst_memory_copy, NULL,
       (GstMiniObjectFreeFunction) _gst_memory_free);
 
-  mem->allocator = gst_object_ref (allocator);
+  /* skip the refcounting of the system allocator, it lives forever */
+  if (allocator != _priv_gst_sysmem_allocator)
+    gst_object_ref (allocator);
+  mem->allocator = allocator;
   if (parent) {
     /* FIXME 2.0: this can fail if the memory is already write locked */
     gst_memory_lock (parent, GST_LOCK_FLAG_EXCLUSIVE);
@@ -288,12 +295,21 @@ cannot_map:
 gboolean
 gst_memory_map (GstMemory * mem, GstMapInfo * info, GstMapFlags flags)
 {
+  gboolean unlocked;
+
   g_return_val_if_fail (mem != NULL, FALSE);
   g_return_val_if_fail (info != NULL, FALSE);
 
-  if (!gst_memory_lock (mem, (GstLockFlags) flags))
+  /* readonly system memory can never be locked for writing, so its read
+   * mappings don't have to be counted in the lock state */
+  unlocked = flags == GST_MAP_READ && GST_MEMORY_IS_READONLY (mem)
+      && mem->allocator == _priv_gst_sysmem_allocator;
+
+  if (!unlocked && !gst_memory_lock (mem, (GstLockFlags) flags))
     goto lock_failed;
 
+  MAP_INFO_UNLOCKED (info) = GINT_TO_POINTER (unlocked);
+
   info->flags = flags;
   info->memory = mem;
   info->size = mem->size;
@@ -322,7 +338,8 @@ error:
   {
     /* something went wrong, restore the orginal state again */
     GST_CAT_ERROR (GST_CAT_MEMORY, "mem %p: subclass map failed", mem);
-    gst_memory_unlock (mem, (GstLockFlags) flags);
+    if (!unlocked)
+      gst_memory_unlock (mem, (GstLockFlags) flags);
     memset (info, 0, sizeof (GstMapInfo));
     return FALSE;
   }
@@ -346,7 +363,8 @@ gst_memory_unmap (GstMemory * mem, GstMapInfo * info)
     mem->allocator->mem_unmap_full (mem, info);
   else
     mem->allocator->mem_unmap (mem);
-  gst_memory_unlock (mem, (GstLockFlags) info->flags);
+  if (!MAP_INFO_UNLOCKED (info))
+    gst_memory_unlock (mem, (GstLockFlags) info->flags);
 }
 
 /**
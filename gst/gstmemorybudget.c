@@ -0,0 +1,636 @@
+/* GStreamer
+ *
+ * gstmemorybudget.c: memory budget shared between elements
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/**
+ * SECTION:gstmemorybudget
+ * @short_description: Memory limit shared between elements
+ * @see_also: #GstContext, #GstBufferPool
+ *
+ * A #GstMemoryBudget bounds the total amount of memory that queueing
+ * elements and buffer pools hold, across any number of pipelines in the
+ * process. Every user of the budget registers as a #GstMemoryBudgetClient
+ * with gst_memory_budget_add_client() and accounts the bytes it holds with
+ * gst_memory_budget_client_acquire() and gst_memory_budget_client_release().
+ *
+ * Each client has a fair share of the limit, proportional to its priority.
+ * A client can always use memory up to its share. Beyond that it can only
+ * use memory that is not reserved for the unused shares of other clients,
+ * so a client that consumes a lot can not starve the others.
+ *
+ * When gst_memory_budget_client_is_exhausted() returns %TRUE, elements
+ * handle it like their own size limits: queues block or leak depending
+ * on their configuration and buffer pools recycle their buffers instead of
+ * allocating more.
+ *
+ * The budget is distributed to elements with a #GstContext of type
+ * %GST_MEMORY_BUDGET_CONTEXT_TYPE, for example by setting it on a pipeline:
+ * |[<!-- language="C" -->
+ *   GstMemoryBudget *budget = gst_memory_budget_new (512 * 1024 * 1024);
+ *   GstContext *context = gst_context_new_memory_budget (budget);
+ *
+ *   gst_element_set_context (pipeline, context);
+ *   gst_context_unref (context);
+ * ]|
+ *
+ * The same budget can be set on any number of pipelines.
+ */
+
+#include "gst_private.h"
+
+#include "gstinfo.h"
+#include "gstutils.h"
+#include "gstmemorybudget.h"
+
+GST_DEBUG_CATEGORY_STATIC (memory_budget_debug);
+#define GST_CAT_DEFAULT (memory_budget_debug)
+
+struct _GstMemoryBudgetPrivate
+{
+  GMutex lock;
+
+  guint64 limit;                /* 0 is unlimited */
+  guint64 used;
+  /* sum of the unused parts of the client shares */
+  guint64 reserved;
+  guint64 total_priority;
+
+  GList *clients;
+};
+
+/**
+ * GstMemoryBudgetClient:
+ *
+ * Opaque handle of a user of a #GstMemoryBudget.
+ *
+ * Since: 1.10
+ */
+struct _GstMemoryBudgetClient
+{
+  GstMemoryBudget *budget;
+
+  guint priority;
+  guint64 share;
+  guint64 used;
+};
+
+enum
+{
+  PROP_0,
+  PROP_LIMIT
+};
+
+static void gst_memory_budget_finalize (GObject * object);
+static void gst_memory_budget_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec);
+static void gst_memory_budget_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec);
+
+#define _do_init \
+{ \
+  GST_DEBUG_CATEGORY_INIT (memory_budget_debug, "memorybudget", 0, \
+      "Memory budget"); \
+}
+
+#define GST_MEMORY_BUDGET_GET_PRIVATE(obj)  \
+   (G_TYPE_INSTANCE_GET_PRIVATE ((obj), GST_TYPE_MEMORY_BUDGET, GstMemoryBudgetPrivate))
+
+G_DEFINE_TYPE_WITH_CODE (GstMemoryBudget, gst_memory_budget, GST_TYPE_OBJECT,
+    _do_init);
+
+static void
+gst_memory_budget_class_init (GstMemoryBudgetClass * klass)
+{
+  GObjectClass *gobject_class = (GObjectClass *) klass;
+
+  g_type_class_add_private (klass, sizeof (GstMemoryBudgetPrivate));
+
+  gobject_class->finalize = gst_memory_budget_finalize;
+  gobject_class->set_property = gst_memory_budget_set_property;
+  gobject_class->get_property = gst_memory_budget_get_property;
+
+  /**
+   * GstMemoryBudget:limit:
+   *
+   * The maximum number of bytes all clients of the budget can hold together,
+   * or 0 for no limit.
+   *
+   * Since: 1.10
+   */
+  g_object_class_install_property (gobject_class, PROP_LIMIT,
+      g_param_spec_uint64 ("limit", "Limit",
+          "Maximum number of bytes held by all clients (0 = unlimited)",
+          0, G_MAXUINT64, 0, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+}
+
+static void
+gst_memory_budget_init (GstMemoryBudget * budget)
+{
+  budget->priv = GST_MEMORY_BUDGET_GET_PRIVATE (budget);
+
+  g_mutex_init (&budget->priv->lock);
+}
+
+static void
+gst_memory_budget_finalize (GObject * object)
+{
+  GstMemoryBudget *budget = GST_MEMORY_BUDGET (object);
+
+  /* every client holds a ref on the budget */
+  g_assert (budget->priv->clients == NULL);
+
+  g_mutex_clear (&budget->priv->lock);
+
+  G_OBJECT_CLASS (gst_memory_budget_parent_class)->finalize (object);
+}
+
+static void
+gst_memory_budget_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstMemoryBudget *budget = GST_MEMORY_BUDGET (object);
+
+  switch (prop_id) {
+    case PROP_LIMIT:
+      gst_memory_budget_set_limit (budget, g_value_get_uint64 (value));
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_memory_budget_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec)
+{
+  GstMemoryBudget *budget = GST_MEMORY_BUDGET (object);
+
+  switch (prop_id) {
+    case PROP_LIMIT:
+      g_value_set_uint64 (value, gst_memory_budget_get_limit (budget));
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static inline guint64
+client_reserved (GstMemoryBudgetClient * client)
+{
+  return client->share > client->used ? client->share - client->used : 0;
+}
+
+/* must be called with the lock */
+static void
+update_shares (GstMemoryBudget * budget)
+{
+  GstMemoryBudgetPrivate *priv = budget->priv;
+  GList *walk;
+
+  priv->reserved = 0;
+  for (walk = priv->clients; walk; walk = walk->next) {
+    GstMemoryBudgetClient *client = walk->data;
+
+    if (priv->limit == 0 || priv->total_priority == 0)
+      client->share = 0;
+    else
+      client->share = gst_util_uint64_scale (priv->limit, client->priority,
+          priv->total_priority);
+    priv->reserved += client_reserved (client);
+  }
+}
+
+/* must be called with the lock; bytes that no other client can claim */
+static inline guint64
+available (GstMemoryBudget * budget, GstMemoryBudgetClient * client)
+{
+  GstMemoryBudgetPrivate *priv = budget->priv;
+  guint64 taken;
+
+  taken = priv->used + priv->reserved - client_reserved (client);
+
+  return taken < priv->limit ? priv->limit - taken : 0;
+}
+
+/* must be called with the lock */
+static inline void
+account (GstMemoryBudget * budget, GstMemoryBudgetClient * client,
+    guint64 used)
+{
+  GstMemoryBudgetPrivate *priv = budget->priv;
+
+  priv->reserved -= client_reserved (client);
+  priv->used -= client->used;
+  client->used = used;
+  priv->used += client->used;
+  priv->reserved += client_reserved (client);
+}
+
+/**
+ * gst_memory_budget_new:
+ * @limit: the maximum number of bytes, or 0 for no limit
+ *
+ * Create a new memory budget that allows at most @limit bytes to be held by
+ * all its clients together.
+ *
+ * Returns: (transfer full): a new #GstMemoryBudget
+ *
+ * Since: 1.10
+ */
+GstMemoryBudget *
+gst_memory_budget_new (guint64 limit)
+{
+  GstMemoryBudget *budget;
+
+  budget = g_object_new (GST_TYPE_MEMORY_BUDGET, "limit", limit, NULL);
+
+  /* clear floating flag */
+  gst_object_ref_sink (budget);
+
+  return budget;
+}
+
+/**
+ * gst_memory_budget_set_limit:
+ * @budget: a #GstMemoryBudget
+ * @limit: the maximum number of bytes, or 0 for no limit
+ *
+ * Change the limit of @budget. Lowering the limit below the amount of
+ * memory currently used does not free anything, clients will be reported
+ * as exhausted until enough memory has been released.
+ *
+ * Since: 1.10
+ */
+void
+gst_memory_budget_set_limit (GstMemoryBudget * budget, guint64 limit)
+{
+  g_return_if_fail (GST_IS_MEMORY_BUDGET (budget));
+
+  g_mutex_lock (&budget->priv->lock);
+  budget->priv->limit = limit;
+  update_shares (budget);
+  g_mutex_unlock (&budget->priv->lock);
+
+  GST_DEBUG_OBJECT (budget, "limit set to %" G_GUINT64_FORMAT, limit);
+}
+
+/**
+ * gst_memory_budget_get_limit:
+ * @budget: a #GstMemoryBudget
+ *
+ * Get the limit of @budget.
+ *
+ * Returns: the maximum number of bytes, or 0 when there is no limit
+ *
+ * Since: 1.10
+ */
+guint64
+gst_memory_budget_get_limit (GstMemoryBudget * budget)
+{
+  guint64 result;
+
+  g_return_val_if_fail (GST_IS_MEMORY_BUDGET (budget), 0);
+
+  g_mutex_lock (&budget->priv->lock);
+  result = budget->priv->limit;
+  g_mutex_unlock (&budget->priv->lock);
+
+  return result;
+}
+
+/**
+ * gst_memory_budget_get_used:
+ * @budget: a #GstMemoryBudget
+ *
+ * Get the number of bytes that all clients of @budget currently hold.
+ *
+ * Returns: the number of bytes in use
+ *
+ * Since: 1.10
+ */
+guint64
+gst_memory_budget_get_used (GstMemoryBudget * budget)
+{
+  guint64 result;
+
+  g_return_val_if_fail (GST_IS_MEMORY_BUDGET (budget), 0);
+
+  g_mutex_lock (&budget->priv->lock);
+  result = budget->priv->used;
+  g_mutex_unlock (&budget->priv->lock);
+
+  return result;
+}
+
+/**
+ * gst_memory_budget_add_client:
+ * @budget: a #GstMemoryBudget
+ * @priority: the priority of the client
+ *
+ * Register a new user of @budget. The share of the limit a client can
+ * always use is proportional to its @priority, relative to the priorities
+ * of all clients. A client with priority 0 can only use memory that is not
+ * reserved for the other clients.
+ *
+ * Returns: (transfer full): a new #GstMemoryBudgetClient, remove it with
+ *     gst_memory_budget_remove_client().
+ *
+ * Since: 1.10
+ */
+GstMemoryBudgetClient *
+gst_memory_budget_add_client (GstMemoryBudget * budget, guint priority)
+{
+  GstMemoryBudgetClient *client;
+
+  g_return_val_if_fail (GST_IS_MEMORY_BUDGET (budget), NULL);
+
+  client = g_slice_new0 (GstMemoryBudgetClient);
+  client->budget = gst_object_ref (budget);
+  client->priority = priority;
+
+  g_mutex_lock (&budget->priv->lock);
+  budget->priv->clients = g_list_prepend (budget->priv->clients, client);
+  budget->priv->total_priority += priority;
+  update_shares (budget);
+  g_mutex_unlock (&budget->priv->lock);
+
+  GST_DEBUG_OBJECT (budget, "added client %p with priority %u", client,
+      priority);
+
+  return client;
+}
+
+/**
+ * gst_memory_budget_remove_client:
+ * @budget: a #GstMemoryBudget
+ * @client: (transfer full): a #GstMemoryBudgetClient of @budget
+ *
+ * Unregister @client, releasing all the memory it still holds.
+ *
+ * Since: 1.10
+ */
+void
+gst_memory_budget_remove_client (GstMemoryBudget * budget,
+    GstMemoryBudgetClient * client)
+{
+  g_return_if_fail (GST_IS_MEMORY_BUDGET (budget));
+  g_return_if_fail (client != NULL);
+  g_return_if_fail (client->budget == budget);
+
+  g_mutex_lock (&budget->priv->lock);
+  account (budget, client, 0);
+  budget->priv->clients = g_list_remove (budget->priv->clients, client);
+  budget->priv->total_priority -= client->priority;
+  update_shares (budget);
+  g_mutex_unlock (&budget->priv->lock);
+
+  GST_DEBUG_OBJECT (budget, "removed client %p", client);
+
+  g_slice_free (GstMemoryBudgetClient, client);
+  gst_object_unref (budget);
+}
+
+/**
+ * gst_memory_budget_client_set_priority:
+ * @client: a #GstMemoryBudgetClient
+ * @priority: the new priority
+ *
+ * Change the priority of @client, see gst_memory_budget_add_client().
+ *
+ * Since: 1.10
+ */
+void
+gst_memory_budget_client_set_priority (GstMemoryBudgetClient * client,
+    guint priority)
+{
+  GstMemoryBudget *budget;
+
+  g_return_if_fail (client != NULL);
+
+  budget = client->budget;
+
+  g_mutex_lock (&budget->priv->lock);
+  budget->priv->total_priority -= client->priority;
+  client->priority = priority;
+  budget->priv->total_priority += priority;
+  update_shares (budget);
+  g_mutex_unlock (&budget->priv->lock);
+}
+
+/**
+ * gst_memory_budget_client_acquire:
+ * @client: a #GstMemoryBudgetClient
+ * @size: a number of bytes
+ *
+ * Account @size more bytes as held by @client, even when this goes over
+ * the budget. This is what queues use: like with their own size limits,
+ * they check gst_memory_budget_client_is_exhausted() before accepting more
+ * data and may go over the limit by the size of one buffer.
+ *
+ * Since: 1.10
+ */
+void
+gst_memory_budget_client_acquire (GstMemoryBudgetClient * client, gsize size)
+{
+  GstMemoryBudget *budget;
+
+  g_return_if_fail (client != NULL);
+
+  budget = client->budget;
+
+  g_mutex_lock (&budget->priv->lock);
+  account (budget, client, client->used + size);
+  g_mutex_unlock (&budget->priv->lock);
+}
+
+/**
+ * gst_memory_budget_client_try_acquire:
+ * @client: a #GstMemoryBudgetClient
+ * @size: a number of bytes
+ *
+ * Account @size more bytes as held by @client if that is possible without
+ * going over the share of @client or taking memory reserved for the other
+ * clients.
+ *
+ * Returns: %TRUE when the bytes were acquired
+ *
+ * Since: 1.10
+ */
+gboolean
+gst_memory_budget_client_try_acquire (GstMemoryBudgetClient * client,
+    gsize size)
+{
+  GstMemoryBudget *budget;
+  gboolean result;
+
+  g_return_val_if_fail (client != NULL, FALSE);
+
+  budget = client->budget;
+
+  g_mutex_lock (&budget->priv->lock);
+  result = budget->priv->limit == 0 || client->used + size <= client->share
+      || size <= available (budget, client);
+  if (result)
+    account (budget, client, client->used + size);
+  g_mutex_unlock (&budget->priv->lock);
+
+  return result;
+}
+
+/**
+ * gst_memory_budget_client_release:
+ * @client: a #GstMemoryBudgetClient
+ * @size: a number of bytes
+ *
+ * Release @size bytes previously acquired by @client.
+ *
+ * Since: 1.10
+ */
+void
+gst_memory_budget_client_release (GstMemoryBudgetClient * client, gsize size)
+{
+  GstMemoryBudget *budget;
+
+  g_return_if_fail (client != NULL);
+
+  budget = client->budget;
+
+  g_mutex_lock (&budget->priv->lock);
+  if (G_UNLIKELY (size > client->used)) {
+    g_critical ("memory budget client %p releases %" G_GSIZE_FORMAT
+        " bytes but only holds %" G_GUINT64_FORMAT, client, size,
+        client->used);
+    size = client->used;
+  }
+  account (budget, client, client->used - size);
+  g_mutex_unlock (&budget->priv->lock);
+}
+
+/**
+ * gst_memory_budget_client_is_exhausted:
+ * @client: a #GstMemoryBudgetClient
+ *
+ * Check if @client used up its share of the budget and no memory that is
+ * not reserved for other clients is left.
+ *
+ * Returns: %TRUE when @client should not acquire more memory
+ *
+ * Since: 1.10
+ */
+gboolean
+gst_memory_budget_client_is_exhausted (GstMemoryBudgetClient * client)
+{
+  GstMemoryBudget *budget;
+  gboolean result;
+
+  g_return_val_if_fail (client != NULL, FALSE);
+
+  budget = client->budget;
+
+  g_mutex_lock (&budget->priv->lock);
+  result = budget->priv->limit != 0 && client->used >= client->share
+      && available (budget, client) == 0;
+  g_mutex_unlock (&budget->priv->lock);
+
+  return result;
+}
+
+/**
+ * gst_memory_budget_client_get_used:
+ * @client: a #GstMemoryBudgetClient
+ *
+ * Get the number of bytes @client currently holds.
+ *
+ * Returns: the number of bytes held by @client
+ *
+ * Since: 1.10
+ */
+guint64
+gst_memory_budget_client_get_used (GstMemoryBudgetClient * client)
+{
+  GstMemoryBudget *budget;
+  guint64 result;
+
+  g_return_val_if_fail (client != NULL, 0);
+
+  budget = client->budget;
+
+  g_mutex_lock (&budget->priv->lock);
+  result = client->used;
+  g_mutex_unlock (&budget->priv->lock);
+
+  return result;
+}
+
+/**
+ * gst_context_new_memory_budget:
+ * @budget: a #GstMemoryBudget
+ *
+ * Create a persistent context of type %GST_MEMORY_BUDGET_CONTEXT_TYPE that
+ * makes the elements it is set on use @budget.
+ *
+ * Returns: (transfer full): a new #GstContext
+ *
+ * Since: 1.10
+ */
+GstContext *
+gst_context_new_memory_budget (GstMemoryBudget * budget)
+{
+  GstContext *context;
+  GstStructure *s;
+
+  g_return_val_if_fail (GST_IS_MEMORY_BUDGET (budget), NULL);
+
+  context = gst_context_new (GST_MEMORY_BUDGET_CONTEXT_TYPE, TRUE);
+  s = gst_context_writable_structure (context);
+  gst_structure_set (s, "budget", GST_TYPE_MEMORY_BUDGET, budget, NULL);
+
+  return context;
+}
+
+/**
+ * gst_context_get_memory_budget:
+ * @context: a #GstContext
+ * @budget: (out) (transfer full): the #GstMemoryBudget
+ *
+ * Get the memory budget from a context created with
+ * gst_context_new_memory_budget().
+ *
+ * Returns: %TRUE if @context contains a memory budget
+ *
+ * Since: 1.10
+ */
+gboolean
+gst_context_get_memory_budget (const GstContext * context,
+    GstMemoryBudget ** budget)
+{
+  const GstStructure *s;
+
+  g_return_val_if_fail (GST_IS_CONTEXT (context), FALSE);
+  g_return_val_if_fail (budget != NULL, FALSE);
+
+  if (!gst_context_has_context_type (context, GST_MEMORY_BUDGET_CONTEXT_TYPE))
+    return FALSE;
+
+  s = gst_context_get_structure (context);
+
+  return gst_structure_get (s, "budget", GST_TYPE_MEMORY_BUDGET, budget, NULL);
+}
@@ -0,0 +1,127 @@
+/* GStreamer
+ *
+ * gstmemorybudget.h: memory budget shared between elements
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __GST_MEMORY_BUDGET_H__
+#define __GST_MEMORY_BUDGET_H__
+
+#include <gst/gstobject.h>
+#include <gst/gstcontext.h>
+
+G_BEGIN_DECLS
+
+#define GST_TYPE_MEMORY_BUDGET             (gst_memory_budget_get_type ())
+#define GST_MEMORY_BUDGET(obj)             (G_TYPE_CHECK_INSTANCE_CAST ((obj), GST_TYPE_MEMORY_BUDGET, GstMemoryBudget))
+#define GST_IS_MEMORY_BUDGET(obj)          (G_TYPE_CHECK_INSTANCE_TYPE ((obj), GST_TYPE_MEMORY_BUDGET))
+#define GST_MEMORY_BUDGET_CLASS(klass)     (G_TYPE_CHECK_CLASS_CAST ((klass), GST_TYPE_MEMORY_BUDGET, GstMemoryBudgetClass))
+#define GST_IS_MEMORY_BUDGET_CLASS(klass)  (G_TYPE_CHECK_CLASS_TYPE ((klass), GST_TYPE_MEMORY_BUDGET))
+#define GST_MEMORY_BUDGET_GET_CLASS(obj)   (G_TYPE_INSTANCE_GET_CLASS ((obj), GST_TYPE_MEMORY_BUDGET, GstMemoryBudgetClass))
+#define GST_MEMORY_BUDGET_CAST(obj)        ((GstMemoryBudget *)(obj))
+
+/**
+ * GST_MEMORY_BUDGET_CONTEXT_TYPE:
+ *
+ * The #GstContext type used to distribute a #GstMemoryBudget to the
+ * elements of a bin or pipeline.
+ *
+ * Since: 1.10
+ */
+#define GST_MEMORY_BUDGET_CONTEXT_TYPE "gst.memory-budget"
+
+/**
+ * GST_MEMORY_BUDGET_DEFAULT_PRIORITY:
+ *
+ * The default priority of a #GstMemoryBudgetClient.
+ *
+ * Since: 1.10
+ */
+#define GST_MEMORY_BUDGET_DEFAULT_PRIORITY 100
+
+typedef struct _GstMemoryBudget GstMemoryBudget;
+typedef struct _GstMemoryBudgetClass GstMemoryBudgetClass;
+typedef struct _GstMemoryBudgetPrivate GstMemoryBudgetPrivate;
+typedef struct _GstMemoryBudgetClient GstMemoryBudgetClient;
+
+/**
+ * GstMemoryBudget:
+ *
+ * The opaque #GstMemoryBudget object.
+ *
+ * Since: 1.10
+ */
+struct _GstMemoryBudget {
+  GstObject object;
+
+  /*< private >*/
+  GstMemoryBudgetPrivate *priv;
+  gpointer _gst_reserved[GST_PADDING];
+};
+
+/**
+ * GstMemoryBudgetClass:
+ * @parent_class: the parent class structure
+ *
+ * The #GstMemoryBudgetClass structure.
+ *
+ * Since: 1.10
+ */
+struct _GstMemoryBudgetClass {
+  GstObjectClass parent_class;
+
+  /*< private >*/
+  gpointer _gst_reserved[GST_PADDING];
+};
+
+GType                   gst_memory_budget_get_type      (void);
+
+GstMemoryBudget *       gst_memory_budget_new           (guint64 limit);
+
+void                    gst_memory_budget_set_limit     (GstMemoryBudget * budget, guint64 limit);
+guint64                 gst_memory_budget_get_limit     (GstMemoryBudget * budget);
+guint64                 gst_memory_budget_get_used      (GstMemoryBudget * budget);
+
+/* clients */
+GstMemoryBudgetClient * gst_memory_budget_add_client    (GstMemoryBudget * budget, guint priority);
+void                    gst_memory_budget_remove_client (GstMemoryBudget * budget,
+                                                         GstMemoryBudgetClient * client);
+
+void                    gst_memory_budget_client_set_priority (GstMemoryBudgetClient * client,
+                                                               guint priority);
+
+void                    gst_memory_budget_client_acquire      (GstMemoryBudgetClient * client,
+                                                               gsize size);
+gboolean                gst_memory_budget_client_try_acquire  (GstMemoryBudgetClient * client,
+                                                               gsize size);
+void                    gst_memory_budget_client_release      (GstMemoryBudgetClient * client,
+                                                               gsize size);
+gboolean                gst_memory_budget_client_is_exhausted (GstMemoryBudgetClient * client);
+guint64                 gst_memory_budget_client_get_used     (GstMemoryBudgetClient * client);
+
+/* context */
+GstContext *            gst_context_new_memory_budget   (GstMemoryBudget * budget);
+gboolean                gst_context_get_memory_budget   (const GstContext * context,
+                                                         GstMemoryBudget ** budget);
+
+#ifdef G_DEFINE_AUTOPTR_CLEANUP_FUNC
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(GstMemoryBudget, gst_object_unref)
+#endif
+
+G_END_DECLS
+
+#endif /* __GST_MEMORY_BUDGET_H__ */
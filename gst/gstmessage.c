@@ -209,7 +209,8 @@ _gst_message_free (GstMessage * message)
     gst_structure_free (structure);
   }
 
-  g_slice_free1 (sizeof (GstMessageImpl), message);
+  _priv_gst_mini_object_cache_free (GST_MINI_OBJECT_CACHE_MESSAGE,
+      sizeof (GstMessageImpl), message);
 }
 
 static void
@@ -226,7 +227,8 @@ _gst_message_copy (GstMessage * message)
       GST_MESSAGE_TYPE_NAME (message),
       GST_OBJECT_NAME (GST_MESSAGE_SRC (message)));
 
-  copy = g_slice_new0 (GstMessageImpl);
+  copy = _priv_gst_mini_object_cache_alloc0 (GST_MINI_OBJECT_CACHE_MESSAGE,
+      sizeof (GstMessageImpl));
 
   gst_message_init (copy, GST_MESSAGE_TYPE (message),
       GST_MESSAGE_SRC (message));
@@ -285,7 +287,8 @@ gst_message_new_custom (GstMessageType type, GstObject * src,
 {
   GstMessageImpl *message;
 
-  message = g_slice_new0 (GstMessageImpl);
+  message = _priv_gst_mini_object_cache_alloc0 (GST_MINI_OBJECT_CACHE_MESSAGE,
+      sizeof (GstMessageImpl));
 
   GST_CAT_LOG (GST_CAT_MESSAGE, "source %s: creating new message %p %s",
       (src ? GST_OBJECT_NAME (src) : "NULL"), message,
@@ -306,7 +309,8 @@ gst_message_new_custom (GstMessageType type, GstObject * src,
   /* ERRORS */
 had_parent:
   {
-    g_slice_free1 (sizeof (GstMessageImpl), message);
+    _priv_gst_mini_object_cache_free (GST_MINI_OBJECT_CACHE_MESSAGE,
+        sizeof (GstMessageImpl), message);
     g_warning ("structure is already owned by another object");
     return NULL;
   }
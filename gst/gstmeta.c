@@ -53,6 +53,22 @@
 static GHashTable *metainfo = NULL;
 static GRWLock lock;
 
+/* API types get a dense index so that buffers can keep a bitmap of the APIs
+ * of their metas. Slots are only ever added, so that lookups don't need to
+ * take the lock. */
+#define META_API_TABLE_SIZE 128
+
+typedef struct
+{
+  volatile gsize api;
+  gint index;
+} GstMetaApiSlot;
+
+static GstMetaApiSlot api_slots[META_API_TABLE_SIZE];
+static gint n_api_indices = 0;
+
+#define META_API_HASH(api) ((((gsize) (api)) >> 3) * 2654435761u)
+
 GQuark _gst_meta_transform_copy;
 GQuark _gst_meta_tag_memory;
 
@@ -100,9 +116,59 @@ gst_meta_api_type_register (const gchar * api, const gchar ** tags)
   g_type_set_qdata (type, g_quark_from_string ("tags"),
       g_strdupv ((gchar **) tags));
 
+  if (type != 0)
+    gst_meta_api_type_add_index (type);
+
   return type;
 }
 
+static void
+gst_meta_api_type_add_index (GType api)
+{
+  guint i;
+
+  g_rw_lock_writer_lock (&lock);
+  if (n_api_indices >= GST_META_API_INDEX_MAX)
+    goto done;
+
+  i = META_API_HASH (api) & (META_API_TABLE_SIZE - 1);
+  while (api_slots[i].api != 0) {
+    if (api_slots[i].api == api)
+      goto done;
+    i = (i + 1) & (META_API_TABLE_SIZE - 1);
+  }
+  /* publish the index before the api so that readers never see a slot with
+   * an api and no index */
+  api_slots[i].index = n_api_indices++;
+  g_atomic_pointer_set (&api_slots[i].api, api);
+
+  GST_CAT_DEBUG (GST_CAT_META, "API %s has index %d", g_type_name (api),
+      api_slots[i].index);
+
+done:
+  g_rw_lock_writer_unlock (&lock);
+}
+
+/* Get the dense index of @api, or -1 when it has none because it was not
+ * registered with gst_meta_api_type_register() or too many APIs exist. */
+gint
+_priv_gst_meta_api_type_get_index (GType api)
+{
+  guint i, n;
+
+  i = META_API_HASH (api) & (META_API_TABLE_SIZE - 1);
+  for (n = 0; n < META_API_TABLE_SIZE; n++) {
+    gsize slot_api = (gsize) g_atomic_pointer_get (&api_slots[i].api);
+
+    if (slot_api == api)
+      return api_slots[i].index;
+    if (slot_api == 0)
+      break;
+    i = (i + 1) & (META_API_TABLE_SIZE - 1);
+  }
+  return -1;
+}
+
 /**
  * gst_meta_api_type_has_tag:
  * @api: an API
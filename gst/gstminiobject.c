@@ -62,6 +62,41 @@
 static GstAllocTrace *_gst_mini_object_trace;
 #endif
 
+#ifndef GST_DISABLE_OBJECT_CACHE
+/* maximum number of structs kept per type and thread */
+#define CACHE_MAX_ITEMS 64
+/* allocations between two "mini-object-cache-stats" tracer hooks */
+#define CACHE_STATS_INTERVAL 4096
+
+typedef struct
+{
+  /* the size of the cached structs, 0 until the first allocation */
+  gsize size;
+  guint n_items;
+  gpointer items[CACHE_MAX_ITEMS];
+
+  guint64 hits;
+  guint64 misses;
+} GstMiniObjectCache;
+
+typedef struct
+{
+  GstMiniObjectCache caches[GST_MINI_OBJECT_CACHE_LAST];
+} GstMiniObjectThreadCache;
+
+static const gchar *cache_names[GST_MINI_OBJECT_CACHE_LAST] = {
+  "buffer", "event", "message", "query", "buffer-list", "memory"
+};
+
+static gboolean cache_enabled = TRUE;
+
+static void gst_mini_object_thread_cache_free (GstMiniObjectThreadCache *
+    tcache);
+
+static GPrivate thread_cache =
+G_PRIVATE_INIT ((GDestroyNotify) gst_mini_object_thread_cache_free);
+#endif
+
 /* Mutex used for weak referencing */
 G_LOCK_DEFINE_STATIC (qdata_mutex);
 static GQuark weak_ref_quark;
@@ -97,8 +132,117 @@ _priv_gst_mini_object_initialize (void)
 #ifndef GST_DISABLE_TRACE
   _gst_mini_object_trace = _gst_alloc_trace_register ("GstMiniObject", 0);
 #endif
+
+#ifndef GST_DISABLE_OBJECT_CACHE
+  {
+    const gchar *env = g_getenv ("GST_OBJECT_CACHE");
+
+    if (env != NULL && (!strcmp (env, "0") || !g_ascii_strcasecmp (env, "no")))
+      cache_enabled = FALSE;
+    /* cached structs would hide leaked objects from valgrind */
+    if (_priv_gst_in_valgrind ())
+      cache_enabled = FALSE;
+  }
+#endif
+}
+
+#ifndef GST_DISABLE_OBJECT_CACHE
+static void
+gst_mini_object_thread_cache_free (GstMiniObjectThreadCache * tcache)
+{
+  guint i, j;
+
+  for (i = 0; i < GST_MINI_OBJECT_CACHE_LAST; i++) {
+    GstMiniObjectCache *cache = &tcache->caches[i];
+
+    for (j = 0; j < cache->n_items; j++)
+      g_slice_free1 (cache->size, cache->items[j]);
+  }
+  g_slice_free (GstMiniObjectThreadCache, tcache);
 }
 
+static inline GstMiniObjectCache *
+gst_mini_object_cache_get (GstMiniObjectCacheId id, gsize size)
+{
+  GstMiniObjectThreadCache *tcache;
+  GstMiniObjectCache *cache;
+
+  if (G_UNLIKELY (!cache_enabled))
+    return NULL;
+
+  tcache = g_private_get (&thread_cache);
+  if (G_UNLIKELY (tcache == NULL)) {
+    tcache = g_slice_new0 (GstMiniObjectThreadCache);
+    g_private_set (&thread_cache, tcache);
+  }
+
+  cache = &tcache->caches[id];
+  if (G_UNLIKELY (cache->size == 0))
+    cache->size = size;
+  else if (G_UNLIKELY (cache->size != size))
+    return NULL;
+
+  return cache;
+}
+
+static inline void
+gst_mini_object_cache_count (GstMiniObjectCacheId id,
+    GstMiniObjectCache * cache)
+{
+  if (G_UNLIKELY ((cache->hits + cache->misses) % CACHE_STATS_INTERVAL == 0))
+    GST_TRACER_MINI_OBJECT_CACHE_STATS (cache_names[id], cache->hits,
+        cache->misses);
+}
+
+/* Get a struct of @size bytes for a mini object of type @id. The fields of
+ * a cached struct are not reset, the caller initializes them all. */
+gpointer
+_priv_gst_mini_object_cache_alloc (GstMiniObjectCacheId id, gsize size)
+{
+  GstMiniObjectCache *cache;
+  gpointer mem;
+
+  cache = gst_mini_object_cache_get (id, size);
+  if (cache == NULL)
+    return g_slice_alloc (size);
+
+  if (cache->n_items > 0) {
+    mem = cache->items[--cache->n_items];
+    cache->hits++;
+  } else {
+    mem = g_slice_alloc (size);
+    cache->misses++;
+  }
+  gst_mini_object_cache_count (id, cache);
+
+  return mem;
+}
+
+/* like _priv_gst_mini_object_cache_alloc() but the struct is cleared */
+gpointer
+_priv_gst_mini_object_cache_alloc0 (GstMiniObjectCacheId id, gsize size)
+{
+  return memset (_priv_gst_mini_object_cache_alloc (id, size), 0, size);
+}
+
+/* Give the struct of a freed mini object back to the cache of the calling
+ * thread, or to the slice allocator when that cache is full. */
+void
+_priv_gst_mini_object_cache_free (GstMiniObjectCacheId id, gsize size,
+    gpointer mem)
+{
+  GstMiniObjectCache *cache;
+
+  cache = gst_mini_object_cache_get (id, size);
+  if (cache == NULL || cache->n_items == CACHE_MAX_ITEMS) {
+    g_slice_free1 (size, mem);
+    return;
+  }
+
+  cache->items[cache->n_items++] = mem;
+}
+#endif
+
 /**
  * gst_mini_object_init: (skip)
  * @mini_object: a #GstMiniObject
@@ -422,6 +566,22 @@ call_finalize_notify (GstMiniObject * obj)
   }
 }
 
+/* Drop a reference and return %TRUE when it was the last one.
+ *
+ * A caller that sees a refcount of 1 owns the only reference, so no other
+ * thread can legally ref or unref the object concurrently and the count
+ * can be cleared without a locked read-modify-write. This is the common
+ * case for buffers and events that are handled by one streaming thread. */
+static inline gboolean
+unref_and_test (GstMiniObject * mini_object)
+{
+  if (g_atomic_int_get (&mini_object->refcount) == 1) {
+    mini_object->refcount = 0;
+    return TRUE;
+  }
+  return g_atomic_int_dec_and_test (&mini_object->refcount);
+}
+
 /**
  * gst_mini_object_unref: (skip)
  * @mini_object: the mini-object
@@ -441,7 +601,7 @@ gst_mini_object_unref (GstMiniObject * mini_object)
 
   g_return_if_fail (mini_object->refcount > 0);
 
-  if (G_UNLIKELY (g_atomic_int_dec_and_test (&mini_object->refcount))) {
+  if (G_UNLIKELY (unref_and_test (mini_object))) {
     gboolean do_free;
 
     if (mini_object->dispose)
@@ -456,6 +616,8 @@ gst_mini_object_unref (GstMiniObject * mini_object)
       g_return_if_fail ((g_atomic_int_get (&mini_object->lockstate) & LOCK_MASK)
           < 4);
 
+      GST_TRACER_MINI_OBJECT_FREE (mini_object);
+
       if (mini_object->n_qdata) {
         call_finalize_notify (mini_object);
         g_free (mini_object->qdata);
@@ -93,6 +93,8 @@
 #include "gst_private.h"
 #include "glib-compat-private.h"
 
+#include <stdlib.h>
+
 #include "gstobject.h"
 #include "gstclock.h"
 #include "gstcontrolbinding.h"
@@ -129,6 +131,18 @@ enum
   SO_LAST_SIGNAL
 };
 
+/* what the last gst_object_sync_values() found out about the next changes of
+ * the control bindings */
+typedef struct
+{
+  /* the synced values are valid until this time */
+  GstClockTime next_sync;
+  /* _priv_gst_control_cookie when next_sync was computed */
+  gint cookie;
+  /* the result of the last sync */
+  gboolean ret;
+} GstObjectControlCache;
+
 /* maps type name quark => count */
 static GData *object_name_counts = NULL;
 
@@ -414,6 +428,8 @@ gst_object_finalize (GObject * object)
 
   g_free (gstobject->name);
   g_mutex_clear (&gstobject->lock);
+  if (gstobject->control_cache)
+    g_slice_free (GstObjectControlCache, gstobject->control_cache);
 
 #ifndef GST_DISABLE_TRACE
   _gst_alloc_trace_free (_gst_object_trace, object);
@@ -422,11 +438,24 @@ gst_object_finalize (GObject * object)
   ((GObjectClass *) gst_object_parent_class)->finalize (object);
 }
 
+/* emitting deep-notify on @object does nothing when there is no class
+ * handler and no signal handler for the property. Handlers connected with a
+ * detail only want notifications of that property. */
+static inline gboolean
+gst_object_wants_deep_notify (GstObject * object, GQuark detail)
+{
+  return GST_OBJECT_GET_CLASS (object)->deep_notify != NULL ||
+      g_signal_has_handler_pending (object, gst_object_signals[DEEP_NOTIFY],
+      detail, FALSE);
+}
+
 /* Changing a GObject property of a GstObject will result in "deep-notify"
  * signals being emitted by the object itself, as well as in each parent
  * object. This is so that an application can connect a listener to the
  * top-level bin to catch property-change notifications for all contained
- * elements.
+ * elements. Parents that don't listen for the property are skipped without
+ * emitting the signal, so that properties notified for every buffer are cheap
+ * when nobody is interested in them.
  *
  * MT safe.
  */
@@ -459,11 +488,18 @@ gst_object_dispatch_properties_changed (GObject * object,
   parent = gst_object_get_parent (gst_object);
   while (parent) {
     for (i = 0; i < n_pspecs; i++) {
+      /* when the name was never used as a quark, no handler can have been
+       * connected with it as detail */
+      GQuark detail = g_quark_try_string (pspecs[i]->name);
+
+      if (!gst_object_wants_deep_notify (parent, detail))
+        continue;
+
       GST_CAT_LOG_OBJECT (GST_CAT_PROPERTIES, parent,
           "deep notification from %s (%s)", debug_name, pspecs[i]->name);
 
-      g_signal_emit (parent, gst_object_signals[DEEP_NOTIFY],
-          g_quark_from_string (pspecs[i]->name), gst_object, pspecs[i]);
+      g_signal_emit (parent, gst_object_signals[DEEP_NOTIFY], detail,
+          gst_object, pspecs[i]);
     }
 
     old_parent = parent;
@@ -1114,14 +1150,21 @@ gst_object_suggest_next_sync (GstObject * object)
  * If this function fails, it is most likely the application developers fault.
  * Most probably the control sources are not setup correctly.
  *
+ * When all control bindings know until when their values stay the same (see
+ * gst_control_binding_get_next_change()), syncing again for a later
+ * timestamp before that time returns immediately.
+ *
  * Returns: %TRUE if the controller values could be applied to the object
  * properties, %FALSE otherwise
  */
 gboolean
 gst_object_sync_values (GstObject * object, GstClockTime timestamp)
 {
+  GstObjectControlCache *cache;
+  GstClockTime next_sync = GST_CLOCK_TIME_NONE;
   GList *node;
   gboolean ret = TRUE;
+  gint cookie;
 
   g_return_val_if_fail (GST_IS_OBJECT (object), FALSE);
   g_return_val_if_fail (GST_CLOCK_TIME_IS_VALID (timestamp), FALSE);
@@ -1130,14 +1173,33 @@ gst_object_sync_values (GstObject * object, GstClockTime timestamp)
   if (!object->control_bindings)
     return TRUE;
 
+  /* nothing changed since the last sync, the properties have their values
+   * for this timestamp already */
+  cache = object->control_cache;
+  cookie = g_atomic_int_get (&_priv_gst_control_cookie);
+  if (G_LIKELY (cache && timestamp >= object->last_sync
+          && timestamp < cache->next_sync && cookie == cache->cookie)) {
+    object->last_sync = timestamp;
+    return cache->ret;
+  }
+
   /* FIXME: this deadlocks */
   /* GST_OBJECT_LOCK (object); */
   g_object_freeze_notify ((GObject *) object);
   for (node = object->control_bindings; node; node = g_list_next (node)) {
-    ret &= gst_control_binding_sync_values ((GstControlBinding *) node->data,
-        object, timestamp, object->last_sync);
+    GstControlBinding *binding = (GstControlBinding *) node->data;
+
+    ret &= gst_control_binding_sync_values (binding, object, timestamp,
+        object->last_sync);
+    next_sync = MIN (next_sync,
+        gst_control_binding_get_next_change (binding, timestamp));
   }
   object->last_sync = timestamp;
+  if (cache) {
+    cache->next_sync = next_sync;
+    cache->cookie = cookie;
+    cache->ret = ret;
+  }
   g_object_thaw_notify ((GObject *) object);
   /* GST_OBJECT_UNLOCK (object); */
 
@@ -1251,6 +1313,10 @@ gst_object_add_control_binding (GstObject * object, GstControlBinding * binding)
   }
   object->control_bindings = g_list_prepend (object->control_bindings, binding);
   gst_object_set_parent (GST_OBJECT_CAST (binding), object);
+  if (!object->control_cache)
+    object->control_cache = g_slice_new0 (GstObjectControlCache);
+  /* the new binding has to be synced */
+  g_atomic_int_inc (&_priv_gst_control_cookie);
   GST_DEBUG_OBJECT (object, "controlled property %s added", binding->name);
   GST_OBJECT_UNLOCK (object);
 
@@ -1311,6 +1377,7 @@ gst_object_remove_control_binding (GstObject * object,
     object->control_bindings =
         g_list_delete_link (object->control_bindings, node);
     gst_object_unparent (GST_OBJECT_CAST (binding));
+    g_atomic_int_inc (&_priv_gst_control_cookie);
     ret = TRUE;
   }
   GST_OBJECT_UNLOCK (object);
@@ -1481,3 +1548,210 @@ gst_object_set_control_rate (GstObject * object, GstClockTime control_rate)
 
   object->control_rate = control_rate;
 }
+
+/* lock tracing and adaptive spinning, the lock macros call these when
+ * GStreamer was configured with --enable-lock-tracing or
+ * --enable-adaptive-locks. The previous holder of a lock and the spin
+ * estimate are remembered in a small table indexed by the lock address,
+ * collisions just make this information less accurate. */
+#define LOCK_HOLDERS_SIZE 1024
+
+/* upper bound for GST_LOCK_SPIN */
+#define LOCK_SPIN_MAX 10000
+#ifdef GST_ENABLE_ADAPTIVE_LOCKS
+#define LOCK_SPIN_DEFAULT 100
+#else
+#define LOCK_SPIN_DEFAULT 0
+#endif
+
+#if defined (__GNUC__) && (defined (__i386__) || defined (__x86_64__))
+#define LOCK_CPU_RELAX() __asm__ __volatile__ ("pause" ::: "memory")
+#elif defined (__GNUC__) && defined (__aarch64__)
+#define LOCK_CPU_RELAX() __asm__ __volatile__ ("yield" ::: "memory")
+#else
+#define LOCK_CPU_RELAX() G_STMT_START { } G_STMT_END
+#endif
+
+typedef struct
+{
+  gpointer lock;
+  GThread *thread;
+  /* running average of the spins that were needed to get the lock */
+  gint spins;
+} GstLockHolder;
+
+static GstLockHolder lock_holders[LOCK_HOLDERS_SIZE];
+
+#define LOCK_HOLDER(l) (&lock_holders[(((guintptr) (l)) >> 3) % LOCK_HOLDERS_SIZE])
+
+static inline void
+lock_holder_set (gpointer lock)
+{
+  GstLockHolder *h = LOCK_HOLDER (lock);
+  GThread *self = g_thread_self ();
+
+  /* a thread taking the same lock again, as with recursive stream locks,
+   * does not need to dirty the cache line */
+  if (g_atomic_pointer_get (&h->lock) == lock &&
+      g_atomic_pointer_get (&h->thread) == self)
+    return;
+
+  g_atomic_pointer_set (&h->thread, self);
+  g_atomic_pointer_set (&h->lock, lock);
+}
+
+static inline GThread *
+lock_holder_get (gpointer lock)
+{
+  GstLockHolder *h = LOCK_HOLDER (lock);
+
+  if (g_atomic_pointer_get (&h->lock) != lock)
+    return NULL;
+  return g_atomic_pointer_get (&h->thread);
+}
+
+/* the maximum number of spins before blocking, from GST_LOCK_SPIN. Spinning
+ * is pointless when there is no other CPU to release the lock */
+static gint
+lock_spin_limit (void)
+{
+  static gint limit = -1;
+  gint res;
+
+  res = g_atomic_int_get (&limit);
+  if (G_UNLIKELY (res < 0)) {
+    const gchar *env = g_getenv ("GST_LOCK_SPIN");
+
+    res = LOCK_SPIN_DEFAULT;
+    if (env != NULL)
+      res = CLAMP (atoi (env), 0, LOCK_SPIN_MAX);
+    if (g_get_num_processors () < 2)
+      res = 0;
+    g_atomic_int_set (&limit, res);
+  }
+  return res;
+}
+
+/* spin on @trylock for up to twice the number of spins that were needed
+ * before, like the adaptive mutexes of glibc. Returns %TRUE when the lock was
+ * acquired */
+static gboolean
+lock_spin (gpointer lock, gboolean (*trylock) (gpointer), gpointer object,
+    const gchar * kind)
+{
+  GstLockHolder *h;
+  gint limit, max_spins, spins, avg;
+  gboolean res = FALSE;
+
+  limit = lock_spin_limit ();
+  if (limit == 0)
+    return FALSE;
+
+  h = LOCK_HOLDER (lock);
+  avg = g_atomic_int_get (&h->spins);
+  max_spins = MIN (limit, avg * 2 + 10);
+
+  for (spins = 1; spins <= max_spins; spins++) {
+    LOCK_CPU_RELAX ();
+    if (trylock (lock)) {
+      res = TRUE;
+      break;
+    }
+  }
+  spins = MIN (spins, max_spins);
+  g_atomic_int_set (&h->spins, avg + (spins - avg) / 8);
+
+#ifndef GST_DISABLE_GST_TRACER_HOOKS
+  GST_TRACER_LOCK_SPIN (object, kind, spins, res);
+#endif
+
+  return res;
+}
+
+static gboolean
+mutex_trylock (gpointer mutex)
+{
+  return g_mutex_trylock (mutex);
+}
+
+static gboolean
+rec_mutex_trylock (gpointer mutex)
+{
+  return g_rec_mutex_trylock (mutex);
+}
+
+/**
+ * _gst_lock_trace_mutex_lock: (skip)
+ * @mutex: the mutex to lock
+ * @object: the object owning @mutex
+ * @kind: a static string describing the lock
+ *
+ * Lock @mutex, spinning for a while before blocking when it is contended.
+ * The spinning is reported to the "lock-spin" tracer hook and the time spent
+ * blocking to the "lock-wait" tracer hook.
+ */
+void
+_gst_lock_trace_mutex_lock (GMutex * mutex, gpointer object,
+    const gchar * kind)
+{
+  if (G_LIKELY (g_mutex_trylock (mutex)))
+    goto done;
+
+  if (lock_spin (mutex, mutex_trylock, object, kind))
+    goto done;
+
+#ifndef GST_DISABLE_GST_TRACER_HOOKS
+  if (GST_TRACER_HOOK_IS_ENABLED (GST_TRACER_QUARK_HOOK_LOCK_WAIT)) {
+    GThread *holder = lock_holder_get (mutex);
+    GstClockTime start = gst_util_get_timestamp ();
+
+    g_mutex_lock (mutex);
+    GST_TRACER_LOCK_WAIT (object, kind,
+        GST_CLOCK_DIFF (start, gst_util_get_timestamp ()), holder);
+    goto done;
+  }
+#endif
+
+  g_mutex_lock (mutex);
+
+done:
+  lock_holder_set (mutex);
+}
+
+/**
+ * _gst_lock_trace_rec_mutex_lock: (skip)
+ * @mutex: the recursive mutex to lock
+ * @object: the object owning @mutex
+ * @kind: a static string describing the lock
+ *
+ * Like _gst_lock_trace_mutex_lock() but for a #GRecMutex. When the current
+ * thread already owns @mutex, the first trylock succeeds and it neither
+ * spins nor updates the holder table.
+ */
+void
+_gst_lock_trace_rec_mutex_lock (GRecMutex * mutex, gpointer object,
+    const gchar * kind)
+{
+  if (G_LIKELY (g_rec_mutex_trylock (mutex)))
+    goto done;
+
+  if (lock_spin (mutex, rec_mutex_trylock, object, kind))
+    goto done;
+
+#ifndef GST_DISABLE_GST_TRACER_HOOKS
+  if (GST_TRACER_HOOK_IS_ENABLED (GST_TRACER_QUARK_HOOK_LOCK_WAIT)) {
+    GThread *holder = lock_holder_get (mutex);
+    GstClockTime start = gst_util_get_timestamp ();
+
+    g_rec_mutex_lock (mutex);
+    GST_TRACER_LOCK_WAIT (object, kind,
+        GST_CLOCK_DIFF (start, gst_util_get_timestamp ()), holder);
+    goto done;
+  }
+#endif
+
+  g_rec_mutex_lock (mutex);
+
+done:
+  lock_holder_set (mutex);
+}
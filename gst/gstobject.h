@@ -83,7 +83,11 @@ typedef enum
  * This macro will obtain a lock on the object, making serialization possible.
  * It blocks until the lock can be obtained.
  */
+#if !defined (GST_ENABLE_LOCK_TRACING) && !defined (GST_ENABLE_ADAPTIVE_LOCKS)
 #define GST_OBJECT_LOCK(obj)                   g_mutex_lock(GST_OBJECT_GET_LOCK(obj))
+#else
+#define GST_OBJECT_LOCK(obj)                   _gst_lock_trace_mutex_lock(GST_OBJECT_GET_LOCK(obj), obj, "object")
+#endif
 /**
  * GST_OBJECT_TRYLOCK:
  * @obj: a #GstObject.
@@ -179,7 +183,7 @@ struct _GstObject {
   guint64        control_rate;
   guint64        last_sync;
 
-  gpointer _gst_reserved;
+  gpointer       control_cache;     /* until when the synced values are valid */
 };
 
 /**
@@ -269,6 +273,11 @@ gboolean        gst_object_get_g_value_array      (GstObject * object, const gch
 GstClockTime    gst_object_get_control_rate       (GstObject * object);
 void            gst_object_set_control_rate       (GstObject * object, GstClockTime control_rate);
 
+/* lock tracing and spinning, used by the lock macros with
+ * GST_ENABLE_LOCK_TRACING or GST_ENABLE_ADAPTIVE_LOCKS */
+void            _gst_lock_trace_mutex_lock        (GMutex * mutex, gpointer object, const gchar * kind);
+void            _gst_lock_trace_rec_mutex_lock    (GRecMutex * mutex, gpointer object, const gchar * kind);
+
 #ifdef G_DEFINE_AUTOPTR_CLEANUP_FUNC
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(GstObject, gst_object_unref)
 #endif
@@ -90,6 +90,7 @@
 
 #include "gstpad.h"
 #include "gstpadtemplate.h"
+#include "gstghostpad.h"
 #include "gstenumtypes.h"
 #include "gstutils.h"
 #include "gstinfo.h"
@@ -132,22 +133,104 @@ typedef struct
   GstEvent *event;
 } PadEvent;
 
+/* sticky event types are numbered in steps of 10, which makes them map
+ * to small slot numbers */
+#define PAD_EVENT_SLOT(type) (((type) >> GST_EVENT_NUM_SHIFT) / 10)
+#define PAD_EVENT_N_SLOTS 64
+
+/* max number of pad pairs that are skipped in one push */
+#define BYPASS_MAX_HOPS 8
+
+/* the pads that data pushed to a pad with GST_PAD_FLAG_BYPASS can skip:
+ * pairs of the sink pad and the source pad it bypasses to */
+typedef struct
+{
+  GstPad *pads[2 * BYPASS_MAX_HOPS];
+  guint n_pads;
+  /* the pads are refs owned by this path instead of a cache */
+  gboolean owned;
+} BypassPath;
+
 struct _GstPadPrivate
 {
   guint events_cookie;
+  /* the sticky events, only allocated while events are stored */
   GArray *events;
   guint last_cookie;
 
+  /* index of the sticky events array, one slot per sticky event type. The
+   * bit of a slot is set in events_mask when an event of that type is
+   * stored and events_first then has the position of the first one, or 0
+   * when the position does not fit */
+  guint64 events_mask;
+  guint8 events_first[PAD_EVENT_N_SLOTS];
+
   gint using;
   guint probe_list_cookie;
   guint probe_cookie;
 
+  /* union of the masks of the installed non-blocking and blocking probes,
+   * used to skip the probe handling when no probe can match */
+  GstPadProbeType probe_mask;
+  GstPadProbeType block_probe_mask;
+
   /* counter of how many idle probes are running directly from the add_probe
    * call. Used to block any data flowing in the pad while the idle callback
    * Doesn't finish its work */
   gint idle_running;
+
+  /* pending batch of buffers when GST_PAD_FLAG_BATCHING is set, protected
+   * with the object lock */
+  GstBufferList *batch;
+  guint batch_bytes;
+  GstClockTime batch_first_ts;
+  guint batch_max_buffers;
+  guint batch_max_bytes;
+  GstClockTime batch_max_latency;
+
+  /* result of the last allocation query with GST_PAD_FLAG_CACHE_ALLOCATION,
+   * protected with the object lock */
+  GstQuery *allocation_cache;
+  guint allocation_cookie;
+
+  /* results of the last caps and accept-caps queries when the caps cache
+   * is enabled, protected with the object lock */
+  gboolean caps_cache_enabled;
+  gboolean caps_cached;
+  GstCaps *caps_filter;
+  GstCaps *caps_result;
+  GstCaps *accept_caps;
+  gboolean accept_result;
+  guint caps_cookie;
+
+  /* events queued with gst_pad_queue_event(), protected with the object
+   * lock */
+  GQueue queued_events;
+
+  GstPadGetRangesFunction getrangesfunc;
+  gpointer getrangesdata;
+  GDestroyNotify getrangesnotify;
+
+  /* source pad that buffers pushed to this sink pad skip to, see
+   * gst_pad_set_bypass_pad(). protected with the object lock */
+  GstPad *bypass_pad;
+
+  /* the bypass path starting at the peer of this source pad, allocated
+   * when the first bypass path is found. valid while bypass_cookie matches
+   * the global bypass cookie and only replaced when no push is using it.
+   * protected with the object lock */
+  BypassPath *bypass_path;
+  guint bypass_cookie;
 };
 
+/* changed when links or bypass pads change, this makes the source pads
+ * look up their bypass path again */
+static gint bypass_cookie = 1;
+
+#define BYPASS_INVALIDATE() g_atomic_int_inc (&bypass_cookie)
+
+static void bypass_path_clear (BypassPath * path);
+
 typedef struct
 {
   GHook hook;
@@ -185,6 +268,7 @@ static GstFlowReturn gst_pad_send_event_unchecked (GstPad * pad,
     GstEvent * event, GstPadProbeType type);
 static GstFlowReturn gst_pad_push_event_unchecked (GstPad * pad,
     GstEvent * event, GstPadProbeType type);
+static void push_queued_events (GstPad * pad);
 
 static gboolean activate_mode_internal (GstPad * pad, GstObject * parent,
     GstPadMode mode, gboolean active);
@@ -405,18 +489,93 @@ gst_pad_init (GstPad * pad)
 
   GST_PAD_SET_FLUSHING (pad);
 
-  g_rec_mutex_init (&pad->stream_rec_lock);
-
-  g_cond_init (&pad->block_cond);
+  /* the stream lock and block cond are zero-filled, which makes GLib set
+   * them up on first use. Most pads never block and many are never used
+   * for streaming */
 
   g_hook_list_init (&pad->probes, sizeof (GstProbe));
 
-  pad->priv->events = g_array_sized_new (FALSE, TRUE, sizeof (PadEvent), 16);
   pad->priv->events_cookie = 0;
   pad->priv->last_cookie = -1;
+  pad->priv->batch_first_ts = GST_CLOCK_TIME_NONE;
   pad->ABI.abi.last_flowret = GST_FLOW_FLUSHING;
 }
 
+/* drop the events queued with gst_pad_queue_event(). must be called with
+ * the object lock */
+static void
+clear_queued_events (GstPad * pad)
+{
+  GstEvent *event;
+
+  while ((event = g_queue_pop_head (&pad->priv->queued_events)))
+    gst_event_unref (event);
+}
+
+/* take the pending batch of buffers. must be called with the object lock */
+static GstBufferList *
+take_batch (GstPad * pad)
+{
+  GstBufferList *list = pad->priv->batch;
+
+  pad->priv->batch = NULL;
+  pad->priv->batch_bytes = 0;
+  pad->priv->batch_first_ts = GST_CLOCK_TIME_NONE;
+
+  return list;
+}
+
+/* rebuild the per type index of the sticky events array, needs to be called
+ * every time events are inserted or removed from the array.
+ * must be called with object lock */
+static void
+update_events_index (GstPad * pad)
+{
+  GstPadPrivate *priv = pad->priv;
+  guint i, len;
+  guint64 mask = 0;
+
+  len = priv->events->len;
+  for (i = 0; i < len; i++) {
+    PadEvent *ev = &g_array_index (priv->events, PadEvent, i);
+    guint slot;
+
+    if (ev->event == NULL)
+      continue;
+
+    slot = PAD_EVENT_SLOT (GST_EVENT_TYPE (ev->event));
+    if (slot >= PAD_EVENT_N_SLOTS || (mask & (G_GUINT64_CONSTANT (1) << slot)))
+      continue;
+
+    mask |= G_GUINT64_CONSTANT (1) << slot;
+    /* looking from the start finds the same events, only slower */
+    priv->events_first[slot] = i <= G_MAXUINT8 ? i : 0;
+  }
+  priv->events_mask = mask;
+}
+
+/* get the position in the events array where the lookup for events of @type
+ * can start. Returns FALSE when no event of @type is stored.
+ * must be called with object lock */
+static inline gboolean
+find_events_start (GstPad * pad, GstEventType type, guint * start)
+{
+  guint slot = PAD_EVENT_SLOT (type);
+
+  if (pad->priv->events == NULL)
+    return FALSE;
+
+  if (G_UNLIKELY (slot >= PAD_EVENT_N_SLOTS)) {
+    *start = 0;
+    return TRUE;
+  }
+  if (!(pad->priv->events_mask & (G_GUINT64_CONSTANT (1) << slot)))
+    return FALSE;
+
+  *start = pad->priv->events_first[slot];
+  return TRUE;
+}
+
 /* called when setting the pad inactive. It removes all sticky events from
  * the pad. must be called with object lock */
 static void
@@ -427,8 +586,9 @@ remove_events (GstPad * pad)
   gboolean notify = FALSE;
 
   events = pad->priv->events;
+  pad->priv->events = NULL;
 
-  len = events->len;
+  len = events ? events->len : 0;
   for (i = 0; i < len; i++) {
     PadEvent *ev = &g_array_index (events, PadEvent, i);
     GstEvent *event = ev->event;
@@ -440,9 +600,11 @@ remove_events (GstPad * pad)
 
     gst_event_unref (event);
   }
+  if (events)
+    g_array_free (events, TRUE);
 
   GST_OBJECT_FLAG_UNSET (pad, GST_PAD_FLAG_PENDING_EVENTS);
-  g_array_set_size (events, 0);
+  pad->priv->events_mask = 0;
   pad->priv->events_cookie++;
 
   if (notify) {
@@ -463,10 +625,13 @@ find_event_by_type (GstPad * pad, GstEventType type, guint idx)
   GArray *events;
   PadEvent *ev;
 
+  if (!find_events_start (pad, type, &i))
+    return NULL;
+
   events = pad->priv->events;
   len = events->len;
 
-  for (i = 0; i < len; i++) {
+  for (; i < len; i++) {
     ev = &g_array_index (events, PadEvent, i);
     if (ev->event == NULL)
       continue;
@@ -492,10 +657,13 @@ find_event (GstPad * pad, GstEvent * event)
   GArray *events;
   PadEvent *ev;
 
+  if (!find_events_start (pad, GST_EVENT_TYPE (event), &i))
+    return NULL;
+
   events = pad->priv->events;
   len = events->len;
 
-  for (i = 0; i < len; i++) {
+  for (; i < len; i++) {
     ev = &g_array_index (events, PadEvent, i);
     if (event == ev->event)
       goto found;
@@ -514,11 +682,14 @@ remove_event_by_type (GstPad * pad, GstEventType type)
   guint i, len;
   GArray *events;
   PadEvent *ev;
+  gboolean removed = FALSE;
+
+  if (!find_events_start (pad, type, &i))
+    return;
 
   events = pad->priv->events;
   len = events->len;
 
-  i = 0;
   while (i < len) {
     ev = &g_array_index (events, PadEvent, i);
     if (ev->event == NULL)
@@ -533,11 +704,14 @@ remove_event_by_type (GstPad * pad, GstEventType type)
     g_array_remove_index (events, i);
     len--;
     pad->priv->events_cookie++;
+    removed = TRUE;
     continue;
 
   next:
     i++;
   }
+  if (removed)
+    update_events_index (pad);
 }
 
 /* check all events on srcpad against those on sinkpad. All events that are not
@@ -552,7 +726,8 @@ schedule_events (GstPad * srcpad, GstPad * sinkpad)
   PadEvent *ev;
   gboolean pending = FALSE;
 
-  events = srcpad->priv->events;
+  if (!(events = srcpad->priv->events))
+    return;
   len = events->len;
 
   for (i = 0; i < len; i++) {
@@ -581,10 +756,11 @@ events_foreach (GstPad * pad, PadEventFunction func, gpointer user_data)
   gboolean ret;
   guint cookie;
 
-  events = pad->priv->events;
-
 restart:
+  /* the array is freed when the events are removed */
   cookie = pad->priv->events_cookie;
+  if (!(events = pad->priv->events))
+    return;
   i = 0;
   len = events->len;
   while (i < len) {
@@ -617,6 +793,7 @@ restart:
         /* function unreffed and set the event to NULL, remove it */
         gst_event_unref (ev->event);
         g_array_remove_index (events, i);
+        update_events_index (pad);
         len--;
         cookie = ++pad->priv->events_cookie;
         continue;
@@ -691,11 +868,44 @@ get_pad_caps (GstPad * pad)
   return caps;
 }
 
+/* called with the object lock, also makes a running allocation query not
+ * cache its result */
+static inline void
+clear_allocation_cache (GstPad * pad)
+{
+  gst_query_replace (&pad->priv->allocation_cache, NULL);
+  pad->priv->allocation_cookie++;
+}
+
+/* called with the object lock, same for caps queries */
+static inline void
+clear_caps_cache (GstPad * pad)
+{
+  GstPadPrivate *priv = pad->priv;
+
+  priv->caps_cached = FALSE;
+  gst_caps_replace (&priv->caps_filter, NULL);
+  gst_caps_replace (&priv->caps_result, NULL);
+  gst_caps_replace (&priv->accept_caps, NULL);
+  priv->caps_cookie++;
+}
+
+/* used by ghost pads when their target changes */
+void
+_priv_gst_pad_clear_caps_cache (GstPad * pad)
+{
+  GST_OBJECT_LOCK (pad);
+  clear_caps_cache (pad);
+  GST_OBJECT_UNLOCK (pad);
+}
+
 static void
 gst_pad_dispose (GObject * object)
 {
   GstPad *pad = GST_PAD_CAST (object);
-  GstPad *peer;
+  GstPad *peer, *bypass;
+  GstBufferList *batch;
+  BypassPath path;
 
   GST_CAT_DEBUG_OBJECT (GST_CAT_REFCOUNTING, pad, "dispose");
 
@@ -716,8 +926,25 @@ gst_pad_dispose (GObject * object)
 
   GST_OBJECT_LOCK (pad);
   remove_events (pad);
+  batch = take_batch (pad);
+  clear_queued_events (pad);
+  clear_allocation_cache (pad);
+  clear_caps_cache (pad);
+  bypass = pad->priv->bypass_pad;
+  pad->priv->bypass_pad = NULL;
+  path.n_pads = 0;
+  if (pad->priv->bypass_path) {
+    path = *pad->priv->bypass_path;
+    pad->priv->bypass_path->n_pads = 0;
+  }
   GST_OBJECT_UNLOCK (pad);
 
+  if (batch)
+    gst_buffer_list_unref (batch);
+  if (bypass)
+    gst_object_unref (bypass);
+  bypass_path_clear (&path);
+
   g_hook_list_clear (&pad->probes);
 
   G_OBJECT_CLASS (parent_class)->dispose (object);
@@ -750,6 +977,8 @@ gst_pad_finalize (GObject * object)
     pad->chainlistnotify (pad->chainlistdata);
   if (pad->getrangenotify)
     pad->getrangenotify (pad->getrangedata);
+  if (pad->priv->getrangesnotify)
+    pad->priv->getrangesnotify (pad->priv->getrangesdata);
   if (pad->eventnotify)
     pad->eventnotify (pad->eventdata);
   if (pad->querynotify)
@@ -757,9 +986,12 @@ gst_pad_finalize (GObject * object)
   if (pad->iterintlinknotify)
     pad->iterintlinknotify (pad->iterintlinkdata);
 
-  g_rec_mutex_clear (&pad->stream_rec_lock);
-  g_cond_clear (&pad->block_cond);
-  g_array_free (pad->priv->events, TRUE);
+  _priv_gst_rec_mutex_clear_lazy (&pad->stream_rec_lock);
+  _priv_gst_cond_clear_lazy (&pad->block_cond);
+  if (pad->priv->events)
+    g_array_free (pad->priv->events, TRUE);
+  if (pad->priv->bypass_path)
+    g_slice_free (BypassPath, pad->priv->bypass_path);
 
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
@@ -959,6 +1191,8 @@ gst_pad_mode_get_name (GstPadMode mode)
 static void
 pre_activate (GstPad * pad, GstPadMode new_mode)
 {
+  GstBufferList *batch;
+
   switch (new_mode) {
     case GST_PAD_MODE_NONE:
       GST_OBJECT_LOCK (pad);
@@ -968,7 +1202,11 @@ pre_activate (GstPad * pad, GstPadMode new_mode)
       GST_PAD_MODE (pad) = new_mode;
       /* unlock blocked pads so element can resume and stop */
       GST_PAD_BLOCK_BROADCAST (pad);
+      batch = take_batch (pad);
+      clear_queued_events (pad);
       GST_OBJECT_UNLOCK (pad);
+      if (batch)
+        gst_buffer_list_unref (batch);
       break;
     case GST_PAD_MODE_PUSH:
     case GST_PAD_MODE_PULL:
@@ -1193,6 +1431,9 @@ exit_success:
     GST_OBJECT_LOCK (pad);
     GST_OBJECT_FLAG_UNSET (pad, GST_PAD_FLAG_NEED_RECONFIGURE);
     GST_OBJECT_FLAG_UNSET (pad, GST_PAD_FLAG_EOS);
+    /* downstream might give different pools after the restart */
+    clear_allocation_cache (pad);
+    clear_caps_cache (pad);
     GST_OBJECT_UNLOCK (pad);
   }
 
@@ -1305,6 +1546,30 @@ gst_pad_is_active (GstPad * pad)
   return result;
 }
 
+/* recalculate the masks of installed probes. must be called with the
+ * object lock */
+static void
+update_probe_masks (GstPad * pad)
+{
+  GstPadProbeType mask = 0, block_mask = 0;
+  GHook *hook;
+
+  for (hook = pad->probes.hooks; hook; hook = hook->next) {
+    GstPadProbeType flags;
+
+    if (!G_HOOK_IS_VALID (hook))
+      continue;
+
+    flags = hook->flags >> G_HOOK_FLAG_USER_SHIFT;
+    if (flags & GST_PAD_PROBE_TYPE_BLOCKING)
+      block_mask |= flags;
+    else
+      mask |= flags;
+  }
+  pad->priv->probe_mask = mask;
+  pad->priv->block_probe_mask = block_mask;
+}
+
 static void
 cleanup_hook (GstPad * pad, GHook * hook)
 {
@@ -1331,6 +1596,7 @@ cleanup_hook (GstPad * pad, GHook * hook)
   }
   g_hook_destroy_link (&pad->probes, hook);
   pad->num_probes--;
+  update_probe_masks (pad);
 }
 
 /**
@@ -1395,6 +1661,10 @@ gst_pad_add_probe (GstPad * pad, GstPadProbeType mask,
   /* add the probe */
   g_hook_append (&pad->probes, hook);
   pad->num_probes++;
+  if (mask & GST_PAD_PROBE_TYPE_BLOCKING)
+    pad->priv->block_probe_mask |= mask;
+  else
+    pad->priv->probe_mask |= mask;
   /* incremenent cookie so that the new hook get's called */
   pad->priv->probe_list_cookie++;
 
@@ -1814,6 +2084,47 @@ gst_pad_set_getrange_function_full (GstPad * pad, GstPadGetRangeFunction get,
       GST_DEBUG_FUNCPTR_NAME (get));
 }
 
+/**
+ * gst_pad_set_getranges_function:
+ * @p: a source #GstPad.
+ * @f: the #GstPadGetRangesFunction to set.
+ *
+ * Calls gst_pad_set_getranges_function_full() with %NULL for the user_data
+ * and notify.
+ *
+ * Since: 1.10
+ */
+/**
+ * gst_pad_set_getranges_function_full:
+ * @pad: a source #GstPad.
+ * @get: the #GstPadGetRangesFunction to set.
+ * @user_data: user_data passed to @notify
+ * @notify: notify called when @get will not be used anymore.
+ *
+ * Sets the given getranges function for the pad. It is called when the peer
+ * pulls several ranges at once with gst_pad_pull_ranges(), see
+ * #GstPadGetRangesFunction. The pad still needs a getrange function for
+ * gst_pad_pull_range().
+ *
+ * Since: 1.10
+ */
+void
+gst_pad_set_getranges_function_full (GstPad * pad,
+    GstPadGetRangesFunction get, gpointer user_data, GDestroyNotify notify)
+{
+  g_return_if_fail (GST_IS_PAD (pad));
+  g_return_if_fail (GST_PAD_IS_SRC (pad));
+
+  if (pad->priv->getrangesnotify)
+    pad->priv->getrangesnotify (pad->priv->getrangesdata);
+  pad->priv->getrangesfunc = get;
+  pad->priv->getrangesdata = user_data;
+  pad->priv->getrangesnotify = notify;
+
+  GST_CAT_DEBUG_OBJECT (GST_CAT_PADS, pad, "getrangesfunc set to %s",
+      GST_DEBUG_FUNCPTR_NAME (get));
+}
+
 /**
  * gst_pad_set_event_function:
  * @p: a #GstPad of either direction.
@@ -2056,6 +2367,7 @@ gst_pad_unlink (GstPad * srcpad, GstPad * sinkpad)
 {
   gboolean result = FALSE;
   GstElement *parent = NULL;
+  BypassPath path = { {NULL,}, 0, FALSE };
 
   g_return_val_if_fail (GST_IS_PAD (srcpad), FALSE);
   g_return_val_if_fail (GST_PAD_IS_SRC (srcpad), FALSE);
@@ -2110,10 +2422,22 @@ no_sink_parent:
   /* first clear peers */
   GST_PAD_PEER (srcpad) = NULL;
   GST_PAD_PEER (sinkpad) = NULL;
+  BYPASS_INVALIDATE ();
+
+  clear_caps_cache (srcpad);
+  clear_caps_cache (sinkpad);
+
+  /* don't keep the old peer alive in the bypass path */
+  if (srcpad->priv->using == 0 && srcpad->priv->bypass_path) {
+    path = *srcpad->priv->bypass_path;
+    srcpad->priv->bypass_path->n_pads = 0;
+  }
 
   GST_OBJECT_UNLOCK (sinkpad);
   GST_OBJECT_UNLOCK (srcpad);
 
+  bypass_path_clear (&path);
+
   /* fire off a signal to each of the pads telling them
    * that they've been unlinked */
   g_signal_emit (srcpad, gst_pad_signals[PAD_UNLINKED], 0, sinkpad);
@@ -2466,6 +2790,7 @@ gst_pad_link_full (GstPad * srcpad, GstPad * sinkpad, GstPadLinkCheck flags)
   /* must set peers before calling the link function */
   GST_PAD_PEER (srcpad) = sinkpad;
   GST_PAD_PEER (sinkpad) = srcpad;
+  BYPASS_INVALIDATE ();
 
   /* check events, when something is different, mark pending */
   schedule_events (srcpad, sinkpad);
@@ -2507,6 +2832,8 @@ gst_pad_link_full (GstPad * srcpad, GstPad * sinkpad, GstPadLinkCheck flags)
     if (G_UNLIKELY (result != GST_PAD_LINK_OK))
       goto link_failed;
   }
+  clear_caps_cache (srcpad);
+  clear_caps_cache (sinkpad);
   GST_OBJECT_UNLOCK (sinkpad);
   GST_OBJECT_UNLOCK (srcpad);
 
@@ -3495,10 +3822,43 @@ no_match:
   }
 }
 
+/* check if any of the installed probes could match a probe of @type. This is
+ * the same check as in probe_hook_marshal() but on the union of the masks of
+ * all probes, so it can give false positives but never false negatives.
+ * must be called with the object lock */
+static inline gboolean
+probes_may_match (GstPad * pad, GstPadProbeType type)
+{
+  GstPadProbeType flags;
+
+  /* data flow must wait for idle probes that run from gst_pad_add_probe() */
+  if (G_UNLIKELY (pad->priv->idle_running > 0))
+    return TRUE;
+
+  if (type & GST_PAD_PROBE_TYPE_BLOCKING) {
+    flags = pad->priv->block_probe_mask;
+    if ((flags & GST_PAD_PROBE_TYPE_BLOCKING & type) == 0)
+      return FALSE;
+  } else {
+    flags = pad->priv->probe_mask;
+  }
+  if ((type & GST_PAD_PROBE_TYPE_IDLE) == 0
+      && (flags & GST_PAD_PROBE_TYPE_ALL_BOTH & type) == 0)
+    return FALSE;
+  if ((flags & GST_PAD_PROBE_TYPE_SCHEDULING & type) == 0)
+    return FALSE;
+  if ((type & GST_PAD_PROBE_TYPE_EVENT_FLUSH) &&
+      (flags & GST_PAD_PROBE_TYPE_EVENT_FLUSH & type) == 0)
+    return FALSE;
+
+  return TRUE;
+}
+
 /* a probe that does not take or return any data */
 #define PROBE_NO_DATA(pad,mask,label,defaultval)                \
   G_STMT_START {						\
-    if (G_UNLIKELY (pad->num_probes)) {				\
+    if (G_UNLIKELY (pad->num_probes) &&				\
+        probes_may_match (pad, mask)) {				\
       GstFlowReturn pval = defaultval;				\
       /* pass NULL as the data item */                          \
       GstPadProbeInfo info = { mask, 0, NULL, 0, 0 };		\
@@ -3511,7 +3871,8 @@ no_match:
 
 #define PROBE_FULL(pad,mask,data,offs,size,label,handleable,handle_label) \
   G_STMT_START {							\
-    if (G_UNLIKELY (pad->num_probes)) {					\
+    if (G_UNLIKELY (pad->num_probes) &&					\
+        probes_may_match (pad, mask)) {					\
       /* pass the data item */						\
       GstPadProbeInfo info = { mask, 0, data, offs, size };		\
       info.ABI.abi.flow_ret = GST_FLOW_OK;				\
@@ -3685,6 +4046,60 @@ handled:
   }
 }
 
+/**
+ * gst_pad_set_caps_cache_enabled:
+ * @pad: a #GstPad
+ * @enabled: whether to cache caps query results
+ *
+ * Enable or disable the caching of the results of %GST_QUERY_CAPS and
+ * %GST_QUERY_ACCEPT_CAPS queries on @pad. When enabled, a query with the
+ * same filter or caps as the previous one of its type is answered without
+ * calling the query function of @pad.
+ *
+ * The cache is cleared when @pad is linked, unlinked or deactivated and
+ * when a %GST_EVENT_RECONFIGURE or %GST_EVENT_CAPS event passes @pad. This is mostly useful for
+ * pads that proxy caps queries, like the pads of queues and ghost pads.
+ * Elements whose caps answers change without a reconfigure should not
+ * enable this.
+ *
+ * Since: 1.10
+ */
+void
+gst_pad_set_caps_cache_enabled (GstPad * pad, gboolean enabled)
+{
+  g_return_if_fail (GST_IS_PAD (pad));
+
+  GST_OBJECT_LOCK (pad);
+  pad->priv->caps_cache_enabled = enabled;
+  clear_caps_cache (pad);
+  GST_OBJECT_UNLOCK (pad);
+}
+
+/**
+ * gst_pad_get_caps_cache_enabled:
+ * @pad: a #GstPad
+ *
+ * Check if caps query results are cached on @pad, see
+ * gst_pad_set_caps_cache_enabled().
+ *
+ * Returns: %TRUE if the caps cache is enabled.
+ *
+ * Since: 1.10
+ */
+gboolean
+gst_pad_get_caps_cache_enabled (GstPad * pad)
+{
+  gboolean result;
+
+  g_return_val_if_fail (GST_IS_PAD (pad), FALSE);
+
+  GST_OBJECT_LOCK (pad);
+  result = pad->priv->caps_cache_enabled;
+  GST_OBJECT_UNLOCK (pad);
+
+  return result;
+}
+
 /* pad offsets */
 
 /**
@@ -3865,6 +4280,172 @@ check_sticky (GstPad * pad, GstEvent * event)
 }
 
 
+static void
+copy_allocation_result (GstQuery * dest, GstQuery * src)
+{
+  guint i, n;
+
+  n = gst_query_get_n_allocation_pools (src);
+  for (i = 0; i < n; i++) {
+    GstBufferPool *pool;
+    guint size, min, max;
+
+    gst_query_parse_nth_allocation_pool (src, i, &pool, &size, &min, &max);
+    gst_query_add_allocation_pool (dest, pool, size, min, max);
+    if (pool)
+      gst_object_unref (pool);
+  }
+
+  n = gst_query_get_n_allocation_params (src);
+  for (i = 0; i < n; i++) {
+    GstAllocator *allocator;
+    GstAllocationParams params;
+
+    gst_query_parse_nth_allocation_param (src, i, &allocator, &params);
+    gst_query_add_allocation_param (dest, allocator, &params);
+    if (allocator)
+      gst_object_unref (allocator);
+  }
+
+  n = gst_query_get_n_allocation_metas (src);
+  for (i = 0; i < n; i++) {
+    const GstStructure *params;
+    GType api;
+
+    api = gst_query_parse_nth_allocation_meta (src, i, &params);
+    gst_query_add_allocation_meta (dest, api, params);
+  }
+}
+
+/* called with the object lock, which is released. Answers the allocation
+ * query from the cache of @pad when it was made with the same caps and
+ * need-pool value, or else calls the query function and caches its result.
+ * The pools and arrays are copied so that changes that upstream makes to
+ * its query don't end up in the cache. */
+static gboolean
+query_allocation_cached (GstPad * pad, GstObject * parent, GstQuery * query)
+{
+  GstQuery *cached = NULL;
+  GstPadQueryFunction func;
+  GstCaps *caps, *cached_caps;
+  gboolean need_pool, cached_need_pool, res;
+  guint cookie;
+
+  gst_query_parse_allocation (query, &caps, &need_pool);
+
+  if (pad->priv->allocation_cache) {
+    gst_query_parse_allocation (pad->priv->allocation_cache, &cached_caps,
+        &cached_need_pool);
+    if (need_pool == cached_need_pool && caps && cached_caps &&
+        gst_caps_is_equal (caps, cached_caps))
+      cached = gst_query_ref (pad->priv->allocation_cache);
+  }
+  cookie = pad->priv->allocation_cookie;
+  GST_OBJECT_UNLOCK (pad);
+
+  if (cached) {
+    GST_CAT_DEBUG_OBJECT (GST_CAT_PERFORMANCE, pad,
+        "answering allocation query from the cache");
+    copy_allocation_result (query, cached);
+    gst_query_unref (cached);
+    return TRUE;
+  }
+
+  if ((func = GST_PAD_QUERYFUNC (pad)) == NULL)
+    return FALSE;
+
+  res = func (pad, parent, query);
+
+  if (res && caps) {
+    cached = gst_query_new_allocation (caps, need_pool);
+    copy_allocation_result (cached, query);
+
+    GST_OBJECT_LOCK (pad);
+    if (cookie == pad->priv->allocation_cookie)
+      gst_query_replace (&pad->priv->allocation_cache, cached);
+    GST_OBJECT_UNLOCK (pad);
+    gst_query_unref (cached);
+  }
+  return res;
+}
+
+static inline gboolean
+caps_equal (GstCaps * caps1, GstCaps * caps2)
+{
+  if (caps1 == caps2)
+    return TRUE;
+  if (caps1 == NULL || caps2 == NULL)
+    return FALSE;
+  return gst_caps_is_strictly_equal (caps1, caps2);
+}
+
+/* called with the object lock, which is released. Answers caps and
+ * accept-caps queries from the cache of @pad or else calls the query
+ * function and caches its result. */
+static gboolean
+query_caps_cached (GstPad * pad, GstObject * parent, GstQuery * query)
+{
+  GstPadPrivate *priv = pad->priv;
+  GstPadQueryFunction func;
+  GstCaps *caps, *result = NULL;
+  gboolean res, accepted = FALSE, hit = FALSE;
+  guint cookie;
+
+  if (GST_QUERY_TYPE (query) == GST_QUERY_CAPS) {
+    gst_query_parse_caps (query, &caps);
+    if (priv->caps_cached && caps_equal (caps, priv->caps_filter)) {
+      result = gst_caps_ref (priv->caps_result);
+      hit = TRUE;
+    }
+  } else {
+    gst_query_parse_accept_caps (query, &caps);
+    if (priv->accept_caps && caps_equal (caps, priv->accept_caps)) {
+      accepted = priv->accept_result;
+      hit = TRUE;
+    }
+  }
+  cookie = priv->caps_cookie;
+  GST_OBJECT_UNLOCK (pad);
+
+  if (hit) {
+    GST_CAT_LOG_OBJECT (GST_CAT_PERFORMANCE, pad,
+        "answering %s query from the cache", GST_QUERY_TYPE_NAME (query));
+    if (result) {
+      gst_query_set_caps_result (query, result);
+      gst_caps_unref (result);
+    } else {
+      gst_query_set_accept_caps_result (query, accepted);
+    }
+    return TRUE;
+  }
+
+  if ((func = GST_PAD_QUERYFUNC (pad)) == NULL)
+    return FALSE;
+
+  res = func (pad, parent, query);
+  if (!res)
+    return res;
+
+  GST_OBJECT_LOCK (pad);
+  if (cookie == priv->caps_cookie && priv->caps_cache_enabled) {
+    if (GST_QUERY_TYPE (query) == GST_QUERY_CAPS) {
+      gst_query_parse_caps_result (query, &result);
+      if (result) {
+        gst_caps_replace (&priv->caps_filter, caps);
+        gst_caps_replace (&priv->caps_result, result);
+        priv->caps_cached = TRUE;
+      }
+    } else if (caps) {
+      gst_query_parse_accept_caps_result (query, &accepted);
+      gst_caps_replace (&priv->accept_caps, caps);
+      priv->accept_result = accepted;
+    }
+  }
+  GST_OBJECT_UNLOCK (pad);
+
+  return res;
+}
+
 /**
  * gst_pad_query:
  * @pad: a #GstPad to invoke the default query on.
@@ -3920,6 +4501,16 @@ gst_pad_query (GstPad * pad, GstQuery * query)
   PROBE_PUSH (pad, type | GST_PAD_PROBE_TYPE_PUSH, query, probe_stopped);
 
   ACQUIRE_PARENT (pad, parent, no_parent);
+
+  if (G_UNLIKELY (GST_PAD_IS_CACHE_ALLOCATION (pad))
+      && GST_QUERY_TYPE (query) == GST_QUERY_ALLOCATION)
+    goto allocation_query;
+
+  if (G_UNLIKELY (pad->priv->caps_cache_enabled)
+      && (GST_QUERY_TYPE (query) == GST_QUERY_CAPS
+          || GST_QUERY_TYPE (query) == GST_QUERY_ACCEPT_CAPS))
+    goto caps_query;
+
   GST_OBJECT_UNLOCK (pad);
 
   if ((func = GST_PAD_QUERYFUNC (pad)) == NULL)
@@ -3927,6 +4518,7 @@ gst_pad_query (GstPad * pad, GstQuery * query)
 
   res = func (pad, parent, query);
 
+answered:
   RELEASE_PARENT (parent);
 
   GST_DEBUG_OBJECT (pad, "sent query %p (%s), result %d", query,
@@ -3965,6 +4557,16 @@ no_parent:
       GST_PAD_STREAM_UNLOCK (pad);
     return FALSE;
   }
+allocation_query:
+  {
+    res = query_allocation_cached (pad, parent, query);
+    goto answered;
+  }
+caps_query:
+  {
+    res = query_caps_cached (pad, parent, query);
+    goto answered;
+  }
 no_func:
   {
     GST_DEBUG_OBJECT (pad, "had no query function");
@@ -4180,7 +4782,9 @@ gst_pad_chain_data_unchecked (GstPad * pad, GstPadProbeType type, void *data)
         "calling chainfunction &%s with buffer %" GST_PTR_FORMAT,
         GST_DEBUG_FUNCPTR_NAME (chainfunc), GST_BUFFER (data));
 
+    GST_SDT_PROBE2 (pad_chain, pad, data);
     ret = chainfunc (pad, parent, GST_BUFFER_CAST (data));
+    GST_SDT_PROBE2 (pad_chain_done, pad, ret);
 
     GST_CAT_DEBUG_OBJECT (GST_CAT_SCHEDULING, pad,
         "called chainfunction &%s with buffer %p, returned %s",
@@ -4195,7 +4799,9 @@ gst_pad_chain_data_unchecked (GstPad * pad, GstPadProbeType type, void *data)
         "calling chainlistfunction &%s",
         GST_DEBUG_FUNCPTR_NAME (chainlistfunc));
 
+    GST_SDT_PROBE2 (pad_chain_list, pad, data);
     ret = chainlistfunc (pad, parent, GST_BUFFER_LIST_CAST (data));
+    GST_SDT_PROBE2 (pad_chain_done, pad, ret);
 
     GST_CAT_DEBUG_OBJECT (GST_CAT_SCHEDULING, pad,
         "called chainlistfunction &%s, returned %s",
@@ -4377,14 +4983,226 @@ gst_pad_chain_list (GstPad * pad, GstBufferList * list)
       GST_PAD_PROBE_TYPE_BUFFER_LIST | GST_PAD_PROBE_TYPE_PUSH, list);
 }
 
-static GstFlowReturn
-gst_pad_push_data (GstPad * pad, GstPadProbeType type, void *data)
+/* check if data of @type can skip the pad @pad when it only needs to
+ * be forwarded. must be called with the object lock */
+static inline gboolean
+bypass_allowed (GstPad * pad, GstPadProbeType type)
 {
-  GstPad *peer;
-  GstFlowReturn ret;
-  gboolean handled = FALSE;
+  if (GST_PAD_IS_FLUSHING (pad) || GST_PAD_IS_EOS (pad)
+      || GST_PAD_MODE (pad) != GST_PAD_MODE_PUSH)
+    return FALSE;
 
-  GST_OBJECT_LOCK (pad);
+  if (pad->num_probes || pad->priv->idle_running > 0)
+    return FALSE;
+
+  if (GST_PAD_IS_SRC (pad)) {
+    if (GST_PAD_HAS_PENDING_EVENTS (pad) || GST_PAD_IS_BATCHING (pad)
+        || GST_PAD_PEER (pad) == NULL)
+      return FALSE;
+    /* elements renegotiate when they handle the next buffer themselves */
+    if (!GST_IS_PROXY_PAD (pad) && GST_PAD_NEEDS_RECONFIGURE (pad))
+      return FALSE;
+  } else if (!GST_IS_PROXY_PAD (pad)) {
+    /* the element decides with gst_pad_set_bypass_pad() */
+  } else if (type & GST_PAD_PROBE_TYPE_BUFFER) {
+    if (GST_PAD_CHAINFUNC (pad) != gst_proxy_pad_chain_default)
+      return FALSE;
+  } else {
+    if (GST_PAD_CHAINLISTFUNC (pad) != gst_proxy_pad_chain_list_default)
+      return FALSE;
+  }
+  return TRUE;
+}
+
+/* get the source pad that data reaching the sink pad @pad skips to */
+static inline GstPad *
+bypass_get_target (GstPad * pad)
+{
+  GstPad *target;
+
+  if (GST_IS_PROXY_PAD (pad))
+    return (GstPad *) gst_proxy_pad_get_internal ((GstProxyPad *) pad);
+
+  GST_OBJECT_LOCK (pad);
+  if ((target = pad->priv->bypass_pad))
+    gst_object_ref (target);
+  GST_OBJECT_UNLOCK (pad);
+
+  return target;
+}
+
+static void
+bypass_path_clear (BypassPath * path)
+{
+  while (path->n_pads > 0)
+    gst_object_unref (path->pads[--path->n_pads]);
+}
+
+/* collect the pads with GST_PAD_FLAG_BYPASS that follow the sink pad @peer
+ * in @path, without checking if they can be bypassed right now. Must be
+ * called without locks. */
+static void
+bypass_build_path (GstPad * peer, BypassPath * path)
+{
+  GstPad *sink, *src;
+
+  path->n_pads = 0;
+  path->owned = TRUE;
+
+  sink = gst_object_ref (peer);
+  while (path->n_pads < G_N_ELEMENTS (path->pads) && GST_PAD_IS_BYPASS (sink)) {
+    if ((src = bypass_get_target (sink)) == NULL)
+      break;
+
+    path->pads[path->n_pads++] = sink;
+    path->pads[path->n_pads++] = src;
+
+    GST_OBJECT_LOCK (src);
+    if ((sink = GST_PAD_PEER (src)))
+      gst_object_ref (sink);
+    GST_OBJECT_UNLOCK (src);
+
+    if (sink == NULL)
+      return;
+  }
+  gst_object_unref (sink);
+}
+
+/* get the bypass path for data pushed from @pad to its peer @peer in @path.
+ * The path is cached on @pad until links or bypass pads change. Must be
+ * called without locks while @pad is marked as in use, which keeps the
+ * cached path alive. */
+static void
+bypass_get_path (GstPad * pad, GstPad * peer, BypassPath * path)
+{
+  BypassPath old;
+  guint cookie;
+
+  cookie = g_atomic_int_get (&bypass_cookie);
+
+  GST_OBJECT_LOCK (pad);
+  if (G_LIKELY (pad->priv->bypass_cookie == cookie
+          && pad->priv->bypass_path && pad->priv->bypass_path->n_pads > 0
+          && pad->priv->bypass_path->pads[0] == peer)) {
+    *path = *pad->priv->bypass_path;
+    GST_OBJECT_UNLOCK (pad);
+    return;
+  }
+  GST_OBJECT_UNLOCK (pad);
+
+  bypass_build_path (peer, path);
+
+  GST_CAT_LOG_OBJECT (GST_CAT_SCHEDULING, pad, "bypass path of %u pads",
+      path->n_pads);
+
+  /* only replace the cached path when no other push can be walking it */
+  old.n_pads = 0;
+  GST_OBJECT_LOCK (pad);
+  if (pad->priv->using == 1 && cookie == g_atomic_int_get (&bypass_cookie)
+      && (path->n_pads > 0 || pad->priv->bypass_path)) {
+    if (pad->priv->bypass_path)
+      old = *pad->priv->bypass_path;
+    else
+      pad->priv->bypass_path = g_slice_new (BypassPath);
+    *pad->priv->bypass_path = *path;
+    pad->priv->bypass_path->owned = FALSE;
+    pad->priv->bypass_cookie = cookie;
+    path->owned = FALSE;
+  }
+  GST_OBJECT_UNLOCK (pad);
+
+  bypass_path_clear (&old);
+}
+
+/* follow @path from the sink pad @peer as long as the pads can be bypassed
+ * right now. The skipped source pads are stored in @hops and marked as in
+ * use, and the new peer to chain to is returned. The pads in @path stay
+ * alive while it is used, so only the returned peer needs a ref. Takes
+ * ownership of @peer and must be called without locks. */
+static GstPad *
+bypass_pads (GstPad * peer, GstPadProbeType type, BypassPath * path,
+    GstPad ** hops, guint * n_hops)
+{
+  GstPad *target = peer, *next;
+  gboolean next_owned = FALSE;
+  guint i;
+
+  for (i = 0; i + 1 < path->n_pads && !next_owned; i += 2) {
+    GstPad *sink = path->pads[i], *src = path->pads[i + 1];
+
+    if (sink != target)
+      break;
+
+    GST_OBJECT_LOCK (sink);
+    if (!GST_PAD_IS_BYPASS (sink) || !bypass_allowed (sink, type)
+        || (!GST_IS_PROXY_PAD (sink) && sink->priv->bypass_pad != src)) {
+      GST_OBJECT_UNLOCK (sink);
+      break;
+    }
+    GST_OBJECT_UNLOCK (sink);
+
+    GST_OBJECT_LOCK (src);
+    if (!bypass_allowed (src, type)) {
+      GST_OBJECT_UNLOCK (src);
+      break;
+    }
+    next = GST_PAD_PEER (src);
+    /* the path ends here or was relinked, keep the new peer alive */
+    if (i + 2 >= path->n_pads || next != path->pads[i + 2]) {
+      gst_object_ref (next);
+      next_owned = TRUE;
+    }
+    src->priv->using++;
+    GST_OBJECT_UNLOCK (src);
+
+    GST_CAT_LOG_OBJECT (GST_CAT_SCHEDULING, sink,
+        "bypassing to %s:%s", GST_DEBUG_PAD_NAME (next));
+
+    hops[(*n_hops)++] = src;
+    target = next;
+  }
+
+  if (target != peer) {
+    if (!next_owned)
+      gst_object_ref (target);
+    gst_object_unref (peer);
+  }
+  return target;
+}
+
+/* undo bypass_pads(), store @flowret as the last flow return on the
+ * skipped pads and run their idle probes */
+static void
+bypass_release_pads (GstPad ** hops, guint n_hops, GstFlowReturn flowret)
+{
+  while (n_hops > 0) {
+    GstPad *pad = hops[--n_hops];
+    GstFlowReturn ret;
+
+    GST_OBJECT_LOCK (pad);
+    pad->ABI.abi.last_flowret = flowret;
+    pad->priv->using--;
+    if (pad->priv->using == 0) {
+      /* pad is not active anymore, trigger idle callbacks */
+      PROBE_NO_DATA (pad, GST_PAD_PROBE_TYPE_PUSH | GST_PAD_PROBE_TYPE_IDLE,
+          probe_stopped, flowret);
+    }
+  probe_stopped:
+    GST_OBJECT_UNLOCK (pad);
+  }
+}
+
+static GstFlowReturn
+gst_pad_push_data (GstPad * pad, GstPadProbeType type, void *data)
+{
+  GstPad *peer;
+  GstPad *hops[BYPASS_MAX_HOPS];
+  guint n_hops = 0;
+  BypassPath path;
+  GstFlowReturn ret;
+  gboolean handled = FALSE;
+
+  GST_OBJECT_LOCK (pad);
   if (G_UNLIKELY (GST_PAD_IS_FLUSHING (pad)))
     goto flushing;
 
@@ -4432,11 +5250,23 @@ gst_pad_push_data (GstPad * pad, GstPadProbeType type, void *data)
   pad->priv->using++;
   GST_OBJECT_UNLOCK (pad);
 
+  if (G_UNLIKELY (GST_PAD_IS_BYPASS (peer))) {
+    bypass_get_path (pad, peer, &path);
+    peer = bypass_pads (peer, type, &path, hops, &n_hops);
+  } else {
+    path.owned = FALSE;
+  }
+
   ret = gst_pad_chain_data_unchecked (peer, type, data);
   data = NULL;
 
   gst_object_unref (peer);
 
+  if (G_UNLIKELY (n_hops > 0))
+    bypass_release_pads (hops, n_hops, ret);
+  if (G_UNLIKELY (path.owned))
+    bypass_path_clear (&path);
+
   GST_OBJECT_LOCK (pad);
   pad->ABI.abi.last_flowret = ret;
   pad->priv->using--;
@@ -4519,6 +5349,205 @@ not_linked:
   }
 }
 
+/* add @buffer to the pending batch of @pad and push the batch when one of
+ * the thresholds is reached */
+static GstFlowReturn
+gst_pad_push_batched (GstPad * pad, GstBuffer * buffer)
+{
+  GstPadPrivate *priv = pad->priv;
+  GstBufferList *list = NULL;
+  GstClockTime ts;
+  GstFlowReturn ret;
+
+  GST_OBJECT_LOCK (pad);
+  if (G_UNLIKELY (GST_PAD_IS_FLUSHING (pad) || GST_PAD_IS_EOS (pad)
+          || GST_PAD_MODE (pad) != GST_PAD_MODE_PUSH)) {
+    /* let the normal push path handle the error */
+    list = take_batch (pad);
+    GST_OBJECT_UNLOCK (pad);
+    if (list)
+      gst_buffer_list_unref (list);
+    return gst_pad_push_data (pad,
+        GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_PUSH, buffer);
+  }
+
+  if (priv->batch == NULL)
+    priv->batch = gst_buffer_list_new_sized (MIN (priv->batch_max_buffers,
+            256));
+
+  ts = GST_BUFFER_DTS_OR_PTS (buffer);
+  if (!GST_CLOCK_TIME_IS_VALID (priv->batch_first_ts))
+    priv->batch_first_ts = ts;
+  priv->batch_bytes += gst_buffer_get_size (buffer);
+  gst_buffer_list_add (priv->batch, buffer);
+
+  GST_CAT_LOG_OBJECT (GST_CAT_SCHEDULING, pad, "batched buffer, %u buffers",
+      gst_buffer_list_length (priv->batch));
+
+  if (gst_buffer_list_length (priv->batch) >= priv->batch_max_buffers ||
+      (priv->batch_max_bytes && priv->batch_bytes >= priv->batch_max_bytes) ||
+      (GST_CLOCK_TIME_IS_VALID (priv->batch_max_latency) &&
+          GST_CLOCK_TIME_IS_VALID (ts) &&
+          GST_CLOCK_TIME_IS_VALID (priv->batch_first_ts) &&
+          ts >= priv->batch_first_ts + priv->batch_max_latency))
+    list = take_batch (pad);
+
+  /* report the result of the previous batch until we push this one */
+  ret = pad->ABI.abi.last_flowret;
+  GST_OBJECT_UNLOCK (pad);
+
+  if (list)
+    ret = gst_pad_push_data (pad,
+        GST_PAD_PROBE_TYPE_BUFFER_LIST | GST_PAD_PROBE_TYPE_PUSH, list);
+
+  return ret;
+}
+
+/**
+ * gst_pad_set_batching:
+ * @pad: a source #GstPad
+ * @max_buffers: the maximum number of buffers in a batch, or 0 to disable
+ *     batching
+ * @max_bytes: the maximum number of bytes in a batch, or 0 for no limit
+ * @max_latency: the maximum difference between the timestamps of the first
+ *     and the last buffer of a batch, or #GST_CLOCK_TIME_NONE for no limit
+ *
+ * Configure @pad to collect the buffers pushed with gst_pad_push() into a
+ * #GstBufferList that is pushed to the peer pad as a whole. This reduces the
+ * per-buffer overhead of the push and probe handling, and peer pads with a
+ * chainlist function get called once per batch.
+ *
+ * The pending batch is pushed when one of the limits is reached, before any
+ * serialized event or buffer list is pushed on @pad, and with
+ * gst_pad_push_batch(). It is discarded when @pad is flushed or deactivated.
+ * While a batch is pending, gst_pad_push() returns the result of pushing the
+ * previous batch.
+ *
+ * Probes installed on @pad see the batches as buffer lists.
+ *
+ * Disabling batching pushes the pending batch, this should be done from the
+ * streaming thread or when no data flows on @pad.
+ *
+ * Since: 1.10
+ */
+void
+gst_pad_set_batching (GstPad * pad, guint max_buffers, guint max_bytes,
+    GstClockTime max_latency)
+{
+  g_return_if_fail (GST_IS_PAD (pad));
+  g_return_if_fail (GST_PAD_IS_SRC (pad));
+
+  GST_OBJECT_LOCK (pad);
+  GST_DEBUG_OBJECT (pad, "batching buffers %u, bytes %u, latency %"
+      GST_TIME_FORMAT, max_buffers, max_bytes, GST_TIME_ARGS (max_latency));
+  pad->priv->batch_max_buffers = max_buffers;
+  pad->priv->batch_max_bytes = max_bytes;
+  pad->priv->batch_max_latency = max_latency;
+  if (max_buffers > 0)
+    GST_OBJECT_FLAG_SET (pad, GST_PAD_FLAG_BATCHING);
+  GST_OBJECT_UNLOCK (pad);
+
+  if (max_buffers == 0 && GST_PAD_IS_BATCHING (pad)) {
+    gst_pad_push_batch (pad);
+    GST_OBJECT_FLAG_UNSET (pad, GST_PAD_FLAG_BATCHING);
+  }
+}
+
+/**
+ * gst_pad_push_batch:
+ * @pad: a source #GstPad
+ *
+ * Push the pending batch of buffers of @pad to the peer pad, see
+ * gst_pad_set_batching().
+ *
+ * Returns: a #GstFlowReturn from the peer pad, or %GST_FLOW_OK when there
+ * was no pending batch.
+ *
+ * Since: 1.10
+ */
+GstFlowReturn
+gst_pad_push_batch (GstPad * pad)
+{
+  GstBufferList *list;
+
+  g_return_val_if_fail (GST_IS_PAD (pad), GST_FLOW_ERROR);
+  g_return_val_if_fail (GST_PAD_IS_SRC (pad), GST_FLOW_ERROR);
+
+  GST_OBJECT_LOCK (pad);
+  list = take_batch (pad);
+  GST_OBJECT_UNLOCK (pad);
+
+  if (list == NULL)
+    return GST_FLOW_OK;
+
+  GST_CAT_LOG_OBJECT (GST_CAT_SCHEDULING, pad, "pushing batch of %u buffers",
+      gst_buffer_list_length (list));
+
+  return gst_pad_push_data (pad,
+      GST_PAD_PROBE_TYPE_BUFFER_LIST | GST_PAD_PROBE_TYPE_PUSH, list);
+}
+
+/* make the source pads look up their bypass path again */
+void
+priv_gst_pad_invalidate_bypass (void)
+{
+  BYPASS_INVALIDATE ();
+}
+
+/**
+ * gst_pad_set_bypass_pad:
+ * @pad: a sink #GstPad
+ * @bypass: (allow-none): a source #GstPad of the same element, or %NULL
+ *
+ * Let buffers and buffer lists that are pushed to @pad go directly to the
+ * peer of @bypass, without calling the chain functions of @pad. Elements
+ * use this while they pass all buffers unchanged from @pad to @bypass, for
+ * example a #GstBaseTransform in passthrough mode. %NULL disables the
+ * bypass.
+ *
+ * The bypass is only taken when no probes are installed on @pad and
+ * @bypass, when they are not flushing or EOS and when @bypass has no
+ * pending sticky events and no pending reconfiguration. In all other cases
+ * buffers are chained to @pad as usual. Events and queries are never
+ * bypassed.
+ *
+ * The element must disable the bypass as soon as it needs to see buffers
+ * again. Tracers will not see the push on @bypass.
+ *
+ * Since: 1.10
+ */
+void
+gst_pad_set_bypass_pad (GstPad * pad, GstPad * bypass)
+{
+  GstPad *old;
+
+  g_return_if_fail (GST_IS_PAD (pad));
+  g_return_if_fail (GST_PAD_IS_SINK (pad));
+  g_return_if_fail (!GST_IS_PROXY_PAD (pad));
+  g_return_if_fail (bypass == NULL || GST_IS_PAD (bypass));
+  g_return_if_fail (bypass == NULL || GST_PAD_IS_SRC (bypass));
+
+  if (bypass)
+    gst_object_ref (bypass);
+
+  GST_OBJECT_LOCK (pad);
+  old = pad->priv->bypass_pad;
+  pad->priv->bypass_pad = bypass;
+  BYPASS_INVALIDATE ();
+  if (bypass) {
+    GST_CAT_DEBUG_OBJECT (GST_CAT_SCHEDULING, pad, "bypassing to %s:%s",
+        GST_DEBUG_PAD_NAME (bypass));
+    GST_OBJECT_FLAG_SET (pad, GST_PAD_FLAG_BYPASS);
+  } else {
+    GST_CAT_DEBUG_OBJECT (GST_CAT_SCHEDULING, pad, "bypass disabled");
+    GST_OBJECT_FLAG_UNSET (pad, GST_PAD_FLAG_BYPASS);
+  }
+  GST_OBJECT_UNLOCK (pad);
+
+  if (old)
+    gst_object_unref (old);
+}
+
 /**
  * gst_pad_push:
  * @pad: a source #GstPad, returns #GST_FLOW_ERROR if not.
@@ -4551,8 +5580,15 @@ gst_pad_push (GstPad * pad, GstBuffer * buffer)
   g_return_val_if_fail (GST_IS_BUFFER (buffer), GST_FLOW_ERROR);
 
   GST_TRACER_PAD_PUSH_PRE (pad, buffer);
-  res = gst_pad_push_data (pad,
-      GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_PUSH, buffer);
+  GST_SDT_PROBE2 (pad_push, pad, buffer);
+  if (G_UNLIKELY (pad->priv->queued_events.length))
+    push_queued_events (pad);
+  if (G_UNLIKELY (GST_PAD_IS_BATCHING (pad)))
+    res = gst_pad_push_batched (pad, buffer);
+  else
+    res = gst_pad_push_data (pad,
+        GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_PUSH, buffer);
+  GST_SDT_PROBE2 (pad_push_done, pad, res);
   GST_TRACER_PAD_PUSH_POST (pad, res);
   return res;
 }
@@ -4591,8 +5627,15 @@ gst_pad_push_list (GstPad * pad, GstBufferList * list)
   g_return_val_if_fail (GST_IS_BUFFER_LIST (list), GST_FLOW_ERROR);
 
   GST_TRACER_PAD_PUSH_LIST_PRE (pad, list);
+  GST_SDT_PROBE2 (pad_push_list, pad, list);
+  if (G_UNLIKELY (pad->priv->queued_events.length))
+    push_queued_events (pad);
+  /* keep the order of the buffers */
+  if (G_UNLIKELY (GST_PAD_IS_BATCHING (pad)))
+    gst_pad_push_batch (pad);
   res = gst_pad_push_data (pad,
       GST_PAD_PROBE_TYPE_BUFFER_LIST | GST_PAD_PROBE_TYPE_PUSH, list);
+  GST_SDT_PROBE2 (pad_push_done, pad, res);
   GST_TRACER_PAD_PUSH_LIST_POST (pad, res);
   return res;
 }
@@ -4754,6 +5797,99 @@ get_range_failed:
   }
 }
 
+/* get the ranges from the getranges function of @pad, or one by one when it
+ * has none or when probes need to see each range. @buffers are all NULL. */
+static GstFlowReturn
+gst_pad_get_ranges_unchecked (GstPad * pad, const GstPadRange * ranges,
+    guint n_ranges, GstBuffer ** buffers)
+{
+  GstFlowReturn ret;
+  GstPadGetRangesFunction getrangesfunc;
+  GstObject *parent;
+  guint i;
+
+  GST_PAD_STREAM_LOCK (pad);
+
+  GST_OBJECT_LOCK (pad);
+  if (G_UNLIKELY (GST_PAD_IS_FLUSHING (pad)))
+    goto flushing;
+
+  if (G_UNLIKELY (GST_PAD_MODE (pad) != GST_PAD_MODE_PULL))
+    goto wrong_mode;
+
+  if (G_UNLIKELY ((ret = check_sticky (pad, NULL))) != GST_FLOW_OK)
+    goto events_error;
+
+  getrangesfunc = pad->priv->getrangesfunc;
+  if (getrangesfunc == NULL || pad->num_probes > 0)
+    goto one_by_one;
+
+  ACQUIRE_PARENT (pad, parent, no_parent);
+  GST_OBJECT_UNLOCK (pad);
+
+  GST_CAT_LOG_OBJECT (GST_CAT_SCHEDULING, pad,
+      "calling getrangesfunc %s, %u ranges",
+      GST_DEBUG_FUNCPTR_NAME (getrangesfunc), n_ranges);
+
+  ret = getrangesfunc (pad, parent, ranges, n_ranges, buffers);
+
+  RELEASE_PARENT (parent);
+
+  GST_OBJECT_LOCK (pad);
+  pad->ABI.abi.last_flowret = ret;
+  GST_OBJECT_UNLOCK (pad);
+
+  GST_PAD_STREAM_UNLOCK (pad);
+
+  return ret;
+
+one_by_one:
+  {
+    GST_OBJECT_UNLOCK (pad);
+    /* takes the stream lock again, which is recursive */
+    for (i = 0, ret = GST_FLOW_OK; i < n_ranges && ret == GST_FLOW_OK; i++)
+      ret = gst_pad_get_range_unchecked (pad, ranges[i].offset,
+          ranges[i].size, &buffers[i]);
+    GST_PAD_STREAM_UNLOCK (pad);
+    return ret;
+  }
+  /* ERRORS */
+flushing:
+  {
+    GST_CAT_LOG_OBJECT (GST_CAT_SCHEDULING, pad,
+        "getranges, but pad was flushing");
+    pad->ABI.abi.last_flowret = GST_FLOW_FLUSHING;
+    GST_OBJECT_UNLOCK (pad);
+    GST_PAD_STREAM_UNLOCK (pad);
+    return GST_FLOW_FLUSHING;
+  }
+wrong_mode:
+  {
+    g_critical ("getranges on pad %s:%s but it was not activated in pull mode",
+        GST_DEBUG_PAD_NAME (pad));
+    pad->ABI.abi.last_flowret = GST_FLOW_ERROR;
+    GST_OBJECT_UNLOCK (pad);
+    GST_PAD_STREAM_UNLOCK (pad);
+    return GST_FLOW_ERROR;
+  }
+events_error:
+  {
+    GST_CAT_LOG_OBJECT (GST_CAT_SCHEDULING, pad, "error pushing events");
+    pad->ABI.abi.last_flowret = ret;
+    GST_OBJECT_UNLOCK (pad);
+    GST_PAD_STREAM_UNLOCK (pad);
+    return ret;
+  }
+no_parent:
+  {
+    GST_DEBUG_OBJECT (pad, "no parent");
+    pad->ABI.abi.last_flowret = GST_FLOW_FLUSHING;
+    GST_OBJECT_UNLOCK (pad);
+    GST_PAD_STREAM_UNLOCK (pad);
+    return GST_FLOW_FLUSHING;
+  }
+}
+
 /**
  * gst_pad_get_range:
  * @pad: a src #GstPad, returns #GST_FLOW_ERROR if not.
@@ -4859,6 +5995,7 @@ gst_pad_pull_range (GstPad * pad, guint64 offset, guint size,
           && gst_buffer_get_size (*buffer) >= size), GST_FLOW_ERROR);
 
   GST_TRACER_PAD_PULL_RANGE_PRE (pad, offset, size);
+  GST_SDT_PROBE3 (pad_pull_range, pad, offset, size);
 
   GST_OBJECT_LOCK (pad);
   if (G_UNLIKELY (GST_PAD_IS_FLUSHING (pad)))
@@ -4906,6 +6043,7 @@ probed_data:
 
   *buffer = res_buf;
 
+  GST_SDT_PROBE3 (pad_pull_range_done, pad, *buffer, ret);
   GST_TRACER_PAD_PULL_RANGE_POST (pad, *buffer, ret);
   return ret;
 
@@ -4984,10 +6122,148 @@ probe_stopped_unref:
     goto done;
   }
 done:
+  GST_SDT_PROBE3 (pad_pull_range_done, pad, NULL, ret);
   GST_TRACER_PAD_PULL_RANGE_POST (pad, NULL, ret);
   return ret;
 }
 
+/**
+ * gst_pad_pull_ranges:
+ * @pad: a sink #GstPad, returns GST_FLOW_ERROR if not.
+ * @ranges: (array length=n_ranges): the ranges to pull
+ * @n_ranges: the number of ranges in @ranges
+ * @buffers: (out caller-allocates) (array length=n_ranges): the locations
+ *     for the result buffers
+ *
+ * Pulls a buffer for each range in @ranges from the peer pad. This is the
+ * same as calling gst_pad_pull_range() with a %NULL buffer for each range,
+ * but the pads and the peer element are traversed only once when the peer
+ * pad has a #GstPadGetRangesFunction installed.
+ *
+ * Each range is still pulled separately when probes are installed on @pad
+ * or its peer, so that the probes see every range.
+ *
+ * When this function returns #GST_FLOW_OK, @buffers contains a buffer for
+ * every range. Otherwise the result of the first failed range is returned.
+ * The buffers of the ranges before that one are still valid, the other
+ * elements of @buffers are %NULL. All the returned buffers must be freed
+ * with gst_buffer_unref() after usage.
+ *
+ * Returns: a #GstFlowReturn from the peer pad.
+ *
+ * MT safe.
+ *
+ * Since: 1.10
+ */
+GstFlowReturn
+gst_pad_pull_ranges (GstPad * pad, const GstPadRange * ranges,
+    guint n_ranges, GstBuffer ** buffers)
+{
+  GstPad *peer;
+  GstFlowReturn ret;
+  guint i;
+
+  g_return_val_if_fail (GST_IS_PAD (pad), GST_FLOW_ERROR);
+  g_return_val_if_fail (GST_PAD_IS_SINK (pad), GST_FLOW_ERROR);
+  g_return_val_if_fail (ranges != NULL || n_ranges == 0, GST_FLOW_ERROR);
+  g_return_val_if_fail (buffers != NULL || n_ranges == 0, GST_FLOW_ERROR);
+
+  for (i = 0; i < n_ranges; i++)
+    buffers[i] = NULL;
+
+  GST_OBJECT_LOCK (pad);
+  if (G_UNLIKELY (GST_PAD_IS_FLUSHING (pad)))
+    goto flushing;
+
+  if (G_UNLIKELY (GST_PAD_MODE (pad) != GST_PAD_MODE_PULL))
+    goto wrong_mode;
+
+  if (G_UNLIKELY (pad->num_probes > 0))
+    goto one_by_one;
+
+  if (G_UNLIKELY ((peer = GST_PAD_PEER (pad)) == NULL))
+    goto not_linked;
+
+  gst_object_ref (peer);
+  pad->priv->using++;
+  GST_OBJECT_UNLOCK (pad);
+
+  for (i = 0; i < n_ranges; i++)
+    GST_TRACER_PAD_PULL_RANGE_PRE (pad, ranges[i].offset, ranges[i].size);
+
+  ret = gst_pad_get_ranges_unchecked (peer, ranges, n_ranges, buffers);
+
+  for (i = 0; i < n_ranges; i++)
+    GST_TRACER_PAD_PULL_RANGE_POST (pad, buffers[i],
+        buffers[i] ? GST_FLOW_OK : ret);
+
+  gst_object_unref (peer);
+
+  GST_OBJECT_LOCK (pad);
+  pad->priv->using--;
+  pad->ABI.abi.last_flowret = ret;
+  if (pad->priv->using == 0) {
+    /* pad is not active anymore, trigger idle callbacks */
+    PROBE_NO_DATA (pad, GST_PAD_PROBE_TYPE_PULL | GST_PAD_PROBE_TYPE_IDLE,
+        probe_stopped, ret);
+  }
+  GST_OBJECT_UNLOCK (pad);
+
+  if (G_UNLIKELY (ret != GST_FLOW_OK))
+    GST_CAT_LEVEL_LOG (GST_CAT_SCHEDULING,
+        (ret >= GST_FLOW_EOS) ? GST_LEVEL_INFO : GST_LEVEL_WARNING,
+        pad, "pullranges failed, flow: %s", gst_flow_get_name (ret));
+
+  return ret;
+
+one_by_one:
+  {
+    GST_OBJECT_UNLOCK (pad);
+    for (i = 0, ret = GST_FLOW_OK; i < n_ranges && ret == GST_FLOW_OK; i++)
+      ret = gst_pad_pull_range (pad, ranges[i].offset, ranges[i].size,
+          &buffers[i]);
+    return ret;
+  }
+  /* ERROR recovery here */
+flushing:
+  {
+    GST_CAT_LOG_OBJECT (GST_CAT_SCHEDULING, pad,
+        "pullranges, but pad was flushing");
+    pad->ABI.abi.last_flowret = GST_FLOW_FLUSHING;
+    GST_OBJECT_UNLOCK (pad);
+    return GST_FLOW_FLUSHING;
+  }
+wrong_mode:
+  {
+    g_critical ("pullranges on pad %s:%s but it was not activated in pull mode",
+        GST_DEBUG_PAD_NAME (pad));
+    pad->ABI.abi.last_flowret = GST_FLOW_ERROR;
+    GST_OBJECT_UNLOCK (pad);
+    return GST_FLOW_ERROR;
+  }
+not_linked:
+  {
+    GST_CAT_LOG_OBJECT (GST_CAT_SCHEDULING, pad,
+        "pulling ranges, but it was not linked");
+    pad->ABI.abi.last_flowret = GST_FLOW_NOT_LINKED;
+    GST_OBJECT_UNLOCK (pad);
+    return GST_FLOW_NOT_LINKED;
+  }
+probe_stopped:
+  {
+    GST_CAT_LOG_OBJECT (GST_CAT_SCHEDULING, pad,
+        "idle probe returned %s", gst_flow_get_name (ret));
+    /* like in gst_pad_pull_range(), the buffers are dropped then */
+    if (ret == GST_FLOW_CUSTOM_SUCCESS)
+      ret = GST_FLOW_EOS;
+    pad->ABI.abi.last_flowret = ret;
+    GST_OBJECT_UNLOCK (pad);
+    for (i = 0; i < n_ranges; i++)
+      gst_buffer_replace (&buffers[i], NULL);
+    return ret;
+  }
+}
+
 /* must be called with pad object lock */
 static GstFlowReturn
 store_sticky_event (GstPad * pad, GstEvent * event)
@@ -5024,7 +6300,8 @@ store_sticky_event (GstPad * pad, GstEvent * event)
   if (type & GST_EVENT_TYPE_STICKY_MULTI)
     name = gst_structure_get_name (gst_event_get_structure (event));
 
-  events = pad->priv->events;
+  if (!(events = pad->priv->events))
+    events = pad->priv->events = g_array_new (FALSE, TRUE, sizeof (PadEvent));
   len = events->len;
 
   for (i = 0; i < len; i++) {
@@ -5065,6 +6342,7 @@ store_sticky_event (GstPad * pad, GstEvent * event)
     ev.event = gst_event_ref (event);
     ev.received = FALSE;
     g_array_insert_val (events, i, ev);
+    update_events_index (pad);
     res = TRUE;
   }
 
@@ -5167,6 +6445,7 @@ gst_pad_push_event_unchecked (GstPad * pad, GstEvent * event,
   switch (event_type) {
     case GST_EVENT_FLUSH_START:
       GST_PAD_SET_FLUSHING (pad);
+      clear_queued_events (pad);
 
       GST_PAD_BLOCK_BROADCAST (pad);
       type |= GST_PAD_PROBE_TYPE_EVENT_FLUSH;
@@ -5198,8 +6477,15 @@ gst_pad_push_event_unchecked (GstPad * pad, GstEvent * event,
 
       switch (GST_EVENT_TYPE (event)) {
         case GST_EVENT_RECONFIGURE:
-          if (GST_PAD_IS_SINK (pad))
+          if (GST_PAD_IS_SINK (pad)) {
             GST_OBJECT_FLAG_SET (pad, GST_PAD_FLAG_NEED_RECONFIGURE);
+            /* our answer to the allocation query changes */
+            clear_allocation_cache (pad);
+          }
+          clear_caps_cache (pad);
+          break;
+        case GST_EVENT_CAPS:
+          clear_caps_cache (pad);
           break;
         default:
           break;
@@ -5308,6 +6594,27 @@ idle_probe_stopped:
   }
 }
 
+static gboolean push_event_full (GstPad * pad, GstEvent * event);
+
+/* push the events queued with gst_pad_queue_event() in the streaming
+ * thread. Events are taken one by one so that events queued meanwhile
+ * keep their order */
+static void
+push_queued_events (GstPad * pad)
+{
+  GstEvent *event;
+
+  GST_OBJECT_LOCK (pad);
+  while ((event = g_queue_pop_head (&pad->priv->queued_events))) {
+    GST_OBJECT_UNLOCK (pad);
+    GST_CAT_LOG_OBJECT (GST_CAT_EVENT, pad, "pushing queued %" GST_PTR_FORMAT,
+        event);
+    push_event_full (pad, event);
+    GST_OBJECT_LOCK (pad);
+  }
+  GST_OBJECT_UNLOCK (pad);
+}
+
 /**
  * gst_pad_push_event:
  * @pad: a #GstPad to push the event to.
@@ -5327,12 +6634,73 @@ idle_probe_stopped:
 gboolean
 gst_pad_push_event (GstPad * pad, GstEvent * event)
 {
-  gboolean res = FALSE;
-  GstPadProbeType type;
-  gboolean sticky, serialized;
+  g_return_val_if_fail (GST_IS_PAD (pad), FALSE);
+  g_return_val_if_fail (GST_IS_EVENT (event), FALSE);
+
+  /* queued events go before the next serialized event */
+  if (G_UNLIKELY (pad->priv->queued_events.length)
+      && GST_EVENT_IS_SERIALIZED (event) && GST_PAD_IS_SRC (pad))
+    push_queued_events (pad);
+
+  return push_event_full (pad, event);
+}
 
+/**
+ * gst_pad_queue_event:
+ * @pad: a source #GstPad
+ * @event: (transfer full): a serialized downstream #GstEvent
+ *
+ * Queue @event on @pad. The event is pushed by the streaming thread of
+ * @pad before the next buffer, buffer list or serialized event that is
+ * pushed on @pad, so it keeps its position in the data flow without the
+ * caller having to wait for or take the stream lock.
+ *
+ * This is meant for injecting events, like custom events carrying
+ * metadata, from other threads at a high rate. Queued events are dropped
+ * when @pad is flushed or deactivated. They are not pushed if no more data
+ * flows on @pad.
+ *
+ * Returns: %TRUE if the event was queued, %FALSE if @pad is flushing.
+ *
+ * MT safe.
+ *
+ * Since: 1.10
+ */
+gboolean
+gst_pad_queue_event (GstPad * pad, GstEvent * event)
+{
   g_return_val_if_fail (GST_IS_PAD (pad), FALSE);
+  g_return_val_if_fail (GST_PAD_IS_SRC (pad), FALSE);
   g_return_val_if_fail (GST_IS_EVENT (event), FALSE);
+  g_return_val_if_fail (GST_EVENT_IS_DOWNSTREAM (event)
+      && GST_EVENT_IS_SERIALIZED (event), FALSE);
+
+  GST_OBJECT_LOCK (pad);
+  if (G_UNLIKELY (GST_PAD_IS_FLUSHING (pad)))
+    goto flushing;
+
+  GST_CAT_LOG_OBJECT (GST_CAT_EVENT, pad, "queueing %" GST_PTR_FORMAT, event);
+  g_queue_push_tail (&pad->priv->queued_events, event);
+  GST_OBJECT_UNLOCK (pad);
+
+  return TRUE;
+
+  /* ERRORS */
+flushing:
+  {
+    GST_DEBUG_OBJECT (pad, "We're flushing");
+    GST_OBJECT_UNLOCK (pad);
+    gst_event_unref (event);
+    return FALSE;
+  }
+}
+
+static gboolean
+push_event_full (GstPad * pad, GstEvent * event)
+{
+  gboolean res = FALSE;
+  GstPadProbeType type;
+  gboolean sticky, serialized;
 
   GST_TRACER_PAD_PUSH_EVENT_PRE (pad, event);
 
@@ -5340,6 +6708,21 @@ gst_pad_push_event (GstPad * pad, GstEvent * event)
     if (G_UNLIKELY (!GST_EVENT_IS_DOWNSTREAM (event)))
       goto wrong_direction;
     type = GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM;
+
+    if (G_UNLIKELY (GST_PAD_IS_BATCHING (pad))) {
+      if (GST_EVENT_IS_SERIALIZED (event)) {
+        /* pending buffers go before the event */
+        gst_pad_push_batch (pad);
+      } else if (GST_EVENT_TYPE (event) == GST_EVENT_FLUSH_START) {
+        GstBufferList *batch;
+
+        GST_OBJECT_LOCK (pad);
+        batch = take_batch (pad);
+        GST_OBJECT_UNLOCK (pad);
+        if (batch)
+          gst_buffer_list_unref (batch);
+      }
+    }
   } else if (GST_PAD_IS_SINK (pad)) {
     if (G_UNLIKELY (!GST_EVENT_IS_UPSTREAM (event)))
       goto wrong_direction;
@@ -5519,6 +6902,8 @@ gst_pad_send_event_unchecked (GstPad * pad, GstEvent * event,
     case GST_EVENT_RECONFIGURE:
       if (GST_PAD_IS_SRC (pad))
         GST_OBJECT_FLAG_SET (pad, GST_PAD_FLAG_NEED_RECONFIGURE);
+      /* downstream caps changed */
+      clear_caps_cache (pad);
     default:
       GST_CAT_DEBUG_OBJECT (GST_CAT_EVENT, pad,
           "have event type %" GST_PTR_FORMAT, event);
@@ -5533,6 +6918,10 @@ gst_pad_send_event_unchecked (GstPad * pad, GstEvent * event,
           remove_event_by_type (pad, GST_EVENT_EOS);
           GST_OBJECT_FLAG_UNSET (pad, GST_PAD_FLAG_EOS);
           break;
+        case GST_EVENT_CAPS:
+          /* upstream caps changed */
+          clear_caps_cache (pad);
+          break;
         default:
           break;
       }
@@ -5910,16 +7299,20 @@ do_stream_status (GstPad * pad, GstStreamStatusType type,
         g_free (tname);
       }
 
-      message = gst_message_new_stream_status (GST_OBJECT_CAST (pad),
-          type, parent);
+      /* don't bother creating the message when nobody wants it */
+      if (gst_element_message_will_be_posted (parent,
+              GST_MESSAGE_STREAM_STATUS)) {
+        message = gst_message_new_stream_status (GST_OBJECT_CAST (pad),
+            type, parent);
 
-      g_value_init (&value, GST_TYPE_TASK);
-      g_value_set_object (&value, task);
-      gst_message_set_stream_status_object (message, &value);
-      g_value_unset (&value);
+        g_value_init (&value, GST_TYPE_TASK);
+        g_value_set_object (&value, task);
+        gst_message_set_stream_status_object (message, &value);
+        g_value_unset (&value);
 
-      GST_DEBUG_OBJECT (pad, "posting stream-status %d", type);
-      gst_element_post_message (parent, message);
+        GST_DEBUG_OBJECT (pad, "posting stream-status %d", type);
+        gst_element_post_message (parent, message);
+      }
     }
     gst_object_unref (parent);
   }
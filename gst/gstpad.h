@@ -347,6 +347,51 @@ typedef GstFlowReturn		(*GstPadGetRangeFunction)	(GstPad *pad, GstObject *parent
                                                                  guint64 offset, guint length,
                                                                  GstBuffer **buffer);
 
+/**
+ * GstPadRange:
+ * @offset: the offset of the range
+ * @size: the length of the range
+ *
+ * A byte range requested with gst_pad_pull_ranges().
+ *
+ * Since: 1.10
+ */
+typedef struct {
+  guint64 offset;
+  guint   size;
+} GstPadRange;
+
+/**
+ * GstPadGetRangesFunction:
+ * @pad: the src #GstPad to perform the getranges on.
+ * @parent: (allow-none): the parent of @pad. If the #GST_PAD_FLAG_NEED_PARENT
+ *          flag is set, @parent is guaranteed to be not-%NULL and remain valid
+ *          during the execution of this function.
+ * @ranges: (array length=n_ranges): the requested ranges
+ * @n_ranges: the number of ranges in @ranges
+ * @buffers: (array length=n_ranges): memory locations for the result
+ *           buffers, all pointing to %NULL.
+ *
+ * This function will be called on source pads when a peer element requests
+ * several ranges at once with gst_pad_pull_ranges(). Each range has the
+ * same semantics as the arguments of a #GstPadGetRangeFunction and its
+ * result buffer is stored in the matching element of @buffers.
+ *
+ * Implementations can read all ranges in one go, for example with a
+ * single vectored read. Pads without this function get each range from
+ * their #GstPadGetRangeFunction.
+ *
+ * Returns: #GST_FLOW_OK when all buffers were produced. Otherwise the
+ * result of the first range that failed. The buffers of the ranges before
+ * that one are valid, the others must be left %NULL.
+ *
+ * Since: 1.10
+ */
+typedef GstFlowReturn		(*GstPadGetRangesFunction)	(GstPad *pad, GstObject *parent,
+                                                                 const GstPadRange *ranges,
+                                                                 guint n_ranges,
+                                                                 GstBuffer **buffers);
+
 /**
  * GstPadEventFunction:
  * @pad: the #GstPad to handle the event.
@@ -674,6 +719,18 @@ typedef gboolean  (*GstPadStickyEventsForeachFunction) (GstPad *pad, GstEvent **
  *                      the template pad caps instead of query caps to
  *                      compare with the accept caps. Use this in combination
  *                      with %GST_PAD_FLAG_ACCEPT_INTERSECT. (Since 1.6)
+ * @GST_PAD_FLAG_BATCHING: buffers pushed on the pad are collected in a
+ *                      #GstBufferList before they are pushed to the peer,
+ *                      see gst_pad_set_batching(). (Since 1.10)
+ * @GST_PAD_FLAG_BYPASS: buffers that reach this sink pad are passed directly
+ *                      to the peer of its internal pad for proxy pads, or of
+ *                      the pad set with gst_pad_set_bypass_pad(), when
+ *                      nothing on the skipped pads needs to see them, see
+ *                      also gst_ghost_pad_set_bypass(). (Since 1.10)
+ * @GST_PAD_FLAG_CACHE_ALLOCATION: a sink pad remembers the last successful
+ *                      allocation query and answers the same query with the
+ *                      same result until a RECONFIGURE event is pushed
+ *                      upstream from it or it is deactivated. (Since 1.10)
  * @GST_PAD_FLAG_LAST: offset to define more flags
  *
  * Pad state flags
@@ -692,6 +749,9 @@ typedef enum {
   GST_PAD_FLAG_PROXY_SCHEDULING = (GST_OBJECT_FLAG_LAST << 10),
   GST_PAD_FLAG_ACCEPT_INTERSECT = (GST_OBJECT_FLAG_LAST << 11),
   GST_PAD_FLAG_ACCEPT_TEMPLATE  = (GST_OBJECT_FLAG_LAST << 12),
+  GST_PAD_FLAG_BATCHING         = (GST_OBJECT_FLAG_LAST << 13),
+  GST_PAD_FLAG_BYPASS           = (GST_OBJECT_FLAG_LAST << 14),
+  GST_PAD_FLAG_CACHE_ALLOCATION = (GST_OBJECT_FLAG_LAST << 15),
   /* padding */
   GST_PAD_FLAG_LAST        = (GST_OBJECT_FLAG_LAST << 16)
 } GstPadFlags;
@@ -1206,6 +1266,58 @@ struct _GstPadClass {
  * Since: 1.6
  */
 #define GST_PAD_UNSET_ACCEPT_TEMPLATE(pad) (GST_OBJECT_FLAG_UNSET (pad, GST_PAD_FLAG_ACCEPT_TEMPLATE))
+/**
+ * GST_PAD_IS_BATCHING:
+ * @pad: a #GstPad
+ *
+ * Check if the pad collects pushed buffers in buffer lists, see
+ * gst_pad_set_batching().
+ *
+ * Since: 1.10
+ */
+#define GST_PAD_IS_BATCHING(pad)           (GST_OBJECT_FLAG_IS_SET (pad, GST_PAD_FLAG_BATCHING))
+/**
+ * GST_PAD_IS_BYPASS:
+ * @pad: a #GstPad
+ *
+ * Check if buffers can skip over the pad @pad, see
+ * gst_ghost_pad_set_bypass() and gst_pad_set_bypass_pad().
+ *
+ * Since: 1.10
+ */
+#define GST_PAD_IS_BYPASS(pad)             (GST_OBJECT_FLAG_IS_SET (pad, GST_PAD_FLAG_BYPASS))
+/**
+ * GST_PAD_IS_CACHE_ALLOCATION:
+ * @pad: a #GstPad
+ *
+ * Check if the sink pad @pad answers repeated allocation queries from its
+ * cache.
+ *
+ * Since: 1.10
+ */
+#define GST_PAD_IS_CACHE_ALLOCATION(pad)   (GST_OBJECT_FLAG_IS_SET (pad, GST_PAD_FLAG_CACHE_ALLOCATION))
+/**
+ * GST_PAD_SET_CACHE_ALLOCATION:
+ * @pad: a #GstPad
+ *
+ * Let the sink pad @pad remember the result of the last allocation query
+ * and give it to the next allocation query with the same caps and
+ * need-pool value, without calling the query function. Elements that use
+ * this must push a RECONFIGURE event upstream on @pad when their answer to
+ * the allocation query changes.
+ *
+ * Since: 1.10
+ */
+#define GST_PAD_SET_CACHE_ALLOCATION(pad)  (GST_OBJECT_FLAG_SET (pad, GST_PAD_FLAG_CACHE_ALLOCATION))
+/**
+ * GST_PAD_UNSET_CACHE_ALLOCATION:
+ * @pad: a #GstPad
+ *
+ * Stop answering allocation queries on @pad from the cache.
+ *
+ * Since: 1.10
+ */
+#define GST_PAD_UNSET_CACHE_ALLOCATION(pad) (GST_OBJECT_FLAG_UNSET (pad, GST_PAD_FLAG_CACHE_ALLOCATION))
 /**
  * GST_PAD_GET_STREAM_LOCK:
  * @pad: a #GstPad
@@ -1223,7 +1335,11 @@ struct _GstPadClass {
  * Take the pad's stream lock. The stream lock is recursive and will be taken
  * when buffers or serialized downstream events are pushed on a pad.
  */
+#if !defined (GST_ENABLE_LOCK_TRACING) && !defined (GST_ENABLE_ADAPTIVE_LOCKS)
 #define GST_PAD_STREAM_LOCK(pad)        g_rec_mutex_lock(GST_PAD_GET_STREAM_LOCK(pad))
+#else
+#define GST_PAD_STREAM_LOCK(pad)        _gst_lock_trace_rec_mutex_lock(GST_PAD_GET_STREAM_LOCK(pad), pad, "stream")
+#endif
 /**
  * GST_PAD_STREAM_TRYLOCK:
  * @pad: a #GstPad
@@ -1338,6 +1454,10 @@ void			gst_pad_set_getrange_function_full	(GstPad *pad,
                                                                  GstPadGetRangeFunction get,
                                                                  gpointer user_data,
                                                                  GDestroyNotify notify);
+void			gst_pad_set_getranges_function_full	(GstPad *pad,
+                                                                 GstPadGetRangesFunction get,
+                                                                 gpointer user_data,
+                                                                 GDestroyNotify notify);
 void			gst_pad_set_event_function_full		(GstPad *pad,
                                                                  GstPadEventFunction event,
                                                                  gpointer user_data,
@@ -1352,6 +1472,7 @@ void			gst_pad_set_event_full_function_full	(GstPad *pad,
 #define gst_pad_set_chain_function(p,f)         gst_pad_set_chain_function_full((p),(f),NULL,NULL)
 #define gst_pad_set_chain_list_function(p,f)    gst_pad_set_chain_list_function_full((p),(f),NULL,NULL)
 #define gst_pad_set_getrange_function(p,f)      gst_pad_set_getrange_function_full((p),(f),NULL,NULL)
+#define gst_pad_set_getranges_function(p,f)     gst_pad_set_getranges_function_full((p),(f),NULL,NULL)
 #define gst_pad_set_event_function(p,f)         gst_pad_set_event_function_full((p),(f),NULL,NULL)
 #define gst_pad_set_event_full_function(p,f)    gst_pad_set_event_full_function_full((p),(f),NULL,NULL)
 
@@ -1389,12 +1510,22 @@ GstCaps *		gst_pad_get_allowed_caps		(GstPad * pad);
 gint64                  gst_pad_get_offset                      (GstPad *pad);
 void                    gst_pad_set_offset                      (GstPad *pad, gint64 offset);
 
+void                    gst_pad_set_caps_cache_enabled          (GstPad *pad, gboolean enabled);
+gboolean                gst_pad_get_caps_cache_enabled          (GstPad *pad);
+
 /* data passing functions to peer */
 GstFlowReturn		gst_pad_push				(GstPad *pad, GstBuffer *buffer);
 GstFlowReturn		gst_pad_push_list			(GstPad *pad, GstBufferList *list);
+void			gst_pad_set_batching			(GstPad *pad, guint max_buffers, guint max_bytes,
+								 GstClockTime max_latency);
+GstFlowReturn		gst_pad_push_batch			(GstPad *pad);
 GstFlowReturn		gst_pad_pull_range			(GstPad *pad, guint64 offset, guint size,
 								 GstBuffer **buffer);
+GstFlowReturn		gst_pad_pull_ranges			(GstPad *pad, const GstPadRange *ranges,
+								 guint n_ranges, GstBuffer **buffers);
 gboolean		gst_pad_push_event			(GstPad *pad, GstEvent *event);
+gboolean		gst_pad_queue_event			(GstPad *pad, GstEvent *event);
+void			gst_pad_set_bypass_pad			(GstPad *pad, GstPad *bypass);
 gboolean		gst_pad_event_default			(GstPad *pad, GstObject *parent,
                                                                  GstEvent *event);
 GstFlowReturn           gst_pad_get_last_flow_return            (GstPad *pad);
@@ -396,6 +396,9 @@ gst_pad_template_set_property (GObject * object, guint prop_id,
       break;
     case PROP_CAPS:
       GST_PAD_TEMPLATE_CAPS (object) = g_value_dup_boxed (value);
+      /* the caps of a padtemplate can't be modified after creation */
+      if (GST_PAD_TEMPLATE_CAPS (object))
+        _priv_gst_caps_set_immutable (GST_PAD_TEMPLATE_CAPS (object));
       break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
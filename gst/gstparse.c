@@ -323,7 +323,7 @@ gst_parse_launch_full (const gchar * pipeline_description,
       pipeline_description);
 
   element = priv_gst_parse_launch (pipeline_description, &myerror, context,
-      flags);
+      flags, NULL);
 
   /* don't return partially constructed pipeline if FATAL_ERRORS was given */
   if (G_UNLIKELY (myerror != NULL && element != NULL)) {
@@ -349,3 +349,196 @@ gst_parse_launch_full (const gchar * pipeline_description,
   return NULL;
 #endif
 }
+
+G_DEFINE_BOXED_TYPE (GstParseTemplate, gst_parse_template,
+    (GBoxedCopyFunc) gst_parse_template_ref,
+    (GBoxedFreeFunc) gst_parse_template_unref);
+
+/**
+ * gst_parse_template_new:
+ * @pipeline_description: the command line describing the pipeline
+ * @flags: parsing options, or #GST_PARSE_FLAG_NONE
+ * @error: the error message in case of an erroneous pipeline.
+ *
+ * Parses @pipeline_description once and keeps the element factories,
+ * property values and links it describes, so that many identical pipelines
+ * can be created with gst_parse_template_instantiate() without parsing the
+ * description again.
+ *
+ * Unlike gst_parse_launch_full(), any error is fatal. Descriptions that use
+ * URIs, properties of children of bins or properties holding elements are
+ * accepted but parsed again for every instance.
+ *
+ * Returns: (transfer full): a new #GstParseTemplate, or %NULL on failure.
+ *
+ * Since: 1.10
+ */
+GstParseTemplate *
+gst_parse_template_new (const gchar * pipeline_description,
+    GstParseFlags flags, GError ** error)
+{
+#ifndef GST_DISABLE_PARSE
+  GstParseTemplate *templ;
+  GstElement *element;
+  GError *myerror = NULL;
+
+  g_return_val_if_fail (pipeline_description != NULL, NULL);
+  g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+  GST_CAT_INFO (GST_CAT_PIPELINE, "compiling pipeline description '%s'",
+      pipeline_description);
+
+  templ = g_slice_new0 (GstParseTemplate);
+  templ->refcount = 1;
+  templ->flags = flags | GST_PARSE_FLAG_FATAL_ERRORS;
+  templ->elements = g_array_new (FALSE, FALSE, sizeof (template_element_t));
+  templ->links = g_array_new (FALSE, FALSE, sizeof (template_link_t));
+  templ->index = g_hash_table_new (NULL, NULL);
+
+  element = priv_gst_parse_launch (pipeline_description, &myerror, NULL,
+      templ->flags, templ);
+
+  g_hash_table_destroy (templ->index);
+  templ->index = NULL;
+
+  if (element)
+    gst_object_unref (element);
+
+  if (G_UNLIKELY (myerror != NULL || element == NULL))
+    goto error;
+
+  if (templ->reparse) {
+    GST_CAT_DEBUG (GST_CAT_PIPELINE, "description can't be compiled, it "
+        "will be parsed for every instance");
+    templ->description = g_strdup (pipeline_description);
+  } else {
+    GST_CAT_DEBUG (GST_CAT_PIPELINE, "compiled %u elements and %u links",
+        templ->elements->len, templ->links->len);
+  }
+
+  return templ;
+
+  /* ERRORS */
+error:
+  {
+    if (myerror)
+      g_propagate_error (error, myerror);
+    gst_parse_template_unref (templ);
+    return NULL;
+  }
+#else
+  gchar *msg;
+
+  GST_WARNING ("Disabled API called");
+
+  msg = gst_error_get_message (GST_CORE_ERROR, GST_CORE_ERROR_DISABLED);
+  g_set_error (error, GST_CORE_ERROR, GST_CORE_ERROR_DISABLED, "%s", msg);
+  g_free (msg);
+
+  return NULL;
+#endif
+}
+
+/**
+ * gst_parse_template_ref:
+ * @templ: a #GstParseTemplate
+ *
+ * Increases the refcount of @templ. Templates are immutable and can be
+ * shared between threads.
+ *
+ * Returns: (transfer full): @templ
+ *
+ * Since: 1.10
+ */
+GstParseTemplate *
+gst_parse_template_ref (GstParseTemplate * templ)
+{
+  g_return_val_if_fail (templ != NULL, NULL);
+
+  g_atomic_int_inc (&templ->refcount);
+
+  return templ;
+}
+
+/**
+ * gst_parse_template_unref:
+ * @templ: (transfer full): a #GstParseTemplate
+ *
+ * Decreases the refcount of @templ and frees it when it reaches 0.
+ *
+ * Since: 1.10
+ */
+void
+gst_parse_template_unref (GstParseTemplate * templ)
+{
+#ifndef GST_DISABLE_PARSE
+  guint i, j;
+
+  g_return_if_fail (templ != NULL);
+
+  if (!g_atomic_int_dec_and_test (&templ->refcount))
+    return;
+
+  for (i = 0; i < templ->elements->len; i++) {
+    template_element_t *te =
+        &g_array_index (templ->elements, template_element_t, i);
+
+    for (j = 0; j < te->props->len; j++)
+      g_value_unset (&g_array_index (te->props, template_prop_t, j).value);
+    g_array_free (te->props, TRUE);
+    gst_object_unref (te->factory);
+  }
+  g_array_free (templ->elements, TRUE);
+
+  for (i = 0; i < templ->links->len; i++) {
+    template_link_t *tl = &g_array_index (templ->links, template_link_t, i);
+
+    g_slist_free_full (tl->src_pads, g_free);
+    g_slist_free_full (tl->sink_pads, g_free);
+    if (tl->caps)
+      gst_caps_unref (tl->caps);
+  }
+  g_array_free (templ->links, TRUE);
+
+  g_free (templ->description);
+  g_slice_free (GstParseTemplate, templ);
+#endif
+}
+
+/**
+ * gst_parse_template_instantiate:
+ * @templ: a #GstParseTemplate
+ * @error: the error message in case the pipeline could not be created.
+ *
+ * Creates a new pipeline from @templ. This creates the elements from the
+ * stored factories, sets the stored property values and links them, just
+ * like gst_parse_launch_full() would do for the description of @templ.
+ *
+ * Returns: (transfer floating): a new element on success, %NULL on failure.
+ *
+ * Since: 1.10
+ */
+GstElement *
+gst_parse_template_instantiate (GstParseTemplate * templ, GError ** error)
+{
+#ifndef GST_DISABLE_PARSE
+  g_return_val_if_fail (templ != NULL, NULL);
+  g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+  if (templ->description)
+    return gst_parse_launch_full (templ->description, NULL, templ->flags,
+        error);
+
+  return priv_gst_parse_template_instantiate (templ, error);
+#else
+  gchar *msg;
+
+  GST_WARNING ("Disabled API called");
+
+  msg = gst_error_get_message (GST_CORE_ERROR, GST_CORE_ERROR_DISABLED);
+  g_set_error (error, GST_CORE_ERROR, GST_CORE_ERROR_DISABLED, "%s", msg);
+  g_free (msg);
+
+  return NULL;
+#endif
+}
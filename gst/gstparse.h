@@ -117,8 +117,33 @@ GstElement      * gst_parse_launchv_full (const gchar     ** argv,
                                           GstParseFlags      flags,
                                           GError          ** error) G_GNUC_MALLOC;
 
+/* parse templates */
+
+#define GST_TYPE_PARSE_TEMPLATE (gst_parse_template_get_type())
+
+/**
+ * GstParseTemplate:
+ *
+ * Opaque structure.
+ */
+typedef struct _GstParseTemplate GstParseTemplate;
+
+GType              gst_parse_template_get_type    (void);
+
+GstParseTemplate * gst_parse_template_new         (const gchar      * pipeline_description,
+                                                   GstParseFlags      flags,
+                                                   GError          ** error) G_GNUC_MALLOC;
+
+GstParseTemplate * gst_parse_template_ref         (GstParseTemplate * templ);
+
+void               gst_parse_template_unref       (GstParseTemplate * templ);
+
+GstElement       * gst_parse_template_instantiate (GstParseTemplate * templ,
+                                                   GError          ** error) G_GNUC_MALLOC;
+
 #ifdef G_DEFINE_AUTOPTR_CLEANUP_FUNC
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(GstParseContext, gst_parse_context_free)
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(GstParseTemplate, gst_parse_template_unref)
 #endif
 
 G_END_DECLS
@@ -714,6 +714,7 @@ _priv_gst_plugin_load_file_for_registry (const gchar * filename,
 
   GST_CAT_DEBUG (GST_CAT_PLUGIN_LOADING, "attempt to load plugin \"%s\"",
       filename);
+  GST_TRACER_PLUGIN_LOAD_PRE (filename);
 
   if (!g_module_supported ()) {
     GST_CAT_DEBUG (GST_CAT_PLUGIN_LOADING, "module loading not supported");
@@ -846,6 +847,7 @@ _priv_gst_plugin_load_file_for_registry (const gchar * filename,
     gst_registry_add_plugin (registry, plugin);
   }
 
+  GST_TRACER_PLUGIN_LOAD_POST (filename, plugin);
   g_mutex_unlock (&gst_plugin_loading_mutex);
   return plugin;
 
@@ -853,6 +855,7 @@ return_error:
   {
     if (plugin)
       gst_object_unref (plugin);
+    GST_TRACER_PLUGIN_LOAD_POST (filename, NULL);
     g_mutex_unlock (&gst_plugin_loading_mutex);
     return NULL;
   }
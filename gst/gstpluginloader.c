@@ -65,7 +65,8 @@ static const guint32 loader_protocol_version = 3;
 
 #define GST_CAT_DEFAULT GST_CAT_PLUGIN_LOADING
 
-static GstPluginLoader *plugin_loader_new (GstRegistry * registry);
+static GstPluginLoader *plugin_loader_new (GstRegistry * registry,
+    guint n_scanners);
 static gboolean plugin_loader_free (GstPluginLoader * loader);
 static gboolean plugin_loader_load (GstPluginLoader * loader,
     const gchar * filename, off_t file_size, time_t file_mtime);
@@ -79,11 +80,25 @@ typedef struct _PendingPluginEntry
 {
   /* sequence number */
   guint32 tag;
+  /* position in the whole scan, shared by all scanners of a pool */
+  guint32 seq;
   gchar *filename;
   off_t file_size;
   time_t file_mtime;
 } PendingPluginEntry;
 
+/* Plugin details received by a pooled scanner, merged into the registry
+ * by the pool owner in scan order */
+typedef struct _PluginLoaderResult
+{
+  guint32 seq;
+  PendingPluginEntry *entry;
+  /* copy of the PLUGIN_DETAILS packet. The header space is kept so that the
+   * payload has the same alignment as in the rx buffer */
+  guint8 *packet;
+  guint payload_len;
+} PluginLoaderResult;
+
 struct _GstPluginLoader
 {
   GstRegistry *registry;
@@ -115,6 +130,13 @@ struct _GstPluginLoader
      PendingPluginEntry structs */
   GList *pending_plugins;
   GList *pending_plugins_tail;
+
+  /* Scanner pool. The first loader owns the other ones, hands out the
+   * files and collects the results of all of them */
+  GstPluginLoader *owner;
+  GPtrArray *pool;
+  GArray *results;
+  guint32 next_seq;
 };
 
 #define PACKET_EXIT 1
@@ -136,6 +158,7 @@ static gboolean gst_plugin_loader_spawn (GstPluginLoader * loader);
 static void put_packet (GstPluginLoader * loader, guint type, guint32 tag,
     const guint8 * payload, guint32 payload_len);
 static gboolean exchange_packets (GstPluginLoader * l);
+static gboolean read_one (GstPluginLoader * l);
 static gboolean plugin_loader_replay_pending (GstPluginLoader * l);
 static gboolean plugin_loader_load_and_sync (GstPluginLoader * l,
     PendingPluginEntry * entry);
@@ -145,7 +168,7 @@ static void plugin_loader_cleanup_child (GstPluginLoader * loader);
 static gboolean plugin_loader_sync_with_child (GstPluginLoader * l);
 
 static GstPluginLoader *
-plugin_loader_new (GstRegistry * registry)
+plugin_loader_new_one (GstRegistry * registry)
 {
   GstPluginLoader *l = g_slice_new0 (GstPluginLoader);
 
@@ -166,11 +189,133 @@ plugin_loader_new (GstRegistry * registry)
   return l;
 }
 
+static GstPluginLoader *
+plugin_loader_new (GstRegistry * registry, guint n_scanners)
+{
+  GstPluginLoader *l = plugin_loader_new_one (registry);
+
+  if (n_scanners > 1) {
+    guint i;
+
+    l->pool = g_ptr_array_new ();
+    l->results = g_array_new (FALSE, FALSE, sizeof (PluginLoaderResult));
+
+    for (i = 1; i < n_scanners; i++) {
+      GstPluginLoader *worker = plugin_loader_new_one (registry);
+
+      worker->owner = l;
+      g_ptr_array_add (l->pool, worker);
+    }
+  }
+
+  return l;
+}
+
+static gboolean
+plugin_loader_is_pooled (GstPluginLoader * l)
+{
+  return l->owner != NULL || l->results != NULL;
+}
+
+static void
+plugin_loader_defer_result (GstPluginLoader * l, PendingPluginEntry * entry,
+    const guint8 * payload, guint payload_len)
+{
+  GstPluginLoader *owner = l->owner ? l->owner : l;
+  PluginLoaderResult res = { 0, };
+
+  /* details we can't match with a request are merged last */
+  res.seq = entry ? entry->seq : G_MAXUINT32;
+  if (entry) {
+    res.entry = g_slice_dup (PendingPluginEntry, entry);
+    res.entry->filename = g_strdup (entry->filename);
+  }
+  if (payload_len > 0) {
+    res.packet = g_malloc (HEADER_SIZE + payload_len);
+    memcpy (res.packet + HEADER_SIZE, payload, payload_len);
+    res.payload_len = payload_len;
+  }
+
+  g_array_append_val (owner->results, res);
+}
+
+static gint
+compare_results (gconstpointer a, gconstpointer b)
+{
+  const PluginLoaderResult *ra = a, *rb = b;
+
+  if (ra->seq < rb->seq)
+    return -1;
+  if (ra->seq > rb->seq)
+    return 1;
+  return 0;
+}
+
+/* Add the results of all scanners of the pool to the registry in the order
+ * the files were handed out, which is the order a single scanner would have
+ * registered them in */
+static void
+plugin_loader_merge_results (GstPluginLoader * l)
+{
+  guint i;
+
+  g_array_sort (l->results, compare_results);
+
+  for (i = 0; i < l->results->len; i++) {
+    PluginLoaderResult *res =
+        &g_array_index (l->results, PluginLoaderResult, i);
+
+    if (res->payload_len > 0) {
+      gchar *tmp = (gchar *) res->packet + HEADER_SIZE;
+      GstPlugin *newplugin = NULL;
+
+      if (_priv_gst_registry_chunks_load_plugin (l->registry, &tmp,
+              tmp + res->payload_len, &newplugin, FALSE)) {
+        GST_OBJECT_FLAG_UNSET (newplugin, GST_PLUGIN_FLAG_CACHED);
+        GST_LOG_OBJECT (l->registry,
+            "marking plugin %p as registered as %s", newplugin,
+            newplugin->filename);
+        newplugin->registered = TRUE;
+        l->got_plugin_details = TRUE;
+      } else {
+        /* Not blacklisted, the file is scanned again on the next update */
+        GST_ERROR_OBJECT (l->registry,
+            "Problems loading plugin details for %s from scanner",
+            res->entry ? res->entry->filename : "(unknown)");
+      }
+    } else if (res->entry != NULL) {
+      plugin_loader_create_blacklist_plugin (l, res->entry);
+      l->got_plugin_details = TRUE;
+    }
+
+    if (res->entry) {
+      g_free (res->entry->filename);
+      g_slice_free (PendingPluginEntry, res->entry);
+    }
+    g_free (res->packet);
+  }
+
+  g_array_free (l->results, TRUE);
+  l->results = NULL;
+}
+
 static gboolean
 plugin_loader_free (GstPluginLoader * loader)
 {
   GList *cur;
-  gboolean got_plugin_details;
+  gboolean got_plugin_details = FALSE;
+
+  /* Let the other scanners of the pool finish first, their results are
+   * merged together with ours below */
+  if (loader->pool) {
+    guint i;
+
+    for (i = 0; i < loader->pool->len; i++)
+      got_plugin_details |= plugin_loader_free (g_ptr_array_index (loader->pool,
+              i));
+    g_ptr_array_free (loader->pool, TRUE);
+    loader->pool = NULL;
+  }
 
   fsync (loader->fd_w.fd);
 
@@ -198,10 +343,13 @@ plugin_loader_free (GstPluginLoader * loader)
   g_free (loader->rx_buf);
   g_free (loader->tx_buf);
 
+  if (loader->results)
+    plugin_loader_merge_results (loader);
+
   if (loader->registry)
     gst_object_unref (loader->registry);
 
-  got_plugin_details = loader->got_plugin_details;
+  got_plugin_details |= loader->got_plugin_details;
 
   /* Free any pending plugin entries */
   cur = loader->pending_plugins;
@@ -219,8 +367,8 @@ plugin_loader_free (GstPluginLoader * loader)
 }
 
 static gboolean
-plugin_loader_load (GstPluginLoader * loader, const gchar * filename,
-    off_t file_size, time_t file_mtime)
+plugin_loader_load_one (GstPluginLoader * loader, guint32 seq,
+    const gchar * filename, off_t file_size, time_t file_mtime)
 {
   gint len;
   PendingPluginEntry *entry;
@@ -234,6 +382,7 @@ plugin_loader_load (GstPluginLoader * loader, const gchar * filename,
 
   entry = g_slice_new (PendingPluginEntry);
   entry->tag = loader->next_tag++;
+  entry->seq = seq;
   entry->filename = g_strdup (filename);
   entry->file_size = file_size;
   entry->file_mtime = file_mtime;
@@ -257,6 +406,67 @@ plugin_loader_load (GstPluginLoader * loader, const gchar * filename,
   return TRUE;
 }
 
+/* Read the replies a scanner already has ready, without waiting for the
+ * ones still being worked on */
+static gboolean
+plugin_loader_poll_replies (GstPluginLoader * l)
+{
+  while (l->child_running && !l->rx_done && l->pending_plugins != NULL) {
+    if (gst_poll_wait (l->fdset, 0) <= 0)
+      break;
+
+    if (gst_poll_fd_has_error (l->fdset, &l->fd_r))
+      goto fail_and_cleanup;
+
+    if (gst_poll_fd_can_read (l->fdset, &l->fd_r)) {
+      if (!read_one (l))
+        goto fail_and_cleanup;
+    } else if (gst_poll_fd_has_closed (l->fdset, &l->fd_r)) {
+      goto fail_and_cleanup;
+    } else {
+      break;
+    }
+  }
+
+  return TRUE;
+
+fail_and_cleanup:
+  GST_LOG ("scanner with read fd %d failed", l->fd_r.fd);
+  plugin_loader_cleanup_child (l);
+  return plugin_loader_replay_pending (l);
+}
+
+static gboolean
+plugin_loader_load (GstPluginLoader * loader, const gchar * filename,
+    off_t file_size, time_t file_mtime)
+{
+  GstPluginLoader *target = loader;
+  guint32 seq = loader->next_seq++;
+
+  /* Hand the file to the scanner with the fewest files in flight, after
+   * collecting what the scanners finished in the meantime */
+  if (loader->pool) {
+    guint i, n_pending;
+
+    plugin_loader_poll_replies (loader);
+    n_pending = g_list_length (loader->pending_plugins);
+
+    for (i = 0; i < loader->pool->len && n_pending > 0; i++) {
+      GstPluginLoader *worker = g_ptr_array_index (loader->pool, i);
+      guint n;
+
+      plugin_loader_poll_replies (worker);
+      n = g_list_length (worker->pending_plugins);
+      if (n < n_pending) {
+        target = worker;
+        n_pending = n;
+      }
+    }
+  }
+
+  return plugin_loader_load_one (target, seq, filename, file_size, file_mtime);
+}
+
 static gboolean
 plugin_loader_replay_pending (GstPluginLoader * l)
 {
@@ -275,7 +485,10 @@ restart:
       /* Create dummy plugin entry to block re-scanning this file */
       GST_ERROR ("Plugin file %s failed to load. Blacklisting",
           entry->filename);
-      plugin_loader_create_blacklist_plugin (l, entry);
+      if (plugin_loader_is_pooled (l))
+        plugin_loader_defer_result (l, entry, NULL, 0);
+      else
+        plugin_loader_create_blacklist_plugin (l, entry);
       l->got_plugin_details = TRUE;
       /* Now remove this crashy plugin from the head of the list */
       l->pending_plugins = g_list_delete_link (cur, cur);
@@ -531,7 +744,7 @@ _gst_plugin_loader_client_run (void)
   gboolean res = TRUE;
   GstPluginLoader *l;
 
-  l = plugin_loader_new (NULL);
+  l = plugin_loader_new (NULL, 1);
   if (l == NULL)
     return FALSE;
 
@@ -869,10 +1082,15 @@ handle_rx_packet (GstPluginLoader * l,
       if (cur == NULL)
         l->pending_plugins_tail = NULL;
 
-      if (payload_len > 0) {
+      if (plugin_loader_is_pooled (l)) {
+        if (payload_len > 0 || entry != NULL) {
+          plugin_loader_defer_result (l, entry, payload, payload_len);
+          l->got_plugin_details = TRUE;
+        }
+      } else if (payload_len > 0) {
         GstPlugin *newplugin = NULL;
         if (!_priv_gst_registry_chunks_load_plugin (l->registry, &tmp,
-                tmp + payload_len, &newplugin)) {
+                tmp + payload_len, &newplugin, FALSE)) {
           /* Got garbage from the child, so fail and trigger replay of plugins */
           GST_ERROR_OBJECT (l->registry,
               "Problems loading plugin details with tag %u from scanner", tag);
@@ -29,7 +29,7 @@ G_BEGIN_DECLS
 typedef struct _GstPluginLoader GstPluginLoader;
 
 typedef struct _GstPluginLoaderFuncs {
-  GstPluginLoader * (*create)   (GstRegistry *registry);
+  GstPluginLoader * (*create)   (GstRegistry *registry, guint n_scanners);
   gboolean          (*destroy)  (GstPluginLoader *loader);
   gboolean          (*load)     (GstPluginLoader *loader, const gchar *filename,
                                  off_t file_size, time_t file_mtime);
@@ -82,6 +82,15 @@
 #endif
 #include <sys/time.h>
 #include <sys/socket.h>
+#ifdef HAVE_SYS_EPOLL_H
+#include <sys/epoll.h>
+#endif
+#ifdef HAVE_SYS_EVENTFD_H
+#include <sys/eventfd.h>
+#endif
+#ifdef HAVE_SYS_TIMERFD_H
+#include <sys/timerfd.h>
+#endif
 #endif
 
 /* OS/X needs this because of bad headers */
@@ -117,6 +126,7 @@ typedef enum
   GST_POLL_MODE_PSELECT,
   GST_POLL_MODE_POLL,
   GST_POLL_MODE_PPOLL,
+  GST_POLL_MODE_EPOLL,
   GST_POLL_MODE_WINDOWS
 } GstPollMode;
 
@@ -136,6 +146,20 @@ struct _GstPoll
   gchar buf[1];
   GstPollFD control_read_fd;
   GstPollFD control_write_fd;
+  /* the control fd is an eventfd, read and write fd are the same */
+  gboolean control_eventfd;
+
+  /* epoll instance for non-timer sets or -1. The fds are registered with
+   * their index in the fds array and the fd number */
+  gint epoll_fd;
+  /* events returned by epoll_wait() and the indexes of the active fds that
+   * got their revents set from them */
+  GArray *epoll_events;
+  GArray *epoll_ready;
+  /* timerfd for timeouts that are not a multiple of milliseconds or -1 */
+  gint epoll_timer_fd;
+  /* an fd could not be added to the epoll instance, poll() is used instead */
+  volatile gint epoll_failed;
 #else
   GArray *active_fds_ignored;
   GArray *events;
@@ -155,6 +179,7 @@ struct _GstPoll
 static gboolean gst_poll_fd_ctl_read_unlocked (GstPoll * set, GstPollFD * fd,
     gboolean active);
 static gboolean gst_poll_add_fd_unlocked (GstPoll * set, GstPollFD * fd);
+static GstPoll *gst_poll_new_internal (gboolean controllable, gboolean timer);
 
 #define IS_FLUSHING(s)      (g_atomic_int_get(&(s)->flushing))
 #define SET_FLUSHING(s,val) (g_atomic_int_set(&(s)->flushing, (val)))
@@ -167,8 +192,36 @@ static gboolean gst_poll_add_fd_unlocked (GstPoll * set, GstPollFD * fd);
 #define MARK_REBUILD(s)     (g_atomic_int_set(&(s)->rebuild, 1))
 
 #ifndef G_OS_WIN32
+#ifdef HAVE_SYS_EVENTFD_H
+static inline gboolean
+wake_event (GstPoll * set)
+{
+  if (set->control_eventfd) {
+    guint64 val = 1;
+
+    return write (set->control_write_fd.fd, &val, sizeof (val)) ==
+        sizeof (val);
+  }
+  return write (set->control_write_fd.fd, "W", 1) == 1;
+}
+
+static inline gboolean
+release_event (GstPoll * set)
+{
+  if (set->control_eventfd) {
+    guint64 val;
+
+    return read (set->control_read_fd.fd, &val, sizeof (val)) == sizeof (val);
+  }
+  return read (set->control_read_fd.fd, set->buf, 1) == 1;
+}
+
+#define WAKE_EVENT(s)       (wake_event (s))
+#define RELEASE_EVENT(s)    (release_event (s))
+#else
 #define WAKE_EVENT(s)       (write ((s)->control_write_fd.fd, "W", 1) == 1)
 #define RELEASE_EVENT(s)    (read ((s)->control_read_fd.fd, (s)->buf, 1) == 1)
+#endif
 #else
 #define WAKE_EVENT(s)       (SetLastError (0), SetEvent ((s)->wakeup_event), errno = GetLastError () == NO_ERROR ? 0 : EACCES, errno == 0 ? 1 : 0)
 #define RELEASE_EVENT(s)    (ResetEvent ((s)->wakeup_event))
@@ -316,6 +369,10 @@ choose_mode (GstPoll * set, GstClockTime timeout)
   GstPollMode mode;
 
   if (set->mode == GST_POLL_MODE_AUTO) {
+#ifdef HAVE_SYS_EPOLL_H
+    if (set->epoll_fd >= 0 && !g_atomic_int_get (&set->epoll_failed))
+      return GST_POLL_MODE_EPOLL;
+#endif
 #ifdef HAVE_PPOLL
     mode = GST_POLL_MODE_PPOLL;
 #elif defined(HAVE_POLL)
@@ -397,6 +454,181 @@ fd_set_to_pollfd (GstPoll * set, fd_set * readfds, fd_set * writefds,
 
   g_mutex_unlock (&set->lock);
 }
+
+#ifdef HAVE_SYS_EPOLL_H
+#define EPOLL_DATA(idx,fd)  ((((guint64) (idx)) << 32) | (guint32) (fd))
+#define EPOLL_DATA_IDX(d)   ((guint) ((d) >> 32))
+#define EPOLL_DATA_FD(d)    ((gint) (guint32) (d))
+#define EPOLL_DATA_TIMER    G_MAXUINT64
+
+static guint32
+pollfd_to_epoll_events (gshort events)
+{
+  guint32 res = 0;
+
+  if (events & POLLIN)
+    res |= EPOLLIN;
+  if (events & POLLPRI)
+    res |= EPOLLPRI;
+  if (events & POLLOUT)
+    res |= EPOLLOUT;
+
+  return res;
+}
+
+static gshort
+epoll_to_pollfd_events (guint32 events)
+{
+  gshort res = 0;
+
+  if (events & EPOLLIN)
+    res |= POLLIN;
+  if (events & EPOLLPRI)
+    res |= POLLPRI;
+  if (events & EPOLLOUT)
+    res |= POLLOUT;
+  if (events & EPOLLERR)
+    res |= POLLERR;
+  if (events & EPOLLHUP)
+    res |= POLLHUP;
+
+  return res;
+}
+
+/* add, modify or remove the fd at @idx in the fds array of @set in the epoll
+ * instance. Must be called with the lock */
+static void
+gst_poll_epoll_ctl (GstPoll * set, gint op, guint idx)
+{
+  struct pollfd *pfd = &g_array_index (set->fds, struct pollfd, idx);
+  struct epoll_event ev;
+
+  if (set->epoll_fd < 0 || g_atomic_int_get (&set->epoll_failed))
+    return;
+
+  ev.events = pollfd_to_epoll_events (pfd->events);
+  ev.data.u64 = EPOLL_DATA (idx, pfd->fd);
+
+  if (epoll_ctl (set->epoll_fd, op, pfd->fd, &ev) < 0) {
+    /* the fd was closed before it was removed, epoll already dropped it */
+    if (op == EPOLL_CTL_DEL) {
+      GST_DEBUG ("%p: could not remove fd %d: %s", set, pfd->fd,
+          g_strerror (errno));
+      return;
+    }
+    /* some fds, like regular files, can't be used with epoll, fall back to
+     * poll() for this set. The waiter, if any, keeps using epoll until it is
+     * restarted. */
+    GST_INFO ("%p: can't use epoll for fd %d: %s", set, pfd->fd,
+        g_strerror (errno));
+    g_atomic_int_set (&set->epoll_failed, 1);
+    MARK_REBUILD (set);
+  }
+}
+
+/* wait for activity on the epoll instance and update the revents of the
+ * active fds. Only the fds that had activity are touched. */
+static gint
+gst_poll_epoll_wait (GstPoll * set, GstClockTime timeout)
+{
+  struct epoll_event *events;
+  guint i, max_events;
+  gboolean timer_armed = FALSE;
+  gint t, res, n_events;
+
+  /* clear the revents of the previous wait, the active fds are not copied
+   * again from the fds when they did not change */
+  for (i = 0; i < set->epoll_ready->len; i++) {
+    guint idx = g_array_index (set->epoll_ready, guint, i);
+
+    if (idx < set->active_fds->len)
+      g_array_index (set->active_fds, struct pollfd, idx).revents = 0;
+  }
+  g_array_set_size (set->epoll_ready, 0);
+
+  if (timeout == GST_CLOCK_TIME_NONE) {
+    t = -1;
+  } else if (timeout % GST_MSECOND == 0 || set->epoll_timer_fd < 0) {
+    /* round up, we should not return before the timeout */
+    t = MIN ((timeout + GST_MSECOND - 1) / GST_MSECOND, G_MAXINT);
+  } else {
+#ifdef HAVE_SYS_TIMERFD_H
+    struct itimerspec its = { {0,}, };
+
+    GST_TIME_TO_TIMESPEC (timeout, its.it_value);
+    if (timerfd_settime (set->epoll_timer_fd, 0, &its, NULL) == 0) {
+      timer_armed = TRUE;
+      t = -1;
+    } else
+#endif
+      t = MIN ((timeout + GST_MSECOND - 1) / GST_MSECOND, G_MAXINT);
+  }
+
+  /* one extra for the timer fd */
+  max_events = MAX (set->active_fds->len, 1) + 1;
+  g_array_set_size (set->epoll_events, max_events);
+  events = (struct epoll_event *) set->epoll_events->data;
+
+  n_events = epoll_wait (set->epoll_fd, events, max_events, t);
+  if (n_events < 0) {
+    res = -1;
+    goto done;
+  }
+
+  res = 0;
+  for (i = 0; i < n_events; i++) {
+    guint64 data = events[i].data.u64;
+    struct pollfd *pfd;
+    guint idx;
+
+    if (data == EPOLL_DATA_TIMER) {
+      guint64 expirations;
+
+      /* timeout expired, clear the timer */
+      if (read (set->epoll_timer_fd, &expirations, sizeof (expirations)) < 0)
+        GST_LOG ("%p: could not read timer fd", set);
+      timer_armed = FALSE;
+      continue;
+    }
+
+    /* the fds might have changed after the active fds were copied, check
+     * the index and look the fd up when needed */
+    idx = EPOLL_DATA_IDX (data);
+    if (idx >= set->active_fds->len ||
+        g_array_index (set->active_fds, struct pollfd, idx).fd !=
+        EPOLL_DATA_FD (data)) {
+      for (idx = 0; idx < set->active_fds->len; idx++) {
+        if (g_array_index (set->active_fds, struct pollfd, idx).fd ==
+            EPOLL_DATA_FD (data))
+          break;
+      }
+      if (idx == set->active_fds->len)
+        continue;
+    }
+
+    pfd = &g_array_index (set->active_fds, struct pollfd, idx);
+    pfd->revents = epoll_to_pollfd_events (events[i].events) &
+        (pfd->events | POLLERR | POLLHUP);
+    if (pfd->revents) {
+      g_array_append_val (set->epoll_ready, idx);
+      res++;
+    }
+  }
+
+done:
+  if (timer_armed) {
+#ifdef HAVE_SYS_TIMERFD_H
+    struct itimerspec its = { {0,}, };
+
+    /* disarm, we did not wait for the timeout */
+    timerfd_settime (set->epoll_timer_fd, 0, &its, NULL);
+#endif
+  }
+
+  return res;
+}
+#endif
+
 #else /* G_OS_WIN32 */
 /*
  * Translate errors thrown by the Winsock API used by GstPoll:
@@ -550,6 +782,12 @@ gst_poll_collect_winsock_events (GstPoll * set)
  */
 GstPoll *
 gst_poll_new (gboolean controllable)
+{
+  return gst_poll_new_internal (controllable, FALSE);
+}
+
+static GstPoll *
+gst_poll_new_internal (gboolean controllable, gboolean timer)
 {
   GstPoll *nset;
 
@@ -562,6 +800,43 @@ gst_poll_new (gboolean controllable)
   nset->active_fds = g_array_new (FALSE, FALSE, sizeof (struct pollfd));
   nset->control_read_fd.fd = -1;
   nset->control_write_fd.fd = -1;
+  nset->epoll_fd = -1;
+  nset->epoll_timer_fd = -1;
+#ifdef HAVE_SYS_EPOLL_H
+  /* timers only wait on the control fd, possibly from multiple threads, so
+   * they keep using ppoll() with its nanosecond timeouts */
+  if (!timer) {
+    nset->epoll_fd = epoll_create1 (EPOLL_CLOEXEC);
+    if (nset->epoll_fd >= 0) {
+#ifdef HAVE_SYS_TIMERFD_H
+      nset->epoll_timer_fd = timerfd_create (CLOCK_MONOTONIC,
+          TFD_NONBLOCK | TFD_CLOEXEC);
+      if (nset->epoll_timer_fd >= 0) {
+        struct epoll_event ev;
+
+        ev.events = EPOLLIN;
+        ev.data.u64 = EPOLL_DATA_TIMER;
+        if (epoll_ctl (nset->epoll_fd, EPOLL_CTL_ADD, nset->epoll_timer_fd,
+                &ev) < 0) {
+          close (nset->epoll_timer_fd);
+          nset->epoll_timer_fd = -1;
+        }
+      }
+#endif
+      nset->epoll_events =
+          g_array_new (FALSE, FALSE, sizeof (struct epoll_event));
+      nset->epoll_ready = g_array_new (FALSE, FALSE, sizeof (guint));
+      GST_DEBUG ("%p: using epoll", nset);
+    }
+  }
+#endif
+#ifdef HAVE_SYS_EVENTFD_H
+  nset->control_read_fd.fd = eventfd (0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (nset->control_read_fd.fd >= 0) {
+    nset->control_write_fd.fd = nset->control_read_fd.fd;
+    nset->control_eventfd = TRUE;
+  } else
+#endif
   {
     gint control_sock[2];
 
@@ -573,10 +848,9 @@ gst_poll_new (gboolean controllable)
 
     nset->control_read_fd.fd = control_sock[0];
     nset->control_write_fd.fd = control_sock[1];
-
-    gst_poll_add_fd_unlocked (nset, &nset->control_read_fd);
-    gst_poll_fd_ctl_read_unlocked (nset, &nset->control_read_fd, TRUE);
   }
+  gst_poll_add_fd_unlocked (nset, &nset->control_read_fd);
+  gst_poll_fd_ctl_read_unlocked (nset, &nset->control_read_fd, TRUE);
 #else
   nset->mode = GST_POLL_MODE_WINDOWS;
   nset->fds = g_array_new (FALSE, FALSE, sizeof (WinsockFd));
@@ -592,6 +866,7 @@ gst_poll_new (gboolean controllable)
   MARK_REBUILD (nset);
 
   nset->controllable = controllable;
+  nset->timer = timer;
 
   return nset;
 
@@ -623,17 +898,8 @@ no_socket_pair:
 GstPoll *
 gst_poll_new_timer (void)
 {
-  GstPoll *poll;
-
-  /* make a new controllable poll set */
-  if (!(poll = gst_poll_new (TRUE)))
-    goto done;
-
-  /* we are a timer */
-  poll->timer = TRUE;
-
-done:
-  return poll;
+  /* make a new controllable poll set, we are a timer */
+  return gst_poll_new_internal (TRUE, TRUE);
 }
 
 /**
@@ -650,10 +916,18 @@ gst_poll_free (GstPoll * set)
   GST_DEBUG ("%p: freeing", set);
 
 #ifndef G_OS_WIN32
-  if (set->control_write_fd.fd >= 0)
+  if (set->control_write_fd.fd >= 0 && !set->control_eventfd)
     close (set->control_write_fd.fd);
   if (set->control_read_fd.fd >= 0)
     close (set->control_read_fd.fd);
+  if (set->epoll_timer_fd >= 0)
+    close (set->epoll_timer_fd);
+  if (set->epoll_fd >= 0)
+    close (set->epoll_fd);
+  if (set->epoll_events)
+    g_array_free (set->epoll_events, TRUE);
+  if (set->epoll_ready)
+    g_array_free (set->epoll_ready, TRUE);
 #else
   CloseHandle (set->wakeup_event);
 
@@ -737,6 +1011,9 @@ gst_poll_add_fd_unlocked (GstPoll * set, GstPollFD * fd)
     g_array_append_val (set->fds, nfd);
 
     fd->idx = set->fds->len - 1;
+#ifdef HAVE_SYS_EPOLL_H
+    gst_poll_epoll_ctl (set, EPOLL_CTL_ADD, fd->idx);
+#endif
 #else
     WinsockFd wfd;
     HANDLE event;
@@ -818,10 +1095,20 @@ gst_poll_remove_fd (GstPoll * set, GstPollFD * fd)
     g_array_remove_index_fast (set->events, idx);
 #endif
 
+#ifdef HAVE_SYS_EPOLL_H
+    gst_poll_epoll_ctl (set, EPOLL_CTL_DEL, idx);
+#endif
+
     /* remove the fd at index, we use _remove_index_fast, which copies the last
      * element of the array to the freed index */
     g_array_remove_index_fast (set->fds, idx);
 
+#ifdef HAVE_SYS_EPOLL_H
+    /* the last fd moved to the freed index, update its registration */
+    if (idx < set->fds->len)
+      gst_poll_epoll_ctl (set, EPOLL_CTL_MOD, idx);
+#endif
+
     /* mark fd as removed by setting the index to -1 */
     fd->idx = -1;
     MARK_REBUILD (set);
@@ -870,6 +1157,9 @@ gst_poll_fd_ctl_write (GstPoll * set, GstPollFD * fd, gboolean active)
       pfd->events &= ~POLLOUT;
 
     GST_LOG ("%p: pfd->events now %d (POLLOUT:%d)", set, pfd->events, POLLOUT);
+#ifdef HAVE_SYS_EPOLL_H
+    gst_poll_epoll_ctl (set, EPOLL_CTL_MOD, idx);
+#endif
 #else
     gst_poll_update_winsock_event_mask (set, idx, FD_WRITE | FD_CONNECT,
         active);
@@ -902,6 +1192,9 @@ gst_poll_fd_ctl_read_unlocked (GstPoll * set, GstPollFD * fd, gboolean active)
       pfd->events |= (POLLIN | POLLPRI);
     else
       pfd->events &= ~(POLLIN | POLLPRI);
+#ifdef HAVE_SYS_EPOLL_H
+    gst_poll_epoll_ctl (set, EPOLL_CTL_MOD, idx);
+#endif
 #else
     gst_poll_update_winsock_event_mask (set, idx, FD_READ | FD_ACCEPT, active);
 #endif
@@ -1232,6 +1525,16 @@ gst_poll_wait (GstPoll * set, GstClockTime timeout)
       case GST_POLL_MODE_AUTO:
         g_assert_not_reached ();
         break;
+      case GST_POLL_MODE_EPOLL:
+      {
+#ifdef HAVE_SYS_EPOLL_H
+        res = gst_poll_epoll_wait (set, timeout);
+#else
+        g_assert_not_reached ();
+        errno = ENOSYS;
+#endif
+        break;
+      }
       case GST_POLL_MODE_PPOLL:
       {
 #ifdef HAVE_PPOLL
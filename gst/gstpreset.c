@@ -105,6 +105,43 @@ static GQuark preset_app_path_quark = 0;
 static GQuark preset_system_path_quark = 0;
 static GQuark preset_quark = 0;
 
+/* how often the preset files are checked for changes */
+#define PRESET_CHECK_INTERVAL G_USEC_PER_SEC
+
+/* a preset file, for detecting changes */
+typedef struct
+{
+  gchar *path;
+  gint64 mtime;                 /* -1 if the file does not exist */
+  gint64 size;
+} PresetFile;
+
+/* a property value of a preset */
+typedef struct
+{
+  gchar *name;
+  GValue value;
+} PresetValue;
+
+/* the parsed presets of an element type, set as qdata on the type */
+typedef struct
+{
+  GKeyFile *presets;
+  /* keyfiles replaced after the files changed, other threads might still
+   * use them */
+  GList *old_presets;
+
+  /* the files the presets were read from */
+  GArray *files;
+  gint64 last_check;
+
+  /* preset name -> GArray of PresetValue, the deserialized values */
+  GHashTable *values;
+} PresetCache;
+
+/* protects the PresetCache */
+static GMutex preset_lock;
+
 /* the application can set a custom path that is checked in addition to standard
  * system and user dirs. This helps to develop new presets first local to the
  * application.
@@ -369,139 +406,330 @@ compare_preset_and_version (gconstpointer a, gconstpointer b,
     return 0;
 }
 
-/* reads the user and system presets files and merges them together. This
- * function caches the GKeyFile on the element type. If there is no existing
- * preset file, a new in-memory GKeyFile will be created. */
-static GKeyFile *
-preset_get_keyfile (GstPreset * preset)
+static gint64
+preset_file_stat (const gchar * path, gint64 * size)
 {
-  GKeyFile *presets;
-  GType type = G_TYPE_FROM_INSTANCE (preset);
+  GStatBuf st;
 
-  /* first see if the have a cached version for the type */
-  if (!(presets = g_type_get_qdata (type, preset_quark))) {
-    const gchar *preset_user_path, *preset_app_path, *preset_system_path;
-    guint64 version_system = G_GUINT64_CONSTANT (0);
-    guint64 version_app = G_GUINT64_CONSTANT (0);
-    guint64 version_user = G_GUINT64_CONSTANT (0);
-    guint64 version = G_GUINT64_CONSTANT (0);
-    gboolean merged = FALSE;
-    GKeyFile *in_user, *in_app = NULL, *in_system;
-    GQueue in_env = G_QUEUE_INIT;
-    gboolean have_env = FALSE;
-    const gchar *envvar;
-
-    /* try to load the user, app and system presets, we do this to get the
-     * versions of all files. */
-    preset_get_paths (preset, &preset_user_path, &preset_app_path,
-        &preset_system_path);
-    in_user = preset_open_and_parse_header (preset, preset_user_path,
-        &version_user);
-
-    if (preset_app_path) {
-      in_app = preset_open_and_parse_header (preset, preset_app_path,
-          &version_app);
-    }
+  if (g_stat (path, &st) != 0) {
+    *size = 0;
+    return -1;
+  }
+  *size = st.st_size;
+  return st.st_mtime;
+}
 
-    envvar = g_getenv ("GST_PRESET_PATH");
-    if (envvar) {
-      gint i;
-      gchar **preset_dirs = g_strsplit (envvar, G_SEARCHPATH_SEPARATOR_S, -1);
-
-      for (i = 0; preset_dirs[i]; i++) {
-        gchar *preset_path = g_strdup_printf ("%s" G_DIR_SEPARATOR_S "%s.prs",
-            preset_dirs[i], G_OBJECT_TYPE_NAME (preset));
-        GKeyFile *env_file;
-        guint64 env_version;
-
-        env_file = preset_open_and_parse_header (preset, preset_path,
-            &env_version);
-        g_free (preset_path);
-        if (env_file) {
-          PresetAndVersion *pv = g_new (PresetAndVersion, 1);
-          pv->preset = env_file;
-          pv->version = env_version;
-          g_queue_push_tail (&in_env, pv);
-          have_env = TRUE;
-        }
-      }
-      g_strfreev (preset_dirs);
+/* call with the preset lock */
+static void
+preset_cache_add_file (PresetCache * cache, const gchar * path)
+{
+  PresetFile file;
+
+  file.path = g_strdup (path);
+  file.mtime = preset_file_stat (path, &file.size);
+  g_array_append_val (cache->files, file);
+}
+
+/* call with the preset lock */
+static void
+preset_cache_update_file (PresetCache * cache, const gchar * path)
+{
+  PresetFile *file;
+  guint i;
+
+  for (i = 0; i < cache->files->len; i++) {
+    file = &g_array_index (cache->files, PresetFile, i);
+    if (!strcmp (file->path, path)) {
+      file->mtime = preset_file_stat (path, &file->size);
+      return;
     }
+  }
+  preset_cache_add_file (cache, path);
+}
 
-    in_system = preset_open_and_parse_header (preset, preset_system_path,
-        &version_system);
+/* call with the preset lock */
+static gboolean
+preset_cache_is_stale (PresetCache * cache)
+{
+  PresetFile *file;
+  gint64 now, mtime, size;
+  guint i;
 
-    /* compare version to check for merge */
-    if (in_system) {
-      presets = in_system;
-      version = version_system;
+  now = g_get_monotonic_time ();
+  if (now - cache->last_check < PRESET_CHECK_INTERVAL)
+    return FALSE;
+  cache->last_check = now;
+
+  for (i = 0; i < cache->files->len; i++) {
+    file = &g_array_index (cache->files, PresetFile, i);
+    mtime = preset_file_stat (file->path, &size);
+    if (mtime != file->mtime || size != file->size) {
+      GST_INFO ("preset file %s changed", file->path);
+      return TRUE;
     }
+  }
+  return FALSE;
+}
 
-    if (have_env) {
-      GList *l;
-
-      /* merge the ones from the environment paths. If any of them has a
-       * higher version, take that as the "master" version. Lower versions are
-       * then just merged in. */
-      g_queue_sort (&in_env, compare_preset_and_version, NULL);
-      /* highest version to lowest */
-      for (l = in_env.head; l; l = l->next) {
-        PresetAndVersion *pv = l->data;
-
-        if (version > pv->version) {
-          preset_merge (presets, pv->preset);
-          g_key_file_free (pv->preset);
-        } else {
-          if (presets)
-            g_key_file_free (presets);
-          presets = pv->preset;
-          version = pv->version;
-        }
-        g_free (pv);
+static void
+preset_file_clear (PresetFile * file)
+{
+  g_free (file->path);
+}
+
+static void
+preset_value_clear (PresetValue * value)
+{
+  g_free (value->name);
+  g_value_unset (&value->value);
+}
+
+static PresetCache *
+preset_cache_new (void)
+{
+  PresetCache *cache = g_new0 (PresetCache, 1);
+
+  cache->files = g_array_new (FALSE, FALSE, sizeof (PresetFile));
+  g_array_set_clear_func (cache->files, (GDestroyNotify) preset_file_clear);
+  cache->values = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+      (GDestroyNotify) g_array_unref);
+  cache->last_check = g_get_monotonic_time ();
+
+  return cache;
+}
+
+/* reads the user and system presets files and merges them together. If there
+ * is no existing preset file, a new in-memory GKeyFile will be created. The
+ * files are added to @cache. Call with the preset lock. */
+static GKeyFile *
+preset_load_keyfile (GstPreset * preset, PresetCache * cache,
+    gboolean * merged_out)
+{
+  GKeyFile *presets = NULL;
+  const gchar *preset_user_path, *preset_app_path, *preset_system_path;
+  guint64 version_system = G_GUINT64_CONSTANT (0);
+  guint64 version_app = G_GUINT64_CONSTANT (0);
+  guint64 version_user = G_GUINT64_CONSTANT (0);
+  guint64 version = G_GUINT64_CONSTANT (0);
+  gboolean merged = FALSE;
+  GKeyFile *in_user, *in_app = NULL, *in_system;
+  GQueue in_env = G_QUEUE_INIT;
+  gboolean have_env = FALSE;
+  const gchar *envvar;
+
+  /* try to load the user, app and system presets, we do this to get the
+   * versions of all files. */
+  preset_get_paths (preset, &preset_user_path, &preset_app_path,
+      &preset_system_path);
+  in_user = preset_open_and_parse_header (preset, preset_user_path,
+      &version_user);
+  preset_cache_add_file (cache, preset_user_path);
+
+  if (preset_app_path) {
+    in_app = preset_open_and_parse_header (preset, preset_app_path,
+        &version_app);
+    preset_cache_add_file (cache, preset_app_path);
+  }
+
+  envvar = g_getenv ("GST_PRESET_PATH");
+  if (envvar) {
+    gint i;
+    gchar **preset_dirs = g_strsplit (envvar, G_SEARCHPATH_SEPARATOR_S, -1);
+
+    for (i = 0; preset_dirs[i]; i++) {
+      gchar *preset_path = g_strdup_printf ("%s" G_DIR_SEPARATOR_S "%s.prs",
+          preset_dirs[i], G_OBJECT_TYPE_NAME (preset));
+      GKeyFile *env_file;
+      guint64 env_version;
+
+      env_file = preset_open_and_parse_header (preset, preset_path,
+          &env_version);
+      preset_cache_add_file (cache, preset_path);
+      g_free (preset_path);
+      if (env_file) {
+        PresetAndVersion *pv = g_new (PresetAndVersion, 1);
+        pv->preset = env_file;
+        pv->version = env_version;
+        g_queue_push_tail (&in_env, pv);
+        have_env = TRUE;
       }
-      g_queue_clear (&in_env);
     }
+    g_strfreev (preset_dirs);
+  }
+
+  in_system = preset_open_and_parse_header (preset, preset_system_path,
+      &version_system);
+  preset_cache_add_file (cache, preset_system_path);
 
-    if (in_app) {
-      /* if system/env version is higher, merge */
-      if (version > version_app) {
-        preset_merge (presets, in_app);
-        g_key_file_free (in_app);
+  /* compare version to check for merge */
+  if (in_system) {
+    presets = in_system;
+    version = version_system;
+  }
+
+  if (have_env) {
+    GList *l;
+
+    /* merge the ones from the environment paths. If any of them has a
+     * higher version, take that as the "master" version. Lower versions are
+     * then just merged in. */
+    g_queue_sort (&in_env, compare_preset_and_version, NULL);
+    /* highest version to lowest */
+    for (l = in_env.head; l; l = l->next) {
+      PresetAndVersion *pv = l->data;
+
+      if (version > pv->version) {
+        preset_merge (presets, pv->preset);
+        g_key_file_free (pv->preset);
       } else {
         if (presets)
           g_key_file_free (presets);
-        presets = in_app;
-        version = version_app;
+        presets = pv->preset;
+        version = pv->version;
       }
+      g_free (pv);
     }
-    if (in_user) {
-      /* if system/env or app version is higher, merge */
-      if (version > version_user) {
-        preset_merge (presets, in_user);
-        g_key_file_free (in_user);
-        merged = TRUE;
-      } else {
-        if (presets)
-          g_key_file_free (presets);
-        presets = in_user;
-      }
+    g_queue_clear (&in_env);
+  }
+
+  if (in_app) {
+    /* if system/env version is higher, merge */
+    if (version > version_app) {
+      preset_merge (presets, in_app);
+      g_key_file_free (in_app);
+    } else {
+      if (presets)
+        g_key_file_free (presets);
+      presets = in_app;
+      version = version_app;
+    }
+  }
+  if (in_user) {
+    /* if system/env or app version is higher, merge */
+    if (version > version_user) {
+      preset_merge (presets, in_user);
+      g_key_file_free (in_user);
+      merged = TRUE;
+    } else {
+      if (presets)
+        g_key_file_free (presets);
+      presets = in_user;
     }
+  }
+
+  if (!presets) {
+    /* we did not load a user, app or system presets file, create a new one */
+    presets = g_key_file_new ();
+    g_key_file_set_string (presets, PRESET_HEADER, PRESET_HEADER_ELEMENT_NAME,
+        G_OBJECT_TYPE_NAME (preset));
+  }
+
+  *merged_out = merged;
+  return presets;
+}
+
+/* get the merged user and system presets. This function caches the GKeyFile
+ * on the element type and reloads it when one of the preset files changed. */
+static GKeyFile *
+preset_get_keyfile (GstPreset * preset)
+{
+  GType type = G_TYPE_FROM_INSTANCE (preset);
+  PresetCache *cache;
+  GKeyFile *presets;
+  gboolean merged = FALSE;
+
+  g_mutex_lock (&preset_lock);
+  /* first see if the have a cached version for the type */
+  if (!(cache = g_type_get_qdata (type, preset_quark))) {
+    cache = preset_cache_new ();
+    /* attach the presets to the type */
+    g_type_set_qdata (type, preset_quark, cache);
+  } else if (cache->presets && preset_cache_is_stale (cache)) {
+    GST_INFO_OBJECT (preset, "reloading presets");
+    cache->old_presets = g_list_prepend (cache->old_presets, cache->presets);
+    cache->presets = NULL;
+    g_array_set_size (cache->files, 0);
+    g_hash_table_remove_all (cache->values);
+  }
+
+  if (!cache->presets)
+    cache->presets = preset_load_keyfile (preset, cache, &merged);
+  presets = cache->presets;
+  g_mutex_unlock (&preset_lock);
+
+  if (merged) {
+    gst_preset_default_save_presets_file (preset);
+  }
+  return presets;
+}
+
+/* get the deserialized property values of preset @name from @presets, they
+ * are cached on the type. Only for elements that are not child proxies and
+ * use the default property names. */
+static GArray *
+preset_get_values (GstPreset * preset, GKeyFile * presets, const gchar * name)
+{
+  GType type = G_TYPE_FROM_INSTANCE (preset);
+  GObjectClass *gclass;
+  PresetCache *cache;
+  PresetValue value;
+  GParamSpec *property;
+  GArray *values;
+  gchar **props, *str;
+  guint i;
+
+  g_mutex_lock (&preset_lock);
+  cache = g_type_get_qdata (type, preset_quark);
+  if ((values = g_hash_table_lookup (cache->values, name))) {
+    g_array_ref (values);
+    g_mutex_unlock (&preset_lock);
+    return values;
+  }
+  g_mutex_unlock (&preset_lock);
+
+  if (!(props = gst_preset_get_property_names (preset)))
+    return NULL;
+
+  gclass = G_OBJECT_CLASS (GST_ELEMENT_GET_CLASS (preset));
+  values = g_array_new (FALSE, FALSE, sizeof (PresetValue));
+  g_array_set_clear_func (values, (GDestroyNotify) preset_value_clear);
 
-    if (!presets) {
-      /* we did not load a user, app or system presets file, create a new one */
-      presets = g_key_file_new ();
-      g_key_file_set_string (presets, PRESET_HEADER, PRESET_HEADER_ELEMENT_NAME,
-          G_OBJECT_TYPE_NAME (preset));
+  for (i = 0; props[i]; i++) {
+    /* check if we have a settings for this element property */
+    if (!(str = g_key_file_get_value (presets, name, props[i], NULL))) {
+      /* the element has a property but the parameter is not in the keyfile */
+      GST_WARNING_OBJECT (preset, "parameter '%s' not in preset", props[i]);
+      continue;
     }
 
-    /* attach the preset to the type */
-    g_type_set_qdata (type, preset_quark, (gpointer) presets);
+    if (!(property = g_object_class_find_property (gclass, props[i]))) {
+      GST_WARNING_OBJECT (preset, "property '%s' not in object", props[i]);
+      g_free (str);
+      continue;
+    }
 
-    if (merged) {
-      gst_preset_default_save_presets_file (preset);
+    memset (&value, 0, sizeof (value));
+    g_value_init (&value.value, property->value_type);
+    if (gst_value_deserialize (&value.value, str)) {
+      value.name = g_strdup (props[i]);
+      g_array_append_val (values, value);
+    } else {
+      GST_WARNING_OBJECT (preset,
+          "deserialization of value '%s' for property '%s' failed", str,
+          props[i]);
+      g_value_unset (&value.value);
     }
+    g_free (str);
   }
-  return presets;
+  g_strfreev (props);
+
+  /* don't cache values of presets that were replaced meanwhile */
+  g_mutex_lock (&preset_lock);
+  if (cache->presets == presets)
+    g_hash_table_insert (cache->values, g_strdup (name), g_array_ref (values));
+  g_mutex_unlock (&preset_lock);
+
+  return values;
 }
 
 static gint
@@ -653,12 +881,31 @@ gst_preset_default_load_preset (GstPreset * preset, const gchar * name)
 
   GST_DEBUG_OBJECT (preset, "loading preset : '%s'", name);
 
+  is_child_proxy = GST_IS_CHILD_PROXY (preset);
+
+  /* the properties do not depend on the instance, use the cached values */
+  if (!is_child_proxy && GST_PRESET_GET_INTERFACE (preset)->get_property_names
+      == gst_preset_default_get_property_names) {
+    GArray *values;
+
+    if (!(values = preset_get_values (preset, presets, name)))
+      goto no_properties;
+
+    for (i = 0; i < values->len; i++) {
+      PresetValue *value = &g_array_index (values, PresetValue, i);
+
+      g_object_set_property ((GObject *) preset, value->name, &value->value);
+    }
+    g_array_unref (values);
+
+    return TRUE;
+  }
+
   /* get the properties that we can configure in this element */
   if (!(props = gst_preset_get_property_names (preset)))
     goto no_properties;
 
   gclass = G_OBJECT_CLASS (GST_ELEMENT_GET_CLASS (preset));
-  is_child_proxy = GST_IS_CHILD_PROXY (preset);
 
   /* for each of the property names, find the preset parameter and try to
    * configure the property with its value */
@@ -731,6 +978,23 @@ no_properties:
   }
 }
 
+/* forget the cached values of the type of @preset and update the state of
+ * @path, if it was written */
+static void
+preset_cache_changed (GstPreset * preset, const gchar * path)
+{
+  PresetCache *cache;
+
+  g_mutex_lock (&preset_lock);
+  cache = g_type_get_qdata (G_TYPE_FROM_INSTANCE (preset), preset_quark);
+  if (cache) {
+    g_hash_table_remove_all (cache->values);
+    if (path)
+      preset_cache_update_file (cache, path);
+  }
+  g_mutex_unlock (&preset_lock);
+}
+
 /* save the presets file. A copy of the existing presets file is stored in a
  * .bak file */
 static gboolean
@@ -750,6 +1014,9 @@ gst_preset_default_save_presets_file (GstPreset * preset)
   if (!(presets = preset_get_keyfile (preset)))
     goto no_presets;
 
+  /* the keyfile was changed, the values have to be deserialized again */
+  preset_cache_changed (preset, NULL);
+
   GST_DEBUG_OBJECT (preset, "saving preset file: '%s'", preset_path);
 
   /* create backup if possible */
@@ -781,6 +1048,9 @@ gst_preset_default_save_presets_file (GstPreset * preset)
   if (!g_file_set_contents (preset_path, data, data_size, &error))
     goto write_failed;
 
+  /* we know what we just wrote, don't reload it */
+  preset_cache_changed (preset, preset_path);
+
   g_free (data);
 
   return TRUE;
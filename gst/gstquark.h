@@ -202,7 +202,13 @@ typedef enum _GstQuarkId
   GST_QUARK_MESSAGE_DEVICE_REMOVED = 171,
   GST_QUARK_DEVICE = 172,
   GST_QUARK_URI_REDIRECTION_PERMANENT = 173,
-  GST_QUARK_MAX = 174
+  GST_QUARK_THREAD_CACHE_SIZE = 174,
+  GST_QUARK_MEMORY_BUDGET = 175,
+  GST_QUARK_TRIM_IDLE_TIME = 176,
+  GST_QUARK_PREFAULT = 177,
+  GST_QUARK_LOCK_MEMORY = 178,
+  GST_QUARK_REUSE_MEMORY = 179,
+  GST_QUARK_MAX = 180
 } GstQuarkId;
 
 extern GQuark _priv_gst_quark_table[GST_QUARK_MAX];
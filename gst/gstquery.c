@@ -195,7 +195,8 @@ _gst_query_free (GstQuery * query)
     gst_structure_free (s);
   }
 
-  g_slice_free1 (sizeof (GstQueryImpl), query);
+  _priv_gst_mini_object_cache_free (GST_MINI_OBJECT_CACHE_QUERY,
+      sizeof (GstQueryImpl), query);
 }
 
 static GstQuery *
@@ -669,7 +670,8 @@ gst_query_new_custom (GstQueryType type, GstStructure * structure)
 {
   GstQueryImpl *query;
 
-  query = g_slice_new0 (GstQueryImpl);
+  query = _priv_gst_mini_object_cache_alloc0 (GST_MINI_OBJECT_CACHE_QUERY,
+      sizeof (GstQueryImpl));
 
   GST_DEBUG ("creating new query %p %s", query, gst_query_type_get_name (type));
 
@@ -692,7 +694,8 @@ gst_query_new_custom (GstQueryType type, GstStructure * structure)
   /* ERRORS */
 had_parent:
   {
-    g_slice_free1 (sizeof (GstQueryImpl), query);
+    _priv_gst_mini_object_cache_free (GST_MINI_OBJECT_CACHE_QUERY,
+        sizeof (GstQueryImpl), query);
     g_warning ("structure is already owned by another object");
     return NULL;
   }
@@ -119,6 +119,7 @@
 #endif
 #include <errno.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 /* For g_stat () */
@@ -168,6 +169,21 @@ struct _GstRegistryPrivate
   guint32 tfl_cookie;
   GList *device_provider_factory_list;
   guint32 dmfl_cookie;
+
+  /* element factories by pad template media type, per direction. Built
+   * from element_factory_list, which holds the refs */
+  GHashTable *caps_index[2];
+  GPtrArray *caps_index_any[2];
+  GHashTable *caps_index_factories;
+  guint32 caps_index_cookie;
+
+  /* element factories by URI protocol, per URI type, sorted by rank. Built
+   * from element_factory_list, which holds the refs */
+  GHashTable *uri_index[2];
+  guint32 uri_index_cookie;
+
+  /* registry cache contents the features point into */
+  GList *cache_data;
 };
 
 /* the one instance of the default registry and the mutex protecting the
@@ -180,6 +196,21 @@ static GstRegistry *_gst_registry_default = NULL;
 
 /* control the behaviour of registry rebuild */
 static gboolean _gst_enable_registry_fork = DEFAULT_FORK;
+
+/* features of plugins that are left out of the registry, parsed once from
+ * the string passed to gst_registry_set_feature_filter() or from
+ * GST_REGISTRY_FILTER */
+typedef struct
+{
+  gboolean active;
+  /* plugin and feature names, NULL allows everything */
+  GHashTable *allow;
+  GHashTable *deny;
+  guint min_rank;
+} GstRegistryFilter;
+
+static gchar *feature_filter_string = NULL;
+static GstRegistryFilter feature_filter;
 /* List of plugins that need preloading/reloading after scanning registry */
 extern GSList *_priv_gst_preload_plugins;
 
@@ -191,6 +222,10 @@ extern GList *_priv_gst_plugin_paths;
 /* Set to TRUE when the registry cache should be disabled */
 gboolean _gst_disable_registry_cache = FALSE;
 
+/* registry cache linked into the application, replaces the cache file */
+static const guint8 *builtin_cache_data = NULL;
+static gsize builtin_cache_size = 0;
+
 static gboolean __registry_reuse_plugin_scanner = TRUE;
 #endif
 
@@ -262,6 +297,9 @@ gst_registry_init (GstRegistry * registry)
   registry->priv->basename_hash = g_hash_table_new (g_str_hash, g_str_equal);
 }
 
+static void gst_registry_clear_caps_index (GstRegistry * registry);
+static void gst_registry_clear_uri_index (GstRegistry * registry);
+
 static void
 gst_registry_finalize (GObject * object)
 {
@@ -307,6 +345,9 @@ gst_registry_finalize (GObject * object)
   g_hash_table_destroy (registry->priv->basename_hash);
   registry->priv->basename_hash = NULL;
 
+  gst_registry_clear_caps_index (registry);
+  gst_registry_clear_uri_index (registry);
+
   if (registry->priv->element_factory_list) {
     GST_DEBUG_OBJECT (registry, "Cleaning up cached element factory list");
     gst_plugin_feature_list_free (registry->priv->element_factory_list);
@@ -323,9 +364,46 @@ gst_registry_finalize (GObject * object)
     gst_plugin_feature_list_free (registry->priv->device_provider_factory_list);
   }
 
+  g_list_free_full (registry->priv->cache_data, (GDestroyNotify) g_bytes_unref);
+  registry->priv->cache_data = NULL;
+
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
 
+/* Keeps @data alive as long as @registry, so the features loaded from the
+ * registry cache can refer to its strings instead of copying them.
+ * Takes ownership of @data. */
+void
+priv_gst_registry_keep_cache_data (GstRegistry * registry, GBytes * data)
+{
+  GST_OBJECT_LOCK (registry);
+  registry->priv->cache_data = g_list_prepend (registry->priv->cache_data,
+      data);
+  GST_OBJECT_UNLOCK (registry);
+}
+
+/* Returns the structure in @metadata, parsing it from @str first when the
+ * feature was loaded from the registry cache and nobody needed it yet. */
+const GstStructure *
+priv_gst_registry_ensure_metadata (gpointer * metadata, const gchar * str)
+{
+  GstStructure *s;
+
+  if (G_LIKELY (g_atomic_pointer_get (metadata) != NULL || str == NULL))
+    return *metadata;
+
+  s = gst_structure_from_string (str, NULL);
+  if (G_UNLIKELY (s == NULL)) {
+    GST_ERROR ("Error when trying to deserialize structure for metadata '%s'",
+        str);
+    s = gst_structure_new_empty ("metadata");
+  }
+  if (!g_atomic_pointer_compare_and_exchange (metadata, NULL, s))
+    gst_structure_free (s);
+
+  return *metadata;
+}
+
 /**
  * gst_registry_get:
  *
@@ -548,6 +626,146 @@ gst_registry_remove_plugin (GstRegistry * registry, GstPlugin * plugin)
   gst_object_unref (plugin);
 }
 
+static gboolean
+parse_filter_rank (const gchar * str, guint * rank)
+{
+  gchar *end;
+
+  if (g_ascii_strcasecmp (str, "none") == 0)
+    *rank = GST_RANK_NONE;
+  else if (g_ascii_strcasecmp (str, "marginal") == 0)
+    *rank = GST_RANK_MARGINAL;
+  else if (g_ascii_strcasecmp (str, "secondary") == 0)
+    *rank = GST_RANK_SECONDARY;
+  else if (g_ascii_strcasecmp (str, "primary") == 0)
+    *rank = GST_RANK_PRIMARY;
+  else {
+    *rank = strtoul (str, &end, 10);
+    if (end == str || *end != '\0')
+      return FALSE;
+  }
+  return TRUE;
+}
+
+static void
+parse_feature_filter (GstRegistryFilter * filter, const gchar * str)
+{
+  gchar **entries;
+  gint i;
+
+  GST_INFO ("registry feature filter: %s", str);
+
+  entries = g_strsplit (str, ",", -1);
+  for (i = 0; entries[i]; i++) {
+    gchar *entry = g_strstrip (entries[i]);
+    GHashTable **set;
+
+    if (*entry == '\0')
+      continue;
+
+    if (g_str_has_prefix (entry, "min-rank=")) {
+      if (!parse_filter_rank (entry + 9, &filter->min_rank))
+        g_warning ("invalid rank in registry filter entry '%s'", entry);
+      filter->active = TRUE;
+      continue;
+    }
+
+    if (*entry == '-') {
+      set = &filter->deny;
+      entry++;
+    } else {
+      set = &filter->allow;
+    }
+    if (*set == NULL)
+      *set = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+    g_hash_table_add (*set, g_strdup (entry));
+    filter->active = TRUE;
+  }
+  g_strfreev (entries);
+}
+
+static const GstRegistryFilter *
+get_feature_filter (void)
+{
+  static gsize init = 0;
+
+  if (g_once_init_enter (&init)) {
+    const gchar *str = feature_filter_string;
+
+    if (str == NULL)
+      str = g_getenv ("GST_REGISTRY_FILTER");
+    if (str != NULL)
+      parse_feature_filter (&feature_filter, str);
+
+    g_once_init_leave (&init, 1);
+  }
+  return &feature_filter;
+}
+
+/* check if @feature of a plugin is left out by the feature filter. Features
+ * without a plugin, like bin and pipeline, are always kept */
+static gboolean
+gst_registry_feature_is_filtered (GstPluginFeature * feature)
+{
+  const GstRegistryFilter *filter = get_feature_filter ();
+  const gchar *name = GST_OBJECT_NAME (feature);
+
+  if (G_LIKELY (!filter->active) || feature->plugin == NULL)
+    return FALSE;
+
+  if (filter->deny && (g_hash_table_contains (filter->deny, name) ||
+          g_hash_table_contains (filter->deny, feature->plugin_name)))
+    return TRUE;
+
+  /* features allowed by name pass the rank threshold too */
+  if (filter->allow && g_hash_table_contains (filter->allow, name))
+    return FALSE;
+
+  if (filter->allow && !g_hash_table_contains (filter->allow,
+          feature->plugin_name))
+    return TRUE;
+
+  return feature->rank < filter->min_rank;
+}
+
+/**
+ * gst_registry_set_feature_filter:
+ * @filter: (allow-none): the filter, or %NULL to use the GST_REGISTRY_FILTER
+ *     environment variable
+ *
+ * Leave plugin features out of the registry. @filter is a comma separated
+ * list of entries:
+ *
+ * - a plugin or feature name allows the features of that plugin or that one
+ *   feature. When there are such entries, all other features are left out.
+ * - a name prefixed with "-" leaves out the features of that plugin or that
+ *   one feature.
+ * - "min-rank=RANK" leaves out the features with a rank lower than RANK,
+ *   unless they are allowed by name. RANK is a number or one of "none",
+ *   "marginal", "secondary" and "primary".
+ *
+ * For example "coreelements,playback,-decodebin,min-rank=marginal".
+ *
+ * The features that are left out are never added to the registry, they are
+ * not returned by gst_registry_get_feature_list() and the other lookups, and
+ * their elements can't be created. Features that are not part of a plugin,
+ * like "bin" and "pipeline", are always kept. While a filter is active the
+ * registry cache is not rewritten, since it would miss the left out
+ * features; run once without a filter to update it after installing plugins.
+ *
+ * This function must be called before gst_init().
+ *
+ * Since: 1.10
+ */
+void
+gst_registry_set_feature_filter (const gchar * filter)
+{
+  g_return_if_fail (!gst_is_initialized ());
+
+  g_free (feature_filter_string);
+  feature_filter_string = g_strdup (filter);
+}
+
 /**
  * gst_registry_add_feature:
  * @registry: the registry to add the plugin to
@@ -570,6 +788,15 @@ gst_registry_add_feature (GstRegistry * registry, GstPluginFeature * feature)
   g_return_val_if_fail (GST_OBJECT_NAME (feature) != NULL, FALSE);
   g_return_val_if_fail (feature->plugin_name != NULL, FALSE);
 
+  if (G_UNLIKELY (gst_registry_feature_is_filtered (feature))) {
+    GST_LOG_OBJECT (registry, "leaving out filtered feature %s of plugin %s",
+        GST_OBJECT_NAME (feature), feature->plugin_name);
+    /* not an error, plugins fail to load when registering one fails */
+    gst_object_ref_sink (feature);
+    gst_object_unref (feature);
+    return TRUE;
+  }
+
   GST_OBJECT_LOCK (registry);
   existing_feature = gst_registry_lookup_feature_locked (registry,
       GST_OBJECT_NAME (feature));
@@ -734,6 +961,154 @@ gst_registry_get_feature_list_or_create (GstRegistry * registry,
   return res;
 }
 
+static void
+gst_registry_clear_caps_index (GstRegistry * registry)
+{
+  GstRegistryPrivate *priv = registry->priv;
+  gint i;
+
+  for (i = 0; i < 2; i++) {
+    if (priv->caps_index[i]) {
+      g_hash_table_unref (priv->caps_index[i]);
+      priv->caps_index[i] = NULL;
+    }
+    if (priv->caps_index_any[i]) {
+      g_ptr_array_unref (priv->caps_index_any[i]);
+      priv->caps_index_any[i] = NULL;
+    }
+  }
+  if (priv->caps_index_factories) {
+    g_hash_table_unref (priv->caps_index_factories);
+    priv->caps_index_factories = NULL;
+  }
+}
+
+static void
+caps_index_add (GPtrArray * factories, GstElementFactory * factory)
+{
+  /* the templates of a factory are added one after the other */
+  if (factories->len == 0 ||
+      g_ptr_array_index (factories, factories->len - 1) != factory)
+    g_ptr_array_add (factories, factory);
+}
+
+/* Must be called with the object lock taken */
+static void
+gst_registry_update_caps_index (GstRegistry * registry)
+{
+  GstRegistryPrivate *priv = registry->priv;
+  GList *walk;
+  gint i;
+
+  gst_registry_get_feature_list_or_create (registry,
+      &priv->element_factory_list, &priv->efl_cookie,
+      GST_TYPE_ELEMENT_FACTORY);
+
+  if (priv->caps_index_factories && priv->caps_index_cookie == priv->cookie)
+    return;
+
+  GST_DEBUG_OBJECT (registry, "rebuilding pad template caps index");
+
+  gst_registry_clear_caps_index (registry);
+
+  for (i = 0; i < 2; i++) {
+    priv->caps_index[i] = g_hash_table_new_full (NULL, NULL, NULL,
+        (GDestroyNotify) g_ptr_array_unref);
+    priv->caps_index_any[i] = g_ptr_array_new ();
+  }
+  priv->caps_index_factories = g_hash_table_new (NULL, NULL);
+
+  for (walk = priv->element_factory_list; walk; walk = walk->next) {
+    GstElementFactory *factory = walk->data;
+    const GList *templates;
+
+    templates = gst_element_factory_get_static_pad_templates (factory);
+    for (; templates; templates = templates->next) {
+      GstStaticPadTemplate *templ = templates->data;
+      GstCaps *caps;
+      guint j, n;
+
+      if (templ->direction != GST_PAD_SRC && templ->direction != GST_PAD_SINK)
+        continue;
+      i = templ->direction - GST_PAD_SRC;
+
+      caps = gst_static_caps_get (&templ->static_caps);
+      if (gst_caps_is_any (caps)) {
+        caps_index_add (priv->caps_index_any[i], factory);
+      } else {
+        n = gst_caps_get_size (caps);
+        for (j = 0; j < n; j++) {
+          GQuark name;
+          GPtrArray *factories;
+
+          name = gst_structure_get_name_id (gst_caps_get_structure (caps, j));
+          factories =
+              g_hash_table_lookup (priv->caps_index[i], GUINT_TO_POINTER (name));
+          if (factories == NULL) {
+            factories = g_ptr_array_new ();
+            g_hash_table_insert (priv->caps_index[i], GUINT_TO_POINTER (name),
+                factories);
+          }
+          caps_index_add (factories, factory);
+        }
+      }
+      gst_caps_unref (caps);
+    }
+    g_hash_table_add (priv->caps_index_factories, factory);
+  }
+
+  priv->caps_index_cookie = priv->cookie;
+}
+
+/* Returns the set of element factories of @registry that have a template in
+ * @direction with one of the media types of @caps or with ANY caps. Only
+ * those can intersect with @caps. @indexed is set to the set of all factories
+ * that were considered, others need to be checked in full.
+ *
+ * Returns NULL when @caps can't be used to narrow down the factories. */
+GHashTable *
+priv_gst_registry_get_factory_candidates (GstRegistry * registry,
+    const GstCaps * caps, GstPadDirection direction, GHashTable ** indexed)
+{
+  GstRegistryPrivate *priv = registry->priv;
+  GHashTable *candidates;
+  GPtrArray *factories;
+  guint i, j, n, d;
+
+  if (direction != GST_PAD_SRC && direction != GST_PAD_SINK)
+    return NULL;
+  if (gst_caps_is_any (caps) || gst_caps_is_empty (caps))
+    return NULL;
+
+  d = direction - GST_PAD_SRC;
+  candidates = g_hash_table_new (NULL, NULL);
+
+  GST_OBJECT_LOCK (registry);
+  gst_registry_update_caps_index (registry);
+
+  factories = priv->caps_index_any[d];
+  for (j = 0; j < factories->len; j++)
+    g_hash_table_add (candidates, g_ptr_array_index (factories, j));
+
+  n = gst_caps_get_size (caps);
+  for (i = 0; i < n; i++) {
+    GQuark name = gst_structure_get_name_id (gst_caps_get_structure (caps, i));
+
+    factories = g_hash_table_lookup (priv->caps_index[d],
+        GUINT_TO_POINTER (name));
+    if (factories == NULL)
+      continue;
+
+    for (j = 0; j < factories->len; j++)
+      g_hash_table_add (candidates, g_ptr_array_index (factories, j));
+  }
+
+  *indexed = g_hash_table_ref (priv->caps_index_factories);
+  GST_OBJECT_UNLOCK (registry);
+
+  return candidates;
+}
+
 static gint
 type_find_factory_rank_cmp (const GstPluginFeature * fac1,
     const GstPluginFeature * fac2)
@@ -746,6 +1121,140 @@ type_find_factory_rank_cmp (const GstPluginFeature * fac1,
   return strcmp (GST_OBJECT_NAME (fac1), GST_OBJECT_NAME (fac2));
 }
 
+static void
+gst_registry_clear_uri_index (GstRegistry * registry)
+{
+  GstRegistryPrivate *priv = registry->priv;
+  gint i;
+
+  for (i = 0; i < 2; i++) {
+    if (priv->uri_index[i]) {
+      g_hash_table_unref (priv->uri_index[i]);
+      priv->uri_index[i] = NULL;
+    }
+  }
+}
+
+/* URI protocols are case insensitive */
+static guint
+uri_protocol_hash (gconstpointer key)
+{
+  const gchar *p;
+  guint h = 5381;
+
+  for (p = key; *p; p++)
+    h = (h << 5) + h + g_ascii_tolower (*p);
+
+  return h;
+}
+
+static gboolean
+uri_protocol_equal (gconstpointer a, gconstpointer b)
+{
+  return g_ascii_strcasecmp (a, b) == 0;
+}
+
+static gint
+uri_index_rank_cmp (gconstpointer a, gconstpointer b)
+{
+  return type_find_factory_rank_cmp (*(const GstPluginFeature **) a,
+      *(const GstPluginFeature **) b);
+}
+
+static void
+sort_uri_factories (gpointer key, GPtrArray * factories, gpointer user_data)
+{
+  g_ptr_array_sort (factories, uri_index_rank_cmp);
+}
+
+/* Must be called with the object lock taken */
+static void
+gst_registry_update_uri_index (GstRegistry * registry)
+{
+  GstRegistryPrivate *priv = registry->priv;
+  GList *walk;
+  gint i;
+
+  gst_registry_get_feature_list_or_create (registry,
+      &priv->element_factory_list, &priv->efl_cookie,
+      GST_TYPE_ELEMENT_FACTORY);
+
+  if (priv->uri_index[0] && priv->uri_index_cookie == priv->cookie)
+    return;
+
+  GST_DEBUG_OBJECT (registry, "rebuilding URI protocol index");
+
+  gst_registry_clear_uri_index (registry);
+
+  /* the keys are the protocol strings of the factories */
+  for (i = 0; i < 2; i++)
+    priv->uri_index[i] = g_hash_table_new_full (uri_protocol_hash,
+        uri_protocol_equal, NULL, (GDestroyNotify) g_ptr_array_unref);
+
+  for (walk = priv->element_factory_list; walk; walk = walk->next) {
+    GstElementFactory *factory = walk->data;
+    const gchar *const *protocols;
+
+    if (!GST_URI_TYPE_IS_VALID (factory->uri_type))
+      continue;
+    i = factory->uri_type - GST_URI_SINK;
+
+    protocols = gst_element_factory_get_uri_protocols (factory);
+    if (protocols == NULL) {
+      g_warning ("Factory '%s' implements GstUriHandler interface but returned "
+          "no supported protocols!", GST_OBJECT_NAME (factory));
+      continue;
+    }
+
+    for (; *protocols != NULL; protocols++) {
+      GPtrArray *factories;
+
+      factories = g_hash_table_lookup (priv->uri_index[i], *protocols);
+      if (factories == NULL) {
+        factories = g_ptr_array_new ();
+        g_hash_table_insert (priv->uri_index[i], (gpointer) * protocols,
+            factories);
+      }
+      caps_index_add (factories, factory);
+    }
+  }
+
+  for (i = 0; i < 2; i++)
+    g_hash_table_foreach (priv->uri_index[i], (GHFunc) sort_uri_factories,
+        NULL);
+
+  priv->uri_index_cookie = priv->cookie;
+}
+
+/* Returns a list of the element factories of @registry that handle URIs of
+ * @type with @protocol, sorted by the rank they had when the index was built.
+ * Free with gst_plugin_feature_list_free() */
+GList *
+priv_gst_registry_get_uri_factories (GstRegistry * registry, GstURIType type,
+    const gchar * protocol)
+{
+  GPtrArray *factories;
+  GList *list = NULL;
+  gint i;
+
+  if (!GST_URI_TYPE_IS_VALID (type))
+    return NULL;
+
+  GST_OBJECT_LOCK (registry);
+  gst_registry_update_uri_index (registry);
+
+  factories = g_hash_table_lookup (registry->priv->uri_index[type -
+          GST_URI_SINK], protocol);
+  if (factories) {
+    for (i = factories->len - 1; i >= 0; i--)
+      list = g_list_prepend (list,
+          gst_object_ref (g_ptr_array_index (factories, i)));
+  }
+  GST_OBJECT_UNLOCK (registry);
+
+  return list;
+}
+
 static GList *
 gst_registry_get_element_factory_list (GstRegistry * registry)
 {
@@ -1092,9 +1601,20 @@ typedef struct
   GstRegistry *registry;
   GstRegistryScanHelperState helper_state;
   GstPluginLoader *helper;
+  guint n_scanners;
   gboolean changed;
 } GstRegistryScanContext;
 
+#define MAX_REGISTRY_SCANNERS 16
+
+typedef struct
+{
+  gchar *dirent;
+  gchar *filename;
+  GStatBuf file_status;
+  gint stat_res;
+} GstRegistryDirEntry;
+
 static void
 init_scan_context (GstRegistryScanContext * context, GstRegistry * registry)
 {
@@ -1119,6 +1639,20 @@ init_scan_context (GstRegistryScanContext * context, GstRegistry * registry)
   else
     context->helper_state = REGISTRY_SCAN_HELPER_DISABLED;
 
+  /* number of scanner helpers to run in parallel, 0 means one per CPU */
+  context->n_scanners = 1;
+  {
+    const gchar *scanners_env;
+
+    if ((scanners_env = g_getenv ("GST_REGISTRY_SCANNERS"))) {
+      guint64 n = g_ascii_strtoull (scanners_env, NULL, 10);
+
+      if (n == 0)
+        n = g_get_num_processors ();
+      context->n_scanners = CLAMP (n, 1, MAX_REGISTRY_SCANNERS);
+    }
+  }
+
   context->helper = NULL;
   context->changed = FALSE;
 }
@@ -1148,7 +1682,8 @@ gst_registry_scan_plugin_file (GstRegistryScanContext * context,
   /* Have a plugin to load - see if the scan-helper needs starting */
   if (context->helper_state == REGISTRY_SCAN_HELPER_NOT_STARTED) {
     GST_DEBUG ("Starting plugin scanner for file %s", filename);
-    context->helper = _priv_gst_plugin_loader_funcs.create (context->registry);
+    context->helper = _priv_gst_plugin_loader_funcs.create (context->registry,
+        context->n_scanners);
     if (context->helper != NULL)
       context->helper_state = REGISTRY_SCAN_HELPER_RUNNING;
     else {
@@ -1217,35 +1752,93 @@ is_blacklisted_hidden_directory (const gchar * dirent)
   return FALSE;
 }
 
+static void
+dir_entry_free (GstRegistryDirEntry * entry)
+{
+  g_free (entry->dirent);
+  g_free (entry->filename);
+  g_slice_free (GstRegistryDirEntry, entry);
+}
+
+static void
+dir_entry_stat (GstRegistryDirEntry * entry, gpointer user_data)
+{
+  entry->stat_res = g_stat (entry->filename, &entry->file_status);
+}
+
+/* Lists the directory and stats all entries. With several scanners the
+ * stat calls are spread over as many threads, the entries stay in
+ * directory order so the scan itself is not affected. */
+static GPtrArray *
+gst_registry_read_dir_entries (GstRegistryScanContext * context,
+    const gchar * path)
+{
+  GDir *dir;
+  const gchar *dirent;
+  GPtrArray *entries;
+  GThreadPool *pool = NULL;
+  guint i;
+
+  dir = g_dir_open (path, 0, NULL);
+  if (!dir)
+    return NULL;
+
+  entries = g_ptr_array_new_with_free_func ((GDestroyNotify) dir_entry_free);
+  while ((dirent = g_dir_read_name (dir))) {
+    GstRegistryDirEntry *entry = g_slice_new0 (GstRegistryDirEntry);
+
+    entry->dirent = g_strdup (dirent);
+    entry->filename = g_build_filename (path, dirent, NULL);
+    g_ptr_array_add (entries, entry);
+  }
+  g_dir_close (dir);
+
+  if (context->n_scanners > 1 && entries->len > 1)
+    pool = g_thread_pool_new ((GFunc) dir_entry_stat, NULL,
+        MIN (context->n_scanners, entries->len), FALSE, NULL);
+
+  for (i = 0; i < entries->len; i++) {
+    GstRegistryDirEntry *entry = g_ptr_array_index (entries, i);
+
+    if (pool == NULL || !g_thread_pool_push (pool, entry, NULL))
+      dir_entry_stat (entry, NULL);
+  }
+
+  /* waits for all pushed entries */
+  if (pool)
+    g_thread_pool_free (pool, FALSE, TRUE);
+
+  return entries;
+}
+
 static gboolean
 gst_registry_scan_path_level (GstRegistryScanContext * context,
     const gchar * path, int level)
 {
-  GDir *dir;
-  const gchar *dirent;
-  gchar *filename;
+  GPtrArray *entries;
   GstPlugin *plugin;
   gboolean changed = FALSE;
+  guint i;
 
-  dir = g_dir_open (path, 0, NULL);
-  if (!dir)
+  entries = gst_registry_read_dir_entries (context, path);
+  if (!entries)
     return FALSE;
 
-  while ((dirent = g_dir_read_name (dir))) {
-    GStatBuf file_status;
+  for (i = 0; i < entries->len; i++) {
+    GstRegistryDirEntry *entry = g_ptr_array_index (entries, i);
+    const gchar *dirent = entry->dirent;
+    const gchar *filename = entry->filename;
+    GStatBuf file_status = entry->file_status;
 
-    filename = g_build_filename (path, dirent, NULL);
-    if (g_stat (filename, &file_status) < 0) {
+    if (entry->stat_res < 0) {
       /* Plugin will be removed from cache after the scan completes if it
        * is still marked 'cached' */
-      g_free (filename);
       continue;
     }
 
     if (file_status.st_mode & S_IFDIR) {
       if (G_UNLIKELY (is_blacklisted_hidden_directory (dirent))) {
         GST_TRACE_OBJECT (context->registry, "ignoring %s directory", dirent);
-        g_free (filename);
         continue;
       }
       /* FIXME 2.0: Don't recurse into directories, this behaviour
@@ -1259,13 +1852,11 @@ gst_registry_scan_path_level (GstRegistryScanContext * context,
         GST_LOG_OBJECT (context->registry, "not recursing into directory %s, "
             "recursion level too deep", filename);
       }
-      g_free (filename);
       continue;
     }
     if (!(file_status.st_mode & S_IFREG)) {
       GST_TRACE_OBJECT (context->registry, "%s is not a regular file, ignoring",
           filename);
-      g_free (filename);
       continue;
     }
     if (!g_str_has_suffix (dirent, G_MODULE_SUFFIX)
@@ -1276,7 +1867,6 @@ gst_registry_scan_path_level (GstRegistryScanContext * context,
       GST_TRACE_OBJECT (context->registry,
           "extension is not recognized as module file, ignoring file %s",
           filename);
-      g_free (filename);
       continue;
     }
 
@@ -1290,7 +1880,6 @@ gst_registry_scan_path_level (GstRegistryScanContext * context,
           "has been merged into the corelements plugin", filename);
       /* Plugin will be removed from cache after the scan completes if it
        * is still marked 'cached' */
-      g_free (filename);
       continue;
     }
 
@@ -1304,7 +1893,6 @@ gst_registry_scan_path_level (GstRegistryScanContext * context,
         GST_DEBUG_OBJECT (context->registry,
             "plugin already registered from path \"%s\"",
             GST_STR_NULL (plugin->filename));
-        g_free (filename);
         gst_object_unref (plugin);
         continue;
       }
@@ -1346,11 +1934,9 @@ gst_registry_scan_path_level (GstRegistryScanContext * context,
       changed |= gst_registry_scan_plugin_file (context, filename,
           file_status.st_size, file_status.st_mtime);
     }
-
-    g_free (filename);
   }
 
-  g_dir_close (dir);
+  g_ptr_array_free (entries, TRUE);
 
   return changed;
 }
@@ -1687,6 +2273,12 @@ scan_and_update_registry (GstRegistry * default_registry,
     return REGISTRY_SCAN_AND_UPDATE_FAILURE;
   }
 
+  if (get_feature_filter ()->active) {
+    GST_INFO ("Registry cache changed, but features are filtered. Not "
+        "writing.");
+    return REGISTRY_SCAN_AND_UPDATE_FAILURE;
+  }
+
   GST_INFO ("Registry cache changed. Writing new registry cache");
   if (!priv_gst_registry_binary_write_cache (default_registry,
           default_registry->priv->plugins, registry_file)) {
@@ -1708,9 +2300,25 @@ ensure_current_registry (GError ** error)
   gboolean ret = TRUE;
   gboolean do_update = TRUE;
   gboolean have_cache = TRUE;
+  const gchar *update_env;
 
   default_registry = gst_registry_get ();
 
+  if (builtin_cache_data != NULL && !_gst_disable_registry_cache) {
+    GST_INFO ("reading builtin registry cache");
+    have_cache = priv_gst_registry_binary_read_cache_data (default_registry,
+        builtin_cache_data, builtin_cache_size);
+    _gst_disable_registry_cache = TRUE;
+
+    /* the builtin cache describes the deployment, don't scan the plugin paths
+     * on startup unless explicitly asked to */
+    update_env = g_getenv ("GST_REGISTRY_UPDATE");
+    if (have_cache && (update_env == NULL || strcmp (update_env, "no") == 0)) {
+      GST_DEBUG ("Not updating builtin registry cache");
+      return TRUE;
+    }
+  }
+
   registry_file = g_strdup (g_getenv ("GST_REGISTRY_1_0"));
   if (registry_file == NULL)
     registry_file = g_strdup (g_getenv ("GST_REGISTRY"));
@@ -1731,8 +2339,6 @@ ensure_current_registry (GError ** error)
   if (have_cache) {
     do_update = !_priv_gst_disable_registry_update;
     if (do_update) {
-      const gchar *update_env;
-
       if ((update_env = g_getenv ("GST_REGISTRY_UPDATE"))) {
         /* do update for any value different from "no" */
         do_update = (strcmp (update_env, "no") != 0);
@@ -1761,6 +2367,37 @@ ensure_current_registry (GError ** error)
 }
 #endif /* GST_DISABLE_REGISTRY */
 
+/**
+ * gst_registry_set_builtin_cache:
+ * @data: (array length=size): the contents of a registry cache file
+ * @size: the size of @data
+ *
+ * Makes gst_init() read the registry from @data instead of the registry
+ * cache file, and not scan the plugin paths for changes unless the
+ * GST_REGISTRY_UPDATE environment variable is set to a value different from
+ * "no". Registry loading then does no file system access at all, plugins
+ * are only opened when their features are used.
+ *
+ * @data is the content of a registry cache file written by gst_init() for
+ * the plugins of the deployment, typically converted to a C array at build
+ * time with tools/gst-registry-to-c and linked into the application.
+ * @data must stay valid for the lifetime of the program.
+ *
+ * This function must be called before gst_init().
+ *
+ * Since: 1.10
+ */
+void
+gst_registry_set_builtin_cache (const guint8 * data, gsize size)
+{
+#ifndef GST_DISABLE_REGISTRY
+  g_return_if_fail (!gst_is_initialized ());
+
+  builtin_cache_data = data;
+  builtin_cache_size = size;
+#endif
+}
+
 /**
  * gst_registry_fork_is_enabled:
  *
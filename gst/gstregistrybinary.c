@@ -497,24 +497,16 @@ fail:
   return -1;
 }
 
-/**
- * gst_registry_binary_read_cache:
- * @registry: a #GstRegistry
- * @location: a filename
- *
- * Read the contents of the binary cache file at @location into @registry.
- *
- * Returns: %TRUE on success.
- */
-gboolean
-priv_gst_registry_binary_read_cache (GstRegistry * registry,
-    const char *location)
+/* Reads the registry cache in @data into @registry, @location is only used
+ * for the debug log. Takes ownership of @data. */
+static gboolean
+gst_registry_binary_load_cache (GstRegistry * registry, GBytes * data,
+    const gchar * location)
 {
-  GMappedFile *mapped = NULL;
-  gchar *contents = NULL;
+  gboolean keep_data = FALSE;
+  const gchar *contents, *end;
   gchar *in = NULL;
   gsize size;
-  GError *err = NULL;
   gboolean res = FALSE;
   guint32 filter_env_hash = 0;
   gint check_magic_result;
@@ -532,33 +524,11 @@ priv_gst_registry_binary_read_cache (GstRegistry * registry,
   timer = g_timer_new ();
 #endif
 
-  mapped = g_mapped_file_new (location, FALSE, &err);
-  if (G_UNLIKELY (err != NULL)) {
-    GST_INFO ("Unable to mmap file %s : %s", location, err->message);
-    g_error_free (err);
-    err = NULL;
-  }
-
-  if (mapped == NULL) {
-    /* Error mmap-ing the cache, try a plain memory read */
-
-    g_file_get_contents (location, &contents, &size, &err);
-    if (err != NULL) {
-      GST_INFO ("Unable to read file %s : %s", location, err->message);
-#ifndef GST_DISABLE_GST_DEBUG
-      g_timer_destroy (timer);
-#endif
-      g_error_free (err);
-      return FALSE;
-    }
-  } else {
-    /* This can't fail if g_mapped_file_new() succeeded */
-    contents = g_mapped_file_get_contents (mapped);
-    size = g_mapped_file_get_length (mapped);
-  }
+  contents = g_bytes_get_data (data, &size);
+  end = contents + size;
 
   /* in is a cursor pointer, we initialize it with the begin of registry and is updated on each read */
-  in = contents;
+  in = (gchar *) contents;
   GST_DEBUG ("File data at address %p", in);
   if (G_UNLIKELY (size < sizeof (GstBinaryRegistryMagic))) {
     GST_ERROR ("No or broken registry header for file at %s", location);
@@ -577,7 +547,7 @@ priv_gst_registry_binary_read_cache (GstRegistry * registry,
   }
 
   if (!_priv_gst_registry_chunks_load_global_header (registry, &in,
-          contents + size, &filter_env_hash)) {
+          (gchar *) end, &filter_env_hash)) {
     GST_ERROR ("Couldn't read global header chunk");
     goto Error;
   }
@@ -590,19 +560,22 @@ priv_gst_registry_binary_read_cache (GstRegistry * registry,
 
   /* check if there are plugins in the file */
   if (G_UNLIKELY (!(((gsize) in + sizeof (GstRegistryChunkPluginElement)) <
-              (gsize) contents + size))) {
+              (gsize) end))) {
     GST_INFO ("No binary plugins structure to read");
     /* empty file, this is not an error */
   } else {
-    gchar *end = contents + size;
+    /* the features refer to the strings in the registry data instead of
+     * copying and parsing everything now, so keep it around */
+    keep_data = TRUE;
+
     /* read as long as we still have space for a GstRegistryChunkPluginElement */
-    for (;
-        ((gsize) in + sizeof (GstRegistryChunkPluginElement)) <
-        (gsize) contents + size;) {
+    for (; ((gsize) in + sizeof (GstRegistryChunkPluginElement)) <
+        (gsize) end;) {
       GST_DEBUG ("reading binary registry %" G_GSIZE_FORMAT "(%x)/%"
           G_GSIZE_FORMAT, (gsize) in - (gsize) contents,
           (guint) ((gsize) in - (gsize) contents), size);
-      if (!_priv_gst_registry_chunks_load_plugin (registry, &in, end, NULL)) {
+      if (!_priv_gst_registry_chunks_load_plugin (registry, &in,
+              (gchar *) end, NULL, TRUE)) {
         GST_ERROR ("Problem while reading binary registry %s", location);
         goto Error;
       }
@@ -619,16 +592,86 @@ done:
   GST_INFO ("loaded %s in %lf seconds", location, seconds);
 
   res = TRUE;
-  /* TODO: once we re-use the pointers to registry contents, return here */
 
 Error:
 #ifndef GST_DISABLE_GST_DEBUG
   g_timer_destroy (timer);
 #endif
-  if (mapped) {
-    g_mapped_file_unref (mapped);
+  /* plugins loaded before an error still refer to the data */
+  if (keep_data)
+    priv_gst_registry_keep_cache_data (registry, data);
+  else
+    g_bytes_unref (data);
+
+  return res;
+}
+
+/**
+ * gst_registry_binary_read_cache:
+ * @registry: a #GstRegistry
+ * @location: a filename
+ *
+ * Read the contents of the binary cache file at @location into @registry.
+ *
+ * Returns: %TRUE on success.
+ */
+gboolean
+priv_gst_registry_binary_read_cache (GstRegistry * registry,
+    const char *location)
+{
+  GMappedFile *mapped = NULL;
+  GBytes *data;
+  gchar *contents = NULL;
+  gsize size;
+  GError *err = NULL;
+
+  mapped = g_mapped_file_new (location, FALSE, &err);
+  if (G_UNLIKELY (err != NULL)) {
+    GST_INFO ("Unable to mmap file %s : %s", location, err->message);
+    g_error_free (err);
+    err = NULL;
+  }
+
+  if (mapped == NULL) {
+    /* Error mmap-ing the cache, try a plain memory read */
+
+    g_file_get_contents (location, &contents, &size, &err);
+    if (err != NULL) {
+      GST_INFO ("Unable to read file %s : %s", location, err->message);
+      g_error_free (err);
+      return FALSE;
+    }
+    data = g_bytes_new_take (contents, size);
   } else {
-    g_free (contents);
+    data = g_mapped_file_get_bytes (mapped);
+    g_mapped_file_unref (mapped);
   }
-  return res;
+
+  return gst_registry_binary_load_cache (registry, data, location);
+}
+
+/**
+ * gst_registry_binary_read_cache_data:
+ * @registry: a #GstRegistry
+ * @data: the contents of a binary cache file
+ * @size: the size of @data
+ *
+ * Read the registry cache in @data, which has to stay valid for the
+ * lifetime of the program, into @registry.
+ *
+ * Returns: %TRUE on success.
+ */
+gboolean
+priv_gst_registry_binary_read_cache_data (GstRegistry * registry,
+    const guint8 * data, gsize size)
+{
+  GBytes *bytes;
+
+  /* the chunks are aligned to pointers in memory, like in a mapped file */
+  if (G_LIKELY ((gsize) data % ALIGNMENT == 0))
+    bytes = g_bytes_new_static (data, size);
+  else
+    bytes = g_bytes_new (data, size);
+
+  return gst_registry_binary_load_cache (registry, bytes, "builtin cache");
 }
@@ -178,6 +178,42 @@ gst_registry_chunks_make_data (gpointer data, gulong size)
 }
 
 
+/*
+ * gst_registry_chunks_parse_magic:
+ *
+ * Parse a typefind magic saved as "offset:hexbytes".
+ *
+ * Returns: %TRUE for success
+ */
+static gboolean
+gst_registry_chunks_parse_magic (GstTypeFindFactory * factory,
+    const gchar * str)
+{
+  gchar *hex;
+  guint i, len;
+
+  factory->magic_offset = g_ascii_strtoll (str, &hex, 10);
+  if (*hex++ != ':')
+    return FALSE;
+
+  len = strlen (hex);
+  if (len == 0 || len % 2 != 0)
+    return FALSE;
+
+  factory->magic_len = len / 2;
+  factory->magic = g_malloc (factory->magic_len);
+  for (i = 0; i < factory->magic_len; i++) {
+    gint hi = g_ascii_xdigit_value (hex[2 * i]);
+    gint lo = g_ascii_xdigit_value (hex[2 * i + 1]);
+
+    if (hi < 0 || lo < 0)
+      return FALSE;
+    factory->magic[i] = (hi << 4) | lo;
+  }
+
+  return TRUE;
+}
+
 /*
  * gst_registry_chunks_save_pad_template:
  *
@@ -286,9 +322,13 @@ gst_registry_chunks_save_feature (GList ** list, GstPluginFeature * feature)
       }
     }
 
-    /* pack element metadata strings */
-    gst_registry_chunks_save_string (list,
-        gst_structure_to_string (factory->metadata));
+    /* pack element metadata strings, metadata that was never used since it
+     * was loaded from the cache can be saved as is */
+    if (factory->metadata == NULL && factory->metadata_string != NULL)
+      gst_registry_chunks_save_const_string (list, factory->metadata_string);
+    else
+      gst_registry_chunks_save_string (list,
+          gst_structure_to_string (factory->metadata));
   } else if (GST_IS_TYPE_FIND_FACTORY (feature)) {
     GstRegistryChunkTypeFindFactory *tff;
     GstTypeFindFactory *factory = GST_TYPE_FIND_FACTORY (feature);
@@ -312,7 +352,10 @@ gst_registry_chunks_save_feature (GList ** list, GstPluginFeature * feature)
     }
     GST_DEBUG_OBJECT (feature, "saved %d extensions", tff->nextensions);
     /* save caps */
-    if (factory->caps) {
+    if (factory->caps == NULL && factory->caps_string != NULL) {
+      /* still as loaded from the cache, so already simplified */
+      gst_registry_chunks_save_const_string (list, factory->caps_string);
+    } else if (factory->caps) {
       GstCaps *fcaps = gst_caps_ref (factory->caps);
       /* we simplify the caps before saving. This is a lot faster
        * when loading them later on */
@@ -324,6 +367,18 @@ gst_registry_chunks_save_feature (GList ** list, GstPluginFeature * feature)
     } else {
       gst_registry_chunks_save_const_string (list, "");
     }
+    /* save magic as "offset:hexbytes" */
+    if (factory->magic_len > 0) {
+      GString *s = g_string_new (NULL);
+      guint i;
+
+      g_string_printf (s, "%" G_GINT64_FORMAT ":", factory->magic_offset);
+      for (i = 0; i < factory->magic_len; i++)
+        g_string_append_printf (s, "%02x", factory->magic[i]);
+      gst_registry_chunks_save_string (list, g_string_free (s, FALSE));
+    } else {
+      gst_registry_chunks_save_const_string (list, "");
+    }
   } else if (GST_IS_DEVICE_PROVIDER_FACTORY (feature)) {
     GstRegistryChunkDeviceProviderFactory *tff;
     GstDeviceProviderFactory *factory = GST_DEVICE_PROVIDER_FACTORY (feature);
@@ -338,9 +393,13 @@ gst_registry_chunks_save_feature (GList ** list, GstPluginFeature * feature)
     pf = (GstRegistryChunkPluginFeature *) tff;
 
 
-    /* pack element metadata strings */
-    gst_registry_chunks_save_string (list,
-        gst_structure_to_string (factory->metadata));
+    /* pack element metadata strings, metadata that was never used since it
+     * was loaded from the cache can be saved as is */
+    if (factory->metadata == NULL && factory->metadata_string != NULL)
+      gst_registry_chunks_save_const_string (list, factory->metadata_string);
+    else
+      gst_registry_chunks_save_string (list,
+          gst_structure_to_string (factory->metadata));
   } else if (GST_IS_TRACER_FACTORY (feature)) {
     /* Initialize with zeroes because of struct padding and
      * valgrind complaining about copying unitialized memory
@@ -496,7 +555,7 @@ fail:
  */
 static gboolean
 gst_registry_chunks_load_pad_template (GstElementFactory * factory, gchar ** in,
-    gchar * end)
+    gchar * end, gboolean persistent)
 {
   GstRegistryChunkPadTemplate *pt;
   GstStaticPadTemplate *template = NULL;
@@ -511,9 +570,15 @@ gst_registry_chunks_load_pad_template (GstElementFactory * factory, gchar ** in,
   template->direction = (GstPadDirection) pt->direction;
   template->static_caps.caps = NULL;
 
-  /* unpack pad template strings */
-  unpack_const_string (*in, template->name_template, end, fail);
-  unpack_const_string (*in, template->static_caps.string, end, fail);
+  /* unpack pad template strings, they can be used in place when the
+   * registry data stays around */
+  if (persistent) {
+    unpack_string_nocopy (*in, template->name_template, end, fail);
+    unpack_string_nocopy (*in, template->static_caps.string, end, fail);
+  } else {
+    unpack_const_string (*in, template->name_template, end, fail);
+    unpack_const_string (*in, template->static_caps.string, end, fail);
+  }
 
   __gst_element_factory_add_static_pad_template (factory, template);
   GST_DEBUG ("Added pad_template %s", template->name_template);
@@ -535,7 +600,7 @@ fail:
  */
 static gboolean
 gst_registry_chunks_load_feature (GstRegistry * registry, gchar ** in,
-    gchar * end, GstPlugin * plugin)
+    gchar * end, GstPlugin * plugin, gboolean persistent)
 {
   GstRegistryChunkPluginFeature *pf = NULL;
   GstPluginFeature *feature = NULL;
@@ -593,7 +658,10 @@ gst_registry_chunks_load_feature (GstRegistry * registry, gchar ** in,
 
     /* unpack element factory strings */
     unpack_string_nocopy (*in, meta_data_str, end, fail);
-    if (meta_data_str && *meta_data_str) {
+    if (persistent && meta_data_str && *meta_data_str) {
+      /* parsed on first use */
+      factory->metadata_string = meta_data_str;
+    } else if (meta_data_str && *meta_data_str) {
       factory->metadata = gst_structure_from_string (meta_data_str, NULL);
       if (!factory->metadata) {
         GST_ERROR
@@ -608,7 +676,7 @@ gst_registry_chunks_load_feature (GstRegistry * registry, gchar ** in,
     /* load pad templates */
     for (i = 0; i < n; i++) {
       if (G_UNLIKELY (!gst_registry_chunks_load_pad_template (factory, in,
-                  end))) {
+                  end, persistent))) {
         GST_ERROR ("Error while loading binary pad template");
         goto fail;
       }
@@ -648,12 +716,21 @@ gst_registry_chunks_load_feature (GstRegistry * registry, gchar ** in,
     unpack_element (*in, tff, GstRegistryChunkTypeFindFactory, end, fail);
     pf = (GstRegistryChunkPluginFeature *) tff;
 
+    /* load typefinder magic */
+    unpack_string_nocopy (*in, const_str, end, fail);
+    if (const_str != NULL && *const_str != '\0') {
+      if (!gst_registry_chunks_parse_magic (factory, const_str))
+        goto fail;
+    }
+
     /* load typefinder caps */
     unpack_string_nocopy (*in, const_str, end, fail);
-    if (const_str != NULL && *const_str != '\0')
-      factory->caps = gst_caps_from_string (const_str);
-    else
+    if (const_str == NULL || *const_str == '\0')
       factory->caps = NULL;
+    else if (persistent)
+      factory->caps_string = const_str;
+    else
+      factory->caps = gst_caps_from_string (const_str);
 
     /* load extensions */
     if (tff->nextensions) {
@@ -682,7 +759,10 @@ gst_registry_chunks_load_feature (GstRegistry * registry, gchar ** in,
 
     /* unpack element factory strings */
     unpack_string_nocopy (*in, meta_data_str, end, fail);
-    if (meta_data_str && *meta_data_str) {
+    if (persistent && meta_data_str && *meta_data_str) {
+      /* parsed on first use */
+      factory->metadata_string = meta_data_str;
+    } else if (meta_data_str && *meta_data_str) {
       factory->metadata = gst_structure_from_string (meta_data_str, NULL);
       if (!factory->metadata) {
         GST_ERROR
@@ -794,10 +874,13 @@ fail:
  * Make a new GstPlugin from current GstRegistryChunkPluginElement structure
  * and add it to the GstRegistry. Return an offset to the next
  * GstRegistryChunkPluginElement structure.
+ *
+ * When @persistent is set, the data stays valid as long as @registry and
+ * the features refer to it and parse their metadata and caps on first use.
  */
 gboolean
 _priv_gst_registry_chunks_load_plugin (GstRegistry * registry, gchar ** in,
-    gchar * end, GstPlugin ** out_plugin)
+    gchar * end, GstPlugin ** out_plugin, gboolean persistent)
 {
 #ifndef GST_DISABLE_GST_DEBUG
   gchar *start = *in;
@@ -864,7 +947,7 @@ _priv_gst_registry_chunks_load_plugin (GstRegistry * registry, gchar ** in,
   /* Load plugin features */
   for (i = 0; i < n; i++) {
     if (G_UNLIKELY (!gst_registry_chunks_load_feature (registry, in, end,
-                plugin))) {
+                plugin, persistent))) {
       GST_ERROR ("Error while loading binary feature for plugin '%s'",
           GST_STR_NULL (plugin->desc.name));
       gst_registry_remove_plugin (registry, plugin);
@@ -0,0 +1,48 @@
+/* GStreamer
+ *
+ * gstsdt.h: static probe points for systemtap, bpftrace and perf
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __GST_SDT_H__
+#define __GST_SDT_H__
+
+/* The probes are a single nop in the code and some notes in the ELF file
+ * when no tool is attached, so they can stay in release builds. The
+ * arguments are still computed, keep them cheap. All probes are in the
+ * "gstreamer" provider, see docs/design/part-tracing.txt for the list. */
+
+#ifdef HAVE_SDT_PROBES
+
+#include <sys/sdt.h>
+
+#define GST_SDT_PROBE1(name,a) \
+  DTRACE_PROBE1 (gstreamer, name, a)
+#define GST_SDT_PROBE2(name,a,b) \
+  DTRACE_PROBE2 (gstreamer, name, a, b)
+#define GST_SDT_PROBE3(name,a,b,c) \
+  DTRACE_PROBE3 (gstreamer, name, a, b, c)
+
+#else /* !HAVE_SDT_PROBES */
+
+#define GST_SDT_PROBE1(name,a)
+#define GST_SDT_PROBE2(name,a,b)
+#define GST_SDT_PROBE3(name,a,b,c)
+
+#endif /* HAVE_SDT_PROBES */
+
+#endif /* __GST_SDT_H__ */
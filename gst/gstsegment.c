@@ -79,6 +79,12 @@
  * For elements that need to perform operations on media data in stream_time,
  * gst_segment_to_stream_time() can be used to convert a timestamp and the segment
  * info to stream time (which is always between 0 and the duration of the stream).
+ *
+ * Elements that convert the timestamps of every buffer can precompute the
+ * conversions of the segment once with gst_segment_transform_init() and use
+ * the inline gst_segment_transform_to_running_time() and
+ * gst_segment_transform_to_stream_time() functions or their array variants
+ * on the data path.
  */
 
 /**
@@ -1224,3 +1230,115 @@ gst_segment_is_equal (const GstSegment * s0, const GstSegment * s1)
     return FALSE;
   return TRUE;
 }
+
+/**
+ * gst_segment_transform_init:
+ * @trans: (out caller-allocates): a #GstSegmentTransform
+ * @segment: a #GstSegment
+ *
+ * Precompute the position conversions of @segment into @trans. Elements
+ * typically do this once for each SEGMENT event and then convert the
+ * timestamps of all the following buffers with @trans.
+ *
+ * @trans does not track later changes of @segment, it needs to be
+ * initialized again when the segment changes.
+ *
+ * Since: 1.10
+ */
+void
+gst_segment_transform_init (GstSegmentTransform * trans,
+    const GstSegment * segment)
+{
+  g_return_if_fail (trans != NULL);
+  g_return_if_fail (segment != NULL);
+
+  memset (trans, 0, sizeof (GstSegmentTransform));
+
+  trans->start = segment->start;
+  trans->stop = segment->stop;
+
+  trans->abs_rate = ABS (segment->rate);
+  trans->base = segment->base;
+  if (G_LIKELY (segment->rate > 0.0)) {
+    trans->rt_valid = TRUE;
+    trans->rt_forward = TRUE;
+    trans->rt_anchor = segment->start + segment->offset;
+  } else if (segment->stop != -1 && segment->stop >= segment->offset) {
+    trans->rt_valid = TRUE;
+    trans->rt_forward = FALSE;
+    trans->rt_anchor = segment->stop - segment->offset;
+  }
+
+  /* time must be known, and the stop with a negative applied rate */
+  trans->abs_applied_rate = ABS (segment->applied_rate);
+  trans->time = segment->time;
+  if (segment->time != -1) {
+    if (G_LIKELY (segment->applied_rate > 0.0)) {
+      trans->st_valid = TRUE;
+      trans->st_forward = TRUE;
+      trans->st_anchor = segment->start;
+    } else if (segment->stop != -1) {
+      trans->st_valid = TRUE;
+      trans->st_forward = FALSE;
+      trans->st_anchor = segment->stop;
+    }
+  }
+}
+
+/**
+ * gst_segment_transform_to_running_time_array:
+ * @trans: a #GstSegmentTransform
+ * @positions: (array length=n_positions): positions in the segment
+ * @running_times: (out caller-allocates) (array length=n_positions): the
+ *     resulting running times
+ * @n_positions: the number of positions
+ *
+ * Convert all @positions with gst_segment_transform_to_running_time().
+ * @running_times can be the same array as @positions.
+ *
+ * Since: 1.10
+ */
+void
+gst_segment_transform_to_running_time_array (const GstSegmentTransform *
+    trans, const guint64 * positions, guint64 * running_times,
+    guint n_positions)
+{
+  guint i;
+
+  g_return_if_fail (trans != NULL);
+  g_return_if_fail (positions != NULL || n_positions == 0);
+  g_return_if_fail (running_times != NULL || n_positions == 0);
+
+  for (i = 0; i < n_positions; i++)
+    running_times[i] =
+        gst_segment_transform_to_running_time (trans, positions[i]);
+}
+
+/**
+ * gst_segment_transform_to_stream_time_array:
+ * @trans: a #GstSegmentTransform
+ * @positions: (array length=n_positions): positions in the segment
+ * @stream_times: (out caller-allocates) (array length=n_positions): the
+ *     resulting stream times
+ * @n_positions: the number of positions
+ *
+ * Convert all @positions with gst_segment_transform_to_stream_time().
+ * @stream_times can be the same array as @positions.
+ *
+ * Since: 1.10
+ */
+void
+gst_segment_transform_to_stream_time_array (const GstSegmentTransform *
+    trans, const guint64 * positions, guint64 * stream_times,
+    guint n_positions)
+{
+  guint i;
+
+  g_return_if_fail (trans != NULL);
+  g_return_if_fail (positions != NULL || n_positions == 0);
+  g_return_if_fail (stream_times != NULL || n_positions == 0);
+
+  for (i = 0; i < n_positions; i++)
+    stream_times[i] =
+        gst_segment_transform_to_stream_time (trans, positions[i]);
+}
@@ -30,6 +30,7 @@ G_BEGIN_DECLS
 #define GST_TYPE_SEGMENT             (gst_segment_get_type())
 
 typedef struct _GstSegment GstSegment;
+typedef struct _GstSegmentTransform GstSegmentTransform;
 
 /**
  * GstSeekType:
@@ -209,6 +210,37 @@ struct _GstSegment {
   gpointer        _gst_reserved[GST_PADDING];
 };
 
+/**
+ * GstSegmentTransform:
+ *
+ * The position conversions of a #GstSegment, precomputed with
+ * gst_segment_transform_init() so that they can be applied to many
+ * positions without checking the segment values again.
+ *
+ * Since: 1.10
+ */
+struct _GstSegmentTransform {
+  /*< private >*/
+  guint64         start;
+  guint64         stop;
+
+  /* running time */
+  gboolean        rt_valid;
+  gboolean        rt_forward;
+  guint64         rt_anchor;
+  gdouble         abs_rate;
+  guint64         base;
+
+  /* stream time */
+  gboolean        st_valid;
+  gboolean        st_forward;
+  guint64         st_anchor;
+  gdouble         abs_applied_rate;
+  guint64         time;
+
+  gpointer        _gst_reserved[GST_PADDING];
+};
+
 GType        gst_segment_get_type            (void);
 
 GstSegment * gst_segment_new                 (void) G_GNUC_MALLOC;
@@ -246,6 +278,183 @@ gboolean     gst_segment_do_seek             (GstSegment * segment, gdouble rate
                                               GstSeekType stop_type, guint64 stop, gboolean * update);
 gboolean     gst_segment_is_equal            (const GstSegment * s0, const GstSegment * s1);
 
+void         gst_segment_transform_init      (GstSegmentTransform * trans, const GstSegment * segment);
+
+void         gst_segment_transform_to_running_time_array (const GstSegmentTransform * trans,
+                                                          const guint64 * positions,
+                                                          guint64 * running_times, guint n_positions);
+void         gst_segment_transform_to_stream_time_array  (const GstSegmentTransform * trans,
+                                                          const guint64 * positions,
+                                                          guint64 * stream_times, guint n_positions);
+
+/**
+ * gst_segment_transform_to_running_time_full:
+ * @trans: a #GstSegmentTransform
+ * @position: the position in the segment
+ * @running_time: (out): result running-time
+ *
+ * Does the same as gst_segment_to_running_time_full() with the segment
+ * @trans was initialized from.
+ *
+ * @running_time is set to -1 when 0 is returned.
+ *
+ * Returns: a 1 or -1 on success, 0 on failure.
+ *
+ * Since: 1.10
+ */
+static inline gint
+gst_segment_transform_to_running_time_full (const GstSegmentTransform * trans,
+    guint64 position, guint64 * running_time)
+{
+  guint64 result;
+  gint res;
+
+  if (G_UNLIKELY (position == (guint64) -1 || !trans->rt_valid)) {
+    *running_time = -1;
+    return 0;
+  }
+
+  /* bring to uncorrected position in segment */
+  if (G_LIKELY (trans->rt_forward)) {
+    if (position < trans->rt_anchor) {
+      result = trans->rt_anchor - position;
+      res = -1;
+    } else {
+      result = position - trans->rt_anchor;
+      res = 1;
+    }
+  } else {
+    if (position > trans->rt_anchor) {
+      result = position - trans->rt_anchor;
+      res = -1;
+    } else {
+      result = trans->rt_anchor - position;
+      res = 1;
+    }
+  }
+
+  if (G_UNLIKELY (trans->abs_rate != 1.0))
+    result /= trans->abs_rate;
+
+  /* correct for base of the segment */
+  if (res == 1) {
+    *running_time = result + trans->base;
+  } else if (trans->base >= result) {
+    *running_time = trans->base - result;
+    res = 1;
+  } else {
+    *running_time = result - trans->base;
+  }
+
+  return res;
+}
+
+/**
+ * gst_segment_transform_to_running_time:
+ * @trans: a #GstSegmentTransform
+ * @position: the position in the segment
+ *
+ * Does the same as gst_segment_to_running_time() with the segment @trans
+ * was initialized from.
+ *
+ * Returns: the position as the total running time or -1 when an invalid
+ * position was given.
+ *
+ * Since: 1.10
+ */
+static inline guint64
+gst_segment_transform_to_running_time (const GstSegmentTransform * trans,
+    guint64 position)
+{
+  guint64 result;
+
+  if (G_UNLIKELY (position < trans->start || position > trans->stop))
+    return -1;
+
+  if (gst_segment_transform_to_running_time_full (trans, position,
+          &result) == 1)
+    return result;
+
+  return -1;
+}
+
+/**
+ * gst_segment_transform_to_stream_time_full:
+ * @trans: a #GstSegmentTransform
+ * @position: the position in the segment
+ * @stream_time: (out): result stream-time
+ *
+ * Does the same as gst_segment_to_stream_time_full() with the segment
+ * @trans was initialized from.
+ *
+ * @stream_time is set to -1 when 0 is returned.
+ *
+ * Returns: a 1 or -1 on success, 0 on failure.
+ *
+ * Since: 1.10
+ */
+static inline gint
+gst_segment_transform_to_stream_time_full (const GstSegmentTransform * trans,
+    guint64 position, guint64 * stream_time)
+{
+  guint64 result;
+
+  if (G_UNLIKELY (position == (guint64) -1 || !trans->st_valid)) {
+    *stream_time = -1;
+    return 0;
+  }
+
+  /* the distance to the segment time, and whether it moves away from it */
+  if (trans->st_forward == (position > trans->st_anchor)) {
+    result = trans->st_forward ? position - trans->st_anchor :
+        trans->st_anchor - position;
+    if (G_UNLIKELY (trans->abs_applied_rate != 1.0))
+      result *= trans->abs_applied_rate;
+    *stream_time = result + trans->time;
+    return 1;
+  }
+
+  result = trans->st_forward ? trans->st_anchor - position :
+      position - trans->st_anchor;
+  if (G_UNLIKELY (trans->abs_applied_rate != 1.0))
+    result *= trans->abs_applied_rate;
+  if (result > trans->time) {
+    *stream_time = result - trans->time;
+    return -1;
+  }
+  *stream_time = trans->time - result;
+  return 1;
+}
+
+/**
+ * gst_segment_transform_to_stream_time:
+ * @trans: a #GstSegmentTransform
+ * @position: the position in the segment
+ *
+ * Does the same as gst_segment_to_stream_time() with the segment @trans
+ * was initialized from.
+ *
+ * Returns: the position in stream_time or -1 when an invalid position
+ * was given.
+ *
+ * Since: 1.10
+ */
+static inline guint64
+gst_segment_transform_to_stream_time (const GstSegmentTransform * trans,
+    guint64 position)
+{
+  guint64 result;
+
+  if (G_UNLIKELY (position < trans->start || position > trans->stop))
+    return -1;
+
+  if (gst_segment_transform_to_stream_time_full (trans, position,
+          &result) == 1)
+    return result;
+
+  return -1;
+}
+
 #ifdef G_DEFINE_AUTOPTR_CLEANUP_FUNC
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(GstSegment, gst_segment_free)
 #endif
@@ -89,14 +89,38 @@ typedef struct
   /* owned by parent structure, NULL if no parent */
   gint *parent_refcount;
 
-  GArray *fields;
+  guint fields_len;
+  guint fields_alloc;
+  /* points to arr while the fields fit in the inline storage */
+  GstStructureField *fields;
+  /* positions of the fields sorted by name, only kept for structures with
+   * more than STRUCTURE_INLINE_FIELDS fields, NULL otherwise */
+  guint *index;
+
+  /* serialized fields for the debug log, only set while the structure is
+   * shared and dropped by anything that modifies the fields */
+  gchar *fields_string;
+
+  /* number of fields in arr */
+  guint n_inline;
+  GstStructureField arr[1];
 } GstStructureImpl;
 
+/* minimum number of fields stored in the same allocation as the structure,
+ * this covers most caps and event structures */
+#define STRUCTURE_INLINE_FIELDS 8
+
+#define STRUCTURE_IMPL_SIZE(n_inline) \
+    (sizeof (GstStructureImpl) + ((n_inline) - 1) * sizeof (GstStructureField))
+
 #define GST_STRUCTURE_REFCOUNT(s) (((GstStructureImpl*)(s))->parent_refcount)
 #define GST_STRUCTURE_FIELDS(s) (((GstStructureImpl*)(s))->fields)
+#define GST_STRUCTURE_LEN(s) (((GstStructureImpl*)(s))->fields_len)
+#define GST_STRUCTURE_INDEX(s) (((GstStructureImpl*)(s))->index)
+#define GST_STRUCTURE_FIELDS_STRING(s) (((GstStructureImpl*)(s))->fields_string)
 
 #define GST_STRUCTURE_FIELD(structure, index) \
-    &g_array_index(GST_STRUCTURE_FIELDS(structure), GstStructureField, (index))
+    (&GST_STRUCTURE_FIELDS(structure)[(index)])
 
 #define IS_MUTABLE(structure) \
     (!GST_STRUCTURE_REFCOUNT(structure) || \
@@ -137,17 +161,140 @@ _priv_gst_structure_initialize (void)
       "GstStructure debug");
 }
 
+/* returns the position in the index of the first field with a name
+ * not smaller than @field_id */
+static guint
+gst_structure_index_search (const GstStructure * structure, GQuark field_id)
+{
+  const guint *index = GST_STRUCTURE_INDEX (structure);
+  guint lo = 0, hi = GST_STRUCTURE_LEN (structure);
+
+  while (lo < hi) {
+    guint mid = lo + (hi - lo) / 2;
+
+    if (GST_STRUCTURE_FIELD (structure, index[mid])->name < field_id)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return lo;
+}
+
+static gint
+gst_structure_index_compare (gconstpointer a, gconstpointer b,
+    gpointer user_data)
+{
+  GstStructure *structure = user_data;
+  GQuark qa = GST_STRUCTURE_FIELD (structure, *(const guint *) a)->name;
+  GQuark qb = GST_STRUCTURE_FIELD (structure, *(const guint *) b)->name;
+
+  return qa < qb ? -1 : (qa > qb ? 1 : 0);
+}
+
+static inline void
+gst_structure_fields_changed (GstStructure * structure)
+{
+  if (G_UNLIKELY (GST_STRUCTURE_FIELDS_STRING (structure))) {
+    g_free (GST_STRUCTURE_FIELDS_STRING (structure));
+    GST_STRUCTURE_FIELDS_STRING (structure) = NULL;
+  }
+}
+
+static void
+gst_structure_index_build (GstStructure * structure)
+{
+  GstStructureImpl *impl = (GstStructureImpl *) structure;
+  guint i;
+
+  impl->index = g_renew (guint, impl->index, impl->fields_alloc);
+  for (i = 0; i < impl->fields_len; i++)
+    impl->index[i] = i;
+  g_qsort_with_data (impl->index, impl->fields_len, sizeof (guint),
+      gst_structure_index_compare, structure);
+}
+
+/* appends @field without checking for an existing field with the same name.
+ * The field's value is not deeply copied. */
+static void
+gst_structure_append_field (GstStructure * structure,
+    const GstStructureField * field)
+{
+  GstStructureImpl *impl = (GstStructureImpl *) structure;
+  guint pos;
+
+  gst_structure_fields_changed (structure);
+
+  if (G_UNLIKELY (impl->fields_len == impl->fields_alloc)) {
+    impl->fields_alloc *= 2;
+    if (impl->fields == impl->arr) {
+      impl->fields = g_new (GstStructureField, impl->fields_alloc);
+      memcpy (impl->fields, impl->arr,
+          impl->fields_len * sizeof (GstStructureField));
+    } else {
+      impl->fields = g_renew (GstStructureField, impl->fields,
+          impl->fields_alloc);
+    }
+    if (impl->index)
+      impl->index = g_renew (guint, impl->index, impl->fields_alloc);
+  }
+
+  impl->fields[impl->fields_len++] = *field;
+
+  if (impl->index) {
+    pos = gst_structure_index_search (structure, field->name);
+    memmove (&impl->index[pos + 1], &impl->index[pos],
+        (impl->fields_len - 1 - pos) * sizeof (guint));
+    impl->index[pos] = impl->fields_len - 1;
+  } else if (G_UNLIKELY (impl->fields_len > STRUCTURE_INLINE_FIELDS)) {
+    gst_structure_index_build (structure);
+  }
+}
+
+/* removes the field at @idx, keeping the order of the other fields. The
+ * field's value must already be unset. */
+static void
+gst_structure_remove_field_index (GstStructure * structure, guint idx)
+{
+  GstStructureImpl *impl = (GstStructureImpl *) structure;
+  guint i, pos;
+
+  gst_structure_fields_changed (structure);
+
+  if (impl->index) {
+    /* the index loses the entry of the field, the positions behind it
+     * shift down */
+    pos = gst_structure_index_search (structure, impl->fields[idx].name);
+    memmove (&impl->index[pos], &impl->index[pos + 1],
+        (impl->fields_len - 1 - pos) * sizeof (guint));
+    for (i = 0; i < impl->fields_len - 1; i++) {
+      if (impl->index[i] > idx)
+        impl->index[i]--;
+    }
+  }
+
+  impl->fields_len--;
+  memmove (&impl->fields[idx], &impl->fields[idx + 1],
+      (impl->fields_len - idx) * sizeof (GstStructureField));
+}
+
 static GstStructure *
 gst_structure_new_id_empty_with_size (GQuark quark, guint prealloc)
 {
   GstStructureImpl *structure;
+  guint n_inline;
 
-  structure = g_slice_new (GstStructureImpl);
+  n_inline = MAX (prealloc, STRUCTURE_INLINE_FIELDS);
+
+  structure = g_slice_alloc (STRUCTURE_IMPL_SIZE (n_inline));
   ((GstStructure *) structure)->type = _gst_structure_type;
   ((GstStructure *) structure)->name = quark;
   GST_STRUCTURE_REFCOUNT (structure) = NULL;
-  GST_STRUCTURE_FIELDS (structure) =
-      g_array_sized_new (FALSE, FALSE, sizeof (GstStructureField), prealloc);
+  structure->fields_len = 0;
+  structure->fields_alloc = n_inline;
+  structure->fields = structure->arr;
+  structure->index = NULL;
+  structure->fields_string = NULL;
+  structure->n_inline = n_inline;
 
   GST_TRACE ("created structure %p", structure);
 
@@ -341,7 +488,7 @@ gst_structure_copy (const GstStructure * structure)
 
   g_return_val_if_fail (structure != NULL, NULL);
 
-  len = GST_STRUCTURE_FIELDS (structure)->len;
+  len = GST_STRUCTURE_LEN (structure);
   new_structure = gst_structure_new_id_empty_with_size (structure->name, len);
 
   for (i = 0; i < len; i++) {
@@ -351,7 +498,7 @@ gst_structure_copy (const GstStructure * structure)
 
     new_field.name = field->name;
     gst_value_init_and_copy (&new_field.value, &field->value);
-    g_array_append_val (GST_STRUCTURE_FIELDS (new_structure), new_field);
+    gst_structure_append_field (new_structure, &new_field);
   }
   GST_CAT_TRACE (GST_CAT_PERFORMANCE, "doing copy %p -> %p",
       structure, new_structure);
@@ -369,13 +516,14 @@ gst_structure_copy (const GstStructure * structure)
 void
 gst_structure_free (GstStructure * structure)
 {
+  GstStructureImpl *impl = (GstStructureImpl *) structure;
   GstStructureField *field;
   guint i, len;
 
   g_return_if_fail (structure != NULL);
   g_return_if_fail (GST_STRUCTURE_REFCOUNT (structure) == NULL);
 
-  len = GST_STRUCTURE_FIELDS (structure)->len;
+  len = GST_STRUCTURE_LEN (structure);
   for (i = 0; i < len; i++) {
     field = GST_STRUCTURE_FIELD (structure, i);
 
@@ -383,13 +531,16 @@ gst_structure_free (GstStructure * structure)
       g_value_unset (&field->value);
     }
   }
-  g_array_free (GST_STRUCTURE_FIELDS (structure), TRUE);
+  if (GST_STRUCTURE_FIELDS (structure) != impl->arr)
+    g_free (GST_STRUCTURE_FIELDS (structure));
+  g_free (GST_STRUCTURE_INDEX (structure));
+  g_free (GST_STRUCTURE_FIELDS_STRING (structure));
 #ifdef USE_POISONING
   memset (structure, 0xff, sizeof (GstStructure));
 #endif
   GST_TRACE ("free structure %p", structure);
 
-  g_slice_free1 (sizeof (GstStructureImpl), structure);
+  g_slice_free1 (STRUCTURE_IMPL_SIZE (impl->n_inline), structure);
 }
 
 /**
@@ -771,9 +922,6 @@ gst_structure_set_field (GstStructure * structure, GstStructureField * field)
 {
   GstStructureField *f;
   GType field_value_type;
-  guint i, len;
-
-  len = GST_STRUCTURE_FIELDS (structure)->len;
 
   field_value_type = G_VALUE_TYPE (&field->value);
   if (field_value_type == G_TYPE_STRING) {
@@ -824,17 +972,15 @@ gst_structure_set_field (GstStructure * structure, GstStructureField * field)
     }
   }
 
-  for (i = 0; i < len; i++) {
-    f = GST_STRUCTURE_FIELD (structure, i);
-
-    if (G_UNLIKELY (f->name == field->name)) {
-      g_value_unset (&f->value);
-      memcpy (f, field, sizeof (GstStructureField));
-      return;
-    }
+  f = gst_structure_id_get_field (structure, field->name);
+  if (G_UNLIKELY (f != NULL)) {
+    gst_structure_fields_changed (structure);
+    g_value_unset (&f->value);
+    memcpy (f, field, sizeof (GstStructureField));
+    return;
   }
 
-  g_array_append_val (GST_STRUCTURE_FIELDS (structure), *field);
+  gst_structure_append_field (structure, field);
 }
 
 /* If there is no field with the given ID, NULL is returned.
@@ -845,7 +991,18 @@ gst_structure_id_get_field (const GstStructure * structure, GQuark field_id)
   GstStructureField *field;
   guint i, len;
 
-  len = GST_STRUCTURE_FIELDS (structure)->len;
+  len = GST_STRUCTURE_LEN (structure);
+
+  if (G_UNLIKELY (GST_STRUCTURE_INDEX (structure) != NULL)) {
+    i = gst_structure_index_search (structure, field_id);
+    if (i < len) {
+      field = GST_STRUCTURE_FIELD (structure,
+          GST_STRUCTURE_INDEX (structure)[i]);
+      if (field->name == field_id)
+        return field;
+    }
+    return NULL;
+  }
 
   for (i = 0; i < len; i++) {
     field = GST_STRUCTURE_FIELD (structure, i);
@@ -939,7 +1096,7 @@ gst_structure_remove_field (GstStructure * structure, const gchar * fieldname)
   g_return_if_fail (IS_MUTABLE (structure));
 
   id = g_quark_from_string (fieldname);
-  len = GST_STRUCTURE_FIELDS (structure)->len;
+  len = GST_STRUCTURE_LEN (structure);
 
   for (i = 0; i < len; i++) {
     field = GST_STRUCTURE_FIELD (structure, i);
@@ -948,8 +1105,7 @@ gst_structure_remove_field (GstStructure * structure, const gchar * fieldname)
       if (G_IS_VALUE (&field->value)) {
         g_value_unset (&field->value);
       }
-      GST_STRUCTURE_FIELDS (structure) =
-          g_array_remove_index (GST_STRUCTURE_FIELDS (structure), i);
+      gst_structure_remove_field_index (structure, i);
       return;
     }
   }
@@ -1018,15 +1174,17 @@ gst_structure_remove_all_fields (GstStructure * structure)
   g_return_if_fail (structure != NULL);
   g_return_if_fail (IS_MUTABLE (structure));
 
-  for (i = GST_STRUCTURE_FIELDS (structure)->len - 1; i >= 0; i--) {
+  for (i = GST_STRUCTURE_LEN (structure) - 1; i >= 0; i--) {
     field = GST_STRUCTURE_FIELD (structure, i);
 
     if (G_IS_VALUE (&field->value)) {
       g_value_unset (&field->value);
     }
-    GST_STRUCTURE_FIELDS (structure) =
-        g_array_remove_index (GST_STRUCTURE_FIELDS (structure), i);
   }
+  GST_STRUCTURE_LEN (structure) = 0;
+  g_free (GST_STRUCTURE_INDEX (structure));
+  GST_STRUCTURE_INDEX (structure) = NULL;
+  gst_structure_fields_changed (structure);
 }
 
 /**
@@ -1069,7 +1227,7 @@ gst_structure_n_fields (const GstStructure * structure)
 {
   g_return_val_if_fail (structure != NULL, 0);
 
-  return GST_STRUCTURE_FIELDS (structure)->len;
+  return GST_STRUCTURE_LEN (structure);
 }
 
 /**
@@ -1087,7 +1245,7 @@ gst_structure_nth_field_name (const GstStructure * structure, guint index)
   GstStructureField *field;
 
   g_return_val_if_fail (structure != NULL, NULL);
-  g_return_val_if_fail (index < GST_STRUCTURE_FIELDS (structure)->len, NULL);
+  g_return_val_if_fail (index < GST_STRUCTURE_LEN (structure), NULL);
 
   field = GST_STRUCTURE_FIELD (structure, index);
 
@@ -1118,7 +1276,7 @@ gst_structure_foreach (const GstStructure * structure,
   g_return_val_if_fail (structure != NULL, FALSE);
   g_return_val_if_fail (func != NULL, FALSE);
 
-  len = GST_STRUCTURE_FIELDS (structure)->len;
+  len = GST_STRUCTURE_LEN (structure);
 
   for (i = 0; i < len; i++) {
     field = GST_STRUCTURE_FIELD (structure, i);
@@ -1155,7 +1313,9 @@ gst_structure_map_in_place (GstStructure * structure,
   g_return_val_if_fail (structure != NULL, FALSE);
   g_return_val_if_fail (IS_MUTABLE (structure), FALSE);
   g_return_val_if_fail (func != NULL, FALSE);
-  len = GST_STRUCTURE_FIELDS (structure)->len;
+  len = GST_STRUCTURE_LEN (structure);
+
+  gst_structure_fields_changed (structure);
 
   for (i = 0; i < len; i++) {
     field = GST_STRUCTURE_FIELD (structure, i);
@@ -1193,7 +1353,9 @@ gst_structure_filter_and_map_in_place (GstStructure * structure,
   g_return_if_fail (structure != NULL);
   g_return_if_fail (IS_MUTABLE (structure));
   g_return_if_fail (func != NULL);
-  len = GST_STRUCTURE_FIELDS (structure)->len;
+  len = GST_STRUCTURE_LEN (structure);
+
+  gst_structure_fields_changed (structure);
 
   for (i = 0; i < len;) {
     field = GST_STRUCTURE_FIELD (structure, i);
@@ -1204,9 +1366,8 @@ gst_structure_filter_and_map_in_place (GstStructure * structure,
       if (G_IS_VALUE (&field->value)) {
         g_value_unset (&field->value);
       }
-      GST_STRUCTURE_FIELDS (structure) =
-          g_array_remove_index (GST_STRUCTURE_FIELDS (structure), i);
-      len = GST_STRUCTURE_FIELDS (structure)->len;
+      gst_structure_remove_field_index (structure, i);
+      len = GST_STRUCTURE_LEN (structure);
     } else {
       i++;
     }
@@ -1853,7 +2014,7 @@ gst_structure_gtype_from_abbr (const char *type_name)
   }
 
   /* this is the fallback */
-  return g_type_from_name (type_name);
+  return _priv_gst_type_from_name (type_name);
 }
 
 static const char *
@@ -1911,7 +2072,7 @@ priv_gst_structure_append_to_gstring (const GstStructure * structure,
 
   g_return_val_if_fail (s != NULL, FALSE);
 
-  len = GST_STRUCTURE_FIELDS (structure)->len;
+  len = GST_STRUCTURE_LEN (structure);
   for (i = 0; i < len; i++) {
     char *t;
     GType type;
@@ -1941,6 +2102,40 @@ priv_gst_structure_append_to_gstring (const GstStructure * structure,
   return TRUE;
 }
 
+/* like priv_gst_structure_append_to_gstring(), but keeps the serialized
+ * fields around while the structure is shared so that logging the same caps
+ * or event again does not serialize all values again */
+void
+priv_gst_structure_append_to_gstring_cached (const GstStructure * structure,
+    GString * s)
+{
+  GstStructureImpl *impl = (GstStructureImpl *) structure;
+  gchar *str;
+
+  /* a mutable structure can change before it is logged the next time */
+  if (IS_MUTABLE (structure)) {
+    priv_gst_structure_append_to_gstring (structure, s);
+    return;
+  }
+
+  str = g_atomic_pointer_get (&impl->fields_string);
+  if (str == NULL) {
+    GString *tmp;
+
+    tmp = g_string_sized_new (STRUCTURE_ESTIMATED_STRING_LEN (structure));
+    priv_gst_structure_append_to_gstring (structure, tmp);
+    str = g_string_free (tmp, FALSE);
+
+    /* other threads can log the same structure at the same time */
+    if (!g_atomic_pointer_compare_and_exchange (&impl->fields_string, NULL,
+            str)) {
+      g_free (str);
+      str = g_atomic_pointer_get (&impl->fields_string);
+    }
+  }
+  g_string_append (s, str);
+}
+
 gboolean
 priv__gst_structure_append_template_to_gstring (GQuark field_id,
     const GValue * value, gpointer user_data)
@@ -2027,6 +2222,18 @@ gst_structure_to_string (const GstStructure * structure)
   return g_string_free (s, FALSE);
 }
 
+/* gst_structure_to_string() for the debug log */
+gchar *
+priv_gst_structure_to_string_cached (const GstStructure * structure)
+{
+  GString *s;
+
+  s = g_string_sized_new (STRUCTURE_ESTIMATED_STRING_LEN (structure));
+  g_string_append (s, g_quark_to_string (structure->name));
+  priv_gst_structure_append_to_gstring_cached (structure, s);
+  return g_string_free (s, FALSE);
+}
+
 /*
  * r will still point to the string. if end == next, the string will not be
  * null-terminated. In all other cases it will be.
@@ -2453,6 +2660,17 @@ priv_gst_structure_parse_name (gchar * str, gchar ** start, gchar ** end,
   return TRUE;
 }
 
+/* makes string values shared between copies of @structure */
+void
+priv_gst_structure_intern_strings (GstStructure * structure)
+{
+  guint i, len;
+
+  len = GST_STRUCTURE_LEN (structure);
+  for (i = 0; i < len; i++)
+    priv_gst_value_intern_strings (&GST_STRUCTURE_FIELD (structure, i)->value);
+}
+
 gboolean
 priv_gst_structure_parse_fields (gchar * str, gchar ** end,
     GstStructure * structure)
@@ -2582,6 +2800,138 @@ error:
   return NULL;
 }
 
+gboolean
+_priv_gst_structure_write_binary (GByteArray * array,
+    const GstStructure * structure)
+{
+  GstStructureField *field;
+  guint i, len;
+
+  len = GST_STRUCTURE_LEN (structure);
+
+  _priv_gst_binary_write_string (array, g_quark_to_string (structure->name));
+  _priv_gst_binary_write_uint (array, len);
+  for (i = 0; i < len; i++) {
+    field = GST_STRUCTURE_FIELD (structure, i);
+
+    _priv_gst_binary_write_string (array, g_quark_to_string (field->name));
+    if (!_priv_gst_value_write_binary (array, &field->value))
+      return FALSE;
+  }
+
+  return TRUE;
+}
+
+GstStructure *
+_priv_gst_structure_read_binary (GstBinaryReader * reader)
+{
+  GstStructure *structure;
+  const gchar *name;
+  guint64 i, len;
+
+  /* names are used in place, quarks copy them when needed */
+  if (!_priv_gst_binary_read_string (reader, &name) || name == NULL ||
+      !_priv_gst_binary_read_uint (reader, &len))
+    return NULL;
+
+  /* every field takes at least two bytes */
+  if (len > (reader->size - reader->pos) / 2)
+    return NULL;
+
+  structure = gst_structure_new_id_empty_with_size (g_quark_from_string (name),
+      len);
+
+  for (i = 0; i < len; i++) {
+    GValue value = G_VALUE_INIT;
+
+    if (!_priv_gst_binary_read_string (reader, &name) || name == NULL ||
+        !_priv_gst_value_read_binary (reader, &value))
+      goto error;
+
+    gst_structure_id_take_value (structure, g_quark_from_string (name),
+        &value);
+  }
+
+  return structure;
+
+error:
+  {
+    GST_WARNING ("invalid binary data for structure %s",
+        g_quark_to_string (structure->name));
+    gst_structure_free (structure);
+    return NULL;
+  }
+}
+
+/**
+ * gst_structure_serialize_binary:
+ * @structure: a #GstStructure
+ *
+ * Serializes @structure into a compact, versioned binary representation.
+ * The result can be turned back into an equal structure with
+ * gst_structure_deserialize_binary(), also in another process.
+ *
+ * Values of types without a dedicated binary representation are stored
+ * with gst_value_serialize().
+ *
+ * Returns: (transfer full) (nullable): the serialized @structure, or %NULL
+ *     if a value could not be serialized.
+ *
+ * Since: 1.10
+ */
+GBytes *
+gst_structure_serialize_binary (const GstStructure * structure)
+{
+  GByteArray *array;
+
+  g_return_val_if_fail (structure != NULL, NULL);
+
+  array = g_byte_array_new ();
+  _priv_gst_binary_write_version (array);
+  if (!_priv_gst_structure_write_binary (array, structure)) {
+    g_byte_array_unref (array);
+    return NULL;
+  }
+
+  return g_byte_array_free_to_bytes (array);
+}
+
+/**
+ * gst_structure_deserialize_binary:
+ * @data: (array length=size): data created with
+ *     gst_structure_serialize_binary()
+ * @size: the size of @data
+ * @consumed: (out) (allow-none): the number of bytes of @data that were used
+ *
+ * Creates a #GstStructure from its binary representation in @data.
+ * Strings are used in place while parsing, so @data is not copied.
+ *
+ * Free-function: gst_structure_free
+ *
+ * Returns: (transfer full) (nullable): a new #GstStructure or %NULL when
+ *     @data is not a valid serialized structure.
+ *
+ * Since: 1.10
+ */
+GstStructure *
+gst_structure_deserialize_binary (const guint8 * data, gsize size,
+    gsize * consumed)
+{
+  GstBinaryReader reader = { data, size, 0, 0 };
+  GstStructure *structure;
+
+  g_return_val_if_fail (data != NULL || size == 0, NULL);
+
+  if (!_priv_gst_binary_read_version (&reader))
+    return NULL;
+
+  structure = _priv_gst_structure_read_binary (&reader);
+  if (structure && consumed)
+    *consumed = reader.pos;
+
+  return structure;
+}
+
 static void
 gst_structure_transform_to_string (const GValue * src_value,
     GValue * dest_value)
@@ -3246,8 +3596,7 @@ gst_structure_is_equal (const GstStructure * structure1,
   if (structure1->name != structure2->name) {
     return FALSE;
   }
-  if (GST_STRUCTURE_FIELDS (structure1)->len !=
-      GST_STRUCTURE_FIELDS (structure2)->len) {
+  if (GST_STRUCTURE_LEN (structure1) != GST_STRUCTURE_LEN (structure2)) {
     return FALSE;
   }
 
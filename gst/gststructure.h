@@ -298,6 +298,12 @@ gchar *               gst_structure_to_string    (const GstStructure * structure
 GstStructure *        gst_structure_from_string  (const gchar * string,
                                                   gchar      ** end) G_GNUC_MALLOC;
 
+GBytes *              gst_structure_serialize_binary   (const GstStructure * structure);
+
+GstStructure *        gst_structure_deserialize_binary (const guint8 * data,
+                                                        gsize          size,
+                                                        gsize        * consumed) G_GNUC_MALLOC;
+
 gboolean              gst_structure_fixate_field_nearest_int      (GstStructure * structure,
                                                                    const char   * field_name,
                                                                    int            target);
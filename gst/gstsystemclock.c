@@ -41,6 +41,7 @@
 #include "gstsystemclock.h"
 #include "gstenumtypes.h"
 #include "gstpoll.h"
+#include "gsttaskpool.h"
 #include "gstutils.h"
 #include "glib-compat-private.h"
 
@@ -72,19 +73,37 @@
 #define GST_SYSTEM_CLOCK_TIMED_WAIT(clock,tv)   g_cond_timed_wait(GST_SYSTEM_CLOCK_GET_COND(clock),GST_OBJECT_GET_LOCK(clock),tv)
 #define GST_SYSTEM_CLOCK_BROADCAST(clock)       g_cond_broadcast(GST_SYSTEM_CLOCK_GET_COND(clock))
 
+/* a node in the binary heap of pending async entries. The time is copied
+ * from the entry when it is inserted, the seqnum keeps entries with the same
+ * time in insertion order. */
+typedef struct
+{
+  GstClockTime time;
+  guint64 seqnum;
+  GstClockEntry *entry;
+} GstSystemClockNode;
+
 struct _GstSystemClockPrivate
 {
   GThread *thread;              /* thread for async notify */
   gboolean stopping;
 
-  GList *entries;
+  GArray *entries;              /* binary min-heap of GstSystemClockNode */
+  guint64 entries_seqnum;
+  GPtrArray *expired;           /* entries fired together by the async thread */
   GCond entries_changed;
+  GstTaskPool *callback_pool;   /* pool for async callbacks, written with LOCK */
 
   GstClockType clock_type;
   GstPoll *timer;
   gint wakeup_count;            /* the number of entries with a pending wakeup */
   gboolean async_wakeup;        /* if the wakeup was because of a async list change */
 
+  /* written with LOCK */
+  GstClockTime precise_wait;    /* final part of waits done with clock_nanosleep */
+  GstClockTime spin_wait;       /* final part of waits done busy-waiting */
+  GstClockTime wakeup_error;    /* average lateness of waits */
+
 #ifdef G_OS_WIN32
   LARGE_INTEGER start;
   LARGE_INTEGER frequency;
@@ -108,10 +127,29 @@ struct _GstSystemClockPrivate
 #define DEFAULT_CLOCK_TYPE GST_CLOCK_TYPE_REALTIME
 #endif
 
+/* the CPU counter can be used as clock with gcc-compatible compilers, and
+ * the monotonic clock to calibrate it against */
+#if defined(__GNUC__) && defined(HAVE_POSIX_TIMERS) && \
+    defined(HAVE_CLOCK_GETTIME) && defined(HAVE_MONOTONIC_CLOCK) && \
+    (defined(__x86_64__) || defined(__i386__) || defined(__aarch64__))
+#define HAVE_TSC_CLOCK 1
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+#endif
+
+#define DEFAULT_PRECISE_WAIT 0
+#define DEFAULT_SPIN_WAIT 0
+#define MAX_SPIN_WAIT (GST_MSECOND)
+
 enum
 {
   PROP_0,
   PROP_CLOCK_TYPE,
+  PROP_PRECISE_WAIT,
+  PROP_SPIN_WAIT,
+  PROP_WAKEUP_ERROR,
+  PROP_CALLBACK_POOL
   /* FILL ME */
 };
 
@@ -139,6 +177,8 @@ static void gst_system_clock_id_unschedule (GstClock * clock,
 static void gst_system_clock_async_thread (GstClock * clock);
 static gboolean gst_system_clock_start_async (GstSystemClock * clock);
 static void gst_system_clock_add_wakeup (GstSystemClock * sysclock);
+static void gst_system_clock_insert_entry (GstSystemClock * sysclock,
+    GstClockEntry * entry);
 
 static GMutex _gst_sysclock_mutex;
 
@@ -168,6 +208,68 @@ gst_system_clock_class_init (GstSystemClockClass * klass)
           GST_TYPE_CLOCK_TYPE, DEFAULT_CLOCK_TYPE,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstSystemClock:precise-wait:
+   *
+   * The final part of every wait, in nanoseconds, that is not done by
+   * waiting on a timer with the usual scheduler slack but by a high
+   * resolution sleep against the absolute deadline. 0 disables this.
+   *
+   * Since: 1.10
+   */
+  g_object_class_install_property (gobject_class, PROP_PRECISE_WAIT,
+      g_param_spec_uint64 ("precise-wait", "Precise wait",
+          "Final part of waits done with a high resolution sleep",
+          0, GST_SECOND, DEFAULT_PRECISE_WAIT,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstSystemClock:spin-wait:
+   *
+   * The final part of every wait, in nanoseconds, that is done by
+   * busy-waiting on the clock. This gives the most accurate wakeups at the
+   * cost of CPU time. 0 disables this.
+   *
+   * Since: 1.10
+   */
+  g_object_class_install_property (gobject_class, PROP_SPIN_WAIT,
+      g_param_spec_uint64 ("spin-wait", "Spin wait",
+          "Final part of waits done busy-waiting",
+          0, MAX_SPIN_WAIT, DEFAULT_SPIN_WAIT,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstSystemClock:wakeup-error:
+   *
+   * The running average of how late blocking waits on this clock woke up,
+   * in nanoseconds.
+   *
+   * Since: 1.10
+   */
+  g_object_class_install_property (gobject_class, PROP_WAKEUP_ERROR,
+      g_param_spec_uint64 ("wakeup-error", "Wakeup error",
+          "Average lateness of wakeups", 0, G_MAXUINT64, 0,
+          G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstSystemClock:callback-pool:
+   *
+   * A #GstTaskPool to run the callbacks of expired async clock ids on. By
+   * default the callbacks run one after another on the thread that waits
+   * for all async clock ids, so a slow callback delays every other timer.
+   *
+   * Callbacks of the same periodic clock id are never run at the same time
+   * and stay in order, the id is only scheduled again after its previous
+   * callback returned. The pool has to be prepared and must not require its
+   * functions to be joined, like #GstTaskPool and #GstWorkStealingTaskPool.
+   *
+   * Since: 1.10
+   */
+  g_object_class_install_property (gobject_class, PROP_CALLBACK_POOL,
+      g_param_spec_object ("callback-pool", "Callback pool",
+          "Pool for running async clock callbacks (NULL = the clock thread)",
+          GST_TYPE_TASK_POOL, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gstclock_class->get_internal_time = gst_system_clock_get_internal_time;
   gstclock_class->get_resolution = gst_system_clock_get_resolution;
   gstclock_class->wait = gst_system_clock_id_wait_jitter;
@@ -190,8 +292,11 @@ gst_system_clock_init (GstSystemClock * clock)
 
   priv->clock_type = DEFAULT_CLOCK_TYPE;
   priv->timer = gst_poll_new_timer ();
+  priv->precise_wait = DEFAULT_PRECISE_WAIT;
+  priv->spin_wait = DEFAULT_SPIN_WAIT;
 
-  priv->entries = NULL;
+  priv->entries = g_array_new (FALSE, FALSE, sizeof (GstSystemClockNode));
+  priv->expired = g_ptr_array_new ();
   g_cond_init (&priv->entries_changed);
 
 #ifdef G_OS_WIN32
@@ -220,14 +325,15 @@ gst_system_clock_dispose (GObject * object)
   GstClock *clock = (GstClock *) object;
   GstSystemClock *sysclock = GST_SYSTEM_CLOCK_CAST (clock);
   GstSystemClockPrivate *priv = sysclock->priv;
-  GList *entries;
+  guint i;
 
   /* else we have to stop the thread */
   GST_OBJECT_LOCK (clock);
   priv->stopping = TRUE;
   /* unschedule all entries */
-  for (entries = priv->entries; entries; entries = g_list_next (entries)) {
-    GstClockEntry *entry = (GstClockEntry *) entries->data;
+  for (i = 0; i < priv->entries->len; i++) {
+    GstClockEntry *entry =
+        g_array_index (priv->entries, GstSystemClockNode, i).entry;
 
     GST_CAT_DEBUG (GST_CAT_CLOCK, "unscheduling entry %p", entry);
     SET_ENTRY_STATUS (entry, GST_CLOCK_UNSCHEDULED);
@@ -241,13 +347,21 @@ gst_system_clock_dispose (GObject * object)
   priv->thread = NULL;
   GST_CAT_DEBUG (GST_CAT_CLOCK, "joined thread");
 
-  g_list_foreach (priv->entries, (GFunc) gst_clock_id_unref, NULL);
-  g_list_free (priv->entries);
+  for (i = 0; i < priv->entries->len; i++)
+    gst_clock_id_unref (g_array_index (priv->entries, GstSystemClockNode,
+            i).entry);
+  g_array_free (priv->entries, TRUE);
   priv->entries = NULL;
+  g_ptr_array_free (priv->expired, TRUE);
+  priv->expired = NULL;
 
   gst_poll_free (priv->timer);
   g_cond_clear (&priv->entries_changed);
 
+  if (priv->callback_pool)
+    gst_object_unref (priv->callback_pool);
+  priv->callback_pool = NULL;
+
   G_OBJECT_CLASS (parent_class)->dispose (object);
 
   if (_the_system_clock == clock) {
@@ -264,10 +378,37 @@ gst_system_clock_set_property (GObject * object, guint prop_id,
 
   switch (prop_id) {
     case PROP_CLOCK_TYPE:
+#ifdef HAVE_TSC_CLOCK
+      /* calibrate now and not on the first use */
+      if (g_value_get_enum (value) == GST_CLOCK_TYPE_TSC)
+        gst_system_clock_calibrate_tsc ();
+#endif
       sysclock->priv->clock_type = (GstClockType) g_value_get_enum (value);
       GST_CAT_DEBUG (GST_CAT_CLOCK, "clock-type set to %d",
           sysclock->priv->clock_type);
       break;
+    case PROP_PRECISE_WAIT:
+      GST_OBJECT_LOCK (sysclock);
+      sysclock->priv->precise_wait = g_value_get_uint64 (value);
+      GST_OBJECT_UNLOCK (sysclock);
+      break;
+    case PROP_SPIN_WAIT:
+      GST_OBJECT_LOCK (sysclock);
+      sysclock->priv->spin_wait = g_value_get_uint64 (value);
+      GST_OBJECT_UNLOCK (sysclock);
+      break;
+    case PROP_CALLBACK_POOL:{
+      GstTaskPool *old;
+
+      GST_OBJECT_LOCK (sysclock);
+      old = sysclock->priv->callback_pool;
+      sysclock->priv->callback_pool = g_value_dup_object (value);
+      GST_OBJECT_UNLOCK (sysclock);
+      /* without the lock, the pool might wait for our callbacks */
+      if (old)
+        gst_object_unref (old);
+      break;
+    }
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -284,6 +425,26 @@ gst_system_clock_get_property (GObject * object, guint prop_id, GValue * value,
     case PROP_CLOCK_TYPE:
       g_value_set_enum (value, sysclock->priv->clock_type);
       break;
+    case PROP_PRECISE_WAIT:
+      GST_OBJECT_LOCK (sysclock);
+      g_value_set_uint64 (value, sysclock->priv->precise_wait);
+      GST_OBJECT_UNLOCK (sysclock);
+      break;
+    case PROP_SPIN_WAIT:
+      GST_OBJECT_LOCK (sysclock);
+      g_value_set_uint64 (value, sysclock->priv->spin_wait);
+      GST_OBJECT_UNLOCK (sysclock);
+      break;
+    case PROP_WAKEUP_ERROR:
+      GST_OBJECT_LOCK (sysclock);
+      g_value_set_uint64 (value, sysclock->priv->wakeup_error);
+      GST_OBJECT_UNLOCK (sysclock);
+      break;
+    case PROP_CALLBACK_POOL:
+      GST_OBJECT_LOCK (sysclock);
+      g_value_set_object (value, sysclock->priv->callback_pool);
+      GST_OBJECT_UNLOCK (sysclock);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -418,6 +579,226 @@ gst_system_clock_wait_wakeup (GstSystemClock * sysclock)
   }
 }
 
+#define NODE_BEFORE(a,b) ((a)->time < (b)->time || \
+    ((a)->time == (b)->time && (a)->seqnum < (b)->seqnum))
+
+/* binary heap of async entries, sorted on time. All of these must be called
+ * with the object lock held */
+static void
+gst_system_clock_heap_sift_up (GArray * heap, guint idx)
+{
+  GstSystemClockNode *nodes = (GstSystemClockNode *) heap->data;
+  GstSystemClockNode node = nodes[idx];
+
+  while (idx > 0) {
+    guint parent = (idx - 1) / 2;
+
+    if (!NODE_BEFORE (&node, &nodes[parent]))
+      break;
+    nodes[idx] = nodes[parent];
+    idx = parent;
+  }
+  nodes[idx] = node;
+}
+
+static void
+gst_system_clock_heap_sift_down (GArray * heap, guint idx)
+{
+  GstSystemClockNode *nodes = (GstSystemClockNode *) heap->data;
+  GstSystemClockNode node = nodes[idx];
+  guint len = heap->len;
+
+  while (TRUE) {
+    guint child = 2 * idx + 1;
+
+    if (child >= len)
+      break;
+    if (child + 1 < len && NODE_BEFORE (&nodes[child + 1], &nodes[child]))
+      child++;
+    if (!NODE_BEFORE (&nodes[child], &node))
+      break;
+    nodes[idx] = nodes[child];
+    idx = child;
+  }
+  nodes[idx] = node;
+}
+
+/* takes ownership of the ref on @entry */
+static void
+gst_system_clock_heap_push (GstSystemClock * sysclock, GstClockEntry * entry)
+{
+  GstSystemClockPrivate *priv = sysclock->priv;
+  GstSystemClockNode node;
+
+  node.time = GST_CLOCK_ENTRY_TIME (entry);
+  node.seqnum = priv->entries_seqnum++;
+  node.entry = entry;
+
+  g_array_append_val (priv->entries, node);
+  gst_system_clock_heap_sift_up (priv->entries, priv->entries->len - 1);
+}
+
+static inline GstSystemClockNode *
+gst_system_clock_heap_peek (GstSystemClock * sysclock)
+{
+  GArray *heap = sysclock->priv->entries;
+
+  if (heap->len == 0)
+    return NULL;
+
+  return &g_array_index (heap, GstSystemClockNode, 0);
+}
+
+/* removes @entry from the heap, the ref is transfered to the caller. The
+ * entry is usually at the top of the heap, only when new entries were added
+ * in front of it the heap needs to be searched. */
+static gboolean
+gst_system_clock_heap_remove (GstSystemClock * sysclock, GstClockEntry * entry)
+{
+  GArray *heap = sysclock->priv->entries;
+  GstSystemClockNode *nodes = (GstSystemClockNode *) heap->data;
+  guint idx, last;
+
+  for (idx = 0; idx < heap->len; idx++) {
+    if (nodes[idx].entry == entry)
+      break;
+  }
+  if (G_UNLIKELY (idx == heap->len))
+    return FALSE;
+
+  last = heap->len - 1;
+  if (idx != last) {
+    nodes[idx] = nodes[last];
+    g_array_set_size (heap, last);
+    gst_system_clock_heap_sift_down (heap, idx);
+    gst_system_clock_heap_sift_up (heap, idx);
+  } else {
+    g_array_set_size (heap, last);
+  }
+  return TRUE;
+}
+
+/* runs the callback of @entry on the callback pool. Periodic entries are only
+ * put back in the heap afterwards, which keeps their callbacks in order. */
+static void
+gst_system_clock_dispatch_func (GstClockEntry * entry)
+{
+  GstClock *clock = entry->clock;
+  GstSystemClock *sysclock = GST_SYSTEM_CLOCK_CAST (clock);
+
+  entry->func (clock, entry->time, (GstClockID) entry, entry->user_data);
+
+  GST_OBJECT_LOCK (clock);
+  if (entry->type == GST_CLOCK_ENTRY_PERIODIC && !sysclock->priv->stopping &&
+      GET_ENTRY_STATUS (entry) != GST_CLOCK_UNSCHEDULED) {
+    GST_CAT_DEBUG (GST_CAT_CLOCK, "updating periodic entry %p", entry);
+    entry->time += entry->interval;
+    gst_system_clock_insert_entry (sysclock, entry);
+    entry = NULL;
+  }
+  GST_OBJECT_UNLOCK (clock);
+
+  if (entry)
+    gst_clock_id_unref ((GstClockID) entry);
+  gst_object_unref (clock);
+}
+
+/* takes ownership of the ref on @entry, call without the LOCK. When the pool
+ * fails the callback is run right here. */
+static void
+gst_system_clock_dispatch (GstSystemClock * sysclock, GstTaskPool * pool,
+    GstClockEntry * entry)
+{
+  GError *err = NULL;
+
+  GST_CAT_DEBUG (GST_CAT_CLOCK, "dispatching async entry %p", entry);
+
+  gst_object_ref (sysclock);
+  gst_task_pool_push (pool,
+      (GstTaskPoolFunction) gst_system_clock_dispatch_func, entry, &err);
+  if (G_UNLIKELY (err != NULL)) {
+    GST_CAT_WARNING (GST_CAT_CLOCK, "failed to dispatch entry %p: %s", entry,
+        err->message);
+    g_error_free (err);
+    gst_system_clock_dispatch_func (entry);
+  }
+}
+
+/* fire all the entries that expired at @now in one go instead of waiting
+ * for them one by one. Must be called with the object lock held, which is
+ * released while calling the callbacks. */
+static void
+gst_system_clock_fire_expired (GstClock * clock, GstClockTime now)
+{
+  GstSystemClock *sysclock = GST_SYSTEM_CLOCK_CAST (clock);
+  GstSystemClockPrivate *priv = sysclock->priv;
+  GPtrArray *expired = priv->expired;
+  GstSystemClockNode *node;
+  GstTaskPool *pool;
+  guint i;
+
+  while ((node = gst_system_clock_heap_peek (sysclock)) && node->time <= now) {
+    GstClockEntry *entry = node->entry;
+    GstClockReturn status, res;
+
+    res = node->time == now ? GST_CLOCK_OK : GST_CLOCK_EARLY;
+    gst_system_clock_heap_remove (sysclock, entry);
+    do {
+      status = GET_ENTRY_STATUS (entry);
+      if (G_UNLIKELY (status == GST_CLOCK_UNSCHEDULED))
+        break;
+    } while (G_UNLIKELY (!CAS_ENTRY_STATUS (entry, status, res)));
+
+    if (G_UNLIKELY (status == GST_CLOCK_UNSCHEDULED)) {
+      GST_CAT_DEBUG (GST_CAT_CLOCK, "async entry %p unscheduled", entry);
+      gst_clock_id_unref ((GstClockID) entry);
+      continue;
+    }
+    g_ptr_array_add (expired, entry);
+  }
+
+  if (expired->len == 0)
+    return;
+
+  GST_CAT_DEBUG (GST_CAT_CLOCK, "firing %u expired async entries",
+      expired->len);
+
+  pool = priv->callback_pool ? gst_object_ref (priv->callback_pool) : NULL;
+  GST_OBJECT_UNLOCK (clock);
+  for (i = 0; i < expired->len; i++) {
+    GstClockEntry *entry = g_ptr_array_index (expired, i);
+
+    if (!entry->func)
+      continue;
+
+    if (pool) {
+      gst_system_clock_dispatch (sysclock, pool, entry);
+      g_ptr_array_index (expired, i) = NULL;
+    } else {
+      entry->func (clock, entry->time, (GstClockID) entry, entry->user_data);
+    }
+  }
+  if (pool)
+    gst_object_unref (pool);
+  GST_OBJECT_LOCK (clock);
+
+  for (i = 0; i < expired->len; i++) {
+    GstClockEntry *entry = g_ptr_array_index (expired, i);
+
+    if (entry == NULL)
+      continue;
+
+    if (entry->type == GST_CLOCK_ENTRY_PERIODIC) {
+      GST_CAT_DEBUG (GST_CAT_CLOCK, "updating periodic entry %p", entry);
+      entry->time += entry->interval;
+      gst_system_clock_heap_push (sysclock, entry);
+    } else {
+      gst_clock_id_unref ((GstClockID) entry);
+    }
+  }
+  g_ptr_array_set_size (expired, 0);
+}
+
 /* this thread reads the sorted clock entries from the queue.
  *
  * It waits on each of them and fires the callback when the timeout occurs.
@@ -444,11 +825,11 @@ gst_system_clock_async_thread (GstClock * clock)
   /* now enter our (almost) infinite loop */
   while (!priv->stopping) {
     GstClockEntry *entry;
-    GstClockTime requested;
+    GstClockTime requested, now;
     GstClockReturn res;
 
     /* check if something to be done */
-    while (priv->entries == NULL) {
+    while (priv->entries->len == 0) {
       GST_CAT_DEBUG (GST_CAT_CLOCK, "no clock entries, waiting..");
       /* wait for work to do */
       GST_SYSTEM_CLOCK_WAIT (clock);
@@ -467,7 +848,7 @@ gst_system_clock_async_thread (GstClock * clock)
     }
 
     /* pick the next entry */
-    entry = priv->entries->data;
+    entry = gst_system_clock_heap_peek (sysclock)->entry;
 
     /* set entry status to busy before we release the clock lock */
     do {
@@ -511,26 +892,41 @@ gst_system_clock_async_thread (GstClock * clock)
         /* entry timed out normally, fire the callback and move to the next
          * entry */
         GST_CAT_DEBUG (GST_CAT_CLOCK, "async entry %p timed out", entry);
-        if (entry->func) {
-          /* unlock before firing the callback */
+        if (entry->func && priv->callback_pool) {
+          GstTaskPool *pool = gst_object_ref (priv->callback_pool);
+
+          /* the pool puts periodic entries back when the callback is done */
+          gst_system_clock_heap_remove (sysclock, entry);
           GST_OBJECT_UNLOCK (clock);
-          entry->func (clock, entry->time, (GstClockID) entry,
-              entry->user_data);
+          gst_system_clock_dispatch (sysclock, pool, entry);
+          gst_object_unref (pool);
           GST_OBJECT_LOCK (clock);
-        }
-        if (entry->type == GST_CLOCK_ENTRY_PERIODIC) {
-          GST_CAT_DEBUG (GST_CAT_CLOCK, "updating periodic entry %p", entry);
-          /* adjust time now */
-          entry->time = requested + entry->interval;
-          /* and resort the list now */
-          priv->entries =
-              g_list_sort (priv->entries, gst_clock_id_compare_func);
-          /* and restart */
-          continue;
         } else {
-          GST_CAT_DEBUG (GST_CAT_CLOCK, "moving to next entry");
-          goto next_entry;
+          if (entry->func) {
+            /* unlock before firing the callback */
+            GST_OBJECT_UNLOCK (clock);
+            entry->func (clock, entry->time, (GstClockID) entry,
+                entry->user_data);
+            GST_OBJECT_LOCK (clock);
+          }
+          gst_system_clock_heap_remove (sysclock, entry);
+          if (entry->type == GST_CLOCK_ENTRY_PERIODIC) {
+            GST_CAT_DEBUG (GST_CAT_CLOCK, "updating periodic entry %p", entry);
+            /* adjust time now and put it back in the heap */
+            entry->time = requested + entry->interval;
+            gst_system_clock_heap_push (sysclock, entry);
+          } else {
+            gst_clock_id_unref ((GstClockID) entry);
+          }
         }
+        /* other entries might have expired while we were waiting or calling
+         * the callback, fire them all now */
+        GST_OBJECT_UNLOCK (clock);
+        now = gst_clock_get_time (clock);
+        GST_OBJECT_LOCK (clock);
+        gst_system_clock_fire_expired (clock, now);
+        GST_CAT_DEBUG (GST_CAT_CLOCK, "moving to next entry");
+        continue;
       }
       case GST_CLOCK_BUSY:
         /* somebody unlocked the entry but is was not canceled, This means that
@@ -553,8 +949,8 @@ gst_system_clock_async_thread (GstClock * clock)
     }
   next_entry:
     /* we remove the current entry and unref it */
-    priv->entries = g_list_remove (priv->entries, entry);
-    gst_clock_id_unref ((GstClockID) entry);
+    if (gst_system_clock_heap_remove (sysclock, entry))
+      gst_clock_id_unref ((GstClockID) entry);
   }
 exit:
   /* signal exit */
@@ -568,7 +964,9 @@ static inline clockid_t
 clock_type_to_posix_id (GstClockType clock_type)
 {
 #ifdef HAVE_MONOTONIC_CLOCK
-  if (clock_type == GST_CLOCK_TYPE_MONOTONIC)
+  /* also used for TSC when the CPU doesn't have a usable one */
+  if (clock_type == GST_CLOCK_TYPE_MONOTONIC
+      || clock_type == GST_CLOCK_TYPE_TSC)
     return CLOCK_MONOTONIC;
   else
 #endif
@@ -576,10 +974,124 @@ clock_type_to_posix_id (GstClockType clock_type)
 }
 #endif
 
+#ifdef HAVE_TSC_CLOCK
+/* The counter is converted to nanoseconds as
+ *   base_time + (counter - base_counter) * mult / 2^shift
+ * with base_time the monotonic time at base_counter. mult fits in 32 bits
+ * and the multiplication is split in two so that it can't overflow. */
+typedef struct
+{
+  gboolean usable;
+  guint64 base_counter;
+  GstClockTime base_time;
+  guint64 mult;
+  guint shift;
+} GstTscCalibration;
+
+static GstTscCalibration tsc_calibration;
+
+static inline guint64
+gst_system_clock_read_counter (void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+  return __builtin_ia32_rdtsc ();
+#else
+  guint64 val;
+
+  __asm__ __volatile__ ("isb; mrs %0, cntvct_el0":"=r" (val));
+  return val;
+#endif
+}
+
+static inline GstClockTime
+gst_system_clock_get_monotonic (void)
+{
+  struct timespec ts;
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return GST_TIMESPEC_TO_TIME (ts);
+}
+
+/* read the monotonic time and the counter as close together as possible */
+static void
+gst_system_clock_sample_counter (guint64 * counter, GstClockTime * time)
+{
+  guint64 before, after;
+
+  before = gst_system_clock_read_counter ();
+  *time = gst_system_clock_get_monotonic ();
+  after = gst_system_clock_read_counter ();
+  *counter = before + (after - before) / 2;
+}
+
+static void
+gst_system_clock_calibrate_tsc (void)
+{
+  static gsize calibrated = 0;
+
+  if (g_once_init_enter (&calibrated)) {
+    GstTscCalibration *cal = &tsc_calibration;
+    guint64 counter, freq = 0;
+    GstClockTime time;
+
+#if defined(__x86_64__) || defined(__i386__)
+    {
+      guint eax, ebx, ecx, edx;
+
+      /* invariant TSC: runs at a constant rate in all P, C and T states */
+      if (__get_cpuid (0x80000007, &eax, &ebx, &ecx, &edx) && (edx & (1 << 8))) {
+        /* no reliable way to get the frequency, measure it */
+        gst_system_clock_sample_counter (&cal->base_counter, &cal->base_time);
+        g_usleep (20000);
+        gst_system_clock_sample_counter (&counter, &time);
+        if (counter > cal->base_counter && time > cal->base_time)
+          freq = gst_util_uint64_scale (counter - cal->base_counter,
+              GST_SECOND, time - cal->base_time);
+      }
+    }
+#else
+    __asm__ __volatile__ ("mrs %0, cntfrq_el0":"=r" (freq));
+    gst_system_clock_sample_counter (&cal->base_counter, &cal->base_time);
+#endif
+
+    if (freq >= 1000000) {
+      cal->shift = 32;
+      while ((cal->mult = (GST_SECOND << cal->shift) / freq) > G_MAXUINT32)
+        cal->shift--;
+      cal->usable = TRUE;
+      GST_CAT_INFO (GST_CAT_CLOCK, "using CPU counter running at %"
+          G_GUINT64_FORMAT " Hz", freq);
+    } else {
+      GST_CAT_INFO (GST_CAT_CLOCK, "no usable CPU counter, using the "
+          "monotonic clock");
+    }
+
+    g_once_init_leave (&calibrated, 1);
+  }
+}
+
+static inline GstClockTime
+gst_system_clock_get_tsc_time (void)
+{
+  guint64 delta = gst_system_clock_read_counter () -
+      tsc_calibration.base_counter;
+  guint shift = tsc_calibration.shift;
+
+  return tsc_calibration.base_time + (delta >> shift) * tsc_calibration.mult +
+      (((delta & ((G_GUINT64_CONSTANT (1) << shift) - 1)) *
+          tsc_calibration.mult) >> shift);
+}
+#endif
+
 /* MT safe */
 static GstClockTime
 gst_system_clock_get_internal_time (GstClock * clock)
 {
+#ifdef HAVE_TSC_CLOCK
+  if (GST_SYSTEM_CLOCK_CAST (clock)->priv->clock_type == GST_CLOCK_TYPE_TSC
+      && tsc_calibration.usable)
+    return gst_system_clock_get_tsc_time ();
+#endif
 #if defined __APPLE__
   GstSystemClock *sysclock = GST_SYSTEM_CLOCK_CAST (clock);
   uint64_t mach_t = mach_absolute_time ();
@@ -627,6 +1139,11 @@ gst_system_clock_get_internal_time (GstClock * clock)
 static guint64
 gst_system_clock_get_resolution (GstClock * clock)
 {
+#ifdef HAVE_TSC_CLOCK
+  if (GST_SYSTEM_CLOCK_CAST (clock)->priv->clock_type == GST_CLOCK_TYPE_TSC
+      && tsc_calibration.usable)
+    return MAX (tsc_calibration.mult >> tsc_calibration.shift, 1);
+#endif
 #if defined __APPLE__
   GstSystemClock *sysclock = GST_SYSTEM_CLOCK_CAST (clock);
   return gst_util_uint64_scale (GST_NSECOND,
@@ -678,6 +1195,55 @@ gst_system_clock_cleanup_unscheduled (GstSystemClock * sysclock,
   GST_OBJECT_UNLOCK (sysclock);
 }
 
+/* Does the final @diff of a wait until @entryt, with a high resolution sleep
+ * against the absolute deadline and then busy-waiting for the last
+ * @spin. The entry is not BUSY anymore, an unschedule only stops the
+ * spinning, the sleep is bounded by the precise-wait window anyway.
+ * Returns the remaining diff. */
+static GstClockTimeDiff
+gst_system_clock_wait_precise (GstClock * clock, GstClockEntry * entry,
+    GstClockTime entryt, GstClockTimeDiff diff, GstClockTime spin)
+{
+  GstClockTime start;
+
+#if defined(HAVE_CLOCK_NANOSLEEP) && defined(HAVE_POSIX_TIMERS)
+  if (diff > spin) {
+#ifdef HAVE_MONOTONIC_CLOCK
+    clockid_t clockid = CLOCK_MONOTONIC;
+#else
+    clockid_t clockid = CLOCK_REALTIME;
+#endif
+    struct timespec ts;
+
+    /* the entry is in the time of the clock, which might not run at the
+     * same rate as the posix clock. Over such a short interval the
+     * difference doesn't matter */
+    if (clock_gettime (clockid, &ts) == 0) {
+      GstClockTime deadline = GST_TIMESPEC_TO_TIME (ts) + diff - spin;
+
+      GST_TIME_TO_TIMESPEC (deadline, ts);
+      while (clock_nanosleep (clockid, TIMER_ABSTIME, &ts, NULL) == EINTR);
+    }
+    diff = GST_CLOCK_DIFF (gst_clock_get_time (clock), entryt);
+  }
+#endif
+
+  if (spin == 0 || diff <= 0)
+    return diff;
+
+  /* don't spin forever if the clock is not advancing */
+  start = gst_util_get_timestamp ();
+  do {
+    if (G_UNLIKELY (GET_ENTRY_STATUS (entry) == GST_CLOCK_UNSCHEDULED))
+      break;
+    if (G_UNLIKELY (gst_util_get_timestamp () - start > 2 * MAX_SPIN_WAIT))
+      break;
+    diff = GST_CLOCK_DIFF (gst_clock_get_time (clock), entryt);
+  } while (diff > 0);
+
+  return diff;
+}
+
 /* synchronously wait on the given GstClockEntry.
  *
  * We do this by blocking on the global GstPoll timer with
@@ -697,7 +1263,7 @@ gst_system_clock_id_wait_jitter_unlocked (GstClock * clock,
     GstClockEntry * entry, GstClockTimeDiff * jitter, gboolean restart)
 {
   GstSystemClock *sysclock = GST_SYSTEM_CLOCK_CAST (clock);
-  GstClockTime entryt, now;
+  GstClockTime entryt, now, spin, margin;
   GstClockTimeDiff diff;
   GstClockReturn status;
 
@@ -731,12 +1297,22 @@ gst_system_clock_id_wait_jitter_unlocked (GstClock * clock,
     GstClockTime final;
 #endif
 
+    /* the final part of the wait is done by gst_system_clock_wait_precise()
+     * if configured */
+    spin = sysclock->priv->spin_wait;
+#if defined(HAVE_CLOCK_NANOSLEEP) && defined(HAVE_POSIX_TIMERS)
+    margin = sysclock->priv->precise_wait + spin;
+#else
+    margin = spin;
+#endif
+
     while (TRUE) {
       gint pollret;
 
       /* now wait on the entry, it either times out or the fd is written. The
        * status of the entry is BUSY only around the poll. */
-      pollret = gst_poll_wait (sysclock->priv->timer, diff);
+      pollret = gst_poll_wait (sysclock->priv->timer,
+          diff > margin ? diff - margin : 0);
 
       /* get the new status, mark as DONE. We do this so that the unschedule
        * function knows when we left the poll and doesn't need to wakeup the
@@ -784,6 +1360,10 @@ gst_system_clock_id_wait_jitter_unlocked (GstClock * clock,
         now = gst_clock_get_time (clock);
         diff = GST_CLOCK_DIFF (now, entryt);
 
+        if (diff > 0 && diff <= margin && pollret == 0)
+          diff = gst_system_clock_wait_precise (clock, entry, entryt, diff,
+              spin);
+
         if (diff <= 0) {
           /* timeout, this is fine, we can report success now */
           if (G_UNLIKELY (!CAS_ENTRY_STATUS (entry, GST_CLOCK_DONE,
@@ -800,6 +1380,11 @@ gst_system_clock_id_wait_jitter_unlocked (GstClock * clock,
           GST_CAT_DEBUG (GST_CAT_CLOCK,
               "entry %p finished, diff %" G_GINT64_FORMAT, entry, diff);
 
+          GST_OBJECT_LOCK (sysclock);
+          sysclock->priv->wakeup_error =
+              (7 * sysclock->priv->wakeup_error + (GstClockTime) (-diff)) / 8;
+          GST_OBJECT_UNLOCK (sysclock);
+
 #ifdef WAIT_DEBUGGING
           final = gst_system_clock_get_internal_time (clock);
           GST_CAT_DEBUG (GST_CAT_CLOCK, "Waited for %" G_GINT64_FORMAT
@@ -912,48 +1497,33 @@ no_thread:
   return FALSE;
 }
 
-/* Add an entry to the list of pending async waits. The entry is inserted
- * in sorted order. If we inserted the entry at the head of the list, we
- * need to signal the thread as it might either be waiting on it or waiting
- * for a new entry.
+/* Add an entry to the heap of pending async waits. If the entry ended up at
+ * the top of the heap, we need to signal the thread as it might either be
+ * waiting on it or waiting for a new entry.
  *
  * MT safe.
  */
-static GstClockReturn
-gst_system_clock_id_wait_async (GstClock * clock, GstClockEntry * entry)
+/* takes ownership of the ref on @entry and makes the async thread pick it
+ * up, call with LOCK */
+static void
+gst_system_clock_insert_entry (GstSystemClock * sysclock,
+    GstClockEntry * entry)
 {
-  GstSystemClock *sysclock;
-  GstSystemClockPrivate *priv;
+  GstClock *clock = GST_CLOCK_CAST (sysclock);
+  GstSystemClockPrivate *priv = sysclock->priv;
+  GstSystemClockNode *node;
   GstClockEntry *head;
 
-  sysclock = GST_SYSTEM_CLOCK_CAST (clock);
-  priv = sysclock->priv;
-
-  GST_CAT_DEBUG (GST_CAT_CLOCK, "adding async entry %p", entry);
-
-  GST_OBJECT_LOCK (clock);
-  /* Start the clock async thread if needed */
-  if (G_UNLIKELY (!gst_system_clock_start_async (sysclock)))
-    goto thread_error;
-
-  if (G_UNLIKELY (GET_ENTRY_STATUS (entry) == GST_CLOCK_UNSCHEDULED))
-    goto was_unscheduled;
+  node = gst_system_clock_heap_peek (sysclock);
+  head = node ? node->entry : NULL;
 
-  if (priv->entries)
-    head = priv->entries->data;
-  else
-    head = NULL;
-
-  /* need to take a ref */
-  gst_clock_id_ref ((GstClockID) entry);
-  /* insert the entry in sorted order */
-  priv->entries = g_list_insert_sorted (priv->entries, entry,
-      gst_clock_id_compare_func);
+  /* insert the entry in the heap */
+  gst_system_clock_heap_push (sysclock, entry);
 
   /* only need to send the signal if the entry was added to the
    * front, else the thread is just waiting for another entry and
    * will get to this entry automatically. */
-  if (priv->entries->data == entry) {
+  if (gst_system_clock_heap_peek (sysclock)->entry == entry) {
     GST_CAT_DEBUG (GST_CAT_CLOCK, "async entry added to head %p", head);
     if (head == NULL) {
       /* the list was empty before, signal the cond so that the async thread can
@@ -978,6 +1548,28 @@ gst_system_clock_id_wait_async (GstClock * clock, GstClockEntry * entry)
       }
     }
   }
+}
+
+static GstClockReturn
+gst_system_clock_id_wait_async (GstClock * clock, GstClockEntry * entry)
+{
+  GstSystemClock *sysclock;
+
+  sysclock = GST_SYSTEM_CLOCK_CAST (clock);
+
+  GST_CAT_DEBUG (GST_CAT_CLOCK, "adding async entry %p", entry);
+
+  GST_OBJECT_LOCK (clock);
+  /* Start the clock async thread if needed */
+  if (G_UNLIKELY (!gst_system_clock_start_async (sysclock)))
+    goto thread_error;
+
+  if (G_UNLIKELY (GET_ENTRY_STATUS (entry) == GST_CLOCK_UNSCHEDULED))
+    goto was_unscheduled;
+
+  /* need to take a ref */
+  gst_clock_id_ref ((GstClockID) entry);
+  gst_system_clock_insert_entry (sysclock, entry);
   GST_OBJECT_UNLOCK (clock);
 
   return GST_CLOCK_OK;
@@ -48,13 +48,19 @@ typedef struct _GstSystemClockPrivate GstSystemClockPrivate;
  * @GST_CLOCK_TYPE_MONOTONIC: monotonic time since some unspecified starting
  *                            point
  * @GST_CLOCK_TYPE_OTHER: some other time source is used (Since 1.0.5)
+ * @GST_CLOCK_TYPE_TSC: the time stamp counter of the CPU, calibrated against
+ *                      the monotonic clock. Only used if the CPU has a
+ *                      counter that runs at a constant rate on all cores,
+ *                      otherwise the same as %GST_CLOCK_TYPE_MONOTONIC
+ *                      (Since 1.10)
  *
  * The different kind of clocks.
  */
 typedef enum {
   GST_CLOCK_TYPE_REALTIME       = 0,
   GST_CLOCK_TYPE_MONOTONIC      = 1,
-  GST_CLOCK_TYPE_OTHER          = 2
+  GST_CLOCK_TYPE_OTHER          = 2,
+  GST_CLOCK_TYPE_TSC            = 3
 } GstClockType;
 
 /**
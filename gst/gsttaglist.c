@@ -72,17 +72,34 @@ typedef struct
   GstTagMergeFunc merge_func;   /* functions to merge the values */
   GstTagFlag flag;              /* type of tag */
   GQuark name_quark;            /* quark for the name */
+  const gchar *name;            /* the name it was registered with */
 }
 GstTagInfo;
 
 #define g_value_get_char g_value_get_schar
 
+/* only taken when registering tags */
 static GMutex __tag_mutex;
 #define TAG_LOCK g_mutex_lock (&__tag_mutex)
 #define TAG_UNLOCK g_mutex_unlock (&__tag_mutex)
 
-/* tags hash table: maps tag name string => GstTagInfo */
-static GHashTable *__tags;
+/* tags are looked up all the time but practically only registered at
+ * startup and never removed, so they live in an open addressing hash table
+ * that is read without any locking. Registering fills an empty slot, which
+ * readers either see or not. When the table gets half full a bigger copy is
+ * published, the old one has to stay around as readers may still use it. */
+typedef struct
+{
+  guint mask;
+  GstTagInfo *volatile slots[1];
+} GstTagTable;
+
+#define TAG_TABLE_INITIAL_SIZE 256
+
+static GstTagTable *volatile __tags;
+static guint __n_tags;
+/* tables that were replaced by a bigger one */
+static GSList *__old_tags;
 
 GType _gst_tag_list_type = 0;
 GST_DEFINE_MINI_OBJECT_TYPE (GstTagList, gst_tag_list);
@@ -90,6 +107,29 @@ GST_DEFINE_MINI_OBJECT_TYPE (GstTagList, gst_tag_list);
 static void __gst_tag_list_free (GstTagList * list);
 static GstTagList *__gst_tag_list_copy (const GstTagList * list);
 
+static GstTagTable *
+gst_tag_table_new (guint size)
+{
+  GstTagTable *table;
+
+  table = g_malloc0 (sizeof (GstTagTable) + (size - 1) * sizeof (gpointer));
+  table->mask = size - 1;
+
+  return table;
+}
+
+/* call with TAG_LOCK, @info must be complete */
+static void
+gst_tag_table_insert (GstTagTable * table, GstTagInfo * info)
+{
+  guint i = g_str_hash (info->name) & table->mask;
+
+  while (table->slots[i])
+    i = (i + 1) & table->mask;
+
+  g_atomic_pointer_set (&table->slots[i], info);
+}
+
 /* FIXME: had code:
  *    g_value_register_transform_func (_gst_tag_list_type, G_TYPE_STRING,
  *      _gst_structure_transform_to_string);
@@ -101,314 +141,335 @@ _priv_gst_tag_initialize (void)
 
   _gst_tag_list_type = gst_tag_list_get_type ();
 
-  __tags = g_hash_table_new (g_str_hash, g_str_equal);
-  gst_tag_register_static (GST_TAG_TITLE, GST_TAG_FLAG_META,
+  __tags = gst_tag_table_new (TAG_TABLE_INITIAL_SIZE);
+}
+
+static void gst_tag_register_core (const gchar * name, GstTagFlag flag,
+    GType type, const gchar * nick, const gchar * blurb,
+    GstTagMergeFunc func);
+
+/* the core tags are registered when the first tag is looked up or
+ * registered, most processes never use any of them */
+static void
+gst_tag_register_core_tags (void)
+{
+  gst_tag_register_core (GST_TAG_TITLE, GST_TAG_FLAG_META,
       G_TYPE_STRING,
       _("title"), _("commonly used title"), gst_tag_merge_strings_with_comma);
-  gst_tag_register_static (GST_TAG_TITLE_SORTNAME, GST_TAG_FLAG_META,
+  gst_tag_register_core (GST_TAG_TITLE_SORTNAME, GST_TAG_FLAG_META,
       G_TYPE_STRING,
       _("title sortname"), _("commonly used title for sorting purposes"), NULL);
-  gst_tag_register_static (GST_TAG_ARTIST, GST_TAG_FLAG_META,
+  gst_tag_register_core (GST_TAG_ARTIST, GST_TAG_FLAG_META,
       G_TYPE_STRING,
       _("artist"),
       _("person(s) responsible for the recording"),
       gst_tag_merge_strings_with_comma);
-  gst_tag_register_static (GST_TAG_ARTIST_SORTNAME, GST_TAG_FLAG_META,
+  gst_tag_register_core (GST_TAG_ARTIST_SORTNAME, GST_TAG_FLAG_META,
       G_TYPE_STRING,
       _("artist sortname"),
       _("person(s) responsible for the recording for sorting purposes"), NULL);
-  gst_tag_register_static (GST_TAG_ALBUM, GST_TAG_FLAG_META,
+  gst_tag_register_core (GST_TAG_ALBUM, GST_TAG_FLAG_META,
       G_TYPE_STRING,
       _("album"),
       _("album containing this data"), gst_tag_merge_strings_with_comma);
-  gst_tag_register_static (GST_TAG_ALBUM_SORTNAME, GST_TAG_FLAG_META,
+  gst_tag_register_core (GST_TAG_ALBUM_SORTNAME, GST_TAG_FLAG_META,
       G_TYPE_STRING,
       _("album sortname"),
       _("album containing this data for sorting purposes"), NULL);
-  gst_tag_register_static (GST_TAG_ALBUM_ARTIST, GST_TAG_FLAG_META,
+  gst_tag_register_core (GST_TAG_ALBUM_ARTIST, GST_TAG_FLAG_META,
       G_TYPE_STRING,
       _("album artist"),
       _("The artist of the entire album, as it should be displayed"),
       gst_tag_merge_strings_with_comma);
-  gst_tag_register_static (GST_TAG_ALBUM_ARTIST_SORTNAME, GST_TAG_FLAG_META,
+  gst_tag_register_core (GST_TAG_ALBUM_ARTIST_SORTNAME, GST_TAG_FLAG_META,
       G_TYPE_STRING,
       _("album artist sortname"),
       _("The artist of the entire album, as it should be sorted"), NULL);
-  gst_tag_register_static (GST_TAG_DATE, GST_TAG_FLAG_META, G_TYPE_DATE,
+  gst_tag_register_core (GST_TAG_DATE, GST_TAG_FLAG_META, G_TYPE_DATE,
       _("date"), _("date the data was created (as a GDate structure)"), NULL);
-  gst_tag_register_static (GST_TAG_DATE_TIME, GST_TAG_FLAG_META,
+  gst_tag_register_core (GST_TAG_DATE_TIME, GST_TAG_FLAG_META,
       GST_TYPE_DATE_TIME, _("datetime"),
       _("date and time the data was created (as a GstDateTime structure)"),
       NULL);
-  gst_tag_register_static (GST_TAG_GENRE, GST_TAG_FLAG_META,
+  gst_tag_register_core (GST_TAG_GENRE, GST_TAG_FLAG_META,
       G_TYPE_STRING,
       _("genre"),
       _("genre this data belongs to"), gst_tag_merge_strings_with_comma);
-  gst_tag_register_static (GST_TAG_COMMENT, GST_TAG_FLAG_META,
+  gst_tag_register_core (GST_TAG_COMMENT, GST_TAG_FLAG_META,
       G_TYPE_STRING,
       _("comment"),
       _("free text commenting the data"), gst_tag_merge_use_first);
-  gst_tag_register_static (GST_TAG_EXTENDED_COMMENT, GST_TAG_FLAG_META,
+  gst_tag_register_core (GST_TAG_EXTENDED_COMMENT, GST_TAG_FLAG_META,
       G_TYPE_STRING,
       _("extended comment"),
       _("free text commenting the data in key=value or key[en]=comment form"),
       gst_tag_merge_use_first);
-  gst_tag_register_static (GST_TAG_TRACK_NUMBER, GST_TAG_FLAG_META,
+  gst_tag_register_core (GST_TAG_TRACK_NUMBER, GST_TAG_FLAG_META,
       G_TYPE_UINT,
       _("track number"),
       _("track number inside a collection"), gst_tag_merge_use_first);
-  gst_tag_register_static (GST_TAG_TRACK_COUNT, GST_TAG_FLAG_META,
+  gst_tag_register_core (GST_TAG_TRACK_COUNT, GST_TAG_FLAG_META,
       G_TYPE_UINT,
       _("track count"),
       _("count of tracks inside collection this track belongs to"),
       gst_tag_merge_use_first);
-  gst_tag_register_static (GST_TAG_ALBUM_VOLUME_NUMBER, GST_TAG_FLAG_META,
+  gst_tag_register_core (GST_TAG_ALBUM_VOLUME_NUMBER, GST_TAG_FLAG_META,
       G_TYPE_UINT,
       _("disc number"),
       _("disc number inside a collection"), gst_tag_merge_use_first);
-  gst_tag_register_static (GST_TAG_ALBUM_VOLUME_COUNT, GST_TAG_FLAG_META,
+  gst_tag_register_core (GST_TAG_ALBUM_VOLUME_COUNT, GST_TAG_FLAG_META,
       G_TYPE_UINT,
       _("disc count"),
       _("count of discs inside collection this disc belongs to"),
       gst_tag_merge_use_first);
-  gst_tag_register_static (GST_TAG_LOCATION, GST_TAG_FLAG_META,
+  gst_tag_register_core (GST_TAG_LOCATION, GST_TAG_FLAG_META,
       G_TYPE_STRING,
       _("location"), _("Origin of media as a URI (location, where the "
           "original of the file or stream is hosted)"),
       gst_tag_merge_strings_with_comma);
-  gst_tag_register_static (GST_TAG_HOMEPAGE, GST_TAG_FLAG_META,
+  gst_tag_register_core (GST_TAG_HOMEPAGE, GST_TAG_FLAG_META,
       G_TYPE_STRING,
       _("homepage"),
       _("Homepage for this media (i.e. artist or movie homepage)"),
       gst_tag_merge_strings_with_comma);
-  gst_tag_register_static (GST_TAG_DESCRIPTION, GST_TAG_FLAG_META,
+  gst_tag_register_core (GST_TAG_DESCRIPTION, GST_TAG_FLAG_META,
       G_TYPE_STRING, _("description"),
       _("short text describing the content of the data"),
       gst_tag_merge_strings_with_comma);
-  gst_tag_register_static (GST_TAG_VERSION, GST_TAG_FLAG_META, G_TYPE_STRING,
+  gst_tag_register_core (GST_TAG_VERSION, GST_TAG_FLAG_META, G_TYPE_STRING,
       _("version"), _("version of this data"), NULL);
-  gst_tag_register_static (GST_TAG_ISRC, GST_TAG_FLAG_META, G_TYPE_STRING,
+  gst_tag_register_core (GST_TAG_ISRC, GST_TAG_FLAG_META, G_TYPE_STRING,
       _("ISRC"),
       _
       ("International Standard Recording Code - see http://www.ifpi.org/isrc/"),
       NULL);
   /* FIXME: organization (fix what? tpm) */
-  gst_tag_register_static (GST_TAG_ORGANIZATION, GST_TAG_FLAG_META,
+  gst_tag_register_core (GST_TAG_ORGANIZATION, GST_TAG_FLAG_META,
       G_TYPE_STRING, _("organization"), _("organization"),
       gst_tag_merge_strings_with_comma);
-  gst_tag_register_static (GST_TAG_COPYRIGHT, GST_TAG_FLAG_META,
+  gst_tag_register_core (GST_TAG_COPYRIGHT, GST_TAG_FLAG_META,
       G_TYPE_STRING, _("copyright"), _("copyright notice of the data"), NULL);
-  gst_tag_register_static (GST_TAG_COPYRIGHT_URI, GST_TAG_FLAG_META,
+  gst_tag_register_core (GST_TAG_COPYRIGHT_URI, GST_TAG_FLAG_META,
       G_TYPE_STRING, _("copyright uri"),
       _("URI to the copyright notice of the data"), NULL);
-  gst_tag_register_static (GST_TAG_ENCODED_BY, GST_TAG_FLAG_META, G_TYPE_STRING,
+  gst_tag_register_core (GST_TAG_ENCODED_BY, GST_TAG_FLAG_META, G_TYPE_STRING,
       _("encoded by"), _("name of the encoding person or organization"),
       gst_tag_merge_strings_with_comma);
-  gst_tag_register_static (GST_TAG_CONTACT, GST_TAG_FLAG_META,
+  gst_tag_register_core (GST_TAG_CONTACT, GST_TAG_FLAG_META,
       G_TYPE_STRING,
       _("contact"), _("contact information"), gst_tag_merge_strings_with_comma);
-  gst_tag_register_static (GST_TAG_LICENSE, GST_TAG_FLAG_META,
+  gst_tag_register_core (GST_TAG_LICENSE, GST_TAG_FLAG_META,
       G_TYPE_STRING, _("license"), _("license of data"), NULL);
-  gst_tag_register_static (GST_TAG_LICENSE_URI, GST_TAG_FLAG_META,
+  gst_tag_register_core (GST_TAG_LICENSE_URI, GST_TAG_FLAG_META,
       G_TYPE_STRING, _("license uri"),
       _("URI to the license of the data"), NULL);
-  gst_tag_register_static (GST_TAG_PERFORMER, GST_TAG_FLAG_META,
+  gst_tag_register_core (GST_TAG_PERFORMER, GST_TAG_FLAG_META,
       G_TYPE_STRING,
       _("performer"),
       _("person(s) performing"), gst_tag_merge_strings_with_comma);
-  gst_tag_register_static (GST_TAG_COMPOSER, GST_TAG_FLAG_META,
+  gst_tag_register_core (GST_TAG_COMPOSER, GST_TAG_FLAG_META,
       G_TYPE_STRING,
       _("composer"),
       _("person(s) who composed the recording"),
       gst_tag_merge_strings_with_comma);
-  gst_tag_register_static (GST_TAG_CONDUCTOR, GST_TAG_FLAG_META,
+  gst_tag_register_core (GST_TAG_CONDUCTOR, GST_TAG_FLAG_META,
       G_TYPE_STRING,
       _("conductor"),
       _("conductor/performer refinement"), gst_tag_merge_strings_with_comma);
-  gst_tag_register_static (GST_TAG_DURATION, GST_TAG_FLAG_DECODED,
+  gst_tag_register_core (GST_TAG_DURATION, GST_TAG_FLAG_DECODED,
       G_TYPE_UINT64,
       _("duration"), _("length in GStreamer time units (nanoseconds)"), NULL);
-  gst_tag_register_static (GST_TAG_CODEC, GST_TAG_FLAG_ENCODED,
+  gst_tag_register_core (GST_TAG_CODEC, GST_TAG_FLAG_ENCODED,
       G_TYPE_STRING,
       _("codec"),
       _("codec the data is stored in"), gst_tag_merge_strings_with_comma);
-  gst_tag_register_static (GST_TAG_VIDEO_CODEC, GST_TAG_FLAG_ENCODED,
+  gst_tag_register_core (GST_TAG_VIDEO_CODEC, GST_TAG_FLAG_ENCODED,
       G_TYPE_STRING,
       _("video codec"), _("codec the video data is stored in"), NULL);
-  gst_tag_register_static (GST_TAG_AUDIO_CODEC, GST_TAG_FLAG_ENCODED,
+  gst_tag_register_core (GST_TAG_AUDIO_CODEC, GST_TAG_FLAG_ENCODED,
       G_TYPE_STRING,
       _("audio codec"), _("codec the audio data is stored in"), NULL);
-  gst_tag_register_static (GST_TAG_SUBTITLE_CODEC, GST_TAG_FLAG_ENCODED,
+  gst_tag_register_core (GST_TAG_SUBTITLE_CODEC, GST_TAG_FLAG_ENCODED,
       G_TYPE_STRING,
       _("subtitle codec"), _("codec the subtitle data is stored in"), NULL);
-  gst_tag_register_static (GST_TAG_CONTAINER_FORMAT, GST_TAG_FLAG_ENCODED,
+  gst_tag_register_core (GST_TAG_CONTAINER_FORMAT, GST_TAG_FLAG_ENCODED,
       G_TYPE_STRING, _("container format"),
       _("container format the data is stored in"), NULL);
-  gst_tag_register_static (GST_TAG_BITRATE, GST_TAG_FLAG_ENCODED,
+  gst_tag_register_core (GST_TAG_BITRATE, GST_TAG_FLAG_ENCODED,
       G_TYPE_UINT, _("bitrate"), _("exact or average bitrate in bits/s"), NULL);
-  gst_tag_register_static (GST_TAG_NOMINAL_BITRATE, GST_TAG_FLAG_ENCODED,
+  gst_tag_register_core (GST_TAG_NOMINAL_BITRATE, GST_TAG_FLAG_ENCODED,
       G_TYPE_UINT, _("nominal bitrate"), _("nominal bitrate in bits/s"), NULL);
-  gst_tag_register_static (GST_TAG_MINIMUM_BITRATE, GST_TAG_FLAG_ENCODED,
+  gst_tag_register_core (GST_TAG_MINIMUM_BITRATE, GST_TAG_FLAG_ENCODED,
       G_TYPE_UINT, _("minimum bitrate"), _("minimum bitrate in bits/s"), NULL);
-  gst_tag_register_static (GST_TAG_MAXIMUM_BITRATE, GST_TAG_FLAG_ENCODED,
+  gst_tag_register_core (GST_TAG_MAXIMUM_BITRATE, GST_TAG_FLAG_ENCODED,
       G_TYPE_UINT, _("maximum bitrate"), _("maximum bitrate in bits/s"), NULL);
-  gst_tag_register_static (GST_TAG_ENCODER, GST_TAG_FLAG_ENCODED,
+  gst_tag_register_core (GST_TAG_ENCODER, GST_TAG_FLAG_ENCODED,
       G_TYPE_STRING,
       _("encoder"), _("encoder used to encode this stream"), NULL);
-  gst_tag_register_static (GST_TAG_ENCODER_VERSION, GST_TAG_FLAG_ENCODED,
+  gst_tag_register_core (GST_TAG_ENCODER_VERSION, GST_TAG_FLAG_ENCODED,
       G_TYPE_UINT,
       _("encoder version"),
       _("version of the encoder used to encode this stream"), NULL);
-  gst_tag_register_static (GST_TAG_SERIAL, GST_TAG_FLAG_ENCODED,
+  gst_tag_register_core (GST_TAG_SERIAL, GST_TAG_FLAG_ENCODED,
       G_TYPE_UINT, _("serial"), _("serial number of track"), NULL);
-  gst_tag_register_static (GST_TAG_TRACK_GAIN, GST_TAG_FLAG_META,
+  gst_tag_register_core (GST_TAG_TRACK_GAIN, GST_TAG_FLAG_META,
       G_TYPE_DOUBLE, _("replaygain track gain"), _("track gain in db"), NULL);
-  gst_tag_register_static (GST_TAG_TRACK_PEAK, GST_TAG_FLAG_META,
+  gst_tag_register_core (GST_TAG_TRACK_PEAK, GST_TAG_FLAG_META,
       G_TYPE_DOUBLE, _("replaygain track peak"), _("peak of the track"), NULL);
-  gst_tag_register_static (GST_TAG_ALBUM_GAIN, GST_TAG_FLAG_META,
+  gst_tag_register_core (GST_TAG_ALBUM_GAIN, GST_TAG_FLAG_META,
       G_TYPE_DOUBLE, _("replaygain album gain"), _("album gain in db"), NULL);
-  gst_tag_register_static (GST_TAG_ALBUM_PEAK, GST_TAG_FLAG_META,
+  gst_tag_register_core (GST_TAG_ALBUM_PEAK, GST_TAG_FLAG_META,
       G_TYPE_DOUBLE, _("replaygain album peak"), _("peak of the album"), NULL);
-  gst_tag_register_static (GST_TAG_REFERENCE_LEVEL, GST_TAG_FLAG_META,
+  gst_tag_register_core (GST_TAG_REFERENCE_LEVEL, GST_TAG_FLAG_META,
       G_TYPE_DOUBLE, _("replaygain reference level"),
       _("reference level of track and album gain values"), NULL);
-  gst_tag_register_static (GST_TAG_LANGUAGE_CODE, GST_TAG_FLAG_META,
+  gst_tag_register_core (GST_TAG_LANGUAGE_CODE, GST_TAG_FLAG_META,
       G_TYPE_STRING, _("language code"),
       _("language code for this stream, conforming to ISO-639-1 or ISO-639-2"),
       NULL);
-  gst_tag_register_static (GST_TAG_LANGUAGE_NAME, GST_TAG_FLAG_META,
+  gst_tag_register_core (GST_TAG_LANGUAGE_NAME, GST_TAG_FLAG_META,
       G_TYPE_STRING, _("language name"),
       _("freeform name of the language this stream is in"), NULL);
-  gst_tag_register_static (GST_TAG_IMAGE, GST_TAG_FLAG_META, GST_TYPE_SAMPLE,
+  gst_tag_register_core (GST_TAG_IMAGE, GST_TAG_FLAG_META, GST_TYPE_SAMPLE,
       _("image"), _("image related to this stream"), gst_tag_merge_use_first);
-  gst_tag_register_static (GST_TAG_PREVIEW_IMAGE, GST_TAG_FLAG_META,
+  gst_tag_register_core (GST_TAG_PREVIEW_IMAGE, GST_TAG_FLAG_META,
       GST_TYPE_SAMPLE,
       /* TRANSLATORS: 'preview image' = image that shows a preview of the full image */
       _("preview image"), _("preview image related to this stream"), NULL);
-  gst_tag_register_static (GST_TAG_ATTACHMENT, GST_TAG_FLAG_META,
+  gst_tag_register_core (GST_TAG_ATTACHMENT, GST_TAG_FLAG_META,
       GST_TYPE_SAMPLE, _("attachment"), _("file attached to this stream"),
       gst_tag_merge_use_first);
-  gst_tag_register_static (GST_TAG_BEATS_PER_MINUTE, GST_TAG_FLAG_META,
+  gst_tag_register_core (GST_TAG_BEATS_PER_MINUTE, GST_TAG_FLAG_META,
       G_TYPE_DOUBLE, _("beats per minute"),
       _("number of beats per minute in audio"), NULL);
-  gst_tag_register_static (GST_TAG_KEYWORDS, GST_TAG_FLAG_META, G_TYPE_STRING,
+  gst_tag_register_core (GST_TAG_KEYWORDS, GST_TAG_FLAG_META, G_TYPE_STRING,
       _("keywords"), _("comma separated keywords describing the content"),
       gst_tag_merge_strings_with_comma);
-  gst_tag_register_static (GST_TAG_GEO_LOCATION_NAME, GST_TAG_FLAG_META,
+  gst_tag_register_core (GST_TAG_GEO_LOCATION_NAME, GST_TAG_FLAG_META,
       G_TYPE_STRING, _("geo location name"),
       _("human readable descriptive location of where "
           "the media has been recorded or produced"), NULL);
-  gst_tag_register_static (GST_TAG_GEO_LOCATION_LATITUDE, GST_TAG_FLAG_META,
+  gst_tag_register_core (GST_TAG_GEO_LOCATION_LATITUDE, GST_TAG_FLAG_META,
       G_TYPE_DOUBLE, _("geo location latitude"),
       _("geo latitude location of where the media has been recorded or "
           "produced in degrees according to WGS84 (zero at the equator, "
           "negative values for southern latitudes)"), NULL);
-  gst_tag_register_static (GST_TAG_GEO_LOCATION_LONGITUDE, GST_TAG_FLAG_META,
+  gst_tag_register_core (GST_TAG_GEO_LOCATION_LONGITUDE, GST_TAG_FLAG_META,
       G_TYPE_DOUBLE, _("geo location longitude"),
       _("geo longitude location of where the media has been recorded or "
           "produced in degrees according to WGS84 (zero at the prime meridian "
           "in Greenwich/UK,  negative values for western longitudes)"), NULL);
-  gst_tag_register_static (GST_TAG_GEO_LOCATION_ELEVATION, GST_TAG_FLAG_META,
+  gst_tag_register_core (GST_TAG_GEO_LOCATION_ELEVATION, GST_TAG_FLAG_META,
       G_TYPE_DOUBLE, _("geo location elevation"),
       _("geo elevation of where the media has been recorded or produced in "
           "meters according to WGS84 (zero is average sea level)"), NULL);
-  gst_tag_register_static (GST_TAG_GEO_LOCATION_COUNTRY, GST_TAG_FLAG_META,
+  gst_tag_register_core (GST_TAG_GEO_LOCATION_COUNTRY, GST_TAG_FLAG_META,
       G_TYPE_STRING, _("geo location country"),
       _("country (english name) where the media has been recorded "
           "or produced"), NULL);
-  gst_tag_register_static (GST_TAG_GEO_LOCATION_CITY, GST_TAG_FLAG_META,
+  gst_tag_register_core (GST_TAG_GEO_LOCATION_CITY, GST_TAG_FLAG_META,
       G_TYPE_STRING, _("geo location city"),
       _("city (english name) where the media has been recorded "
           "or produced"), NULL);
-  gst_tag_register_static (GST_TAG_GEO_LOCATION_SUBLOCATION, GST_TAG_FLAG_META,
+  gst_tag_register_core (GST_TAG_GEO_LOCATION_SUBLOCATION, GST_TAG_FLAG_META,
       G_TYPE_STRING, _("geo location sublocation"),
       _("a location within a city where the media has been produced "
           "or created (e.g. the neighborhood)"), NULL);
-  gst_tag_register_static (GST_TAG_GEO_LOCATION_HORIZONTAL_ERROR,
+  gst_tag_register_core (GST_TAG_GEO_LOCATION_HORIZONTAL_ERROR,
       GST_TAG_FLAG_META, G_TYPE_DOUBLE, _("geo location horizontal error"),
       _("expected error of the horizontal positioning measures (in meters)"),
       NULL);
-  gst_tag_register_static (GST_TAG_GEO_LOCATION_MOVEMENT_SPEED,
+  gst_tag_register_core (GST_TAG_GEO_LOCATION_MOVEMENT_SPEED,
       GST_TAG_FLAG_META, G_TYPE_DOUBLE, _("geo location movement speed"),
       _("movement speed of the capturing device while performing the capture "
           "in m/s"), NULL);
-  gst_tag_register_static (GST_TAG_GEO_LOCATION_MOVEMENT_DIRECTION,
+  gst_tag_register_core (GST_TAG_GEO_LOCATION_MOVEMENT_DIRECTION,
       GST_TAG_FLAG_META, G_TYPE_DOUBLE, _("geo location movement direction"),
       _("indicates the movement direction of the device performing the capture"
           " of a media. It is represented as degrees in floating point "
           "representation, 0 means the geographic north, and increases "
           "clockwise"), NULL);
-  gst_tag_register_static (GST_TAG_GEO_LOCATION_CAPTURE_DIRECTION,
+  gst_tag_register_core (GST_TAG_GEO_LOCATION_CAPTURE_DIRECTION,
       GST_TAG_FLAG_META, G_TYPE_DOUBLE, _("geo location capture direction"),
       _("indicates the direction the device is pointing to when capturing "
           " a media. It is represented as degrees in floating point "
           " representation, 0 means the geographic north, and increases "
           "clockwise"), NULL);
-  gst_tag_register_static (GST_TAG_SHOW_NAME, GST_TAG_FLAG_META, G_TYPE_STRING,
+  gst_tag_register_core (GST_TAG_SHOW_NAME, GST_TAG_FLAG_META, G_TYPE_STRING,
       /* TRANSLATORS: 'show name' = 'TV/radio/podcast show name' here */
       _("show name"),
       _("Name of the tv/podcast/series show the media is from"),
       gst_tag_merge_strings_with_comma);
-  gst_tag_register_static (GST_TAG_SHOW_SORTNAME, GST_TAG_FLAG_META,
+  gst_tag_register_core (GST_TAG_SHOW_SORTNAME, GST_TAG_FLAG_META,
       G_TYPE_STRING,
       /* TRANSLATORS: 'show sortname' = 'TV/radio/podcast show name as used for sorting purposes' here */
       _("show sortname"),
       _("Name of the tv/podcast/series show the media is from, for sorting "
           "purposes"), NULL);
-  gst_tag_register_static (GST_TAG_SHOW_EPISODE_NUMBER, GST_TAG_FLAG_META,
+  gst_tag_register_core (GST_TAG_SHOW_EPISODE_NUMBER, GST_TAG_FLAG_META,
       G_TYPE_UINT, _("episode number"),
       _("The episode number in the season the media is part of"),
       gst_tag_merge_use_first);
-  gst_tag_register_static (GST_TAG_SHOW_SEASON_NUMBER, GST_TAG_FLAG_META,
+  gst_tag_register_core (GST_TAG_SHOW_SEASON_NUMBER, GST_TAG_FLAG_META,
       G_TYPE_UINT, _("season number"),
       _("The season number of the show the media is part of"),
       gst_tag_merge_use_first);
-  gst_tag_register_static (GST_TAG_LYRICS, GST_TAG_FLAG_META, G_TYPE_STRING,
+  gst_tag_register_core (GST_TAG_LYRICS, GST_TAG_FLAG_META, G_TYPE_STRING,
       _("lyrics"), _("The lyrics of the media, commonly used for songs"),
       gst_tag_merge_strings_with_comma);
-  gst_tag_register_static (GST_TAG_COMPOSER_SORTNAME, GST_TAG_FLAG_META,
+  gst_tag_register_core (GST_TAG_COMPOSER_SORTNAME, GST_TAG_FLAG_META,
       G_TYPE_STRING, _("composer sortname"),
       _("person(s) who composed the recording, for sorting purposes"), NULL);
-  gst_tag_register_static (GST_TAG_GROUPING, GST_TAG_FLAG_META, G_TYPE_STRING,
+  gst_tag_register_core (GST_TAG_GROUPING, GST_TAG_FLAG_META, G_TYPE_STRING,
       _("grouping"),
       _("Groups related media that spans multiple tracks, like the different "
           "pieces of a concerto. It is a higher level than a track, "
           "but lower than an album"), NULL);
-  gst_tag_register_static (GST_TAG_USER_RATING, GST_TAG_FLAG_META, G_TYPE_UINT,
+  gst_tag_register_core (GST_TAG_USER_RATING, GST_TAG_FLAG_META, G_TYPE_UINT,
       _("user rating"),
       _("Rating attributed by a user. The higher the rank, "
           "the more the user likes this media"), NULL);
-  gst_tag_register_static (GST_TAG_DEVICE_MANUFACTURER, GST_TAG_FLAG_META,
+  gst_tag_register_core (GST_TAG_DEVICE_MANUFACTURER, GST_TAG_FLAG_META,
       G_TYPE_STRING, _("device manufacturer"),
       _("Manufacturer of the device used to create this media"), NULL);
-  gst_tag_register_static (GST_TAG_DEVICE_MODEL, GST_TAG_FLAG_META,
+  gst_tag_register_core (GST_TAG_DEVICE_MODEL, GST_TAG_FLAG_META,
       G_TYPE_STRING, _("device model"),
       _("Model of the device used to create this media"), NULL);
-  gst_tag_register_static (GST_TAG_APPLICATION_NAME, GST_TAG_FLAG_META,
+  gst_tag_register_core (GST_TAG_APPLICATION_NAME, GST_TAG_FLAG_META,
       G_TYPE_STRING, _("application name"),
       _("Application used to create the media"), NULL);
-  gst_tag_register_static (GST_TAG_APPLICATION_DATA, GST_TAG_FLAG_META,
+  gst_tag_register_core (GST_TAG_APPLICATION_DATA, GST_TAG_FLAG_META,
       GST_TYPE_SAMPLE, _("application data"),
       _("Arbitrary application data to be serialized into the media"), NULL);
-  gst_tag_register_static (GST_TAG_IMAGE_ORIENTATION, GST_TAG_FLAG_META,
+  gst_tag_register_core (GST_TAG_IMAGE_ORIENTATION, GST_TAG_FLAG_META,
       G_TYPE_STRING, _("image orientation"),
       _("How the image should be rotated or flipped before display"), NULL);
-  gst_tag_register_static (GST_TAG_PUBLISHER, GST_TAG_FLAG_META,
+  gst_tag_register_core (GST_TAG_PUBLISHER, GST_TAG_FLAG_META,
       G_TYPE_STRING,
       _("publisher"),
       _("Name of the label or publisher"), gst_tag_merge_strings_with_comma);
-  gst_tag_register_static (GST_TAG_INTERPRETED_BY, GST_TAG_FLAG_META,
+  gst_tag_register_core (GST_TAG_INTERPRETED_BY, GST_TAG_FLAG_META,
       G_TYPE_STRING,
       _("interpreted-by"),
       _("Information about the people behind a remix and similar "
           "interpretations"), gst_tag_merge_strings_with_comma);
-  gst_tag_register_static (GST_TAG_MIDI_BASE_NOTE, GST_TAG_FLAG_META,
+  gst_tag_register_core (GST_TAG_MIDI_BASE_NOTE, GST_TAG_FLAG_META,
       G_TYPE_UINT,
       _("midi-base-note"), _("Midi note number of the audio track."), NULL);
-  gst_tag_register_static (GST_TAG_PRIVATE_DATA, GST_TAG_FLAG_META,
+  gst_tag_register_core (GST_TAG_PRIVATE_DATA, GST_TAG_FLAG_META,
       GST_TYPE_SAMPLE,
       _("private-data"), _("Private data"), gst_tag_merge_use_first);
+}
+
+static inline void
+gst_tag_ensure_core_tags (void)
+{
+  static volatile gsize registered = 0;
 
+  if (g_once_init_enter (&registered)) {
+    gst_tag_register_core_tags ();
+    g_once_init_leave (&registered, 1);
+  }
 }
 
 /**
@@ -458,15 +519,28 @@ gst_tag_merge_strings_with_comma (GValue * dest, const GValue * src)
 }
 
 static GstTagInfo *
-gst_tag_lookup (const gchar * tag_name)
+gst_tag_table_lookup (const gchar * tag_name)
 {
-  GstTagInfo *ret;
+  GstTagTable *table = g_atomic_pointer_get (&__tags);
+  GstTagInfo *info;
+  guint i;
 
-  TAG_LOCK;
-  ret = g_hash_table_lookup (__tags, (gpointer) tag_name);
-  TAG_UNLOCK;
+  i = g_str_hash (tag_name) & table->mask;
+  while ((info = g_atomic_pointer_get (&table->slots[i]))) {
+    if (info->name == tag_name || strcmp (info->name, tag_name) == 0)
+      return info;
+    i = (i + 1) & table->mask;
+  }
+
+  return NULL;
+}
+
+static GstTagInfo *
+gst_tag_lookup (const gchar * tag_name)
+{
+  gst_tag_ensure_core_tags ();
 
-  return ret;
+  return gst_tag_table_lookup (tag_name);
 }
 
 /**
@@ -533,16 +607,26 @@ void
 gst_tag_register_static (const gchar * name, GstTagFlag flag, GType type,
     const gchar * nick, const gchar * blurb, GstTagMergeFunc func)
 {
-  GstTagInfo *info;
-
   g_return_if_fail (name != NULL);
   g_return_if_fail (nick != NULL);
   g_return_if_fail (blurb != NULL);
   g_return_if_fail (type != 0 && type != GST_TYPE_LIST);
 
-  info = gst_tag_lookup (name);
+  gst_tag_ensure_core_tags ();
+  gst_tag_register_core (name, flag, type, nick, blurb, func);
+}
+
+static void
+gst_tag_register_core (const gchar * name, GstTagFlag flag, GType type,
+    const gchar * nick, const gchar * blurb, GstTagMergeFunc func)
+{
+  GstTagInfo *info;
+
+  TAG_LOCK;
+  info = gst_tag_table_lookup (name);
 
   if (info) {
+    TAG_UNLOCK;
     g_return_if_fail (info->type == type);
     return;
   }
@@ -551,12 +635,25 @@ gst_tag_register_static (const gchar * name, GstTagFlag flag, GType type,
   info->flag = flag;
   info->type = type;
   info->name_quark = g_quark_from_static_string (name);
+  info->name = name;
   info->nick = nick;
   info->blurb = blurb;
   info->merge_func = func;
 
-  TAG_LOCK;
-  g_hash_table_insert (__tags, (gpointer) name, info);
+  if (G_UNLIKELY ((__n_tags + 1) * 2 > __tags->mask + 1)) {
+    GstTagTable *old = __tags, *table;
+    guint i;
+
+    table = gst_tag_table_new ((old->mask + 1) * 2);
+    for (i = 0; i <= old->mask; i++) {
+      if (old->slots[i])
+        gst_tag_table_insert (table, old->slots[i]);
+    }
+    g_atomic_pointer_set (&__tags, table);
+    __old_tags = g_slist_prepend (__old_tags, old);
+  }
+  gst_tag_table_insert (__tags, info);
+  __n_tags++;
   TAG_UNLOCK;
 }
 
@@ -892,6 +989,83 @@ gst_tag_list_new_from_string (const gchar * str)
   return tag_list;
 }
 
+/**
+ * gst_tag_list_serialize_binary:
+ * @list: a #GstTagList
+ *
+ * Serializes a tag list and its scope into a compact, versioned binary
+ * representation that can be read back with
+ * gst_tag_list_deserialize_binary().
+ *
+ * Returns: (transfer full) (nullable): the serialized @list, or %NULL if a
+ *     tag could not be serialized.
+ *
+ * Since: 1.10
+ */
+GBytes *
+gst_tag_list_serialize_binary (const GstTagList * list)
+{
+  GByteArray *array;
+  guint8 scope;
+
+  g_return_val_if_fail (GST_IS_TAG_LIST (list), NULL);
+
+  array = g_byte_array_new ();
+  _priv_gst_binary_write_version (array);
+  scope = GST_TAG_LIST_SCOPE (list);
+  g_byte_array_append (array, &scope, 1);
+  if (!_priv_gst_structure_write_binary (array, GST_TAG_LIST_STRUCTURE (list))) {
+    g_byte_array_unref (array);
+    return NULL;
+  }
+
+  return g_byte_array_free_to_bytes (array);
+}
+
+/**
+ * gst_tag_list_deserialize_binary:
+ * @data: (array length=size): data created with
+ *     gst_tag_list_serialize_binary()
+ * @size: the size of @data
+ * @consumed: (out) (allow-none): the number of bytes of @data that were used
+ *
+ * Deserializes a tag list from its binary representation.
+ *
+ * Returns: (transfer full) (nullable): a new #GstTagList, or %NULL when
+ *     @data is not a valid serialized tag list.
+ *
+ * Since: 1.10
+ */
+GstTagList *
+gst_tag_list_deserialize_binary (const guint8 * data, gsize size,
+    gsize * consumed)
+{
+  GstBinaryReader reader = { data, size, 0, 0 };
+  GstStructure *s;
+  guint8 scope;
+
+  g_return_val_if_fail (data != NULL || size == 0, NULL);
+
+  if (!_priv_gst_binary_read_version (&reader) ||
+      !_priv_gst_binary_read_uint8 (&reader, &scope) ||
+      scope > GST_TAG_SCOPE_GLOBAL)
+    return NULL;
+
+  s = _priv_gst_structure_read_binary (&reader);
+  if (s == NULL)
+    return NULL;
+
+  if (!gst_structure_has_name (s, "taglist")) {
+    gst_structure_free (s);
+    return NULL;
+  }
+
+  if (consumed)
+    *consumed = reader.pos;
+
+  return gst_tag_list_new_internal (s, scope);
+}
+
 /**
  * gst_tag_list_n_tags:
  * @list: A #GstTagList.
@@ -1169,6 +1343,20 @@ gst_tag_list_merge (const GstTagList * list1, const GstTagList * list2,
     return NULL;
   }
 
+  /* avoid copying a list only to throw its contents away or to insert into
+   * it what is already there; the result keeps the scope of @list1, or the
+   * default stream scope without one */
+  if (list2 == NULL || gst_tag_list_is_empty (list2)) {
+    if (list1 != NULL && mode != GST_TAG_MERGE_REPLACE_ALL)
+      return gst_tag_list_copy (list1);
+  } else if (mode == GST_TAG_MERGE_REPLACE_ALL ||
+      (mode != GST_TAG_MERGE_KEEP_ALL &&
+          (list1 == NULL || gst_tag_list_is_empty (list1)))) {
+    return gst_tag_list_new_internal (gst_structure_copy
+        (GST_TAG_LIST_STRUCTURE (list2)),
+        list1 ? GST_TAG_LIST_SCOPE (list1) : GST_TAG_SCOPE_STREAM);
+  }
+
   /* create empty list, we need to do this to correctly handling merge modes */
   list1_cp = (list1) ? gst_tag_list_copy (list1) : gst_tag_list_new_empty ();
   list2_cp = (list2) ? list2 : gst_tag_list_new_empty ();
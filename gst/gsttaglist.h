@@ -237,6 +237,11 @@ GstTagScope  gst_tag_list_get_scope         (const GstTagList * list);
 gchar      * gst_tag_list_to_string         (const GstTagList * list) G_GNUC_MALLOC;
 GstTagList * gst_tag_list_new_from_string   (const gchar      * str) G_GNUC_MALLOC;
 
+GBytes     * gst_tag_list_serialize_binary  (const GstTagList * list);
+GstTagList * gst_tag_list_deserialize_binary (const guint8    * data,
+                                             gsize             size,
+                                             gsize           * consumed) G_GNUC_MALLOC;
+
 gint         gst_tag_list_n_tags            (const GstTagList * list);
 const gchar* gst_tag_list_nth_tag_name      (const GstTagList * list, guint index);
 gboolean     gst_tag_list_is_empty          (const GstTagList * list);
@@ -65,6 +65,21 @@
  * name on Linux. Please note that the object name should be configured before the
  * task is started; changing the object name after the task has been started, has
  * no effect on the thread name.
+ *
+ * The thread of a task can be pinned to a set of CPUs with
+ * gst_task_set_cpu_affinity() or to the CPUs of a NUMA node with
+ * gst_task_set_numa_node(). Applications usually do this for the tasks of a
+ * pipeline from a synchronous bus handler when the
+ * %GST_STREAM_STATUS_TYPE_CREATE #GstMessage for the task is posted. Memory
+ * that the pinned thread touches first is then usually allocated on the
+ * closest NUMA node by the operating system. The affinity is applied when the
+ * thread enters the task function and is undone when it leaves, so that
+ * threads from a #GstTaskPool can be reused for other tasks.
+ *
+ * In the same way gst_task_set_scheduling() makes the thread of a task run
+ * with a realtime scheduling policy and priority, for example for the
+ * streaming threads of low-latency audio capture and playback. Unlike the
+ * affinity, the scheduling can also be changed while the task is running.
  */
 
 #include "gst_private.h"
@@ -83,6 +98,27 @@
 #include <pthread.h>
 #endif
 
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
+#if defined (HAVE_PTHREAD) && defined (_POSIX_THREAD_PRIORITY_SCHEDULING)
+#include <pthread.h>
+#include <sched.h>
+#include <errno.h>
+#include <string.h>
+#include <sys/resource.h>
+#define HAVE_TASK_SCHEDULING 1
+#endif
+
+#ifdef HAVE_SCHED_SETAFFINITY
+#include <sched.h>
+#include <errno.h>
+#define MAX_CPUS CPU_SETSIZE
+#else
+#define MAX_CPUS 1024
+#endif
+
 GST_DEBUG_CATEGORY_STATIC (task_debug);
 #define GST_CAT_DEFAULT (task_debug)
 
@@ -126,6 +162,15 @@ struct _GstTaskPrivate
   /* remember the pool and id that is currently running. */
   gpointer id;
   GstTaskPool *pool_id;
+
+  /* CPUs to run on as a list like "0-3,8", NULL for anywhere */
+  gchar *cpu_affinity;
+  gint numa_node;
+
+  /* scheduling of the thread, applied by the thread itself when changed */
+  GstTaskSchedulingPolicy sched_policy;
+  gint sched_priority;
+  gboolean sched_changed;
 };
 
 #ifdef _MSC_VER
@@ -204,6 +249,13 @@ gst_task_init (GstTask * task)
   task->priv->scheduleable = FALSE;
   task->priv->should_schedule = TRUE;
 
+  task->priv->cpu_affinity = NULL;
+  task->priv->numa_node = -1;
+
+  task->priv->sched_policy = GST_TASK_SCHEDULING_DEFAULT;
+  task->priv->sched_priority = 0;
+  task->priv->sched_changed = FALSE;
+
   /* clear floating flag */
   gst_object_ref_sink (task);
 }
@@ -227,6 +279,8 @@ gst_task_finalize (GObject * object)
 
   gst_object_unref (priv->pool);
 
+  g_free (priv->cpu_affinity);
+
   /* task thread cannot be running here since it holds a ref
    * to the task so that the finalize could not have happened */
   g_cond_clear (&task->cond);
@@ -276,12 +330,223 @@ gst_task_configure_name (GstTask * task)
 #endif
 }
 
+/* parse a list of CPUs like "0-3,8,10-11", the format the kernel uses in
+ * sysfs, and call @add for every CPU in it */
+static gboolean
+parse_cpu_list (const gchar * list, void (*add) (guint cpu, gpointer data),
+    gpointer data)
+{
+  const gchar *p = list;
+
+  if (*p == '\0')
+    return FALSE;
+
+  while (*p) {
+    gchar *end;
+    guint64 first, last, cpu;
+
+    if (!g_ascii_isdigit (*p))
+      return FALSE;
+    first = last = g_ascii_strtoull (p, &end, 10);
+
+    if (*end == '-') {
+      p = end + 1;
+      if (!g_ascii_isdigit (*p))
+        return FALSE;
+      last = g_ascii_strtoull (p, &end, 10);
+    }
+    if (last < first || last >= MAX_CPUS)
+      return FALSE;
+
+    if (add) {
+      for (cpu = first; cpu <= last; cpu++)
+        add (cpu, data);
+    }
+
+    p = end;
+    if (*p == ',' && p[1] != '\0')
+      p++;
+    else if (*p != '\0')
+      return FALSE;
+  }
+  return TRUE;
+}
+
+#ifdef HAVE_SCHED_SETAFFINITY
+static void
+cpu_set_add (guint cpu, gpointer data)
+{
+  CPU_SET (cpu, (cpu_set_t *) data);
+}
+
+/* pin the calling thread to the CPUs of @task. Returns TRUE when the
+ * affinity was changed and the previous one is in @saved. */
+static gboolean
+gst_task_configure_affinity (GstTask * task, cpu_set_t * saved)
+{
+  cpu_set_t set;
+  gchar *cpus;
+  gboolean res = FALSE;
+
+  GST_OBJECT_LOCK (task);
+  cpus = g_strdup (task->priv->cpu_affinity);
+  GST_OBJECT_UNLOCK (task);
+
+  if (cpus == NULL)
+    return FALSE;
+
+  CPU_ZERO (&set);
+  parse_cpu_list (cpus, cpu_set_add, &set);
+
+  if (sched_getaffinity (0, sizeof (cpu_set_t), saved) < 0) {
+    GST_WARNING_OBJECT (task, "Failed to get CPU affinity: %s",
+        g_strerror (errno));
+    goto done;
+  }
+  if (sched_setaffinity (0, sizeof (cpu_set_t), &set) < 0) {
+    GST_WARNING_OBJECT (task, "Failed to set CPU affinity to %s: %s", cpus,
+        g_strerror (errno));
+    goto done;
+  }
+  GST_DEBUG_OBJECT (task, "Running on CPUs %s", cpus);
+  res = TRUE;
+
+done:
+  g_free (cpus);
+  return res;
+}
+#endif
+
+#ifdef HAVE_TASK_SCHEDULING
+typedef struct
+{
+  gboolean valid;
+  int policy;
+  struct sched_param param;
+} GstTaskSavedScheduling;
+
+static void
+gst_task_check_rt_throttling (GstTask * task)
+{
+#ifdef __linux__
+  gchar *contents;
+  gint64 runtime;
+
+  if (!g_file_get_contents ("/proc/sys/kernel/sched_rt_runtime_us",
+          &contents, NULL, NULL))
+    return;
+
+  runtime = g_ascii_strtoll (contents, NULL, 10);
+  g_free (contents);
+
+  /* the kernel normally keeps some time of every period for the normal
+   * threads so that a runaway realtime thread can't lock up the system */
+  if (runtime < 0)
+    GST_WARNING_OBJECT (task, "Realtime throttling is disabled, a busy "
+        "realtime task can starve the whole system");
+  else
+    GST_INFO_OBJECT (task, "Realtime threads are throttled to %"
+        G_GINT64_FORMAT " us per period", runtime);
+#endif
+}
+
+/* switch the calling thread to the scheduling configured for @task. The
+ * scheduling the thread had before is kept in @saved. */
+static void
+gst_task_configure_scheduling (GstTask * task, GstTaskSavedScheduling * saved)
+{
+  GstTaskSchedulingPolicy policy;
+  gint priority;
+  struct sched_param param;
+  int sched_policy, res;
+
+  GST_OBJECT_LOCK (task);
+  policy = task->priv->sched_policy;
+  priority = task->priv->sched_priority;
+  task->priv->sched_changed = FALSE;
+  GST_OBJECT_UNLOCK (task);
+
+  if (policy == GST_TASK_SCHEDULING_DEFAULT) {
+    if (saved->valid) {
+      pthread_setschedparam (pthread_self (), saved->policy, &saved->param);
+      saved->valid = FALSE;
+    }
+    return;
+  }
+
+  if (!saved->valid) {
+    res = pthread_getschedparam (pthread_self (), &saved->policy,
+        &saved->param);
+    if (res != 0) {
+      GST_WARNING_OBJECT (task, "Failed to get scheduling: %s",
+          g_strerror (res));
+      return;
+    }
+    saved->valid = TRUE;
+  }
+
+  switch (policy) {
+    case GST_TASK_SCHEDULING_FIFO:
+      sched_policy = SCHED_FIFO;
+      break;
+    case GST_TASK_SCHEDULING_RR:
+      sched_policy = SCHED_RR;
+      break;
+    case GST_TASK_SCHEDULING_NORMAL:
+    default:
+      sched_policy = SCHED_OTHER;
+      break;
+  }
+
+  memset (&param, 0, sizeof (param));
+  if (sched_policy != SCHED_OTHER) {
+    param.sched_priority = CLAMP (priority,
+        sched_get_priority_min (sched_policy),
+        sched_get_priority_max (sched_policy));
+    gst_task_check_rt_throttling (task);
+  }
+
+  res = pthread_setschedparam (pthread_self (), sched_policy, &param);
+#ifdef RLIMIT_RTPRIO
+  if (res == EPERM && sched_policy != SCHED_OTHER) {
+    struct rlimit rl;
+
+    /* without privileges, priorities up to RLIMIT_RTPRIO are still allowed */
+    if (getrlimit (RLIMIT_RTPRIO, &rl) == 0 && rl.rlim_cur > 0 &&
+        rl.rlim_cur < (rlim_t) param.sched_priority) {
+      GST_INFO_OBJECT (task, "Lowering priority %d to the limit of %d",
+          param.sched_priority, (gint) rl.rlim_cur);
+      param.sched_priority = rl.rlim_cur;
+      res = pthread_setschedparam (pthread_self (), sched_policy, &param);
+    }
+  }
+#endif
+  if (res != 0) {
+    GST_WARNING_OBJECT (task, "Failed to set scheduling policy %d with "
+        "priority %d, keeping the current scheduling: %s", sched_policy,
+        param.sched_priority, g_strerror (res));
+    return;
+  }
+
+  GST_DEBUG_OBJECT (task, "Running with scheduling policy %d, priority %d",
+      sched_policy, param.sched_priority);
+}
+#endif
+
 static void
 gst_task_func (GstTask * task)
 {
   GRecMutex *lock;
   GThread *tself;
   GstTaskPrivate *priv;
+#ifdef HAVE_SCHED_SETAFFINITY
+  cpu_set_t saved_affinity;
+  gboolean restore_affinity;
+#endif
+#ifdef HAVE_TASK_SCHEDULING
+  GstTaskSavedScheduling saved_scheduling = { FALSE, };
+  gboolean sched_changed = FALSE;
+#endif
 
   priv = task->priv;
 
@@ -310,6 +575,13 @@ gst_task_func (GstTask * task)
   g_rec_mutex_lock (lock);
   /* configure the thread name now */
   gst_task_configure_name (task);
+#ifdef HAVE_SCHED_SETAFFINITY
+  restore_affinity = gst_task_configure_affinity (task, &saved_affinity);
+#endif
+#ifdef HAVE_TASK_SCHEDULING
+  if (priv->sched_policy != GST_TASK_SCHEDULING_DEFAULT)
+    gst_task_configure_scheduling (task, &saved_scheduling);
+#endif
 
   while (G_LIKELY (GET_TASK_STATE (task) != GST_TASK_STOPPED)) {
     GST_OBJECT_LOCK (task);
@@ -338,15 +610,34 @@ gst_task_func (GstTask * task)
       GST_OBJECT_UNLOCK (task);
       break;
     } else {
+#ifdef HAVE_TASK_SCHEDULING
+      sched_changed = priv->sched_changed;
+#endif
       GST_OBJECT_UNLOCK (task);
     }
 
+#ifdef HAVE_TASK_SCHEDULING
+    if (G_UNLIKELY (sched_changed))
+      gst_task_configure_scheduling (task, &saved_scheduling);
+#endif
+
     task->func (task->user_data);
 
     if (priv->scheduleable)
       break;
   }
 
+#ifdef HAVE_SCHED_SETAFFINITY
+  /* the thread might be reused by the pool for something else */
+  if (restore_affinity)
+    sched_setaffinity (0, sizeof (cpu_set_t), &saved_affinity);
+#endif
+#ifdef HAVE_TASK_SCHEDULING
+  if (saved_scheduling.valid)
+    pthread_setschedparam (pthread_self (), saved_scheduling.policy,
+        &saved_scheduling.param);
+#endif
+
   g_rec_mutex_unlock (lock);
 
   GST_OBJECT_LOCK (task);
@@ -626,6 +917,218 @@ gst_task_set_leave_callback (GstTask * task, GstTaskThreadFunc leave_func,
   GST_OBJECT_UNLOCK (task);
 }
 
+/**
+ * gst_task_set_cpu_affinity:
+ * @task: a #GstTask
+ * @cpus: (allow-none): a list of CPUs like "0-3,8", or %NULL
+ *
+ * Make the thread of @task only run on the CPUs in @cpus, which is a comma
+ * separated list of CPU numbers and ranges of CPU numbers. With %NULL, the
+ * thread can run on any CPU again.
+ *
+ * The affinity is applied the next time the task function is entered, so this
+ * is best called before the task is started. CPU affinity is not supported on
+ * all platforms, the call has no effect then.
+ *
+ * Returns: %TRUE if @cpus could be parsed.
+ *
+ * MT safe.
+ *
+ * Since: 1.10
+ */
+gboolean
+gst_task_set_cpu_affinity (GstTask * task, const gchar * cpus)
+{
+  g_return_val_if_fail (GST_IS_TASK (task), FALSE);
+
+  if (cpus && !parse_cpu_list (cpus, NULL, NULL))
+    goto invalid_cpus;
+
+  GST_OBJECT_LOCK (task);
+  g_free (task->priv->cpu_affinity);
+  task->priv->cpu_affinity = g_strdup (cpus);
+  task->priv->numa_node = -1;
+  GST_OBJECT_UNLOCK (task);
+
+  return TRUE;
+
+  /* ERRORS */
+invalid_cpus:
+  {
+    GST_WARNING_OBJECT (task, "Invalid CPU list '%s'", cpus);
+    return FALSE;
+  }
+}
+
+/**
+ * gst_task_get_cpu_affinity:
+ * @task: a #GstTask
+ *
+ * Get the CPUs the thread of @task runs on, as configured with
+ * gst_task_set_cpu_affinity() or gst_task_set_numa_node().
+ *
+ * Returns: (transfer full) (nullable): a list of CPUs, or %NULL when the
+ * thread can run on any CPU. g_free() after usage.
+ *
+ * MT safe.
+ *
+ * Since: 1.10
+ */
+gchar *
+gst_task_get_cpu_affinity (GstTask * task)
+{
+  gchar *result;
+
+  g_return_val_if_fail (GST_IS_TASK (task), NULL);
+
+  GST_OBJECT_LOCK (task);
+  result = g_strdup (task->priv->cpu_affinity);
+  GST_OBJECT_UNLOCK (task);
+
+  return result;
+}
+
+/**
+ * gst_task_set_numa_node:
+ * @task: a #GstTask
+ * @node: a NUMA node number, or -1
+ *
+ * Make the thread of @task only run on the CPUs of NUMA node @node. With -1,
+ * the thread can run on any CPU again. See also gst_task_set_cpu_affinity().
+ *
+ * Returns: %TRUE if the CPUs of @node are known.
+ *
+ * MT safe.
+ *
+ * Since: 1.10
+ */
+gboolean
+gst_task_set_numa_node (GstTask * task, gint node)
+{
+  gchar *path, *cpus = NULL;
+  gboolean res;
+
+  g_return_val_if_fail (GST_IS_TASK (task), FALSE);
+  g_return_val_if_fail (node >= -1, FALSE);
+
+  if (node == -1)
+    return gst_task_set_cpu_affinity (task, NULL);
+
+  path = g_strdup_printf ("/sys/devices/system/node/node%d/cpulist", node);
+  res = g_file_get_contents (path, &cpus, NULL, NULL);
+  g_free (path);
+  if (!res)
+    goto unknown_node;
+
+  res = gst_task_set_cpu_affinity (task, g_strstrip (cpus));
+  if (res) {
+    GST_OBJECT_LOCK (task);
+    task->priv->numa_node = node;
+    GST_OBJECT_UNLOCK (task);
+  }
+  g_free (cpus);
+
+  return res;
+
+  /* ERRORS */
+unknown_node:
+  {
+    GST_WARNING_OBJECT (task, "Unknown NUMA node %d", node);
+    return FALSE;
+  }
+}
+
+/**
+ * gst_task_get_numa_node:
+ * @task: a #GstTask
+ *
+ * Get the NUMA node configured with gst_task_set_numa_node().
+ *
+ * Returns: the NUMA node, or -1 when no node is configured.
+ *
+ * MT safe.
+ *
+ * Since: 1.10
+ */
+gint
+gst_task_get_numa_node (GstTask * task)
+{
+  gint result;
+
+  g_return_val_if_fail (GST_IS_TASK (task), -1);
+
+  GST_OBJECT_LOCK (task);
+  result = task->priv->numa_node;
+  GST_OBJECT_UNLOCK (task);
+
+  return result;
+}
+
+/**
+ * gst_task_set_scheduling:
+ * @task: a #GstTask
+ * @policy: the scheduling policy
+ * @priority: the realtime priority
+ *
+ * Make the thread of @task run with the scheduling @policy. For the realtime
+ * policies, @priority is the static priority of the thread, usually between
+ * 1 and 99, and it is clamped to the range the system supports. It is not
+ * used for the other policies.
+ *
+ * The scheduling is changed by the thread of @task itself, when it enters the
+ * task function or before it calls the function the next time. Without the
+ * privileges for realtime scheduling, the priority is lowered to the
+ * RLIMIT_RTPRIO of the process, or the thread keeps its current scheduling
+ * when that is not possible either. When the thread leaves @task, it gets the
+ * scheduling back it had before. Scheduling policies are not supported on all
+ * platforms, the call has no effect then.
+ *
+ * MT safe.
+ *
+ * Since: 1.10
+ */
+void
+gst_task_set_scheduling (GstTask * task, GstTaskSchedulingPolicy policy,
+    gint priority)
+{
+  g_return_if_fail (GST_IS_TASK (task));
+
+  GST_OBJECT_LOCK (task);
+  if (task->priv->sched_policy != policy
+      || task->priv->sched_priority != priority) {
+    task->priv->sched_policy = policy;
+    task->priv->sched_priority = priority;
+    task->priv->sched_changed = TRUE;
+  }
+  GST_OBJECT_UNLOCK (task);
+}
+
+/**
+ * gst_task_get_scheduling:
+ * @task: a #GstTask
+ * @policy: (out) (allow-none): the scheduling policy
+ * @priority: (out) (allow-none): the realtime priority
+ *
+ * Get the scheduling configured with gst_task_set_scheduling().
+ *
+ * MT safe.
+ *
+ * Since: 1.10
+ */
+void
+gst_task_get_scheduling (GstTask * task, GstTaskSchedulingPolicy * policy,
+    gint * priority)
+{
+  g_return_if_fail (GST_IS_TASK (task));
+
+  GST_OBJECT_LOCK (task);
+  if (policy)
+    *policy = task->priv->sched_policy;
+  if (priority)
+    *priority = task->priv->sched_priority;
+  GST_OBJECT_UNLOCK (task);
+}
+
 /**
  * gst_task_get_state:
  * @task: The #GstTask to query
@@ -731,8 +1234,13 @@ gst_task_set_state (GstTask * task, GstTaskState state)
           res = start_task (task);
         break;
       case GST_TASK_PAUSED:
-        /* when we are paused, signal to go to the new state */
-        GST_TASK_SIGNAL (task);
+        /* when we are paused, signal to go to the new state. A paused
+         * scheduleable task has no thread waiting, push it again. */
+        if (task->priv->scheduleable && !task->running
+            && task->priv->should_schedule && state == GST_TASK_STARTED)
+          res = start_task (task);
+        else
+          GST_TASK_SIGNAL (task);
         break;
       case GST_TASK_STARTED:
         /* if we were started, we'll go to the new state after the next
@@ -921,10 +1429,13 @@ gst_task_schedule (GstTask * task)
 
   GST_OBJECT_LOCK (task);
   GST_DEBUG_OBJECT (task, "Scheduling task");
+  /* When the task is still running this iteration, possibly after having
+   * unscheduled itself, it will be pushed again when it finishes. Otherwise
+   * the wakeup would be lost. */
+  task->priv->should_schedule = TRUE;
   if (!task->running && task->priv->scheduleable
       && GET_TASK_STATE (task) == GST_TASK_STARTED) {
     GST_DEBUG_OBJECT (task, "Task needs to be scheduled");
-    task->priv->should_schedule = TRUE;
     start_task (task);
   }
   GST_OBJECT_UNLOCK (task);
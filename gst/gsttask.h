@@ -64,6 +64,26 @@ typedef enum {
   GST_TASK_PAUSED
 } GstTaskState;
 
+/**
+ * GstTaskSchedulingPolicy:
+ * @GST_TASK_SCHEDULING_DEFAULT: keep the scheduling the thread already has
+ * @GST_TASK_SCHEDULING_NORMAL: the normal time sharing scheduling
+ *   (SCHED_OTHER), also when the thread was created from a realtime thread
+ * @GST_TASK_SCHEDULING_FIFO: realtime first-in first-out scheduling
+ *   (SCHED_FIFO)
+ * @GST_TASK_SCHEDULING_RR: realtime round-robin scheduling (SCHED_RR)
+ *
+ * The scheduling policies the thread of a #GstTask can run with.
+ *
+ * Since: 1.10
+ */
+typedef enum {
+  GST_TASK_SCHEDULING_DEFAULT,
+  GST_TASK_SCHEDULING_NORMAL,
+  GST_TASK_SCHEDULING_FIFO,
+  GST_TASK_SCHEDULING_RR
+} GstTaskSchedulingPolicy;
+
 /**
  * GST_TASK_STATE:
  * @task: Task to get the state of
@@ -185,6 +205,19 @@ void            gst_task_set_leave_callback  (GstTask *task,
                                               gpointer user_data,
                                               GDestroyNotify notify);
 
+gboolean        gst_task_set_cpu_affinity (GstTask *task, const gchar *cpus);
+gchar *         gst_task_get_cpu_affinity (GstTask *task);
+
+gboolean        gst_task_set_numa_node  (GstTask *task, gint node);
+gint            gst_task_get_numa_node  (GstTask *task);
+
+void            gst_task_set_scheduling (GstTask *task,
+                                         GstTaskSchedulingPolicy policy,
+                                         gint priority);
+void            gst_task_get_scheduling (GstTask *task,
+                                         GstTaskSchedulingPolicy *policy,
+                                         gint *priority);
+
 GstTaskState    gst_task_get_state      (GstTask *task);
 gboolean        gst_task_set_state      (GstTask *task, GstTaskState state);
 
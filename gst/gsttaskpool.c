@@ -29,6 +29,12 @@
  * implementation uses a regular GThreadPool to start tasks.
  *
  * Subclasses can be made to create custom threads.
+ *
+ * #GstWorkStealingTaskPool runs pushed functions on a fixed number of
+ * worker threads with per-worker queues. Together with scheduleable tasks
+ * this allows many pipelines to share a small number of threads, set it on
+ * the tasks with gst_task_set_pool(), for example from a
+ * %GST_MESSAGE_STREAM_STATUS sync handler.
  */
 
 #include "gst_private.h"
@@ -424,3 +430,401 @@ gst_task_pool_get_default (void)
 
   return gst_object_ref (pool);
 }
+
+/* GstWorkStealingTaskPool */
+
+typedef struct _GstWorkStealingWorker GstWorkStealingWorker;
+
+struct _GstWorkStealingWorker
+{
+  GstWorkStealingTaskPool *pool;
+  guint index;
+  GThread *thread;
+
+  /* protects deque */
+  GMutex lock;
+  /* of TaskData, the owner pops from the head, new work is appended to
+   * the tail and thieves take from the head too, so every worker runs its
+   * own work in push order */
+  GQueue deque;
+};
+
+struct _GstWorkStealingTaskPoolPrivate
+{
+  guint n_threads;
+
+  /* protects workers and n_workers against prepare/cleanup, pushing only
+   * takes the reader side */
+  GRWLock workers_lock;
+  GstWorkStealingWorker *workers;
+  guint n_workers;
+  gboolean shutdown;
+
+  /* round robin counter for pushes from outside the pool */
+  volatile gint next_worker;
+
+  /* number of TaskData queued in all deques */
+  volatile gint n_pending;
+  /* number of workers sleeping on idle_cond */
+  volatile gint n_idle;
+  GMutex idle_lock;
+  GCond idle_cond;
+};
+
+/* the worker structure of the current thread, if it is a pool worker */
+static GPrivate current_worker = G_PRIVATE_INIT (NULL);
+
+static void gst_work_stealing_task_pool_finalize (GObject * object);
+
+#define GST_WORK_STEALING_TASK_POOL_GET_PRIVATE(obj)  \
+   (G_TYPE_INSTANCE_GET_PRIVATE ((obj), GST_TYPE_WORK_STEALING_TASK_POOL, \
+       GstWorkStealingTaskPoolPrivate))
+
+G_DEFINE_TYPE (GstWorkStealingTaskPool, gst_work_stealing_task_pool,
+    GST_TYPE_TASK_POOL);
+
+/* move half of the work of @victim to @worker and return the first item
+ * to run, or %NULL when @victim has nothing queued. */
+static TaskData *
+ws_steal (GstWorkStealingWorker * worker, GstWorkStealingWorker * victim)
+{
+  TaskData *tdata;
+  GQueue stolen = G_QUEUE_INIT;
+  guint n;
+
+  g_mutex_lock (&victim->lock);
+  tdata = g_queue_pop_head (&victim->deque);
+  if (tdata != NULL) {
+    n = victim->deque.length / 2;
+    while (n--)
+      g_queue_push_tail (&stolen, g_queue_pop_head (&victim->deque));
+  }
+  g_mutex_unlock (&victim->lock);
+
+  if (stolen.length > 0) {
+    GST_LOG_OBJECT (worker->pool, "worker %u stole %u extra from worker %u",
+        worker->index, stolen.length, victim->index);
+    g_mutex_lock (&worker->lock);
+    while (stolen.head != NULL)
+      g_queue_push_tail (&worker->deque, g_queue_pop_head (&stolen));
+    g_mutex_unlock (&worker->lock);
+  }
+
+  return tdata;
+}
+
+static TaskData *
+ws_next (GstWorkStealingWorker * worker)
+{
+  GstWorkStealingTaskPoolPrivate *priv = worker->pool->priv;
+  TaskData *tdata;
+  guint i;
+
+  g_mutex_lock (&worker->lock);
+  tdata = g_queue_pop_head (&worker->deque);
+  g_mutex_unlock (&worker->lock);
+
+  for (i = 1; tdata == NULL && i < priv->n_workers; i++) {
+    /* nothing queued anywhere, don't bother locking every deque */
+    if (g_atomic_int_get (&priv->n_pending) == 0)
+      break;
+    tdata =
+        ws_steal (worker,
+        &priv->workers[(worker->index + i) % priv->n_workers]);
+  }
+
+  if (tdata != NULL)
+    g_atomic_int_add (&priv->n_pending, -1);
+
+  return tdata;
+}
+
+static gpointer
+ws_worker_func (GstWorkStealingWorker * worker)
+{
+  GstWorkStealingTaskPoolPrivate *priv = worker->pool->priv;
+  TaskData *tdata;
+
+  g_private_set (&current_worker, worker);
+
+  while (TRUE) {
+    if ((tdata = ws_next (worker))) {
+      default_func (tdata, GST_TASK_POOL_CAST (worker->pool));
+      continue;
+    }
+
+    /* Announce ourselves as idle before checking for pending work again,
+     * a pusher increments n_pending before looking at n_idle so either we
+     * see its work or it sees us and signals with the idle_lock held. */
+    g_mutex_lock (&priv->idle_lock);
+    g_atomic_int_inc (&priv->n_idle);
+    while (g_atomic_int_get (&priv->n_pending) == 0 && !priv->shutdown)
+      g_cond_wait (&priv->idle_cond, &priv->idle_lock);
+    g_atomic_int_add (&priv->n_idle, -1);
+    if (priv->shutdown && g_atomic_int_get (&priv->n_pending) == 0) {
+      g_mutex_unlock (&priv->idle_lock);
+      break;
+    }
+    g_mutex_unlock (&priv->idle_lock);
+  }
+
+  g_private_set (&current_worker, NULL);
+
+  return NULL;
+}
+
+static void
+ws_stop_workers (GstWorkStealingTaskPool * pool)
+{
+  GstWorkStealingTaskPoolPrivate *priv = pool->priv;
+  GstWorkStealingWorker *workers;
+  guint i, n_workers;
+
+  /* refuse new work, the workers still run what is queued */
+  g_rw_lock_writer_lock (&priv->workers_lock);
+  workers = priv->workers;
+  n_workers = priv->n_workers;
+  g_mutex_lock (&priv->idle_lock);
+  priv->shutdown = TRUE;
+  g_cond_broadcast (&priv->idle_cond);
+  g_mutex_unlock (&priv->idle_lock);
+  g_rw_lock_writer_unlock (&priv->workers_lock);
+
+  if (workers == NULL)
+    return;
+
+  for (i = 0; i < n_workers; i++) {
+    if (workers[i].thread)
+      g_thread_join (workers[i].thread);
+  }
+
+  g_rw_lock_writer_lock (&priv->workers_lock);
+  for (i = 0; i < n_workers; i++)
+    g_mutex_clear (&workers[i].lock);
+  g_free (workers);
+  priv->workers = NULL;
+  priv->n_workers = 0;
+  g_rw_lock_writer_unlock (&priv->workers_lock);
+}
+
+static void
+ws_prepare (GstTaskPool * pool, GError ** error)
+{
+  GstWorkStealingTaskPool *self = GST_WORK_STEALING_TASK_POOL_CAST (pool);
+  GstWorkStealingTaskPoolPrivate *priv = self->priv;
+  GstWorkStealingWorker *workers;
+  gchar *name;
+  guint i, n_threads;
+
+  g_rw_lock_writer_lock (&priv->workers_lock);
+  if (priv->workers != NULL)
+    goto already_prepared;
+
+  n_threads = priv->n_threads;
+  if (n_threads == 0)
+    n_threads = g_get_num_processors ();
+
+  workers = g_new0 (GstWorkStealingWorker, n_threads);
+  for (i = 0; i < n_threads; i++) {
+    workers[i].pool = self;
+    workers[i].index = i;
+    g_mutex_init (&workers[i].lock);
+    g_queue_init (&workers[i].deque);
+  }
+  priv->workers = workers;
+  priv->n_workers = n_threads;
+  priv->shutdown = FALSE;
+  g_rw_lock_writer_unlock (&priv->workers_lock);
+
+  GST_DEBUG_OBJECT (pool, "starting %u workers", n_threads);
+
+  for (i = 0; i < n_threads; i++) {
+    name = g_strdup_printf ("wspool-%u", i);
+    workers[i].thread =
+        g_thread_try_new (name, (GThreadFunc) ws_worker_func, &workers[i],
+        error);
+    g_free (name);
+    if (workers[i].thread == NULL)
+      goto no_thread;
+  }
+  return;
+
+  /* ERRORS */
+already_prepared:
+  {
+    g_rw_lock_writer_unlock (&priv->workers_lock);
+    GST_DEBUG_OBJECT (pool, "already prepared");
+    return;
+  }
+no_thread:
+  {
+    GST_WARNING_OBJECT (pool, "failed to start worker %u", i);
+    ws_stop_workers (self);
+    return;
+  }
+}
+
+static void
+ws_cleanup (GstTaskPool * pool)
+{
+  ws_stop_workers (GST_WORK_STEALING_TASK_POOL_CAST (pool));
+}
+
+static gpointer
+ws_push (GstTaskPool * pool, GstTaskPoolFunction func,
+    gpointer user_data, GError ** error)
+{
+  GstWorkStealingTaskPoolPrivate *priv =
+      GST_WORK_STEALING_TASK_POOL_CAST (pool)->priv;
+  GstWorkStealingWorker *worker;
+  TaskData *tdata;
+
+  g_rw_lock_reader_lock (&priv->workers_lock);
+  if (G_UNLIKELY (priv->workers == NULL || priv->shutdown))
+    goto not_prepared;
+
+  tdata = g_slice_new (TaskData);
+  tdata->func = func;
+  tdata->user_data = user_data;
+
+  /* work pushed from one of our workers stays on that worker, typically a
+   * scheduleable task rescheduling itself, everything else is spread */
+  worker = g_private_get (&current_worker);
+  if (worker == NULL || worker->pool != GST_WORK_STEALING_TASK_POOL_CAST (pool))
+    worker = &priv->workers[(guint) g_atomic_int_add (&priv->next_worker,
+            1) % priv->n_workers];
+
+  g_mutex_lock (&worker->lock);
+  g_queue_push_tail (&worker->deque, tdata);
+  g_mutex_unlock (&worker->lock);
+
+  g_atomic_int_inc (&priv->n_pending);
+  if (g_atomic_int_get (&priv->n_idle) > 0) {
+    g_mutex_lock (&priv->idle_lock);
+    g_cond_signal (&priv->idle_cond);
+    g_mutex_unlock (&priv->idle_lock);
+  }
+  g_rw_lock_reader_unlock (&priv->workers_lock);
+
+  return NULL;
+
+  /* ERRORS */
+not_prepared:
+  {
+    g_rw_lock_reader_unlock (&priv->workers_lock);
+    GST_WARNING_OBJECT (pool, "pool is not prepared");
+    return NULL;
+  }
+}
+
+static void
+gst_work_stealing_task_pool_class_init (GstWorkStealingTaskPoolClass * klass)
+{
+  GObjectClass *gobject_class;
+  GstTaskPoolClass *gsttaskpool_class;
+
+  gobject_class = (GObjectClass *) klass;
+  gsttaskpool_class = (GstTaskPoolClass *) klass;
+
+  g_type_class_add_private (gobject_class,
+      sizeof (GstWorkStealingTaskPoolPrivate));
+
+  gobject_class->finalize = gst_work_stealing_task_pool_finalize;
+
+  gsttaskpool_class->prepare = ws_prepare;
+  gsttaskpool_class->cleanup = ws_cleanup;
+  gsttaskpool_class->push = ws_push;
+  /* join is inherited, there is nothing to join for a single run */
+}
+
+static void
+gst_work_stealing_task_pool_init (GstWorkStealingTaskPool * pool)
+{
+  pool->priv = GST_WORK_STEALING_TASK_POOL_GET_PRIVATE (pool);
+
+  pool->priv->n_threads = 0;
+  g_rw_lock_init (&pool->priv->workers_lock);
+  pool->priv->workers = NULL;
+  pool->priv->n_workers = 0;
+  pool->priv->shutdown = FALSE;
+  pool->priv->next_worker = 0;
+  pool->priv->n_pending = 0;
+  pool->priv->n_idle = 0;
+  g_mutex_init (&pool->priv->idle_lock);
+  g_cond_init (&pool->priv->idle_cond);
+}
+
+static void
+gst_work_stealing_task_pool_finalize (GObject * object)
+{
+  GstWorkStealingTaskPool *pool = GST_WORK_STEALING_TASK_POOL (object);
+
+  ws_stop_workers (pool);
+
+  g_rw_lock_clear (&pool->priv->workers_lock);
+  g_mutex_clear (&pool->priv->idle_lock);
+  g_cond_clear (&pool->priv->idle_cond);
+
+  G_OBJECT_CLASS (gst_work_stealing_task_pool_parent_class)->finalize (object);
+}
+
+/**
+ * gst_work_stealing_task_pool_new:
+ * @n_threads: the number of worker threads, 0 for one per processor
+ *
+ * Create a new task pool running all pushed functions on a fixed set of
+ * @n_threads worker threads. Every worker has its own queue; work pushed
+ * from a worker is queued on that same worker and idle workers steal
+ * half of the queue of a busy one.
+ *
+ * This pool is meant for scheduleable tasks, see
+ * gst_task_set_scheduleable(), where every push runs a single iteration of
+ * the task function. This allows many pipelines to share a few threads
+ * instead of creating one thread per streaming task. A regular #GstTask
+ * occupies its worker until it is stopped, so no more than @n_threads of
+ * them can run at the same time.
+ *
+ * Returns: (transfer full): a new #GstTaskPool. gst_object_unref() after usage.
+ *
+ * Since: 1.10
+ */
+GstTaskPool *
+gst_work_stealing_task_pool_new (guint n_threads)
+{
+  GstTaskPool *pool;
+
+  pool = g_object_newv (GST_TYPE_WORK_STEALING_TASK_POOL, 0, NULL);
+
+  GST_WORK_STEALING_TASK_POOL_CAST (pool)->priv->n_threads = n_threads;
+
+  return pool;
+}
+
+/**
+ * gst_work_stealing_task_pool_get_n_threads:
+ * @pool: a #GstWorkStealingTaskPool
+ *
+ * Get the number of worker threads of @pool. This is the number of
+ * processors when @pool was created with 0 threads and is prepared.
+ *
+ * Returns: the number of worker threads.
+ *
+ * Since: 1.10
+ */
+guint
+gst_work_stealing_task_pool_get_n_threads (GstWorkStealingTaskPool * pool)
+{
+  guint n_threads;
+
+  g_return_val_if_fail (GST_IS_WORK_STEALING_TASK_POOL (pool), 0);
+
+  g_rw_lock_reader_lock (&pool->priv->workers_lock);
+  n_threads = pool->priv->n_workers;
+  if (n_threads == 0)
+    n_threads = pool->priv->n_threads;
+  if (n_threads == 0)
+    n_threads = g_get_num_processors ();
+  g_rw_lock_reader_unlock (&pool->priv->workers_lock);
+
+  return n_threads;
+}
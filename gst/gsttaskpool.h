@@ -104,8 +104,57 @@ GstTaskPool *   gst_task_pool_get_default (void);
 gboolean        gst_task_pool_need_schedule_thread (GstTaskPool *pool, gboolean needed);
 GMainContext *  gst_task_pool_get_schedule_context (GstTaskPool *pool);
 
+/* work stealing pool */
+#define GST_TYPE_WORK_STEALING_TASK_POOL             (gst_work_stealing_task_pool_get_type ())
+#define GST_WORK_STEALING_TASK_POOL(pool)            (G_TYPE_CHECK_INSTANCE_CAST ((pool), GST_TYPE_WORK_STEALING_TASK_POOL, GstWorkStealingTaskPool))
+#define GST_IS_WORK_STEALING_TASK_POOL(pool)         (G_TYPE_CHECK_INSTANCE_TYPE ((pool), GST_TYPE_WORK_STEALING_TASK_POOL))
+#define GST_WORK_STEALING_TASK_POOL_CLASS(pclass)    (G_TYPE_CHECK_CLASS_CAST ((pclass), GST_TYPE_WORK_STEALING_TASK_POOL, GstWorkStealingTaskPoolClass))
+#define GST_IS_WORK_STEALING_TASK_POOL_CLASS(pclass) (G_TYPE_CHECK_CLASS_TYPE ((pclass), GST_TYPE_WORK_STEALING_TASK_POOL))
+#define GST_WORK_STEALING_TASK_POOL_GET_CLASS(pool)  (G_TYPE_INSTANCE_GET_CLASS ((pool), GST_TYPE_WORK_STEALING_TASK_POOL, GstWorkStealingTaskPoolClass))
+#define GST_WORK_STEALING_TASK_POOL_CAST(pool)       ((GstWorkStealingTaskPool*)(pool))
+
+typedef struct _GstWorkStealingTaskPool GstWorkStealingTaskPool;
+typedef struct _GstWorkStealingTaskPoolClass GstWorkStealingTaskPoolClass;
+typedef struct _GstWorkStealingTaskPoolPrivate GstWorkStealingTaskPoolPrivate;
+
+/**
+ * GstWorkStealingTaskPool:
+ *
+ * The #GstWorkStealingTaskPool object.
+ *
+ * Since: 1.10
+ */
+struct _GstWorkStealingTaskPool {
+  GstTaskPool    parent;
+
+  /*< private >*/
+  GstWorkStealingTaskPoolPrivate *priv;
+  gpointer _gst_reserved[GST_PADDING];
+};
+
+/**
+ * GstWorkStealingTaskPoolClass:
+ * @parent_class: the parent class structure
+ *
+ * The #GstWorkStealingTaskPoolClass object.
+ *
+ * Since: 1.10
+ */
+struct _GstWorkStealingTaskPoolClass {
+  GstTaskPoolClass parent_class;
+
+  /*< private >*/
+  gpointer _gst_reserved[GST_PADDING];
+};
+
+GType           gst_work_stealing_task_pool_get_type      (void);
+
+GstTaskPool *   gst_work_stealing_task_pool_new           (guint n_threads);
+guint           gst_work_stealing_task_pool_get_n_threads (GstWorkStealingTaskPool *pool);
+
 #ifdef G_DEFINE_AUTOPTR_CLEANUP_FUNC
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(GstTaskPool, gst_object_unref)
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(GstWorkStealingTaskPool, gst_object_unref)
 #endif
 
 G_END_DECLS
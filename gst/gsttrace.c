@@ -41,8 +41,40 @@
 
 #include "gsttrace.h"
 
+/* protects the list of tracers, the counting itself doesn't take it */
 GMutex _gst_trace_mutex;
 
+/* the live counts are spread over several cache lines that threads pick
+ * according to their index, the live pointers are spread over several hash
+ * sets according to the pointer. Both only get summed up when dumping. */
+#define N_SHARDS 16
+#define CACHE_LINE_SIZE 64
+
+typedef struct
+{
+  volatile gint live;
+  gchar padding[CACHE_LINE_SIZE - sizeof (gint)];
+} LiveShard;
+
+typedef struct
+{
+  GMutex lock;
+  GHashTable *mem_live;
+  gchar padding[CACHE_LINE_SIZE - sizeof (GMutex) - sizeof (gpointer)];
+} MemShard;
+
+typedef struct
+{
+  GstAllocTrace trace;
+
+  LiveShard live[N_SHARDS];
+  MemShard mem[N_SHARDS];
+} GstAllocTraceImpl;
+
+/* index + 1 of the current thread */
+static GPrivate thread_index;
+static volatile gint n_threads = 0;
+
 /* global flags */
 static GstAllocTraceFlags _gst_trace_flags = GST_ALLOC_TRACE_NONE;
 
@@ -96,20 +128,115 @@ _priv_gst_alloc_trace_register (const gchar * name, goffset offset)
 {
   GstAllocTrace *trace;
 
+  GstAllocTraceImpl *impl;
+  guint i;
+
   g_return_val_if_fail (name, NULL);
 
-  trace = g_slice_new (GstAllocTrace);
+  impl = g_slice_new0 (GstAllocTraceImpl);
+  trace = &impl->trace;
   trace->name = g_strdup (name);
   trace->live = 0;
   trace->mem_live = NULL;
   trace->flags = _gst_trace_flags;
   trace->offset = offset;
 
+  if (trace->flags & GST_ALLOC_TRACE_MEM_LIVE) {
+    for (i = 0; i < N_SHARDS; i++) {
+      g_mutex_init (&impl->mem[i].lock);
+      impl->mem[i].mem_live = g_hash_table_new (NULL, NULL);
+    }
+  }
+
+  g_mutex_lock (&_gst_trace_mutex);
   _gst_alloc_tracers = g_list_prepend (_gst_alloc_tracers, trace);
+  g_mutex_unlock (&_gst_trace_mutex);
 
   return trace;
 }
 
+static inline LiveShard *
+gst_alloc_trace_live_shard (GstAllocTraceImpl * impl)
+{
+  guint idx = GPOINTER_TO_UINT (g_private_get (&thread_index));
+
+  if (G_UNLIKELY (idx == 0)) {
+    idx = (guint) g_atomic_int_add (&n_threads, 1) + 1;
+    g_private_set (&thread_index, GUINT_TO_POINTER (idx));
+  }
+  return &impl->live[(idx - 1) % N_SHARDS];
+}
+
+static inline MemShard *
+gst_alloc_trace_mem_shard (GstAllocTraceImpl * impl, gpointer mem)
+{
+  /* allocations are at least 8 byte aligned */
+  return &impl->mem[(GPOINTER_TO_SIZE (mem) >> 4) % N_SHARDS];
+}
+
+void
+_priv_gst_alloc_trace_new (GstAllocTrace * trace, gpointer mem)
+{
+  GstAllocTraceImpl *impl = (GstAllocTraceImpl *) trace;
+
+  if (trace->flags & GST_ALLOC_TRACE_LIVE)
+    g_atomic_int_inc (&gst_alloc_trace_live_shard (impl)->live);
+
+  if (trace->flags & GST_ALLOC_TRACE_MEM_LIVE) {
+    MemShard *shard = gst_alloc_trace_mem_shard (impl, mem);
+
+    g_mutex_lock (&shard->lock);
+    g_hash_table_add (shard->mem_live, mem);
+    g_mutex_unlock (&shard->lock);
+  }
+}
+
+void
+_priv_gst_alloc_trace_free (GstAllocTrace * trace, gpointer mem)
+{
+  GstAllocTraceImpl *impl = (GstAllocTraceImpl *) trace;
+
+  /* counts go negative on the shard of the freeing thread, only the sum
+   * means something */
+  if (trace->flags & GST_ALLOC_TRACE_LIVE)
+    g_atomic_int_add (&gst_alloc_trace_live_shard (impl)->live, -1);
+
+  if (trace->flags & GST_ALLOC_TRACE_MEM_LIVE) {
+    MemShard *shard = gst_alloc_trace_mem_shard (impl, mem);
+
+    g_mutex_lock (&shard->lock);
+    g_hash_table_remove (shard->mem_live, mem);
+    g_mutex_unlock (&shard->lock);
+  }
+}
+
+/* sums up the shards into the public fields of @trace */
+static void
+gst_alloc_trace_collect (GstAllocTrace * trace)
+{
+  GstAllocTraceImpl *impl = (GstAllocTraceImpl *) trace;
+  guint i;
+
+  trace->live = 0;
+  for (i = 0; i < N_SHARDS; i++)
+    trace->live += g_atomic_int_get (&impl->live[i].live);
+
+  g_slist_free (trace->mem_live);
+  trace->mem_live = NULL;
+  if (trace->flags & GST_ALLOC_TRACE_MEM_LIVE) {
+    for (i = 0; i < N_SHARDS; i++) {
+      GHashTableIter iter;
+      gpointer mem;
+
+      g_mutex_lock (&impl->mem[i].lock);
+      g_hash_table_iter_init (&iter, impl->mem[i].mem_live);
+      while (g_hash_table_iter_next (&iter, &mem, NULL))
+        trace->mem_live = g_slist_prepend (trace->mem_live, mem);
+      g_mutex_unlock (&impl->mem[i].lock);
+    }
+  }
+}
+
 static gint
 compare_func (GstAllocTrace * a, GstAllocTrace * b)
 {
@@ -205,11 +332,14 @@ _priv_gst_alloc_trace_dump (void)
 {
   GList *orig, *walk;
 
+  g_mutex_lock (&_gst_trace_mutex);
   orig = walk = gst_alloc_trace_list_sorted ();
+  g_mutex_unlock (&_gst_trace_mutex);
 
   while (walk) {
     GstAllocTrace *trace = (GstAllocTrace *) walk->data;
 
+    gst_alloc_trace_collect (trace);
     gst_alloc_trace_print (trace);
 
     walk = g_list_next (walk);
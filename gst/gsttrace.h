@@ -53,7 +53,9 @@ typedef struct _GstAllocTrace   GstAllocTrace;
  * @live: counter for live memory
  * @mem_live: list with pointers to unfreed memory
  *
- * The main tracing object
+ * The main tracing object. @live and @mem_live are only updated when the
+ * tracers are dumped, the counting happens in private per-thread and
+ * per-pointer shards.
  */
 struct _GstAllocTrace {
   gchar         *name;
@@ -71,6 +73,8 @@ GST_EXPORT GMutex       _gst_trace_mutex;
 void                    _priv_gst_alloc_trace_initialize (void);
 void                    _priv_gst_alloc_trace_deinit     (void);
 GstAllocTrace*          _priv_gst_alloc_trace_register   (const gchar *name, goffset offset);
+void                    _priv_gst_alloc_trace_new        (GstAllocTrace *trace, gpointer mem);
+void                    _priv_gst_alloc_trace_free       (GstAllocTrace *trace, gpointer mem);
 
 void                    _priv_gst_alloc_trace_dump       (void);
 
@@ -94,15 +98,8 @@ void                    _priv_gst_alloc_trace_dump       (void);
  */
 #define _gst_alloc_trace_new(trace, mem)           \
 G_STMT_START {                                          \
-  if (G_UNLIKELY ((trace)->flags)) {                    \
-    g_mutex_lock (&_gst_trace_mutex);            \
-    if ((trace)->flags & GST_ALLOC_TRACE_LIVE)          \
-      (trace)->live++;                                  \
-    if ((trace)->flags & GST_ALLOC_TRACE_MEM_LIVE)      \
-      (trace)->mem_live =                               \
-        g_slist_prepend ((trace)->mem_live, mem);       \
-    g_mutex_unlock (&_gst_trace_mutex);          \
-  }                                                     \
+  if (G_UNLIKELY ((trace)->flags))                      \
+    _priv_gst_alloc_trace_new (trace, mem);             \
 } G_STMT_END
 
 /**
@@ -114,15 +111,8 @@ G_STMT_START {                                          \
  */
 #define _gst_alloc_trace_free(trace, mem)                \
 G_STMT_START {                                          \
-  if (G_UNLIKELY ((trace)->flags)) {                    \
-    g_mutex_lock (&_gst_trace_mutex);            \
-    if ((trace)->flags & GST_ALLOC_TRACE_LIVE)          \
-      (trace)->live--;                                  \
-    if ((trace)->flags & GST_ALLOC_TRACE_MEM_LIVE)      \
-      (trace)->mem_live =                               \
-        g_slist_remove ((trace)->mem_live, mem);        \
-    g_mutex_unlock (&_gst_trace_mutex);          \
-  }                                                     \
+  if (G_UNLIKELY ((trace)->flags))                      \
+    _priv_gst_alloc_trace_free (trace, mem);            \
 } G_STMT_END
 
 #else
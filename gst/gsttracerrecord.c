@@ -37,7 +37,12 @@
 #include "gststructure.h"
 #include "gsttracerrecord.h"
 #include "gstvalue.h"
+#include "gstutils.h"
 #include <gobject/gvaluecollector.h>
+#include <glib/gstdio.h>
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
 
 GST_DEBUG_CATEGORY_EXTERN (tracer_debug);
 #define GST_CAT_DEFAULT tracer_debug
@@ -48,8 +53,20 @@ struct _GstTracerRecord
 
   GstStructure *spec;
   gchar *format;
+
+  /* for the binary output, one entry per logged value */
+  GArray *fields;               /* GstTracerRecordField */
+  gint id;                      /* 0 until declared in the binary output */
 };
 
+typedef struct
+{
+  GQuark name;
+  GType type;
+  /* how the value is stored in the binary output */
+  gchar code;
+} GstTracerRecordField;
+
 struct _GstTracerRecordClass
 {
   GstObjectClass parent_class;
@@ -96,6 +113,77 @@ build_field_template (GQuark field_id, const GValue * value, gpointer user_data)
   return res;
 }
 
+static void
+add_field (GstTracerRecord * self, GQuark name, GType type)
+{
+  GstTracerRecordField field;
+
+  field.name = name;
+  field.type = type;
+
+  switch (G_TYPE_FUNDAMENTAL (type)) {
+    case G_TYPE_BOOLEAN:
+    case G_TYPE_CHAR:
+    case G_TYPE_INT:
+    case G_TYPE_ENUM:
+      field.code = 'i';
+      break;
+    case G_TYPE_UCHAR:
+    case G_TYPE_UINT:
+    case G_TYPE_FLAGS:
+      field.code = 'u';
+      break;
+    case G_TYPE_LONG:
+      field.code = 'l';
+      break;
+    case G_TYPE_ULONG:
+      field.code = 'L';
+      break;
+    case G_TYPE_INT64:
+      field.code = 'I';
+      break;
+    case G_TYPE_UINT64:
+      field.code = 'U';
+      break;
+    case G_TYPE_FLOAT:
+    case G_TYPE_DOUBLE:
+      field.code = 'd';
+      break;
+    case G_TYPE_STRING:
+      field.code = 's';
+      break;
+    default:
+      /* boxed and object values are stored serialized */
+      field.code = 'v';
+      break;
+  }
+  g_array_append_val (self->fields, field);
+}
+
+static gboolean
+build_field_types (GQuark field_id, const GValue * value, gpointer user_data)
+{
+  GstTracerRecord *self = (GstTracerRecord *) user_data;
+  GType type = G_TYPE_INVALID;
+  GstTracerValueFlags flags = GST_TRACER_VALUE_FLAGS_NONE;
+
+  if (G_VALUE_TYPE (value) != GST_TYPE_STRUCTURE)
+    return FALSE;
+
+  gst_structure_get (gst_value_get_structure (value), "type", G_TYPE_GTYPE,
+      &type, "flags", GST_TYPE_TRACER_VALUE_FLAGS, &flags, NULL);
+
+  if (flags & GST_TRACER_VALUE_FLAGS_OPTIONAL) {
+    gchar *opt_name = g_strconcat ("have-", g_quark_to_string (field_id), NULL);
+
+    add_field (self, g_quark_from_string (opt_name), G_TYPE_BOOLEAN);
+    g_free (opt_name);
+  }
+  add_field (self, field_id, type);
+
+  return TRUE;
+}
+
 static void
 gst_tracer_record_build_format (GstTracerRecord * self)
 {
@@ -123,6 +211,9 @@ gst_tracer_record_build_format (GstTracerRecord * self)
   self->format = g_string_free (s, FALSE);
   GST_DEBUG ("new format string: %s", self->format);
   g_free (name);
+
+  self->fields = g_array_new (FALSE, FALSE, sizeof (GstTracerRecordField));
+  gst_structure_foreach (structure, build_field_types, self);
 }
 
 static void
@@ -136,6 +227,10 @@ gst_tracer_record_dispose (GObject * object)
   }
   g_free (self->format);
   self->format = NULL;
+  if (self->fields) {
+    g_array_free (self->fields, TRUE);
+    self->fields = NULL;
+  }
 }
 
 static void
@@ -227,6 +322,372 @@ gst_tracer_record_new (const gchar * name, const gchar * firstfield, ...)
 }
 
 #ifndef GST_DISABLE_GST_DEBUG
+
+/* binary output
+ *
+ * When GST_TRACER_BINARY_FILE is set, records are not formatted as text but
+ * copied into a ring buffer of the logging thread in a fixed layout given
+ * by the field types of the record. A background thread drains the rings
+ * to the file. A ring only has one writer and one reader, so no locks are
+ * needed. When a ring is full the entry is dropped.
+ *
+ * The file starts with TRACE_FILE_MAGIC, a guint32 version and a guint32
+ * byte order mark, all entries are in host byte order. Each entry has a
+ * header with the guint32 size of the whole entry, the guint32 id of the
+ * record and a guint64 timestamp, followed by the values. Strings are a
+ * guint32 length and the bytes without terminator. Entries with id 0
+ * declare a record: its id, its name, the number of fields and for each
+ * field its name, its binary code and its type name.
+ */
+#define TRACE_FILE_MAGIC "GSTTRACE"
+#define TRACE_FILE_VERSION 1
+#define TRACE_RING_SIZE (64 * 1024)
+#define TRACE_DRAIN_INTERVAL (10 * G_TIME_SPAN_MILLISECOND)
+
+typedef struct
+{
+  guint8 data[TRACE_RING_SIZE];
+  /* bytes written by the thread and read by the drain thread, both wrap */
+  volatile gint head;
+  volatile gint tail;
+  /* the logging thread exited, the ring can go when it is drained */
+  volatile gint dead;
+} GstTracerRing;
+
+static FILE *trace_file = NULL;
+static GMutex trace_file_lock;
+static GMutex trace_rings_lock;
+static GCond trace_cond;
+static GList *trace_rings = NULL;
+static GThread *trace_thread = NULL;
+static gboolean trace_running = FALSE;
+static volatile gint trace_next_id = 1;
+static volatile gint trace_dropped = 0;
+
+static void
+trace_ring_thread_exit (GstTracerRing * ring)
+{
+  g_atomic_int_set (&ring->dead, TRUE);
+}
+
+static GPrivate trace_ring_key =
+G_PRIVATE_INIT ((GDestroyNotify) trace_ring_thread_exit);
+
+/* drain @ring into the file, call with the file lock */
+static gboolean
+trace_ring_drain (GstTracerRing * ring)
+{
+  guint head, tail, pos, len;
+
+  head = (guint) g_atomic_int_get (&ring->head);
+  tail = (guint) ring->tail;
+  len = head - tail;
+
+  if (len > 0) {
+    pos = tail % TRACE_RING_SIZE;
+    if (pos + len > TRACE_RING_SIZE) {
+      fwrite (ring->data + pos, 1, TRACE_RING_SIZE - pos, trace_file);
+      fwrite (ring->data, 1, len - (TRACE_RING_SIZE - pos), trace_file);
+    } else {
+      fwrite (ring->data + pos, 1, len, trace_file);
+    }
+    g_atomic_int_set (&ring->tail, (gint) head);
+  }
+  return len > 0;
+}
+
+/* drain all rings and free the ones of exited threads */
+static void
+trace_drain_all (void)
+{
+  GList *l, *next;
+
+  g_mutex_lock (&trace_rings_lock);
+  g_mutex_lock (&trace_file_lock);
+  for (l = trace_rings; l; l = next) {
+    GstTracerRing *ring = l->data;
+    gboolean dead = g_atomic_int_get (&ring->dead);
+
+    next = l->next;
+    trace_ring_drain (ring);
+    if (dead) {
+      trace_rings = g_list_delete_link (trace_rings, l);
+      g_free (ring);
+    }
+  }
+  fflush (trace_file);
+  g_mutex_unlock (&trace_file_lock);
+  g_mutex_unlock (&trace_rings_lock);
+}
+
+static gpointer
+trace_drain_func (gpointer data)
+{
+  gint64 end_time;
+
+  g_mutex_lock (&trace_rings_lock);
+  while (trace_running) {
+    end_time = g_get_monotonic_time () + TRACE_DRAIN_INTERVAL;
+    g_cond_wait_until (&trace_cond, &trace_rings_lock, end_time);
+    g_mutex_unlock (&trace_rings_lock);
+    trace_drain_all ();
+    g_mutex_lock (&trace_rings_lock);
+  }
+  g_mutex_unlock (&trace_rings_lock);
+
+  return NULL;
+}
+
+void
+_priv_gst_tracer_record_binary_init (void)
+{
+  const gchar *env = g_getenv ("GST_TRACER_BINARY_FILE");
+  guint32 header[2] = { TRACE_FILE_VERSION, 0x01020304 };
+
+  if (env == NULL || *env == '\0')
+    return;
+
+  if (!(trace_file = g_fopen (env, "wb"))) {
+    g_printerr ("Could not open '%s' for writing tracer records: %s\n", env,
+        g_strerror (errno));
+    return;
+  }
+  fwrite (TRACE_FILE_MAGIC, 1, 8, trace_file);
+  fwrite (header, sizeof (guint32), 2, trace_file);
+
+  trace_running = TRUE;
+  trace_thread = g_thread_new ("GstTracerDrain", trace_drain_func, NULL);
+}
+
+void
+_priv_gst_tracer_record_binary_deinit (void)
+{
+  if (trace_file == NULL)
+    return;
+
+  g_mutex_lock (&trace_rings_lock);
+  trace_running = FALSE;
+  g_cond_signal (&trace_cond);
+  g_mutex_unlock (&trace_rings_lock);
+  g_thread_join (trace_thread);
+  trace_thread = NULL;
+
+  trace_drain_all ();
+  if (g_atomic_int_get (&trace_dropped))
+    GST_WARNING ("dropped %d tracer records, ring buffers were full",
+        g_atomic_int_get (&trace_dropped));
+
+  /* the rings of threads that are still alive stay in the list, these
+   * threads still reference them */
+  fclose (trace_file);
+  trace_file = NULL;
+}
+
+static inline void
+trace_put (GByteArray * buf, gconstpointer data, guint len)
+{
+  g_byte_array_append (buf, data, len);
+}
+
+static void
+trace_put_string (GByteArray * buf, const gchar * str)
+{
+  guint32 len = str ? strlen (str) : 0;
+
+  trace_put (buf, &len, sizeof (len));
+  trace_put (buf, (const guint8 *) str, len);
+}
+
+static void
+trace_put_header (GByteArray * buf, guint32 id, guint64 ts)
+{
+  guint32 size = 0;
+
+  g_byte_array_set_size (buf, 0);
+  trace_put (buf, &size, sizeof (size));
+  trace_put (buf, &id, sizeof (id));
+  trace_put (buf, &ts, sizeof (ts));
+}
+
+static void
+trace_finish (GByteArray * buf)
+{
+  guint32 size = buf->len;
+
+  memcpy (buf->data, &size, sizeof (size));
+}
+
+/* write the declaration of @self straight to the file, before any entry of
+ * it can be drained */
+static void
+gst_tracer_record_declare (GstTracerRecord * self)
+{
+  GByteArray *buf;
+  gchar *name, *p;
+  guint32 id, n_fields;
+  guint i;
+
+  g_mutex_lock (&trace_file_lock);
+  if (self->id != 0)
+    goto done;
+
+  id = g_atomic_int_add (&trace_next_id, 1);
+  name = g_strdup (g_quark_to_string (self->spec->name));
+  if ((p = strrchr (name, '.')))
+    *p = '\0';
+
+  buf = g_byte_array_new ();
+  trace_put_header (buf, 0, 0);
+  trace_put (buf, &id, sizeof (id));
+  trace_put_string (buf, name);
+  n_fields = self->fields->len;
+  trace_put (buf, &n_fields, sizeof (n_fields));
+  for (i = 0; i < self->fields->len; i++) {
+    GstTracerRecordField *field =
+        &g_array_index (self->fields, GstTracerRecordField, i);
+
+    trace_put_string (buf, g_quark_to_string (field->name));
+    trace_put (buf, &field->code, 1);
+    trace_put_string (buf, g_type_name (field->type));
+  }
+  trace_finish (buf);
+  fwrite (buf->data, 1, buf->len, trace_file);
+  g_byte_array_unref (buf);
+  g_free (name);
+
+  g_atomic_int_set (&self->id, id);
+
+done:
+  g_mutex_unlock (&trace_file_lock);
+}
+
+static GstTracerRing *
+trace_get_ring (void)
+{
+  GstTracerRing *ring;
+
+  if (G_UNLIKELY (!(ring = g_private_get (&trace_ring_key)))) {
+    ring = g_new0 (GstTracerRing, 1);
+    g_private_set (&trace_ring_key, ring);
+
+    g_mutex_lock (&trace_rings_lock);
+    trace_rings = g_list_prepend (trace_rings, ring);
+    g_mutex_unlock (&trace_rings_lock);
+  }
+  return ring;
+}
+
+static void
+trace_ring_write (GstTracerRing * ring, const guint8 * data, guint len)
+{
+  guint head, tail, pos;
+
+  head = (guint) ring->head;
+  tail = (guint) g_atomic_int_get (&ring->tail);
+
+  if (G_UNLIKELY (len > TRACE_RING_SIZE - (head - tail))) {
+    g_atomic_int_inc (&trace_dropped);
+    return;
+  }
+
+  pos = head % TRACE_RING_SIZE;
+  if (pos + len > TRACE_RING_SIZE) {
+    memcpy (ring->data + pos, data, TRACE_RING_SIZE - pos);
+    memcpy (ring->data, data + TRACE_RING_SIZE - pos,
+        len - (TRACE_RING_SIZE - pos));
+  } else {
+    memcpy (ring->data + pos, data, len);
+  }
+  /* publish the entry */
+  g_atomic_int_set (&ring->head, (gint) (head + len));
+}
+
+static void
+gst_tracer_record_log_binary (GstTracerRecord * self, va_list var_args)
+{
+  /* reused by the thread, most entries fit without reallocating */
+  static GPrivate buf_key = G_PRIVATE_INIT ((GDestroyNotify) g_byte_array_unref);
+  GByteArray *buf;
+  gint id;
+  guint i;
+
+  if (G_UNLIKELY (!(id = g_atomic_int_get (&self->id)))) {
+    gst_tracer_record_declare (self);
+    id = self->id;
+  }
+
+  if (G_UNLIKELY (!(buf = g_private_get (&buf_key)))) {
+    buf = g_byte_array_sized_new (256);
+    g_private_set (&buf_key, buf);
+  }
+
+  trace_put_header (buf, id, gst_util_get_timestamp ());
+  for (i = 0; i < self->fields->len; i++) {
+    GstTracerRecordField *field =
+        &g_array_index (self->fields, GstTracerRecordField, i);
+
+    switch (field->code) {
+      case 'i':{
+        gint32 v = va_arg (var_args, gint);
+        trace_put (buf, &v, sizeof (v));
+        break;
+      }
+      case 'u':{
+        guint32 v = va_arg (var_args, guint);
+        trace_put (buf, &v, sizeof (v));
+        break;
+      }
+      case 'l':{
+        gint64 v = va_arg (var_args, glong);
+        trace_put (buf, &v, sizeof (v));
+        break;
+      }
+      case 'L':{
+        guint64 v = va_arg (var_args, gulong);
+        trace_put (buf, &v, sizeof (v));
+        break;
+      }
+      case 'I':{
+        gint64 v = va_arg (var_args, gint64);
+        trace_put (buf, &v, sizeof (v));
+        break;
+      }
+      case 'U':{
+        guint64 v = va_arg (var_args, guint64);
+        trace_put (buf, &v, sizeof (v));
+        break;
+      }
+      case 'd':{
+        gdouble v = va_arg (var_args, gdouble);
+        trace_put (buf, &v, sizeof (v));
+        break;
+      }
+      case 's':
+        trace_put_string (buf, va_arg (var_args, const gchar *));
+        break;
+      default:{
+        GValue v = G_VALUE_INIT;
+        gchar *err = NULL, *str;
+
+        G_VALUE_COLLECT_INIT (&v, field->type, var_args, 0, &err);
+        if (G_UNLIKELY (err)) {
+          g_critical ("%s", err);
+          g_free (err);
+          return;
+        }
+        str = gst_value_serialize (&v);
+        trace_put_string (buf, str);
+        g_free (str);
+        g_value_unset (&v);
+        break;
+      }
+    }
+  }
+  trace_finish (buf);
+
+  trace_ring_write (trace_get_ring (), buf->data, buf->len);
+}
+
 /**
  * gst_tracer_record_log:
  * @self: the tracer-record
@@ -235,7 +696,9 @@ gst_tracer_record_new (const gchar * name, const gchar * firstfield, ...)
  * Serialzes the trace event into the log.
  *
  * Right now this is using the gstreamer debug log with the level TRACE (7) and
- * the category "GST_TRACER".
+ * the category "GST_TRACER". When the environment variable
+ * GST_TRACER_BINARY_FILE is set, the entries are written to that file in a
+ * binary format instead, which is much cheaper. gst-stats can read both.
  * <note><para>
  *   Please note that this is still under discussion and subject to change.
  * </para></note>
@@ -258,10 +721,24 @@ gst_tracer_record_log (GstTracerRecord * self, ...)
    */
 
   va_start (var_args, self);
-  if (G_LIKELY (GST_LEVEL_TRACE <= _gst_debug_min)) {
+  if (trace_file) {
+    gst_tracer_record_log_binary (self, var_args);
+  } else if (G_LIKELY (GST_LEVEL_TRACE <= _gst_debug_min)) {
     gst_debug_log_valist (GST_CAT_DEFAULT, GST_LEVEL_TRACE, "", "", 0, NULL,
         self->format, var_args);
   }
   va_end (var_args);
 }
+#else
+
+void
+_priv_gst_tracer_record_binary_init (void)
+{
+}
+
+void
+_priv_gst_tracer_record_binary_deinit (void)
+{
+}
+
 #endif
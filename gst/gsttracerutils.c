@@ -55,7 +55,12 @@ static const gchar *_quark_strings[] = {
   "element-new", "element-add-pad", "element-remove-pad",
   "bin-add-pre", "bin-add-post", "bin-remove-pre", "bin-remove-post",
   "pad-link-pre", "pad-link-post", "pad-unlink-pre", "pad-unlink-post",
-  "element-change-state-pre", "element-change-state-post"
+  "element-change-state-pre", "element-change-state-post",
+  "mini-object-cache-stats", "mini-object-free",
+  "buffer-pool-acquire-pre", "buffer-pool-acquire-post",
+  "buffer-pool-release", "queue-enqueue", "queue-dequeue", "queue-underrun",
+  "queue-overrun", "queue-leak", "lock-wait",
+  "plugin-load-pre", "plugin-load-post", "lock-spin"
 };
 
 GQuark _priv_gst_tracer_quark_table[GST_TRACER_QUARK_MAX];
@@ -63,7 +68,10 @@ GQuark _priv_gst_tracer_quark_table[GST_TRACER_QUARK_MAX];
 /* tracing helpers */
 
 gboolean _priv_tracer_enabled = FALSE;
-GHashTable *_priv_tracers = NULL;
+GList *_priv_tracers[GST_TRACER_QUARK_MAX + 1] = { NULL, };
+guint64 _priv_tracer_hooks = 0;
+
+G_STATIC_ASSERT (GST_TRACER_QUARK_MAX <= 64);
 
 /* Initialize the tracing system */
 void
@@ -76,7 +84,6 @@ _priv_gst_tracing_init (void)
    * user did not activate it through the env variable
    * so that external tools can use it anyway */
   GST_DEBUG ("Initializing GstTracer");
-  _priv_tracers = g_hash_table_new (NULL, NULL);
 
   if (G_N_ELEMENTS (_quark_strings) != GST_TRACER_QUARK_MAX)
     g_warning ("the quark table is not consistent! %d != %d",
@@ -87,6 +94,8 @@ _priv_gst_tracing_init (void)
         g_quark_from_static_string (_quark_strings[i]);
   }
 
+  _priv_gst_tracer_record_binary_init ();
+
   if (env != NULL && *env != '\0') {
     GstRegistry *registry = gst_registry_get ();
     GstPluginFeature *feature;
@@ -135,41 +144,46 @@ _priv_gst_tracing_init (void)
 void
 _priv_gst_tracing_deinit (void)
 {
-  GList *h_list, *h_node, *t_node;
+  GList *t_node;
   GstTracerHook *hook;
+  gint i;
 
   _priv_tracer_enabled = FALSE;
-  if (!_priv_tracers)
-    return;
+  _priv_tracer_hooks = 0;
 
   /* shutdown tracers for final reports */
-  h_list = g_hash_table_get_values (_priv_tracers);
-  for (h_node = h_list; h_node; h_node = g_list_next (h_node)) {
-    for (t_node = h_node->data; t_node; t_node = g_list_next (t_node)) {
+  for (i = 0; i <= GST_TRACER_QUARK_MAX; i++) {
+    for (t_node = _priv_tracers[i]; t_node; t_node = g_list_next (t_node)) {
       hook = (GstTracerHook *) t_node->data;
       gst_object_unref (hook->tracer);
       g_slice_free (GstTracerHook, hook);
     }
-    g_list_free (h_node->data);
+    g_list_free (_priv_tracers[i]);
+    _priv_tracers[i] = NULL;
   }
-  g_list_free (h_list);
-  g_hash_table_destroy (_priv_tracers);
-  _priv_tracers = NULL;
+
+  /* after the final reports of the tracers */
+  _priv_gst_tracer_record_binary_deinit ();
 }
 
+/* @id is GST_TRACER_QUARK_MAX for all hooks */
 static void
-gst_tracing_register_hook_id (GstTracer * tracer, GQuark detail, GCallback func)
+gst_tracing_register_hook_id (GstTracer * tracer, GstTracerQuarkId id,
+    GCallback func)
 {
-  gpointer key = GINT_TO_POINTER (detail);
-  GList *list = g_hash_table_lookup (_priv_tracers, key);
   GstTracerHook *hook = g_slice_new0 (GstTracerHook);
   hook->tracer = gst_object_ref (tracer);
   hook->func = func;
 
-  list = g_list_prepend (list, hook);
-  g_hash_table_replace (_priv_tracers, key, list);
+  _priv_tracers[id] = g_list_prepend (_priv_tracers[id], hook);
   GST_DEBUG ("registering tracer for '%s', list.len=%d",
-      (detail ? g_quark_to_string (detail) : "*"), g_list_length (list));
+      (id < GST_TRACER_QUARK_MAX ? _quark_strings[id] : "*"),
+      g_list_length (_priv_tracers[id]));
+
+  if (id < GST_TRACER_QUARK_MAX)
+    _priv_tracer_hooks |= G_GUINT64_CONSTANT (1) << id;
+  else
+    _priv_tracer_hooks = G_MAXUINT64;
   _priv_tracer_enabled = TRUE;
 }
 
@@ -186,7 +200,22 @@ void
 gst_tracing_register_hook (GstTracer * tracer, const gchar * detail,
     GCallback func)
 {
-  gst_tracing_register_hook_id (tracer, g_quark_try_string (detail), func);
+  GQuark quark;
+  gint id;
+
+  if (detail == NULL) {
+    gst_tracing_register_hook_id (tracer, GST_TRACER_QUARK_MAX, func);
+    return;
+  }
+
+  quark = g_quark_try_string (detail);
+  for (id = 0; id < GST_TRACER_QUARK_MAX; id++) {
+    if (_priv_gst_tracer_quark_table[id] == quark) {
+      gst_tracing_register_hook_id (tracer, id, func);
+      return;
+    }
+  }
+  GST_WARNING_OBJECT (tracer, "no hook named '%s'", detail);
 }
 
 #endif /* GST_DISABLE_GST_TRACER_HOOKS */
@@ -27,6 +27,8 @@
 #include <glib-object.h>
 #include <gst/gstconfig.h>
 #include <gst/gstbin.h>
+#include <gst/gstbufferpool.h>
+#include <gst/gstplugin.h>
 
 G_BEGIN_DECLS
 
@@ -70,6 +72,20 @@ typedef enum /*< skip >*/
   GST_TRACER_QUARK_HOOK_PAD_UNLINK_POST,
   GST_TRACER_QUARK_HOOK_ELEMENT_CHANGE_STATE_PRE,
   GST_TRACER_QUARK_HOOK_ELEMENT_CHANGE_STATE_POST,
+  GST_TRACER_QUARK_HOOK_MINI_OBJECT_CACHE_STATS,
+  GST_TRACER_QUARK_HOOK_MINI_OBJECT_FREE,
+  GST_TRACER_QUARK_HOOK_BUFFER_POOL_ACQUIRE_PRE,
+  GST_TRACER_QUARK_HOOK_BUFFER_POOL_ACQUIRE_POST,
+  GST_TRACER_QUARK_HOOK_BUFFER_POOL_RELEASE,
+  GST_TRACER_QUARK_HOOK_QUEUE_ENQUEUE,
+  GST_TRACER_QUARK_HOOK_QUEUE_DEQUEUE,
+  GST_TRACER_QUARK_HOOK_QUEUE_UNDERRUN,
+  GST_TRACER_QUARK_HOOK_QUEUE_OVERRUN,
+  GST_TRACER_QUARK_HOOK_QUEUE_LEAK,
+  GST_TRACER_QUARK_HOOK_LOCK_WAIT,
+  GST_TRACER_QUARK_HOOK_PLUGIN_LOAD_PRE,
+  GST_TRACER_QUARK_HOOK_PLUGIN_LOAD_POST,
+  GST_TRACER_QUARK_HOOK_LOCK_SPIN,
   GST_TRACER_QUARK_MAX
 } GstTracerQuarkId;
 
@@ -84,11 +100,17 @@ typedef struct {
   GCallback func;
 } GstTracerHook;
 
-extern gboolean _priv_tracer_enabled;
-/* key are hook-id quarks, values are GstTracerHook */
-extern GHashTable *_priv_tracers;
+/* exported for the hooks in the core elements */
+GST_EXPORT gboolean _priv_tracer_enabled;
+/* indexed by GstTracerQuarkId, values are lists of GstTracerHook, the last
+ * entry has the hooks registered for all hook-ids */
+GST_EXPORT GList *_priv_tracers[GST_TRACER_QUARK_MAX + 1];
+/* bit n is set when there are hooks for the hook-id n */
+GST_EXPORT guint64 _priv_tracer_hooks;
 
 #define GST_TRACER_IS_ENABLED (_priv_tracer_enabled)
+#define GST_TRACER_HOOK_IS_ENABLED(id) \
+  (_priv_tracer_hooks & (G_GUINT64_CONSTANT (1) << (id)))
 
 #define GST_TRACER_TS \
   GST_CLOCK_DIFF (_priv_gst_start_time, gst_util_get_timestamp ())
@@ -96,18 +118,17 @@ extern GHashTable *_priv_tracers;
 /* tracing hooks */
 
 #define GST_TRACER_ARGS h->tracer, ts
-#define GST_TRACER_DISPATCH(key,type,args) G_STMT_START{ \
-  if (GST_TRACER_IS_ENABLED) {                                         \
+#define GST_TRACER_DISPATCH(id,type,args) G_STMT_START{ \
+  if (G_UNLIKELY (GST_TRACER_HOOK_IS_ENABLED (id))) {                  \
     GstClockTime ts = GST_TRACER_TS;                                   \
-    GList *__l, *__n;                                                  \
+    GList *__n;                                                        \
     GstTracerHook *h;                                                  \
-    __l = g_hash_table_lookup (_priv_tracers, GINT_TO_POINTER (key));  \
-    for (__n = __l; __n; __n = g_list_next (__n)) {                    \
+    for (__n = _priv_tracers[id]; __n; __n = g_list_next (__n)) {      \
       h = (GstTracerHook *) __n->data;                                 \
       ((type)(h->func)) args;                                          \
     }                                                                  \
-    __l = g_hash_table_lookup (_priv_tracers, NULL);                   \
-    for (__n = __l; __n; __n = g_list_next (__n)) {                    \
+    for (__n = _priv_tracers[GST_TRACER_QUARK_MAX]; __n;               \
+        __n = g_list_next (__n)) {                                     \
       h = (GstTracerHook *) __n->data;                                 \
       ((type)(h->func)) args;                                          \
     }                                                                  \
@@ -126,7 +147,7 @@ extern GHashTable *_priv_tracers;
 typedef void (*GstTracerHookPadPushPre) (GObject *self, GstClockTime ts,
     GstPad *pad, GstBuffer *buffer);
 #define GST_TRACER_PAD_PUSH_PRE(pad, buffer) G_STMT_START{ \
-  GST_TRACER_DISPATCH(GST_TRACER_QUARK(HOOK_PAD_PUSH_PRE), \
+  GST_TRACER_DISPATCH(GST_TRACER_QUARK_HOOK_PAD_PUSH_PRE, \
     GstTracerHookPadPushPre, (GST_TRACER_ARGS, pad, buffer)); \
 }G_STMT_END
 
@@ -142,7 +163,7 @@ typedef void (*GstTracerHookPadPushPre) (GObject *self, GstClockTime ts,
 typedef void (*GstTracerHookPadPushPost) (GObject * self, GstClockTime ts,
     GstPad *pad, GstFlowReturn res);
 #define GST_TRACER_PAD_PUSH_POST(pad, res) G_STMT_START{ \
-  GST_TRACER_DISPATCH(GST_TRACER_QUARK(HOOK_PAD_PUSH_POST), \
+  GST_TRACER_DISPATCH(GST_TRACER_QUARK_HOOK_PAD_PUSH_POST, \
     GstTracerHookPadPushPost, (GST_TRACER_ARGS, pad, res)); \
 }G_STMT_END
 
@@ -158,7 +179,7 @@ typedef void (*GstTracerHookPadPushPost) (GObject * self, GstClockTime ts,
 typedef void (*GstTracerHookPadPushListPre) (GObject *self, GstClockTime ts,
     GstPad *pad, GstBufferList *list);
 #define GST_TRACER_PAD_PUSH_LIST_PRE(pad, list) G_STMT_START{ \
-  GST_TRACER_DISPATCH(GST_TRACER_QUARK(HOOK_PAD_PUSH_LIST_PRE), \
+  GST_TRACER_DISPATCH(GST_TRACER_QUARK_HOOK_PAD_PUSH_LIST_PRE, \
     GstTracerHookPadPushListPre, (GST_TRACER_ARGS, pad, list)); \
 }G_STMT_END
 
@@ -175,7 +196,7 @@ typedef void (*GstTracerHookPadPushListPost) (GObject *self, GstClockTime ts,
     GstPad *pad,
     GstFlowReturn res);
 #define GST_TRACER_PAD_PUSH_LIST_POST(pad, res) G_STMT_START{ \
-  GST_TRACER_DISPATCH(GST_TRACER_QUARK(HOOK_PAD_PUSH_LIST_POST), \
+  GST_TRACER_DISPATCH(GST_TRACER_QUARK_HOOK_PAD_PUSH_LIST_POST, \
     GstTracerHookPadPushListPost, (GST_TRACER_ARGS, pad, res)); \
 }G_STMT_END
 
@@ -192,7 +213,7 @@ typedef void (*GstTracerHookPadPushListPost) (GObject *self, GstClockTime ts,
 typedef void (*GstTracerHookPadPullRangePre) (GObject *self, GstClockTime ts,
     GstPad *pad, guint64 offset, guint size);
 #define GST_TRACER_PAD_PULL_RANGE_PRE(pad, offset, size) G_STMT_START{ \
-  GST_TRACER_DISPATCH(GST_TRACER_QUARK(HOOK_PAD_PULL_RANGE_PRE), \
+  GST_TRACER_DISPATCH(GST_TRACER_QUARK_HOOK_PAD_PULL_RANGE_PRE, \
     GstTracerHookPadPullRangePre, (GST_TRACER_ARGS, pad, offset, size)); \
 }G_STMT_END
 
@@ -209,7 +230,7 @@ typedef void (*GstTracerHookPadPullRangePre) (GObject *self, GstClockTime ts,
 typedef void (*GstTracerHookPadPullRangePost) (GObject *self, GstClockTime ts,
     GstPad *pad, GstBuffer *buffer, GstFlowReturn res);
 #define GST_TRACER_PAD_PULL_RANGE_POST(pad, buffer, res) G_STMT_START{ \
-  GST_TRACER_DISPATCH(GST_TRACER_QUARK(HOOK_PAD_PULL_RANGE_POST), \
+  GST_TRACER_DISPATCH(GST_TRACER_QUARK_HOOK_PAD_PULL_RANGE_POST, \
     GstTracerHookPadPullRangePost, (GST_TRACER_ARGS, pad, buffer, res)); \
 }G_STMT_END
 
@@ -225,7 +246,7 @@ typedef void (*GstTracerHookPadPullRangePost) (GObject *self, GstClockTime ts,
 typedef void (*GstTracerHookPadPushEventPre) (GObject *self, GstClockTime ts,
     GstPad *pad, GstEvent *event);
 #define GST_TRACER_PAD_PUSH_EVENT_PRE(pad, event) G_STMT_START{ \
-  GST_TRACER_DISPATCH(GST_TRACER_QUARK(HOOK_PAD_PUSH_EVENT_PRE), \
+  GST_TRACER_DISPATCH(GST_TRACER_QUARK_HOOK_PAD_PUSH_EVENT_PRE, \
     GstTracerHookPadPushEventPre, (GST_TRACER_ARGS, pad, event)); \
 }G_STMT_END
 
@@ -241,7 +262,7 @@ typedef void (*GstTracerHookPadPushEventPre) (GObject *self, GstClockTime ts,
 typedef void (*GstTracerHookPadPushEventPost) (GObject *self, GstClockTime ts,
     GstPad *pad, gboolean res);
 #define GST_TRACER_PAD_PUSH_EVENT_POST(pad, res) G_STMT_START{ \
-  GST_TRACER_DISPATCH(GST_TRACER_QUARK(HOOK_PAD_PUSH_EVENT_POST), \
+  GST_TRACER_DISPATCH(GST_TRACER_QUARK_HOOK_PAD_PUSH_EVENT_POST, \
     GstTracerHookPadPushEventPost, (GST_TRACER_ARGS, pad, res)); \
 }G_STMT_END
 
@@ -257,7 +278,7 @@ typedef void (*GstTracerHookPadPushEventPost) (GObject *self, GstClockTime ts,
 typedef void (*GstTracerHookPadQueryPre) (GObject *self, GstClockTime ts,
     GstPad *pad, GstQuery *query);
 #define GST_TRACER_PAD_QUERY_PRE(pad, query) G_STMT_START{ \
-  GST_TRACER_DISPATCH(GST_TRACER_QUARK(HOOK_PAD_QUERY_PRE), \
+  GST_TRACER_DISPATCH(GST_TRACER_QUARK_HOOK_PAD_QUERY_PRE, \
     GstTracerHookPadQueryPre, (GST_TRACER_ARGS, pad, query)); \
 }G_STMT_END
 
@@ -274,7 +295,7 @@ typedef void (*GstTracerHookPadQueryPre) (GObject *self, GstClockTime ts,
 typedef void (*GstTracerHookPadQueryPost) (GObject *self, GstClockTime ts,
     GstPad *pad, GstQuery *query, gboolean res);
 #define GST_TRACER_PAD_QUERY_POST(pad, query, res) G_STMT_START{ \
-  GST_TRACER_DISPATCH(GST_TRACER_QUARK(HOOK_PAD_QUERY_POST), \
+  GST_TRACER_DISPATCH(GST_TRACER_QUARK_HOOK_PAD_QUERY_POST, \
     GstTracerHookPadQueryPost, (GST_TRACER_ARGS, pad, query, res)); \
 }G_STMT_END
 
@@ -290,7 +311,7 @@ typedef void (*GstTracerHookPadQueryPost) (GObject *self, GstClockTime ts,
 typedef void (*GstTracerHookElementPostMessagePre) (GObject *self,
     GstClockTime ts, GstElement *element, GstMessage *message);
 #define GST_TRACER_ELEMENT_POST_MESSAGE_PRE(element, message) G_STMT_START{ \
-  GST_TRACER_DISPATCH(GST_TRACER_QUARK(HOOK_ELEMENT_POST_MESSAGE_PRE), \
+  GST_TRACER_DISPATCH(GST_TRACER_QUARK_HOOK_ELEMENT_POST_MESSAGE_PRE, \
     GstTracerHookElementPostMessagePre, (GST_TRACER_ARGS, element, message)); \
 }G_STMT_END
 
@@ -306,7 +327,7 @@ typedef void (*GstTracerHookElementPostMessagePre) (GObject *self,
 typedef void (*GstTracerHookElementPostMessagePost) (GObject *self,
     GstClockTime ts, GstElement *element, gboolean res);
 #define GST_TRACER_ELEMENT_POST_MESSAGE_POST(element, res) G_STMT_START{ \
-  GST_TRACER_DISPATCH(GST_TRACER_QUARK(HOOK_ELEMENT_POST_MESSAGE_POST), \
+  GST_TRACER_DISPATCH(GST_TRACER_QUARK_HOOK_ELEMENT_POST_MESSAGE_POST, \
     GstTracerHookElementPostMessagePost, (GST_TRACER_ARGS, element, res)); \
 }G_STMT_END
 
@@ -322,7 +343,7 @@ typedef void (*GstTracerHookElementPostMessagePost) (GObject *self,
 typedef void (*GstTracerHookElementQueryPre) (GObject *self, GstClockTime ts,
     GstElement *element, GstQuery *query);
 #define GST_TRACER_ELEMENT_QUERY_PRE(element, query) G_STMT_START{ \
-  GST_TRACER_DISPATCH(GST_TRACER_QUARK(HOOK_ELEMENT_QUERY_PRE), \
+  GST_TRACER_DISPATCH(GST_TRACER_QUARK_HOOK_ELEMENT_QUERY_PRE, \
     GstTracerHookElementQueryPre, (GST_TRACER_ARGS, element, query)); \
 }G_STMT_END
 
@@ -339,7 +360,7 @@ typedef void (*GstTracerHookElementQueryPre) (GObject *self, GstClockTime ts,
 typedef void (*GstTracerHookElementQueryPost) (GObject *self, GstClockTime ts,
     GstElement *element, GstQuery *query, gboolean res);
 #define GST_TRACER_ELEMENT_QUERY_POST(element, query, res) G_STMT_START{ \
-  GST_TRACER_DISPATCH(GST_TRACER_QUARK(HOOK_ELEMENT_QUERY_POST), \
+  GST_TRACER_DISPATCH(GST_TRACER_QUARK_HOOK_ELEMENT_QUERY_POST, \
     GstTracerHookElementQueryPost, (GST_TRACER_ARGS, element, query, res)); \
 }G_STMT_END
 
@@ -354,7 +375,7 @@ typedef void (*GstTracerHookElementQueryPost) (GObject *self, GstClockTime ts,
 typedef void (*GstTracerHookElementNew) (GObject *self, GstClockTime ts,
     GstElement *element);
 #define GST_TRACER_ELEMENT_NEW(element) G_STMT_START{ \
-  GST_TRACER_DISPATCH(GST_TRACER_QUARK(HOOK_ELEMENT_NEW), \
+  GST_TRACER_DISPATCH(GST_TRACER_QUARK_HOOK_ELEMENT_NEW, \
     GstTracerHookElementNew, (GST_TRACER_ARGS, element)); \
 }G_STMT_END
 
@@ -370,7 +391,7 @@ typedef void (*GstTracerHookElementNew) (GObject *self, GstClockTime ts,
 typedef void (*GstTracerHookElementAddPad) (GObject *self, GstClockTime ts,
     GstElement *element, GstPad *pad);
 #define GST_TRACER_ELEMENT_ADD_PAD(element, pad) G_STMT_START{ \
-  GST_TRACER_DISPATCH(GST_TRACER_QUARK(HOOK_ELEMENT_ADD_PAD), \
+  GST_TRACER_DISPATCH(GST_TRACER_QUARK_HOOK_ELEMENT_ADD_PAD, \
     GstTracerHookElementAddPad, (GST_TRACER_ARGS, element, pad)); \
 }G_STMT_END
 
@@ -386,7 +407,7 @@ typedef void (*GstTracerHookElementAddPad) (GObject *self, GstClockTime ts,
 typedef void (*GstTracerHookElementRemovePad) (GObject *self, GstClockTime ts,
     GstElement *element, GstPad *pad);
 #define GST_TRACER_ELEMENT_REMOVE_PAD(element, pad) G_STMT_START{ \
-  GST_TRACER_DISPATCH(GST_TRACER_QUARK(HOOK_ELEMENT_REMOVE_PAD), \
+  GST_TRACER_DISPATCH(GST_TRACER_QUARK_HOOK_ELEMENT_REMOVE_PAD, \
     GstTracerHookElementRemovePad, (GST_TRACER_ARGS, element, pad)); \
 }G_STMT_END
 
@@ -402,7 +423,7 @@ typedef void (*GstTracerHookElementRemovePad) (GObject *self, GstClockTime ts,
 typedef void (*GstTracerHookElementChangeStatePre) (GObject *self,
     GstClockTime ts, GstElement *element, GstStateChange transition);
 #define GST_TRACER_ELEMENT_CHANGE_STATE_PRE(element, transition) G_STMT_START{ \
-  GST_TRACER_DISPATCH(GST_TRACER_QUARK(HOOK_ELEMENT_CHANGE_STATE_PRE), \
+  GST_TRACER_DISPATCH(GST_TRACER_QUARK_HOOK_ELEMENT_CHANGE_STATE_PRE, \
     GstTracerHookElementChangeStatePre, (GST_TRACER_ARGS, element, transition)); \
 }G_STMT_END
 
@@ -420,7 +441,7 @@ typedef void (*GstTracerHookElementChangeStatePost) (GObject *self,
     GstClockTime ts, GstElement *element, GstStateChange transition,
     GstStateChangeReturn result);
 #define GST_TRACER_ELEMENT_CHANGE_STATE_POST(element, transition, result) G_STMT_START{ \
-  GST_TRACER_DISPATCH(GST_TRACER_QUARK(HOOK_ELEMENT_CHANGE_STATE_POST), \
+  GST_TRACER_DISPATCH(GST_TRACER_QUARK_HOOK_ELEMENT_CHANGE_STATE_POST, \
     GstTracerHookElementChangeStatePost, (GST_TRACER_ARGS, element, transition, result)); \
 }G_STMT_END
 
@@ -436,7 +457,7 @@ typedef void (*GstTracerHookElementChangeStatePost) (GObject *self,
 typedef void (*GstTracerHookBinAddPre) (GObject *self, GstClockTime ts,
     GstBin *bin, GstElement *element);
 #define GST_TRACER_BIN_ADD_PRE(bin, element) G_STMT_START{ \
-  GST_TRACER_DISPATCH(GST_TRACER_QUARK(HOOK_BIN_ADD_PRE), \
+  GST_TRACER_DISPATCH(GST_TRACER_QUARK_HOOK_BIN_ADD_PRE, \
     GstTracerHookBinAddPre, (GST_TRACER_ARGS, bin, element)); \
 }G_STMT_END
 
@@ -453,7 +474,7 @@ typedef void (*GstTracerHookBinAddPre) (GObject *self, GstClockTime ts,
 typedef void (*GstTracerHookBinAddPost) (GObject *self, GstClockTime ts,
     GstBin *bin, GstElement *element, gboolean result);
 #define GST_TRACER_BIN_ADD_POST(bin, element, result) G_STMT_START{ \
-  GST_TRACER_DISPATCH(GST_TRACER_QUARK(HOOK_BIN_ADD_POST), \
+  GST_TRACER_DISPATCH(GST_TRACER_QUARK_HOOK_BIN_ADD_POST, \
     GstTracerHookBinAddPost, (GST_TRACER_ARGS, bin, element, result)); \
 }G_STMT_END
 
@@ -469,7 +490,7 @@ typedef void (*GstTracerHookBinAddPost) (GObject *self, GstClockTime ts,
 typedef void (*GstTracerHookBinRemovePre) (GObject *self, GstClockTime ts,
     GstBin *bin, GstElement *element);
 #define GST_TRACER_BIN_REMOVE_PRE(bin, element) G_STMT_START{ \
-  GST_TRACER_DISPATCH(GST_TRACER_QUARK(HOOK_BIN_REMOVE_PRE), \
+  GST_TRACER_DISPATCH(GST_TRACER_QUARK_HOOK_BIN_REMOVE_PRE, \
     GstTracerHookBinRemovePre, (GST_TRACER_ARGS, bin, element)); \
 }G_STMT_END
 
@@ -485,7 +506,7 @@ typedef void (*GstTracerHookBinRemovePre) (GObject *self, GstClockTime ts,
 typedef void (*GstTracerHookBinRemovePost) (GObject *self, GstClockTime ts,
     GstBin *bin, gboolean result);
 #define GST_TRACER_BIN_REMOVE_POST(bin, result) G_STMT_START{ \
-  GST_TRACER_DISPATCH(GST_TRACER_QUARK(HOOK_BIN_REMOVE_POST), \
+  GST_TRACER_DISPATCH(GST_TRACER_QUARK_HOOK_BIN_REMOVE_POST, \
     GstTracerHookBinRemovePost, (GST_TRACER_ARGS, bin, result)); \
 }G_STMT_END
 
@@ -501,7 +522,7 @@ typedef void (*GstTracerHookBinRemovePost) (GObject *self, GstClockTime ts,
 typedef void (*GstTracerHookPadLinkPre) (GObject *self, GstClockTime ts,
     GstPad *srcpad, GstPad *sinkpad);
 #define GST_TRACER_PAD_LINK_PRE(srcpad, sinkpad) G_STMT_START{ \
-  GST_TRACER_DISPATCH(GST_TRACER_QUARK(HOOK_PAD_LINK_PRE), \
+  GST_TRACER_DISPATCH(GST_TRACER_QUARK_HOOK_PAD_LINK_PRE, \
     GstTracerHookPadLinkPre, (GST_TRACER_ARGS, srcpad, sinkpad)); \
 }G_STMT_END
 
@@ -518,7 +539,7 @@ typedef void (*GstTracerHookPadLinkPre) (GObject *self, GstClockTime ts,
 typedef void (*GstTracerHookPadLinkPost) (GObject *self, GstClockTime ts,
     GstPad *srcpad, GstPad *sinkpad, GstPadLinkReturn result);
 #define GST_TRACER_PAD_LINK_POST(srcpad, sinkpad, result) G_STMT_START{ \
-  GST_TRACER_DISPATCH(GST_TRACER_QUARK(HOOK_PAD_LINK_POST), \
+  GST_TRACER_DISPATCH(GST_TRACER_QUARK_HOOK_PAD_LINK_POST, \
     GstTracerHookPadLinkPost, (GST_TRACER_ARGS, srcpad, sinkpad, result)); \
 }G_STMT_END
 
@@ -534,7 +555,7 @@ typedef void (*GstTracerHookPadLinkPost) (GObject *self, GstClockTime ts,
 typedef void (*GstTracerHookPadUnlinkPre) (GObject *self, GstClockTime ts,
     GstPad *srcpad, GstPad *sinkpad);
 #define GST_TRACER_PAD_UNLINK_PRE(srcpad, sinkpad) G_STMT_START{ \
-  GST_TRACER_DISPATCH(GST_TRACER_QUARK(HOOK_PAD_UNLINK_PRE), \
+  GST_TRACER_DISPATCH(GST_TRACER_QUARK_HOOK_PAD_UNLINK_PRE, \
     GstTracerHookPadUnlinkPre, (GST_TRACER_ARGS, srcpad, sinkpad)); \
 }G_STMT_END
 
@@ -551,10 +572,303 @@ typedef void (*GstTracerHookPadUnlinkPre) (GObject *self, GstClockTime ts,
 typedef void (*GstTracerHookPadUnlinkPost) (GObject *self, GstClockTime ts,
     GstPad *srcpad, GstPad *sinkpad, gboolean result);
 #define GST_TRACER_PAD_UNLINK_POST(srcpad, sinkpad, result) G_STMT_START{ \
-  GST_TRACER_DISPATCH(GST_TRACER_QUARK(HOOK_PAD_UNLINK_POST), \
+  GST_TRACER_DISPATCH(GST_TRACER_QUARK_HOOK_PAD_UNLINK_POST, \
     GstTracerHookPadUnlinkPost, (GST_TRACER_ARGS, srcpad, sinkpad, result)); \
 }G_STMT_END
 
+/**
+ * GstTracerHookMiniObjectCacheStats:
+ * @self: the tracer instance
+ * @ts: the current timestamp
+ * @cache: the name of the cache: "buffer", "event", "message" or "query"
+ * @hits: the number of structs that were reused by the current thread
+ * @misses: the number of structs that the current thread had to allocate
+ *
+ * Hook named "mini-object-cache-stats" that reports the counters of the
+ * per-thread mini object caches of the current thread. It is called
+ * periodically while the thread allocates mini objects of that type.
+ *
+ * Since: 1.10
+ */
+typedef void (*GstTracerHookMiniObjectCacheStats) (GObject *self,
+    GstClockTime ts, const gchar *cache, guint64 hits, guint64 misses);
+#define GST_TRACER_MINI_OBJECT_CACHE_STATS(cache, hits, misses) G_STMT_START{ \
+  GST_TRACER_DISPATCH(GST_TRACER_QUARK_HOOK_MINI_OBJECT_CACHE_STATS, \
+    GstTracerHookMiniObjectCacheStats, (GST_TRACER_ARGS, cache, hits, misses)); \
+}G_STMT_END
+
+/**
+ * GstTracerHookMiniObjectFree:
+ * @self: the tracer instance
+ * @ts: the current timestamp
+ * @object: the mini object
+ *
+ * Hook named "mini-object-free" that is called when the last reference of
+ * @object was dropped and it is about to be freed. It is not called for
+ * objects that are recycled by their dispose function, like buffers that go
+ * back to their pool.
+ *
+ * Since: 1.10
+ */
+typedef void (*GstTracerHookMiniObjectFree) (GObject *self, GstClockTime ts,
+    GstMiniObject *object);
+#define GST_TRACER_MINI_OBJECT_FREE(object) G_STMT_START{ \
+  GST_TRACER_DISPATCH(GST_TRACER_QUARK_HOOK_MINI_OBJECT_FREE, \
+    GstTracerHookMiniObjectFree, (GST_TRACER_ARGS, object)); \
+}G_STMT_END
+
+/**
+ * GstTracerHookBufferPoolAcquirePre:
+ * @self: the tracer instance
+ * @ts: the current timestamp
+ * @pool: the buffer pool
+ *
+ * Pre-hook for gst_buffer_pool_acquire_buffer() named
+ * "buffer-pool-acquire-pre".
+ *
+ * Since: 1.10
+ */
+typedef void (*GstTracerHookBufferPoolAcquirePre) (GObject *self,
+    GstClockTime ts, GstBufferPool *pool);
+#define GST_TRACER_BUFFER_POOL_ACQUIRE_PRE(pool) G_STMT_START{ \
+  GST_TRACER_DISPATCH(GST_TRACER_QUARK_HOOK_BUFFER_POOL_ACQUIRE_PRE, \
+    GstTracerHookBufferPoolAcquirePre, (GST_TRACER_ARGS, pool)); \
+}G_STMT_END
+
+/**
+ * GstTracerHookBufferPoolAcquirePost:
+ * @self: the tracer instance
+ * @ts: the current timestamp
+ * @pool: the buffer pool
+ * @buffer: the acquired buffer or %NULL
+ * @res: the result of gst_buffer_pool_acquire_buffer()
+ *
+ * Post-hook for gst_buffer_pool_acquire_buffer() named
+ * "buffer-pool-acquire-post". @buffer is only set when @res is
+ * %GST_FLOW_OK.
+ *
+ * Since: 1.10
+ */
+typedef void (*GstTracerHookBufferPoolAcquirePost) (GObject *self,
+    GstClockTime ts, GstBufferPool *pool, GstBuffer *buffer,
+    GstFlowReturn res);
+#define GST_TRACER_BUFFER_POOL_ACQUIRE_POST(pool, buffer, res) G_STMT_START{ \
+  GST_TRACER_DISPATCH(GST_TRACER_QUARK_HOOK_BUFFER_POOL_ACQUIRE_POST, \
+    GstTracerHookBufferPoolAcquirePost, (GST_TRACER_ARGS, pool, buffer, res)); \
+}G_STMT_END
+
+/**
+ * GstTracerHookBufferPoolRelease:
+ * @self: the tracer instance
+ * @ts: the current timestamp
+ * @pool: the buffer pool
+ * @buffer: the buffer
+ *
+ * Hook for gst_buffer_pool_release_buffer() named "buffer-pool-release". It
+ * is called before @buffer is handed back to @pool.
+ *
+ * Since: 1.10
+ */
+typedef void (*GstTracerHookBufferPoolRelease) (GObject *self,
+    GstClockTime ts, GstBufferPool *pool, GstBuffer *buffer);
+#define GST_TRACER_BUFFER_POOL_RELEASE(pool, buffer) G_STMT_START{ \
+  GST_TRACER_DISPATCH(GST_TRACER_QUARK_HOOK_BUFFER_POOL_RELEASE, \
+    GstTracerHookBufferPoolRelease, (GST_TRACER_ARGS, pool, buffer)); \
+}G_STMT_END
+
+/**
+ * GstTracerHookQueueEnqueue:
+ * @self: the tracer instance
+ * @ts: the current timestamp
+ * @queue: the queue element
+ * @pad: the sink pad of the queue
+ * @buffers: the number of buffers in the queue
+ * @bytes: the number of bytes in the queue
+ * @time: the amount of data in the queue in ns
+ *
+ * Hook named "queue-enqueue" that is called by queue, queue2 and multiqueue
+ * after a buffer or buffer list was added to the queue of @pad. It can be
+ * called with the queue lock held, tracers must not call into @queue.
+ *
+ * Since: 1.10
+ */
+typedef void (*GstTracerHookQueueEnqueue) (GObject *self, GstClockTime ts,
+    GstElement *queue, GstPad *pad, guint buffers, guint bytes, guint64 time);
+#define GST_TRACER_QUEUE_ENQUEUE(queue, pad, buffers, bytes, time) G_STMT_START{ \
+  GST_TRACER_DISPATCH(GST_TRACER_QUARK_HOOK_QUEUE_ENQUEUE, \
+    GstTracerHookQueueEnqueue, (GST_TRACER_ARGS, queue, pad, buffers, bytes, \
+    time)); \
+}G_STMT_END
+
+/**
+ * GstTracerHookQueueDequeue:
+ * @self: the tracer instance
+ * @ts: the current timestamp
+ * @queue: the queue element
+ * @pad: the sink pad of the queue
+ * @buffers: the number of buffers in the queue
+ * @bytes: the number of bytes in the queue
+ * @time: the amount of data in the queue in ns
+ *
+ * Hook named "queue-dequeue" that is called by queue, queue2 and multiqueue
+ * after a buffer or buffer list was taken from the queue of @pad. It can be
+ * called with the queue lock held, tracers must not call into @queue.
+ *
+ * Since: 1.10
+ */
+typedef void (*GstTracerHookQueueDequeue) (GObject *self, GstClockTime ts,
+    GstElement *queue, GstPad *pad, guint buffers, guint bytes, guint64 time);
+#define GST_TRACER_QUEUE_DEQUEUE(queue, pad, buffers, bytes, time) G_STMT_START{ \
+  GST_TRACER_DISPATCH(GST_TRACER_QUARK_HOOK_QUEUE_DEQUEUE, \
+    GstTracerHookQueueDequeue, (GST_TRACER_ARGS, queue, pad, buffers, bytes, \
+    time)); \
+}G_STMT_END
+
+/**
+ * GstTracerHookQueueUnderrun:
+ * @self: the tracer instance
+ * @ts: the current timestamp
+ * @queue: the queue element
+ * @pad: the sink pad of the queue
+ *
+ * Hook named "queue-underrun" that is called when the queue of @pad ran
+ * empty and downstream has to wait for data. It can be called with the queue
+ * lock held, tracers must not call into @queue.
+ *
+ * Since: 1.10
+ */
+typedef void (*GstTracerHookQueueUnderrun) (GObject *self, GstClockTime ts,
+    GstElement *queue, GstPad *pad);
+#define GST_TRACER_QUEUE_UNDERRUN(queue, pad) G_STMT_START{ \
+  GST_TRACER_DISPATCH(GST_TRACER_QUARK_HOOK_QUEUE_UNDERRUN, \
+    GstTracerHookQueueUnderrun, (GST_TRACER_ARGS, queue, pad)); \
+}G_STMT_END
+
+/**
+ * GstTracerHookQueueOverrun:
+ * @self: the tracer instance
+ * @ts: the current timestamp
+ * @queue: the queue element
+ * @pad: the sink pad of the queue
+ *
+ * Hook named "queue-overrun" that is called when the queue of @pad is full
+ * and upstream has to wait or data is leaked. It can be called with the queue
+ * lock held, tracers must not call into @queue.
+ *
+ * Since: 1.10
+ */
+typedef void (*GstTracerHookQueueOverrun) (GObject *self, GstClockTime ts,
+    GstElement *queue, GstPad *pad);
+#define GST_TRACER_QUEUE_OVERRUN(queue, pad) G_STMT_START{ \
+  GST_TRACER_DISPATCH(GST_TRACER_QUARK_HOOK_QUEUE_OVERRUN, \
+    GstTracerHookQueueOverrun, (GST_TRACER_ARGS, queue, pad)); \
+}G_STMT_END
+
+/**
+ * GstTracerHookQueueLeak:
+ * @self: the tracer instance
+ * @ts: the current timestamp
+ * @queue: the queue element
+ * @pad: the sink pad of the queue
+ * @item: the dropped item
+ *
+ * Hook named "queue-leak" that is called when a leaky queue drops @item
+ * because it is full. It can be called with the queue lock held, tracers must
+ * not call into @queue.
+ *
+ * Since: 1.10
+ */
+typedef void (*GstTracerHookQueueLeak) (GObject *self, GstClockTime ts,
+    GstElement *queue, GstPad *pad, GstMiniObject *item);
+#define GST_TRACER_QUEUE_LEAK(queue, pad, item) G_STMT_START{ \
+  GST_TRACER_DISPATCH(GST_TRACER_QUARK_HOOK_QUEUE_LEAK, \
+    GstTracerHookQueueLeak, (GST_TRACER_ARGS, queue, pad, item)); \
+}G_STMT_END
+
+/**
+ * GstTracerHookLockWait:
+ * @self: the tracer instance
+ * @ts: the current timestamp
+ * @object: the object owning the lock
+ * @kind: what lock of @object this was, e.g. "object" or "stream"
+ * @wait: how long the thread had to wait for the lock
+ * @holder: the #GThread that held the lock before, or %NULL if unknown
+ *
+ * Hook named "lock-wait" that is called after a thread had to block to
+ * acquire a traced lock. It is only called when GStreamer was configured with
+ * --enable-lock-tracing. It is called with the lock held, tracers must not
+ * take locks of @object.
+ *
+ * Since: 1.10
+ */
+typedef void (*GstTracerHookLockWait) (GObject *self, GstClockTime ts,
+    gpointer object, const gchar *kind, GstClockTime wait, gpointer holder);
+#define GST_TRACER_LOCK_WAIT(object, kind, wait, holder) G_STMT_START{ \
+  GST_TRACER_DISPATCH(GST_TRACER_QUARK_HOOK_LOCK_WAIT, \
+    GstTracerHookLockWait, (GST_TRACER_ARGS, object, kind, wait, holder)); \
+}G_STMT_END
+
+/**
+ * GstTracerHookLockSpin:
+ * @self: the tracer instance
+ * @ts: the current timestamp
+ * @object: the object owning the lock
+ * @kind: what lock of @object this was, e.g. "object" or "stream"
+ * @spins: how often the thread tried to take the lock
+ * @acquired: whether the lock was taken by spinning
+ *
+ * Hook named "lock-spin" that is called after a thread spun on a contended
+ * lock. If @acquired is %FALSE, the thread blocks on the lock next. It is
+ * only called when GStreamer was configured with --enable-adaptive-locks or
+ * spinning was enabled with GST_LOCK_SPIN. It can be called with the lock
+ * held, tracers must not take locks of @object.
+ *
+ * Since: 1.10
+ */
+typedef void (*GstTracerHookLockSpin) (GObject *self, GstClockTime ts,
+    gpointer object, const gchar *kind, guint spins, gboolean acquired);
+#define GST_TRACER_LOCK_SPIN(object, kind, spins, acquired) G_STMT_START{ \
+  GST_TRACER_DISPATCH(GST_TRACER_QUARK_HOOK_LOCK_SPIN, \
+    GstTracerHookLockSpin, (GST_TRACER_ARGS, object, kind, spins, acquired)); \
+}G_STMT_END
+
+/**
+ * GstTracerHookPluginLoadPre:
+ * @self: the tracer instance
+ * @ts: the current timestamp
+ * @filename: the file the plugin is loaded from
+ *
+ * Pre-hook for loading a plugin file named "plugin-load-pre". It is only
+ * called when the file is actually opened, not for plugins that are already
+ * loaded.
+ *
+ * Since: 1.10
+ */
+typedef void (*GstTracerHookPluginLoadPre) (GObject *self, GstClockTime ts,
+    const gchar *filename);
+#define GST_TRACER_PLUGIN_LOAD_PRE(filename) G_STMT_START{ \
+  GST_TRACER_DISPATCH(GST_TRACER_QUARK_HOOK_PLUGIN_LOAD_PRE, \
+    GstTracerHookPluginLoadPre, (GST_TRACER_ARGS, filename)); \
+}G_STMT_END
+
+/**
+ * GstTracerHookPluginLoadPost:
+ * @self: the tracer instance
+ * @ts: the current timestamp
+ * @filename: the file the plugin was loaded from
+ * @plugin: the loaded plugin, or %NULL if loading failed
+ *
+ * Post-hook for loading a plugin file named "plugin-load-post".
+ *
+ * Since: 1.10
+ */
+typedef void (*GstTracerHookPluginLoadPost) (GObject *self, GstClockTime ts,
+    const gchar *filename, GstPlugin *plugin);
+#define GST_TRACER_PLUGIN_LOAD_POST(filename, plugin) G_STMT_START{ \
+  GST_TRACER_DISPATCH(GST_TRACER_QUARK_HOOK_PLUGIN_LOAD_POST, \
+    GstTracerHookPluginLoadPost, (GST_TRACER_ARGS, filename, plugin)); \
+}G_STMT_END
+
 #else /* !GST_DISABLE_GST_TRACER_HOOKS */
 
 #define GST_TRACER_PAD_PUSH_PRE(pad, buffer)
@@ -584,6 +898,20 @@ typedef void (*GstTracerHookPadUnlinkPost) (GObject *self, GstClockTime ts,
 #define GST_TRACER_PAD_LINK_POST(srcpad, sinkpad, res)
 #define GST_TRACER_PAD_UNLINK_PRE(srcpad, sinkpad)
 #define GST_TRACER_PAD_UNLINK_POST(srcpad, sinkpad, res)
+#define GST_TRACER_MINI_OBJECT_CACHE_STATS(cache, hits, misses)
+#define GST_TRACER_MINI_OBJECT_FREE(object)
+#define GST_TRACER_BUFFER_POOL_ACQUIRE_PRE(pool)
+#define GST_TRACER_BUFFER_POOL_ACQUIRE_POST(pool, buffer, res)
+#define GST_TRACER_BUFFER_POOL_RELEASE(pool, buffer)
+#define GST_TRACER_QUEUE_ENQUEUE(queue, pad, buffers, bytes, time)
+#define GST_TRACER_QUEUE_DEQUEUE(queue, pad, buffers, bytes, time)
+#define GST_TRACER_QUEUE_UNDERRUN(queue, pad)
+#define GST_TRACER_QUEUE_OVERRUN(queue, pad)
+#define GST_TRACER_QUEUE_LEAK(queue, pad, item)
+#define GST_TRACER_LOCK_WAIT(object, kind, wait, holder)
+#define GST_TRACER_PLUGIN_LOAD_PRE(filename)
+#define GST_TRACER_PLUGIN_LOAD_POST(filename, plugin)
+#define GST_TRACER_LOCK_SPIN(object, kind, spins, acquired)
 
 #endif /* GST_DISABLE_GST_TRACER_HOOKS */
 
@@ -63,10 +63,50 @@ gboolean
 gst_type_find_register (GstPlugin * plugin, const gchar * name, guint rank,
     GstTypeFindFunction func, const gchar * extensions,
     GstCaps * possible_caps, gpointer data, GDestroyNotify data_notify)
+{
+  return gst_type_find_register_magic (plugin, name, rank, func, extensions,
+      possible_caps, 0, NULL, 0, data, data_notify);
+}
+
+/**
+ * gst_type_find_register_magic:
+ * @plugin: (allow-none): A #GstPlugin, or %NULL for a static typefind function
+ * @name: The name for registering
+ * @rank: The rank (or importance) of this typefind function
+ * @func: The #GstTypeFindFunction to use
+ * @extensions: (allow-none): Optional comma-separated list of extensions
+ *     that could belong to this type
+ * @possible_caps: Optionally the caps that could be returned when typefinding
+ *                 succeeds
+ * @magic_offset: offset of @magic in the stream, negative offsets are
+ *     relative to the end of the stream
+ * @magic: (array length=magic_len) (allow-none): bytes the stream must
+ *     contain at @magic_offset for @func to find anything
+ * @magic_len: the length of @magic
+ * @data: Optional user data. This user data must be available until the plugin
+ *        is unloaded.
+ * @data_notify: a #GDestroyNotify that will be called on @data when the plugin
+ *        is unloaded.
+ *
+ * Like gst_type_find_register(), but also declares a magic byte pattern that
+ * all streams recognised by @func start with. The pattern is stored in the
+ * registry, streams that don't contain it are rejected without loading the
+ * plugin or calling @func.
+ *
+ * Returns: %TRUE on success, %FALSE otherwise
+ *
+ * Since: 1.10
+ */
+gboolean
+gst_type_find_register_magic (GstPlugin * plugin, const gchar * name,
+    guint rank, GstTypeFindFunction func, const gchar * extensions,
+    GstCaps * possible_caps, gint64 magic_offset, const guint8 * magic,
+    guint magic_len, gpointer data, GDestroyNotify data_notify)
 {
   GstTypeFindFactory *factory;
 
   g_return_val_if_fail (name != NULL, FALSE);
+  g_return_val_if_fail (magic != NULL || magic_len == 0, FALSE);
 
   GST_INFO ("registering typefind function for %s", name);
 
@@ -80,6 +120,11 @@ gst_type_find_register (GstPlugin * plugin, const gchar * name, guint rank,
     factory->extensions = g_strsplit (extensions, ",", -1);
 
   gst_caps_replace (&factory->caps, possible_caps);
+  if (magic_len > 0) {
+    factory->magic_offset = magic_offset;
+    factory->magic = g_memdup (magic, magic_len);
+    factory->magic_len = magic_len;
+  }
   factory->function = func;
   factory->user_data = data;
   factory->user_data_notify = data_notify;
@@ -119,6 +119,18 @@ gboolean  gst_type_find_register   (GstPlugin            * plugin,
                                     gpointer               data,
                                     GDestroyNotify         data_notify);
 
+gboolean  gst_type_find_register_magic (GstPlugin        * plugin,
+                                    const gchar          * name,
+                                    guint                  rank,
+                                    GstTypeFindFunction    func,
+                                    const gchar          * extensions,
+                                    GstCaps              * possible_caps,
+                                    gint64                 magic_offset,
+                                    const guint8         * magic,
+                                    guint                  magic_len,
+                                    gpointer               data,
+                                    GDestroyNotify         data_notify);
+
 G_END_DECLS
 
 #endif /* __GST_TYPE_FIND_H__ */
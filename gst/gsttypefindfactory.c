@@ -123,6 +123,9 @@ gst_type_find_factory_dispose (GObject * object)
     g_strfreev (factory->extensions);
     factory->extensions = NULL;
   }
+  g_free (factory->magic);
+  factory->magic = NULL;
+  factory->magic_len = 0;
   if (factory->user_data_notify && factory->user_data) {
     factory->user_data_notify (factory->user_data);
     factory->user_data = NULL;
@@ -165,6 +168,16 @@ gst_type_find_factory_get_caps (GstTypeFindFactory * factory)
 {
   g_return_val_if_fail (GST_IS_TYPE_FIND_FACTORY (factory), NULL);
 
+  /* caps from the registry cache are parsed on first use */
+  if (G_UNLIKELY (g_atomic_pointer_get (&factory->caps) == NULL
+          && factory->caps_string != NULL)) {
+    GstCaps *caps = gst_caps_from_string (factory->caps_string);
+
+    if (caps && !g_atomic_pointer_compare_and_exchange (&factory->caps, NULL,
+            caps))
+      gst_caps_unref (caps);
+  }
+
   return factory->caps;
 }
 
@@ -207,6 +220,18 @@ gst_type_find_factory_call_function (GstTypeFindFactory * factory,
   g_return_if_fail (find->peek != NULL);
   g_return_if_fail (find->suggest != NULL);
 
+  /* the function can't match without its magic, no need to load the
+   * plugin for it */
+  if (factory->magic_len > 0) {
+    const guint8 *data;
+
+    data = gst_type_find_peek (find, factory->magic_offset, factory->magic_len);
+    if (data == NULL || memcmp (data, factory->magic, factory->magic_len) != 0) {
+      GST_LOG_OBJECT (factory, "magic does not match");
+      return;
+    }
+  }
+
   new_factory =
       GST_TYPE_FIND_FACTORY (gst_plugin_feature_load (GST_PLUGIN_FEATURE
           (factory)));
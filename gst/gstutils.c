@@ -684,6 +684,272 @@ gst_util_uint64_scale_int_ceil (guint64 val, gint num, gint denom)
   return _gst_util_uint64_scale_int (val, num, denom, denom - 1);
 }
 
+/* high 64 bits of a 64x64 bits multiply */
+static inline guint64
+gst_util_uint64_mul_high (guint64 a, guint64 b)
+{
+#ifdef HAVE_UINT128_T
+  return (guint64) ((((__uint128_t) a) * ((__uint128_t) b)) >> 64);
+#else
+  GstUInt64 c1, c0;
+
+  gst_util_uint64_mul_uint64 (&c1, &c0, a, b);
+
+  return c1.ll;
+#endif
+}
+
+static guint64
+gst_util_uint64_gcd (guint64 a, guint64 b)
+{
+  while (b != 0) {
+    guint64 t = a % b;
+
+    a = b;
+    b = t;
+  }
+  return a;
+}
+
+/* compute 2^(64 + exp) / denom with a plain shift-subtract long division,
+ * denom must be bigger than 2^exp so that the quotient fits in 64 bits. This
+ * runs once per scaler so it does not need to be fast. */
+static guint64
+gst_util_scaler_div_pow2 (guint exp, guint64 denom, guint64 * rem)
+{
+  guint64 q = 0, r = 0, carry;
+  gint i;
+
+  for (i = 64 + exp; i >= 0; i--) {
+    carry = r >> 63;
+    r = (r << 1) | (i == 64 + exp);
+    q <<= 1;
+    if (carry || r >= denom) {
+      r -= denom;
+      q |= 1;
+    }
+  }
+  *rem = r;
+
+  return q;
+}
+
+/**
+ * gst_util_scaler_init:
+ * @scaler: a #GstUtilScaler
+ * @num: the numerator of the scale ratio
+ * @denom: the denominator of the scale ratio
+ *
+ * Prepare @scaler for repeatedly scaling values by the constant rational
+ * number @num / @denom. The ratio is reduced and a reciprocal of the
+ * denominator is computed so that the division of gst_util_uint64_scale()
+ * becomes a multiply and shift for all values that don't need more than 64
+ * bits for the intermediate result.
+ *
+ * Since: 1.10
+ */
+void
+gst_util_scaler_init (GstUtilScaler * scaler, guint64 num, guint64 denom)
+{
+  guint64 gcd, rem, m;
+  guint l;
+
+  g_return_if_fail (scaler != NULL);
+  g_return_if_fail (denom != 0);
+
+  memset (scaler, 0, sizeof (GstUtilScaler));
+
+  if (num == 0) {
+    scaler->num = 0;
+    scaler->denom = 1;
+    scaler->max_val = G_MAXUINT64;
+    return;
+  }
+
+  gcd = gst_util_uint64_gcd (num, denom);
+  scaler->num = num / gcd;
+  scaler->denom = denom / gcd;
+
+  /* largest value for which val * num + correct can't overflow, for all
+   * rounding modes */
+  scaler->max_val = (G_MAXUINT64 - (scaler->denom - 1)) / scaler->num;
+
+  l = 0;
+  while ((scaler->denom >> l) > 1)
+    l++;
+  scaler->shift = l;
+
+  if ((scaler->denom & (scaler->denom - 1)) == 0) {
+    /* power of two, a shift is enough */
+    scaler->magic = 0;
+    return;
+  }
+
+  /* Granlund-Montgomery style reciprocal, as in libdivide */
+  m = gst_util_scaler_div_pow2 (l, scaler->denom, &rem);
+  if (scaler->denom - rem < (G_GUINT64_CONSTANT (1) << l)) {
+    scaler->add = FALSE;
+  } else {
+    guint64 twice_rem = rem + rem;
+
+    m += m;
+    if (twice_rem >= scaler->denom || twice_rem < rem)
+      m += 1;
+    scaler->add = TRUE;
+  }
+  scaler->magic = m + 1;
+}
+
+static inline guint64
+_gst_util_scaler_scale (const GstUtilScaler * scaler, guint64 val,
+    guint64 correct)
+{
+  guint64 x, q;
+
+  /* needs more than 64 bits, do the full muldiv */
+  if (G_UNLIKELY (val > scaler->max_val))
+    return _gst_util_uint64_scale (val, scaler->num, scaler->denom, correct);
+
+  x = val * scaler->num + correct;
+
+  if (scaler->magic == 0)
+    return x >> scaler->shift;
+
+  q = gst_util_uint64_mul_high (scaler->magic, x);
+  if (scaler->add)
+    q += (x - q) >> 1;
+
+  return q >> scaler->shift;
+}
+
+/**
+ * gst_util_scaler_scale:
+ * @scaler: a #GstUtilScaler
+ * @val: the number to scale
+ *
+ * Scale @val by the ratio @scaler was initialized with. This gives the same
+ * result as gst_util_uint64_scale() but is a lot cheaper when called
+ * repeatedly with the same ratio.
+ *
+ * Returns: @val * num / denom, truncated. In the case of an overflow, this
+ * function returns G_MAXUINT64.
+ *
+ * Since: 1.10
+ */
+guint64
+gst_util_scaler_scale (const GstUtilScaler * scaler, guint64 val)
+{
+  return _gst_util_scaler_scale (scaler, val, 0);
+}
+
+/**
+ * gst_util_scaler_scale_round:
+ * @scaler: a #GstUtilScaler
+ * @val: the number to scale
+ *
+ * Like gst_util_scaler_scale() but gives the result of
+ * gst_util_uint64_scale_round().
+ *
+ * Returns: @val * num / denom, rounded to the nearest integer. In the case
+ * of an overflow, this function returns G_MAXUINT64.
+ *
+ * Since: 1.10
+ */
+guint64
+gst_util_scaler_scale_round (const GstUtilScaler * scaler, guint64 val)
+{
+  return _gst_util_scaler_scale (scaler, val, scaler->denom >> 1);
+}
+
+/**
+ * gst_util_scaler_scale_ceil:
+ * @scaler: a #GstUtilScaler
+ * @val: the number to scale
+ *
+ * Like gst_util_scaler_scale() but gives the result of
+ * gst_util_uint64_scale_ceil().
+ *
+ * Returns: @val * num / denom, rounded up. In the case of an overflow, this
+ * function returns G_MAXUINT64.
+ *
+ * Since: 1.10
+ */
+guint64
+gst_util_scaler_scale_ceil (const GstUtilScaler * scaler, guint64 val)
+{
+  return _gst_util_scaler_scale (scaler, val, scaler->denom - 1);
+}
+
+/**
+ * gst_util_scaler_scale_array:
+ * @scaler: a #GstUtilScaler
+ * @vals: (array length=n_vals) (inout): the values to scale
+ * @n_vals: the number of values in @vals
+ *
+ * Scale all @n_vals values in @vals in place with gst_util_scaler_scale().
+ *
+ * Since: 1.10
+ */
+void
+gst_util_scaler_scale_array (const GstUtilScaler * scaler, guint64 * vals,
+    guint n_vals)
+{
+  guint i;
+
+  g_return_if_fail (vals != NULL || n_vals == 0);
+
+  for (i = 0; i < n_vals; i++)
+    vals[i] = _gst_util_scaler_scale (scaler, vals[i], 0);
+}
+
+/**
+ * gst_util_scaler_scale_array_round:
+ * @scaler: a #GstUtilScaler
+ * @vals: (array length=n_vals) (inout): the values to scale
+ * @n_vals: the number of values in @vals
+ *
+ * Scale all @n_vals values in @vals in place with
+ * gst_util_scaler_scale_round().
+ *
+ * Since: 1.10
+ */
+void
+gst_util_scaler_scale_array_round (const GstUtilScaler * scaler,
+    guint64 * vals, guint n_vals)
+{
+  guint64 correct = scaler->denom >> 1;
+  guint i;
+
+  g_return_if_fail (vals != NULL || n_vals == 0);
+
+  for (i = 0; i < n_vals; i++)
+    vals[i] = _gst_util_scaler_scale (scaler, vals[i], correct);
+}
+
+/**
+ * gst_util_scaler_scale_array_ceil:
+ * @scaler: a #GstUtilScaler
+ * @vals: (array length=n_vals) (inout): the values to scale
+ * @n_vals: the number of values in @vals
+ *
+ * Scale all @n_vals values in @vals in place with
+ * gst_util_scaler_scale_ceil().
+ *
+ * Since: 1.10
+ */
+void
+gst_util_scaler_scale_array_ceil (const GstUtilScaler * scaler,
+    guint64 * vals, guint n_vals)
+{
+  guint64 correct = scaler->denom - 1;
+  guint i;
+
+  g_return_if_fail (vals != NULL || n_vals == 0);
+
+  for (i = 0; i < n_vals; i++)
+    vals[i] = _gst_util_scaler_scale (scaler, vals[i], correct);
+}
+
 /**
  * gst_util_seqnum_next:
  *
@@ -72,6 +72,37 @@ guint64         gst_util_uint64_scale_int       (guint64 val, gint num, gint den
 guint64         gst_util_uint64_scale_int_round (guint64 val, gint num, gint denom);
 guint64         gst_util_uint64_scale_int_ceil  (guint64 val, gint num, gint denom);
 
+/**
+ * GstUtilScaler:
+ * @num: the reduced numerator of the scale ratio
+ * @denom: the reduced denominator of the scale ratio
+ *
+ * Precomputed form of a constant scale ratio, for when many values have to
+ * be scaled by the same @num / @denom. Initialize with gst_util_scaler_init().
+ *
+ * Since: 1.10
+ */
+typedef struct {
+  guint64       num;
+  guint64       denom;
+
+  /*< private >*/
+  guint64       max_val;
+  guint64       magic;
+  guint         shift;
+  gboolean      add;
+
+  gpointer      _gst_reserved[GST_PADDING];
+} GstUtilScaler;
+
+void            gst_util_scaler_init              (GstUtilScaler * scaler, guint64 num, guint64 denom);
+guint64         gst_util_scaler_scale             (const GstUtilScaler * scaler, guint64 val);
+guint64         gst_util_scaler_scale_round       (const GstUtilScaler * scaler, guint64 val);
+guint64         gst_util_scaler_scale_ceil        (const GstUtilScaler * scaler, guint64 val);
+void            gst_util_scaler_scale_array       (const GstUtilScaler * scaler, guint64 * vals, guint n_vals);
+void            gst_util_scaler_scale_array_round (const GstUtilScaler * scaler, guint64 * vals, guint n_vals);
+void            gst_util_scaler_scale_array_ceil  (const GstUtilScaler * scaler, guint64 * vals, guint n_vals);
+
 guint32         gst_util_seqnum_next            (void);
 gint32          gst_util_seqnum_compare         (guint32 s1, guint32 s2);
 
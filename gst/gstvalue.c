@@ -92,28 +92,28 @@ static void gst_value_register_intersect_func (GType type1,
 static void gst_value_register_subtract_func (GType minuend_type,
     GType subtrahend_type, GstValueSubtractFunc func);
 
-typedef struct _GstValueUnionInfo GstValueUnionInfo;
-struct _GstValueUnionInfo
+/* function registered for a pair of types */
+typedef struct _GstValuePairEntry GstValuePairEntry;
+struct _GstValuePairEntry
 {
   GType type1;
   GType type2;
-  GstValueUnionFunc func;
+  gpointer func;
+  /* the function was registered for (type2, type1) and expects the values
+   * in that order */
+  gboolean swapped;
 };
 
-typedef struct _GstValueIntersectInfo GstValueIntersectInfo;
-struct _GstValueIntersectInfo
+/* open addressed hash table of GstValuePairEntry, indexed by the types */
+typedef struct _GstValuePairTable GstValuePairTable;
+struct _GstValuePairTable
 {
-  GType type1;
-  GType type2;
-  GstValueIntersectFunc func;
-};
-
-typedef struct _GstValueSubtractInfo GstValueSubtractInfo;
-struct _GstValueSubtractInfo
-{
-  GType minuend;
-  GType subtrahend;
-  GstValueSubtractFunc func;
+  GstValuePairEntry *entries;
+  /* size of entries - 1, the size is a power of 2 */
+  guint mask;
+  guint n_entries;
+  /* number of registered functions */
+  guint n_funcs;
 };
 
 struct _GstFlagSetClass
@@ -136,9 +136,9 @@ typedef struct _GstFlagSetClass GstFlagSetClass;
 static GArray *gst_value_table;
 static GHashTable *gst_value_hash;
 static GstValueTable *gst_value_tables_fundamental[FUNDAMENTAL_TYPE_ID_MAX + 1];
-static GArray *gst_value_union_funcs;
-static GArray *gst_value_intersect_funcs;
-static GArray *gst_value_subtract_funcs;
+static GstValuePairTable gst_value_union_funcs;
+static GstValuePairTable gst_value_intersect_funcs;
+static GstValuePairTable gst_value_subtract_funcs;
 
 /* Forward declarations */
 static gchar *gst_value_serialize_fraction (const GValue * value);
@@ -174,6 +174,110 @@ gst_value_hash_add_type (GType type, const GstValueTable * table)
   g_hash_table_insert (gst_value_hash, (gpointer) type, (gpointer) table);
 }
 
+static inline guint
+gst_value_pair_hash (GType type1, GType type2)
+{
+  guint hash;
+
+  /* GstValue types are fundamental, their GType is a small multiple of 4.
+   * Other types are pointers to aligned memory. */
+  hash = (guint) (type1 >> 2) * 0x9e3779b1;
+  hash = (hash ^ (guint) (type2 >> 2)) * 0x85ebca6b;
+
+  return hash ^ (hash >> 16);
+}
+
+static inline const GstValuePairEntry *
+gst_value_pair_table_lookup (const GstValuePairTable * table, GType type1,
+    GType type2)
+{
+  const GstValuePairEntry *entry;
+  guint i;
+
+  i = gst_value_pair_hash (type1, type2) & table->mask;
+  while ((entry = &table->entries[i])->type1 != G_TYPE_INVALID) {
+    if (entry->type1 == type1 && entry->type2 == type2)
+      return entry;
+    i = (i + 1) & table->mask;
+  }
+
+  return NULL;
+}
+
+static void
+gst_value_pair_table_init (GstValuePairTable * table, guint n_funcs)
+{
+  guint size = 8;
+
+  /* two entries per function, keep the load below 1/2 */
+  while (size < n_funcs * 4)
+    size <<= 1;
+
+  table->entries = g_new0 (GstValuePairEntry, size);
+  table->mask = size - 1;
+  table->n_entries = 0;
+  table->n_funcs = 0;
+}
+
+static void
+gst_value_pair_table_insert_entry (GstValuePairTable * table,
+    const GstValuePairEntry * entry)
+{
+  guint i;
+
+  i = gst_value_pair_hash (entry->type1, entry->type2) & table->mask;
+  while (table->entries[i].type1 != G_TYPE_INVALID)
+    i = (i + 1) & table->mask;
+
+  table->entries[i] = *entry;
+  table->n_entries++;
+}
+
+static void
+gst_value_pair_table_insert (GstValuePairTable * table, GType type1,
+    GType type2, gpointer func, gboolean swapped)
+{
+  GstValuePairEntry entry;
+
+  /* the first registered function wins, like it did when we searched the
+   * functions in registration order */
+  if (gst_value_pair_table_lookup (table, type1, type2))
+    return;
+
+  if ((table->n_entries + 1) * 2 > table->mask + 1) {
+    GstValuePairEntry *old = table->entries;
+    guint i, size = table->mask + 1;
+
+    table->entries = g_new0 (GstValuePairEntry, size * 2);
+    table->mask = size * 2 - 1;
+    table->n_entries = 0;
+    for (i = 0; i < size; i++) {
+      if (old[i].type1 != G_TYPE_INVALID)
+        gst_value_pair_table_insert_entry (table, &old[i]);
+    }
+    g_free (old);
+  }
+
+  entry.type1 = type1;
+  entry.type2 = type2;
+  entry.func = func;
+  entry.swapped = swapped;
+  gst_value_pair_table_insert_entry (table, &entry);
+}
+
+/* register @func for (@type1, @type2) and, when @symmetric, also for
+ * (@type2, @type1) */
+static void
+gst_value_pair_table_register (GstValuePairTable * table, GType type1,
+    GType type2, gpointer func, gboolean symmetric)
+{
+  table->n_funcs++;
+
+  gst_value_pair_table_insert (table, type1, type2, func, FALSE);
+  if (symmetric && type1 != type2)
+    gst_value_pair_table_insert (table, type2, type1, func, TRUE);
+}
+
 /********
  * list *
  ********/
@@ -2826,6 +2930,10 @@ gst_value_deserialize_float (GValue * dest, const gchar * s)
 static gint
 gst_value_compare_string (const GValue * value1, const GValue * value2)
 {
+  /* interned strings are equal when they are the same */
+  if (value1->data[0].v_pointer == value2->data[0].v_pointer)
+    return GST_VALUE_EQUAL;
+
   if (G_UNLIKELY (!value1->data[0].v_pointer || !value2->data[0].v_pointer)) {
     /* if only one is NULL, no match - otherwise both NULL == EQUAL */
     if (value1->data[0].v_pointer != value2->data[0].v_pointer)
@@ -4830,25 +4938,11 @@ gst_value_compare_with_func (const GValue * value1, const GValue * value2,
 gboolean
 gst_value_can_union (const GValue * value1, const GValue * value2)
 {
-  GstValueUnionInfo *union_info;
-  guint i, len;
-
   g_return_val_if_fail (G_IS_VALUE (value1), FALSE);
   g_return_val_if_fail (G_IS_VALUE (value2), FALSE);
 
-  len = gst_value_union_funcs->len;
-
-  for (i = 0; i < len; i++) {
-    union_info = &g_array_index (gst_value_union_funcs, GstValueUnionInfo, i);
-    if (union_info->type1 == G_VALUE_TYPE (value1) &&
-        union_info->type2 == G_VALUE_TYPE (value2))
-      return TRUE;
-    if (union_info->type1 == G_VALUE_TYPE (value2) &&
-        union_info->type2 == G_VALUE_TYPE (value1))
-      return TRUE;
-  }
-
-  return FALSE;
+  return gst_value_pair_table_lookup (&gst_value_union_funcs,
+      G_VALUE_TYPE (value1), G_VALUE_TYPE (value2)) != NULL;
 }
 
 /**
@@ -4864,9 +4958,7 @@ gst_value_can_union (const GValue * value1, const GValue * value2)
 gboolean
 gst_value_union (GValue * dest, const GValue * value1, const GValue * value2)
 {
-  const GstValueUnionInfo *union_info;
-  guint i, len;
-  GType type1, type2;
+  const GstValuePairEntry *entry;
 
   g_return_val_if_fail (dest != NULL, FALSE);
   g_return_val_if_fail (G_IS_VALUE (value1), FALSE);
@@ -4874,18 +4966,14 @@ gst_value_union (GValue * dest, const GValue * value1, const GValue * value2)
   g_return_val_if_fail (gst_value_list_or_array_are_compatible (value1, value2),
       FALSE);
 
-  len = gst_value_union_funcs->len;
-  type1 = G_VALUE_TYPE (value1);
-  type2 = G_VALUE_TYPE (value2);
+  entry = gst_value_pair_table_lookup (&gst_value_union_funcs,
+      G_VALUE_TYPE (value1), G_VALUE_TYPE (value2));
+  if (entry) {
+    GstValueUnionFunc func = (GstValueUnionFunc) entry->func;
 
-  for (i = 0; i < len; i++) {
-    union_info = &g_array_index (gst_value_union_funcs, GstValueUnionInfo, i);
-    if (union_info->type1 == type1 && union_info->type2 == type2) {
-      return union_info->func (dest, value1, value2);
-    }
-    if (union_info->type1 == type2 && union_info->type2 == type1) {
-      return union_info->func (dest, value2, value1);
-    }
+    if (entry->swapped)
+      return func (dest, value2, value1);
+    return func (dest, value1, value2);
   }
 
   gst_value_list_concat (dest, value1, value2);
@@ -4907,13 +4995,8 @@ gst_value_union (GValue * dest, const GValue * value1, const GValue * value2)
 static void
 gst_value_register_union_func (GType type1, GType type2, GstValueUnionFunc func)
 {
-  GstValueUnionInfo union_info;
-
-  union_info.type1 = type1;
-  union_info.type2 = type2;
-  union_info.func = func;
-
-  g_array_append_val (gst_value_union_funcs, union_info);
+  gst_value_pair_table_register (&gst_value_union_funcs, type1, type2,
+      (gpointer) func, TRUE);
 }
 
 /* intersection */
@@ -4932,8 +5015,6 @@ gst_value_register_union_func (GType type1, GType type2, GstValueUnionFunc func)
 gboolean
 gst_value_can_intersect (const GValue * value1, const GValue * value2)
 {
-  GstValueIntersectInfo *intersect_info;
-  guint i, len;
   GType type1, type2;
 
   g_return_val_if_fail (G_IS_VALUE (value1), FALSE);
@@ -4952,14 +5033,8 @@ gst_value_can_intersect (const GValue * value1, const GValue * value2)
     return TRUE;
 
   /* check registered intersect functions */
-  len = gst_value_intersect_funcs->len;
-  for (i = 0; i < len; i++) {
-    intersect_info = &g_array_index (gst_value_intersect_funcs,
-        GstValueIntersectInfo, i);
-    if ((intersect_info->type1 == type1 && intersect_info->type2 == type2) ||
-        (intersect_info->type1 == type2 && intersect_info->type2 == type1))
-      return TRUE;
-  }
+  if (gst_value_pair_table_lookup (&gst_value_intersect_funcs, type1, type2))
+    return TRUE;
 
   return gst_value_can_compare_unchecked (value1, value2);
 }
@@ -4984,8 +5059,7 @@ gboolean
 gst_value_intersect (GValue * dest, const GValue * value1,
     const GValue * value2)
 {
-  GstValueIntersectInfo *intersect_info;
-  guint i, len;
+  const GstValuePairEntry *entry;
   GType type1, type2;
 
   g_return_val_if_fail (G_IS_VALUE (value1), FALSE);
@@ -5006,16 +5080,14 @@ gst_value_intersect (GValue * dest, const GValue * value1,
     return TRUE;
   }
 
-  len = gst_value_intersect_funcs->len;
-  for (i = 0; i < len; i++) {
-    intersect_info = &g_array_index (gst_value_intersect_funcs,
-        GstValueIntersectInfo, i);
-    if (intersect_info->type1 == type1 && intersect_info->type2 == type2) {
-      return intersect_info->func (dest, value1, value2);
-    }
-    if (intersect_info->type1 == type2 && intersect_info->type2 == type1) {
-      return intersect_info->func (dest, value2, value1);
-    }
+  entry = gst_value_pair_table_lookup (&gst_value_intersect_funcs, type1,
+      type2);
+  if (entry) {
+    GstValueIntersectFunc func = (GstValueIntersectFunc) entry->func;
+
+    if (entry->swapped)
+      return func (dest, value2, value1);
+    return func (dest, value1, value2);
   }
 
   /* Failed to find a direct intersection, check if these are
@@ -5047,13 +5119,8 @@ static void
 gst_value_register_intersect_func (GType type1, GType type2,
     GstValueIntersectFunc func)
 {
-  GstValueIntersectInfo intersect_info;
-
-  intersect_info.type1 = type1;
-  intersect_info.type2 = type2;
-  intersect_info.func = func;
-
-  g_array_append_val (gst_value_intersect_funcs, intersect_info);
+  gst_value_pair_table_register (&gst_value_intersect_funcs, type1, type2,
+      (gpointer) func, TRUE);
 }
 
 
@@ -5077,8 +5144,7 @@ gboolean
 gst_value_subtract (GValue * dest, const GValue * minuend,
     const GValue * subtrahend)
 {
-  GstValueSubtractInfo *info;
-  guint i, len;
+  const GstValuePairEntry *entry;
   GType mtype, stype;
 
   g_return_val_if_fail (G_IS_VALUE (minuend), FALSE);
@@ -5093,13 +5159,9 @@ gst_value_subtract (GValue * dest, const GValue * minuend,
   if (stype == GST_TYPE_LIST)
     return gst_value_subtract_list (dest, minuend, subtrahend);
 
-  len = gst_value_subtract_funcs->len;
-  for (i = 0; i < len; i++) {
-    info = &g_array_index (gst_value_subtract_funcs, GstValueSubtractInfo, i);
-    if (info->minuend == mtype && info->subtrahend == stype) {
-      return info->func (dest, minuend, subtrahend);
-    }
-  }
+  entry = gst_value_pair_table_lookup (&gst_value_subtract_funcs, mtype, stype);
+  if (entry)
+    return ((GstValueSubtractFunc) entry->func) (dest, minuend, subtrahend);
 
   if (_gst_value_compare_nolist (minuend, subtrahend) != GST_VALUE_EQUAL) {
     if (dest)
@@ -5136,8 +5198,6 @@ gst_value_subtract (GValue * dest, const GValue * minuend,
 gboolean
 gst_value_can_subtract (const GValue * minuend, const GValue * subtrahend)
 {
-  GstValueSubtractInfo *info;
-  guint i, len;
   GType mtype, stype;
 
   g_return_val_if_fail (G_IS_VALUE (minuend), FALSE);
@@ -5150,12 +5210,8 @@ gst_value_can_subtract (const GValue * minuend, const GValue * subtrahend)
   if (mtype == GST_TYPE_LIST || stype == GST_TYPE_LIST)
     return TRUE;
 
-  len = gst_value_subtract_funcs->len;
-  for (i = 0; i < len; i++) {
-    info = &g_array_index (gst_value_subtract_funcs, GstValueSubtractInfo, i);
-    if (info->minuend == mtype && info->subtrahend == stype)
-      return TRUE;
-  }
+  if (gst_value_pair_table_lookup (&gst_value_subtract_funcs, mtype, stype))
+    return TRUE;
 
   return gst_value_can_compare_unchecked (minuend, subtrahend);
 }
@@ -5176,16 +5232,11 @@ static void
 gst_value_register_subtract_func (GType minuend_type, GType subtrahend_type,
     GstValueSubtractFunc func)
 {
-  GstValueSubtractInfo info;
-
   g_return_if_fail (!gst_type_is_fixed (minuend_type)
       || !gst_type_is_fixed (subtrahend_type));
 
-  info.minuend = minuend_type;
-  info.subtrahend = subtrahend_type;
-  info.func = func;
-
-  g_array_append_val (gst_value_subtract_funcs, info);
+  gst_value_pair_table_register (&gst_value_subtract_funcs, minuend_type,
+      subtrahend_type, (gpointer) func, FALSE);
 }
 
 /**
@@ -5228,9 +5279,48 @@ gst_value_init_and_copy (GValue * dest, const GValue * src)
   g_return_if_fail (dest != NULL);
 
   g_value_init (dest, G_VALUE_TYPE (src));
+
+  /* interned strings are never freed, copies can share them */
+  if (G_VALUE_TYPE (src) == G_TYPE_STRING
+      && (src->data[1].v_uint & GST_VALUE_INTERNED_STRING)) {
+    dest->data[0].v_pointer = src->data[0].v_pointer;
+    dest->data[1].v_uint = src->data[1].v_uint;
+    return;
+  }
+
   g_value_copy (src, dest);
 }
 
+/* longest string value that is interned, longer ones are more likely
+ * unique data than one of a small set of names */
+#define INTERN_STRING_MAX_LEN 64
+
+/* replaces the short strings in @value, and in the lists and arrays it
+ * contains, with interned strings */
+void
+priv_gst_value_intern_strings (GValue * value)
+{
+  GType type = G_VALUE_TYPE (value);
+
+  if (type == G_TYPE_STRING) {
+    const gchar *str = value->data[0].v_pointer;
+
+    if (str == NULL || (value->data[1].v_uint & GST_VALUE_INTERNED_STRING))
+      return;
+    if (strlen (str) > INTERN_STRING_MAX_LEN)
+      return;
+
+    g_value_set_static_string (value, g_intern_string (str));
+    value->data[1].v_uint |= GST_VALUE_INTERNED_STRING;
+  } else if (type == GST_TYPE_LIST || type == GST_TYPE_ARRAY) {
+    GArray *array = value->data[0].v_pointer;
+    guint i;
+
+    for (i = 0; i < array->len; i++)
+      priv_gst_value_intern_strings (&g_array_index (array, GValue, i));
+  }
+}
+
 /* move src into dest and clear src */
 static void
 gst_value_move (GValue * dest, GValue * src)
@@ -5335,6 +5425,578 @@ gst_value_deserialize (GValue * dest, const gchar * src)
   return FALSE;
 }
 
+/************************
+ * binary serialization *
+ ************************/
+
+/* maximum nesting of lists, arrays, structures and caps we accept */
+#define BINARY_MAX_DEPTH 64
+
+/* type tags of binary serialized values, never reuse or renumber these */
+enum
+{
+  BINARY_VALUE_INT = 1,
+  BINARY_VALUE_UINT,
+  BINARY_VALUE_INT64,
+  BINARY_VALUE_UINT64,
+  BINARY_VALUE_BOOLEAN,
+  BINARY_VALUE_FLOAT,
+  BINARY_VALUE_DOUBLE,
+  BINARY_VALUE_STRING,
+  BINARY_VALUE_INT_RANGE,
+  BINARY_VALUE_INT64_RANGE,
+  BINARY_VALUE_DOUBLE_RANGE,
+  BINARY_VALUE_FRACTION,
+  BINARY_VALUE_FRACTION_RANGE,
+  BINARY_VALUE_LIST,
+  BINARY_VALUE_ARRAY,
+  BINARY_VALUE_BITMASK,
+  BINARY_VALUE_STRUCTURE,
+  BINARY_VALUE_CAPS,
+  /* type name and gst_value_serialize() string */
+  BINARY_VALUE_GENERIC
+};
+
+static inline void
+gst_binary_write_uint8 (GByteArray * array, guint8 val)
+{
+  g_byte_array_append (array, &val, 1);
+}
+
+void
+_priv_gst_binary_write_version (GByteArray * array)
+{
+  gst_binary_write_uint8 (array, GST_BINARY_FORMAT_VERSION);
+}
+
+/* unsigned LEB128, small values take one byte */
+void
+_priv_gst_binary_write_uint (GByteArray * array, guint64 val)
+{
+  guint8 buf[10];
+  guint n = 0;
+
+  do {
+    buf[n] = val & 0x7f;
+    val >>= 7;
+    if (val)
+      buf[n] |= 0x80;
+    n++;
+  } while (val);
+
+  g_byte_array_append (array, buf, n);
+}
+
+static void
+gst_binary_write_int (GByteArray * array, gint64 val)
+{
+  /* zigzag encoding, keeps small negative values small as well */
+  _priv_gst_binary_write_uint (array,
+      ((guint64) val << 1) ^ (val < 0 ? G_MAXUINT64 : 0));
+}
+
+static void
+gst_binary_write_double (GByteArray * array, gdouble val)
+{
+  union
+  {
+    gdouble d;
+    guint64 u;
+  } u;
+
+  u.d = val;
+  u.u = GUINT64_TO_LE (u.u);
+  g_byte_array_append (array, (const guint8 *) &u.u, 8);
+}
+
+/* NULL is stored as length 0, other strings with their length + 1 and
+ * their terminator, so that readers can use them in place */
+void
+_priv_gst_binary_write_string (GByteArray * array, const gchar * str)
+{
+  gsize len;
+
+  if (str == NULL) {
+    _priv_gst_binary_write_uint (array, 0);
+    return;
+  }
+
+  len = strlen (str) + 1;
+  _priv_gst_binary_write_uint (array, len);
+  g_byte_array_append (array, (const guint8 *) str, len);
+}
+
+gboolean
+_priv_gst_binary_read_uint8 (GstBinaryReader * reader, guint8 * val)
+{
+  if (reader->pos >= reader->size)
+    return FALSE;
+
+  *val = reader->data[reader->pos++];
+  return TRUE;
+}
+
+gboolean
+_priv_gst_binary_read_version (GstBinaryReader * reader)
+{
+  guint8 version;
+
+  if (!_priv_gst_binary_read_uint8 (reader, &version))
+    return FALSE;
+
+  if (version != GST_BINARY_FORMAT_VERSION) {
+    GST_WARNING ("unsupported binary format version %u", version);
+    return FALSE;
+  }
+  return TRUE;
+}
+
+gboolean
+_priv_gst_binary_read_uint (GstBinaryReader * reader, guint64 * val)
+{
+  guint64 res = 0;
+  guint shift = 0;
+  guint8 b;
+
+  do {
+    if (reader->pos >= reader->size || shift > 63)
+      return FALSE;
+    b = reader->data[reader->pos++];
+    res |= (guint64) (b & 0x7f) << shift;
+    shift += 7;
+  } while (b & 0x80);
+
+  *val = res;
+  return TRUE;
+}
+
+static gboolean
+gst_binary_read_int (GstBinaryReader * reader, gint64 * val)
+{
+  guint64 u;
+
+  if (!_priv_gst_binary_read_uint (reader, &u))
+    return FALSE;
+
+  *val = (gint64) ((u >> 1) ^ (0 - (u & 1)));
+  return TRUE;
+}
+
+static gboolean
+gst_binary_read_int32 (GstBinaryReader * reader, gint * val)
+{
+  gint64 v;
+
+  if (!gst_binary_read_int (reader, &v) || v < G_MININT || v > G_MAXINT)
+    return FALSE;
+
+  *val = (gint) v;
+  return TRUE;
+}
+
+static gboolean
+gst_binary_read_double (GstBinaryReader * reader, gdouble * val)
+{
+  union
+  {
+    gdouble d;
+    guint64 u;
+  } u;
+
+  if (reader->size - reader->pos < 8)
+    return FALSE;
+
+  memcpy (&u.u, reader->data + reader->pos, 8);
+  reader->pos += 8;
+  u.u = GUINT64_FROM_LE (u.u);
+  *val = u.d;
+  return TRUE;
+}
+
+/* @str points into the data of @reader, it is not copied */
+gboolean
+_priv_gst_binary_read_string (GstBinaryReader * reader, const gchar ** str)
+{
+  const gchar *s;
+  guint64 len;
+
+  if (!_priv_gst_binary_read_uint (reader, &len))
+    return FALSE;
+
+  if (len == 0) {
+    *str = NULL;
+    return TRUE;
+  }
+
+  if (len > reader->size - reader->pos)
+    return FALSE;
+
+  s = (const gchar *) reader->data + reader->pos;
+  if (s[len - 1] != '\0' || memchr (s, '\0', len - 1) != NULL)
+    return FALSE;
+
+  reader->pos += len;
+  *str = s;
+  return TRUE;
+}
+
+static gboolean
+gst_value_write_binary_generic (GByteArray * array, const GValue * value)
+{
+  gchar *str;
+
+  str = gst_value_serialize (value);
+  if (str == NULL) {
+    GST_WARNING ("can't serialize value of type %s",
+        G_VALUE_TYPE_NAME (value));
+    return FALSE;
+  }
+
+  gst_binary_write_uint8 (array, BINARY_VALUE_GENERIC);
+  _priv_gst_binary_write_string (array, G_VALUE_TYPE_NAME (value));
+  _priv_gst_binary_write_string (array, str);
+  g_free (str);
+
+  return TRUE;
+}
+
+gboolean
+_priv_gst_value_write_binary (GByteArray * array, const GValue * value)
+{
+  GType type = G_VALUE_TYPE (value);
+
+  if (type == G_TYPE_INT) {
+    gst_binary_write_uint8 (array, BINARY_VALUE_INT);
+    gst_binary_write_int (array, g_value_get_int (value));
+  } else if (type == G_TYPE_UINT) {
+    gst_binary_write_uint8 (array, BINARY_VALUE_UINT);
+    _priv_gst_binary_write_uint (array, g_value_get_uint (value));
+  } else if (type == G_TYPE_INT64) {
+    gst_binary_write_uint8 (array, BINARY_VALUE_INT64);
+    gst_binary_write_int (array, g_value_get_int64 (value));
+  } else if (type == G_TYPE_UINT64) {
+    gst_binary_write_uint8 (array, BINARY_VALUE_UINT64);
+    _priv_gst_binary_write_uint (array, g_value_get_uint64 (value));
+  } else if (type == G_TYPE_BOOLEAN) {
+    gst_binary_write_uint8 (array, BINARY_VALUE_BOOLEAN);
+    gst_binary_write_uint8 (array, g_value_get_boolean (value) ? 1 : 0);
+  } else if (type == G_TYPE_FLOAT) {
+    gst_binary_write_uint8 (array, BINARY_VALUE_FLOAT);
+    gst_binary_write_double (array, g_value_get_float (value));
+  } else if (type == G_TYPE_DOUBLE) {
+    gst_binary_write_uint8 (array, BINARY_VALUE_DOUBLE);
+    gst_binary_write_double (array, g_value_get_double (value));
+  } else if (type == G_TYPE_STRING) {
+    gst_binary_write_uint8 (array, BINARY_VALUE_STRING);
+    _priv_gst_binary_write_string (array, g_value_get_string (value));
+  } else if (type == GST_TYPE_INT_RANGE) {
+    gst_binary_write_uint8 (array, BINARY_VALUE_INT_RANGE);
+    gst_binary_write_int (array, gst_value_get_int_range_min (value));
+    gst_binary_write_int (array, gst_value_get_int_range_max (value));
+    gst_binary_write_int (array, gst_value_get_int_range_step (value));
+  } else if (type == GST_TYPE_INT64_RANGE) {
+    gst_binary_write_uint8 (array, BINARY_VALUE_INT64_RANGE);
+    gst_binary_write_int (array, gst_value_get_int64_range_min (value));
+    gst_binary_write_int (array, gst_value_get_int64_range_max (value));
+    gst_binary_write_int (array, gst_value_get_int64_range_step (value));
+  } else if (type == GST_TYPE_DOUBLE_RANGE) {
+    gst_binary_write_uint8 (array, BINARY_VALUE_DOUBLE_RANGE);
+    gst_binary_write_double (array, gst_value_get_double_range_min (value));
+    gst_binary_write_double (array, gst_value_get_double_range_max (value));
+  } else if (type == GST_TYPE_FRACTION) {
+    gst_binary_write_uint8 (array, BINARY_VALUE_FRACTION);
+    gst_binary_write_int (array, gst_value_get_fraction_numerator (value));
+    gst_binary_write_int (array, gst_value_get_fraction_denominator (value));
+  } else if (type == GST_TYPE_FRACTION_RANGE) {
+    const GValue *min = gst_value_get_fraction_range_min (value);
+    const GValue *max = gst_value_get_fraction_range_max (value);
+
+    gst_binary_write_uint8 (array, BINARY_VALUE_FRACTION_RANGE);
+    gst_binary_write_int (array, gst_value_get_fraction_numerator (min));
+    gst_binary_write_int (array, gst_value_get_fraction_denominator (min));
+    gst_binary_write_int (array, gst_value_get_fraction_numerator (max));
+    gst_binary_write_int (array, gst_value_get_fraction_denominator (max));
+  } else if (type == GST_TYPE_LIST || type == GST_TYPE_ARRAY) {
+    guint i, len = VALUE_LIST_SIZE (value);
+
+    gst_binary_write_uint8 (array,
+        type == GST_TYPE_LIST ? BINARY_VALUE_LIST : BINARY_VALUE_ARRAY);
+    _priv_gst_binary_write_uint (array, len);
+    for (i = 0; i < len; i++) {
+      if (!_priv_gst_value_write_binary (array, VALUE_LIST_GET_VALUE (value,
+                  i)))
+        return FALSE;
+    }
+  } else if (type == GST_TYPE_BITMASK) {
+    gst_binary_write_uint8 (array, BINARY_VALUE_BITMASK);
+    _priv_gst_binary_write_uint (array, gst_value_get_bitmask (value));
+  } else if (type == GST_TYPE_STRUCTURE && gst_value_get_structure (value)) {
+    gst_binary_write_uint8 (array, BINARY_VALUE_STRUCTURE);
+    return _priv_gst_structure_write_binary (array,
+        gst_value_get_structure (value));
+  } else if (type == GST_TYPE_CAPS && gst_value_get_caps (value)) {
+    gst_binary_write_uint8 (array, BINARY_VALUE_CAPS);
+    return _priv_gst_caps_write_binary (array, gst_value_get_caps (value));
+  } else {
+    return gst_value_write_binary_generic (array, value);
+  }
+
+  return TRUE;
+}
+
+static gboolean
+gst_value_read_binary_list (GstBinaryReader * reader, GValue * value,
+    GType type)
+{
+  guint64 i, len;
+
+  if (!_priv_gst_binary_read_uint (reader, &len))
+    return FALSE;
+
+  /* every value takes at least one byte */
+  if (len > reader->size - reader->pos)
+    return FALSE;
+
+  g_value_init (value, type);
+  for (i = 0; i < len; i++) {
+    GValue v = G_VALUE_INIT;
+
+    if (!_priv_gst_value_read_binary (reader, &v)) {
+      g_value_unset (value);
+      return FALSE;
+    }
+    if (type == GST_TYPE_LIST)
+      _gst_value_list_append_and_take_value (value, &v);
+    else
+      _gst_value_array_append_and_take_value (value, &v);
+  }
+
+  return TRUE;
+}
+
+static gboolean
+gst_value_read_binary_generic (GstBinaryReader * reader, GValue * value)
+{
+  const gchar *type_name, *str;
+  GType type;
+
+  if (!_priv_gst_binary_read_string (reader, &type_name) || !type_name ||
+      !_priv_gst_binary_read_string (reader, &str) || !str)
+    return FALSE;
+
+  type = _priv_gst_type_from_name (type_name);
+  if (type == G_TYPE_INVALID) {
+    GST_WARNING ("unknown type %s", type_name);
+    return FALSE;
+  }
+
+  g_value_init (value, type);
+  if (!gst_value_deserialize (value, str)) {
+    g_value_unset (value);
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+/* reads a value written with _priv_gst_value_write_binary() into the
+ * uninitialized @value */
+gboolean
+_priv_gst_value_read_binary (GstBinaryReader * reader, GValue * value)
+{
+  gboolean ret = FALSE;
+  guint8 tag;
+
+  if (!_priv_gst_binary_read_uint8 (reader, &tag))
+    return FALSE;
+
+  switch (tag) {
+    case BINARY_VALUE_INT:{
+      gint v;
+
+      if ((ret = gst_binary_read_int32 (reader, &v))) {
+        g_value_init (value, G_TYPE_INT);
+        g_value_set_int (value, v);
+      }
+      break;
+    }
+    case BINARY_VALUE_UINT:{
+      guint64 v;
+
+      if ((ret = _priv_gst_binary_read_uint (reader, &v) && v <= G_MAXUINT)) {
+        g_value_init (value, G_TYPE_UINT);
+        g_value_set_uint (value, (guint) v);
+      }
+      break;
+    }
+    case BINARY_VALUE_INT64:{
+      gint64 v;
+
+      if ((ret = gst_binary_read_int (reader, &v))) {
+        g_value_init (value, G_TYPE_INT64);
+        g_value_set_int64 (value, v);
+      }
+      break;
+    }
+    case BINARY_VALUE_UINT64:{
+      guint64 v;
+
+      if ((ret = _priv_gst_binary_read_uint (reader, &v))) {
+        g_value_init (value, G_TYPE_UINT64);
+        g_value_set_uint64 (value, v);
+      }
+      break;
+    }
+    case BINARY_VALUE_BOOLEAN:{
+      guint8 v;
+
+      if ((ret = _priv_gst_binary_read_uint8 (reader, &v))) {
+        g_value_init (value, G_TYPE_BOOLEAN);
+        g_value_set_boolean (value, v != 0);
+      }
+      break;
+    }
+    case BINARY_VALUE_FLOAT:
+    case BINARY_VALUE_DOUBLE:{
+      gdouble v;
+
+      if ((ret = gst_binary_read_double (reader, &v))) {
+        if (tag == BINARY_VALUE_FLOAT) {
+          g_value_init (value, G_TYPE_FLOAT);
+          g_value_set_float (value, (gfloat) v);
+        } else {
+          g_value_init (value, G_TYPE_DOUBLE);
+          g_value_set_double (value, v);
+        }
+      }
+      break;
+    }
+    case BINARY_VALUE_STRING:{
+      const gchar *v;
+
+      if ((ret = _priv_gst_binary_read_string (reader, &v))) {
+        g_value_init (value, G_TYPE_STRING);
+        g_value_set_string (value, v);
+      }
+      break;
+    }
+    case BINARY_VALUE_INT_RANGE:{
+      gint min, max, step;
+
+      if (gst_binary_read_int32 (reader, &min) &&
+          gst_binary_read_int32 (reader, &max) &&
+          gst_binary_read_int32 (reader, &step) && min < max && step > 0 &&
+          min % step == 0 && max % step == 0) {
+        g_value_init (value, GST_TYPE_INT_RANGE);
+        gst_value_set_int_range_step (value, min, max, step);
+        ret = TRUE;
+      }
+      break;
+    }
+    case BINARY_VALUE_INT64_RANGE:{
+      gint64 min, max, step;
+
+      if (gst_binary_read_int (reader, &min) &&
+          gst_binary_read_int (reader, &max) &&
+          gst_binary_read_int (reader, &step) && min < max && step > 0 &&
+          min % step == 0 && max % step == 0) {
+        g_value_init (value, GST_TYPE_INT64_RANGE);
+        gst_value_set_int64_range_step (value, min, max, step);
+        ret = TRUE;
+      }
+      break;
+    }
+    case BINARY_VALUE_DOUBLE_RANGE:{
+      gdouble min, max;
+
+      if (gst_binary_read_double (reader, &min) &&
+          gst_binary_read_double (reader, &max) && min < max) {
+        g_value_init (value, GST_TYPE_DOUBLE_RANGE);
+        gst_value_set_double_range (value, min, max);
+        ret = TRUE;
+      }
+      break;
+    }
+    case BINARY_VALUE_FRACTION:{
+      gint num, den;
+
+      if (gst_binary_read_int32 (reader, &num) &&
+          gst_binary_read_int32 (reader, &den) && den != 0) {
+        g_value_init (value, GST_TYPE_FRACTION);
+        gst_value_set_fraction (value, num, den);
+        ret = TRUE;
+      }
+      break;
+    }
+    case BINARY_VALUE_FRACTION_RANGE:{
+      gint n1, d1, n2, d2;
+
+      if (gst_binary_read_int32 (reader, &n1) &&
+          gst_binary_read_int32 (reader, &d1) &&
+          gst_binary_read_int32 (reader, &n2) &&
+          gst_binary_read_int32 (reader, &d2) && d1 != 0 && d2 != 0 &&
+          gst_util_fraction_compare (n1, d1, n2, d2) < 0) {
+        g_value_init (value, GST_TYPE_FRACTION_RANGE);
+        gst_value_set_fraction_range_full (value, n1, d1, n2, d2);
+        ret = TRUE;
+      }
+      break;
+    }
+    case BINARY_VALUE_LIST:
+    case BINARY_VALUE_ARRAY:
+      if (reader->depth < BINARY_MAX_DEPTH) {
+        reader->depth++;
+        ret = gst_value_read_binary_list (reader, value,
+            tag == BINARY_VALUE_LIST ? GST_TYPE_LIST : GST_TYPE_ARRAY);
+        reader->depth--;
+      }
+      break;
+    case BINARY_VALUE_BITMASK:{
+      guint64 v;
+
+      if ((ret = _priv_gst_binary_read_uint (reader, &v))) {
+        g_value_init (value, GST_TYPE_BITMASK);
+        gst_value_set_bitmask (value, v);
+      }
+      break;
+    }
+    case BINARY_VALUE_STRUCTURE:
+      if (reader->depth < BINARY_MAX_DEPTH) {
+        GstStructure *s;
+
+        reader->depth++;
+        s = _priv_gst_structure_read_binary (reader);
+        reader->depth--;
+        if ((ret = (s != NULL))) {
+          g_value_init (value, GST_TYPE_STRUCTURE);
+          g_value_take_boxed (value, s);
+        }
+      }
+      break;
+    case BINARY_VALUE_CAPS:
+      if (reader->depth < BINARY_MAX_DEPTH) {
+        GstCaps *caps;
+
+        reader->depth++;
+        caps = _priv_gst_caps_read_binary (reader);
+        reader->depth--;
+        if ((ret = (caps != NULL))) {
+          g_value_init (value, GST_TYPE_CAPS);
+          g_value_take_boxed (value, caps);
+        }
+      }
+      break;
+    case BINARY_VALUE_GENERIC:
+      ret = gst_value_read_binary_generic (reader, value);
+      break;
+    default:
+      GST_WARNING ("unknown binary value type %u", tag);
+      break;
+  }
+
+  return ret;
+}
+
 /**
  * gst_value_is_fixed:
  * @value: the #GValue to check
@@ -6307,7 +6969,7 @@ try_as_flags_string:
 
     if (end != NULL) {
       gchar *class_name = g_strndup (set_class, end - set_class);
-      GType flags_type = g_type_from_name (class_name);
+      GType flags_type = _priv_gst_type_from_name (class_name);
 
       g_free (class_name);
 
@@ -6622,12 +7284,12 @@ _priv_gst_value_initialize (void)
       g_array_sized_new (FALSE, FALSE, sizeof (GstValueTable),
       GST_VALUE_TABLE_DEFAULT_SIZE);
   gst_value_hash = g_hash_table_new (NULL, NULL);
-  gst_value_union_funcs = g_array_sized_new (FALSE, FALSE,
-      sizeof (GstValueUnionInfo), GST_VALUE_UNION_TABLE_DEFAULT_SIZE);
-  gst_value_intersect_funcs = g_array_sized_new (FALSE, FALSE,
-      sizeof (GstValueIntersectInfo), GST_VALUE_INTERSECT_TABLE_DEFAULT_SIZE);
-  gst_value_subtract_funcs = g_array_sized_new (FALSE, FALSE,
-      sizeof (GstValueSubtractInfo), GST_VALUE_SUBTRACT_TABLE_DEFAULT_SIZE);
+  gst_value_pair_table_init (&gst_value_union_funcs,
+      GST_VALUE_UNION_TABLE_DEFAULT_SIZE);
+  gst_value_pair_table_init (&gst_value_intersect_funcs,
+      GST_VALUE_INTERSECT_TABLE_DEFAULT_SIZE);
+  gst_value_pair_table_init (&gst_value_subtract_funcs,
+      GST_VALUE_SUBTRACT_TABLE_DEFAULT_SIZE);
 
   REGISTER_SERIALIZATION (gst_int_range_get_type (), int_range);
   REGISTER_SERIALIZATION (gst_int64_range_get_type (), int64_range);
@@ -6788,20 +7450,20 @@ _priv_gst_value_initialize (void)
         "Please set GST_VALUE_TABLE_DEFAULT_SIZE to %u in gstvalue.c",
         gst_value_table->len);
   }
-  if (gst_value_union_funcs->len != GST_VALUE_UNION_TABLE_DEFAULT_SIZE) {
+  if (gst_value_union_funcs.n_funcs != GST_VALUE_UNION_TABLE_DEFAULT_SIZE) {
     GST_ERROR ("Wrong initial gst_value_union_funcs table size. "
         "Please set GST_VALUE_UNION_TABLE_DEFAULT_SIZE to %u in gstvalue.c",
-        gst_value_union_funcs->len);
+        gst_value_union_funcs.n_funcs);
   }
-  if (gst_value_intersect_funcs->len != GST_VALUE_INTERSECT_TABLE_DEFAULT_SIZE) {
+  if (gst_value_intersect_funcs.n_funcs != GST_VALUE_INTERSECT_TABLE_DEFAULT_SIZE) {
     GST_ERROR ("Wrong initial gst_value_intersect_funcs table size. "
         "Please set GST_VALUE_INTERSECT_TABLE_DEFAULT_SIZE to %u in gstvalue.c",
-        gst_value_intersect_funcs->len);
+        gst_value_intersect_funcs.n_funcs);
   }
-  if (gst_value_subtract_funcs->len != GST_VALUE_SUBTRACT_TABLE_DEFAULT_SIZE) {
+  if (gst_value_subtract_funcs.n_funcs != GST_VALUE_SUBTRACT_TABLE_DEFAULT_SIZE) {
     GST_ERROR ("Wrong initial gst_value_subtract_funcs table size. "
         "Please set GST_VALUE_SUBTRACT_TABLE_DEFAULT_SIZE to %u in gstvalue.c",
-        gst_value_subtract_funcs->len);
+        gst_value_subtract_funcs.n_funcs);
   }
 #endif
 
@@ -258,6 +258,126 @@ static int  gst_resolve_reference(reference_t *rr, GstElement *pipeline){
   else            return -1; /* not found */
 }
 
+/*******************************************************************************************
+*** recording of templates
+*******************************************************************************************/
+
+/* the description can't be replayed, it will be parsed for every instance */
+static void gst_parse_record_reparse (graph_t *graph)
+{
+  if (graph->templ)
+    graph->templ->reparse = TRUE;
+}
+
+static void gst_parse_record_element (graph_t *graph, GstElement *element)
+{
+  GstParseTemplate *templ = graph->templ;
+  template_element_t te;
+
+  if (templ == NULL || element == NULL)
+    return;
+
+  te.factory = gst_element_get_factory (element);
+  if (te.factory == NULL) {
+    gst_parse_record_reparse (graph);
+    return;
+  }
+  gst_object_ref (te.factory);
+  te.parent = -1;
+  te.props = g_array_new (FALSE, TRUE, sizeof (template_prop_t));
+  g_array_append_val (templ->elements, te);
+  g_hash_table_insert (templ->index, element,
+      GUINT_TO_POINTER (templ->elements->len));
+}
+
+static gint gst_parse_record_lookup (graph_t *graph, GstElement *element)
+{
+  return GPOINTER_TO_INT (g_hash_table_lookup (graph->templ->index,
+          element)) - 1;
+}
+
+static void gst_parse_record_property (graph_t *graph, GstElement *element,
+    GParamSpec *pspec, const GValue *value)
+{
+  template_element_t *te;
+  template_prop_t prop = { NULL, G_VALUE_INIT };
+  gint idx;
+
+  if (graph->templ == NULL)
+    return;
+
+  /* objects can't be shared between instances */
+  idx = gst_parse_record_lookup (graph, element);
+  if (idx < 0 || G_VALUE_HOLDS_OBJECT (value)) {
+    gst_parse_record_reparse (graph);
+    return;
+  }
+
+  te = &g_array_index (graph->templ->elements, template_element_t, idx);
+  prop.name = g_intern_string (pspec->name);
+  g_value_init (&prop.value, G_VALUE_TYPE (value));
+  g_value_copy (value, &prop.value);
+  g_array_append_val (te->props, prop);
+}
+
+static GSList *gst_parse_copy_pads (GSList *pads)
+{
+  GSList *copy = NULL;
+
+  for (; pads; pads = pads->next)
+    copy = g_slist_prepend (copy, g_strdup (pads->data));
+
+  return g_slist_reverse (copy);
+}
+
+static void gst_parse_record_link (graph_t *graph, link_t *link)
+{
+  template_link_t tl;
+  gint src, sink;
+
+  if (graph->templ == NULL)
+    return;
+
+  src = gst_parse_record_lookup (graph, link->src.element);
+  sink = gst_parse_record_lookup (graph, link->sink.element);
+  if (src < 0 || sink < 0) {
+    gst_parse_record_reparse (graph);
+    return;
+  }
+
+  tl.src = src;
+  tl.sink = sink;
+  tl.src_pads = gst_parse_copy_pads (link->src.pads);
+  tl.sink_pads = gst_parse_copy_pads (link->sink.pads);
+  tl.caps = link->caps ? gst_caps_ref (link->caps) : NULL;
+  g_array_append_val (graph->templ->links, tl);
+}
+
+/* remember the parents and the toplevel once all elements are in their bins */
+static void gst_parse_record_finish (graph_t *graph, GstElement *top)
+{
+  GstParseTemplate *templ = graph->templ;
+  GHashTableIter iter;
+  gpointer key, value;
+
+  if (templ == NULL || top == NULL)
+    return;
+
+  g_hash_table_iter_init (&iter, templ->index);
+  while (g_hash_table_iter_next (&iter, &key, &value)) {
+    GstObject *parent = GST_OBJECT_PARENT (key);
+    template_element_t *te = &g_array_index (templ->elements,
+        template_element_t, GPOINTER_TO_UINT (value) - 1);
+
+    if (parent)
+      te->parent = gst_parse_record_lookup (graph, GST_ELEMENT_CAST (parent));
+  }
+  if (gst_parse_record_lookup (graph, top) < 0)
+    gst_parse_record_reparse (graph);
+  else
+    templ->top = gst_parse_record_lookup (graph, top);
+}
+
 static void gst_parse_free_delayed_set (DelayedSet *set)
 {
   g_free(set->name);
@@ -401,6 +521,7 @@ static void gst_parse_element_set (gchar *value, GstElement *element, graph_t *g
     if (!gst_child_proxy_lookup (GST_CHILD_PROXY (element), value, &target, &pspec)) {
       /* do a delayed set */
       gst_parse_add_delayed_set (element, value, pos);
+      gst_parse_record_reparse (graph);
     }
   } else {
     pspec = g_object_class_find_property (G_OBJECT_GET_CLASS (element), value);
@@ -438,6 +559,12 @@ static void gst_parse_element_set (gchar *value, GstElement *element, graph_t *g
     if (!got_value)
       goto error;
     g_object_set_property (target, pspec->name, &v);
+
+    /* properties of children are not recorded */
+    if (target == G_OBJECT (element))
+      gst_parse_record_property (graph, element, pspec, &v);
+    else
+      gst_parse_record_reparse (graph);
   }
 
 out:
@@ -573,45 +700,24 @@ gst_parse_perform_delayed_link (GstElement *src, const gchar *src_pad,
   return FALSE;
 }
 
-/*
- * performs a link and frees the struct. src and sink elements must be given
- * return values   0 - link performed
- *                 1 - link delayed
- *                <0 - error
- */
-static gint
-gst_parse_perform_link (link_t *link, graph_t *graph)
+/* links the given pads of src and sink, or delays the links */
+static gboolean
+gst_parse_link_pads (GstElement *src, GSList *srcs, GstElement *sink,
+    GSList *sinks, GstCaps *caps)
 {
-  GstElement *src = link->src.element;
-  GstElement *sink = link->sink.element;
-  GSList *srcs = link->src.pads;
-  GSList *sinks = link->sink.pads;
-  g_assert (GST_IS_ELEMENT (src));
-  g_assert (GST_IS_ELEMENT (sink));
-
-  GST_CAT_INFO (GST_CAT_PIPELINE,
-      "linking " PRETTY_PAD_NAME_FMT " to " PRETTY_PAD_NAME_FMT " (%u/%u) with caps \"%" GST_PTR_FORMAT "\"",
-      PRETTY_PAD_NAME_ARGS (src, link->src.name),
-      PRETTY_PAD_NAME_ARGS (sink, link->sink.name),
-      g_slist_length (srcs), g_slist_length (sinks), link->caps);
-
   if (!srcs || !sinks) {
     if (gst_element_link_pads_filtered (src,
         srcs ? (const gchar *) srcs->data : NULL, sink,
-        sinks ? (const gchar *) sinks->data : NULL, link->caps)) {
-      goto success;
+        sinks ? (const gchar *) sinks->data : NULL, caps)) {
+      return TRUE;
     } else {
-      if (gst_parse_perform_delayed_link (src,
+      return gst_parse_perform_delayed_link (src,
           srcs ? (const gchar *) srcs->data : NULL,
-          sink, sinks ? (const gchar *) sinks->data : NULL, link->caps)) {
-	goto success;
-      } else {
-        goto error;
-      }
+          sink, sinks ? (const gchar *) sinks->data : NULL, caps);
     }
   }
-  if (g_slist_length (link->src.pads) != g_slist_length (link->sink.pads)) {
-    goto error;
+  if (g_slist_length (srcs) != g_slist_length (sinks)) {
+    return FALSE;
   }
   while (srcs && sinks) {
     const gchar *src_pad = (const gchar *) srcs->data;
@@ -619,20 +725,48 @@ gst_parse_perform_link (link_t *link, graph_t *graph)
     srcs = g_slist_next (srcs);
     sinks = g_slist_next (sinks);
     if (gst_element_link_pads_filtered (src, src_pad, sink, sink_pad,
-        link->caps)) {
+        caps)) {
       continue;
     } else {
       if (gst_parse_perform_delayed_link (src, src_pad,
                                           sink, sink_pad,
-					  link->caps)) {
+					  caps)) {
 	continue;
       } else {
-        goto error;
+        return FALSE;
       }
     }
   }
+  return TRUE;
+}
+
+/*
+ * performs a link and frees the struct. src and sink elements must be given
+ * return values   0 - link performed
+ *                 1 - link delayed
+ *                <0 - error
+ */
+static gint
+gst_parse_perform_link (link_t *link, graph_t *graph)
+{
+  GstElement *src = link->src.element;
+  GstElement *sink = link->sink.element;
+  GSList *srcs = link->src.pads;
+  GSList *sinks = link->sink.pads;
+  g_assert (GST_IS_ELEMENT (src));
+  g_assert (GST_IS_ELEMENT (sink));
+
+  GST_CAT_INFO (GST_CAT_PIPELINE,
+      "linking " PRETTY_PAD_NAME_FMT " to " PRETTY_PAD_NAME_FMT " (%u/%u) with caps \"%" GST_PTR_FORMAT "\"",
+      PRETTY_PAD_NAME_ARGS (src, link->src.name),
+      PRETTY_PAD_NAME_ARGS (sink, link->sink.name),
+      g_slist_length (srcs), g_slist_length (sinks), link->caps);
+
+  gst_parse_record_link (graph, link);
+
+  if (!gst_parse_link_pads (src, srcs, sink, sinks, link->caps))
+    goto error;
 
-success:
   gst_parse_free_link (link);
   return 0;
 
@@ -715,6 +849,7 @@ element:	IDENTIFIER     		      { $$ = gst_element_factory_make ($1, NULL);
 						  add_missing_element(graph, $1);
 						  SET_ERROR (graph->error, GST_PARSE_ERROR_NO_SUCH_ELEMENT, _("no element \"%s\""), $1);
 						}
+						gst_parse_record_element (graph, $$);
 						gst_parse_strfree ($1);
                                               }
 	|	element ASSIGNMENT	      { gst_parse_element_set ($2, $1, graph);
@@ -844,6 +979,7 @@ morepads:	/* NOP */		      { $$ = NULL; }
 
 chain:	openchain link PARSE_URL	      { GstElement *element =
 							  gst_element_make_from_uri (GST_URI_SINK, $3, NULL, NULL);
+						gst_parse_record_reparse (graph);
 						/* FIXME: get and parse error properly */
 						if (!element) {
 						  SET_ERROR (graph->error, GST_PARSE_ERROR_NO_SUCH_ELEMENT,
@@ -863,6 +999,7 @@ chain:	openchain link PARSE_URL	      { GstElement *element =
 openchain:
 	PARSE_URL			      { GstElement *element =
 							  gst_element_make_from_uri (GST_URI_SRC, $1, NULL, NULL);
+						gst_parse_record_reparse (graph);
 						/* FIXME: get and parse error properly */
 						if (!element) {
 						  SET_ERROR (graph->error, GST_PARSE_ERROR_NO_SUCH_ELEMENT,
@@ -995,6 +1132,7 @@ bin:	binopener assignments chainlist ')'   {
 						  g_slist_free ($2);
 						  $2 = NULL;
 						} else {
+						  gst_parse_record_element (graph, GST_ELEMENT (bin));
 						  for (walk = chain->elements; walk; walk = walk->next )
 						    gst_bin_add (bin, GST_ELEMENT (walk->data));
 						  g_slist_free (chain->elements);
@@ -1039,7 +1177,7 @@ yyerror (void *scanner, graph_t *graph, const char *s)
 
 GstElement *
 priv_gst_parse_launch (const gchar *str, GError **error, GstParseContext *ctx,
-    GstParseFlags flags)
+    GstParseFlags flags, GstParseTemplate *templ)
 {
   graph_t g;
   gchar *dstr;
@@ -1056,6 +1194,7 @@ priv_gst_parse_launch (const gchar *str, GError **error, GstParseContext *ctx,
   g.error = error;
   g.ctx = ctx;
   g.flags = flags;
+  g.templ = templ;
 
 #ifdef __GST_PARSE_TRACE
   GST_CAT_DEBUG (GST_CAT_PIPELINE, "TRACE: tracing enabled");
@@ -1109,6 +1248,7 @@ priv_gst_parse_launch (const gchar *str, GError **error, GstParseContext *ctx,
   if(g.chain->elements->next){
     bin = GST_BIN (gst_element_factory_make ("pipeline", NULL));
     g_assert (bin);
+    gst_parse_record_element (&g, GST_ELEMENT (bin));
 
     for (walk = g.chain->elements; walk; walk = walk->next) {
       if (walk->data != NULL)
@@ -1126,6 +1266,7 @@ priv_gst_parse_launch (const gchar *str, GError **error, GstParseContext *ctx,
   gst_parse_free_chain (g.chain);
   g.chain = NULL;
 
+  gst_parse_record_finish (&g, ret);
 
   /* resolve and perform links */
   for (walk = g.links; walk; walk = walk->next) {
@@ -1190,3 +1331,68 @@ error1:
 
   goto out;
 }
+
+
+GstElement *
+priv_gst_parse_template_instantiate (GstParseTemplate *templ, GError **error)
+{
+  GstElement **elements;
+  GstElement *ret;
+  guint i, j;
+
+  elements = g_new0 (GstElement *, templ->elements->len);
+
+  for (i = 0; i < templ->elements->len; i++) {
+    template_element_t *te =
+        &g_array_index (templ->elements, template_element_t, i);
+
+    elements[i] = gst_element_factory_create (te->factory, NULL);
+    if (elements[i] == NULL) {
+      SET_ERROR (error, GST_PARSE_ERROR_NO_SUCH_ELEMENT,
+          _("no element \"%s\""), GST_OBJECT_NAME (te->factory));
+      goto error;
+    }
+    for (j = 0; j < te->props->len; j++) {
+      template_prop_t *prop = &g_array_index (te->props, template_prop_t, j);
+
+      g_object_set_property (G_OBJECT (elements[i]), prop->name,
+          &prop->value);
+    }
+  }
+
+  /* the bins take ownership of their children */
+  for (i = 0; i < templ->elements->len; i++) {
+    template_element_t *te =
+        &g_array_index (templ->elements, template_element_t, i);
+
+    if (te->parent >= 0)
+      gst_bin_add (GST_BIN (elements[te->parent]), elements[i]);
+  }
+
+  for (i = 0; i < templ->links->len; i++) {
+    template_link_t *tl = &g_array_index (templ->links, template_link_t, i);
+    GstElement *src = elements[tl->src], *sink = elements[tl->sink];
+
+    if (!gst_parse_link_pads (src, tl->src_pads, sink, tl->sink_pads,
+            tl->caps)) {
+      SET_ERROR (error, GST_PARSE_ERROR_LINK,
+          _("could not link %s to %s"), GST_ELEMENT_NAME (src),
+          GST_ELEMENT_NAME (sink));
+    }
+  }
+
+  ret = elements[templ->top];
+  g_free (elements);
+
+  return ret;
+
+error:
+  {
+    for (i = 0; i < templ->elements->len; i++) {
+      if (elements[i])
+        gst_object_unref (elements[i]);
+    }
+    g_free (elements);
+    return NULL;
+  }
+}
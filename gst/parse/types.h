@@ -23,6 +23,44 @@ typedef struct {
   reference_t last;
 } chain_t;
 
+/* a recorded property assignment of a template element */
+typedef struct {
+  const gchar *name; /* interned */
+  GValue value;
+} template_prop_t;
+
+typedef struct {
+  GstElementFactory *factory;
+  gint parent; /* index of the parent bin, -1 for the toplevel */
+  GArray *props; /* template_prop_t */
+} template_element_t;
+
+typedef struct {
+  guint src;
+  guint sink;
+  GSList *src_pads;
+  GSList *sink_pads;
+  GstCaps *caps;
+} template_link_t;
+
+struct _GstParseTemplate {
+  gint refcount;
+
+  GstParseFlags flags;
+  /* set when the description uses something that can't be recorded, like
+   * URIs or delayed child properties. It is parsed again for every
+   * instance then */
+  gboolean reparse;
+  gchar *description;
+
+  GArray *elements; /* template_element_t */
+  GArray *links; /* template_link_t */
+  guint top;
+
+  /* GstElement -> index + 1, only used while recording */
+  GHashTable *index;
+};
+
 typedef struct _graph_t graph_t;
 struct _graph_t {
   chain_t *chain; /* links are supposed to be done now */
@@ -30,6 +68,7 @@ struct _graph_t {
   GError **error;
   GstParseContext *ctx; /* may be NULL */
   GstParseFlags flags;
+  GstParseTemplate *templ; /* may be NULL */
 };
 
 
@@ -104,6 +143,10 @@ gst_parse_unescape (gchar *str)
 G_GNUC_INTERNAL GstElement *priv_gst_parse_launch (const gchar      * str,
                                                    GError          ** err,
                                                    GstParseContext  * ctx,
-                                                   GstParseFlags      flags);
+                                                   GstParseFlags      flags,
+                                                   GstParseTemplate * templ);
+
+G_GNUC_INTERNAL GstElement *priv_gst_parse_template_instantiate (GstParseTemplate * templ,
+                                                                 GError          ** err);
 
 #endif /* __GST_PARSE_TYPES_H__ */
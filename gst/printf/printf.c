@@ -157,3 +157,10 @@ __gst_vasprintf (char **result, char const *format, va_list args)
 
   return length;
 }
+
+char *
+__gst_vasnprintf (char *resultbuf, size_t * lengthp, char const *format,
+    va_list args)
+{
+  return vasnprintf (resultbuf, lengthp, format, args);
+}
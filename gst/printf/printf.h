@@ -60,5 +60,11 @@ int __gst_vasprintf (char       **result,
                      char const *format,
                      va_list      args);
 
+/* formats into @resultbuf of *@lengthp bytes if it fits, see vasnprintf() */
+char * __gst_vasnprintf (char        *resultbuf,
+                         size_t      *lengthp,
+                         char const  *format,
+                         va_list      args);
+
 
 #endif /* __GNULIB_PRINTF_H__ */
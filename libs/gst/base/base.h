@@ -28,6 +28,7 @@
 #include <gst/base/gstbasesrc.h>
 #include <gst/base/gstbasetransform.h>
 #include <gst/base/gstbitreader.h>
+#include <gst/base/gstbufferreader.h>
 #include <gst/base/gstbytereader.h>
 #include <gst/base/gstbytewriter.h>
 #include <gst/base/gstcollectpads.h>
@@ -35,6 +36,7 @@
 #include <gst/base/gstflowcombiner.h>
 #include <gst/base/gstpushsrc.h>
 #include <gst/base/gstqueuearray.h>
+#include <gst/base/gstscratcharena.h>
 #include <gst/base/gsttypefindhelper.h>
 
 #endif /* __GST_BASE_H__ */
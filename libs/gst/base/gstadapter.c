@@ -113,6 +113,7 @@
 
 #include <gst/gst_private.h>
 #include "gstadapter.h"
+#include "gstqueuearray.h"
 #include <string.h>
 
 /* default size for the assembled data buffer */
@@ -123,16 +124,28 @@ static void gst_adapter_flush_unchecked (GstAdapter * adapter, gsize flush);
 GST_DEBUG_CATEGORY_STATIC (gst_adapter_debug);
 #define GST_CAT_DEFAULT gst_adapter_debug
 
+/* a pushed buffer and the position of its first byte in all the data that
+ * was pushed since the adapter was created or cleared */
+typedef struct
+{
+  GstBuffer *buffer;
+  guint64 offset;
+} GstAdapterChunk;
+
+#define CHUNK_NTH(adapter,idx) \
+    ((GstAdapterChunk *) gst_queue_array_peek_nth_struct ((adapter)->bufqueue, (idx)))
+#define BUFFER_NTH(adapter,idx) (CHUNK_NTH (adapter, idx)->buffer)
+#define BUFFER_HEAD(adapter) BUFFER_NTH (adapter, 0)
+
 struct _GstAdapter
 {
   GObject object;
 
   /*< private > */
-  GSList *buflist;
-  GSList *buflist_end;
+  GstQueueArray *bufqueue;
+  guint64 tail_offset;
   gsize size;
   gsize skip;
-  guint count;
 
   /* we keep state of assembled pieces */
   gpointer assembled_data;
@@ -144,9 +157,6 @@ struct _GstAdapter
   GstClockTime dts;
   guint64 dts_distance;
 
-  gsize scan_offset;
-  GSList *scan_entry;
-
   GstMapInfo info;
 };
 
@@ -175,6 +185,8 @@ gst_adapter_class_init (GstAdapterClass * klass)
 static void
 gst_adapter_init (GstAdapter * adapter)
 {
+  adapter->bufqueue =
+      gst_queue_array_new_for_struct (sizeof (GstAdapterChunk), 16);
   adapter->assembled_data = g_malloc (DEFAULT_SIZE);
   adapter->assembled_size = DEFAULT_SIZE;
   adapter->pts = GST_CLOCK_TIME_NONE;
@@ -199,6 +211,7 @@ gst_adapter_finalize (GObject * object)
   GstAdapter *adapter = GST_ADAPTER (object);
 
   g_free (adapter->assembled_data);
+  gst_queue_array_free (adapter->bufqueue);
 
   GST_CALL_PARENT (G_OBJECT_CLASS, finalize, (object));
 }
@@ -230,11 +243,12 @@ gst_adapter_clear (GstAdapter * adapter)
   if (adapter->info.memory)
     gst_adapter_unmap (adapter);
 
-  g_slist_foreach (adapter->buflist, (GFunc) gst_mini_object_unref, NULL);
-  g_slist_free (adapter->buflist);
-  adapter->buflist = NULL;
-  adapter->buflist_end = NULL;
-  adapter->count = 0;
+  while (!gst_queue_array_is_empty (adapter->bufqueue)) {
+    GstAdapterChunk *chunk = gst_queue_array_pop_head_struct (adapter->bufqueue);
+
+    gst_buffer_unref (chunk->buffer);
+  }
+  adapter->tail_offset = 0;
   adapter->size = 0;
   adapter->skip = 0;
   adapter->assembled_len = 0;
@@ -242,8 +256,6 @@ gst_adapter_clear (GstAdapter * adapter)
   adapter->pts_distance = 0;
   adapter->dts = GST_CLOCK_TIME_NONE;
   adapter->dts_distance = 0;
-  adapter->scan_offset = 0;
-  adapter->scan_entry = NULL;
 }
 
 static inline void
@@ -265,31 +277,75 @@ update_timestamps (GstAdapter * adapter, GstBuffer * buf)
   }
 }
 
+/* find the buffer that contains the byte @skip bytes after the start of the
+ * head buffer. Returns the index of the buffer and updates @skip to the
+ * position in that buffer. There must be more than @skip bytes in the
+ * buffers. */
+static guint
+find_chunk (GstAdapter * adapter, gsize * skip)
+{
+  guint64 target;
+  guint lo, hi;
+
+  target = CHUNK_NTH (adapter, 0)->offset + *skip;
+
+  /* find the last buffer that starts at or before target, because empty
+   * buffers have the same offset as the next one, this is never an empty
+   * buffer */
+  lo = 0;
+  hi = gst_queue_array_get_length (adapter->bufqueue) - 1;
+  while (lo < hi) {
+    guint mid = lo + (hi - lo + 1) / 2;
+
+    if (CHUNK_NTH (adapter, mid)->offset <= target)
+      lo = mid;
+    else
+      hi = mid - 1;
+  }
+  *skip = target - CHUNK_NTH (adapter, lo)->offset;
+
+  return lo;
+}
+
+/* get the number of buffers that start before @skip bytes after the start of
+ * the head buffer */
+static guint
+find_chunk_before (GstAdapter * adapter, gsize skip)
+{
+  guint64 target;
+  guint lo, hi;
+
+  if (gst_queue_array_is_empty (adapter->bufqueue))
+    return 0;
+
+  target = CHUNK_NTH (adapter, 0)->offset + skip;
+
+  lo = 0;
+  hi = gst_queue_array_get_length (adapter->bufqueue);
+  while (lo < hi) {
+    guint mid = lo + (hi - lo) / 2;
+
+    if (CHUNK_NTH (adapter, mid)->offset < target)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return lo;
+}
+
 /* copy data into @dest, skipping @skip bytes from the head buffers */
 static void
 copy_into_unchecked (GstAdapter * adapter, guint8 * dest, gsize skip,
     gsize size)
 {
-  GSList *g;
+  guint idx;
   GstBuffer *buf;
   gsize bsize, csize;
 
   /* first step, do skipping */
-  /* we might well be copying where we were scanning */
-  if (adapter->scan_entry && (adapter->scan_offset <= skip)) {
-    g = adapter->scan_entry;
-    skip -= adapter->scan_offset;
-  } else {
-    g = adapter->buflist;
-  }
-  buf = g->data;
+  idx = find_chunk (adapter, &skip);
+  buf = BUFFER_NTH (adapter, idx);
   bsize = gst_buffer_get_size (buf);
-  while (G_UNLIKELY (skip >= bsize)) {
-    skip -= bsize;
-    g = g_slist_next (g);
-    buf = g->data;
-    bsize = gst_buffer_get_size (buf);
-  }
   /* copy partial buffer */
   csize = MIN (bsize - skip, size);
   GST_DEBUG ("bsize %" G_GSIZE_FORMAT ", skip %" G_GSIZE_FORMAT ", csize %"
@@ -302,8 +358,7 @@ copy_into_unchecked (GstAdapter * adapter, guint8 * dest, gsize skip,
 
   /* second step, copy remainder */
   while (size > 0) {
-    g = g_slist_next (g);
-    buf = g->data;
+    buf = BUFFER_NTH (adapter, ++idx);
     bsize = gst_buffer_get_size (buf);
     if (G_LIKELY (bsize > 0)) {
       csize = MIN (bsize, size);
@@ -327,6 +382,7 @@ copy_into_unchecked (GstAdapter * adapter, guint8 * dest, gsize skip,
 void
 gst_adapter_push (GstAdapter * adapter, GstBuffer * buf)
 {
+  GstAdapterChunk chunk;
   gsize size;
 
   g_return_if_fail (GST_IS_ADAPTER (adapter));
@@ -336,78 +392,19 @@ gst_adapter_push (GstAdapter * adapter, GstBuffer * buf)
   adapter->size += size;
 
   /* Note: merging buffers at this point is premature. */
-  if (G_UNLIKELY (adapter->buflist == NULL)) {
+  if (G_UNLIKELY (gst_queue_array_is_empty (adapter->bufqueue))) {
     GST_LOG_OBJECT (adapter, "pushing %p first %" G_GSIZE_FORMAT " bytes",
         buf, size);
-    adapter->buflist = adapter->buflist_end = g_slist_append (NULL, buf);
     update_timestamps (adapter, buf);
   } else {
-    /* Otherwise append to the end, and advance our end pointer */
     GST_LOG_OBJECT (adapter, "pushing %p %" G_GSIZE_FORMAT " bytes at end, "
         "size now %" G_GSIZE_FORMAT, buf, size, adapter->size);
-    adapter->buflist_end = g_slist_append (adapter->buflist_end, buf);
-    adapter->buflist_end = g_slist_next (adapter->buflist_end);
-  }
-  ++adapter->count;
-}
-
-#if 0
-/* Internal method only. Tries to merge buffers at the head of the queue
- * to form a single larger buffer of size 'size'.
- *
- * Returns %TRUE if it managed to merge anything.
- */
-static gboolean
-gst_adapter_try_to_merge_up (GstAdapter * adapter, gsize size)
-{
-  GstBuffer *cur, *head;
-  GSList *g;
-  gboolean ret = FALSE;
-  gsize hsize;
-
-  g = adapter->buflist;
-  if (g == NULL)
-    return FALSE;
-
-  head = g->data;
-
-  hsize = gst_buffer_get_size (head);
-
-  /* Remove skipped part from the buffer (otherwise the buffer might grow indefinitely) */
-  head = gst_buffer_make_writable (head);
-  gst_buffer_resize (head, adapter->skip, hsize - adapter->skip);
-  hsize -= adapter->skip;
-  adapter->skip = 0;
-  g->data = head;
-
-  g = g_slist_next (g);
-
-  while (g != NULL && hsize < size) {
-    cur = g->data;
-    /* Merge the head buffer and the next in line */
-    GST_LOG_OBJECT (adapter, "Merging buffers of size %" G_GSIZE_FORMAT " & %"
-        G_GSIZE_FORMAT " in search of target %" G_GSIZE_FORMAT,
-        hsize, gst_buffer_get_size (cur), size);
-
-    head = gst_buffer_append (head, cur);
-    hsize = gst_buffer_get_size (head);
-    ret = TRUE;
-
-    /* Delete the front list item, and store our new buffer in the 2nd list
-     * item */
-    adapter->buflist = g_slist_delete_link (adapter->buflist, adapter->buflist);
-    g->data = head;
-
-    /* invalidate scan position */
-    adapter->scan_offset = 0;
-    adapter->scan_entry = NULL;
-
-    g = g_slist_next (g);
   }
-
-  return ret;
+  chunk.buffer = buf;
+  chunk.offset = adapter->tail_offset;
+  adapter->tail_offset += size;
+  gst_queue_array_push_tail_struct (adapter->bufqueue, &chunk);
 }
-#endif
 
 /**
  * gst_adapter_map:
@@ -455,24 +452,16 @@ gst_adapter_map (GstAdapter * adapter, gsize size)
   if (adapter->assembled_len >= size)
     return adapter->assembled_data;
 
-#if 0
-  do {
-#endif
-    cur = adapter->buflist->data;
-    skip = adapter->skip;
+  cur = BUFFER_HEAD (adapter);
+  skip = adapter->skip;
 
-    csize = gst_buffer_get_size (cur);
-    if (csize >= size + skip) {
-      if (!gst_buffer_map (cur, &adapter->info, GST_MAP_READ))
-        return FALSE;
+  csize = gst_buffer_get_size (cur);
+  if (csize >= size + skip) {
+    if (!gst_buffer_map (cur, &adapter->info, GST_MAP_READ))
+      return FALSE;
 
-      return (guint8 *) adapter->info.data + skip;
-    }
-    /* We may be able to efficiently merge buffers in our pool to
-     * gather a big enough chunk to return it from the head buffer directly */
-#if 0
-  } while (gst_adapter_try_to_merge_up (adapter, size));
-#endif
+    return (guint8 *) adapter->info.data + skip;
+  }
 
   /* see how much data we can reuse from the assembled memory and how much
    * we need to copy */
@@ -519,7 +508,7 @@ gst_adapter_unmap (GstAdapter * adapter)
   g_return_if_fail (GST_IS_ADAPTER (adapter));
 
   if (adapter->info.memory) {
-    GstBuffer *cur = adapter->buflist->data;
+    GstBuffer *cur = BUFFER_HEAD (adapter);
     GST_LOG_OBJECT (adapter, "unmap memory buffer %p", cur);
     gst_buffer_unmap (cur, &adapter->info);
     adapter->info.memory = NULL;
@@ -579,9 +568,9 @@ gst_adapter_copy_bytes (GstAdapter * adapter, gsize offset, gsize size)
 static void
 gst_adapter_flush_unchecked (GstAdapter * adapter, gsize flush)
 {
+  GstAdapterChunk *chunk;
   GstBuffer *cur;
   gsize size;
-  GSList *g;
 
   GST_LOG_OBJECT (adapter, "flushing %" G_GSIZE_FORMAT " bytes", flush);
 
@@ -598,8 +587,7 @@ gst_adapter_flush_unchecked (GstAdapter * adapter, gsize flush)
   adapter->pts_distance -= adapter->skip;
   adapter->dts_distance -= adapter->skip;
 
-  g = adapter->buflist;
-  cur = g->data;
+  cur = BUFFER_HEAD (adapter);
   size = gst_buffer_get_size (cur);
   while (flush >= size) {
     /* can skip whole buffer */
@@ -608,28 +596,22 @@ gst_adapter_flush_unchecked (GstAdapter * adapter, gsize flush)
     adapter->dts_distance += size;
     flush -= size;
 
-    gst_buffer_unref (cur);
-    g = g_slist_delete_link (g, g);
-    --adapter->count;
+    chunk = gst_queue_array_pop_head_struct (adapter->bufqueue);
+    gst_buffer_unref (chunk->buffer);
 
-    if (G_UNLIKELY (g == NULL)) {
+    if (G_UNLIKELY (gst_queue_array_is_empty (adapter->bufqueue))) {
       GST_LOG_OBJECT (adapter, "adapter empty now");
-      adapter->buflist_end = NULL;
       break;
     }
     /* there is a new head buffer, update the timestamps */
-    cur = g->data;
+    cur = BUFFER_HEAD (adapter);
     update_timestamps (adapter, cur);
     size = gst_buffer_get_size (cur);
   }
-  adapter->buflist = g;
   /* account for the remaining bytes */
   adapter->skip = flush;
   adapter->pts_distance += flush;
   adapter->dts_distance += flush;
-  /* invalidate scan position */
-  adapter->scan_offset = 0;
-  adapter->scan_entry = NULL;
 }
 
 /**
@@ -759,7 +741,7 @@ gst_adapter_get_buffer_fast (GstAdapter * adapter, gsize nbytes)
 {
   GstBuffer *buffer = NULL;
   GstBuffer *cur;
-  GSList *item;
+  guint idx;
   gsize skip;
   gsize left = nbytes;
 
@@ -776,7 +758,7 @@ gst_adapter_get_buffer_fast (GstAdapter * adapter, gsize nbytes)
     return NULL;
 
   skip = adapter->skip;
-  cur = adapter->buflist->data;
+  cur = BUFFER_HEAD (adapter);
 
   if (skip == 0 && gst_buffer_get_size (cur) == nbytes) {
     GST_LOG_OBJECT (adapter, "providing buffer of %" G_GSIZE_FORMAT " bytes"
@@ -785,10 +767,10 @@ gst_adapter_get_buffer_fast (GstAdapter * adapter, gsize nbytes)
     goto done;
   }
 
-  for (item = adapter->buflist; item && left > 0; item = item->next) {
+  for (idx = 0; left > 0; idx++) {
     gsize size, cur_size;
 
-    cur = item->data;
+    cur = BUFFER_NTH (adapter, idx);
     cur_size = gst_buffer_get_size (cur);
     size = MIN (cur_size - skip, left);
 
@@ -925,7 +907,7 @@ gst_adapter_get_buffer (GstAdapter * adapter, gsize nbytes)
   if (G_UNLIKELY (nbytes > adapter->size))
     return NULL;
 
-  cur = adapter->buflist->data;
+  cur = BUFFER_HEAD (adapter);
   skip = adapter->skip;
   hsize = gst_buffer_get_size (cur);
 
@@ -941,37 +923,20 @@ gst_adapter_get_buffer (GstAdapter * adapter, gsize nbytes)
     buffer = gst_buffer_copy_region (cur, GST_BUFFER_COPY_ALL, skip, nbytes);
     goto done;
   }
-#if 0
-  if (gst_adapter_try_to_merge_up (adapter, nbytes)) {
-    /* Merged something, let's try again for sub-buffering */
-    cur = adapter->buflist->data;
-    skip = adapter->skip;
-    if (gst_buffer_get_size (cur) >= nbytes + skip) {
-      GST_LOG_OBJECT (adapter, "providing buffer of %" G_GSIZE_FORMAT " bytes"
-          " via sub-buffer", nbytes);
-      buffer = gst_buffer_copy_region (cur, GST_BUFFER_COPY_ALL, skip, nbytes);
-      goto done;
-    }
-  }
-#endif
-
   data = gst_adapter_get_internal (adapter, nbytes);
 
   buffer = gst_buffer_new_wrapped (data, nbytes);
 
   {
-    GSList *g;
     GstBuffer *cur;
     gsize read_offset = 0;
+    guint idx = 0;
 
-    g = adapter->buflist;
-    while (g && read_offset < nbytes + adapter->skip) {
-      cur = g->data;
+    while (read_offset < nbytes + adapter->skip) {
+      cur = BUFFER_NTH (adapter, idx++);
 
       gst_buffer_foreach_meta (cur, foreach_metadata, buffer);
       read_offset += gst_buffer_get_size (cur);
-
-      g = g_slist_next (g);
     }
   }
 
@@ -1054,7 +1019,7 @@ gst_adapter_take_list (GstAdapter * adapter, gsize nbytes)
   GST_LOG_OBJECT (adapter, "taking %" G_GSIZE_FORMAT " bytes", nbytes);
 
   while (nbytes > 0) {
-    cur = adapter->buflist->data;
+    cur = BUFFER_HEAD (adapter);
     skip = adapter->skip;
     cur_size = gst_buffer_get_size (cur);
     hsize = MIN (nbytes, cur_size - skip);
@@ -1092,18 +1057,17 @@ gst_adapter_get_list (GstAdapter * adapter, gsize nbytes)
   GQueue queue = G_QUEUE_INIT;
   GstBuffer *cur, *buffer;
   gsize hsize, skip, cur_size;
-  GSList *g = NULL;
+  guint idx = 0;
 
   g_return_val_if_fail (GST_IS_ADAPTER (adapter), NULL);
   g_return_val_if_fail (nbytes <= adapter->size, NULL);
 
   GST_LOG_OBJECT (adapter, "getting %" G_GSIZE_FORMAT " bytes", nbytes);
 
-  g = adapter->buflist;
   skip = adapter->skip;
 
   while (nbytes > 0) {
-    cur = g->data;
+    cur = BUFFER_NTH (adapter, idx++);
     cur_size = gst_buffer_get_size (cur);
     hsize = MIN (nbytes, cur_size - skip);
 
@@ -1121,7 +1085,6 @@ gst_adapter_get_list (GstAdapter * adapter, gsize nbytes)
 
     nbytes -= hsize;
     skip = 0;
-    g = g_slist_next (g);
   }
 
   return queue.head;
@@ -1152,7 +1115,7 @@ gst_adapter_take_buffer_list (GstAdapter * adapter, gsize nbytes)
   GstBufferList *buffer_list;
   GstBuffer *cur;
   gsize hsize, skip, cur_size;
-  guint n_bufs;
+  guint n_bufs, count;
 
   g_return_val_if_fail (GST_IS_ADAPTER (adapter), NULL);
 
@@ -1162,15 +1125,16 @@ gst_adapter_take_buffer_list (GstAdapter * adapter, gsize nbytes)
   GST_LOG_OBJECT (adapter, "taking %" G_GSIZE_FORMAT " bytes", nbytes);
 
   /* try to create buffer list with sufficient size, so no resize is done later */
-  if (adapter->count < 64)
-    n_bufs = adapter->count;
+  count = gst_queue_array_get_length (adapter->bufqueue);
+  if (count < 64)
+    n_bufs = count;
   else
-    n_bufs = (adapter->count * nbytes * 1.2 / adapter->size) + 1;
+    n_bufs = (count * nbytes * 1.2 / adapter->size) + 1;
 
   buffer_list = gst_buffer_list_new_sized (n_bufs);
 
   while (nbytes > 0) {
-    cur = adapter->buflist->data;
+    cur = BUFFER_HEAD (adapter);
     skip = adapter->skip;
     cur_size = gst_buffer_get_size (cur);
     hsize = MIN (nbytes, cur_size - skip);
@@ -1205,8 +1169,8 @@ gst_adapter_get_buffer_list (GstAdapter * adapter, gsize nbytes)
   GstBufferList *buffer_list;
   GstBuffer *cur, *buffer;
   gsize hsize, skip, cur_size;
-  guint n_bufs;
-  GSList *g = NULL;
+  guint n_bufs, count;
+  guint idx = 0;
 
   g_return_val_if_fail (GST_IS_ADAPTER (adapter), NULL);
 
@@ -1216,18 +1180,18 @@ gst_adapter_get_buffer_list (GstAdapter * adapter, gsize nbytes)
   GST_LOG_OBJECT (adapter, "getting %" G_GSIZE_FORMAT " bytes", nbytes);
 
   /* try to create buffer list with sufficient size, so no resize is done later */
-  if (adapter->count < 64)
-    n_bufs = adapter->count;
+  count = gst_queue_array_get_length (adapter->bufqueue);
+  if (count < 64)
+    n_bufs = count;
   else
-    n_bufs = (adapter->count * nbytes * 1.2 / adapter->size) + 1;
+    n_bufs = (count * nbytes * 1.2 / adapter->size) + 1;
 
   buffer_list = gst_buffer_list_new_sized (n_bufs);
 
-  g = adapter->buflist;
   skip = adapter->skip;
 
   while (nbytes > 0) {
-    cur = g->data;
+    cur = BUFFER_NTH (adapter, idx++);
     cur_size = gst_buffer_get_size (cur);
     hsize = MIN (nbytes, cur_size - skip);
 
@@ -1245,7 +1209,6 @@ gst_adapter_get_buffer_list (GstAdapter * adapter, gsize nbytes)
 
     nbytes -= hsize;
     skip = 0;
-    g = g_slist_next (g);
   }
 
   return buffer_list;
@@ -1284,8 +1247,7 @@ gsize
 gst_adapter_available_fast (GstAdapter * adapter)
 {
   GstBuffer *cur;
-  gsize size;
-  GSList *g;
+  gsize skip;
 
   g_return_val_if_fail (GST_IS_ADAPTER (adapter), 0);
 
@@ -1298,17 +1260,11 @@ gst_adapter_available_fast (GstAdapter * adapter)
     return adapter->assembled_len;
 
   /* take the first non-zero buffer */
-  g = adapter->buflist;
-  while (TRUE) {
-    cur = g->data;
-    size = gst_buffer_get_size (cur);
-    if (size != 0)
-      break;
-    g = g_slist_next (g);
-  }
+  skip = adapter->skip;
+  cur = BUFFER_NTH (adapter, find_chunk (adapter, &skip));
 
   /* we can quickly get the (remaining) data of the first buffer */
-  return size - adapter->skip;
+  return gst_buffer_get_size (cur) - skip;
 }
 
 /**
@@ -1387,24 +1343,20 @@ GstClockTime
 gst_adapter_prev_pts_at_offset (GstAdapter * adapter, gsize offset,
     guint64 * distance)
 {
-  GstBuffer *cur;
-  GSList *g;
-  gsize read_offset = 0;
   GstClockTime pts = adapter->pts;
+  guint idx;
 
   g_return_val_if_fail (GST_IS_ADAPTER (adapter), GST_CLOCK_TIME_NONE);
 
-  g = adapter->buflist;
-
-  while (g && read_offset < offset + adapter->skip) {
-    cur = g->data;
+  /* take the last valid pts of the buffers that start before offset */
+  idx = find_chunk_before (adapter, offset + adapter->skip);
+  while (idx > 0) {
+    GstBuffer *cur = BUFFER_NTH (adapter, --idx);
 
-    read_offset += gst_buffer_get_size (cur);
     if (GST_CLOCK_TIME_IS_VALID (GST_BUFFER_PTS (cur))) {
       pts = GST_BUFFER_PTS (cur);
+      break;
     }
-
-    g = g_slist_next (g);
   }
 
   if (distance)
@@ -1435,24 +1387,20 @@ GstClockTime
 gst_adapter_prev_dts_at_offset (GstAdapter * adapter, gsize offset,
     guint64 * distance)
 {
-  GstBuffer *cur;
-  GSList *g;
-  gsize read_offset = 0;
   GstClockTime dts = adapter->dts;
+  guint idx;
 
   g_return_val_if_fail (GST_IS_ADAPTER (adapter), GST_CLOCK_TIME_NONE);
 
-  g = adapter->buflist;
+  /* take the last valid dts of the buffers that start before offset */
+  idx = find_chunk_before (adapter, offset + adapter->skip);
+  while (idx > 0) {
+    GstBuffer *cur = BUFFER_NTH (adapter, --idx);
 
-  while (g && read_offset < offset + adapter->skip) {
-    cur = g->data;
-
-    read_offset += gst_buffer_get_size (cur);
     if (GST_CLOCK_TIME_IS_VALID (GST_BUFFER_DTS (cur))) {
       dts = GST_BUFFER_DTS (cur);
+      break;
     }
-
-    g = g_slist_next (g);
   }
 
   if (distance)
@@ -1461,6 +1409,11 @@ gst_adapter_prev_dts_at_offset (GstAdapter * adapter, gsize offset,
   return dts;
 }
 
+/* check if one of the 8 bytes in @v is 0 */
+#define HAS_ZERO_BYTE(v) \
+    ((((v) - G_GUINT64_CONSTANT (0x0101010101010101)) & ~(v) & \
+        G_GUINT64_CONSTANT (0x8080808080808080)) != 0)
+
 /**
  * gst_adapter_masked_scan_uint32_peek:
  * @adapter: a #GstAdapter
@@ -1488,12 +1441,13 @@ gssize
 gst_adapter_masked_scan_uint32_peek (GstAdapter * adapter, guint32 mask,
     guint32 pattern, gsize offset, gsize size, guint32 * value)
 {
-  GSList *g;
+  guint idx;
   gsize skip, bsize, i;
   guint32 state;
   GstMapInfo info;
   guint8 *bdata;
   GstBuffer *buf;
+  gboolean start_code;
 
   g_return_val_if_fail (size > 0, -1);
   g_return_val_if_fail (offset + size <= adapter->size, -1);
@@ -1506,25 +1460,8 @@ gst_adapter_masked_scan_uint32_peek (GstAdapter * adapter, guint32 mask,
   skip = offset + adapter->skip;
 
   /* first step, do skipping and position on the first buffer */
-  /* optimistically assume scanning continues sequentially */
-  if (adapter->scan_entry && (adapter->scan_offset <= skip)) {
-    g = adapter->scan_entry;
-    skip -= adapter->scan_offset;
-  } else {
-    g = adapter->buflist;
-    adapter->scan_offset = 0;
-    adapter->scan_entry = NULL;
-  }
-  buf = g->data;
-  bsize = gst_buffer_get_size (buf);
-  while (G_UNLIKELY (skip >= bsize)) {
-    skip -= bsize;
-    g = g_slist_next (g);
-    adapter->scan_offset += bsize;
-    adapter->scan_entry = g;
-    buf = g->data;
-    bsize = gst_buffer_get_size (buf);
-  }
+  idx = find_chunk (adapter, &skip);
+  buf = BUFFER_NTH (adapter, idx);
   /* get the data now */
   if (!gst_buffer_map (buf, &info, GST_MAP_READ))
     return -1;
@@ -1536,10 +1473,25 @@ gst_adapter_masked_scan_uint32_peek (GstAdapter * adapter, guint32 mask,
   /* set the state to something that does not match */
   state = ~pattern;
 
+  /* special case for the MPEG and H264 start code */
+  start_code = (pattern == 0x00000100) && (mask == 0xffffff00);
+
   /* now find data */
   do {
     bsize = MIN (bsize, size);
     for (i = 0; i < bsize; i++) {
+      /* no start code can end in the next 8 bytes when the last 2 bytes and
+       * the next 8 bytes are not 0, skip them a word at a time */
+      if (start_code && (state & 0xff) && (state & 0xff00) && i + 8 <= bsize) {
+        guint64 v;
+
+        memcpy (&v, bdata + i, sizeof (v));
+        if (!HAS_ZERO_BYTE (v)) {
+          state = GST_READ_UINT32_BE (bdata + i + 4);
+          i += 7;
+          continue;
+        }
+      }
       state = ((state << 8) | bdata[i]);
       if (G_UNLIKELY ((state & mask) == pattern)) {
         /* we have a match but we need to have skipped at
@@ -1558,11 +1510,8 @@ gst_adapter_masked_scan_uint32_peek (GstAdapter * adapter, guint32 mask,
 
     /* nothing found yet, go to next buffer */
     skip += bsize;
-    g = g_slist_next (g);
-    adapter->scan_offset += info.size;
-    adapter->scan_entry = g;
     gst_buffer_unmap (buf, &info);
-    buf = g->data;
+    buf = BUFFER_NTH (adapter, ++idx);
 
     if (!gst_buffer_map (buf, &info, GST_MAP_READ))
       return -1;
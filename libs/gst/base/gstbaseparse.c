@@ -205,9 +205,12 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include <glib/gstdio.h>
+
 #include <gst/base/gstadapter.h>
 
 #include "gstbaseparse.h"
+#include "gstscratcharena.h"
 
 /* FIXME: get rid of old GstIndex code */
 #include "gstindex.h"
@@ -219,6 +222,16 @@
 #define MIN_FRAMES_TO_POST_BITRATE 10
 #define TARGET_DIFFERENCE          (20 * GST_SECOND)
 #define MAX_INDEX_ENTRIES          4096
+/* the index scan looks at one position every INDEX_SCAN_PERIOD frames and
+ * at least INDEX_SCAN_MIN_STEP bytes apart */
+#define INDEX_SCAN_PERIOD          4
+#define INDEX_SCAN_MIN_STEP        (64 * 1024)
+
+/* persistent index file: a header of 5 little endian 64 bits words (magic,
+ * upstream size, mtime, duration, number of entries) followed by the
+ * (timestamp, offset) pairs of the keyframe entries, sorted on time */
+#define INDEX_FILE_MAGIC           "GSTBPIX1"
+#define INDEX_FILE_HEADER_WORDS    5
 #define UPDATE_THRESHOLD           2
 
 #define ABSDIFF(a,b) (((a) > (b)) ? ((a) - (b)) : ((b) - (a)))
@@ -262,6 +275,11 @@ struct _GstBaseParsePrivate
   GstClockTime lead_in_ts, lead_out_ts;
   GstClockTime min_latency, max_latency;
 
+  /* output batching, with STREAM_LOCK */
+  GstClockTime batch_latency;   /* with LOCK */
+  GstBufferList *batch;
+  GstClockTime batch_start;
+
   gboolean discont;
   gboolean flushing;
   gboolean drain;
@@ -320,6 +338,21 @@ struct _GstBaseParsePrivate
   gint64 index_last_offset;
   gboolean index_last_valid;
 
+  /* persistent index, see the index-cache-dir property */
+  gchar *index_cache_dir;       /* with LOCK */
+  gchar *index_path;
+  gint64 index_mtime;
+  GMappedFile *index_file;
+  const guint64 *index_table;
+  guint64 index_table_len;
+  GArray *index_entries;
+
+  /* index scan, see the scan-index property */
+  gboolean scan_index;          /* with LOCK */
+  gint64 index_scan_offset;
+  guint index_scan_count;
+  gboolean index_scan_done;
+
   /* timestamps currently produced are accurate, e.g. started from 0 onwards */
   gboolean exact_position;
   /* seek events are temporarily kept to match them with newsegments */
@@ -369,6 +402,8 @@ struct _GstBaseParsePrivate
   GstTagList *upstream_tags;
   GstTagList *parser_tags;
   GstTagMergeMode parser_tags_merge_mode;
+  /* the last tags we queued, reused as long as only the bitrates change */
+  GstTagList *merged_tags;
   gboolean tags_changed;
 };
 
@@ -381,11 +416,17 @@ typedef struct _GstBaseParseSeek
 } GstBaseParseSeek;
 
 #define DEFAULT_DISABLE_PASSTHROUGH        FALSE
+#define DEFAULT_BATCH_LATENCY              0
+#define DEFAULT_INDEX_CACHE_DIR            NULL
+#define DEFAULT_SCAN_INDEX                 FALSE
 
 enum
 {
   PROP_0,
   PROP_DISABLE_PASSTHROUGH,
+  PROP_BATCH_LATENCY,
+  PROP_INDEX_CACHE_DIR,
+  PROP_SCAN_INDEX,
   PROP_LAST
 };
 
@@ -463,7 +504,10 @@ static gboolean gst_base_parse_sink_query (GstPad * pad, GstObject * parent,
 
 static GstFlowReturn gst_base_parse_chain (GstPad * pad, GstObject * parent,
     GstBuffer * buffer);
+static GstFlowReturn gst_base_parse_sink_chain (GstPad * pad,
+    GstObject * parent, GstBuffer * buffer);
 static void gst_base_parse_loop (GstPad * pad);
+static void gst_base_parse_task_func (GstPad * pad);
 
 static GstFlowReturn gst_base_parse_parse_frame (GstBaseParse * parse,
     GstBaseParseFrame * frame);
@@ -494,8 +538,11 @@ static GstFlowReturn gst_base_parse_send_buffers (GstBaseParse * parse);
 static inline GstFlowReturn gst_base_parse_check_sync (GstBaseParse * parse);
 
 static gboolean gst_base_parse_is_seekable (GstBaseParse * parse);
+static void gst_base_parse_clear_persistent_index (GstBaseParse * parse);
+static void gst_base_parse_scan_index_step (GstBaseParse * parse);
 
 static void gst_base_parse_push_pending_events (GstBaseParse * parse);
+static GstFlowReturn gst_base_parse_push_batch (GstBaseParse * parse);
 
 static void
 gst_base_parse_clear_queues (GstBaseParse * parse)
@@ -529,6 +576,11 @@ gst_base_parse_clear_queues (GstBaseParse * parse)
   g_list_free (parse->priv->pending_events);
   parse->priv->pending_events = NULL;
 
+  if (parse->priv->batch) {
+    gst_buffer_list_unref (parse->priv->batch);
+    parse->priv->batch = NULL;
+  }
+
   parse->priv->checked_media = FALSE;
 }
 
@@ -544,6 +596,8 @@ gst_base_parse_finalize (GObject * object)
     parse->priv->index = NULL;
   }
   g_mutex_clear (&parse->priv->index_lock);
+  g_free (parse->priv->index_cache_dir);
+  gst_base_parse_clear_persistent_index (parse);
 
   gst_base_parse_clear_queues (parse);
 
@@ -580,6 +634,61 @@ gst_base_parse_class_init (GstBaseParseClass * klass)
           DEFAULT_DISABLE_PASSTHROUGH,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstBaseParse:batch-latency:
+   *
+   * Maximum duration of output frames to collect into a #GstBufferList
+   * before pushing them downstream. This reduces the per-buffer overhead
+   * for parsers that output many small frames, at the cost of the
+   * configured amount of extra latency. Frames without timestamps and
+   * serialized events cause the collected frames to be pushed right away.
+   * 0 pushes every frame on its own.
+   *
+   * Since: 1.10
+   */
+  g_object_class_install_property (gobject_class, PROP_BATCH_LATENCY,
+      g_param_spec_uint64 ("batch-latency", "Batch latency",
+          "Maximum duration of frames to collect before pushing them as "
+          "a list (0 = push every frame)", 0, G_MAXUINT64,
+          DEFAULT_BATCH_LATENCY, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstBaseParse:index-cache-dir:
+   *
+   * Directory where the seek index of a stream is saved after it was
+   * parsed completely, and loaded from the next time the same stream is
+   * opened. Streams are identified by their upstream URI, their size and,
+   * for local files, their modification time. %NULL disables the
+   * persistent index.
+   *
+   * Since: 1.10
+   */
+  g_object_class_install_property (gobject_class, PROP_INDEX_CACHE_DIR,
+      g_param_spec_string ("index-cache-dir", "Index cache directory",
+          "Directory to save and load persistent seek indexes in "
+          "(NULL = disabled)", DEFAULT_INDEX_CACHE_DIR,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstBaseParse:scan-index:
+   *
+   * In pull mode, fill the seek index ahead of playback by looking up a
+   * frame at regular positions through the rest of the stream. The scan
+   * is done in small steps between the frames of normal playback. Later
+   * seeks can then use the index instead of searching the stream. Once
+   * the whole stream is scanned, the index is also saved as persistent
+   * index, see #GstBaseParse:index-cache-dir.
+   *
+   * This only works for parsers whose frames carry their own timestamps,
+   * see gst_base_parse_set_has_timing_info().
+   *
+   * Since: 1.10
+   */
+  g_object_class_install_property (gobject_class, PROP_SCAN_INDEX,
+      g_param_spec_boolean ("scan-index", "Scan index",
+          "Fill the seek index by scanning ahead in pull mode",
+          DEFAULT_SCAN_INDEX, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gstelement_class = (GstElementClass *) klass;
   gstelement_class->change_state =
       GST_DEBUG_FUNCPTR (gst_base_parse_change_state);
@@ -618,7 +727,7 @@ gst_base_parse_init (GstBaseParse * parse, GstBaseParseClass * bclass)
   gst_pad_set_query_function (parse->sinkpad,
       GST_DEBUG_FUNCPTR (gst_base_parse_sink_query));
   gst_pad_set_chain_function (parse->sinkpad,
-      GST_DEBUG_FUNCPTR (gst_base_parse_chain));
+      GST_DEBUG_FUNCPTR (gst_base_parse_sink_chain));
   gst_pad_set_activate_function (parse->sinkpad,
       GST_DEBUG_FUNCPTR (gst_base_parse_sink_activate));
   gst_pad_set_activatemode_function (parse->sinkpad,
@@ -656,6 +765,7 @@ gst_base_parse_init (GstBaseParse * parse, GstBaseParseClass * bclass)
 
   parse->priv->upstream_tags = NULL;
   parse->priv->parser_tags = NULL;
+  parse->priv->merged_tags = NULL;
   parse->priv->parser_tags_merge_mode = GST_TAG_MERGE_APPEND;
 }
 
@@ -669,6 +779,24 @@ gst_base_parse_set_property (GObject * object, guint prop_id,
     case PROP_DISABLE_PASSTHROUGH:
       parse->priv->disable_passthrough = g_value_get_boolean (value);
       break;
+    case PROP_INDEX_CACHE_DIR:
+      GST_OBJECT_LOCK (parse);
+      g_free (parse->priv->index_cache_dir);
+      parse->priv->index_cache_dir = g_value_dup_string (value);
+      GST_OBJECT_UNLOCK (parse);
+      break;
+    case PROP_SCAN_INDEX:
+      GST_OBJECT_LOCK (parse);
+      parse->priv->scan_index = g_value_get_boolean (value);
+      GST_OBJECT_UNLOCK (parse);
+      break;
+    case PROP_BATCH_LATENCY:
+      GST_OBJECT_LOCK (parse);
+      parse->priv->batch_latency = g_value_get_uint64 (value);
+      GST_OBJECT_UNLOCK (parse);
+      gst_element_post_message (GST_ELEMENT_CAST (parse),
+          gst_message_new_latency (GST_OBJECT_CAST (parse)));
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -685,6 +813,21 @@ gst_base_parse_get_property (GObject * object, guint prop_id, GValue * value,
     case PROP_DISABLE_PASSTHROUGH:
       g_value_set_boolean (value, parse->priv->disable_passthrough);
       break;
+    case PROP_BATCH_LATENCY:
+      GST_OBJECT_LOCK (parse);
+      g_value_set_uint64 (value, parse->priv->batch_latency);
+      GST_OBJECT_UNLOCK (parse);
+      break;
+    case PROP_INDEX_CACHE_DIR:
+      GST_OBJECT_LOCK (parse);
+      g_value_set_string (value, parse->priv->index_cache_dir);
+      GST_OBJECT_UNLOCK (parse);
+      break;
+    case PROP_SCAN_INDEX:
+      GST_OBJECT_LOCK (parse);
+      g_value_set_boolean (value, parse->priv->scan_index);
+      GST_OBJECT_UNLOCK (parse);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -804,6 +947,15 @@ gst_base_parse_update_frame (GstBaseParse * parse, GstBaseParseFrame * frame)
   frame->offset = parse->priv->prev_offset = parse->priv->offset;
 }
 
+static void
+gst_base_parse_clear_merged_tags (GstBaseParse * parse)
+{
+  if (parse->priv->merged_tags) {
+    gst_tag_list_unref (parse->priv->merged_tags);
+    parse->priv->merged_tags = NULL;
+  }
+}
+
 static void
 gst_base_parse_reset (GstBaseParse * parse)
 {
@@ -846,6 +998,10 @@ gst_base_parse_reset (GstBaseParse * parse)
   parse->priv->index_last_ts = GST_CLOCK_TIME_NONE;
   parse->priv->index_last_offset = -1;
   parse->priv->index_last_valid = TRUE;
+  gst_base_parse_clear_persistent_index (parse);
+  parse->priv->index_scan_offset = -1;
+  parse->priv->index_scan_count = 0;
+  parse->priv->index_scan_done = FALSE;
   parse->priv->upstream_seekable = FALSE;
   parse->priv->upstream_size = 0;
   parse->priv->upstream_has_duration = FALSE;
@@ -862,6 +1018,11 @@ gst_base_parse_reset (GstBaseParse * parse)
 
   parse->priv->skip = 0;
 
+  if (parse->priv->batch) {
+    gst_buffer_list_unref (parse->priv->batch);
+    parse->priv->batch = NULL;
+  }
+
   g_list_foreach (parse->priv->pending_events, (GFunc) gst_mini_object_unref,
       NULL);
   g_list_free (parse->priv->pending_events);
@@ -886,6 +1047,7 @@ gst_base_parse_reset (GstBaseParse * parse)
     parse->priv->parser_tags = NULL;
   }
   parse->priv->parser_tags_merge_mode = GST_TAG_MERGE_APPEND;
+  gst_base_parse_clear_merged_tags (parse);
 
   parse->priv->new_frame = TRUE;
 
@@ -923,6 +1085,9 @@ gst_base_parse_check_bitrate_tags (GstBaseParse * parse)
       !gst_base_parse_check_bitrate_tag (parse, GST_TAG_BITRATE);
   parse->priv->post_max_bitrate =
       !gst_base_parse_check_bitrate_tag (parse, GST_TAG_MAXIMUM_BITRATE);
+
+  /* called whenever the upstream or subclass tags change */
+  gst_base_parse_clear_merged_tags (parse);
 }
 
 /* Queues new tag event with the current combined state of the stream tags
@@ -938,39 +1103,49 @@ gst_base_parse_queue_tag_event_update (GstBaseParse * parse)
       parse->priv->parser_tags);
   GST_LOG_OBJECT (parse, "mode     : %d", parse->priv->parser_tags_merge_mode);
 
-  merged_tags =
-      gst_tag_list_merge (parse->priv->upstream_tags, parse->priv->parser_tags,
-      parse->priv->parser_tags_merge_mode);
+  if (parse->priv->merged_tags) {
+    /* only the bitrates changed since the last update, so update those in
+     * the previous list instead of merging everything again. This only
+     * copies the list if the previous tag event is still around. */
+    merged_tags = gst_tag_list_make_writable (parse->priv->merged_tags);
+    parse->priv->merged_tags = NULL;
+  } else {
+    merged_tags =
+        gst_tag_list_merge (parse->priv->upstream_tags,
+        parse->priv->parser_tags, parse->priv->parser_tags_merge_mode);
 
-  GST_DEBUG_OBJECT (parse, "merged   : %" GST_PTR_FORMAT, merged_tags);
+    GST_DEBUG_OBJECT (parse, "merged   : %" GST_PTR_FORMAT, merged_tags);
 
-  if (merged_tags == NULL)
-    return;
+    if (merged_tags == NULL)
+      return;
 
-  if (gst_tag_list_is_empty (merged_tags)) {
-    gst_tag_list_unref (merged_tags);
-    return;
+    if (gst_tag_list_is_empty (merged_tags)) {
+      gst_tag_list_unref (merged_tags);
+      return;
+    }
   }
 
   /* only add bitrate tags to non-empty taglists for now, and only if neither
-   * upstream tags nor the subclass sets the bitrate tag in question already */
+   * upstream tags nor the subclass sets the bitrate tag in question already,
+   * so replacing only ever replaces our own previous value */
   if (parse->priv->min_bitrate != G_MAXUINT && parse->priv->post_min_bitrate) {
     GST_LOG_OBJECT (parse, "adding min bitrate %u", parse->priv->min_bitrate);
-    gst_tag_list_add (merged_tags, GST_TAG_MERGE_KEEP, GST_TAG_MINIMUM_BITRATE,
-        parse->priv->min_bitrate, NULL);
+    gst_tag_list_add (merged_tags, GST_TAG_MERGE_REPLACE,
+        GST_TAG_MINIMUM_BITRATE, parse->priv->min_bitrate, NULL);
   }
   if (parse->priv->max_bitrate != 0 && parse->priv->post_max_bitrate) {
     GST_LOG_OBJECT (parse, "adding max bitrate %u", parse->priv->max_bitrate);
-    gst_tag_list_add (merged_tags, GST_TAG_MERGE_KEEP, GST_TAG_MAXIMUM_BITRATE,
-        parse->priv->max_bitrate, NULL);
+    gst_tag_list_add (merged_tags, GST_TAG_MERGE_REPLACE,
+        GST_TAG_MAXIMUM_BITRATE, parse->priv->max_bitrate, NULL);
   }
   if (parse->priv->avg_bitrate != 0 && parse->priv->post_avg_bitrate) {
     parse->priv->posted_avg_bitrate = parse->priv->avg_bitrate;
     GST_LOG_OBJECT (parse, "adding avg bitrate %u", parse->priv->avg_bitrate);
-    gst_tag_list_add (merged_tags, GST_TAG_MERGE_KEEP, GST_TAG_BITRATE,
+    gst_tag_list_add (merged_tags, GST_TAG_MERGE_REPLACE, GST_TAG_BITRATE,
         parse->priv->avg_bitrate, NULL);
   }
 
+  parse->priv->merged_tags = gst_tag_list_ref (merged_tags);
   parse->priv->pending_events =
       g_list_prepend (parse->priv->pending_events,
       gst_event_new_tag (merged_tags));
@@ -1350,10 +1525,12 @@ gst_base_parse_sink_event_default (GstBaseParse * parse, GstEvent * event)
       break;
 
     case GST_EVENT_EOS:
-      if (parse->segment.rate > 0.0)
+      if (parse->segment.rate > 0.0) {
         gst_base_parse_drain (parse);
-      else
+        gst_base_parse_save_persistent_index (parse);
+      } else {
         gst_base_parse_finish_fragment (parse, TRUE);
+      }
 
       /* If we STILL have zero frames processed, fire an error */
       if (parse->priv->framecount == 0 && !parse->priv->saw_gaps &&
@@ -1496,6 +1673,8 @@ gst_base_parse_sink_event_default (GstBaseParse * parse, GstEvent * event)
    */
   if (event) {
     if (!GST_EVENT_IS_SERIALIZED (event) || forward_immediate) {
+      if (GST_EVENT_IS_SERIALIZED (event))
+        gst_base_parse_push_batch (parse);
       ret = gst_pad_push_event (parse->srcpad, event);
     } else {
       parse->priv->pending_events =
@@ -1914,6 +2093,11 @@ gst_base_parse_add_index_entry (GstBaseParse * parse, guint64 offset,
 
   if (G_LIKELY (!force)) {
 
+    if (parse->priv->index_table) {
+      GST_LOG_OBJECT (parse, "have a complete index; discarding");
+      goto exit;
+    }
+
     if (!parse->priv->upstream_seekable) {
       GST_DEBUG_OBJECT (parse, "upstream not seekable; discarding");
       goto exit;
@@ -1969,6 +2153,19 @@ gst_base_parse_add_index_entry (GstBaseParse * parse, guint64 offset,
   if (key) {
     parse->priv->index_last_offset = offset;
     parse->priv->index_last_ts = ts;
+
+    /* collect the entries for the persistent index, only while they are
+     * added in order from the start of the stream */
+    if (parse->priv->index_entries && parse->priv->index_last_valid) {
+      GArray *entries = parse->priv->index_entries;
+
+      if (entries->len == 0
+          || g_array_index (entries, guint64, entries->len - 2) < ts) {
+        guint64 entry[2] = { ts, offset };
+
+        g_array_append_vals (entries, entry, 2);
+      }
+    }
   }
 
   ret = TRUE;
@@ -1977,6 +2174,228 @@ exit:
   return ret;
 }
 
+static void
+gst_base_parse_clear_persistent_index (GstBaseParse * parse)
+{
+  GstBaseParsePrivate *priv = parse->priv;
+
+  g_free (priv->index_path);
+  priv->index_path = NULL;
+  priv->index_mtime = 0;
+  if (priv->index_file) {
+    g_mapped_file_unref (priv->index_file);
+    priv->index_file = NULL;
+  }
+  priv->index_table = NULL;
+  priv->index_table_len = 0;
+  if (priv->index_entries) {
+    g_array_free (priv->index_entries, TRUE);
+    priv->index_entries = NULL;
+  }
+}
+
+/* looks up the persistent index file for the upstream stream, maps it when
+ * it matches the stream or otherwise prepares for writing one at EOS */
+static void
+gst_base_parse_load_persistent_index (GstBaseParse * parse)
+{
+  GstBaseParsePrivate *priv = parse->priv;
+  GstQuery *query;
+  gchar *dir, *uri = NULL, *key, *checksum, *filename;
+  const guint64 *words;
+  GMappedFile *file;
+  gsize len;
+  guint64 n_entries;
+
+  if (!priv->upstream_seekable || priv->index_path)
+    return;
+
+  GST_OBJECT_LOCK (parse);
+  dir = g_strdup (priv->index_cache_dir);
+  GST_OBJECT_UNLOCK (parse);
+
+  if (dir == NULL)
+    return;
+
+  query = gst_query_new_uri ();
+  if (gst_pad_peer_query (parse->sinkpad, query))
+    gst_query_parse_uri (query, &uri);
+  gst_query_unref (query);
+
+  if (uri == NULL) {
+    GST_DEBUG_OBJECT (parse, "no upstream uri, no persistent index");
+    g_free (dir);
+    return;
+  }
+
+  /* the modification time of local files is checked as well */
+  if ((filename = g_filename_from_uri (uri, NULL, NULL))) {
+    GStatBuf st;
+
+    if (g_stat (filename, &st) == 0)
+      priv->index_mtime = st.st_mtime;
+    g_free (filename);
+  }
+
+  key = g_strdup_printf ("%s:%s", G_OBJECT_TYPE_NAME (parse), uri);
+  checksum = g_compute_checksum_for_string (G_CHECKSUM_SHA1, key, -1);
+  filename = g_strdup_printf ("%s.idx", checksum);
+  priv->index_path = g_build_filename (dir, filename, NULL);
+  g_free (filename);
+  g_free (checksum);
+  g_free (key);
+  g_free (uri);
+  g_free (dir);
+
+  file = g_mapped_file_new (priv->index_path, FALSE, NULL);
+  if (file == NULL)
+    goto no_index;
+
+  words = (const guint64 *) g_mapped_file_get_contents (file);
+  len = g_mapped_file_get_length (file);
+
+  if (len < INDEX_FILE_HEADER_WORDS * sizeof (guint64)
+      || memcmp (words, INDEX_FILE_MAGIC, sizeof (guint64)) != 0)
+    goto invalid_index;
+  if (GUINT64_FROM_LE (words[1]) != priv->upstream_size
+      || (gint64) GUINT64_FROM_LE (words[2]) != priv->index_mtime)
+    goto stale_index;
+
+  n_entries = GUINT64_FROM_LE (words[4]);
+  if (n_entries == 0 || len != (INDEX_FILE_HEADER_WORDS + 2 * n_entries)
+      * sizeof (guint64))
+    goto invalid_index;
+
+  GST_DEBUG_OBJECT (parse, "using persistent index %s with %" G_GUINT64_FORMAT
+      " entries", priv->index_path, n_entries);
+
+  priv->index_file = file;
+  priv->index_table = words + INDEX_FILE_HEADER_WORDS;
+  priv->index_table_len = n_entries;
+
+  if (!GST_CLOCK_TIME_IS_VALID (priv->duration)
+      && GST_CLOCK_TIME_IS_VALID (GUINT64_FROM_LE (words[3])))
+    gst_base_parse_set_duration (parse, GST_FORMAT_TIME,
+        GUINT64_FROM_LE (words[3]), 0);
+  return;
+
+  /* ERRORS */
+invalid_index:
+  {
+    GST_WARNING_OBJECT (parse, "invalid persistent index %s",
+        priv->index_path);
+    g_mapped_file_unref (file);
+    goto no_index;
+  }
+stale_index:
+  {
+    GST_DEBUG_OBJECT (parse, "persistent index %s is for another version of "
+        "the stream", priv->index_path);
+    g_mapped_file_unref (file);
+    goto no_index;
+  }
+no_index:
+  {
+    /* collect the entries to write one at EOS */
+    priv->index_entries = g_array_new (FALSE, FALSE, sizeof (guint64));
+    return;
+  }
+}
+
+/* writes the collected entries when the whole stream was indexed */
+static void
+gst_base_parse_save_persistent_index (GstBaseParse * parse)
+{
+  GstBaseParsePrivate *priv = parse->priv;
+  GArray *entries = priv->index_entries;
+  guint64 *words;
+  GstClockTime duration;
+  gchar *dir;
+  GError *err = NULL;
+  guint i;
+
+  if (entries == NULL || entries->len == 0)
+    return;
+
+  /* only a complete index can be used on the next open */
+  if (!priv->index_last_valid || (priv->offset < priv->upstream_size &&
+          !priv->index_scan_done)) {
+    GST_DEBUG_OBJECT (parse, "stream was not parsed completely");
+    return;
+  }
+
+  if (priv->duration_fmt == GST_FORMAT_TIME && priv->duration != -1)
+    duration = priv->duration;
+  else
+    duration = parse->segment.position;
+
+  words = g_new (guint64, INDEX_FILE_HEADER_WORDS + entries->len);
+  memcpy (words, INDEX_FILE_MAGIC, sizeof (guint64));
+  words[1] = GUINT64_TO_LE (priv->upstream_size);
+  words[2] = GUINT64_TO_LE (priv->index_mtime);
+  words[3] = GUINT64_TO_LE (duration);
+  words[4] = GUINT64_TO_LE (entries->len / 2);
+  for (i = 0; i < entries->len; i++)
+    words[INDEX_FILE_HEADER_WORDS + i] =
+        GUINT64_TO_LE (g_array_index (entries, guint64, i));
+
+  dir = g_path_get_dirname (priv->index_path);
+  g_mkdir_with_parents (dir, 0755);
+  g_free (dir);
+
+  /* written to a temporary file and renamed, readers never see a partial
+   * index */
+  if (!g_file_set_contents (priv->index_path, (const gchar *) words,
+          (INDEX_FILE_HEADER_WORDS + entries->len) * sizeof (guint64), &err)) {
+    GST_WARNING_OBJECT (parse, "failed to write persistent index: %s",
+        err->message);
+    g_error_free (err);
+  } else {
+    GST_DEBUG_OBJECT (parse, "wrote persistent index %s with %u entries",
+        priv->index_path, entries->len / 2);
+  }
+  g_free (words);
+
+  /* only once */
+  g_array_free (entries, TRUE);
+  priv->index_entries = NULL;
+}
+
+/* binary search in the persistent index, returns the offset of the last
+ * entry at or before @time (or the first after), -1 if there is none */
+static gint64
+gst_base_parse_find_persistent_offset (GstBaseParse * parse,
+    GstClockTime time, gboolean before, GstClockTime * _ts)
+{
+  const guint64 *table = parse->priv->index_table;
+  guint64 lo = 0, hi = parse->priv->index_table_len;
+
+  /* find the first entry after @time */
+  while (lo < hi) {
+    guint64 mid = lo + (hi - lo) / 2;
+
+    if (GUINT64_FROM_LE (table[2 * mid]) <= time)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+
+  if (before) {
+    if (lo == 0)
+      return -1;
+    lo--;
+  } else if (lo > 0 && GUINT64_FROM_LE (table[2 * (lo - 1)]) == time) {
+    lo--;
+  } else if (lo == parse->priv->index_table_len) {
+    return -1;
+  }
+
+  if (_ts)
+    *_ts = GUINT64_FROM_LE (table[2 * lo]);
+
+  return GUINT64_FROM_LE (table[2 * lo + 1]);
+}
+
 /* check for seekable upstream, above and beyond a mere query */
 static void
 gst_base_parse_check_seekability (GstBaseParse * parse)
@@ -2228,6 +2647,64 @@ gst_base_parse_handle_buffer (GstBaseParse * parse, GstBuffer * buffer,
   return ret;
 }
 
+/* gst_base_parse_push_batch:
+ * @parse: #GstBaseParse
+ *
+ * Pushes the frames collected for the batch-latency property, if any.
+ */
+static GstFlowReturn
+gst_base_parse_push_batch (GstBaseParse * parse)
+{
+  GstBufferList *list;
+  GstFlowReturn ret;
+
+  if (G_LIKELY (parse->priv->batch == NULL))
+    return GST_FLOW_OK;
+
+  list = parse->priv->batch;
+  parse->priv->batch = NULL;
+
+  GST_LOG_OBJECT (parse, "pushing batch of %u frames",
+      gst_buffer_list_length (list));
+  ret = gst_pad_push_list (parse->srcpad, list);
+  GST_LOG_OBJECT (parse, "batch pushed, flow %s", gst_flow_get_name (ret));
+
+  return ret;
+}
+
+/* gst_base_parse_batch_buffer:
+ * @parse: #GstBaseParse
+ * @buffer: (transfer full): the frame to output
+ *
+ * Collects @buffer and pushes the collected frames when they span at
+ * least @latency, or when the timestamps of @buffer are unknown.
+ */
+static GstFlowReturn
+gst_base_parse_batch_buffer (GstBaseParse * parse, GstBuffer * buffer,
+    GstClockTime latency)
+{
+  GstClockTime start, stop;
+
+  start = GST_BUFFER_DTS_OR_PTS (buffer);
+  stop = start;
+  if (GST_CLOCK_TIME_IS_VALID (start) && GST_BUFFER_DURATION_IS_VALID (buffer))
+    stop += GST_BUFFER_DURATION (buffer);
+
+  if (parse->priv->batch == NULL) {
+    parse->priv->batch = gst_buffer_list_new ();
+    parse->priv->batch_start = start;
+  }
+  gst_buffer_list_add (parse->priv->batch, buffer);
+
+  if (!GST_CLOCK_TIME_IS_VALID (stop)
+      || !GST_CLOCK_TIME_IS_VALID (parse->priv->batch_start)
+      || stop < parse->priv->batch_start
+      || stop - parse->priv->batch_start >= latency)
+    return gst_base_parse_push_batch (parse);
+
+  return GST_FLOW_OK;
+}
+
 /* gst_base_parse_push_pending_events:
  * @parse: #GstBaseParse
  *
@@ -2237,9 +2714,14 @@ static void
 gst_base_parse_push_pending_events (GstBaseParse * parse)
 {
   if (G_UNLIKELY (parse->priv->pending_events)) {
-    GList *r = g_list_reverse (parse->priv->pending_events);
+    GList *r;
     GList *l;
 
+    /* events must not overtake the collected frames */
+    gst_base_parse_push_batch (parse);
+
+    r = g_list_reverse (parse->priv->pending_events);
+
     parse->priv->pending_events = NULL;
     for (l = r; l != NULL; l = l->next) {
       gst_pad_push_event (parse->srcpad, GST_EVENT_CAST (l->data));
@@ -2454,6 +2936,7 @@ gst_base_parse_push_frame (GstBaseParse * parse, GstBaseParseFrame * frame)
             GST_TIME_ARGS (last_start));
 
         /* skip gap FIXME */
+        gst_base_parse_push_batch (parse);
         gst_pad_push_event (parse->srcpad,
             gst_event_new_segment (&parse->segment));
 
@@ -2528,10 +3011,29 @@ gst_base_parse_push_frame (GstBaseParse * parse, GstBaseParseFrame * frame)
     ret = GST_FLOW_OK;
   } else if (ret == GST_FLOW_OK) {
     if (parse->segment.rate > 0.0) {
-      GST_LOG_OBJECT (parse, "pushing frame (%" G_GSIZE_FORMAT " bytes) now..",
-          size);
-      ret = gst_pad_push (parse->srcpad, buffer);
-      GST_LOG_OBJECT (parse, "frame pushed, flow %s", gst_flow_get_name (ret));
+      GstClockTime latency;
+
+      GST_OBJECT_LOCK (parse);
+      latency = parse->priv->batch_latency;
+      GST_OBJECT_UNLOCK (parse);
+
+      if (latency > 0) {
+        GST_LOG_OBJECT (parse, "batching frame (%" G_GSIZE_FORMAT " bytes)",
+            size);
+        ret = gst_base_parse_batch_buffer (parse, buffer, latency);
+      } else {
+        /* push what was collected before batching was disabled */
+        ret = gst_base_parse_push_batch (parse);
+        if (ret == GST_FLOW_OK) {
+          GST_LOG_OBJECT (parse,
+              "pushing frame (%" G_GSIZE_FORMAT " bytes) now..", size);
+          ret = gst_pad_push (parse->srcpad, buffer);
+          GST_LOG_OBJECT (parse, "frame pushed, flow %s",
+              gst_flow_get_name (ret));
+        } else {
+          gst_buffer_unref (buffer);
+        }
+      }
     } else if (!parse->priv->disable_passthrough && parse->priv->passthrough) {
 
       /* in backwards playback mode, if on passthrough we need to push buffers
@@ -2637,6 +3139,7 @@ gst_base_parse_finish_frame (GstBaseParse * parse, GstBaseParseFrame * frame,
   if (G_UNLIKELY (parse->priv->framecount == 0)) {
     gst_base_parse_check_seekability (parse);
     gst_base_parse_check_upstream (parse);
+    gst_base_parse_load_persistent_index (parse);
   }
 
   parse->priv->flushed += size;
@@ -2999,6 +3502,21 @@ notfound:
   }
 }
 
+/* releases the scratch memory used while handling @buffer */
+static GstFlowReturn
+gst_base_parse_sink_chain (GstPad * pad, GstObject * parent,
+    GstBuffer * buffer)
+{
+  GstScratchArenaMark mark;
+  GstFlowReturn ret;
+
+  gst_scratch_arena_enter (&mark);
+  ret = gst_base_parse_chain (pad, parent, buffer);
+  gst_scratch_arena_leave (&mark);
+
+  return ret;
+}
+
 static GstFlowReturn
 gst_base_parse_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
 {
@@ -3485,6 +4003,16 @@ done:
   return ret;
 }
 
+static void
+gst_base_parse_task_func (GstPad * pad)
+{
+  GstScratchArenaMark mark;
+
+  gst_scratch_arena_enter (&mark);
+  gst_base_parse_loop (pad);
+  gst_scratch_arena_leave (&mark);
+}
+
 /* Loop that is used in pull mode to retrieve data from upstream */
 static void
 gst_base_parse_loop (GstPad * pad)
@@ -3543,6 +4071,8 @@ gst_base_parse_loop (GstPad * pad)
   if (ret != GST_FLOW_OK)
     goto done;
 
+  gst_base_parse_scan_index_step (parse);
+
 done:
   if (ret == GST_FLOW_EOS)
     goto eos;
@@ -3581,6 +4111,7 @@ pause:
             (GST_ELEMENT_CAST (parse),
             gst_message_new_segment_done (GST_OBJECT_CAST (parse),
                 GST_FORMAT_TIME, stop));
+        gst_base_parse_push_batch (parse);
         gst_pad_push_event (parse->srcpad,
             gst_event_new_segment_done (GST_FORMAT_TIME, stop));
       } else {
@@ -3588,6 +4119,8 @@ pause:
         if (parse->priv->framecount == 0) {
           GST_ELEMENT_ERROR (parse, STREAM, WRONG_TYPE,
               ("No valid frames found before end of stream"), (NULL));
+        } else if (parse->segment.rate > 0.0) {
+          gst_base_parse_save_persistent_index (parse);
         }
         push_eos = TRUE;
       }
@@ -3605,6 +4138,7 @@ pause:
       }
       /* Push pending events, including SEGMENT events */
       gst_base_parse_push_pending_events (parse);
+      gst_base_parse_push_batch (parse);
 
       gst_pad_push_event (parse->srcpad, gst_event_new_eos ());
     }
@@ -3646,7 +4180,7 @@ gst_base_parse_sink_activate (GstPad * sinkpad, GstObject * parent)
 
   parse->priv->push_stream_start = TRUE;
 
-  return gst_pad_start_task (sinkpad, (GstTaskFunction) gst_base_parse_loop,
+  return gst_pad_start_task (sinkpad, (GstTaskFunction) gst_base_parse_task_func,
       sinkpad, NULL);
   /* fallback */
 baseparse_push:
@@ -4145,11 +4679,12 @@ gst_base_parse_src_query_default (GstBaseParse * parse, GstQuery * query)
 
         GST_OBJECT_LOCK (parse);
         /* add our latency */
-        min_latency += parse->priv->min_latency;
+        min_latency += parse->priv->min_latency + parse->priv->batch_latency;
         if (max_latency == -1 || parse->priv->max_latency == -1)
           max_latency = -1;
         else
-          max_latency += parse->priv->max_latency;
+          max_latency +=
+              parse->priv->max_latency + parse->priv->batch_latency;
         GST_OBJECT_UNLOCK (parse);
 
         gst_query_set_latency (query, live, min_latency, max_latency);
@@ -4186,7 +4721,7 @@ gst_base_parse_src_query_default (GstBaseParse * parse, GstQuery * query)
  * return GST_FLOW_OK and frame position/time in @pos/@time if found */
 static GstFlowReturn
 gst_base_parse_find_frame (GstBaseParse * parse, gint64 * pos,
-    GstClockTime * time, GstClockTime * duration)
+    GstClockTime * time, GstClockTime * duration, gboolean * keyframe)
 {
   GstBaseParseClass *klass;
   gint64 orig_offset;
@@ -4233,6 +4768,8 @@ gst_base_parse_find_frame (GstBaseParse * parse, gint64 * pos,
   /* but it should provide proper time */
   *time = GST_BUFFER_TIMESTAMP (buf);
   *duration = GST_BUFFER_DURATION (buf);
+  if (keyframe)
+    *keyframe = !GST_BUFFER_FLAG_IS_SET (buf, GST_BUFFER_FLAG_DELTA_UNIT);
 
   GST_LOG_OBJECT (parse,
       "frame with time %" GST_TIME_FORMAT " at offset %" G_GINT64_FORMAT,
@@ -4354,7 +4891,7 @@ gst_base_parse_locate_time (GstBaseParse * parse, GstClockTime * _time,
         "estimated _offset for %" GST_TIME_FORMAT ": %" G_GINT64_FORMAT,
         GST_TIME_ARGS (time), newpos);
 
-    ret = gst_base_parse_find_frame (parse, &newpos, &newtime, &dur);
+    ret = gst_base_parse_find_frame (parse, &newpos, &newtime, &dur, NULL);
     if (ret == GST_FLOW_EOS) {
       /* heuristic HACK */
       hpos = MAX (lpos, hpos - chunk);
@@ -4401,6 +4938,88 @@ exit:
   return ret;
 }
 
+/* looks up the frame at the next position of the index scan and adds it to
+ * the index. Called from the streaming thread between normal frames, the
+ * subclass can not be used from another thread. */
+static void
+gst_base_parse_scan_index_step (GstBaseParse * parse)
+{
+  GstBaseParsePrivate *priv = parse->priv;
+  GstClockTime time, duration;
+  gboolean keyframe = TRUE, scan_index, new_frame;
+  GstFlowReturn ret;
+  gint64 pos, sync_offset, prev_offset;
+
+  GST_OBJECT_LOCK (parse);
+  scan_index = priv->scan_index;
+  GST_OBJECT_UNLOCK (parse);
+
+  if (!scan_index || priv->index_scan_done ||
+      priv->index_scan_offset >= priv->upstream_size)
+    return;
+
+  /* only for forward playback of streams that can be indexed by looking at
+   * a single frame, and not when a complete index was loaded */
+  if (priv->pad_mode != GST_PAD_MODE_PULL || parse->segment.rate < 0.0 ||
+      !priv->upstream_seekable || !priv->has_timing_info ||
+      !GST_CLOCK_TIME_IS_VALID (priv->first_frame_pts) || priv->index_table)
+    return;
+
+  /* leave most of the time to normal playback */
+  if (++priv->index_scan_count < INDEX_SCAN_PERIOD)
+    return;
+  priv->index_scan_count = 0;
+
+  if (priv->index_scan_offset < 0)
+    priv->index_scan_offset = priv->first_frame_offset;
+
+  /* the frame lookup only restores the state it needs for seeking, keep the
+   * rest of the state of playback too */
+  sync_offset = priv->sync_offset;
+  prev_offset = priv->prev_offset;
+  new_frame = priv->new_frame;
+
+  pos = priv->index_scan_offset;
+  ret = gst_base_parse_find_frame (parse, &pos, &time, &duration, &keyframe);
+
+  priv->sync_offset = sync_offset;
+  priv->prev_offset = prev_offset;
+  priv->new_frame = new_frame;
+  priv->skip = 0;
+  if (ret == GST_FLOW_EOS || (ret == GST_FLOW_OK
+          && pos >= priv->upstream_size))
+    goto done;
+  if (ret != GST_FLOW_OK || pos < 0 || !GST_CLOCK_TIME_IS_VALID (time))
+    goto failed;
+
+  GST_LOG_OBJECT (parse, "index scan found frame with time %" GST_TIME_FORMAT
+      " at offset %" G_GINT64_FORMAT, GST_TIME_ARGS (time), pos);
+  if (keyframe)
+    gst_base_parse_add_index_entry (parse, pos, time, TRUE, FALSE);
+
+  /* past the distance the index keeps between entries */
+  priv->index_scan_offset = pos + MAX (priv->idx_byte_interval,
+      INDEX_SCAN_MIN_STEP) + 1;
+  return;
+
+done:
+  {
+    GST_DEBUG_OBJECT (parse, "index scan reached the end of the stream");
+    priv->index_scan_done = TRUE;
+    if (priv->duration_fmt == GST_FORMAT_TIME && priv->duration != -1)
+      gst_base_parse_save_persistent_index (parse);
+    return;
+  }
+failed:
+  {
+    GST_DEBUG_OBJECT (parse, "index scan failed at offset %" G_GINT64_FORMAT
+        ": %s", priv->index_scan_offset, gst_flow_get_name (ret));
+    /* stop scanning, playback keeps adding entries after this position */
+    priv->index_scan_offset = priv->upstream_size;
+    return;
+  }
+}
+
 static gint64
 gst_base_parse_find_offset (GstBaseParse * parse, GstClockTime time,
     gboolean before, GstClockTime * _ts)
@@ -4414,6 +5033,18 @@ gst_base_parse_find_offset (GstBaseParse * parse, GstClockTime time,
     goto exit;
   }
 
+  if (parse->priv->index_table) {
+    bytes = gst_base_parse_find_persistent_offset (parse, time, before, &ts);
+    if (bytes != -1) {
+      GST_DEBUG_OBJECT (parse, "found persistent index entry for %"
+          GST_TIME_FORMAT " at %" GST_TIME_FORMAT ", offset %" G_GINT64_FORMAT,
+          GST_TIME_ARGS (time), GST_TIME_ARGS (ts), bytes);
+      goto exit;
+    }
+    bytes = 0;
+    ts = 0;
+  }
+
   GST_BASE_PARSE_INDEX_LOCK (parse);
   if (parse->priv->index) {
     /* Let's check if we have an index entry for that time */
@@ -4665,7 +5296,7 @@ gst_base_parse_handle_seek (GstBaseParse * parse, GstEvent * event)
 
     /* Start streaming thread if paused */
     gst_pad_start_task (parse->sinkpad,
-        (GstTaskFunction) gst_base_parse_loop, parse->sinkpad, NULL);
+        (GstTaskFunction) gst_base_parse_task_func, parse->sinkpad, NULL);
 
     GST_PAD_STREAM_UNLOCK (parse->sinkpad);
 
@@ -147,6 +147,7 @@
 #include <gst/gst_private.h>
 
 #include "gstbasesink.h"
+#include "gstscratcharena.h"
 #include <gst/gst-i18n-lib.h>
 
 GST_DEBUG_CATEGORY_STATIC (gst_base_sink_debug);
@@ -239,6 +240,10 @@ struct _GstBaseSinkPrivate
   GstBuffer *last_buffer;
   GstCaps *last_caps;
   GstBufferList *last_buffer_list;
+  /* the pool of the last buffer, it can ask for the buffer back. Protected
+   * by last_pool_lock, which is never taken with the object lock */
+  GMutex last_pool_lock;
+  GstBufferPool *last_pool;
 
   /* negotiated caps */
   GstCaps *caps;
@@ -265,11 +270,25 @@ struct _GstBaseSinkPrivate
   GstClockTime earliest_in_time;
   GstClockTime throttle_time;
 
+  /* for aggregating QoS events */
+  GstClockTime qos_interval;
+  GstClockTime qos_last_sent;
+  gint64 qos_jitter_sum;
+  guint qos_jitter_count;
+
+  /* SCHED_FIFO priority of the pull mode task, 0 for the default */
+  gint realtime_priority;
+
   /* for rate control */
   guint64 max_bitrate;
   GstClockTime rc_time;
   GstClockTime rc_next;
   gsize rc_accumulated;
+
+  /* buffers of a list within this running time of the first one are not
+   * synchronized separately */
+  GstClockTime list_sync_tolerance;
+  GstClockTime list_sync_until;
 };
 
 #define DO_RUNNING_AVG(avg,val,size) (((val) + ((size)-1) * (avg)) / (size))
@@ -298,6 +317,9 @@ struct _GstBaseSinkPrivate
 #define DEFAULT_ENABLE_LAST_SAMPLE  TRUE
 #define DEFAULT_THROTTLE_TIME       0
 #define DEFAULT_MAX_BITRATE         0
+#define DEFAULT_LIST_SYNC_TOLERANCE 0
+#define DEFAULT_QOS_INTERVAL        0
+#define DEFAULT_REALTIME_PRIORITY   0
 
 enum
 {
@@ -313,6 +335,9 @@ enum
   PROP_RENDER_DELAY,
   PROP_THROTTLE_TIME,
   PROP_MAX_BITRATE,
+  PROP_LIST_SYNC_TOLERANCE,
+  PROP_QOS_INTERVAL,
+  PROP_REALTIME_PRIORITY,
   PROP_LAST
 };
 
@@ -383,6 +408,7 @@ static GstFlowReturn gst_base_sink_chain_list (GstPad * pad, GstObject * parent,
     GstBufferList * list);
 
 static void gst_base_sink_loop (GstPad * pad);
+static void gst_base_sink_task_func (GstPad * pad);
 static gboolean gst_base_sink_pad_activate (GstPad * pad, GstObject * parent);
 static gboolean gst_base_sink_pad_activate_mode (GstPad * pad,
     GstObject * parent, GstPadMode mode, gboolean active);
@@ -395,6 +421,9 @@ static gboolean gst_base_sink_event (GstPad * pad, GstObject * parent,
 
 static gboolean gst_base_sink_default_query (GstBaseSink * sink,
     GstQuery * query);
+static void gst_base_sink_drain (GstBaseSink * basesink);
+static void gst_base_sink_set_last_pool (GstBaseSink * sink,
+    GstBufferPool * pool);
 
 static gboolean gst_base_sink_negotiate_pull (GstBaseSink * basesink);
 static GstCaps *gst_base_sink_default_fixate (GstBaseSink * bsink,
@@ -535,6 +564,55 @@ gst_base_sink_class_init (GstBaseSinkClass * klass)
           "The maximum bits per second to render (0 = disabled)", 0,
           G_MAXUINT64, DEFAULT_MAX_BITRATE,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstBaseSink:list-sync-tolerance:
+   *
+   * When rendering the buffers of a buffer list one by one, only synchronize
+   * the first buffer of the list against the clock and render the following
+   * buffers that are at most this amount of running time later right away.
+   * This avoids a clock wait for every buffer of lists with bursts of
+   * buffers. Buffer lists that are rendered with a single render_list call
+   * are always synchronized once.
+   *
+   * Since: 1.10
+   */
+  g_object_class_install_property (gobject_class, PROP_LIST_SYNC_TOLERANCE,
+      g_param_spec_uint64 ("list-sync-tolerance", "List sync tolerance",
+          "Running time after the first buffer of a list in which buffers "
+          "are rendered without waiting for the clock (0 = disabled)", 0,
+          G_MAXUINT64, DEFAULT_LIST_SYNC_TOLERANCE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstBaseSink:qos-interval:
+   *
+   * The minimum running time between two QoS events. QoS measurements of
+   * the buffers in between are aggregated into the next event, which
+   * carries the running average of the proportion and the average jitter
+   * of the interval. This limits the QoS event rate when the pipeline is
+   * overloaded.
+   *
+   * Since: 1.10
+   */
+  g_object_class_install_property (gobject_class, PROP_QOS_INTERVAL,
+      g_param_spec_uint64 ("qos-interval", "QoS interval",
+          "Minimum running time between QoS events (0 = every buffer)", 0,
+          G_MAXUINT64, DEFAULT_QOS_INTERVAL,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstBaseSink:realtime-priority:
+   *
+   * Run the streaming thread of the sink in pull mode with realtime FIFO
+   * scheduling and this priority, see gst_task_set_scheduling(). 0 keeps the
+   * scheduling the thread gets from the application or the system. In push
+   * mode the streaming thread belongs to an upstream element.
+   *
+   * Since: 1.10
+   */
+  g_object_class_install_property (gobject_class, PROP_REALTIME_PRIORITY,
+      g_param_spec_int ("realtime-priority", "Realtime priority",
+          "Realtime FIFO priority of the streaming thread in pull mode "
+          "(0 = default)", 0, 99, DEFAULT_REALTIME_PRIORITY,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
   gstelement_class->change_state =
       GST_DEBUG_FUNCPTR (gst_base_sink_change_state);
@@ -645,6 +723,8 @@ gst_base_sink_init (GstBaseSink * basesink, gpointer g_class)
   gst_pad_set_event_function (basesink->sinkpad, gst_base_sink_event);
   gst_pad_set_chain_function (basesink->sinkpad, gst_base_sink_chain);
   gst_pad_set_chain_list_function (basesink->sinkpad, gst_base_sink_chain_list);
+  /* see the propose_allocation docs, subclasses can unset this */
+  GST_PAD_SET_CACHE_ALLOCATION (basesink->sinkpad);
   gst_element_add_pad (GST_ELEMENT_CAST (basesink), basesink->sinkpad);
 
   basesink->pad_mode = GST_PAD_MODE_NONE;
@@ -666,6 +746,12 @@ gst_base_sink_init (GstBaseSink * basesink, gpointer g_class)
   g_atomic_int_set (&priv->enable_last_sample, DEFAULT_ENABLE_LAST_SAMPLE);
   priv->throttle_time = DEFAULT_THROTTLE_TIME;
   priv->max_bitrate = DEFAULT_MAX_BITRATE;
+  priv->list_sync_tolerance = DEFAULT_LIST_SYNC_TOLERANCE;
+  priv->list_sync_until = GST_CLOCK_TIME_NONE;
+  priv->qos_interval = DEFAULT_QOS_INTERVAL;
+  priv->qos_last_sent = GST_CLOCK_TIME_NONE;
+  priv->realtime_priority = DEFAULT_REALTIME_PRIORITY;
+  g_mutex_init (&priv->last_pool_lock);
 
   GST_OBJECT_FLAG_SET (basesink, GST_ELEMENT_FLAG_SINK);
 }
@@ -677,6 +763,8 @@ gst_base_sink_finalize (GObject * object)
 
   basesink = GST_BASE_SINK (object);
 
+  gst_base_sink_set_last_pool (basesink, NULL);
+  g_mutex_clear (&basesink->priv->last_pool_lock);
   g_mutex_clear (&basesink->preroll_lock);
   g_cond_clear (&basesink->preroll_cond);
 
@@ -990,15 +1078,56 @@ gst_base_sink_set_last_buffer_list_unlocked (GstBaseSink * sink,
   }
 }
 
+/* called by the pool of the last buffer when it ran out of buffers */
+static void
+gst_base_sink_reclaim_last_buffer (GstBufferPool * pool, gpointer user_data)
+{
+  GstBaseSink *sink = GST_BASE_SINK_CAST (user_data);
+
+  GST_DEBUG_OBJECT (sink, "pool %" GST_PTR_FORMAT " reclaims buffers", pool);
+  /* keeps a copy of the last buffer for the last-sample */
+  gst_base_sink_drain (sink);
+}
+
+static void
+gst_base_sink_set_last_pool (GstBaseSink * sink, GstBufferPool * pool)
+{
+  GstBaseSinkPrivate *priv = sink->priv;
+
+  g_mutex_lock (&priv->last_pool_lock);
+  if (priv->last_pool != pool) {
+    if (priv->last_pool) {
+      gst_buffer_pool_remove_reclaim_func (priv->last_pool,
+          gst_base_sink_reclaim_last_buffer, sink);
+      gst_object_unref (priv->last_pool);
+    }
+    priv->last_pool = pool ? gst_object_ref (pool) : NULL;
+    if (pool)
+      gst_buffer_pool_add_reclaim_func (pool,
+          gst_base_sink_reclaim_last_buffer, sink);
+  }
+  g_mutex_unlock (&priv->last_pool_lock);
+}
+
 static void
 gst_base_sink_set_last_buffer (GstBaseSink * sink, GstBuffer * buffer)
 {
-  if (!g_atomic_int_get (&sink->priv->enable_last_sample))
+  GstBufferPool *pool;
+
+  if (!g_atomic_int_get (&sink->priv->enable_last_sample)) {
+    if (G_UNLIKELY (sink->priv->last_pool))
+      gst_base_sink_set_last_pool (sink, NULL);
     return;
+  }
 
   GST_OBJECT_LOCK (sink);
   gst_base_sink_set_last_buffer_unlocked (sink, buffer);
   GST_OBJECT_UNLOCK (sink);
+
+  /* the pool of the buffer can then ask for it back */
+  pool = buffer ? buffer->pool : NULL;
+  if (G_UNLIKELY (pool != sink->priv->last_pool))
+    gst_base_sink_set_last_pool (sink, pool);
 }
 
 static void
@@ -1363,6 +1492,130 @@ gst_base_sink_get_max_bitrate (GstBaseSink * sink)
   return res;
 }
 
+/**
+ * gst_base_sink_set_list_sync_tolerance:
+ * @sink: a #GstBaseSink
+ * @tolerance: the tolerance in nanoseconds, 0 to disable
+ *
+ * Set the running time after the first buffer of a buffer list in which the
+ * following buffers of the list are rendered without synchronizing them
+ * against the clock. This only affects buffer lists that are rendered one
+ * buffer at a time because the subclass does not implement render_list.
+ *
+ * Since: 1.10
+ */
+void
+gst_base_sink_set_list_sync_tolerance (GstBaseSink * sink,
+    GstClockTime tolerance)
+{
+  g_return_if_fail (GST_IS_BASE_SINK (sink));
+
+  GST_OBJECT_LOCK (sink);
+  sink->priv->list_sync_tolerance = tolerance;
+  GST_LOG_OBJECT (sink, "set list_sync_tolerance to %" GST_TIME_FORMAT,
+      GST_TIME_ARGS (tolerance));
+  GST_OBJECT_UNLOCK (sink);
+}
+
+/**
+ * gst_base_sink_get_list_sync_tolerance:
+ * @sink: a #GstBaseSink
+ *
+ * Get the tolerance set with gst_base_sink_set_list_sync_tolerance().
+ *
+ * Returns: the list sync tolerance in nanoseconds.
+ *
+ * Since: 1.10
+ */
+GstClockTime
+gst_base_sink_get_list_sync_tolerance (GstBaseSink * sink)
+{
+  GstClockTime res;
+
+  g_return_val_if_fail (GST_IS_BASE_SINK (sink), 0);
+
+  GST_OBJECT_LOCK (sink);
+  res = sink->priv->list_sync_tolerance;
+  GST_OBJECT_UNLOCK (sink);
+
+  return res;
+}
+
+/**
+ * gst_base_sink_set_qos_interval:
+ * @sink: a #GstBaseSink
+ * @interval: the minimum running time between QoS events, 0 to send one
+ *     for every buffer
+ *
+ * Set the minimum running time between two QoS events sent upstream by
+ * @sink. The measurements in between are aggregated into the next event.
+ *
+ * Since: 1.10
+ */
+void
+gst_base_sink_set_qos_interval (GstBaseSink * sink, GstClockTime interval)
+{
+  g_return_if_fail (GST_IS_BASE_SINK (sink));
+
+  GST_OBJECT_LOCK (sink);
+  sink->priv->qos_interval = interval;
+  GST_LOG_OBJECT (sink, "set qos_interval to %" GST_TIME_FORMAT,
+      GST_TIME_ARGS (interval));
+  GST_OBJECT_UNLOCK (sink);
+}
+
+/**
+ * gst_base_sink_get_qos_interval:
+ * @sink: a #GstBaseSink
+ *
+ * Get the interval set with gst_base_sink_set_qos_interval().
+ *
+ * Returns: the minimum running time between QoS events.
+ *
+ * Since: 1.10
+ */
+GstClockTime
+gst_base_sink_get_qos_interval (GstBaseSink * sink)
+{
+  GstClockTime res;
+
+  g_return_val_if_fail (GST_IS_BASE_SINK (sink), 0);
+
+  GST_OBJECT_LOCK (sink);
+  res = sink->priv->qos_interval;
+  GST_OBJECT_UNLOCK (sink);
+
+  return res;
+}
+
+/* apply the realtime-priority to the pull mode task, if there is one.
+ * Without @force, the default priority leaves the scheduling of the task to
+ * the application. */
+static void
+gst_base_sink_configure_task_scheduling (GstBaseSink * sink, gboolean force)
+{
+  GstTask *task;
+  gint priority;
+
+  GST_OBJECT_LOCK (sink);
+  priority = sink->priv->realtime_priority;
+  GST_OBJECT_UNLOCK (sink);
+
+  if (priority == 0 && !force)
+    return;
+
+  GST_OBJECT_LOCK (sink->sinkpad);
+  if ((task = GST_PAD_TASK (sink->sinkpad)))
+    gst_object_ref (task);
+  GST_OBJECT_UNLOCK (sink->sinkpad);
+
+  if (task) {
+    gst_task_set_scheduling (task, priority > 0 ? GST_TASK_SCHEDULING_FIFO :
+        GST_TASK_SCHEDULING_DEFAULT, priority);
+    gst_object_unref (task);
+  }
+}
+
 static void
 gst_base_sink_set_property (GObject * object, guint prop_id,
     const GValue * value, GParamSpec * pspec)
@@ -1400,6 +1653,18 @@ gst_base_sink_set_property (GObject * object, guint prop_id,
     case PROP_MAX_BITRATE:
       gst_base_sink_set_max_bitrate (sink, g_value_get_uint64 (value));
       break;
+    case PROP_LIST_SYNC_TOLERANCE:
+      gst_base_sink_set_list_sync_tolerance (sink, g_value_get_uint64 (value));
+      break;
+    case PROP_QOS_INTERVAL:
+      gst_base_sink_set_qos_interval (sink, g_value_get_uint64 (value));
+      break;
+    case PROP_REALTIME_PRIORITY:
+      GST_OBJECT_LOCK (sink);
+      sink->priv->realtime_priority = g_value_get_int (value);
+      GST_OBJECT_UNLOCK (sink);
+      gst_base_sink_configure_task_scheduling (sink, TRUE);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -1446,6 +1711,17 @@ gst_base_sink_get_property (GObject * object, guint prop_id, GValue * value,
     case PROP_MAX_BITRATE:
       g_value_set_uint64 (value, gst_base_sink_get_max_bitrate (sink));
       break;
+    case PROP_LIST_SYNC_TOLERANCE:
+      g_value_set_uint64 (value, gst_base_sink_get_list_sync_tolerance (sink));
+      break;
+    case PROP_QOS_INTERVAL:
+      g_value_set_uint64 (value, gst_base_sink_get_qos_interval (sink));
+      break;
+    case PROP_REALTIME_PRIORITY:
+      GST_OBJECT_LOCK (sink);
+      g_value_set_int (value, sink->priv->realtime_priority);
+      GST_OBJECT_UNLOCK (sink);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -2526,6 +2802,15 @@ again:
   if (!do_sync)
     goto done;
 
+  /* part of a buffer list that was synchronized on its first buffer */
+  if (G_UNLIKELY (GST_CLOCK_TIME_IS_VALID (priv->list_sync_until))
+      && GST_CLOCK_TIME_IS_VALID (rstart) && rstart <= priv->list_sync_until) {
+    GST_LOG_OBJECT (basesink, "not syncing buffer in list, %" GST_TIME_FORMAT
+        " <= %" GST_TIME_FORMAT, GST_TIME_ARGS (rstart),
+        GST_TIME_ARGS (priv->list_sync_until));
+    goto done;
+  }
+
   /* adjust for latency */
   stime = gst_base_sink_adjust_time (basesink, rstart);
 
@@ -2747,11 +3032,28 @@ gst_base_sink_perform_qos (GstBaseSink * sink, gboolean dropped)
         priv->current_jitter = -priv->current_rstart;
     }
 
+    diff = priv->current_jitter;
+
+    if (priv->qos_interval > 0) {
+      priv->qos_jitter_sum += diff;
+      priv->qos_jitter_count++;
+
+      /* aggregate into the next event */
+      if (GST_CLOCK_TIME_IS_VALID (priv->qos_last_sent) &&
+          start >= priv->qos_last_sent &&
+          start - priv->qos_last_sent < priv->qos_interval)
+        goto done;
+
+      diff = priv->qos_jitter_sum / (gint64) priv->qos_jitter_count;
+      priv->qos_jitter_sum = 0;
+      priv->qos_jitter_count = 0;
+      priv->qos_last_sent = start;
+    }
+
     if (priv->throttle_time > 0) {
       diff = priv->throttle_time;
       type = GST_QOS_TYPE_THROTTLE;
     } else {
-      diff = priv->current_jitter;
       if (diff <= 0)
         type = GST_QOS_TYPE_OVERFLOW;
       else
@@ -2762,6 +3064,7 @@ gst_base_sink_perform_qos (GstBaseSink * sink, gboolean dropped)
         diff);
   }
 
+done:
   /* record when this buffer will leave us */
   priv->last_left = left;
 }
@@ -2781,6 +3084,9 @@ gst_base_sink_reset_qos (GstBaseSink * sink)
   priv->avg_duration = GST_CLOCK_TIME_NONE;
   priv->avg_pt = GST_CLOCK_TIME_NONE;
   priv->avg_rate = -1.0;
+  priv->qos_last_sent = GST_CLOCK_TIME_NONE;
+  priv->qos_jitter_sum = 0;
+  priv->qos_jitter_count = 0;
   priv->avg_render = GST_CLOCK_TIME_NONE;
   priv->avg_in_diff = GST_CLOCK_TIME_NONE;
   priv->rendered = 0;
@@ -3528,13 +3834,17 @@ again:
     gst_base_sink_set_last_buffer (basesink, GST_BUFFER_CAST (obj));
     gst_base_sink_set_last_buffer_list (basesink, NULL);
 
+    GST_SDT_PROBE2 (base_sink_render, basesink, obj);
     if (bclass->render)
       ret = bclass->render (basesink, GST_BUFFER_CAST (obj));
+    GST_SDT_PROBE2 (base_sink_render_done, basesink, ret);
   } else {
     GstBufferList *buffer_list = GST_BUFFER_LIST_CAST (obj);
 
+    GST_SDT_PROBE2 (base_sink_render_list, basesink, buffer_list);
     if (bclass->render_list)
       ret = bclass->render_list (basesink, buffer_list);
+    GST_SDT_PROBE2 (base_sink_render_done, basesink, ret);
 
     /* Set the first buffer and buffer list to be included in last sample */
     gst_base_sink_set_last_buffer (basesink, sync_buf);
@@ -3610,7 +3920,9 @@ dropped:
     priv->dropped++;
     GST_DEBUG_OBJECT (basesink, "buffer late, dropping");
 
-    if (g_atomic_int_get (&priv->qos_enabled)) {
+    if (g_atomic_int_get (&priv->qos_enabled) &&
+        gst_element_message_will_be_posted (GST_ELEMENT_CAST (basesink),
+            GST_MESSAGE_QOS)) {
       GstMessage *qos_msg;
       GstClockTime timestamp, duration;
 
@@ -3647,13 +3959,16 @@ gst_base_sink_chain_main (GstBaseSink * basesink, GstPad * pad, gpointer obj,
     gboolean is_list)
 {
   GstFlowReturn result;
+  GstScratchArenaMark mark;
 
   if (G_UNLIKELY (basesink->pad_mode != GST_PAD_MODE_PUSH))
     goto wrong_mode;
 
+  gst_scratch_arena_enter (&mark);
   GST_BASE_SINK_PREROLL_LOCK (basesink);
   result = gst_base_sink_chain_unlocked (basesink, pad, obj, is_list);
   GST_BASE_SINK_PREROLL_UNLOCK (basesink);
+  gst_scratch_arena_leave (&mark);
 
 done:
   return result;
@@ -3698,11 +4013,17 @@ gst_base_sink_chain_list (GstPad * pad, GstObject * parent,
   if (G_LIKELY (bclass->render_list)) {
     result = gst_base_sink_chain_main (basesink, pad, list, TRUE);
   } else {
+    GstBaseSinkPrivate *priv = basesink->priv;
+    GstClockTime tolerance;
     guint i, len;
     GstBuffer *buffer;
 
     GST_LOG_OBJECT (pad, "chaining each buffer in list");
 
+    GST_OBJECT_LOCK (basesink);
+    tolerance = priv->list_sync_tolerance;
+    GST_OBJECT_UNLOCK (basesink);
+
     len = gst_buffer_list_length (list);
 
     result = GST_FLOW_OK;
@@ -3712,7 +4033,14 @@ gst_base_sink_chain_list (GstPad * pad, GstObject * parent,
           gst_buffer_ref (buffer), FALSE);
       if (result != GST_FLOW_OK)
         break;
+
+      /* the first buffer was synchronized, render the ones close to it
+       * without waiting again */
+      if (i == 0 && tolerance > 0
+          && GST_CLOCK_TIME_IS_VALID (priv->current_rstart))
+        priv->list_sync_until = priv->current_rstart + tolerance;
     }
+    priv->list_sync_until = GST_CLOCK_TIME_NONE;
     gst_buffer_list_unref (list);
   }
   return result;
@@ -4021,6 +4349,17 @@ gst_base_sink_perform_step (GstBaseSink * sink, GstPad * pad, GstEvent * event)
   return TRUE;
 }
 
+/* releases the scratch memory used in each iteration of the loop */
+static void
+gst_base_sink_task_func (GstPad * pad)
+{
+  GstScratchArenaMark mark;
+
+  gst_scratch_arena_enter (&mark);
+  gst_base_sink_loop (pad);
+  gst_scratch_arena_leave (&mark);
+}
+
 /* with STREAM_LOCK
  */
 static void
@@ -4170,7 +4509,9 @@ gst_base_sink_default_activate_pull (GstBaseSink * basesink, gboolean active)
   if (active) {
     /* start task */
     result = gst_pad_start_task (basesink->sinkpad,
-        (GstTaskFunction) gst_base_sink_loop, basesink->sinkpad, NULL);
+        (GstTaskFunction) gst_base_sink_task_func, basesink->sinkpad, NULL);
+    if (result)
+      gst_base_sink_configure_task_scheduling (basesink, FALSE);
   } else {
     /* step 2, make sure streaming finishes */
     result = gst_pad_stop_task (basesink->sinkpad);
@@ -118,7 +118,10 @@ struct _GstBaseSink {
  *     mode. The default implementation starts a task on the sink pad.
  * @get_times: Called to get the start and end times for synchronising
  *     the passed buffer to the clock
- * @propose_allocation: configure the allocation query
+ * @propose_allocation: configure the allocation query. The result is
+ *     cached on the sink pad and reused for allocation queries with the same
+ *     caps (Since 1.10). Push a RECONFIGURE event upstream on the sink pad
+ *     when the proposal changes, or unset %GST_PAD_FLAG_CACHE_ALLOCATION.
  * @start: Start processing. Ideal for opening resources in the subclass
  * @stop: Stop processing. Subclasses should use this to close resources.
  * @unlock: Unlock any pending access to the resource. Subclasses should
@@ -249,6 +252,15 @@ guint64         gst_base_sink_get_throttle_time (GstBaseSink *sink);
 void            gst_base_sink_set_max_bitrate   (GstBaseSink *sink, guint64 max_bitrate);
 guint64         gst_base_sink_get_max_bitrate   (GstBaseSink *sink);
 
+/* list-sync-tolerance */
+void            gst_base_sink_set_list_sync_tolerance (GstBaseSink *sink,
+                                                       GstClockTime tolerance);
+GstClockTime    gst_base_sink_get_list_sync_tolerance (GstBaseSink *sink);
+
+/* qos-interval */
+void            gst_base_sink_set_qos_interval  (GstBaseSink *sink, GstClockTime interval);
+GstClockTime    gst_base_sink_get_qos_interval  (GstBaseSink *sink);
+
 GstClockReturn  gst_base_sink_wait_clock        (GstBaseSink *sink, GstClockTime time,
                                                  GstClockTimeDiff * jitter);
 GstFlowReturn   gst_base_sink_wait              (GstBaseSink *sink, GstClockTime time,
@@ -165,6 +165,7 @@
 #include <gst/glib-compat-private.h>
 
 #include "gstbasesrc.h"
+#include "gstscratcharena.h"
 #include "gsttypefindhelper.h"
 #include <gst/gst-i18n-lib.h>
 
@@ -204,6 +205,9 @@ enum
 #define DEFAULT_NUM_BUFFERS     -1
 #define DEFAULT_TYPEFIND        FALSE
 #define DEFAULT_DO_TIMESTAMP    FALSE
+#define DEFAULT_READAHEAD       0
+#define MAX_READAHEAD           64
+#define DEFAULT_REALTIME_PRIORITY 0
 
 enum
 {
@@ -211,7 +215,9 @@ enum
   PROP_BLOCKSIZE,
   PROP_NUM_BUFFERS,
   PROP_TYPEFIND,
-  PROP_DO_TIMESTAMP
+  PROP_DO_TIMESTAMP,
+  PROP_READAHEAD,
+  PROP_REALTIME_PRIORITY
 };
 
 #define GST_BASE_SRC_GET_PRIVATE(obj)  \
@@ -260,6 +266,9 @@ struct _GstBaseSrcPrivate
   GList *pending_events;
   volatile gint have_events;
 
+  /* list submitted from the create function, without its first buffer */
+  GstBufferList *pending_bufferlist;
+
   /* QoS *//* with LOCK */
   gboolean qos_enabled;
   gdouble proportion;
@@ -270,8 +279,33 @@ struct _GstBaseSrcPrivate
   GstAllocationParams params;
 
   GCond async_cond;
+
+  /* readahead in pull mode */
+  guint readahead;              /* with LOCK */
+
+  /* SCHED_FIFO priority of the streaming task, 0 for the default */
+  gint realtime_priority;       /* with LOCK */
+  GMutex create_lock;           /* serializes the create calls */
+  GMutex ra_lock;               /* protects the fields below */
+  GCond ra_cond;
+  GstTask *ra_task;
+  GRecMutex ra_task_lock;
+  gboolean ra_flushing;
+  GQueue ra_blocks;             /* of GstBaseSrcBlock, sorted by offset */
+  guint ra_max;
+  guint64 ra_last_end;
+  guint64 ra_next;
+  guint64 ra_end;
+  guint ra_blocksize;
 };
 
+typedef struct
+{
+  guint64 offset;
+  gsize size;
+  GstBuffer *buffer;
+} GstBaseSrcBlock;
+
 static GstElementClass *parent_class = NULL;
 
 static void gst_base_src_class_init (GstBaseSrcClass * klass);
@@ -350,8 +384,14 @@ static GstStateChangeReturn gst_base_src_change_state (GstElement * element,
     GstStateChange transition);
 
 static void gst_base_src_loop (GstPad * pad);
+static void gst_base_src_task_func (GstPad * pad);
+static gboolean gst_base_src_start_task (GstBaseSrc * src);
+static void gst_base_src_configure_task_scheduling (GstBaseSrc * src,
+    gboolean force);
 static GstFlowReturn gst_base_src_getrange (GstPad * pad, GstObject * parent,
     guint64 offset, guint length, GstBuffer ** buf);
+static GstFlowReturn gst_base_src_getranges (GstPad * pad, GstObject * parent,
+    const GstPadRange * ranges, guint n_ranges, GstBuffer ** buffers);
 static GstFlowReturn gst_base_src_get_range (GstBaseSrc * src, guint64 offset,
     guint length, GstBuffer ** buf);
 static gboolean gst_base_src_seekable (GstBaseSrc * src);
@@ -395,6 +435,32 @@ gst_base_src_class_init (GstBaseSrcClass * klass)
       g_param_spec_boolean ("do-timestamp", "Do timestamp",
           "Apply current stream time to buffers", DEFAULT_DO_TIMESTAMP,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstBaseSrc:readahead:
+   *
+   * Number of blocks to prefetch when the source is pulled sequentially.
+   *
+   * Since: 1.10
+   */
+  g_object_class_install_property (gobject_class, PROP_READAHEAD,
+      g_param_spec_uint ("readahead", "Readahead",
+          "Number of blocks to prefetch for sequential reads in pull mode "
+          "(0 = disabled)", 0, MAX_READAHEAD, DEFAULT_READAHEAD,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstBaseSrc:realtime-priority:
+   *
+   * Run the streaming thread in push mode with realtime FIFO scheduling and
+   * this priority, see gst_task_set_scheduling(). 0 keeps the scheduling the
+   * thread gets from the application or the system.
+   *
+   * Since: 1.10
+   */
+  g_object_class_install_property (gobject_class, PROP_REALTIME_PRIORITY,
+      g_param_spec_int ("realtime-priority", "Realtime priority",
+          "Realtime FIFO priority of the streaming thread (0 = default)",
+          0, 99, DEFAULT_REALTIME_PRIORITY,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
   gstelement_class->change_state =
       GST_DEBUG_FUNCPTR (gst_base_src_change_state);
@@ -418,6 +484,7 @@ gst_base_src_class_init (GstBaseSrcClass * klass)
   GST_DEBUG_REGISTER_FUNCPTR (gst_base_src_event);
   GST_DEBUG_REGISTER_FUNCPTR (gst_base_src_query);
   GST_DEBUG_REGISTER_FUNCPTR (gst_base_src_getrange);
+  GST_DEBUG_REGISTER_FUNCPTR (gst_base_src_getranges);
   GST_DEBUG_REGISTER_FUNCPTR (gst_base_src_fixate);
 }
 
@@ -450,6 +517,7 @@ gst_base_src_init (GstBaseSrc * basesrc, gpointer g_class)
   gst_pad_set_event_function (pad, gst_base_src_event);
   gst_pad_set_query_function (pad, gst_base_src_query);
   gst_pad_set_getrange_function (pad, gst_base_src_getrange);
+  gst_pad_set_getranges_function (pad, gst_base_src_getranges);
 
   /* hold pointer to pad */
   basesrc->srcpad = pad;
@@ -465,6 +533,13 @@ gst_base_src_init (GstBaseSrc * basesrc, gpointer g_class)
   g_atomic_int_set (&basesrc->priv->have_events, FALSE);
 
   g_cond_init (&basesrc->priv->async_cond);
+  basesrc->priv->readahead = DEFAULT_READAHEAD;
+  basesrc->priv->realtime_priority = DEFAULT_REALTIME_PRIORITY;
+  g_mutex_init (&basesrc->priv->create_lock);
+  g_mutex_init (&basesrc->priv->ra_lock);
+  g_cond_init (&basesrc->priv->ra_cond);
+  g_rec_mutex_init (&basesrc->priv->ra_task_lock);
+  g_queue_init (&basesrc->priv->ra_blocks);
   basesrc->priv->start_result = GST_FLOW_FLUSHING;
   GST_OBJECT_FLAG_UNSET (basesrc, GST_BASE_SRC_FLAG_STARTED);
   GST_OBJECT_FLAG_UNSET (basesrc, GST_BASE_SRC_FLAG_STARTING);
@@ -484,6 +559,10 @@ gst_base_src_finalize (GObject * object)
   g_mutex_clear (&basesrc->live_lock);
   g_cond_clear (&basesrc->live_cond);
   g_cond_clear (&basesrc->priv->async_cond);
+  g_mutex_clear (&basesrc->priv->create_lock);
+  g_mutex_clear (&basesrc->priv->ra_lock);
+  g_cond_clear (&basesrc->priv->ra_cond);
+  g_rec_mutex_clear (&basesrc->priv->ra_task_lock);
 
   event_p = &basesrc->pending_seek;
   gst_event_replace (event_p, NULL);
@@ -493,6 +572,8 @@ gst_base_src_finalize (GObject * object)
         NULL);
     g_list_free (basesrc->priv->pending_events);
   }
+  if (basesrc->priv->pending_bufferlist)
+    gst_buffer_list_unref (basesrc->priv->pending_bufferlist);
 
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
@@ -820,6 +901,58 @@ gst_base_src_get_do_timestamp (GstBaseSrc * src)
   return res;
 }
 
+/**
+ * gst_base_src_set_readahead:
+ * @src: the source
+ * @n_blocks: the number of blocks to prefetch, 0 to disable
+ *
+ * Configure @src to prefetch the next @n_blocks ranges on a helper thread
+ * when it is pulled sequentially. Ranges that were prefetched are then
+ * handed out without calling the #GstBaseSrcClass.create() method on the
+ * pulling thread, other ranges are still read directly.
+ *
+ * The create() method is never called concurrently, but it can be called
+ * from the helper thread. Readahead is only used for non-live sources and
+ * the value is taken into account the next time @src is activated in pull
+ * mode.
+ *
+ * Since: 1.10
+ */
+void
+gst_base_src_set_readahead (GstBaseSrc * src, guint n_blocks)
+{
+  g_return_if_fail (GST_IS_BASE_SRC (src));
+  g_return_if_fail (n_blocks <= MAX_READAHEAD);
+
+  GST_OBJECT_LOCK (src);
+  src->priv->readahead = n_blocks;
+  GST_OBJECT_UNLOCK (src);
+}
+
+/**
+ * gst_base_src_get_readahead:
+ * @src: the source
+ *
+ * Get the number of blocks @src prefetches in pull mode.
+ *
+ * Returns: the number of blocks to prefetch, 0 when disabled.
+ *
+ * Since: 1.10
+ */
+guint
+gst_base_src_get_readahead (GstBaseSrc * src)
+{
+  guint res;
+
+  g_return_val_if_fail (GST_IS_BASE_SRC (src), 0);
+
+  GST_OBJECT_LOCK (src);
+  res = src->priv->readahead;
+  GST_OBJECT_UNLOCK (src);
+
+  return res;
+}
+
 /**
  * gst_base_src_new_seamless_segment:
  * @src: The source
@@ -1719,8 +1852,7 @@ gst_base_src_perform_seek (GstBaseSrc * src, GstEvent * event, gboolean unlock)
   src->running = TRUE;
   /* and restart the task in case it got paused explicitly or by
    * the FLUSH_START event we pushed out. */
-  tres = gst_pad_start_task (src->srcpad, (GstTaskFunction) gst_base_src_loop,
-      src->srcpad, NULL);
+  tres = gst_base_src_start_task (src);
   if (res && !tres)
     res = FALSE;
 
@@ -1806,8 +1938,7 @@ gst_base_src_send_event (GstElement * element, GstEvent * event)
       }
 
       if (start)
-        gst_pad_start_task (src->srcpad, (GstTaskFunction) gst_base_src_loop,
-            src->srcpad, NULL);
+        gst_base_src_start_task (src);
       GST_LIVE_UNLOCK (src);
       event = NULL;
       break;
@@ -2061,6 +2192,47 @@ subclass_failed:
   }
 }
 
+/* apply the realtime-priority to the streaming task, if there is one.
+ * Without @force, the default priority leaves the scheduling of the task to
+ * the application. */
+static void
+gst_base_src_configure_task_scheduling (GstBaseSrc * src, gboolean force)
+{
+  GstTask *task;
+  gint priority;
+
+  GST_OBJECT_LOCK (src);
+  priority = src->priv->realtime_priority;
+  GST_OBJECT_UNLOCK (src);
+
+  if (priority == 0 && !force)
+    return;
+
+  GST_OBJECT_LOCK (src->srcpad);
+  if ((task = GST_PAD_TASK (src->srcpad)))
+    gst_object_ref (task);
+  GST_OBJECT_UNLOCK (src->srcpad);
+
+  if (task) {
+    gst_task_set_scheduling (task, priority > 0 ? GST_TASK_SCHEDULING_FIFO :
+        GST_TASK_SCHEDULING_DEFAULT, priority);
+    gst_object_unref (task);
+  }
+}
+
+static gboolean
+gst_base_src_start_task (GstBaseSrc * src)
+{
+  gboolean res;
+
+  res = gst_pad_start_task (src->srcpad,
+      (GstTaskFunction) gst_base_src_task_func, src->srcpad, NULL);
+  if (res)
+    gst_base_src_configure_task_scheduling (src, FALSE);
+
+  return res;
+}
+
 static void
 gst_base_src_set_property (GObject * object, guint prop_id,
     const GValue * value, GParamSpec * pspec)
@@ -2082,6 +2254,15 @@ gst_base_src_set_property (GObject * object, guint prop_id,
     case PROP_DO_TIMESTAMP:
       gst_base_src_set_do_timestamp (src, g_value_get_boolean (value));
       break;
+    case PROP_READAHEAD:
+      gst_base_src_set_readahead (src, g_value_get_uint (value));
+      break;
+    case PROP_REALTIME_PRIORITY:
+      GST_OBJECT_LOCK (src);
+      src->priv->realtime_priority = g_value_get_int (value);
+      GST_OBJECT_UNLOCK (src);
+      gst_base_src_configure_task_scheduling (src, TRUE);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -2109,6 +2290,14 @@ gst_base_src_get_property (GObject * object, guint prop_id, GValue * value,
     case PROP_DO_TIMESTAMP:
       g_value_set_boolean (value, gst_base_src_get_do_timestamp (src));
       break;
+    case PROP_READAHEAD:
+      g_value_set_uint (value, gst_base_src_get_readahead (src));
+      break;
+    case PROP_REALTIME_PRIORITY:
+      GST_OBJECT_LOCK (src);
+      g_value_set_int (value, src->priv->realtime_priority);
+      GST_OBJECT_UNLOCK (src);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -2398,6 +2587,358 @@ unexpected_length:
   }
 }
 
+static void
+gst_base_src_block_free (GstBaseSrcBlock * block)
+{
+  gst_buffer_unref (block->buffer);
+  g_slice_free (GstBaseSrcBlock, block);
+}
+
+/* with ra_lock, find the cached block containing @offset */
+static GList *
+gst_base_src_readahead_find (GstBaseSrc * src, guint64 offset)
+{
+  GList *l;
+
+  for (l = src->priv->ra_blocks.head; l; l = l->next) {
+    GstBaseSrcBlock *block = l->data;
+
+    if (block->offset > offset)
+      break;
+    if (offset < block->offset + block->size)
+      return l;
+  }
+  return NULL;
+}
+
+/* with ra_lock, takes ownership of @buffer */
+static void
+gst_base_src_readahead_store (GstBaseSrc * src, guint64 offset,
+    GstBuffer * buffer)
+{
+  GstBaseSrcPrivate *priv = src->priv;
+  GstBaseSrcBlock *block;
+  GList *l;
+
+  block = g_slice_new (GstBaseSrcBlock);
+  block->offset = offset;
+  block->size = gst_buffer_get_size (buffer);
+  block->buffer = buffer;
+
+  /* keep the blocks sorted on offset, they are mostly appended */
+  for (l = priv->ra_blocks.tail; l; l = l->prev) {
+    if (((GstBaseSrcBlock *) l->data)->offset <= offset)
+      break;
+  }
+  if (l)
+    g_queue_insert_after (&priv->ra_blocks, l, block);
+  else
+    g_queue_push_head (&priv->ra_blocks, block);
+
+  while (priv->ra_blocks.length > 2 * priv->ra_max)
+    gst_base_src_block_free (g_queue_pop_head (&priv->ra_blocks));
+}
+
+/* with ra_lock, get the range from the cache or return %NULL */
+static GstBuffer *
+gst_base_src_readahead_lookup (GstBaseSrc * src, guint64 offset, guint length)
+{
+  GstBaseSrcBlock *block;
+  GstBuffer *res;
+  GList *l;
+
+  l = gst_base_src_readahead_find (src, offset);
+  if (l == NULL)
+    return NULL;
+
+  block = l->data;
+  if (offset + length > block->offset + block->size)
+    return NULL;
+
+  if (offset == block->offset && length == block->size) {
+    /* the common case, hand out the block itself */
+    res = block->buffer;
+    g_queue_delete_link (&src->priv->ra_blocks, l);
+    g_slice_free (GstBaseSrcBlock, block);
+  } else {
+    res = gst_buffer_copy_region (block->buffer, GST_BUFFER_COPY_ALL,
+        offset - block->offset, length);
+    if (GST_BUFFER_OFFSET_IS_VALID (block->buffer))
+      GST_BUFFER_OFFSET (res) = offset;
+  }
+  GST_LOG_OBJECT (src, "readahead hit offset %" G_GUINT64_FORMAT " length %u",
+      offset, length);
+
+  return res;
+}
+
+static void
+gst_base_src_readahead_loop (GstBaseSrc * src)
+{
+  GstBaseSrcClass *bclass;
+  GstBaseSrcPrivate *priv = src->priv;
+  GstBuffer *buffer = NULL;
+  GstFlowReturn ret;
+  guint64 offset;
+  guint length;
+  GList *l;
+
+  bclass = GST_BASE_SRC_GET_CLASS (src);
+
+  g_mutex_lock (&priv->ra_lock);
+  while (!priv->ra_flushing) {
+    if (priv->ra_next < priv->ra_end) {
+      /* skip what we have already */
+      if ((l = gst_base_src_readahead_find (src, priv->ra_next)) == NULL)
+        break;
+      priv->ra_next = ((GstBaseSrcBlock *) l->data)->offset +
+          ((GstBaseSrcBlock *) l->data)->size;
+      continue;
+    }
+    g_cond_wait (&priv->ra_cond, &priv->ra_lock);
+  }
+  if (priv->ra_flushing)
+    goto flushing;
+
+  offset = priv->ra_next;
+  length = priv->ra_blocksize;
+  g_mutex_unlock (&priv->ra_lock);
+
+  GST_LOG_OBJECT (src, "prefetching offset %" G_GUINT64_FORMAT " length %u",
+      offset, length);
+
+  g_mutex_lock (&priv->create_lock);
+  /* the pulling thread might have read this range itself in the meantime */
+  g_mutex_lock (&priv->ra_lock);
+  if (priv->ra_flushing || priv->ra_next != offset)
+    goto skip;
+  g_mutex_unlock (&priv->ra_lock);
+
+  ret = bclass->create (src, offset, length, &buffer);
+
+  g_mutex_lock (&priv->ra_lock);
+  if (ret == GST_FLOW_OK && !priv->ra_flushing) {
+    gsize size = gst_buffer_get_size (buffer);
+
+    if (priv->ra_next == offset) {
+      priv->ra_next = offset + size;
+      /* a short read means we are at the end */
+      if (size < length)
+        priv->ra_end = priv->ra_next;
+    }
+    gst_base_src_readahead_store (src, offset, buffer);
+  } else {
+    GST_DEBUG_OBJECT (src, "prefetch returned %s", gst_flow_get_name (ret));
+    if (ret == GST_FLOW_OK)
+      gst_buffer_unref (buffer);
+    /* stop here and let the pulling thread read this range itself so that
+     * it gets to see the flow return */
+    if (priv->ra_next == offset)
+      priv->ra_end = offset;
+  }
+  g_mutex_unlock (&priv->ra_lock);
+  g_mutex_unlock (&priv->create_lock);
+  return;
+
+skip:
+  {
+    g_mutex_unlock (&priv->ra_lock);
+    g_mutex_unlock (&priv->create_lock);
+    return;
+  }
+flushing:
+  {
+    g_mutex_unlock (&priv->ra_lock);
+    return;
+  }
+}
+
+/* must be called with LIVE_LOCK */
+static GstFlowReturn
+gst_base_src_readahead_create (GstBaseSrc * src, guint64 offset,
+    guint length, GstBuffer ** buf)
+{
+  GstBaseSrcClass *bclass;
+  GstBaseSrcPrivate *priv = src->priv;
+  GstBaseSrcBlock *block;
+  GstFlowReturn ret;
+  GstBuffer *res;
+
+  bclass = GST_BASE_SRC_GET_CLASS (src);
+
+  g_mutex_lock (&priv->ra_lock);
+  if (offset == priv->ra_last_end) {
+    /* sequential access, drop what was consumed and move the window */
+    while ((block = g_queue_peek_head (&priv->ra_blocks))
+        && block->offset + block->size <= offset)
+      gst_base_src_block_free (g_queue_pop_head (&priv->ra_blocks));
+
+    if (priv->ra_next < offset + length)
+      priv->ra_next = offset + length;
+    priv->ra_end = offset + length + (guint64) length * priv->ra_max;
+    priv->ra_blocksize = length;
+    g_cond_signal (&priv->ra_cond);
+  } else {
+    /* random access, stop prefetching until it becomes sequential again */
+    priv->ra_next = priv->ra_end = offset + length;
+  }
+  priv->ra_last_end = offset + length;
+
+  res = gst_base_src_readahead_lookup (src, offset, length);
+  g_mutex_unlock (&priv->ra_lock);
+
+  if (res) {
+    *buf = res;
+    return GST_FLOW_OK;
+  }
+
+  g_mutex_lock (&priv->create_lock);
+  /* the helper thread might just have read it */
+  g_mutex_lock (&priv->ra_lock);
+  res = gst_base_src_readahead_lookup (src, offset, length);
+  g_mutex_unlock (&priv->ra_lock);
+
+  if (res) {
+    *buf = res;
+    ret = GST_FLOW_OK;
+  } else {
+    ret = bclass->create (src, offset, length, buf);
+  }
+  g_mutex_unlock (&priv->create_lock);
+
+  return ret;
+}
+
+static void
+gst_base_src_readahead_start (GstBaseSrc * src)
+{
+  GstBaseSrcPrivate *priv = src->priv;
+  guint n_blocks;
+
+  GST_OBJECT_LOCK (src);
+  n_blocks = priv->readahead;
+  GST_OBJECT_UNLOCK (src);
+
+  if (n_blocks == 0 || src->is_live)
+    return;
+
+  GST_DEBUG_OBJECT (src, "prefetching up to %u blocks", n_blocks);
+
+  priv->ra_max = n_blocks;
+  priv->ra_flushing = FALSE;
+  priv->ra_last_end = priv->ra_next = priv->ra_end = 0;
+  priv->ra_task = gst_task_new ((GstTaskFunction) gst_base_src_readahead_loop,
+      src, NULL);
+  gst_task_set_lock (priv->ra_task, &priv->ra_task_lock);
+  gst_task_start (priv->ra_task);
+}
+
+static void
+gst_base_src_readahead_stop (GstBaseSrc * src)
+{
+  GstBaseSrcPrivate *priv = src->priv;
+  GstBaseSrcBlock *block;
+  GstTask *task;
+
+  if ((task = priv->ra_task) == NULL)
+    return;
+
+  gst_task_stop (task);
+  g_mutex_lock (&priv->ra_lock);
+  priv->ra_flushing = TRUE;
+  g_cond_signal (&priv->ra_cond);
+  g_mutex_unlock (&priv->ra_lock);
+  gst_task_join (task);
+
+  GST_LIVE_LOCK (src);
+  priv->ra_task = NULL;
+  while ((block = g_queue_pop_head (&priv->ra_blocks)))
+    gst_base_src_block_free (block);
+  GST_LIVE_UNLOCK (src);
+
+  gst_object_unref (task);
+}
+
+typedef struct
+{
+  /* timestamps of the first buffer for buffers without any */
+  GstClockTime dts, pts;
+  GstClockTimeDiff ts_offset;
+} ListTimestampData;
+
+static gboolean
+timestamp_list_buffer (GstBuffer ** buffer, guint idx, gpointer user_data)
+{
+  ListTimestampData *data = user_data;
+  GstBuffer *buf = *buffer;
+
+  if (!GST_CLOCK_TIME_IS_VALID (GST_BUFFER_DTS (buf))
+      && !GST_CLOCK_TIME_IS_VALID (GST_BUFFER_PTS (buf))) {
+    if (GST_CLOCK_TIME_IS_VALID (data->dts)
+        || GST_CLOCK_TIME_IS_VALID (data->pts)) {
+      buf = *buffer = gst_buffer_make_writable (buf);
+      GST_BUFFER_DTS (buf) = data->dts;
+      GST_BUFFER_PTS (buf) = data->pts;
+    }
+  } else if (data->ts_offset != 0) {
+    buf = *buffer = gst_buffer_make_writable (buf);
+    if (GST_CLOCK_TIME_IS_VALID (GST_BUFFER_PTS (buf)))
+      GST_BUFFER_PTS (buf) += data->ts_offset;
+    if (GST_CLOCK_TIME_IS_VALID (GST_BUFFER_DTS (buf)))
+      GST_BUFFER_DTS (buf) += data->ts_offset;
+  }
+
+  return TRUE;
+}
+
+/* the first buffer of a submitted list was timestamped and synced like any
+ * other buffer, do the same timestamping for the remaining ones. They were
+ * all created at once, so with do-timestamp they get the timestamps of the
+ * first buffer. */
+static void
+gst_base_src_timestamp_list (GstBaseSrc * src, GstBuffer * first,
+    GstBufferList * list)
+{
+  ListTimestampData data;
+  gboolean do_timestamp;
+
+  GST_OBJECT_LOCK (src);
+  do_timestamp = src->priv->do_timestamp;
+  GST_OBJECT_UNLOCK (src);
+
+  if (do_timestamp) {
+    data.dts = GST_BUFFER_DTS (first);
+    data.pts = GST_BUFFER_PTS (first);
+  } else {
+    data.dts = data.pts = GST_CLOCK_TIME_NONE;
+  }
+  data.ts_offset = src->is_live ? src->priv->ts_offset : 0;
+
+  gst_buffer_list_foreach (list, timestamp_list_buffer, &data);
+}
+
+/* drop the buffers at the end of @list that start after the segment stop
+ * in TIME format */
+static void
+gst_base_src_clip_list (GstBaseSrc * src, GstBufferList * list)
+{
+  guint len = gst_buffer_list_length (list);
+
+  while (len > 0) {
+    GstBuffer *buf = gst_buffer_list_get (list, len - 1);
+    GstClockTime ts = GST_BUFFER_PTS (buf);
+
+    if (!GST_CLOCK_TIME_IS_VALID (ts))
+      ts = GST_BUFFER_DTS (buf);
+    if (!GST_CLOCK_TIME_IS_VALID (ts) || ts < src->segment.stop)
+      break;
+
+    GST_LOG_OBJECT (src, "dropping buffer at %" GST_TIME_FORMAT
+        " after segment stop", GST_TIME_ARGS (ts));
+    gst_buffer_list_remove (list, --len, 1);
+  }
+}
+
 /* must be called with LIVE_LOCK */
 static GstFlowReturn
 gst_base_src_get_range (GstBaseSrc * src, guint64 offset, guint length,
@@ -2408,6 +2949,7 @@ gst_base_src_get_range (GstBaseSrc * src, guint64 offset, guint length,
   GstClockReturn status;
   GstBuffer *res_buf;
   GstBuffer *in_buf;
+  GstBufferList *res_list = NULL;
 
   bclass = GST_BASE_SRC_GET_CLASS (src);
 
@@ -2457,7 +2999,21 @@ again:
 
   res_buf = in_buf = *buf;
 
-  ret = bclass->create (src, offset, length, &res_buf);
+  if (src->priv->ra_task)
+    ret = gst_base_src_readahead_create (src, offset, length, &res_buf);
+  else
+    ret = bclass->create (src, offset, length, &res_buf);
+
+  /* a list was submitted, the first buffer goes through the usual
+   * timestamping and sync below */
+  if (G_UNLIKELY (src->priv->pending_bufferlist != NULL)) {
+    res_list = src->priv->pending_bufferlist;
+    src->priv->pending_bufferlist = NULL;
+    if (ret == GST_FLOW_OK && res_buf == NULL) {
+      res_buf = gst_buffer_ref (gst_buffer_list_get (res_list, 0));
+      gst_buffer_list_remove (res_list, 0, 1);
+    }
+  }
 
   /* The create function could be unlocked because we have a pending EOS. It's
    * possible that we have a valid buffer from create that we need to
@@ -2467,6 +3023,8 @@ again:
       if (*buf == NULL)
         gst_buffer_unref (res_buf);
     }
+    if (res_list)
+      gst_buffer_list_unref (res_list);
     src->priv->forced_eos = TRUE;
     goto eos;
   }
@@ -2537,6 +3095,10 @@ again:
          * pause and playing. We try to produce a new buffer */
         GST_DEBUG_OBJECT (src,
             "clock was unscheduled (%d), but we are running", status);
+        if (res_list) {
+          gst_buffer_list_unref (res_list);
+          res_list = NULL;
+        }
         goto again;
       }
       break;
@@ -2550,8 +3112,14 @@ again:
       ret = GST_FLOW_ERROR;
       break;
   }
-  if (G_LIKELY (ret == GST_FLOW_OK))
+  if (G_LIKELY (ret == GST_FLOW_OK)) {
     *buf = res_buf;
+    if (res_list)
+      gst_base_src_timestamp_list (src, res_buf, res_list);
+    src->priv->pending_bufferlist = res_list;
+  } else if (res_list) {
+    gst_buffer_list_unref (res_list);
+  }
 
   return ret;
 
@@ -2566,6 +3134,8 @@ not_ok:
   {
     GST_DEBUG_OBJECT (src, "create returned %d (%s)", ret,
         gst_flow_get_name (ret));
+    if (res_list)
+      gst_buffer_list_unref (res_list);
     return ret;
   }
 map_failed:
@@ -2603,6 +3173,8 @@ flushing:
     GST_DEBUG_OBJECT (src, "we are flushing");
     if (*buf == NULL)
       gst_buffer_unref (res_buf);
+    if (res_list)
+      gst_buffer_list_unref (res_list);
     return GST_FLOW_FLUSHING;
   }
 eos:
@@ -2627,6 +3199,55 @@ gst_base_src_getrange (GstPad * pad, GstObject * parent, guint64 offset,
 
   res = gst_base_src_get_range (src, offset, length, buf);
 
+  /* lists can only be pushed, the remaining buffers are lost here */
+  if (G_UNLIKELY (src->priv->pending_bufferlist != NULL)) {
+    g_warning ("%s: buffer lists can only be submitted in push mode",
+        GST_ELEMENT_NAME (src));
+    gst_buffer_list_unref (src->priv->pending_bufferlist);
+    src->priv->pending_bufferlist = NULL;
+  }
+
+done:
+  GST_LIVE_UNLOCK (src);
+
+  return res;
+
+  /* ERRORS */
+flushing:
+  {
+    GST_DEBUG_OBJECT (src, "we are flushing");
+    res = GST_FLOW_FLUSHING;
+    goto done;
+  }
+}
+
+/* all ranges are read with one take of the live lock */
+static GstFlowReturn
+gst_base_src_getranges (GstPad * pad, GstObject * parent,
+    const GstPadRange * ranges, guint n_ranges, GstBuffer ** buffers)
+{
+  GstBaseSrc *src;
+  GstFlowReturn res = GST_FLOW_OK;
+  guint i;
+
+  src = GST_BASE_SRC_CAST (parent);
+
+  GST_LIVE_LOCK (src);
+  for (i = 0; i < n_ranges && res == GST_FLOW_OK; i++) {
+    if (G_UNLIKELY (src->priv->flushing))
+      goto flushing;
+
+    res = gst_base_src_get_range (src, ranges[i].offset, ranges[i].size,
+        &buffers[i]);
+
+    if (G_UNLIKELY (src->priv->pending_bufferlist != NULL)) {
+      g_warning ("%s: buffer lists can only be submitted in push mode",
+          GST_ELEMENT_NAME (src));
+      gst_buffer_list_unref (src->priv->pending_bufferlist);
+      src->priv->pending_bufferlist = NULL;
+    }
+  }
+
 done:
   GST_LIVE_UNLOCK (src);
 
@@ -2664,11 +3285,23 @@ start_failed:
   }
 }
 
+/* releases the scratch memory used in each iteration of the loop */
+static void
+gst_base_src_task_func (GstPad * pad)
+{
+  GstScratchArenaMark mark;
+
+  gst_scratch_arena_enter (&mark);
+  gst_base_src_loop (pad);
+  gst_scratch_arena_leave (&mark);
+}
+
 static void
 gst_base_src_loop (GstPad * pad)
 {
   GstBaseSrc *src;
   GstBuffer *buf = NULL;
+  GstBufferList *blist = NULL;
   GstFlowReturn ret;
   gint64 position;
   gboolean eos;
@@ -2693,8 +3326,12 @@ gst_base_src_loop (GstPad * pad)
     goto flushing;
   GST_LIVE_UNLOCK (src);
 
-  /* check if we need to renegotiate */
-  if (gst_pad_check_reconfigure (pad)) {
+  /* check if we need to renegotiate. The flag is level-triggered, all the
+   * RECONFIGURE events since the last iteration are handled with a single
+   * negotiation. Peek at it first so that we don't take the pad lock for
+   * every buffer */
+  if (G_UNLIKELY (GST_PAD_NEEDS_RECONFIGURE (pad))
+      && gst_pad_check_reconfigure (pad)) {
     if (!gst_base_src_negotiate (src)) {
       gst_pad_mark_reconfigure (pad);
       if (GST_PAD_IS_FLUSHING (pad)) {
@@ -2744,6 +3381,9 @@ gst_base_src_loop (GstPad * pad)
   if (G_UNLIKELY (buf == NULL))
     goto null_buffer;
 
+  blist = src->priv->pending_bufferlist;
+  src->priv->pending_bufferlist = NULL;
+
   /* push events to close/start our segment before we push the buffer. */
   if (G_UNLIKELY (src->priv->segment_pending)) {
     GstEvent *seg_event = gst_event_new_segment (&src->segment);
@@ -2778,6 +3418,13 @@ gst_base_src_loop (GstPad * pad)
     {
       guint bufsize = gst_buffer_get_size (buf);
 
+      if (blist) {
+        guint i, len = gst_buffer_list_length (blist);
+
+        for (i = 0; i < len; i++)
+          bufsize += gst_buffer_get_size (gst_buffer_list_get (blist, i));
+      }
+
       /* we subtracted above for negative rates */
       if (src->segment.rate >= 0.0)
         position += bufsize;
@@ -2785,10 +3432,17 @@ gst_base_src_loop (GstPad * pad)
     }
     case GST_FORMAT_TIME:
     {
+      GstBuffer *last = buf;
       GstClockTime start, duration;
 
-      start = GST_BUFFER_TIMESTAMP (buf);
-      duration = GST_BUFFER_DURATION (buf);
+      if (blist && src->segment.rate >= 0.0 && src->segment.stop != -1)
+        gst_base_src_clip_list (src, blist);
+
+      if (blist && gst_buffer_list_length (blist) > 0)
+        last = gst_buffer_list_get (blist, gst_buffer_list_length (blist) - 1);
+
+      start = GST_BUFFER_TIMESTAMP (last);
+      duration = GST_BUFFER_DURATION (last);
 
       if (GST_CLOCK_TIME_IS_VALID (start))
         position = start;
@@ -2806,9 +3460,14 @@ gst_base_src_loop (GstPad * pad)
       break;
     }
     case GST_FORMAT_DEFAULT:
-      if (src->segment.rate >= 0.0)
-        position = GST_BUFFER_OFFSET_END (buf);
-      else
+      if (src->segment.rate >= 0.0) {
+        GstBuffer *last = buf;
+
+        if (blist && gst_buffer_list_length (blist) > 0)
+          last =
+              gst_buffer_list_get (blist, gst_buffer_list_length (blist) - 1);
+        position = GST_BUFFER_OFFSET_END (last);
+      } else
         position = GST_BUFFER_OFFSET (buf);
       break;
     default:
@@ -2847,7 +3506,12 @@ gst_base_src_loop (GstPad * pad)
   }
   GST_LIVE_UNLOCK (src);
 
-  ret = gst_pad_push (pad, buf);
+  if (blist) {
+    gst_buffer_list_insert (blist, 0, buf);
+    ret = gst_pad_push_list (pad, blist);
+  } else {
+    ret = gst_pad_push (pad, buf);
+  }
   if (G_UNLIKELY (ret != GST_FLOW_OK)) {
     if (ret == GST_FLOW_NOT_NEGOTIATED) {
       goto not_negotiated;
@@ -3538,6 +4202,7 @@ gst_base_src_stop (GstBaseSrc * basesrc)
   gst_base_src_set_flushing (basesrc, TRUE, FALSE, NULL);
   /* stop the task */
   gst_pad_stop_task (basesrc->srcpad);
+  gst_base_src_readahead_stop (basesrc);
 
   GST_OBJECT_LOCK (basesrc);
   if (!GST_BASE_SRC_IS_STARTED (basesrc) && !GST_BASE_SRC_IS_STARTING (basesrc))
@@ -3680,8 +4345,7 @@ gst_base_src_set_playing (GstBaseSrc * basesrc, gboolean live_play)
     start = (GST_PAD_MODE (basesrc->srcpad) == GST_PAD_MODE_PUSH);
     GST_OBJECT_UNLOCK (basesrc->srcpad);
     if (start)
-      gst_pad_start_task (basesrc->srcpad, (GstTaskFunction) gst_base_src_loop,
-          basesrc->srcpad, NULL);
+      gst_base_src_start_task (basesrc);
     GST_DEBUG_OBJECT (basesrc, "signal");
     GST_LIVE_SIGNAL (basesrc);
   }
@@ -3744,6 +4408,7 @@ gst_base_src_activate_pull (GstPad * pad, GstObject * parent, gboolean active)
     GST_DEBUG_OBJECT (basesrc, "Activating in pull mode");
     if (G_UNLIKELY (!gst_base_src_start (basesrc)))
       goto error_start;
+    gst_base_src_readahead_start (basesrc);
   } else {
     GST_DEBUG_OBJECT (basesrc, "Deactivating in pull mode");
     if (G_UNLIKELY (!gst_base_src_stop (basesrc)))
@@ -3881,6 +4546,39 @@ gst_base_src_get_buffer_pool (GstBaseSrc * src)
   return NULL;
 }
 
+/**
+ * gst_base_src_submit_buffer_list:
+ * @src: a #GstBaseSrc
+ * @buffer_list: (transfer full): a #GstBufferList
+ *
+ * Subclasses can call this from their create virtual method implementation
+ * to push out several buffers at once in a #GstBufferList. This avoids the
+ * per-buffer overhead of the downstream elements for packetised data.
+ *
+ * The create function must then return %GST_FLOW_OK without a buffer. This
+ * function must only be called once per create call, with a non-empty list,
+ * and only when the source operates in push mode.
+ *
+ * The list is handled as a whole: it counts as one buffer for
+ * #GstBaseSrc:num-buffers, the remaining buffers get the timestamp offset of
+ * live sources and, with #GstBaseSrc:do-timestamp, the timestamps of the
+ * first buffer when they have none, and buffers that start after the stop of
+ * a TIME segment are dropped from the end of the list.
+ *
+ * Since: 1.10
+ */
+void
+gst_base_src_submit_buffer_list (GstBaseSrc * src, GstBufferList * buffer_list)
+{
+  g_return_if_fail (GST_IS_BASE_SRC (src));
+  g_return_if_fail (GST_IS_BUFFER_LIST (buffer_list));
+  g_return_if_fail (gst_buffer_list_length (buffer_list) > 0);
+  g_return_if_fail (src->priv->pending_bufferlist == NULL);
+
+  /* the first buffer is taken out again in get_range */
+  src->priv->pending_bufferlist = gst_buffer_list_make_writable (buffer_list);
+}
+
 /**
  * gst_base_src_get_allocator:
  * @src: a #GstBaseSrc
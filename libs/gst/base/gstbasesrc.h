@@ -262,11 +262,16 @@ guint           gst_base_src_get_blocksize    (GstBaseSrc *src);
 void            gst_base_src_set_do_timestamp (GstBaseSrc *src, gboolean timestamp);
 gboolean        gst_base_src_get_do_timestamp (GstBaseSrc *src);
 
+void            gst_base_src_set_readahead    (GstBaseSrc *src, guint n_blocks);
+guint           gst_base_src_get_readahead    (GstBaseSrc *src);
+
 gboolean        gst_base_src_new_seamless_segment (GstBaseSrc *src, gint64 start, gint64 stop, gint64 time);
 
 gboolean        gst_base_src_set_caps         (GstBaseSrc *src, GstCaps *caps);
 
 GstBufferPool * gst_base_src_get_buffer_pool  (GstBaseSrc *src);
+void            gst_base_src_submit_buffer_list (GstBaseSrc *src,
+                                                 GstBufferList *buffer_list);
 void            gst_base_src_get_allocator    (GstBaseSrc *src,
                                                GstAllocator **allocator,
                                                GstAllocationParams *params);
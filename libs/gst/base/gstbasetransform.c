@@ -215,6 +215,7 @@
 #include "../../../gst/gst-i18n-lib.h"
 #include "../../../gst/glib-compat-private.h"
 #include "gstbasetransform.h"
+#include "gstscratcharena.h"
 
 GST_DEBUG_CATEGORY_STATIC (gst_base_transform_debug);
 #define GST_CAT_DEFAULT gst_base_transform_debug
@@ -227,11 +228,13 @@ enum
 };
 
 #define DEFAULT_PROP_QOS	FALSE
+#define DEFAULT_PROP_N_THREADS	0
 
 enum
 {
   PROP_0,
-  PROP_QOS
+  PROP_QOS,
+  PROP_N_THREADS
 };
 
 #define GST_BASE_TRANSFORM_GET_PRIVATE(obj)  \
@@ -274,8 +277,31 @@ struct _GstBaseTransformPrivate
   GstAllocator *allocator;
   GstAllocationParams params;
   GstQuery *query;
+
+  /* with LOCK, threads used for transform_slice, 0 for the default */
+  guint n_threads;
+
+  /* with LOCK, the subclass vmethods don't need to see passthrough buffers */
+  gboolean bypass_allowed;
+  /* with LOCK, buffers skip the element from the sinkpad to the srcpad */
+  gboolean bypass;
+
+  /* atomic, a RECONFIGURE event was forwarded upstream and no buffer was
+   * handled since. Later ones are merged into it while upstream still
+   * needs to renegotiate */
+  gint reconfigure_pending;
 };
 
+/* threads used for transform_slice by the elements that don't configure it,
+ * 0 is one per processor */
+static gint default_n_threads = 1;
+
+/* upper limit for the number of slices of a buffer */
+#define MAX_SLICES 64
+
+/* the pool the slices of all elements are run on */
+static GstTaskPool *slice_pool = NULL;
+
 
 static GstElementClass *parent_class = NULL;
 
@@ -403,6 +429,21 @@ gst_base_transform_class_init (GstBaseTransformClass * klass)
       g_param_spec_boolean ("qos", "QoS", "Handle Quality-of-Service events",
           DEFAULT_PROP_QOS, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstBaseTransform:n-threads:
+   *
+   * The number of threads used to process the slices of a buffer when the
+   * subclass implements the transform_slice vmethod. 0 uses the default set
+   * with gst_base_transform_set_default_n_threads().
+   *
+   * Since: 1.10
+   */
+  g_object_class_install_property (gobject_class, PROP_N_THREADS,
+      g_param_spec_uint ("n-threads", "Number of threads",
+          "Number of threads used to transform a buffer (0 = default)",
+          0, G_MAXUINT, DEFAULT_PROP_N_THREADS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gobject_class->finalize = gst_base_transform_finalize;
 
   klass->passthrough_on_same_caps = FALSE;
@@ -478,6 +519,7 @@ gst_base_transform_init (GstBaseTransform * trans,
   priv->pad_mode = GST_PAD_MODE_NONE;
   priv->gap_aware = FALSE;
   priv->prefer_passthrough = TRUE;
+  priv->n_threads = DEFAULT_PROP_N_THREADS;
 
   priv->passthrough = FALSE;
   if (bclass->transform == NULL) {
@@ -1556,7 +1598,9 @@ gst_base_transform_default_query (GstBaseTransform * trans,
       GstFormat format;
 
       gst_query_parse_position (query, &format, NULL);
-      if (format == GST_FORMAT_TIME && trans->segment.format == GST_FORMAT_TIME) {
+      /* we don't see the buffers to track the position while bypassed */
+      if (format == GST_FORMAT_TIME && trans->segment.format == GST_FORMAT_TIME
+          && !trans->priv->bypass) {
         gint64 pos;
         ret = TRUE;
 
@@ -1894,6 +1938,14 @@ gst_base_transform_sink_event (GstPad * pad, GstObject * parent,
   trans = GST_BASE_TRANSFORM (parent);
   bclass = GST_BASE_TRANSFORM_GET_CLASS (trans);
 
+  /* events can change the configuration, let the following buffers take the
+   * normal path until the next one has been handled */
+  if (G_UNLIKELY (trans->priv->bypass)) {
+    GST_OBJECT_LOCK (trans);
+    gst_base_transform_set_bypass (trans, FALSE);
+    GST_OBJECT_UNLOCK (trans);
+  }
+
   if (bclass->sink_event)
     ret = bclass->sink_event (trans, event);
   else
@@ -1924,6 +1976,7 @@ gst_base_transform_sink_eventfunc (GstBaseTransform * trans, GstEvent * event)
       trans->have_segment = FALSE;
       gst_segment_init (&trans->segment, GST_FORMAT_UNDEFINED);
       priv->position_out = GST_CLOCK_TIME_NONE;
+      g_atomic_int_set (&priv->reconfigure_pending, 0);
       break;
     case GST_EVENT_EOS:
       break;
@@ -1981,6 +2034,30 @@ gst_base_transform_src_event (GstPad * pad, GstObject * parent,
   return ret;
 }
 
+/* check if a RECONFIGURE event from downstream needs to go upstream. The
+ * flag it sets on the peer of the sinkpad is level-triggered, so while the
+ * event we forwarded before was not handled yet the new one only repeats
+ * the renegotiation that is already pending upstream */
+static gboolean
+gst_base_transform_forward_reconfigure (GstBaseTransform * trans)
+{
+  GstPad *peer;
+  gboolean pending;
+
+  if (g_atomic_int_compare_and_exchange (&trans->priv->reconfigure_pending, 0,
+          1))
+    return TRUE;
+
+  peer = gst_pad_get_peer (trans->sinkpad);
+  if (peer == NULL)
+    return TRUE;
+
+  pending = gst_pad_needs_reconfigure (peer);
+  gst_object_unref (peer);
+
+  return !pending;
+}
+
 static gboolean
 gst_base_transform_src_eventfunc (GstBaseTransform * trans, GstEvent * event)
 {
@@ -2003,6 +2080,13 @@ gst_base_transform_src_eventfunc (GstBaseTransform * trans, GstEvent * event)
       gst_base_transform_update_qos (trans, proportion, diff, timestamp);
       break;
     }
+    case GST_EVENT_RECONFIGURE:
+      if (!gst_base_transform_forward_reconfigure (trans)) {
+        GST_DEBUG_OBJECT (trans, "upstream still needs to reconfigure");
+        gst_event_unref (event);
+        return TRUE;
+      }
+      break;
     default:
       break;
   }
@@ -2087,13 +2171,16 @@ default_submit_input_buffer (GstBaseTransform * trans, gboolean is_discont,
           timestamp);
       jitter = GST_CLOCK_DIFF (running_time, earliest_time);
 
-      qos_msg =
-          gst_message_new_qos (GST_OBJECT_CAST (trans), FALSE, running_time,
-          stream_time, timestamp, duration);
-      gst_message_set_qos_values (qos_msg, jitter, proportion, 1000000);
-      gst_message_set_qos_stats (qos_msg, GST_FORMAT_BUFFERS,
-          priv->processed, priv->dropped);
-      gst_element_post_message (GST_ELEMENT_CAST (trans), qos_msg);
+      if (gst_element_message_will_be_posted (GST_ELEMENT_CAST (trans),
+              GST_MESSAGE_QOS)) {
+        qos_msg =
+            gst_message_new_qos (GST_OBJECT_CAST (trans), FALSE, running_time,
+            stream_time, timestamp, duration);
+        gst_message_set_qos_values (qos_msg, jitter, proportion, 1000000);
+        gst_message_set_qos_stats (qos_msg, GST_FORMAT_BUFFERS,
+            priv->processed, priv->dropped);
+        gst_element_post_message (GST_ELEMENT_CAST (trans), qos_msg);
+      }
 
       /* mark discont for next buffer */
       priv->discont = TRUE;
@@ -2122,6 +2209,151 @@ not_negotiated:
   }
 }
 
+typedef struct
+{
+  GMutex lock;
+  GCond cond;
+  guint pending;
+} SliceJoin;
+
+typedef struct
+{
+  GstBaseTransform *trans;
+  GstBuffer *inbuf;
+  GstBuffer *outbuf;
+  guint slice;
+  guint n_slices;
+  GstFlowReturn ret;
+  SliceJoin *join;
+} SliceJob;
+
+static gpointer
+gst_base_transform_init_slice_pool (gpointer data)
+{
+  GstTaskPool *pool;
+  GError *err = NULL;
+
+  pool = gst_task_pool_new ();
+  gst_task_pool_prepare (pool, &err);
+  if (err) {
+    GST_WARNING ("could not prepare the slice pool: %s", err->message);
+    g_clear_error (&err);
+  }
+  GST_OBJECT_FLAG_SET (pool, GST_OBJECT_FLAG_MAY_BE_LEAKED);
+  slice_pool = pool;
+
+  return NULL;
+}
+
+static void
+gst_base_transform_run_slice (SliceJob * job)
+{
+  GstBaseTransformClass *bclass = GST_BASE_TRANSFORM_GET_CLASS (job->trans);
+
+  job->ret = bclass->transform_slice (job->trans, job->inbuf, job->outbuf,
+      job->slice, job->n_slices);
+}
+
+static void
+gst_base_transform_pool_slice (SliceJob * job)
+{
+  SliceJoin *join = job->join;
+
+  gst_base_transform_run_slice (job);
+
+  g_mutex_lock (&join->lock);
+  if (--join->pending == 0)
+    g_cond_signal (&join->cond);
+  g_mutex_unlock (&join->lock);
+}
+
+/* the number of slices to split each buffer in */
+static guint
+gst_base_transform_get_n_slices (GstBaseTransform * trans)
+{
+  guint n_threads;
+
+  GST_OBJECT_LOCK (trans);
+  n_threads = trans->priv->n_threads;
+  GST_OBJECT_UNLOCK (trans);
+
+  if (n_threads == 0)
+    n_threads = g_atomic_int_get (&default_n_threads);
+  if (n_threads == 0)
+    n_threads = g_get_num_processors ();
+
+  return MIN (n_threads, MAX_SLICES);
+}
+
+/* run the slices of the buffer on the slice pool and wait for all of them to
+ * finish. The first slice is processed on the streaming thread. */
+static GstFlowReturn
+gst_base_transform_transform_slices (GstBaseTransform * trans,
+    GstBuffer * inbuf, GstBuffer * outbuf, guint n_slices)
+{
+  static GOnce pool_once = G_ONCE_INIT;
+  GstFlowReturn ret = GST_FLOW_OK;
+  SliceJoin join;
+  SliceJob *jobs;
+  guint i;
+
+  g_once (&pool_once, gst_base_transform_init_slice_pool, NULL);
+
+  GST_LOG_OBJECT (trans, "transforming %u slices", n_slices);
+
+  g_mutex_init (&join.lock);
+  g_cond_init (&join.cond);
+  join.pending = 0;
+
+  jobs = g_newa (SliceJob, n_slices);
+  for (i = 0; i < n_slices; i++) {
+    jobs[i].trans = trans;
+    jobs[i].inbuf = inbuf;
+    jobs[i].outbuf = outbuf;
+    jobs[i].slice = i;
+    jobs[i].n_slices = n_slices;
+    jobs[i].ret = GST_FLOW_OK;
+    jobs[i].join = &join;
+  }
+
+  for (i = 1; i < n_slices; i++) {
+    GError *err = NULL;
+
+    g_mutex_lock (&join.lock);
+    join.pending++;
+    g_mutex_unlock (&join.lock);
+
+    gst_task_pool_push (slice_pool,
+        (GstTaskPoolFunction) gst_base_transform_pool_slice, &jobs[i], &err);
+    if (err) {
+      GST_WARNING_OBJECT (trans, "could not push slice %u: %s", i,
+          err->message);
+      g_clear_error (&err);
+      /* run it here then */
+      gst_base_transform_pool_slice (&jobs[i]);
+    }
+  }
+
+  gst_base_transform_run_slice (&jobs[0]);
+
+  g_mutex_lock (&join.lock);
+  while (join.pending > 0)
+    g_cond_wait (&join.cond, &join.lock);
+  g_mutex_unlock (&join.lock);
+
+  g_cond_clear (&join.cond);
+  g_mutex_clear (&join.lock);
+
+  for (i = 0; i < n_slices; i++) {
+    if (jobs[i].ret != GST_FLOW_OK) {
+      ret = jobs[i].ret;
+      break;
+    }
+  }
+
+  return ret;
+}
+
 static GstFlowReturn
 default_generate_output (GstBaseTransform * trans, GstBuffer ** outbuf)
 {
@@ -2168,15 +2400,27 @@ default_generate_output (GstBaseTransform * trans, GstBuffer ** outbuf)
       GST_DEBUG_OBJECT (trans, "element is in passthrough");
     }
   } else {
+    guint n_slices = 1;
+
     want_in_place = (bclass->transform_ip != NULL) && priv->always_in_place;
 
+    if (bclass->transform_slice)
+      n_slices = gst_base_transform_get_n_slices (trans);
+
     if (want_in_place) {
       GST_DEBUG_OBJECT (trans, "doing inplace transform");
-      ret = bclass->transform_ip (trans, *outbuf);
+      if (n_slices > 1)
+        ret = gst_base_transform_transform_slices (trans, *outbuf, *outbuf,
+            n_slices);
+      else
+        ret = bclass->transform_ip (trans, *outbuf);
     } else {
       GST_DEBUG_OBJECT (trans, "doing non-inplace transform");
 
-      if (bclass->transform)
+      if (bclass->transform && n_slices > 1)
+        ret = gst_base_transform_transform_slices (trans, inbuf, *outbuf,
+            n_slices);
+      else if (bclass->transform)
         ret = bclass->transform (trans, inbuf, *outbuf);
       else
         ret = GST_FLOW_NOT_SUPPORTED;
@@ -2223,6 +2467,9 @@ gst_base_transform_getrange (GstPad * pad, GstObject * parent, guint64 offset,
   GstBuffer *inbuf = NULL;
   GstBuffer *outbuf = NULL;
 
+  if (G_UNLIKELY (g_atomic_int_get (&priv->reconfigure_pending)))
+    g_atomic_int_set (&priv->reconfigure_pending, 0);
+
   /* Try and generate a buffer, if the sub-class wants more data,
    * pull some and repeat until a buffer (or error) is produced */
   do {
@@ -2287,6 +2534,42 @@ pull_error:
   }
 }
 
+/* check if buffers can skip @trans and go from the sinkpad directly to the
+ * peer of the srcpad. with LOCK */
+static gboolean
+gst_base_transform_can_bypass (GstBaseTransform * trans)
+{
+  GstBaseTransformClass *bclass = GST_BASE_TRANSFORM_GET_CLASS (trans);
+  GstBaseTransformPrivate *priv = trans->priv;
+
+  if (!priv->passthrough || priv->qos_enabled || priv->discont
+      || priv->pad_mode != GST_PAD_MODE_PUSH)
+    return FALSE;
+
+  if (bclass->transform_ip_on_passthrough && bclass->transform_ip)
+    return FALSE;
+
+  if (priv->bypass_allowed)
+    return TRUE;
+
+  return bclass->before_transform == NULL
+      && bclass->submit_input_buffer == default_submit_input_buffer
+      && bclass->generate_output == default_generate_output
+      && bclass->prepare_output_buffer == default_prepare_output_buffer;
+}
+
+/* with LOCK */
+static void
+gst_base_transform_set_bypass (GstBaseTransform * trans, gboolean bypass)
+{
+  if (trans->priv->bypass == bypass)
+    return;
+
+  GST_DEBUG_OBJECT (trans, "set bypass %d", bypass);
+  trans->priv->bypass = bypass;
+  gst_pad_set_bypass_pad (trans->sinkpad, bypass ? trans->srcpad : NULL);
+}
+
 /* The flow of the chain function is the reverse of the
  * getrange() function - we have data, feed it to the sub-class
  * and then iterate, pushing buffers it generates until it either
@@ -2301,6 +2584,13 @@ gst_base_transform_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
   GstClockTime position = GST_CLOCK_TIME_NONE;
   GstClockTime timestamp, duration;
   GstBuffer *outbuf = NULL;
+  GstScratchArenaMark mark;
+
+  gst_scratch_arena_enter (&mark);
+
+  /* upstream handled the pending RECONFIGURE before pushing this buffer */
+  if (G_UNLIKELY (g_atomic_int_get (&priv->reconfigure_pending)))
+    g_atomic_int_set (&priv->reconfigure_pending, 0);
 
   timestamp = GST_BUFFER_TIMESTAMP (buffer);
   duration = GST_BUFFER_DURATION (buffer);
@@ -2382,6 +2672,16 @@ done:
     ret = GST_FLOW_OK;
   }
 
+  /* the next buffers can skip us if we only pass them on */
+  if (ret == GST_FLOW_OK && !priv->bypass) {
+    GST_OBJECT_LOCK (trans);
+    if (gst_base_transform_can_bypass (trans))
+      gst_base_transform_set_bypass (trans, TRUE);
+    GST_OBJECT_UNLOCK (trans);
+  }
+
+  gst_scratch_arena_leave (&mark);
+
   return ret;
 }
 
@@ -2397,6 +2697,9 @@ gst_base_transform_set_property (GObject * object, guint prop_id,
     case PROP_QOS:
       gst_base_transform_set_qos_enabled (trans, g_value_get_boolean (value));
       break;
+    case PROP_N_THREADS:
+      gst_base_transform_set_n_threads (trans, g_value_get_uint (value));
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -2415,6 +2718,9 @@ gst_base_transform_get_property (GObject * object, guint prop_id,
     case PROP_QOS:
       g_value_set_boolean (value, gst_base_transform_is_qos_enabled (trans));
       break;
+    case PROP_N_THREADS:
+      g_value_set_uint (value, gst_base_transform_get_n_threads (trans));
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -2457,12 +2763,17 @@ gst_base_transform_activate (GstBaseTransform * trans, gboolean active)
     priv->processed = 0;
     priv->dropped = 0;
     GST_OBJECT_UNLOCK (trans);
+    g_atomic_int_set (&priv->reconfigure_pending, 0);
 
     if (incaps)
       gst_caps_unref (incaps);
     if (outcaps)
       gst_caps_unref (outcaps);
   } else {
+    GST_OBJECT_LOCK (trans);
+    gst_base_transform_set_bypass (trans, FALSE);
+    GST_OBJECT_UNLOCK (trans);
+
     /* We must make sure streaming has finished before resetting things
      * and calling the ::stop vfunc */
     GST_PAD_STREAM_LOCK (trans->sinkpad);
@@ -2575,6 +2886,8 @@ gst_base_transform_set_passthrough (GstBaseTransform * trans,
   } else {
     trans->priv->passthrough = TRUE;
   }
+  if (!trans->priv->passthrough)
+    gst_base_transform_set_bypass (trans, FALSE);
 
   GST_DEBUG_OBJECT (trans, "set passthrough %d", trans->priv->passthrough);
   GST_OBJECT_UNLOCK (trans);
@@ -2717,6 +3030,8 @@ gst_base_transform_set_qos_enabled (GstBaseTransform * trans, gboolean enabled)
 
   GST_OBJECT_LOCK (trans);
   trans->priv->qos_enabled = enabled;
+  if (enabled)
+    gst_base_transform_set_bypass (trans, FALSE);
   GST_OBJECT_UNLOCK (trans);
 }
 
@@ -2744,6 +3059,78 @@ gst_base_transform_is_qos_enabled (GstBaseTransform * trans)
   return result;
 }
 
+/**
+ * gst_base_transform_set_n_threads:
+ * @trans: a #GstBaseTransform
+ * @n_threads: the number of threads, or 0 for the default
+ *
+ * Set the number of threads that are used to process each buffer when the
+ * subclass implements the transform_slice vmethod. Each buffer is split in
+ * @n_threads slices that are processed in parallel. When @n_threads is 0,
+ * the default set with gst_base_transform_set_default_n_threads() is used.
+ *
+ * MT safe.
+ *
+ * Since: 1.10
+ */
+void
+gst_base_transform_set_n_threads (GstBaseTransform * trans, guint n_threads)
+{
+  g_return_if_fail (GST_IS_BASE_TRANSFORM (trans));
+
+  GST_OBJECT_LOCK (trans);
+  trans->priv->n_threads = n_threads;
+  GST_DEBUG_OBJECT (trans, "set n_threads %u", n_threads);
+  GST_OBJECT_UNLOCK (trans);
+}
+
+/**
+ * gst_base_transform_get_n_threads:
+ * @trans: a #GstBaseTransform
+ *
+ * Get the number of threads configured with
+ * gst_base_transform_set_n_threads().
+ *
+ * Returns: the number of threads, 0 when the default is used.
+ *
+ * MT safe.
+ *
+ * Since: 1.10
+ */
+guint
+gst_base_transform_get_n_threads (GstBaseTransform * trans)
+{
+  guint result;
+
+  g_return_val_if_fail (GST_IS_BASE_TRANSFORM (trans), 0);
+
+  GST_OBJECT_LOCK (trans);
+  result = trans->priv->n_threads;
+  GST_OBJECT_UNLOCK (trans);
+
+  return result;
+}
+
+/**
+ * gst_base_transform_set_default_n_threads:
+ * @n_threads: the number of threads, or 0 for one per processor
+ *
+ * Set the number of threads that are used to process each buffer by all the
+ * #GstBaseTransform elements that did not configure their own with
+ * gst_base_transform_set_n_threads(). The default is 1, which does not split
+ * the buffers into slices.
+ *
+ * MT safe.
+ *
+ * Since: 1.10
+ */
+void
+gst_base_transform_set_default_n_threads (guint n_threads)
+{
+  GST_DEBUG ("set default n_threads %u", n_threads);
+  g_atomic_int_set (&default_n_threads, n_threads);
+}
+
 /**
  * gst_base_transform_set_gap_aware:
  * @trans: a #GstBaseTransform
@@ -2800,6 +3187,41 @@ gst_base_transform_set_prefer_passthrough (GstBaseTransform * trans,
   GST_OBJECT_UNLOCK (trans);
 }
 
+/**
+ * gst_base_transform_set_bypass_allowed:
+ * @trans: a #GstBaseTransform
+ * @allowed: New state
+ *
+ * In passthrough mode, without QoS and without a transform_ip function
+ * that wants to see passthrough buffers, @trans lets buffers go from its
+ * sinkpad directly to the peer of its srcpad, see gst_pad_set_bypass_pad().
+ * The bypass starts after a buffer was handled normally and ends with the
+ * next event.
+ *
+ * By default this is only done when @trans does not override the
+ * before_transform, submit_input_buffer, generate_output and
+ * prepare_output_buffer vmethods. Subclasses that do, but don't need to see
+ * the buffers in passthrough mode after the first one, set @allowed to
+ * %TRUE.
+ *
+ * MT safe.
+ *
+ * Since: 1.10
+ */
+void
+gst_base_transform_set_bypass_allowed (GstBaseTransform * trans,
+    gboolean allowed)
+{
+  g_return_if_fail (GST_IS_BASE_TRANSFORM (trans));
+
+  GST_OBJECT_LOCK (trans);
+  trans->priv->bypass_allowed = allowed;
+  GST_DEBUG_OBJECT (trans, "bypass allowed %d", allowed);
+  if (!gst_base_transform_can_bypass (trans))
+    gst_base_transform_set_bypass (trans, FALSE);
+  GST_OBJECT_UNLOCK (trans);
+}
+
 /**
  * gst_base_transform_reconfigure_sink:
  * @trans: a #GstBaseTransform
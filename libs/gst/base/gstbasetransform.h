@@ -208,6 +208,15 @@ struct _GstBaseTransform {
  *                   do 1-to-1 transformations on input to output buffers can either
  *                   return GST_BASE_TRANSFORM_FLOW_DROPPED or simply not generate
  *                   an output buffer until they are ready to do so. (Since 1.6)
+ * @transform_slice: Optional. Transforms slice @slice of @n_slices of the
+ *                   input buffer into the output buffer. The slices must be
+ *                   independent of each other, e.g. ranges of rows or of
+ *                   samples, as they are processed at the same time from
+ *                   different threads. For in-place transforms @inbuf and
+ *                   @outbuf are the same buffer. When more than one thread is
+ *                   configured with gst_base_transform_set_n_threads(), this
+ *                   is called instead of @transform or @transform_ip, which
+ *                   must still be provided. (Since 1.10)
  *                   
  * Subclasses can override any of the available virtual methods or not, as
  * needed. At minimum either @transform or @transform_ip need to be overridden.
@@ -280,8 +289,12 @@ struct _GstBaseTransformClass {
   GstFlowReturn (*submit_input_buffer) (GstBaseTransform *trans, gboolean is_discont, GstBuffer *input);
   GstFlowReturn (*generate_output) (GstBaseTransform *trans, GstBuffer **outbuf);
 
+  GstFlowReturn (*transform_slice) (GstBaseTransform *trans, GstBuffer *inbuf,
+                                    GstBuffer *outbuf, guint slice,
+                                    guint n_slices);
+
   /*< private >*/
-  gpointer       _gst_reserved[GST_PADDING_LARGE - 2];
+  gpointer       _gst_reserved[GST_PADDING_LARGE - 3];
 };
 
 GType           gst_base_transform_get_type         (void);
@@ -308,6 +321,15 @@ void            gst_base_transform_set_gap_aware    (GstBaseTransform *trans,
 void            gst_base_transform_set_prefer_passthrough (GstBaseTransform *trans,
                                                            gboolean prefer_passthrough);
 
+void            gst_base_transform_set_bypass_allowed (GstBaseTransform *trans,
+                                                       gboolean allowed);
+
+void            gst_base_transform_set_n_threads    (GstBaseTransform *trans,
+                                                     guint n_threads);
+guint           gst_base_transform_get_n_threads    (GstBaseTransform *trans);
+
+void            gst_base_transform_set_default_n_threads (guint n_threads);
+
 GstBufferPool * gst_base_transform_get_buffer_pool  (GstBaseTransform *trans);
 void            gst_base_transform_get_allocator    (GstBaseTransform *trans,
                                                      GstAllocator **allocator,
@@ -33,7 +33,8 @@
  *
  * #GstBitReader provides a bit reader that can read any number of bits
  * from a memory buffer. It provides functions for reading any number of bits
- * into 8, 16, 32 and 64 bit variables.
+ * into 8, 16, 32 and 64 bit variables, and for reading the Exp-Golomb codes
+ * used in H.264 and H.265 bitstreams.
  */
 
 /**
@@ -293,3 +294,39 @@ GST_BIT_READER_READ_BITS (8);
 GST_BIT_READER_READ_BITS (16);
 GST_BIT_READER_READ_BITS (32);
 GST_BIT_READER_READ_BITS (64);
+
+/**
+ * gst_bit_reader_get_ue:
+ * @reader: a #GstBitReader instance
+ * @val: (out): Pointer to a #guint32 to store the result
+ *
+ * Read an unsigned Exp-Golomb code, the ue(v) syntax element of
+ * H.264 and H.265, into @val and update the current position.
+ *
+ * Returns: %TRUE if successful, %FALSE otherwise.
+ *
+ * Since: 1.10
+ */
+gboolean
+gst_bit_reader_get_ue (GstBitReader * reader, guint32 * val)
+{
+  return _gst_bit_reader_get_ue_inline (reader, val);
+}
+
+/**
+ * gst_bit_reader_get_se:
+ * @reader: a #GstBitReader instance
+ * @val: (out): Pointer to a #gint32 to store the result
+ *
+ * Read a signed Exp-Golomb code, the se(v) syntax element of
+ * H.264 and H.265, into @val and update the current position.
+ *
+ * Returns: %TRUE if successful, %FALSE otherwise.
+ *
+ * Since: 1.10
+ */
+gboolean
+gst_bit_reader_get_se (GstBitReader * reader, gint32 * val)
+{
+  return _gst_bit_reader_get_se_inline (reader, val);
+}
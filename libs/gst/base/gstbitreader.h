@@ -75,6 +75,9 @@ gboolean        gst_bit_reader_peek_bits_uint16 (const GstBitReader *reader, gui
 gboolean        gst_bit_reader_peek_bits_uint32 (const GstBitReader *reader, guint32 *val, guint nbits);
 gboolean        gst_bit_reader_peek_bits_uint64 (const GstBitReader *reader, guint64 *val, guint nbits);
 
+gboolean        gst_bit_reader_get_ue           (GstBitReader *reader, guint32 *val);
+gboolean        gst_bit_reader_get_se           (GstBitReader *reader, gint32 *val);
+
 /**
  * GST_BIT_READER_INIT:
  * @data: Data from which the #GstBitReader should read
@@ -118,6 +121,16 @@ gst_bit_reader_peek_bits_uint##bits##_unchecked (const GstBitReader *reader, gui
   byte = reader->byte; \
   bit = reader->bit; \
   \
+  /* take all bits from one big endian word when there is enough data */ \
+  if (G_LIKELY (nbits > 0 && byte + 8 <= reader->size)) { \
+    guint64 word = GST_READ_UINT64_BE (data + byte) << bit; \
+    \
+    if (G_UNLIKELY (bit + nbits > 64)) \
+      word |= data[byte + 8] >> (8 - bit); \
+    \
+    return (guint##bits) (word >> (64 - nbits)); \
+  } \
+  \
   while (nbits > 0) { \
     guint toread = MIN (nbits, 8 - bit); \
     \
@@ -154,6 +167,23 @@ __GST_BIT_READER_READ_BITS_UNCHECKED (64)
 
 #undef __GST_BIT_READER_READ_BITS_UNCHECKED
 
+/* count the leading zero bits of @v, which must not be 0 */
+static inline guint
+_gst_bit_reader_clz32 (guint32 v)
+{
+#if defined(__GNUC__) && (__GNUC__ > 3 || (__GNUC__ == 3 && __GNUC_MINOR__ >= 4))
+  return __builtin_clz (v);
+#else
+  guint n = 0;
+
+  while (!(v & 0x80000000)) {
+    v <<= 1;
+    n++;
+  }
+  return n;
+#endif
+}
+
 /* unchecked variants -- do not use */
 
 static inline guint
@@ -261,6 +291,57 @@ __GST_BIT_READER_READ_BITS_INLINE (64)
 
 #undef __GST_BIT_READER_READ_BITS_INLINE
 
+static inline gboolean
+_gst_bit_reader_get_ue_inline (GstBitReader * reader, guint32 * val)
+{
+  guint remaining, nbits, zeros;
+  guint32 peek;
+
+  g_return_val_if_fail (reader != NULL, FALSE);
+  g_return_val_if_fail (val != NULL, FALSE);
+
+  /* the leading zeros, the marker bit and as many value bits as zeros */
+  remaining = _gst_bit_reader_get_remaining_unchecked (reader);
+  nbits = MIN (remaining, 32);
+  if (nbits == 0)
+    return FALSE;
+
+  peek = gst_bit_reader_peek_bits_uint32_unchecked (reader, nbits);
+  peek <<= 32 - nbits;
+  if (peek == 0)
+    return FALSE;
+
+  zeros = _gst_bit_reader_clz32 (peek);
+  nbits = 2 * zeros + 1;
+  if (remaining < nbits)
+    return FALSE;
+
+  if (G_LIKELY (nbits <= 32)) {
+    *val = (peek >> (32 - nbits)) - 1;
+    gst_bit_reader_skip_unchecked (reader, nbits);
+  } else {
+    *val = gst_bit_reader_get_bits_uint64_unchecked (reader, nbits) - 1;
+  }
+  return TRUE;
+}
+
+static inline gboolean
+_gst_bit_reader_get_se_inline (GstBitReader * reader, gint32 * val)
+{
+  guint32 ue;
+
+  g_return_val_if_fail (val != NULL, FALSE);
+
+  if (!_gst_bit_reader_get_ue_inline (reader, &ue))
+    return FALSE;
+
+  if (ue & 1)
+    *val = (gint32) ((ue >> 1) + 1);
+  else
+    *val = -(gint32) (ue >> 1);
+  return TRUE;
+}
+
 #ifndef GST_BIT_READER_DISABLE_INLINES
 
 #define gst_bit_reader_get_size(reader) \
@@ -294,6 +375,11 @@ __GST_BIT_READER_READ_BITS_INLINE (64)
     G_LIKELY (_gst_bit_reader_peek_bits_uint32_inline (reader, val, nbits))
 #define gst_bit_reader_peek_bits_uint64(reader, val, nbits) \
     G_LIKELY (_gst_bit_reader_peek_bits_uint64_inline (reader, val, nbits))
+
+#define gst_bit_reader_get_ue(reader, val) \
+    G_LIKELY (_gst_bit_reader_get_ue_inline (reader, val))
+#define gst_bit_reader_get_se(reader, val) \
+    G_LIKELY (_gst_bit_reader_get_se_inline (reader, val))
 #endif
 
 G_END_DECLS
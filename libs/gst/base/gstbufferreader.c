@@ -0,0 +1,565 @@
+/* GStreamer buffer reader
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "gstbufferreader.h"
+
+#include <string.h>
+
+/**
+ * SECTION:gstbufferreader
+ * @short_description: Reads the data of a #GstBuffer without merging its
+ *     memory blocks
+ *
+ * #GstBufferReader reads the bytes of a #GstBuffer in order. Unlike
+ * gst_buffer_map(), which merges all the memory blocks of a buffer into a
+ * newly allocated block, the buffer reader maps one memory block at a time.
+ *
+ * gst_buffer_reader_get_chunk() returns the data of the memory blocks one
+ * after the other and is what checksums or writers should use. Parsers can
+ * read integers or peek at data with the other functions, these work across
+ * memory block boundaries by only copying the few bytes that are requested.
+ *
+ * Since: 1.10
+ */
+
+/**
+ * gst_buffer_reader_init:
+ * @reader: a #GstBufferReader instance
+ * @buffer: (transfer none): the #GstBuffer to read
+ *
+ * Initializes a #GstBufferReader instance to read from @buffer. The reader
+ * keeps a reference to @buffer until gst_buffer_reader_clear() is called.
+ *
+ * Since: 1.10
+ */
+void
+gst_buffer_reader_init (GstBufferReader * reader, GstBuffer * buffer)
+{
+  g_return_if_fail (reader != NULL);
+  g_return_if_fail (GST_IS_BUFFER (buffer));
+
+  memset (reader, 0, sizeof (GstBufferReader));
+
+  reader->buffer = gst_buffer_ref (buffer);
+  reader->size = gst_buffer_get_size (buffer);
+  reader->n_mem = gst_buffer_n_memory (buffer);
+  if (reader->n_mem > 0)
+    reader->mem_size =
+        gst_memory_get_sizes (gst_buffer_peek_memory (buffer, 0), NULL, NULL);
+}
+
+/**
+ * gst_buffer_reader_clear:
+ * @reader: a #GstBufferReader instance
+ *
+ * Unmaps the memory that @reader is reading from and releases the
+ * reference to the buffer. The data that was returned by @reader can not be
+ * used anymore after this.
+ *
+ * Since: 1.10
+ */
+void
+gst_buffer_reader_clear (GstBufferReader * reader)
+{
+  g_return_if_fail (reader != NULL);
+
+  if (reader->mapped)
+    gst_memory_unmap (reader->map.memory, &reader->map);
+  reader->mapped = FALSE;
+
+  g_free (reader->scratch);
+  reader->scratch = NULL;
+  reader->scratch_size = 0;
+
+  gst_buffer_replace (&reader->buffer, NULL);
+  reader->size = reader->pos = 0;
+  reader->n_mem = reader->idx = 0;
+  reader->offset = reader->mem_size = 0;
+}
+
+static void
+gst_buffer_reader_next_memory (GstBufferReader * reader)
+{
+  if (reader->mapped) {
+    gst_memory_unmap (reader->map.memory, &reader->map);
+    reader->mapped = FALSE;
+  }
+
+  reader->idx++;
+  reader->offset = 0;
+  if (reader->idx < reader->n_mem)
+    reader->mem_size =
+        gst_memory_get_sizes (gst_buffer_peek_memory (reader->buffer,
+            reader->idx), NULL, NULL);
+  else
+    reader->mem_size = 0;
+}
+
+/* make sure the memory with the data at the current position is mapped */
+static gboolean
+gst_buffer_reader_map (GstBufferReader * reader)
+{
+  GstMemory *mem;
+
+  while (reader->offset >= reader->mem_size && reader->idx < reader->n_mem)
+    gst_buffer_reader_next_memory (reader);
+
+  if (reader->idx >= reader->n_mem)
+    return FALSE;
+
+  if (reader->mapped)
+    return TRUE;
+
+  mem = gst_buffer_peek_memory (reader->buffer, reader->idx);
+  if (!gst_memory_map (mem, &reader->map, GST_MAP_READ))
+    goto map_failed;
+
+  reader->mapped = TRUE;
+
+  return TRUE;
+
+  /* ERRORS */
+map_failed:
+  {
+    GST_WARNING ("failed to map memory %p", mem);
+    return FALSE;
+  }
+}
+
+/**
+ * gst_buffer_reader_get_pos:
+ * @reader: a #GstBufferReader instance
+ *
+ * Returns the current position of a #GstBufferReader instance in bytes.
+ *
+ * Returns: The current position of @reader in bytes.
+ *
+ * Since: 1.10
+ */
+gsize
+gst_buffer_reader_get_pos (const GstBufferReader * reader)
+{
+  g_return_val_if_fail (reader != NULL, 0);
+
+  return reader->pos;
+}
+
+/**
+ * gst_buffer_reader_get_remaining:
+ * @reader: a #GstBufferReader instance
+ *
+ * Returns the remaining number of bytes of a #GstBufferReader instance.
+ *
+ * Returns: The remaining number of bytes of @reader instance.
+ *
+ * Since: 1.10
+ */
+gsize
+gst_buffer_reader_get_remaining (const GstBufferReader * reader)
+{
+  g_return_val_if_fail (reader != NULL, 0);
+
+  return reader->size - reader->pos;
+}
+
+/**
+ * gst_buffer_reader_get_size:
+ * @reader: a #GstBufferReader instance
+ *
+ * Returns the total number of bytes of a #GstBufferReader instance.
+ *
+ * Returns: The total number of bytes of @reader instance.
+ *
+ * Since: 1.10
+ */
+gsize
+gst_buffer_reader_get_size (const GstBufferReader * reader)
+{
+  g_return_val_if_fail (reader != NULL, 0);
+
+  return reader->size;
+}
+
+/**
+ * gst_buffer_reader_skip:
+ * @reader: a #GstBufferReader instance
+ * @nbytes: the number of bytes to skip
+ *
+ * Skips @nbytes bytes of the #GstBufferReader instance. Memory blocks that
+ * are skipped entirely are not mapped.
+ *
+ * Returns: %TRUE if @nbytes bytes could be skipped, %FALSE otherwise.
+ *
+ * Since: 1.10
+ */
+gboolean
+gst_buffer_reader_skip (GstBufferReader * reader, gsize nbytes)
+{
+  g_return_val_if_fail (reader != NULL, FALSE);
+
+  if (reader->size - reader->pos < nbytes)
+    return FALSE;
+
+  reader->pos += nbytes;
+
+  while (nbytes > 0) {
+    gsize avail;
+
+    if (reader->offset >= reader->mem_size) {
+      gst_buffer_reader_next_memory (reader);
+      continue;
+    }
+
+    avail = MIN (reader->mem_size - reader->offset, nbytes);
+    reader->offset += avail;
+    nbytes -= avail;
+  }
+
+  return TRUE;
+}
+
+/**
+ * gst_buffer_reader_get_chunk:
+ * @reader: a #GstBufferReader instance
+ * @data: (out) (transfer none) (array length=size): address of a
+ *     #guint8 pointer variable in which to store the result
+ * @size: (out): the number of bytes in @data
+ *
+ * Returns the data from the current position up to the end of the memory
+ * block at that position and moves the position to the end of the memory
+ * block. Calling this function until it returns %FALSE walks all the data of
+ * the buffer without copying it.
+ *
+ * The data is valid until @reader is moved past the memory block or
+ * cleared.
+ *
+ * Returns: %TRUE if data was returned, %FALSE when the end of the buffer was
+ *     reached or a memory block could not be mapped.
+ *
+ * Since: 1.10
+ */
+gboolean
+gst_buffer_reader_get_chunk (GstBufferReader * reader, const guint8 ** data,
+    gsize * size)
+{
+  gsize avail;
+
+  g_return_val_if_fail (reader != NULL, FALSE);
+  g_return_val_if_fail (data != NULL, FALSE);
+  g_return_val_if_fail (size != NULL, FALSE);
+
+  if (!gst_buffer_reader_map (reader))
+    return FALSE;
+
+  avail = reader->mem_size - reader->offset;
+
+  *data = reader->map.data + reader->offset;
+  *size = avail;
+
+  reader->offset += avail;
+  reader->pos += avail;
+
+  return TRUE;
+}
+
+/**
+ * gst_buffer_reader_peek_data:
+ * @reader: a #GstBufferReader instance
+ * @size: the number of bytes to peek
+ * @data: (out) (transfer none) (array length=size): address of a
+ *     #guint8 pointer variable in which to store the result
+ *
+ * Returns a constant pointer to the next @size bytes of @reader without
+ * changing its position. When the data lies in a single memory block, a
+ * pointer into the mapped memory is returned. When it crosses memory
+ * blocks, only these @size bytes are copied into a scratch area of the
+ * reader.
+ *
+ * The data is valid until the next call on @reader that reads, peeks or
+ * moves the position past the current memory block.
+ *
+ * Returns: %TRUE if successful, %FALSE otherwise.
+ *
+ * Since: 1.10
+ */
+gboolean
+gst_buffer_reader_peek_data (GstBufferReader * reader, gsize size,
+    const guint8 ** data)
+{
+  g_return_val_if_fail (reader != NULL, FALSE);
+  g_return_val_if_fail (data != NULL, FALSE);
+
+  if (reader->size - reader->pos < size)
+    return FALSE;
+
+  if (size == 0) {
+    *data = NULL;
+    return TRUE;
+  }
+
+  if (!gst_buffer_reader_map (reader))
+    return FALSE;
+
+  if (reader->mem_size - reader->offset >= size) {
+    *data = reader->map.data + reader->offset;
+    return TRUE;
+  }
+
+  if (reader->scratch_size < size) {
+    reader->scratch_size = MAX (reader->scratch_size * 2, size);
+    reader->scratch = g_realloc (reader->scratch, reader->scratch_size);
+  }
+
+  if (gst_buffer_extract (reader->buffer, reader->pos, reader->scratch,
+          size) != size)
+    return FALSE;
+
+  *data = reader->scratch;
+
+  return TRUE;
+}
+
+/**
+ * gst_buffer_reader_get_data:
+ * @reader: a #GstBufferReader instance
+ * @size: the number of bytes to read
+ * @data: (out) (transfer none) (array length=size): address of a
+ *     #guint8 pointer variable in which to store the result
+ *
+ * Returns a constant pointer to the next @size bytes of @reader and moves
+ * the position forward by @size bytes. See gst_buffer_reader_peek_data()
+ * for how long the data stays valid.
+ *
+ * Returns: %TRUE if successful, %FALSE otherwise.
+ *
+ * Since: 1.10
+ */
+gboolean
+gst_buffer_reader_get_data (GstBufferReader * reader, gsize size,
+    const guint8 ** data)
+{
+  if (!gst_buffer_reader_peek_data (reader, size, data))
+    return FALSE;
+
+  return gst_buffer_reader_skip (reader, size);
+}
+
+#define GST_BUFFER_READER_PEEK_GET(bits,type,name,read) \
+gboolean \
+gst_buffer_reader_peek_##name (GstBufferReader * reader, type * val) \
+{ \
+  const guint8 *data; \
+  \
+  g_return_val_if_fail (val != NULL, FALSE); \
+  \
+  if (!gst_buffer_reader_peek_data (reader, bits / 8, &data)) \
+    return FALSE; \
+  \
+  *val = read (data); \
+  return TRUE; \
+} \
+\
+gboolean \
+gst_buffer_reader_get_##name (GstBufferReader * reader, type * val) \
+{ \
+  if (!gst_buffer_reader_peek_##name (reader, val)) \
+    return FALSE; \
+  \
+  return gst_buffer_reader_skip (reader, bits / 8); \
+}
+
+/**
+ * gst_buffer_reader_peek_uint8:
+ * @reader: a #GstBufferReader instance
+ * @val: (out): Pointer to a #guint8 to store the result
+ *
+ * Read an unsigned 8 bit integer but keep the current position.
+ *
+ * Returns: %TRUE if successful, %FALSE otherwise.
+ *
+ * Since: 1.10
+ */
+/**
+ * gst_buffer_reader_get_uint8:
+ * @reader: a #GstBufferReader instance
+ * @val: (out): Pointer to a #guint8 to store the result
+ *
+ * Read an unsigned 8 bit integer into @val and update the current position.
+ *
+ * Returns: %TRUE if successful, %FALSE otherwise.
+ *
+ * Since: 1.10
+ */
+GST_BUFFER_READER_PEEK_GET (8, guint8, uint8, GST_READ_UINT8)
+
+/**
+ * gst_buffer_reader_peek_uint16_le:
+ * @reader: a #GstBufferReader instance
+ * @val: (out): Pointer to a #guint16 to store the result
+ *
+ * Read an unsigned 16 bit little endian integer but keep the current
+ * position.
+ *
+ * Returns: %TRUE if successful, %FALSE otherwise.
+ *
+ * Since: 1.10
+ */
+/**
+ * gst_buffer_reader_get_uint16_le:
+ * @reader: a #GstBufferReader instance
+ * @val: (out): Pointer to a #guint16 to store the result
+ *
+ * Read an unsigned 16 bit little endian integer into @val and update the
+ * current position.
+ *
+ * Returns: %TRUE if successful, %FALSE otherwise.
+ *
+ * Since: 1.10
+ */
+GST_BUFFER_READER_PEEK_GET (16, guint16, uint16_le, GST_READ_UINT16_LE)
+
+/**
+ * gst_buffer_reader_peek_uint16_be:
+ * @reader: a #GstBufferReader instance
+ * @val: (out): Pointer to a #guint16 to store the result
+ *
+ * Read an unsigned 16 bit big endian integer but keep the current position.
+ *
+ * Returns: %TRUE if successful, %FALSE otherwise.
+ *
+ * Since: 1.10
+ */
+/**
+ * gst_buffer_reader_get_uint16_be:
+ * @reader: a #GstBufferReader instance
+ * @val: (out): Pointer to a #guint16 to store the result
+ *
+ * Read an unsigned 16 bit big endian integer into @val and update the
+ * current position.
+ *
+ * Returns: %TRUE if successful, %FALSE otherwise.
+ *
+ * Since: 1.10
+ */
+GST_BUFFER_READER_PEEK_GET (16, guint16, uint16_be, GST_READ_UINT16_BE)
+
+/**
+ * gst_buffer_reader_peek_uint32_le:
+ * @reader: a #GstBufferReader instance
+ * @val: (out): Pointer to a #guint32 to store the result
+ *
+ * Read an unsigned 32 bit little endian integer but keep the current
+ * position.
+ *
+ * Returns: %TRUE if successful, %FALSE otherwise.
+ *
+ * Since: 1.10
+ */
+/**
+ * gst_buffer_reader_get_uint32_le:
+ * @reader: a #GstBufferReader instance
+ * @val: (out): Pointer to a #guint32 to store the result
+ *
+ * Read an unsigned 32 bit little endian integer into @val and update the
+ * current position.
+ *
+ * Returns: %TRUE if successful, %FALSE otherwise.
+ *
+ * Since: 1.10
+ */
+GST_BUFFER_READER_PEEK_GET (32, guint32, uint32_le, GST_READ_UINT32_LE)
+
+/**
+ * gst_buffer_reader_peek_uint32_be:
+ * @reader: a #GstBufferReader instance
+ * @val: (out): Pointer to a #guint32 to store the result
+ *
+ * Read an unsigned 32 bit big endian integer but keep the current position.
+ *
+ * Returns: %TRUE if successful, %FALSE otherwise.
+ *
+ * Since: 1.10
+ */
+/**
+ * gst_buffer_reader_get_uint32_be:
+ * @reader: a #GstBufferReader instance
+ * @val: (out): Pointer to a #guint32 to store the result
+ *
+ * Read an unsigned 32 bit big endian integer into @val and update the
+ * current position.
+ *
+ * Returns: %TRUE if successful, %FALSE otherwise.
+ *
+ * Since: 1.10
+ */
+GST_BUFFER_READER_PEEK_GET (32, guint32, uint32_be, GST_READ_UINT32_BE)
+
+/**
+ * gst_buffer_reader_peek_uint64_le:
+ * @reader: a #GstBufferReader instance
+ * @val: (out): Pointer to a #guint64 to store the result
+ *
+ * Read an unsigned 64 bit little endian integer but keep the current
+ * position.
+ *
+ * Returns: %TRUE if successful, %FALSE otherwise.
+ *
+ * Since: 1.10
+ */
+/**
+ * gst_buffer_reader_get_uint64_le:
+ * @reader: a #GstBufferReader instance
+ * @val: (out): Pointer to a #guint64 to store the result
+ *
+ * Read an unsigned 64 bit little endian integer into @val and update the
+ * current position.
+ *
+ * Returns: %TRUE if successful, %FALSE otherwise.
+ *
+ * Since: 1.10
+ */
+GST_BUFFER_READER_PEEK_GET (64, guint64, uint64_le, GST_READ_UINT64_LE)
+
+/**
+ * gst_buffer_reader_peek_uint64_be:
+ * @reader: a #GstBufferReader instance
+ * @val: (out): Pointer to a #guint64 to store the result
+ *
+ * Read an unsigned 64 bit big endian integer but keep the current position.
+ *
+ * Returns: %TRUE if successful, %FALSE otherwise.
+ *
+ * Since: 1.10
+ */
+/**
+ * gst_buffer_reader_get_uint64_be:
+ * @reader: a #GstBufferReader instance
+ * @val: (out): Pointer to a #guint64 to store the result
+ *
+ * Read an unsigned 64 bit big endian integer into @val and update the
+ * current position.
+ *
+ * Returns: %TRUE if successful, %FALSE otherwise.
+ *
+ * Since: 1.10
+ */
+GST_BUFFER_READER_PEEK_GET (64, guint64, uint64_be, GST_READ_UINT64_BE)
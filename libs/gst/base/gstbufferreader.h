@@ -0,0 +1,90 @@
+/* GStreamer buffer reader
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __GST_BUFFER_READER_H__
+#define __GST_BUFFER_READER_H__
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+#define GST_BUFFER_READER(reader) ((GstBufferReader *) (reader))
+
+/**
+ * GstBufferReader:
+ * @buffer: the #GstBuffer that is read
+ * @size: size of @buffer in bytes
+ * @pos: current byte position
+ *
+ * A buffer reader instance.
+ *
+ * Since: 1.10
+ */
+typedef struct {
+  GstBuffer *buffer;
+  gsize size;
+
+  gsize pos;  /* Byte position */
+
+  /* < private > */
+  guint n_mem;
+  guint idx;
+  gsize offset;
+  gsize mem_size;
+  gboolean mapped;
+  GstMapInfo map;
+
+  guint8 *scratch;
+  gsize scratch_size;
+
+  gpointer _gst_reserved[GST_PADDING];
+} GstBufferReader;
+
+void            gst_buffer_reader_init           (GstBufferReader *reader, GstBuffer *buffer);
+void            gst_buffer_reader_clear          (GstBufferReader *reader);
+
+gsize           gst_buffer_reader_get_pos        (const GstBufferReader *reader);
+gsize           gst_buffer_reader_get_remaining  (const GstBufferReader *reader);
+gsize           gst_buffer_reader_get_size       (const GstBufferReader *reader);
+
+gboolean        gst_buffer_reader_skip           (GstBufferReader *reader, gsize nbytes);
+
+gboolean        gst_buffer_reader_get_chunk      (GstBufferReader *reader, const guint8 ** data, gsize *size);
+
+gboolean        gst_buffer_reader_peek_data      (GstBufferReader *reader, gsize size, const guint8 ** data);
+gboolean        gst_buffer_reader_get_data       (GstBufferReader *reader, gsize size, const guint8 ** data);
+
+gboolean        gst_buffer_reader_get_uint8      (GstBufferReader *reader, guint8 *val);
+gboolean        gst_buffer_reader_get_uint16_le  (GstBufferReader *reader, guint16 *val);
+gboolean        gst_buffer_reader_get_uint16_be  (GstBufferReader *reader, guint16 *val);
+gboolean        gst_buffer_reader_get_uint32_le  (GstBufferReader *reader, guint32 *val);
+gboolean        gst_buffer_reader_get_uint32_be  (GstBufferReader *reader, guint32 *val);
+gboolean        gst_buffer_reader_get_uint64_le  (GstBufferReader *reader, guint64 *val);
+gboolean        gst_buffer_reader_get_uint64_be  (GstBufferReader *reader, guint64 *val);
+
+gboolean        gst_buffer_reader_peek_uint8     (GstBufferReader *reader, guint8 *val);
+gboolean        gst_buffer_reader_peek_uint16_le (GstBufferReader *reader, guint16 *val);
+gboolean        gst_buffer_reader_peek_uint16_be (GstBufferReader *reader, guint16 *val);
+gboolean        gst_buffer_reader_peek_uint32_le (GstBufferReader *reader, guint32 *val);
+gboolean        gst_buffer_reader_peek_uint32_be (GstBufferReader *reader, guint32 *val);
+gboolean        gst_buffer_reader_peek_uint64_le (GstBufferReader *reader, guint64 *val);
+gboolean        gst_buffer_reader_peek_uint64_be (GstBufferReader *reader, guint64 *val);
+
+G_END_DECLS
+
+#endif /* __GST_BUFFER_READER_H__ */
@@ -821,6 +821,11 @@ gst_byte_reader_dup_data (GstByteReader * reader, guint size, guint8 ** val)
   return _gst_byte_reader_dup_data_inline (reader, size, val);
 }
 
+/* check if one of the 8 bytes in @v is 0 */
+#define HAS_ZERO_BYTE(v) \
+    ((((v) - G_GUINT64_CONSTANT (0x0101010101010101)) & ~(v) & \
+        G_GUINT64_CONSTANT (0x8080808080808080)) != 0)
+
 /* Special optimized scan for mask 0xffffff00 and pattern 0x00000100 */
 static inline gint
 _scan_for_start_code (const guint8 * data, guint offset, guint size)
@@ -829,6 +834,19 @@ _scan_for_start_code (const guint8 * data, guint offset, guint size)
   guint8 *pend = (guint8 *) (data + size - 4);
 
   while (pdata <= pend) {
+    /* a start code can't begin in 8 bytes without a 0 byte, skip them a
+     * word at a time. This is where most of the time goes in payload data */
+    while (pdata + 8 <= pend + 4) {
+      guint64 v;
+
+      memcpy (&v, pdata, sizeof (v));
+      if (HAS_ZERO_BYTE (v))
+        break;
+      pdata += 8;
+    }
+    if (pdata > pend)
+      break;
+
     if (pdata[2] > 1) {
       pdata += 3;
     } else if (pdata[1]) {
@@ -864,10 +882,12 @@ _masked_scan_uint32_peek (const GstByteReader * reader,
 
   /* Handle special case found in MPEG and H264 */
   if ((pattern == 0x00000100) && (mask == 0xffffff00)) {
-    guint ret = _scan_for_start_code (data, offset, size);
+    gint ret = _scan_for_start_code (data, 0, size);
+    if (ret < 0)
+      return -1;
     if (G_UNLIKELY (value))
       *value = (1 << 8) | data[ret + 3];
-    return ret;
+    return ret + offset;
   }
 
   /* set the state to something that does not match */
@@ -974,6 +994,43 @@ gst_byte_reader_masked_scan_uint32_peek (const GstByteReader * reader,
   return _masked_scan_uint32_peek (reader, mask, pattern, offset, size, value);
 }
 
+/**
+ * gst_byte_reader_find_start_code:
+ * @reader: a #GstByteReader
+ * @offset: offset from which to start scanning, relative to the current
+ *     position
+ * @size: number of bytes to scan from offset
+ * @code: (out) (allow-none): pointer to return the byte following the
+ *     start code prefix
+ *
+ * Scan for the 0x00 0x00 0x01 start code prefix used in MPEG and H.264/H.265
+ * bitstreams, starting from offset @offset relative to the current position.
+ * This is the same as calling gst_byte_reader_masked_scan_uint32_peek() with
+ * a mask of 0xffffff00 and a pattern of 0x00000100, so the byte after the
+ * prefix must also be present in the byte reader data for a match.
+ *
+ * It is an error to call this function without making sure that there is
+ * enough data (offset+size bytes) in the byte reader.
+ *
+ * Returns: offset of the first start code, or -1 if no start code was found.
+ *
+ * Since: 1.10
+ */
+guint
+gst_byte_reader_find_start_code (const GstByteReader * reader, guint offset,
+    guint size, guint8 * code)
+{
+  guint32 value;
+  guint ret;
+
+  ret = _masked_scan_uint32_peek (reader, 0xffffff00, 0x00000100, offset,
+      size, &value);
+  if (ret != -1 && code)
+    *code = value & 0xff;
+
+  return ret;
+}
+
 #define GST_BYTE_READER_SCAN_STRING(bits) \
 static guint \
 gst_byte_reader_scan_string_utf##bits (const GstByteReader * reader) \
@@ -36,8 +36,28 @@
  * 32 and 64 bits and functions for reading little/big endian floating points numbers of
  * 32 and 64 bits. It also provides functions to write/read NUL-terminated strings
  * in various character encodings.
+ *
+ * With gst_byte_writer_init_with_buffer() the data is written directly into
+ * the memory of a #GstBuffer, for example one acquired from a #GstBufferPool,
+ * which gst_byte_writer_reset_and_get_buffer() then returns again without
+ * copying. gst_byte_writer_reserve() and gst_byte_writer_commit() allow
+ * writing arbitrary data at the write cursor in place.
  */
 
+/* the buffer written into and its mapping, see init_with_buffer */
+#define WRITER_BUFFER(writer) ((GstBuffer *) (writer)->_gst_reserved[0])
+#define WRITER_MAP(writer) ((GstMapInfo *) (writer)->_gst_reserved[1])
+
+static void
+gst_byte_writer_release_buffer (GstByteWriter * writer)
+{
+  GstMapInfo *map = WRITER_MAP (writer);
+
+  gst_buffer_unmap (WRITER_BUFFER (writer), map);
+  g_slice_free (GstMapInfo, map);
+  writer->_gst_reserved[0] = writer->_gst_reserved[1] = NULL;
+}
+
 /**
  * gst_byte_writer_new: (skip)
  *
@@ -173,6 +193,60 @@ gst_byte_writer_init_with_data (GstByteWriter * writer, guint8 * data,
   writer->owned = FALSE;
 }
 
+/**
+ * gst_byte_writer_init_with_buffer:
+ * @writer: #GstByteWriter instance
+ * @buffer: (transfer full): a writable #GstBuffer
+ * @initialized: If %TRUE the complete data can be read from the beginning
+ *
+ * Initializes @writer to write into the memory of @buffer, which is mapped
+ * until @writer is reset. The data can't be reallocated, so at most the size
+ * of @buffer can be written. If @initialized is %TRUE it is possible to
+ * read the complete data of @buffer from the beginning.
+ *
+ * gst_byte_writer_reset_and_get_buffer() returns @buffer again, resized to
+ * the written data. A buffer with a single memory, as provided by most
+ * buffer pools and allocators, is written without any copies.
+ *
+ * Returns: %TRUE if @buffer could be mapped for writing
+ *
+ * Since: 1.10
+ */
+gboolean
+gst_byte_writer_init_with_buffer (GstByteWriter * writer, GstBuffer * buffer,
+    gboolean initialized)
+{
+  GstMapInfo *map;
+
+  g_return_val_if_fail (writer != NULL, FALSE);
+  g_return_val_if_fail (GST_IS_BUFFER (buffer), FALSE);
+  g_return_val_if_fail (gst_buffer_is_writable (buffer), FALSE);
+
+  gst_byte_writer_init (writer);
+
+  map = g_slice_new (GstMapInfo);
+  if (!gst_buffer_map (buffer, map, GST_MAP_READWRITE))
+    goto map_failed;
+
+  writer->parent.data = map->data;
+  writer->parent.size = (initialized) ? map->size : 0;
+  writer->alloc_size = map->size;
+  writer->fixed = TRUE;
+  writer->owned = FALSE;
+  writer->_gst_reserved[0] = buffer;
+  writer->_gst_reserved[1] = map;
+
+  return TRUE;
+
+  /* ERRORS */
+map_failed:
+  {
+    g_slice_free (GstMapInfo, map);
+    gst_buffer_unref (buffer);
+    return FALSE;
+  }
+}
+
 /**
  * gst_byte_writer_reset:
  * @writer: #GstByteWriter instance
@@ -185,8 +259,14 @@ gst_byte_writer_reset (GstByteWriter * writer)
 {
   g_return_if_fail (writer != NULL);
 
-  if (writer->owned)
+  if (WRITER_BUFFER (writer)) {
+    GstBuffer *buffer = WRITER_BUFFER (writer);
+
+    gst_byte_writer_release_buffer (writer);
+    gst_buffer_unref (buffer);
+  } else if (writer->owned) {
     g_free ((guint8 *) writer->parent.data);
+  }
   memset (writer, 0, sizeof (GstByteWriter));
 }
 
@@ -238,6 +318,17 @@ gst_byte_writer_reset_and_get_buffer (GstByteWriter * writer)
   g_return_val_if_fail (writer != NULL, NULL);
 
   size = writer->parent.size;
+
+  /* hand out the buffer that was written into */
+  if (WRITER_BUFFER (writer)) {
+    buffer = WRITER_BUFFER (writer);
+    gst_byte_writer_release_buffer (writer);
+    gst_buffer_resize (buffer, 0, size);
+    gst_byte_writer_reset (writer);
+
+    return buffer;
+  }
+
   data = gst_byte_writer_reset_and_get_data (writer);
 
   buffer = gst_buffer_new ();
@@ -349,6 +440,60 @@ gst_byte_writer_ensure_free_space (GstByteWriter * writer, guint size)
   return _gst_byte_writer_ensure_free_space_inline (writer, size);
 }
 
+/**
+ * gst_byte_writer_reserve:
+ * @writer: #GstByteWriter instance
+ * @size: Number of bytes to reserve
+ *
+ * Makes sure that @size bytes are available at the current write cursor, and
+ * returns a pointer to them for writing in place, for example by a
+ * function that produces the data itself instead of copying it in with
+ * gst_byte_writer_put_data(). The written data becomes part of @writer with
+ * gst_byte_writer_commit().
+ *
+ * The pointer is only valid until the next call that writes to @writer.
+ *
+ * Returns: (transfer none) (nullable): a pointer to @size bytes at the write
+ * cursor, or %NULL if they are not available
+ *
+ * Since: 1.10
+ */
+guint8 *
+gst_byte_writer_reserve (GstByteWriter * writer, guint size)
+{
+  g_return_val_if_fail (writer != NULL, NULL);
+
+  if (G_UNLIKELY (!_gst_byte_writer_ensure_free_space_inline (writer, size)))
+    return NULL;
+
+  return (guint8 *) writer->parent.data + writer->parent.byte;
+}
+
+/**
+ * gst_byte_writer_commit:
+ * @writer: #GstByteWriter instance
+ * @size: Number of bytes written
+ *
+ * Moves the write cursor of @writer over @size bytes that were written in
+ * place after gst_byte_writer_reserve().
+ *
+ * Returns: %TRUE if @size bytes were reserved
+ *
+ * Since: 1.10
+ */
+gboolean
+gst_byte_writer_commit (GstByteWriter * writer, guint size)
+{
+  g_return_val_if_fail (writer != NULL, FALSE);
+  g_return_val_if_fail (size <= writer->alloc_size - writer->parent.byte,
+      FALSE);
+
+  writer->parent.byte += size;
+  writer->parent.size = MAX (writer->parent.size, writer->parent.byte);
+
+  return TRUE;
+}
+
 
 #define CREATE_WRITE_FUNC(bits,type,name,write_func) \
 gboolean \
@@ -59,6 +59,8 @@ void            gst_byte_writer_init            (GstByteWriter *writer);
 void            gst_byte_writer_init_with_size  (GstByteWriter *writer, guint size, gboolean fixed);
 void            gst_byte_writer_init_with_data  (GstByteWriter *writer, guint8 *data,
                                                  guint size, gboolean initialized);
+gboolean        gst_byte_writer_init_with_buffer (GstByteWriter *writer, GstBuffer *buffer,
+                                                  gboolean initialized);
 
 void            gst_byte_writer_free                    (GstByteWriter *writer);
 guint8 *        gst_byte_writer_free_and_get_data       (GstByteWriter *writer);
@@ -111,6 +113,9 @@ gst_byte_writer_get_size (const GstByteWriter *writer)
 guint           gst_byte_writer_get_remaining     (const GstByteWriter *writer);
 gboolean        gst_byte_writer_ensure_free_space (GstByteWriter *writer, guint size);
 
+guint8 *        gst_byte_writer_reserve           (GstByteWriter *writer, guint size);
+gboolean        gst_byte_writer_commit            (GstByteWriter *writer, guint size);
+
 gboolean        gst_byte_writer_put_uint8         (GstByteWriter *writer, guint8 val);
 gboolean        gst_byte_writer_put_int8          (GstByteWriter *writer, gint8 val);
 gboolean        gst_byte_writer_put_uint16_be     (GstByteWriter *writer, guint16 val);
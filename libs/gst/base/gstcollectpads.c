@@ -94,6 +94,11 @@ struct _GstCollectDataPrivate
   /* refcounting for struct, and destroy callback */
   GstCollectDataDestroyNotify destroy_notify;
   gint refcount;
+
+  /* position in the buffer heap, -1 when no buffer is queued */
+  gint heap_index;
+  /* order in which the pad was added, breaks ties in the heap */
+  guint32 seqnum;
 };
 
 struct _GstCollectPadsPrivate
@@ -108,6 +113,7 @@ struct _GstCollectPadsPrivate
   guint eospads;                /* number of pads that are EOS */
   GstClockTime earliest_time;   /* Current earliest time */
   GstCollectData *earliest_data;        /* Pad data for current earliest time */
+  GPtrArray *heap;              /* min-heap of pad data with a queued buffer */
 
   /* with LOCK */
   GSList *pad_list;             /* updated pad list */
@@ -153,6 +159,9 @@ static gint gst_collect_pads_default_compare_func (GstCollectPads * pads,
     GstCollectData * data1, GstClockTime timestamp1, GstCollectData * data2,
     GstClockTime timestamp2, gpointer user_data);
 static gboolean gst_collect_pads_recalculate_full (GstCollectPads * pads);
+static void gst_collect_pads_heap_update (GstCollectPads * pads,
+    GstCollectData * data);
+static void gst_collect_pads_heap_clear (GstCollectPads * pads);
 static void ref_data (GstCollectData * data);
 static void unref_data (GstCollectData * data);
 
@@ -247,6 +256,7 @@ gst_collect_pads_init (GstCollectPads * pads)
   pads->priv->compare_user_data = NULL;
   pads->priv->earliest_data = NULL;
   pads->priv->earliest_time = GST_CLOCK_TIME_NONE;
+  pads->priv->heap = g_ptr_array_new ();
 
   pads->priv->event_func = gst_collect_pads_event_default_internal;
   pads->priv->query_func = gst_collect_pads_query_default_internal;
@@ -280,6 +290,9 @@ gst_collect_pads_finalize (GObject * object)
   g_cond_clear (&pads->priv->evt_cond);
   g_mutex_clear (&pads->priv->evt_lock);
 
+  gst_collect_pads_heap_clear (pads);
+  g_ptr_array_free (pads->priv->heap, TRUE);
+
   /* Remove pads and free pads list */
   g_slist_foreach (pads->priv->pad_list, (GFunc) unref_data, NULL);
   g_slist_foreach (pads->data, (GFunc) unref_data, NULL);
@@ -366,6 +379,9 @@ gst_collect_pads_set_compare_function (GstCollectPads * pads,
   GST_OBJECT_LOCK (pads);
   pads->priv->compare_func = func;
   pads->priv->compare_user_data = user_data;
+  /* the buffer heap is ordered with the old function, make the next
+   * check rebuild it */
+  pads->priv->pad_cookie++;
   GST_OBJECT_UNLOCK (pads);
 }
 
@@ -661,9 +677,11 @@ gst_collect_pads_add_pad (GstCollectPads * pads, GstPad * pad, guint size,
   data->state |= lock ? GST_COLLECT_PADS_STATE_LOCKED : 0;
   data->priv->refcount = 1;
   data->priv->destroy_notify = destroy_notify;
+  data->priv->heap_index = -1;
   data->ABI.abi.dts = G_MININT64;
 
   GST_OBJECT_LOCK (pads);
+  data->priv->seqnum = pads->priv->pad_cookie;
   GST_OBJECT_LOCK (pad);
   gst_pad_set_element_private (pad, data);
   GST_OBJECT_UNLOCK (pad);
@@ -913,6 +931,7 @@ gst_collect_pads_stop (GstCollectPads * pads)
   pads->priv->started = FALSE;
   pads->priv->eospads = 0;
   pads->priv->queuedpads = 0;
+  gst_collect_pads_heap_clear (pads);
 
   /* loop over the master pad list and flush buffers */
   collected = pads->priv->pad_list;
@@ -999,6 +1018,7 @@ gst_collect_pads_pop (GstCollectPads * pads, GstCollectData * data)
   if ((result = data->buffer)) {
     data->buffer = NULL;
     data->pos = 0;
+    gst_collect_pads_heap_update (pads, data);
     /* one less pad with queued data now */
     if (GST_COLLECT_PADS_STATE_IS_SET (data, GST_COLLECT_PADS_STATE_WAITING))
       pads->priv->queuedpads--;
@@ -1286,6 +1306,7 @@ gst_collect_pads_check_pads (GstCollectPads * pads)
       unref_data (pads->priv->earliest_data);
     pads->priv->earliest_data = NULL;
     pads->priv->earliest_time = GST_CLOCK_TIME_NONE;
+    gst_collect_pads_heap_clear (pads);
 
     /* loop over the master pad list */
     collected = pads->priv->pad_list;
@@ -1303,6 +1324,7 @@ gst_collect_pads_check_pads (GstCollectPads * pads)
 
       /* add to the list of pads to collect */
       ref_data (data);
+      gst_collect_pads_heap_update (pads, data);
       /* preserve order of adding/requesting pads */
       pads->data = g_slist_append (pads->data, data);
     }
@@ -1383,6 +1405,128 @@ gst_collect_pads_check_collected (GstCollectPads * pads)
 }
 
 
+/* The pads that have a buffer queued are kept in a binary min-heap, ordered
+ * with the compare function on the buffer timestamp, so that the default
+ * collected function does not need to look at every pad to find the oldest
+ * buffer. Pads that compare equal are ordered as they were added, like the
+ * linear scan over the pad list used to do.
+ *
+ * Each entry holds a ref to the collect data. All of this must be called with
+ * STREAM_LOCK.
+ */
+static gboolean
+gst_collect_pads_heap_less (GstCollectPads * pads, GstCollectData * a,
+    GstCollectData * b)
+{
+  gint cmp;
+
+  cmp = pads->priv->compare_func (pads, a, GST_BUFFER_DTS_OR_PTS (a->buffer),
+      b, GST_BUFFER_DTS_OR_PTS (b->buffer), pads->priv->compare_user_data);
+  if (cmp != 0)
+    return cmp < 0;
+
+  return a->priv->seqnum < b->priv->seqnum;
+}
+
+static void
+gst_collect_pads_heap_set (GstCollectPads * pads, guint idx,
+    GstCollectData * data)
+{
+  g_ptr_array_index (pads->priv->heap, idx) = data;
+  data->priv->heap_index = idx;
+}
+
+static void
+gst_collect_pads_heap_sift_up (GstCollectPads * pads, guint idx)
+{
+  GPtrArray *heap = pads->priv->heap;
+  GstCollectData *data = g_ptr_array_index (heap, idx);
+
+  while (idx > 0) {
+    guint parent = (idx - 1) / 2;
+    GstCollectData *pdata = g_ptr_array_index (heap, parent);
+
+    if (!gst_collect_pads_heap_less (pads, data, pdata))
+      break;
+
+    gst_collect_pads_heap_set (pads, idx, pdata);
+    idx = parent;
+  }
+  gst_collect_pads_heap_set (pads, idx, data);
+}
+
+static void
+gst_collect_pads_heap_sift_down (GstCollectPads * pads, guint idx)
+{
+  GPtrArray *heap = pads->priv->heap;
+  GstCollectData *data = g_ptr_array_index (heap, idx);
+
+  while (2 * idx + 1 < heap->len) {
+    guint child = 2 * idx + 1;
+    GstCollectData *cdata = g_ptr_array_index (heap, child);
+
+    if (child + 1 < heap->len) {
+      GstCollectData *rdata = g_ptr_array_index (heap, child + 1);
+
+      if (gst_collect_pads_heap_less (pads, rdata, cdata)) {
+        child++;
+        cdata = rdata;
+      }
+    }
+    if (!gst_collect_pads_heap_less (pads, cdata, data))
+      break;
+
+    gst_collect_pads_heap_set (pads, idx, cdata);
+    idx = child;
+  }
+  gst_collect_pads_heap_set (pads, idx, data);
+}
+
+/* move @data to the right place in the heap after its buffer changed, this
+ * inserts or removes it when a buffer was queued or taken */
+static void
+gst_collect_pads_heap_update (GstCollectPads * pads, GstCollectData * data)
+{
+  GPtrArray *heap = pads->priv->heap;
+  gint idx = data->priv->heap_index;
+
+  if (data->buffer != NULL) {
+    if (idx < 0) {
+      ref_data (data);
+      g_ptr_array_add (heap, data);
+      idx = heap->len - 1;
+    }
+    gst_collect_pads_heap_sift_up (pads, idx);
+    gst_collect_pads_heap_sift_down (pads, data->priv->heap_index);
+  } else if (idx >= 0) {
+    GstCollectData *last;
+
+    last = g_ptr_array_remove_index_fast (heap, heap->len - 1);
+    if (last != data) {
+      gst_collect_pads_heap_set (pads, idx, last);
+      gst_collect_pads_heap_sift_up (pads, idx);
+      gst_collect_pads_heap_sift_down (pads, last->priv->heap_index);
+    }
+    data->priv->heap_index = -1;
+    unref_data (data);
+  }
+}
+
+static void
+gst_collect_pads_heap_clear (GstCollectPads * pads)
+{
+  GPtrArray *heap = pads->priv->heap;
+  guint i;
+
+  for (i = 0; i < heap->len; i++) {
+    GstCollectData *data = g_ptr_array_index (heap, i);
+
+    data->priv->heap_index = -1;
+    unref_data (data);
+  }
+  g_ptr_array_set_size (heap, 0);
+}
+
 /* General overview:
  * - only pad with a buffer can determine earliest_data (and earliest_time)
  * - only segment info determines (non-)waiting state
@@ -1463,29 +1607,17 @@ static void
 gst_collect_pads_find_best_pad (GstCollectPads * pads,
     GstCollectData ** data, GstClockTime * time)
 {
-  GSList *collected;
   GstCollectData *best = NULL;
   GstClockTime best_time = GST_CLOCK_TIME_NONE;
 
   g_return_if_fail (data != NULL);
   g_return_if_fail (time != NULL);
 
-  for (collected = pads->data; collected; collected = g_slist_next (collected)) {
-    GstBuffer *buffer;
-    GstCollectData *data = (GstCollectData *) collected->data;
-    GstClockTime timestamp;
-
-    buffer = gst_collect_pads_peek (pads, data);
-    /* if we have a buffer check if it is better then the current best one */
-    if (buffer != NULL) {
-      timestamp = GST_BUFFER_DTS_OR_PTS (buffer);
-      gst_buffer_unref (buffer);
-      if (best == NULL || pads->priv->compare_func (pads, data, timestamp,
-              best, best_time, pads->priv->compare_user_data) < 0) {
-        best = data;
-        best_time = timestamp;
-      }
-    }
+  /* the pads with a buffer are kept ordered in the heap, the best one is
+   * always at the top */
+  if (pads->priv->heap->len > 0) {
+    best = g_ptr_array_index (pads->priv->heap, 0);
+    best_time = GST_BUFFER_DTS_OR_PTS (best->buffer);
   }
 
   /* set earliest time */
@@ -2198,6 +2330,7 @@ gst_collect_pads_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
     pads->priv->queuedpads++;
   buffer_p = &data->buffer;
   gst_buffer_replace (buffer_p, buffer);
+  gst_collect_pads_heap_update (pads, data);
 
   /* update segment last position if in TIME */
   if (G_LIKELY (data->segment.format == GST_FORMAT_TIME)) {
@@ -60,6 +60,8 @@ struct _GstDataQueuePrivate
 {
   /* the array of data we're keeping our grubby hands on */
   GstQueueArray *queue;
+  /* size of the items stored in queue, 0 when it stores item pointers */
+  gsize item_size;
 
   GstDataQueueSize cur_level;   /* size of the queue */
   GstDataQueueCheckFullFunction checkfull;      /* Callback to check if the queue is full */
@@ -244,13 +246,68 @@ gst_data_queue_new (GstDataQueueCheckFullFunction checkfull,
   return ret;
 }
 
+/**
+ * gst_data_queue_new_for_struct: (skip)
+ * @checkfull: the callback used to tell if the element considers the queue full
+ * or not.
+ * @fullcallback: the callback which will be called when the queue is considered full.
+ * @emptycallback: the callback which will be called when the queue is considered empty.
+ * @checkdata: a #gpointer that will be passed to the @checkfull, @fullcallback,
+ *   and @emptycallback callbacks.
+ * @item_size: the size of the items, a structure that begins with the same
+ *   fields as #GstDataQueueItem up to @destroy.
+ *
+ * Creates a new #GstDataQueue like gst_data_queue_new() that stores copies
+ * of the items instead of pointers to them. Pushing then copies the item
+ * into the queue, so it can live on the stack of the caller, and items are
+ * retrieved with gst_data_queue_pop_struct() and gst_data_queue_peek_struct()
+ * instead of gst_data_queue_pop() and gst_data_queue_peek().
+ *
+ * The destroy function of the items is called with a pointer to the copy in
+ * the queue and must only release the contents of the item, not the item
+ * itself.
+ *
+ * Returns: a new #GstDataQueue.
+ *
+ * Since: 1.10
+ */
+GstDataQueue *
+gst_data_queue_new_for_struct (GstDataQueueCheckFullFunction checkfull,
+    GstDataQueueFullCallback fullcallback,
+    GstDataQueueEmptyCallback emptycallback, gpointer checkdata,
+    gsize item_size)
+{
+  GstDataQueue *ret;
+
+  g_return_val_if_fail (checkfull != NULL, NULL);
+  g_return_val_if_fail (item_size >= G_STRUCT_OFFSET (GstDataQueueItem,
+          _gst_reserved), NULL);
+
+  ret = g_object_newv (GST_TYPE_DATA_QUEUE, 0, NULL);
+  gst_queue_array_free (ret->priv->queue);
+  ret->priv->queue = gst_queue_array_new_for_struct (item_size, 50);
+  ret->priv->item_size = item_size;
+  ret->priv->checkfull = checkfull;
+  ret->priv->checkdata = checkdata;
+  ret->priv->fullcallback = fullcallback;
+  ret->priv->emptycallback = emptycallback;
+
+  return ret;
+}
+
 static void
 gst_data_queue_cleanup (GstDataQueue * queue)
 {
   GstDataQueuePrivate *priv = queue->priv;
 
   while (!gst_queue_array_is_empty (priv->queue)) {
-    GstDataQueueItem *item = gst_queue_array_pop_head (priv->queue);
+    GstDataQueueItem *item;
+
+    /* stored structures stay valid until the next push */
+    if (priv->item_size)
+      item = gst_queue_array_pop_head_struct (priv->queue);
+    else
+      item = gst_queue_array_pop_head (priv->queue);
 
     /* Just call the destroy notify on the item */
     item->destroy (item);
@@ -418,7 +475,10 @@ gst_data_queue_push_force_unlocked (GstDataQueue * queue,
 {
   GstDataQueuePrivate *priv = queue->priv;
 
-  gst_queue_array_push_tail (priv->queue, item);
+  if (priv->item_size)
+    gst_queue_array_push_tail_struct (priv->queue, item);
+  else
+    gst_queue_array_push_tail (priv->queue, item);
 
   if (item->visible)
     priv->cur_level.visible++;
@@ -441,6 +501,9 @@ gst_data_queue_push_force_unlocked (GstDataQueue * queue,
  * the #GstMiniObject contained in @item if the push was successful. If %FALSE
  * is returned, the caller is responsible for freeing @item and its contents.
  *
+ * Queues created with gst_data_queue_new_for_struct() copy @item and only
+ * take ownership of its contents.
+ *
  * Returns: %TRUE if the @item was successfully pushed on the @queue.
  *
  * Since: 1.2
@@ -449,6 +512,7 @@ gboolean
 gst_data_queue_push_force (GstDataQueue * queue, GstDataQueueItem * item)
 {
   GstDataQueuePrivate *priv = queue->priv;
+  gboolean wake;
 
   g_return_val_if_fail (GST_IS_DATA_QUEUE (queue), FALSE);
   g_return_val_if_fail (item != NULL, FALSE);
@@ -458,11 +522,13 @@ gst_data_queue_push_force (GstDataQueue * queue, GstDataQueueItem * item)
   STATUS (queue, "before pushing");
   gst_data_queue_push_force_unlocked (queue, item);
   STATUS (queue, "after pushing");
-  if (priv->waiting_add)
-    g_cond_signal (&priv->item_add);
+  wake = priv->waiting_add;
 
   GST_DATA_QUEUE_MUTEX_UNLOCK (queue);
 
+  if (wake)
+    g_cond_signal (&priv->item_add);
+
   return TRUE;
 
   /* ERRORS */
@@ -489,6 +555,9 @@ flushing:
  * the #GstMiniObject contained in @item if the push was successful. If %FALSE
  * is returned, the caller is responsible for freeing @item and its contents.
  *
+ * Queues created with gst_data_queue_new_for_struct() copy @item and only
+ * take ownership of its contents.
+ *
  * Returns: %TRUE if the @item was successfully pushed on the @queue.
  *
  * Since: 1.2
@@ -497,6 +566,7 @@ gboolean
 gst_data_queue_push (GstDataQueue * queue, GstDataQueueItem * item)
 {
   GstDataQueuePrivate *priv = queue->priv;
+  gboolean wake;
 
   g_return_val_if_fail (GST_IS_DATA_QUEUE (queue), FALSE);
   g_return_val_if_fail (item != NULL, FALSE);
@@ -527,11 +597,15 @@ gst_data_queue_push (GstDataQueue * queue, GstDataQueueItem * item)
   gst_data_queue_push_force_unlocked (queue, item);
 
   STATUS (queue, "after pushing");
-  if (priv->waiting_add)
-    g_cond_signal (&priv->item_add);
+  wake = priv->waiting_add;
 
   GST_DATA_QUEUE_MUTEX_UNLOCK (queue);
 
+  /* wake up the consumer after releasing the lock, so that it does not
+   * immediately block on it again */
+  if (wake)
+    g_cond_signal (&priv->item_add);
+
   return TRUE;
 
   /* ERRORS */
@@ -558,31 +632,19 @@ _gst_data_queue_wait_non_empty (GstDataQueue * queue)
   return TRUE;
 }
 
-/**
- * gst_data_queue_pop: (skip)
- * @queue: a #GstDataQueue.
- * @item: pointer to store the returned #GstDataQueueItem.
- *
- * Retrieves the first @item available on the @queue. If the queue is currently
- * empty, the call will block until at least one item is available, OR the
- * @queue is set to the flushing state.
- * MT safe.
- *
- * Returns: %TRUE if an @item was successfully retrieved from the @queue.
- *
- * Since: 1.2
- */
-gboolean
-gst_data_queue_pop (GstDataQueue * queue, GstDataQueueItem ** item)
+/* retrieves the head of the queue, into @item for pointer queues and into
+ * @p_item for structure queues, and removes it with @pop */
+static gboolean
+gst_data_queue_get_head (GstDataQueue * queue, gboolean pop,
+    GstDataQueueItem ** item, GstDataQueueItem * p_item)
 {
   GstDataQueuePrivate *priv = queue->priv;
-
-  g_return_val_if_fail (GST_IS_DATA_QUEUE (queue), FALSE);
-  g_return_val_if_fail (item != NULL, FALSE);
+  GstDataQueueItem *head;
+  gboolean wake = FALSE;
 
   GST_DATA_QUEUE_MUTEX_LOCK_CHECK (queue, flushing);
 
-  STATUS (queue, "before popping");
+  STATUS (queue, "before getting the head");
 
   if (gst_data_queue_locked_is_empty (queue)) {
     GST_DATA_QUEUE_MUTEX_UNLOCK (queue);
@@ -597,20 +659,36 @@ gst_data_queue_pop (GstDataQueue * queue, GstDataQueueItem ** item)
   }
 
   /* Get the item from the GQueue */
-  *item = gst_queue_array_pop_head (priv->queue);
+  if (priv->item_size) {
+    head = gst_queue_array_peek_head_struct (priv->queue);
+    memcpy (p_item, head, priv->item_size);
+    if (pop)
+      gst_queue_array_pop_head_struct (priv->queue);
+  } else {
+    if (pop)
+      head = gst_queue_array_pop_head (priv->queue);
+    else
+      head = gst_queue_array_peek_head (priv->queue);
+    *item = head;
+  }
 
-  /* update current level counter */
-  if ((*item)->visible)
-    priv->cur_level.visible--;
-  priv->cur_level.bytes -= (*item)->size;
-  priv->cur_level.time -= (*item)->duration;
+  if (pop) {
+    /* update current level counter */
+    if (head->visible)
+      priv->cur_level.visible--;
+    priv->cur_level.bytes -= head->size;
+    priv->cur_level.time -= head->duration;
 
-  STATUS (queue, "after popping");
-  if (priv->waiting_del)
-    g_cond_signal (&priv->item_del);
+    wake = priv->waiting_del;
+  }
 
+  STATUS (queue, "after getting the head");
   GST_DATA_QUEUE_MUTEX_UNLOCK (queue);
 
+  /* same as in push, wake up the producer without the lock held */
+  if (wake)
+    g_cond_signal (&priv->item_del);
+
   return TRUE;
 
   /* ERRORS */
@@ -622,6 +700,53 @@ flushing:
   }
 }
 
+/**
+ * gst_data_queue_pop: (skip)
+ * @queue: a #GstDataQueue.
+ * @item: pointer to store the returned #GstDataQueueItem.
+ *
+ * Retrieves the first @item available on the @queue. If the queue is currently
+ * empty, the call will block until at least one item is available, OR the
+ * @queue is set to the flushing state.
+ * MT safe.
+ *
+ * Returns: %TRUE if an @item was successfully retrieved from the @queue.
+ *
+ * Since: 1.2
+ */
+gboolean
+gst_data_queue_pop (GstDataQueue * queue, GstDataQueueItem ** item)
+{
+  g_return_val_if_fail (GST_IS_DATA_QUEUE (queue), FALSE);
+  g_return_val_if_fail (queue->priv->item_size == 0, FALSE);
+  g_return_val_if_fail (item != NULL, FALSE);
+
+  return gst_data_queue_get_head (queue, TRUE, item, NULL);
+}
+
+/**
+ * gst_data_queue_pop_struct: (skip)
+ * @queue: a #GstDataQueue created with gst_data_queue_new_for_struct().
+ * @item: (out caller-allocates): location to copy the first item to.
+ *
+ * Retrieves the first item available on the @queue like gst_data_queue_pop()
+ * and copies it into @item. The caller then owns the contents of @item.
+ * MT safe.
+ *
+ * Returns: %TRUE if an @item was successfully retrieved from the @queue.
+ *
+ * Since: 1.10
+ */
+gboolean
+gst_data_queue_pop_struct (GstDataQueue * queue, GstDataQueueItem * item)
+{
+  g_return_val_if_fail (GST_IS_DATA_QUEUE (queue), FALSE);
+  g_return_val_if_fail (queue->priv->item_size != 0, FALSE);
+  g_return_val_if_fail (item != NULL, FALSE);
+
+  return gst_data_queue_get_head (queue, TRUE, NULL, item);
+}
+
 static gint
 is_of_type (gconstpointer a, gconstpointer b)
 {
@@ -645,42 +770,35 @@ is_of_type (gconstpointer a, gconstpointer b)
 gboolean
 gst_data_queue_peek (GstDataQueue * queue, GstDataQueueItem ** item)
 {
-  GstDataQueuePrivate *priv = queue->priv;
-
   g_return_val_if_fail (GST_IS_DATA_QUEUE (queue), FALSE);
+  g_return_val_if_fail (queue->priv->item_size == 0, FALSE);
   g_return_val_if_fail (item != NULL, FALSE);
 
-  GST_DATA_QUEUE_MUTEX_LOCK_CHECK (queue, flushing);
-
-  STATUS (queue, "before peeking");
-
-  if (gst_data_queue_locked_is_empty (queue)) {
-    GST_DATA_QUEUE_MUTEX_UNLOCK (queue);
-    if (G_LIKELY (priv->emptycallback))
-      priv->emptycallback (queue, priv->checkdata);
-    else
-      g_signal_emit (queue, gst_data_queue_signals[SIGNAL_EMPTY], 0);
-    GST_DATA_QUEUE_MUTEX_LOCK_CHECK (queue, flushing);
-
-    if (!_gst_data_queue_wait_non_empty (queue))
-      goto flushing;
-  }
-
-  /* Get the item from the GQueue */
-  *item = gst_queue_array_peek_head (priv->queue);
-
-  STATUS (queue, "after peeking");
-  GST_DATA_QUEUE_MUTEX_UNLOCK (queue);
+  return gst_data_queue_get_head (queue, FALSE, item, NULL);
+}
 
-  return TRUE;
+/**
+ * gst_data_queue_peek_struct: (skip)
+ * @queue: a #GstDataQueue created with gst_data_queue_new_for_struct().
+ * @item: (out caller-allocates): location to copy the first item to.
+ *
+ * Retrieves the first item available on the @queue without removing it,
+ * like gst_data_queue_peek(), and copies it into @item. The contents of
+ * @item stay owned by the @queue.
+ * MT safe.
+ *
+ * Returns: %TRUE if an @item was successfully retrieved from the @queue.
+ *
+ * Since: 1.10
+ */
+gboolean
+gst_data_queue_peek_struct (GstDataQueue * queue, GstDataQueueItem * item)
+{
+  g_return_val_if_fail (GST_IS_DATA_QUEUE (queue), FALSE);
+  g_return_val_if_fail (queue->priv->item_size != 0, FALSE);
+  g_return_val_if_fail (item != NULL, FALSE);
 
-  /* ERRORS */
-flushing:
-  {
-    GST_DEBUG ("queue:%p, we are flushing", queue);
-    GST_DATA_QUEUE_MUTEX_UNLOCK (queue);
-    return FALSE;
-  }
+  return gst_data_queue_get_head (queue, FALSE, NULL, item);
 }
 
 /**
@@ -712,7 +830,12 @@ gst_data_queue_drop_head (GstDataQueue * queue, GType type)
   if (idx == -1)
     goto done;
 
-  leak = gst_queue_array_drop_element (priv->queue, idx);
+  if (priv->item_size) {
+    leak = g_alloca (priv->item_size);
+    gst_queue_array_drop_struct (priv->queue, idx, leak);
+  } else {
+    leak = gst_queue_array_drop_element (priv->queue, idx);
+  }
 
   if (leak->visible)
     priv->cur_level.visible--;
@@ -141,12 +141,21 @@ GstDataQueue * gst_data_queue_new            (GstDataQueueCheckFullFunction chec
 					      GstDataQueueEmptyCallback emptycallback,
 					      gpointer checkdata) G_GNUC_MALLOC;
 
+GstDataQueue * gst_data_queue_new_for_struct (GstDataQueueCheckFullFunction checkfull,
+					      GstDataQueueFullCallback fullcallback,
+					      GstDataQueueEmptyCallback emptycallback,
+					      gpointer checkdata,
+					      gsize item_size) G_GNUC_MALLOC;
+
 gboolean       gst_data_queue_push           (GstDataQueue * queue, GstDataQueueItem * item);
 gboolean       gst_data_queue_push_force     (GstDataQueue * queue, GstDataQueueItem * item);
 
 gboolean       gst_data_queue_pop            (GstDataQueue * queue, GstDataQueueItem ** item);
 gboolean       gst_data_queue_peek           (GstDataQueue * queue, GstDataQueueItem ** item);
 
+gboolean       gst_data_queue_pop_struct     (GstDataQueue * queue, GstDataQueueItem * item);
+gboolean       gst_data_queue_peek_struct    (GstDataQueue * queue, GstDataQueueItem * item);
+
 void           gst_data_queue_flush          (GstDataQueue * queue);
 
 void           gst_data_queue_set_flushing   (GstDataQueue * queue, gboolean flushing);
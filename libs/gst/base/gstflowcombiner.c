@@ -57,6 +57,11 @@
  * %GST_FLOW_ERROR or below, GST_FLOW_NOT_NEGOTIATED and GST_FLOW_FLUSHING are
  * returned immediatelly from the gst_flow_combiner_update_flow() function.
  *
+ * gst_flow_combiner_update_pad_flow() keeps count of how many pads are in
+ * each state, so that it usually does not need to look at all pads to compute
+ * the combined return. The last flow returns of all pads are looked at again
+ * when the combined return changes and by gst_flow_combiner_update_flow().
+ *
  * Since: 1.4
  */
 
@@ -67,6 +72,13 @@ struct _GstFlowCombiner
 {
   GQueue pads;
 
+  /* the last flow return of each pad as seen by the combiner and the number
+   * of pads that have an error, are not-linked or EOS */
+  GHashTable *pad_flows;
+  guint n_errors;
+  guint n_not_linked;
+  guint n_eos;
+
   GstFlowReturn last_ret;
   volatile gint ref_count;
 };
@@ -92,6 +104,10 @@ gst_flow_combiner_new (void)
   GstFlowCombiner *combiner = g_slice_new (GstFlowCombiner);
 
   g_queue_init (&combiner->pads);
+  combiner->pad_flows = g_hash_table_new (NULL, NULL);
+  combiner->n_errors = 0;
+  combiner->n_not_linked = 0;
+  combiner->n_eos = 0;
   combiner->last_ret = GST_FLOW_OK;
   combiner->ref_count = 1;
 
@@ -133,6 +149,7 @@ gst_flow_combiner_unref (GstFlowCombiner * combiner)
 
     while ((pad = g_queue_pop_head (&combiner->pads)))
       gst_object_unref (pad);
+    g_hash_table_unref (combiner->pad_flows);
 
     g_slice_free (GstFlowCombiner, combiner);
   }
@@ -155,6 +172,10 @@ gst_flow_combiner_clear (GstFlowCombiner * combiner)
 
   while ((pad = g_queue_pop_head (&combiner->pads)))
     gst_object_unref (pad);
+  g_hash_table_remove_all (combiner->pad_flows);
+  combiner->n_errors = 0;
+  combiner->n_not_linked = 0;
+  combiner->n_eos = 0;
   combiner->last_ret = GST_FLOW_OK;
 }
 
@@ -177,42 +198,76 @@ gst_flow_combiner_reset (GstFlowCombiner * combiner)
 
   for (iter = combiner->pads.head; iter; iter = iter->next) {
     GST_PAD_LAST_FLOW_RETURN (iter->data) = GST_FLOW_OK;
+    g_hash_table_insert (combiner->pad_flows, iter->data,
+        GINT_TO_POINTER (GST_FLOW_OK));
   }
+  combiner->n_errors = 0;
+  combiner->n_not_linked = 0;
+  combiner->n_eos = 0;
 
   combiner->last_ret = GST_FLOW_OK;
 }
 
+#define IS_ERROR_FLOW(fret) \
+  ((fret) <= GST_FLOW_NOT_NEGOTIATED || (fret) == GST_FLOW_FLUSHING)
+
+/* add @delta to the counter of the state @fret is in */
+static void
+gst_flow_combiner_count (GstFlowCombiner * combiner, GstFlowReturn fret,
+    gint delta)
+{
+  if (IS_ERROR_FLOW (fret))
+    combiner->n_errors += delta;
+  else if (fret == GST_FLOW_NOT_LINKED)
+    combiner->n_not_linked += delta;
+  else if (fret == GST_FLOW_EOS)
+    combiner->n_eos += delta;
+}
+
+/* combined return from the counters, only valid when no pad has an error */
+static GstFlowReturn
+gst_flow_combiner_get_counted_flow (GstFlowCombiner * combiner)
+{
+  guint n_pads = combiner->pads.length;
+
+  if (combiner->n_not_linked == n_pads)
+    return GST_FLOW_NOT_LINKED;
+  if (combiner->n_not_linked + combiner->n_eos == n_pads)
+    return GST_FLOW_EOS;
+
+  return GST_FLOW_OK;
+}
+
 static GstFlowReturn
 gst_flow_combiner_get_flow (GstFlowCombiner * combiner)
 {
   GstFlowReturn cret = GST_FLOW_OK;
-  gboolean all_eos = TRUE;
-  gboolean all_notlinked = TRUE;
+  gboolean have_error = FALSE;
   GList *iter;
 
   GST_DEBUG ("Combining flow returns");
 
+  combiner->n_errors = 0;
+  combiner->n_not_linked = 0;
+  combiner->n_eos = 0;
+
+  /* look at all pads, also after an error was found, to bring the counters
+   * in sync with the last flow returns of the pads */
   for (iter = combiner->pads.head; iter; iter = iter->next) {
     GstFlowReturn fret = GST_PAD_LAST_FLOW_RETURN (iter->data);
 
-    if (fret <= GST_FLOW_NOT_NEGOTIATED || fret == GST_FLOW_FLUSHING) {
-      GST_DEBUG ("Error flow return found, returning");
+    if (IS_ERROR_FLOW (fret) && !have_error) {
+      GST_DEBUG ("Error flow return found");
       cret = fret;
-      goto done;
-    }
-
-    if (fret != GST_FLOW_NOT_LINKED) {
-      all_notlinked = FALSE;
-      if (fret != GST_FLOW_EOS)
-        all_eos = FALSE;
+      have_error = TRUE;
     }
+    g_hash_table_insert (combiner->pad_flows, iter->data,
+        GINT_TO_POINTER (fret));
+    gst_flow_combiner_count (combiner, fret, 1);
   }
-  if (all_notlinked)
-    cret = GST_FLOW_NOT_LINKED;
-  else if (all_eos)
-    cret = GST_FLOW_EOS;
+  if (!have_error)
+    cret = gst_flow_combiner_get_counted_flow (combiner);
 
-done:
   GST_DEBUG ("Combined flow return: %s (%d)", gst_flow_get_name (cret), cret);
   return cret;
 }
@@ -243,7 +298,7 @@ gst_flow_combiner_update_flow (GstFlowCombiner * combiner, GstFlowReturn fret)
     return fret;
   }
 
-  if (fret <= GST_FLOW_NOT_NEGOTIATED || fret == GST_FLOW_FLUSHING) {
+  if (IS_ERROR_FLOW (fret)) {
     ret = fret;
   } else {
     ret = gst_flow_combiner_get_flow (combiner);
@@ -266,6 +321,11 @@ gst_flow_combiner_update_flow (GstFlowCombiner * combiner, GstFlowReturn fret)
  * combinations and avoid looking over all pads again. e.g. The last combined
  * return is the same as the latest obtained #GstFlowReturn.
  *
+ * The combined return is computed from the last flow returns that were
+ * passed to this function for each pad. Flow returns that were set on the
+ * other pads without the combiner, e.g. by pushing an event, are only taken
+ * into account when the combined return changes.
+ *
  * Returns: The combined #GstFlowReturn
  * Since: 1.6
  */
@@ -273,11 +333,37 @@ GstFlowReturn
 gst_flow_combiner_update_pad_flow (GstFlowCombiner * combiner, GstPad * pad,
     GstFlowReturn fret)
 {
+  gpointer old;
+  GstFlowReturn ret;
+
+  g_return_val_if_fail (combiner != NULL, GST_FLOW_ERROR);
   g_return_val_if_fail (pad != NULL, GST_FLOW_ERROR);
 
   GST_PAD_LAST_FLOW_RETURN (pad) = fret;
 
-  return gst_flow_combiner_update_flow (combiner, fret);
+  if (!g_hash_table_lookup_extended (combiner->pad_flows, pad, NULL, &old))
+    return gst_flow_combiner_update_flow (combiner, fret);
+
+  /* move the pad to its new state */
+  if (GPOINTER_TO_INT (old) != fret) {
+    gst_flow_combiner_count (combiner, GPOINTER_TO_INT (old), -1);
+    gst_flow_combiner_count (combiner, fret, 1);
+    g_hash_table_insert (combiner->pad_flows, pad, GINT_TO_POINTER (fret));
+  }
+
+  if (IS_ERROR_FLOW (fret)) {
+    ret = fret;
+  } else if (combiner->n_errors == 0 &&
+      gst_flow_combiner_get_counted_flow (combiner) == combiner->last_ret) {
+    /* nothing changed */
+    return combiner->last_ret;
+  } else {
+    /* look at all pads again, their flow return might have been changed
+     * without going through the combiner */
+    ret = gst_flow_combiner_get_flow (combiner);
+  }
+  combiner->last_ret = ret;
+  return ret;
 }
 
 /**
@@ -292,10 +378,18 @@ gst_flow_combiner_update_pad_flow (GstFlowCombiner * combiner, GstPad * pad,
 void
 gst_flow_combiner_add_pad (GstFlowCombiner * combiner, GstPad * pad)
 {
+  GstFlowReturn fret;
+
   g_return_if_fail (combiner != NULL);
   g_return_if_fail (pad != NULL);
 
+  if (g_hash_table_contains (combiner->pad_flows, pad))
+    return;
+
+  fret = GST_PAD_LAST_FLOW_RETURN (pad);
   g_queue_push_head (&combiner->pads, gst_object_ref (pad));
+  g_hash_table_insert (combiner->pad_flows, pad, GINT_TO_POINTER (fret));
+  gst_flow_combiner_count (combiner, fret, 1);
 }
 
 /**
@@ -310,9 +404,15 @@ gst_flow_combiner_add_pad (GstFlowCombiner * combiner, GstPad * pad)
 void
 gst_flow_combiner_remove_pad (GstFlowCombiner * combiner, GstPad * pad)
 {
+  gpointer old;
+
   g_return_if_fail (combiner != NULL);
   g_return_if_fail (pad != NULL);
 
+  if (g_hash_table_lookup_extended (combiner->pad_flows, pad, NULL, &old)) {
+    gst_flow_combiner_count (combiner, GPOINTER_TO_INT (old), -1);
+    g_hash_table_remove (combiner->pad_flows, pad);
+  }
   if (g_queue_remove (&combiner->pads, pad))
     gst_object_unref (pad);
 }
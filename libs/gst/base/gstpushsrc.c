@@ -123,9 +123,24 @@ gst_push_src_create (GstBaseSrc * bsrc, guint64 offset, guint length,
   GstFlowReturn fret;
   GstPushSrc *src;
   GstPushSrcClass *pclass;
+  GstBufferList *list = NULL;
 
   src = GST_PUSH_SRC (bsrc);
   pclass = GST_PUSH_SRC_GET_CLASS (src);
+
+  /* lists can only be pushed, so not when a buffer to fill is provided */
+  if (pclass->create_list && *ret == NULL) {
+    fret = pclass->create_list (src, &list);
+    if (fret == GST_FLOW_OK) {
+      if (G_UNLIKELY (list == NULL || gst_buffer_list_length (list) == 0))
+        goto empty_list;
+      gst_base_src_submit_buffer_list (bsrc, list);
+    } else if (list) {
+      gst_buffer_list_unref (list);
+    }
+    return fret;
+  }
+
   if (pclass->create)
     fret = pclass->create (src, ret);
   else
@@ -133,6 +148,16 @@ gst_push_src_create (GstBaseSrc * bsrc, guint64 offset, guint length,
         GST_BASE_SRC_CLASS (parent_class)->create (bsrc, offset, length, ret);
 
   return fret;
+
+  /* ERRORS */
+empty_list:
+  {
+    GST_ELEMENT_ERROR (src, CORE, FAILED, (NULL),
+        ("create_list returned an empty buffer list"));
+    if (list)
+      gst_buffer_list_unref (list);
+    return GST_FLOW_ERROR;
+  }
 }
 
 static GstFlowReturn
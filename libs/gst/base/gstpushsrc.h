@@ -62,6 +62,9 @@ struct _GstPushSrc {
  *         size this buffer should be. The default implementation will create
  *         a new buffer from the negotiated allocator.
  * @fill: Ask the subclass to fill the buffer with data.
+ * @create_list: Ask the subclass to create a list of buffers that is pushed
+ *          downstream at once, see gst_base_src_submit_buffer_list(). Takes
+ *          precedence over @create in push mode. Since: 1.10
  *
  * Subclasses can override any of the available virtual methods or not, as
  * needed. At the minimum, the @fill method should be overridden to produce
@@ -78,8 +81,11 @@ struct _GstPushSrcClass {
   /* ask the subclass to fill a buffer */
   GstFlowReturn (*fill)   (GstPushSrc *src, GstBuffer *buf);
 
+  /* ask the subclass to create a non-empty list of buffers */
+  GstFlowReturn (*create_list) (GstPushSrc *src, GstBufferList **list);
+
   /*< private >*/
-  gpointer _gst_reserved[GST_PADDING];
+  gpointer _gst_reserved[GST_PADDING - 1];
 };
 
 GType gst_push_src_get_type(void);
@@ -27,6 +27,15 @@
  * #GstQueueArray is an object that provides standard queue functionality
  * based on an array instead of linked lists. This reduces the overhead
  * caused by memory management by a large factor.
+ *
+ * When the size of the queue is a power of 2, positions are wrapped around
+ * with a mask instead of a modulo and the queue grows by doubling its size so
+ * that it stays a power of 2. Create the queue with a power of 2 initial size
+ * to use this mode.
+ *
+ * Multiple elements can be moved in and out of the queue at once with
+ * gst_queue_array_push_tail_n() and gst_queue_array_pop_head_n(), which copy
+ * the elements with at most two memcpy() calls.
  */
 
 
@@ -44,8 +53,21 @@ struct _GstQueueArray
   guint length;
   guint elt_size;
   gboolean struct_array;
+  guint mask;                   /* size - 1 when size is a power of 2, else 0 */
 };
 
+#define IS_POWER_OF_2(n) ((n) >= 2 && ((n) & ((n) - 1)) == 0)
+
+/* wrap @pos around the size of @array */
+#define WRAP(array,pos) \
+    ((array)->mask ? ((pos) & (array)->mask) : ((pos) % (array)->size))
+
+static inline void
+gst_queue_array_update_mask (GstQueueArray * array)
+{
+  array->mask = IS_POWER_OF_2 (array->size) ? array->size - 1 : 0;
+}
+
 /**
  * gst_queue_array_new_for_struct: (skip)
  * @struct_size: Size of each element (e.g. structure) in the array
@@ -73,6 +95,7 @@ gst_queue_array_new_for_struct (gsize struct_size, guint initial_size)
   array->tail = 0;
   array->length = 0;
   array->struct_array = TRUE;
+  gst_queue_array_update_mask (array);
   return array;
 }
 
@@ -135,8 +158,7 @@ gst_queue_array_pop_head_struct (GstQueueArray * array)
 
   p_struct = array->array + (array->elt_size * array->head);
 
-  array->head++;
-  array->head %= array->size;
+  array->head = WRAP (array, array->head + 1);
   array->length--;
 
   return p_struct;
@@ -163,12 +185,50 @@ gst_queue_array_pop_head (GstQueueArray * array)
     return NULL;
 
   ret = *(gpointer *) (array->array + (sizeof (gpointer) * array->head));
-  array->head++;
-  array->head %= array->size;
+  array->head = WRAP (array, array->head + 1);
   array->length--;
   return ret;
 }
 
+/**
+ * gst_queue_array_pop_head_n: (skip)
+ * @array: a #GstQueueArray object
+ * @data: address where to store the elements
+ * @n: the maximum number of elements to pop
+ *
+ * Removes up to @n elements from the head of the queue @array and stores
+ * them contiguously at @data, which must have room for @n elements of the
+ * size of the queue elements.
+ *
+ * Returns: the number of elements that were removed
+ *
+ * Since: 1.10
+ */
+guint
+gst_queue_array_pop_head_n (GstQueueArray * array, gpointer data, guint n)
+{
+  guint elt_size, span;
+
+  g_return_val_if_fail (data != NULL || n == 0, 0);
+
+  n = MIN (n, array->length);
+  if (n == 0)
+    return 0;
+
+  elt_size = array->elt_size;
+
+  span = MIN (n, array->size - array->head);
+  memcpy (data, array->array + elt_size * array->head, span * elt_size);
+  if (span < n)
+    memcpy ((guint8 *) data + span * elt_size, array->array,
+        (n - span) * elt_size);
+
+  array->head = WRAP (array, array->head + n);
+  array->length -= n;
+
+  return n;
+}
+
 /**
  * gst_queue_array_peek_head_struct: (skip)
  * @array: a #GstQueueArray object
@@ -212,13 +272,65 @@ gst_queue_array_peek_head (GstQueueArray * array)
   return *(gpointer *) (array->array + (sizeof (gpointer) * array->head));
 }
 
+/**
+ * gst_queue_array_peek_nth_struct: (skip)
+ * @array: a #GstQueueArray object
+ * @idx: the position of the element, 0 is the head of the queue
+ *
+ * Returns the element at position @idx in the queue @array without removing
+ * it from the queue.
+ *
+ * Returns: pointer to element or struct, or NULL if @idx was out of bounds.
+ *    The data pointed to by the returned pointer stays valid only as long as
+ *    the queue array is not modified further!
+ *
+ * Since: 1.10
+ */
+gpointer
+gst_queue_array_peek_nth_struct (GstQueueArray * array, guint idx)
+{
+  if (G_UNLIKELY (idx >= array->length))
+    return NULL;
+
+  return array->array + (array->elt_size * WRAP (array, array->head + idx));
+}
+
+/**
+ * gst_queue_array_peek_nth: (skip)
+ * @array: a #GstQueueArray object
+ * @idx: the position of the element, 0 is the head of the queue
+ *
+ * Returns the element at position @idx in the queue @array without removing
+ * it from the queue.
+ *
+ * Returns: The element at position @idx, or NULL if @idx was out of bounds.
+ *
+ * Since: 1.10
+ */
+gpointer
+gst_queue_array_peek_nth (GstQueueArray * array, guint idx)
+{
+  if (G_UNLIKELY (idx >= array->length))
+    return NULL;
+
+  return *(gpointer *) (array->array +
+      (sizeof (gpointer) * WRAP (array, array->head + idx)));
+}
+
 static void
 gst_queue_array_do_expand (GstQueueArray * array)
 {
   guint elt_size = array->elt_size;
-  /* newsize is 50% bigger */
   guint oldsize = array->size;
-  guint newsize = MAX ((3 * oldsize) / 2, oldsize + 1);
+  guint newsize;
+
+  if (array->mask) {
+    /* stay a power of 2 so that we can keep on using the mask */
+    newsize = oldsize << 1;
+  } else {
+    /* newsize is 50% bigger */
+    newsize = MAX ((3 * oldsize) / 2, oldsize + 1);
+  }
 
   /* copy over data */
   if (array->tail != 0) {
@@ -249,6 +361,79 @@ gst_queue_array_do_expand (GstQueueArray * array)
   }
   array->tail = oldsize;
   array->size = newsize;
+  gst_queue_array_update_mask (array);
+}
+
+/* grow @array so that it can hold at least @min_size elements */
+static void
+gst_queue_array_expand_for (GstQueueArray * array, guint min_size)
+{
+  guint elt_size = array->elt_size;
+  guint newsize = MAX (array->size, 1);
+  guint8 *array2;
+  guint span;
+
+  while (newsize < min_size) {
+    if (array->mask)
+      newsize <<= 1;
+    else
+      newsize = MAX ((3 * newsize) / 2, newsize + 1);
+  }
+
+  /* move the elements to the beginning of the new array */
+  array2 = g_malloc0 (elt_size * newsize);
+  span = MIN (array->length, array->size - array->head);
+  memcpy (array2, array->array + elt_size * array->head, span * elt_size);
+  memcpy (array2 + span * elt_size, array->array,
+      (array->length - span) * elt_size);
+
+  g_free (array->array);
+  array->array = array2;
+  array->head = 0;
+  array->tail = array->length;
+  array->size = newsize;
+  gst_queue_array_update_mask (array);
+}
+
+/**
+ * gst_queue_array_push_tail_n: (skip)
+ * @array: a #GstQueueArray object
+ * @data: address of the first element to push
+ * @n: the number of elements to push
+ *
+ * Pushes @n elements stored contiguously at @data to the tail of the queue
+ * @array. For queues created with gst_queue_array_new(), @data is an array
+ * of pointers, for queues created with gst_queue_array_new_for_struct(), it
+ * is an array of structures of the struct_size of the queue.
+ *
+ * Since: 1.10
+ */
+void
+gst_queue_array_push_tail_n (GstQueueArray * array, gconstpointer data,
+    guint n)
+{
+  guint elt_size, span;
+
+  g_return_if_fail (data != NULL || n == 0);
+
+  if (n == 0)
+    return;
+
+  elt_size = array->elt_size;
+
+  /* Check if we need to make room */
+  if (G_UNLIKELY (array->length + n > array->size))
+    gst_queue_array_expand_for (array, array->length + n);
+
+  /* copy up to the end of the array and wrap around for the rest */
+  span = MIN (n, array->size - array->tail);
+  memcpy (array->array + elt_size * array->tail, data, span * elt_size);
+  if (span < n)
+    memcpy (array->array, (const guint8 *) data + span * elt_size,
+        (n - span) * elt_size);
+
+  array->tail = WRAP (array, array->tail + n);
+  array->length += n;
 }
 
 /**
@@ -276,8 +461,7 @@ gst_queue_array_push_tail_struct (GstQueueArray * array, gpointer p_struct)
     gst_queue_array_do_expand (array);
 
   memcpy (array->array + elt_size * array->tail, p_struct, elt_size);
-  array->tail++;
-  array->tail %= array->size;
+  array->tail = WRAP (array, array->tail + 1);
   array->length++;
 }
 
@@ -298,8 +482,7 @@ gst_queue_array_push_tail (GstQueueArray * array, gpointer data)
     gst_queue_array_do_expand (array);
 
   *(gpointer *) (array->array + sizeof (gpointer) * array->tail) = data;
-  array->tail++;
-  array->tail %= array->size;
+  array->tail = WRAP (array, array->tail + 1);
   array->length++;
 }
 
@@ -349,7 +532,7 @@ gst_queue_array_drop_struct (GstQueueArray * array, guint idx,
   first_item_index = array->head;
 
   /* tail points to the first free spot */
-  last_item_index = (array->tail - 1 + array->size) % array->size;
+  last_item_index = WRAP (array, array->tail - 1 + array->size);
 
   if (p_struct != NULL)
     memcpy (p_struct, array->array + elt_size * idx, elt_size);
@@ -357,8 +540,7 @@ gst_queue_array_drop_struct (GstQueueArray * array, guint idx,
   /* simple case idx == first item */
   if (idx == first_item_index) {
     /* move the head plus one */
-    array->head++;
-    array->head %= array->size;
+    array->head = WRAP (array, array->head + 1);
     array->length--;
     return TRUE;
   }
@@ -366,7 +548,7 @@ gst_queue_array_drop_struct (GstQueueArray * array, guint idx,
   /* simple case idx == last item */
   if (idx == last_item_index) {
     /* move tail minus one, potentially wrapping */
-    array->tail = (array->tail - 1 + array->size) % array->size;
+    array->tail = WRAP (array, array->tail - 1 + array->size);
     array->length--;
     return TRUE;
   }
@@ -379,7 +561,7 @@ gst_queue_array_drop_struct (GstQueueArray * array, guint idx,
         array->array + elt_size * (idx + 1),
         (last_item_index - idx) * elt_size);
     /* tail might wrap, ie if tail == 0 (and last_item_index == size) */
-    array->tail = (array->tail - 1 + array->size) % array->size;
+    array->tail = WRAP (array, array->tail - 1 + array->size);
     array->length--;
     return TRUE;
   }
@@ -451,6 +633,10 @@ gst_queue_array_drop_element (GstQueueArray * array, guint idx)
  * gst_queue_array_drop_element(). FIXME: return index 0-based and make
  * gst_queue_array_drop_element() take a 0-based index.
  *
+ * For arrays of structures, @func is required and is called with a pointer
+ * to the data of each structure. The index can be used with
+ * gst_queue_array_drop_struct(). Since 1.10.
+ *
  * Returns: Index of the found element or -1 if nothing was found.
  *
  * Since: 1.2
@@ -462,25 +648,31 @@ gst_queue_array_find (GstQueueArray * array, GCompareFunc func, gpointer data)
   guint elt_size;
   guint i;
 
-  /* For struct arrays we need to implement this differently so that
-   * the user gets a pointer to the element data not the dereferenced
-   * pointer itself */
-  g_return_val_if_fail (array->struct_array == FALSE, -1);
+  /* structures can only be compared with a function */
+  g_return_val_if_fail (func != NULL || !array->struct_array, -1);
 
   elt_size = array->elt_size;
 
-  if (func != NULL) {
+  if (array->struct_array) {
+    /* the user gets a pointer to the element data, not the dereferenced
+     * pointer itself */
+    for (i = 0; i < array->length; i++) {
+      p_element = array->array + WRAP (array, i + array->head) * elt_size;
+      if (func (p_element, data) == 0)
+        return WRAP (array, i + array->head);
+    }
+  } else if (func != NULL) {
     /* Scan from head to tail */
     for (i = 0; i < array->length; i++) {
-      p_element = array->array + ((i + array->head) % array->size) * elt_size;
+      p_element = array->array + WRAP (array, i + array->head) * elt_size;
       if (func (*(gpointer *) p_element, data) == 0)
-        return (i + array->head) % array->size;
+        return WRAP (array, i + array->head);
     }
   } else {
     for (i = 0; i < array->length; i++) {
-      p_element = array->array + ((i + array->head) % array->size) * elt_size;
+      p_element = array->array + WRAP (array, i + array->head) * elt_size;
       if (*(gpointer *) p_element == data)
-        return (i + array->head) % array->size;
+        return WRAP (array, i + array->head);
     }
   }
 
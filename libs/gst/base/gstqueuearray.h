@@ -50,6 +50,19 @@ guint           gst_queue_array_find (GstQueueArray * array,
 
 guint           gst_queue_array_get_length (GstQueueArray * array);
 
+gpointer        gst_queue_array_peek_nth (GstQueueArray * array,
+                                          guint           idx);
+
+/* Functions for moving multiple elements at once */
+
+void            gst_queue_array_push_tail_n (GstQueueArray * array,
+                                             gconstpointer   data,
+                                             guint           n);
+
+guint           gst_queue_array_pop_head_n  (GstQueueArray * array,
+                                             gpointer        data,
+                                             guint           n);
+
 /* Functions for use with structures */
 
 GstQueueArray * gst_queue_array_new_for_struct (gsize struct_size,
@@ -62,6 +75,9 @@ gpointer        gst_queue_array_pop_head_struct  (GstQueueArray * array);
 
 gpointer        gst_queue_array_peek_head_struct (GstQueueArray * array);
 
+gpointer        gst_queue_array_peek_nth_struct  (GstQueueArray * array,
+                                                  guint           idx);
+
 gboolean        gst_queue_array_drop_struct      (GstQueueArray * array,
                                                   guint           idx,
                                                   gpointer        p_struct);
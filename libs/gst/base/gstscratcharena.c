@@ -0,0 +1,343 @@
+/* GStreamer
+ *
+ * gstscratcharena.c: per-thread scratch memory for streaming threads
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/**
+ * SECTION:gstscratcharena
+ * @short_description: Per-thread scratch memory for streaming threads
+ *
+ * #GstScratchArena gives each streaming thread a bump-pointer allocator for
+ * temporary memory such as header assembly, line buffers or conversion
+ * scratch that is only needed while a buffer is being processed. Allocating
+ * from the arena is a pointer increment and nothing is freed individually,
+ * the memory is reused for the next buffer instead of going through
+ * g_malloc() and g_free() for every buffer.
+ *
+ * Get the arena of the current thread with gst_scratch_arena_get() and
+ * allocate from it with gst_scratch_arena_alloc(). The memory stays valid
+ * until the chain function that allocated it returns. #GstBaseTransform,
+ * #GstBaseParse and #GstBaseSink release the allocations made during their
+ * chain function automatically, other elements wrap their chain function
+ * with gst_scratch_arena_enter() and gst_scratch_arena_leave():
+ *
+ * |[<!-- language="C" -->
+ * static GstFlowReturn
+ * my_element_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+ * {
+ *   GstScratchArenaMark mark;
+ *   GstFlowReturn ret;
+ *
+ *   gst_scratch_arena_enter (&mark);
+ *   ret = my_element_process (MY_ELEMENT (parent), buffer);
+ *   gst_scratch_arena_leave (&mark);
+ *
+ *   return ret;
+ * }
+ * ]|
+ *
+ * Chain functions nest when an element pushes downstream, the allocations
+ * of the upstream element stay valid while downstream elements use the
+ * arena on top of them.
+ *
+ * Memory from the arena must not be passed to other threads or kept after
+ * the chain function returns, wrap it in a #GstBuffer with g_malloc()ed
+ * memory for that.
+ *
+ * Since: 1.10
+ */
+
+#include <gst/gst.h>
+#include <string.h>
+
+#include "gstscratcharena.h"
+
+/* allocations are aligned for any basic type and SIMD loads */
+#define ARENA_ALIGN 16
+#define ALIGN_UP(s) (((s) + ARENA_ALIGN - 1) & ~((gsize) ARENA_ALIGN - 1))
+
+#define MIN_BLOCK_SIZE (4 * 1024)
+/* on reset the arena drops its blocks when it grew larger than this */
+#define MAX_RETAINED_SIZE (4 * 1024 * 1024)
+
+typedef struct _ArenaBlock ArenaBlock;
+
+struct _ArenaBlock
+{
+  ArenaBlock *next;
+  gsize size;
+};
+
+#define BLOCK_HEADER_SIZE ALIGN_UP (sizeof (ArenaBlock))
+#define BLOCK_DATA(b) ((guint8 *) (b) + BLOCK_HEADER_SIZE)
+
+struct _GstScratchArena
+{
+  ArenaBlock *first;
+  /* block and offset of the next allocation, NULL before the first block */
+  ArenaBlock *current;
+  gsize offset;
+  /* size of all blocks */
+  gsize total;
+};
+
+static void
+gst_scratch_arena_free_blocks (GstScratchArena * arena)
+{
+  ArenaBlock *block, *next;
+
+  for (block = arena->first; block; block = next) {
+    next = block->next;
+    g_free (block);
+  }
+  arena->first = NULL;
+  arena->current = NULL;
+  arena->offset = 0;
+  arena->total = 0;
+}
+
+static void
+gst_scratch_arena_free (gpointer data)
+{
+  GstScratchArena *arena = data;
+
+  gst_scratch_arena_free_blocks (arena);
+  g_slice_free (GstScratchArena, arena);
+}
+
+static GPrivate thread_arena = G_PRIVATE_INIT (gst_scratch_arena_free);
+
+/**
+ * gst_scratch_arena_get: (skip)
+ *
+ * Get the scratch arena of the current thread, it is created on first use
+ * and freed when the thread exits.
+ *
+ * Returns: (transfer none): the #GstScratchArena of the current thread
+ *
+ * Since: 1.10
+ */
+GstScratchArena *
+gst_scratch_arena_get (void)
+{
+  GstScratchArena *arena;
+
+  arena = g_private_get (&thread_arena);
+  if (G_UNLIKELY (arena == NULL)) {
+    arena = g_slice_new0 (GstScratchArena);
+    g_private_set (&thread_arena, arena);
+  }
+  return arena;
+}
+
+/**
+ * gst_scratch_arena_alloc: (skip)
+ * @arena: a #GstScratchArena
+ * @size: number of bytes to allocate
+ *
+ * Allocate @size bytes from @arena, aligned to 16 bytes. The memory is not
+ * initialized and is reused after the current chain function returns or
+ * the allocation is released with gst_scratch_arena_release().
+ *
+ * Returns: (transfer none): the allocated memory
+ *
+ * Since: 1.10
+ */
+gpointer
+gst_scratch_arena_alloc (GstScratchArena * arena, gsize size)
+{
+  ArenaBlock *block, *next;
+  gsize block_size;
+  gpointer res;
+
+  g_return_val_if_fail (arena != NULL, NULL);
+
+  size = ALIGN_UP (MAX (size, 1));
+
+  while (TRUE) {
+    block = arena->current;
+    if (G_LIKELY (block && block->size - arena->offset >= size)) {
+      res = BLOCK_DATA (block) + arena->offset;
+      arena->offset += size;
+      return res;
+    }
+
+    /* reuse the next block when it is large enough */
+    next = block ? block->next : arena->first;
+    if (next == NULL || next->size < size)
+      break;
+    arena->current = next;
+    arena->offset = 0;
+  }
+
+  /* insert a new block in front of the next one, growing the arena
+   * geometrically so that a thread settles on a few blocks */
+  block_size = MAX (MAX (size, MIN_BLOCK_SIZE), arena->total);
+  block = g_malloc (BLOCK_HEADER_SIZE + block_size);
+  block->size = block_size;
+  block->next = next;
+  if (arena->current)
+    arena->current->next = block;
+  else
+    arena->first = block;
+  arena->total += block_size;
+
+  arena->current = block;
+  arena->offset = size;
+
+  return BLOCK_DATA (block);
+}
+
+/**
+ * gst_scratch_arena_alloc0: (skip)
+ * @arena: a #GstScratchArena
+ * @size: number of bytes to allocate
+ *
+ * Allocate @size bytes from @arena like gst_scratch_arena_alloc() and fill
+ * them with 0.
+ *
+ * Returns: (transfer none): the allocated memory
+ *
+ * Since: 1.10
+ */
+gpointer
+gst_scratch_arena_alloc0 (GstScratchArena * arena, gsize size)
+{
+  gpointer res;
+
+  res = gst_scratch_arena_alloc (arena, size);
+  if (res)
+    memset (res, 0, size);
+
+  return res;
+}
+
+/**
+ * gst_scratch_arena_mark: (skip)
+ * @arena: a #GstScratchArena
+ * @mark: (out caller-allocates): the mark to fill
+ *
+ * Remember the current position of @arena in @mark so that the allocations
+ * made after it can be released with gst_scratch_arena_release().
+ *
+ * Since: 1.10
+ */
+void
+gst_scratch_arena_mark (GstScratchArena * arena, GstScratchArenaMark * mark)
+{
+  g_return_if_fail (arena != NULL);
+  g_return_if_fail (mark != NULL);
+
+  mark->block = arena->current;
+  mark->offset = arena->offset;
+}
+
+/**
+ * gst_scratch_arena_release: (skip)
+ * @arena: a #GstScratchArena
+ * @mark: a mark of @arena
+ *
+ * Release all allocations made from @arena after @mark was taken. Marks
+ * must be released in the reverse order they were taken.
+ *
+ * Since: 1.10
+ */
+void
+gst_scratch_arena_release (GstScratchArena * arena,
+    const GstScratchArenaMark * mark)
+{
+  g_return_if_fail (arena != NULL);
+  g_return_if_fail (mark != NULL);
+
+  if (mark->block == NULL) {
+    gst_scratch_arena_reset (arena);
+    return;
+  }
+  arena->current = mark->block;
+  arena->offset = mark->offset;
+}
+
+/**
+ * gst_scratch_arena_reset: (skip)
+ * @arena: a #GstScratchArena
+ *
+ * Release all allocations of @arena. The memory is kept for reuse unless
+ * the arena grew unusually large.
+ *
+ * Since: 1.10
+ */
+void
+gst_scratch_arena_reset (GstScratchArena * arena)
+{
+  g_return_if_fail (arena != NULL);
+
+  if (G_UNLIKELY (arena->total > MAX_RETAINED_SIZE))
+    gst_scratch_arena_free_blocks (arena);
+
+  arena->current = NULL;
+  arena->offset = 0;
+}
+
+/**
+ * gst_scratch_arena_enter: (skip)
+ * @mark: (out caller-allocates): the mark to fill
+ *
+ * Remember the position of the scratch arena of the current thread at the
+ * start of a chain function. This does not create the arena if the thread
+ * did not use it yet.
+ *
+ * Since: 1.10
+ */
+void
+gst_scratch_arena_enter (GstScratchArenaMark * mark)
+{
+  GstScratchArena *arena;
+
+  g_return_if_fail (mark != NULL);
+
+  arena = g_private_get (&thread_arena);
+  if (arena) {
+    mark->block = arena->current;
+    mark->offset = arena->offset;
+  } else {
+    mark->block = NULL;
+    mark->offset = 0;
+  }
+}
+
+/**
+ * gst_scratch_arena_leave: (skip)
+ * @mark: a mark from gst_scratch_arena_enter()
+ *
+ * Release the allocations made from the scratch arena of the current thread
+ * since the matching gst_scratch_arena_enter(), at the end of a chain
+ * function.
+ *
+ * Since: 1.10
+ */
+void
+gst_scratch_arena_leave (const GstScratchArenaMark * mark)
+{
+  GstScratchArena *arena;
+
+  g_return_if_fail (mark != NULL);
+
+  arena = g_private_get (&thread_arena);
+  if (arena)
+    gst_scratch_arena_release (arena, mark);
+}
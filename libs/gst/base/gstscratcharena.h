@@ -0,0 +1,71 @@
+/* GStreamer
+ *
+ * gstscratcharena.h: per-thread scratch memory for streaming threads
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __GST_SCRATCH_ARENA_H__
+#define __GST_SCRATCH_ARENA_H__
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+/**
+ * GstScratchArena: (skip)
+ *
+ * The opaque per-thread scratch arena.
+ *
+ * Since: 1.10
+ */
+typedef struct _GstScratchArena GstScratchArena;
+
+/**
+ * GstScratchArenaMark: (skip)
+ *
+ * A position in a #GstScratchArena, allocations made after the mark are
+ * released together with gst_scratch_arena_release(). Allocate it on the
+ * stack, its fields are private.
+ *
+ * Since: 1.10
+ */
+typedef struct {
+  /*< private >*/
+  gpointer block;
+  gsize    offset;
+} GstScratchArenaMark;
+
+GstScratchArena * gst_scratch_arena_get      (void);
+
+gpointer          gst_scratch_arena_alloc    (GstScratchArena * arena,
+                                              gsize             size);
+gpointer          gst_scratch_arena_alloc0   (GstScratchArena * arena,
+                                              gsize             size);
+
+void              gst_scratch_arena_mark     (GstScratchArena     * arena,
+                                              GstScratchArenaMark * mark);
+void              gst_scratch_arena_release  (GstScratchArena           * arena,
+                                              const GstScratchArenaMark * mark);
+void              gst_scratch_arena_reset    (GstScratchArena * arena);
+
+/* for chain functions */
+void              gst_scratch_arena_enter    (GstScratchArenaMark * mark);
+void              gst_scratch_arena_leave    (const GstScratchArenaMark * mark);
+
+G_END_DECLS
+
+#endif /* __GST_SCRATCH_ARENA_H__ */
@@ -46,17 +46,26 @@ static void
 helper_find_suggest (gpointer data, GstTypeFindProbability probability,
     GstCaps * caps);
 
+/* the cache works on aligned blocks of this size, some typefinders go in 1
+ * byte steps over 1k of data and request small buffers. It is really
+ * inefficient to pull each time, and pulling a larger chunk is almost free */
+#define BLOCK_SIZE 4096
+
 typedef struct
 {
   GstBuffer *buffer;
   GstMapInfo map;
+  guint64 offset;
 } GstMappedBuffer;
 
 typedef struct
 {
+  GHashTable *blocks;           /* block index -> GstMappedBuffer covering it */
   GSList *buffers;              /* buffer cache */
+  GSList *copies;               /* peeks spanning several buffers */
+  guint n_pulls;
+  guint n_peeks;
   guint64 size;
-  guint64 last_offset;
   GstTypeFindHelperGetRangeFunction func;
   GstTypeFindProbability best_probability;
   GstCaps *caps;
@@ -65,13 +74,57 @@ typedef struct
   GstObject *parent;
 } GstTypeFindHelper;
 
+static GstMappedBuffer *
+helper_find_block (GstTypeFindHelper * helper, guint64 block)
+{
+  return g_hash_table_lookup (helper->blocks, &block);
+}
+
+/* returns the cached data for the range, copying it together when it is
+ * spread over several buffers, or %NULL when part of it is missing */
+static const guint8 *
+helper_find_lookup (GstTypeFindHelper * helper, guint64 offset, guint size)
+{
+  GstMappedBuffer *bmap;
+  guint64 pos, end = offset + size;
+  guint8 *copy;
+
+  bmap = helper_find_block (helper, offset / BLOCK_SIZE);
+  if (bmap == NULL)
+    return NULL;
+
+  if (bmap->offset <= offset && end <= bmap->offset + bmap->map.size)
+    return (guint8 *) bmap->map.data + (offset - bmap->offset);
+
+  /* check that all the blocks are there */
+  for (pos = offset; pos < end; pos = (pos / BLOCK_SIZE + 1) * BLOCK_SIZE) {
+    guint64 block_end = MIN ((pos / BLOCK_SIZE + 1) * BLOCK_SIZE, end);
+
+    bmap = helper_find_block (helper, pos / BLOCK_SIZE);
+    if (bmap == NULL || bmap->offset + bmap->map.size < block_end)
+      return NULL;
+  }
+
+  copy = g_malloc (size);
+  for (pos = offset; pos < end; pos = (pos / BLOCK_SIZE + 1) * BLOCK_SIZE) {
+    guint64 block_end = MIN ((pos / BLOCK_SIZE + 1) * BLOCK_SIZE, end);
+
+    bmap = helper_find_block (helper, pos / BLOCK_SIZE);
+    memcpy (copy + (pos - offset), bmap->map.data + (pos - bmap->offset),
+        block_end - pos);
+  }
+  helper->copies = g_slist_prepend (helper->copies, copy);
+
+  return copy;
+}
+
 /*
  * helper_find_peek:
  * @data: helper data struct
  * @off: stream offset
  * @size: block size
  *
- * Get data pointer within a stream. Keeps a cache of read buffers (partly
+ * Get data pointer within a stream. Keeps a cache of read blocks (partly
  * for performance reasons, but mostly because pointers returned by us need
  * to stay valid until typefinding has finished)
  *
@@ -84,13 +137,10 @@ helper_find_peek (gpointer data, gint64 offset, guint size)
   GstTypeFindHelper *helper;
   GstBuffer *buffer;
   GstFlowReturn ret;
-  GSList *insert_pos = NULL;
   gsize buf_size;
-  guint64 buf_offset;
+  guint64 buf_offset, first, last, block;
+  const guint8 *res;
   GstMappedBuffer *bmap;
-#if 0
-  GstCaps *caps;
-#endif
 
   helper = (GstTypeFindHelper *) data;
 
@@ -107,70 +157,44 @@ helper_find_peek (gpointer data, gint64 offset, guint size)
     offset += helper->size;
   }
 
-  /* see if we have a matching buffer already in our list */
-  if (size > 0 && offset <= helper->last_offset) {
-    GSList *walk;
+  helper->n_peeks++;
 
-    for (walk = helper->buffers; walk; walk = walk->next) {
-      GstMappedBuffer *bmp = (GstMappedBuffer *) walk->data;
-      GstBuffer *buf = GST_BUFFER_CAST (bmp->buffer);
+  if ((res = helper_find_lookup (helper, offset, size)))
+    return res;
 
-      buf_offset = GST_BUFFER_OFFSET (buf);
-      buf_size = bmp->map.size;
+  /* pull all missing blocks of the request at once */
+  first = offset / BLOCK_SIZE;
+  last = (offset + size - 1) / BLOCK_SIZE;
+  while (first < last && helper_find_block (helper, first))
+    first++;
+  while (last > first && helper_find_block (helper, last))
+    last--;
 
-      /* buffers are kept sorted by end offset (highest first) in the list, so
-       * at this point we save the current position and stop searching if 
-       * we're after the searched end offset */
-      if (buf_offset <= offset) {
-        if ((offset + size) < (buf_offset + buf_size)) {
-          /* must already have been mapped before */
-          return (guint8 *) bmp->map.data + (offset - buf_offset);
-        }
-      } else if (offset + size >= buf_offset + buf_size) {
-        insert_pos = walk;
-        break;
-      }
-    }
-  }
+  /* a cached block that does not cover the range is the end of the stream */
+  if (helper_find_block (helper, first))
+    return NULL;
 
   buffer = NULL;
-  /* some typefinders go in 1 byte steps over 1k of data and request
-   * small buffers. It is really inefficient to pull each time, and pulling
-   * a larger chunk is almost free. Trying to pull a larger chunk at the end
-   * of the file is also not a problem here, we'll just get a truncated buffer
-   * in that case (and we'll have to double-check the size we actually get
-   * anyway, see below) */
-  ret =
-      helper->func (helper->obj, helper->parent, offset, MAX (size, 4096),
-      &buffer);
+  /* Trying to pull a larger chunk at the end of the file is not a problem
+   * here, we'll just get a truncated buffer in that case (and we'll have to
+   * double-check the size we actually get anyway, see below) */
+  ret = helper->func (helper->obj, helper->parent, first * BLOCK_SIZE,
+      (last - first + 1) * BLOCK_SIZE, &buffer);
+  helper->n_pulls++;
 
   if (ret != GST_FLOW_OK)
     goto error;
 
-#if 0
-  caps = GST_BUFFER_CAPS (buffer);
-
-  if (caps && !gst_caps_is_empty (caps) && !gst_caps_is_any (caps)) {
-    GST_DEBUG ("buffer has caps %" GST_PTR_FORMAT ", suggest max probability",
-        caps);
-
-    gst_caps_replace (&helper->caps, caps);
-    helper->best_probability = GST_TYPE_FIND_MAXIMUM;
-
-    gst_buffer_unref (buffer);
-    return NULL;
-  }
-#endif
-
   /* getrange might silently return shortened buffers at the end of a file,
    * we must, however, always return either the full requested data or %NULL */
   buf_offset = GST_BUFFER_OFFSET (buffer);
   buf_size = gst_buffer_get_size (buffer);
 
-  if ((buf_offset != -1 && buf_offset != offset) || buf_size < size) {
-    GST_DEBUG ("dropping short buffer: %" G_GUINT64_FORMAT "-%" G_GUINT64_FORMAT
-        " instead of %" G_GUINT64_FORMAT "-%" G_GUINT64_FORMAT,
-        buf_offset, buf_offset + buf_size - 1, offset, offset + size - 1);
+  if ((buf_offset != -1 && buf_offset != first * BLOCK_SIZE) || buf_size == 0) {
+    GST_DEBUG ("dropping unexpected buffer: %" G_GUINT64_FORMAT "-%"
+        G_GUINT64_FORMAT " instead of %" G_GUINT64_FORMAT "-%" G_GUINT64_FORMAT,
+        buf_offset, buf_offset + buf_size - 1, first * BLOCK_SIZE,
+        (last + 1) * BLOCK_SIZE - 1);
     gst_buffer_unref (buffer);
     return NULL;
   }
@@ -181,18 +205,28 @@ helper_find_peek (gpointer data, gint64 offset, guint size)
     goto map_failed;
 
   bmap->buffer = buffer;
+  bmap->offset = first * BLOCK_SIZE;
+  helper->buffers = g_slist_prepend (helper->buffers, bmap);
 
-  if (insert_pos) {
-    helper->buffers = g_slist_insert_before (helper->buffers, insert_pos, bmap);
-  } else {
-    /* if insert_pos is not set, our offset is bigger than the largest offset
-     * we have so far; since we keep the list sorted with highest offsets
-     * first, we need to prepend the buffer to the list */
-    helper->last_offset = GST_BUFFER_OFFSET (buffer) + buf_size;
-    helper->buffers = g_slist_prepend (helper->buffers, bmap);
+  /* a short buffer at the end of the file still covers its last block */
+  for (block = first; block * BLOCK_SIZE < bmap->offset + bmap->map.size;
+      block++) {
+    if (!helper_find_block (helper, block)) {
+      guint64 *key = g_new (guint64, 1);
+
+      *key = block;
+      g_hash_table_insert (helper->blocks, key, bmap);
+    }
   }
 
-  return bmap->map.data;
+  res = helper_find_lookup (helper, offset, size);
+  if (res == NULL)
+    GST_DEBUG ("short buffer: %" G_GUINT64_FORMAT "-%" G_GUINT64_FORMAT
+        " does not cover %" G_GUINT64_FORMAT "-%" G_GUINT64_FORMAT,
+        bmap->offset, bmap->offset + bmap->map.size - 1, offset,
+        offset + size - 1);
+
+  return res;
 
 error:
   {
@@ -287,9 +321,13 @@ gst_type_find_helper_get_range (GstObject * obj, GstObject * parent,
   g_return_val_if_fail (GST_IS_OBJECT (obj), NULL);
   g_return_val_if_fail (func != NULL, NULL);
 
+  helper.blocks = g_hash_table_new_full (g_int64_hash, g_int64_equal, g_free,
+      NULL);
   helper.buffers = NULL;
+  helper.copies = NULL;
+  helper.n_pulls = 0;
+  helper.n_peeks = 0;
   helper.size = size;
-  helper.last_offset = 0;
   helper.func = func;
   helper.best_probability = GST_TYPE_FIND_NONE;
   helper.caps = NULL;
@@ -366,6 +404,11 @@ gst_type_find_helper_get_range (GstObject * obj, GstObject * parent,
     g_slice_free (GstMappedBuffer, bmap);
   }
   g_slist_free (helper.buffers);
+  g_slist_free_full (helper.copies, g_free);
+  g_hash_table_unref (helper.blocks);
+
+  GST_DEBUG_OBJECT (obj, "%u peeks needed %u upstream pulls", helper.n_peeks,
+      helper.n_pulls);
 
   if (helper.best_probability > 0)
     result = helper.caps;
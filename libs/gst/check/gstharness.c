@@ -132,8 +132,10 @@
 #include "gstharness.h"
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <math.h>
+#include <time.h>
 
 static void gst_harness_stress_free (GstHarnessThread * t);
 
@@ -189,6 +191,14 @@ struct _GstHarnessPrivate
   GMutex priv_mutex;
 
   GPtrArray *stress;
+
+  /* benchmarking, protected by blocking_push_mutex */
+  GstClockTime *bench_push_times;
+  GstClockTime *bench_latencies;
+  volatile gint bench_pushed;
+  guint bench_received;
+  guint bench_n_latencies;
+  GCond bench_cond;
 };
 
 static GstFlowReturn
@@ -201,7 +211,19 @@ gst_harness_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
   g_mutex_lock (&priv->blocking_push_mutex);
   g_atomic_int_inc (&priv->recv_buffers);
 
-  if (priv->drop_buffers)
+  if (priv->bench_push_times) {
+    guint idx = priv->bench_n_latencies;
+
+    /* match outputs to inputs in order */
+    if (idx < (guint) g_atomic_int_get (&priv->bench_pushed)) {
+      priv->bench_latencies[idx] =
+          gst_util_get_timestamp () - priv->bench_push_times[idx];
+      priv->bench_n_latencies++;
+    }
+    priv->bench_received++;
+    g_cond_broadcast (&priv->bench_cond);
+    gst_buffer_unref (buffer);
+  } else if (priv->drop_buffers)
     gst_buffer_unref (buffer);
   else
     g_async_queue_push (priv->buffer_queue, buffer);
@@ -654,6 +676,7 @@ gst_harness_new_empty (void)
   g_mutex_init (&priv->blocking_push_mutex);
   g_cond_init (&priv->blocking_push_cond);
   g_mutex_init (&priv->priv_mutex);
+  g_cond_init (&priv->bench_cond);
 
   priv->stress = g_ptr_array_new_with_free_func (
       (GDestroyNotify) gst_harness_stress_free);
@@ -1067,6 +1090,7 @@ gst_harness_teardown (GstHarness * h)
   g_cond_clear (&priv->blocking_push_cond);
   g_mutex_clear (&priv->blocking_push_mutex);
   g_mutex_clear (&priv->priv_mutex);
+  g_cond_clear (&priv->bench_cond);
 
   g_ptr_array_unref (priv->stress);
 
@@ -2536,6 +2560,264 @@ gst_harness_add_probe (GstHarness * h,
   gst_object_unref (element);
 }
 
+/******************************************************************************/
+/*       BENCHMARK                                                            */
+/******************************************************************************/
+typedef struct
+{
+  GstHarness *h;
+  gsize size;
+  guint n_buffers;
+
+  guint pushed;
+  GstClockTime start;
+  GstClockTime end;
+  guint64 bytes;
+  guint received;
+  GstClockTime *latencies;
+  guint n_latencies;
+} GstHarnessBenchRun;
+
+/* how long to wait for output after the last push */
+#define BENCH_DRAIN_TIMEOUT (G_TIME_SPAN_SECOND)
+
+static void
+gst_harness_bench_run (GstHarnessBenchRun * run)
+{
+  GstHarness *h = run->h;
+  GstHarnessPrivate *priv = h->priv;
+  GstClockTime *push_times;
+  gint64 end_time;
+  guint i;
+
+  push_times = g_new (GstClockTime, run->n_buffers);
+  run->latencies = g_new (GstClockTime, run->n_buffers);
+
+  g_mutex_lock (&priv->blocking_push_mutex);
+  priv->bench_push_times = push_times;
+  priv->bench_latencies = run->latencies;
+  priv->bench_received = 0;
+  priv->bench_n_latencies = 0;
+  g_atomic_int_set (&priv->bench_pushed, 0);
+  g_mutex_unlock (&priv->blocking_push_mutex);
+
+  run->bytes = 0;
+  run->start = gst_util_get_timestamp ();
+  for (i = 0; i < run->n_buffers; i++) {
+    GstBuffer *buf = gst_harness_create_buffer (h, run->size);
+
+    run->bytes += gst_buffer_get_size (buf);
+    push_times[i] = gst_util_get_timestamp ();
+    g_atomic_int_inc (&priv->bench_pushed);
+    if (gst_harness_push (h, buf) != GST_FLOW_OK)
+      break;
+  }
+
+  /* wait for elements that output from another thread */
+  end_time = g_get_monotonic_time () + BENCH_DRAIN_TIMEOUT;
+  g_mutex_lock (&priv->blocking_push_mutex);
+  run->pushed = g_atomic_int_get (&priv->bench_pushed);
+  while (priv->bench_n_latencies < run->pushed) {
+    if (!g_cond_wait_until (&priv->bench_cond, &priv->blocking_push_mutex,
+            end_time))
+      break;
+  }
+  run->end = gst_util_get_timestamp ();
+  run->received = priv->bench_received;
+  run->n_latencies = priv->bench_n_latencies;
+  priv->bench_push_times = NULL;
+  priv->bench_latencies = NULL;
+  g_mutex_unlock (&priv->blocking_push_mutex);
+
+  g_free (push_times);
+}
+
+static gpointer
+gst_harness_bench_thread (gpointer data)
+{
+  gst_harness_bench_run (data);
+  return NULL;
+}
+
+static gint
+gst_harness_bench_compare_time (gconstpointer a, gconstpointer b)
+{
+  GstClockTime ta = *(const GstClockTime *) a, tb = *(const GstClockTime *) b;
+
+  return (ta > tb) - (ta < tb);
+}
+
+static GstStructure *
+gst_harness_bench_result (GstHarnessBenchRun * runs, guint n_runs,
+    GstClockTime cpu_time)
+{
+  GstClockTime start = GST_CLOCK_TIME_NONE, end = 0, duration;
+  GstClockTime *latencies, lat[5] = { 0, };
+  guint64 bytes = 0;
+  guint buffers = 0, received = 0, n_latencies = 0;
+  gdouble secs;
+  guint i;
+
+  for (i = 0; i < n_runs; i++) {
+    start = MIN (start, runs[i].start);
+    end = MAX (end, runs[i].end);
+    bytes += runs[i].bytes;
+    buffers += runs[i].pushed;
+    received += runs[i].received;
+    n_latencies += runs[i].n_latencies;
+  }
+
+  latencies = g_new (GstClockTime, MAX (n_latencies, 1));
+  n_latencies = 0;
+  for (i = 0; i < n_runs; i++) {
+    memcpy (latencies + n_latencies, runs[i].latencies,
+        runs[i].n_latencies * sizeof (GstClockTime));
+    n_latencies += runs[i].n_latencies;
+  }
+
+  if (n_latencies > 0) {
+    const guint pct[5] = { 0, 50, 90, 99, 100 };
+
+    qsort (latencies, n_latencies, sizeof (GstClockTime),
+        gst_harness_bench_compare_time);
+    /* nearest-rank percentiles */
+    for (i = 0; i < 5; i++) {
+      guint rank = (pct[i] * n_latencies + 99) / 100;
+
+      lat[i] = latencies[MAX (rank, 1) - 1];
+    }
+  }
+  g_free (latencies);
+
+  duration = end > start ? end - start : 0;
+  secs = MAX ((gdouble) duration / GST_SECOND, 1e-9);
+
+  return gst_structure_new ("harness-benchmark",
+      "buffers", G_TYPE_UINT, buffers,
+      "received", G_TYPE_UINT, received,
+      "bytes", G_TYPE_UINT64, bytes,
+      "duration", G_TYPE_UINT64, duration,
+      "cpu-time", G_TYPE_UINT64, cpu_time,
+      "buffers-per-second", G_TYPE_DOUBLE, buffers / secs,
+      "bytes-per-second", G_TYPE_DOUBLE, bytes / secs,
+      "latency-min", G_TYPE_UINT64, lat[0],
+      "latency-p50", G_TYPE_UINT64, lat[1],
+      "latency-p90", G_TYPE_UINT64, lat[2],
+      "latency-p99", G_TYPE_UINT64, lat[3],
+      "latency-max", G_TYPE_UINT64, lat[4], NULL);
+}
+
+static GstClockTime
+gst_harness_bench_cpu_time (void)
+{
+  return gst_util_uint64_scale_int (clock (), GST_SECOND, CLOCKS_PER_SEC);
+}
+
+/**
+ * gst_harness_benchmark_push:
+ * @h: a #GstHarness
+ * @size: a #gsize specifying the size of the buffers
+ * @n_buffers: the number of buffers to push
+ *
+ * Pushes @n_buffers buffers of @size bytes, allocated like
+ * gst_harness_create_buffer() does, through the harnessed element and
+ * measures the throughput and the time each buffer took to arrive on the
+ * #GstHarness sinkpad. The output buffers are matched to the input buffers
+ * in order and dropped, so this is most meaningful for elements that
+ * produce one output buffer per input buffer.
+ *
+ * The caps should be set, for example with gst_harness_set_src_caps(),
+ * before calling this. After pushing, this waits up to one second for the
+ * element to output the remaining buffers.
+ *
+ * The returned structure contains the number of "buffers" pushed, the
+ * number of buffers "received", the "bytes" pushed, the wall clock
+ * "duration" and the "cpu-time" used by the process, "buffers-per-second"
+ * and "bytes-per-second", and the "latency-min", "latency-p50",
+ * "latency-p90", "latency-p99" and "latency-max" per-buffer latencies, all
+ * times in nanoseconds.
+ *
+ * Returns: (transfer full): a #GstStructure with the measurements
+ *
+ * Since: 1.10
+ */
+GstStructure *
+gst_harness_benchmark_push (GstHarness * h, gsize size, guint n_buffers)
+{
+  GstHarnessBenchRun run = { 0, };
+  GstStructure *res;
+  GstClockTime cpu_start;
+
+  g_return_val_if_fail (h != NULL, NULL);
+
+  run.h = h;
+  run.size = size;
+  run.n_buffers = n_buffers;
+
+  cpu_start = gst_harness_bench_cpu_time ();
+  gst_harness_bench_run (&run);
+  res = gst_harness_bench_result (&run, 1,
+      gst_harness_bench_cpu_time () - cpu_start);
+  g_free (run.latencies);
+
+  return res;
+}
+
+/**
+ * gst_harness_benchmark_push_parallel:
+ * @harnesses: (array length=n_harnesses): the #GstHarness instances
+ * @n_harnesses: the number of #GstHarness in @harnesses
+ * @size: a #gsize specifying the size of the buffers
+ * @n_buffers: the number of buffers to push into each harness
+ *
+ * Like gst_harness_benchmark_push(), but drives all @harnesses at the same
+ * time, each from its own thread, to measure how the element scales. The
+ * counters in the returned structure are totals, the rates are for all
+ * harnesses together over the wall clock time of the whole run and the
+ * latency percentiles are over the buffers of all harnesses.
+ *
+ * Returns: (transfer full): a #GstStructure with the measurements
+ *
+ * Since: 1.10
+ */
+GstStructure *
+gst_harness_benchmark_push_parallel (GstHarness ** harnesses,
+    guint n_harnesses, gsize size, guint n_buffers)
+{
+  GstHarnessBenchRun *runs;
+  GThread **threads;
+  GstStructure *res;
+  GstClockTime cpu_start;
+  guint i;
+
+  g_return_val_if_fail (harnesses != NULL, NULL);
+  g_return_val_if_fail (n_harnesses > 0, NULL);
+
+  runs = g_new0 (GstHarnessBenchRun, n_harnesses);
+  threads = g_new (GThread *, n_harnesses);
+
+  cpu_start = gst_harness_bench_cpu_time ();
+  for (i = 0; i < n_harnesses; i++) {
+    runs[i].h = harnesses[i];
+    runs[i].size = size;
+    runs[i].n_buffers = n_buffers;
+    threads[i] = g_thread_new ("gst-harness-bench",
+        gst_harness_bench_thread, &runs[i]);
+  }
+  for (i = 0; i < n_harnesses; i++)
+    g_thread_join (threads[i]);
+
+  res = gst_harness_bench_result (runs, n_harnesses,
+      gst_harness_bench_cpu_time () - cpu_start);
+
+  for (i = 0; i < n_harnesses; i++)
+    g_free (runs[i].latencies);
+  g_free (runs);
+  g_free (threads);
+
+  return res;
+}
+
 /******************************************************************************/
 /*       STRESS                                                               */
 /******************************************************************************/
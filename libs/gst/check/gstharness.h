@@ -264,6 +264,17 @@ void          gst_harness_add_probe (GstHarness        * h,
                                      gpointer            user_data,
                                      GDestroyNotify      destroy_data);
 
+/* benchmark */
+
+GstStructure * gst_harness_benchmark_push (GstHarness * h,
+                                           gsize        size,
+                                           guint        n_buffers);
+
+GstStructure * gst_harness_benchmark_push_parallel (GstHarness ** harnesses,
+                                                    guint         n_harnesses,
+                                                    gsize         size,
+                                                    guint         n_buffers);
+
 /* Stress */
 
 guint              gst_harness_stress_thread_stop  (GstHarnessThread * t);
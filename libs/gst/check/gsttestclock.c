@@ -192,13 +192,20 @@ struct _GstClockEntryContext
 {
   GstClockEntry *clock_entry;
   GstClockTimeDiff time_diff;
+  /* orders entries with the same time, the newest one comes first */
+  guint64 seqnum;
+  GSequenceIter *iter;
 };
 
 struct _GstTestClockPrivate
 {
   GstClockTime start_time;
   GstClockTime internal_time;
-  GList *entry_contexts;
+  /* the pending GstClockEntryContexts sorted by time, and a lookup table
+   * from their GstClockEntry */
+  GSequence *entry_contexts;
+  GHashTable *entry_lookup;
+  guint64 entry_seqnum;
   GCond entry_added_cond;
   GCond entry_processed_cond;
 };
@@ -243,11 +250,13 @@ static void gst_test_clock_add_entry (GstTestClock * test_clock,
     GstClockEntry * entry, GstClockTimeDiff * jitter);
 static void gst_test_clock_remove_entry (GstTestClock * test_clock,
     GstClockEntry * entry);
+static GstClockEntryContext *gst_test_clock_first_entry_context (GstTestClock *
+    test_clock);
 static GstClockEntryContext *gst_test_clock_lookup_entry_context (GstTestClock *
     test_clock, GstClockEntry * clock_entry);
 
 static gint gst_clock_entry_context_compare_func (gconstpointer a,
-    gconstpointer b);
+    gconstpointer b, gpointer user_data);
 
 static void
 gst_test_clock_class_init (GstTestClockClass * klass)
@@ -299,6 +308,8 @@ gst_test_clock_init (GstTestClock * test_clock)
 
   priv = GST_TEST_CLOCK_GET_PRIVATE (test_clock);
 
+  priv->entry_contexts = g_sequence_new (NULL);
+  priv->entry_lookup = g_hash_table_new (NULL, NULL);
   g_cond_init (&priv->entry_added_cond);
   g_cond_init (&priv->entry_processed_cond);
 
@@ -328,8 +339,8 @@ gst_test_clock_dispose (GObject * object)
 
   GST_OBJECT_LOCK (test_clock);
 
-  while (priv->entry_contexts != NULL) {
-    GstClockEntryContext *ctx = priv->entry_contexts->data;
+  while (g_sequence_get_length (priv->entry_contexts) > 0) {
+    GstClockEntryContext *ctx = gst_test_clock_first_entry_context (test_clock);
     gst_test_clock_remove_entry (test_clock, ctx->clock_entry);
   }
 
@@ -344,6 +355,8 @@ gst_test_clock_finalize (GObject * object)
   GstTestClock *test_clock = GST_TEST_CLOCK (object);
   GstTestClockPrivate *priv = GST_TEST_CLOCK_GET_PRIVATE (test_clock);
 
+  g_sequence_free (priv->entry_contexts);
+  g_hash_table_unref (priv->entry_lookup);
   g_cond_clear (&priv->entry_added_cond);
   g_cond_clear (&priv->entry_processed_cond);
 
@@ -502,13 +515,10 @@ static gboolean
 gst_test_clock_peek_next_pending_id_unlocked (GstTestClock * test_clock,
     GstClockID * pending_id)
 {
-  GstTestClockPrivate *priv = GST_TEST_CLOCK_GET_PRIVATE (test_clock);
-  GList *imminent_clock_id = g_list_first (priv->entry_contexts);
+  GstClockEntryContext *ctx = gst_test_clock_first_entry_context (test_clock);
   gboolean result = FALSE;
 
-  if (imminent_clock_id != NULL) {
-    GstClockEntryContext *ctx = imminent_clock_id->data;
-
+  if (ctx != NULL) {
     if (pending_id != NULL) {
       *pending_id = gst_clock_id_ref (ctx->clock_entry);
     }
@@ -524,7 +534,7 @@ gst_test_clock_peek_id_count_unlocked (GstTestClock * test_clock)
 {
   GstTestClockPrivate *priv = GST_TEST_CLOCK_GET_PRIVATE (test_clock);
 
-  return g_list_length (priv->entry_contexts);
+  return g_sequence_get_length (priv->entry_contexts);
 }
 
 static void
@@ -543,9 +553,11 @@ gst_test_clock_add_entry (GstTestClock * test_clock,
   ctx = g_slice_new (GstClockEntryContext);
   ctx->clock_entry = GST_CLOCK_ENTRY (gst_clock_id_ref (entry));
   ctx->time_diff = GST_CLOCK_DIFF (now, GST_CLOCK_ENTRY_TIME (entry));
+  ctx->seqnum = priv->entry_seqnum++;
 
-  priv->entry_contexts = g_list_insert_sorted (priv->entry_contexts, ctx,
-      gst_clock_entry_context_compare_func);
+  ctx->iter = g_sequence_insert_sorted (priv->entry_contexts, ctx,
+      gst_clock_entry_context_compare_func, NULL);
+  g_hash_table_insert (priv->entry_lookup, entry, ctx);
 
   g_cond_broadcast (&priv->entry_added_cond);
 }
@@ -558,8 +570,9 @@ gst_test_clock_remove_entry (GstTestClock * test_clock, GstClockEntry * entry)
 
   ctx = gst_test_clock_lookup_entry_context (test_clock, entry);
   if (ctx != NULL) {
+    g_hash_table_remove (priv->entry_lookup, entry);
+    g_sequence_remove (ctx->iter);
     gst_clock_id_unref (ctx->clock_entry);
-    priv->entry_contexts = g_list_remove (priv->entry_contexts, ctx);
     g_slice_free (GstClockEntryContext, ctx);
 
     g_cond_broadcast (&priv->entry_processed_cond);
@@ -571,28 +584,36 @@ gst_test_clock_lookup_entry_context (GstTestClock * test_clock,
     GstClockEntry * clock_entry)
 {
   GstTestClockPrivate *priv = GST_TEST_CLOCK_GET_PRIVATE (test_clock);
-  GstClockEntryContext *result = NULL;
-  GList *cur;
 
-  for (cur = priv->entry_contexts; cur != NULL; cur = cur->next) {
-    GstClockEntryContext *ctx = cur->data;
+  return g_hash_table_lookup (priv->entry_lookup, clock_entry);
+}
 
-    if (ctx->clock_entry == clock_entry) {
-      result = ctx;
-      break;
-    }
-  }
+/* the most imminent pending entry or NULL */
+static GstClockEntryContext *
+gst_test_clock_first_entry_context (GstTestClock * test_clock)
+{
+  GstTestClockPrivate *priv = GST_TEST_CLOCK_GET_PRIVATE (test_clock);
+  GSequenceIter *iter = g_sequence_get_begin_iter (priv->entry_contexts);
 
-  return result;
+  if (g_sequence_iter_is_end (iter))
+    return NULL;
+
+  return g_sequence_get (iter);
 }
 
 static gint
-gst_clock_entry_context_compare_func (gconstpointer a, gconstpointer b)
+gst_clock_entry_context_compare_func (gconstpointer a, gconstpointer b,
+    gpointer user_data)
 {
   const GstClockEntryContext *ctx_a = a;
   const GstClockEntryContext *ctx_b = b;
+  gint res;
+
+  res = gst_clock_id_compare_func (ctx_a->clock_entry, ctx_b->clock_entry);
+  if (res == 0)
+    res = ctx_a->seqnum < ctx_b->seqnum ? 1 : -1;
 
-  return gst_clock_id_compare_func (ctx_a->clock_entry, ctx_b->clock_entry);
+  return res;
 }
 
 static void
@@ -624,15 +645,33 @@ process_entry_context_unlocked (GstTestClock * test_clock,
   }
 }
 
+/* process all entries that are due at the current time, in order */
+static guint
+gst_test_clock_process_due_unlocked (GstTestClock * test_clock)
+{
+  GstTestClockPrivate *priv = GST_TEST_CLOCK_GET_PRIVATE (test_clock);
+  GstClockEntryContext *ctx;
+  guint result = 0;
+
+  while ((ctx = gst_test_clock_first_entry_context (test_clock)) != NULL &&
+      GST_CLOCK_ENTRY_TIME (ctx->clock_entry) <= priv->internal_time) {
+    process_entry_context_unlocked (test_clock, ctx);
+    result++;
+  }
+
+  return result;
+}
+
 static GList *
 gst_test_clock_get_pending_id_list_unlocked (GstTestClock * test_clock)
 {
   GstTestClockPrivate *priv = GST_TEST_CLOCK_GET_PRIVATE (test_clock);
   GQueue queue = G_QUEUE_INIT;
-  GList *cur;
+  GSequenceIter *iter;
 
-  for (cur = priv->entry_contexts; cur != NULL; cur = cur->next) {
-    GstClockEntryContext *ctx = cur->data;
+  for (iter = g_sequence_get_begin_iter (priv->entry_contexts);
+      !g_sequence_iter_is_end (iter); iter = g_sequence_iter_next (iter)) {
+    GstClockEntryContext *ctx = g_sequence_get (iter);
 
     g_queue_push_tail (&queue, gst_clock_id_ref (ctx->clock_entry));
   }
@@ -862,7 +901,7 @@ gst_test_clock_wait_for_next_pending_id (GstTestClock * test_clock,
 
   GST_OBJECT_LOCK (test_clock);
 
-  while (priv->entry_contexts == NULL)
+  while (g_sequence_get_length (priv->entry_contexts) == 0)
     g_cond_wait (&priv->entry_added_cond, GST_OBJECT_GET_LOCK (test_clock));
 
   if (!gst_test_clock_peek_next_pending_id_unlocked (test_clock, pending_id))
@@ -914,8 +953,7 @@ gst_test_clock_process_next_clock_id (GstTestClock * test_clock)
 {
   GstTestClockPrivate *priv;
   GstClockID result = NULL;
-  GstClockEntryContext *ctx = NULL;
-  GList *cur;
+  GstClockEntryContext *ctx;
 
   g_return_val_if_fail (GST_IS_TEST_CLOCK (test_clock), NULL);
 
@@ -923,16 +961,13 @@ gst_test_clock_process_next_clock_id (GstTestClock * test_clock)
 
   GST_OBJECT_LOCK (test_clock);
 
-  for (cur = priv->entry_contexts; cur != NULL && result == NULL;
-      cur = cur->next) {
-    ctx = cur->data;
-
-    if (priv->internal_time >= GST_CLOCK_ENTRY_TIME (ctx->clock_entry))
-      result = gst_clock_id_ref (ctx->clock_entry);
-  }
-
-  if (result != NULL)
+  /* the entries are sorted, only the first one can be due */
+  ctx = gst_test_clock_first_entry_context (test_clock);
+  if (ctx != NULL
+      && priv->internal_time >= GST_CLOCK_ENTRY_TIME (ctx->clock_entry)) {
+    result = gst_clock_id_ref (ctx->clock_entry);
     process_entry_context_unlocked (test_clock, ctx);
+  }
 
   GST_OBJECT_UNLOCK (test_clock);
 
@@ -956,23 +991,18 @@ gst_test_clock_process_next_clock_id (GstTestClock * test_clock)
 GstClockTime
 gst_test_clock_get_next_entry_time (GstTestClock * test_clock)
 {
-  GstTestClockPrivate *priv;
   GstClockTime result = GST_CLOCK_TIME_NONE;
-  GList *imminent_clock_id;
+  GstClockEntryContext *ctx;
 
   g_return_val_if_fail (GST_IS_TEST_CLOCK (test_clock), GST_CLOCK_TIME_NONE);
 
-  priv = GST_TEST_CLOCK_GET_PRIVATE (test_clock);
-
   GST_OBJECT_LOCK (test_clock);
 
-  /* The list of pending clock notifications is sorted by time,
-     so the most imminent one is the first one in the list. */
-  imminent_clock_id = g_list_first (priv->entry_contexts);
-  if (imminent_clock_id != NULL) {
-    GstClockEntryContext *ctx = imminent_clock_id->data;
+  /* The pending clock notifications are sorted by time,
+     so the most imminent one is the first one. */
+  ctx = gst_test_clock_first_entry_context (test_clock);
+  if (ctx != NULL)
     result = GST_CLOCK_ENTRY_TIME (ctx->clock_entry);
-  }
 
   GST_OBJECT_UNLOCK (test_clock);
 
@@ -1006,7 +1036,7 @@ gst_test_clock_wait_for_multiple_pending_ids (GstTestClock * test_clock,
 
   GST_OBJECT_LOCK (test_clock);
 
-  while (g_list_length (priv->entry_contexts) < count)
+  while (g_sequence_get_length (priv->entry_contexts) < count)
     g_cond_wait (&priv->entry_added_cond, GST_OBJECT_GET_LOCK (test_clock));
 
   if (pending_list)
@@ -1123,3 +1153,127 @@ gst_test_clock_crank (GstTestClock * test_clock)
 
   return result;
 }
+
+/**
+ * gst_test_clock_set_time_and_process:
+ * @test_clock: a #GstTestClock
+ * @new_time: a #GstClockTime later than that returned by gst_clock_get_time()
+ *
+ * Sets the time of @test_clock to @new_time like gst_test_clock_set_time()
+ * and releases all clock notifications that are due at @new_time, in the
+ * order of their times. Notifications that are requested from the
+ * callbacks of released asynchronous notifications are also released when
+ * they are due. This is much cheaper than cranking the clock once for every
+ * notification.
+ *
+ * MT safe.
+ *
+ * Returns: the number of released clock notifications.
+ *
+ * Since: 1.10
+ */
+guint
+gst_test_clock_set_time_and_process (GstTestClock * test_clock,
+    GstClockTime new_time)
+{
+  GstTestClockPrivate *priv;
+  guint result;
+
+  g_return_val_if_fail (GST_IS_TEST_CLOCK (test_clock), 0);
+
+  priv = GST_TEST_CLOCK_GET_PRIVATE (test_clock);
+
+  g_assert_cmpuint (new_time, !=, GST_CLOCK_TIME_NONE);
+
+  GST_OBJECT_LOCK (test_clock);
+
+  g_assert_cmpuint (new_time, >=, priv->internal_time);
+
+  priv->internal_time = new_time;
+  result = gst_test_clock_process_due_unlocked (test_clock);
+
+  GST_CAT_DEBUG_OBJECT (GST_CAT_TEST_CLOCK, test_clock,
+      "clock set to %" GST_TIME_FORMAT ", released %u notifications",
+      GST_TIME_ARGS (new_time), result);
+
+  GST_OBJECT_UNLOCK (test_clock);
+
+  return result;
+}
+
+/**
+ * gst_test_clock_fast_forward:
+ * @test_clock: a #GstTestClock
+ * @end_time: the #GstClockTime to stop at, or %GST_CLOCK_TIME_NONE
+ * @idle_timeout: how long to wait in real time for a new clock notification
+ *
+ * Runs @test_clock as fast as possible: the time jumps to the next pending
+ * clock notification and all notifications due at that time are released,
+ * until no notification is requested within @idle_timeout of real time or
+ * the next notification is later than @end_time. In the last case the time
+ * of @test_clock is set to @end_time.
+ *
+ * This can drive simulated time through hours of media in seconds, as
+ * long as the elements request their next notification within
+ * @idle_timeout of being woken up.
+ *
+ * MT safe.
+ *
+ * Returns: the number of released clock notifications.
+ *
+ * Since: 1.10
+ */
+guint
+gst_test_clock_fast_forward (GstTestClock * test_clock, GstClockTime end_time,
+    GstClockTime idle_timeout)
+{
+  GstTestClockPrivate *priv;
+  GstClockEntryContext *ctx;
+  GstClockTime time;
+  guint result = 0;
+
+  g_return_val_if_fail (GST_IS_TEST_CLOCK (test_clock), 0);
+  g_return_val_if_fail (GST_CLOCK_TIME_IS_VALID (idle_timeout), 0);
+
+  priv = GST_TEST_CLOCK_GET_PRIVATE (test_clock);
+
+  GST_OBJECT_LOCK (test_clock);
+
+  while (TRUE) {
+    if ((ctx = gst_test_clock_first_entry_context (test_clock)) == NULL) {
+      gint64 deadline;
+
+      /* give the woken up threads time to request their next notification */
+      deadline = g_get_monotonic_time () + idle_timeout / GST_USECOND;
+      while (ctx == NULL && g_cond_wait_until (&priv->entry_added_cond,
+              GST_OBJECT_GET_LOCK (test_clock), deadline))
+        ctx = gst_test_clock_first_entry_context (test_clock);
+
+      if (ctx == NULL
+          && (ctx = gst_test_clock_first_entry_context (test_clock)) == NULL) {
+        GST_CAT_DEBUG_OBJECT (GST_CAT_TEST_CLOCK, test_clock,
+            "idle at %" GST_TIME_FORMAT, GST_TIME_ARGS (priv->internal_time));
+        break;
+      }
+    }
+
+    time = GST_CLOCK_ENTRY_TIME (ctx->clock_entry);
+    if (GST_CLOCK_TIME_IS_VALID (end_time) && time > end_time) {
+      if (end_time > priv->internal_time)
+        priv->internal_time = end_time;
+      break;
+    }
+
+    if (time > priv->internal_time)
+      priv->internal_time = time;
+    result += gst_test_clock_process_due_unlocked (test_clock);
+  }
+
+  GST_CAT_DEBUG_OBJECT (GST_CAT_TEST_CLOCK, test_clock,
+      "fast forwarded to %" GST_TIME_FORMAT ", released %u notifications",
+      GST_TIME_ARGS (priv->internal_time), result);
+
+  GST_OBJECT_UNLOCK (test_clock);
+
+  return result;
+}
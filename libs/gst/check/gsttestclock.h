@@ -116,6 +116,13 @@ GstClockTime  gst_test_clock_id_list_get_latest_time (const GList * pending_list
 
 gboolean      gst_test_clock_crank (GstTestClock * test_clock);
 
+guint         gst_test_clock_set_time_and_process (GstTestClock * test_clock,
+                                                   GstClockTime   new_time);
+
+guint         gst_test_clock_fast_forward (GstTestClock * test_clock,
+                                           GstClockTime   end_time,
+                                           GstClockTime   idle_timeout);
+
 #ifdef G_DEFINE_AUTOPTR_CLEANUP_FUNC
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(GstTestClock, gst_object_unref)
 #endif
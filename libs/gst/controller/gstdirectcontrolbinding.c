@@ -58,6 +58,8 @@ static gboolean gst_direct_control_binding_get_value_array (GstControlBinding *
 static gboolean gst_direct_control_binding_get_g_value_array (GstControlBinding
     * _self, GstClockTime timestamp, GstClockTime interval, guint n_values,
     GValue * values);
+static GstClockTime gst_direct_control_binding_get_next_change
+    (GstControlBinding * _self, GstClockTime timestamp);
 
 #define _do_init \
   GST_DEBUG_CATEGORY_INIT (GST_CAT_DEFAULT, "gstdirectcontrolbinding", 0, \
@@ -77,8 +79,16 @@ enum
 
 static GParamSpec *properties[PROP_LAST];
 
+/* largest value array converted through a stack buffer */
+#define MAX_STACK_VALUES 1024
+
 /* mapping functions */
 
+/* block variant of GstDirectControlBindingConvertValue, entries that are NAN
+ * in @s leave the matching entry in @d untouched */
+typedef void (*GstDirectControlBindingConvertValues) (GstDirectControlBinding *
+    self, const gdouble * s, gpointer d, guint n);
+
 #define DEFINE_CONVERT(type,Type,TYPE,ROUNDING_OP) \
 static void \
 convert_g_value_to_##type (GstDirectControlBinding *self, gdouble s, GValue *d) \
@@ -114,6 +124,36 @@ abs_convert_value_to_##type (GstDirectControlBinding *self, gdouble s, gpointer
 { \
   g##type *d = (g##type *)d_; \
   *d = (g##type) ROUNDING_OP (s); \
+} \
+\
+static void \
+convert_values_to_##type (GstDirectControlBinding *self, const gdouble *s, gpointer d_, guint n) \
+{ \
+  GParamSpec##Type *pspec = G_PARAM_SPEC_##TYPE (((GstControlBinding *)self)->pspec); \
+  g##type min = pspec->minimum, max = pspec->maximum; \
+  g##type *d = (g##type *)d_; \
+  guint i; \
+  \
+  for (i = 0; i < n; i++) { \
+    gdouble v = s[i]; \
+    \
+    if (isnan (v)) \
+      continue; \
+    v = CLAMP (v, 0.0, 1.0); \
+    d[i] = (g##type) ROUNDING_OP (min * (1-v)) + (g##type) ROUNDING_OP (max * v); \
+  } \
+} \
+\
+static void \
+abs_convert_values_to_##type (GstDirectControlBinding *self, const gdouble *s, gpointer d_, guint n) \
+{ \
+  g##type *d = (g##type *)d_; \
+  guint i; \
+  \
+  for (i = 0; i < n; i++) { \
+    if (!isnan (s[i])) \
+      d[i] = (g##type) ROUNDING_OP (s[i]); \
+  } \
 }
 
 DEFINE_CONVERT (int, Int, INT, rint);
@@ -189,6 +229,8 @@ gst_direct_control_binding_class_init (GstDirectControlBindingClass * klass)
       gst_direct_control_binding_get_value_array;
   control_binding_class->get_g_value_array =
       gst_direct_control_binding_get_g_value_array;
+  control_binding_class->get_next_change =
+      gst_direct_control_binding_get_next_change;
 
   properties[PROP_CS] =
       g_param_spec_object ("control-source", "ControlSource",
@@ -236,10 +278,12 @@ gst_direct_control_binding_constructor (GType type, guint n_construct_params,
     if (self->ABI.abi.want_absolute) { \
         self->convert_g_value = abs_convert_g_value_to_##type; \
         self->convert_value = abs_convert_value_to_##type; \
+        self->ABI.abi.convert_values = abs_convert_values_to_##type; \
     } \
     else { \
         self->convert_g_value = convert_g_value_to_##type; \
         self->convert_value = convert_value_to_##type; \
+        self->ABI.abi.convert_values = convert_values_to_##type; \
     } \
     self->byte_size = sizeof (g##type);
 
@@ -298,6 +342,9 @@ gst_direct_control_binding_set_property (GObject * object, guint prop_id,
   switch (prop_id) {
     case PROP_CS:
       self->cs = g_value_dup_object (value);
+      /* the values of the new control source have to be synced */
+      if (self->cs)
+        gst_control_source_values_changed (self->cs);
       break;
     case PROP_ABSOLUTE:
       self->ABI.abi.want_absolute = g_value_get_boolean (value);
@@ -424,6 +471,7 @@ gst_direct_control_binding_get_value_array (GstControlBinding * _self,
   gdouble *src_val;
   gboolean res = FALSE;
   GstDirectControlBindingConvertValue convert;
+  GstDirectControlBindingConvertValues convert_values;
   gint byte_size;
   guint8 *values = (guint8 *) values_;
 
@@ -434,26 +482,38 @@ gst_direct_control_binding_get_value_array (GstControlBinding * _self,
   g_return_val_if_fail (GST_CONTROL_BINDING_PSPEC (self), FALSE);
 
   convert = self->convert_value;
+  convert_values = self->ABI.abi.convert_values;
   byte_size = self->byte_size;
 
-  src_val = g_new0 (gdouble, n_values);
+  /* this runs once per buffer in elements doing per-sample automation, keep
+   * the usual block sizes off the heap */
+  if (n_values <= MAX_STACK_VALUES)
+    src_val = g_newa (gdouble, n_values);
+  else
+    src_val = g_new (gdouble, n_values);
+
   if ((res = gst_control_source_get_value_array (self->cs, timestamp,
               interval, n_values, src_val))) {
-    for (i = 0; i < n_values; i++) {
-      /* we will only get NAN for sparse control sources, such as triggers */
-      if (!isnan (src_val[i])) {
-        convert (self, src_val[i], (gpointer) values);
-      } else {
-        GST_LOG ("no control value for property %s at index %d", _self->name,
-            i);
+    if (convert_values) {
+      convert_values (self, src_val, values_, n_values);
+    } else {
+      for (i = 0; i < n_values; i++) {
+        /* we will only get NAN for sparse control sources, such as triggers */
+        if (!isnan (src_val[i])) {
+          convert (self, src_val[i], (gpointer) values);
+        } else {
+          GST_LOG ("no control value for property %s at index %d",
+              _self->name, i);
+        }
+        values += byte_size;
       }
-      values += byte_size;
     }
   } else {
     GST_LOG ("failed to get control value for property %s at ts %"
         GST_TIME_FORMAT, _self->name, GST_TIME_ARGS (timestamp));
   }
-  g_free (src_val);
+  if (n_values > MAX_STACK_VALUES)
+    g_free (src_val);
   return res;
 }
 
@@ -499,6 +559,15 @@ gst_direct_control_binding_get_g_value_array (GstControlBinding * _self,
   return res;
 }
 
+static GstClockTime
+gst_direct_control_binding_get_next_change (GstControlBinding * _self,
+    GstClockTime timestamp)
+{
+  GstDirectControlBinding *self = GST_DIRECT_CONTROL_BINDING (_self);
+
+  return gst_control_source_get_next_change (self->cs, timestamp);
+}
+
 /* functions */
 
 /**
@@ -89,6 +89,8 @@ struct _GstDirectControlBinding {
     gpointer _gst_reserved[GST_PADDING];
     struct {
       gboolean want_absolute;
+      /* converts a block of control-values, NULL for types without one */
+      gpointer convert_values;
     } abi;
   } ABI;
 };
@@ -46,161 +46,295 @@
 #define GST_CAT_DEFAULT controller_debug
 GST_DEBUG_CATEGORY_STATIC (GST_CAT_DEFAULT);
 
+struct _GstInterpolationControlSourcePrivate
+{
+  GstInterpolationMode interpolation_mode;
+
+  /* sorted copy of the control points, valid with the cache */
+  GstControlPoint **points;
+  gint n_points, points_size;
+  /* result of the last lookup */
+  gint cursor;
+};
+
 /* helper functions */
 
-static inline gboolean
-_get_nearest_control_points (GstTimedValueControlSource * self,
-    GstClockTime ts, GstControlPoint ** cp1, GstControlPoint ** cp2)
+typedef void (*InterpolateBlockFunc) (GstControlPoint * cp1,
+    GstControlPoint * cp2, gdouble diff, gdouble step, guint n,
+    gdouble * values);
+typedef void (*InterpolateUpdateFunc) (GstTimedValueControlSource * self);
+
+static void _interpolate_linear_block (GstControlPoint * cp1,
+    GstControlPoint * cp2, gdouble diff, gdouble step, guint n,
+    gdouble * values);
+
+/* Copy the control points into a sorted array when they changed. Lookups
+ * then are a binary search instead of a walk of the sequence, and
+ * consecutive control points are next to each other in memory. @update
+ * fills the per control point caches of the interpolation mode. */
+static void
+_interpolate_update_cache (GstTimedValueControlSource * self,
+    InterpolateUpdateFunc update)
 {
+  GstInterpolationControlSourcePrivate *priv =
+      ((GstInterpolationControlSource *) self)->priv;
   GSequenceIter *iter;
+  gint i = 0;
 
-  iter = gst_timed_value_control_source_find_control_point_iter (self, ts);
-  if (iter) {
-    *cp1 = g_sequence_get (iter);
-    iter = g_sequence_iter_next (iter);
-    if (iter && !g_sequence_iter_is_end (iter)) {
-      *cp2 = g_sequence_get (iter);
-    } else {
-      *cp2 = NULL;
-    }
-    return TRUE;
-  }
-  return FALSE;
-}
+  if (G_LIKELY (self->valid_cache))
+    return;
 
-static inline void
-_get_nearest_control_points2 (GstTimedValueControlSource * self,
-    GstClockTime ts, GstControlPoint ** cp1, GstControlPoint ** cp2,
-    GstClockTime * next_ts)
-{
-  GSequenceIter *iter1, *iter2 = NULL;
+  if (self->nvalues > priv->points_size) {
+    priv->points_size = self->nvalues;
+    priv->points = g_renew (GstControlPoint *, priv->points,
+        priv->points_size);
+  }
 
-  *cp1 = *cp2 = NULL;
-  iter1 = gst_timed_value_control_source_find_control_point_iter (self, ts);
-  if (iter1) {
-    *cp1 = g_sequence_get (iter1);
-    iter2 = g_sequence_iter_next (iter1);
-  } else {
-    if (G_LIKELY (self->values)) {
-      /* all values in the control point list come after the given timestamp */
-      iter2 = g_sequence_get_begin_iter (self->values);
-      /* why this? if !cp1 we don't interpolate anyway
-       * if we can eliminate this, we can also use _get_nearest_control_points()
-       * here, is this just to set next_ts? */
-    } else {
-      /* no values */
-      iter2 = NULL;
-    }
+  if (self->values) {
+    for (iter = g_sequence_get_begin_iter (self->values);
+        !g_sequence_iter_is_end (iter); iter = g_sequence_iter_next (iter))
+      priv->points[i++] = g_sequence_get (iter);
   }
+  priv->n_points = i;
+  priv->cursor = 0;
 
-  if (iter2 && !g_sequence_iter_is_end (iter2)) {
-    *cp2 = g_sequence_get (iter2);
-    *next_ts = (*cp2)->timestamp;
+  /* the cubic modes need at least 3 control points, with less they
+   * interpolate linearly */
+  if (update && priv->n_points > 2)
+    update (self);
+
+  self->valid_cache = TRUE;
+}
+
+/* Returns the index of the last control point at or before @ts, or -1 if
+ * there is none. Values are mostly requested in order, so this checks the
+ * result of the previous lookup and its successor before doing a binary
+ * search. */
+static inline gint
+_find_control_point (GstInterpolationControlSourcePrivate * priv,
+    GstClockTime ts)
+{
+  GstControlPoint **points = priv->points;
+  gint n = priv->n_points, idx = priv->cursor, lo, hi;
+
+  if (n == 0 || ts < points[0]->timestamp)
+    return -1;
+
+  if (idx < n && points[idx]->timestamp <= ts) {
+    if (idx + 1 == n || ts < points[idx + 1]->timestamp)
+      return idx;
+    if (idx + 2 == n || ts < points[idx + 2]->timestamp)
+      return idx + 1;
+    lo = idx + 2;
+    hi = n;
   } else {
-    *next_ts = GST_CLOCK_TIME_NONE;
+    lo = 0;
+    hi = MIN (idx, n);
   }
-}
 
+  /* points[lo] is at or before ts, points[hi] after it */
+  while (hi - lo > 1) {
+    gint mid = (lo + hi) / 2;
 
-/*  steps-like (no-)interpolation, default */
-/*  just returns the value for the most recent key-frame */
-static inline gdouble
-_interpolate_none (GstTimedValueControlSource * self, GstControlPoint * cp)
-{
-  return cp->value;
+    if (points[mid]->timestamp <= ts)
+      lo = mid;
+    else
+      hi = mid;
+  }
+  return lo;
 }
 
 static gboolean
-interpolate_none_get (GstTimedValueControlSource * self, GstClockTime timestamp,
-    gdouble * value)
+_interpolate_get (GstTimedValueControlSource * self, GstClockTime timestamp,
+    gdouble * value, InterpolateBlockFunc block, InterpolateUpdateFunc update)
 {
+  GstInterpolationControlSourcePrivate *priv =
+      ((GstInterpolationControlSource *) self)->priv;
   gboolean ret = FALSE;
-  GSequenceIter *iter;
-  GstControlPoint *cp;
+  gint idx;
 
   g_mutex_lock (&self->lock);
 
-  iter =
-      gst_timed_value_control_source_find_control_point_iter (self, timestamp);
-  if (iter) {
-    cp = g_sequence_get (iter);
-    *value = _interpolate_none (self, cp);
+  _interpolate_update_cache (self, update);
+  if (update && priv->n_points <= 2)
+    block = _interpolate_linear_block;
+
+  idx = _find_control_point (priv, timestamp);
+  if (idx >= 0) {
+    GstControlPoint *cp1 = priv->points[idx];
+
+    if (block && idx + 1 < priv->n_points) {
+      block (cp1, priv->points[idx + 1],
+          gst_guint64_to_gdouble (timestamp - cp1->timestamp), 0.0, 1, value);
+    } else {
+      *value = cp1->value;
+    }
+    priv->cursor = idx;
     ret = TRUE;
   }
   g_mutex_unlock (&self->lock);
   return ret;
 }
 
+/* Fills @values segment by segment: for each pair of control points all
+ * the values between them are computed in one go by @block, which is a
+ * simple loop without branches that the compiler can vectorize. A NULL
+ * @block keeps the value of the previous control point. */
 static gboolean
-interpolate_none_get_value_array (GstTimedValueControlSource * self,
+_interpolate_get_value_array (GstTimedValueControlSource * self,
     GstClockTime timestamp, GstClockTime interval, guint n_values,
-    gdouble * values)
+    gdouble * values, InterpolateBlockFunc block, InterpolateUpdateFunc update)
 {
+  GstInterpolationControlSourcePrivate *priv =
+      ((GstInterpolationControlSource *) self)->priv;
   gboolean ret = FALSE;
-  guint i;
   GstClockTime ts = timestamp;
-  GstClockTime next_ts = 0;
-  GstControlPoint *cp1 = NULL, *cp2 = NULL;
+  guint i = 0, j, n;
+  gint idx;
 
   g_mutex_lock (&self->lock);
 
-  for (i = 0; i < n_values; i++) {
-    GST_LOG ("values[%3d] : ts=%" GST_TIME_FORMAT ", next_ts=%" GST_TIME_FORMAT,
-        i, GST_TIME_ARGS (ts), GST_TIME_ARGS (next_ts));
-    if (ts >= next_ts) {
-      _get_nearest_control_points2 (self, ts, &cp1, &cp2, &next_ts);
+  _interpolate_update_cache (self, update);
+  if (update && priv->n_points <= 2)
+    block = _interpolate_linear_block;
+
+  idx = _find_control_point (priv, ts);
+  while (i < n_values) {
+    GstControlPoint *cp1 = NULL, *cp2 = NULL;
+
+    /* number of values before the next control point */
+    n = n_values - i;
+    if (idx + 1 < priv->n_points) {
+      cp2 = priv->points[idx + 1];
+      if (interval)
+        n = MIN (n, (cp2->timestamp - ts - 1) / interval + 1);
     }
-    if (cp1) {
-      *values = _interpolate_none (self, cp1);
+
+    if (idx >= 0) {
+      cp1 = priv->points[idx];
+      if (block && cp2) {
+        block (cp1, cp2, gst_guint64_to_gdouble (ts - cp1->timestamp),
+            gst_guint64_to_gdouble (interval), n, values + i);
+      } else {
+        for (j = 0; j < n; j++)
+          values[i + j] = cp1->value;
+      }
       ret = TRUE;
-      GST_LOG ("values[%3d]=%lf", i, *values);
     } else {
-      *values = NAN;
-      GST_LOG ("values[%3d]=-", i);
+      for (j = 0; j < n; j++)
+        values[i + j] = NAN;
     }
-    ts += interval;
-    values++;
+    GST_LOG ("values[%3u..%3u] : ts=%" GST_TIME_FORMAT ", next_ts=%"
+        GST_TIME_FORMAT, i, i + n - 1, GST_TIME_ARGS (ts),
+        GST_TIME_ARGS (cp2 ? cp2->timestamp : GST_CLOCK_TIME_NONE));
+
+    i += n;
+    ts += n * interval;
+    while (idx + 1 < priv->n_points && priv->points[idx + 1]->timestamp <= ts)
+      idx++;
+  }
+  if (idx >= 0)
+    priv->cursor = idx;
+
+  g_mutex_unlock (&self->lock);
+  return ret;
+}
+
+/* Returns until when the value at @timestamp stays the same. With @steps
+ * the value only changes at control points, otherwise it's also constant
+ * between control points with the same value. The cubic modes (with an
+ * @update function) are only constant outside of the control points. */
+static GstClockTime
+_interpolate_get_next_change (GstTimedValueControlSource * self,
+    GstClockTime timestamp, gboolean steps, InterpolateUpdateFunc update)
+{
+  GstInterpolationControlSourcePrivate *priv =
+      ((GstInterpolationControlSource *) self)->priv;
+  GstControlPoint **points;
+  GstClockTime ret;
+  gint idx, n;
+
+  g_mutex_lock (&self->lock);
+
+  _interpolate_update_cache (self, update);
+  points = priv->points;
+  n = priv->n_points;
+
+  idx = _find_control_point (priv, timestamp);
+  if (idx < 0) {
+    /* no value until the first control point */
+    ret = n > 0 ? points[0]->timestamp : GST_CLOCK_TIME_NONE;
+  } else if (update && n > 2) {
+    ret = idx + 1 < n ? timestamp : GST_CLOCK_TIME_NONE;
+  } else {
+    gint last = idx;
+
+    while (last + 1 < n && points[last + 1]->value == points[last]->value)
+      last++;
+
+    if (last + 1 == n)
+      ret = GST_CLOCK_TIME_NONE;
+    else if (steps)
+      ret = points[last + 1]->timestamp;
+    else if (last == idx)
+      ret = timestamp;
+    else
+      ret = points[last]->timestamp;
   }
   g_mutex_unlock (&self->lock);
+
   return ret;
 }
 
 
+/*  steps-like (no-)interpolation, default */
+/*  just returns the value for the most recent key-frame */
+static gboolean
+interpolate_none_get (GstTimedValueControlSource * self, GstClockTime timestamp,
+    gdouble * value)
+{
+  return _interpolate_get (self, timestamp, value, NULL, NULL);
+}
+
+static gboolean
+interpolate_none_get_value_array (GstTimedValueControlSource * self,
+    GstClockTime timestamp, GstClockTime interval, guint n_values,
+    gdouble * values)
+{
+  return _interpolate_get_value_array (self, timestamp, interval, n_values,
+      values, NULL, NULL);
+}
+
+static GstClockTime
+interpolate_none_get_next_change (GstTimedValueControlSource * self,
+    GstClockTime timestamp)
+{
+  return _interpolate_get_next_change (self, timestamp, TRUE, NULL);
+}
+
+
 
 /*  linear interpolation */
 /*  smoothes inbetween values */
-static inline gdouble
-_interpolate_linear (GstClockTime timestamp1, gdouble value1,
-    GstClockTime timestamp2, gdouble value2, GstClockTime timestamp)
+static void
+_interpolate_linear_block (GstControlPoint * cp1, GstControlPoint * cp2,
+    gdouble diff, gdouble step, guint n, gdouble * values)
 {
-  if (GST_CLOCK_TIME_IS_VALID (timestamp2)) {
-    gdouble slope;
+  gdouble value1 = cp1->value;
+  gdouble slope = (cp2->value - value1) /
+      gst_guint64_to_gdouble (cp2->timestamp - cp1->timestamp);
+  guint i;
 
-    slope =
-        (value2 - value1) / gst_guint64_to_gdouble (timestamp2 - timestamp1);
-    return value1 + (gst_guint64_to_gdouble (timestamp - timestamp1) * slope);
-  } else {
-    return value1;
-  }
+  for (i = 0; i < n; i++)
+    values[i] = value1 + (diff + i * step) * slope;
 }
 
 static gboolean
 interpolate_linear_get (GstTimedValueControlSource * self,
     GstClockTime timestamp, gdouble * value)
 {
-  gboolean ret = FALSE;
-  GstControlPoint *cp1, *cp2;
-
-  g_mutex_lock (&self->lock);
-
-  if (_get_nearest_control_points (self, timestamp, &cp1, &cp2)) {
-    *value = _interpolate_linear (cp1->timestamp, cp1->value,
-        (cp2 ? cp2->timestamp : GST_CLOCK_TIME_NONE),
-        (cp2 ? cp2->value : 0.0), timestamp);
-    ret = TRUE;
-  }
-  g_mutex_unlock (&self->lock);
-  return ret;
+  return _interpolate_get (self, timestamp, value, _interpolate_linear_block,
+      NULL);
 }
 
 static gboolean
@@ -208,35 +342,15 @@ interpolate_linear_get_value_array (GstTimedValueControlSource * self,
     GstClockTime timestamp, GstClockTime interval, guint n_values,
     gdouble * values)
 {
-  gboolean ret = FALSE;
-  guint i;
-  GstClockTime ts = timestamp;
-  GstClockTime next_ts = 0;
-  GstControlPoint *cp1 = NULL, *cp2 = NULL;
-
-  g_mutex_lock (&self->lock);
+  return _interpolate_get_value_array (self, timestamp, interval, n_values,
+      values, _interpolate_linear_block, NULL);
+}
 
-  for (i = 0; i < n_values; i++) {
-    GST_LOG ("values[%3d] : ts=%" GST_TIME_FORMAT ", next_ts=%" GST_TIME_FORMAT,
-        i, GST_TIME_ARGS (ts), GST_TIME_ARGS (next_ts));
-    if (ts >= next_ts) {
-      _get_nearest_control_points2 (self, ts, &cp1, &cp2, &next_ts);
-    }
-    if (cp1) {
-      *values = _interpolate_linear (cp1->timestamp, cp1->value,
-          (cp2 ? cp2->timestamp : GST_CLOCK_TIME_NONE),
-          (cp2 ? cp2->value : 0.0), ts);
-      ret = TRUE;
-      GST_LOG ("values[%3d]=%lf", i, *values);
-    } else {
-      *values = NAN;
-      GST_LOG ("values[%3d]=-", i);
-    }
-    ts += interval;
-    values++;
-  }
-  g_mutex_unlock (&self->lock);
-  return ret;
+static GstClockTime
+interpolate_linear_get_next_change (GstTimedValueControlSource * self,
+    GstClockTime timestamp)
+{
+  return _interpolate_get_next_change (self, timestamp, FALSE, NULL);
 }
 
 
@@ -259,7 +373,10 @@ interpolate_linear_get_value_array (GstTimedValueControlSource * self,
 static void
 _interpolate_cubic_update_cache (GstTimedValueControlSource * self)
 {
-  gint i, n = self->nvalues;
+  GstInterpolationControlSourcePrivate *priv =
+      ((GstInterpolationControlSource *) self)->priv;
+  GstControlPoint **points = priv->points;
+  gint i, n = priv->n_points;
   gdouble *o = g_new0 (gdouble, n);
   gdouble *p = g_new0 (gdouble, n);
   gdouble *q = g_new0 (gdouble, n);
@@ -268,23 +385,17 @@ _interpolate_cubic_update_cache (GstTimedValueControlSource * self)
   gdouble *b = g_new0 (gdouble, n);
   gdouble *z = g_new0 (gdouble, n);
 
-  GSequenceIter *iter;
-  GstControlPoint *cp;
   GstClockTime x, x_next;
   gdouble y_prev, y, y_next;
 
   /* Fill linear system of equations */
-  iter = g_sequence_get_begin_iter (self->values);
-  cp = g_sequence_get (iter);
-  x = cp->timestamp;
-  y = cp->value;
+  x = points[0]->timestamp;
+  y = points[0]->value;
 
   p[0] = 1.0;
 
-  iter = g_sequence_iter_next (iter);
-  cp = g_sequence_get (iter);
-  x_next = cp->timestamp;
-  y_next = cp->value;
+  x_next = points[1]->timestamp;
+  y_next = points[1]->value;
   h[0] = gst_guint64_to_gdouble (x_next - x);
 
   for (i = 1; i < n - 1; i++) {
@@ -292,10 +403,8 @@ _interpolate_cubic_update_cache (GstTimedValueControlSource * self)
     y_prev = y;
     x = x_next;
     y = y_next;
-    iter = g_sequence_iter_next (iter);
-    cp = g_sequence_get (iter);
-    x_next = cp->timestamp;
-    y_next = cp->value;
+    x_next = points[i + 1]->timestamp;
+    y_next = points[i + 1]->value;
 
     h[i] = gst_guint64_to_gdouble (x_next - x);
     o[i] = h[i - 1];
@@ -317,13 +426,9 @@ _interpolate_cubic_update_cache (GstTimedValueControlSource * self)
     z[i] = (b[i] - q[i] * z[i + 1]) / p[i];
 
   /* Save cache next in the GstControlPoint */
-
-  iter = g_sequence_get_begin_iter (self->values);
   for (i = 0; i < n; i++) {
-    cp = g_sequence_get (iter);
-    cp->cache.cubic.h = h[i];
-    cp->cache.cubic.z = z[i];
-    iter = g_sequence_iter_next (iter);
+    points[i]->cache.cubic.h = h[i];
+    points[i]->cache.cubic.z = z[i];
   }
 
   /* Free our temporary arrays */
@@ -335,35 +440,23 @@ _interpolate_cubic_update_cache (GstTimedValueControlSource * self)
   g_free (z);
 }
 
-static inline gdouble
-_interpolate_cubic (GstTimedValueControlSource * self, GstControlPoint * cp1,
-    gdouble value1, GstControlPoint * cp2, gdouble value2,
-    GstClockTime timestamp)
+static void
+_interpolate_cubic_block (GstControlPoint * cp1, GstControlPoint * cp2,
+    gdouble diff, gdouble step, guint n, gdouble * values)
 {
-  if (!self->valid_cache) {
-    _interpolate_cubic_update_cache (self);
-    self->valid_cache = TRUE;
-  }
+  gdouble h = cp1->cache.cubic.h;
+  gdouble z1 = cp1->cache.cubic.z, z2 = cp2->cache.cubic.z;
+  gdouble a = cp2->value / h - h * z2;
+  gdouble b = cp1->value / h - h * z1;
+  guint i;
 
-  if (cp2) {
-    gdouble diff1, diff2;
-    gdouble out;
-
-    diff1 = gst_guint64_to_gdouble (timestamp - cp1->timestamp);
-    diff2 = gst_guint64_to_gdouble (cp2->timestamp - timestamp);
-
-    out =
-        (cp2->cache.cubic.z * diff1 * diff1 * diff1 +
-        cp1->cache.cubic.z * diff2 * diff2 * diff2) / cp1->cache.cubic.h;
-    out +=
-        (value2 / cp1->cache.cubic.h -
-        cp1->cache.cubic.h * cp2->cache.cubic.z) * diff1;
-    out +=
-        (value1 / cp1->cache.cubic.h -
-        cp1->cache.cubic.h * cp1->cache.cubic.z) * diff2;
-    return out;
-  } else {
-    return value1;
+  for (i = 0; i < n; i++) {
+    gdouble diff1 = diff + i * step;
+    gdouble diff2 = h - diff1;
+
+    values[i] = (z2 * diff1 * diff1 * diff1 + z1 * diff2 * diff2 * diff2) / h;
+    values[i] += a * diff1;
+    values[i] += b * diff2;
   }
 }
 
@@ -371,21 +464,8 @@ static gboolean
 interpolate_cubic_get (GstTimedValueControlSource * self,
     GstClockTime timestamp, gdouble * value)
 {
-  gboolean ret = FALSE;
-  GstControlPoint *cp1, *cp2 = NULL;
-
-  if (self->nvalues <= 2)
-    return interpolate_linear_get (self, timestamp, value);
-
-  g_mutex_lock (&self->lock);
-
-  if (_get_nearest_control_points (self, timestamp, &cp1, &cp2)) {
-    *value = _interpolate_cubic (self, cp1, cp1->value, cp2,
-        (cp2 ? cp2->value : 0.0), timestamp);
-    ret = TRUE;
-  }
-  g_mutex_unlock (&self->lock);
-  return ret;
+  return _interpolate_get (self, timestamp, value, _interpolate_cubic_block,
+      _interpolate_cubic_update_cache);
 }
 
 static gboolean
@@ -393,38 +473,16 @@ interpolate_cubic_get_value_array (GstTimedValueControlSource * self,
     GstClockTime timestamp, GstClockTime interval, guint n_values,
     gdouble * values)
 {
-  gboolean ret = FALSE;
-  guint i;
-  GstClockTime ts = timestamp;
-  GstClockTime next_ts = 0;
-  GstControlPoint *cp1 = NULL, *cp2 = NULL;
-
-  if (self->nvalues <= 2)
-    return interpolate_linear_get_value_array (self, timestamp, interval,
-        n_values, values);
-
-  g_mutex_lock (&self->lock);
+  return _interpolate_get_value_array (self, timestamp, interval, n_values,
+      values, _interpolate_cubic_block, _interpolate_cubic_update_cache);
+}
 
-  for (i = 0; i < n_values; i++) {
-    GST_LOG ("values[%3d] : ts=%" GST_TIME_FORMAT ", next_ts=%" GST_TIME_FORMAT,
-        i, GST_TIME_ARGS (ts), GST_TIME_ARGS (next_ts));
-    if (ts >= next_ts) {
-      _get_nearest_control_points2 (self, ts, &cp1, &cp2, &next_ts);
-    }
-    if (cp1) {
-      *values = _interpolate_cubic (self, cp1, cp1->value, cp2,
-          (cp2 ? cp2->value : 0.0), ts);
-      ret = TRUE;
-      GST_LOG ("values[%3d]=%lf", i, *values);
-    } else {
-      *values = NAN;
-      GST_LOG ("values[%3d]=-", i);
-    }
-    ts += interval;
-    values++;
-  }
-  g_mutex_unlock (&self->lock);
-  return ret;
+static GstClockTime
+interpolate_cubic_get_next_change (GstTimedValueControlSource * self,
+    GstClockTime timestamp)
+{
+  return _interpolate_get_next_change (self, timestamp, FALSE,
+      _interpolate_cubic_update_cache);
 }
 
 
@@ -439,29 +497,26 @@ interpolate_cubic_get_value_array (GstTimedValueControlSource * self,
 static void
 _interpolate_cubic_monotonic_update_cache (GstTimedValueControlSource * self)
 {
-  gint i, n = self->nvalues;
+  GstInterpolationControlSourcePrivate *priv =
+      ((GstInterpolationControlSource *) self)->priv;
+  GstControlPoint **points = priv->points;
+  gint i, n = priv->n_points;
   gdouble *dxs = g_new0 (gdouble, n);
   gdouble *dys = g_new0 (gdouble, n);
   gdouble *ms = g_new0 (gdouble, n);
   gdouble *c1s = g_new0 (gdouble, n);
 
-  GSequenceIter *iter;
-  GstControlPoint *cp;
   GstClockTime x, x_next, dx;
   gdouble y, y_next, dy;
 
   /* Get consecutive differences and slopes */
-  iter = g_sequence_get_begin_iter (self->values);
-  cp = g_sequence_get (iter);
-  x_next = cp->timestamp;
-  y_next = cp->value;
+  x_next = points[0]->timestamp;
+  y_next = points[0]->value;
   for (i = 0; i < n - 1; i++) {
     x = x_next;
     y = y_next;
-    iter = g_sequence_iter_next (iter);
-    cp = g_sequence_get (iter);
-    x_next = cp->timestamp;
-    y_next = cp->value;
+    x_next = points[i + 1]->timestamp;
+    y_next = points[i + 1]->value;
 
     dx = gst_guint64_to_gdouble (x_next - x);
     dy = y_next - y;
@@ -488,10 +543,9 @@ _interpolate_cubic_monotonic_update_cache (GstTimedValueControlSource * self)
   c1s[n - 1] = ms[n - 1];
 
   /* Get degree-2 and degree-3 coefficients */
-  iter = g_sequence_get_begin_iter (self->values);
   for (i = 0; i < n - 1; i++) {
     gdouble c1, m, inv_dx, common;
-    cp = g_sequence_get (iter);
+    GstControlPoint *cp = points[i];
 
     c1 = c1s[i];
     m = ms[i];
@@ -501,8 +555,6 @@ _interpolate_cubic_monotonic_update_cache (GstTimedValueControlSource * self)
     cp->cache.cubic_monotonic.c1s = c1;
     cp->cache.cubic_monotonic.c2s = (m - c1 - common) * inv_dx;
     cp->cache.cubic_monotonic.c3s = common * inv_dx * inv_dx;
-
-    iter = g_sequence_iter_next (iter);
   }
 
   /* Free our temporary arrays */
@@ -512,27 +564,24 @@ _interpolate_cubic_monotonic_update_cache (GstTimedValueControlSource * self)
   g_free (c1s);
 }
 
-static inline gdouble
-_interpolate_cubic_monotonic (GstTimedValueControlSource * self,
-    GstControlPoint * cp1, gdouble value1, GstControlPoint * cp2,
-    gdouble value2, GstClockTime timestamp)
+static void
+_interpolate_cubic_monotonic_block (GstControlPoint * cp1,
+    GstControlPoint * cp2, gdouble diff, gdouble step, guint n,
+    gdouble * values)
 {
-  if (!self->valid_cache) {
-    _interpolate_cubic_monotonic_update_cache (self);
-    self->valid_cache = TRUE;
-  }
+  gdouble value1 = cp1->value;
+  gdouble c1 = cp1->cache.cubic_monotonic.c1s;
+  gdouble c2 = cp1->cache.cubic_monotonic.c2s;
+  gdouble c3 = cp1->cache.cubic_monotonic.c3s;
+  guint i;
 
-  if (cp2) {
-    gdouble diff = gst_guint64_to_gdouble (timestamp - cp1->timestamp);
-    gdouble diff2 = diff * diff;
-    gdouble out;
+  for (i = 0; i < n; i++) {
+    gdouble d = diff + i * step;
+    gdouble d2 = d * d;
 
-    out = value1 + cp1->cache.cubic_monotonic.c1s * diff;
-    out += cp1->cache.cubic_monotonic.c2s * diff2;
-    out += cp1->cache.cubic_monotonic.c3s * diff * diff2;
-    return out;
-  } else {
-    return value1;
+    values[i] = value1 + c1 * d;
+    values[i] += c2 * d2;
+    values[i] += c3 * d * d2;
   }
 }
 
@@ -540,21 +589,9 @@ static gboolean
 interpolate_cubic_monotonic_get (GstTimedValueControlSource * self,
     GstClockTime timestamp, gdouble * value)
 {
-  gboolean ret = FALSE;
-  GstControlPoint *cp1, *cp2 = NULL;
-
-  if (self->nvalues <= 2)
-    return interpolate_linear_get (self, timestamp, value);
-
-  g_mutex_lock (&self->lock);
-
-  if (_get_nearest_control_points (self, timestamp, &cp1, &cp2)) {
-    *value = _interpolate_cubic_monotonic (self, cp1, cp1->value, cp2,
-        (cp2 ? cp2->value : 0.0), timestamp);
-    ret = TRUE;
-  }
-  g_mutex_unlock (&self->lock);
-  return ret;
+  return _interpolate_get (self, timestamp, value,
+      _interpolate_cubic_monotonic_block,
+      _interpolate_cubic_monotonic_update_cache);
 }
 
 static gboolean
@@ -562,38 +599,17 @@ interpolate_cubic_monotonic_get_value_array (GstTimedValueControlSource * self,
     GstClockTime timestamp, GstClockTime interval, guint n_values,
     gdouble * values)
 {
-  gboolean ret = FALSE;
-  guint i;
-  GstClockTime ts = timestamp;
-  GstClockTime next_ts = 0;
-  GstControlPoint *cp1 = NULL, *cp2 = NULL;
-
-  if (self->nvalues <= 2)
-    return interpolate_linear_get_value_array (self, timestamp, interval,
-        n_values, values);
-
-  g_mutex_lock (&self->lock);
+  return _interpolate_get_value_array (self, timestamp, interval, n_values,
+      values, _interpolate_cubic_monotonic_block,
+      _interpolate_cubic_monotonic_update_cache);
+}
 
-  for (i = 0; i < n_values; i++) {
-    GST_LOG ("values[%3d] : ts=%" GST_TIME_FORMAT ", next_ts=%" GST_TIME_FORMAT,
-        i, GST_TIME_ARGS (ts), GST_TIME_ARGS (next_ts));
-    if (ts >= next_ts) {
-      _get_nearest_control_points2 (self, ts, &cp1, &cp2, &next_ts);
-    }
-    if (cp1) {
-      *values = _interpolate_cubic_monotonic (self, cp1, cp1->value, cp2,
-          (cp2 ? cp2->value : 0.0), ts);
-      ret = TRUE;
-      GST_LOG ("values[%3d]=%lf", i, *values);
-    } else {
-      *values = NAN;
-      GST_LOG ("values[%3d]=-", i);
-    }
-    ts += interval;
-    values++;
-  }
-  g_mutex_unlock (&self->lock);
-  return ret;
+static GstClockTime
+interpolate_cubic_monotonic_get_next_change (GstTimedValueControlSource * self,
+    GstClockTime timestamp)
+{
+  return _interpolate_get_next_change (self, timestamp, FALSE,
+      _interpolate_cubic_monotonic_update_cache);
 }
 
 
@@ -601,17 +617,23 @@ static struct
 {
   GstControlSourceGetValue get;
   GstControlSourceGetValueArray get_value_array;
+  GstControlSourceGetNextChange get_next_change;
 } interpolation_modes[] = {
   {
   (GstControlSourceGetValue) interpolate_none_get,
-        (GstControlSourceGetValueArray) interpolate_none_get_value_array}, {
+        (GstControlSourceGetValueArray) interpolate_none_get_value_array,
+        (GstControlSourceGetNextChange) interpolate_none_get_next_change}, {
   (GstControlSourceGetValue) interpolate_linear_get,
-        (GstControlSourceGetValueArray) interpolate_linear_get_value_array}, {
+        (GstControlSourceGetValueArray) interpolate_linear_get_value_array,
+        (GstControlSourceGetNextChange) interpolate_linear_get_next_change}, {
   (GstControlSourceGetValue) interpolate_cubic_get,
-        (GstControlSourceGetValueArray) interpolate_cubic_get_value_array}, {
+        (GstControlSourceGetValueArray) interpolate_cubic_get_value_array,
+        (GstControlSourceGetNextChange) interpolate_cubic_get_next_change}, {
     (GstControlSourceGetValue) interpolate_cubic_monotonic_get,
         (GstControlSourceGetValueArray)
-interpolate_cubic_monotonic_get_value_array}};
+        interpolate_cubic_monotonic_get_value_array,
+        (GstControlSourceGetNextChange)
+interpolate_cubic_monotonic_get_next_change}};
 
 static const guint num_interpolation_modes = G_N_ELEMENTS (interpolation_modes);
 
@@ -650,11 +672,6 @@ G_DEFINE_TYPE_WITH_CODE (GstInterpolationControlSource,
     gst_interpolation_control_source, GST_TYPE_TIMED_VALUE_CONTROL_SOURCE,
     _do_init);
 
-struct _GstInterpolationControlSourcePrivate
-{
-  GstInterpolationMode interpolation_mode;
-};
-
 /**
  * gst_interpolation_control_source_new:
  *
@@ -682,6 +699,7 @@ static gboolean
   GST_TIMED_VALUE_CONTROL_SOURCE_LOCK (self);
   csource->get_value = interpolation_modes[mode].get;
   csource->get_value_array = interpolation_modes[mode].get_value_array;
+  csource->get_next_change = interpolation_modes[mode].get_next_change;
 
   gst_timed_value_control_invalidate_cache ((GstTimedValueControlSource *)
       csource);
@@ -737,6 +755,18 @@ gst_interpolation_control_source_get_property (GObject * object, guint prop_id,
   }
 }
 
+static void
+gst_interpolation_control_source_finalize (GObject * object)
+{
+  GstInterpolationControlSource *self =
+      GST_INTERPOLATION_CONTROL_SOURCE (object);
+
+  g_free (self->priv->points);
+
+  G_OBJECT_CLASS (gst_interpolation_control_source_parent_class)->finalize
+      (object);
+}
+
 static void
 gst_interpolation_control_source_class_init (GstInterpolationControlSourceClass
     * klass)
@@ -749,6 +779,7 @@ gst_interpolation_control_source_class_init (GstInterpolationControlSourceClass
 
   gobject_class->set_property = gst_interpolation_control_source_set_property;
   gobject_class->get_property = gst_interpolation_control_source_get_property;
+  gobject_class->finalize = gst_interpolation_control_source_finalize;
 
   g_object_class_install_property (gobject_class, PROP_MODE,
       g_param_spec_enum ("mode", "Mode", "Interpolation mode",
@@ -74,6 +74,66 @@ _calculate_pos (GstClockTime timestamp, GstClockTime timeshift,
   return timestamp % period;
 }
 
+typedef gdouble (*GstLFOGetFunc) (GstLFOControlSource * self, gdouble amp,
+    gdouble off, GstClockTime timeshift, GstClockTime period,
+    gdouble frequency, GstClockTime timestamp);
+typedef void (*GstLFOFillFunc) (GstLFOControlSourcePrivate * priv,
+    gdouble step, guint n_values, gdouble * values);
+
+/* Fills @values with the positions in the period of consecutive
+ * timestamps. A phase accumulator replaces the modulo per value and gives
+ * exactly the same positions as _calculate_pos(). */
+static inline void
+_fill_pos (GstClockTime timestamp, GstClockTime timeshift,
+    GstClockTime period, GstClockTime interval, guint n_values,
+    gdouble * values)
+{
+  GstClockTime pos = _calculate_pos (timestamp, timeshift, period);
+  GstClockTime step = interval % period;
+  guint i;
+
+  for (i = 0; i < n_values; i++) {
+    values[i] = gst_guint64_to_gdouble (pos);
+    pos += step;
+    if (pos >= period)
+      pos -= period;
+  }
+}
+
+static gboolean
+_get_value_array (GstLFOControlSource * self, GstClockTime timestamp,
+    GstClockTime interval, guint n_values, gdouble * values,
+    GstLFOGetFunc get, GstLFOFillFunc fill)
+{
+  GstLFOControlSourcePrivate *priv = self->priv;
+  guint i;
+  GstClockTime ts = timestamp;
+
+  /* with controlled properties the waveform can change for every value */
+  if (gst_object_has_active_control_bindings (GST_OBJECT (self))) {
+    for (i = 0; i < n_values; i++) {
+      gst_object_sync_values (GST_OBJECT (self), ts);
+      g_mutex_lock (&self->lock);
+      *values = get (self, priv->amplitude, priv->offset, priv->timeshift,
+          priv->period, priv->frequency, ts);
+      g_mutex_unlock (&self->lock);
+      ts += interval;
+      values++;
+    }
+    return TRUE;
+  }
+
+  /* otherwise generate the whole block at once */
+  g_mutex_lock (&self->lock);
+  _fill_pos (timestamp, priv->timeshift, priv->period, interval, n_values,
+      values);
+  fill (priv, gst_guint64_to_gdouble (interval % priv->period), n_values,
+      values);
+  g_mutex_unlock (&self->lock);
+
+  return TRUE;
+}
+
 static inline gdouble
 _sine_get (GstLFOControlSource * self, gdouble amp, gdouble off,
     GstClockTime timeshift, GstClockTime period, gdouble frequency,
@@ -90,6 +150,36 @@ _sine_get (GstLFOControlSource * self, gdouble amp, gdouble off,
   return ret;
 }
 
+/* Rotates the previous value instead of calling sin() for every value. The
+ * exact value is computed again at the start of every period, where the
+ * rounded period makes the phase jump, and every 64 values to keep the
+ * rounding errors from adding up. */
+static void
+_sine_fill (GstLFOControlSourcePrivate * priv, gdouble step, guint n_values,
+    gdouble * values)
+{
+  gdouble amp = priv->amplitude, off = priv->offset;
+  gdouble w = 2.0 * M_PI * (priv->frequency / GST_SECOND);
+  gdouble sd = sin (w * step), cd = cos (w * step);
+  gdouble s = 0.0, c = 1.0, pos, prev = 0.0;
+  guint i;
+
+  for (i = 0; i < n_values; i++) {
+    pos = values[i];
+    if ((i & 63) == 0 || pos < prev) {
+      s = sin (w * pos);
+      c = cos (w * pos);
+    } else {
+      gdouble t = s * cd + c * sd;
+
+      c = c * cd - s * sd;
+      s = t;
+    }
+    prev = pos;
+    values[i] = s * amp + off;
+  }
+}
+
 static gboolean
 waveform_sine_get (GstLFOControlSource * self, GstClockTime timestamp,
     gdouble * value)
@@ -109,20 +199,8 @@ waveform_sine_get_value_array (GstLFOControlSource * self,
     GstClockTime timestamp, GstClockTime interval, guint n_values,
     gdouble * values)
 {
-  GstLFOControlSourcePrivate *priv = self->priv;
-  guint i;
-  GstClockTime ts = timestamp;
-
-  for (i = 0; i < n_values; i++) {
-    gst_object_sync_values (GST_OBJECT (self), ts);
-    g_mutex_lock (&self->lock);
-    *values = _sine_get (self, priv->amplitude, priv->offset, priv->timeshift,
-        priv->period, priv->frequency, ts);
-    g_mutex_unlock (&self->lock);
-    ts += interval;
-    values++;
-  }
-  return TRUE;
+  return _get_value_array (self, timestamp, interval, n_values, values,
+      _sine_get, _sine_fill);
 }
 
 
@@ -143,6 +221,18 @@ _square_get (GstLFOControlSource * self, gdouble amp, gdouble off,
   return ret;
 }
 
+static void
+_square_fill (GstLFOControlSourcePrivate * priv, gdouble step, guint n_values,
+    gdouble * values)
+{
+  gdouble amp = priv->amplitude, off = priv->offset;
+  gdouble half = gst_guint64_to_gdouble (priv->period / 2);
+  guint i;
+
+  for (i = 0; i < n_values; i++)
+    values[i] = (values[i] >= half ? amp : -amp) + off;
+}
+
 static gboolean
 waveform_square_get (GstLFOControlSource * self, GstClockTime timestamp,
     gdouble * value)
@@ -162,20 +252,8 @@ waveform_square_get_value_array (GstLFOControlSource * self,
     GstClockTime timestamp, GstClockTime interval, guint n_values,
     gdouble * values)
 {
-  GstLFOControlSourcePrivate *priv = self->priv;
-  guint i;
-  GstClockTime ts = timestamp;
-
-  for (i = 0; i < n_values; i++) {
-    gst_object_sync_values (GST_OBJECT (self), ts);
-    g_mutex_lock (&self->lock);
-    *values = _square_get (self, priv->amplitude, priv->offset, priv->timeshift,
-        priv->period, priv->frequency, ts);
-    g_mutex_unlock (&self->lock);
-    ts += interval;
-    values++;
-  }
-  return TRUE;
+  return _get_value_array (self, timestamp, interval, n_values, values,
+      _square_get, _square_fill);
 }
 
 static inline gdouble
@@ -194,6 +272,19 @@ _saw_get (GstLFOControlSource * self, gdouble amp, gdouble off,
   return ret;
 }
 
+static void
+_saw_fill (GstLFOControlSourcePrivate * priv, gdouble step, guint n_values,
+    gdouble * values)
+{
+  gdouble off = priv->offset;
+  gdouble per = gst_guint64_to_gdouble (priv->period);
+  gdouble slope = (2.0 * priv->amplitude) / per;
+  guint i;
+
+  for (i = 0; i < n_values; i++)
+    values[i] = -((values[i] - per / 2.0) * slope) + off;
+}
+
 static gboolean
 waveform_saw_get (GstLFOControlSource * self, GstClockTime timestamp,
     gdouble * value)
@@ -213,20 +304,8 @@ waveform_saw_get_value_array (GstLFOControlSource * self,
     GstClockTime timestamp, GstClockTime interval, guint n_values,
     gdouble * values)
 {
-  GstLFOControlSourcePrivate *priv = self->priv;
-  guint i;
-  GstClockTime ts = timestamp;
-
-  for (i = 0; i < n_values; i++) {
-    gst_object_sync_values (GST_OBJECT (self), ts);
-    g_mutex_lock (&self->lock);
-    *values = _saw_get (self, priv->amplitude, priv->offset, priv->timeshift,
-        priv->period, priv->frequency, ts);
-    g_mutex_unlock (&self->lock);
-    ts += interval;
-    values++;
-  }
-  return TRUE;
+  return _get_value_array (self, timestamp, interval, n_values, values,
+      _saw_get, _saw_fill);
 }
 
 static inline gdouble
@@ -245,6 +324,19 @@ _rsaw_get (GstLFOControlSource * self, gdouble amp, gdouble off,
   return ret;
 }
 
+static void
+_rsaw_fill (GstLFOControlSourcePrivate * priv, gdouble step, guint n_values,
+    gdouble * values)
+{
+  gdouble off = priv->offset;
+  gdouble per = gst_guint64_to_gdouble (priv->period);
+  gdouble slope = (2.0 * priv->amplitude) / per;
+  guint i;
+
+  for (i = 0; i < n_values; i++)
+    values[i] = (values[i] - per / 2.0) * slope + off;
+}
+
 static gboolean
 waveform_rsaw_get (GstLFOControlSource * self, GstClockTime timestamp,
     gdouble * value)
@@ -264,20 +356,8 @@ waveform_rsaw_get_value_array (GstLFOControlSource * self,
     GstClockTime timestamp, GstClockTime interval, guint n_values,
     gdouble * values)
 {
-  GstLFOControlSourcePrivate *priv = self->priv;
-  guint i;
-  GstClockTime ts = timestamp;
-
-  for (i = 0; i < n_values; i++) {
-    gst_object_sync_values (GST_OBJECT (self), ts);
-    g_mutex_lock (&self->lock);
-    *values = _rsaw_get (self, priv->amplitude, priv->offset, priv->timeshift,
-        priv->period, priv->frequency, ts);
-    g_mutex_unlock (&self->lock);
-    ts += interval;
-    values++;
-  }
-  return TRUE;
+  return _get_value_array (self, timestamp, interval, n_values, values,
+      _rsaw_get, _rsaw_fill);
 }
 
 
@@ -306,6 +386,26 @@ _triangle_get (GstLFOControlSource * self, gdouble amp, gdouble off,
   return ret;
 }
 
+static void
+_triangle_fill (GstLFOControlSourcePrivate * priv, gdouble step,
+    guint n_values, gdouble * values)
+{
+  gdouble off = priv->offset;
+  gdouble per = gst_guint64_to_gdouble (priv->period);
+  gdouble slope = (4.0 * priv->amplitude) / per;
+  guint i;
+
+  for (i = 0; i < n_values; i++) {
+    gdouble pos = values[i];
+
+    /* 1st, 2nd & 3rd or 4th quarter, selects that can be vectorized */
+    gdouble ret = pos <= 0.25 * per ? pos : -(pos - per / 2.0);
+    ret = pos <= 0.75 * per ? ret : -(per - pos);
+
+    values[i] = ret * slope + off;
+  }
+}
+
 static gboolean
 waveform_triangle_get (GstLFOControlSource * self, GstClockTime timestamp,
     gdouble * value)
@@ -325,21 +425,8 @@ waveform_triangle_get_value_array (GstLFOControlSource * self,
     GstClockTime timestamp, GstClockTime interval, guint n_values,
     gdouble * values)
 {
-  GstLFOControlSourcePrivate *priv = self->priv;
-  guint i;
-  GstClockTime ts = timestamp;
-
-  for (i = 0; i < n_values; i++) {
-    gst_object_sync_values (GST_OBJECT (self), ts);
-    g_mutex_lock (&self->lock);
-    *values =
-        _triangle_get (self, priv->amplitude, priv->offset, priv->timeshift,
-        priv->period, priv->frequency, ts);
-    g_mutex_unlock (&self->lock);
-    ts += interval;
-    values++;
-  }
-  return TRUE;
+  return _get_value_array (self, timestamp, interval, n_values, values,
+      _triangle_get, _triangle_fill);
 }
 
 static struct
@@ -108,6 +108,7 @@ gst_timed_value_control_source_reset (GstTimedValueControlSource * self)
 
   csource->get_value = NULL;
   csource->get_value_array = NULL;
+  csource->get_next_change = NULL;
 
   if (self->values) {
     g_sequence_free (self->values);
@@ -185,11 +186,13 @@ gst_timed_value_control_source_set_internal (GstTimedValueControlSource *
 
       /* update control point */
       cp->value = value;
+      self->valid_cache = FALSE;
+      gst_control_source_values_changed ((GstControlSource *) self);
       g_mutex_unlock (&self->lock);
 
       g_signal_emit (self,
           gst_timed_value_control_source_signals[VALUE_CHANGED_SIGNAL], 0, cp);
-      goto done;
+      return;
     }
   } else {
     self->values = g_sequence_new ((GDestroyNotify) gst_control_point_free);
@@ -201,13 +204,14 @@ gst_timed_value_control_source_set_internal (GstTimedValueControlSource *
   g_sequence_insert_sorted (self->values, cp,
       (GCompareDataFunc) gst_control_point_compare, NULL);
   self->nvalues++;
+  /* invalidate while holding the lock, subclasses may cache pointers to the
+   * control points */
+  self->valid_cache = FALSE;
+  gst_control_source_values_changed ((GstControlSource *) self);
   g_mutex_unlock (&self->lock);
 
   g_signal_emit (self,
       gst_timed_value_control_source_signals[VALUE_ADDED_SIGNAL], 0, cp);
-
-done:
-  self->valid_cache = FALSE;
 }
 
 /**
@@ -336,6 +340,7 @@ gst_timed_value_control_source_unset (GstTimedValueControlSource * self,
     g_sequence_remove (iter);
     self->nvalues--;
     self->valid_cache = FALSE;
+    gst_control_source_values_changed ((GstControlSource *) self);
     res = TRUE;
   }
   g_mutex_unlock (&self->lock);
@@ -369,6 +374,7 @@ gst_timed_value_control_source_unset_all (GstTimedValueControlSource * self)
   }
   self->nvalues = 0;
   self->valid_cache = FALSE;
+  gst_control_source_values_changed ((GstControlSource *) self);
 
   g_mutex_unlock (&self->lock);
 }
@@ -430,6 +436,7 @@ gst_timed_value_control_invalidate_cache (GstTimedValueControlSource * self)
 {
   g_return_if_fail (GST_IS_TIMED_VALUE_CONTROL_SOURCE (self));
   self->valid_cache = FALSE;
+  gst_control_source_values_changed ((GstControlSource *) self);
 }
 
 static void
@@ -41,6 +41,12 @@
 #include <net/if.h>
 #include <netinet/in.h>
 #include <string.h>
+#include <time.h>
+#include <sys/stat.h>
+
+#ifdef HAVE_SYS_EVENTFD_H
+#include <sys/mman.h>
+#endif
 
 #ifdef HAVE_GETIFADDRS_AF_LINK
 #include <ifaddrs.h>
@@ -70,6 +76,8 @@ static gchar **ifaces = NULL;
 static gboolean verbose = FALSE;
 static guint64 clock_id = (guint64) - 1;
 static guint8 clock_id_array[8];
+static gint ring_fd = -1;
+static gint ring_event_fd = -1;
 
 static GOptionEntry opt_entries[] = {
   {"interface", 'i', 0, G_OPTION_ARG_STRING_ARRAY, &ifaces,
@@ -78,12 +86,134 @@ static GOptionEntry opt_entries[] = {
       "PTP clock id", NULL},
   {"verbose", 'v', 0, G_OPTION_ARG_NONE, &verbose,
       "Be verbose", NULL},
+  {"ring-fd", 0, G_OPTION_FLAG_HIDDEN, G_OPTION_ARG_INT, &ring_fd,
+      "Shared memory ring to pass received messages through", NULL},
+  {"ring-event-fd", 0, G_OPTION_FLAG_HIDDEN, G_OPTION_ARG_INT,
+        &ring_event_fd,
+      "eventfd to signal new messages in the ring with", NULL},
   {NULL}
 };
 
 static GSocketAddress *event_saddr, *general_saddr;
 static GSocket *socket_event, *socket_general;
 static GIOChannel *stdin_channel, *stdout_channel;
+static gboolean kernel_timestamps = FALSE;
+#ifdef HAVE_PTP_RING
+static PtpRing *ring;
+static guint ring_write_index;
+#endif
+
+/* Receives a datagram on @socket. If kernel timestamps are enabled the
+ * receive time is stored in the first 8 bytes of @buffer and TRUE is
+ * returned in @timestamped */
+static gssize
+receive_message (GSocket * socket, gchar * buffer, gsize size,
+    gboolean * timestamped, GError ** err)
+{
+#ifdef SO_TIMESTAMPNS
+  if (kernel_timestamps) {
+    union
+    {
+      struct cmsghdr align;
+      gchar buf[CMSG_SPACE (sizeof (struct timespec))];
+    } control;
+    struct iovec iov;
+    struct msghdr msg;
+    struct cmsghdr *cmsg;
+    gssize read;
+
+    iov.iov_base = buffer + 8;
+    iov.iov_len = size - 8;
+    memset (&msg, 0, sizeof (msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = &control;
+    msg.msg_controllen = sizeof (control);
+
+    do {
+      read = recvmsg (g_socket_get_fd (socket), &msg, 0);
+    } while (read == -1 && errno == EINTR);
+
+    if (read == -1) {
+      int errsv = errno;
+
+      g_set_error (err, G_IO_ERROR, g_io_error_from_errno (errsv), "%s",
+          g_strerror (errsv));
+      return -1;
+    }
+
+    for (cmsg = CMSG_FIRSTHDR (&msg); cmsg; cmsg = CMSG_NXTHDR (&msg, cmsg)) {
+      if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_TIMESTAMPNS) {
+        struct timespec ts;
+        guint64 ns;
+
+        memcpy (&ts, CMSG_DATA (cmsg), sizeof (ts));
+        ns = ((guint64) ts.tv_sec) * G_GUINT64_CONSTANT (1000000000) +
+            ts.tv_nsec;
+        memcpy (buffer, &ns, 8);
+        *timestamped = TRUE;
+        return read + 8;
+      }
+    }
+
+    /* no timestamp, send the plain message */
+    memmove (buffer, buffer + 8, read);
+    *timestamped = FALSE;
+    return read;
+  }
+#endif
+
+  *timestamped = FALSE;
+  return g_socket_receive (socket, buffer, size, NULL, err);
+}
+
+#ifdef HAVE_PTP_RING
+/* Puts a received message into the next free slot of the ring. Returns
+ * FALSE if the message has to go through stdout instead because it is too
+ * big or the ring is full */
+static gboolean
+write_ring_message (GSocket * socket, const gchar * buffer, gssize size,
+    gboolean timestamped)
+{
+  PtpRingSlot *slot;
+  guint read_index;
+  guint64 kernel_time = 0;
+  guint64 event = 1;
+
+  if (timestamped) {
+    memcpy (&kernel_time, buffer, 8);
+    buffer += 8;
+    size -= 8;
+  }
+
+  if ((gsize) size > sizeof (slot->data))
+    return FALSE;
+
+  /* The clock only ever moves read_index forwards up to our write index, so
+   * a value that claims more than that is garbage and treated as full */
+  read_index = g_atomic_int_get (&ring->read_index);
+  if (ring_write_index - read_index >= PTP_RING_N_SLOTS) {
+    if (verbose)
+      g_message ("Ring full, passing message through stdout");
+    return FALSE;
+  }
+
+  slot = &ring->slots[ring_write_index & (PTP_RING_N_SLOTS - 1)];
+  slot->size = size;
+  slot->type = (socket == socket_event) ? TYPE_EVENT : TYPE_GENERAL;
+  slot->kernel_time = kernel_time;
+  memcpy (slot->data, buffer, size);
+
+  /* Publish the slot, then wake up the clock */
+  ring_write_index++;
+  g_atomic_int_set (&ring->write_index, ring_write_index);
+
+  while (write (ring_event_fd, &event, sizeof (event)) == -1
+      && errno == EINTR);
+
+  return TRUE;
+}
+#endif
 
 static gboolean
 have_socket_data_cb (GSocket * socket, GIOCondition condition,
@@ -95,8 +225,9 @@ have_socket_data_cb (GSocket * socket, GIOCondition condition,
   GError *err = NULL;
   GIOStatus status;
   StdIOHeader header = { 0, };
+  gboolean timestamped;
 
-  read = g_socket_receive (socket, buffer, sizeof (buffer), NULL, &err);
+  read = receive_message (socket, buffer, sizeof (buffer), &timestamped, &err);
   if (read == -1)
     g_error ("Failed to read from socket: %s", err->message);
   g_clear_error (&err);
@@ -105,8 +236,17 @@ have_socket_data_cb (GSocket * socket, GIOCondition condition,
     g_message ("Received %" G_GSSIZE_FORMAT " bytes from %s socket", read,
         (socket == socket_event ? "event" : "general"));
 
+#ifdef HAVE_PTP_RING
+  if (ring && write_ring_message (socket, buffer, read, timestamped))
+    return G_SOURCE_CONTINUE;
+#endif
+
   header.size = read;
-  header.type = (socket == socket_event) ? TYPE_EVENT : TYPE_GENERAL;
+  if (timestamped)
+    header.type = (socket == socket_event) ? TYPE_EVENT_TIMESTAMPED :
+        TYPE_GENERAL_TIMESTAMPED;
+  else
+    header.type = (socket == socket_event) ? TYPE_EVENT : TYPE_GENERAL;
 
   status =
       g_io_channel_write_chars (stdout_channel, (gchar *) & header,
@@ -248,6 +388,20 @@ setup_sockets (void)
   g_object_unref (bind_saddr);
   g_object_unref (bind_addr);
 
+#ifdef SO_TIMESTAMPNS
+  /* Let the kernel timestamp received packets, the time they spend in the
+   * socket and in our pipe to the clock would otherwise be counted as
+   * network delay */
+  kernel_timestamps =
+      g_socket_set_option (socket_event, SOL_SOCKET, SO_TIMESTAMPNS, TRUE,
+      NULL)
+      && g_socket_set_option (socket_general, SOL_SOCKET, SO_TIMESTAMPNS, TRUE,
+      NULL);
+  if (verbose)
+    g_message ("Kernel receive timestamps %s",
+        kernel_timestamps ? "enabled" : "not available");
+#endif
+
   /* Probe all non-loopback interfaces */
   if (!ifaces) {
 #if defined(HAVE_SIOCGIFCONF_SIOCGIFFLAGS_SIOCGIFHWADDR)
@@ -589,6 +743,32 @@ setup_stdio_channels (void)
   g_io_channel_set_buffered (stdout_channel, FALSE);
 }
 
+static void
+setup_ring (void)
+{
+#ifdef HAVE_PTP_RING
+  struct stat st;
+
+  if (ring_fd == -1 || ring_event_fd == -1)
+    return;
+
+  /* Don't access beyond the end of whatever we were passed */
+  if (fstat (ring_fd, &st) == -1 || (gsize) st.st_size < sizeof (PtpRing))
+    g_error ("Invalid ring file descriptor");
+
+  ring = mmap (NULL, sizeof (PtpRing), PROT_READ | PROT_WRITE, MAP_SHARED,
+      ring_fd, 0);
+  if (ring == MAP_FAILED)
+    g_error ("Failed to map ring: %s", g_strerror (errno));
+  close (ring_fd);
+
+  ring_write_index = g_atomic_int_get (&ring->write_index);
+#else
+  if (ring_fd != -1)
+    g_error ("Ring not supported");
+#endif
+}
+
 static void
 write_clock_id (void)
 {
@@ -676,6 +856,7 @@ main (gint argc, gchar ** argv)
   setup_sockets ();
   drop_privileges ();
   setup_stdio_channels ();
+  setup_ring ();
   write_clock_id ();
 
   /* Get running */
@@ -24,18 +24,43 @@
  * #GstNetAddressMeta can be used to store a network address (a #GSocketAddress)
  * in a #GstBuffer so that it network elements can track the to and from address
  * of the buffer.
+ *
+ * Elements receiving many packets can store the native socket address with
+ * gst_buffer_add_net_address_meta_from_native() instead. The #GSocketAddress
+ * is then only created when gst_net_address_meta_get_address() is called, and
+ * gst_net_address_meta_equal() and gst_net_address_meta_hash() compare the
+ * native addresses without going through GIO.
  */
 
 #include <string.h>
 
+#include <gio/gnetworking.h>
+
 #include "gstnetaddressmeta.h"
 
+/* large enough for a struct sockaddr_storage */
+#define NATIVE_SIZE 128
+
+typedef struct
+{
+  GstNetAddressMeta meta;
+
+  /* the native address, len is 0 when it didn't fit */
+  gsize native_len;
+  union
+  {
+    guint8 data[NATIVE_SIZE];
+    guint64 align;
+  } native;
+} GstNetAddressMetaImpl;
+
 static gboolean
 net_address_meta_init (GstMeta * meta, gpointer params, GstBuffer * buffer)
 {
-  GstNetAddressMeta *nmeta = (GstNetAddressMeta *) meta;
+  GstNetAddressMetaImpl *nmeta = (GstNetAddressMetaImpl *) meta;
 
-  nmeta->addr = NULL;
+  nmeta->meta.addr = NULL;
+  nmeta->native_len = 0;
 
   return TRUE;
 }
@@ -44,14 +69,20 @@ static gboolean
 net_address_meta_transform (GstBuffer * transbuf, GstMeta * meta,
     GstBuffer * buffer, GQuark type, gpointer data)
 {
-  GstNetAddressMeta *smeta, *dmeta;
-  smeta = (GstNetAddressMeta *) meta;
+  GstNetAddressMetaImpl *smeta, *dmeta;
+  smeta = (GstNetAddressMetaImpl *) meta;
 
   /* we always copy no matter what transform */
-  dmeta = gst_buffer_add_net_address_meta (transbuf, smeta->addr);
+  dmeta = (GstNetAddressMetaImpl *) gst_buffer_add_meta (transbuf,
+      GST_NET_ADDRESS_META_INFO, NULL);
   if (!dmeta)
     return FALSE;
 
+  if (smeta->meta.addr)
+    dmeta->meta.addr = g_object_ref (smeta->meta.addr);
+  dmeta->native_len = smeta->native_len;
+  memcpy (dmeta->native.data, smeta->native.data, smeta->native_len);
+
   return TRUE;
 }
 
@@ -86,7 +117,7 @@ gst_net_address_meta_get_info (void)
   if (g_once_init_enter (&meta_info)) {
     const GstMetaInfo *mi = gst_meta_register (GST_NET_ADDRESS_META_API_TYPE,
         "GstNetAddressMeta",
-        sizeof (GstNetAddressMeta),
+        sizeof (GstNetAddressMetaImpl),
         net_address_meta_init,
         net_address_meta_free, net_address_meta_transform);
     g_once_init_leave (&meta_info, mi);
@@ -106,18 +137,211 @@ gst_net_address_meta_get_info (void)
 GstNetAddressMeta *
 gst_buffer_add_net_address_meta (GstBuffer * buffer, GSocketAddress * addr)
 {
-  GstNetAddressMeta *meta;
+  GstNetAddressMetaImpl *meta;
+  gssize len;
 
   g_return_val_if_fail (GST_IS_BUFFER (buffer), NULL);
   g_return_val_if_fail (G_IS_SOCKET_ADDRESS (addr), NULL);
 
   meta =
-      (GstNetAddressMeta *) gst_buffer_add_meta (buffer,
+      (GstNetAddressMetaImpl *) gst_buffer_add_meta (buffer,
       GST_NET_ADDRESS_META_INFO, NULL);
 
-  meta->addr = g_object_ref (addr);
+  meta->meta.addr = g_object_ref (addr);
+
+  /* keep the native address around for comparing */
+  len = g_socket_address_get_native_size (addr);
+  if (len > 0 && len <= NATIVE_SIZE &&
+      g_socket_address_to_native (addr, meta->native.data, len, NULL))
+    meta->native_len = len;
+
+  return (GstNetAddressMeta *) meta;
+}
+
+/**
+ * gst_buffer_add_net_address_meta_from_native:
+ * @buffer: a #GstBuffer
+ * @native: a pointer to a native socket address, like a struct sockaddr
+ * @len: the size of @native
+ *
+ * Attaches a copy of the native socket address @native as metadata in a
+ * #GstNetAddressMeta to @buffer. Unlike gst_buffer_add_net_address_meta()
+ * this doesn't create a #GSocketAddress, the @addr field of the metadata is
+ * %NULL until gst_net_address_meta_get_address() is called.
+ *
+ * Returns: (transfer none): a #GstNetAddressMeta connected to @buffer or
+ *   %NULL when @native is too big.
+ *
+ * Since: 1.10
+ */
+GstNetAddressMeta *
+gst_buffer_add_net_address_meta_from_native (GstBuffer * buffer,
+    gconstpointer native, gsize len)
+{
+  GstNetAddressMetaImpl *meta;
+
+  g_return_val_if_fail (GST_IS_BUFFER (buffer), NULL);
+  g_return_val_if_fail (native != NULL, NULL);
+  g_return_val_if_fail (len > 0 && len <= NATIVE_SIZE, NULL);
+
+  meta =
+      (GstNetAddressMetaImpl *) gst_buffer_add_meta (buffer,
+      GST_NET_ADDRESS_META_INFO, NULL);
+
+  memcpy (meta->native.data, native, len);
+  meta->native_len = len;
+
+  return (GstNetAddressMeta *) meta;
+}
+
+/**
+ * gst_net_address_meta_get_address:
+ * @meta: a #GstNetAddressMeta
+ *
+ * Gets the address stored in @meta, creating the #GSocketAddress from the
+ * native address on first use.
+ *
+ * Returns: (transfer none) (nullable): the #GSocketAddress of @meta or %NULL
+ *   when the native address could not be converted.
+ *
+ * Since: 1.10
+ */
+GSocketAddress *
+gst_net_address_meta_get_address (GstNetAddressMeta * meta)
+{
+  GstNetAddressMetaImpl *impl = (GstNetAddressMetaImpl *) meta;
+  GSocketAddress *addr;
+
+  g_return_val_if_fail (meta != NULL, NULL);
+
+  addr = g_atomic_pointer_get (&meta->addr);
+  if (addr != NULL || impl->native_len == 0)
+    return addr;
+
+  addr = g_socket_address_new_from_native (impl->native.data,
+      impl->native_len);
+  if (addr == NULL)
+    return NULL;
+
+  /* another thread reading the same buffer might have been faster */
+  if (!g_atomic_pointer_compare_and_exchange (&meta->addr, NULL, addr)) {
+    g_object_unref (addr);
+    addr = g_atomic_pointer_get (&meta->addr);
+  }
+
+  return addr;
+}
+
+/**
+ * gst_net_address_meta_equal:
+ * @meta1: a #GstNetAddressMeta
+ * @meta2: another #GstNetAddressMeta
+ *
+ * Checks if @meta1 and @meta2 store the same address and port. This compares
+ * the native addresses and doesn't need to create #GSocketAddress objects.
+ *
+ * Returns: %TRUE when both metadata store the same address.
+ *
+ * Since: 1.10
+ */
+gboolean
+gst_net_address_meta_equal (GstNetAddressMeta * meta1,
+    GstNetAddressMeta * meta2)
+{
+  GstNetAddressMetaImpl *m1 = (GstNetAddressMetaImpl *) meta1;
+  GstNetAddressMetaImpl *m2 = (GstNetAddressMetaImpl *) meta2;
+  const struct sockaddr *sa1, *sa2;
+
+  g_return_val_if_fail (meta1 != NULL, FALSE);
+  g_return_val_if_fail (meta2 != NULL, FALSE);
+
+  if (m1->native_len == 0 || m2->native_len == 0)
+    return meta1->addr == meta2->addr;
+
+  sa1 = (const struct sockaddr *) m1->native.data;
+  sa2 = (const struct sockaddr *) m2->native.data;
+  if (sa1->sa_family != sa2->sa_family)
+    return FALSE;
+
+  /* the other fields and the padding are not part of the address */
+  switch (sa1->sa_family) {
+    case AF_INET:{
+      const struct sockaddr_in *in1 = (const struct sockaddr_in *) sa1;
+      const struct sockaddr_in *in2 = (const struct sockaddr_in *) sa2;
+
+      return in1->sin_port == in2->sin_port &&
+          in1->sin_addr.s_addr == in2->sin_addr.s_addr;
+    }
+#ifdef AF_INET6
+    case AF_INET6:{
+      const struct sockaddr_in6 *in1 = (const struct sockaddr_in6 *) sa1;
+      const struct sockaddr_in6 *in2 = (const struct sockaddr_in6 *) sa2;
+
+      return in1->sin6_port == in2->sin6_port &&
+          in1->sin6_scope_id == in2->sin6_scope_id &&
+          memcmp (&in1->sin6_addr, &in2->sin6_addr,
+          sizeof (in1->sin6_addr)) == 0;
+    }
+#endif
+    default:
+      return m1->native_len == m2->native_len &&
+          memcmp (m1->native.data, m2->native.data, m1->native_len) == 0;
+  }
+}
+
+/**
+ * gst_net_address_meta_hash:
+ * @meta: a #GstNetAddressMeta
+ *
+ * Gets a hash of the address stored in @meta, for example to demultiplex
+ * packets by their source address in a #GHashTable together with
+ * gst_net_address_meta_equal().
+ *
+ * Returns: a hash value of the address of @meta.
+ *
+ * Since: 1.10
+ */
+guint
+gst_net_address_meta_hash (GstNetAddressMeta * meta)
+{
+  GstNetAddressMetaImpl *impl = (GstNetAddressMetaImpl *) meta;
+  const struct sockaddr *sa;
+  const guint8 *data;
+  gsize i, len;
+  guint hash = 5381;
+
+  g_return_val_if_fail (meta != NULL, 0);
+
+  if (impl->native_len == 0)
+    return g_direct_hash (meta->addr);
+
+  sa = (const struct sockaddr *) impl->native.data;
+  switch (sa->sa_family) {
+    case AF_INET:{
+      const struct sockaddr_in *in = (const struct sockaddr_in *) sa;
+
+      return in->sin_addr.s_addr ^ (in->sin_port << 16);
+    }
+#ifdef AF_INET6
+    case AF_INET6:{
+      const struct sockaddr_in6 *in = (const struct sockaddr_in6 *) sa;
+
+      data = (const guint8 *) &in->sin6_addr;
+      len = sizeof (in->sin6_addr);
+      hash ^= in->sin6_port;
+      break;
+    }
+#endif
+    default:
+      data = impl->native.data;
+      len = impl->native_len;
+      break;
+  }
+
+  for (i = 0; i < len; i++)
+    hash = (hash << 5) + hash + data[i];
 
-  return meta;
+  return hash;
 }
 
 /**
@@ -30,7 +30,9 @@ typedef struct _GstNetAddressMeta GstNetAddressMeta;
 /**
  * GstNetAddressMeta:
  * @meta: the parent type
- * @addr: a #GSocketAddress stored as metadata
+ * @addr: a #GSocketAddress stored as metadata. Can be %NULL for metadata
+ *   added with gst_buffer_add_net_address_meta_from_native(), use
+ *   gst_net_address_meta_get_address() to get it.
  *
  * Buffer metadata for network addresses.
  */
@@ -49,8 +51,17 @@ const GstMetaInfo *gst_net_address_meta_get_info (void);
 
 GstNetAddressMeta * gst_buffer_add_net_address_meta (GstBuffer      *buffer,
                                                      GSocketAddress *addr);
+GstNetAddressMeta * gst_buffer_add_net_address_meta_from_native (GstBuffer * buffer,
+                                                                 gconstpointer native,
+                                                                 gsize len);
 GstNetAddressMeta * gst_buffer_get_net_address_meta (GstBuffer      *buffer);
 
+GSocketAddress *    gst_net_address_meta_get_address (GstNetAddressMeta * meta);
+
+gboolean            gst_net_address_meta_equal       (GstNetAddressMeta * meta1,
+                                                      GstNetAddressMeta * meta2);
+guint               gst_net_address_meta_hash        (GstNetAddressMeta * meta);
+
 G_END_DECLS
 
 #endif /* __GST_NET_ADDRESS_META_H__ */
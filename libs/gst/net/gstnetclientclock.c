@@ -62,8 +62,13 @@
 #include "gstnetclientclock.h"
 
 #include <gio/gio.h>
+#include <gio/gnetworking.h>
 
 #include <string.h>
+#ifdef SO_TIMESTAMPNS
+#include <errno.h>
+#include <time.h>
+#endif
 
 GST_DEBUG_CATEGORY_STATIC (ncc_debug);
 #define GST_CAT_DEFAULT (ncc_debug)
@@ -146,6 +151,8 @@ struct _GstNetClientInternalClock
   gchar *address;
   gint port;
   gboolean is_ntp;
+  /* the kernel gives us the receive time of packets */
+  gboolean kernel_timestamps;
 
   /* Protected by OBJECT_LOCK */
   GList *busses;
@@ -625,6 +632,121 @@ bogus_observation:
   return;
 }
 
+#ifdef SO_TIMESTAMPNS
+/* receive a datagram and move @local back by the time it waited in the
+ * socket, according to the receive timestamp of the kernel */
+static gssize
+gst_net_client_internal_clock_receive_timestamped (GstNetClientInternalClock *
+    self, GSocket * socket, guint8 * buffer, gsize size, GstClockTime * local,
+    GError ** error)
+{
+  union
+  {
+    struct cmsghdr align;
+    gchar buf[CMSG_SPACE (sizeof (struct timespec))];
+  } control;
+  struct iovec iov;
+  struct msghdr msg;
+  struct cmsghdr *cmsg;
+  struct timespec now;
+  gssize ret;
+
+  iov.iov_base = buffer;
+  iov.iov_len = size;
+  memset (&msg, 0, sizeof (msg));
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = &control;
+  msg.msg_controllen = sizeof (control);
+
+  do {
+    ret = recvmsg (g_socket_get_fd (socket), &msg, 0);
+  } while (ret < 0 && errno == EINTR);
+
+  if (ret < 0) {
+    int errsv = errno;
+
+    g_set_error (error, G_IO_ERROR, g_io_error_from_errno (errsv),
+        "Error receiving message: %s", g_strerror (errsv));
+    return -1;
+  }
+
+  if (clock_gettime (CLOCK_REALTIME, &now) < 0)
+    return ret;
+
+  for (cmsg = CMSG_FIRSTHDR (&msg); cmsg; cmsg = CMSG_NXTHDR (&msg, cmsg)) {
+    GstClockTime received, real_now, queued;
+    struct timespec rx;
+
+    if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_TIMESTAMPNS)
+      continue;
+
+    memcpy (&rx, CMSG_DATA (cmsg), sizeof (rx));
+    received = GST_TIMESPEC_TO_TIME (rx);
+    real_now = GST_TIMESPEC_TO_TIME (now);
+
+    if (received <= real_now) {
+      queued = real_now - received;
+      if (queued < GST_SECOND && queued <= *local) {
+        GST_TRACE_OBJECT (self, "packet was queued for %" GST_TIME_FORMAT,
+            GST_TIME_ARGS (queued));
+        *local -= queued;
+      }
+    }
+  }
+
+  return ret;
+}
+#endif
+
+static GstNtpPacket *
+gst_net_client_internal_clock_receive_ntp (GstNetClientInternalClock * self,
+    GSocket * socket, GstClockTime * local, GError ** error)
+{
+#ifdef SO_TIMESTAMPNS
+  if (self->kernel_timestamps) {
+    guint8 buffer[GST_NTP_PACKET_SIZE];
+    gssize ret;
+
+    ret = gst_net_client_internal_clock_receive_timestamped (self, socket,
+        buffer, sizeof (buffer), local, error);
+    if (ret < 0)
+      return NULL;
+    if (ret < GST_NTP_PACKET_SIZE) {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+          "short time packet (%d < %d)", (int) ret, GST_NTP_PACKET_SIZE);
+      return NULL;
+    }
+    return gst_ntp_packet_new (buffer, error);
+  }
+#endif
+  return gst_ntp_packet_receive (socket, NULL, error);
+}
+
+static GstNetTimePacket *
+gst_net_client_internal_clock_receive_net (GstNetClientInternalClock * self,
+    GSocket * socket, GstClockTime * local, GError ** error)
+{
+#ifdef SO_TIMESTAMPNS
+  if (self->kernel_timestamps) {
+    guint8 buffer[GST_NET_TIME_PACKET_SIZE];
+    gssize ret;
+
+    ret = gst_net_client_internal_clock_receive_timestamped (self, socket,
+        buffer, sizeof (buffer), local, error);
+    if (ret < 0)
+      return NULL;
+    if (ret < GST_NET_TIME_PACKET_SIZE) {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+          "short time packet (%d < %d)", (int) ret, GST_NET_TIME_PACKET_SIZE);
+      return NULL;
+    }
+    return gst_net_time_packet_new (buffer);
+  }
+#endif
+  return gst_net_time_packet_receive (socket, NULL, error);
+}
+
 static gpointer
 gst_net_client_internal_clock_thread (gpointer data)
 {
@@ -712,7 +834,8 @@ gst_net_client_internal_clock_thread (gpointer data)
       if (self->is_ntp) {
         GstNtpPacket *packet;
 
-        packet = gst_ntp_packet_receive (socket, NULL, &err);
+        packet = gst_net_client_internal_clock_receive_ntp (self, socket,
+            &new_local, &err);
 
         if (packet != NULL) {
           GST_LOG_OBJECT (self, "got packet back");
@@ -767,7 +890,8 @@ gst_net_client_internal_clock_thread (gpointer data)
       } else {
         GstNetTimePacket *packet;
 
-        packet = gst_net_time_packet_receive (socket, NULL, &err);
+        packet = gst_net_client_internal_clock_receive_net (self, socket,
+            &new_local, &err);
 
         if (packet != NULL) {
           GST_LOG_OBJECT (self, "got packet back");
@@ -864,6 +988,15 @@ gst_net_client_internal_clock_start (GstNetClientInternalClock * self)
 
   g_object_unref (myaddr);
 
+#ifdef SO_TIMESTAMPNS
+  /* so that the receive time does not include scheduling delays of our
+   * thread */
+  self->kernel_timestamps =
+      g_socket_set_option (socket, SOL_SOCKET, SO_TIMESTAMPNS, TRUE, NULL);
+  GST_DEBUG_OBJECT (self, "kernel receive timestamps %s",
+      self->kernel_timestamps ? "enabled" : "not available");
+#endif
+
   self->cancel = g_cancellable_new ();
   self->made_cancel_fd =
       g_cancellable_make_pollfd (self->cancel, &dummy_pollfd);
@@ -31,8 +31,19 @@
  * query the exposed clock over the network for its values.
  *
  * The #GstNetTimeProvider typically wraps the clock used by a #GstPipeline.
+ *
+ * Where the platform supports it, requests are received and answered in
+ * batches and the time of a reply is corrected by how long the request
+ * waited in the kernel. With #GstNetTimeProvider:n-threads, several threads
+ * serve the port, each with its own socket, so that the kernel spreads the
+ * clients over them.
  */
 
+/* for recvmmsg() and sendmmsg() */
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE 1
+#endif
+
 #ifdef HAVE_CONFIG_H
 #include "config.h"
 #endif
@@ -40,11 +51,23 @@
 #include "gstnettimeprovider.h"
 #include "gstnettimepacket.h"
 
+#include <gio/gnetworking.h>
+
+#if defined (HAVE_RECVMMSG) && defined (HAVE_SENDMMSG)
+#include <errno.h>
+#include <string.h>
+#include <time.h>
+#define USE_MMSG 1
+/* number of requests handled per system call */
+#define BATCH_SIZE 64
+#endif
+
 GST_DEBUG_CATEGORY_STATIC (ntp_debug);
 #define GST_CAT_DEFAULT (ntp_debug)
 
 #define DEFAULT_ADDRESS         "0.0.0.0"
 #define DEFAULT_PORT            5637
+#define DEFAULT_N_THREADS       1
 
 #define IS_ACTIVE(self) (g_atomic_int_get (&((self)->priv->active)))
 
@@ -54,24 +77,34 @@ enum
   PROP_PORT,
   PROP_ADDRESS,
   PROP_CLOCK,
-  PROP_ACTIVE
+  PROP_ACTIVE,
+  PROP_N_THREADS
 };
 
 #define GST_NET_TIME_PROVIDER_GET_PRIVATE(obj)  \
    (G_TYPE_INSTANCE_GET_PRIVATE ((obj), GST_TYPE_NET_TIME_PROVIDER, GstNetTimeProviderPrivate))
 
+typedef struct
+{
+  GstNetTimeProvider *self;
+  GSocket *socket;
+  GThread *thread;
+} GstNetTimeProviderWorker;
+
 struct _GstNetTimeProviderPrivate
 {
   gchar *address;
   int port;
+  guint n_threads;
 
-  GThread *thread;
+  /* one socket and thread each */
+  GstNetTimeProviderWorker *workers;
+  guint n_workers;
 
   GstClock *clock;
 
   gboolean active;              /* ATOMIC */
 
-  GSocket *socket;
   GCancellable *cancel;
   gboolean made_cancel_fd;
 };
@@ -130,6 +163,20 @@ gst_net_time_provider_class_init (GstNetTimeProviderClass * klass)
       g_param_spec_boolean ("active", "Active",
           "TRUE if the clock will respond to queries over the network", TRUE,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstNetTimeProvider:n-threads:
+   *
+   * The number of threads serving requests. Each thread has its own socket
+   * bound to the same port with SO_REUSEPORT, so the kernel distributes the
+   * clients over the threads. Where SO_REUSEPORT is not available only one
+   * thread is used.
+   *
+   * Since: 1.10
+   */
+  g_object_class_install_property (gobject_class, PROP_N_THREADS,
+      g_param_spec_uint ("n-threads", "Number of threads",
+          "Number of threads serving requests", 1, 64, DEFAULT_N_THREADS,
+          G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY | G_PARAM_STATIC_STRINGS));
 }
 
 static void
@@ -139,7 +186,8 @@ gst_net_time_provider_init (GstNetTimeProvider * self)
 
   self->priv->port = DEFAULT_PORT;
   self->priv->address = g_strdup (DEFAULT_ADDRESS);
-  self->priv->thread = NULL;
+  self->priv->n_threads = DEFAULT_N_THREADS;
+  self->priv->workers = NULL;
   self->priv->active = TRUE;
 }
 
@@ -148,9 +196,9 @@ gst_net_time_provider_finalize (GObject * object)
 {
   GstNetTimeProvider *self = GST_NET_TIME_PROVIDER (object);
 
-  if (self->priv->thread) {
+  if (self->priv->workers) {
     gst_net_time_provider_stop (self);
-    g_assert (self->priv->thread == NULL);
+    g_assert (self->priv->workers == NULL);
   }
 
   g_free (self->priv->address);
@@ -163,19 +211,132 @@ gst_net_time_provider_finalize (GObject * object)
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
 
+#ifdef USE_MMSG
+/* receive up to BATCH_SIZE requests and answer them with one system call
+ * each. Returns FALSE on receive errors. */
+static gboolean
+gst_net_time_provider_serve_batch (GstNetTimeProvider * self,
+    GSocket * socket)
+{
+  struct mmsghdr msgs[BATCH_SIZE];
+  struct iovec iovs[BATCH_SIZE];
+  struct sockaddr_storage addrs[BATCH_SIZE];
+  guint8 bufs[BATCH_SIZE][GST_NET_TIME_PACKET_SIZE];
+  union
+  {
+    struct cmsghdr align;
+    gchar buf[CMSG_SPACE (sizeof (struct timespec))];
+  } ctrls[BATCH_SIZE];
+  GstClockTime now, real_now;
+  struct timespec ts;
+  int fd, i, n, n_replies, sent;
+
+  memset (msgs, 0, sizeof (msgs));
+  for (i = 0; i < BATCH_SIZE; i++) {
+    iovs[i].iov_base = bufs[i];
+    iovs[i].iov_len = GST_NET_TIME_PACKET_SIZE;
+    msgs[i].msg_hdr.msg_iov = &iovs[i];
+    msgs[i].msg_hdr.msg_iovlen = 1;
+    msgs[i].msg_hdr.msg_name = &addrs[i];
+    msgs[i].msg_hdr.msg_namelen = sizeof (addrs[i]);
+    msgs[i].msg_hdr.msg_control = &ctrls[i];
+    msgs[i].msg_hdr.msg_controllen = sizeof (ctrls[i]);
+  }
+
+  fd = g_socket_get_fd (socket);
+  n = recvmmsg (fd, msgs, BATCH_SIZE, MSG_DONTWAIT, NULL);
+  if (n < 0) {
+    if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+      return TRUE;
+
+    GST_DEBUG_OBJECT (self, "receive error: %s", g_strerror (errno));
+    return FALSE;
+  }
+
+  if (!IS_ACTIVE (self))
+    return TRUE;
+
+  /* one clock reading for the whole batch */
+  now = gst_clock_get_time (self->priv->clock);
+  clock_gettime (CLOCK_REALTIME, &ts);
+  real_now = GST_TIMESPEC_TO_TIME (ts);
+
+  n_replies = 0;
+  for (i = 0; i < n; i++) {
+    struct msghdr *hdr = &msgs[i].msg_hdr;
+    GstClockTime remote_time = now;
+
+    if (msgs[i].msg_len < GST_NET_TIME_PACKET_SIZE)
+      continue;
+
+#ifdef SCM_TIMESTAMPNS
+    {
+      struct cmsghdr *cmsg;
+
+      for (cmsg = CMSG_FIRSTHDR (hdr); cmsg; cmsg = CMSG_NXTHDR (hdr, cmsg)) {
+        GstClockTime received, queued;
+        struct timespec rx;
+
+        if (cmsg->cmsg_level != SOL_SOCKET
+            || cmsg->cmsg_type != SCM_TIMESTAMPNS)
+          continue;
+
+        memcpy (&rx, CMSG_DATA (cmsg), sizeof (rx));
+        received = GST_TIMESPEC_TO_TIME (rx);
+
+        /* don't count the time the request waited in the socket */
+        if (received <= real_now) {
+          queued = real_now - received;
+          if (queued < GST_SECOND && queued <= now)
+            remote_time = now - queued;
+        }
+      }
+    }
+#endif
+
+    /* answer in place, the local time of the client is kept */
+    GST_WRITE_UINT64_BE (bufs[i] + sizeof (GstClockTime), remote_time);
+
+    msgs[n_replies].msg_hdr = *hdr;
+    msgs[n_replies].msg_hdr.msg_control = NULL;
+    msgs[n_replies].msg_hdr.msg_controllen = 0;
+    msgs[n_replies].msg_hdr.msg_flags = 0;
+    n_replies++;
+  }
+
+  for (sent = 0; sent < n_replies;) {
+    int ret = sendmmsg (fd, msgs + sent, n_replies - sent, 0);
+
+    if (ret < 0 && errno == EINTR)
+      continue;
+    /* ignore errors */
+    if (ret <= 0) {
+      GST_LOG_OBJECT (self, "send error: %s", g_strerror (errno));
+      break;
+    }
+    sent += ret;
+  }
+
+  return TRUE;
+}
+#endif
+
 static gpointer
 gst_net_time_provider_thread (gpointer data)
 {
-  GstNetTimeProvider *self = data;
+  GstNetTimeProviderWorker *worker = data;
+  GstNetTimeProvider *self = worker->self;
   GCancellable *cancel = self->priv->cancel;
-  GSocket *socket = self->priv->socket;
-  GstNetTimePacket *packet;
+  GSocket *socket = worker->socket;
   GError *err = NULL;
 
   GST_INFO_OBJECT (self, "time provider thread is running");
 
   while (TRUE) {
+#ifndef USE_MMSG
+    GstNetTimePacket *packet;
     GSocketAddress *sender_addr = NULL;
+#endif
 
     GST_LOG_OBJECT (self, "waiting on socket");
     if (!g_socket_condition_wait (socket, G_IO_IN, cancel, &err)) {
@@ -191,6 +352,10 @@ gst_net_time_provider_thread (gpointer data)
       continue;
     }
 
+#ifdef USE_MMSG
+    if (!gst_net_time_provider_serve_batch (self, socket))
+      g_usleep (G_USEC_PER_SEC / 10);
+#else
     /* got data in */
     packet = gst_net_time_packet_receive (socket, &sender_addr, &err);
 
@@ -208,9 +373,10 @@ gst_net_time_provider_thread (gpointer data)
 
       /* ignore errors */
       gst_net_time_packet_send (packet, socket, sender_addr, NULL);
-      g_object_unref (sender_addr);
-      g_free (packet);
     }
+    g_object_unref (sender_addr);
+    g_free (packet);
+#endif
   }
 
   g_error_free (err);
@@ -244,6 +410,9 @@ gst_net_time_provider_set_property (GObject * object, guint prop_id,
     case PROP_ACTIVE:
       g_atomic_int_set (&self->priv->active, g_value_get_boolean (value));
       break;
+    case PROP_N_THREADS:
+      self->priv->n_threads = g_value_get_uint (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -269,21 +438,67 @@ gst_net_time_provider_get_property (GObject * object, guint prop_id,
     case PROP_ACTIVE:
       g_value_set_boolean (value, IS_ACTIVE (self));
       break;
+    case PROP_N_THREADS:
+      g_value_set_uint (value, self->priv->n_threads);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
   }
 }
 
+static GSocket *
+gst_net_time_provider_make_socket (GstNetTimeProvider * self,
+    GInetAddress * inet_addr, gint port, gboolean reuse_port, GError ** error)
+{
+  GSocketAddress *socket_addr;
+  GSocket *socket;
+
+  GST_LOG_OBJECT (self, "creating socket");
+  socket = g_socket_new (g_inet_address_get_family (inet_addr),
+      G_SOCKET_TYPE_DATAGRAM, G_SOCKET_PROTOCOL_UDP, error);
+
+  if (!socket)
+    return NULL;
+
+#ifdef SO_REUSEPORT
+  /* let the other workers bind to the same port */
+  if (reuse_port && !g_socket_set_option (socket, SOL_SOCKET, SO_REUSEPORT,
+          TRUE, error))
+    goto error;
+#endif
+
+#if defined (USE_MMSG) && defined (SO_TIMESTAMPNS)
+  /* not fatal, the replies are then just a bit late */
+  if (!g_socket_set_option (socket, SOL_SOCKET, SO_TIMESTAMPNS, TRUE, NULL))
+    GST_WARNING_OBJECT (self, "could not enable receive timestamps");
+#endif
+
+  GST_DEBUG_OBJECT (self, "binding on port %d", port);
+  socket_addr = g_inet_socket_address_new (inet_addr, port);
+  if (!g_socket_bind (socket, socket_addr, TRUE, error)) {
+    g_object_unref (socket_addr);
+    goto error;
+  }
+  g_object_unref (socket_addr);
+
+  return socket;
+
+error:
+  g_object_unref (socket);
+  return NULL;
+}
+
 static gboolean
 gst_net_time_provider_start (GstNetTimeProvider * self, GError ** error)
 {
-  GSocketAddress *socket_addr, *bound_addr;
+  GSocketAddress *bound_addr;
   GInetAddress *inet_addr;
   GPollFD dummy_pollfd;
   GSocket *socket;
   int port;
   gchar *address;
+  guint i, n_workers;
   GError *err = NULL;
 
   if (self->priv->address) {
@@ -298,28 +513,24 @@ gst_net_time_provider_start (GstNetTimeProvider * self, GError ** error)
     inet_addr = g_inet_address_new_any (G_SOCKET_FAMILY_IPV4);
   }
 
-  GST_LOG_OBJECT (self, "creating socket");
-  socket = g_socket_new (g_inet_address_get_family (inet_addr),
-      G_SOCKET_TYPE_DATAGRAM, G_SOCKET_PROTOCOL_UDP, &err);
+  n_workers = self->priv->n_threads;
+#ifndef SO_REUSEPORT
+  if (n_workers > 1) {
+    GST_WARNING_OBJECT (self, "no SO_REUSEPORT, using only one thread");
+    n_workers = 1;
+  }
+#endif
 
+  socket = gst_net_time_provider_make_socket (self, inet_addr,
+      self->priv->port, n_workers > 1, &err);
   if (!socket)
-    goto no_socket;
-
-  GST_DEBUG_OBJECT (self, "binding on port %d", self->priv->port);
-  socket_addr = g_inet_socket_address_new (inet_addr, self->priv->port);
-  if (!g_socket_bind (socket, socket_addr, TRUE, &err)) {
-    g_object_unref (socket_addr);
-    g_object_unref (inet_addr);
     goto bind_error;
-  }
-  g_object_unref (socket_addr);
-  g_object_unref (inet_addr);
 
   bound_addr = g_socket_get_local_address (socket, NULL);
   port = g_inet_socket_address_get_port (G_INET_SOCKET_ADDRESS (bound_addr));
-  inet_addr =
-      g_inet_socket_address_get_address (G_INET_SOCKET_ADDRESS (bound_addr));
-  address = g_inet_address_to_string (inet_addr);
+  address =
+      g_inet_address_to_string (g_inet_socket_address_get_address
+      (G_INET_SOCKET_ADDRESS (bound_addr)));
 
   if (g_strcmp0 (address, self->priv->address)) {
     g_free (self->priv->address);
@@ -338,16 +549,37 @@ gst_net_time_provider_start (GstNetTimeProvider * self, GError ** error)
       self->priv->address, port);
   g_object_unref (bound_addr);
 
-  self->priv->socket = socket;
+  self->priv->workers = g_new0 (GstNetTimeProviderWorker, n_workers);
+  self->priv->workers[0].self = self;
+  self->priv->workers[0].socket = socket;
+  self->priv->n_workers = 1;
+
+  /* the other workers bind to the port the first one got */
+  for (i = 1; i < n_workers; i++) {
+    socket = gst_net_time_provider_make_socket (self, inet_addr, port, TRUE,
+        &err);
+    if (!socket)
+      goto reuse_error;
+
+    self->priv->workers[i].self = self;
+    self->priv->workers[i].socket = socket;
+    self->priv->n_workers++;
+  }
+  g_object_unref (inet_addr);
+
   self->priv->cancel = g_cancellable_new ();
   self->priv->made_cancel_fd =
       g_cancellable_make_pollfd (self->priv->cancel, &dummy_pollfd);
 
-  self->priv->thread = g_thread_try_new ("GstNetTimeProvider",
-      gst_net_time_provider_thread, self, &err);
+  for (i = 0; i < self->priv->n_workers; i++) {
+    GstNetTimeProviderWorker *worker = &self->priv->workers[i];
+
+    worker->thread = g_thread_try_new ("GstNetTimeProvider",
+        gst_net_time_provider_thread, worker, &err);
 
-  if (!self->priv->thread)
-    goto no_thread;
+    if (!worker->thread)
+      goto no_thread;
+  }
 
   return TRUE;
 
@@ -358,28 +590,26 @@ invalid_address:
     g_propagate_error (error, err);
     return FALSE;
   }
-no_socket:
+bind_error:
   {
-    GST_ERROR_OBJECT (self, "could not create socket: %s", err->message);
+    GST_ERROR_OBJECT (self, "bind failed: %s", err->message);
     g_propagate_error (error, err);
     g_object_unref (inet_addr);
     return FALSE;
   }
-bind_error:
+reuse_error:
   {
-    GST_ERROR_OBJECT (self, "bind failed: %s", err->message);
+    GST_ERROR_OBJECT (self, "bind of worker %u failed: %s", i, err->message);
     g_propagate_error (error, err);
-    g_object_unref (socket);
+    g_object_unref (inet_addr);
+    gst_net_time_provider_stop (self);
     return FALSE;
   }
 no_thread:
   {
     GST_ERROR_OBJECT (self, "could not create thread: %s", err->message);
     g_propagate_error (error, err);
-    g_object_unref (self->priv->socket);
-    self->priv->socket = NULL;
-    g_object_unref (self->priv->cancel);
-    self->priv->cancel = NULL;
+    gst_net_time_provider_stop (self);
     return FALSE;
   }
 }
@@ -387,22 +617,32 @@ no_thread:
 static void
 gst_net_time_provider_stop (GstNetTimeProvider * self)
 {
-  g_return_if_fail (self->priv->thread != NULL);
+  guint i;
+
+  g_return_if_fail (self->priv->workers != NULL);
 
   GST_INFO_OBJECT (self, "stopping..");
-  g_cancellable_cancel (self->priv->cancel);
+  if (self->priv->cancel)
+    g_cancellable_cancel (self->priv->cancel);
 
-  g_thread_join (self->priv->thread);
-  self->priv->thread = NULL;
+  for (i = 0; i < self->priv->n_workers; i++) {
+    GstNetTimeProviderWorker *worker = &self->priv->workers[i];
 
-  if (self->priv->made_cancel_fd)
-    g_cancellable_release_fd (self->priv->cancel);
+    if (worker->thread)
+      g_thread_join (worker->thread);
+    g_object_unref (worker->socket);
+  }
+  g_free (self->priv->workers);
+  self->priv->workers = NULL;
+  self->priv->n_workers = 0;
 
-  g_object_unref (self->priv->cancel);
-  self->priv->cancel = NULL;
+  if (self->priv->cancel) {
+    if (self->priv->made_cancel_fd)
+      g_cancellable_release_fd (self->priv->cancel);
 
-  g_object_unref (self->priv->socket);
-  self->priv->socket = NULL;
+    g_object_unref (self->priv->cancel);
+    self->priv->cancel = NULL;
+  }
 
   GST_INFO_OBJECT (self, "stopped");
 }
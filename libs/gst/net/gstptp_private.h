@@ -7,7 +7,12 @@ enum
 {
   TYPE_EVENT,
   TYPE_GENERAL,
-  TYPE_CLOCK_ID
+  TYPE_CLOCK_ID,
+  /* Same as TYPE_EVENT and TYPE_GENERAL, but the message is preceded by
+   * the CLOCK_REALTIME time in nanoseconds (guint64, host byte order) at
+   * which the kernel received it */
+  TYPE_EVENT_TIMESTAMPED,
+  TYPE_GENERAL_TIMESTAMPED
 };
 
 typedef struct
@@ -16,4 +21,46 @@ typedef struct
   guint8 type;
 } StdIOHeader;
 
+/* On Linux the helper can pass received messages through a ring of fixed
+ * size slots in shared memory instead of the stdout pipe, and only signals
+ * new messages with an eventfd. The ring is created by the clock and passed
+ * to the helper as file descriptors via --ring-fd and --ring-event-fd */
+#if defined (HAVE_SYS_EVENTFD_H) && defined (__linux__)
+#include <sys/syscall.h>
+#ifdef __NR_memfd_create
+#define HAVE_PTP_RING 1
+#endif
+#endif
+
+#ifdef HAVE_PTP_RING
+#define PTP_RING_N_SLOTS   64   /* power of two */
+#define PTP_RING_SLOT_SIZE 2048
+
+/* The file descriptors the helper finds the ring and eventfd at */
+#define PTP_RING_HELPER_FD       3
+#define PTP_RING_HELPER_EVENT_FD 4
+
+typedef struct
+{
+  guint16 size;
+  guint8 type;                  /* TYPE_EVENT or TYPE_GENERAL */
+  guint8 padding[5];
+  /* CLOCK_REALTIME receive time in nanoseconds, or 0 if unknown */
+  guint64 kernel_time;
+  guint8 data[PTP_RING_SLOT_SIZE - 16];
+} PtpRingSlot;
+
+typedef struct
+{
+  /* Free running slot counters. write_index is only written by the helper
+   * and read_index only by the clock, each on its own cache line */
+  volatile gint write_index;
+  guint8 padding1[60];
+  volatile gint read_index;
+  guint8 padding2[60];
+
+  PtpRingSlot slots[PTP_RING_N_SLOTS];
+} PtpRing;
+#endif
+
 #endif /* __GST_PTP_PRIVATE_H__ */
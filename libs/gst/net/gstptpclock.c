@@ -65,6 +65,9 @@
 #include <windows.h>
 #endif
 #include <sys/types.h>
+#ifdef HAVE_CLOCK_GETTIME
+#include <time.h>
+#endif
 
 #ifdef HAVE_UNISTD_H
 #include <unistd.h>
@@ -72,6 +75,21 @@
 #include <io.h>
 #endif
 
+#if defined(HAVE_PTP) && !defined(G_OS_WIN32)
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <errno.h>
+#endif
+
+#ifdef HAVE_PTP_RING
+#include <sys/eventfd.h>
+#include <glib-unix.h>
+#ifndef MFD_CLOEXEC
+#define MFD_CLOEXEC 0x0001U
+#endif
+#endif
+
 #include <gst/base/base.h>
 
 GST_DEBUG_CATEGORY_STATIC (ptp_debug);
@@ -123,6 +141,12 @@ GST_DEBUG_CATEGORY_STATIC (ptp_debug);
 /* How many updates should be skipped at maximum when using USE_MEASUREMENT_FILTERING */
 #define MAX_SKIPPED_UPDATES 5
 
+/* Allow processes to use the PTP clock of another process on the same host
+ * through a file mapped into memory, see gst_ptp_init() */
+#if defined(HAVE_PTP) && !defined(G_OS_WIN32)
+#define USE_SHARED_CLOCK 1
+#endif
+
 typedef enum
 {
   PTP_MESSAGE_TYPE_SYNC = 0x0,
@@ -1042,6 +1066,328 @@ send_delay_req (PtpDomainData * domain, PtpPendingSync * sync)
   return TRUE;
 }
 
+#ifdef USE_SHARED_CLOCK
+/* State published for other processes by the process that runs the PTP
+ * helper. All internal times are CLOCK_MONOTONIC, like the ones of our
+ * system clocks, and thus valid in every process on this host. Readers use
+ * the sequence numbers like a seqlock: they are odd while the writer
+ * updates the fields they protect. */
+#define PTP_SHARED_MAGIC (0x47505450)   /* GPTP */
+#define PTP_SHARED_VERSION (1)
+#define PTP_SHARED_POLL_INTERVAL (50)   /* ms */
+
+typedef struct
+{
+  gint seqnum;
+  gint valid;
+  guint64 internal_time, external_time, rate_num, rate_den;
+  guint64 last_ptp_time, last_local_time;
+  guint64 mean_path_delay;
+  guint64 master_clock_identity;
+  guint64 grandmaster_identity;
+  guint32 master_port_number;
+} PtpSharedDomain;
+
+typedef struct
+{
+  guint32 magic;
+  guint32 version;
+  gint seqnum;
+  guint64 clock_identity;
+  guint32 port_number;
+  PtpSharedDomain domains[G_MAXUINT8 + 1];
+} PtpSharedState;
+
+static gint shared_fd = -1;
+static PtpSharedState *shared_state;
+/* TRUE if we run the helper and publish, FALSE if we read the state */
+static gboolean shared_publisher;
+static gint shared_seqnums[G_MAXUINT8 + 1];
+static gboolean shared_publisher_gone;
+
+static gboolean
+ptp_shared_map (void)
+{
+  struct stat st;
+  gpointer mem;
+
+  if (shared_state)
+    return TRUE;
+
+  /* the publisher might not have resized the file yet */
+  if (fstat (shared_fd, &st) < 0
+      || st.st_size < (off_t) sizeof (PtpSharedState))
+    return FALSE;
+
+  mem = mmap (NULL, sizeof (PtpSharedState), PROT_READ | PROT_WRITE,
+      MAP_SHARED, shared_fd, 0);
+  if (mem == MAP_FAILED) {
+    GST_ERROR ("Failed to map shared PTP clock: %s", g_strerror (errno));
+    return FALSE;
+  }
+  shared_state = mem;
+
+  return TRUE;
+}
+
+/* Opens the file of the shared clock. The process that runs the helper
+ * holds a write lock on it, if we can get the lock there's nobody else and
+ * we become the publisher. */
+static gboolean
+ptp_shared_open (const gchar * name)
+{
+  struct flock fl;
+  gchar *path;
+
+  if (g_path_is_absolute (name))
+    path = g_strdup (name);
+  else
+    path = g_build_filename (g_get_user_runtime_dir (), name, NULL);
+
+  shared_fd = open (path, O_RDWR | O_CREAT, 0600);
+  if (shared_fd < 0) {
+    GST_ERROR ("Failed to open shared PTP clock %s: %s", path,
+        g_strerror (errno));
+    g_free (path);
+    return FALSE;
+  }
+  fcntl (shared_fd, F_SETFD, FD_CLOEXEC);
+
+  memset (&fl, 0, sizeof (fl));
+  fl.l_type = F_WRLCK;
+  fl.l_whence = SEEK_SET;
+
+  if (fcntl (shared_fd, F_SETLK, &fl) == 0) {
+    shared_publisher = TRUE;
+    if (ftruncate (shared_fd, sizeof (PtpSharedState)) < 0
+        || !ptp_shared_map ())
+      goto error;
+    g_atomic_int_set ((gint *) & shared_state->magic, 0);
+    memset (((guint8 *) shared_state) + sizeof (guint32), 0,
+        sizeof (PtpSharedState) - sizeof (guint32));
+    shared_state->version = PTP_SHARED_VERSION;
+    g_atomic_int_set ((gint *) & shared_state->magic, PTP_SHARED_MAGIC);
+    GST_DEBUG ("Publishing PTP clock in %s", path);
+  } else if (errno == EACCES || errno == EAGAIN) {
+    shared_publisher = FALSE;
+    memset (shared_seqnums, 0, sizeof (shared_seqnums));
+    shared_publisher_gone = FALSE;
+    /* will be mapped once the publisher has set it up */
+    ptp_shared_map ();
+    GST_DEBUG ("Using PTP clock published in %s", path);
+  } else {
+    goto error;
+  }
+
+  g_free (path);
+  return TRUE;
+
+error:
+  {
+    GST_ERROR ("Failed to set up shared PTP clock %s: %s", path,
+        g_strerror (errno));
+    if (shared_state)
+      munmap (shared_state, sizeof (PtpSharedState));
+    shared_state = NULL;
+    close (shared_fd);
+    shared_fd = -1;
+    g_free (path);
+    return FALSE;
+  }
+}
+
+static void
+ptp_shared_close (void)
+{
+  if (shared_state)
+    munmap (shared_state, sizeof (PtpSharedState));
+  shared_state = NULL;
+  /* also releases the lock */
+  if (shared_fd != -1)
+    close (shared_fd);
+  shared_fd = -1;
+  shared_publisher = FALSE;
+}
+
+static void
+ptp_shared_publish_clock_id (void)
+{
+  if (!shared_publisher || !shared_state)
+    return;
+
+  g_atomic_int_inc (&shared_state->seqnum);
+  shared_state->clock_identity = ptp_clock_id.clock_identity;
+  shared_state->port_number = ptp_clock_id.port_number;
+  g_atomic_int_inc (&shared_state->seqnum);
+}
+
+static void
+ptp_shared_publish_domain (PtpDomainData * domain)
+{
+  PtpSharedDomain *shared;
+  GstClockTime internal_time, external_time, rate_num, rate_den;
+
+  if (!shared_publisher || !shared_state || domain->last_ptp_time == 0)
+    return;
+
+  gst_clock_get_calibration (GST_CLOCK_CAST (domain->domain_clock),
+      &internal_time, &external_time, &rate_num, &rate_den);
+
+  shared = &shared_state->domains[domain->domain];
+  g_atomic_int_inc (&shared->seqnum);
+  shared->internal_time = internal_time;
+  shared->external_time = external_time;
+  shared->rate_num = rate_num;
+  shared->rate_den = rate_den;
+  shared->last_ptp_time = domain->last_ptp_time;
+  shared->last_local_time = domain->last_local_time;
+  shared->mean_path_delay = domain->mean_path_delay;
+  shared->master_clock_identity = domain->master_clock_identity.clock_identity;
+  shared->master_port_number = domain->master_clock_identity.port_number;
+  shared->grandmaster_identity = domain->grandmaster_identity;
+  shared->valid = TRUE;
+  g_atomic_int_inc (&shared->seqnum);
+}
+
+/* Copies the state of the publisher into our domain data, so that
+ * everything else works as if we ran the helper ourselves */
+static gboolean
+ptp_shared_poll_cb (gpointer user_data)
+{
+  guint i;
+
+  if (!ptp_shared_map ()
+      || g_atomic_int_get ((gint *) & shared_state->magic) != PTP_SHARED_MAGIC)
+    return G_SOURCE_CONTINUE;
+
+  if (shared_state->version != PTP_SHARED_VERSION) {
+    GST_ERROR ("Unsupported shared PTP clock version %u",
+        shared_state->version);
+    return G_SOURCE_REMOVE;
+  }
+
+  if (!shared_publisher_gone) {
+    struct flock fl;
+
+    memset (&fl, 0, sizeof (fl));
+    fl.l_type = F_WRLCK;
+    fl.l_whence = SEEK_SET;
+    if (fcntl (shared_fd, F_GETLK, &fl) == 0 && fl.l_type == F_UNLCK) {
+      GST_WARNING ("Publisher of the shared PTP clock is gone, clocks are "
+          "not synchronized anymore");
+      shared_publisher_gone = TRUE;
+    }
+  }
+
+  if (ptp_clock_id.clock_identity == GST_PTP_CLOCK_ID_NONE) {
+    gint seqnum;
+    guint64 clock_identity;
+    guint32 port_number;
+
+    do {
+      seqnum = g_atomic_int_get (&shared_state->seqnum);
+      clock_identity = shared_state->clock_identity;
+      port_number = shared_state->port_number;
+    } while ((seqnum & 1)
+        || seqnum != g_atomic_int_get (&shared_state->seqnum));
+
+    if (seqnum != 0) {
+      g_mutex_lock (&ptp_lock);
+      ptp_clock_id.clock_identity = clock_identity;
+      ptp_clock_id.port_number = port_number;
+      GST_DEBUG ("Got clock id 0x%016" G_GINT64_MODIFIER "x %u",
+          ptp_clock_id.clock_identity, ptp_clock_id.port_number);
+      g_cond_signal (&ptp_cond);
+      g_mutex_unlock (&ptp_lock);
+    }
+  }
+
+  for (i = 0; i <= G_MAXUINT8; i++) {
+    PtpSharedDomain *shared = &shared_state->domains[i];
+    PtpSharedDomain copy;
+    PtpDomainData *domain = NULL;
+    gint seqnum;
+    GList *l;
+
+    seqnum = g_atomic_int_get (&shared->seqnum);
+    if (seqnum == shared_seqnums[i])
+      continue;
+
+    do {
+      seqnum = g_atomic_int_get (&shared->seqnum);
+      memcpy (&copy, shared, sizeof (PtpSharedDomain));
+    } while ((seqnum & 1) || seqnum != g_atomic_int_get (&shared->seqnum));
+    shared_seqnums[i] = seqnum;
+
+    if (!copy.valid)
+      continue;
+
+    for (l = domain_data; l; l = l->next) {
+      PtpDomainData *tmp = l->data;
+
+      if (tmp->domain == i) {
+        domain = tmp;
+        break;
+      }
+    }
+
+    if (!domain) {
+      gchar *clock_name;
+
+      domain = g_new0 (PtpDomainData, 1);
+      domain->domain = i;
+      clock_name = g_strdup_printf ("ptp-clock-%u", domain->domain);
+      domain->domain_clock =
+          g_object_new (GST_TYPE_SYSTEM_CLOCK, "name", clock_name, NULL);
+      g_free (clock_name);
+      g_queue_init (&domain->pending_syncs);
+      domain_data = g_list_prepend (domain_data, domain);
+
+      g_mutex_lock (&domain_clocks_lock);
+      domain_clocks = g_list_prepend (domain_clocks, domain);
+      g_mutex_unlock (&domain_clocks_lock);
+
+      if (g_atomic_int_get (&domain_stats_n_hooks)) {
+        GstStructure *stats =
+            gst_structure_new (GST_PTP_STATISTICS_NEW_DOMAIN_FOUND, "domain",
+            G_TYPE_UINT, domain->domain, "clock", GST_TYPE_CLOCK,
+            domain->domain_clock, NULL);
+        emit_ptp_statistics (domain->domain, stats);
+        gst_structure_free (stats);
+      }
+    }
+
+    gst_clock_set_calibration (GST_CLOCK_CAST (domain->domain_clock),
+        copy.internal_time, copy.external_time, copy.rate_num, copy.rate_den);
+    domain->mean_path_delay = copy.mean_path_delay;
+    domain->master_clock_identity.clock_identity = copy.master_clock_identity;
+    domain->master_clock_identity.port_number = copy.master_port_number;
+    domain->grandmaster_identity = copy.grandmaster_identity;
+    domain->last_local_time = copy.last_local_time;
+    domain->last_ptp_time = copy.last_ptp_time;
+
+    if (g_atomic_int_get (&domain_stats_n_hooks)) {
+      GstStructure *stats = gst_structure_new (GST_PTP_STATISTICS_TIME_UPDATED,
+          "domain", G_TYPE_UINT, domain->domain,
+          "mean-path-delay-avg", GST_TYPE_CLOCK_TIME, domain->mean_path_delay,
+          "local-time", GST_TYPE_CLOCK_TIME, domain->last_local_time,
+          "ptp-time", GST_TYPE_CLOCK_TIME, domain->last_ptp_time,
+          "synced", G_TYPE_BOOLEAN, TRUE,
+          "internal-time", GST_TYPE_CLOCK_TIME, copy.internal_time,
+          "external-time", GST_TYPE_CLOCK_TIME, copy.external_time,
+          "rate-num", G_TYPE_UINT64, copy.rate_num,
+          "rate-den", G_TYPE_UINT64, copy.rate_den,
+          "rate", G_TYPE_DOUBLE, (gdouble) (copy.rate_num) / copy.rate_den,
+          NULL);
+      emit_ptp_statistics (domain->domain, stats);
+      gst_structure_free (stats);
+    }
+  }
+
+  return G_SOURCE_CONTINUE;
+}
+#endif
+
 /* Filtering of outliers for RTT and time calculations inspired
  * by the code from gstnetclientclock.c
  */
@@ -1253,6 +1599,10 @@ update_ptp_time (PtpDomainData * domain, PtpPendingSync * sync)
 #ifdef USE_MEASUREMENT_FILTERING
 out:
 #endif
+#ifdef USE_SHARED_CLOCK
+  ptp_shared_publish_domain (domain);
+#endif
+
   if (g_atomic_int_get (&domain_stats_n_hooks)) {
     GstStructure *stats = gst_structure_new (GST_PTP_STATISTICS_TIME_UPDATED,
         "domain", G_TYPE_UINT, domain->domain,
@@ -1735,6 +2085,156 @@ handle_ptp_message (PtpMessage * msg, GstClockTime receive_time)
   }
 }
 
+/* Handles a message received from the helper. @kernel_time is the
+ * CLOCK_REALTIME time at which the kernel received it, or
+ * GST_CLOCK_TIME_NONE if unknown */
+static void
+handle_received_message (const guint8 * data, gsize size,
+    GstClockTime kernel_time)
+{
+  GstClockTime receive_time = gst_clock_get_time (observation_system_clock);
+  PtpMessage msg;
+
+  if (kernel_time != GST_CLOCK_TIME_NONE) {
+    GstClockTime now;
+
+    /* Subtract the time since the kernel received the packet from our
+     * receive time so that the delays in the helper and in the pipe are
+     * not counted as network delay */
+#ifdef HAVE_CLOCK_GETTIME
+    {
+      struct timespec ts;
+
+      clock_gettime (CLOCK_REALTIME, &ts);
+      now = GST_TIMESPEC_TO_TIME (ts);
+    }
+#else
+    now = g_get_real_time () * GST_USECOND;
+#endif
+    if (kernel_time <= now && now - kernel_time < GST_SECOND
+        && now - kernel_time <= receive_time) {
+      GST_TRACE ("Message was queued for %" GST_TIME_FORMAT,
+          GST_TIME_ARGS (now - kernel_time));
+      receive_time -= now - kernel_time;
+    }
+  }
+
+  if (parse_ptp_message (&msg, data, size)) {
+    dump_ptp_message (&msg);
+    handle_ptp_message (&msg, receive_time);
+  }
+}
+
+#ifdef HAVE_PTP_RING
+static PtpRing *ring;
+static gint ring_fd = -1, ring_event_fd = -1;
+
+static void
+ptp_ring_destroy (void)
+{
+  if (ring)
+    munmap (ring, sizeof (PtpRing));
+  ring = NULL;
+  if (ring_fd != -1)
+    close (ring_fd);
+  ring_fd = -1;
+  if (ring_event_fd != -1)
+    close (ring_event_fd);
+  ring_event_fd = -1;
+}
+
+static gboolean
+ptp_ring_create (void)
+{
+  ring_fd = syscall (__NR_memfd_create, "gst-ptp-ring", MFD_CLOEXEC);
+  if (ring_fd == -1) {
+    GST_DEBUG ("Failed to create memfd: %s", g_strerror (errno));
+    goto error;
+  }
+
+  if (ftruncate (ring_fd, sizeof (PtpRing)) == -1) {
+    GST_DEBUG ("Failed to resize ring: %s", g_strerror (errno));
+    goto error;
+  }
+
+  ring = mmap (NULL, sizeof (PtpRing), PROT_READ | PROT_WRITE, MAP_SHARED,
+      ring_fd, 0);
+  if (ring == MAP_FAILED) {
+    GST_DEBUG ("Failed to map ring: %s", g_strerror (errno));
+    ring = NULL;
+    goto error;
+  }
+
+  ring_event_fd = eventfd (0, EFD_CLOEXEC | EFD_NONBLOCK);
+  if (ring_event_fd == -1) {
+    GST_DEBUG ("Failed to create eventfd: %s", g_strerror (errno));
+    goto error;
+  }
+
+  return TRUE;
+
+error:
+  ptp_ring_destroy ();
+  return FALSE;
+}
+
+/* Runs in the forked helper process right before exec, so only
+ * async-signal-safe functions can be used here. Moves the ring and the
+ * eventfd to the file descriptors the helper expects them at */
+static void
+ptp_ring_child_setup (gpointer user_data)
+{
+  gint fd, event_fd;
+
+  /* Duplicate first so that none of them is overwritten by the other */
+  fd = fcntl (ring_fd, F_DUPFD, 10);
+  event_fd = fcntl (ring_event_fd, F_DUPFD, 10);
+  if (fd == -1 || event_fd == -1)
+    return;
+
+  dup2 (fd, PTP_RING_HELPER_FD);
+  dup2 (event_fd, PTP_RING_HELPER_EVENT_FD);
+  close (fd);
+  close (event_fd);
+}
+
+static gboolean
+have_ring_data_cb (gint fd, GIOCondition condition, gpointer user_data)
+{
+  guint64 events;
+  gint read_index, write_index;
+
+  while (read (fd, &events, sizeof (events)) == -1 && errno == EINTR);
+
+  read_index = ring->read_index;
+  write_index = g_atomic_int_get (&ring->write_index);
+
+  while (read_index != write_index) {
+    const PtpRingSlot *slot =
+        &ring->slots[((guint) read_index) & (PTP_RING_N_SLOTS - 1)];
+
+    if (slot->size > sizeof (slot->data)) {
+      GST_ERROR ("Unexpected ring message size: %u", slot->size);
+      g_main_loop_quit (main_loop);
+      return G_SOURCE_REMOVE;
+    }
+
+    if (slot->type == TYPE_EVENT || slot->type == TYPE_GENERAL)
+      handle_received_message (slot->data, slot->size,
+          slot->kernel_time != 0 ? slot->kernel_time : GST_CLOCK_TIME_NONE);
+
+    /* Hand the slot back to the helper */
+    read_index++;
+    g_atomic_int_set (&ring->read_index, read_index);
+
+    if (read_index == write_index)
+      write_index = g_atomic_int_get (&ring->write_index);
+  }
+
+  return G_SOURCE_CONTINUE;
+}
+#endif
+
 static gboolean
 have_stdin_data_cb (GIOChannel * channel, GIOCondition condition,
     gpointer user_data)
@@ -1799,14 +2299,26 @@ have_stdin_data_cb (GIOChannel * channel, GIOCondition condition,
 
   switch (header.type) {
     case TYPE_EVENT:
-    case TYPE_GENERAL:{
-      GstClockTime receive_time = gst_clock_get_time (observation_system_clock);
-      PtpMessage msg;
+    case TYPE_GENERAL:
+      handle_received_message ((const guint8 *) buffer, header.size,
+          GST_CLOCK_TIME_NONE);
+      break;
+    case TYPE_EVENT_TIMESTAMPED:
+    case TYPE_GENERAL_TIMESTAMPED:{
+      GstClockTime kernel_time;
 
-      if (parse_ptp_message (&msg, (const guint8 *) buffer, header.size)) {
-        dump_ptp_message (&msg);
-        handle_ptp_message (&msg, receive_time);
+      if (header.size < 8) {
+        GST_ERROR ("Unexpected timestamped message size (%u < 8)",
+            header.size);
+        g_main_loop_quit (main_loop);
+        return G_SOURCE_REMOVE;
       }
+
+      /* The helper passes the time at which the kernel received the
+       * packet in front of it */
+      memcpy (&kernel_time, buffer, 8);
+      handle_received_message ((const guint8 *) buffer + 8, header.size - 8,
+          kernel_time);
       break;
     }
     default:
@@ -1821,6 +2333,9 @@ have_stdin_data_cb (GIOChannel * channel, GIOCondition condition,
       ptp_clock_id.port_number = getpid ();
       GST_DEBUG ("Got clock id 0x%016" G_GINT64_MODIFIER "x %u",
           ptp_clock_id.clock_identity, ptp_clock_id.port_number);
+#ifdef USE_SHARED_CLOCK
+      ptp_shared_publish_clock_id ();
+#endif
       g_cond_signal (&ptp_cond);
       g_mutex_unlock (&ptp_lock);
       break;
@@ -1995,6 +2510,14 @@ gst_ptp_is_initialized (void)
  * This function is automatically called by gst_ptp_clock_new() with default
  * parameters if it wasn't called before.
  *
+ * If the GST_PTP_SHARED_CLOCK environment variable is set, the PTP clock is
+ * shared between all processes on this host that use the same value. Only
+ * the first of them starts the helper process and runs the synchronization,
+ * and publishes the result in a file with that name mapped into memory. If
+ * the name is not an absolute path, the file is created in the user runtime
+ * directory. The other processes only follow the published state, they
+ * ignore @clock_id and @interfaces. Since 1.10.
+ *
  * Returns: %TRUE if the GStreamer PTP clock subsystem could be initialized.
  *
  * Since: 1.6
@@ -2009,6 +2532,7 @@ gst_ptp_init (guint64 clock_id, gchar ** interfaces)
   gint fd_r, fd_w;
   GError *err = NULL;
   GSource *stdin_source;
+  GSpawnChildSetupFunc child_setup = NULL;
 
   GST_DEBUG_CATEGORY_INIT (ptp_debug, "ptp", 0, "PTP clock");
 
@@ -2035,7 +2559,47 @@ gst_ptp_init (guint64 clock_id, gchar ** interfaces)
     domain_stats_hooks_initted = TRUE;
   }
 
+#ifdef USE_SHARED_CLOCK
+  env = g_getenv ("GST_PTP_SHARED_CLOCK");
+  if (env != NULL && *env != '\0' && ptp_shared_open (env)
+      && !shared_publisher) {
+    GSource *poll_source;
+
+    /* Somebody else runs the helper, only follow what it publishes */
+    main_context = g_main_context_new ();
+    main_loop = g_main_loop_new (main_context, FALSE);
+
+    ptp_helper_thread =
+        g_thread_try_new ("ptp-helper-thread", ptp_helper_main, NULL, &err);
+    if (!ptp_helper_thread) {
+      GST_ERROR ("Failed to start PTP helper thread: %s", err->message);
+      g_clear_error (&err);
+      ret = FALSE;
+      goto done;
+    }
+
+    poll_source = g_timeout_source_new (PTP_SHARED_POLL_INTERVAL);
+    g_source_set_priority (poll_source, G_PRIORITY_DEFAULT);
+    g_source_set_callback (poll_source, (GSourceFunc) ptp_shared_poll_cb,
+        NULL, NULL);
+    g_source_attach (poll_source, main_context);
+    g_source_unref (poll_source);
+
+    observation_system_clock =
+        g_object_new (GST_TYPE_SYSTEM_CLOCK, "name", "ptp-observation-clock",
+        NULL);
+
+    initted = TRUE;
+    goto wait;
+  }
+#endif
+
   argc = 1;
+#ifdef HAVE_PTP_RING
+  env = g_getenv ("GST_PTP_HELPER_USE_PIPE");
+  if ((env == NULL || *env == '\0') && ptp_ring_create ())
+    argc += 2;
+#endif
   if (clock_id != GST_PTP_CLOCK_ID_NONE)
     argc += 2;
   if (interfaces != NULL)
@@ -2069,6 +2633,14 @@ gst_ptp_init (guint64 clock_id, gchar ** interfaces)
     }
   }
 
+#ifdef HAVE_PTP_RING
+  if (ring) {
+    argv[argc_c++] = g_strdup_printf ("--ring-fd=%d", PTP_RING_HELPER_FD);
+    argv[argc_c++] =
+        g_strdup_printf ("--ring-event-fd=%d", PTP_RING_HELPER_EVENT_FD);
+  }
+#endif
+
   main_context = g_main_context_new ();
   main_loop = g_main_loop_new (main_context, FALSE);
 
@@ -2081,7 +2653,12 @@ gst_ptp_init (guint64 clock_id, gchar ** interfaces)
     goto done;
   }
 
-  if (!g_spawn_async_with_pipes (NULL, argv, NULL, 0, NULL, NULL,
+#ifdef HAVE_PTP_RING
+  if (ring)
+    child_setup = ptp_ring_child_setup;
+#endif
+
+  if (!g_spawn_async_with_pipes (NULL, argv, NULL, 0, child_setup, NULL,
           &ptp_helper_pid, &fd_w, &fd_r, NULL, &err)) {
     GST_ERROR ("Failed to start ptp helper process: %s", err->message);
     g_clear_error (&err);
@@ -2102,6 +2679,23 @@ gst_ptp_init (guint64 clock_id, gchar ** interfaces)
   g_source_attach (stdin_source, main_context);
   g_source_unref (stdin_source);
 
+#ifdef HAVE_PTP_RING
+  if (ring) {
+    GSource *ring_source;
+
+    /* The helper has its own copies of the ring file descriptors now */
+    close (ring_fd);
+    ring_fd = -1;
+
+    ring_source = g_unix_fd_source_new (ring_event_fd, G_IO_IN);
+    g_source_set_priority (ring_source, G_PRIORITY_DEFAULT);
+    g_source_set_callback (ring_source, (GSourceFunc) have_ring_data_cb, NULL,
+        NULL);
+    g_source_attach (ring_source, main_context);
+    g_source_unref (ring_source);
+  }
+#endif
+
   /* Create stdout channel */
   stdout_channel = g_io_channel_unix_new (fd_w);
   g_io_channel_set_encoding (stdout_channel, NULL, NULL);
@@ -2172,6 +2766,13 @@ done:
     if (observation_system_clock)
       gst_object_unref (observation_system_clock);
     observation_system_clock = NULL;
+
+#ifdef USE_SHARED_CLOCK
+    ptp_shared_close ();
+#endif
+#ifdef HAVE_PTP_RING
+    ptp_ring_destroy ();
+#endif
   }
 
   g_mutex_unlock (&ptp_lock);
@@ -2236,6 +2837,13 @@ gst_ptp_deinit (void)
     gst_object_unref (observation_system_clock);
   observation_system_clock = NULL;
 
+#ifdef USE_SHARED_CLOCK
+  ptp_shared_close ();
+#endif
+#ifdef HAVE_PTP_RING
+  ptp_ring_destroy ();
+#endif
+
   for (l = domain_data; l; l = l->next) {
     PtpDomainData *domain = l->data;
 
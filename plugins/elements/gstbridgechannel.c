@@ -0,0 +1,345 @@
+/* GStreamer
+ *
+ * gstbridgechannel.c: channel between bridgesink and bridgesrc elements
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "gstbridgechannel.h"
+
+GST_DEBUG_CATEGORY_STATIC (bridge_channel_debug);
+#define GST_CAT_DEFAULT (bridge_channel_debug)
+
+typedef struct
+{
+  GstPad *srcpad;
+  GstDataQueue *queue;
+} GstBridgeChannelSrc;
+
+struct _GstBridgeChannel
+{
+  gchar *name;
+  /* protected by channels_lock */
+  gint refcount;
+
+  GMutex lock;
+  /* the bridgesrcs, as GstBridgeChannelSrc */
+  GList *srcs;
+  /* the current sticky events, sorted by type */
+  GList *sticky;
+};
+
+static GMutex channels_lock;
+static GHashTable *channels;
+
+/* items */
+
+static void
+gst_bridge_item_clear (GstBridgeItem * item)
+{
+  if (item->object)
+    gst_mini_object_unref (item->object);
+}
+
+/* takes ownership of passed mini object! */
+static void
+gst_bridge_item_init (GstBridgeItem * item, GstMiniObject * object,
+    GstClockTime base_time)
+{
+  item->object = object;
+  item->destroy = (GDestroyNotify) gst_bridge_item_clear;
+  item->base_time = base_time;
+
+  if (GST_IS_BUFFER (object)) {
+    item->size = gst_buffer_get_size (GST_BUFFER_CAST (object));
+    item->duration = GST_BUFFER_DURATION (object);
+    if (item->duration == GST_CLOCK_TIME_NONE)
+      item->duration = 0;
+    item->visible = TRUE;
+  } else {
+    item->size = 0;
+    item->duration = 0;
+    item->visible = FALSE;
+  }
+}
+
+/* channels */
+
+/* gst_bridge_channel_get:
+ * @name: the channel name
+ *
+ * Get the channel called @name, creating it when it does not exist yet.
+ *
+ * Returns: (transfer full): the channel
+ */
+GstBridgeChannel *
+gst_bridge_channel_get (const gchar * name)
+{
+  GstBridgeChannel *channel;
+
+  g_mutex_lock (&channels_lock);
+  if (!channels) {
+    GST_DEBUG_CATEGORY_INIT (bridge_channel_debug, "bridgechannel", 0,
+        "channels between bridgesink and bridgesrc");
+    channels = g_hash_table_new (g_str_hash, g_str_equal);
+  }
+
+  if (!(channel = g_hash_table_lookup (channels, name))) {
+    channel = g_slice_new0 (GstBridgeChannel);
+    channel->name = g_strdup (name);
+    g_mutex_init (&channel->lock);
+    g_hash_table_insert (channels, channel->name, channel);
+    GST_DEBUG ("created channel %s", name);
+  }
+  channel->refcount++;
+  g_mutex_unlock (&channels_lock);
+
+  return channel;
+}
+
+void
+gst_bridge_channel_unref (GstBridgeChannel * channel)
+{
+  g_mutex_lock (&channels_lock);
+  if (--channel->refcount > 0) {
+    g_mutex_unlock (&channels_lock);
+    return;
+  }
+  g_hash_table_remove (channels, channel->name);
+  g_mutex_unlock (&channels_lock);
+
+  GST_DEBUG ("freeing channel %s", channel->name);
+  g_assert (channel->srcs == NULL);
+  g_list_free_full (channel->sticky, (GDestroyNotify) gst_event_unref);
+  g_mutex_clear (&channel->lock);
+  g_free (channel->name);
+  g_slice_free (GstBridgeChannel, channel);
+}
+
+/* call with the channel lock */
+static void
+gst_bridge_channel_push_to_src (GstBridgeChannelSrc * src, GstEvent * event,
+    GstClockTime base_time)
+{
+  GstBridgeItem item;
+
+  gst_bridge_item_init (&item, GST_MINI_OBJECT_CAST (gst_event_ref (event)),
+      base_time);
+  /* events must not block while holding the lock, the bridgesrc limits
+   * only count buffers */
+  if (!gst_data_queue_push_force (src->queue, (GstDataQueueItem *) & item))
+    gst_bridge_item_clear (&item);
+}
+
+/* gst_bridge_channel_add_src:
+ * @channel: a #GstBridgeChannel
+ * @srcpad: the src pad of a bridgesrc
+ * @queue: the queue of the bridgesrc
+ *
+ * Start queueing the data of @channel into @queue, starting with the
+ * current sticky events.
+ */
+void
+gst_bridge_channel_add_src (GstBridgeChannel * channel, GstPad * srcpad,
+    GstDataQueue * queue)
+{
+  GstBridgeChannelSrc *src;
+  GList *l;
+
+  src = g_slice_new (GstBridgeChannelSrc);
+  src->srcpad = gst_object_ref (srcpad);
+  src->queue = g_object_ref (queue);
+
+  g_mutex_lock (&channel->lock);
+  for (l = channel->sticky; l; l = l->next)
+    gst_bridge_channel_push_to_src (src, l->data, GST_CLOCK_TIME_NONE);
+  channel->srcs = g_list_prepend (channel->srcs, src);
+  g_mutex_unlock (&channel->lock);
+}
+
+void
+gst_bridge_channel_remove_src (GstBridgeChannel * channel, GstPad * srcpad)
+{
+  GstBridgeChannelSrc *src = NULL;
+  GList *l;
+
+  g_mutex_lock (&channel->lock);
+  for (l = channel->srcs; l; l = l->next) {
+    src = l->data;
+    if (src->srcpad == srcpad) {
+      channel->srcs = g_list_delete_link (channel->srcs, l);
+      break;
+    }
+    src = NULL;
+  }
+  g_mutex_unlock (&channel->lock);
+
+  if (src) {
+    gst_object_unref (src->srcpad);
+    g_object_unref (src->queue);
+    g_slice_free (GstBridgeChannelSrc, src);
+  }
+}
+
+/* call with the channel lock */
+static void
+gst_bridge_channel_remove_sticky (GstBridgeChannel * channel,
+    GstEventType type)
+{
+  GList *l, *next;
+
+  for (l = channel->sticky; l; l = next) {
+    next = l->next;
+    if (GST_EVENT_TYPE (l->data) == type) {
+      gst_event_unref (l->data);
+      channel->sticky = g_list_delete_link (channel->sticky, l);
+    }
+  }
+}
+
+/* call with the channel lock */
+static void
+gst_bridge_channel_store_sticky (GstBridgeChannel * channel, GstEvent * event)
+{
+  GstEventType type = GST_EVENT_TYPE (event);
+  GstEvent *old;
+  GList *l;
+
+  /* a new stream starts, like on a pad */
+  if (type == GST_EVENT_STREAM_START)
+    gst_bridge_channel_remove_sticky (channel, GST_EVENT_EOS);
+
+  for (l = channel->sticky; l; l = l->next) {
+    old = l->data;
+
+    if (GST_EVENT_TYPE (old) > type)
+      break;
+    if (GST_EVENT_TYPE (old) < type)
+      continue;
+
+    if (!(type & GST_EVENT_TYPE_STICKY_MULTI) ||
+        gst_event_has_name (old,
+            gst_structure_get_name (gst_event_get_structure (event)))) {
+      gst_event_replace ((GstEvent **) & l->data, event);
+      return;
+    }
+  }
+  channel->sticky =
+      g_list_insert_before (channel->sticky, l, gst_event_ref (event));
+}
+
+/* gst_bridge_channel_push_event:
+ * @channel: a #GstBridgeChannel
+ * @event: (transfer full): a serialized event
+ * @base_time: the base time of the bridgesink
+ *
+ * Queue @event in all the bridgesrcs of @channel. Sticky events are also
+ * kept for the bridgesrcs that are added later.
+ */
+void
+gst_bridge_channel_push_event (GstBridgeChannel * channel, GstEvent * event,
+    GstClockTime base_time)
+{
+  GList *l;
+
+  g_mutex_lock (&channel->lock);
+  if (GST_EVENT_TYPE (event) == GST_EVENT_FLUSH_STOP) {
+    /* flushing stays in the pipeline of the bridgesink */
+    gst_bridge_channel_remove_sticky (channel, GST_EVENT_EOS);
+    gst_bridge_channel_remove_sticky (channel, GST_EVENT_SEGMENT);
+    goto done;
+  }
+
+  if (GST_EVENT_IS_STICKY (event))
+    gst_bridge_channel_store_sticky (channel, event);
+
+  for (l = channel->srcs; l; l = l->next)
+    gst_bridge_channel_push_to_src (l->data, event, base_time);
+
+done:
+  g_mutex_unlock (&channel->lock);
+  gst_event_unref (event);
+}
+
+/* gst_bridge_channel_push_buffer:
+ * @channel: a #GstBridgeChannel
+ * @buffer: (transfer full): a #GstBuffer
+ * @base_time: the base time of the bridgesink
+ *
+ * Queue @buffer in all the bridgesrcs of @channel. The buffer itself is
+ * queued, not a copy. Blocks while the queue of a bridgesrc is full.
+ */
+void
+gst_bridge_channel_push_buffer (GstBridgeChannel * channel,
+    GstBuffer * buffer, GstClockTime base_time)
+{
+  GstBridgeItem item;
+  GList *queues = NULL, *l;
+
+  /* don't block the other bridgesrcs while waiting for one of them */
+  g_mutex_lock (&channel->lock);
+  for (l = channel->srcs; l; l = l->next)
+    queues = g_list_prepend (queues,
+        g_object_ref (((GstBridgeChannelSrc *) l->data)->queue));
+  g_mutex_unlock (&channel->lock);
+
+  for (l = queues; l; l = l->next) {
+    gst_bridge_item_init (&item,
+        GST_MINI_OBJECT_CAST (gst_buffer_ref (buffer)), base_time);
+    /* fails when the bridgesrc is flushing, it is not interested then */
+    if (!gst_data_queue_push (l->data, (GstDataQueueItem *) & item))
+      gst_bridge_item_clear (&item);
+  }
+  g_list_free_full (queues, g_object_unref);
+  gst_buffer_unref (buffer);
+}
+
+/* gst_bridge_channel_query:
+ * @channel: a #GstBridgeChannel
+ * @query: a #GstQuery
+ *
+ * Answer an allocation @query from downstream of the bridgesrc, when there
+ * is exactly one bridgesrc. Buffers can then be allocated from the pools of
+ * the pipeline of the bridgesrc.
+ *
+ * Returns: %TRUE if @query was answered
+ */
+gboolean
+gst_bridge_channel_query (GstBridgeChannel * channel, GstQuery * query)
+{
+  GstPad *srcpad = NULL;
+  gboolean res = FALSE;
+
+  if (GST_QUERY_TYPE (query) != GST_QUERY_ALLOCATION)
+    return FALSE;
+
+  g_mutex_lock (&channel->lock);
+  if (channel->srcs && !channel->srcs->next)
+    srcpad =
+        gst_object_ref (((GstBridgeChannelSrc *) channel->srcs->data)->srcpad);
+  g_mutex_unlock (&channel->lock);
+
+  if (srcpad) {
+    res = gst_pad_peer_query (srcpad, query);
+    gst_object_unref (srcpad);
+  }
+  return res;
+}
@@ -0,0 +1,78 @@
+/* GStreamer
+ *
+ * gstbridgechannel.h: channel between bridgesink and bridgesrc elements
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __GST_BRIDGE_CHANNEL_H__
+#define __GST_BRIDGE_CHANNEL_H__
+
+#include <gst/gst.h>
+#include <gst/base/gstdataqueue.h>
+
+G_BEGIN_DECLS
+
+#define GST_BRIDGE_CHANNEL_DEFAULT_NAME "default"
+
+typedef struct _GstBridgeChannel GstBridgeChannel;
+typedef struct _GstBridgeItem GstBridgeItem;
+
+/* Extension of GstDataQueueItem structure for our usage, stored in the
+ * GstDataQueue of a bridgesrc */
+struct _GstBridgeItem
+{
+  GstMiniObject *object;
+  guint size;
+  guint64 duration;
+  gboolean visible;
+
+  GDestroyNotify destroy;
+
+  /* base time of the bridgesink when the object was queued */
+  GstClockTime base_time;
+};
+
+G_GNUC_INTERNAL
+GstBridgeChannel * gst_bridge_channel_get          (const gchar * name);
+G_GNUC_INTERNAL
+void               gst_bridge_channel_unref        (GstBridgeChannel * channel);
+
+/* bridgesrc side */
+G_GNUC_INTERNAL
+void               gst_bridge_channel_add_src      (GstBridgeChannel * channel,
+                                                    GstPad * srcpad,
+                                                    GstDataQueue * queue);
+G_GNUC_INTERNAL
+void               gst_bridge_channel_remove_src   (GstBridgeChannel * channel,
+                                                    GstPad * srcpad);
+
+/* bridgesink side */
+G_GNUC_INTERNAL
+void               gst_bridge_channel_push_event   (GstBridgeChannel * channel,
+                                                    GstEvent * event,
+                                                    GstClockTime base_time);
+G_GNUC_INTERNAL
+void               gst_bridge_channel_push_buffer  (GstBridgeChannel * channel,
+                                                    GstBuffer * buffer,
+                                                    GstClockTime base_time);
+G_GNUC_INTERNAL
+gboolean           gst_bridge_channel_query        (GstBridgeChannel * channel,
+                                                    GstQuery * query);
+
+G_END_DECLS
+
+#endif /* __GST_BRIDGE_CHANNEL_H__ */
@@ -0,0 +1,244 @@
+/* GStreamer
+ *
+ * gstbridgesink.c: sink of a zero-copy bridge between pipelines
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+/**
+ * SECTION:element-bridgesink
+ * @see_also: #GstBridgeSrc
+ *
+ * Passes buffers and serialized events to the bridgesrc elements with the
+ * same #GstBridgeSink:channel, which can be in other pipelines of the same
+ * process. Buffers are passed by reference, nothing is copied, and all
+ * pipelines keep their own state.
+ *
+ * When there is exactly one bridgesrc on the channel, allocation queries
+ * are answered by the pipeline of the bridgesrc, so that buffers can be
+ * allocated from its buffer pools.
+ *
+ * The sink does not synchronize to the clock by default, the bridgesrc
+ * elements receive the buffers as soon as they arrive.
+ *
+ * <refsect2>
+ * <title>Example launch line</title>
+ * |[
+ * gst-launch-1.0 videotestsrc ! bridgesink channel=cam  bridgesrc channel=cam ! autovideosink
+ * ]|
+ * </refsect2>
+ *
+ * Since: 1.10
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "gstbridgesink.h"
+
+GST_DEBUG_CATEGORY_STATIC (gst_bridge_sink_debug);
+#define GST_CAT_DEFAULT gst_bridge_sink_debug
+
+static GstStaticPadTemplate sinktemplate = GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS_ANY);
+
+enum
+{
+  PROP_0,
+  PROP_CHANNEL
+};
+
+#define DEFAULT_CHANNEL GST_BRIDGE_CHANNEL_DEFAULT_NAME
+
+#define _do_init \
+    GST_DEBUG_CATEGORY_INIT (gst_bridge_sink_debug, "bridgesink", 0, "bridgesink element");
+#define gst_bridge_sink_parent_class parent_class
+G_DEFINE_TYPE_WITH_CODE (GstBridgeSink, gst_bridge_sink, GST_TYPE_BASE_SINK,
+    _do_init);
+
+static void gst_bridge_sink_finalize (GObject * object);
+static void gst_bridge_sink_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec);
+static void gst_bridge_sink_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec);
+
+static gboolean gst_bridge_sink_start (GstBaseSink * bsink);
+static gboolean gst_bridge_sink_stop (GstBaseSink * bsink);
+static gboolean gst_bridge_sink_event (GstBaseSink * bsink, GstEvent * event);
+static GstFlowReturn gst_bridge_sink_render (GstBaseSink * bsink,
+    GstBuffer * buffer);
+static gboolean gst_bridge_sink_propose_allocation (GstBaseSink * bsink,
+    GstQuery * query);
+
+static void
+gst_bridge_sink_class_init (GstBridgeSinkClass * klass)
+{
+  GObjectClass *gobject_class;
+  GstElementClass *gstelement_class;
+  GstBaseSinkClass *gstbase_sink_class;
+
+  gobject_class = G_OBJECT_CLASS (klass);
+  gstelement_class = GST_ELEMENT_CLASS (klass);
+  gstbase_sink_class = GST_BASE_SINK_CLASS (klass);
+
+  gobject_class->finalize = gst_bridge_sink_finalize;
+  gobject_class->set_property = gst_bridge_sink_set_property;
+  gobject_class->get_property = gst_bridge_sink_get_property;
+
+  /**
+   * GstBridgeSink:channel:
+   *
+   * The name of the channel to the bridgesrc elements. Takes effect when
+   * going from READY to PAUSED.
+   *
+   * Since: 1.10
+   */
+  g_object_class_install_property (gobject_class, PROP_CHANNEL,
+      g_param_spec_string ("channel", "Channel",
+          "Name of the channel to the bridgesrc elements", DEFAULT_CHANNEL,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  gst_element_class_set_static_metadata (gstelement_class, "Bridge sink",
+      "Sink", "Passes data to bridgesrc elements in other pipelines",
+      "GStreamer maintainers <gstreamer-devel@lists.freedesktop.org>");
+  gst_element_class_add_static_pad_template (gstelement_class, &sinktemplate);
+
+  gstbase_sink_class->start = GST_DEBUG_FUNCPTR (gst_bridge_sink_start);
+  gstbase_sink_class->stop = GST_DEBUG_FUNCPTR (gst_bridge_sink_stop);
+  gstbase_sink_class->event = GST_DEBUG_FUNCPTR (gst_bridge_sink_event);
+  gstbase_sink_class->render = GST_DEBUG_FUNCPTR (gst_bridge_sink_render);
+  gstbase_sink_class->propose_allocation =
+      GST_DEBUG_FUNCPTR (gst_bridge_sink_propose_allocation);
+}
+
+static void
+gst_bridge_sink_init (GstBridgeSink * sink)
+{
+  sink->channel_name = g_strdup (DEFAULT_CHANNEL);
+
+  gst_base_sink_set_sync (GST_BASE_SINK (sink), FALSE);
+}
+
+static void
+gst_bridge_sink_finalize (GObject * object)
+{
+  GstBridgeSink *sink = GST_BRIDGE_SINK (object);
+
+  g_free (sink->channel_name);
+
+  G_OBJECT_CLASS (parent_class)->finalize (object);
+}
+
+static void
+gst_bridge_sink_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstBridgeSink *sink = GST_BRIDGE_SINK (object);
+
+  switch (prop_id) {
+    case PROP_CHANNEL:
+      GST_OBJECT_LOCK (sink);
+      g_free (sink->channel_name);
+      sink->channel_name = g_value_dup_string (value);
+      if (!sink->channel_name)
+        sink->channel_name = g_strdup (DEFAULT_CHANNEL);
+      GST_OBJECT_UNLOCK (sink);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_bridge_sink_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec)
+{
+  GstBridgeSink *sink = GST_BRIDGE_SINK (object);
+
+  switch (prop_id) {
+    case PROP_CHANNEL:
+      GST_OBJECT_LOCK (sink);
+      g_value_set_string (value, sink->channel_name);
+      GST_OBJECT_UNLOCK (sink);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static gboolean
+gst_bridge_sink_start (GstBaseSink * bsink)
+{
+  GstBridgeSink *sink = GST_BRIDGE_SINK (bsink);
+
+  GST_OBJECT_LOCK (sink);
+  sink->channel = gst_bridge_channel_get (sink->channel_name);
+  GST_OBJECT_UNLOCK (sink);
+
+  return TRUE;
+}
+
+static gboolean
+gst_bridge_sink_stop (GstBaseSink * bsink)
+{
+  GstBridgeSink *sink = GST_BRIDGE_SINK (bsink);
+
+  if (sink->channel) {
+    gst_bridge_channel_unref (sink->channel);
+    sink->channel = NULL;
+  }
+  return TRUE;
+}
+
+static gboolean
+gst_bridge_sink_event (GstBaseSink * bsink, GstEvent * event)
+{
+  GstBridgeSink *sink = GST_BRIDGE_SINK (bsink);
+
+  if (GST_EVENT_IS_SERIALIZED (event) && sink->channel) {
+    GST_DEBUG_OBJECT (sink, "passing %" GST_PTR_FORMAT, event);
+    gst_bridge_channel_push_event (sink->channel, gst_event_ref (event),
+        gst_element_get_base_time (GST_ELEMENT_CAST (sink)));
+  }
+
+  return GST_BASE_SINK_CLASS (parent_class)->event (bsink, event);
+}
+
+static GstFlowReturn
+gst_bridge_sink_render (GstBaseSink * bsink, GstBuffer * buffer)
+{
+  GstBridgeSink *sink = GST_BRIDGE_SINK (bsink);
+
+  gst_bridge_channel_push_buffer (sink->channel, gst_buffer_ref (buffer),
+      gst_element_get_base_time (GST_ELEMENT_CAST (sink)));
+
+  return GST_FLOW_OK;
+}
+
+static gboolean
+gst_bridge_sink_propose_allocation (GstBaseSink * bsink, GstQuery * query)
+{
+  GstBridgeSink *sink = GST_BRIDGE_SINK (bsink);
+
+  if (!sink->channel)
+    return FALSE;
+
+  return gst_bridge_channel_query (sink->channel, query);
+}
@@ -0,0 +1,68 @@
+/* GStreamer
+ *
+ * gstbridgesink.h: sink of a zero-copy bridge between pipelines
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __GST_BRIDGE_SINK_H__
+#define __GST_BRIDGE_SINK_H__
+
+#include <gst/gst.h>
+#include <gst/base/gstbasesink.h>
+
+#include "gstbridgechannel.h"
+
+G_BEGIN_DECLS
+
+#define GST_TYPE_BRIDGE_SINK \
+  (gst_bridge_sink_get_type())
+#define GST_BRIDGE_SINK(obj) \
+  (G_TYPE_CHECK_INSTANCE_CAST((obj),GST_TYPE_BRIDGE_SINK,GstBridgeSink))
+#define GST_BRIDGE_SINK_CLASS(klass) \
+  (G_TYPE_CHECK_CLASS_CAST((klass),GST_TYPE_BRIDGE_SINK,GstBridgeSinkClass))
+#define GST_IS_BRIDGE_SINK(obj) \
+  (G_TYPE_CHECK_INSTANCE_TYPE((obj),GST_TYPE_BRIDGE_SINK))
+#define GST_IS_BRIDGE_SINK_CLASS(klass) \
+  (G_TYPE_CHECK_CLASS_TYPE((klass),GST_TYPE_BRIDGE_SINK))
+#define GST_BRIDGE_SINK_CAST(obj) ((GstBridgeSink *)obj)
+
+typedef struct _GstBridgeSink GstBridgeSink;
+typedef struct _GstBridgeSinkClass GstBridgeSinkClass;
+
+/**
+ * GstBridgeSink:
+ *
+ * The opaque #GstBridgeSink data structure.
+ */
+struct _GstBridgeSink {
+  GstBaseSink		element;
+
+  /*< private >*/
+  gchar			*channel_name;
+  /* between start and stop */
+  GstBridgeChannel	*channel;
+};
+
+struct _GstBridgeSinkClass {
+  GstBaseSinkClass	parent_class;
+};
+
+G_GNUC_INTERNAL GType gst_bridge_sink_get_type (void);
+
+G_END_DECLS
+
+#endif /* __GST_BRIDGE_SINK_H__ */
@@ -0,0 +1,394 @@
+/* GStreamer
+ *
+ * gstbridgesrc.c: source of a zero-copy bridge between pipelines
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+/**
+ * SECTION:element-bridgesrc
+ * @see_also: #GstBridgeSink
+ *
+ * Outputs the buffers and serialized events of the bridgesink with the same
+ * #GstBridgeSrc:channel, which can be in another pipeline of the same
+ * process. Any number of bridgesrc elements can receive the data of one
+ * bridgesink, they all get the same buffers, nothing is copied.
+ *
+ * A bridgesrc that is added to a channel later first gets the current
+ * sticky events of the channel. Flushes and upstream events stay in their
+ * own pipeline.
+ *
+ * The bridgesrc is a live source. The running time of time segments is
+ * translated from the pipeline of the bridgesink to the one of the
+ * bridgesrc, assuming both pipelines use the same clock. The segment is
+ * sent again when one of the base times changes.
+ *
+ * Since: 1.10
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "gstbridgesrc.h"
+#include "../../gst/gst-i18n-lib.h"
+
+GST_DEBUG_CATEGORY_STATIC (gst_bridge_src_debug);
+#define GST_CAT_DEFAULT gst_bridge_src_debug
+
+static GstStaticPadTemplate srctemplate = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS_ANY);
+
+enum
+{
+  PROP_0,
+  PROP_CHANNEL,
+  PROP_MAX_SIZE_BUFFERS
+};
+
+#define DEFAULT_CHANNEL GST_BRIDGE_CHANNEL_DEFAULT_NAME
+#define DEFAULT_MAX_SIZE_BUFFERS 32
+
+#define _do_init \
+    GST_DEBUG_CATEGORY_INIT (gst_bridge_src_debug, "bridgesrc", 0, "bridgesrc element");
+#define gst_bridge_src_parent_class parent_class
+G_DEFINE_TYPE_WITH_CODE (GstBridgeSrc, gst_bridge_src, GST_TYPE_ELEMENT,
+    _do_init);
+
+static void gst_bridge_src_finalize (GObject * object);
+static void gst_bridge_src_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec);
+static void gst_bridge_src_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec);
+
+static GstStateChangeReturn gst_bridge_src_change_state (GstElement * element,
+    GstStateChange transition);
+
+static gboolean gst_bridge_src_activate_mode (GstPad * pad, GstObject * parent,
+    GstPadMode mode, gboolean active);
+static gboolean gst_bridge_src_query (GstPad * pad, GstObject * parent,
+    GstQuery * query);
+static void gst_bridge_src_loop (GstPad * pad);
+
+static void
+gst_bridge_src_class_init (GstBridgeSrcClass * klass)
+{
+  GObjectClass *gobject_class;
+  GstElementClass *gstelement_class;
+
+  gobject_class = G_OBJECT_CLASS (klass);
+  gstelement_class = GST_ELEMENT_CLASS (klass);
+
+  gobject_class->finalize = gst_bridge_src_finalize;
+  gobject_class->set_property = gst_bridge_src_set_property;
+  gobject_class->get_property = gst_bridge_src_get_property;
+
+  /**
+   * GstBridgeSrc:channel:
+   *
+   * The name of the channel to the bridgesink. Takes effect when going from
+   * READY to PAUSED.
+   *
+   * Since: 1.10
+   */
+  g_object_class_install_property (gobject_class, PROP_CHANNEL,
+      g_param_spec_string ("channel", "Channel",
+          "Name of the channel to the bridgesink", DEFAULT_CHANNEL,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstBridgeSrc:max-size-buffers:
+   *
+   * The number of buffers that are queued before the bridgesink blocks,
+   * 0 for no limit.
+   *
+   * Since: 1.10
+   */
+  g_object_class_install_property (gobject_class, PROP_MAX_SIZE_BUFFERS,
+      g_param_spec_uint ("max-size-buffers", "Max. size (buffers)",
+          "Max. number of buffers in the queue (0=disable)", 0, G_MAXUINT,
+          DEFAULT_MAX_SIZE_BUFFERS,
+          G_PARAM_READWRITE | GST_PARAM_MUTABLE_PLAYING |
+          G_PARAM_STATIC_STRINGS));
+
+  gst_element_class_set_static_metadata (gstelement_class, "Bridge source",
+      "Source", "Receives data from a bridgesink in another pipeline",
+      "GStreamer maintainers <gstreamer-devel@lists.freedesktop.org>");
+  gst_element_class_add_static_pad_template (gstelement_class, &srctemplate);
+
+  gstelement_class->change_state =
+      GST_DEBUG_FUNCPTR (gst_bridge_src_change_state);
+}
+
+static gboolean
+gst_bridge_src_check_full (GstDataQueue * queue, guint visible, guint bytes,
+    guint64 time, GstBridgeSrc * src)
+{
+  guint max_size_buffers = g_atomic_int_get (&src->max_size_buffers);
+
+  return max_size_buffers > 0 && visible >= max_size_buffers;
+}
+
+static void
+gst_bridge_src_init (GstBridgeSrc * src)
+{
+  src->srcpad = gst_pad_new_from_static_template (&srctemplate, "src");
+  gst_pad_set_activatemode_function (src->srcpad,
+      GST_DEBUG_FUNCPTR (gst_bridge_src_activate_mode));
+  gst_pad_set_query_function (src->srcpad,
+      GST_DEBUG_FUNCPTR (gst_bridge_src_query));
+  gst_element_add_pad (GST_ELEMENT_CAST (src), src->srcpad);
+
+  src->channel_name = g_strdup (DEFAULT_CHANNEL);
+  src->max_size_buffers = DEFAULT_MAX_SIZE_BUFFERS;
+
+  src->queue = gst_data_queue_new_for_struct ((GstDataQueueCheckFullFunction)
+      gst_bridge_src_check_full, NULL, NULL, src, sizeof (GstBridgeItem));
+  gst_data_queue_set_flushing (src->queue, TRUE);
+
+  GST_OBJECT_FLAG_SET (src, GST_ELEMENT_FLAG_SOURCE);
+}
+
+static void
+gst_bridge_src_finalize (GObject * object)
+{
+  GstBridgeSrc *src = GST_BRIDGE_SRC (object);
+
+  g_object_unref (src->queue);
+  g_free (src->channel_name);
+
+  G_OBJECT_CLASS (parent_class)->finalize (object);
+}
+
+static void
+gst_bridge_src_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstBridgeSrc *src = GST_BRIDGE_SRC (object);
+
+  switch (prop_id) {
+    case PROP_CHANNEL:
+      GST_OBJECT_LOCK (src);
+      g_free (src->channel_name);
+      src->channel_name = g_value_dup_string (value);
+      if (!src->channel_name)
+        src->channel_name = g_strdup (DEFAULT_CHANNEL);
+      GST_OBJECT_UNLOCK (src);
+      break;
+    case PROP_MAX_SIZE_BUFFERS:
+      g_atomic_int_set (&src->max_size_buffers, g_value_get_uint (value));
+      gst_data_queue_limits_changed (src->queue);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_bridge_src_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec)
+{
+  GstBridgeSrc *src = GST_BRIDGE_SRC (object);
+
+  switch (prop_id) {
+    case PROP_CHANNEL:
+      GST_OBJECT_LOCK (src);
+      g_value_set_string (value, src->channel_name);
+      GST_OBJECT_UNLOCK (src);
+      break;
+    case PROP_MAX_SIZE_BUFFERS:
+      g_value_set_uint (value, g_atomic_int_get (&src->max_size_buffers));
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static gboolean
+gst_bridge_src_activate_mode (GstPad * pad, GstObject * parent,
+    GstPadMode mode, gboolean active)
+{
+  GstBridgeSrc *src = GST_BRIDGE_SRC (parent);
+  gboolean res;
+
+  if (mode != GST_PAD_MODE_PUSH)
+    return FALSE;
+
+  if (active) {
+    src->have_segment = FALSE;
+    src->offset = 0;
+    gst_data_queue_set_flushing (src->queue, FALSE);
+    res = gst_pad_start_task (pad, (GstTaskFunction) gst_bridge_src_loop, pad,
+        NULL);
+  } else {
+    gst_data_queue_set_flushing (src->queue, TRUE);
+    res = gst_pad_stop_task (pad);
+    gst_data_queue_flush (src->queue);
+  }
+  return res;
+}
+
+static gboolean
+gst_bridge_src_query (GstPad * pad, GstObject * parent, GstQuery * query)
+{
+  switch (GST_QUERY_TYPE (query)) {
+    case GST_QUERY_LATENCY:
+      /* we are live, the latency of the other pipeline is already included
+       * in the timestamps */
+      gst_query_set_latency (query, TRUE, 0, GST_CLOCK_TIME_NONE);
+      return TRUE;
+    default:
+      return gst_pad_query_default (pad, parent, query);
+  }
+}
+
+/* push the last segment with the running time moved by @offset */
+static gboolean
+gst_bridge_src_push_segment (GstBridgeSrc * src, GstClockTimeDiff offset)
+{
+  GstSegment segment;
+  GstEvent *event;
+
+  gst_segment_copy_into (&src->segment, &segment);
+  if (segment.format == GST_FORMAT_TIME && offset != 0 &&
+      !gst_segment_offset_running_time (&segment, GST_FORMAT_TIME, offset)) {
+    GST_WARNING_OBJECT (src, "can not move running time by %"
+        GST_STIME_FORMAT, GST_STIME_ARGS (offset));
+  }
+  src->offset = offset;
+
+  event = gst_event_new_segment (&segment);
+  gst_event_set_seqnum (event, src->segment_seqnum);
+  return gst_pad_push_event (src->srcpad, event);
+}
+
+static void
+gst_bridge_src_loop (GstPad * pad)
+{
+  GstBridgeSrc *src = GST_BRIDGE_SRC (GST_PAD_PARENT (pad));
+  GstBridgeItem item;
+  GstClockTimeDiff offset;
+  GstFlowReturn ret = GST_FLOW_OK;
+  GstEvent *event;
+
+  if (!gst_data_queue_pop_struct (src->queue, (GstDataQueueItem *) & item))
+    goto flushing;
+
+  /* running time of the bridgesink pipeline to ours */
+  offset = GST_CLOCK_DIFF (gst_element_get_base_time (GST_ELEMENT_CAST (src)),
+      item.base_time);
+
+  if (GST_IS_BUFFER (item.object)) {
+    if (src->have_segment && offset != src->offset)
+      gst_bridge_src_push_segment (src, offset);
+
+    ret = gst_pad_push (pad, GST_BUFFER_CAST (item.object));
+    item.object = NULL;
+    if (ret != GST_FLOW_OK)
+      goto pause;
+  } else {
+    event = GST_EVENT_CAST (item.object);
+    item.object = NULL;
+
+    switch (GST_EVENT_TYPE (event)) {
+      case GST_EVENT_SEGMENT:
+        gst_event_copy_segment (event, &src->segment);
+        src->segment_seqnum = gst_event_get_seqnum (event);
+        src->have_segment = TRUE;
+        gst_event_unref (event);
+        /* sticky events have no base time, use the last one */
+        if (!GST_CLOCK_TIME_IS_VALID (item.base_time))
+          offset = src->offset;
+        gst_bridge_src_push_segment (src, offset);
+        break;
+      case GST_EVENT_EOS:
+        gst_pad_push_event (pad, event);
+        ret = GST_FLOW_EOS;
+        goto pause;
+      default:
+        gst_pad_push_event (pad, event);
+        break;
+    }
+  }
+  return;
+
+flushing:
+  {
+    GST_DEBUG_OBJECT (src, "we are flushing");
+    gst_pad_pause_task (pad);
+    return;
+  }
+pause:
+  {
+    GST_DEBUG_OBJECT (src, "pausing task, reason %s", gst_flow_get_name (ret));
+    /* don't let the bridgesink wait for us */
+    gst_data_queue_set_flushing (src->queue, TRUE);
+    gst_data_queue_flush (src->queue);
+    gst_pad_pause_task (pad);
+    if (ret == GST_FLOW_NOT_LINKED || ret < GST_FLOW_EOS) {
+      GST_ELEMENT_ERROR (src, STREAM, FAILED,
+          (_("Internal data flow error.")),
+          ("streaming task paused, reason %s (%d)",
+              gst_flow_get_name (ret), ret));
+      gst_pad_push_event (pad, gst_event_new_eos ());
+    }
+    return;
+  }
+}
+
+static GstStateChangeReturn
+gst_bridge_src_change_state (GstElement * element, GstStateChange transition)
+{
+  GstBridgeSrc *src = GST_BRIDGE_SRC (element);
+  GstStateChangeReturn ret;
+
+  switch (transition) {
+    case GST_STATE_CHANGE_PAUSED_TO_READY:
+      /* stop receiving data before we flush */
+      if (src->channel) {
+        gst_bridge_channel_remove_src (src->channel, src->srcpad);
+        gst_bridge_channel_unref (src->channel);
+        src->channel = NULL;
+      }
+      break;
+    default:
+      break;
+  }
+
+  ret = GST_ELEMENT_CLASS (parent_class)->change_state (element, transition);
+  if (ret == GST_STATE_CHANGE_FAILURE)
+    return ret;
+
+  switch (transition) {
+    case GST_STATE_CHANGE_READY_TO_PAUSED:
+      /* the pad is active now, sticky events will not be lost */
+      GST_OBJECT_LOCK (src);
+      src->channel = gst_bridge_channel_get (src->channel_name);
+      GST_OBJECT_UNLOCK (src);
+      gst_bridge_channel_add_src (src->channel, src->srcpad, src->queue);
+      ret = GST_STATE_CHANGE_NO_PREROLL;
+      break;
+    case GST_STATE_CHANGE_PLAYING_TO_PAUSED:
+      ret = GST_STATE_CHANGE_NO_PREROLL;
+      break;
+    default:
+      break;
+  }
+  return ret;
+}
@@ -0,0 +1,80 @@
+/* GStreamer
+ *
+ * gstbridgesrc.h: source of a zero-copy bridge between pipelines
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __GST_BRIDGE_SRC_H__
+#define __GST_BRIDGE_SRC_H__
+
+#include <gst/gst.h>
+#include <gst/base/gstdataqueue.h>
+
+#include "gstbridgechannel.h"
+
+G_BEGIN_DECLS
+
+#define GST_TYPE_BRIDGE_SRC \
+  (gst_bridge_src_get_type())
+#define GST_BRIDGE_SRC(obj) \
+  (G_TYPE_CHECK_INSTANCE_CAST((obj),GST_TYPE_BRIDGE_SRC,GstBridgeSrc))
+#define GST_BRIDGE_SRC_CLASS(klass) \
+  (G_TYPE_CHECK_CLASS_CAST((klass),GST_TYPE_BRIDGE_SRC,GstBridgeSrcClass))
+#define GST_IS_BRIDGE_SRC(obj) \
+  (G_TYPE_CHECK_INSTANCE_TYPE((obj),GST_TYPE_BRIDGE_SRC))
+#define GST_IS_BRIDGE_SRC_CLASS(klass) \
+  (G_TYPE_CHECK_CLASS_TYPE((klass),GST_TYPE_BRIDGE_SRC))
+#define GST_BRIDGE_SRC_CAST(obj) ((GstBridgeSrc *)obj)
+
+typedef struct _GstBridgeSrc GstBridgeSrc;
+typedef struct _GstBridgeSrcClass GstBridgeSrcClass;
+
+/**
+ * GstBridgeSrc:
+ *
+ * The opaque #GstBridgeSrc data structure.
+ */
+struct _GstBridgeSrc {
+  GstElement		element;
+
+  /*< private >*/
+  GstPad		*srcpad;
+
+  gchar			*channel_name;
+  guint			max_size_buffers;
+
+  /* in PAUSED and PLAYING */
+  GstBridgeChannel	*channel;
+  GstDataQueue		*queue;
+
+  /* streaming thread */
+  GstSegment		segment;
+  gboolean		have_segment;
+  guint32		segment_seqnum;
+  /* offset applied to the running time of the last segment */
+  GstClockTimeDiff	offset;
+};
+
+struct _GstBridgeSrcClass {
+  GstElementClass	parent_class;
+};
+
+G_GNUC_INTERNAL GType gst_bridge_src_get_type (void);
+
+G_END_DECLS
+
+#endif /* __GST_BRIDGE_SRC_H__ */
@@ -165,9 +165,40 @@ gst_capsfilter_init (GstCapsFilter * filter)
   GstBaseTransform *trans = GST_BASE_TRANSFORM (filter);
   gst_base_transform_set_gap_aware (trans, TRUE);
   gst_base_transform_set_prefer_passthrough (trans, FALSE);
+  /* prepare_buf only pushes pending events, which are only queued from the
+   * sink event handler */
+  gst_base_transform_set_bypass_allowed (trans, TRUE);
   filter->filter_caps = gst_caps_new_any ();
   filter->filter_caps_used = FALSE;
   filter->caps_change_mode = DEFAULT_CAPS_CHANGE_MODE;
+  filter->pending_events = g_ptr_array_new ();
+}
+
+/* called with the object lock */
+static void
+gst_capsfilter_clear_last_caps (GstCapsFilter * filter)
+{
+  gst_caps_replace (&filter->accepted_caps, NULL);
+  gst_caps_replace (&filter->last_caps, NULL);
+  gst_caps_replace (&filter->last_filter, NULL);
+  gst_caps_replace (&filter->last_result, NULL);
+}
+
+static inline gboolean
+caps_equal (GstCaps * caps1, GstCaps * caps2)
+{
+  if (caps1 == caps2)
+    return TRUE;
+  if (caps1 == NULL || caps2 == NULL)
+    return FALSE;
+  return gst_caps_is_strictly_equal (caps1, caps2);
+}
+
+static void
+gst_capsfilter_clear_pending_events (GstCapsFilter * filter)
+{
+  g_ptr_array_foreach (filter->pending_events, (GFunc) gst_event_unref, NULL);
+  g_ptr_array_set_size (filter->pending_events, 0);
 }
 
 static void
@@ -204,6 +235,7 @@ gst_capsfilter_set_property (GObject * object, guint prop_id,
         capsfilter->previous_caps = NULL;
       }
       capsfilter->filter_caps_used = FALSE;
+      gst_capsfilter_clear_last_caps (capsfilter);
       GST_OBJECT_UNLOCK (capsfilter);
 
       gst_caps_unref (old_caps);
@@ -225,6 +257,7 @@ gst_capsfilter_set_property (GObject * object, guint prop_id,
             (GDestroyNotify) gst_caps_unref);
         capsfilter->previous_caps = NULL;
       }
+      gst_capsfilter_clear_last_caps (capsfilter);
       GST_OBJECT_UNLOCK (capsfilter);
       break;
     }
@@ -261,8 +294,12 @@ gst_capsfilter_dispose (GObject * object)
   GstCapsFilter *filter = GST_CAPS_FILTER (object);
 
   gst_caps_replace (&filter->filter_caps, NULL);
-  g_list_free_full (filter->pending_events, (GDestroyNotify) gst_event_unref);
-  filter->pending_events = NULL;
+  gst_capsfilter_clear_last_caps (filter);
+  if (filter->pending_events) {
+    gst_capsfilter_clear_pending_events (filter);
+    g_ptr_array_unref (filter->pending_events);
+    filter->pending_events = NULL;
+  }
 
   G_OBJECT_CLASS (parent_class)->dispose (object);
 }
@@ -272,13 +309,23 @@ gst_capsfilter_transform_caps (GstBaseTransform * base,
     GstPadDirection direction, GstCaps * caps, GstCaps * filter)
 {
   GstCapsFilter *capsfilter = GST_CAPS_FILTER (base);
-  GstCaps *ret, *filter_caps, *tmp;
+  GstCaps *ret, *filter_caps, *orig_caps, *tmp;
   gboolean retried = FALSE;
   GstCapsFilterCapsChangeMode caps_change_mode;
 
   GST_OBJECT_LOCK (capsfilter);
-  filter_caps = gst_caps_ref (capsfilter->filter_caps);
   capsfilter->filter_caps_used = TRUE;
+  /* upstream and downstream usually ask the same again once negotiated */
+  if (capsfilter->last_result && capsfilter->last_direction == direction
+      && caps_equal (caps, capsfilter->last_caps)
+      && caps_equal (filter, capsfilter->last_filter)) {
+    ret = gst_caps_ref (capsfilter->last_result);
+    GST_OBJECT_UNLOCK (capsfilter);
+    GST_LOG_OBJECT (capsfilter, "reusing last result %" GST_PTR_FORMAT, ret);
+    return ret;
+  }
+  orig_caps = capsfilter->filter_caps;
+  filter_caps = gst_caps_ref (orig_caps);
   caps_change_mode = capsfilter->caps_change_mode;
   GST_OBJECT_UNLOCK (capsfilter);
 
@@ -318,6 +365,17 @@ retry:
     goto retry;
   }
 
+  if (!retried) {
+    GST_OBJECT_LOCK (capsfilter);
+    if (capsfilter->filter_caps == orig_caps && !capsfilter->previous_caps) {
+      gst_caps_replace (&capsfilter->last_caps, caps);
+      gst_caps_replace (&capsfilter->last_filter, filter);
+      gst_caps_replace (&capsfilter->last_result, ret);
+      capsfilter->last_direction = direction;
+    }
+    GST_OBJECT_UNLOCK (capsfilter);
+  }
+
   gst_caps_unref (filter_caps);
 
   return ret;
@@ -332,12 +390,23 @@ gst_capsfilter_accept_caps (GstBaseTransform * base,
   gboolean ret;
 
   GST_OBJECT_LOCK (capsfilter);
-  filter_caps = gst_caps_ref (capsfilter->filter_caps);
   capsfilter->filter_caps_used = TRUE;
+  if (capsfilter->accepted_caps && caps_equal (caps, capsfilter->accepted_caps)) {
+    GST_OBJECT_UNLOCK (capsfilter);
+    GST_LOG_OBJECT (capsfilter, "accepted before");
+    return TRUE;
+  }
+  filter_caps = gst_caps_ref (capsfilter->filter_caps);
   GST_OBJECT_UNLOCK (capsfilter);
 
   ret = gst_caps_can_intersect (caps, filter_caps);
   GST_DEBUG_OBJECT (capsfilter, "can intersect: %d", ret);
+  if (ret) {
+    GST_OBJECT_LOCK (capsfilter);
+    if (capsfilter->filter_caps == filter_caps)
+      gst_caps_replace (&capsfilter->accepted_caps, caps);
+    GST_OBJECT_UNLOCK (capsfilter);
+  }
   if (!ret
       && capsfilter->caps_change_mode ==
       GST_CAPS_FILTER_CAPS_CHANGE_MODE_DELAYED) {
@@ -370,18 +439,21 @@ gst_capsfilter_transform_ip (GstBaseTransform * base, GstBuffer * buf)
   return GST_FLOW_OK;
 }
 
+/* the array keeps its storage, no allocations once it has grown */
 static void
-gst_capsfilter_push_pending_events (GstCapsFilter * filter, GList * events)
+gst_capsfilter_push_pending_events (GstCapsFilter * filter)
 {
-  GList *l;
+  GPtrArray *events = filter->pending_events;
+  guint i;
 
-  for (l = g_list_last (events); l; l = l->prev) {
-    GST_LOG_OBJECT (filter, "Forwarding %s event",
-        GST_EVENT_TYPE_NAME (l->data));
+  for (i = 0; i < events->len; i++) {
+    GstEvent *event = g_ptr_array_index (events, i);
+
+    GST_LOG_OBJECT (filter, "Forwarding %s event", GST_EVENT_TYPE_NAME (event));
     GST_BASE_TRANSFORM_CLASS (parent_class)->sink_event (GST_BASE_TRANSFORM_CAST
-        (filter), l->data);
+        (filter), event);
   }
-  g_list_free (events);
+  g_ptr_array_set_size (events, 0);
 }
 
 /* Ouput buffer preparation ... if the buffer has no caps, and our allowed
@@ -408,12 +480,9 @@ gst_capsfilter_prepare_buf (GstBaseTransform * trans, GstBuffer * input,
 
     /* No caps. See if the output pad only supports fixed caps */
     GstCaps *out_caps;
-    GList *pending_events = filter->pending_events;
 
     GST_LOG_OBJECT (trans, "Input pad does not have caps");
 
-    filter->pending_events = NULL;
-
     out_caps = gst_pad_get_current_caps (trans->srcpad);
     if (out_caps == NULL) {
       out_caps = gst_pad_get_allowed_caps (trans->srcpad);
@@ -428,19 +497,15 @@ gst_capsfilter_prepare_buf (GstBaseTransform * trans, GstBuffer * input,
 
       if (!gst_pad_has_current_caps (trans->srcpad)) {
         if (gst_pad_set_caps (trans->srcpad, out_caps)) {
-          if (pending_events) {
-            gst_capsfilter_push_pending_events (filter, pending_events);
-            pending_events = NULL;
-          }
+          gst_capsfilter_push_pending_events (filter);
         } else {
           ret = GST_FLOW_NOT_NEGOTIATED;
         }
       } else {
-        gst_capsfilter_push_pending_events (filter, pending_events);
-        pending_events = NULL;
+        gst_capsfilter_push_pending_events (filter);
       }
 
-      g_list_free_full (pending_events, (GDestroyNotify) gst_event_unref);
+      gst_capsfilter_clear_pending_events (filter);
       gst_caps_unref (out_caps);
     } else {
       gchar *caps_str = gst_caps_to_string (out_caps);
@@ -454,17 +519,13 @@ gst_capsfilter_prepare_buf (GstBaseTransform * trans, GstBuffer * input,
           ("Output caps are unfixed: %s", caps_str));
 
       g_free (caps_str);
-      g_list_free_full (pending_events, (GDestroyNotify) gst_event_unref);
+      gst_capsfilter_clear_pending_events (filter);
 
       ret = GST_FLOW_ERROR;
     }
-  } else if (G_UNLIKELY (filter->pending_events)) {
-    GList *events = filter->pending_events;
-
-    filter->pending_events = NULL;
-
+  } else if (G_UNLIKELY (filter->pending_events->len)) {
     /* push pending events before a buffer */
-    gst_capsfilter_push_pending_events (filter, events);
+    gst_capsfilter_push_pending_events (filter);
   }
 
   return ret;
@@ -478,13 +539,17 @@ gst_capsfilter_sink_event (GstBaseTransform * trans, GstEvent * event)
   gboolean ret;
 
   if (GST_EVENT_TYPE (event) == GST_EVENT_FLUSH_STOP) {
-    GList *l;
+    GPtrArray *events = filter->pending_events;
+    guint i;
 
-    for (l = filter->pending_events; l; l = l->next) {
-      if (GST_EVENT_TYPE (l->data) == GST_EVENT_SEGMENT ||
-          GST_EVENT_TYPE (l->data) == GST_EVENT_EOS) {
-        gst_event_unref (l->data);
-        filter->pending_events = g_list_delete_link (filter->pending_events, l);
+    /* newest first */
+    for (i = events->len; i > 0; i--) {
+      GstEvent *pending = g_ptr_array_index (events, i - 1);
+
+      if (GST_EVENT_TYPE (pending) == GST_EVENT_SEGMENT ||
+          GST_EVENT_TYPE (pending) == GST_EVENT_EOS) {
+        gst_event_unref (pending);
+        g_ptr_array_remove_index (events, i - 1);
         break;
       }
     }
@@ -496,20 +561,12 @@ gst_capsfilter_sink_event (GstBaseTransform * trans, GstEvent * event)
 
   /* If we get EOS before any buffers, just push all pending events */
   if (GST_EVENT_TYPE (event) == GST_EVENT_EOS) {
-    GList *l;
-
-    for (l = g_list_last (filter->pending_events); l; l = l->prev) {
-      GST_LOG_OBJECT (trans, "Forwarding %s event",
-          GST_EVENT_TYPE_NAME (l->data));
-      GST_BASE_TRANSFORM_CLASS (parent_class)->sink_event (trans, l->data);
-    }
-    g_list_free (filter->pending_events);
-    filter->pending_events = NULL;
+    gst_capsfilter_push_pending_events (filter);
   } else if (!gst_pad_has_current_caps (trans->sinkpad)) {
     GST_LOG_OBJECT (trans, "Got %s event before caps, queueing",
         GST_EVENT_TYPE_NAME (event));
 
-    filter->pending_events = g_list_prepend (filter->pending_events, event);
+    g_ptr_array_add (filter->pending_events, event);
 
     return TRUE;
   }
@@ -558,12 +615,12 @@ gst_capsfilter_stop (GstBaseTransform * trans)
 {
   GstCapsFilter *filter = GST_CAPS_FILTER (trans);
 
-  g_list_free_full (filter->pending_events, (GDestroyNotify) gst_event_unref);
-  filter->pending_events = NULL;
+  gst_capsfilter_clear_pending_events (filter);
 
   GST_OBJECT_LOCK (filter);
   g_list_free_full (filter->previous_caps, (GDestroyNotify) gst_caps_unref);
   filter->previous_caps = NULL;
+  gst_capsfilter_clear_last_caps (filter);
   GST_OBJECT_UNLOCK (filter);
 
   return TRUE;
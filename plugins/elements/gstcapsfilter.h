@@ -68,8 +68,15 @@ struct _GstCapsFilter {
   gboolean filter_caps_used;
   GstCapsFilterCapsChangeMode caps_change_mode;
 
-  GList *pending_events;
+  GPtrArray *pending_events;
   GList *previous_caps;
+
+  /* last results, only valid for the current filter_caps */
+  GstCaps *accepted_caps;
+  GstCaps *last_caps;
+  GstCaps *last_filter;
+  GstCaps *last_result;
+  GstPadDirection last_direction;
 };
 
 struct _GstCapsFilterClass {
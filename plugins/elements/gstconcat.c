@@ -37,6 +37,12 @@
  * another downstream element like a streamsynchronizer adjusts the base
  * values on its own). The adjust-base property can be used for this purpose.
  *
+ * With the max-prebuffer-buffers and max-prebuffer-time properties, the
+ * streams after the current one don't block right away. Their buffers and
+ * serialized events are kept until one of the limits is reached, and sent
+ * the moment the stream becomes the current one, to avoid gaps caused by
+ * the next stream starting late.
+ *
  * <refsect2>
  * <title>Example launch line</title>
  * |[
@@ -74,6 +80,13 @@ struct _GstConcatPad
 
   /* Protected by the concat lock */
   gboolean flushing;
+
+  /* buffers and serialized events kept while not the current pad */
+  GQueue queue;
+  guint queued_buffers;
+  guint64 queued_time;
+  /* a thread is pushing the queue */
+  gboolean draining;
 };
 
 struct _GstConcatPadClass
@@ -83,9 +96,32 @@ struct _GstConcatPadClass
 
 G_DEFINE_TYPE (GstConcatPad, gst_concat_pad, GST_TYPE_PAD);
 
+/* must be called with concat lock */
+static void
+gst_concat_pad_clear_queue (GstConcatPad * spad)
+{
+  GstMiniObject *obj;
+
+  while ((obj = g_queue_pop_head (&spad->queue)))
+    gst_mini_object_unref (obj);
+  spad->queued_buffers = 0;
+  spad->queued_time = 0;
+}
+
+static void
+gst_concat_pad_finalize (GObject * object)
+{
+  gst_concat_pad_clear_queue (GST_CONCAT_PAD_CAST (object));
+
+  G_OBJECT_CLASS (gst_concat_pad_parent_class)->finalize (object);
+}
+
 static void
 gst_concat_pad_class_init (GstConcatPadClass * klass)
 {
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+  gobject_class->finalize = gst_concat_pad_finalize;
 }
 
 static void
@@ -93,6 +129,7 @@ gst_concat_pad_init (GstConcatPad * self)
 {
   gst_segment_init (&self->segment, GST_FORMAT_UNDEFINED);
   self->flushing = FALSE;
+  g_queue_init (&self->queue);
 }
 
 static GstStaticPadTemplate sink_template = GST_STATIC_PAD_TEMPLATE ("sink_%u",
@@ -109,10 +146,14 @@ enum
 {
   PROP_0,
   PROP_ACTIVE_PAD,
-  PROP_ADJUST_BASE
+  PROP_ADJUST_BASE,
+  PROP_MAX_PREBUFFER_BUFFERS,
+  PROP_MAX_PREBUFFER_TIME
 };
 
 #define DEFAULT_ADJUST_BASE TRUE
+#define DEFAULT_MAX_PREBUFFER_BUFFERS 0
+#define DEFAULT_MAX_PREBUFFER_TIME 0
 
 #define _do_init \
   GST_DEBUG_CATEGORY_INIT (gst_concat_debug, "concat", 0, "concat element");
@@ -145,6 +186,11 @@ static gboolean gst_concat_src_query (GstPad * pad, GstObject * parent,
     GstQuery * query);
 
 static gboolean gst_concat_switch_pad (GstConcat * self);
+static GstFlowReturn gst_concat_push_buffer (GstConcat * self,
+    GstConcatPad * spad, GstBuffer * buffer);
+static gboolean gst_concat_push_event (GstConcat * self, GstConcatPad * spad,
+    GstEvent * event);
+static void gst_concat_drain_current (GstConcat * self);
 
 static void gst_concat_notify_active_pad (GstConcat * self);
 
@@ -172,6 +218,38 @@ gst_concat_class_init (GstConcatClass * klass)
           "Adjust the base value of segments to ensure they are adjacent",
           DEFAULT_ADJUST_BASE, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstConcat:max-prebuffer-buffers:
+   *
+   * Maximum number of buffers kept for each of the next streams while
+   * they are not active yet (0 = unlimited). Prebuffering is disabled when
+   * both this and #GstConcat:max-prebuffer-time are 0.
+   *
+   * Since: 1.10
+   */
+  g_object_class_install_property (gobject_class, PROP_MAX_PREBUFFER_BUFFERS,
+      g_param_spec_uint ("max-prebuffer-buffers", "Max prebuffer buffers",
+          "Max. number of buffers to keep for the next streams before they "
+          "become active (0 = unlimited)", 0, G_MAXUINT,
+          DEFAULT_MAX_PREBUFFER_BUFFERS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstConcat:max-prebuffer-time:
+   *
+   * Maximum duration of the buffers kept for each of the next streams while
+   * they are not active yet (0 = unlimited). Prebuffering is disabled when
+   * both this and #GstConcat:max-prebuffer-buffers are 0.
+   *
+   * Since: 1.10
+   */
+  g_object_class_install_property (gobject_class, PROP_MAX_PREBUFFER_TIME,
+      g_param_spec_uint64 ("max-prebuffer-time", "Max prebuffer time",
+          "Max. duration of the buffers to keep for the next streams before "
+          "they become active (0 = unlimited)", 0, G_MAXUINT64,
+          DEFAULT_MAX_PREBUFFER_TIME,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gst_element_class_set_static_metadata (gstelement_class,
       "Concat", "Generic", "Concatenate multiple streams",
       "Sebastian Dröge <sebastian@centricular.com>");
@@ -201,6 +279,8 @@ gst_concat_init (GstConcat * self)
   gst_element_add_pad (GST_ELEMENT (self), self->srcpad);
 
   self->adjust_base = DEFAULT_ADJUST_BASE;
+  self->max_prebuffer_buffers = DEFAULT_MAX_PREBUFFER_BUFFERS;
+  self->max_prebuffer_time = DEFAULT_MAX_PREBUFFER_TIME;
 }
 
 static void
@@ -254,6 +334,18 @@ gst_concat_get_property (GObject * object, guint prop_id, GValue * value,
       g_mutex_unlock (&self->lock);
       break;
     }
+    case PROP_MAX_PREBUFFER_BUFFERS:{
+      g_mutex_lock (&self->lock);
+      g_value_set_uint (value, self->max_prebuffer_buffers);
+      g_mutex_unlock (&self->lock);
+      break;
+    }
+    case PROP_MAX_PREBUFFER_TIME:{
+      g_mutex_lock (&self->lock);
+      g_value_set_uint64 (value, self->max_prebuffer_time);
+      g_mutex_unlock (&self->lock);
+      break;
+    }
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -273,6 +365,20 @@ gst_concat_set_property (GObject * object, guint prop_id, const GValue * value,
       g_mutex_unlock (&self->lock);
       break;
     }
+    case PROP_MAX_PREBUFFER_BUFFERS:{
+      g_mutex_lock (&self->lock);
+      self->max_prebuffer_buffers = g_value_get_uint (value);
+      g_cond_broadcast (&self->cond);
+      g_mutex_unlock (&self->lock);
+      break;
+    }
+    case PROP_MAX_PREBUFFER_TIME:{
+      g_mutex_lock (&self->lock);
+      self->max_prebuffer_time = g_value_get_uint64 (value);
+      g_cond_broadcast (&self->cond);
+      g_mutex_unlock (&self->lock);
+      break;
+    }
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -341,6 +447,7 @@ gst_concat_release_pad (GstElement * element, GstPad * pad)
 
   g_mutex_lock (&self->lock);
   spad->flushing = TRUE;
+  gst_concat_pad_clear_queue (spad);
   g_cond_broadcast (&self->cond);
   g_mutex_unlock (&self->lock);
 
@@ -370,9 +477,11 @@ gst_concat_release_pad (GstElement * element, GstPad * pad)
     gst_concat_notify_active_pad (self);
 
   if (GST_STATE (self) > GST_STATE_READY) {
-    if (current_pad_removed && !eos)
+    if (current_pad_removed && !eos) {
       gst_element_post_message (GST_ELEMENT_CAST (self),
           gst_message_new_duration_changed (GST_OBJECT_CAST (self)));
+      gst_concat_drain_current (self);
+    }
 
     /* FIXME: Sending EOS from application thread */
     if (eos)
@@ -380,31 +489,127 @@ gst_concat_release_pad (GstElement * element, GstPad * pad)
   }
 }
 
+/* must be called with concat lock */
+static gboolean
+gst_concat_pad_can_queue (GstConcat * self, GstConcatPad * spad,
+    GstMiniObject * obj)
+{
+  if (self->max_prebuffer_buffers == 0 && self->max_prebuffer_time == 0)
+    return FALSE;
+  /* only buffers count against the limits */
+  if (GST_IS_EVENT (obj))
+    return TRUE;
+  if (self->max_prebuffer_buffers != 0 &&
+      spad->queued_buffers >= self->max_prebuffer_buffers)
+    return FALSE;
+  if (self->max_prebuffer_time != 0 &&
+      spad->queued_time >= self->max_prebuffer_time)
+    return FALSE;
+
+  return TRUE;
+}
+
+/* Push everything @spad queued before it became the current sinkpad. Must
+ * be called with concat lock, which is released while pushing. Only one
+ * thread drains a pad at a time, the pad's streaming thread waits for the
+ * queue to be empty before pushing anything new. */
+static void
+gst_concat_pad_drain_unlocked (GstConcat * self, GstConcatPad * spad)
+{
+  GstMiniObject *obj;
+
+  spad->draining = TRUE;
+  while (!spad->flushing && (obj = g_queue_pop_head (&spad->queue))) {
+    if (GST_IS_BUFFER (obj)) {
+      GstBuffer *buffer = GST_BUFFER_CAST (obj);
+
+      spad->queued_buffers--;
+      if (GST_BUFFER_DURATION_IS_VALID (buffer))
+        spad->queued_time -= MIN (spad->queued_time,
+            GST_BUFFER_DURATION (buffer));
+      g_mutex_unlock (&self->lock);
+
+      GST_LOG_OBJECT (spad, "pushing queued buffer %p", buffer);
+      gst_concat_push_buffer (self, spad, buffer);
+    } else {
+      g_mutex_unlock (&self->lock);
+
+      GST_LOG_OBJECT (spad, "pushing queued event %" GST_PTR_FORMAT, obj);
+      gst_concat_push_event (self, spad, GST_EVENT_CAST (obj));
+    }
+    g_mutex_lock (&self->lock);
+  }
+  spad->draining = FALSE;
+  g_cond_broadcast (&self->cond);
+}
+
+/* push what the new current sinkpad queued, right after switching to it
+ * from another thread */
+static void
+gst_concat_drain_current (GstConcat * self)
+{
+  GstConcatPad *spad;
+
+  g_mutex_lock (&self->lock);
+  if ((spad = GST_CONCAT_PAD_CAST (self->current_sinkpad))) {
+    gst_object_ref (spad);
+    if (!spad->draining && !g_queue_is_empty (&spad->queue))
+      gst_concat_pad_drain_unlocked (self, spad);
+    gst_object_unref (spad);
+  }
+  g_mutex_unlock (&self->lock);
+}
+
 /* Returns FALSE if flushing
  * Must be called from the pad's streaming thread
+ *
+ * If @obj is given and @spad is not the current sinkpad, @obj is queued
+ * if there is room for it, in which case @queued is set to TRUE and it
+ * takes ownership of @obj.
  */
 static gboolean
-gst_concat_pad_wait (GstConcatPad * spad, GstConcat * self)
+gst_concat_pad_wait_or_queue (GstConcatPad * spad, GstConcat * self,
+    GstMiniObject * obj, gboolean * queued)
 {
-  g_mutex_lock (&self->lock);
-  if (spad->flushing) {
-    g_mutex_unlock (&self->lock);
-    GST_DEBUG_OBJECT (spad, "Flushing");
-    return FALSE;
-  }
+  *queued = FALSE;
 
-  while (spad != GST_CONCAT_PAD_CAST (self->current_sinkpad)) {
-    GST_TRACE_OBJECT (spad, "Not the current sinkpad - waiting");
-    g_cond_wait (&self->cond, &self->lock);
+  g_mutex_lock (&self->lock);
+  while (TRUE) {
     if (spad->flushing) {
       g_mutex_unlock (&self->lock);
       GST_DEBUG_OBJECT (spad, "Flushing");
       return FALSE;
     }
+
+    if (spad == GST_CONCAT_PAD_CAST (self->current_sinkpad)) {
+      /* the queued data needs to go first */
+      if (g_queue_is_empty (&spad->queue) && !spad->draining)
+        break;
+      if (!spad->draining) {
+        gst_concat_pad_drain_unlocked (self, spad);
+        continue;
+      }
+    } else if (obj && gst_concat_pad_can_queue (self, spad, obj)) {
+      GST_TRACE_OBJECT (spad, "Not the current sinkpad - queueing %"
+          GST_PTR_FORMAT, obj);
+      if (GST_IS_BUFFER (obj)) {
+        spad->queued_buffers++;
+        if (GST_BUFFER_DURATION_IS_VALID (obj))
+          spad->queued_time += GST_BUFFER_DURATION (obj);
+      }
+      g_queue_push_tail (&spad->queue, obj);
+      *queued = TRUE;
+      g_mutex_unlock (&self->lock);
+      return TRUE;
+    }
+
+    GST_TRACE_OBJECT (spad, "Not the current sinkpad - waiting");
+    g_cond_wait (&self->cond, &self->lock);
   }
   /* This pad can only become not the current sinkpad from
    * a) This streaming thread (we hold the stream lock)
    * b) Releasing the pad (takes the stream lock, see above)
+   * c) Another thread draining our queue, which we waited for
    *
    * Unlocking here is thus safe and we can safely push
    * serialized data to our srcpad
@@ -415,17 +620,20 @@ gst_concat_pad_wait (GstConcatPad * spad, GstConcat * self)
   return TRUE;
 }
 
-static GstFlowReturn
-gst_concat_sink_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+static gboolean
+gst_concat_pad_wait (GstConcatPad * spad, GstConcat * self)
 {
-  GstFlowReturn ret;
-  GstConcat *self = GST_CONCAT (parent);
-  GstConcatPad *spad = GST_CONCAT_PAD (pad);
+  gboolean queued;
 
-  GST_LOG_OBJECT (pad, "received buffer %p", buffer);
+  return gst_concat_pad_wait_or_queue (spad, self, NULL, &queued);
+}
 
-  if (!gst_concat_pad_wait (spad, self))
-    return GST_FLOW_FLUSHING;
+/* must be called when @spad is the current sinkpad */
+static GstFlowReturn
+gst_concat_push_buffer (GstConcat * self, GstConcatPad * spad,
+    GstBuffer * buffer)
+{
+  GstFlowReturn ret;
 
   if (self->last_stop == GST_CLOCK_TIME_NONE)
     self->last_stop = spad->segment.start;
@@ -447,11 +655,32 @@ gst_concat_sink_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
 
   ret = gst_pad_push (self->srcpad, buffer);
 
-  GST_LOG_OBJECT (pad, "handled buffer %s", gst_flow_get_name (ret));
+  GST_LOG_OBJECT (spad, "handled buffer %s", gst_flow_get_name (ret));
 
   return ret;
 }
 
+static GstFlowReturn
+gst_concat_sink_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+{
+  GstConcat *self = GST_CONCAT (parent);
+  GstConcatPad *spad = GST_CONCAT_PAD (pad);
+  gboolean queued;
+
+  GST_LOG_OBJECT (pad, "received buffer %p", buffer);
+
+  if (!gst_concat_pad_wait_or_queue (spad, self, GST_MINI_OBJECT_CAST (buffer),
+          &queued)) {
+    gst_buffer_unref (buffer);
+    return GST_FLOW_FLUSHING;
+  }
+
+  if (queued)
+    return GST_FLOW_OK;
+
+  return gst_concat_push_buffer (self, spad, buffer);
+}
+
 /* Returns FALSE if no further pad, must be called with concat lock */
 static gboolean
 gst_concat_switch_pad (GstConcat * self)
@@ -507,26 +736,16 @@ gst_concat_notify_active_pad (GstConcat * self)
   g_object_notify_by_pspec ((GObject *) self, pspec_active_pad);
 }
 
+/* handle a serialized event, must be called when @spad is the current
+ * sinkpad */
 static gboolean
-gst_concat_sink_event (GstPad * pad, GstObject * parent, GstEvent * event)
+gst_concat_push_event (GstConcat * self, GstConcatPad * spad, GstEvent * event)
 {
-  GstConcat *self = GST_CONCAT (parent);
-  GstConcatPad *spad = GST_CONCAT_PAD_CAST (pad);
   gboolean ret = TRUE;
 
-  GST_LOG_OBJECT (pad, "received event %" GST_PTR_FORMAT, event);
-
   switch (GST_EVENT_TYPE (event)) {
-    case GST_EVENT_STREAM_START:{
-      if (!gst_concat_pad_wait (spad, self)) {
-        ret = FALSE;
-        gst_event_unref (event);
-      } else {
-        ret = gst_pad_event_default (pad, parent, event);
-      }
-      break;
-    }
     case GST_EVENT_SEGMENT:{
+      GstSegment segment;
       gboolean adjust_base;
 
       /* Drop segment event, we create our own one */
@@ -535,75 +754,111 @@ gst_concat_sink_event (GstPad * pad, GstObject * parent, GstEvent * event)
 
       g_mutex_lock (&self->lock);
       adjust_base = self->adjust_base;
+      g_mutex_unlock (&self->lock);
+
+      segment = spad->segment;
+      if (adjust_base) {
+        /* We know no duration */
+        segment.duration = -1;
+
+        /* Update segment values to be continous with last stream */
+        if (self->format == GST_FORMAT_TIME) {
+          segment.base += self->current_start_offset;
+        } else {
+          /* Shift start/stop byte position */
+          segment.start += self->current_start_offset;
+          if (segment.stop != -1)
+            segment.stop += self->current_start_offset;
+        }
+      }
+
+      gst_pad_push_event (self->srcpad, gst_event_new_segment (&segment));
+      break;
+    }
+    case GST_EVENT_EOS:{
+      gboolean next;
+
+      gst_event_unref (event);
+
+      g_mutex_lock (&self->lock);
+      next = gst_concat_switch_pad (self);
+      g_mutex_unlock (&self->lock);
+
+      gst_concat_notify_active_pad (self);
+
+      if (!next) {
+        gst_pad_push_event (self->srcpad, gst_event_new_eos ());
+      } else {
+        gst_element_post_message (GST_ELEMENT_CAST (self),
+            gst_message_new_duration_changed (GST_OBJECT_CAST (self)));
+        /* the next pad might have prebuffered, send that right away */
+        gst_concat_drain_current (self);
+      }
+      break;
+    }
+    default:
+      ret = gst_pad_event_default (GST_PAD_CAST (spad), GST_OBJECT_CAST (self),
+          event);
+      break;
+  }
+
+  return ret;
+}
+
+static gboolean
+gst_concat_sink_event (GstPad * pad, GstObject * parent, GstEvent * event)
+{
+  GstConcat *self = GST_CONCAT (parent);
+  GstConcatPad *spad = GST_CONCAT_PAD_CAST (pad);
+  gboolean ret = TRUE;
+
+  GST_LOG_OBJECT (pad, "received event %" GST_PTR_FORMAT, event);
+
+  switch (GST_EVENT_TYPE (event)) {
+    case GST_EVENT_SEGMENT:{
+      GstSegment segment;
+
+      gst_event_copy_segment (event, &segment);
+
+      g_mutex_lock (&self->lock);
       if (self->format == GST_FORMAT_UNDEFINED) {
-        if (spad->segment.format != GST_FORMAT_TIME
-            && spad->segment.format != GST_FORMAT_BYTES) {
+        if (segment.format != GST_FORMAT_TIME
+            && segment.format != GST_FORMAT_BYTES) {
           g_mutex_unlock (&self->lock);
           GST_ELEMENT_ERROR (self, CORE, FAILED, (NULL),
               ("Can only operate in TIME or BYTES format"));
+          gst_event_unref (event);
           ret = FALSE;
           break;
         }
-        self->format = spad->segment.format;
+        self->format = segment.format;
         GST_DEBUG_OBJECT (self, "Operating in %s format",
             gst_format_get_name (self->format));
         g_mutex_unlock (&self->lock);
-      } else if (self->format != spad->segment.format) {
+      } else if (self->format != segment.format) {
         g_mutex_unlock (&self->lock);
         GST_ELEMENT_ERROR (self, CORE, FAILED, (NULL),
             ("Operating in %s format but new pad has %s",
                 gst_format_get_name (self->format),
-                gst_format_get_name (spad->segment.format)));
+                gst_format_get_name (segment.format)));
+        gst_event_unref (event);
         ret = FALSE;
+        break;
       } else {
         g_mutex_unlock (&self->lock);
       }
-
-      if (!gst_concat_pad_wait (spad, self)) {
-        ret = FALSE;
-      } else {
-        GstSegment segment = spad->segment;
-
-        if (adjust_base) {
-          /* We know no duration */
-          segment.duration = -1;
-
-          /* Update segment values to be continous with last stream */
-          if (self->format == GST_FORMAT_TIME) {
-            segment.base += self->current_start_offset;
-          } else {
-            /* Shift start/stop byte position */
-            segment.start += self->current_start_offset;
-            if (segment.stop != -1)
-              segment.stop += self->current_start_offset;
-          }
-        }
-
-        gst_pad_push_event (self->srcpad, gst_event_new_segment (&segment));
-      }
-      break;
     }
+      /* fall through */
+    case GST_EVENT_STREAM_START:
     case GST_EVENT_EOS:{
-      gst_event_unref (event);
+      gboolean queued;
 
-      if (!gst_concat_pad_wait (spad, self)) {
+      if (!gst_concat_pad_wait_or_queue (spad, self,
+              GST_MINI_OBJECT_CAST (event), &queued)) {
+        gst_event_unref (event);
         ret = FALSE;
-      } else {
-        gboolean next;
-
-        g_mutex_lock (&self->lock);
-        next = gst_concat_switch_pad (self);
-        g_mutex_unlock (&self->lock);
-        ret = TRUE;
-
-        gst_concat_notify_active_pad (self);
-
-        if (!next) {
-          gst_pad_push_event (self->srcpad, gst_event_new_eos ());
-        } else {
-          gst_element_post_message (GST_ELEMENT_CAST (self),
-              gst_message_new_duration_changed (GST_OBJECT_CAST (self)));
-        }
+      } else if (!queued) {
+        ret = gst_concat_push_event (self, spad, event);
       }
       break;
     }
@@ -612,6 +867,7 @@ gst_concat_sink_event (GstPad * pad, GstObject * parent, GstEvent * event)
 
       g_mutex_lock (&self->lock);
       spad->flushing = TRUE;
+      gst_concat_pad_clear_queue (spad);
       g_cond_broadcast (&self->cond);
       forward = (self->current_sinkpad == GST_PAD_CAST (spad));
       g_mutex_unlock (&self->lock);
@@ -648,11 +904,15 @@ gst_concat_sink_event (GstPad * pad, GstObject * parent, GstEvent * event)
       break;
     }
     default:{
+      gboolean queued = FALSE;
+
       /* Wait for other serialized events before forwarding */
-      if (GST_EVENT_IS_SERIALIZED (event) && !gst_concat_pad_wait (spad, self)) {
+      if (GST_EVENT_IS_SERIALIZED (event)
+          && !gst_concat_pad_wait_or_queue (spad, self,
+              GST_MINI_OBJECT_CAST (event), &queued)) {
         gst_event_unref (event);
         ret = FALSE;
-      } else {
+      } else if (!queued) {
         ret = gst_pad_event_default (pad, parent, event);
       }
       break;
@@ -672,6 +932,22 @@ gst_concat_sink_query (GstPad * pad, GstObject * parent, GstQuery * query)
   GST_LOG_OBJECT (pad, "received query %" GST_PTR_FORMAT, query);
 
   switch (GST_QUERY_TYPE (query)) {
+    case GST_QUERY_ALLOCATION:{
+      gboolean prebuffer;
+
+      /* don't keep the next streams from prebuffering, let them
+       * negotiate an allocator right away */
+      g_mutex_lock (&self->lock);
+      prebuffer = self->max_prebuffer_buffers != 0
+          || self->max_prebuffer_time != 0;
+      g_mutex_unlock (&self->lock);
+
+      if (!prebuffer && !gst_concat_pad_wait (spad, self))
+        ret = FALSE;
+      else
+        ret = gst_pad_query_default (pad, parent, query);
+      break;
+    }
     default:
       /* Wait for other serialized queries before forwarding */
       if (GST_QUERY_IS_SERIALIZED (query) && !gst_concat_pad_wait (spad, self)) {
@@ -783,6 +1059,7 @@ unblock_pad (const GValue * data, gpointer user_data)
   GstConcatPad *spad = GST_CONCAT_PAD_CAST (pad);
 
   spad->flushing = TRUE;
+  gst_concat_pad_clear_queue (spad);
 }
 
 static GstStateChangeReturn
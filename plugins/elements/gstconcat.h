@@ -61,6 +61,11 @@ struct _GstConcat
   guint64 last_stop;
 
   gboolean adjust_base;
+
+  /* How much the next pads may queue while they are not active yet,
+   * 0 is unlimited, both 0 disables prebuffering */
+  guint max_prebuffer_buffers;
+  guint64 max_prebuffer_time;
 };
 
 struct _GstConcatClass
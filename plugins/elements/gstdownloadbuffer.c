@@ -51,6 +51,16 @@
  *   </para>
  * </listitem>
  * </itemizedlist>
+ *
+ * When cache-directory is set, the data is stored in a file in that
+ * directory named after the URI of the upstream element, together with an
+ * index of the byte ranges that were downloaded. The next time the same
+ * URI is played, the index is reloaded and only the missing ranges are
+ * fetched from upstream. The cached data is discarded when upstream reports
+ * a different size or ETag than the one recorded in the index. With
+ * cache-max-size, the least recently used entries are removed from the
+ * directory when the element is stopped. The temp-template is only used
+ * when upstream does not report a URI.
  */
 
 #ifdef HAVE_CONFIG_H
@@ -74,9 +84,7 @@
 #include <unistd.h>
 #endif
 
-#ifdef __BIONIC__
 #include <fcntl.h>
-#endif
 
 static GstStaticPadTemplate sinktemplate = GST_STATIC_PAD_TEMPLATE ("sink",
     GST_PAD_SINK,
@@ -105,6 +113,10 @@ enum
 #define DEFAULT_LOW_PERCENT        10
 #define DEFAULT_HIGH_PERCENT       99
 #define DEFAULT_TEMP_REMOVE        TRUE
+#define DEFAULT_CACHE_DIRECTORY    NULL
+#define DEFAULT_CACHE_MAX_SIZE     0
+
+#define CACHE_INDEX_GROUP          "GstDownloadBufferCache"
 
 enum
 {
@@ -116,6 +128,8 @@ enum
   PROP_TEMP_TEMPLATE,
   PROP_TEMP_LOCATION,
   PROP_TEMP_REMOVE,
+  PROP_CACHE_DIRECTORY,
+  PROP_CACHE_MAX_SIZE,
   PROP_LAST
 };
 
@@ -268,6 +282,36 @@ gst_download_buffer_class_init (GstDownloadBufferClass * klass)
           "Remove the temp-location after use",
           DEFAULT_TEMP_REMOVE, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstDownloadBuffer:cache-directory
+   *
+   * Directory to keep downloaded data in across runs, keyed by the URI of
+   * the upstream element. When upstream does not provide a URI,
+   * temp-template is used instead.
+   *
+   * Since: 1.10
+   */
+  g_object_class_install_property (gobject_class, PROP_CACHE_DIRECTORY,
+      g_param_spec_string ("cache-directory", "Cache Directory",
+          "Directory to keep downloaded data in across runs (NULL == disabled)",
+          DEFAULT_CACHE_DIRECTORY,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstDownloadBuffer:cache-max-size
+   *
+   * Maximum size of all the entries in cache-directory. When it is
+   * exceeded, the least recently used entries are removed when the element
+   * goes to READY.
+   *
+   * Since: 1.10
+   */
+  g_object_class_install_property (gobject_class, PROP_CACHE_MAX_SIZE,
+      g_param_spec_uint64 ("cache-max-size", "Cache Max Size",
+          "Maximum size of cache-directory in bytes (0 = unlimited)",
+          0, G_MAXUINT64, DEFAULT_CACHE_MAX_SIZE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   /* set several parent class virtual functions */
   gobject_class->finalize = gst_download_buffer_finalize;
 
@@ -333,6 +377,10 @@ gst_download_buffer_init (GstDownloadBuffer * dlbuf)
   dlbuf->temp_template = NULL;
   dlbuf->temp_location = NULL;
   dlbuf->temp_remove = DEFAULT_TEMP_REMOVE;
+
+  dlbuf->cache_directory = g_strdup (DEFAULT_CACHE_DIRECTORY);
+  dlbuf->cache_max_size = DEFAULT_CACHE_MAX_SIZE;
+  dlbuf->cache_size = -1;
 }
 
 /* called only once, as opposed to dispose */
@@ -349,6 +397,7 @@ gst_download_buffer_finalize (GObject * object)
   /* temp_file path cleanup  */
   g_free (dlbuf->temp_template);
   g_free (dlbuf->temp_location);
+  g_free (dlbuf->cache_directory);
 
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
@@ -650,6 +699,19 @@ get_seek_threshold (GstDownloadBuffer * dlbuf)
   return threshold;
 }
 
+/* called with DOWNLOAD_BUFFER_MUTEX. Drops the cached ranges, the data in
+ * the file is overwritten as new data arrives */
+static void
+gst_download_buffer_discard_cache (GstDownloadBuffer * dlbuf)
+{
+  GST_INFO_OBJECT (dlbuf, "discarding cached data for %s", dlbuf->cache_uri);
+
+  gst_sparse_file_clear (dlbuf->file);
+  g_free (dlbuf->cache_etag);
+  dlbuf->cache_etag = NULL;
+  dlbuf->cache_size = -1;
+}
+
 /* called with DOWNLOAD_BUFFER_MUTEX */
 static void
 gst_download_buffer_update_upstream_size (GstDownloadBuffer * dlbuf)
@@ -660,6 +722,15 @@ gst_download_buffer_update_upstream_size (GstDownloadBuffer * dlbuf)
           &upstream_size)) {
     GST_INFO_OBJECT (dlbuf, "upstream size: %" G_GINT64_FORMAT, upstream_size);
     dlbuf->upstream_size = upstream_size;
+
+    if (dlbuf->cache_key) {
+      if (dlbuf->cache_size != -1 && dlbuf->cache_size != upstream_size) {
+        GST_INFO_OBJECT (dlbuf, "size changed from %" G_GUINT64_FORMAT,
+            dlbuf->cache_size);
+        gst_download_buffer_discard_cache (dlbuf);
+      }
+      dlbuf->cache_size = upstream_size;
+    }
   }
 }
 
@@ -857,6 +928,306 @@ read_error:
   }
 }
 
+static gchar *
+gst_download_buffer_cache_filename (GstDownloadBuffer * dlbuf,
+    const gchar * key, const gchar * suffix)
+{
+  gchar *base, *result;
+
+  base = g_strconcat (key, suffix, NULL);
+  result = g_build_filename (dlbuf->cache_directory, base, NULL);
+  g_free (base);
+
+  return result;
+}
+
+/* open the cache file for the upstream uri, returns -1 when upstream has no
+ * uri or the file could not be opened */
+static gint
+gst_download_buffer_open_cache_file (GstDownloadBuffer * dlbuf, gchar ** name)
+{
+  GstQuery *query;
+  gchar *uri = NULL, *key, *filename;
+  gint fd, flags;
+
+  query = gst_query_new_uri ();
+  if (gst_pad_peer_query (dlbuf->sinkpad, query))
+    gst_query_parse_uri (query, &uri);
+  gst_query_unref (query);
+
+  if (uri == NULL)
+    goto no_uri;
+
+  if (g_mkdir_with_parents (dlbuf->cache_directory, 0700) < 0)
+    goto mkdir_failed;
+
+  key = g_compute_checksum_for_string (G_CHECKSUM_SHA1, uri, -1);
+  filename = gst_download_buffer_cache_filename (dlbuf, key, ".data");
+
+  flags = O_RDWR | O_CREAT;
+#ifdef O_LARGEFILE
+  flags |= O_LARGEFILE;
+#endif
+#ifdef O_BINARY
+  flags |= O_BINARY;
+#endif
+  fd = g_open (filename, flags, 0600);
+  if (fd == -1)
+    goto open_failed;
+
+  GST_DEBUG_OBJECT (dlbuf, "opened cache file %s for %s", filename, uri);
+
+  dlbuf->cache_key = key;
+  dlbuf->cache_uri = uri;
+  dlbuf->cache_size = -1;
+  *name = filename;
+
+  return fd;
+
+  /* ERRORS */
+no_uri:
+  {
+    GST_DEBUG_OBJECT (dlbuf, "upstream has no uri, not caching");
+    return -1;
+  }
+mkdir_failed:
+  {
+    GST_WARNING_OBJECT (dlbuf, "could not create cache directory %s: %s",
+        dlbuf->cache_directory, g_strerror (errno));
+    g_free (uri);
+    return -1;
+  }
+open_failed:
+  {
+    GST_WARNING_OBJECT (dlbuf, "could not open cache file %s: %s", filename,
+        g_strerror (errno));
+    g_free (filename);
+    g_free (key);
+    g_free (uri);
+    return -1;
+  }
+}
+
+static void
+gst_download_buffer_clear_cache_entry (GstDownloadBuffer * dlbuf)
+{
+  g_free (dlbuf->cache_key);
+  dlbuf->cache_key = NULL;
+  g_free (dlbuf->cache_uri);
+  dlbuf->cache_uri = NULL;
+  g_free (dlbuf->cache_etag);
+  dlbuf->cache_etag = NULL;
+  dlbuf->cache_size = -1;
+}
+
+/* restore the ranges of the cache file from its index */
+static void
+gst_download_buffer_load_cache_index (GstDownloadBuffer * dlbuf,
+    const gchar * filename)
+{
+  GKeyFile *index;
+  gchar *index_name, *uri = NULL, **ranges = NULL;
+  GStatBuf st;
+  gsize i, n_ranges;
+  GError *error = NULL;
+
+  index_name =
+      gst_download_buffer_cache_filename (dlbuf, dlbuf->cache_key, ".index");
+  index = g_key_file_new ();
+
+  if (!g_key_file_load_from_file (index, index_name, G_KEY_FILE_NONE, NULL))
+    goto done;
+
+  if (g_stat (filename, &st) < 0)
+    goto done;
+
+  /* checksums could clash */
+  uri = g_key_file_get_string (index, CACHE_INDEX_GROUP, "uri", NULL);
+  if (g_strcmp0 (uri, dlbuf->cache_uri) != 0)
+    goto wrong_uri;
+
+  dlbuf->cache_etag =
+      g_key_file_get_string (index, CACHE_INDEX_GROUP, "etag", NULL);
+  dlbuf->cache_size =
+      g_key_file_get_uint64 (index, CACHE_INDEX_GROUP, "size", &error);
+  if (error) {
+    dlbuf->cache_size = -1;
+    g_clear_error (&error);
+  }
+
+  ranges = g_key_file_get_string_list (index, CACHE_INDEX_GROUP, "ranges",
+      &n_ranges, NULL);
+  for (i = 0; ranges && i < n_ranges; i++) {
+    guint64 start, stop;
+    gchar *end;
+
+    start = g_ascii_strtoull (ranges[i], &end, 10);
+    if (*end != '-')
+      continue;
+    stop = g_ascii_strtoull (end + 1, &end, 10);
+    if (*end != '\0' || start >= stop || stop > (guint64) st.st_size)
+      continue;
+
+    GST_DEBUG_OBJECT (dlbuf, "cached range %" G_GUINT64_FORMAT " - %"
+        G_GUINT64_FORMAT, start, stop);
+    gst_sparse_file_add_range (dlbuf->file, start, stop);
+  }
+  GST_INFO_OBJECT (dlbuf, "restored %u cached ranges",
+      gst_sparse_file_n_ranges (dlbuf->file));
+
+done:
+  g_strfreev (ranges);
+  g_free (uri);
+  g_key_file_free (index);
+  g_free (index_name);
+  return;
+
+  /* ERRORS */
+wrong_uri:
+  {
+    GST_WARNING_OBJECT (dlbuf, "cache index %s is for %s", index_name, uri);
+    goto done;
+  }
+}
+
+/* write the ranges of the cache file to its index */
+static void
+gst_download_buffer_save_cache_index (GstDownloadBuffer * dlbuf)
+{
+  GKeyFile *index;
+  GPtrArray *ranges;
+  gchar *index_name;
+  gsize start, stop, offset;
+  GError *error = NULL;
+
+  /* the index must not list data that never made it to the file */
+  if (!gst_sparse_file_flush (dlbuf->file, &error)) {
+    GST_WARNING_OBJECT (dlbuf, "not writing cache index: %s",
+        error->message);
+    g_clear_error (&error);
+    return;
+  }
+
+  index = g_key_file_new ();
+  g_key_file_set_string (index, CACHE_INDEX_GROUP, "uri", dlbuf->cache_uri);
+  if (dlbuf->cache_etag)
+    g_key_file_set_string (index, CACHE_INDEX_GROUP, "etag",
+        dlbuf->cache_etag);
+  if (dlbuf->cache_size != -1)
+    g_key_file_set_uint64 (index, CACHE_INDEX_GROUP, "size",
+        dlbuf->cache_size);
+
+  ranges = g_ptr_array_new_with_free_func (g_free);
+  offset = 0;
+  while (gst_sparse_file_get_range_after (dlbuf->file, offset, &start, &stop)) {
+    g_ptr_array_add (ranges, g_strdup_printf ("%" G_GSIZE_FORMAT "-%"
+            G_GSIZE_FORMAT, start, stop));
+    offset = stop;
+  }
+  g_key_file_set_string_list (index, CACHE_INDEX_GROUP, "ranges",
+      (const gchar * const *) ranges->pdata, ranges->len);
+  g_ptr_array_unref (ranges);
+
+  index_name =
+      gst_download_buffer_cache_filename (dlbuf, dlbuf->cache_key, ".index");
+  if (!g_key_file_save_to_file (index, index_name, &error)) {
+    GST_WARNING_OBJECT (dlbuf, "could not write cache index %s: %s",
+        index_name, error->message);
+    g_clear_error (&error);
+  }
+  g_free (index_name);
+  g_key_file_free (index);
+}
+
+typedef struct
+{
+  gchar *key;
+  guint64 size;
+  gint64 mtime;
+} GstDownloadBufferCacheEntry;
+
+static gint
+compare_cache_entry_mtime (gconstpointer a, gconstpointer b)
+{
+  const GstDownloadBufferCacheEntry *ea = a, *eb = b;
+
+  return (ea->mtime > eb->mtime) - (ea->mtime < eb->mtime);
+}
+
+/* remove the least recently used entries, based on the modification time of
+ * their index, until the cache directory fits in cache-max-size. The current
+ * entry is never removed. */
+static void
+gst_download_buffer_evict_cache (GstDownloadBuffer * dlbuf)
+{
+  GDir *dir;
+  GArray *entries;
+  const gchar *name;
+  guint64 total = 0;
+  guint i;
+
+  if (dlbuf->cache_max_size == 0)
+    return;
+
+  if (!(dir = g_dir_open (dlbuf->cache_directory, 0, NULL)))
+    return;
+
+  entries = g_array_new (FALSE, FALSE, sizeof (GstDownloadBufferCacheEntry));
+  while ((name = g_dir_read_name (dir))) {
+    GstDownloadBufferCacheEntry entry;
+    gchar *filename;
+    GStatBuf st;
+
+    if (!g_str_has_suffix (name, ".index"))
+      continue;
+
+    entry.key = g_strndup (name, strlen (name) - strlen (".index"));
+
+    filename = gst_download_buffer_cache_filename (dlbuf, entry.key, ".index");
+    entry.mtime = g_stat (filename, &st) == 0 ? st.st_mtime : 0;
+    g_free (filename);
+
+    filename = gst_download_buffer_cache_filename (dlbuf, entry.key, ".data");
+    entry.size = g_stat (filename, &st) == 0 ? st.st_size : 0;
+    g_free (filename);
+
+    total += entry.size;
+
+    if (strcmp (entry.key, dlbuf->cache_key) == 0)
+      g_free (entry.key);
+    else
+      g_array_append_val (entries, entry);
+  }
+  g_dir_close (dir);
+
+  g_array_sort (entries, compare_cache_entry_mtime);
+
+  for (i = 0; i < entries->len; i++) {
+    GstDownloadBufferCacheEntry *entry =
+        &g_array_index (entries, GstDownloadBufferCacheEntry, i);
+
+    if (total > dlbuf->cache_max_size) {
+      gchar *filename;
+
+      GST_DEBUG_OBJECT (dlbuf, "evicting cache entry %s of %" G_GUINT64_FORMAT
+          " bytes", entry->key, entry->size);
+
+      filename = gst_download_buffer_cache_filename (dlbuf, entry->key,
+          ".data");
+      g_remove (filename);
+      g_free (filename);
+      filename = gst_download_buffer_cache_filename (dlbuf, entry->key,
+          ".index");
+      g_remove (filename);
+      g_free (filename);
+
+      total -= entry->size;
+    }
+    g_free (entry->key);
+  }
+  g_array_free (entries, TRUE);
+}
+
 /* must be called with MUTEX_LOCK. Will briefly release the lock when notifying
  * the temp filename. */
 static gboolean
@@ -868,23 +1239,29 @@ gst_download_buffer_open_temp_location_file (GstDownloadBuffer * dlbuf)
   if (dlbuf->file)
     goto already_opened;
 
-  GST_DEBUG_OBJECT (dlbuf, "opening temp file %s", dlbuf->temp_template);
+  /* try the persistent cache first */
+  if (dlbuf->cache_directory != NULL)
+    fd = gst_download_buffer_open_cache_file (dlbuf, &name);
 
-  /* If temp_template was set, allocate a filename and open that file */
+  if (fd == -1) {
+    GST_DEBUG_OBJECT (dlbuf, "opening temp file %s", dlbuf->temp_template);
 
-  /* nothing to do */
-  if (dlbuf->temp_template == NULL)
-    goto no_directory;
+    /* If temp_template was set, allocate a filename and open that file */
+
+    /* nothing to do */
+    if (dlbuf->temp_template == NULL)
+      goto no_directory;
 
-  /* make copy of the template, we don't want to change this */
-  name = g_strdup (dlbuf->temp_template);
+    /* make copy of the template, we don't want to change this */
+    name = g_strdup (dlbuf->temp_template);
 #ifdef __BIONIC__
-  fd = g_mkstemp_full (name, O_RDWR | O_LARGEFILE, S_IRUSR | S_IWUSR);
+    fd = g_mkstemp_full (name, O_RDWR | O_LARGEFILE, S_IRUSR | S_IWUSR);
 #else
-  fd = g_mkstemp (name);
+    fd = g_mkstemp (name);
 #endif
-  if (fd == -1)
-    goto mkstemp_failed;
+    if (fd == -1)
+      goto mkstemp_failed;
+  }
 
   /* open the file for update/writing */
   dlbuf->file = gst_sparse_file_new ();
@@ -892,6 +1269,9 @@ gst_download_buffer_open_temp_location_file (GstDownloadBuffer * dlbuf)
   if (!gst_sparse_file_set_fd (dlbuf->file, fd))
     goto open_failed;
 
+  if (dlbuf->cache_key)
+    gst_download_buffer_load_cache_index (dlbuf, name);
+
   g_free (dlbuf->temp_location);
   dlbuf->temp_location = name;
   dlbuf->temp_fd = fd;
@@ -935,6 +1315,7 @@ open_failed:
     g_free (name);
     if (fd != -1)
       close (fd);
+    gst_download_buffer_clear_cache_entry (dlbuf);
     return FALSE;
   }
 }
@@ -948,7 +1329,10 @@ gst_download_buffer_close_temp_location_file (GstDownloadBuffer * dlbuf)
 
   GST_DEBUG_OBJECT (dlbuf, "closing sparse file");
 
-  if (dlbuf->temp_remove) {
+  if (dlbuf->cache_key) {
+    /* keep the file, the index tells the next run what we have */
+    gst_download_buffer_save_cache_index (dlbuf);
+  } else if (dlbuf->temp_remove) {
     if (remove (dlbuf->temp_location) < 0) {
       GST_WARNING_OBJECT (dlbuf, "Failed to remove temporary file %s: %s",
           dlbuf->temp_location, g_strerror (errno));
@@ -957,6 +1341,11 @@ gst_download_buffer_close_temp_location_file (GstDownloadBuffer * dlbuf)
   gst_sparse_file_free (dlbuf->file);
   close (dlbuf->temp_fd);
   dlbuf->file = NULL;
+
+  if (dlbuf->cache_key) {
+    gst_download_buffer_evict_cache (dlbuf);
+    gst_download_buffer_clear_cache_entry (dlbuf);
+  }
 }
 
 static void
@@ -965,11 +1354,49 @@ gst_download_buffer_flush_temp_file (GstDownloadBuffer * dlbuf)
   if (dlbuf->file == NULL)
     return;
 
+  /* the cached data stays valid for the uri */
+  if (dlbuf->cache_key)
+    return;
+
   GST_DEBUG_OBJECT (dlbuf, "flushing temp file");
 
   gst_sparse_file_clear (dlbuf->file);
 }
 
+/* called with DOWNLOAD_BUFFER_MUTEX. Checks the ETag of the resource against
+ * the one of the cached data */
+static void
+gst_download_buffer_check_http_headers (GstDownloadBuffer * dlbuf,
+    GstEvent * event)
+{
+  const GstStructure *s;
+  const GValue *value;
+  const gchar *etag;
+
+  if (dlbuf->cache_key == NULL)
+    return;
+
+  s = gst_event_get_structure (event);
+  if (s == NULL || !gst_structure_has_name (s, "http-headers"))
+    return;
+
+  value = gst_structure_get_value (s, "response-headers");
+  if (value == NULL || !GST_VALUE_HOLDS_STRUCTURE (value))
+    return;
+
+  etag = gst_structure_get_string (gst_value_get_structure (value), "ETag");
+  if (etag == NULL)
+    return;
+
+  if (dlbuf->cache_etag && strcmp (dlbuf->cache_etag, etag) != 0) {
+    GST_INFO_OBJECT (dlbuf, "ETag changed from %s to %s", dlbuf->cache_etag,
+        etag);
+    gst_download_buffer_discard_cache (dlbuf);
+  }
+  g_free (dlbuf->cache_etag);
+  dlbuf->cache_etag = g_strdup (etag);
+}
+
 static void
 gst_download_buffer_locked_flush (GstDownloadBuffer * dlbuf, gboolean full,
     gboolean clear_temp)
@@ -1078,6 +1505,9 @@ gst_download_buffer_handle_sink_event (GstPad * pad, GstObject * parent,
           case GST_EVENT_STREAM_START:
             gst_event_replace (&dlbuf->stream_start_event, event);
             break;
+          case GST_EVENT_CUSTOM_DOWNSTREAM_STICKY:
+            gst_download_buffer_check_http_headers (dlbuf, event);
+            break;
           default:
             break;
         }
@@ -1864,6 +2294,33 @@ wrong_state:
   }
 }
 
+static void
+gst_download_buffer_set_cache_directory (GstDownloadBuffer * dlbuf,
+    const gchar * directory)
+{
+  GstState state;
+
+  /* the element must be stopped in order to do this */
+  GST_OBJECT_LOCK (dlbuf);
+  state = GST_STATE (dlbuf);
+  if (state != GST_STATE_READY && state != GST_STATE_NULL)
+    goto wrong_state;
+  GST_OBJECT_UNLOCK (dlbuf);
+
+  g_free (dlbuf->cache_directory);
+  dlbuf->cache_directory = g_strdup (directory);
+
+  return;
+
+/* ERROR */
+wrong_state:
+  {
+    GST_WARNING_OBJECT (dlbuf,
+        "setting cache-directory property in wrong state");
+    GST_OBJECT_UNLOCK (dlbuf);
+  }
+}
+
 static void
 gst_download_buffer_set_property (GObject * object,
     guint prop_id, const GValue * value, GParamSpec * pspec)
@@ -1896,6 +2353,13 @@ gst_download_buffer_set_property (GObject * object,
     case PROP_TEMP_REMOVE:
       dlbuf->temp_remove = g_value_get_boolean (value);
       break;
+    case PROP_CACHE_DIRECTORY:
+      gst_download_buffer_set_cache_directory (dlbuf,
+          g_value_get_string (value));
+      break;
+    case PROP_CACHE_MAX_SIZE:
+      dlbuf->cache_max_size = g_value_get_uint64 (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -1938,6 +2402,12 @@ gst_download_buffer_get_property (GObject * object,
     case PROP_TEMP_REMOVE:
       g_value_set_boolean (value, dlbuf->temp_remove);
       break;
+    case PROP_CACHE_DIRECTORY:
+      g_value_set_string (value, dlbuf->cache_directory);
+      break;
+    case PROP_CACHE_MAX_SIZE:
+      g_value_set_uint64 (value, dlbuf->cache_max_size);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -110,6 +110,14 @@ struct _GstDownloadBuffer
   gint temp_fd;
   gboolean seeking;
 
+  /* persistent cache stuff */
+  gchar *cache_directory;
+  guint64 cache_max_size;
+  gchar *cache_key;             /* checksum of the uri, NULL when not caching */
+  gchar *cache_uri;
+  gchar *cache_etag;
+  guint64 cache_size;           /* size of the cached resource, -1 unknown */
+
   GstEvent *stream_start_event;
   GstEvent *segment_event;
 
@@ -27,6 +27,8 @@
 
 #include <gst/gst.h>
 
+#include "gstbridgesink.h"
+#include "gstbridgesrc.h"
 #include "gstcapsfilter.h"
 #include "gstconcat.h"
 #include "gstdownloadbuffer.h"
@@ -51,6 +53,12 @@
 static gboolean
 plugin_init (GstPlugin * plugin)
 {
+  if (!gst_element_register (plugin, "bridgesink", GST_RANK_NONE,
+          gst_bridge_sink_get_type ()))
+    return FALSE;
+  if (!gst_element_register (plugin, "bridgesrc", GST_RANK_NONE,
+          gst_bridge_src_get_type ()))
+    return FALSE;
   if (!gst_element_register (plugin, "capsfilter", GST_RANK_NONE,
           gst_capsfilter_get_type ()))
     return FALSE;
@@ -32,6 +32,9 @@
 #ifdef HAVE_SYS_UIO_H
 #include <sys/uio.h>
 #endif
+#ifdef HAVE_SYS_SENDFILE_H
+#include <sys/sendfile.h>
+#endif
 #include <errno.h>
 #include <string.h>
 #include <string.h>
@@ -39,6 +42,7 @@
 #include "gstelements_private.h"
 
 #ifdef G_OS_WIN32
+#  include <io.h>               /* lseek, read, dup, close */
 #  define WIN32_LEAN_AND_MEAN   /* prevents from including too many things */
 #  include <windows.h>
 #  undef WIN32_LEAN_AND_MEAN
@@ -190,6 +194,245 @@ fill_vectors (struct iovec *vecs, GstMapInfo * maps, guint n, GstBuffer * buf)
   return size;
 }
 
+/* wait until @fd can be written to when it is non-blocking */
+static GstFlowReturn
+gst_wait_writable (GstObject * sink, GstPoll * fdset, gsize left)
+{
+#ifndef HAVE_WIN32
+  gint ret;
+
+  if (fdset == NULL)
+    return GST_FLOW_OK;
+
+  do {
+    GST_DEBUG_OBJECT (sink, "going into select, have %" G_GSIZE_FORMAT
+        " bytes to write", left);
+    ret = gst_poll_wait (fdset, GST_CLOCK_TIME_NONE);
+  } while (ret == -1 && (errno == EINTR || errno == EAGAIN));
+
+  if (ret == -1) {
+    if (errno == EBUSY)
+      goto stopped;
+    else
+      goto select_error;
+  }
+#endif
+  return GST_FLOW_OK;
+
+  /* ERRORS */
+#ifndef HAVE_WIN32
+select_error:
+  {
+    GST_ELEMENT_ERROR (sink, RESOURCE, READ, (NULL),
+        ("select on file descriptor: %s", g_strerror (errno)));
+    GST_DEBUG_OBJECT (sink, "Error during select: %s", g_strerror (errno));
+    return GST_FLOW_ERROR;
+  }
+stopped:
+  {
+    GST_DEBUG_OBJECT (sink, "Select stopped");
+    return GST_FLOW_FLUSHING;
+  }
+#endif
+}
+
+static GstFlowReturn
+gst_write_error (GstObject * sink, gint fd)
+{
+  switch (errno) {
+    case ENOSPC:
+      GST_ELEMENT_ERROR (sink, RESOURCE, NO_SPACE_LEFT, (NULL), (NULL));
+      break;
+    default:{
+      GST_ELEMENT_ERROR (sink, RESOURCE, WRITE, (NULL),
+          ("Error while writing to file descriptor %d: %s",
+              fd, g_strerror (errno)));
+    }
+  }
+  return GST_FLOW_ERROR;
+}
+
+/* write out all @size bytes of @vecs */
+static GstFlowReturn
+gst_writev_vectors (GstObject * sink, gint fd, GstPoll * fdset,
+    struct iovec *vecs, guint n_vecs, gsize size, guint64 * total_written,
+    guint64 * cur_pos)
+{
+  GstFlowReturn flow_ret;
+  gssize ret, left;
+
+  left = size;
+  do {
+    if ((flow_ret = gst_wait_writable (sink, fdset, left)) != GST_FLOW_OK)
+      return flow_ret;
+
+    ret = gst_writev (fd, vecs, n_vecs, left);
+
+    if (ret > 0) {
+      if (total_written)
+        *total_written += ret;
+      if (cur_pos)
+        *cur_pos += ret;
+    }
+
+    if (ret == left)
+      break;
+
+    if (ret < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      /* do nothing, try again */
+    } else if (ret < 0) {
+      return gst_write_error (sink, fd);
+    } else if (ret < left) {
+      /* skip vectors that have been written in full */
+      while (ret >= vecs[0].iov_len) {
+        ret -= vecs[0].iov_len;
+        left -= vecs[0].iov_len;
+        ++vecs;
+        --n_vecs;
+      }
+      g_assert (n_vecs > 0);
+      /* skip partially written vector data */
+      if (ret > 0) {
+        vecs[0].iov_len -= ret;
+        vecs[0].iov_base = ((guint8 *) vecs[0].iov_base) + ret;
+        left -= ret;
+      }
+    }
+#ifdef HAVE_WIN32
+    /* do short sleep on windows where we don't use gst_poll(),
+     * to avoid excessive busy looping */
+    if (fdset != NULL)
+      g_usleep (1000);
+#endif
+
+  }
+  while (left > 0);
+
+  return GST_FLOW_OK;
+}
+
+static GstFlowReturn
+gst_write_memory (GstObject * sink, gint fd, GstPoll * fdset, GstMemory * mem,
+    guint64 * total_written, guint64 * cur_pos)
+{
+  struct iovec vec;
+  GstMapInfo map;
+  GstFlowReturn flow_ret;
+
+  if (!gst_memory_map (mem, &map, GST_MAP_READ)) {
+    GST_WARNING ("Failed to map memory %p for reading", mem);
+    return GST_FLOW_OK;
+  }
+
+  vec.iov_base = map.data;
+  vec.iov_len = map.size;
+  flow_ret = gst_writev_vectors (sink, fd, fdset, &vec, 1, map.size,
+      total_written, cur_pos);
+
+  gst_memory_unmap (mem, &map);
+
+  return flow_ret;
+}
+
+#ifdef HAVE_SYS_SENDFILE_H
+/* let the kernel copy the file region of @mem to @fd, falls back to writing
+ * the mapped memory when sendfile() does not work for these descriptors */
+static GstFlowReturn
+gst_sendfile_memory (GstObject * sink, gint fd, GstPoll * fdset,
+    GstMemory * mem, guint64 * total_written, guint64 * cur_pos)
+{
+  GstFlowReturn flow_ret;
+  guint64 offset;
+  gssize ret;
+  gsize left;
+  gint in_fd;
+
+  gst_fd_chunk_memory_get_fd (mem, &in_fd, &offset);
+
+  left = mem->size;
+  while (left > 0) {
+    off_t off = offset;
+
+    if ((flow_ret = gst_wait_writable (sink, fdset, left)) != GST_FLOW_OK)
+      return flow_ret;
+
+    ret = sendfile (fd, in_fd, &off, left);
+
+    if (ret > 0) {
+      offset += ret;
+      left -= ret;
+      if (total_written)
+        *total_written += ret;
+      if (cur_pos)
+        *cur_pos += ret;
+    } else if (ret == 0) {
+      goto truncated;
+    } else if (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK) {
+      /* try again */
+    } else if ((errno == EINVAL || errno == ENOSYS) && left == mem->size) {
+      goto not_supported;
+    } else {
+      return gst_write_error (sink, fd);
+    }
+  }
+  return GST_FLOW_OK;
+
+  /* ERRORS */
+truncated:
+  {
+    GST_ELEMENT_ERROR (sink, RESOURCE, READ, (NULL),
+        ("File was truncated while sending it"));
+    return GST_FLOW_ERROR;
+  }
+not_supported:
+  {
+    GST_DEBUG_OBJECT (sink, "sendfile not supported: %s", g_strerror (errno));
+    return gst_write_memory (sink, fd, fdset, mem, total_written, cur_pos);
+  }
+}
+
+static gboolean
+gst_buffers_have_fd_chunk_memory (GstBuffer ** buffers, guint num_buffers)
+{
+  guint i, j, n;
+
+  for (i = 0; i < num_buffers; ++i) {
+    n = gst_buffer_n_memory (buffers[i]);
+    for (j = 0; j < n; ++j) {
+      if (gst_memory_is_type (gst_buffer_peek_memory (buffers[i], j),
+              GST_FD_CHUNK_MEMORY_TYPE))
+        return TRUE;
+    }
+  }
+  return FALSE;
+}
+
+/* write the memories one by one, with sendfile() where possible */
+static GstFlowReturn
+gst_sendfile_buffers (GstObject * sink, gint fd, GstPoll * fdset,
+    GstBuffer ** buffers, guint num_buffers, guint64 * total_written,
+    guint64 * cur_pos)
+{
+  GstFlowReturn flow_ret = GST_FLOW_OK;
+  guint i, j, n;
+
+  for (i = 0; i < num_buffers && flow_ret == GST_FLOW_OK; ++i) {
+    n = gst_buffer_n_memory (buffers[i]);
+    for (j = 0; j < n && flow_ret == GST_FLOW_OK; ++j) {
+      GstMemory *mem = gst_buffer_peek_memory (buffers[i], j);
+
+      if (gst_memory_is_type (mem, GST_FD_CHUNK_MEMORY_TYPE))
+        flow_ret = gst_sendfile_memory (sink, fd, fdset, mem, total_written,
+            cur_pos);
+      else
+        flow_ret = gst_write_memory (sink, fd, fdset, mem, total_written,
+            cur_pos);
+    }
+  }
+  return flow_ret;
+}
+#endif
+
 GstFlowReturn
 gst_writev_buffers (GstObject * sink, gint fd, GstPoll * fdset,
     GstBuffer ** buffers, guint num_buffers, guint8 * mem_nums,
@@ -203,6 +446,12 @@ gst_writev_buffers (GstObject * sink, gint fd, GstPoll * fdset,
 
   GST_LOG_OBJECT (sink, "%u buffers, %u memories", num_buffers, total_mem_num);
 
+#ifdef HAVE_SYS_SENDFILE_H
+  if (gst_buffers_have_fd_chunk_memory (buffers, num_buffers))
+    return gst_sendfile_buffers (sink, fd, fdset, buffers, num_buffers,
+        total_written, cur_pos);
+#endif
+
   vecs = g_newa (struct iovec, total_mem_num);
   map_infos = g_newa (GstMapInfo, total_mem_num);
 
@@ -213,111 +462,271 @@ gst_writev_buffers (GstObject * sink, gint fd, GstPoll * fdset,
   }
 
   /* now write it all out! */
-  {
-    gssize ret, left;
-    guint n_vecs = total_mem_num;
+  flow_ret = gst_writev_vectors (sink, fd, fdset, vecs, total_mem_num, size,
+      total_written, cur_pos);
 
-    left = size;
-    do {
-#ifndef HAVE_WIN32
-      if (fdset != NULL) {
-        do {
-          GST_DEBUG_OBJECT (sink, "going into select, have %" G_GSSIZE_FORMAT
-              " bytes to write", left);
-          ret = gst_poll_wait (fdset, GST_CLOCK_TIME_NONE);
-        } while (ret == -1 && (errno == EINTR || errno == EAGAIN));
-
-        if (ret == -1) {
-          if (errno == EBUSY)
-            goto stopped;
-          else
-            goto select_error;
-        }
-      }
-#endif
+  for (i = 0; i < total_mem_num; ++i)
+    gst_memory_unmap (map_infos[i].memory, &map_infos[i]);
 
-      ret = gst_writev (fd, vecs, n_vecs, left);
+  return flow_ret;
+}
 
-      if (ret > 0) {
-        if (total_written)
-          *total_written += ret;
-        if (cur_pos)
-          *cur_pos += ret;
-      }
+/* reference to a dup of the file descriptor, the file stays open while
+ * memory pointing into it is alive */
+struct _GstFdChunkFile
+{
+  gint refcount;
+  gint fd;
+  GMutex lock;                  /* serializes reads without pread() */
+};
 
-      if (ret == left)
-        break;
-
-      if (ret < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
-        /* do nothing, try again */
-      } else if (ret < 0) {
-        goto write_error;
-      } else if (ret < left) {
-        /* skip vectors that have been written in full */
-        while (ret >= vecs[0].iov_len) {
-          ret -= vecs[0].iov_len;
-          left -= vecs[0].iov_len;
-          ++vecs;
-          --n_vecs;
-        }
-        g_assert (n_vecs > 0);
-        /* skip partially written vector data */
-        if (ret > 0) {
-          vecs[0].iov_len -= ret;
-          vecs[0].iov_base = ((guint8 *) vecs[0].iov_base) + ret;
-          left -= ret;
-        }
-      }
-#ifdef HAVE_WIN32
-      /* do short sleep on windows where we don't use gst_poll(),
-       * to avoid excessive busy looping */
-      if (fdset != NULL)
-        g_usleep (1000);
+typedef struct
+{
+  GstMemory mem;
+
+  GstFdChunkFile *file;
+  guint64 file_offset;          /* file offset of the start of maxsize */
+
+  GMutex lock;
+  gpointer data;                /* read from the file on the first map */
+} GstFdChunkMemory;
+
+typedef GstAllocator GstFdChunkAllocator;
+typedef GstAllocatorClass GstFdChunkAllocatorClass;
+
+static GType gst_fd_chunk_allocator_get_type (void);
+G_DEFINE_TYPE (GstFdChunkAllocator, gst_fd_chunk_allocator,
+    GST_TYPE_ALLOCATOR);
+
+GstFdChunkFile *
+gst_fd_chunk_file_new (gint fd)
+{
+  GstFdChunkFile *file;
+  gint dup_fd;
+
+  if ((dup_fd = dup (fd)) < 0)
+    return NULL;
+
+  file = g_slice_new (GstFdChunkFile);
+  file->refcount = 1;
+  file->fd = dup_fd;
+  g_mutex_init (&file->lock);
+
+  return file;
+}
+
+static GstFdChunkFile *
+gst_fd_chunk_file_ref (GstFdChunkFile * file)
+{
+  g_atomic_int_inc (&file->refcount);
+  return file;
+}
+
+void
+gst_fd_chunk_file_unref (GstFdChunkFile * file)
+{
+  if (g_atomic_int_dec_and_test (&file->refcount)) {
+    close (file->fd);
+    g_mutex_clear (&file->lock);
+    g_slice_free (GstFdChunkFile, file);
+  }
+}
+
+static gboolean
+gst_fd_chunk_file_read (GstFdChunkFile * file, guint8 * data, gsize size,
+    guint64 offset)
+{
+  gssize ret;
+
+  while (size > 0) {
+#ifdef G_OS_UNIX
+    ret = pread (file->fd, data, size, offset);
+#else
+    g_mutex_lock (&file->lock);
+    if (lseek (file->fd, offset, SEEK_SET) == (off_t) - 1)
+      ret = -1;
+    else
+      ret = read (file->fd, data, size);
+    g_mutex_unlock (&file->lock);
 #endif
+    if (ret < 0 && errno == EINTR)
+      continue;
+    if (ret <= 0)
+      return FALSE;
+
+    data += ret;
+    size -= ret;
+    offset += ret;
+  }
+  return TRUE;
+}
 
-    }
-    while (left > 0);
+static GstAllocator *
+gst_fd_chunk_allocator_get (void)
+{
+  static GstAllocator *allocator = NULL;
+
+  if (g_once_init_enter (&allocator)) {
+    GstAllocator *alloc;
+
+    alloc = g_object_new (gst_fd_chunk_allocator_get_type (), NULL);
+    gst_object_ref_sink (alloc);
+    g_once_init_leave (&allocator, alloc);
   }
+  return allocator;
+}
 
-  flow_ret = GST_FLOW_OK;
+static GstFdChunkMemory *
+gst_fd_chunk_memory_new_internal (GstFdChunkFile * file, GstMemory * parent,
+    guint64 offset, gsize size)
+{
+  GstFdChunkMemory *mem;
 
-out:
+  mem = g_slice_new (GstFdChunkMemory);
+  gst_memory_init (GST_MEMORY_CAST (mem), GST_MEMORY_FLAG_READONLY,
+      gst_fd_chunk_allocator_get (), parent, size, 0, 0, size);
+  mem->file = gst_fd_chunk_file_ref (file);
+  mem->file_offset = offset;
+  g_mutex_init (&mem->lock);
+  mem->data = NULL;
 
-  for (i = 0; i < total_mem_num; ++i)
-    gst_memory_unmap (map_infos[i].memory, &map_infos[i]);
+  return mem;
+}
 
-  return flow_ret;
+GstMemory *
+gst_fd_chunk_memory_new (GstFdChunkFile * file, guint64 offset, gsize size)
+{
+  g_return_val_if_fail (file != NULL, NULL);
 
-/* ERRORS */
-#ifndef HAVE_WIN32
-select_error:
-  {
-    GST_ELEMENT_ERROR (sink, RESOURCE, READ, (NULL),
-        ("select on file descriptor: %s", g_strerror (errno)));
-    GST_DEBUG_OBJECT (sink, "Error during select: %s", g_strerror (errno));
-    flow_ret = GST_FLOW_ERROR;
-    goto out;
-  }
-stopped:
-  {
-    GST_DEBUG_OBJECT (sink, "Select stopped");
-    flow_ret = GST_FLOW_FLUSHING;
-    goto out;
+  return GST_MEMORY_CAST (gst_fd_chunk_memory_new_internal (file, NULL,
+          offset, size));
+}
+
+gboolean
+gst_fd_chunk_memory_get_fd (GstMemory * mem, gint * fd, guint64 * offset)
+{
+  GstFdChunkMemory *fmem = (GstFdChunkMemory *) mem;
+
+  if (!gst_memory_is_type (mem, GST_FD_CHUNK_MEMORY_TYPE))
+    return FALSE;
+
+  *fd = fmem->file->fd;
+  *offset = fmem->file_offset + mem->offset;
+
+  return TRUE;
+}
+
+/* sinks propose the allocator in the ALLOCATION query, filesrc produces
+ * file backed memory when it finds it */
+gboolean
+gst_fd_chunk_query_has_allocator (GstQuery * query)
+{
+  gboolean res = FALSE;
+  guint i, n;
+
+  n = gst_query_get_n_allocation_params (query);
+  for (i = 0; i < n && !res; i++) {
+    GstAllocator *allocator = NULL;
+
+    gst_query_parse_nth_allocation_param (query, i, &allocator, NULL);
+    if (allocator) {
+      res = (allocator == gst_fd_chunk_allocator_get ());
+      gst_object_unref (allocator);
+    }
   }
+  return res;
+}
+
+void
+gst_fd_chunk_query_add_allocator (GstQuery * query)
+{
+#ifdef HAVE_SYS_SENDFILE_H
+  gst_query_add_allocation_param (query, gst_fd_chunk_allocator_get (), NULL);
 #endif
-write_error:
+}
+
+static gpointer
+gst_fd_chunk_mem_map (GstFdChunkMemory * mem, gsize maxsize, GstMapFlags flags)
+{
+  gpointer res;
+
+  g_mutex_lock (&mem->lock);
+  if (mem->data == NULL) {
+    gpointer data = g_malloc (maxsize);
+
+    if (!gst_fd_chunk_file_read (mem->file, data, maxsize, mem->file_offset))
+      goto read_failed;
+
+    mem->data = data;
+  }
+  res = mem->data;
+  g_mutex_unlock (&mem->lock);
+
+  return res;
+
+  /* ERRORS */
+read_failed:
   {
-    switch (errno) {
-      case ENOSPC:
-        GST_ELEMENT_ERROR (sink, RESOURCE, NO_SPACE_LEFT, (NULL), (NULL));
-        break;
-      default:{
-        GST_ELEMENT_ERROR (sink, RESOURCE, WRITE, (NULL),
-            ("Error while writing to file descriptor %d: %s",
-                fd, g_strerror (errno)));
-      }
-    }
-    flow_ret = GST_FLOW_ERROR;
-    goto out;
+    GST_WARNING ("could not read %" G_GSIZE_FORMAT " bytes at offset %"
+        G_GUINT64_FORMAT ": %s", maxsize, mem->file_offset,
+        g_strerror (errno));
+    g_mutex_unlock (&mem->lock);
+    return NULL;
   }
 }
+
+static void
+gst_fd_chunk_mem_unmap (GstFdChunkMemory * mem)
+{
+  /* keep the data for the next map */
+}
+
+static GstFdChunkMemory *
+gst_fd_chunk_mem_share (GstFdChunkMemory * mem, gssize offset, gsize size)
+{
+  GstMemory *parent;
+
+  if (size == -1)
+    size = mem->mem.size - offset;
+
+  if ((parent = mem->mem.parent) == NULL)
+    parent = GST_MEMORY_CAST (mem);
+
+  return gst_fd_chunk_memory_new_internal (mem->file, parent,
+      mem->file_offset + mem->mem.offset + offset, size);
+}
+
+static GstMemory *
+gst_fd_chunk_allocator_alloc (GstAllocator * allocator, gsize size,
+    GstAllocationParams * params)
+{
+  /* our memory is only made from files, anything else is system memory */
+  return gst_allocator_alloc (NULL, size, params);
+}
+
+static void
+gst_fd_chunk_allocator_free (GstAllocator * allocator, GstMemory * memory)
+{
+  GstFdChunkMemory *mem = (GstFdChunkMemory *) memory;
+
+  g_free (mem->data);
+  g_mutex_clear (&mem->lock);
+  gst_fd_chunk_file_unref (mem->file);
+  g_slice_free (GstFdChunkMemory, mem);
+}
+
+static void
+gst_fd_chunk_allocator_class_init (GstFdChunkAllocatorClass * klass)
+{
+  klass->alloc = gst_fd_chunk_allocator_alloc;
+  klass->free = gst_fd_chunk_allocator_free;
+}
+
+static void
+gst_fd_chunk_allocator_init (GstFdChunkAllocator * allocator)
+{
+  allocator->mem_type = GST_FD_CHUNK_MEMORY_TYPE;
+  allocator->mem_map = (GstMemoryMapFunction) gst_fd_chunk_mem_map;
+  allocator->mem_unmap = (GstMemoryUnmapFunction) gst_fd_chunk_mem_unmap;
+  allocator->mem_share = (GstMemoryShareFunction) gst_fd_chunk_mem_share;
+}
@@ -36,6 +36,33 @@ GstFlowReturn  gst_writev_buffers (GstObject * sink, gint fd, GstPoll * fdset,
                                    guint8 * mem_nums, guint total_mem_num,
                                    guint64 * total_written, guint64 * cur_pos);
 
+/* memory that refers to a region of a file, sinks that know about it can
+ * send the data with sendfile() instead of mapping it. Mapping it reads the
+ * region into memory. */
+#define GST_FD_CHUNK_MEMORY_TYPE "FdChunkMemory"
+
+typedef struct _GstFdChunkFile GstFdChunkFile;
+
+G_GNUC_INTERNAL
+GstFdChunkFile * gst_fd_chunk_file_new          (gint fd);
+
+G_GNUC_INTERNAL
+void             gst_fd_chunk_file_unref        (GstFdChunkFile * file);
+
+G_GNUC_INTERNAL
+GstMemory *      gst_fd_chunk_memory_new        (GstFdChunkFile * file,
+                                                 guint64 offset, gsize size);
+
+G_GNUC_INTERNAL
+gboolean         gst_fd_chunk_memory_get_fd     (GstMemory * mem, gint * fd,
+                                                 guint64 * offset);
+
+G_GNUC_INTERNAL
+gboolean         gst_fd_chunk_query_has_allocator (GstQuery * query);
+
+G_GNUC_INTERNAL
+void             gst_fd_chunk_query_add_allocator (GstQuery * query);
+
 G_END_DECLS
 
 #endif /* __GST_ELEMENTS_PRIVATE_H__ */
@@ -68,6 +68,7 @@ enum
 #define DEFAULT_CAN_ACTIVATE_PUSH TRUE
 #define DEFAULT_CAN_ACTIVATE_PULL FALSE
 #define DEFAULT_NUM_BUFFERS -1
+#define DEFAULT_ENABLE_STATS FALSE
 
 enum
 {
@@ -79,7 +80,9 @@ enum
   PROP_LAST_MESSAGE,
   PROP_CAN_ACTIVATE_PUSH,
   PROP_CAN_ACTIVATE_PULL,
-  PROP_NUM_BUFFERS
+  PROP_NUM_BUFFERS,
+  PROP_ENABLE_STATS,
+  PROP_STATS
 };
 
 #define GST_TYPE_FAKE_SINK_STATE_ERROR (gst_fake_sink_state_error_get_type())
@@ -123,6 +126,9 @@ static void gst_fake_sink_get_property (GObject * object, guint prop_id,
     GValue * value, GParamSpec * pspec);
 static void gst_fake_sink_finalize (GObject * obj);
 
+static GstStructure *gst_fake_sink_get_stats (GstFakeSink * sink);
+static void gst_fake_sink_reset_stats (GstFakeSink * sink);
+
 static GstStateChangeReturn gst_fake_sink_change_state (GstElement * element,
     GstStateChange transition);
 
@@ -188,6 +194,35 @@ gst_fake_sink_class_init (GstFakeSinkClass * klass)
       g_param_spec_int ("num-buffers", "num-buffers",
           "Number of buffers to accept going EOS", -1, G_MAXINT,
           DEFAULT_NUM_BUFFERS, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstFakeSink:enable-stats:
+   *
+   * Count the rendered buffers and measure their arrival times. The results
+   * are available in the #GstFakeSink:stats property. This is much cheaper
+   * than formatting #GstFakeSink:last-message for every buffer.
+   *
+   * Since: 1.10
+   */
+  g_object_class_install_property (gobject_class, PROP_ENABLE_STATS,
+      g_param_spec_boolean ("enable-stats", "Enable stats",
+          "Collect statistics about the rendered buffers",
+          DEFAULT_ENABLE_STATS, G_PARAM_READWRITE | GST_PARAM_MUTABLE_READY |
+          G_PARAM_STATIC_STRINGS));
+  /**
+   * GstFakeSink:stats:
+   *
+   * Statistics collected with #GstFakeSink:enable-stats, reset when going
+   * to PAUSED. The structure contains the number of "buffers" and "bytes",
+   * the "throughput" in bytes per second since the first buffer, the
+   * smoothed inter-arrival "jitter" and the average "latency" of the
+   * buffers against their running time, when a clock is available.
+   *
+   * Since: 1.10
+   */
+  g_object_class_install_property (gobject_class, PROP_STATS,
+      g_param_spec_boxed ("stats", "Statistics",
+          "Statistics about the rendered buffers", GST_TYPE_STRUCTURE,
+          G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
 
   /**
    * GstFakeSink::handoff:
@@ -245,6 +280,8 @@ gst_fake_sink_init (GstFakeSink * fakesink)
   fakesink->state_error = DEFAULT_STATE_ERROR;
   fakesink->signal_handoffs = DEFAULT_SIGNAL_HANDOFFS;
   fakesink->num_buffers = DEFAULT_NUM_BUFFERS;
+  fakesink->enable_stats = DEFAULT_ENABLE_STATS;
+  gst_fake_sink_reset_stats (fakesink);
 
   gst_base_sink_set_sync (GST_BASE_SINK (fakesink), DEFAULT_SYNC);
 }
@@ -285,6 +322,9 @@ gst_fake_sink_set_property (GObject * object, guint prop_id,
     case PROP_NUM_BUFFERS:
       sink->num_buffers = g_value_get_int (value);
       break;
+    case PROP_ENABLE_STATS:
+      sink->enable_stats = g_value_get_boolean (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -326,12 +366,114 @@ gst_fake_sink_get_property (GObject * object, guint prop_id, GValue * value,
     case PROP_NUM_BUFFERS:
       g_value_set_int (value, sink->num_buffers);
       break;
+    case PROP_ENABLE_STATS:
+      g_value_set_boolean (value, sink->enable_stats);
+      break;
+    case PROP_STATS:
+      g_value_take_boxed (value, gst_fake_sink_get_stats (sink));
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
   }
 }
 
+static GstStructure *
+gst_fake_sink_get_stats (GstFakeSink * sink)
+{
+  guint64 buffers, bytes, latency_count;
+  GstClockTime first, last, jitter;
+  GstClockTimeDiff latency;
+  gdouble throughput = 0.0;
+  gint seq;
+
+  /* lockless snapshot of what the streaming thread wrote */
+  do {
+    while ((seq = g_atomic_int_get (&sink->stats_seq)) & 1)
+      g_thread_yield ();
+
+    buffers = sink->stats_buffers;
+    bytes = sink->stats_bytes;
+    first = sink->stats_first;
+    last = sink->stats_last;
+    jitter = sink->stats_jitter;
+    latency = sink->stats_latency;
+    latency_count = sink->stats_latency_count;
+  } while (g_atomic_int_get (&sink->stats_seq) != seq);
+
+  if (GST_CLOCK_TIME_IS_VALID (first) && last > first)
+    throughput = gst_guint64_to_gdouble (bytes) * GST_SECOND / (last - first);
+
+  return gst_structure_new ("application/x-fakesink-stats",
+      "buffers", G_TYPE_UINT64, buffers,
+      "bytes", G_TYPE_UINT64, bytes,
+      "throughput", G_TYPE_DOUBLE, throughput,
+      "jitter", G_TYPE_UINT64, jitter,
+      "latency", G_TYPE_INT64, latency_count ?
+      latency / (gint64) latency_count : (gint64) 0, NULL);
+}
+
+static void
+gst_fake_sink_reset_stats (GstFakeSink * sink)
+{
+  g_atomic_int_inc (&sink->stats_seq);
+  sink->stats_buffers = 0;
+  sink->stats_bytes = 0;
+  sink->stats_first = GST_CLOCK_TIME_NONE;
+  sink->stats_last = GST_CLOCK_TIME_NONE;
+  sink->stats_interval = GST_CLOCK_TIME_NONE;
+  sink->stats_jitter = 0;
+  sink->stats_latency = 0;
+  sink->stats_latency_count = 0;
+  g_atomic_int_inc (&sink->stats_seq);
+}
+
+static void
+gst_fake_sink_update_stats (GstFakeSink * sink, GstBuffer * buf)
+{
+  GstBaseSink *bsink = GST_BASE_SINK_CAST (sink);
+  GstClockTime now, ts, interval, running_time = GST_CLOCK_TIME_NONE;
+  GstClock *clock;
+
+  now = gst_util_get_timestamp ();
+
+  ts = GST_BUFFER_DTS_OR_PTS (buf);
+  if (GST_CLOCK_TIME_IS_VALID (ts) && bsink->segment.format == GST_FORMAT_TIME) {
+    ts = gst_segment_to_running_time (&bsink->segment, GST_FORMAT_TIME, ts);
+
+    GST_OBJECT_LOCK (sink);
+    if ((clock = GST_ELEMENT_CLOCK (sink)))
+      running_time = gst_clock_get_time (clock) - GST_ELEMENT_CAST
+          (sink)->base_time;
+    GST_OBJECT_UNLOCK (sink);
+  }
+
+  g_atomic_int_inc (&sink->stats_seq);
+  sink->stats_buffers++;
+  sink->stats_bytes += gst_buffer_get_size (buf);
+
+  if (!GST_CLOCK_TIME_IS_VALID (sink->stats_first))
+    sink->stats_first = now;
+
+  if (GST_CLOCK_TIME_IS_VALID (sink->stats_last)) {
+    interval = now - sink->stats_last;
+    /* smoothed deviation of the inter-arrival times, like RFC 3550 does */
+    if (GST_CLOCK_TIME_IS_VALID (sink->stats_interval)) {
+      GstClockTimeDiff d = GST_CLOCK_DIFF (sink->stats_interval, interval);
+
+      sink->stats_jitter += (ABS (d) - (gint64) sink->stats_jitter) / 16;
+    }
+    sink->stats_interval = interval;
+  }
+  sink->stats_last = now;
+
+  if (GST_CLOCK_TIME_IS_VALID (ts) && GST_CLOCK_TIME_IS_VALID (running_time)) {
+    sink->stats_latency += GST_CLOCK_DIFF (ts, running_time);
+    sink->stats_latency_count++;
+  }
+  g_atomic_int_inc (&sink->stats_seq);
+}
+
 static void
 gst_fake_sink_notify_last_message (GstFakeSink * sink)
 {
@@ -429,6 +571,9 @@ gst_fake_sink_render (GstBaseSink * bsink, GstBuffer * buf)
   if (sink->num_buffers_left != -1)
     sink->num_buffers_left--;
 
+  if (sink->enable_stats)
+    gst_fake_sink_update_stats (sink, buf);
+
   if (!sink->silent) {
     gchar dts_str[64], pts_str[64], dur_str[64];
     gchar *flag_str;
@@ -535,6 +680,7 @@ gst_fake_sink_change_state (GstElement * element, GstStateChange transition)
       if (fakesink->state_error == FAKE_SINK_STATE_ERROR_READY_PAUSED)
         goto error;
       fakesink->num_buffers_left = fakesink->num_buffers;
+      gst_fake_sink_reset_stats (fakesink);
       break;
     case GST_STATE_CHANGE_PAUSED_TO_PLAYING:
       if (fakesink->state_error == FAKE_SINK_STATE_ERROR_PAUSED_PLAYING)
@@ -82,6 +82,19 @@ struct _GstFakeSink {
   gchar			*last_message;
   gint                  num_buffers;
   gint                  num_buffers_left;
+
+  /* stats, only written from the streaming thread. Readers retry while
+   * stats_seq is odd or changed under them. */
+  gboolean              enable_stats;
+  volatile gint         stats_seq;
+  guint64               stats_buffers;
+  guint64               stats_bytes;
+  GstClockTime          stats_first;
+  GstClockTime          stats_last;
+  GstClockTime          stats_interval;
+  GstClockTime          stats_jitter;
+  GstClockTimeDiff      stats_latency;
+  guint64               stats_latency_count;
 };
 
 struct _GstFakeSinkClass {
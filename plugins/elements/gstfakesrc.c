@@ -85,6 +85,10 @@ enum
 #define DEFAULT_CAN_ACTIVATE_PULL TRUE
 #define DEFAULT_CAN_ACTIVATE_PUSH TRUE
 #define DEFAULT_FORMAT          GST_FORMAT_BYTES
+#define DEFAULT_BUFFER_LIST_SIZE 0
+
+/* buffers allocated up front in pool mode */
+#define POOL_MIN_BUFFERS        16
 
 enum
 {
@@ -108,6 +112,7 @@ enum
   PROP_CAN_ACTIVATE_PUSH,
   PROP_IS_LIVE,
   PROP_FORMAT,
+  PROP_BUFFER_LIST_SIZE,
   PROP_LAST,
 };
 
@@ -145,6 +150,7 @@ gst_fake_src_data_get_type (void)
   static const GEnumValue fakesrc_data[] = {
     {FAKE_SRC_DATA_ALLOCATE, "Allocate data", "allocate"},
     {FAKE_SRC_DATA_SUBBUFFER, "Subbuffer data", "subbuffer"},
+    {FAKE_SRC_DATA_POOL, "Cycle preallocated buffers from a pool", "pool"},
     {0, NULL, NULL},
   };
 
@@ -320,6 +326,19 @@ gst_fake_src_class_init (GstFakeSrcClass * klass)
       g_param_spec_enum ("format", "Format",
           "The format of the segment events", GST_TYPE_FORMAT,
           DEFAULT_FORMAT, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstFakeSrc:buffer-list-size
+   *
+   * Push this many buffers at once in a #GstBufferList when operating in
+   * push mode. 0 or 1 pushes the buffers one by one.
+   *
+   * Since: 1.10
+   */
+  g_object_class_install_property (gobject_class, PROP_BUFFER_LIST_SIZE,
+      g_param_spec_uint ("buffer-list-size", "Buffer list size",
+          "Number of buffers to push at once in a buffer list (0 = no lists)",
+          0, G_MAXUINT, DEFAULT_BUFFER_LIST_SIZE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
   /**
    * GstFakeSrc::handoff:
@@ -369,6 +388,7 @@ gst_fake_src_init (GstFakeSrc * fakesrc)
   fakesrc->datarate = DEFAULT_DATARATE;
   fakesrc->sync = DEFAULT_SYNC;
   fakesrc->format = DEFAULT_FORMAT;
+  fakesrc->buffer_list_size = DEFAULT_BUFFER_LIST_SIZE;
 }
 
 static void
@@ -508,6 +528,9 @@ gst_fake_src_set_property (GObject * object, guint prop_id,
     case PROP_FORMAT:
       src->format = (GstFormat) g_value_get_enum (value);
       break;
+    case PROP_BUFFER_LIST_SIZE:
+      src->buffer_list_size = g_value_get_uint (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -582,6 +605,9 @@ gst_fake_src_get_property (GObject * object, guint prop_id, GValue * value,
     case PROP_FORMAT:
       g_value_set_enum (value, src->format);
       break;
+    case PROP_BUFFER_LIST_SIZE:
+      g_value_set_uint (value, src->buffer_list_size);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -661,6 +687,29 @@ gst_fake_src_alloc_buffer (GstFakeSrc * src, guint size)
   return buf;
 }
 
+static GstBuffer *
+gst_fake_src_acquire_buffer (GstFakeSrc * src, guint size)
+{
+  GstBuffer *buf = NULL;
+  GstMapInfo info;
+
+  if (gst_buffer_pool_acquire_buffer (src->pool, &buf, NULL) != GST_FLOW_OK)
+    return NULL;
+
+  /* the pool restores the full size when the buffer comes back */
+  if (size < gst_buffer_get_size (buf))
+    gst_buffer_set_size (buf, size);
+
+  if (size != 0 && src->filltype != FAKE_SRC_FILLTYPE_NOTHING) {
+    if (gst_buffer_map (buf, &info, GST_MAP_WRITE)) {
+      gst_fake_src_prepare_buffer (src, info.data, info.size);
+      gst_buffer_unmap (buf, &info);
+    }
+  }
+
+  return buf;
+}
+
 static guint
 gst_fake_src_get_size (GstFakeSrc * src)
 {
@@ -696,6 +745,14 @@ gst_fake_src_create_buffer (GstFakeSrc * src, gsize * bufsize)
     case FAKE_SRC_DATA_ALLOCATE:
       buf = gst_fake_src_alloc_buffer (src, size);
       break;
+    case FAKE_SRC_DATA_POOL:
+      if (src->pool == NULL)
+        goto no_pool;
+      buf = gst_fake_src_acquire_buffer (src, MIN (size, src->sizemax));
+      if (buf == NULL)
+        goto buffer_create_fail;
+      *bufsize = gst_buffer_get_size (buf);
+      break;
     case FAKE_SRC_DATA_SUBBUFFER:
       /* see if we have a parent to subbuffer */
       if (!src->parent) {
@@ -736,6 +793,12 @@ gst_fake_src_create_buffer (GstFakeSrc * src, gsize * bufsize)
 
   return buf;
 
+no_pool:
+  {
+    GST_ELEMENT_ERROR (src, CORE, STATE, (NULL),
+        ("Pool allocation selected after starting"));
+    return NULL;
+  }
 buffer_create_fail:
   {
     GST_ELEMENT_ERROR (src, RESOURCE, BUSY, (NULL),
@@ -784,17 +847,16 @@ gst_fake_src_get_times (GstBaseSrc * basesrc, GstBuffer * buffer,
 }
 
 static GstFlowReturn
-gst_fake_src_create (GstBaseSrc * basesrc, guint64 offset, guint length,
-    GstBuffer ** ret)
+gst_fake_src_create_one (GstFakeSrc * src, guint64 offset, GstBuffer ** ret)
 {
-  GstFakeSrc *src;
+  GstBaseSrc *basesrc = GST_BASE_SRC_CAST (src);
   GstBuffer *buf;
   GstClockTime time;
   gsize size;
 
-  src = GST_FAKE_SRC (basesrc);
-
   buf = gst_fake_src_create_buffer (src, &size);
+  if (buf == NULL)
+    return GST_FLOW_ERROR;
   GST_BUFFER_OFFSET (buf) = offset;
 
   if (src->datarate > 0) {
@@ -875,6 +937,43 @@ gst_fake_src_create (GstBaseSrc * basesrc, guint64 offset, guint length,
   return GST_FLOW_OK;
 }
 
+static GstFlowReturn
+gst_fake_src_create (GstBaseSrc * basesrc, guint64 offset, guint length,
+    GstBuffer ** ret)
+{
+  GstFakeSrc *src;
+  GstBufferList *list;
+  GstBuffer *buf;
+  GstFlowReturn res;
+  guint i, n_buffers;
+
+  src = GST_FAKE_SRC (basesrc);
+
+  n_buffers = src->buffer_list_size;
+  if (n_buffers <= 1 || GST_PAD_MODE (basesrc->srcpad) != GST_PAD_MODE_PUSH)
+    return gst_fake_src_create_one (src, offset, ret);
+
+  list = gst_buffer_list_new_sized (n_buffers);
+  for (i = 0; i < n_buffers; i++) {
+    res = gst_fake_src_create_one (src, offset, &buf);
+    if (res != GST_FLOW_OK)
+      goto create_failed;
+    if (offset != -1)
+      offset += gst_buffer_get_size (buf);
+    gst_buffer_list_add (list, buf);
+  }
+  gst_base_src_submit_buffer_list (basesrc, list);
+
+  return GST_FLOW_OK;
+
+  /* ERRORS */
+create_failed:
+  {
+    gst_buffer_list_unref (list);
+    return res;
+  }
+}
+
 static gboolean
 gst_fake_src_start (GstBaseSrc * basesrc)
 {
@@ -887,13 +986,41 @@ gst_fake_src_start (GstBaseSrc * basesrc)
 
   gst_base_src_set_format (basesrc, src->format);
 
+  if (src->data == FAKE_SRC_DATA_POOL) {
+    GstBufferPool *pool;
+    GstStructure *config;
+
+    pool = gst_buffer_pool_new ();
+    config = gst_buffer_pool_get_config (pool);
+    gst_buffer_pool_config_set_params (config, NULL, src->sizemax,
+        MAX (src->buffer_list_size, POOL_MIN_BUFFERS), 0);
+    if (!gst_buffer_pool_set_config (pool, config)
+        || !gst_buffer_pool_set_active (pool, TRUE))
+      goto pool_failed;
+
+    GST_OBJECT_LOCK (src);
+    src->pool = pool;
+    GST_OBJECT_UNLOCK (src);
+  }
+
   return TRUE;
+
+  /* ERRORS */
+pool_failed:
+  {
+    GST_ELEMENT_ERROR (src, RESOURCE, FAILED, (NULL),
+        ("Failed to preallocate %u buffers of %u bytes",
+            MAX (src->buffer_list_size, POOL_MIN_BUFFERS), src->sizemax));
+    gst_object_unref (pool);
+    return FALSE;
+  }
 }
 
 static gboolean
 gst_fake_src_stop (GstBaseSrc * basesrc)
 {
   GstFakeSrc *src;
+  GstBufferPool *pool;
 
   src = GST_FAKE_SRC (basesrc);
 
@@ -904,8 +1031,15 @@ gst_fake_src_stop (GstBaseSrc * basesrc)
   }
   g_free (src->last_message);
   src->last_message = NULL;
+  pool = src->pool;
+  src->pool = NULL;
   GST_OBJECT_UNLOCK (src);
 
+  if (pool) {
+    gst_buffer_pool_set_active (pool, FALSE);
+    gst_object_unref (pool);
+  }
+
   return TRUE;
 }
 
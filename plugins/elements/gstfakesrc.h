@@ -57,12 +57,15 @@ typedef enum {
  * GstFakeSrcDataType:
  * @FAKE_SRC_DATA_ALLOCATE: allocate buffers
  * @FAKE_SRC_DATA_SUBBUFFER: subbuffer each buffer
+ * @FAKE_SRC_DATA_POOL: cycle sizemax sized buffers from a preallocated
+ *     pool (Since: 1.10)
  *
  * The different ways buffers are allocated.
  */
 typedef enum {
   FAKE_SRC_DATA_ALLOCATE = 1,
-  FAKE_SRC_DATA_SUBBUFFER
+  FAKE_SRC_DATA_SUBBUFFER,
+  FAKE_SRC_DATA_POOL
 } GstFakeSrcDataType;
 
 /**
@@ -133,6 +136,8 @@ struct _GstFakeSrc {
   GstBuffer	*parent;
   guint		parentsize;
   guint		parentoffset;
+  GstBufferPool	*pool;
+  guint		 buffer_list_size;
   guint8	 pattern_byte;
   GList		*patternlist;
   gint		 datarate;
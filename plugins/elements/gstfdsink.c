@@ -115,6 +115,8 @@ static void gst_fd_sink_get_property (GObject * object, guint prop_id,
 static void gst_fd_sink_dispose (GObject * obj);
 
 static gboolean gst_fd_sink_query (GstBaseSink * bsink, GstQuery * query);
+static gboolean gst_fd_sink_propose_allocation (GstBaseSink * bsink,
+    GstQuery * query);
 static GstFlowReturn gst_fd_sink_render (GstBaseSink * sink,
     GstBuffer * buffer);
 static GstFlowReturn gst_fd_sink_render_list (GstBaseSink * bsink,
@@ -156,6 +158,8 @@ gst_fd_sink_class_init (GstFdSinkClass * klass)
   gstbasesink_class->unlock_stop = GST_DEBUG_FUNCPTR (gst_fd_sink_unlock_stop);
   gstbasesink_class->event = GST_DEBUG_FUNCPTR (gst_fd_sink_event);
   gstbasesink_class->query = GST_DEBUG_FUNCPTR (gst_fd_sink_query);
+  gstbasesink_class->propose_allocation =
+      GST_DEBUG_FUNCPTR (gst_fd_sink_propose_allocation);
 
   g_object_class_install_property (gobject_class, ARG_FD,
       g_param_spec_int ("fd", "fd", "An open file descriptor to write to",
@@ -184,6 +188,15 @@ gst_fd_sink_dispose (GObject * obj)
   G_OBJECT_CLASS (parent_class)->dispose (obj);
 }
 
+/* we can send file backed memory from filesrc with sendfile() */
+static gboolean
+gst_fd_sink_propose_allocation (GstBaseSink * bsink, GstQuery * query)
+{
+  gst_fd_chunk_query_add_allocator (query);
+
+  return TRUE;
+}
+
 static gboolean
 gst_fd_sink_query (GstBaseSink * bsink, GstQuery * query)
 {
@@ -44,6 +44,13 @@
  * </listitem>
  * </itemizedlist>
  *
+ * If #GstFdSrc:batch-size is bigger than 1, fdsrc reads up to that many
+ * blocks per wakeup and pushes them downstream in one #GstBufferList. Stream
+ * file descriptors are read with one readv() call, datagram sockets with
+ * recvmmsg() where available so that each datagram ends up in its own
+ * buffer. #GstFdSrc:batch-timeout bounds the time spent waiting for a batch
+ * to fill up.
+ *
  * <refsect2>
  * <title>Example launch line</title>
  * |[
@@ -53,6 +60,11 @@
  * </refsect2>
  */
 
+/* for recvmmsg() */
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE 1
+#endif
+
 #ifdef HAVE_CONFIG_H
 #  include "config.h"
 #endif
@@ -75,6 +87,9 @@
 #ifdef HAVE_UNISTD_H
 #include <unistd.h>
 #endif
+#ifdef HAVE_SYS_UIO_H
+#include <sys/uio.h>
+#endif
 #ifdef _MSC_VER
 #undef stat
 #define stat _stat
@@ -82,6 +97,7 @@
 #define S_ISREG(m)	(((m)&S_IFREG)==S_IFREG)
 #endif
 #include <stdlib.h>
+#include <string.h>
 #include <errno.h>
 
 #include "gstfdsrc.h"
@@ -103,6 +119,15 @@ GST_DEBUG_CATEGORY_STATIC (gst_fd_src_debug);
 
 #define DEFAULT_FD              0
 #define DEFAULT_TIMEOUT         0
+#define DEFAULT_BATCH_SIZE      1
+#define DEFAULT_BATCH_TIMEOUT   0
+
+/* upper bound for the batch-size, the iovecs live on the stack */
+#define MAX_BATCH_SIZE          64
+
+#if defined (HAVE_RECVMMSG) && defined (HAVE_SYS_SOCKET_H)
+#define USE_MMSG 1
+#endif
 
 enum
 {
@@ -110,6 +135,8 @@ enum
 
   PROP_FD,
   PROP_TIMEOUT,
+  PROP_BATCH_SIZE,
+  PROP_BATCH_TIMEOUT,
 
   PROP_LAST
 };
@@ -169,6 +196,33 @@ gst_fd_src_class_init (GstFdSrcClass * klass)
           "Post a message after timeout microseconds (0 = disabled)", 0,
           G_MAXUINT64, DEFAULT_TIMEOUT,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstFdSrc:batch-size
+   *
+   * Maximum number of blocks to read per wakeup. More than 1 pushes the
+   * blocks in a #GstBufferList, allocated from the negotiated buffer pool
+   * when its buffers are large enough.
+   *
+   * Since: 1.10
+   */
+  g_object_class_install_property (G_OBJECT_CLASS (klass), PROP_BATCH_SIZE,
+      g_param_spec_uint ("batch-size", "Batch size",
+          "Maximum number of blocks to read per wakeup", 1, MAX_BATCH_SIZE,
+          DEFAULT_BATCH_SIZE, G_PARAM_READWRITE | GST_PARAM_MUTABLE_READY |
+          G_PARAM_STATIC_STRINGS));
+  /**
+   * GstFdSrc:batch-timeout
+   *
+   * Microseconds to wait for more data once a batch has been started. With
+   * 0, only the data that is already available is added to the batch.
+   *
+   * Since: 1.10
+   */
+  g_object_class_install_property (G_OBJECT_CLASS (klass), PROP_BATCH_TIMEOUT,
+      g_param_spec_uint64 ("batch-timeout", "Batch timeout",
+          "Microseconds to wait for a batch to fill up (0 = don't wait)", 0,
+          G_MAXUINT64, DEFAULT_BATCH_TIMEOUT,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
   gst_element_class_set_static_metadata (gstelement_class,
       "Filedescriptor Source",
@@ -196,6 +250,8 @@ gst_fd_src_init (GstFdSrc * fdsrc)
   fdsrc->fd = -1;
   fdsrc->size = -1;
   fdsrc->timeout = DEFAULT_TIMEOUT;
+  fdsrc->batch_size = DEFAULT_BATCH_SIZE;
+  fdsrc->batch_timeout = DEFAULT_BATCH_TIMEOUT;
   fdsrc->uri = g_strdup_printf ("fd://0");
   fdsrc->curoffset = 0;
 }
@@ -244,6 +300,19 @@ gst_fd_src_update_fd (GstFdSrc * src, guint64 size)
     GST_INFO_OBJECT (src, "Setting size to fd %" G_GUINT64_FORMAT, size);
     src->size = size;
 
+    src->is_dgram = FALSE;
+#ifdef HAVE_SYS_SOCKET_H
+    {
+      gint type;
+      socklen_t len = sizeof (type);
+
+      /* datagrams must not be merged when reading batches */
+      if (getsockopt (src->fd, SOL_SOCKET, SO_TYPE, &type, &len) == 0
+          && type == SOCK_DGRAM)
+        src->is_dgram = TRUE;
+    }
+#endif
+
     g_free (src->uri);
     src->uri = g_strdup_printf ("fd://%d", src->fd);
 
@@ -304,6 +373,10 @@ gst_fd_src_stop (GstBaseSrc * bsrc)
     gst_poll_free (src->fdset);
     src->fdset = NULL;
   }
+  if (src->pool) {
+    gst_object_unref (src->pool);
+    src->pool = NULL;
+  }
 
   return TRUE;
 }
@@ -360,6 +433,12 @@ gst_fd_src_set_property (GObject * object, guint prop_id, const GValue * value,
       GST_DEBUG_OBJECT (src, "poll timeout set to %" GST_TIME_FORMAT,
           GST_TIME_ARGS (src->timeout));
       break;
+    case PROP_BATCH_SIZE:
+      src->batch_size = g_value_get_uint (value);
+      break;
+    case PROP_BATCH_TIMEOUT:
+      src->batch_timeout = g_value_get_uint64 (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -379,12 +458,269 @@ gst_fd_src_get_property (GObject * object, guint prop_id, GValue * value,
     case PROP_TIMEOUT:
       g_value_set_uint64 (value, src->timeout);
       break;
+    case PROP_BATCH_SIZE:
+      g_value_set_uint (value, src->batch_size);
+      break;
+    case PROP_BATCH_TIMEOUT:
+      g_value_set_uint64 (value, src->batch_timeout);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
   }
 }
 
+#ifndef HAVE_WIN32
+static GstBuffer *
+gst_fd_src_alloc_block (GstFdSrc * src, guint blocksize)
+{
+  GstBaseSrc *bsrc = GST_BASE_SRC_CAST (src);
+  GstBufferPool *pool;
+  GstBuffer *buf = NULL;
+
+  /* only use the negotiated pool when its buffers can hold a block */
+  pool = gst_base_src_get_buffer_pool (bsrc);
+  if (pool != src->pool) {
+    GstStructure *config;
+    guint size = 0;
+
+    if (src->pool)
+      gst_object_unref (src->pool);
+    src->pool = pool ? gst_object_ref (pool) : NULL;
+    src->pool_usable = FALSE;
+
+    if (pool) {
+      config = gst_buffer_pool_get_config (pool);
+      gst_buffer_pool_config_get_params (config, NULL, &size, NULL, NULL);
+      gst_structure_free (config);
+      src->pool_usable = size >= blocksize;
+      GST_DEBUG_OBJECT (src, "pool buffers of %u bytes, using pool: %d", size,
+          src->pool_usable);
+    }
+  }
+
+  if (pool && src->pool_usable
+      && gst_buffer_pool_acquire_buffer (pool, &buf, NULL) == GST_FLOW_OK) {
+    if (gst_buffer_get_size (buf) > blocksize)
+      gst_buffer_set_size (buf, blocksize);
+  } else {
+    GstAllocator *allocator;
+    GstAllocationParams params;
+
+    gst_base_src_get_allocator (bsrc, &allocator, &params);
+    buf = gst_buffer_new_allocate (allocator, blocksize, &params);
+    if (allocator)
+      gst_object_unref (allocator);
+  }
+
+  if (pool)
+    gst_object_unref (pool);
+
+  return buf;
+}
+
+/* fills the first buffers of @bufs with one system call. Returns the number
+ * of filled buffers, 0 on EOS and -1 with errno set on errors. */
+static gint
+gst_fd_src_read_blocks (GstFdSrc * src, GstBuffer ** bufs, gint n_bufs)
+{
+  GstMapInfo info[MAX_BATCH_SIZE];
+  gsize sizes[MAX_BATCH_SIZE];
+  gint i, n_filled = 0;
+  gssize readbytes;
+  gint saved_errno;
+
+  for (i = 0; i < n_bufs; i++) {
+    if (!gst_buffer_map (bufs[i], &info[i], GST_MAP_WRITE)) {
+      n_bufs = i;
+      break;
+    }
+  }
+  if (n_bufs == 0) {
+    errno = ENOMEM;
+    return -1;
+  }
+
+  if (src->is_dgram) {
+#ifdef USE_MMSG
+    struct mmsghdr msgs[MAX_BATCH_SIZE];
+    struct iovec iov[MAX_BATCH_SIZE];
+
+    memset (msgs, 0, sizeof (struct mmsghdr) * n_bufs);
+    for (i = 0; i < n_bufs; i++) {
+      iov[i].iov_base = info[i].data;
+      iov[i].iov_len = info[i].size;
+      msgs[i].msg_hdr.msg_iov = &iov[i];
+      msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+    do {
+      n_filled = recvmmsg (src->fd, msgs, n_bufs, MSG_DONTWAIT, NULL);
+    } while (n_filled == -1 && errno == EINTR);
+
+    for (i = 0; i < n_filled; i++)
+      sizes[i] = msgs[i].msg_len;
+#else
+    do {
+      readbytes = read (src->fd, info[0].data, info[0].size);
+    } while (readbytes == -1 && errno == EINTR);
+
+    n_filled = readbytes < 0 ? -1 : 1;
+    sizes[0] = MAX (readbytes, 0);
+#endif
+  } else {
+#ifdef HAVE_SYS_UIO_H
+    struct iovec iov[MAX_BATCH_SIZE];
+
+    for (i = 0; i < n_bufs; i++) {
+      iov[i].iov_base = info[i].data;
+      iov[i].iov_len = info[i].size;
+    }
+    do {
+      readbytes = readv (src->fd, iov, n_bufs);
+    } while (readbytes == -1 && errno == EINTR);
+#else
+    do {
+      readbytes = read (src->fd, info[0].data, info[0].size);
+    } while (readbytes == -1 && errno == EINTR);
+    n_bufs = 1;
+#endif
+    if (readbytes < 0) {
+      n_filled = -1;
+    } else {
+      /* the data was spread over the buffers in order */
+      for (i = 0; i < n_bufs && readbytes > 0; i++) {
+        sizes[i] = MIN ((gsize) readbytes, info[i].size);
+        readbytes -= sizes[i];
+      }
+      n_filled = i;
+    }
+  }
+  saved_errno = errno;
+
+  for (i = 0; i < n_bufs; i++)
+    gst_buffer_unmap (bufs[i], &info[i]);
+  for (i = 0; i < n_filled; i++)
+    gst_buffer_resize (bufs[i], 0, sizes[i]);
+
+  GST_LOG_OBJECT (src, "filled %d of %u blocks", n_filled, n_bufs);
+
+  errno = saved_errno;
+  return n_filled;
+}
+
+/* called after the poll said that the fd is readable, returns
+ * GST_FLOW_CUSTOM_SUCCESS when nothing could be read after all */
+static GstFlowReturn
+gst_fd_src_create_batch (GstFdSrc * src)
+{
+  GstBuffer *bufs[MAX_BATCH_SIZE];
+  GstBufferList *list;
+  GstClockTime deadline = GST_CLOCK_TIME_NONE, wait;
+  guint blocksize, n_bufs;
+  gint i, n_alloced = 0, n_filled;
+  gint retval;
+
+  blocksize = GST_BASE_SRC (src)->blocksize;
+  n_bufs = MIN (src->batch_size, MAX_BATCH_SIZE);
+  list = gst_buffer_list_new_sized (n_bufs);
+
+  if (src->batch_timeout > 0)
+    deadline = gst_util_get_timestamp () + src->batch_timeout * GST_USECOND;
+
+  while (gst_buffer_list_length (list) < n_bufs) {
+    gint n_wanted = n_bufs - gst_buffer_list_length (list);
+
+    /* buffers that were not filled last time are used again */
+    for (; n_alloced < n_wanted; n_alloced++) {
+      if (!(bufs[n_alloced] = gst_fd_src_alloc_block (src, blocksize)))
+        break;
+    }
+    if (n_alloced == 0)
+      goto alloc_failed;
+
+    n_filled = gst_fd_src_read_blocks (src, bufs, n_alloced);
+    if (n_filled < 0) {
+      if (errno != EAGAIN && errno != EWOULDBLOCK)
+        goto read_error;
+      n_filled = 0;
+    } else if (n_filled == 0) {
+      /* EOS, push what we have first */
+      if (gst_buffer_list_length (list) == 0)
+        goto eos;
+      break;
+    }
+
+    for (i = 0; i < n_filled; i++) {
+      GST_BUFFER_OFFSET (bufs[i]) = src->curoffset;
+      GST_BUFFER_TIMESTAMP (bufs[i]) = GST_CLOCK_TIME_NONE;
+      src->curoffset += gst_buffer_get_size (bufs[i]);
+      gst_buffer_list_add (list, bufs[i]);
+    }
+    n_alloced -= n_filled;
+    memmove (bufs, bufs + n_filled, n_alloced * sizeof (GstBuffer *));
+
+    if (gst_buffer_list_length (list) == n_bufs)
+      break;
+
+    /* wait for more data, but not longer than the batch timeout */
+    wait = 0;
+    if (GST_CLOCK_TIME_IS_VALID (deadline)) {
+      GstClockTime now = gst_util_get_timestamp ();
+
+      if (now >= deadline)
+        break;
+      wait = deadline - now;
+    }
+    do {
+      retval = gst_poll_wait (src->fdset, wait);
+    } while (retval == -1 && (errno == EINTR || errno == EAGAIN));
+    /* timeout, flushing or a poll error that the next create will see */
+    if (retval <= 0)
+      break;
+  }
+
+  for (i = 0; i < n_alloced; i++)
+    gst_buffer_unref (bufs[i]);
+
+  if (gst_buffer_list_length (list) == 0) {
+    /* spurious wakeup, go back to polling */
+    gst_buffer_list_unref (list);
+    return GST_FLOW_CUSTOM_SUCCESS;
+  }
+
+  GST_LOG_OBJECT (src, "pushing %u blocks", gst_buffer_list_length (list));
+  gst_base_src_submit_buffer_list (GST_BASE_SRC_CAST (src), list);
+
+  return GST_FLOW_OK;
+
+  /* ERRORS */
+alloc_failed:
+  {
+    GST_ERROR_OBJECT (src, "Failed to allocate %u bytes", blocksize);
+    gst_buffer_list_unref (list);
+    return GST_FLOW_ERROR;
+  }
+eos:
+  {
+    GST_DEBUG_OBJECT (src, "Read 0 bytes. EOS.");
+    for (i = 0; i < n_alloced; i++)
+      gst_buffer_unref (bufs[i]);
+    gst_buffer_list_unref (list);
+    return GST_FLOW_EOS;
+  }
+read_error:
+  {
+    GST_ELEMENT_ERROR (src, RESOURCE, READ, (NULL),
+        ("read on file descriptor: %s.", g_strerror (errno)));
+    GST_DEBUG_OBJECT (src, "Error reading from fd");
+    for (i = 0; i < n_alloced; i++)
+      gst_buffer_unref (bufs[i]);
+    gst_buffer_list_unref (list);
+    return GST_FLOW_ERROR;
+  }
+}
+#endif
+
 static GstFlowReturn
 gst_fd_src_create (GstPushSrc * psrc, GstBuffer ** outbuf)
 {
@@ -409,6 +745,7 @@ gst_fd_src_create (GstPushSrc * psrc, GstBuffer ** outbuf)
     timeout = GST_CLOCK_TIME_NONE;
   }
 
+again:
   do {
     try_again = FALSE;
 
@@ -436,6 +773,15 @@ gst_fd_src_create (GstPushSrc * psrc, GstBuffer ** outbuf)
                   "timeout", G_TYPE_UINT64, src->timeout, NULL)));
     }
   } while (G_UNLIKELY (try_again));     /* retry if interrupted or timeout */
+
+  if (src->batch_size > 1
+      && GST_PAD_MODE (GST_BASE_SRC_PAD (src)) == GST_PAD_MODE_PUSH) {
+    GstFlowReturn ret = gst_fd_src_create_batch (src);
+
+    if (ret == GST_FLOW_CUSTOM_SUCCESS)
+      goto again;
+    return ret;
+  }
 #endif
 
   blocksize = GST_BASE_SRC (src)->blocksize;
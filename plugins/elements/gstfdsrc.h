@@ -66,6 +66,13 @@ struct _GstFdSrc {
   /* poll timeout */
   guint64 timeout;
 
+  /* batched reads */
+  guint batch_size;
+  guint64 batch_timeout;
+  gboolean is_dgram;
+  GstBufferPool *pool;
+  gboolean pool_usable;
+
   gchar *uri;
 
   GstPoll *fdset;
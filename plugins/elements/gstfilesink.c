@@ -105,6 +105,23 @@ gst_file_sink_buffer_mode_get_type (void)
   return buffer_mode_type;
 }
 
+#define GST_TYPE_FILE_SINK_IO_MODE (gst_file_sink_io_mode_get_type ())
+static GType
+gst_file_sink_io_mode_get_type (void)
+{
+  static GType io_mode_type = 0;
+  static const GEnumValue io_mode[] = {
+    {GST_FILE_SINK_IO_MODE_SYNC, "Write from the streaming thread", "sync"},
+    {GST_FILE_SINK_IO_MODE_ASYNC, "Write from a separate thread", "async"},
+    {0, NULL, NULL},
+  };
+
+  if (!io_mode_type) {
+    io_mode_type = g_enum_register_static ("GstFileSinkIOMode", io_mode);
+  }
+  return io_mode_type;
+}
+
 GST_DEBUG_CATEGORY_STATIC (gst_file_sink_debug);
 #define GST_CAT_DEFAULT gst_file_sink_debug
 
@@ -112,6 +129,8 @@ GST_DEBUG_CATEGORY_STATIC (gst_file_sink_debug);
 #define DEFAULT_BUFFER_MODE 	GST_FILE_SINK_BUFFER_MODE_DEFAULT
 #define DEFAULT_BUFFER_SIZE 	64 * 1024
 #define DEFAULT_APPEND		FALSE
+#define DEFAULT_IO_MODE		GST_FILE_SINK_IO_MODE_SYNC
+#define DEFAULT_MAX_BYTES_IN_FLIGHT	(4 * 1024 * 1024)
 
 enum
 {
@@ -120,6 +139,8 @@ enum
   PROP_BUFFER_MODE,
   PROP_BUFFER_SIZE,
   PROP_APPEND,
+  PROP_IO_MODE,
+  PROP_MAX_BYTES_IN_FLIGHT,
   PROP_LAST
 };
 
@@ -162,6 +183,7 @@ gst_fopen (const gchar * filename, const gchar * mode)
 }
 
 static void gst_file_sink_dispose (GObject * object);
+static void gst_file_sink_finalize (GObject * object);
 
 static void gst_file_sink_set_property (GObject * object, guint prop_id,
     const GValue * value, GParamSpec * pspec);
@@ -174,6 +196,8 @@ static void gst_file_sink_close_file (GstFileSink * sink);
 static gboolean gst_file_sink_start (GstBaseSink * sink);
 static gboolean gst_file_sink_stop (GstBaseSink * sink);
 static gboolean gst_file_sink_event (GstBaseSink * sink, GstEvent * event);
+static gboolean gst_file_sink_unlock (GstBaseSink * sink);
+static gboolean gst_file_sink_unlock_stop (GstBaseSink * sink);
 static GstFlowReturn gst_file_sink_render (GstBaseSink * sink,
     GstBuffer * buffer);
 static GstFlowReturn gst_file_sink_render_list (GstBaseSink * sink,
@@ -185,6 +209,8 @@ static gboolean gst_file_sink_get_current_offset (GstFileSink * filesink,
     guint64 * p_pos);
 
 static gboolean gst_file_sink_query (GstBaseSink * bsink, GstQuery * query);
+static gboolean gst_file_sink_propose_allocation (GstBaseSink * bsink,
+    GstQuery * query);
 
 static void gst_file_sink_uri_handler_init (gpointer g_iface,
     gpointer iface_data);
@@ -204,6 +230,7 @@ gst_file_sink_class_init (GstFileSinkClass * klass)
   GstBaseSinkClass *gstbasesink_class = GST_BASE_SINK_CLASS (klass);
 
   gobject_class->dispose = gst_file_sink_dispose;
+  gobject_class->finalize = gst_file_sink_finalize;
 
   gobject_class->set_property = gst_file_sink_set_property;
   gobject_class->get_property = gst_file_sink_get_property;
@@ -234,6 +261,35 @@ gst_file_sink_class_init (GstFileSinkClass * klass)
           "Append to an already existing file", DEFAULT_APPEND,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstFileSink:io-mode
+   *
+   * In async mode buffers are handed to a writer thread and the streaming
+   * thread only blocks when more than #GstFileSink:max-bytes-in-flight are
+   * waiting to be written. Write errors are reported on the next buffer.
+   *
+   * Since: 1.10
+   */
+  g_object_class_install_property (gobject_class, PROP_IO_MODE,
+      g_param_spec_enum ("io-mode", "IO mode",
+          "How buffers are written to the file", GST_TYPE_FILE_SINK_IO_MODE,
+          DEFAULT_IO_MODE, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_READY));
+
+  /**
+   * GstFileSink:max-bytes-in-flight
+   *
+   * The maximum number of bytes queued for the writer thread in async
+   * #GstFileSink:io-mode before the streaming thread blocks.
+   *
+   * Since: 1.10
+   */
+  g_object_class_install_property (gobject_class, PROP_MAX_BYTES_IN_FLIGHT,
+      g_param_spec_uint64 ("max-bytes-in-flight", "Max bytes in flight",
+          "Maximum number of bytes waiting to be written in async io-mode",
+          1, G_MAXUINT64, DEFAULT_MAX_BYTES_IN_FLIGHT,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gst_element_class_set_static_metadata (gstelement_class,
       "File Sink",
       "Sink/File", "Write stream to a file",
@@ -243,10 +299,15 @@ gst_file_sink_class_init (GstFileSinkClass * klass)
   gstbasesink_class->start = GST_DEBUG_FUNCPTR (gst_file_sink_start);
   gstbasesink_class->stop = GST_DEBUG_FUNCPTR (gst_file_sink_stop);
   gstbasesink_class->query = GST_DEBUG_FUNCPTR (gst_file_sink_query);
+  gstbasesink_class->propose_allocation =
+      GST_DEBUG_FUNCPTR (gst_file_sink_propose_allocation);
   gstbasesink_class->render = GST_DEBUG_FUNCPTR (gst_file_sink_render);
   gstbasesink_class->render_list =
       GST_DEBUG_FUNCPTR (gst_file_sink_render_list);
   gstbasesink_class->event = GST_DEBUG_FUNCPTR (gst_file_sink_event);
+  gstbasesink_class->unlock = GST_DEBUG_FUNCPTR (gst_file_sink_unlock);
+  gstbasesink_class->unlock_stop =
+      GST_DEBUG_FUNCPTR (gst_file_sink_unlock_stop);
 
   if (sizeof (off_t) < 8) {
     GST_LOG ("No large file support, sizeof (off_t) = %" G_GSIZE_FORMAT "!",
@@ -264,6 +325,12 @@ gst_file_sink_init (GstFileSink * filesink)
   filesink->buffer_size = DEFAULT_BUFFER_SIZE;
   filesink->buffer = NULL;
   filesink->append = FALSE;
+  filesink->io_mode = DEFAULT_IO_MODE;
+  filesink->max_bytes_in_flight = DEFAULT_MAX_BYTES_IN_FLIGHT;
+
+  g_mutex_init (&filesink->writer_lock);
+  g_cond_init (&filesink->writer_cond);
+  g_queue_init (&filesink->writer_queue);
 
   gst_base_sink_set_sync (GST_BASE_SINK (filesink), FALSE);
 }
@@ -284,6 +351,17 @@ gst_file_sink_dispose (GObject * object)
   sink->buffer_size = 0;
 }
 
+static void
+gst_file_sink_finalize (GObject * object)
+{
+  GstFileSink *sink = GST_FILE_SINK (object);
+
+  g_mutex_clear (&sink->writer_lock);
+  g_cond_clear (&sink->writer_cond);
+
+  G_OBJECT_CLASS (parent_class)->finalize (object);
+}
+
 static gboolean
 gst_file_sink_set_location (GstFileSink * sink, const gchar * location,
     GError ** error)
@@ -338,6 +416,15 @@ gst_file_sink_set_property (GObject * object, guint prop_id,
     case PROP_APPEND:
       sink->append = g_value_get_boolean (value);
       break;
+    case PROP_IO_MODE:
+      sink->io_mode = g_value_get_enum (value);
+      break;
+    case PROP_MAX_BYTES_IN_FLIGHT:
+      g_mutex_lock (&sink->writer_lock);
+      sink->max_bytes_in_flight = g_value_get_uint64 (value);
+      g_cond_broadcast (&sink->writer_cond);
+      g_mutex_unlock (&sink->writer_lock);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -363,12 +450,162 @@ gst_file_sink_get_property (GObject * object, guint prop_id, GValue * value,
     case PROP_APPEND:
       g_value_set_boolean (value, sink->append);
       break;
+    case PROP_IO_MODE:
+      g_value_set_enum (value, sink->io_mode);
+      break;
+    case PROP_MAX_BYTES_IN_FLIGHT:
+      g_value_set_uint64 (value, sink->max_bytes_in_flight);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
   }
 }
 
+/* the async writer thread, writes the queued buffers in order until it is
+ * stopped and the queue is empty. After an error the remaining buffers are
+ * dropped and the error is returned from the next render call. */
+static gpointer
+gst_file_sink_writer_func (GstFileSink * sink)
+{
+  guint64 write_pos = 0;
+
+  g_mutex_lock (&sink->writer_lock);
+  while (TRUE) {
+    GstBuffer *buffer;
+    GstFlowReturn flow;
+    gsize size;
+
+    while (g_queue_is_empty (&sink->writer_queue) && !sink->writer_stop)
+      g_cond_wait (&sink->writer_cond, &sink->writer_lock);
+
+    buffer = g_queue_pop_head (&sink->writer_queue);
+    if (buffer == NULL)
+      break;
+
+    sink->writer_busy = TRUE;
+    flow = sink->writer_flow;
+    g_mutex_unlock (&sink->writer_lock);
+
+    size = gst_buffer_get_size (buffer);
+    if (flow == GST_FLOW_OK && size > 0) {
+      guint8 n_mem = gst_buffer_n_memory (buffer);
+
+      flow = gst_writev_buffers (GST_OBJECT_CAST (sink), fileno (sink->file),
+          NULL, &buffer, 1, &n_mem, n_mem, NULL, &write_pos);
+    }
+    if (flow == GST_FLOW_OK &&
+        GST_BUFFER_FLAG_IS_SET (buffer, GST_BUFFER_FLAG_SYNC_AFTER)) {
+      if (fsync (fileno (sink->file))) {
+        GST_ELEMENT_ERROR (sink, RESOURCE, WRITE,
+            (_("Error while writing to file \"%s\"."), sink->filename),
+            ("%s", g_strerror (errno)));
+        flow = GST_FLOW_ERROR;
+      }
+    }
+    gst_buffer_unref (buffer);
+
+    g_mutex_lock (&sink->writer_lock);
+    sink->writer_busy = FALSE;
+    sink->bytes_in_flight -= size;
+    if (flow != GST_FLOW_OK && sink->writer_flow == GST_FLOW_OK)
+      sink->writer_flow = flow;
+    g_cond_broadcast (&sink->writer_cond);
+  }
+  g_mutex_unlock (&sink->writer_lock);
+
+  GST_DEBUG_OBJECT (sink, "writer thread stopped");
+
+  return NULL;
+}
+
+/* wait until the writer thread wrote everything. Returns the result of the
+ * writes */
+static GstFlowReturn
+gst_file_sink_writer_drain (GstFileSink * sink)
+{
+  GstFlowReturn flow;
+
+  if (sink->writer == NULL)
+    return GST_FLOW_OK;
+
+  g_mutex_lock (&sink->writer_lock);
+  while (!g_queue_is_empty (&sink->writer_queue) || sink->writer_busy)
+    g_cond_wait (&sink->writer_cond, &sink->writer_lock);
+  flow = sink->writer_flow;
+  g_mutex_unlock (&sink->writer_lock);
+
+  return flow;
+}
+
+/* drop the queued buffers and wait for the one being written */
+static void
+gst_file_sink_writer_flush (GstFileSink * sink)
+{
+  GstBuffer *buffer;
+
+  if (sink->writer == NULL)
+    return;
+
+  g_mutex_lock (&sink->writer_lock);
+  while ((buffer = g_queue_pop_head (&sink->writer_queue))) {
+    sink->bytes_in_flight -= gst_buffer_get_size (buffer);
+    gst_buffer_unref (buffer);
+  }
+  while (sink->writer_busy)
+    g_cond_wait (&sink->writer_cond, &sink->writer_lock);
+  sink->writer_flow = GST_FLOW_OK;
+  g_mutex_unlock (&sink->writer_lock);
+}
+
+/* hand @buffer to the writer thread, blocks while too many bytes are
+ * waiting to be written */
+static GstFlowReturn
+gst_file_sink_writer_queue (GstFileSink * sink, GstBuffer * buffer)
+{
+  GstFlowReturn flow;
+  gsize size;
+
+  size = gst_buffer_get_size (buffer);
+
+  g_mutex_lock (&sink->writer_lock);
+  while (sink->writer_flow == GST_FLOW_OK && !sink->writer_flushing &&
+      sink->bytes_in_flight > 0 &&
+      sink->bytes_in_flight + size > sink->max_bytes_in_flight) {
+    GST_LOG_OBJECT (sink, "%" G_GUINT64_FORMAT " bytes in flight, waiting",
+        sink->bytes_in_flight);
+    g_cond_wait (&sink->writer_cond, &sink->writer_lock);
+  }
+  if (G_UNLIKELY (sink->writer_flushing))
+    goto flushing;
+  if (G_UNLIKELY ((flow = sink->writer_flow) != GST_FLOW_OK))
+    goto write_error;
+
+  g_queue_push_tail (&sink->writer_queue, gst_buffer_ref (buffer));
+  sink->bytes_in_flight += size;
+  g_cond_broadcast (&sink->writer_cond);
+  g_mutex_unlock (&sink->writer_lock);
+
+  sink->current_pos += size;
+
+  return GST_FLOW_OK;
+
+  /* ERRORS */
+flushing:
+  {
+    GST_DEBUG_OBJECT (sink, "we are flushing");
+    g_mutex_unlock (&sink->writer_lock);
+    return GST_FLOW_FLUSHING;
+  }
+write_error:
+  {
+    GST_DEBUG_OBJECT (sink, "writer thread failed: %s",
+        gst_flow_get_name (flow));
+    g_mutex_unlock (&sink->writer_lock);
+    return flow;
+  }
+}
+
 static gboolean
 gst_file_sink_open_file (GstFileSink * sink)
 {
@@ -422,6 +659,16 @@ gst_file_sink_open_file (GstFileSink * sink)
   GST_DEBUG_OBJECT (sink, "opened file %s, seekable %d",
       sink->filename, sink->seekable);
 
+  if (sink->io_mode == GST_FILE_SINK_IO_MODE_ASYNC) {
+    sink->writer_stop = FALSE;
+    sink->writer_flushing = FALSE;
+    sink->writer_busy = FALSE;
+    sink->writer_flow = GST_FLOW_OK;
+    sink->bytes_in_flight = 0;
+    sink->writer = g_thread_new ("filesink-writer",
+        (GThreadFunc) gst_file_sink_writer_func, sink);
+  }
+
   return TRUE;
 
   /* ERRORS */
@@ -443,6 +690,16 @@ open_failed:
 static void
 gst_file_sink_close_file (GstFileSink * sink)
 {
+  if (sink->writer) {
+    /* the writer thread writes what is left before stopping */
+    g_mutex_lock (&sink->writer_lock);
+    sink->writer_stop = TRUE;
+    g_cond_broadcast (&sink->writer_cond);
+    g_mutex_unlock (&sink->writer_lock);
+    g_thread_join (sink->writer);
+    sink->writer = NULL;
+  }
+
   if (sink->file) {
     if (fclose (sink->file) != 0)
       GST_ELEMENT_ERROR (sink, RESOURCE, CLOSE,
@@ -456,6 +713,15 @@ gst_file_sink_close_file (GstFileSink * sink)
   }
 }
 
+/* we can send file backed memory from filesrc with sendfile() */
+static gboolean
+gst_file_sink_propose_allocation (GstBaseSink * bsink, GstQuery * query)
+{
+  gst_fd_chunk_query_add_allocator (query);
+
+  return TRUE;
+}
+
 static gboolean
 gst_file_sink_query (GstBaseSink * bsink, GstQuery * query)
 {
@@ -522,6 +788,9 @@ gst_file_sink_do_seek (GstFileSink * filesink, guint64 new_offset)
   GST_DEBUG_OBJECT (filesink, "Seeking to offset %" G_GUINT64_FORMAT
       " using " __GST_STDIO_SEEK_FUNCTION, new_offset);
 
+  if (gst_file_sink_writer_drain (filesink) != GST_FLOW_OK)
+    goto flush_failed;
+
   if (fflush (filesink->file))
     goto flush_failed;
 
@@ -595,6 +864,7 @@ gst_file_sink_event (GstBaseSink * sink, GstEvent * event)
       break;
     }
     case GST_EVENT_FLUSH_STOP:
+      gst_file_sink_writer_flush (filesink);
       if (filesink->current_pos != 0 && filesink->seekable) {
         gst_file_sink_do_seek (filesink, 0);
         if (ftruncate (fileno (filesink->file), 0))
@@ -602,6 +872,8 @@ gst_file_sink_event (GstBaseSink * sink, GstEvent * event)
       }
       break;
     case GST_EVENT_EOS:
+      if (gst_file_sink_writer_drain (filesink) != GST_FLOW_OK)
+        goto write_failed;
       if (fflush (filesink->file))
         goto flush_failed;
       break;
@@ -628,6 +900,37 @@ flush_failed:
     gst_event_unref (event);
     return FALSE;
   }
+write_failed:
+  {
+    /* the writer thread already posted an error */
+    gst_event_unref (event);
+    return FALSE;
+  }
+}
+
+static gboolean
+gst_file_sink_unlock (GstBaseSink * sink)
+{
+  GstFileSink *filesink = GST_FILE_SINK_CAST (sink);
+
+  g_mutex_lock (&filesink->writer_lock);
+  filesink->writer_flushing = TRUE;
+  g_cond_broadcast (&filesink->writer_cond);
+  g_mutex_unlock (&filesink->writer_lock);
+
+  return TRUE;
+}
+
+static gboolean
+gst_file_sink_unlock_stop (GstBaseSink * sink)
+{
+  GstFileSink *filesink = GST_FILE_SINK_CAST (sink);
+
+  g_mutex_lock (&filesink->writer_lock);
+  filesink->writer_flushing = FALSE;
+  g_mutex_unlock (&filesink->writer_lock);
+
+  return TRUE;
 }
 
 static gboolean
@@ -682,6 +985,13 @@ gst_file_sink_render_list (GstBaseSink * bsink, GstBufferList * buffer_list)
   if (num_buffers == 0)
     goto no_data;
 
+  if (sink->writer) {
+    for (i = 0, flow = GST_FLOW_OK; i < num_buffers && flow == GST_FLOW_OK; ++i)
+      flow = gst_file_sink_writer_queue (sink,
+          gst_buffer_list_get (buffer_list, i));
+    return flow;
+  }
+
   /* extract buffers from list and count memories */
   buffers = g_newa (GstBuffer *, num_buffers);
   mem_nums = g_newa (guint8, num_buffers);
@@ -724,6 +1034,9 @@ gst_file_sink_render (GstBaseSink * sink, GstBuffer * buffer)
 
   filesink = GST_FILE_SINK_CAST (sink);
 
+  if (filesink->writer)
+    return gst_file_sink_writer_queue (filesink, buffer);
+
   n_mem = gst_buffer_n_memory (buffer);
 
   if (n_mem > 0)
@@ -62,6 +62,20 @@ typedef enum {
   GST_FILE_SINK_BUFFER_MODE_UNBUFFERED = _IONBF
 } GstFileSinkBufferMode;
 
+/**
+ * GstFileSinkIOMode:
+ * @GST_FILE_SINK_IO_MODE_SYNC: Write from the streaming thread
+ * @GST_FILE_SINK_IO_MODE_ASYNC: Write from a separate writer thread
+ *
+ * How buffers are written to the file.
+ *
+ * Since: 1.10
+ */
+typedef enum {
+  GST_FILE_SINK_IO_MODE_SYNC,
+  GST_FILE_SINK_IO_MODE_ASYNC
+} GstFileSinkIOMode;
+
 /**
  * GstFileSink:
  *
@@ -83,6 +97,20 @@ struct _GstFileSink {
   gchar  *buffer;
 
   gboolean append;
+
+  gint     io_mode;
+  guint64  max_bytes_in_flight;
+
+  /* async writer thread, protected by writer_lock */
+  GThread *writer;
+  GMutex   writer_lock;
+  GCond    writer_cond;
+  GQueue   writer_queue;
+  guint64  bytes_in_flight;
+  gboolean writer_busy;
+  gboolean writer_stop;
+  gboolean writer_flushing;
+  GstFlowReturn writer_flow;
 };
 
 struct _GstFileSinkClass {
@@ -64,6 +64,9 @@
 #ifdef HAVE_UNISTD_H
 #  include <unistd.h>
 #endif
+#ifdef HAVE_MMAP
+#  include <sys/mman.h>
+#endif
 
 #ifdef __BIONIC__               /* Android */
 #undef lseek
@@ -138,11 +141,15 @@ enum
 };
 
 #define DEFAULT_BLOCKSIZE       4*1024
+#define DEFAULT_USE_MMAP        FALSE
+#define DEFAULT_MMAPSIZE        4*1024*1024
 
 enum
 {
   PROP_0,
-  PROP_LOCATION
+  PROP_LOCATION,
+  PROP_USE_MMAP,
+  PROP_MMAPSIZE
 };
 
 static void gst_file_src_finalize (GObject * object);
@@ -157,8 +164,12 @@ static gboolean gst_file_src_stop (GstBaseSrc * basesrc);
 
 static gboolean gst_file_src_is_seekable (GstBaseSrc * src);
 static gboolean gst_file_src_get_size (GstBaseSrc * src, guint64 * size);
+static GstFlowReturn gst_file_src_create (GstBaseSrc * src, guint64 offset,
+    guint length, GstBuffer ** buf);
 static GstFlowReturn gst_file_src_fill (GstBaseSrc * src, guint64 offset,
     guint length, GstBuffer * buf);
+static gboolean gst_file_src_decide_allocation (GstBaseSrc * src,
+    GstQuery * query);
 
 static void gst_file_src_uri_handler_init (gpointer g_iface,
     gpointer iface_data);
@@ -189,6 +200,38 @@ gst_file_src_class_init (GstFileSrcClass * klass)
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
           GST_PARAM_MUTABLE_READY));
 
+  /**
+   * GstFileSrc:use-mmap:
+   *
+   * Map the file into memory and push buffers that point into the mapping
+   * instead of copying the data. Only regular files can be mapped. The file
+   * must not be truncated while the element is running, accessing a mapping
+   * past the end of the file makes the process crash. On systems without
+   * mmap() this property has no effect.
+   *
+   * Since: 1.10
+   */
+  g_object_class_install_property (gobject_class, PROP_USE_MMAP,
+      g_param_spec_boolean ("use-mmap", "Use mmap",
+          "Whether to push buffers mapped from the file instead of copying "
+          "them", DEFAULT_USE_MMAP,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_READY));
+
+  /**
+   * GstFileSrc:mmapsize:
+   *
+   * The size of the windows of the file that are mapped at once when
+   * #GstFileSrc:use-mmap is enabled. Larger reads map a larger window.
+   *
+   * Since: 1.10
+   */
+  g_object_class_install_property (gobject_class, PROP_MMAPSIZE,
+      g_param_spec_uint64 ("mmapsize", "mmap() Block Size",
+          "Size in bytes of the mapped windows of the file", 1, G_MAXUINT64,
+          DEFAULT_MMAPSIZE, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_READY));
+
   gobject_class->finalize = gst_file_src_finalize;
 
   gst_element_class_set_static_metadata (gstelement_class,
@@ -202,7 +245,10 @@ gst_file_src_class_init (GstFileSrcClass * klass)
   gstbasesrc_class->stop = GST_DEBUG_FUNCPTR (gst_file_src_stop);
   gstbasesrc_class->is_seekable = GST_DEBUG_FUNCPTR (gst_file_src_is_seekable);
   gstbasesrc_class->get_size = GST_DEBUG_FUNCPTR (gst_file_src_get_size);
+  gstbasesrc_class->create = GST_DEBUG_FUNCPTR (gst_file_src_create);
   gstbasesrc_class->fill = GST_DEBUG_FUNCPTR (gst_file_src_fill);
+  gstbasesrc_class->decide_allocation =
+      GST_DEBUG_FUNCPTR (gst_file_src_decide_allocation);
 
   if (sizeof (off_t) < 8) {
     GST_LOG ("No large file support, sizeof (off_t) = %" G_GSIZE_FORMAT "!",
@@ -219,6 +265,10 @@ gst_file_src_init (GstFileSrc * src)
 
   src->is_regular = FALSE;
 
+  src->use_mmap = DEFAULT_USE_MMAP;
+  src->mmapsize = DEFAULT_MMAPSIZE;
+  src->mapping = NULL;
+
   gst_base_src_set_blocksize (GST_BASE_SRC (src), DEFAULT_BLOCKSIZE);
 }
 
@@ -291,6 +341,12 @@ gst_file_src_set_property (GObject * object, guint prop_id,
     case PROP_LOCATION:
       gst_file_src_set_location (src, g_value_get_string (value));
       break;
+    case PROP_USE_MMAP:
+      src->use_mmap = g_value_get_boolean (value);
+      break;
+    case PROP_MMAPSIZE:
+      src->mmapsize = g_value_get_uint64 (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -311,6 +367,12 @@ gst_file_src_get_property (GObject * object, guint prop_id, GValue * value,
     case PROP_LOCATION:
       g_value_set_string (value, src->filename);
       break;
+    case PROP_USE_MMAP:
+      g_value_set_boolean (value, src->use_mmap);
+      break;
+    case PROP_MMAPSIZE:
+      g_value_set_uint64 (value, src->mmapsize);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -416,6 +478,256 @@ buffer_write_fail:
   }
 }
 
+#ifdef HAVE_MMAP
+/* a mapped window of the file, the memory we push holds a ref on it so that
+ * it stays mapped until downstream released all buffers */
+struct _GstFileSrcMapping
+{
+  gint refcount;
+  guint8 *data;
+  gsize size;
+  guint64 offset;               /* offset of the window in the file */
+};
+
+static GstFileSrcMapping *
+gst_file_src_mapping_ref (GstFileSrcMapping * mapping)
+{
+  g_atomic_int_inc (&mapping->refcount);
+  return mapping;
+}
+
+static void
+gst_file_src_mapping_unref (GstFileSrcMapping * mapping)
+{
+  if (g_atomic_int_dec_and_test (&mapping->refcount)) {
+    munmap (mapping->data, mapping->size);
+    g_slice_free (GstFileSrcMapping, mapping);
+  }
+}
+
+/* tell the kernel how we are going to access the current window */
+static void
+gst_file_src_mapping_advise (GstFileSrc * src, guint64 offset, guint length)
+{
+#ifdef POSIX_MADV_SEQUENTIAL
+  GstFileSrcMapping *mapping = src->mapping;
+
+  if (src->map_sequential) {
+    /* read ahead the window aggressively and drop the pages we passed */
+    posix_madvise (mapping->data, mapping->size, POSIX_MADV_SEQUENTIAL);
+    posix_madvise (mapping->data, mapping->size, POSIX_MADV_WILLNEED);
+  } else {
+    gsize start = offset - mapping->offset;
+    gsize page_size = sysconf (_SC_PAGESIZE);
+
+    /* only prefetch what was asked for */
+    posix_madvise (mapping->data, mapping->size, POSIX_MADV_RANDOM);
+    start -= start % page_size;
+    posix_madvise (mapping->data + start,
+        MIN (offset - mapping->offset + length - start, mapping->size - start),
+        POSIX_MADV_WILLNEED);
+  }
+#endif
+}
+
+/* map a window of the file that contains @offset to @offset + @length */
+static GstFileSrcMapping *
+gst_file_src_map_window (GstFileSrc * src, guint64 offset, guint length)
+{
+  GstFileSrcMapping *mapping;
+  guint64 page_size, start, size;
+  gpointer data;
+
+  page_size = sysconf (_SC_PAGESIZE);
+  start = offset - offset % page_size;
+  size = MAX (src->mmapsize, offset + length - start);
+  if (start + size > src->map_file_size)
+    size = src->map_file_size - start;
+  if (size > G_MAXSIZE)
+    return NULL;
+
+  GST_LOG_OBJECT (src, "mapping %" G_GUINT64_FORMAT " bytes at offset %"
+      G_GUINT64_FORMAT, size, start);
+
+  data = mmap (NULL, size, PROT_READ, MAP_SHARED, src->fd, start);
+  if (data == MAP_FAILED)
+    return NULL;
+
+  mapping = g_slice_new (GstFileSrcMapping);
+  mapping->refcount = 1;
+  mapping->data = data;
+  mapping->size = size;
+  mapping->offset = start;
+
+  return mapping;
+}
+
+static GstFlowReturn
+gst_file_src_create_mmap (GstFileSrc * src, guint64 offset, guint length,
+    GstBuffer ** buffer)
+{
+  GstFileSrcMapping *mapping;
+  GstBuffer *buf;
+  gboolean sequential;
+
+  if (offset == -1)
+    offset = src->map_position;
+
+  /* the file can grow, check the size again when reading past its end */
+  if (offset + length > src->map_file_size) {
+    struct stat stat_results;
+
+    if (fstat (src->fd, &stat_results) < 0)
+      goto could_not_stat;
+    src->map_file_size = stat_results.st_size;
+  }
+
+  if (offset >= src->map_file_size)
+    goto eos;
+  if (offset + length > src->map_file_size)
+    length = src->map_file_size - offset;
+
+  sequential = (offset == src->map_position);
+  src->map_position = offset + length;
+
+  buf = gst_buffer_new ();
+  if (length > 0) {
+    mapping = src->mapping;
+    if (mapping == NULL || offset < mapping->offset ||
+        offset + length > mapping->offset + mapping->size) {
+      /* we need a new window, the old one stays mapped until all buffers
+       * pointing into it are released */
+      if (mapping)
+        gst_file_src_mapping_unref (mapping);
+      mapping = src->mapping = gst_file_src_map_window (src, offset, length);
+      if (mapping == NULL)
+        goto map_failed;
+      src->map_sequential = sequential;
+      gst_file_src_mapping_advise (src, offset, length);
+    } else if (sequential != src->map_sequential) {
+      src->map_sequential = sequential;
+      gst_file_src_mapping_advise (src, offset, length);
+    }
+
+    gst_buffer_append_memory (buf,
+        gst_memory_new_wrapped (GST_MEMORY_FLAG_READONLY, mapping->data,
+            mapping->size, offset - mapping->offset, length,
+            gst_file_src_mapping_ref (mapping),
+            (GDestroyNotify) gst_file_src_mapping_unref));
+  }
+
+  GST_BUFFER_OFFSET (buf) = offset;
+  GST_BUFFER_OFFSET_END (buf) = offset + length;
+
+  *buffer = buf;
+
+  return GST_FLOW_OK;
+
+  /* ERROR */
+could_not_stat:
+  {
+    GST_ELEMENT_ERROR (src, RESOURCE, READ, (NULL), GST_ERROR_SYSTEM);
+    return GST_FLOW_ERROR;
+  }
+eos:
+  {
+    GST_DEBUG ("EOS");
+    return GST_FLOW_EOS;
+  }
+map_failed:
+  {
+    GST_ELEMENT_ERROR (src, RESOURCE, READ, (NULL),
+        ("mmap of %u bytes at offset %" G_GUINT64_FORMAT " failed: %s",
+            length, offset, g_strerror (errno)));
+    gst_buffer_unref (buf);
+    return GST_FLOW_ERROR;
+  }
+}
+#endif
+
+/* push memory that only refers to the file region, sinks send it with
+ * sendfile() and everything else reads it when mapping */
+static GstFlowReturn
+gst_file_src_create_fd_chunk (GstFileSrc * src, guint64 offset, guint length,
+    GstBuffer ** buffer)
+{
+  struct stat stat_results;
+  GstBuffer *buf;
+
+  if (offset == -1)
+    offset = src->chunk_position;
+
+  /* the file can grow, check the size every time */
+  if (fstat (src->fd, &stat_results) < 0)
+    goto could_not_stat;
+
+  if (offset >= (guint64) stat_results.st_size)
+    goto eos;
+  if (offset + length > (guint64) stat_results.st_size)
+    length = stat_results.st_size - offset;
+
+  src->chunk_position = offset + length;
+
+  GST_LOG_OBJECT (src, "file backed memory of %u bytes at offset %"
+      G_GUINT64_FORMAT, length, offset);
+
+  buf = gst_buffer_new ();
+  gst_buffer_append_memory (buf,
+      gst_fd_chunk_memory_new (src->chunk_file, offset, length));
+
+  GST_BUFFER_OFFSET (buf) = offset;
+  GST_BUFFER_OFFSET_END (buf) = offset + length;
+
+  *buffer = buf;
+
+  return GST_FLOW_OK;
+
+  /* ERROR */
+could_not_stat:
+  {
+    GST_ELEMENT_ERROR (src, RESOURCE, READ, (NULL), GST_ERROR_SYSTEM);
+    return GST_FLOW_ERROR;
+  }
+eos:
+  {
+    GST_DEBUG ("EOS");
+    return GST_FLOW_EOS;
+  }
+}
+
+static GstFlowReturn
+gst_file_src_create (GstBaseSrc * basesrc, guint64 offset, guint length,
+    GstBuffer ** buffer)
+{
+  GstFileSrc *src = GST_FILE_SRC_CAST (basesrc);
+
+  /* when downstream provides a buffer we have to fill it */
+  if (src->use_fd_memory && src->chunk_file && *buffer == NULL)
+    return gst_file_src_create_fd_chunk (src, offset, length, buffer);
+
+#ifdef HAVE_MMAP
+  if (src->use_mmap && src->seekable && *buffer == NULL)
+    return gst_file_src_create_mmap (src, offset, length, buffer);
+#endif
+
+  return GST_BASE_SRC_CLASS (parent_class)->create (basesrc, offset, length,
+      buffer);
+}
+
+static gboolean
+gst_file_src_decide_allocation (GstBaseSrc * basesrc, GstQuery * query)
+{
+  GstFileSrc *src = GST_FILE_SRC_CAST (basesrc);
+
+  /* the sink proposed the file backed memory allocator */
+  src->use_fd_memory = gst_fd_chunk_query_has_allocator (query);
+  GST_DEBUG_OBJECT (src, "downstream %s file backed memory",
+      src->use_fd_memory ? "accepts" : "does not accept");
+
+  return GST_BASE_SRC_CLASS (parent_class)->decide_allocation (basesrc,
+      query);
+}
+
 static gboolean
 gst_file_src_is_seekable (GstBaseSrc * basesrc)
 {
@@ -513,6 +825,15 @@ gst_file_src_start (GstBaseSrc * basesrc)
 
   gst_base_src_set_dynamic_size (basesrc, src->seekable);
 
+  src->map_position = 0;
+  src->map_file_size = 0;
+  src->map_sequential = TRUE;
+
+  /* file backed memory needs a file that does not move under us */
+  src->chunk_position = 0;
+  if (src->is_regular)
+    src->chunk_file = gst_fd_chunk_file_new (src->fd);
+
   return TRUE;
 
   /* ERROR */
@@ -574,6 +895,21 @@ gst_file_src_stop (GstBaseSrc * basesrc)
 {
   GstFileSrc *src = GST_FILE_SRC (basesrc);
 
+#ifdef HAVE_MMAP
+  /* buffers still downstream keep their window mapped */
+  if (src->mapping) {
+    gst_file_src_mapping_unref (src->mapping);
+    src->mapping = NULL;
+  }
+#endif
+
+  /* buffers still downstream keep their own reference to the file */
+  if (src->chunk_file) {
+    gst_fd_chunk_file_unref (src->chunk_file);
+    src->chunk_file = NULL;
+  }
+  src->use_fd_memory = FALSE;
+
   /* close the file */
   close (src->fd);
 
@@ -29,6 +29,8 @@
 #include <gst/gst.h>
 #include <gst/base/gstbasesrc.h>
 
+#include "gstelements_private.h"
+
 G_BEGIN_DECLS
 
 #define GST_TYPE_FILE_SRC \
@@ -45,6 +47,7 @@ G_BEGIN_DECLS
 
 typedef struct _GstFileSrc GstFileSrc;
 typedef struct _GstFileSrcClass GstFileSrcClass;
+typedef struct _GstFileSrcMapping GstFileSrcMapping;
 
 /**
  * GstFileSrc:
@@ -63,6 +66,19 @@ struct _GstFileSrc {
   gboolean seekable;                    /* whether the file is seekable */
   gboolean is_regular;                  /* whether it's a (symlink to a)
                                            regular file */
+
+  gboolean use_mmap;                    /* hand out memory mapped from the
+                                           file instead of reading */
+  guint64 mmapsize;                     /* size of the mapped windows */
+  GstFileSrcMapping *mapping;           /* the current mapped window */
+  guint64 map_position;                 /* end of the last mapped read */
+  guint64 map_file_size;                /* file size when last checked */
+  gboolean map_sequential;              /* current access pattern hint */
+
+  GstFdChunkFile *chunk_file;           /* the file for file backed memory */
+  gboolean use_fd_memory;               /* downstream wants file backed
+                                           memory */
+  guint64 chunk_position;               /* end of the last file backed read */
 };
 
 struct _GstFileSrcClass {
@@ -36,6 +36,13 @@
  * the different input streams but simply forwards all buffers
  * immediately when they arrive.
  *
+ * With #GstFunnel:combine-pushes, a streaming thread that finds another
+ * thread pushing on the source pad does not wait for it. It queues its
+ * buffer and returns, and the pushing thread sends that buffer downstream
+ * too before it releases the source pad. This avoids serializing many input
+ * threads on one lock, at the cost of returning the last flow return of the
+ * source pad instead of the result of pushing the buffer itself.
+ *
  */
 
 #ifdef HAVE_CONFIG_H
@@ -107,14 +114,24 @@ G_DEFINE_TYPE (GstFunnelPad, gst_funnel_pad, GST_TYPE_PAD);
 
 #define DEFAULT_FORWARD_STICKY_EVENTS       TRUE
 #define DEFAULT_FORWARD_STICKY_EVENTS_MODE  GST_FUNNEL_FORWARD_STICKY_EVENTS_MODE_ALWAYS
+#define DEFAULT_COMBINE_PUSHES              FALSE
 
 enum
 {
   PROP_0,
   PROP_FORWARD_STICKY_EVENTS,
-  PROP_FORWARD_STICKY_EVENTS_MODE
+  PROP_FORWARD_STICKY_EVENTS_MODE,
+  PROP_COMBINE_PUSHES
 };
 
+/* a buffer or list queued on a sinkpad for the srcpad STREAM_LOCK holder */
+typedef struct
+{
+  GstPad *pad;
+  GstMiniObject *obj;
+  gboolean is_list;
+} GstFunnelItem;
+
 static void
 gst_funnel_pad_finalize (GObject * gobject)
 {
@@ -188,6 +205,9 @@ gst_funnel_set_property (GObject * object, guint prop_id,
     case PROP_FORWARD_STICKY_EVENTS_MODE:
       funnel->forward_sticky_events_mode = g_value_get_enum (value);
       break;
+    case PROP_COMBINE_PUSHES:
+      funnel->combine_pushes = g_value_get_boolean (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -213,12 +233,43 @@ gst_funnel_get_property (GObject * object, guint prop_id, GValue * value,
     case PROP_FORWARD_STICKY_EVENTS_MODE:
       g_value_set_enum (value, funnel->forward_sticky_events_mode);
       break;
+    case PROP_COMBINE_PUSHES:
+      g_value_set_boolean (value, funnel->combine_pushes);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
   }
 }
 
+static void
+gst_funnel_item_free (GstFunnelItem * item)
+{
+  gst_mini_object_unref (item->obj);
+  gst_object_unref (item->pad);
+  g_slice_free (GstFunnelItem, item);
+}
+
+static void
+gst_funnel_clear_queue (GstFunnel * funnel)
+{
+  GstFunnelItem *item;
+
+  while ((item = gst_atomic_queue_pop (funnel->queue)))
+    gst_funnel_item_free (item);
+}
+
+static void
+gst_funnel_finalize (GObject * object)
+{
+  GstFunnel *funnel = GST_FUNNEL (object);
+
+  gst_funnel_clear_queue (funnel);
+  gst_atomic_queue_unref (funnel->queue);
+
+  G_OBJECT_CLASS (parent_class)->finalize (object);
+}
+
 static void
 gst_funnel_dispose (GObject * object)
 {
@@ -249,6 +300,7 @@ gst_funnel_class_init (GstFunnelClass * klass)
   gobject_class->set_property = gst_funnel_set_property;
   gobject_class->get_property = gst_funnel_get_property;
   gobject_class->dispose = GST_DEBUG_FUNCPTR (gst_funnel_dispose);
+  gobject_class->finalize = GST_DEBUG_FUNCPTR (gst_funnel_finalize);
 
   g_object_class_install_property (gobject_class, PROP_FORWARD_STICKY_EVENTS,
       g_param_spec_boolean ("forward-sticky-events", "Forward sticky events",
@@ -267,6 +319,21 @@ gst_funnel_class_init (GstFunnelClass * klass)
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
           GST_PARAM_MUTABLE_READY));
 
+  /**
+   * GstFunnel:combine-pushes:
+   *
+   * Don't block streaming threads while another thread pushes on the
+   * source pad, let that thread push their buffers instead.
+   *
+   * Since: 1.10
+   */
+  g_object_class_install_property (gobject_class, PROP_COMBINE_PUSHES,
+      g_param_spec_boolean ("combine-pushes", "Combine pushes",
+          "Queue buffers for the thread pushing on the source pad instead of "
+          "waiting for it", DEFAULT_COMBINE_PUSHES,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_READY));
+
   gst_element_class_set_static_metadata (gstelement_class,
       "Funnel pipe fitting", "Generic", "N-to-1 pipe fitting",
       "Olivier Crete <olivier.crete@collabora.co.uk>");
@@ -289,6 +356,8 @@ gst_funnel_init (GstFunnel * funnel)
   gst_element_add_pad (GST_ELEMENT (funnel), funnel->srcpad);
 
   funnel->forward_sticky_events_mode = DEFAULT_FORWARD_STICKY_EVENTS_MODE;
+  funnel->combine_pushes = DEFAULT_COMBINE_PUSHES;
+  funnel->queue = gst_atomic_queue_new (64);
 }
 
 static GstPad *
@@ -423,16 +492,13 @@ forward_events (GstPad * pad, GstEvent ** event, gpointer user_data)
   return TRUE;
 }
 
+/* with the srcpad STREAM_LOCK */
 static GstFlowReturn
-gst_funnel_sink_chain_object (GstPad * pad, GstFunnel * funnel,
+gst_funnel_push_object_unlocked (GstPad * pad, GstFunnel * funnel,
     gboolean is_list, GstMiniObject * obj)
 {
   GstFlowReturn res;
 
-  GST_DEBUG_OBJECT (pad, "received %" GST_PTR_FORMAT, obj);
-
-  GST_PAD_STREAM_LOCK (funnel->srcpad);
-
   if ((funnel->last_sinkpad == NULL)
       || ((funnel->forward_sticky_events_mode !=
               GST_FUNNEL_FORWARD_STICKY_EVENTS_MODE_NEVER)
@@ -451,14 +517,68 @@ gst_funnel_sink_chain_object (GstPad * pad, GstFunnel * funnel,
   else
     res = gst_pad_push (funnel->srcpad, GST_BUFFER_CAST (obj));
 
-  GST_PAD_STREAM_UNLOCK (funnel->srcpad);
-
   GST_LOG_OBJECT (pad, "handled buffer%s %s", (is_list ? "list" : ""),
       gst_flow_get_name (res));
 
   return res;
 }
 
+/* push everything other threads queued, with the srcpad STREAM_LOCK */
+static void
+gst_funnel_drain_unlocked (GstFunnel * funnel)
+{
+  GstFunnelItem *item;
+
+  while ((item = gst_atomic_queue_pop (funnel->queue))) {
+    gst_funnel_push_object_unlocked (item->pad, funnel, item->is_list,
+        item->obj);
+    gst_object_unref (item->pad);
+    g_slice_free (GstFunnelItem, item);
+  }
+}
+
+/* drain the queue unless another thread is pushing. We check again after
+ * releasing the lock because a thread may have queued something after our
+ * last pop and failed to take the lock from us. */
+static void
+gst_funnel_combine (GstFunnel * funnel)
+{
+  while (gst_atomic_queue_length (funnel->queue) > 0 &&
+      GST_PAD_STREAM_TRYLOCK (funnel->srcpad)) {
+    gst_funnel_drain_unlocked (funnel);
+    GST_PAD_STREAM_UNLOCK (funnel->srcpad);
+  }
+}
+
+static GstFlowReturn
+gst_funnel_sink_chain_object (GstPad * pad, GstFunnel * funnel,
+    gboolean is_list, GstMiniObject * obj)
+{
+  GstFlowReturn res;
+
+  GST_DEBUG_OBJECT (pad, "received %" GST_PTR_FORMAT, obj);
+
+  if (funnel->combine_pushes) {
+    GstFunnelItem *item = g_slice_new (GstFunnelItem);
+
+    item->pad = gst_object_ref (pad);
+    item->obj = obj;
+    item->is_list = is_list;
+    gst_atomic_queue_push (funnel->queue, item);
+
+    gst_funnel_combine (funnel);
+
+    /* our buffer might still be waiting for another thread to push it */
+    return gst_pad_get_last_flow_return (funnel->srcpad);
+  }
+
+  GST_PAD_STREAM_LOCK (funnel->srcpad);
+  res = gst_funnel_push_object_unlocked (pad, funnel, is_list, obj);
+  GST_PAD_STREAM_UNLOCK (funnel->srcpad);
+
+  return res;
+}
+
 static GstFlowReturn
 gst_funnel_sink_chain_list (GstPad * pad, GstObject * parent,
     GstBufferList * list)
@@ -486,9 +606,17 @@ gst_funnel_sink_event (GstPad * pad, GstObject * parent, GstEvent * event)
   gboolean forward = TRUE;
   gboolean res = TRUE;
   gboolean unlock = FALSE;
+  gboolean combine = FALSE;
 
   GST_DEBUG_OBJECT (pad, "received event %" GST_PTR_FORMAT, event);
 
+  /* serialized events must not overtake the queued buffers */
+  if (funnel->combine_pushes && GST_EVENT_IS_SERIALIZED (event)) {
+    combine = TRUE;
+    GST_PAD_STREAM_LOCK (funnel->srcpad);
+    gst_funnel_drain_unlocked (funnel);
+  }
+
   if (GST_EVENT_IS_STICKY (event)) {
     unlock = TRUE;
     GST_PAD_STREAM_LOCK (funnel->srcpad);
@@ -530,6 +658,12 @@ gst_funnel_sink_event (GstPad * pad, GstObject * parent, GstEvent * event)
   if (unlock)
     GST_PAD_STREAM_UNLOCK (funnel->srcpad);
 
+  if (combine) {
+    GST_PAD_STREAM_UNLOCK (funnel->srcpad);
+    /* pick up what was queued while we were pushing the event */
+    gst_funnel_combine (funnel);
+  }
+
   return res;
 }
 
@@ -559,9 +693,14 @@ gst_funnel_change_state (GstElement * element, GstStateChange transition)
   switch (transition) {
     case GST_STATE_CHANGE_PAUSED_TO_READY:
     {
-      GstIterator *iter = gst_element_iterate_sink_pads (element);
+      GstIterator *iter;
       GstIteratorResult res;
 
+      /* the srcpad is inactive, nobody is going to push these anymore */
+      gst_funnel_clear_queue (GST_FUNNEL (element));
+
+      iter = gst_element_iterate_sink_pads (element);
+
       do {
         res = gst_iterator_foreach (iter, reset_pad, element);
         if (res == GST_ITERATOR_RESYNC)
@@ -82,6 +82,10 @@ struct _GstFunnel {
 
   GstPad *last_sinkpad;
   GstFunnelForwardStickyEventsMode forward_sticky_events_mode;
+
+  /* combine-pushes: buffers waiting for the srcpad STREAM_LOCK holder */
+  gboolean combine_pushes;
+  GstAtomicQueue *queue;
 };
 
 struct _GstFunnelClass {
@@ -72,6 +72,8 @@ enum
 #define DEFAULT_CHECK_IMPERFECT_TIMESTAMP FALSE
 #define DEFAULT_CHECK_IMPERFECT_OFFSET    FALSE
 #define DEFAULT_SIGNAL_HANDOFFS           TRUE
+#define DEFAULT_PACE_RATE                 0
+#define DEFAULT_PACE_BURST                (64 * 1024)
 
 enum
 {
@@ -88,7 +90,9 @@ enum
   PROP_SYNC,
   PROP_CHECK_IMPERFECT_TIMESTAMP,
   PROP_CHECK_IMPERFECT_OFFSET,
-  PROP_SIGNAL_HANDOFFS
+  PROP_SIGNAL_HANDOFFS,
+  PROP_PACE_RATE,
+  PROP_PACE_BURST
 };
 
 
@@ -222,6 +226,35 @@ gst_identity_class_init (GstIdentityClass * klass)
           "Signal handoffs", "Send a signal before pushing the buffer",
           DEFAULT_SIGNAL_HANDOFFS, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstIdentity:pace-rate
+   *
+   * Limit the output to this many bytes per second with a token bucket that
+   * holds up to #GstIdentity:pace-burst bytes. Buffers pass without waiting
+   * as long as the bucket has tokens, so they leave in bursts with one clock
+   * wait per burst. The buffers themselves are not modified.
+   *
+   * Since: 1.10
+   */
+  g_object_class_install_property (gobject_class, PROP_PACE_RATE,
+      g_param_spec_uint64 ("pace-rate", "Pace rate",
+          "Limit the output to this many bytes per second (0 = disabled)",
+          0, G_MAXUINT64, DEFAULT_PACE_RATE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstIdentity:pace-burst
+   *
+   * Size of the #GstIdentity:pace-rate token bucket in bytes, the biggest
+   * burst that is released at once.
+   *
+   * Since: 1.10
+   */
+  g_object_class_install_property (gobject_class, PROP_PACE_BURST,
+      g_param_spec_uint ("pace-burst", "Pace burst",
+          "Maximum number of bytes to release at once when pacing",
+          1, G_MAXUINT, DEFAULT_PACE_BURST,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   /**
    * GstIdentity::handoff:
    * @identity: the identity instance
@@ -274,6 +307,9 @@ gst_identity_init (GstIdentity * identity)
   identity->dump = DEFAULT_DUMP;
   identity->last_message = NULL;
   identity->signal_handoffs = DEFAULT_SIGNAL_HANDOFFS;
+  identity->pace_rate = DEFAULT_PACE_RATE;
+  identity->pace_burst = DEFAULT_PACE_BURST;
+  identity->pace_time = GST_CLOCK_TIME_NONE;
   g_cond_init (&identity->blocked_cond);
 
   gst_base_transform_set_gap_aware (GST_BASE_TRANSFORM_CAST (identity), TRUE);
@@ -327,6 +363,78 @@ gst_identity_do_sync (GstIdentity * identity, GstClockTime running_time)
   return ret;
 }
 
+/* refills the token bucket for the time passed since the last refill */
+static void
+gst_identity_pace_refill (GstIdentity * identity, GstClockTime now)
+{
+  if (!GST_CLOCK_TIME_IS_VALID (identity->pace_time)) {
+    identity->pace_tokens = identity->pace_burst;
+  } else if (now > identity->pace_time) {
+    identity->pace_tokens += gst_util_uint64_scale (now - identity->pace_time,
+        identity->pace_rate, GST_SECOND);
+    if (identity->pace_tokens > identity->pace_burst)
+      identity->pace_tokens = identity->pace_burst;
+  }
+  identity->pace_time = now;
+}
+
+static GstFlowReturn
+gst_identity_do_pace (GstIdentity * identity, gsize size)
+{
+  GstFlowReturn ret = GST_FLOW_OK;
+  GstClock *clock;
+  guint64 rate, needed;
+
+  GST_OBJECT_LOCK (identity);
+  while (identity->blocked)
+    g_cond_wait (&identity->blocked_cond, GST_OBJECT_GET_LOCK (identity));
+
+  rate = identity->pace_rate;
+  if (rate == 0 || !(clock = GST_ELEMENT (identity)->clock))
+    goto done;
+
+  gst_identity_pace_refill (identity, gst_clock_get_time (clock));
+
+  /* buffers bigger than the bucket only wait for a full bucket */
+  needed = MIN (size, identity->pace_burst);
+  if (identity->pace_tokens < needed) {
+    GstClockReturn cret;
+    GstClockTime timestamp;
+
+    timestamp = identity->pace_time +
+        gst_util_uint64_scale_ceil (needed - identity->pace_tokens,
+        GST_SECOND, rate);
+
+    identity->clock_id = gst_clock_new_single_shot_id (clock, timestamp);
+    GST_OBJECT_UNLOCK (identity);
+
+    cret = gst_clock_id_wait (identity->clock_id, NULL);
+
+    GST_OBJECT_LOCK (identity);
+    if (identity->clock_id) {
+      gst_clock_id_unref (identity->clock_id);
+      identity->clock_id = NULL;
+    }
+    if (cret == GST_CLOCK_UNSCHEDULED) {
+      ret = GST_FLOW_EOS;
+      goto done;
+    }
+    /* refill from the target time, not from when we woke up, to not
+     * accumulate the wakeup latency */
+    gst_identity_pace_refill (identity, timestamp);
+  }
+
+  if (identity->pace_tokens > size)
+    identity->pace_tokens -= size;
+  else
+    identity->pace_tokens = 0;
+
+done:
+  GST_OBJECT_UNLOCK (identity);
+
+  return ret;
+}
+
 static gboolean
 gst_identity_sink_event (GstBaseTransform * trans, GstEvent * event)
 {
@@ -405,6 +513,13 @@ gst_identity_sink_event (GstBaseTransform * trans, GstEvent * event)
     identity->prev_offset = identity->prev_offset_end = GST_BUFFER_OFFSET_NONE;
   }
 
+  /* start with a full bucket after flushing */
+  if (GST_EVENT_TYPE (event) == GST_EVENT_FLUSH_STOP) {
+    GST_OBJECT_LOCK (identity);
+    identity->pace_time = GST_CLOCK_TIME_NONE;
+    GST_OBJECT_UNLOCK (identity);
+  }
+
   if (identity->single_segment && GST_EVENT_TYPE (event) == GST_EVENT_SEGMENT) {
     /* eat up segments */
     gst_event_unref (event);
@@ -637,6 +752,9 @@ gst_identity_transform_ip (GstBaseTransform * trans, GstBuffer * buf)
     runtimestamp = 0;
   ret = gst_identity_do_sync (identity, runtimestamp);
 
+  if (identity->pace_rate > 0 && ret == GST_FLOW_OK)
+    ret = gst_identity_do_pace (identity, size);
+
   identity->offset += size;
 
   if (identity->sleep_time && ret == GST_FLOW_OK)
@@ -723,6 +841,16 @@ gst_identity_set_property (GObject * object, guint prop_id,
     case PROP_SIGNAL_HANDOFFS:
       identity->signal_handoffs = g_value_get_boolean (value);
       break;
+    case PROP_PACE_RATE:
+      GST_OBJECT_LOCK (identity);
+      identity->pace_rate = g_value_get_uint64 (value);
+      GST_OBJECT_UNLOCK (identity);
+      break;
+    case PROP_PACE_BURST:
+      GST_OBJECT_LOCK (identity);
+      identity->pace_burst = g_value_get_uint (value);
+      GST_OBJECT_UNLOCK (identity);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -783,6 +911,16 @@ gst_identity_get_property (GObject * object, guint prop_id, GValue * value,
     case PROP_SIGNAL_HANDOFFS:
       g_value_set_boolean (value, identity->signal_handoffs);
       break;
+    case PROP_PACE_RATE:
+      GST_OBJECT_LOCK (identity);
+      g_value_set_uint64 (value, identity->pace_rate);
+      GST_OBJECT_UNLOCK (identity);
+      break;
+    case PROP_PACE_BURST:
+      GST_OBJECT_LOCK (identity);
+      g_value_set_uint (value, identity->pace_burst);
+      GST_OBJECT_UNLOCK (identity);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -899,6 +1037,8 @@ gst_identity_change_state (GstElement * element, GstStateChange transition)
       break;
     case GST_STATE_CHANGE_PAUSED_TO_PLAYING:
       GST_OBJECT_LOCK (identity);
+      /* the clock might have jumped while paused */
+      identity->pace_time = GST_CLOCK_TIME_NONE;
       identity->blocked = FALSE;
       g_cond_broadcast (&identity->blocked_cond);
       GST_OBJECT_UNLOCK (identity);
@@ -76,6 +76,12 @@ struct _GstIdentity {
   GstClockTime   upstream_latency;
   GCond          blocked_cond;
   gboolean       blocked;
+
+  /* token bucket pacer */
+  guint64        pace_rate;
+  guint          pace_burst;
+  guint64        pace_tokens;
+  GstClockTime   pace_time;
 };
 
 struct _GstIdentityClass {
@@ -47,6 +47,10 @@
  * #GST_FLOW_NOT_LINKED
  * </listitem>
  * </itemizedlist>
+ *
+ * With #GstInputSelector:cache-gop, every pad keeps the buffers since its
+ * last keyframe and a newly activated pad starts with those, so switching
+ * doesn't have to wait for the next keyframe and inactive pads never block.
  */
 
 #ifdef HAVE_CONFIG_H
@@ -108,12 +112,17 @@ enum
   PROP_ACTIVE_PAD,
   PROP_SYNC_STREAMS,
   PROP_SYNC_MODE,
-  PROP_CACHE_BUFFERS
+  PROP_CACHE_BUFFERS,
+  PROP_CACHE_GOP
 };
 
 #define DEFAULT_SYNC_STREAMS TRUE
 #define DEFAULT_SYNC_MODE GST_INPUT_SELECTOR_SYNC_MODE_ACTIVE_SEGMENT
 #define DEFAULT_CACHE_BUFFERS FALSE
+#define DEFAULT_CACHE_GOP FALSE
+
+/* stop keeping a GOP that gets longer than this, until the next keyframe */
+#define MAX_GOP_BUFFERS 1024
 #define DEFAULT_PAD_ALWAYS_OK TRUE
 
 enum
@@ -387,6 +396,50 @@ gst_selector_pad_cache_buffer (GstSelectorPad * selpad, GstBuffer * buffer)
       gst_selector_pad_new_cached_buffer (selpad, buffer));
 }
 
+/* Keep @buffer if it is part of the last GOP of @selpad, the cached buffers
+ * are used as the GOP when cache-gop is enabled.
+ * must be called with the SELECTOR_LOCK */
+static void
+gst_selector_pad_cache_gop (GstSelectorPad * selpad, GstBuffer * buffer)
+{
+  if (!GST_BUFFER_FLAG_IS_SET (buffer, GST_BUFFER_FLAG_DELTA_UNIT)) {
+    /* a new GOP, the old one is useless now */
+    gst_selector_pad_free_cached_buffers (selpad);
+    selpad->cached_buffers = g_queue_new ();
+  } else if (!selpad->cached_buffers) {
+    /* no keyframe seen yet */
+    return;
+  } else if (g_queue_get_length (selpad->cached_buffers) >= MAX_GOP_BUFFERS) {
+    GST_DEBUG_OBJECT (selpad, "GOP too long, waiting for next keyframe");
+    gst_selector_pad_free_cached_buffers (selpad);
+    return;
+  }
+
+  g_queue_push_tail (selpad->cached_buffers,
+      gst_selector_pad_new_cached_buffer (selpad, gst_buffer_ref (buffer)));
+}
+
+/* Get the buffers of the last GOP before @buffer, which was just added
+ * with gst_selector_pad_cache_gop().
+ * must be called with the SELECTOR_LOCK */
+static GList *
+gst_selector_pad_get_gop (GstSelectorPad * selpad, GstBuffer * buffer)
+{
+  GList *l, *gop = NULL;
+
+  if (!selpad->cached_buffers)
+    return NULL;
+
+  for (l = selpad->cached_buffers->tail; l; l = l->prev) {
+    GstSelectorPadCachedBuffer *cached_buffer = l->data;
+
+    if (cached_buffer->buffer != buffer)
+      gop = g_list_prepend (gop, gst_buffer_ref (cached_buffer->buffer));
+  }
+
+  return gop;
+}
+
 /* must be called with the SELECTOR_LOCK */
 static void
 gst_selector_pad_free_cached_buffers (GstSelectorPad * selpad)
@@ -566,6 +619,10 @@ gst_selector_pad_event (GstPad * pad, GstObject * parent, GstEvent * event)
       gst_event_copy_segment (event, &selpad->segment);
       selpad->segment_seqnum = gst_event_get_seqnum (event);
 
+      /* the GOP is only sent with the latest segment */
+      if (sel->cache_gop)
+        gst_selector_pad_free_cached_buffers (selpad);
+
       GST_DEBUG_OBJECT (pad, "configured SEGMENT %" GST_SEGMENT_FORMAT,
           &selpad->segment);
       break;
@@ -967,6 +1024,7 @@ gst_selector_pad_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
   GstPad *active_sinkpad;
   GstPad *prev_active_sinkpad = NULL;
   GstSelectorPad *selpad;
+  GList *gop = NULL;
 
   sel = GST_INPUT_SELECTOR (parent);
   selpad = GST_SELECTOR_PAD_CAST (pad);
@@ -988,9 +1046,13 @@ gst_selector_pad_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
       sel->active_sinkpad ? gst_object_ref (sel->active_sinkpad) : NULL;
   active_sinkpad = gst_input_selector_get_active_sinkpad (sel);
 
-  /* In sync mode wait until the active pad has advanced
-   * after the running time of the current buffer */
-  if (sel->sync_streams) {
+  if (sel->cache_gop) {
+    /* never wait, keep the last GOP of all pads instead and start with it
+     * when the pad becomes active */
+    gst_selector_pad_cache_gop (selpad, buf);
+    if (active_sinkpad == pad && !selpad->pushed)
+      gop = gst_selector_pad_get_gop (selpad, buf);
+  } else if (sel->sync_streams) {
     /* call chain for each cached buffer if we are not the active pad
      * or if we are the active pad but didn't push anything yet. */
     if (active_sinkpad != pad || !selpad->pushed) {
@@ -1035,6 +1097,8 @@ gst_selector_pad_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
       }
     }
 
+    /* In sync mode wait until the active pad has advanced
+     * after the running time of the current buffer */
     if (active_sinkpad != pad) {
       GST_INPUT_SELECTOR_UNLOCK (sel);
       if (gst_input_selector_wait_running_time (sel, selpad, buf))
@@ -1066,7 +1130,7 @@ gst_selector_pad_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
     goto ignore;
 
   /* Tell all non-active pads that we advanced the running time */
-  if (sel->sync_streams)
+  if (sel->sync_streams && !sel->cache_gop)
     GST_INPUT_SELECTOR_BROADCAST (sel);
 
   GST_INPUT_SELECTOR_UNLOCK (sel);
@@ -1091,6 +1155,28 @@ gst_selector_pad_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
     prev_active_sinkpad = NULL;
   }
 
+  /* start from the last keyframe before this buffer */
+  while (gop) {
+    GstBuffer *gop_buf = gop->data;
+
+    gop = g_list_delete_link (gop, gop);
+
+    if (selpad->discont) {
+      gop_buf = gst_buffer_make_writable (gop_buf);
+      GST_BUFFER_FLAG_SET (gop_buf, GST_BUFFER_FLAG_DISCONT);
+      selpad->discont = FALSE;
+    }
+
+    GST_LOG_OBJECT (pad, "Forwarding GOP buffer %p with timestamp %"
+        GST_TIME_FORMAT, gop_buf, GST_TIME_ARGS (GST_BUFFER_PTS (gop_buf)));
+    res = gst_pad_push (sel->srcpad, gop_buf);
+    if (res != GST_FLOW_OK) {
+      g_list_free_full (gop, (GDestroyNotify) gst_buffer_unref);
+      gst_buffer_unref (buf);
+      goto done;
+    }
+  }
+
   if (selpad->discont) {
     buf = gst_buffer_make_writable (buf);
 
@@ -1104,14 +1190,14 @@ gst_selector_pad_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
       buf, GST_TIME_ARGS (GST_BUFFER_PTS (buf)));
 
   /* Only make the buffer read-only when necessary */
-  if (sel->sync_streams && sel->cache_buffers)
+  if (sel->sync_streams && sel->cache_buffers && !sel->cache_gop)
     buf = gst_buffer_ref (buf);
   res = gst_pad_push (sel->srcpad, buf);
   GST_LOG_OBJECT (pad, "Buffer %p forwarded result=%d", buf, res);
 
   GST_INPUT_SELECTOR_LOCK (sel);
 
-  if (sel->sync_streams && sel->cache_buffers) {
+  if (sel->sync_streams && sel->cache_buffers && !sel->cache_gop) {
     /* Might have changed while pushing */
     active_sinkpad = gst_input_selector_get_active_sinkpad (sel);
     /* only set pad to pushed if we are still the active pad */
@@ -1266,6 +1352,24 @@ gst_input_selector_class_init (GstInputSelectorClass * klass)
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
           GST_PARAM_MUTABLE_READY));
 
+  /**
+   * GstInputSelector:cache-gop
+   *
+   * If set to %TRUE, all pads keep the buffers since their last keyframe,
+   * and a pad that becomes active pushes those before its next buffer. The
+   * new stream then starts decoding right away instead of on its next
+   * keyframe. Inactive pads never wait, GstInputSelector:sync-streams and
+   * GstInputSelector:cache-buffers are ignored in this mode.
+   *
+   * Since: 1.10
+   */
+  g_object_class_install_property (gobject_class, PROP_CACHE_GOP,
+      g_param_spec_boolean ("cache-gop", "Cache GOP",
+          "Keep the last GOP of all pads and start from its keyframe when "
+          "switching", DEFAULT_CACHE_GOP,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_READY));
+
   gst_element_class_set_static_metadata (gstelement_class, "Input selector",
       "Generic", "N-to-1 input stream selector",
       "Julien Moutte <julien@moutte.net>, "
@@ -1296,6 +1400,7 @@ gst_input_selector_init (GstInputSelector * sel)
   sel->padcount = 0;
   sel->sync_streams = DEFAULT_SYNC_STREAMS;
   sel->sync_mode = DEFAULT_SYNC_MODE;
+  sel->cache_gop = DEFAULT_CACHE_GOP;
   sel->have_group_id = TRUE;
 
   g_mutex_init (&sel->lock);
@@ -1420,6 +1525,11 @@ gst_input_selector_set_property (GObject * object, guint prop_id,
       sel->cache_buffers = g_value_get_boolean (value);
       GST_INPUT_SELECTOR_UNLOCK (object);
       break;
+    case PROP_CACHE_GOP:
+      GST_INPUT_SELECTOR_LOCK (object);
+      sel->cache_gop = g_value_get_boolean (value);
+      GST_INPUT_SELECTOR_UNLOCK (object);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -1468,6 +1578,11 @@ gst_input_selector_get_property (GObject * object, guint prop_id,
       g_value_set_boolean (value, sel->cache_buffers);
       GST_INPUT_SELECTOR_UNLOCK (object);
       break;
+    case PROP_CACHE_GOP:
+      GST_INPUT_SELECTOR_LOCK (object);
+      g_value_set_boolean (value, sel->cache_gop);
+      GST_INPUT_SELECTOR_UNLOCK (object);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -71,6 +71,7 @@ struct _GstInputSelector {
   gboolean sync_streams;
   GstInputSelectorSyncMode sync_mode;
   gboolean cache_buffers;
+  gboolean cache_gop;
 
   gboolean have_group_id;
 
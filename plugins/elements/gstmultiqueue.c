@@ -107,6 +107,8 @@
 #  include "config.h"
 #endif
 
+#include "gst/gst_private.h"
+
 #include <gst/gst.h>
 #include <stdio.h>
 #include "gstmultiqueue.h"
@@ -152,6 +154,11 @@ struct _GstSingleQueue
   GstClockTimeDiff sinktime, srctime;
   /* cached input value, used for interleave */
   GstClockTimeDiff cached_sinktime;
+  /* input byterate measured for auto-size, over windows of RATE_WINDOW
+   * running time starting at rate_start */
+  GstClockTimeDiff rate_start;
+  guint64 rate_bytes;
+  guint64 byterate;
   /* TRUE if either position needs to be recalculated */
   gboolean sink_tainted, src_tainted;
 
@@ -179,10 +186,37 @@ struct _GstSingleQueue
 
   /* For interleave calculation */
   GThread *thread;
+
+  /* TRUE when the srcpad task is scheduleable, it then gives its thread
+   * back to the pool when the queue is empty */
+  gboolean schedule_task;
+
+  /* EOS dropping state kept between drain thread iterations */
+  gboolean drain_dropping;
+
+  /* the memory budget is ignored below this number of visible items, bumped
+   * like max_size.visible when another queue is empty */
+  guint budget_visible;
 };
 
+/* A thread draining the single queues with id % n_drain_groups == idx, used
+ * instead of one task per srcpad when drain-threads is set */
+struct _GstMultiQueueDrainGroup
+{
+  GstMultiQueue *mq;
+  guint idx;
+
+  GstTask *task;
+  GRecMutex lock;
+  /* signalled with the qlock when one of our queues got data or when
+   * stopping */
+  GCond cond;
+  gboolean stopping;
+};
 
-/* Extension of GstDataQueueItem structure for our usage */
+
+/* Extension of GstDataQueueItem structure for our usage, stored in the
+ * GstDataQueue itself */
 typedef struct _GstMultiQueueItem GstMultiQueueItem;
 
 struct _GstMultiQueueItem
@@ -196,6 +230,9 @@ struct _GstMultiQueueItem
   guint32 posid;
 
   gboolean is_query;
+
+  /* to release the size from the memory budget, for buffers */
+  GstMultiQueue *mqueue;
 };
 
 static GstSingleQueue *gst_single_queue_new (GstMultiQueue * mqueue, guint id);
@@ -208,6 +245,22 @@ static void single_queue_overrun_cb (GstDataQueue * dq, GstSingleQueue * sq);
 static void single_queue_underrun_cb (GstDataQueue * dq, GstSingleQueue * sq);
 
 static void update_buffering (GstMultiQueue * mq, GstSingleQueue * sq);
+
+/* report the level of @sq to the queue-enqueue and queue-dequeue hooks,
+ * only get the level when someone listens */
+#ifndef GST_DISABLE_GST_TRACER_HOOKS
+#define GST_SINGLE_QUEUE_TRACE_LEVEL(sq, HOOK) G_STMT_START {             \
+  if (G_UNLIKELY (GST_TRACER_HOOK_IS_ENABLED (                          \
+          GST_TRACER_QUARK_HOOK_QUEUE_##HOOK))) {                       \
+    GstDataQueueSize __size;                                            \
+    gst_data_queue_get_level ((sq)->queue, &__size);                    \
+    GST_TRACER_QUEUE_##HOOK (GST_ELEMENT_CAST ((sq)->mqueue),           \
+        (sq)->sinkpad, __size.visible, __size.bytes, (sq)->cur_time);   \
+  }                                                                     \
+} G_STMT_END
+#else
+#define GST_SINGLE_QUEUE_TRACE_LEVEL(sq, HOOK)
+#endif
 static void gst_multi_queue_post_buffering (GstMultiQueue * mq);
 static void recheck_buffering_status (GstMultiQueue * mq);
 
@@ -257,7 +310,9 @@ enum
 #define DEFAULT_HIGH_PERCENT  99
 #define DEFAULT_SYNC_BY_RUNNING_TIME FALSE
 #define DEFAULT_USE_INTERLEAVE FALSE
+#define DEFAULT_AUTO_SIZE FALSE
 #define DEFAULT_UNLINKED_CACHE_TIME 250 * GST_MSECOND
+#define DEFAULT_DRAIN_THREADS 0
 
 enum
 {
@@ -274,12 +329,21 @@ enum
   PROP_SYNC_BY_RUNNING_TIME,
   PROP_USE_INTERLEAVE,
   PROP_UNLINKED_CACHE_TIME,
+  PROP_DRAIN_THREADS,
+  PROP_MEMORY_BUDGET_PRIORITY,
+  PROP_AUTO_SIZE,
   PROP_LAST
 };
 
+#if !defined (GST_ENABLE_LOCK_TRACING) && !defined (GST_ENABLE_ADAPTIVE_LOCKS)
 #define GST_MULTI_QUEUE_MUTEX_LOCK(q) G_STMT_START {                          \
   g_mutex_lock (&q->qlock);                                              \
 } G_STMT_END
+#else
+#define GST_MULTI_QUEUE_MUTEX_LOCK(q) G_STMT_START {                          \
+  _gst_lock_trace_mutex_lock (&q->qlock, q, "multiqueue");               \
+} G_STMT_END
+#endif
 
 #define GST_MULTI_QUEUE_MUTEX_UNLOCK(q) G_STMT_START {                        \
   g_mutex_unlock (&q->qlock);                                            \
@@ -319,10 +383,17 @@ static void gst_multi_queue_get_property (GObject * object,
 static GstPad *gst_multi_queue_request_new_pad (GstElement * element,
     GstPadTemplate * temp, const gchar * name, const GstCaps * caps);
 static void gst_multi_queue_release_pad (GstElement * element, GstPad * pad);
+static gboolean gst_multi_queue_post_message (GstElement * element,
+    GstMessage * msg);
 static GstStateChangeReturn gst_multi_queue_change_state (GstElement *
     element, GstStateChange transition);
+static void gst_multi_queue_set_context (GstElement * element,
+    GstContext * context);
 
 static void gst_multi_queue_loop (GstPad * pad);
+static void gst_multi_queue_drain_loop (GstMultiQueueDrainGroup * group);
+static void gst_multi_queue_start_drain (GstMultiQueue * mq);
+static void gst_multi_queue_stop_drain (GstMultiQueue * mq);
 
 #define _do_init \
   GST_DEBUG_CATEGORY_INIT (multi_queue_debug, "multiqueue", 0, "multiqueue element");
@@ -469,6 +540,67 @@ gst_multi_queue_class_init (GstMultiQueueClass * klass)
           G_PARAM_READWRITE | GST_PARAM_MUTABLE_PLAYING |
           G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstMultiQueue:drain-threads:
+   *
+   * Number of threads draining the single queues. With the default of 0
+   * every srcpad has its own streaming thread. Otherwise single queue N is
+   * drained by thread N % drain-threads, which always pushes the queued item
+   * with the lowest running time of all its queues next, events and queries
+   * first. Not-linked pads don't wait for the other streams then, they are
+   * kept in order by that selection instead.
+   *
+   * A push blocking downstream blocks all the queues of that thread, so this
+   * is only suited when downstream does not wait for data of other streams
+   * of the same thread, like sinks prerolling with async enabled.
+   *
+   * Since: 1.10
+   */
+  g_object_class_install_property (gobject_class, PROP_DRAIN_THREADS,
+      g_param_spec_uint ("drain-threads", "Drain threads",
+          "Number of threads draining all queues in running time order "
+          "(0 = one thread per queue)", 0, G_MAXUINT, DEFAULT_DRAIN_THREADS,
+          G_PARAM_READWRITE | GST_PARAM_MUTABLE_READY |
+          G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstMultiQueue:memory-budget-priority
+   *
+   * The priority of the multiqueue in the #GstMemoryBudget that was set on it
+   * with a #GstContext. The share of the budget the multiqueue can always use
+   * is proportional to its priority. When it is over its share and the
+   * budget is exhausted, the queues are handled as full, unless another
+   * queue is empty.
+   *
+   * Since: 1.10
+   */
+  g_object_class_install_property (gobject_class, PROP_MEMORY_BUDGET_PRIORITY,
+      g_param_spec_uint ("memory-budget-priority", "Memory budget priority",
+          "Priority in the shared memory budget, if any", 0, G_MAXUINT,
+          GST_MEMORY_BUDGET_DEFAULT_PRIORITY,
+          G_PARAM_READWRITE | GST_PARAM_MUTABLE_PLAYING |
+          G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstMultiQueue:auto-size
+   *
+   * Size every single queue from its input. The time limit follows the
+   * interleave of the streams like with #GstMultiQueue:use-interleave, and
+   * the bytes limit of each queue is derived from the measured bitrate of
+   * its stream and that time limit. #GstMultiQueue:max-size-bytes is kept
+   * as the upper bound of the bytes limit.
+   *
+   * Limits grow as soon as a stream needs more, but only shrink once they
+   * are twice as large as required, so that bitrate variations don't make
+   * the queues alternate between overrun and underrun.
+   *
+   * Since: 1.10
+   */
+  g_object_class_install_property (gobject_class, PROP_AUTO_SIZE,
+      g_param_spec_boolean ("auto-size", "Auto size",
+          "Adjust the limits of each queue from its bitrate and the "
+          "input interleave", DEFAULT_AUTO_SIZE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
   gobject_class->finalize = gst_multi_queue_finalize;
 
@@ -484,6 +616,10 @@ gst_multi_queue_class_init (GstMultiQueueClass * klass)
       GST_DEBUG_FUNCPTR (gst_multi_queue_release_pad);
   gstelement_class->change_state =
       GST_DEBUG_FUNCPTR (gst_multi_queue_change_state);
+  gstelement_class->post_message =
+      GST_DEBUG_FUNCPTR (gst_multi_queue_post_message);
+  gstelement_class->set_context =
+      GST_DEBUG_FUNCPTR (gst_multi_queue_set_context);
 }
 
 static void
@@ -506,14 +642,21 @@ gst_multi_queue_init (GstMultiQueue * mqueue)
 
   mqueue->sync_by_running_time = DEFAULT_SYNC_BY_RUNNING_TIME;
   mqueue->use_interleave = DEFAULT_USE_INTERLEAVE;
+  mqueue->auto_size = DEFAULT_AUTO_SIZE;
   mqueue->unlinked_cache_time = DEFAULT_UNLINKED_CACHE_TIME;
+  mqueue->drain_threads = DEFAULT_DRAIN_THREADS;
+  mqueue->drain_groups = NULL;
+  mqueue->n_drain_groups = 0;
 
   mqueue->counter = 1;
   mqueue->highid = -1;
   mqueue->high_time = GST_CLOCK_STIME_NONE;
 
+  mqueue->budget_priority = GST_MEMORY_BUDGET_DEFAULT_PRIORITY;
+
   g_mutex_init (&mqueue->qlock);
   g_mutex_init (&mqueue->buffering_post_lock);
+  g_mutex_init (&mqueue->budget_lock);
 }
 
 static void
@@ -526,13 +669,97 @@ gst_multi_queue_finalize (GObject * object)
   mqueue->queues = NULL;
   mqueue->queues_cookie++;
 
+  if (mqueue->budget) {
+    gst_memory_budget_remove_client (mqueue->budget, mqueue->budget_client);
+    gst_object_unref (mqueue->budget);
+  }
+
   /* free/unref instance data */
   g_mutex_clear (&mqueue->qlock);
   g_mutex_clear (&mqueue->buffering_post_lock);
+  g_mutex_clear (&mqueue->budget_lock);
 
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
 
+/* the budget might allow more data now, wake up blocked queues */
+static void
+gst_multi_queue_budget_changed (GstMultiQueue * mq)
+{
+  GList *tmp;
+
+  GST_MULTI_QUEUE_MUTEX_LOCK (mq);
+  for (tmp = mq->queues; tmp; tmp = g_list_next (tmp)) {
+    GstSingleQueue *q = (GstSingleQueue *) tmp->data;
+
+    gst_data_queue_limits_changed (q->queue);
+  }
+  GST_MULTI_QUEUE_MUTEX_UNLOCK (mq);
+}
+
+static void
+gst_multi_queue_set_context (GstElement * element, GstContext * context)
+{
+  GstMultiQueue *mq = GST_MULTI_QUEUE (element);
+  GstMemoryBudget *budget;
+
+  if (gst_context_get_memory_budget (context, &budget)) {
+    GST_DEBUG_OBJECT (mq, "using memory budget %" GST_PTR_FORMAT, budget);
+
+    g_mutex_lock (&mq->budget_lock);
+    if (budget != mq->budget) {
+      if (mq->budget) {
+        gst_memory_budget_remove_client (mq->budget, mq->budget_client);
+        gst_object_unref (mq->budget);
+      }
+      mq->budget = gst_object_ref (budget);
+      mq->budget_client =
+          gst_memory_budget_add_client (budget, mq->budget_priority);
+      /* take over what is queued right now */
+      gst_memory_budget_client_acquire (mq->budget_client, mq->budget_bytes);
+    }
+    g_mutex_unlock (&mq->budget_lock);
+    gst_object_unref (budget);
+
+    gst_multi_queue_budget_changed (mq);
+  }
+
+  GST_ELEMENT_CLASS (parent_class)->set_context (element, context);
+}
+
+static inline void
+gst_multi_queue_budget_acquire (GstMultiQueue * mq, guint size)
+{
+  g_mutex_lock (&mq->budget_lock);
+  mq->budget_bytes += size;
+  if (mq->budget_client)
+    gst_memory_budget_client_acquire (mq->budget_client, size);
+  g_mutex_unlock (&mq->budget_lock);
+}
+
+static inline void
+gst_multi_queue_budget_release (GstMultiQueue * mq, guint size)
+{
+  g_mutex_lock (&mq->budget_lock);
+  mq->budget_bytes -= size;
+  if (mq->budget_client)
+    gst_memory_budget_client_release (mq->budget_client, size);
+  g_mutex_unlock (&mq->budget_lock);
+}
+
+static gboolean
+gst_multi_queue_is_over_budget (GstMultiQueue * mq)
+{
+  gboolean res = FALSE;
+
+  g_mutex_lock (&mq->budget_lock);
+  if (mq->budget_client)
+    res = gst_memory_budget_client_is_exhausted (mq->budget_client);
+  g_mutex_unlock (&mq->budget_lock);
+
+  return res;
+}
+
 #define SET_CHILD_PROPERTY(mq,format) G_STMT_START {	        \
     GList * tmp = mq->queues;					\
     while (tmp) {						\
@@ -634,12 +861,34 @@ gst_multi_queue_set_property (GObject * object, guint prop_id,
     case PROP_USE_INTERLEAVE:
       mq->use_interleave = g_value_get_boolean (value);
       break;
+    case PROP_AUTO_SIZE:
+      GST_MULTI_QUEUE_MUTEX_LOCK (mq);
+      mq->auto_size = g_value_get_boolean (value);
+      if (!mq->auto_size)
+        SET_CHILD_PROPERTY (mq, bytes);
+      GST_MULTI_QUEUE_MUTEX_UNLOCK (mq);
+      gst_multi_queue_post_buffering (mq);
+      break;
     case PROP_UNLINKED_CACHE_TIME:
       GST_MULTI_QUEUE_MUTEX_LOCK (mq);
       mq->unlinked_cache_time = g_value_get_uint64 (value);
       GST_MULTI_QUEUE_MUTEX_UNLOCK (mq);
       gst_multi_queue_post_buffering (mq);
       break;
+    case PROP_DRAIN_THREADS:
+      GST_MULTI_QUEUE_MUTEX_LOCK (mq);
+      mq->drain_threads = g_value_get_uint (value);
+      GST_MULTI_QUEUE_MUTEX_UNLOCK (mq);
+      break;
+    case PROP_MEMORY_BUDGET_PRIORITY:
+      g_mutex_lock (&mq->budget_lock);
+      mq->budget_priority = g_value_get_uint (value);
+      if (mq->budget_client)
+        gst_memory_budget_client_set_priority (mq->budget_client,
+            mq->budget_priority);
+      g_mutex_unlock (&mq->budget_lock);
+      gst_multi_queue_budget_changed (mq);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -688,9 +937,18 @@ gst_multi_queue_get_property (GObject * object, guint prop_id,
     case PROP_USE_INTERLEAVE:
       g_value_set_boolean (value, mq->use_interleave);
       break;
+    case PROP_AUTO_SIZE:
+      g_value_set_boolean (value, mq->auto_size);
+      break;
     case PROP_UNLINKED_CACHE_TIME:
       g_value_set_uint64 (value, mq->unlinked_cache_time);
       break;
+    case PROP_DRAIN_THREADS:
+      g_value_set_uint (value, mq->drain_threads);
+      break;
+    case PROP_MEMORY_BUDGET_PRIORITY:
+      g_value_set_uint (value, mq->budget_priority);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -808,6 +1066,41 @@ gst_multi_queue_release_pad (GstElement * element, GstPad * pad)
   gst_single_queue_free (sq);
 }
 
+static gboolean
+gst_multi_queue_post_message (GstElement * element, GstMessage * msg)
+{
+  GstMultiQueue *mq = GST_MULTI_QUEUE (element);
+  gboolean ret;
+
+  gst_message_ref (msg);
+  ret = GST_ELEMENT_CLASS (parent_class)->post_message (element, msg);
+
+  /* the srcpad tasks are created with their pad as the source, once the
+   * message is handled we know if the task was made scheduleable */
+  if (GST_MESSAGE_TYPE (msg) == GST_MESSAGE_STREAM_STATUS
+      && GST_IS_PAD (GST_MESSAGE_SRC (msg))) {
+    GstStreamStatusType type;
+    GstPad *pad = GST_PAD_CAST (GST_MESSAGE_SRC (msg));
+
+    gst_message_parse_stream_status (msg, &type, NULL);
+    if (type == GST_STREAM_STATUS_TYPE_CREATE
+        && GST_PAD_DIRECTION (pad) == GST_PAD_SRC) {
+      GstSingleQueue *sq =
+          (GstSingleQueue *) gst_pad_get_element_private (pad);
+
+      if (sq) {
+        sq->schedule_task = gst_task_get_scheduleable (GST_PAD_TASK (pad));
+        GST_DEBUG_OBJECT (mq, "SingleQueue %d : scheduling task %d", sq->id,
+            sq->schedule_task);
+      }
+    }
+  }
+
+  gst_message_unref (msg);
+
+  return ret;
+}
+
 static GstStateChangeReturn
 gst_multi_queue_change_state (GstElement * element, GstStateChange transition)
 {
@@ -832,6 +1125,8 @@ gst_multi_queue_change_state (GstElement * element, GstStateChange transition)
       GST_MULTI_QUEUE_MUTEX_UNLOCK (mqueue);
       gst_multi_queue_post_buffering (mqueue);
 
+      /* before the srcpads get activated */
+      gst_multi_queue_start_drain (mqueue);
       break;
     }
     case GST_STATE_CHANGE_PAUSED_TO_READY:{
@@ -857,6 +1152,14 @@ gst_multi_queue_change_state (GstElement * element, GstStateChange transition)
   result = GST_ELEMENT_CLASS (parent_class)->change_state (element, transition);
 
   switch (transition) {
+    case GST_STATE_CHANGE_READY_TO_PAUSED:
+      if (result == GST_STATE_CHANGE_FAILURE)
+        gst_multi_queue_stop_drain (mqueue);
+      break;
+    case GST_STATE_CHANGE_PAUSED_TO_READY:
+      /* the srcpads are deactivated now */
+      gst_multi_queue_stop_drain (mqueue);
+      break;
     default:
       break;
   }
@@ -888,8 +1191,17 @@ gst_single_queue_flush (GstMultiQueue * mq, GstSingleQueue * sq, gboolean flush,
     g_cond_signal (&sq->query_handled);
     GST_MULTI_QUEUE_MUTEX_UNLOCK (mq);
 
-    GST_LOG_OBJECT (mq, "SingleQueue %d : pausing task", sq->id);
-    result = gst_pad_pause_task (sq->srcpad);
+    if (mq->drain_groups) {
+      /* no task on the pad, wait until the drain thread is done with
+       * this queue */
+      GST_LOG_OBJECT (mq, "SingleQueue %d : waiting for drain thread", sq->id);
+      GST_PAD_STREAM_LOCK (sq->srcpad);
+      GST_PAD_STREAM_UNLOCK (sq->srcpad);
+      result = TRUE;
+    } else {
+      GST_LOG_OBJECT (mq, "SingleQueue %d : pausing task", sq->id);
+      result = gst_pad_pause_task (sq->srcpad);
+    }
     sq->sink_tainted = sq->src_tainted = TRUE;
   } else {
     gst_single_queue_flush_queue (sq, full);
@@ -910,6 +1222,8 @@ gst_single_queue_flush (GstMultiQueue * mq, GstSingleQueue * sq, gboolean flush,
     sq->next_time = GST_CLOCK_STIME_NONE;
     sq->last_time = GST_CLOCK_STIME_NONE;
     sq->cached_sinktime = GST_CLOCK_STIME_NONE;
+    sq->rate_start = GST_CLOCK_STIME_NONE;
+    sq->drain_dropping = FALSE;
     gst_data_queue_set_flushing (sq->queue, FALSE);
 
     /* Reset high time to be recomputed next */
@@ -918,10 +1232,15 @@ gst_single_queue_flush (GstMultiQueue * mq, GstSingleQueue * sq, gboolean flush,
     sq->flushing = FALSE;
     GST_MULTI_QUEUE_MUTEX_UNLOCK (mq);
 
-    GST_LOG_OBJECT (mq, "SingleQueue %d : starting task", sq->id);
-    result =
-        gst_pad_start_task (sq->srcpad, (GstTaskFunction) gst_multi_queue_loop,
-        sq->srcpad, NULL);
+    if (mq->drain_groups) {
+      /* the drain thread picks up the new data */
+      result = TRUE;
+    } else {
+      GST_LOG_OBJECT (mq, "SingleQueue %d : starting task", sq->id);
+      result =
+          gst_pad_start_task (sq->srcpad,
+          (GstTaskFunction) gst_multi_queue_loop, sq->srcpad, NULL);
+    }
   }
   return result;
 }
@@ -1003,8 +1322,11 @@ static void
 gst_multi_queue_post_buffering (GstMultiQueue * mq)
 {
   GstMessage *msg = NULL;
+  gboolean post;
 
   g_mutex_lock (&mq->buffering_post_lock);
+  post = gst_element_message_will_be_posted (GST_ELEMENT_CAST (mq),
+      GST_MESSAGE_BUFFERING);
   GST_MULTI_QUEUE_MUTEX_LOCK (mq);
   if (mq->percent_changed) {
     gint percent = mq->percent;
@@ -1016,8 +1338,10 @@ gst_multi_queue_post_buffering (GstMultiQueue * mq)
     if (percent > 100)
       percent = 100;
 
-    GST_DEBUG_OBJECT (mq, "Going to post buffering: %d%%", percent);
-    msg = gst_message_new_buffering (GST_OBJECT_CAST (mq), percent);
+    if (post) {
+      GST_DEBUG_OBJECT (mq, "Going to post buffering: %d%%", percent);
+      msg = gst_message_new_buffering (GST_OBJECT_CAST (mq), percent);
+    }
   }
   GST_MULTI_QUEUE_MUTEX_UNLOCK (mq);
 
@@ -1066,6 +1390,81 @@ recheck_buffering_status (GstMultiQueue * mq)
   gst_multi_queue_post_buffering (mq);
 }
 
+/* limits follow the interleave with auto-size too */
+#define USE_INTERLEAVE(mq) ((mq)->use_interleave || (mq)->auto_size)
+
+/* running time over which the input byterate is measured */
+#define RATE_WINDOW (500 * GST_MSECOND)
+/* smallest bytes limit auto-size picks */
+#define AUTO_SIZE_MIN_BYTES (64 * 1024)
+
+/* derive the bytes limit of @sq from its byterate and time limit, with 50%%
+ * headroom for bitrate peaks. WITH LOCK TAKEN */
+static void
+update_auto_size (GstMultiQueue * mq, GstSingleQueue * sq)
+{
+  guint64 bytes;
+
+  if (sq->byterate == 0 || sq->max_size.time == 0)
+    return;
+
+  bytes = gst_util_uint64_scale (sq->byterate, sq->max_size.time * 3 / 2,
+      GST_SECOND);
+  bytes = MAX (bytes, AUTO_SIZE_MIN_BYTES);
+  if (mq->max_size.bytes > 0)
+    bytes = MIN (bytes, mq->max_size.bytes);
+  else
+    bytes = MIN (bytes, G_MAXUINT);
+
+  /* grow right away, shrink only when much too large */
+  if (bytes <= sq->max_size.bytes && bytes >= sq->max_size.bytes / 2)
+    return;
+
+  GST_DEBUG_OBJECT (mq, "queue %d: byterate %" G_GUINT64_FORMAT
+      ", bytes limit %u -> %" G_GUINT64_FORMAT, sq->id, sq->byterate,
+      sq->max_size.bytes, bytes);
+
+  sq->max_size.bytes = bytes;
+  update_buffering (mq, sq);
+  gst_data_queue_limits_changed (sq->queue);
+}
+
+/* account @size bytes ending at running time @sinktime in the byterate of
+ * @sq. WITH LOCK TAKEN */
+static void
+update_input_rate (GstMultiQueue * mq, GstSingleQueue * sq, guint size,
+    GstClockTimeDiff sinktime)
+{
+  GstClockTimeDiff elapsed;
+  guint64 rate;
+
+  if (sq->is_sparse)
+    return;
+
+  /* first buffer or going back in time, start a new measurement */
+  if (!GST_CLOCK_STIME_IS_VALID (sq->rate_start) || sinktime < sq->rate_start) {
+    sq->rate_start = sinktime;
+    sq->rate_bytes = 0;
+    return;
+  }
+
+  sq->rate_bytes += size;
+  elapsed = sinktime - sq->rate_start;
+  if (elapsed < RATE_WINDOW)
+    return;
+
+  rate = gst_util_uint64_scale (sq->rate_bytes, GST_SECOND, elapsed);
+  if (sq->byterate == 0)
+    sq->byterate = rate;
+  else
+    sq->byterate = (3 * sq->byterate + rate) / 4;
+
+  sq->rate_start = sinktime;
+  sq->rate_bytes = 0;
+
+  update_auto_size (mq, sq);
+}
+
 static void
 calculate_interleave (GstMultiQueue * mq)
 {
@@ -1166,7 +1565,7 @@ update_time_level (GstMultiQueue * mq, GstSingleQueue * sq)
     if (G_UNLIKELY (sink_time != GST_CLOCK_STIME_NONE)) {
       /* if we have a time, we become untainted and use the time */
       sq->sink_tainted = FALSE;
-      if (mq->use_interleave) {
+      if (USE_INTERLEAVE (mq)) {
         sq->cached_sinktime = sink_time;
         calculate_interleave (mq);
       }
@@ -1497,61 +1896,94 @@ gst_multi_queue_item_steal_object (GstMultiQueueItem * item)
   return res;
 }
 
+/* releases the contents of @item, the item itself lives in the data queue
+ * or on the stack */
 static void
-gst_multi_queue_item_destroy (GstMultiQueueItem * item)
+gst_multi_queue_item_clear (GstMultiQueueItem * item)
 {
   if (!item->is_query && item->object)
     gst_mini_object_unref (item->object);
-  g_slice_free (GstMultiQueueItem, item);
+  if (item->mqueue && item->size)
+    gst_multi_queue_budget_release (item->mqueue, item->size);
 }
 
 /* takes ownership of passed mini object! */
-static GstMultiQueueItem *
-gst_multi_queue_buffer_item_new (GstMiniObject * object, guint32 curid)
+static void
+gst_multi_queue_buffer_item_init (GstMultiQueueItem * item,
+    GstMultiQueue * mq, GstMiniObject * object, guint32 curid)
 {
-  GstMultiQueueItem *item;
-
-  item = g_slice_new (GstMultiQueueItem);
   item->object = object;
-  item->destroy = (GDestroyNotify) gst_multi_queue_item_destroy;
+  item->destroy = (GDestroyNotify) gst_multi_queue_item_clear;
   item->posid = curid;
   item->is_query = GST_IS_QUERY (object);
+  item->mqueue = mq;
 
   item->size = gst_buffer_get_size (GST_BUFFER_CAST (object));
+  if (item->size)
+    gst_multi_queue_budget_acquire (mq, item->size);
   item->duration = GST_BUFFER_DURATION (object);
   if (item->duration == GST_CLOCK_TIME_NONE)
     item->duration = 0;
   item->visible = TRUE;
-  return item;
 }
 
-static GstMultiQueueItem *
-gst_multi_queue_mo_item_new (GstMiniObject * object, guint32 curid)
+static void
+gst_multi_queue_mo_item_init (GstMultiQueueItem * item,
+    GstMiniObject * object, guint32 curid)
 {
-  GstMultiQueueItem *item;
-
-  item = g_slice_new (GstMultiQueueItem);
   item->object = object;
-  item->destroy = (GDestroyNotify) gst_multi_queue_item_destroy;
+  item->destroy = (GDestroyNotify) gst_multi_queue_item_clear;
   item->posid = curid;
   item->is_query = GST_IS_QUERY (object);
+  item->mqueue = NULL;
 
   item->size = 0;
   item->duration = 0;
   item->visible = FALSE;
-  return item;
+}
+
+/* wake up the drain thread or a scheduleable srcpad task after queueing
+ * something, must be called without the qlock */
+static void
+gst_single_queue_schedule_task (GstSingleQueue * sq)
+{
+  GstMultiQueue *mq = sq->mqueue;
+  GstTask *task;
+
+  if (mq->drain_groups) {
+    GST_MULTI_QUEUE_MUTEX_LOCK (mq);
+    if (mq->drain_groups)
+      g_cond_signal (&mq->drain_groups[sq->id % mq->n_drain_groups].cond);
+    GST_MULTI_QUEUE_MUTEX_UNLOCK (mq);
+    return;
+  }
+
+  if (!sq->schedule_task)
+    return;
+
+  GST_OBJECT_LOCK (sq->srcpad);
+  if ((task = GST_PAD_TASK (sq->srcpad)))
+    gst_object_ref (task);
+  GST_OBJECT_UNLOCK (sq->srcpad);
+
+  if (task) {
+    gst_task_schedule (task);
+    gst_object_unref (task);
+  }
 }
 
 /* Each main loop attempts to push buffers until the return value
  * is not-linked. not-linked pads are not allowed to push data beyond
  * any linked pads, so they don't 'rush ahead of the pack'.
+ *
+ * With @drain this is called from a drain thread with the srcpad stream
+ * lock and at least one item queued. It then never waits, the drain thread
+ * already picked the queue in running time order.
  */
 static void
-gst_multi_queue_loop (GstPad * pad)
+gst_single_queue_loop (GstSingleQueue * sq, gboolean drain)
 {
-  GstSingleQueue *sq;
-  GstMultiQueueItem *item;
-  GstDataQueueItem *sitem;
+  GstMultiQueueItem item;
   GstMultiQueue *mq;
   GstMiniObject *object = NULL;
   guint32 newid;
@@ -1559,10 +1991,10 @@ gst_multi_queue_loop (GstPad * pad)
   GstClockTimeDiff next_time;
   gboolean is_buffer;
   gboolean do_update_buffering = FALSE;
-  gboolean dropping = FALSE;
+  gboolean dropping;
 
-  sq = (GstSingleQueue *) gst_pad_get_element_private (pad);
   mq = sq->mqueue;
+  dropping = drain ? sq->drain_dropping : FALSE;
 
 next:
   GST_DEBUG_OBJECT (mq, "SingleQueue %d : trying to pop an object", sq->id);
@@ -1570,17 +2002,30 @@ next:
   if (sq->flushing)
     goto out_flushing;
 
+  if (!drain && sq->schedule_task) {
+    GstTask *task = GST_PAD_TASK (sq->srcpad);
+
+    /* Unschedule before checking, anything queued after the check
+     * schedules the task again. Give the thread back when empty. */
+    gst_task_unschedule (task);
+    if (gst_data_queue_is_empty (sq->queue)) {
+      GST_LOG_OBJECT (mq, "SingleQueue %d : empty, yielding", sq->id);
+      return;
+    }
+    gst_task_schedule (task);
+  }
+
   /* Get something from the queue, blocking until that happens, or we get
    * flushed */
-  if (!(gst_data_queue_pop (sq->queue, &sitem)))
+  if (!(gst_data_queue_pop_struct (sq->queue, (GstDataQueueItem *) & item)))
     goto out_flushing;
+  GST_SINGLE_QUEUE_TRACE_LEVEL (sq, DEQUEUE);
 
-  item = (GstMultiQueueItem *) sitem;
-  newid = item->posid;
+  newid = item.posid;
 
-  /* steal the object and destroy the item */
-  object = gst_multi_queue_item_steal_object (item);
-  gst_multi_queue_item_destroy (item);
+  /* steal the object and clear the item */
+  object = gst_multi_queue_item_steal_object (&item);
+  gst_multi_queue_item_clear (&item);
 
   is_buffer = GST_IS_BUFFER (object);
 
@@ -1620,7 +2065,7 @@ next:
     if (sq->last_oldid != G_MAXUINT32)
       sq->oldid = sq->last_oldid;
 
-    if (sq->srcresult == GST_FLOW_NOT_LINKED) {
+    if (!drain && sq->srcresult == GST_FLOW_NOT_LINKED) {
       /* Go to sleep until it's time to push this buffer */
 
       /* Recompute the highid */
@@ -1778,7 +2223,12 @@ next:
   }
   GST_MULTI_QUEUE_MUTEX_UNLOCK (mq);
 
-  if (dropping)
+  if (drain) {
+    /* don't wait for the next item, continue dropping when it arrives */
+    sq->drain_dropping = dropping;
+    if (dropping && !gst_data_queue_is_empty (sq->queue))
+      goto next;
+  } else if (dropping)
     goto next;
 
   if (result != GST_FLOW_OK && result != GST_FLOW_NOT_LINKED
@@ -1817,7 +2267,8 @@ out_flushing:
     gst_single_queue_flush_queue (sq, FALSE);
     single_queue_underrun_cb (sq->queue, sq);
     gst_data_queue_set_flushing (sq->queue, TRUE);
-    gst_pad_pause_task (sq->srcpad);
+    if (!drain)
+      gst_pad_pause_task (sq->srcpad);
     GST_CAT_LOG_OBJECT (multi_queue_debug, mq,
         "SingleQueue[%d] task paused, reason:%s",
         sq->id, gst_flow_get_name (sq->srcresult));
@@ -1825,6 +2276,192 @@ out_flushing:
   }
 }
 
+static void
+gst_multi_queue_loop (GstPad * pad)
+{
+  GstSingleQueue *sq;
+
+  sq = (GstSingleQueue *) gst_pad_get_element_private (pad);
+
+  gst_single_queue_loop (sq, FALSE);
+}
+
+/* items without running time, like most events, go first and ties are
+ * broken by arrival order */
+static gboolean
+drain_item_is_before (GstClockTimeDiff time, guint32 id,
+    GstClockTimeDiff best_time, guint32 best_id)
+{
+  if (!GST_CLOCK_STIME_IS_VALID (time))
+    return GST_CLOCK_STIME_IS_VALID (best_time) || id < best_id;
+  if (!GST_CLOCK_STIME_IS_VALID (best_time))
+    return FALSE;
+  if (time != best_time)
+    return time < best_time;
+  return id < best_id;
+}
+
+/* WITH LOCK TAKEN
+ * Find the queue of @group with the lowest running time at its head, or
+ * %NULL when all of them are empty. */
+static GstSingleQueue *
+gst_multi_queue_drain_next (GstMultiQueue * mq, GstMultiQueueDrainGroup * group)
+{
+  GstSingleQueue *best = NULL;
+  GstClockTimeDiff best_time = GST_CLOCK_STIME_NONE;
+  guint32 best_id = 0;
+  GList *tmp;
+
+  for (tmp = mq->queues; tmp; tmp = g_list_next (tmp)) {
+    GstSingleQueue *sq = (GstSingleQueue *) tmp->data;
+    GstMultiQueueItem item;
+    GstClockTimeDiff time;
+
+    if (sq->id % mq->n_drain_groups != group->idx)
+      continue;
+    if (sq->flushing || !GST_PAD_IS_ACTIVE (sq->srcpad))
+      continue;
+    /* we are the only one popping, it stays non-empty */
+    if (gst_data_queue_is_empty (sq->queue)
+        || !gst_data_queue_peek_struct (sq->queue,
+            (GstDataQueueItem *) & item))
+      continue;
+
+    time = get_running_time (&sq->src_segment, item.object, FALSE);
+
+    if (best == NULL
+        || drain_item_is_before (time, item.posid, best_time, best_id)) {
+      best = sq;
+      best_time = time;
+      best_id = item.posid;
+    }
+  }
+
+  return best;
+}
+
+static void
+gst_multi_queue_drain_loop (GstMultiQueueDrainGroup * group)
+{
+  GstMultiQueue *mq = group->mq;
+  GstSingleQueue *sq;
+
+  GST_MULTI_QUEUE_MUTEX_LOCK (mq);
+  if (group->stopping)
+    goto stopping;
+
+  if (!(sq = gst_multi_queue_drain_next (mq, group))) {
+    /* wait for more data and look again on the next iteration */
+    g_cond_wait (&group->cond, &mq->qlock);
+    GST_MULTI_QUEUE_MUTEX_UNLOCK (mq);
+    return;
+  }
+
+  /* the stream lock is taken before the qlock by the pushing code, don't
+   * block on it here. It is only held briefly by a flush or deactivation. */
+  if (!g_rec_mutex_trylock (GST_PAD_GET_STREAM_LOCK (sq->srcpad))) {
+    GST_MULTI_QUEUE_MUTEX_UNLOCK (mq);
+    GST_LOG_OBJECT (mq, "SingleQueue %d : srcpad busy", sq->id);
+    g_thread_yield ();
+    return;
+  }
+  GST_MULTI_QUEUE_MUTEX_UNLOCK (mq);
+
+  /* the stream lock keeps the queue from being released */
+  gst_single_queue_loop (sq, TRUE);
+  GST_PAD_STREAM_UNLOCK (sq->srcpad);
+
+  return;
+
+stopping:
+  {
+    GST_MULTI_QUEUE_MUTEX_UNLOCK (mq);
+    GST_DEBUG_OBJECT (mq, "drain thread %u stopping", group->idx);
+    return;
+  }
+}
+
+static void
+gst_multi_queue_start_drain (GstMultiQueue * mq)
+{
+  GstMultiQueueDrainGroup *groups;
+  gchar *name;
+  guint i, n;
+
+  GST_MULTI_QUEUE_MUTEX_LOCK (mq);
+  n = mq->drain_threads;
+  GST_MULTI_QUEUE_MUTEX_UNLOCK (mq);
+
+  if (n == 0)
+    return;
+
+  GST_DEBUG_OBJECT (mq, "starting %u drain threads", n);
+
+  groups = g_new0 (GstMultiQueueDrainGroup, n);
+  for (i = 0; i < n; i++) {
+    groups[i].mq = mq;
+    groups[i].idx = i;
+    g_rec_mutex_init (&groups[i].lock);
+    g_cond_init (&groups[i].cond);
+    groups[i].stopping = FALSE;
+
+    groups[i].task =
+        gst_task_new ((GstTaskFunction) gst_multi_queue_drain_loop, &groups[i],
+        NULL);
+    gst_task_set_lock (groups[i].task, &groups[i].lock);
+    name = g_strdup_printf ("%s:drain%u", GST_OBJECT_NAME (mq), i);
+    gst_object_set_name (GST_OBJECT_CAST (groups[i].task), name);
+    g_free (name);
+  }
+
+  GST_MULTI_QUEUE_MUTEX_LOCK (mq);
+  mq->drain_groups = groups;
+  mq->n_drain_groups = n;
+  GST_MULTI_QUEUE_MUTEX_UNLOCK (mq);
+
+  for (i = 0; i < n; i++)
+    gst_task_start (groups[i].task);
+}
+
+static void
+gst_multi_queue_stop_drain (GstMultiQueue * mq)
+{
+  GstMultiQueueDrainGroup *groups;
+  guint i, n;
+
+  GST_MULTI_QUEUE_MUTEX_LOCK (mq);
+  groups = mq->drain_groups;
+  n = mq->n_drain_groups;
+  GST_MULTI_QUEUE_MUTEX_UNLOCK (mq);
+
+  if (groups == NULL)
+    return;
+
+  GST_DEBUG_OBJECT (mq, "stopping %u drain threads", n);
+
+  for (i = 0; i < n; i++) {
+    gst_task_stop (groups[i].task);
+    GST_MULTI_QUEUE_MUTEX_LOCK (mq);
+    groups[i].stopping = TRUE;
+    g_cond_signal (&groups[i].cond);
+    GST_MULTI_QUEUE_MUTEX_UNLOCK (mq);
+  }
+
+  for (i = 0; i < n; i++) {
+    gst_task_join (groups[i].task);
+    gst_object_unref (groups[i].task);
+    g_rec_mutex_clear (&groups[i].lock);
+    g_cond_clear (&groups[i].cond);
+  }
+
+  GST_MULTI_QUEUE_MUTEX_LOCK (mq);
+  mq->drain_groups = NULL;
+  mq->n_drain_groups = 0;
+  GST_MULTI_QUEUE_MUTEX_UNLOCK (mq);
+
+  g_free (groups);
+}
+
 /**
  * gst_multi_queue_chain:
  *
@@ -1837,7 +2474,7 @@ gst_multi_queue_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
 {
   GstSingleQueue *sq;
   GstMultiQueue *mq;
-  GstMultiQueueItem *item;
+  GstMultiQueueItem item;
   guint32 curid;
   GstClockTime timestamp, duration;
 
@@ -1862,10 +2499,11 @@ gst_multi_queue_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
       sq->id, buffer, curid, GST_TIME_ARGS (GST_BUFFER_PTS (buffer)),
       GST_TIME_ARGS (GST_BUFFER_DTS (buffer)), GST_TIME_ARGS (duration));
 
-  item = gst_multi_queue_buffer_item_new (GST_MINI_OBJECT_CAST (buffer), curid);
+  gst_multi_queue_buffer_item_init (&item, mq, GST_MINI_OBJECT_CAST (buffer),
+      curid);
 
   /* Update interleave before pushing data into queue */
-  if (mq->use_interleave) {
+  if (USE_INTERLEAVE (mq)) {
     GstClockTime val = timestamp;
     GstClockTimeDiff dval;
 
@@ -1883,16 +2521,20 @@ gst_multi_queue_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
           GST_STIME_FORMAT, sq->id, sq->cached_sinktime,
           GST_STIME_ARGS (sq->cached_sinktime));
       calculate_interleave (mq);
+      if (mq->auto_size)
+        update_input_rate (mq, sq, gst_buffer_get_size (buffer), dval);
     }
     GST_MULTI_QUEUE_MUTEX_UNLOCK (mq);
   }
 
-  if (!(gst_data_queue_push (sq->queue, (GstDataQueueItem *) item)))
+  if (!(gst_data_queue_push (sq->queue, (GstDataQueueItem *) & item)))
     goto flushing;
+  gst_single_queue_schedule_task (sq);
 
   /* update time level, we must do this after pushing the data in the queue so
    * that we never end up filling the queue first. */
   apply_buffer (mq, sq, timestamp, duration, &sq->sink_segment);
+  GST_SINGLE_QUEUE_TRACE_LEVEL (sq, ENQUEUE);
 
 done:
   return sq->srcresult;
@@ -1902,7 +2544,7 @@ flushing:
   {
     GST_LOG_OBJECT (mq, "SingleQueue %d : exit because task paused, reason: %s",
         sq->id, gst_flow_get_name (sq->srcresult));
-    gst_multi_queue_item_destroy (item);
+    gst_multi_queue_item_clear (&item);
     goto done;
   }
 was_eos:
@@ -1976,7 +2618,7 @@ gst_multi_queue_sink_event (GstPad * pad, GstObject * parent, GstEvent * event)
   GstSingleQueue *sq;
   GstMultiQueue *mq;
   guint32 curid;
-  GstMultiQueueItem *item;
+  GstMultiQueueItem item;
   gboolean res = TRUE;
   GstFlowReturn flowret = GST_FLOW_OK;
   GstEventType type;
@@ -2031,7 +2673,7 @@ gst_multi_queue_sink_event (GstPad * pad, GstObject * parent, GstEvent * event)
       /* take ref because the queue will take ownership and we need the event
        * afterwards to update the segment */
       sref = gst_event_ref (event);
-      if (mq->use_interleave) {
+      if (USE_INTERLEAVE (mq)) {
         GstClockTime val, dur;
         GstClockTime stime;
         gst_event_parse_gap (event, &val, &dur);
@@ -2064,14 +2706,15 @@ gst_multi_queue_sink_event (GstPad * pad, GstObject * parent, GstEvent * event)
   /* Get an unique incrementing id. */
   curid = g_atomic_int_add ((gint *) & mq->counter, 1);
 
-  item = gst_multi_queue_mo_item_new ((GstMiniObject *) event, curid);
+  gst_multi_queue_mo_item_init (&item, (GstMiniObject *) event, curid);
 
   GST_DEBUG_OBJECT (mq,
       "SingleQueue %d : Enqueuing event %p of type %s with id %d",
       sq->id, event, GST_EVENT_TYPE_NAME (event), curid);
 
-  if (!gst_data_queue_push (sq->queue, (GstDataQueueItem *) item))
+  if (!gst_data_queue_push (sq->queue, (GstDataQueueItem *) & item))
     goto flushing;
+  gst_single_queue_schedule_task (sq);
 
   /* mark EOS when we received one, we must do that after putting the
    * buffer in the queue because EOS marks the buffer as filled. */
@@ -2132,7 +2775,7 @@ flushing:
         sq->id, gst_flow_get_name (sq->srcresult));
     if (sref)
       gst_event_unref (sref);
-    gst_multi_queue_item_destroy (item);
+    gst_multi_queue_item_clear (&item);
     return sq->srcresult;
   }
 was_eos:
@@ -2157,7 +2800,7 @@ gst_multi_queue_sink_query (GstPad * pad, GstObject * parent, GstQuery * query)
     default:
       if (GST_QUERY_IS_SERIALIZED (query)) {
         guint32 curid;
-        GstMultiQueueItem *item;
+        GstMultiQueueItem item;
 
         GST_MULTI_QUEUE_MUTEX_LOCK (mq);
         if (sq->srcresult != GST_FLOW_OK)
@@ -2174,13 +2817,15 @@ gst_multi_queue_sink_query (GstPad * pad, GstObject * parent, GstQuery * query)
           /* Get an unique incrementing id. */
           curid = g_atomic_int_add ((gint *) & mq->counter, 1);
 
-          item = gst_multi_queue_mo_item_new ((GstMiniObject *) query, curid);
+          gst_multi_queue_mo_item_init (&item, (GstMiniObject *) query, curid);
 
           GST_DEBUG_OBJECT (mq,
               "SingleQueue %d : Enqueuing query %p of type %s with id %d",
               sq->id, query, GST_QUERY_TYPE_NAME (query), curid);
           GST_MULTI_QUEUE_MUTEX_UNLOCK (mq);
-          res = gst_data_queue_push (sq->queue, (GstDataQueueItem *) item);
+          res = gst_data_queue_push (sq->queue, (GstDataQueueItem *) & item);
+          if (res)
+            gst_single_queue_schedule_task (sq);
           GST_MULTI_QUEUE_MUTEX_LOCK (mq);
           /* it might be that the query has been taken out of the queue
            * while we were unlocked. So, we need to check if the last
@@ -2437,6 +3082,8 @@ single_queue_overrun_cb (GstDataQueue * dq, GstSingleQueue * sq)
   gboolean filled = TRUE;
   gboolean empty_found = FALSE;
 
+  GST_TRACER_QUEUE_OVERRUN (GST_ELEMENT_CAST (mq), sq->sinkpad);
+
   gst_data_queue_get_level (sq->queue, &size);
 
   GST_LOG_OBJECT (mq,
@@ -2483,6 +3130,15 @@ single_queue_overrun_cb (GstDataQueue * dq, GstSingleQueue * sq)
           sq->id, sq->max_size.visible);
       filled = FALSE;
     }
+    /* same for the memory budget, blocking here would deadlock */
+    if (size.visible >= sq->budget_visible
+        && gst_multi_queue_is_over_budget (mq)) {
+      sq->budget_visible = size.visible + 1;
+      GST_DEBUG_OBJECT (mq,
+          "Ignoring the memory budget for single queue %d up to %d visible",
+          sq->id, sq->budget_visible);
+      filled = FALSE;
+    }
   }
 
 done:
@@ -2502,6 +3158,8 @@ single_queue_underrun_cb (GstDataQueue * dq, GstSingleQueue * sq)
   GstMultiQueue *mq = sq->mqueue;
   GList *tmp;
 
+  GST_TRACER_QUEUE_UNDERRUN (GST_ELEMENT_CAST (mq), sq->sinkpad);
+
   if (sq->srcresult == GST_FLOW_NOT_LINKED) {
     GST_LOG_OBJECT (mq, "Single Queue %d is empty but not-linked", sq->id);
     return;
@@ -2559,6 +3217,9 @@ single_queue_check_full (GstDataQueue * dataq, guint visible, guint bytes,
 
   /* check time or bytes */
   res = IS_FILLED (sq, bytes, bytes);
+  /* and the shared budget, an empty queue can't wait for itself to drain */
+  if (!res && bytes > 0 && visible >= sq->budget_visible)
+    res = gst_multi_queue_is_over_budget (mq);
   /* We only care about limits in time if we're not a sparse stream or
    * we're not syncing by running time */
   if (!sq->is_sparse || !mq->sync_by_running_time) {
@@ -2578,8 +3239,7 @@ single_queue_check_full (GstDataQueue * dataq, guint visible, guint bytes,
 static void
 gst_single_queue_flush_queue (GstSingleQueue * sq, gboolean full)
 {
-  GstDataQueueItem *sitem;
-  GstMultiQueueItem *mitem;
+  GstMultiQueueItem mitem;
   gboolean was_flushing = FALSE;
 
   while (!gst_data_queue_is_empty (sq->queue)) {
@@ -2589,29 +3249,28 @@ gst_single_queue_flush_queue (GstSingleQueue * sq, gboolean full)
      * we're flushing... but we want to rescue all sticky
      * events nonetheless.
      */
-    if (!gst_data_queue_pop (sq->queue, &sitem)) {
+    if (!gst_data_queue_pop_struct (sq->queue, (GstDataQueueItem *) & mitem)) {
       was_flushing = TRUE;
       gst_data_queue_set_flushing (sq->queue, FALSE);
       continue;
     }
 
-    mitem = (GstMultiQueueItem *) sitem;
-
-    data = sitem->object;
+    data = mitem.object;
 
-    if (!full && !mitem->is_query && GST_IS_EVENT (data)
+    if (!full && !mitem.is_query && GST_IS_EVENT (data)
         && GST_EVENT_IS_STICKY (data)
         && GST_EVENT_TYPE (data) != GST_EVENT_SEGMENT
         && GST_EVENT_TYPE (data) != GST_EVENT_EOS) {
       gst_pad_store_sticky_event (sq->srcpad, GST_EVENT_CAST (data));
     }
 
-    sitem->destroy (sitem);
+    gst_multi_queue_item_clear (&mitem);
   }
 
   gst_data_queue_flush (sq->queue);
   if (was_flushing)
     gst_data_queue_set_flushing (sq->queue, TRUE);
+  sq->budget_visible = 0;
 
   GST_MULTI_QUEUE_MUTEX_LOCK (sq->mqueue);
   update_buffering (sq->mqueue, sq);
@@ -2680,14 +3339,17 @@ gst_single_queue_new (GstMultiQueue * mqueue, guint id)
   sq->mqueue = mqueue;
   sq->srcresult = GST_FLOW_FLUSHING;
   sq->pushed = FALSE;
-  sq->queue = gst_data_queue_new ((GstDataQueueCheckFullFunction)
+  sq->queue = gst_data_queue_new_for_struct ((GstDataQueueCheckFullFunction)
       single_queue_check_full,
       (GstDataQueueFullCallback) single_queue_overrun_cb,
-      (GstDataQueueEmptyCallback) single_queue_underrun_cb, sq);
+      (GstDataQueueEmptyCallback) single_queue_underrun_cb, sq,
+      sizeof (GstMultiQueueItem));
   sq->is_eos = FALSE;
   sq->is_sparse = FALSE;
+  sq->rate_start = GST_CLOCK_STIME_NONE;
   sq->flushing = FALSE;
   sq->active = FALSE;
+  sq->schedule_task = FALSE;
   gst_segment_init (&sq->sink_segment, GST_FORMAT_TIME);
   gst_segment_init (&sq->src_segment, GST_FORMAT_TIME);
 
@@ -41,6 +41,7 @@ G_BEGIN_DECLS
 
 typedef struct _GstMultiQueue GstMultiQueue;
 typedef struct _GstMultiQueueClass GstMultiQueueClass;
+typedef struct _GstMultiQueueDrainGroup GstMultiQueueDrainGroup;
 
 /**
  * GstMultiQueue:
@@ -52,6 +53,7 @@ struct _GstMultiQueue {
 
   gboolean sync_by_running_time;
   gboolean use_interleave;
+  gboolean auto_size;
 
   /* number of queues */
   guint	nbqueues;
@@ -83,6 +85,20 @@ struct _GstMultiQueue {
   GstClockTimeDiff last_interleave_update;
 
   GstClockTime unlinked_cache_time;
+
+  guint drain_threads;
+  /* array of n_drain_groups while drain threads are running, protected by
+   * qlock and only changed while the srcpads are not active */
+  GstMultiQueueDrainGroup *drain_groups;
+  guint n_drain_groups;
+
+  /* shared memory budget from the context, accounting the bytes of all
+   * queued buffers, protected by the budget_lock */
+  GMutex budget_lock;
+  GstMemoryBudget *budget;
+  GstMemoryBudgetClient *budget_client;
+  guint budget_priority;
+  guint64 budget_bytes;
 };
 
 struct _GstMultiQueueClass {
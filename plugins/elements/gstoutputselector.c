@@ -22,6 +22,10 @@
  * @see_also: #GstOutputSelector, #GstInputSelector
  *
  * Direct input stream to one out of N output pads.
+ *
+ * When #GstOutputSelector:multi-active is enabled, the input stream is
+ * instead pushed to every src pad that has its #GstOutputSelectorPad:active
+ * property set, like a tee that does not proxy allocation queries.
  */
 
 #ifdef HAVE_CONFIG_H
@@ -73,10 +77,126 @@ enum
   PROP_0,
   PROP_ACTIVE_PAD,
   PROP_RESEND_LATEST,
-  PROP_PAD_NEGOTIATION_MODE
+  PROP_PAD_NEGOTIATION_MODE,
+  PROP_MULTI_ACTIVE
 };
 
 #define DEFAULT_PAD_NEGOTIATION_MODE GST_OUTPUT_SELECTOR_PAD_NEGOTIATION_MODE_ALL
+#define DEFAULT_MULTI_ACTIVE FALSE
+#define DEFAULT_PAD_ACTIVE TRUE
+
+/* immutable snapshot of the active src pads, each holding a ref */
+typedef struct
+{
+  guint n_pads;
+  GstPad *pads[1];
+} GstOutputSelectorSet;
+
+static void gst_output_selector_update_active_set (GstOutputSelector * sel);
+
+#define GST_TYPE_OUTPUT_SELECTOR_PAD \
+  (gst_output_selector_pad_get_type())
+#define GST_OUTPUT_SELECTOR_PAD(obj) \
+  (G_TYPE_CHECK_INSTANCE_CAST((obj),GST_TYPE_OUTPUT_SELECTOR_PAD,GstOutputSelectorPad))
+#define GST_OUTPUT_SELECTOR_PAD_CAST(obj) ((GstOutputSelectorPad *)(obj))
+
+typedef struct _GstOutputSelectorPad GstOutputSelectorPad;
+typedef struct _GstOutputSelectorPadClass GstOutputSelectorPadClass;
+
+struct _GstOutputSelectorPad
+{
+  GstPad parent;
+
+  gboolean active;
+};
+
+struct _GstOutputSelectorPadClass
+{
+  GstPadClass parent;
+};
+
+GType gst_output_selector_pad_get_type (void);
+
+enum
+{
+  PROP_PAD_0,
+  PROP_PAD_ACTIVE
+};
+
+G_DEFINE_TYPE (GstOutputSelectorPad, gst_output_selector_pad, GST_TYPE_PAD);
+
+static void
+gst_output_selector_pad_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstOutputSelectorPad *pad = GST_OUTPUT_SELECTOR_PAD (object);
+
+  switch (prop_id) {
+    case PROP_PAD_ACTIVE:{
+      GstElement *parent;
+
+      parent = gst_pad_get_parent_element (GST_PAD_CAST (pad));
+      if (parent) {
+        GST_OBJECT_LOCK (parent);
+        pad->active = g_value_get_boolean (value);
+        GST_OBJECT_UNLOCK (parent);
+        gst_output_selector_update_active_set (GST_OUTPUT_SELECTOR (parent));
+        gst_object_unref (parent);
+      } else {
+        pad->active = g_value_get_boolean (value);
+      }
+      break;
+    }
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_output_selector_pad_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec)
+{
+  GstOutputSelectorPad *pad = GST_OUTPUT_SELECTOR_PAD (object);
+
+  switch (prop_id) {
+    case PROP_PAD_ACTIVE:
+      g_value_set_boolean (value, pad->active);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_output_selector_pad_class_init (GstOutputSelectorPadClass * klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+  gobject_class->set_property = gst_output_selector_pad_set_property;
+  gobject_class->get_property = gst_output_selector_pad_get_property;
+
+  /**
+   * GstOutputSelectorPad:active:
+   *
+   * Whether this pad receives data when #GstOutputSelector:multi-active
+   * is enabled.
+   *
+   * Since: 1.10
+   */
+  g_object_class_install_property (gobject_class, PROP_PAD_ACTIVE,
+      g_param_spec_boolean ("active", "Active",
+          "Receive data in multi-active mode", DEFAULT_PAD_ACTIVE,
+          G_PARAM_READWRITE | GST_PARAM_MUTABLE_PLAYING |
+          G_PARAM_STATIC_STRINGS));
+}
+
+static void
+gst_output_selector_pad_init (GstOutputSelectorPad * pad)
+{
+  pad->active = DEFAULT_PAD_ACTIVE;
+}
 
 #define _do_init \
 GST_DEBUG_CATEGORY_INIT (output_selector_debug, \
@@ -131,6 +251,22 @@ gst_output_selector_class_init (GstOutputSelectorClass * klass)
           GST_TYPE_OUTPUT_SELECTOR_PAD_NEGOTIATION_MODE,
           DEFAULT_PAD_NEGOTIATION_MODE,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstOutputSelector:multi-active:
+   *
+   * Push the input stream to all src pads that have their
+   * #GstOutputSelectorPad:active property set instead of only to
+   * #GstOutputSelector:active-pad. The streaming thread picks up changes to
+   * the set of active pads without taking any lock, and allocation queries
+   * are not forwarded downstream.
+   *
+   * Since: 1.10
+   */
+  g_object_class_install_property (gobject_class, PROP_MULTI_ACTIVE,
+      g_param_spec_boolean ("multi-active", "Multi active",
+          "Push to all src pads that are active", DEFAULT_MULTI_ACTIVE,
+          G_PARAM_READWRITE | GST_PARAM_MUTABLE_PLAYING |
+          G_PARAM_STATIC_STRINGS));
 
   gst_element_class_set_static_metadata (gstelement_class, "Output selector",
       "Generic", "1-to-N output stream selector",
@@ -173,6 +309,77 @@ gst_output_selector_init (GstOutputSelector * sel)
   sel->latest_buffer = NULL;
   gst_output_selector_switch_pad_negotiation_mode (sel,
       DEFAULT_PAD_NEGOTIATION_MODE);
+
+  sel->multi_active = DEFAULT_MULTI_ACTIVE;
+  sel->pending_set = NULL;
+  sel->active_set = NULL;
+}
+
+static void
+gst_output_selector_set_free (GstOutputSelectorSet * set)
+{
+  guint i;
+
+  for (i = 0; i < set->n_pads; i++)
+    gst_object_unref (set->pads[i]);
+  g_free (set);
+}
+
+/* Called from the application threads whenever the set of active pads
+ * might have changed. The new set is built and published under the object
+ * lock so that concurrent updates are published in order, the streaming
+ * thread only ever swaps the pointer. */
+static void
+gst_output_selector_update_active_set (GstOutputSelector * sel)
+{
+  GstOutputSelectorSet *set, *old;
+  GList *walk;
+  guint n = 0;
+
+  GST_OBJECT_LOCK (sel);
+  for (walk = GST_ELEMENT_CAST (sel)->srcpads; walk; walk = walk->next) {
+    if (GST_OUTPUT_SELECTOR_PAD_CAST (walk->data)->active)
+      n++;
+  }
+
+  set = g_malloc (sizeof (GstOutputSelectorSet) + n * sizeof (GstPad *));
+  set->n_pads = 0;
+  for (walk = GST_ELEMENT_CAST (sel)->srcpads; walk; walk = walk->next) {
+    if (GST_OUTPUT_SELECTOR_PAD_CAST (walk->data)->active)
+      set->pads[set->n_pads++] = gst_object_ref (walk->data);
+  }
+
+  do {
+    old = g_atomic_pointer_get (&sel->pending_set);
+  } while (!g_atomic_pointer_compare_and_exchange (&sel->pending_set, old,
+          set));
+  GST_OBJECT_UNLOCK (sel);
+
+  GST_DEBUG_OBJECT (sel, "published set of %u active pads", n);
+
+  /* the streaming thread never saw this one */
+  if (old)
+    gst_output_selector_set_free (old);
+}
+
+/* Called from the streaming thread only */
+static GstOutputSelectorSet *
+gst_output_selector_get_active_set (GstOutputSelector * sel)
+{
+  GstOutputSelectorSet *set;
+
+  do {
+    set = g_atomic_pointer_get (&sel->pending_set);
+  } while (set && !g_atomic_pointer_compare_and_exchange (&sel->pending_set,
+          set, NULL));
+
+  if (set) {
+    if (sel->active_set)
+      gst_output_selector_set_free (sel->active_set);
+    sel->active_set = set;
+  }
+
+  return sel->active_set;
 }
 
 static void
@@ -196,9 +403,20 @@ static void
 gst_output_selector_dispose (GObject * object)
 {
   GstOutputSelector *osel = GST_OUTPUT_SELECTOR (object);
+  GstOutputSelectorSet *set;
 
   gst_output_selector_reset (osel);
 
+  set = g_atomic_pointer_get (&osel->pending_set);
+  if (set) {
+    gst_output_selector_set_free (set);
+    osel->pending_set = NULL;
+  }
+  if (osel->active_set) {
+    gst_output_selector_set_free (osel->active_set);
+    osel->active_set = NULL;
+  }
+
   G_OBJECT_CLASS (parent_class)->dispose (object);
 }
 
@@ -247,6 +465,12 @@ gst_output_selector_set_property (GObject * object, guint prop_id,
           g_value_get_enum (value));
       break;
     }
+    case PROP_MULTI_ACTIVE:
+      GST_OBJECT_LOCK (object);
+      sel->multi_active = g_value_get_boolean (value);
+      GST_OBJECT_UNLOCK (object);
+      gst_output_selector_update_active_set (sel);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -275,6 +499,11 @@ gst_output_selector_get_property (GObject * object, guint prop_id,
     case PROP_PAD_NEGOTIATION_MODE:
       g_value_set_enum (value, sel->pad_negotiation_mode);
       break;
+    case PROP_MULTI_ACTIVE:
+      GST_OBJECT_LOCK (object);
+      g_value_set_boolean (value, sel->multi_active);
+      GST_OBJECT_UNLOCK (object);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -327,7 +556,8 @@ gst_output_selector_request_new_pad (GstElement * element,
 
   GST_OBJECT_LOCK (osel);
   padname = g_strdup_printf ("src_%u", osel->nb_srcpads++);
-  srcpad = gst_pad_new_from_template (templ, padname);
+  srcpad = g_object_new (GST_TYPE_OUTPUT_SELECTOR_PAD, "name", padname,
+      "direction", templ->direction, "template", templ, NULL);
   GST_OBJECT_UNLOCK (osel);
 
   gst_pad_set_active (srcpad, TRUE);
@@ -348,6 +578,8 @@ gst_output_selector_request_new_pad (GstElement * element,
   }
   g_free (padname);
 
+  gst_output_selector_update_active_set (osel);
+
   return srcpad;
 }
 
@@ -373,6 +605,8 @@ gst_output_selector_release_pad (GstElement * element, GstPad * pad)
   gst_pad_set_active (pad, FALSE);
 
   gst_element_remove_pad (GST_ELEMENT_CAST (osel), pad);
+
+  gst_output_selector_update_active_set (osel);
 }
 
 static gboolean
@@ -450,6 +684,39 @@ gst_output_selector_switch (GstOutputSelector * osel)
   return res;
 }
 
+static GstFlowReturn
+gst_output_selector_chain_multi (GstOutputSelector * osel, GstBuffer * buf)
+{
+  GstOutputSelectorSet *set;
+  GstFlowReturn ret = GST_FLOW_NOT_LINKED, res;
+  guint i;
+
+  set = gst_output_selector_get_active_set (osel);
+  if (set == NULL || set->n_pads == 0) {
+    GST_DEBUG_OBJECT (osel, "No active srcpad");
+    gst_buffer_unref (buf);
+    return GST_FLOW_OK;
+  }
+
+  for (i = 0; i < set->n_pads; i++) {
+    GST_LOG_OBJECT (osel, "pushing buffer to %" GST_PTR_FORMAT, set->pads[i]);
+    res = gst_pad_push (set->pads[i], gst_buffer_ref (buf));
+
+    /* one linked pad is enough to keep going, like tee */
+    if (res == GST_FLOW_OK) {
+      ret = GST_FLOW_OK;
+    } else if (res <= GST_FLOW_NOT_NEGOTIATED) {
+      ret = res;
+      break;
+    } else if (ret != GST_FLOW_OK && res != GST_FLOW_NOT_LINKED) {
+      ret = res;
+    }
+  }
+  gst_buffer_unref (buf);
+
+  return ret;
+}
+
 static GstFlowReturn
 gst_output_selector_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
 {
@@ -460,6 +727,9 @@ gst_output_selector_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
 
   osel = GST_OUTPUT_SELECTOR (parent);
 
+  if (osel->multi_active)
+    return gst_output_selector_chain_multi (osel, buf);
+
   /*
    * The _switch function might push a buffer if 'resend-latest' is true.
    *
@@ -582,6 +852,13 @@ gst_output_selector_event (GstPad * pad, GstObject * parent, GstEvent * event)
 
   sel = GST_OUTPUT_SELECTOR (parent);
 
+  if (sel->multi_active) {
+    if (GST_EVENT_TYPE (event) == GST_EVENT_SEGMENT)
+      gst_event_copy_segment (event, &sel->segment);
+    /* Send to all src pads */
+    return gst_pad_event_default (pad, parent, event);
+  }
+
   switch (GST_EVENT_TYPE (event)) {
     case GST_EVENT_EOS:
     {
@@ -643,6 +920,15 @@ gst_output_selector_query (GstPad * pad, GstObject * parent, GstQuery * query)
       }
       break;
     }
+    case GST_QUERY_ALLOCATION:
+      /* don't negotiate allocation with a changing set of downstream
+       * peers, upstream will use its defaults */
+      if (sel->multi_active) {
+        res = FALSE;
+        break;
+      }
+      res = gst_pad_query_default (pad, parent, query);
+      break;
     case GST_QUERY_DRAIN:
       if (sel->latest_buffer) {
         gst_buffer_unref (sel->latest_buffer);
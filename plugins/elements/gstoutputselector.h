@@ -55,6 +55,13 @@ struct _GstOutputSelector {
   gboolean resend_latest;
   GstBuffer *latest_buffer;
 
+  /* route to every active src pad */
+  gboolean multi_active;
+  /* set of active pads published by the application threads, picked up
+   * atomically by the streaming thread */
+  gpointer pending_set;
+  /* set in use, only touched by the streaming thread */
+  gpointer active_set;
 };
 
 struct _GstOutputSelectorClass {
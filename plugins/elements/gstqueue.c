@@ -47,7 +47,12 @@
  * As said earlier, the queue blocks by default when one of the specified
  * maximums (bytes, time, buffers) has been reached. You can set the
  * #GstQueue:leaky property to specify that instead of blocking it should
- * leak (drop) new or old buffers.
+ * leak (drop) new or old buffers. For encoded video, the queue can also
+ * prefer to leak the oldest delta unit buffers, or all buffers up to the next
+ * keyframe.
+ *
+ * With #GstQueue:max-age, buffers that are older than the given running time
+ * age against the clock when they reach the head of the queue are dropped.
  *
  * The #GstQueue::underrun signal is emitted when the queue has less data than
  * the specified minimum thresholds require (by default: when the queue is
@@ -121,7 +126,10 @@ enum
   PROP_LEAKY,
   PROP_SILENT,
   PROP_FLUSH_ON_EOS,
-  PROP_GENERATE_BUFFER_LIST
+  PROP_GENERATE_BUFFER_LIST,
+  PROP_MAX_AGE,
+  PROP_MEMORY_BUDGET_PRIORITY,
+  PROP_AUTO_BUFFER_LIST
 };
 
 /* default property values */
@@ -130,10 +138,18 @@ enum
 #define DEFAULT_MAX_SIZE_TIME     GST_SECOND    /* 1 second    */
 
 #define DEFAULT_GENERATE_BUFFER_LIST FALSE
+#define DEFAULT_AUTO_BUFFER_LIST  TRUE
+#define DEFAULT_MAX_AGE           0
 
+#ifndef GST_ENABLE_LOCK_TRACING
 #define GST_QUEUE_MUTEX_LOCK(q) G_STMT_START {                          \
   g_mutex_lock (&q->qlock);                                              \
 } G_STMT_END
+#else
+#define GST_QUEUE_MUTEX_LOCK(q) G_STMT_START {                          \
+  _gst_lock_trace_mutex_lock (&q->qlock, q, "queue");                    \
+} G_STMT_END
+#endif
 
 #define GST_QUEUE_MUTEX_LOCK_CHECK(q,label) G_STMT_START {              \
   GST_QUEUE_MUTEX_LOCK (q);                                             \
@@ -214,6 +230,7 @@ static gboolean gst_queue_handle_src_query (GstPad * pad, GstObject * parent,
     GstQuery * query);
 
 static void gst_queue_locked_flush (GstQueue * queue, gboolean full);
+static void gst_queue_set_context (GstElement * element, GstContext * context);
 
 static gboolean gst_queue_src_activate_mode (GstPad * pad, GstObject * parent,
     GstPadMode mode, gboolean active);
@@ -242,6 +259,12 @@ queue_leaky_get_type (void)
     {GST_QUEUE_LEAK_UPSTREAM, "Leaky on upstream (new buffers)", "upstream"},
     {GST_QUEUE_LEAK_DOWNSTREAM, "Leaky on downstream (old buffers)",
         "downstream"},
+    {GST_QUEUE_LEAK_DOWNSTREAM_DELTA,
+        "Leaky on the oldest delta unit (old non-keyframe buffers)",
+        "downstream-delta"},
+    {GST_QUEUE_LEAK_DOWNSTREAM_GOP,
+        "Leaky on downstream up to the next keyframe (old GOPs)",
+        "downstream-gop"},
     {0, NULL, NULL},
   };
 
@@ -253,6 +276,9 @@ queue_leaky_get_type (void)
 
 static guint gst_queue_signals[LAST_SIGNAL] = { 0 };
 
+/* the chain list function of pads that don't handle buffer lists themselves */
+static GstPadChainListFunction default_chain_list = NULL;
+
 static gboolean
 gst_queue_post_message (GstElement * element, GstMessage * msg)
 {
@@ -445,9 +471,60 @@ gst_queue_class_init (GstQueueClass * klass)
           G_PARAM_READWRITE | GST_PARAM_MUTABLE_PLAYING |
           G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstQueue:max-age
+   *
+   * Drop buffers whose running time is more than this amount of time behind
+   * the current running time of the clock when they are about to be pushed.
+   * Only applies in PLAYING, 0 disables.
+   *
+   * Since: 1.10
+   */
+  g_object_class_install_property (gobject_class, PROP_MAX_AGE,
+      g_param_spec_uint64 ("max-age", "Max. age (ns)",
+          "Drop buffers older than this running time age (in ns, 0=disable)",
+          0, G_MAXUINT64, DEFAULT_MAX_AGE,
+          G_PARAM_READWRITE | GST_PARAM_MUTABLE_PLAYING |
+          G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstQueue:memory-budget-priority
+   *
+   * The priority of the queue in the #GstMemoryBudget that was set on it with
+   * a #GstContext. The share of the budget the queue can always use is
+   * proportional to its priority. When the queue is over its share and the
+   * budget is exhausted, it is handled like a full queue.
+   *
+   * Since: 1.10
+   */
+  g_object_class_install_property (gobject_class, PROP_MEMORY_BUDGET_PRIORITY,
+      g_param_spec_uint ("memory-budget-priority", "Memory budget priority",
+          "Priority in the shared memory budget, if any", 0, G_MAXUINT,
+          GST_MEMORY_BUDGET_DEFAULT_PRIORITY,
+          G_PARAM_READWRITE | GST_PARAM_MUTABLE_PLAYING |
+          G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstQueue:auto-buffer-list
+   *
+   * If this property is set to TRUE and more buffers are queued when a buffer
+   * is pushed, all buffers up to the next event or query are combined in a
+   * buffer-list when the downstream peer handles buffer-lists itself. This
+   * reduces the per-buffer overhead when draining a backlog.
+   *
+   * Since: 1.10
+   */
+  g_object_class_install_property (gobject_class, PROP_AUTO_BUFFER_LIST,
+      g_param_spec_boolean ("auto-buffer-list", "Automatic buffer list",
+          "Combine a backlog of queued buffers in a single buffer-list when "
+          "downstream handles buffer-lists", DEFAULT_AUTO_BUFFER_LIST,
+          G_PARAM_READWRITE | GST_PARAM_MUTABLE_PLAYING |
+          G_PARAM_STATIC_STRINGS));
+
   gobject_class->finalize = gst_queue_finalize;
 
   gstelement_class->post_message = gst_queue_post_message;
+  gstelement_class->set_context = GST_DEBUG_FUNCPTR (gst_queue_set_context);
 
   gst_element_class_set_static_metadata (gstelement_class,
       "Queue",
@@ -463,6 +540,14 @@ gst_queue_class_init (GstQueueClass * klass)
   GST_DEBUG_REGISTER_FUNCPTR (gst_queue_handle_src_query);
   GST_DEBUG_REGISTER_FUNCPTR (gst_queue_chain);
   GST_DEBUG_REGISTER_FUNCPTR (gst_queue_chain_list);
+
+  {
+    GstPad *pad = gst_pad_new (NULL, GST_PAD_SINK);
+
+    gst_object_ref_sink (pad);
+    default_chain_list = GST_PAD_CHAINLISTFUNC (pad);
+    gst_object_unref (pad);
+  }
 }
 
 static void
@@ -477,6 +562,7 @@ gst_queue_init (GstQueue * queue)
   gst_pad_set_event_full_function (queue->sinkpad, gst_queue_handle_sink_event);
   gst_pad_set_query_function (queue->sinkpad, gst_queue_handle_sink_query);
   GST_PAD_SET_PROXY_CAPS (queue->sinkpad);
+  gst_pad_set_caps_cache_enabled (queue->sinkpad, TRUE);
   gst_element_add_pad (GST_ELEMENT (queue), queue->sinkpad);
 
   queue->srcpad = gst_pad_new_from_static_template (&srctemplate, "src");
@@ -486,6 +572,7 @@ gst_queue_init (GstQueue * queue)
   gst_pad_set_event_function (queue->srcpad, gst_queue_handle_src_event);
   gst_pad_set_query_function (queue->srcpad, gst_queue_handle_src_query);
   GST_PAD_SET_PROXY_CAPS (queue->srcpad);
+  gst_pad_set_caps_cache_enabled (queue->srcpad, TRUE);
   gst_element_add_pad (GST_ELEMENT (queue), queue->srcpad);
 
   GST_QUEUE_CLEAR_LEVEL (queue->cur_level);
@@ -519,6 +606,9 @@ gst_queue_init (GstQueue * queue)
   queue->newseg_applied_to_src = FALSE;
 
   queue->generate_buffer_list = DEFAULT_GENERATE_BUFFER_LIST;
+  queue->auto_buffer_list = DEFAULT_AUTO_BUFFER_LIST;
+  queue->max_age = DEFAULT_MAX_AGE;
+  queue->budget_priority = GST_MEMORY_BUDGET_DEFAULT_PRIORITY;
 
   GST_DEBUG_OBJECT (queue,
       "initialized queue's not_empty & not_full conditions");
@@ -535,11 +625,16 @@ gst_queue_finalize (GObject * object)
 
   while ((qitem = gst_queue_array_pop_head_struct (queue->queue))) {
     /* FIXME: if it's a query, shouldn't we unref that too? */
-    if (!qitem->is_query)
+    if (!qitem->is_query && qitem->item)
       gst_mini_object_unref (qitem->item);
   }
   gst_queue_array_free (queue->queue);
 
+  if (queue->budget) {
+    gst_memory_budget_remove_client (queue->budget, queue->budget_client);
+    gst_object_unref (queue->budget);
+  }
+
   g_mutex_clear (&queue->qlock);
   g_cond_clear (&queue->item_add);
   g_cond_clear (&queue->item_del);
@@ -739,6 +834,44 @@ apply_buffer_list (GstQueue * queue, GstBufferList * buffer_list,
   update_time_level (queue);
 }
 
+/* make the memory budget account the current level, with QUEUE_LOCK */
+static inline void
+gst_queue_budget_sync (GstQueue * queue)
+{
+  if (queue->budget_client == NULL
+      || queue->budget_bytes == queue->cur_level.bytes)
+    return;
+
+  if (queue->cur_level.bytes > queue->budget_bytes)
+    gst_memory_budget_client_acquire (queue->budget_client,
+        queue->cur_level.bytes - queue->budget_bytes);
+  else
+    gst_memory_budget_client_release (queue->budget_client,
+        queue->budget_bytes - queue->cur_level.bytes);
+  queue->budget_bytes = queue->cur_level.bytes;
+}
+
+/* with QUEUE_LOCK */
+static void
+gst_queue_locked_set_budget (GstQueue * queue, GstMemoryBudget * budget)
+{
+  if (budget == queue->budget)
+    return;
+
+  if (queue->budget) {
+    gst_memory_budget_remove_client (queue->budget, queue->budget_client);
+    gst_object_unref (queue->budget);
+    queue->budget_client = NULL;
+  }
+  queue->budget_bytes = 0;
+  if ((queue->budget = budget)) {
+    gst_object_ref (budget);
+    queue->budget_client =
+        gst_memory_budget_add_client (budget, queue->budget_priority);
+    gst_queue_budget_sync (queue);
+  }
+}
+
 static void
 gst_queue_locked_flush (GstQueue * queue, gboolean full)
 {
@@ -753,13 +886,16 @@ gst_queue_locked_flush (GstQueue * queue, gboolean full)
         && GST_EVENT_TYPE (qitem->item) != GST_EVENT_EOS) {
       gst_pad_store_sticky_event (queue->srcpad, GST_EVENT_CAST (qitem->item));
     }
-    if (!qitem->is_query)
+    if (!qitem->is_query && qitem->item)
       gst_mini_object_unref (qitem->item);
     memset (qitem, 0, sizeof (GstQueueItem));
   }
+  queue->delta_scan = 0;
+  queue->next_needs_discont = FALSE;
   queue->last_query = FALSE;
   g_cond_signal (&queue->query_handled);
   GST_QUEUE_CLEAR_LEVEL (queue->cur_level);
+  gst_queue_budget_sync (queue);
   queue->min_threshold.buffers = queue->orig_min_threshold.buffers;
   queue->min_threshold.bytes = queue->orig_min_threshold.bytes;
   queue->min_threshold.time = queue->orig_min_threshold.time;
@@ -785,7 +921,10 @@ gst_queue_locked_enqueue_buffer (GstQueue * queue, gpointer item)
   /* add buffer to the statistics */
   queue->cur_level.buffers++;
   queue->cur_level.bytes += bsize;
+  gst_queue_budget_sync (queue);
   apply_buffer (queue, buffer, &queue->sink_segment, TRUE);
+  GST_TRACER_QUEUE_ENQUEUE (GST_ELEMENT_CAST (queue), queue->sinkpad,
+      queue->cur_level.buffers, queue->cur_level.bytes, queue->cur_level.time);
 
   qitem.item = item;
   qitem.is_query = FALSE;
@@ -821,7 +960,10 @@ gst_queue_locked_enqueue_buffer_list (GstQueue * queue, gpointer item)
   /* add buffer to the statistics */
   queue->cur_level.buffers += gst_buffer_list_length (buffer_list);
   queue->cur_level.bytes += bsize;
+  gst_queue_budget_sync (queue);
   apply_buffer_list (queue, buffer_list, &queue->sink_segment, TRUE);
+  GST_TRACER_QUEUE_ENQUEUE (GST_ELEMENT_CAST (queue), queue->sinkpad,
+      queue->cur_level.buffers, queue->cur_level.bytes, queue->cur_level.time);
 
   qitem.item = item;
   qitem.is_query = FALSE;
@@ -894,6 +1036,40 @@ gst_queue_next_is_buffer (GstQueue * queue)
       || GST_IS_BUFFER_LIST (qitem->item));
 }
 
+/* check if the peer of the srcpad handles buffer lists itself instead of
+ * chaining the buffers one by one, with QUEUE_LOCK */
+static gboolean
+gst_queue_peer_handles_lists (GstQueue * queue)
+{
+  GstPad *peer;
+  gboolean res;
+
+  peer = gst_pad_get_peer (queue->srcpad);
+  if (peer == NULL)
+    return FALSE;
+
+  res = GST_PAD_CHAINLISTFUNC (peer) != default_chain_list;
+  gst_object_unref (peer);
+
+  return res;
+}
+
+/* pop the items of dropped delta units off the head so that the head is
+ * always a valid item, with QUEUE_LOCK */
+static void
+gst_queue_locked_trim_head (GstQueue * queue)
+{
+  GstQueueItem *qitem;
+
+  while ((qitem = gst_queue_array_peek_head_struct (queue->queue))
+      && qitem->item == NULL) {
+    gst_queue_array_pop_head_struct (queue->queue);
+    if (queue->delta_scan > 0)
+      queue->delta_scan--;
+    queue->next_needs_discont = TRUE;
+  }
+}
+
 /* dequeue an item from the queue and update level stats, with QUEUE_LOCK */
 static GstMiniObject *
 gst_queue_locked_dequeue (GstQueue * queue)
@@ -909,6 +1085,15 @@ gst_queue_locked_dequeue (GstQueue * queue)
   item = qitem->item;
   bufsize = qitem->size;
 
+  if (queue->delta_scan > 0)
+    queue->delta_scan--;
+  /* data was dropped right before this item */
+  if (queue->next_needs_discont) {
+    queue->head_needs_discont = TRUE;
+    queue->next_needs_discont = FALSE;
+  }
+  gst_queue_locked_trim_head (queue);
+
   if (GST_IS_BUFFER (item)) {
     GstBuffer *buffer = GST_BUFFER_CAST (item);
 
@@ -922,6 +1107,9 @@ gst_queue_locked_dequeue (GstQueue * queue)
     /* if the queue is empty now, update the other side */
     if (queue->cur_level.buffers == 0)
       queue->cur_level.time = 0;
+    GST_TRACER_QUEUE_DEQUEUE (GST_ELEMENT_CAST (queue), queue->sinkpad,
+        queue->cur_level.buffers, queue->cur_level.bytes,
+        queue->cur_level.time);
   } else if (GST_IS_BUFFER_LIST (item)) {
     GstBufferList *buffer_list = GST_BUFFER_LIST_CAST (item);
 
@@ -935,6 +1123,9 @@ gst_queue_locked_dequeue (GstQueue * queue)
     /* if the queue is empty now, update the other side */
     if (queue->cur_level.buffers == 0)
       queue->cur_level.time = 0;
+    GST_TRACER_QUEUE_DEQUEUE (GST_ELEMENT_CAST (queue), queue->sinkpad,
+        queue->cur_level.buffers, queue->cur_level.bytes,
+        queue->cur_level.time);
   } else if (GST_IS_EVENT (item)) {
     GstEvent *event = GST_EVENT_CAST (item);
 
@@ -971,6 +1162,7 @@ gst_queue_locked_dequeue (GstQueue * queue)
         item, GST_OBJECT_NAME (queue));
     item = NULL;
   }
+  gst_queue_budget_sync (queue);
   GST_QUEUE_SIGNAL_DEL (queue);
 
   return item;
@@ -1031,6 +1223,7 @@ gst_queue_handle_sink_event (GstPad * pad, GstObject * parent, GstEvent * event)
       queue->srcresult = GST_FLOW_OK;
       queue->eos = FALSE;
       queue->unexpected = FALSE;
+      queue->reconfigure_pending = FALSE;
       if (gst_pad_is_active (queue->srcpad)) {
         gst_pad_start_task (queue->srcpad, (GstTaskFunction) gst_queue_loop,
             queue->srcpad, NULL);
@@ -1173,6 +1366,14 @@ gst_queue_is_empty (GstQueue * queue)
       !gst_queue_is_filled (queue);
 }
 
+/* an empty queue always accepts data, it can't wait for itself to drain */
+static inline gboolean
+gst_queue_is_over_budget (GstQueue * queue)
+{
+  return queue->budget_client && queue->cur_level.bytes > 0 &&
+      gst_memory_budget_client_is_exhausted (queue->budget_client);
+}
+
 static gboolean
 gst_queue_is_filled (GstQueue * queue)
 {
@@ -1181,37 +1382,130 @@ gst_queue_is_filled (GstQueue * queue)
           (queue->max_size.bytes > 0 &&
               queue->cur_level.bytes >= queue->max_size.bytes) ||
           (queue->max_size.time > 0 &&
-              queue->cur_level.time >= queue->max_size.time)));
+              queue->cur_level.time >= queue->max_size.time)) ||
+      gst_queue_is_over_budget (queue));
+}
+
+/* only buffers and bytes, dropping from the middle of the queue doesn't
+ * change the time level */
+static gboolean
+gst_queue_is_filled_by_size (GstQueue * queue)
+{
+  return ((queue->max_size.buffers > 0 &&
+          queue->cur_level.buffers >= queue->max_size.buffers) ||
+      (queue->max_size.bytes > 0 &&
+          queue->cur_level.bytes >= queue->max_size.bytes) ||
+      gst_queue_is_over_budget (queue));
+}
+
+static gboolean
+gst_queue_head_is_delta_unit (GstQueue * queue)
+{
+  GstQueueItem *head;
+
+  head = gst_queue_array_peek_head_struct (queue->queue);
+
+  return head && GST_IS_BUFFER (head->item) &&
+      GST_BUFFER_FLAG_IS_SET (head->item, GST_BUFFER_FLAG_DELTA_UNIT);
+}
+
+/* drop the oldest delta unit buffer, leaving an empty item in its place so
+ * that this is O(1) amortized, with QUEUE_LOCK */
+static gboolean
+gst_queue_locked_drop_delta_unit (GstQueue * queue)
+{
+  GstQueueItem *qitem = NULL;
+  guint len;
+
+  /* all items before delta_scan are no delta units, so that every item is
+   * only looked at once */
+  len = gst_queue_array_get_length (queue->queue);
+  while (queue->delta_scan < len) {
+    qitem = gst_queue_array_peek_nth_struct (queue->queue, queue->delta_scan);
+    if (qitem->item && GST_IS_BUFFER (qitem->item) &&
+        GST_BUFFER_FLAG_IS_SET (qitem->item, GST_BUFFER_FLAG_DELTA_UNIT))
+      break;
+    queue->delta_scan++;
+  }
+  if (queue->delta_scan == len)
+    return FALSE;
+
+  GST_CAT_DEBUG_OBJECT (queue_dataflow, queue,
+      "queue is full, leaking delta unit %p", qitem->item);
+
+  queue->cur_level.buffers--;
+  queue->cur_level.bytes -= qitem->size;
+  gst_queue_budget_sync (queue);
+  GST_TRACER_QUEUE_LEAK (GST_ELEMENT_CAST (queue), queue->sinkpad,
+      qitem->item);
+  gst_mini_object_unref (qitem->item);
+  qitem->item = NULL;
+  qitem->size = 0;
+  queue->delta_scan++;
+
+  /* the following buffer needs to get a DISCONT flag */
+  if (queue->delta_scan == 1)
+    gst_queue_locked_trim_head (queue);
+
+  return TRUE;
 }
 
 static void
-gst_queue_leak_downstream (GstQueue * queue)
+gst_queue_leak_downstream_one (GstQueue * queue)
 {
-  /* for as long as the queue is filled, dequeue an item and discard it */
-  while (gst_queue_is_filled (queue)) {
-    GstMiniObject *leak;
+  GstMiniObject *leak;
 
-    leak = gst_queue_locked_dequeue (queue);
-    /* there is nothing to dequeue and the queue is still filled.. This should
-     * not happen */
-    g_assert (leak != NULL);
+  leak = gst_queue_locked_dequeue (queue);
+  /* there is nothing to dequeue and the queue is still filled.. This should
+   * not happen */
+  g_assert (leak != NULL);
 
+  GST_CAT_DEBUG_OBJECT (queue_dataflow, queue,
+      "queue is full, leaking item %p on downstream end", leak);
+  if (GST_IS_EVENT (leak) && GST_EVENT_IS_STICKY (leak)) {
     GST_CAT_DEBUG_OBJECT (queue_dataflow, queue,
-        "queue is full, leaking item %p on downstream end", leak);
-    if (GST_IS_EVENT (leak) && GST_EVENT_IS_STICKY (leak)) {
-      GST_CAT_DEBUG_OBJECT (queue_dataflow, queue,
-          "Storing sticky event %s on srcpad", GST_EVENT_TYPE_NAME (leak));
-      gst_pad_store_sticky_event (queue->srcpad, GST_EVENT_CAST (leak));
-    }
+        "Storing sticky event %s on srcpad", GST_EVENT_TYPE_NAME (leak));
+    gst_pad_store_sticky_event (queue->srcpad, GST_EVENT_CAST (leak));
+  }
 
-    if (!GST_IS_QUERY (leak))
-      gst_mini_object_unref (leak);
+  GST_TRACER_QUEUE_LEAK (GST_ELEMENT_CAST (queue), queue->sinkpad, leak);
 
-    /* last buffer needs to get a DISCONT flag */
-    queue->head_needs_discont = TRUE;
+  if (!GST_IS_QUERY (leak))
+    gst_mini_object_unref (leak);
+
+  /* last buffer needs to get a DISCONT flag */
+  queue->head_needs_discont = TRUE;
+}
+
+static void
+gst_queue_leak_downstream_delta (GstQueue * queue)
+{
+  while (gst_queue_is_filled (queue)) {
+    if (!gst_queue_is_filled_by_size (queue)
+        || !gst_queue_locked_drop_delta_unit (queue))
+      gst_queue_leak_downstream_one (queue);
   }
 }
 
+static void
+gst_queue_leak_downstream_gop (GstQueue * queue)
+{
+  while (gst_queue_is_filled (queue)) {
+    /* leak the head and then everything that depends on it */
+    gst_queue_leak_downstream_one (queue);
+    while (gst_queue_head_is_delta_unit (queue))
+      gst_queue_leak_downstream_one (queue);
+  }
+}
+
+static void
+gst_queue_leak_downstream (GstQueue * queue)
+{
+  /* for as long as the queue is filled, dequeue an item and discard it */
+  while (gst_queue_is_filled (queue))
+    gst_queue_leak_downstream_one (queue);
+}
+
 static gboolean
 discont_first_buffer (GstBuffer ** buffer, guint i, gpointer user_data)
 {
@@ -1244,6 +1538,9 @@ gst_queue_chain_buffer_or_list (GstPad * pad, GstObject * parent,
   if (queue->unexpected)
     goto out_unexpected;
 
+  /* upstream handled the last RECONFIGURE before pushing this */
+  queue->reconfigure_pending = FALSE;
+
   if (!is_list) {
     GstClockTime duration, timestamp;
     GstBuffer *buffer = GST_BUFFER_CAST (obj);
@@ -1265,6 +1562,7 @@ gst_queue_chain_buffer_or_list (GstPad * pad, GstObject * parent,
    * the user defined as "full". Note that this only applies to buffers.
    * We always handle events and they don't count in our statistics. */
   while (gst_queue_is_filled (queue)) {
+    GST_TRACER_QUEUE_OVERRUN (GST_ELEMENT_CAST (queue), queue->sinkpad);
     if (!queue->silent) {
       GST_QUEUE_MUTEX_UNLOCK (queue);
       g_signal_emit (queue, gst_queue_signals[SIGNAL_OVERRUN], 0);
@@ -1282,11 +1580,18 @@ gst_queue_chain_buffer_or_list (GstPad * pad, GstObject * parent,
         /* leak current buffer */
         GST_CAT_DEBUG_OBJECT (queue_dataflow, queue,
             "queue is full, leaking buffer on upstream end");
+        GST_TRACER_QUEUE_LEAK (GST_ELEMENT_CAST (queue), queue->sinkpad, obj);
         /* now we can clean up and exit right away */
         goto out_unref;
       case GST_QUEUE_LEAK_DOWNSTREAM:
         gst_queue_leak_downstream (queue);
         break;
+      case GST_QUEUE_LEAK_DOWNSTREAM_DELTA:
+        gst_queue_leak_downstream_delta (queue);
+        break;
+      case GST_QUEUE_LEAK_DOWNSTREAM_GOP:
+        gst_queue_leak_downstream_gop (queue);
+        break;
       default:
         g_warning ("Unknown leaky type, using default");
         /* fall-through */
@@ -1408,6 +1713,42 @@ add_to_list (GstBuffer ** buffer, guint idx, gpointer data)
   return TRUE;
 }
 
+/* check if @buffer is more than max-age behind the running time of the
+ * clock, with QUEUE_LOCK */
+static gboolean
+gst_queue_buffer_is_too_old (GstQueue * queue, GstBuffer * buffer)
+{
+  GstClockTime running_time, base_time, now;
+  GstClock *clock = NULL;
+
+  running_time = gst_segment_to_running_time (&queue->src_segment,
+      GST_FORMAT_TIME, GST_BUFFER_DTS_OR_PTS (buffer));
+  if (!GST_CLOCK_TIME_IS_VALID (running_time))
+    return FALSE;
+
+  GST_OBJECT_LOCK (queue);
+  if (GST_STATE (queue) == GST_STATE_PLAYING
+      && (clock = GST_ELEMENT_CLOCK (queue)))
+    gst_object_ref (clock);
+  base_time = GST_ELEMENT_CAST (queue)->base_time;
+  GST_OBJECT_UNLOCK (queue);
+
+  if (clock == NULL)
+    return FALSE;
+
+  now = gst_clock_get_time (clock);
+  gst_object_unref (clock);
+
+  if (now < base_time + running_time + queue->max_age)
+    return FALSE;
+
+  GST_CAT_DEBUG_OBJECT (queue_dataflow, queue, "buffer %p with running time %"
+      GST_TIME_FORMAT " is older than %" GST_TIME_FORMAT, buffer,
+      GST_TIME_ARGS (running_time), GST_TIME_ARGS (queue->max_age));
+
+  return TRUE;
+}
+
 /* dequeue an item from the queue an push it downstream. This functions returns
  * the result of the push. */
 static GstFlowReturn
@@ -1421,11 +1762,24 @@ gst_queue_push (GstQueue * queue)
   if (data == NULL)
     goto no_item;
 
+  /* drop what is too old to be useful anymore */
+  while (queue->max_age > 0 && GST_IS_BUFFER (data)
+      && gst_queue_buffer_is_too_old (queue, GST_BUFFER_CAST (data))) {
+    gst_buffer_unref (GST_BUFFER_CAST (data));
+    queue->head_needs_discont = TRUE;
+
+    data = gst_queue_locked_dequeue (queue);
+    if (data == NULL)
+      return result;
+  }
+
 next:
   is_list = GST_IS_BUFFER_LIST (data);
 
   if (GST_IS_BUFFER (data) || is_list) {
-    if (queue->generate_buffer_list) {
+    if (queue->generate_buffer_list || (queue->auto_buffer_list
+            && gst_queue_next_is_buffer (queue)
+            && gst_queue_peer_handles_lists (queue))) {
       /* Try to dequeue all buffers/buffer-list in the queue */
 
       while (gst_queue_next_is_buffer (queue)) {
@@ -1613,6 +1967,7 @@ gst_queue_loop (GstPad * pad)
   } else {
     while ((empty = gst_queue_is_empty (queue))) {
       GST_CAT_DEBUG_OBJECT (queue_dataflow, queue, "queue is empty");
+      GST_TRACER_QUEUE_UNDERRUN (GST_ELEMENT_CAST (queue), queue->sinkpad);
       if (!queue->silent) {
         GST_QUEUE_MUTEX_UNLOCK (queue);
         g_signal_emit (queue, gst_queue_signals[SIGNAL_UNDERRUN], 0);
@@ -1675,6 +2030,24 @@ out_flushing:
   }
 }
 
+/* TRUE while the RECONFIGURE flag set by the last event we forwarded is
+ * still set on the upstream peer */
+static gboolean
+gst_queue_upstream_needs_reconfigure (GstQueue * queue)
+{
+  GstPad *peer;
+  gboolean res;
+
+  peer = gst_pad_get_peer (queue->sinkpad);
+  if (peer == NULL)
+    return FALSE;
+
+  res = gst_pad_needs_reconfigure (peer);
+  gst_object_unref (peer);
+
+  return res;
+}
+
 static gboolean
 gst_queue_handle_src_event (GstPad * pad, GstObject * parent, GstEvent * event)
 {
@@ -1688,6 +2061,9 @@ gst_queue_handle_src_event (GstPad * pad, GstObject * parent, GstEvent * event)
 
   switch (GST_EVENT_TYPE (event)) {
     case GST_EVENT_RECONFIGURE:
+    {
+      gboolean forward;
+
       GST_QUEUE_MUTEX_LOCK (queue);
       if (queue->srcresult == GST_FLOW_NOT_LINKED) {
         /* when we got not linked, assume downstream is linked again now and we
@@ -1695,10 +2071,22 @@ gst_queue_handle_src_event (GstPad * pad, GstObject * parent, GstEvent * event)
         queue->srcresult = GST_FLOW_OK;
         gst_pad_start_task (pad, (GstTaskFunction) gst_queue_loop, pad, NULL);
       }
+      forward = !queue->reconfigure_pending;
+      queue->reconfigure_pending = TRUE;
       GST_QUEUE_MUTEX_UNLOCK (queue);
 
+      /* the previous one was not handled upstream yet, it will renegotiate
+       * once for both of them */
+      if (!forward && gst_queue_upstream_needs_reconfigure (queue)) {
+        GST_CAT_DEBUG_OBJECT (queue_dataflow, queue,
+            "upstream still needs to reconfigure");
+        gst_event_unref (event);
+        break;
+      }
+
       res = gst_pad_push_event (queue->sinkpad, event);
       break;
+    }
     default:
       res = gst_pad_event_default (pad, parent, event);
       break;
@@ -1806,6 +2194,7 @@ gst_queue_sink_activate_mode (GstPad * pad, GstObject * parent, GstPadMode mode,
         queue->srcresult = GST_FLOW_OK;
         queue->eos = FALSE;
         queue->unexpected = FALSE;
+        queue->reconfigure_pending = FALSE;
         GST_QUEUE_MUTEX_UNLOCK (queue);
       } else {
         /* step 1, unblock chain function */
@@ -1875,6 +2264,10 @@ queue_capacity_change (GstQueue * queue)
 {
   if (queue->leaky == GST_QUEUE_LEAK_DOWNSTREAM) {
     gst_queue_leak_downstream (queue);
+  } else if (queue->leaky == GST_QUEUE_LEAK_DOWNSTREAM_DELTA) {
+    gst_queue_leak_downstream_delta (queue);
+  } else if (queue->leaky == GST_QUEUE_LEAK_DOWNSTREAM_GOP) {
+    gst_queue_leak_downstream_gop (queue);
   }
 
   /* changing the capacity of the queue must wake up
@@ -1883,6 +2276,24 @@ queue_capacity_change (GstQueue * queue)
   GST_QUEUE_SIGNAL_DEL (queue);
 }
 
+static void
+gst_queue_set_context (GstElement * element, GstContext * context)
+{
+  GstQueue *queue = GST_QUEUE (element);
+  GstMemoryBudget *budget;
+
+  if (gst_context_get_memory_budget (context, &budget)) {
+    GST_DEBUG_OBJECT (queue, "using memory budget %" GST_PTR_FORMAT, budget);
+    GST_QUEUE_MUTEX_LOCK (queue);
+    gst_queue_locked_set_budget (queue, budget);
+    queue_capacity_change (queue);
+    GST_QUEUE_MUTEX_UNLOCK (queue);
+    gst_object_unref (budget);
+  }
+
+  GST_ELEMENT_CLASS (parent_class)->set_context (element, context);
+}
+
 /* Changing the minimum required fill level must
  * wake up the _loop function as it might now
  * be able to preceed.
@@ -1940,6 +2351,20 @@ gst_queue_set_property (GObject * object,
     case PROP_GENERATE_BUFFER_LIST:
       queue->generate_buffer_list = g_value_get_boolean (value);
       break;
+    case PROP_AUTO_BUFFER_LIST:
+      queue->auto_buffer_list = g_value_get_boolean (value);
+      break;
+    case PROP_MAX_AGE:
+      queue->max_age = g_value_get_uint64 (value);
+      break;
+    case PROP_MEMORY_BUDGET_PRIORITY:
+      queue->budget_priority = g_value_get_uint (value);
+      if (queue->budget_client) {
+        gst_memory_budget_client_set_priority (queue->budget_client,
+            queue->budget_priority);
+        queue_capacity_change (queue);
+      }
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -1996,6 +2421,15 @@ gst_queue_get_property (GObject * object,
     case PROP_GENERATE_BUFFER_LIST:
       g_value_set_boolean (value, queue->generate_buffer_list);
       break;
+    case PROP_AUTO_BUFFER_LIST:
+      g_value_set_boolean (value, queue->auto_buffer_list);
+      break;
+    case PROP_MAX_AGE:
+      g_value_set_uint64 (value, queue->max_age);
+      break;
+    case PROP_MEMORY_BUDGET_PRIORITY:
+      g_value_set_uint (value, queue->budget_priority);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
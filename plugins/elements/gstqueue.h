@@ -52,13 +52,19 @@ typedef struct _GstQueueClass GstQueueClass;
  * @GST_QUEUE_NO_LEAK: Not Leaky
  * @GST_QUEUE_LEAK_UPSTREAM: Leaky on upstream (new buffers)
  * @GST_QUEUE_LEAK_DOWNSTREAM: Leaky on downstream (old buffers)
+ * @GST_QUEUE_LEAK_DOWNSTREAM_DELTA: Leaky on the oldest delta unit buffer,
+ *   on downstream when there is none (Since: 1.10)
+ * @GST_QUEUE_LEAK_DOWNSTREAM_GOP: Leaky on downstream up to the next
+ *   keyframe (Since: 1.10)
  *
  * Buffer dropping scheme to avoid the queue to block when full.
  */
 enum _GstQueueLeaky {
   GST_QUEUE_NO_LEAK             = 0,
   GST_QUEUE_LEAK_UPSTREAM       = 1,
-  GST_QUEUE_LEAK_DOWNSTREAM     = 2
+  GST_QUEUE_LEAK_DOWNSTREAM     = 2,
+  GST_QUEUE_LEAK_DOWNSTREAM_DELTA = 3,
+  GST_QUEUE_LEAK_DOWNSTREAM_GOP = 4
 };
 
 /*
@@ -118,6 +124,19 @@ struct _GstQueue {
 
   /* whether we leak data, and at which end */
   gint leaky;
+  /* items at the head known to not be delta units, for leaking deltas */
+  guint delta_scan;
+  /* a delta unit was dropped before the head, the next buffer is a discont */
+  gboolean next_needs_discont;
+
+  /* drop buffers older than this running time age, 0 = disabled */
+  guint64 max_age;
+
+  /* shared memory budget from the context, cur_level.bytes is accounted */
+  GstMemoryBudget *budget;
+  GstMemoryBudgetClient *budget_client;
+  guint budget_priority;
+  guint budget_bytes;
 
   GMutex qlock;        /* lock for queue (vs object lock) */
   gboolean waiting_add;
@@ -139,9 +158,14 @@ struct _GstQueue {
   gboolean flush_on_eos; /* flush on EOS */
 
   gboolean generate_buffer_list;
+  /* combine a backlog when downstream handles buffer lists */
+  gboolean auto_buffer_list;
 
   /* TRUE if we schedule/unschedule tasks */
   gboolean schedule_task;
+
+  /* a RECONFIGURE event went upstream and no data arrived since */
+  gboolean reconfigure_pending;
 };
 
 struct _GstQueueClass {
@@ -54,6 +54,8 @@
 #include "config.h"
 #endif
 
+#include "gst/gst_private.h"
+
 #include "gstqueue2.h"
 
 #include <glib/gstdio.h>
@@ -73,6 +75,10 @@
 #include <unistd.h>
 #endif
 
+#ifdef HAVE_MMAP
+#include <sys/mman.h>
+#endif
+
 #ifdef __BIONIC__               /* Android */
 #undef lseek
 #define lseek lseek64
@@ -105,6 +111,9 @@ enum
 #define QUEUE_IS_USING_TEMP_FILE(queue) ((queue)->temp_template != NULL)
 #define QUEUE_IS_USING_RING_BUFFER(queue) ((queue)->ring_buffer_max_size != 0)  /* for consistency with the above macro */
 #define QUEUE_IS_USING_QUEUE(queue) (!QUEUE_IS_USING_TEMP_FILE(queue) && !QUEUE_IS_USING_RING_BUFFER (queue))
+/* a temp file used as ring buffer is memory mapped when possible, the ring
+ * buffer then points into the mapping and no file IO is needed */
+#define QUEUE_IS_USING_FILE_IO(queue) (QUEUE_IS_USING_TEMP_FILE(queue) && (queue)->ring_buffer_map_size == 0)
 
 #define QUEUE_MAX_BYTES(queue) MIN((queue)->max_level.bytes, (queue)->ring_buffer_max_size)
 
@@ -139,6 +148,7 @@ enum
   PROP_TEMP_REMOVE,
   PROP_RING_BUFFER_MAX_SIZE,
   PROP_AVG_IN_RATE,
+  PROP_MEMORY_BUDGET_PRIORITY,
   PROP_LAST
 };
 
@@ -165,9 +175,15 @@ enum
                         queue->current->writing_pos - queue->current->max_reading_pos : \
                         queue->queue.length))
 
+#if !defined (GST_ENABLE_LOCK_TRACING) && !defined (GST_ENABLE_ADAPTIVE_LOCKS)
 #define GST_QUEUE2_MUTEX_LOCK(q) G_STMT_START {                          \
   g_mutex_lock (&q->qlock);                                              \
 } G_STMT_END
+#else
+#define GST_QUEUE2_MUTEX_LOCK(q) G_STMT_START {                          \
+  _gst_lock_trace_mutex_lock (&q->qlock, q, "queue2");                   \
+} G_STMT_END
+#endif
 
 #define GST_QUEUE2_MUTEX_LOCK_CHECK(q,res,label) G_STMT_START {         \
   GST_QUEUE2_MUTEX_LOCK (q);                                            \
@@ -269,6 +285,8 @@ static gboolean gst_queue2_sink_activate_mode (GstPad * pad, GstObject * parent,
     GstPadMode mode, gboolean active);
 static GstStateChangeReturn gst_queue2_change_state (GstElement * element,
     GstStateChange transition);
+static void gst_queue2_set_context (GstElement * element,
+    GstContext * context);
 
 static gboolean gst_queue2_is_empty (GstQueue2 * queue);
 static gboolean gst_queue2_is_filled (GstQueue2 * queue);
@@ -407,6 +425,24 @@ gst_queue2_class_init (GstQueue2Class * klass)
           "Average input data rate (bytes/s)",
           0, G_MAXINT64, 0, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstQueue2:memory-budget-priority
+   *
+   * The priority of the queue in the #GstMemoryBudget that was set on it with
+   * a #GstContext. The share of the budget the queue can always use is
+   * proportional to its priority. When the queue is over its share and the
+   * budget is exhausted, it is handled like a full queue. Only data queued
+   * in memory is accounted, not the ring buffer or the temp file.
+   *
+   * Since: 1.10
+   */
+  g_object_class_install_property (gobject_class, PROP_MEMORY_BUDGET_PRIORITY,
+      g_param_spec_uint ("memory-budget-priority", "Memory budget priority",
+          "Priority in the shared memory budget, if any", 0, G_MAXUINT,
+          GST_MEMORY_BUDGET_DEFAULT_PRIORITY,
+          G_PARAM_READWRITE | GST_PARAM_MUTABLE_PLAYING |
+          G_PARAM_STATIC_STRINGS));
+
   /* set several parent class virtual functions */
   gobject_class->finalize = gst_queue2_finalize;
 
@@ -421,6 +457,7 @@ gst_queue2_class_init (GstQueue2Class * klass)
 
   gstelement_class->change_state = GST_DEBUG_FUNCPTR (gst_queue2_change_state);
   gstelement_class->query = GST_DEBUG_FUNCPTR (gst_queue2_handle_query);
+  gstelement_class->set_context = GST_DEBUG_FUNCPTR (gst_queue2_set_context);
 }
 
 static void
@@ -499,6 +536,9 @@ gst_queue2_init (GstQueue2 * queue)
 
   queue->ring_buffer = NULL;
   queue->ring_buffer_max_size = DEFAULT_RING_BUFFER_MAX_SIZE;
+  queue->ring_buffer_map_size = 0;
+
+  queue->budget_priority = GST_MEMORY_BUDGET_DEFAULT_PRIORITY;
 
   GST_DEBUG_OBJECT (queue,
       "initialized queue's not_empty & not_full conditions");
@@ -522,6 +562,12 @@ gst_queue2_finalize (GObject * object)
 
   queue->last_query = FALSE;
   g_queue_clear (&queue->queue);
+
+  if (queue->budget) {
+    gst_memory_budget_remove_client (queue->budget, queue->budget_client);
+    gst_object_unref (queue->budget);
+  }
+
   g_mutex_clear (&queue->qlock);
   g_mutex_clear (&queue->buffering_post_lock);
   g_cond_clear (&queue->item_add);
@@ -1006,19 +1052,24 @@ static void
 gst_queue2_post_buffering (GstQueue2 * queue)
 {
   GstMessage *msg = NULL;
+  gboolean post;
 
   g_mutex_lock (&queue->buffering_post_lock);
+  post = gst_element_message_will_be_posted (GST_ELEMENT_CAST (queue),
+      GST_MESSAGE_BUFFERING);
   GST_QUEUE2_MUTEX_LOCK (queue);
   if (queue->percent_changed) {
     gint percent = queue->buffering_percent;
 
     queue->percent_changed = FALSE;
 
-    GST_DEBUG_OBJECT (queue, "Going to post buffering: %d%%", percent);
-    msg = gst_message_new_buffering (GST_OBJECT_CAST (queue), percent);
+    if (post) {
+      GST_DEBUG_OBJECT (queue, "Going to post buffering: %d%%", percent);
+      msg = gst_message_new_buffering (GST_OBJECT_CAST (queue), percent);
 
-    gst_message_set_buffering_stats (msg, queue->mode, queue->avg_in,
-        queue->avg_out, queue->buffering_left);
+      gst_message_set_buffering_stats (msg, queue->mode, queue->avg_in,
+          queue->avg_out, queue->buffering_left);
+    }
   }
   GST_QUEUE2_MUTEX_UNLOCK (queue);
 
@@ -1314,13 +1365,13 @@ gst_queue2_read_data_at_offset (GstQueue2 * queue, guint64 offset, guint length,
 
   ring_buffer = queue->ring_buffer;
 
-  if (QUEUE_IS_USING_TEMP_FILE (queue) && FSEEK_FILE (queue->temp_file, offset))
+  if (QUEUE_IS_USING_FILE_IO (queue) && FSEEK_FILE (queue->temp_file, offset))
     goto seek_failed;
 
   /* this should not block */
   GST_LOG_OBJECT (queue, "Reading %d bytes from offset %" G_GUINT64_FORMAT,
       length, offset);
-  if (QUEUE_IS_USING_TEMP_FILE (queue)) {
+  if (QUEUE_IS_USING_FILE_IO (queue)) {
     res = fread (dst, 1, length, queue->temp_file);
   } else {
     memcpy (dst, ring_buffer + offset, length);
@@ -1330,7 +1381,7 @@ gst_queue2_read_data_at_offset (GstQueue2 * queue, guint64 offset, guint length,
   GST_LOG_OBJECT (queue, "read %" G_GSIZE_FORMAT " bytes", res);
 
   if (G_UNLIKELY (res < length)) {
-    if (!QUEUE_IS_USING_TEMP_FILE (queue))
+    if (!QUEUE_IS_USING_FILE_IO (queue))
       goto could_not_read;
     /* check for errors or EOF */
     if (ferror (queue->temp_file))
@@ -1580,6 +1631,66 @@ gst_queue2_read_item_from_file (GstQueue2 * queue)
   return item;
 }
 
+/* Map the ring buffer sized temp file so that the ring buffer code can use
+ * it directly. Falls back to file IO when this is not possible. */
+static void
+gst_queue2_map_temp_file (GstQueue2 * queue, gint fd)
+{
+#if defined (HAVE_MMAP) && defined (MAP_SHARED) && !defined (G_OS_WIN32)
+  guint64 size = queue->ring_buffer_max_size;
+  gpointer map;
+
+  if (size > G_MAXSIZE || size > G_MAXINT64)
+    goto too_big;
+
+  if (ftruncate (fd, (off_t) size) < 0)
+    goto truncate_failed;
+
+  map = mmap (NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (map == MAP_FAILED)
+    goto map_failed;
+
+  queue->ring_buffer = map;
+  queue->ring_buffer_map_size = size;
+
+  GST_DEBUG_OBJECT (queue, "mapped %" G_GUINT64_FORMAT " bytes of temp file",
+      size);
+  return;
+
+  /* ERRORS */
+too_big:
+  {
+    GST_WARNING_OBJECT (queue, "ring buffer too big to map, using file IO");
+    return;
+  }
+truncate_failed:
+  {
+    GST_WARNING_OBJECT (queue, "could not resize temp file: %s, using "
+        "file IO", g_strerror (errno));
+    return;
+  }
+map_failed:
+  {
+    GST_WARNING_OBJECT (queue, "could not map temp file: %s, using file IO",
+        g_strerror (errno));
+    return;
+  }
+#endif
+}
+
+static void
+gst_queue2_unmap_temp_file (GstQueue2 * queue)
+{
+#if defined (HAVE_MMAP) && defined (MAP_SHARED) && !defined (G_OS_WIN32)
+  if (queue->ring_buffer_map_size == 0)
+    return;
+
+  munmap (queue->ring_buffer, queue->ring_buffer_map_size);
+  queue->ring_buffer = NULL;
+  queue->ring_buffer_map_size = 0;
+#endif
+}
+
 /* must be called with MUTEX_LOCK. Will briefly release the lock when notifying
  * the temp filename. */
 static gboolean
@@ -1620,6 +1731,9 @@ gst_queue2_open_temp_location_file (GstQueue2 * queue)
   g_free (queue->temp_location);
   queue->temp_location = name;
 
+  if (QUEUE_IS_USING_RING_BUFFER (queue))
+    gst_queue2_map_temp_file (queue, fd);
+
   GST_QUEUE2_MUTEX_UNLOCK (queue);
 
   /* we can't emit the notify with the lock */
@@ -1671,6 +1785,7 @@ gst_queue2_close_temp_location_file (GstQueue2 * queue)
 
   GST_DEBUG_OBJECT (queue, "closing temp file");
 
+  gst_queue2_unmap_temp_file (queue);
   fflush (queue->temp_file);
   fclose (queue->temp_file);
 
@@ -1691,11 +1806,66 @@ gst_queue2_flush_temp_file (GstQueue2 * queue)
   if (queue->temp_file == NULL)
     return;
 
+  /* truncating would invalidate the mapping, the ranges are reset anyway */
+  if (queue->ring_buffer_map_size > 0)
+    return;
+
   GST_DEBUG_OBJECT (queue, "flushing temp file");
 
   queue->temp_file = g_freopen (queue->temp_location, "wb+", queue->temp_file);
 }
 
+/* make the memory budget account the current level, with QUEUE_LOCK */
+static inline void
+gst_queue2_budget_sync (GstQueue2 * queue)
+{
+  guint bytes;
+
+  if (queue->budget_client == NULL)
+    return;
+
+  bytes = QUEUE_IS_USING_QUEUE (queue) ? queue->cur_level.bytes : 0;
+  if (bytes == queue->budget_bytes)
+    return;
+
+  if (bytes > queue->budget_bytes)
+    gst_memory_budget_client_acquire (queue->budget_client,
+        bytes - queue->budget_bytes);
+  else
+    gst_memory_budget_client_release (queue->budget_client,
+        queue->budget_bytes - bytes);
+  queue->budget_bytes = bytes;
+}
+
+static void
+gst_queue2_set_context (GstElement * element, GstContext * context)
+{
+  GstQueue2 *queue = GST_QUEUE2 (element);
+  GstMemoryBudget *budget;
+
+  if (gst_context_get_memory_budget (context, &budget)) {
+    GST_DEBUG_OBJECT (queue, "using memory budget %" GST_PTR_FORMAT, budget);
+
+    GST_QUEUE2_MUTEX_LOCK (queue);
+    if (budget != queue->budget) {
+      if (queue->budget) {
+        gst_memory_budget_remove_client (queue->budget, queue->budget_client);
+        gst_object_unref (queue->budget);
+      }
+      queue->budget = gst_object_ref (budget);
+      queue->budget_client =
+          gst_memory_budget_add_client (budget, queue->budget_priority);
+      queue->budget_bytes = 0;
+      gst_queue2_budget_sync (queue);
+      GST_QUEUE2_SIGNAL_DEL (queue);
+    }
+    GST_QUEUE2_MUTEX_UNLOCK (queue);
+    gst_object_unref (budget);
+  }
+
+  GST_ELEMENT_CLASS (parent_class)->set_context (element, context);
+}
+
 static void
 gst_queue2_locked_flush (GstQueue2 * queue, gboolean full, gboolean clear_temp)
 {
@@ -1725,6 +1895,7 @@ gst_queue2_locked_flush (GstQueue2 * queue, gboolean full, gboolean clear_temp)
   queue->last_query = FALSE;
   g_cond_signal (&queue->query_handled);
   GST_QUEUE2_CLEAR_LEVEL (queue->cur_level);
+  gst_queue2_budget_sync (queue);
   gst_segment_init (&queue->sink_segment, GST_FORMAT_TIME);
   gst_segment_init (&queue->src_segment, GST_FORMAT_TIME);
   queue->sinktime = queue->srctime = GST_CLOCK_TIME_NONE;
@@ -1754,6 +1925,7 @@ gst_queue2_wait_free_space (GstQueue2 * queue)
 
     GST_CAT_DEBUG_OBJECT (queue_dataflow, queue,
         "queue is full, waiting for free space");
+    GST_TRACER_QUEUE_OVERRUN (GST_ELEMENT_CAST (queue), queue->sinkpad);
     do {
       /* Wait for space to be available, we could be unlocked because of a flush. */
       GST_QUEUE2_WAIT_DEL_CHECK (queue, queue->sinkresult, out_flushing);
@@ -1928,7 +2100,7 @@ gst_queue2_create_write (GstQueue2 * queue, GstBuffer * buffer)
       new_writing_pos = writing_pos + to_write;
     }
 
-    if (QUEUE_IS_USING_TEMP_FILE (queue)
+    if (QUEUE_IS_USING_FILE_IO (queue)
         && FSEEK_FILE (queue->temp_file, writing_pos))
       goto seek_failed;
 
@@ -1938,7 +2110,7 @@ gst_queue2_create_write (GstQueue2 * queue, GstBuffer * buffer)
           "] (rb wpos %" G_GUINT64_FORMAT ")", to_write, queue->current->offset,
           queue->current->writing_pos, queue->current->rb_writing_pos);
       /* either not using ring buffer or no wrapping, just write */
-      if (QUEUE_IS_USING_TEMP_FILE (queue)) {
+      if (QUEUE_IS_USING_FILE_IO (queue)) {
         if (fwrite (data, to_write, 1, queue->temp_file) != 1)
           goto handle_error;
       } else {
@@ -1983,7 +2155,7 @@ gst_queue2_create_write (GstQueue2 * queue, GstBuffer * buffer)
       if (block_one > 0) {
         GST_INFO_OBJECT (queue, "writing %u bytes", block_one);
         /* write data to end of ring buffer */
-        if (QUEUE_IS_USING_TEMP_FILE (queue)) {
+        if (QUEUE_IS_USING_FILE_IO (queue)) {
           if (fwrite (data, block_one, 1, queue->temp_file) != 1)
             goto handle_error;
         } else {
@@ -1991,12 +2163,12 @@ gst_queue2_create_write (GstQueue2 * queue, GstBuffer * buffer)
         }
       }
 
-      if (QUEUE_IS_USING_TEMP_FILE (queue) && FSEEK_FILE (queue->temp_file, 0))
+      if (QUEUE_IS_USING_FILE_IO (queue) && FSEEK_FILE (queue->temp_file, 0))
         goto seek_failed;
 
       if (block_two > 0) {
         GST_INFO_OBJECT (queue, "writing %u bytes", block_two);
-        if (QUEUE_IS_USING_TEMP_FILE (queue)) {
+        if (QUEUE_IS_USING_FILE_IO (queue)) {
           if (fwrite (data + block_one, block_two, 1, queue->temp_file) != 1)
             goto handle_error;
         } else {
@@ -2120,6 +2292,7 @@ gst_queue2_locked_enqueue (GstQueue2 * queue, gpointer item,
     if (QUEUE_IS_USING_QUEUE (queue)) {
       queue->cur_level.buffers++;
       queue->cur_level.bytes += size;
+      gst_queue2_budget_sync (queue);
     }
     queue->bytes_in += size;
 
@@ -2127,6 +2300,9 @@ gst_queue2_locked_enqueue (GstQueue2 * queue, gpointer item,
     apply_buffer (queue, buffer, &queue->sink_segment, size, TRUE);
     /* update the byterate stats */
     update_in_rates (queue);
+    GST_TRACER_QUEUE_ENQUEUE (GST_ELEMENT_CAST (queue), queue->sinkpad,
+        queue->cur_level.buffers, queue->cur_level.bytes,
+        queue->cur_level.time);
 
     if (!QUEUE_IS_USING_QUEUE (queue)) {
       /* FIXME - check return value? */
@@ -2145,6 +2321,7 @@ gst_queue2_locked_enqueue (GstQueue2 * queue, gpointer item,
     if (QUEUE_IS_USING_QUEUE (queue)) {
       queue->cur_level.buffers += gst_buffer_list_length (buffer_list);
       queue->cur_level.bytes += size;
+      gst_queue2_budget_sync (queue);
     }
     queue->bytes_in += size;
 
@@ -2153,6 +2330,9 @@ gst_queue2_locked_enqueue (GstQueue2 * queue, gpointer item,
 
     /* update the byterate stats */
     update_in_rates (queue);
+    GST_TRACER_QUEUE_ENQUEUE (GST_ELEMENT_CAST (queue), queue->sinkpad,
+        queue->cur_level.buffers, queue->cur_level.bytes,
+        queue->cur_level.time);
 
     if (!QUEUE_IS_USING_QUEUE (queue)) {
       gst_buffer_list_foreach (buffer_list, buffer_list_create_write, queue);
@@ -2299,6 +2479,9 @@ gst_queue2_locked_dequeue (GstQueue2 * queue, GstQueue2ItemType * item_type)
     apply_buffer (queue, buffer, &queue->src_segment, size, FALSE);
     /* update the byterate stats */
     update_out_rates (queue);
+    GST_TRACER_QUEUE_DEQUEUE (GST_ELEMENT_CAST (queue), queue->sinkpad,
+        queue->cur_level.buffers, queue->cur_level.bytes,
+        queue->cur_level.time);
     /* update the buffering */
     if (queue->use_buffering)
       update_buffering (queue);
@@ -2345,6 +2528,9 @@ gst_queue2_locked_dequeue (GstQueue2 * queue, GstQueue2ItemType * item_type)
     apply_buffer_list (queue, buffer_list, &queue->src_segment, FALSE);
     /* update the byterate stats */
     update_out_rates (queue);
+    GST_TRACER_QUEUE_DEQUEUE (GST_ELEMENT_CAST (queue), queue->sinkpad,
+        queue->cur_level.buffers, queue->cur_level.bytes,
+        queue->cur_level.time);
     /* update the buffering */
     if (queue->use_buffering)
       update_buffering (queue);
@@ -2359,6 +2545,7 @@ gst_queue2_locked_dequeue (GstQueue2 * queue, GstQueue2ItemType * item_type)
     item = NULL;
     *item_type = GST_QUEUE2_ITEM_TYPE_UNKNOWN;
   }
+  gst_queue2_budget_sync (queue);
   GST_QUEUE2_SIGNAL_DEL (queue);
 
   return item;
@@ -2644,6 +2831,10 @@ gst_queue2_is_filled (GstQueue2 * queue)
   res = CHECK_FILLED (buffers, 0) || CHECK_FILLED (bytes, 0)
       || CHECK_FILLED (time, 0);
 
+  /* or when we are over our share of an exhausted memory budget */
+  if (!res && queue->budget_client && queue->cur_level.bytes > 0)
+    res = gst_memory_budget_client_is_exhausted (queue->budget_client);
+
   /* if we need to, use the rate estimate to check against the max time we are
    * allowed to queue */
   if (queue->use_rate_estimate)
@@ -2936,6 +3127,7 @@ gst_queue2_loop (GstPad * pad)
 
     GST_CAT_DEBUG_OBJECT (queue_dataflow, queue,
         "queue is empty, waiting for new data");
+    GST_TRACER_QUEUE_UNDERRUN (GST_ELEMENT_CAST (queue), queue->sinkpad);
     do {
       /* Wait for data to be available, we could be unlocked because of a flush. */
       GST_QUEUE2_WAIT_ADD_CHECK (queue, queue->srcresult, out_flushing);
@@ -3682,6 +3874,14 @@ gst_queue2_set_property (GObject * object,
     case PROP_RING_BUFFER_MAX_SIZE:
       queue->ring_buffer_max_size = g_value_get_uint64 (value);
       break;
+    case PROP_MEMORY_BUDGET_PRIORITY:
+      queue->budget_priority = g_value_get_uint (value);
+      if (queue->budget_client) {
+        gst_memory_budget_client_set_priority (queue->budget_client,
+            queue->budget_priority);
+        QUEUE_CAPACITY_CHANGE (queue);
+      }
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -3758,6 +3958,9 @@ gst_queue2_get_property (GObject * object,
       g_value_set_int64 (value, (gint64) in_rate);
       break;
     }
+    case PROP_MEMORY_BUDGET_PRIORITY:
+      g_value_set_uint (value, queue->budget_priority);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -156,6 +156,8 @@ struct _GstQueue2
 
   guint64 ring_buffer_max_size;
   guint8 * ring_buffer;
+  /* size of the temp file mapping when ring_buffer points into it */
+  gsize ring_buffer_map_size;
 
   volatile gint downstream_may_block;
 
@@ -165,6 +167,13 @@ struct _GstQueue2
   gint avg_out;
   gboolean percent_changed;
   GMutex buffering_post_lock; /* assures only one posted at a time */
+
+  /* shared memory budget from the context, the level is accounted when
+   * queueing in memory */
+  GstMemoryBudget *budget;
+  GstMemoryBudgetClient *budget_client;
+  guint budget_priority;
+  guint budget_bytes;
 };
 
 struct _GstQueue2Class
@@ -21,6 +21,7 @@
 #include "config.h"
 #endif
 
+#include <string.h>
 #include <gst/gst.h>
 #include <glib/gstdio.h>
 
@@ -51,6 +52,19 @@
 #define FSEEK_FILE(file,offset)  (fseek (file, offset, SEEK_SET) != 0)
 #endif
 
+/* with positional I/O reads and writes don't share a file position and
+ * don't go through stdio buffers */
+#if defined (HAVE_PREAD) && defined (HAVE_PWRITE)
+#define USE_POSITIONAL_IO 1
+#define HAS_FILE(f) ((f)->fd > 0)
+#else
+#define HAS_FILE(f) ((f)->file != NULL)
+#endif
+
+/* writes smaller than this that continue each other are collected and
+ * written to the file in one go */
+#define WRITE_BUFFER_SIZE (64 * 1024)
+
 #define GST_SPARSE_FILE_IO_ERROR \
     g_quark_from_static_string("gst-sparse-file-io-error-quark")
 
@@ -59,60 +73,97 @@ gst_sparse_file_io_error_from_errno (gint err_no);
 
 typedef struct _GstSparseRange GstSparseRange;
 
+/* ranges never overlap and are kept in a GSequence, a balanced tree, sorted
+ * on their start so that lookups stay fast with many ranges */
 struct _GstSparseRange
 {
-  GstSparseRange *next;
+  GSequenceIter *iter;
 
   gsize start;
   gsize stop;
 };
 
 #define RANGE_CONTAINS(r,o) ((r)->start <= (o) && (r)->stop > (o))
+#define RANGE_AT(i) ((GstSparseRange *) g_sequence_get (i))
 
 struct _GstSparseFile
 {
   gint fd;
+  /* stdio stream and its position, without positional I/O */
   FILE *file;
   gsize current_pos;
 
-  GstSparseRange *ranges;
+  /* pending data of small writes, wbuf_len bytes for wbuf_offset */
+  guint8 *wbuf;
+  gsize wbuf_offset;
+  gsize wbuf_len;
+
+  GSequence *ranges;
   guint n_ranges;
 
   GstSparseRange *write_range;
   GstSparseRange *read_range;
 };
 
+static void
+free_range (GstSparseRange * range)
+{
+  g_slice_free (GstSparseRange, range);
+}
+
+static gint
+compare_range_start (gconstpointer a, gconstpointer b, gpointer user_data)
+{
+  const GstSparseRange *ra = a, *rb = b;
+
+  return (ra->start > rb->start) - (ra->start < rb->start);
+}
+
+/* get the position after the last range that starts at or before @offset */
+static GSequenceIter *
+search_range (GstSparseFile * file, gsize offset)
+{
+  GstSparseRange key;
+
+  key.start = offset;
+
+  return g_sequence_search (file->ranges, &key, compare_range_start, NULL);
+}
+
+/* get the last range that starts at or before @offset or %NULL */
+static GstSparseRange *
+lookup_range (GstSparseFile * file, gsize offset)
+{
+  GSequenceIter *iter;
+
+  iter = search_range (file, offset);
+  if (g_sequence_iter_is_begin (iter))
+    return NULL;
+
+  return RANGE_AT (g_sequence_iter_prev (iter));
+}
+
 static GstSparseRange *
 get_write_range (GstSparseFile * file, gsize offset)
 {
-  GstSparseRange *next, *prev, *result = NULL;
+  GstSparseRange *result = NULL;
+  GSequenceIter *iter;
 
   if (file->write_range && file->write_range->stop == offset)
     return file->write_range;
 
-  prev = NULL;
-  next = file->ranges;
-  while (next) {
-    if (next->start > offset)
-      break;
+  iter = search_range (file, offset);
+  if (!g_sequence_iter_is_begin (iter)) {
+    GstSparseRange *prev = RANGE_AT (g_sequence_iter_prev (iter));
 
-    if (next->stop >= offset) {
-      result = next;
-      break;
-    }
-    prev = next;
-    next = next->next;
+    if (prev->stop >= offset)
+      result = prev;
   }
   if (result == NULL) {
     result = g_slice_new0 (GstSparseRange);
     result->start = offset;
     result->stop = offset;
-
-    result->next = next;
-    if (prev)
-      prev->next = result;
-    else
-      file->ranges = result;
+    result->iter = g_sequence_insert_before (iter, result);
 
     file->write_range = result;
     file->read_range = NULL;
@@ -122,24 +173,151 @@ get_write_range (GstSparseFile * file, gsize offset)
   return result;
 }
 
+/* mark @offset to @stop as written and merge with the following ranges.
+ * Returns the range containing @offset */
+static GstSparseRange *
+update_write_range (GstSparseFile * file, gsize offset, gsize stop)
+{
+  GstSparseRange *range, *next;
+  GSequenceIter *iter;
+
+  /* update the new stop position in the range */
+  range = get_write_range (file, offset);
+  range->stop = MAX (range->stop, stop);
+
+  /* see if we can merge with next region */
+  while (!g_sequence_iter_is_end (iter = g_sequence_iter_next (range->iter))) {
+    next = RANGE_AT (iter);
+    if (next->start > range->stop)
+      break;
+
+    GST_DEBUG ("merging range %" G_GSIZE_FORMAT "-%" G_GSIZE_FORMAT ", next %"
+        G_GSIZE_FORMAT "-%" G_GSIZE_FORMAT, range->start, range->stop,
+        next->start, next->stop);
+
+    range->stop = MAX (next->stop, range->stop);
+
+    if (file->write_range == next)
+      file->write_range = NULL;
+    if (file->read_range == next)
+      file->read_range = NULL;
+    /* frees next */
+    g_sequence_remove (iter);
+    file->n_ranges--;
+  }
+  return range;
+}
+
 static GstSparseRange *
 get_read_range (GstSparseFile * file, gsize offset, gsize count)
 {
-  GstSparseRange *walk, *result = NULL;
+  GstSparseRange *range;
 
-  if (file->read_range && RANGE_CONTAINS (file->read_range, offset))
+  if (file->read_range && RANGE_CONTAINS (file->read_range, offset) &&
+      file->read_range->stop >= offset + count)
     return file->read_range;
 
-  for (walk = file->ranges; walk; walk = walk->next) {
-    if (walk->start > offset)
-      break;
+  /* ranges don't overlap, only the last one starting before offset can
+   * contain it */
+  range = lookup_range (file, offset);
+  if (range == NULL || range->stop < offset + count)
+    return NULL;
 
-    if (walk->stop >= offset + count) {
-      result = walk;
-      break;
+  file->read_range = range;
+
+  return range;
+}
+
+/* write @count bytes of @data at @offset. Returns %FALSE with errno set on
+ * error */
+static gboolean
+file_write_at (GstSparseFile * file, gsize offset, gconstpointer data,
+    gsize count)
+{
+#ifdef USE_POSITIONAL_IO
+  const guint8 *ptr = data;
+
+  while (count > 0) {
+    gssize res = pwrite (file->fd, ptr, count, (off_t) offset);
+
+    if (G_UNLIKELY (res <= 0)) {
+      if (res < 0 && errno == EINTR)
+        continue;
+      if (res == 0)
+        errno = ENOSPC;
+      return FALSE;
     }
+    ptr += res;
+    offset += res;
+    count -= res;
   }
-  return result;
+#else
+  if (file->current_pos != offset) {
+    GST_DEBUG ("seeking to %" G_GSIZE_FORMAT, offset);
+    if (FSEEK_FILE (file->file, offset))
+      return FALSE;
+  }
+  if (fwrite (data, count, 1, file->file) != 1)
+    return FALSE;
+  file->current_pos = offset + count;
+#endif
+  return TRUE;
+}
+
+/* read up to @count bytes at @offset into @data. Returns the number of bytes
+ * read, which is less than @count at the end of the file, or -1 with errno
+ * set on error */
+static gssize
+file_read_at (GstSparseFile * file, gsize offset, gpointer data, gsize count)
+{
+#ifdef USE_POSITIONAL_IO
+  guint8 *ptr = data;
+  gsize done = 0;
+
+  while (done < count) {
+    gssize res = pread (file->fd, ptr + done, count - done,
+        (off_t) (offset + done));
+
+    if (G_UNLIKELY (res < 0)) {
+      if (errno == EINTR)
+        continue;
+      return -1;
+    }
+    if (res == 0)
+      break;
+    done += res;
+  }
+  return done;
+#else
+  gsize res;
+
+  if (file->current_pos != offset) {
+    GST_DEBUG ("seeking from %" G_GSIZE_FORMAT " to %" G_GSIZE_FORMAT,
+        file->current_pos, offset);
+    if (FSEEK_FILE (file->file, offset))
+      return -1;
+  }
+  res = fread (data, 1, count, file->file);
+  file->current_pos = offset + res;
+  if (G_UNLIKELY (res < count && ferror (file->file)))
+    return -1;
+
+  return res;
+#endif
+}
+
+static gboolean
+flush_write_buffer (GstSparseFile * file)
+{
+  gboolean res = TRUE;
+
+  if (file->wbuf_len > 0) {
+    GST_LOG ("writing %" G_GSIZE_FORMAT " pending bytes at %" G_GSIZE_FORMAT,
+        file->wbuf_len, file->wbuf_offset);
+    res = file_write_at (file, file->wbuf_offset, file->wbuf, file->wbuf_len);
+    file->wbuf_len = 0;
+  }
+  return res;
 }
 
 /**
@@ -158,7 +336,7 @@ gst_sparse_file_new (void)
 
   result = g_slice_new0 (GstSparseFile);
   result->current_pos = 0;
-  result->ranges = NULL;
+  result->ranges = g_sequence_new ((GDestroyNotify) free_range);
   result->n_ranges = 0;
 
   return result;
@@ -181,10 +359,14 @@ gst_sparse_file_set_fd (GstSparseFile * file, gint fd)
   g_return_val_if_fail (file != NULL, FALSE);
   g_return_val_if_fail (fd != 0, FALSE);
 
-  file->file = fdopen (fd, "wb+");
   file->fd = fd;
+#ifdef USE_POSITIONAL_IO
+  return TRUE;
+#else
+  file->file = fdopen (fd, "wb+");
 
   return file->file != NULL;
+#endif
 }
 
 /**
@@ -198,14 +380,22 @@ gst_sparse_file_clear (GstSparseFile * file)
 {
   g_return_if_fail (file != NULL);
 
+  /* the pending data is cleared too */
+  file->wbuf_len = 0;
+#ifndef USE_POSITIONAL_IO
+  /* fclose() would close our fd, just start writing at the start again */
   if (file->file) {
-    fclose (file->file);
-    file->file = fdopen (file->fd, "wb+");
+    fflush (file->file);
+    if (FSEEK_FILE (file->file, 0))
+      GST_WARNING ("could not seek to start: %s", g_strerror (errno));
   }
-  g_slice_free_chain (GstSparseRange, file->ranges, next);
+#endif
+  g_sequence_remove_range (g_sequence_get_begin_iter (file->ranges),
+      g_sequence_get_end_iter (file->ranges));
   file->current_pos = 0;
-  file->ranges = NULL;
   file->n_ranges = 0;
+  file->write_range = NULL;
+  file->read_range = NULL;
 }
 
 /**
@@ -221,14 +411,59 @@ gst_sparse_file_free (GstSparseFile * file)
 {
   g_return_if_fail (file != NULL);
 
+  if (HAS_FILE (file) && !flush_write_buffer (file))
+    GST_WARNING ("could not write pending data: %s", g_strerror (errno));
+#ifdef USE_POSITIONAL_IO
+  if (HAS_FILE (file))
+    close (file->fd);
+#else
   if (file->file) {
     fflush (file->file);
     fclose (file->file);
   }
-  g_slice_free_chain (GstSparseRange, file->ranges, next);
+#endif
+  g_free (file->wbuf);
+  g_sequence_free (file->ranges);
   g_slice_free (GstSparseFile, file);
 }
 
+/**
+ * gst_sparse_file_flush:
+ * @file: a #GstSparseFile
+ * @error: a #GError
+ *
+ * Write the data that was collected from small writes to @file, so that the
+ * file contains all the ranges that were written.
+ *
+ * Returns: %TRUE on success.
+ *
+ * Since: 1.10
+ */
+gboolean
+gst_sparse_file_flush (GstSparseFile * file, GError ** error)
+{
+  g_return_val_if_fail (file != NULL, FALSE);
+
+  if (HAS_FILE (file)) {
+    if (!flush_write_buffer (file))
+      goto error;
+#ifndef USE_POSITIONAL_IO
+    if (fflush (file->file) != 0)
+      goto error;
+#endif
+  }
+  return TRUE;
+
+  /* ERRORS */
+error:
+  {
+    g_set_error (error, GST_SPARSE_FILE_IO_ERROR,
+        gst_sparse_file_io_error_from_errno (errno), "Error writing file: %s",
+        g_strerror (errno));
+    return FALSE;
+  }
+}
+
 /**
  * gst_sparse_file_write:
  * @file: a #GstSparseFile
@@ -251,48 +486,34 @@ gsize
 gst_sparse_file_write (GstSparseFile * file, gsize offset, gconstpointer data,
     gsize count, gsize * available, GError ** error)
 {
-  GstSparseRange *range, *next;
+  GstSparseRange *range;
   gsize stop;
 
   g_return_val_if_fail (file != NULL, 0);
   g_return_val_if_fail (count != 0, 0);
 
-  if (file->file) {
-    if (file->current_pos != offset) {
-      GST_DEBUG ("seeking to %" G_GSIZE_FORMAT, offset);
-      if (FSEEK_FILE (file->file, offset))
+  if (HAS_FILE (file)) {
+    /* pending data is written first unless this continues it */
+    if (file->wbuf_len > 0 && (offset != file->wbuf_offset + file->wbuf_len
+            || file->wbuf_len + count > WRITE_BUFFER_SIZE)) {
+      if (!flush_write_buffer (file))
         goto error;
     }
-    if (fwrite (data, count, 1, file->file) != 1)
+    if (count < WRITE_BUFFER_SIZE) {
+      if (G_UNLIKELY (file->wbuf == NULL))
+        file->wbuf = g_malloc (WRITE_BUFFER_SIZE);
+      if (file->wbuf_len == 0)
+        file->wbuf_offset = offset;
+      memcpy (file->wbuf + file->wbuf_len, data, count);
+      file->wbuf_len += count;
+    } else if (!file_write_at (file, offset, data, count)) {
       goto error;
+    }
   }
 
-  file->current_pos = offset + count;
-
-  /* update the new stop position in the range */
-  range = get_write_range (file, offset);
   stop = offset + count;
-  range->stop = MAX (range->stop, stop);
-
-  /* see if we can merge with next region */
-  while ((next = range->next)) {
-    if (next->start > range->stop)
-      break;
+  range = update_write_range (file, offset, stop);
 
-    GST_DEBUG ("merging range %" G_GSIZE_FORMAT "-%" G_GSIZE_FORMAT ", next %"
-        G_GSIZE_FORMAT "-%" G_GSIZE_FORMAT, range->start, range->stop,
-        next->start, next->stop);
-
-    range->stop = MAX (next->stop, range->stop);
-    range->next = next->next;
-
-    if (file->write_range == next)
-      file->write_range = NULL;
-    if (file->read_range == next)
-      file->read_range = NULL;
-    g_slice_free (GstSparseRange, next);
-    file->n_ranges--;
-  }
   if (available)
     *available = range->stop - stop;
 
@@ -308,6 +529,27 @@ error:
   }
 }
 
+/**
+ * gst_sparse_file_add_range:
+ * @file: a #GstSparseFile
+ * @start: the range start
+ * @stop: the range stop
+ *
+ * Mark the data between @start and @stop as available in @file without
+ * writing it. This is used to restore the ranges of a file that was
+ * written before, the data must already be present in the file.
+ *
+ * Since: 1.10
+ */
+void
+gst_sparse_file_add_range (GstSparseFile * file, gsize start, gsize stop)
+{
+  g_return_if_fail (file != NULL);
+  g_return_if_fail (start < stop);
+
+  update_write_range (file, start, stop);
+}
+
 /**
  * gst_sparse_file_read:
  * @file: a #GstSparseFile
@@ -334,7 +576,7 @@ gst_sparse_file_read (GstSparseFile * file, gsize offset, gpointer data,
     gsize count, gsize * remaining, GError ** error)
 {
   GstSparseRange *range;
-  gsize res = 0;
+  gssize res;
 
   g_return_val_if_fail (file != NULL, 0);
   g_return_val_if_fail (count != 0, 0);
@@ -342,22 +584,27 @@ gst_sparse_file_read (GstSparseFile * file, gsize offset, gpointer data,
   if ((range = get_read_range (file, offset, count)) == NULL)
     goto no_range;
 
-  if (file->file) {
-    if (file->current_pos != offset) {
-      GST_DEBUG ("seeking from %" G_GSIZE_FORMAT " to %" G_GSIZE_FORMAT,
-          file->current_pos, offset);
-      if (FSEEK_FILE (file->file, offset))
+  if (HAS_FILE (file)) {
+    if (file->wbuf_len > 0 && offset >= file->wbuf_offset &&
+        offset + count <= file->wbuf_offset + file->wbuf_len) {
+      /* reading what was just written, it's still with us */
+      memcpy (data, file->wbuf + (offset - file->wbuf_offset), count);
+    } else {
+      if (file->wbuf_len > 0 && offset < file->wbuf_offset + file->wbuf_len
+          && offset + count > file->wbuf_offset) {
+        if (!flush_write_buffer (file))
+          goto write_error;
+      }
+      res = file_read_at (file, offset, data, count);
+      if (G_UNLIKELY (res < 0))
         goto error;
+      if (G_UNLIKELY ((gsize) res < count))
+        return res;
     }
-    res = fread (data, 1, count, file->file);
-    if (G_UNLIKELY (res < count))
-      goto error;
   }
 
-  file->current_pos = offset + res;
-
   if (remaining)
-    *remaining = range->stop - file->current_pos;
+    *remaining = range->stop - (offset + count);
 
   return count;
 
@@ -368,15 +615,18 @@ no_range:
         GST_SPARSE_FILE_IO_ERROR_WOULD_BLOCK, "Offset not written to file yet");
     return 0;
   }
+write_error:
+  {
+    g_set_error (error, GST_SPARSE_FILE_IO_ERROR,
+        gst_sparse_file_io_error_from_errno (errno), "Error writing file: %s",
+        g_strerror (errno));
+    return 0;
+  }
 error:
   {
-    if (ferror (file->file)) {
-      g_set_error (error, GST_SPARSE_FILE_IO_ERROR,
-          gst_sparse_file_io_error_from_errno (errno), "Error reading file: %s",
-          g_strerror (errno));
-    } else if (feof (file->file)) {
-      return res;
-    }
+    g_set_error (error, GST_SPARSE_FILE_IO_ERROR,
+        gst_sparse_file_io_error_from_errno (errno), "Error reading file: %s",
+        g_strerror (errno));
     return 0;
   }
 }
@@ -417,19 +667,11 @@ gboolean
 gst_sparse_file_get_range_before (GstSparseFile * file, gsize offset,
     gsize * start, gsize * stop)
 {
-  GstSparseRange *walk, *result = NULL;
+  GstSparseRange *result;
 
   g_return_val_if_fail (file != NULL, FALSE);
 
-  for (walk = file->ranges; walk; walk = walk->next) {
-    GST_DEBUG ("start %" G_GSIZE_FORMAT " > %" G_GSIZE_FORMAT,
-        walk->stop, offset);
-    if (walk->start > offset)
-      break;
-
-    if (walk->start <= offset)
-      result = walk;
-  }
+  result = lookup_range (file, offset);
 
   if (result) {
     if (start)
@@ -458,18 +700,23 @@ gboolean
 gst_sparse_file_get_range_after (GstSparseFile * file, gsize offset,
     gsize * start, gsize * stop)
 {
-  GstSparseRange *walk, *result = NULL;
+  GstSparseRange *result = NULL;
+  GSequenceIter *iter;
 
   g_return_val_if_fail (file != NULL, FALSE);
 
-  for (walk = file->ranges; walk; walk = walk->next) {
-    GST_DEBUG ("stop %" G_GSIZE_FORMAT " > %" G_GSIZE_FORMAT,
-        walk->stop, offset);
-    if (walk->stop > offset) {
-      result = walk;
-      break;
-    }
+  /* the stops are sorted too. The last range starting before offset is the
+   * only one that can contain it, otherwise take the next one */
+  iter = search_range (file, offset);
+  if (!g_sequence_iter_is_begin (iter)) {
+    GstSparseRange *prev = RANGE_AT (g_sequence_iter_prev (iter));
+
+    if (prev->stop > offset)
+      result = prev;
   }
+  if (result == NULL && !g_sequence_iter_is_end (iter))
+    result = RANGE_AT (iter);
+
   if (result) {
     if (start)
       *start = result->start;
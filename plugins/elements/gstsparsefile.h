@@ -80,6 +80,7 @@ void            gst_sparse_file_free         (GstSparseFile *file);
 
 gboolean        gst_sparse_file_set_fd       (GstSparseFile *file, gint fd);
 void            gst_sparse_file_clear        (GstSparseFile *file);
+gboolean        gst_sparse_file_flush        (GstSparseFile *file, GError **error);
 
 gsize           gst_sparse_file_write        (GstSparseFile *file,
                                               gsize offset,
@@ -88,6 +89,10 @@ gsize           gst_sparse_file_write        (GstSparseFile *file,
                                               gsize *available,
                                               GError **error);
 
+void            gst_sparse_file_add_range    (GstSparseFile *file,
+                                              gsize start,
+                                              gsize stop);
+
 gsize           gst_sparse_file_read         (GstSparseFile *file,
                                               gsize offset,
                                               gpointer data,
@@ -77,6 +77,7 @@ G_DEFINE_TYPE_WITH_CODE (GstStreamidDemux, gst_streamid_demux,
     GST_TYPE_ELEMENT, _do_init);
 
 static void gst_streamid_demux_dispose (GObject * object);
+static void gst_streamid_demux_finalize (GObject * object);
 static void gst_streamid_demux_get_property (GObject * object, guint prop_id,
     GValue * value, GParamSpec * pspec);
 static GstFlowReturn gst_streamid_demux_chain (GstPad * pad,
@@ -101,6 +102,7 @@ gst_streamid_demux_class_init (GstStreamidDemuxClass * klass)
 
   gobject_class->get_property = gst_streamid_demux_get_property;
   gobject_class->dispose = gst_streamid_demux_dispose;
+  gobject_class->finalize = gst_streamid_demux_finalize;
 
   g_object_class_install_property (gobject_class, PROP_ACTIVE_PAD,
       g_param_spec_object ("active-pad", "Active pad",
@@ -152,6 +154,16 @@ gst_streamid_demux_dispose (GObject * object)
   G_OBJECT_CLASS (parent_class)->dispose (object);
 }
 
+static void
+gst_streamid_demux_finalize (GObject * object)
+{
+  GstStreamidDemux *demux = GST_STREAMID_DEMUX (object);
+
+  g_hash_table_unref (demux->stream_id_pairs);
+
+  G_OBJECT_CLASS (parent_class)->finalize (object);
+}
+
 static void
 gst_streamid_demux_get_property (GObject * object, guint prop_id,
     GValue * value, GParamSpec * pspec)
@@ -187,6 +199,7 @@ gst_streamid_demux_srcpad_create (GstStreamidDemux * demux, GstPad * pad,
   gchar *padname = NULL;
   GstPad *srcpad = NULL;
   GstPadTemplate *pad_tmpl = NULL;
+  gchar *key;
 
   padname = g_strdup_printf ("src_%u", demux->nb_srcpads++);
   pad_tmpl = gst_static_pad_template_get (&gst_streamid_demux_src_factory);
@@ -197,9 +210,10 @@ gst_streamid_demux_srcpad_create (GstStreamidDemux * demux, GstPad * pad,
   g_free (padname);
   g_return_val_if_fail (srcpad != NULL, FALSE);
 
+  key = g_strdup (stream_id);
   demux->active_srcpad = srcpad;
-  g_hash_table_insert (demux->stream_id_pairs, g_strdup (stream_id),
-      gst_object_ref (srcpad));
+  demux->active_stream_id = key;
+  g_hash_table_insert (demux->stream_id_pairs, key, gst_object_ref (srcpad));
 
   return TRUE;
 }
@@ -245,13 +259,22 @@ gst_streamid_demux_get_srcpad_by_stream_id (GstStreamidDemux * demux,
   GstPad *srcpad = NULL;
 
   GST_DEBUG_OBJECT (demux, "stream_id = %s", stream_id);
-  if (demux->stream_id_pairs == NULL || stream_id == NULL) {
+  if (stream_id == NULL) {
     goto done;
   }
 
-  srcpad = g_hash_table_lookup (demux->stream_id_pairs, stream_id);
+  /* usually the stream-start of the stream we are already routing, e.g.
+   * after a flushing seek, don't bother hashing it then */
+  if (demux->active_stream_id && strcmp (demux->active_stream_id,
+          stream_id) == 0) {
+    srcpad = demux->active_srcpad;
+    goto done;
+  }
 
-  if (srcpad) {
+  /* the caller makes the returned pad the active one, so remember its
+   * stream-id already */
+  if (g_hash_table_lookup_extended (demux->stream_id_pairs, stream_id,
+          (gpointer *) & demux->active_stream_id, (gpointer *) & srcpad)) {
     GST_DEBUG_OBJECT (demux, "srcpad = %s:%s matched",
         GST_DEBUG_PAD_NAME (srcpad));
   }
@@ -362,14 +385,14 @@ gst_streamid_demux_reset (GstStreamidDemux * demux)
   GST_OBJECT_LOCK (demux);
   if (demux->active_srcpad != NULL)
     demux->active_srcpad = NULL;
+  demux->active_stream_id = NULL;
 
   demux->nb_srcpads = 0;
-  GST_OBJECT_UNLOCK (demux);
 
-  if (demux->stream_id_pairs != NULL) {
-    g_hash_table_unref (demux->stream_id_pairs);
-    demux->stream_id_pairs = NULL;
-  }
+  /* keep the table, the next stream-start after going to PAUSED again needs
+   * it */
+  g_hash_table_remove_all (demux->stream_id_pairs);
+  GST_OBJECT_UNLOCK (demux);
 
   it = gst_element_iterate_src_pads (GST_ELEMENT_CAST (demux));
   while (itret == GST_ITERATOR_OK || itret == GST_ITERATOR_RESYNC) {
@@ -58,6 +58,9 @@ struct _GstStreamidDemux
 
   /* This table contains srcpad and stream-id */
   GHashTable *stream_id_pairs;
+
+  /* stream-id of active_srcpad, owned by stream_id_pairs */
+  const gchar *active_stream_id;
 };
 
 struct _GstStreamidDemuxClass
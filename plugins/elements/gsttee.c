@@ -34,6 +34,12 @@
  * provide separate threads for each branch. Otherwise a blocked dataflow in one
  * branch would stall the other branches.
  *
+ * Alternatively, with #GstTee:parallel enabled, tee pushes on each src pad from
+ * a streaming thread of its own and keeps a small backlog per src pad, bounded
+ * by #GstTee:max-backlog. #GstTee:parallel-policy configures whether tee waits
+ * for all src pads, for any src pad or not at all before accepting the next
+ * buffer.
+ *
  * <refsect2>
  * <title>Example launch line</title>
  * |[
@@ -80,12 +86,36 @@ gst_tee_pull_mode_get_type (void)
   return type;
 }
 
+#define GST_TYPE_TEE_PARALLEL_POLICY (gst_tee_parallel_policy_get_type())
+static GType
+gst_tee_parallel_policy_get_type (void)
+{
+  static GType type = 0;
+  static const GEnumValue data[] = {
+    {GST_TEE_PARALLEL_POLICY_WAIT_ALL, "Wait until all src pads pushed",
+        "wait-all"},
+    {GST_TEE_PARALLEL_POLICY_WAIT_ANY, "Wait until one src pad pushed",
+        "wait-any"},
+    {GST_TEE_PARALLEL_POLICY_FIRE_AND_FORGET,
+        "Don't wait, drop when the backlog is full", "fire-and-forget"},
+    {0, NULL, NULL},
+  };
+
+  if (!type) {
+    type = g_enum_register_static ("GstTeeParallelPolicy", data);
+  }
+  return type;
+}
+
 #define DEFAULT_PROP_NUM_SRC_PADS	0
 #define DEFAULT_PROP_HAS_CHAIN		TRUE
 #define DEFAULT_PROP_SILENT		TRUE
 #define DEFAULT_PROP_LAST_MESSAGE	NULL
 #define DEFAULT_PULL_MODE		GST_TEE_PULL_MODE_NEVER
 #define DEFAULT_PROP_ALLOW_NOT_LINKED	FALSE
+#define DEFAULT_PROP_PARALLEL		FALSE
+#define DEFAULT_PROP_PARALLEL_POLICY	GST_TEE_PARALLEL_POLICY_WAIT_ALL
+#define DEFAULT_PROP_MAX_BACKLOG	4
 
 enum
 {
@@ -97,6 +127,11 @@ enum
   PROP_PULL_MODE,
   PROP_ALLOC_PAD,
   PROP_ALLOW_NOT_LINKED,
+  PROP_PARALLEL,
+  PROP_PARALLEL_POLICY,
+  PROP_MAX_BACKLOG,
+  PROP_DROPPED,
+  PROP_WRITABLE_PAD,
 };
 
 static GstStaticPadTemplate src_template = GST_STATIC_PAD_TEMPLATE ("src_%u",
@@ -111,6 +146,7 @@ G_DEFINE_TYPE_WITH_CODE (GstTee, gst_tee, GST_TYPE_ELEMENT, _do_init);
 
 static GParamSpec *pspec_last_message = NULL;
 static GParamSpec *pspec_alloc_pad = NULL;
+static GParamSpec *pspec_writable_pad = NULL;
 
 GType gst_tee_pad_get_type (void);
 
@@ -138,6 +174,21 @@ struct _GstTeePad
   gboolean pushed;
   GstFlowReturn result;
   gboolean removed;
+
+  /* parallel mode, protected by the parallel_lock of the tee */
+  GstTee *tee;
+  gboolean worker;
+  gboolean flushing;
+  GCond cond;
+  /* queued buffers, buffer lists and serialized events */
+  GQueue backlog;
+  guint n_data;
+  /* number of buffers and lists queued and pushed so far */
+  guint64 queued;
+  guint64 done;
+  /* what the current gst_tee_handle_data() waits for, 0 when nothing */
+  guint64 wait;
+  GstFlowReturn worker_result;
 };
 
 struct _GstTeePadClass
@@ -147,9 +198,24 @@ struct _GstTeePadClass
 
 G_DEFINE_TYPE (GstTeePad, gst_tee_pad, GST_TYPE_PAD);
 
+static void
+gst_tee_pad_finalize (GObject * object)
+{
+  GstTeePad *pad = GST_TEE_PAD_CAST (object);
+
+  g_queue_foreach (&pad->backlog, (GFunc) gst_mini_object_unref, NULL);
+  g_queue_clear (&pad->backlog);
+  g_cond_clear (&pad->cond);
+
+  G_OBJECT_CLASS (gst_tee_pad_parent_class)->finalize (object);
+}
+
 static void
 gst_tee_pad_class_init (GstTeePadClass * klass)
 {
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+  gobject_class->finalize = gst_tee_pad_finalize;
 }
 
 static void
@@ -164,6 +230,10 @@ static void
 gst_tee_pad_init (GstTeePad * pad)
 {
   gst_tee_pad_reset (pad);
+
+  g_cond_init (&pad->cond);
+  g_queue_init (&pad->backlog);
+  pad->worker_result = GST_FLOW_OK;
 }
 
 static GstPad *gst_tee_request_new_pad (GstElement * element,
@@ -221,6 +291,8 @@ gst_tee_finalize (GObject * object)
   g_free (tee->last_message);
 
   g_rec_mutex_clear (&tee->mutex_events);
+  g_mutex_clear (&tee->parallel_lock);
+  g_cond_clear (&tee->parallel_cond);
 
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
@@ -284,6 +356,79 @@ gst_tee_class_init (GstTeeClass * klass)
           "all unlinked", DEFAULT_PROP_ALLOW_NOT_LINKED,
           G_PARAM_CONSTRUCT | G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstTee:parallel
+   *
+   * Push on every src pad from a streaming thread of its own instead of
+   * pushing on all src pads one after the other from the upstream streaming
+   * thread. Takes effect when the src pads are activated.
+   *
+   * Since: 1.10
+   */
+  g_object_class_install_property (gobject_class, PROP_PARALLEL,
+      g_param_spec_boolean ("parallel", "Parallel",
+          "Push on each src pad from a separate thread", DEFAULT_PROP_PARALLEL,
+          G_PARAM_READWRITE | GST_PARAM_MUTABLE_READY |
+          G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstTee:parallel-policy
+   *
+   * What to wait for before accepting the next buffer in parallel mode. With
+   * fire-and-forget, buffers are dropped for src pads whose backlog is full.
+   *
+   * Since: 1.10
+   */
+  g_object_class_install_property (gobject_class, PROP_PARALLEL_POLICY,
+      g_param_spec_enum ("parallel-policy", "Parallel policy",
+          "What to wait for in parallel mode", GST_TYPE_TEE_PARALLEL_POLICY,
+          DEFAULT_PROP_PARALLEL_POLICY,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstTee:max-backlog
+   *
+   * The maximum number of buffers and buffer lists queued per src pad in
+   * parallel mode.
+   *
+   * Since: 1.10
+   */
+  g_object_class_install_property (gobject_class, PROP_MAX_BACKLOG,
+      g_param_spec_uint ("max-backlog", "Max backlog",
+          "Maximum number of buffers queued per src pad in parallel mode", 1,
+          G_MAXUINT, DEFAULT_PROP_MAX_BACKLOG,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstTee:dropped
+   *
+   * The number of buffers and buffer lists dropped on src pads with a full
+   * backlog in fire-and-forget mode.
+   *
+   * Since: 1.10
+   */
+  g_object_class_install_property (gobject_class, PROP_DROPPED,
+      g_param_spec_uint64 ("dropped", "Dropped",
+          "Number of buffers dropped in fire-and-forget mode", 0, G_MAXUINT64,
+          0, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstTee:writable-pad
+   *
+   * The src pad that is pushed on after all other src pads. The last pad
+   * pushed on gets the reference of tee, so when the other branches already
+   * released the data it receives a writable buffer and in-place transforms
+   * downstream don't need to copy it. When unset the last pad in the list of
+   * src pads gets the reference.
+   *
+   * Since: 1.10
+   */
+  pspec_writable_pad = g_param_spec_object ("writable-pad", "Writable Src Pad",
+      "The pad that is pushed on last and gets the reference of tee",
+      GST_TYPE_PAD, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
+  g_object_class_install_property (gobject_class, PROP_WRITABLE_PAD,
+      pspec_writable_pad);
+
   gst_element_class_set_static_metadata (gstelement_class,
       "Tee pipe fitting",
       "Generic",
@@ -317,6 +462,12 @@ gst_tee_init (GstTee * tee)
   tee->pad_indexes = g_hash_table_new (NULL, NULL);
 
   tee->last_message = NULL;
+
+  tee->parallel = DEFAULT_PROP_PARALLEL;
+  tee->parallel_policy = DEFAULT_PROP_PARALLEL_POLICY;
+  tee->max_backlog = DEFAULT_PROP_MAX_BACKLOG;
+  g_mutex_init (&tee->parallel_lock);
+  g_cond_init (&tee->parallel_cond);
 }
 
 static void
@@ -325,6 +476,12 @@ gst_tee_notify_alloc_pad (GstTee * tee)
   g_object_notify_by_pspec ((GObject *) tee, pspec_alloc_pad);
 }
 
+static void
+gst_tee_notify_writable_pad (GstTee * tee)
+{
+  g_object_notify_by_pspec ((GObject *) tee, pspec_writable_pad);
+}
+
 static gboolean
 forward_sticky_events (GstPad * pad, GstEvent ** event, gpointer user_data)
 {
@@ -383,12 +540,17 @@ gst_tee_request_new_pad (GstElement * element, GstPadTemplate * templ,
           "name", name, "direction", templ->direction, "template", templ,
           NULL));
   GST_TEE_PAD_CAST (srcpad)->index = index;
+  GST_TEE_PAD_CAST (srcpad)->tee = tee;
   g_free (name);
 
   mode = tee->sink_mode;
 
   GST_OBJECT_UNLOCK (tee);
 
+  /* set before activating so that the worker of parallel mode gets started */
+  gst_pad_set_activatemode_function (srcpad,
+      GST_DEBUG_FUNCPTR (gst_tee_src_activate_mode));
+
   switch (mode) {
     case GST_PAD_MODE_PULL:
       /* we already have a src pad in pull mode, and our pull mode can only be
@@ -404,8 +566,6 @@ gst_tee_request_new_pad (GstElement * element, GstPadTemplate * templ,
   if (!res)
     goto activate_failed;
 
-  gst_pad_set_activatemode_function (srcpad,
-      GST_DEBUG_FUNCPTR (gst_tee_src_activate_mode));
   gst_pad_set_query_function (srcpad, GST_DEBUG_FUNCPTR (gst_tee_src_query));
   gst_pad_set_getrange_function (srcpad,
       GST_DEBUG_FUNCPTR (gst_tee_src_get_range));
@@ -422,7 +582,7 @@ gst_tee_request_new_pad (GstElement * element, GstPadTemplate * templ,
   /* ERRORS */
 activate_failed:
   {
-    gboolean changed = FALSE;
+    gboolean changed = FALSE, writable_changed = FALSE;
 
     GST_OBJECT_LOCK (tee);
     GST_DEBUG_OBJECT (tee, "warning failed to activate request pad");
@@ -430,11 +590,18 @@ activate_failed:
       tee->allocpad = NULL;
       changed = TRUE;
     }
+    if (tee->writable_pad == srcpad) {
+      tee->writable_pad = NULL;
+      writable_changed = TRUE;
+    }
     GST_OBJECT_UNLOCK (tee);
     gst_object_unref (srcpad);
     if (changed) {
       gst_tee_notify_alloc_pad (tee);
     }
+    if (writable_changed) {
+      gst_tee_notify_writable_pad (tee);
+    }
     return NULL;
   }
 }
@@ -443,7 +610,7 @@ static void
 gst_tee_release_pad (GstElement * element, GstPad * pad)
 {
   GstTee *tee;
-  gboolean changed = FALSE;
+  gboolean changed = FALSE, writable_changed = FALSE;
   guint index;
 
   tee = GST_TEE (element);
@@ -458,6 +625,10 @@ gst_tee_release_pad (GstElement * element, GstPad * pad)
     tee->allocpad = NULL;
     changed = TRUE;
   }
+  if (tee->writable_pad == pad) {
+    tee->writable_pad = NULL;
+    writable_changed = TRUE;
+  }
   GST_OBJECT_UNLOCK (tee);
 
   gst_object_ref (pad);
@@ -470,6 +641,9 @@ gst_tee_release_pad (GstElement * element, GstPad * pad)
   if (changed) {
     gst_tee_notify_alloc_pad (tee);
   }
+  if (writable_changed) {
+    gst_tee_notify_writable_pad (tee);
+  }
 
   GST_OBJECT_LOCK (tee);
   g_hash_table_remove (tee->pad_indexes, GUINT_TO_POINTER (index));
@@ -508,6 +682,32 @@ gst_tee_set_property (GObject * object, guint prop_id, const GValue * value,
     case PROP_ALLOW_NOT_LINKED:
       tee->allow_not_linked = g_value_get_boolean (value);
       break;
+    case PROP_PARALLEL:
+      tee->parallel = g_value_get_boolean (value);
+      break;
+    case PROP_PARALLEL_POLICY:
+      tee->parallel_policy = (GstTeeParallelPolicy) g_value_get_enum (value);
+      break;
+    case PROP_MAX_BACKLOG:
+      tee->max_backlog = g_value_get_uint (value);
+      break;
+    case PROP_WRITABLE_PAD:
+    {
+      GstPad *pad = g_value_get_object (value);
+
+      if (pad == NULL) {
+        tee->writable_pad = NULL;
+        break;
+      }
+      GST_OBJECT_LOCK (pad);
+      if (GST_OBJECT_PARENT (pad) == GST_OBJECT_CAST (object))
+        tee->writable_pad = pad;
+      else
+        GST_WARNING_OBJECT (object, "Tried to set writable pad %s which"
+            " is not my pad", GST_OBJECT_NAME (pad));
+      GST_OBJECT_UNLOCK (pad);
+      break;
+    }
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -544,6 +744,21 @@ gst_tee_get_property (GObject * object, guint prop_id, GValue * value,
     case PROP_ALLOW_NOT_LINKED:
       g_value_set_boolean (value, tee->allow_not_linked);
       break;
+    case PROP_PARALLEL:
+      g_value_set_boolean (value, tee->parallel);
+      break;
+    case PROP_PARALLEL_POLICY:
+      g_value_set_enum (value, tee->parallel_policy);
+      break;
+    case PROP_MAX_BACKLOG:
+      g_value_set_uint (value, tee->max_backlog);
+      break;
+    case PROP_WRITABLE_PAD:
+      g_value_set_object (value, tee->writable_pad);
+      break;
+    case PROP_DROPPED:
+      g_value_set_uint64 (value, tee->dropped);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -551,17 +766,205 @@ gst_tee_get_property (GObject * object, guint prop_id, GValue * value,
   GST_OBJECT_UNLOCK (tee);
 }
 
+/* call with the parallel_lock */
+static void
+gst_tee_pad_flush_backlog (GstTeePad * pad)
+{
+  GstMiniObject *item;
+
+  while ((item = g_queue_pop_head (&pad->backlog)))
+    gst_mini_object_unref (item);
+  pad->n_data = 0;
+  pad->done = pad->queued;
+}
+
+static void
+gst_tee_pad_loop (GstPad * pad)
+{
+  GstTeePad *tpad = GST_TEE_PAD_CAST (pad);
+  GstTee *tee = tpad->tee;
+  GstMiniObject *item;
+  GstFlowReturn ret;
+
+  g_mutex_lock (&tee->parallel_lock);
+  while (!tpad->flushing && g_queue_is_empty (&tpad->backlog))
+    g_cond_wait (&tpad->cond, &tee->parallel_lock);
+  if (tpad->flushing)
+    goto flushing;
+
+  item = g_queue_pop_head (&tpad->backlog);
+  g_mutex_unlock (&tee->parallel_lock);
+
+  if (GST_IS_EVENT (item)) {
+    GST_LOG_OBJECT (pad, "pushing event %" GST_PTR_FORMAT, item);
+    gst_pad_push_event (pad, GST_EVENT_CAST (item));
+    return;
+  }
+
+  GST_LOG_OBJECT (pad, "pushing %p", item);
+  if (GST_IS_BUFFER_LIST (item))
+    ret = gst_pad_push_list (pad, GST_BUFFER_LIST_CAST (item));
+  else
+    ret = gst_pad_push (pad, GST_BUFFER_CAST (item));
+  GST_LOG_OBJECT (pad, "pushing %p yielded result %s", item,
+      gst_flow_get_name (ret));
+
+  g_mutex_lock (&tee->parallel_lock);
+  /* a flush already threw away the backlog and updated the counters */
+  if (!tpad->flushing) {
+    tpad->n_data--;
+    tpad->done++;
+    tpad->worker_result = ret;
+  }
+  g_cond_broadcast (&tee->parallel_cond);
+  g_mutex_unlock (&tee->parallel_lock);
+
+  return;
+
+  /* ERRORS */
+flushing:
+  {
+    g_mutex_unlock (&tee->parallel_lock);
+    GST_DEBUG_OBJECT (pad, "flushing, pausing worker");
+    gst_pad_pause_task (pad);
+    return;
+  }
+}
+
+static gboolean
+gst_tee_pad_start_worker (GstTee * tee, GstTeePad * pad)
+{
+  GST_DEBUG_OBJECT (pad, "starting worker");
+
+  g_mutex_lock (&tee->parallel_lock);
+  if (!pad->worker) {
+    pad->worker = TRUE;
+    g_atomic_int_inc (&tee->n_workers);
+  }
+  pad->flushing = FALSE;
+  pad->worker_result = GST_FLOW_OK;
+  g_mutex_unlock (&tee->parallel_lock);
+
+  return gst_pad_start_task (GST_PAD_CAST (pad),
+      (GstTaskFunction) gst_tee_pad_loop, pad, NULL);
+}
+
+/* stop the worker for good when @stop, else only until the next
+ * gst_tee_pad_start_worker() */
+static gboolean
+gst_tee_pad_pause_worker (GstTee * tee, GstTeePad * pad, gboolean stop)
+{
+  g_mutex_lock (&tee->parallel_lock);
+  if (!pad->worker) {
+    g_mutex_unlock (&tee->parallel_lock);
+    return TRUE;
+  }
+  GST_DEBUG_OBJECT (pad, "%s worker", stop ? "stopping" : "pausing");
+  pad->flushing = TRUE;
+  gst_tee_pad_flush_backlog (pad);
+  if (stop) {
+    pad->worker = FALSE;
+    g_atomic_int_add (&tee->n_workers, -1);
+  }
+  g_cond_signal (&pad->cond);
+  g_cond_broadcast (&tee->parallel_cond);
+  g_mutex_unlock (&tee->parallel_lock);
+
+  if (stop)
+    return gst_pad_stop_task (GST_PAD_CAST (pad));
+  else
+    return gst_pad_pause_task (GST_PAD_CAST (pad));
+}
+
+static gboolean
+gst_tee_handle_parallel_event (GstTee * tee, GstEvent * event)
+{
+  GList *pads, *l;
+  gboolean res = FALSE, pushed = FALSE;
+
+  GST_OBJECT_LOCK (tee);
+  pads = g_list_copy_deep (GST_ELEMENT_CAST (tee)->srcpads,
+      (GCopyFunc) gst_object_ref, NULL);
+  GST_OBJECT_UNLOCK (tee);
+
+  for (l = pads; l; l = l->next) {
+    GstTeePad *tpad = GST_TEE_PAD_CAST (l->data);
+
+    if (GST_EVENT_IS_SERIALIZED (event) &&
+        GST_EVENT_TYPE (event) != GST_EVENT_FLUSH_STOP) {
+      g_mutex_lock (&tee->parallel_lock);
+      if (tpad->worker && !tpad->flushing) {
+        /* events are never dropped and don't count against the backlog, they
+         * only need to stay in order with the data */
+        g_queue_push_tail (&tpad->backlog, gst_event_ref (event));
+        g_cond_signal (&tpad->cond);
+        g_mutex_unlock (&tee->parallel_lock);
+        res = pushed = TRUE;
+        continue;
+      }
+      g_mutex_unlock (&tee->parallel_lock);
+    }
+
+    if (GST_EVENT_TYPE (event) == GST_EVENT_FLUSH_STOP) {
+      g_mutex_lock (&tee->parallel_lock);
+      tpad->flushing = FALSE;
+      tpad->worker_result = GST_FLOW_OK;
+      g_mutex_unlock (&tee->parallel_lock);
+    }
+
+    if (GST_PAD_CAST (tpad) != tee->pull_pad) {
+      res |= gst_pad_push_event (GST_PAD_CAST (tpad), gst_event_ref (event));
+      pushed = TRUE;
+    }
+
+    switch (GST_EVENT_TYPE (event)) {
+      case GST_EVENT_FLUSH_START:
+        /* downstream is flushing now and the worker can't block anymore */
+        gst_tee_pad_pause_worker (tee, tpad, FALSE);
+        break;
+      case GST_EVENT_FLUSH_STOP:
+        if (tpad->worker)
+          gst_tee_pad_start_worker (tee, tpad);
+        break;
+      default:
+        break;
+    }
+  }
+  g_list_free_full (pads, gst_object_unref);
+
+  /* like gst_pad_event_default() when there is nothing to forward to */
+  if (!pushed)
+    res = GST_EVENT_IS_STICKY (event);
+
+  gst_event_unref (event);
+
+  return res;
+}
+
 static gboolean
 gst_tee_sink_event (GstPad * pad, GstObject * parent, GstEvent * event)
 {
+  GstTee *tee = GST_TEE_CAST (parent);
   gboolean res;
 
-  GST_TEE_EVENTS_LOCK (GST_PAD_PARENT (pad));
-  res = gst_pad_event_default (pad, parent, event);
-  if (res && GST_EVENT_IS_STICKY (event)) {
-    gst_pad_store_sticky_event (pad, event);
+  GST_TEE_EVENTS_LOCK (tee);
+  if (g_atomic_int_get (&tee->n_workers) > 0 &&
+      (GST_EVENT_IS_SERIALIZED (event) ||
+          GST_EVENT_TYPE (event) == GST_EVENT_FLUSH_START)) {
+    /* keep a ref, the sticky event is stored after forwarding */
+    gst_event_ref (event);
+    res = gst_tee_handle_parallel_event (tee, event);
+    if (res && GST_EVENT_IS_STICKY (event)) {
+      gst_pad_store_sticky_event (pad, event);
+    }
+    gst_event_unref (event);
+  } else {
+    res = gst_pad_event_default (pad, parent, event);
+    if (res && GST_EVENT_IS_STICKY (event)) {
+      gst_pad_store_sticky_event (pad, event);
+    }
   }
-  GST_TEE_EVENTS_UNLOCK (GST_PAD_PARENT (pad));
+  GST_TEE_EVENTS_UNLOCK (tee);
 
   return res;
 }
@@ -586,25 +989,60 @@ gst_tee_do_message (GstTee * tee, GstPad * pad, gpointer data, gboolean is_list)
   g_object_notify_by_pspec ((GObject *) tee, pspec_last_message);
 }
 
+/* pushes @data on @pad. When @steal is TRUE the reference of the caller is
+ * passed on, else a new reference is pushed */
 static GstFlowReturn
-gst_tee_do_push (GstTee * tee, GstPad * pad, gpointer data, gboolean is_list)
+gst_tee_do_push (GstTee * tee, GstPad * pad, gpointer data, gboolean is_list,
+    gboolean steal)
 {
   GstFlowReturn res;
 
   /* Push */
   if (pad == tee->pull_pad) {
     /* don't push on the pad we're pulling from */
+    if (steal)
+      gst_mini_object_unref (GST_MINI_OBJECT_CAST (data));
     res = GST_FLOW_OK;
   } else if (is_list) {
-    res =
-        gst_pad_push_list (pad,
-        gst_buffer_list_ref (GST_BUFFER_LIST_CAST (data)));
+    if (!steal)
+      gst_buffer_list_ref (GST_BUFFER_LIST_CAST (data));
+    res = gst_pad_push_list (pad, GST_BUFFER_LIST_CAST (data));
   } else {
-    res = gst_pad_push (pad, gst_buffer_ref (GST_BUFFER_CAST (data)));
+    if (!steal)
+      gst_buffer_ref (GST_BUFFER_CAST (data));
+    res = gst_pad_push (pad, GST_BUFFER_CAST (data));
   }
   return res;
 }
 
+/* called with the object lock. Returns the next src pad to push on, the
+ * writable pad is only returned when all other pads are pushed. @last is set
+ * to TRUE when no other pad remains to be pushed on after it. */
+static GstPad *
+gst_tee_next_pad (GstTee * tee, gboolean * last)
+{
+  GstPad *next = NULL, *writable = NULL;
+  GList *pads;
+  guint remaining = 0;
+
+  for (pads = GST_ELEMENT_CAST (tee)->srcpads; pads; pads = pads->next) {
+    GstPad *pad = GST_PAD_CAST (pads->data);
+
+    if (GST_TEE_PAD_CAST (pad)->pushed)
+      continue;
+
+    remaining++;
+    if (pad == tee->writable_pad)
+      writable = pad;
+    else if (next == NULL)
+      next = pad;
+  }
+
+  *last = (remaining == 1);
+
+  return next ? next : writable;
+}
+
 static void
 clear_pads (GstPad * pad, GstTee * tee)
 {
@@ -612,11 +1050,132 @@ clear_pads (GstPad * pad, GstTee * tee)
   GST_TEE_PAD_CAST (pad)->result = GST_FLOW_NOT_LINKED;
 }
 
+/* called with the object lock, which is released. Queues @data on the src
+ * pads with a worker and pushes it directly on the others. */
+static GstFlowReturn
+gst_tee_handle_data_parallel (GstTee * tee, gpointer data, gboolean is_list)
+{
+  GstTeeParallelPolicy policy;
+  GList *pads, *l;
+  GstFlowReturn ret, cret;
+  guint max_backlog, dropped = 0;
+
+  policy = tee->parallel_policy;
+  max_backlog = tee->max_backlog;
+  pads = g_list_copy_deep (GST_ELEMENT_CAST (tee)->srcpads,
+      (GCopyFunc) gst_object_ref, NULL);
+  GST_OBJECT_UNLOCK (tee);
+
+  for (l = pads; l; l = l->next) {
+    GstTeePad *tpad = GST_TEE_PAD_CAST (l->data);
+
+    g_mutex_lock (&tee->parallel_lock);
+    tpad->wait = 0;
+    if (!tpad->worker) {
+      g_mutex_unlock (&tee->parallel_lock);
+      tpad->result = gst_tee_do_push (tee, GST_PAD_CAST (tpad), data, is_list,
+          FALSE);
+      continue;
+    }
+
+    if (tpad->n_data >= max_backlog) {
+      if (policy == GST_TEE_PARALLEL_POLICY_FIRE_AND_FORGET) {
+        GST_LOG_OBJECT (tpad, "backlog full, dropping %s %p",
+            is_list ? "list" : "buffer", data);
+        tpad->result = tpad->worker_result;
+        g_mutex_unlock (&tee->parallel_lock);
+        dropped++;
+        continue;
+      }
+      GST_LOG_OBJECT (tpad, "backlog full, waiting");
+      while (!tpad->flushing && tpad->n_data >= max_backlog)
+        g_cond_wait (&tee->parallel_cond, &tee->parallel_lock);
+    }
+
+    if (tpad->flushing) {
+      tpad->result = tpad->removed ? GST_FLOW_NOT_LINKED : GST_FLOW_FLUSHING;
+      g_mutex_unlock (&tee->parallel_lock);
+      continue;
+    }
+
+    g_queue_push_tail (&tpad->backlog, gst_mini_object_ref (data));
+    tpad->n_data++;
+    tpad->wait = ++tpad->queued;
+    g_cond_signal (&tpad->cond);
+    g_mutex_unlock (&tee->parallel_lock);
+  }
+
+  g_mutex_lock (&tee->parallel_lock);
+  while (policy != GST_TEE_PARALLEL_POLICY_FIRE_AND_FORGET) {
+    guint pending = 0, handled = 0;
+
+    for (l = pads; l; l = l->next) {
+      GstTeePad *tpad = GST_TEE_PAD_CAST (l->data);
+
+      if (tpad->wait == 0)
+        continue;
+      if (tpad->flushing || tpad->done >= tpad->wait)
+        handled++;
+      else
+        pending++;
+    }
+    if (pending == 0 || (policy == GST_TEE_PARALLEL_POLICY_WAIT_ANY
+            && handled > 0))
+      break;
+
+    g_cond_wait (&tee->parallel_cond, &tee->parallel_lock);
+  }
+
+  /* for the src pads that didn't finish yet, this is the result of the
+   * previous push, which is the best we know */
+  for (l = pads; l; l = l->next) {
+    GstTeePad *tpad = GST_TEE_PAD_CAST (l->data);
+
+    if (tpad->wait == 0)
+      continue;
+    if (tpad->flushing)
+      tpad->result = tpad->removed ? GST_FLOW_NOT_LINKED : GST_FLOW_FLUSHING;
+    else
+      tpad->result = tpad->worker_result;
+  }
+  g_mutex_unlock (&tee->parallel_lock);
+
+  if (dropped) {
+    GST_OBJECT_LOCK (tee);
+    tee->dropped += dropped;
+    GST_OBJECT_UNLOCK (tee);
+  }
+
+  if (tee->allow_not_linked) {
+    cret = GST_FLOW_OK;
+  } else {
+    cret = GST_FLOW_NOT_LINKED;
+  }
+  for (l = pads; l; l = l->next) {
+    ret = GST_TEE_PAD_CAST (l->data)->result;
+
+    /* a fatal error wins, else OK when any src pad is linked */
+    if (G_UNLIKELY (ret != GST_FLOW_OK && ret != GST_FLOW_NOT_LINKED)) {
+      GST_DEBUG_OBJECT (tee, "received error %s", gst_flow_get_name (ret));
+      cret = ret;
+      break;
+    }
+    if (ret == GST_FLOW_OK)
+      cret = ret;
+  }
+  g_list_free_full (pads, gst_object_unref);
+
+  gst_mini_object_unref (GST_MINI_OBJECT_CAST (data));
+
+  return cret;
+}
+
 static GstFlowReturn
 gst_tee_handle_data (GstTee * tee, gpointer data, gboolean is_list)
 {
   GList *pads;
-  guint32 cookie;
+  GstPad *pad;
+  gboolean last;
   GstFlowReturn ret, cret;
 
   if (G_UNLIKELY (!tee->silent))
@@ -629,6 +1188,9 @@ gst_tee_handle_data (GstTee * tee, gpointer data, gboolean is_list)
   if (G_UNLIKELY (!pads))
     goto no_pads;
 
+  if (g_atomic_int_get (&tee->n_workers) > 0)
+    return gst_tee_handle_data_parallel (tee, data, is_list);
+
   /* special case for just one pad that avoids reffing the buffer */
   if (!pads->next) {
     GstPad *pad = GST_PAD_CAST (pads->data);
@@ -658,71 +1220,63 @@ gst_tee_handle_data (GstTee * tee, gpointer data, gboolean is_list)
   /* mark all pads as 'not pushed on yet' */
   g_list_foreach (pads, (GFunc) clear_pads, tee);
 
-restart:
-  if (tee->allow_not_linked) {
-    cret = GST_FLOW_OK;
-  } else {
-    cret = GST_FLOW_NOT_LINKED;
-  }
-  pads = GST_ELEMENT_CAST (tee)->srcpads;
-  cookie = GST_ELEMENT_CAST (tee)->pads_cookie;
-
-  while (pads) {
-    GstPad *pad;
-
-    pad = GST_PAD_CAST (pads->data);
+  /* Pads that we already pushed on are not pushed on again when the list of
+   * pads changes while pushing. The last pad gets our own reference so that
+   * it can receive a writable buffer when the other branches are done. */
+  while ((pad = gst_tee_next_pad (tee, &last))) {
+    if (G_UNLIKELY (data == NULL)) {
+      /* a pad was added after we gave away our reference */
+      GST_LOG_OBJECT (pad, "added after the last push, skipping");
+      GST_TEE_PAD_CAST (pad)->pushed = TRUE;
+      continue;
+    }
 
-    if (G_LIKELY (!GST_TEE_PAD_CAST (pad)->pushed)) {
-      /* not yet pushed, release lock and start pushing */
-      gst_object_ref (pad);
-      GST_OBJECT_UNLOCK (tee);
+    /* not yet pushed, release lock and start pushing */
+    gst_object_ref (pad);
+    GST_OBJECT_UNLOCK (tee);
 
-      GST_LOG_OBJECT (pad, "Starting to push %s %p",
-          is_list ? "list" : "buffer", data);
+    GST_LOG_OBJECT (pad, "Starting to push %s %p%s",
+        is_list ? "list" : "buffer", data, last ? " (last)" : "");
 
-      ret = gst_tee_do_push (tee, pad, data, is_list);
+    ret = gst_tee_do_push (tee, pad, data, is_list, last);
 
-      GST_LOG_OBJECT (pad, "Pushing item %p yielded result %s", data,
-          gst_flow_get_name (ret));
+    GST_LOG_OBJECT (pad, "Pushing item %p yielded result %s", data,
+        gst_flow_get_name (ret));
 
-      GST_OBJECT_LOCK (tee);
-      /* keep track of which pad we pushed and the result value */
-      GST_TEE_PAD_CAST (pad)->pushed = TRUE;
-      GST_TEE_PAD_CAST (pad)->result = ret;
-      gst_object_unref (pad);
-      pad = NULL;
-    } else {
-      /* already pushed, use previous return value */
-      ret = GST_TEE_PAD_CAST (pad)->result;
-      GST_LOG_OBJECT (pad, "pad already pushed with %s",
-          gst_flow_get_name (ret));
-    }
+    if (last)
+      data = NULL;
 
-    /* before we go combining the return value, check if the pad list is still
-     * the same. It could be possible that the pad we just pushed was removed
-     * and the return value it not valid anymore */
-    if (G_UNLIKELY (GST_ELEMENT_CAST (tee)->pads_cookie != cookie)) {
-      GST_LOG_OBJECT (tee, "pad list changed");
-      /* the list of pads changed, restart iteration. Pads that we already
-       * pushed on and are still in the new list, will not be pushed on
-       * again. */
-      goto restart;
-    }
+    GST_OBJECT_LOCK (tee);
+    /* keep track of which pad we pushed and the result value */
+    GST_TEE_PAD_CAST (pad)->pushed = TRUE;
+    GST_TEE_PAD_CAST (pad)->result = ret;
+    gst_object_unref (pad);
 
     /* stop pushing more buffers when we have a fatal error */
     if (G_UNLIKELY (ret != GST_FLOW_OK && ret != GST_FLOW_NOT_LINKED))
       goto error;
+  }
+
+  if (tee->allow_not_linked) {
+    cret = GST_FLOW_OK;
+  } else {
+    cret = GST_FLOW_NOT_LINKED;
+  }
+  /* combine the results of the pads that are still there, pads that were
+   * removed while pushing don't count anymore */
+  for (pads = GST_ELEMENT_CAST (tee)->srcpads; pads; pads = pads->next) {
+    ret = GST_TEE_PAD_CAST (pads->data)->result;
 
     /* keep all other return values, overwriting the previous one. */
     if (G_LIKELY (ret != GST_FLOW_NOT_LINKED)) {
       GST_LOG_OBJECT (tee, "Replacing ret val %d with %d", cret, ret);
       cret = ret;
     }
-    pads = g_list_next (pads);
   }
   GST_OBJECT_UNLOCK (tee);
 
-  gst_mini_object_unref (GST_MINI_OBJECT_CAST (data));
+  if (data)
+    gst_mini_object_unref (GST_MINI_OBJECT_CAST (data));
 
   /* no need to unset gvalue */
   return cret;
@@ -748,7 +1302,8 @@ error:
 end:
   {
     GST_OBJECT_UNLOCK (tee);
-    gst_mini_object_unref (GST_MINI_OBJECT_CAST (data));
+    if (data)
+      gst_mini_object_unref (GST_MINI_OBJECT_CAST (data));
     return ret;
   }
 }
@@ -867,6 +1422,22 @@ gst_tee_src_activate_mode (GstPad * pad, GstObject * parent, GstPadMode mode,
       GST_OBJECT_UNLOCK (tee);
       break;
     }
+    case GST_PAD_MODE_PUSH:
+    {
+      gboolean parallel;
+
+      GST_OBJECT_LOCK (tee);
+      parallel = tee->parallel;
+      GST_OBJECT_UNLOCK (tee);
+
+      if (active && parallel)
+        res = gst_tee_pad_start_worker (tee, GST_TEE_PAD_CAST (pad));
+      else if (!active)
+        res = gst_tee_pad_pause_worker (tee, GST_TEE_PAD_CAST (pad), TRUE);
+      else
+        res = TRUE;
+      break;
+    }
     default:
       res = TRUE;
       break;
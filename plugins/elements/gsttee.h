@@ -62,6 +62,23 @@ typedef enum {
   GST_TEE_PULL_MODE_SINGLE,
 } GstTeePullMode;
 
+/**
+ * GstTeeParallelPolicy:
+ * @GST_TEE_PARALLEL_POLICY_WAIT_ALL: Wait until all src pads pushed the data.
+ * @GST_TEE_PARALLEL_POLICY_WAIT_ANY: Wait until one src pad pushed the data.
+ * @GST_TEE_PARALLEL_POLICY_FIRE_AND_FORGET: Don't wait, drop data for src pads
+ *   with a full backlog.
+ *
+ * When tee waits for the src pads in parallel mode.
+ *
+ * Since: 1.10
+ */
+typedef enum {
+  GST_TEE_PARALLEL_POLICY_WAIT_ALL,
+  GST_TEE_PARALLEL_POLICY_WAIT_ANY,
+  GST_TEE_PARALLEL_POLICY_FIRE_AND_FORGET,
+} GstTeeParallelPolicy;
+
 /**
  * GstTee:
  *
@@ -74,6 +91,7 @@ struct _GstTee {
   GRecMutex      mutex_events;
   GstPad         *sinkpad;
   GstPad         *allocpad;
+  GstPad         *writable_pad;
 
   GHashTable     *pad_indexes;
   guint           next_pad_index;
@@ -87,6 +105,17 @@ struct _GstTee {
   GstPad         *pull_pad;
 
   gboolean        allow_not_linked;
+
+  /* parallel mode */
+  gboolean        parallel;
+  GstTeeParallelPolicy parallel_policy;
+  guint           max_backlog;
+  guint64         dropped;
+  /* protects the backlogs of the src pads */
+  GMutex          parallel_lock;
+  /* signaled when a src pad handled data */
+  GCond           parallel_cond;
+  gint            n_workers;
 };
 
 struct _GstTeeClass {
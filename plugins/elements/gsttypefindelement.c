@@ -100,6 +100,13 @@ GST_STATIC_PAD_TEMPLATE ("src",
 #define TYPE_FIND_MIN_SIZE   (2*1024)
 #define TYPE_FIND_MAX_SIZE (128*1024)
 
+/* Number of typefind results kept in the process-wide cache and the amount
+ * of data at the start of the stream that must match for a cache hit */
+#define TYPE_FIND_CACHE_SIZE 64
+#define TYPE_FIND_CACHE_PEEK_SIZE TYPE_FIND_MIN_SIZE
+
+#define DEFAULT_USE_CACHE FALSE
+
 /* TypeFind signals and args */
 enum
 {
@@ -112,6 +119,7 @@ enum
   PROP_CAPS,
   PROP_MINIMUM,
   PROP_FORCE_CAPS,
+  PROP_USE_CACHE,
   PROP_LAST
 };
 enum
@@ -261,6 +269,19 @@ gst_type_find_element_class_init (GstTypeFindElementClass * typefind_class)
       g_param_spec_boxed ("force-caps", _("force caps"),
           _("force caps without doing a typefind"), GST_TYPE_CAPS,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstTypeFindElement:use-cache:
+   *
+   * Look up the type of the stream in a process-wide cache of previous
+   * results before running the typefind functions. Streams are identified by
+   * the upstream URI and size, when known, and the first bytes of data.
+   *
+   * Since: 1.10
+   */
+  g_object_class_install_property (gobject_class, PROP_USE_CACHE,
+      g_param_spec_boolean ("use-cache", "Use cache",
+          "Reuse the results of previous typefinding of the same stream",
+          DEFAULT_USE_CACHE, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
   /**
    * GstTypeFindElement::have-type:
    * @typefind: the typefind instance
@@ -330,6 +351,7 @@ gst_type_find_element_init (GstTypeFindElement * typefind)
   typefind->mode = MODE_TYPEFIND;
   typefind->caps = NULL;
   typefind->min_probability = 1;
+  typefind->use_cache = DEFAULT_USE_CACHE;
 
   typefind->adapter = gst_adapter_new ();
 }
@@ -349,6 +371,9 @@ gst_type_find_element_dispose (GObject * object)
     typefind->force_caps = NULL;
   }
 
+  g_free (typefind->cache_key);
+  typefind->cache_key = NULL;
+
   G_OBJECT_CLASS (parent_class)->dispose (object);
 }
 
@@ -371,6 +396,9 @@ gst_type_find_element_set_property (GObject * object, guint prop_id,
       typefind->force_caps = g_value_dup_boxed (value);
       GST_OBJECT_UNLOCK (typefind);
       break;
+    case PROP_USE_CACHE:
+      typefind->use_cache = g_value_get_boolean (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -399,6 +427,9 @@ gst_type_find_element_get_property (GObject * object, guint prop_id,
       g_value_set_boxed (value, typefind->force_caps);
       GST_OBJECT_UNLOCK (typefind);
       break;
+    case PROP_USE_CACHE:
+      g_value_set_boolean (value, typefind->use_cache);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -582,6 +613,9 @@ start_typefinding (GstTypeFindElement * typefind)
   typefind->initial_offset = GST_BUFFER_OFFSET_NONE;
   GST_OBJECT_UNLOCK (typefind);
 
+  g_free (typefind->cache_key);
+  typefind->cache_key = NULL;
+
   typefind->mode = MODE_TYPEFIND;
 }
 
@@ -792,6 +826,125 @@ gst_type_find_element_setcaps (GstTypeFindElement * typefind, GstCaps * caps)
   return TRUE;
 }
 
+typedef struct
+{
+  gchar *key;
+  GstCaps *caps;
+  GstTypeFindProbability probability;
+} TypeFindCacheEntry;
+
+static GMutex cache_lock;
+/* key -> link in cache_lru, most recently used entries first */
+static GHashTable *cache_table;
+static GQueue cache_lru = G_QUEUE_INIT;
+
+static void
+type_find_cache_entry_free (TypeFindCacheEntry * entry)
+{
+  g_free (entry->key);
+  gst_caps_unref (entry->caps);
+  g_slice_free (TypeFindCacheEntry, entry);
+}
+
+/* returns a new reference to the caps stored for @key, if any, that have
+ * at least @min_probability */
+static GstCaps *
+type_find_cache_lookup (const gchar * key, guint min_probability,
+    GstTypeFindProbability * probability)
+{
+  GstCaps *caps = NULL;
+  GList *link;
+
+  g_mutex_lock (&cache_lock);
+  if (cache_table && (link = g_hash_table_lookup (cache_table, key))) {
+    TypeFindCacheEntry *entry = link->data;
+
+    g_queue_unlink (&cache_lru, link);
+    g_queue_push_head_link (&cache_lru, link);
+
+    if (entry->probability >= min_probability) {
+      caps = gst_caps_ref (entry->caps);
+      *probability = entry->probability;
+    }
+  }
+  g_mutex_unlock (&cache_lock);
+
+  return caps;
+}
+
+static void
+type_find_cache_insert (const gchar * key, GstCaps * caps,
+    GstTypeFindProbability probability)
+{
+  TypeFindCacheEntry *entry;
+  GList *link;
+
+  g_mutex_lock (&cache_lock);
+  if (cache_table == NULL)
+    cache_table = g_hash_table_new (g_str_hash, g_str_equal);
+
+  if ((link = g_hash_table_lookup (cache_table, key))) {
+    entry = link->data;
+    g_queue_unlink (&cache_lru, link);
+    gst_caps_replace (&entry->caps, caps);
+  } else {
+    entry = g_slice_new (TypeFindCacheEntry);
+    entry->key = g_strdup (key);
+    entry->caps = gst_caps_ref (caps);
+    link = g_list_alloc ();
+    link->data = entry;
+    g_hash_table_insert (cache_table, entry->key, link);
+  }
+  entry->probability = probability;
+  g_queue_push_head_link (&cache_lru, link);
+
+  while (g_queue_get_length (&cache_lru) > TYPE_FIND_CACHE_SIZE) {
+    entry = g_queue_pop_tail (&cache_lru);
+    g_hash_table_remove (cache_table, entry->key);
+    type_find_cache_entry_free (entry);
+  }
+  g_mutex_unlock (&cache_lock);
+}
+
+/* identifies the upstream stream by its URI and size, either may be unknown */
+static gchar *
+gst_type_find_get_stream_identity (GstTypeFindElement * typefind)
+{
+  GstQuery *query;
+  gchar *uri = NULL, *result;
+  gint64 size;
+
+  query = gst_query_new_uri ();
+  if (gst_pad_peer_query (typefind->sink, query))
+    gst_query_parse_uri (query, &uri);
+  gst_query_unref (query);
+
+  if (!gst_pad_peer_query_duration (typefind->sink, GST_FORMAT_BYTES, &size))
+    size = -1;
+
+  result = g_strdup_printf ("%s|%" G_GINT64_FORMAT, uri ? uri : "", size);
+  g_free (uri);
+
+  return result;
+}
+
+/* the cache key also contains a checksum of the start of the stream, this
+ * makes sure the cached result is only used for the same data */
+static gchar *
+gst_type_find_make_cache_key (const gchar * identity, const guint8 * data,
+    gsize size)
+{
+  gchar *checksum, *result;
+
+  size = MIN (size, TYPE_FIND_CACHE_PEEK_SIZE);
+  checksum = g_compute_checksum_for_data (G_CHECKSUM_SHA1, data, size);
+  result = g_strdup_printf ("%s|%" G_GSIZE_FORMAT "|%s", identity, size,
+      checksum);
+  g_free (checksum);
+
+  return result;
+}
+
 static gchar *
 gst_type_find_get_extension (GstTypeFindElement * typefind, GstPad * pad)
 {
@@ -924,6 +1077,13 @@ gst_type_find_element_chain_do_typefinding (GstTypeFindElement * typefind,
   gsize avail;
   const guint8 *data;
   gboolean have_min, have_max;
+  gboolean cached = FALSE;
+  gchar *identity = NULL;
+
+  /* query upstream before taking the lock, we only need this until the
+   * first lookup in the cache was done */
+  if (typefind->use_cache && typefind->cache_key == NULL)
+    identity = gst_type_find_get_stream_identity (typefind);
 
   GST_OBJECT_LOCK (typefind);
   if (typefind->force_caps) {
@@ -947,8 +1107,16 @@ gst_type_find_element_chain_do_typefinding (GstTypeFindElement * typefind,
 
     /* map all available data */
     data = gst_adapter_map (typefind->adapter, avail);
-    caps = gst_type_find_helper_for_data (GST_OBJECT (typefind),
-        data, avail, &probability);
+    if (identity) {
+      typefind->cache_key = gst_type_find_make_cache_key (identity, data,
+          avail);
+      caps = type_find_cache_lookup (typefind->cache_key,
+          typefind->min_probability, &probability);
+      cached = (caps != NULL);
+    }
+    if (!caps)
+      caps = gst_type_find_helper_for_data (GST_OBJECT (typefind),
+          data, avail, &probability);
     gst_adapter_unmap (typefind->adapter);
 
     if (caps == NULL && have_max)
@@ -959,9 +1127,16 @@ gst_type_find_element_chain_do_typefinding (GstTypeFindElement * typefind,
     /* found a type */
     if (probability < typefind->min_probability)
       goto low_probability;
+
+    if (cached)
+      GST_DEBUG_OBJECT (typefind, "found caps %" GST_PTR_FORMAT " in cache",
+          caps);
+    else if (typefind->cache_key)
+      type_find_cache_insert (typefind->cache_key, caps, probability);
   }
 
   GST_OBJECT_UNLOCK (typefind);
+  g_free (identity);
 
   /* probability is good enough too, so let's make it known ... emiting this
    * signal calls our object handler which sets the caps. */
@@ -976,6 +1151,7 @@ gst_type_find_element_chain_do_typefinding (GstTypeFindElement * typefind,
 not_enough_data:
   {
     GST_OBJECT_UNLOCK (typefind);
+    g_free (identity);
 
     if (at_eos) {
       GST_ELEMENT_ERROR (typefind, STREAM, TYPE_NOT_FOUND,
@@ -991,6 +1167,7 @@ not_enough_data:
 no_type_found:
   {
     GST_OBJECT_UNLOCK (typefind);
+    g_free (identity);
     GST_ELEMENT_ERROR (typefind, STREAM, TYPE_NOT_FOUND, (NULL), (NULL));
     stop_typefinding (typefind);
     return GST_FLOW_ERROR;
@@ -998,6 +1175,7 @@ no_type_found:
 wait_for_data:
   {
     GST_OBJECT_UNLOCK (typefind);
+    g_free (identity);
 
     if (at_eos) {
       GST_ELEMENT_ERROR (typefind, STREAM, TYPE_NOT_FOUND,
@@ -1023,6 +1201,7 @@ low_probability:
       goto no_type_found;
 
     GST_OBJECT_UNLOCK (typefind);
+    g_free (identity);
     GST_DEBUG_OBJECT (typefind, "waiting for more data to try again");
     return GST_FLOW_OK;
   }
@@ -1065,6 +1244,28 @@ gst_type_find_element_activate_src_mode (GstPad * pad, GstObject * parent,
   return res;
 }
 
+static gchar *
+gst_type_find_element_pull_cache_key (GstTypeFindElement * typefind,
+    GstPad * pad)
+{
+  GstBuffer *buffer = NULL;
+  GstMapInfo map;
+  gchar *identity, *result;
+
+  if (gst_pad_pull_range (pad, 0, TYPE_FIND_CACHE_PEEK_SIZE,
+          &buffer) != GST_FLOW_OK)
+    return NULL;
+
+  identity = gst_type_find_get_stream_identity (typefind);
+  gst_buffer_map (buffer, &map, GST_MAP_READ);
+  result = gst_type_find_make_cache_key (identity, map.data, map.size);
+  gst_buffer_unmap (buffer, &map);
+  gst_buffer_unref (buffer);
+  g_free (identity);
+
+  return result;
+}
+
 static void
 gst_type_find_element_loop (GstPad * pad)
 {
@@ -1107,7 +1308,7 @@ gst_type_find_element_loop (GstPad * pad)
       peer = gst_pad_get_peer (pad);
       if (peer) {
         gint64 size;
-        gchar *ext;
+        gchar *ext, *cache_key = NULL;
 
         if (!gst_pad_query_duration (peer, GST_FORMAT_BYTES, &size)) {
           GST_WARNING_OBJECT (typefind, "Could not query upstream length!");
@@ -1126,16 +1327,32 @@ gst_type_find_element_loop (GstPad * pad)
           ret = GST_FLOW_ERROR;
           goto pause;
         }
-        ext = gst_type_find_get_extension (typefind, pad);
 
-        found_caps =
-            gst_type_find_helper_get_range (GST_OBJECT_CAST (peer),
-            GST_OBJECT_PARENT (peer),
-            (GstTypeFindHelperGetRangeFunction) (GST_PAD_GETRANGEFUNC (peer)),
-            (guint64) size, ext, &probability);
-        g_free (ext);
-
-        GST_DEBUG ("Found caps %" GST_PTR_FORMAT, found_caps);
+        if (typefind->use_cache)
+          cache_key = gst_type_find_element_pull_cache_key (typefind, pad);
+        if (cache_key)
+          found_caps = type_find_cache_lookup (cache_key,
+              typefind->min_probability, &probability);
+
+        if (found_caps) {
+          GST_DEBUG ("Found caps %" GST_PTR_FORMAT " in cache", found_caps);
+        } else {
+          ext = gst_type_find_get_extension (typefind, pad);
+
+          found_caps =
+              gst_type_find_helper_get_range (GST_OBJECT_CAST (peer),
+              GST_OBJECT_PARENT (peer),
+              (GstTypeFindHelperGetRangeFunction) (GST_PAD_GETRANGEFUNC
+                  (peer)), (guint64) size, ext, &probability);
+          g_free (ext);
+
+          GST_DEBUG ("Found caps %" GST_PTR_FORMAT, found_caps);
+
+          if (cache_key && found_caps
+              && probability >= typefind->min_probability)
+            type_find_cache_insert (cache_key, found_caps, probability);
+        }
+        g_free (cache_key);
 
         gst_object_unref (peer);
       }
@@ -1329,6 +1546,8 @@ gst_type_find_element_change_state (GstElement * element,
       typefind->cached_events = NULL;
       typefind->mode = MODE_TYPEFIND;
       GST_OBJECT_UNLOCK (typefind);
+      g_free (typefind->cache_key);
+      typefind->cache_key = NULL;
       break;
     default:
       break;
@@ -58,6 +58,9 @@ struct _GstTypeFindElement {
   GList *               cached_events;
   GstCaps *             force_caps;
 
+  gboolean              use_cache;
+  gchar *               cache_key;
+
   guint64		initial_offset;
   
   /* Only used when driving the pipeline */
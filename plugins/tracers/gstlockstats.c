@@ -0,0 +1,264 @@
+/* GStreamer
+ *
+ * gstlockstats.c: tracing module that logs lock contention
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+/**
+ * SECTION:gstlockstats
+ * @short_description: log lock contention of the core locks
+ *
+ * A tracing module that accumulates how often and how long threads had to
+ * wait for the object locks, the pad stream locks and the queue locks. Every
+ * wait that is longer than 1ms is logged as a "lock-wait" entry together with
+ * the thread that held the lock before. When the tracer is shut down, a
+ * "lock-stats" entry is logged for each contended lock, ordered by the total
+ * wait time so that the worst serialization points come first.
+ *
+ * When the locks spin before blocking, the summary also counts how often a
+ * thread spun and how often that avoided blocking.
+ *
+ * The hooks are only called when GStreamer was configured with
+ * --enable-lock-tracing or --enable-adaptive-locks, otherwise this tracer
+ * does not log anything.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include "gstlockstats.h"
+
+GST_DEBUG_CATEGORY_STATIC (gst_lockstats_debug);
+#define GST_CAT_DEFAULT gst_lockstats_debug
+
+#define _do_init \
+    GST_DEBUG_CATEGORY_INIT (gst_lockstats_debug, "lockstats", 0, "lockstats tracer");
+#define gst_lockstats_tracer_parent_class parent_class
+G_DEFINE_TYPE_WITH_CODE (GstLockStatsTracer, gst_lockstats_tracer,
+    GST_TYPE_TRACER, _do_init);
+
+static GstTracerRecord *tr_wait;
+static GstTracerRecord *tr_stats;
+
+/* waits longer than this are logged individually */
+#define LONG_WAIT (GST_MSECOND)
+
+typedef struct
+{
+  gchar *object;
+  const gchar *kind;
+
+  guint64 contended;
+  GstClockTime wait_total;
+  GstClockTime wait_max;
+  guint64 last_holder;
+
+  guint64 spun;
+  guint64 spin_acquired;
+} GstLockStatsEntry;
+
+/* data helpers */
+
+/* call with the lock, the key is static for the given kind */
+static GstLockStatsEntry *
+get_lock_stats (GstLockStatsTracer * self, GstObject * object,
+    const gchar * kind)
+{
+  GstLockStatsEntry *stats;
+  gchar *key;
+  GQuark quark;
+
+  key = g_strconcat ("gstlockstats:", kind, NULL);
+  quark = g_quark_from_string (key);
+  g_free (key);
+
+  if (!(stats = g_object_get_qdata ((GObject *) object, quark))) {
+    stats = g_slice_new0 (GstLockStatsEntry);
+    stats->object = g_strdup (GST_OBJECT_NAME (object));
+    stats->kind = kind;
+    /* owned by the tracer, the object might go away before the report */
+    g_object_set_qdata ((GObject *) object, quark, stats);
+    self->stats = g_list_prepend (self->stats, stats);
+  }
+  return stats;
+}
+
+/* hooks */
+
+static void
+do_lock_wait (GstLockStatsTracer * self, guint64 ts, GstObject * object,
+    const gchar * kind, GstClockTime wait, GThread * holder)
+{
+  GstLockStatsEntry *stats;
+  guint64 holder_id = (guint64) (guintptr) holder;
+
+  g_mutex_lock (&self->lock);
+  stats = get_lock_stats (self, object, kind);
+  stats->contended++;
+  stats->wait_total += wait;
+  stats->wait_max = MAX (stats->wait_max, wait);
+  if (holder)
+    stats->last_holder = holder_id;
+  g_mutex_unlock (&self->lock);
+
+  if (wait >= LONG_WAIT) {
+    gst_tracer_record_log (tr_wait, ts, (guint64) (guintptr) g_thread_self (),
+        GST_OBJECT_NAME (object), kind, wait, holder_id);
+  }
+}
+
+static void
+do_lock_spin (GstLockStatsTracer * self, guint64 ts, GstObject * object,
+    const gchar * kind, guint spins, gboolean acquired)
+{
+  GstLockStatsEntry *stats;
+
+  g_mutex_lock (&self->lock);
+  stats = get_lock_stats (self, object, kind);
+  stats->spun++;
+  if (acquired)
+    stats->spin_acquired++;
+  g_mutex_unlock (&self->lock);
+}
+
+/* tracer class */
+
+static gint
+compare_wait_total (const GstLockStatsEntry * a, const GstLockStatsEntry * b)
+{
+  if (a->wait_total > b->wait_total)
+    return -1;
+  if (a->wait_total < b->wait_total)
+    return 1;
+  return 0;
+}
+
+static void
+free_stats (GstLockStatsEntry * stats)
+{
+  g_free (stats->object);
+  g_slice_free (GstLockStatsEntry, stats);
+}
+
+static void
+gst_lockstats_tracer_finalize (GObject * obj)
+{
+  GstLockStatsTracer *self = GST_LOCKSTATS_TRACER (obj);
+  GstLockStatsEntry *stats;
+  GList *l;
+
+  /* final report, worst locks first */
+  self->stats = g_list_sort (self->stats, (GCompareFunc) compare_wait_total);
+  for (l = self->stats; l; l = l->next) {
+    stats = l->data;
+    gst_tracer_record_log (tr_stats, stats->object, stats->kind,
+        stats->contended, stats->wait_total, stats->wait_max,
+        stats->last_holder, stats->spun, stats->spin_acquired);
+  }
+  g_list_free_full (self->stats, (GDestroyNotify) free_stats);
+  g_mutex_clear (&self->lock);
+
+  G_OBJECT_CLASS (parent_class)->finalize (obj);
+}
+
+static void
+gst_lockstats_tracer_class_init (GstLockStatsTracerClass * klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+  gobject_class->finalize = gst_lockstats_tracer_finalize;
+
+  /* announce trace formats */
+  /* *INDENT-OFF* */
+  tr_wait = gst_tracer_record_new ("lock-wait.class",
+      "ts", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT64,
+          "description", G_TYPE_STRING, "event ts",
+          NULL),
+      "thread-id", GST_TYPE_STRUCTURE, gst_structure_new ("scope",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT64,
+          "related-to", GST_TYPE_TRACER_VALUE_SCOPE, GST_TRACER_VALUE_SCOPE_THREAD,
+          NULL),
+      "object", GST_TYPE_STRUCTURE, gst_structure_new ("scope",
+          "type", G_TYPE_GTYPE, G_TYPE_STRING,
+          "related-to", GST_TYPE_TRACER_VALUE_SCOPE, GST_TRACER_VALUE_SCOPE_ELEMENT,
+          NULL),
+      "kind", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_STRING,
+          "description", G_TYPE_STRING, "which lock of the object",
+          NULL),
+      "wait", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT64,
+          "description", G_TYPE_STRING, "time in ns spent waiting for the lock",
+          NULL),
+      "holder", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT64,
+          "description", G_TYPE_STRING, "thread-id that held the lock before, 0 if unknown",
+          NULL),
+      NULL);
+  tr_stats = gst_tracer_record_new ("lock-stats.class",
+      "object", GST_TYPE_STRUCTURE, gst_structure_new ("scope",
+          "type", G_TYPE_GTYPE, G_TYPE_STRING,
+          "related-to", GST_TYPE_TRACER_VALUE_SCOPE, GST_TRACER_VALUE_SCOPE_ELEMENT,
+          NULL),
+      "kind", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_STRING,
+          "description", G_TYPE_STRING, "which lock of the object",
+          NULL),
+      "contended", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT64,
+          "description", G_TYPE_STRING, "number of times a thread had to wait",
+          "flags", GST_TYPE_TRACER_VALUE_FLAGS, GST_TRACER_VALUE_FLAGS_AGGREGATED,
+          NULL),
+      "wait-total", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT64,
+          "description", G_TYPE_STRING, "time in ns spent waiting for the lock",
+          "flags", GST_TYPE_TRACER_VALUE_FLAGS, GST_TRACER_VALUE_FLAGS_AGGREGATED,
+          NULL),
+      "wait-max", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT64,
+          "description", G_TYPE_STRING, "longest wait in ns",
+          "flags", GST_TYPE_TRACER_VALUE_FLAGS, GST_TRACER_VALUE_FLAGS_AGGREGATED,
+          NULL),
+      "last-holder", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT64,
+          "description", G_TYPE_STRING, "thread-id that last made another thread wait",
+          NULL),
+      "spun", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT64,
+          "description", G_TYPE_STRING, "number of times a thread spun on the lock",
+          "flags", GST_TYPE_TRACER_VALUE_FLAGS, GST_TRACER_VALUE_FLAGS_AGGREGATED,
+          NULL),
+      "spin-acquired", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT64,
+          "description", G_TYPE_STRING, "number of times spinning avoided blocking",
+          "flags", GST_TYPE_TRACER_VALUE_FLAGS, GST_TRACER_VALUE_FLAGS_AGGREGATED,
+          NULL),
+      NULL);
+  /* *INDENT-ON* */
+}
+
+static void
+gst_lockstats_tracer_init (GstLockStatsTracer * self)
+{
+  GstTracer *tracer = GST_TRACER (self);
+
+  g_mutex_init (&self->lock);
+
+  gst_tracing_register_hook (tracer, "lock-wait", G_CALLBACK (do_lock_wait));
+  gst_tracing_register_hook (tracer, "lock-spin", G_CALLBACK (do_lock_spin));
+}
@@ -0,0 +1,579 @@
+/* GStreamer
+ *
+ * gstpoolstats.c: tracing module that logs buffer pool stats
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+/**
+ * SECTION:gstpoolstats
+ * @short_description: log buffer pool usage and stalls
+ *
+ * A tracing module that follows the buffers of all buffer pools from
+ * gst_buffer_pool_acquire_buffer() until they go back to their pool. For
+ * each buffer it remembers the element that it was last pushed to or that
+ * pulled it.
+ *
+ * When acquiring a buffer blocks for longer than 20ms, a "buffer-pool-stall"
+ * entry is logged with the number of outstanding buffers of the pool, the
+ * age of the oldest one and the element holding it. This usually points at
+ * the element that keeps the pool dry.
+ *
+ * When a pool is freed and when the tracer is shut down, a "buffer-pool"
+ * entry is logged with the number of acquired buffers, the maximum number
+ * of outstanding buffers, the time spent waiting in acquire and the
+ * distribution of the time buffers were out of the pool, followed by the
+ * #GstAllocationStats of the pool.
+ *
+ * The tracer also enables the statistics of the default allocator and of
+ * the allocators configured in the pools it sees. When it is shut down, an
+ * "allocator" entry is logged for each of them.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include "gstpoolstats.h"
+
+GST_DEBUG_CATEGORY_STATIC (gst_poolstats_debug);
+#define GST_CAT_DEFAULT gst_poolstats_debug
+
+#define _do_init \
+    GST_DEBUG_CATEGORY_INIT (gst_poolstats_debug, "poolstats", 0, "poolstats tracer");
+#define gst_poolstats_tracer_parent_class parent_class
+G_DEFINE_TYPE_WITH_CODE (GstPoolStatsTracer, gst_poolstats_tracer,
+    GST_TYPE_TRACER, _do_init);
+
+static GstTracerRecord *tr_pool;
+static GstTracerRecord *tr_stall;
+static GstTracerRecord *tr_allocator;
+
+/* acquiring a buffer that took longer than this is logged as a stall */
+#define STALL_TIME (20 * GST_MSECOND)
+
+/* one bucket per power of two nanoseconds */
+#define N_BUCKETS 64
+
+typedef struct
+{
+  GstBufferPool *pool;          /* weak */
+  gchar *name;
+  guint64 acquired;
+  guint outstanding;
+  guint max_outstanding;
+  guint64 stalls;
+  GstClockTime wait_total;
+  GstClockTime wait_max;
+  guint64 released;
+  GstClockTime age_max;
+  guint64 ages[N_BUCKETS];
+} GstPoolStats;
+
+/* a buffer that was acquired from a pool and not released yet */
+typedef struct
+{
+  GstPoolStats *stats;
+  GstClockTime acquired;
+  /* only compared, the element might be gone */
+  GstElement *holder;
+  GQuark holder_name;
+} GstPoolBuffer;
+
+static GPrivate acquire_key = G_PRIVATE_INIT (g_free);
+
+/* data helpers */
+
+static GstClockTime
+get_age_percentile (GstPoolStats * stats, guint percent)
+{
+  guint64 rank, seen = 0;
+  guint i;
+
+  if (stats->released == 0)
+    return 0;
+
+  rank = (stats->released * percent + 99) / 100;
+  for (i = 0; i < N_BUCKETS; i++) {
+    seen += stats->ages[i];
+    if (seen >= rank)
+      return MIN (G_GUINT64_CONSTANT (1) << i, stats->age_max);
+  }
+  return stats->age_max;
+}
+
+/*
+ * Get the element/bin owning the pad.
+ *
+ * in: a normal pad
+ * out: the element
+ *
+ * in: a proxy pad
+ * out: the element that contains the peer of the proxy
+ *
+ * in: a ghost pad
+ * out: the bin owning the ghostpad
+ */
+static GstElement *
+get_real_pad_parent (GstPad * pad)
+{
+  GstObject *parent;
+
+  if (!pad)
+    return NULL;
+
+  parent = GST_OBJECT_PARENT (pad);
+
+  /* if parent of pad is a ghost-pad, then pad is a proxy_pad */
+  if (parent && GST_IS_GHOST_PAD (parent)) {
+    pad = GST_PAD_CAST (parent);
+    parent = GST_OBJECT_PARENT (pad);
+  }
+  return GST_ELEMENT_CAST (parent);
+}
+
+/* call with the lock */
+static void
+log_pool_stats (GstPoolStats * stats)
+{
+  GstAllocationStats astats;
+
+  if (stats->acquired == 0)
+    return;
+
+  gst_buffer_pool_get_stats (stats->pool, &astats);
+  gst_tracer_record_log (tr_pool, stats->name, stats->acquired,
+      stats->max_outstanding, stats->stalls,
+      stats->wait_total / stats->acquired, stats->wait_max,
+      get_age_percentile (stats, 50), get_age_percentile (stats, 90),
+      stats->age_max, astats.allocated, astats.failed, astats.peak_bytes,
+      astats.alloc_time);
+}
+
+static void
+log_allocator_stats (GstAllocator * allocator)
+{
+  GstAllocationStats astats;
+
+  if (!gst_allocator_get_stats (allocator, &astats) || astats.allocated == 0)
+    return;
+
+  gst_tracer_record_log (tr_allocator, GST_OBJECT_NAME (allocator),
+      astats.allocated, astats.freed, astats.failed, astats.live_bytes,
+      astats.peak_bytes, astats.alloc_time);
+}
+
+/* call with the lock */
+static void
+track_allocator (GstPoolStatsTracer * self, GstAllocator * allocator)
+{
+  if (!allocator || g_hash_table_contains (self->allocators, allocator))
+    return;
+
+  gst_allocator_set_stats_enabled (allocator, TRUE);
+  g_hash_table_add (self->allocators, gst_object_ref (allocator));
+}
+
+static void
+pool_finalized (GstPoolStatsTracer * self, GObject * pool)
+{
+  GstPoolStats *stats;
+
+  g_mutex_lock (&self->lock);
+  if ((stats = g_hash_table_lookup (self->pools, pool))) {
+    log_pool_stats (stats);
+    g_hash_table_remove (self->pools, pool);
+  }
+  g_mutex_unlock (&self->lock);
+}
+
+/* call with the lock */
+static GstPoolStats *
+get_pool_stats (GstPoolStatsTracer * self, GstBufferPool * pool)
+{
+  GstPoolStats *stats;
+
+  if (!(stats = g_hash_table_lookup (self->pools, pool))) {
+    GstStructure *config;
+    GstAllocator *allocator = NULL;
+
+    config = gst_buffer_pool_get_config (pool);
+    if (gst_buffer_pool_config_get_allocator (config, &allocator, NULL))
+      track_allocator (self, allocator);
+    gst_structure_free (config);
+
+    stats = g_slice_new0 (GstPoolStats);
+    stats->pool = pool;
+    stats->name = g_strdup (GST_OBJECT_NAME (pool));
+    g_object_weak_ref ((GObject *) pool, (GWeakNotify) pool_finalized, self);
+    g_hash_table_insert (self->pools, pool, stats);
+  }
+  return stats;
+}
+
+/* call with the lock */
+static GstPoolBuffer *
+get_oldest_buffer (GstPoolStatsTracer * self, GstPoolStats * stats)
+{
+  GHashTableIter iter;
+  GstPoolBuffer *buf, *oldest = NULL;
+
+  g_hash_table_iter_init (&iter, self->buffers);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer *) & buf)) {
+    if (buf->stats == stats && (!oldest || buf->acquired < oldest->acquired))
+      oldest = buf;
+  }
+  return oldest;
+}
+
+static void
+set_holder (GstPoolStatsTracer * self, GstBuffer * buffer,
+    GstElement * element)
+{
+  GstPoolBuffer *buf;
+
+  if (!element)
+    return;
+
+  g_mutex_lock (&self->lock);
+  if ((buf = g_hash_table_lookup (self->buffers, buffer)) &&
+      buf->holder != element) {
+    buf->holder = element;
+    buf->holder_name = g_quark_from_string (GST_OBJECT_NAME (element));
+  }
+  g_mutex_unlock (&self->lock);
+}
+
+/* hooks */
+
+static void
+do_acquire_pre (GstPoolStatsTracer * self, guint64 ts, GstBufferPool * pool)
+{
+  GstClockTime *start;
+
+  if (!(start = g_private_get (&acquire_key))) {
+    start = g_new (GstClockTime, 1);
+    g_private_set (&acquire_key, start);
+  }
+  *start = ts;
+}
+
+static void
+do_acquire_post (GstPoolStatsTracer * self, guint64 ts, GstBufferPool * pool,
+    GstBuffer * buffer, GstFlowReturn res)
+{
+  GstClockTime *start = g_private_get (&acquire_key);
+  GstClockTime wait = start ? GST_CLOCK_DIFF (*start, ts) : 0;
+  GstPoolStats *stats;
+  GstPoolBuffer *buf;
+
+  g_mutex_lock (&self->lock);
+  stats = get_pool_stats (self, pool);
+  stats->wait_total += wait;
+  stats->wait_max = MAX (stats->wait_max, wait);
+
+  if (wait >= STALL_TIME) {
+    GstPoolBuffer *oldest = get_oldest_buffer (self, stats);
+
+    stats->stalls++;
+    gst_tracer_record_log (tr_stall, stats->name, wait, stats->outstanding,
+        (oldest && oldest->holder_name) ?
+        g_quark_to_string (oldest->holder_name) : "",
+        oldest ? GST_CLOCK_DIFF (oldest->acquired, ts) : 0);
+  }
+
+  if (buffer) {
+    stats->acquired++;
+    stats->outstanding++;
+    stats->max_outstanding = MAX (stats->max_outstanding, stats->outstanding);
+
+    buf = g_slice_new0 (GstPoolBuffer);
+    buf->stats = stats;
+    buf->acquired = ts;
+    g_hash_table_replace (self->buffers, buffer, buf);
+  }
+  g_mutex_unlock (&self->lock);
+}
+
+static void
+do_release (GstPoolStatsTracer * self, guint64 ts, GstBufferPool * pool,
+    GstBuffer * buffer)
+{
+  GstPoolBuffer *buf;
+
+  g_mutex_lock (&self->lock);
+  if ((buf = g_hash_table_lookup (self->buffers, buffer))) {
+    GstPoolStats *stats = buf->stats;
+    GstClockTime age = GST_CLOCK_DIFF (buf->acquired, ts);
+
+    stats->outstanding--;
+    stats->released++;
+    stats->age_max = MAX (stats->age_max, age);
+    stats->ages[age ? g_bit_storage (age) - 1 : 0]++;
+    g_hash_table_remove (self->buffers, buffer);
+  }
+  g_mutex_unlock (&self->lock);
+}
+
+static void
+do_mini_object_free (GstPoolStatsTracer * self, guint64 ts,
+    GstMiniObject * object)
+{
+  GstPoolBuffer *buf;
+
+  if (GST_MINI_OBJECT_TYPE (object) != GST_TYPE_BUFFER)
+    return;
+
+  /* a buffer that was freed without going back to its pool */
+  g_mutex_lock (&self->lock);
+  if ((buf = g_hash_table_lookup (self->buffers, object))) {
+    buf->stats->outstanding--;
+    g_hash_table_remove (self->buffers, object);
+  }
+  g_mutex_unlock (&self->lock);
+}
+
+static void
+do_push_buffer_pre (GstPoolStatsTracer * self, guint64 ts, GstPad * pad,
+    GstBuffer * buffer)
+{
+  set_holder (self, buffer, get_real_pad_parent (GST_PAD_PEER (pad)));
+}
+
+static void
+do_push_buffer_list_pre (GstPoolStatsTracer * self, guint64 ts, GstPad * pad,
+    GstBufferList * list)
+{
+  GstElement *element = get_real_pad_parent (GST_PAD_PEER (pad));
+  guint i, len = gst_buffer_list_length (list);
+
+  for (i = 0; i < len; i++)
+    set_holder (self, gst_buffer_list_get (list, i), element);
+}
+
+static void
+do_pull_range_post (GstPoolStatsTracer * self, guint64 ts, GstPad * pad,
+    GstBuffer * buffer, GstFlowReturn res)
+{
+  if (buffer)
+    set_holder (self, buffer, get_real_pad_parent (pad));
+}
+
+/* tracer class */
+
+static void
+free_pool_stats (GstPoolStats * stats)
+{
+  g_free (stats->name);
+  g_slice_free (GstPoolStats, stats);
+}
+
+static void
+free_pool_buffer (GstPoolBuffer * buf)
+{
+  g_slice_free (GstPoolBuffer, buf);
+}
+
+static void
+gst_poolstats_tracer_finalize (GObject * obj)
+{
+  GstPoolStatsTracer *self = GST_POOLSTATS_TRACER (obj);
+  GHashTableIter iter;
+  GstPoolStats *stats;
+
+  /* final report for the pools that are still alive */
+  g_hash_table_iter_init (&iter, self->pools);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer *) & stats)) {
+    g_object_weak_unref ((GObject *) stats->pool,
+        (GWeakNotify) pool_finalized, self);
+    log_pool_stats (stats);
+  }
+  g_hash_table_foreach (self->allocators, (GHFunc) log_allocator_stats, NULL);
+  g_hash_table_destroy (self->allocators);
+  g_hash_table_destroy (self->buffers);
+  g_hash_table_destroy (self->pools);
+  g_mutex_clear (&self->lock);
+
+  G_OBJECT_CLASS (parent_class)->finalize (obj);
+}
+
+static void
+gst_poolstats_tracer_class_init (GstPoolStatsTracerClass * klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+  gobject_class->finalize = gst_poolstats_tracer_finalize;
+
+  /* announce trace formats */
+  /* *INDENT-OFF* */
+  tr_pool = gst_tracer_record_new ("buffer-pool.class",
+      "pool", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_STRING,
+          "description", G_TYPE_STRING, "name of the buffer pool",
+          NULL),
+      "acquired", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT64,
+          "description", G_TYPE_STRING, "number of acquired buffers",
+          "flags", GST_TYPE_TRACER_VALUE_FLAGS, GST_TRACER_VALUE_FLAGS_AGGREGATED,
+          NULL),
+      "max-outstanding", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT,
+          "description", G_TYPE_STRING, "maximum number of buffers out of the pool",
+          "flags", GST_TYPE_TRACER_VALUE_FLAGS, GST_TRACER_VALUE_FLAGS_AGGREGATED,
+          NULL),
+      "stalls", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT64,
+          "description", G_TYPE_STRING, "number of acquires that blocked for more than 20ms",
+          "flags", GST_TYPE_TRACER_VALUE_FLAGS, GST_TRACER_VALUE_FLAGS_AGGREGATED,
+          NULL),
+      "wait-avg", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT64,
+          "description", G_TYPE_STRING, "average time in ns spent in acquire",
+          "flags", GST_TYPE_TRACER_VALUE_FLAGS, GST_TRACER_VALUE_FLAGS_AGGREGATED,
+          NULL),
+      "wait-max", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT64,
+          "description", G_TYPE_STRING, "maximum time in ns spent in acquire",
+          "flags", GST_TYPE_TRACER_VALUE_FLAGS, GST_TRACER_VALUE_FLAGS_AGGREGATED,
+          NULL),
+      "age-p50", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT64,
+          "description", G_TYPE_STRING, "median time in ns a buffer was out of the pool",
+          "flags", GST_TYPE_TRACER_VALUE_FLAGS, GST_TRACER_VALUE_FLAGS_AGGREGATED,
+          NULL),
+      "age-p90", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT64,
+          "description", G_TYPE_STRING, "90th percentile of the time in ns a buffer was out of the pool",
+          "flags", GST_TYPE_TRACER_VALUE_FLAGS, GST_TRACER_VALUE_FLAGS_AGGREGATED,
+          NULL),
+      "age-max", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT64,
+          "description", G_TYPE_STRING, "maximum time in ns a buffer was out of the pool",
+          "flags", GST_TYPE_TRACER_VALUE_FLAGS, GST_TRACER_VALUE_FLAGS_AGGREGATED,
+          NULL),
+      "allocated", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT64,
+          "description", G_TYPE_STRING, "number of buffers allocated by the pool",
+          "flags", GST_TYPE_TRACER_VALUE_FLAGS, GST_TRACER_VALUE_FLAGS_AGGREGATED,
+          NULL),
+      "alloc-failed", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT64,
+          "description", G_TYPE_STRING, "number of failed buffer allocations",
+          "flags", GST_TYPE_TRACER_VALUE_FLAGS, GST_TRACER_VALUE_FLAGS_AGGREGATED,
+          NULL),
+      "peak-bytes", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT64,
+          "description", G_TYPE_STRING, "maximum number of bytes in buffers of the pool",
+          "flags", GST_TYPE_TRACER_VALUE_FLAGS, GST_TRACER_VALUE_FLAGS_AGGREGATED,
+          NULL),
+      "alloc-time", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT64,
+          "description", G_TYPE_STRING, "total time in ns spent allocating buffers",
+          "flags", GST_TYPE_TRACER_VALUE_FLAGS, GST_TRACER_VALUE_FLAGS_AGGREGATED,
+          NULL),
+      NULL);
+  tr_allocator = gst_tracer_record_new ("allocator.class",
+      "allocator", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_STRING,
+          "description", G_TYPE_STRING, "name of the allocator",
+          NULL),
+      "allocated", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT64,
+          "description", G_TYPE_STRING, "number of allocated memory blocks",
+          "flags", GST_TYPE_TRACER_VALUE_FLAGS, GST_TRACER_VALUE_FLAGS_AGGREGATED,
+          NULL),
+      "freed", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT64,
+          "description", G_TYPE_STRING, "number of freed memory blocks",
+          "flags", GST_TYPE_TRACER_VALUE_FLAGS, GST_TRACER_VALUE_FLAGS_AGGREGATED,
+          NULL),
+      "failed", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT64,
+          "description", G_TYPE_STRING, "number of failed allocations",
+          "flags", GST_TYPE_TRACER_VALUE_FLAGS, GST_TRACER_VALUE_FLAGS_AGGREGATED,
+          NULL),
+      "live-bytes", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT64,
+          "description", G_TYPE_STRING, "number of bytes that are still allocated",
+          "flags", GST_TYPE_TRACER_VALUE_FLAGS, GST_TRACER_VALUE_FLAGS_AGGREGATED,
+          NULL),
+      "peak-bytes", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT64,
+          "description", G_TYPE_STRING, "maximum number of allocated bytes",
+          "flags", GST_TYPE_TRACER_VALUE_FLAGS, GST_TRACER_VALUE_FLAGS_AGGREGATED,
+          NULL),
+      "alloc-time", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT64,
+          "description", G_TYPE_STRING, "total time in ns spent allocating",
+          "flags", GST_TYPE_TRACER_VALUE_FLAGS, GST_TRACER_VALUE_FLAGS_AGGREGATED,
+          NULL),
+      NULL);
+  tr_stall = gst_tracer_record_new ("buffer-pool-stall.class",
+      "pool", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_STRING,
+          "description", G_TYPE_STRING, "name of the buffer pool",
+          NULL),
+      "wait", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT64,
+          "description", G_TYPE_STRING, "time in ns spent in acquire",
+          NULL),
+      "outstanding", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT,
+          "description", G_TYPE_STRING, "number of buffers out of the pool",
+          NULL),
+      "oldest-holder", GST_TYPE_STRUCTURE, gst_structure_new ("scope",
+          "type", G_TYPE_GTYPE, G_TYPE_STRING,
+          "related-to", GST_TYPE_TRACER_VALUE_SCOPE, GST_TRACER_VALUE_SCOPE_ELEMENT,
+          NULL),
+      "oldest-age", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT64,
+          "description", G_TYPE_STRING, "time in ns the oldest buffer is out of the pool",
+          NULL),
+      NULL);
+  /* *INDENT-ON* */
+}
+
+static void
+gst_poolstats_tracer_init (GstPoolStatsTracer * self)
+{
+  GstTracer *tracer = GST_TRACER (self);
+  GstAllocator *allocator;
+
+  g_mutex_init (&self->lock);
+  self->pools = g_hash_table_new_full (NULL, NULL, NULL,
+      (GDestroyNotify) free_pool_stats);
+  self->buffers = g_hash_table_new_full (NULL, NULL, NULL,
+      (GDestroyNotify) free_pool_buffer);
+  self->allocators = g_hash_table_new_full (NULL, NULL, gst_object_unref,
+      NULL);
+  allocator = gst_allocator_find (NULL);
+  track_allocator (self, allocator);
+  gst_object_unref (allocator);
+
+  gst_tracing_register_hook (tracer, "buffer-pool-acquire-pre",
+      G_CALLBACK (do_acquire_pre));
+  gst_tracing_register_hook (tracer, "buffer-pool-acquire-post",
+      G_CALLBACK (do_acquire_post));
+  gst_tracing_register_hook (tracer, "buffer-pool-release",
+      G_CALLBACK (do_release));
+  gst_tracing_register_hook (tracer, "mini-object-free",
+      G_CALLBACK (do_mini_object_free));
+  gst_tracing_register_hook (tracer, "pad-push-pre",
+      G_CALLBACK (do_push_buffer_pre));
+  gst_tracing_register_hook (tracer, "pad-push-list-pre",
+      G_CALLBACK (do_push_buffer_list_pre));
+  gst_tracing_register_hook (tracer, "pad-pull-range-post",
+      G_CALLBACK (do_pull_range_post));
+}
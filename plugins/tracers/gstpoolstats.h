@@ -0,0 +1,72 @@
+/* GStreamer
+ *
+ * gstpoolstats.h: tracing module that logs buffer pool stats
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __GST_POOLSTATS_TRACER_H__
+#define __GST_POOLSTATS_TRACER_H__
+
+#include <gst/gst.h>
+#include <gst/gsttracer.h>
+
+G_BEGIN_DECLS
+
+#define GST_TYPE_POOLSTATS_TRACER \
+  (gst_poolstats_tracer_get_type())
+#define GST_POOLSTATS_TRACER(obj) \
+  (G_TYPE_CHECK_INSTANCE_CAST((obj),GST_TYPE_POOLSTATS_TRACER,GstPoolStatsTracer))
+#define GST_POOLSTATS_TRACER_CLASS(klass) \
+  (G_TYPE_CHECK_CLASS_CAST((klass),GST_TYPE_POOLSTATS_TRACER,GstPoolStatsTracerClass))
+#define GST_IS_POOLSTATS_TRACER(obj) \
+  (G_TYPE_CHECK_INSTANCE_TYPE((obj),GST_TYPE_POOLSTATS_TRACER))
+#define GST_IS_POOLSTATS_TRACER_CLASS(klass) \
+  (G_TYPE_CHECK_CLASS_TYPE((klass),GST_TYPE_POOLSTATS_TRACER))
+#define GST_POOLSTATS_TRACER_CAST(obj) ((GstPoolStatsTracer *)(obj))
+
+typedef struct _GstPoolStatsTracer GstPoolStatsTracer;
+typedef struct _GstPoolStatsTracerClass GstPoolStatsTracerClass;
+
+/**
+ * GstPoolStatsTracer:
+ *
+ * Opaque #GstPoolStatsTracer data structure
+ */
+struct _GstPoolStatsTracer {
+  GstTracer 	 parent;
+
+  /*< private >*/
+  GMutex lock;
+  /* GstBufferPool -> GstPoolStats, as long as the pool is alive */
+  GHashTable *pools;
+  /* outstanding GstBuffer -> GstPoolBuffer */
+  GHashTable *buffers;
+  /* GstAllocator with enabled statistics, a ref is held */
+  GHashTable *allocators;
+};
+
+struct _GstPoolStatsTracerClass {
+  GstTracerClass parent_class;
+
+  /* signals */
+};
+
+G_GNUC_INTERNAL GType gst_poolstats_tracer_get_type (void);
+
+G_END_DECLS
+
+#endif /* __GST_POOLSTATS_TRACER_H__ */
@@ -0,0 +1,389 @@
+/* GStreamer
+ *
+ * gstproctime.c: tracing module that logs per element processing time stats
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+/**
+ * SECTION:gstproctime
+ * @short_description: log per element processing time stats
+ *
+ * A tracing module that measures how long each element takes to process a
+ * buffer. The time between a buffer arriving on a sink pad of an element
+ * and the chain function returning is accounted to the element, minus the
+ * time spent in the elements downstream of it while it pushed. In pull mode
+ * the same is done for the getrange function. Elements that push one input
+ * buffer to several src pads, like tee, are thus only charged for their own
+ * work.
+ *
+ * The min, average, max and 50th, 90th and 99th percentile are logged for
+ * each element when it goes from PAUSED to READY and when the tracer is
+ * shut down.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include "gstproctime.h"
+
+GST_DEBUG_CATEGORY_STATIC (gst_proctime_debug);
+#define GST_CAT_DEFAULT gst_proctime_debug
+
+#define _do_init \
+    GST_DEBUG_CATEGORY_INIT (gst_proctime_debug, "proctime", 0, "proctime tracer");
+#define gst_proctime_tracer_parent_class parent_class
+G_DEFINE_TYPE_WITH_CODE (GstProcTimeTracer, gst_proctime_tracer,
+    GST_TYPE_TRACER, _do_init);
+
+static GQuark data_quark;
+
+static GstTracerRecord *tr_proctime;
+
+/* the histogram has 8 buckets per power of two, which gives the
+ * percentiles a resolution of 12.5% */
+#define SUB_BUCKETS 8
+#define N_BUCKETS ((64 - 3) * SUB_BUCKETS + SUB_BUCKETS)
+
+typedef struct
+{
+  gchar *name;
+  guint64 count;
+  guint64 reported;
+  GstClockTime min;
+  GstClockTime max;
+  GstClockTime sum;
+  guint64 buckets[N_BUCKETS];
+} GstProcTimeStats;
+
+/* an element that is processing a buffer in the current thread */
+typedef struct
+{
+  GstProcTimeStats *stats;      /* NULL for bins */
+  GstClockTime start;
+  /* time spent downstream while this element was pushing */
+  GstClockTime downstream;
+} GstProcTimeFrame;
+
+static void
+free_frames (GArray * frames)
+{
+  g_array_free (frames, TRUE);
+}
+
+static GPrivate frames_key = G_PRIVATE_INIT ((GDestroyNotify) free_frames);
+
+/* data helpers */
+
+static guint
+get_bucket (GstClockTime t)
+{
+  guint msb;
+
+  if (t < SUB_BUCKETS)
+    return t;
+
+  msb = g_bit_storage (t) - 1;
+  return (msb - 2) * SUB_BUCKETS + ((t >> (msb - 3)) & (SUB_BUCKETS - 1));
+}
+
+static GstClockTime
+get_bucket_start (guint bucket)
+{
+  guint msb;
+
+  if (bucket < SUB_BUCKETS)
+    return bucket;
+
+  msb = bucket / SUB_BUCKETS + 2;
+  return (guint64) (SUB_BUCKETS + bucket % SUB_BUCKETS) << (msb - 3);
+}
+
+static GstClockTime
+get_percentile (GstProcTimeStats * stats, guint percent)
+{
+  guint64 rank, seen = 0;
+  guint i;
+
+  rank = (stats->count * percent + 99) / 100;
+  for (i = 0; i < N_BUCKETS; i++) {
+    seen += stats->buckets[i];
+    if (seen >= rank)
+      return CLAMP (get_bucket_start (i), stats->min, stats->max);
+  }
+  return stats->max;
+}
+
+/*
+ * Get the element/bin owning the pad.
+ *
+ * in: a normal pad
+ * out: the element
+ *
+ * in: a proxy pad
+ * out: the element that contains the peer of the proxy
+ *
+ * in: a ghost pad
+ * out: the bin owning the ghostpad
+ */
+static GstElement *
+get_real_pad_parent (GstPad * pad)
+{
+  GstObject *parent;
+
+  if (!pad)
+    return NULL;
+
+  parent = GST_OBJECT_PARENT (pad);
+
+  /* if parent of pad is a ghost-pad, then pad is a proxy_pad */
+  if (parent && GST_IS_GHOST_PAD (parent)) {
+    pad = GST_PAD_CAST (parent);
+    parent = GST_OBJECT_PARENT (pad);
+  }
+  return GST_ELEMENT_CAST (parent);
+}
+
+/* call with the lock */
+static GstProcTimeStats *
+get_element_stats (GstProcTimeTracer * self, GstElement * element)
+{
+  GstProcTimeStats *stats;
+
+  if (!(stats = g_object_get_qdata ((GObject *) element, data_quark))) {
+    stats = g_slice_new0 (GstProcTimeStats);
+    stats->name = g_strdup (GST_OBJECT_NAME (element));
+    stats->min = GST_CLOCK_TIME_NONE;
+    /* owned by the tracer, the element might go away before the report */
+    g_object_set_qdata ((GObject *) element, data_quark, stats);
+    self->stats = g_list_prepend (self->stats, stats);
+  }
+  return stats;
+}
+
+/* call with the lock */
+static void
+log_stats (GstProcTimeStats * stats)
+{
+  if (stats->count == stats->reported)
+    return;
+
+  gst_tracer_record_log (tr_proctime, stats->name, stats->count, stats->min,
+      stats->sum / stats->count, stats->max, get_percentile (stats, 50),
+      get_percentile (stats, 90), get_percentile (stats, 99));
+  stats->reported = stats->count;
+}
+
+/* hooks */
+
+static void
+do_enter (GstProcTimeTracer * self, guint64 ts, GstPad * pad)
+{
+  GstElement *parent = get_real_pad_parent (pad);
+  GArray *frames;
+  GstProcTimeFrame frame;
+
+  if (!(frames = g_private_get (&frames_key))) {
+    frames = g_array_new (FALSE, FALSE, sizeof (GstProcTimeFrame));
+    g_private_set (&frames_key, frames);
+  }
+
+  frame.stats = NULL;
+  if (parent && !GST_IS_BIN (parent)) {
+    g_mutex_lock (&self->lock);
+    frame.stats = get_element_stats (self, parent);
+    g_mutex_unlock (&self->lock);
+  }
+  frame.start = ts;
+  frame.downstream = 0;
+  g_array_append_val (frames, frame);
+}
+
+static void
+do_leave (GstProcTimeTracer * self, guint64 ts)
+{
+  GArray *frames = g_private_get (&frames_key);
+  GstProcTimeFrame *frame;
+  GstClockTime total, t;
+
+  if (!frames || frames->len == 0)
+    return;
+
+  frame = &g_array_index (frames, GstProcTimeFrame, frames->len - 1);
+  total = GST_CLOCK_DIFF (frame->start, ts);
+
+  if (frame->stats) {
+    GstProcTimeStats *stats = frame->stats;
+
+    t = total > frame->downstream ? total - frame->downstream : 0;
+
+    g_mutex_lock (&self->lock);
+    stats->count++;
+    stats->sum += t;
+    stats->min = MIN (stats->min, t);
+    stats->max = MAX (stats->max, t);
+    stats->buckets[get_bucket (t)]++;
+    g_mutex_unlock (&self->lock);
+  }
+  g_array_set_size (frames, frames->len - 1);
+
+  /* the upstream element was waiting for us */
+  if (frames->len > 0)
+    g_array_index (frames, GstProcTimeFrame, frames->len - 1).downstream +=
+        total;
+}
+
+static void
+do_push_buffer_pre (GstProcTimeTracer * self, guint64 ts, GstPad * pad)
+{
+  do_enter (self, ts, GST_PAD_PEER (pad));
+}
+
+static void
+do_push_buffer_post (GstProcTimeTracer * self, guint64 ts, GstPad * pad)
+{
+  do_leave (self, ts);
+}
+
+static void
+do_pull_range_pre (GstProcTimeTracer * self, guint64 ts, GstPad * pad)
+{
+  do_enter (self, ts, GST_PAD_PEER (pad));
+}
+
+static void
+do_pull_range_post (GstProcTimeTracer * self, guint64 ts, GstPad * pad)
+{
+  do_leave (self, ts);
+}
+
+static void
+do_element_change_state_post (GstProcTimeTracer * self, guint64 ts,
+    GstElement * element, GstStateChange transition,
+    GstStateChangeReturn result)
+{
+  GstProcTimeStats *stats;
+
+  if (transition != GST_STATE_CHANGE_PAUSED_TO_READY)
+    return;
+
+  g_mutex_lock (&self->lock);
+  if ((stats = g_object_get_qdata ((GObject *) element, data_quark)))
+    log_stats (stats);
+  g_mutex_unlock (&self->lock);
+}
+
+/* tracer class */
+
+static void
+free_stats (GstProcTimeStats * stats)
+{
+  g_free (stats->name);
+  g_slice_free (GstProcTimeStats, stats);
+}
+
+static void
+gst_proctime_tracer_finalize (GObject * obj)
+{
+  GstProcTimeTracer *self = GST_PROCTIME_TRACER (obj);
+  GList *l;
+
+  /* final report */
+  for (l = self->stats; l; l = l->next)
+    log_stats (l->data);
+  g_list_free_full (self->stats, (GDestroyNotify) free_stats);
+  g_mutex_clear (&self->lock);
+
+  G_OBJECT_CLASS (parent_class)->finalize (obj);
+}
+
+static void
+gst_proctime_tracer_class_init (GstProcTimeTracerClass * klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+  gobject_class->finalize = gst_proctime_tracer_finalize;
+
+  data_quark = g_quark_from_static_string ("gstproctime:data");
+
+  /* announce trace formats */
+  /* *INDENT-OFF* */
+  tr_proctime = gst_tracer_record_new ("proctime.class",
+      "element", GST_TYPE_STRUCTURE, gst_structure_new ("scope",
+          "type", G_TYPE_GTYPE, G_TYPE_STRING,
+          "related-to", GST_TYPE_TRACER_VALUE_SCOPE, GST_TRACER_VALUE_SCOPE_ELEMENT,
+          NULL),
+      "count", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT64,
+          "description", G_TYPE_STRING, "number of processed buffers",
+          "flags", GST_TYPE_TRACER_VALUE_FLAGS, GST_TRACER_VALUE_FLAGS_AGGREGATED,
+          NULL),
+      "min", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT64,
+          "description", G_TYPE_STRING, "minimum processing time in ns",
+          "flags", GST_TYPE_TRACER_VALUE_FLAGS, GST_TRACER_VALUE_FLAGS_AGGREGATED,
+          NULL),
+      "avg", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT64,
+          "description", G_TYPE_STRING, "average processing time in ns",
+          "flags", GST_TYPE_TRACER_VALUE_FLAGS, GST_TRACER_VALUE_FLAGS_AGGREGATED,
+          NULL),
+      "max", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT64,
+          "description", G_TYPE_STRING, "maximum processing time in ns",
+          "flags", GST_TYPE_TRACER_VALUE_FLAGS, GST_TRACER_VALUE_FLAGS_AGGREGATED,
+          NULL),
+      "p50", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT64,
+          "description", G_TYPE_STRING, "median processing time in ns",
+          "flags", GST_TYPE_TRACER_VALUE_FLAGS, GST_TRACER_VALUE_FLAGS_AGGREGATED,
+          NULL),
+      "p90", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT64,
+          "description", G_TYPE_STRING, "90th percentile processing time in ns",
+          "flags", GST_TYPE_TRACER_VALUE_FLAGS, GST_TRACER_VALUE_FLAGS_AGGREGATED,
+          NULL),
+      "p99", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT64,
+          "description", G_TYPE_STRING, "99th percentile processing time in ns",
+          "flags", GST_TYPE_TRACER_VALUE_FLAGS, GST_TRACER_VALUE_FLAGS_AGGREGATED,
+          NULL),
+      NULL);
+  /* *INDENT-ON* */
+}
+
+static void
+gst_proctime_tracer_init (GstProcTimeTracer * self)
+{
+  GstTracer *tracer = GST_TRACER (self);
+
+  g_mutex_init (&self->lock);
+
+  gst_tracing_register_hook (tracer, "pad-push-pre",
+      G_CALLBACK (do_push_buffer_pre));
+  gst_tracing_register_hook (tracer, "pad-push-list-pre",
+      G_CALLBACK (do_push_buffer_pre));
+  gst_tracing_register_hook (tracer, "pad-push-post",
+      G_CALLBACK (do_push_buffer_post));
+  gst_tracing_register_hook (tracer, "pad-push-list-post",
+      G_CALLBACK (do_push_buffer_post));
+  gst_tracing_register_hook (tracer, "pad-pull-range-pre",
+      G_CALLBACK (do_pull_range_pre));
+  gst_tracing_register_hook (tracer, "pad-pull-range-post",
+      G_CALLBACK (do_pull_range_post));
+  gst_tracing_register_hook (tracer, "element-change-state-post",
+      G_CALLBACK (do_element_change_state_post));
+}
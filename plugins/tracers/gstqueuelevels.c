@@ -0,0 +1,394 @@
+/* GStreamer
+ *
+ * gstqueuelevels.c: tracing module that logs queue fill levels
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+/**
+ * SECTION:gstqueuelevels
+ * @short_description: log queue fill levels and blocking times
+ *
+ * A tracing module that follows the fill level of queue, queue2 and each
+ * single queue of a multiqueue. The level is logged as a "queue-level" entry
+ * at most every 10ms per queue while it changes, and whenever the queue
+ * runs full or empty. This gives a time series of the fill levels.
+ *
+ * For each queue the time that upstream was blocked on a full queue and the
+ * time that downstream waited on an empty queue are accumulated. These are
+ * logged, together with the number of overruns, underruns and leaked items
+ * and the maximum levels, as a "queue-stats" entry when the queue goes from
+ * PAUSED to READY and when the tracer is shut down. In a deep pipeline the
+ * bottleneck is the stage after the last queue that blocks upstream and
+ * before the first queue that starves downstream.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include "gstqueuelevels.h"
+
+GST_DEBUG_CATEGORY_STATIC (gst_queuelevels_debug);
+#define GST_CAT_DEFAULT gst_queuelevels_debug
+
+#define _do_init \
+    GST_DEBUG_CATEGORY_INIT (gst_queuelevels_debug, "queuelevels", 0, "queuelevels tracer");
+#define gst_queuelevels_tracer_parent_class parent_class
+G_DEFINE_TYPE_WITH_CODE (GstQueueLevelsTracer, gst_queuelevels_tracer,
+    GST_TYPE_TRACER, _do_init);
+
+static GQuark data_quark;
+
+static GstTracerRecord *tr_level;
+static GstTracerRecord *tr_stats;
+
+/* minimum time between two level entries of a queue */
+#define LEVEL_INTERVAL (10 * GST_MSECOND)
+
+typedef struct
+{
+  gchar *element;
+  gchar *pad;
+
+  guint buffers;
+  guint bytes;
+  guint64 time;
+  GstClockTime last_logged;
+  gboolean logged;
+
+  guint64 overruns;
+  guint64 underruns;
+  guint64 leaks;
+  /* when the queue ran full or empty */
+  GstClockTime full_since;
+  GstClockTime empty_since;
+  GstClockTime blocked;
+  GstClockTime starved;
+
+  guint max_buffers;
+  guint max_bytes;
+  guint64 max_time;
+  gboolean reported;
+} GstQueueStats;
+
+/* data helpers */
+
+/* call with the lock */
+static GstQueueStats *
+get_queue_stats (GstQueueLevelsTracer * self, GstElement * queue, GstPad * pad)
+{
+  GstQueueStats *stats;
+
+  if (!(stats = g_object_get_qdata ((GObject *) pad, data_quark))) {
+    stats = g_slice_new0 (GstQueueStats);
+    stats->element = g_strdup (GST_OBJECT_NAME (queue));
+    stats->pad = g_strdup (GST_OBJECT_NAME (pad));
+    stats->last_logged = GST_CLOCK_TIME_NONE;
+    stats->full_since = GST_CLOCK_TIME_NONE;
+    stats->empty_since = GST_CLOCK_TIME_NONE;
+    stats->reported = TRUE;
+    /* owned by the tracer, the pad might go away before the report */
+    g_object_set_qdata ((GObject *) pad, data_quark, stats);
+    self->stats = g_list_prepend (self->stats, stats);
+  }
+  return stats;
+}
+
+/* call with the lock */
+static void
+log_level (GstQueueStats * stats, guint64 ts)
+{
+  gst_tracer_record_log (tr_level, ts, stats->element, stats->pad,
+      stats->buffers, stats->bytes, stats->time);
+  stats->last_logged = ts;
+  stats->logged = TRUE;
+}
+
+/* call with the lock */
+static void
+log_stats (GstQueueStats * stats)
+{
+  if (stats->reported)
+    return;
+
+  gst_tracer_record_log (tr_stats, stats->element, stats->pad,
+      stats->overruns, stats->underruns, stats->leaks, stats->blocked,
+      stats->starved, stats->max_buffers, stats->max_bytes, stats->max_time);
+  stats->reported = TRUE;
+}
+
+/* call with the lock */
+static void
+update_level (GstQueueStats * stats, guint64 ts, guint buffers, guint bytes,
+    guint64 time)
+{
+  stats->buffers = buffers;
+  stats->bytes = bytes;
+  stats->time = time;
+  stats->max_buffers = MAX (stats->max_buffers, buffers);
+  stats->max_bytes = MAX (stats->max_bytes, bytes);
+  stats->max_time = MAX (stats->max_time, time);
+  stats->logged = FALSE;
+  stats->reported = FALSE;
+
+  if (!GST_CLOCK_TIME_IS_VALID (stats->last_logged) ||
+      ts >= stats->last_logged + LEVEL_INTERVAL)
+    log_level (stats, ts);
+}
+
+/* hooks */
+
+static void
+do_queue_enqueue (GstQueueLevelsTracer * self, guint64 ts, GstElement * queue,
+    GstPad * pad, guint buffers, guint bytes, guint64 time)
+{
+  GstQueueStats *stats;
+
+  g_mutex_lock (&self->lock);
+  stats = get_queue_stats (self, queue, pad);
+  /* upstream could continue */
+  if (GST_CLOCK_TIME_IS_VALID (stats->full_since)) {
+    stats->blocked += GST_CLOCK_DIFF (stats->full_since, ts);
+    stats->full_since = GST_CLOCK_TIME_NONE;
+  }
+  update_level (stats, ts, buffers, bytes, time);
+  g_mutex_unlock (&self->lock);
+}
+
+static void
+do_queue_dequeue (GstQueueLevelsTracer * self, guint64 ts, GstElement * queue,
+    GstPad * pad, guint buffers, guint bytes, guint64 time)
+{
+  GstQueueStats *stats;
+
+  g_mutex_lock (&self->lock);
+  stats = get_queue_stats (self, queue, pad);
+  /* downstream got data again */
+  if (GST_CLOCK_TIME_IS_VALID (stats->empty_since)) {
+    stats->starved += GST_CLOCK_DIFF (stats->empty_since, ts);
+    stats->empty_since = GST_CLOCK_TIME_NONE;
+  }
+  update_level (stats, ts, buffers, bytes, time);
+  g_mutex_unlock (&self->lock);
+}
+
+static void
+do_queue_underrun (GstQueueLevelsTracer * self, guint64 ts,
+    GstElement * queue, GstPad * pad)
+{
+  GstQueueStats *stats;
+
+  g_mutex_lock (&self->lock);
+  stats = get_queue_stats (self, queue, pad);
+  if (!GST_CLOCK_TIME_IS_VALID (stats->empty_since)) {
+    stats->underruns++;
+    stats->empty_since = ts;
+    stats->reported = FALSE;
+    if (!stats->logged)
+      log_level (stats, ts);
+  }
+  g_mutex_unlock (&self->lock);
+}
+
+static void
+do_queue_overrun (GstQueueLevelsTracer * self, guint64 ts,
+    GstElement * queue, GstPad * pad)
+{
+  GstQueueStats *stats;
+
+  g_mutex_lock (&self->lock);
+  stats = get_queue_stats (self, queue, pad);
+  if (!GST_CLOCK_TIME_IS_VALID (stats->full_since)) {
+    stats->overruns++;
+    stats->full_since = ts;
+    stats->reported = FALSE;
+    if (!stats->logged)
+      log_level (stats, ts);
+  }
+  g_mutex_unlock (&self->lock);
+}
+
+static void
+do_queue_leak (GstQueueLevelsTracer * self, guint64 ts, GstElement * queue,
+    GstPad * pad, GstMiniObject * item)
+{
+  GstQueueStats *stats;
+
+  g_mutex_lock (&self->lock);
+  stats = get_queue_stats (self, queue, pad);
+  stats->leaks++;
+  stats->reported = FALSE;
+  /* upstream did not wait, the queue made space by dropping data */
+  stats->full_since = GST_CLOCK_TIME_NONE;
+  g_mutex_unlock (&self->lock);
+}
+
+static void
+do_element_change_state_post (GstQueueLevelsTracer * self, guint64 ts,
+    GstElement * element, GstStateChange transition,
+    GstStateChangeReturn result)
+{
+  GstQueueStats *stats;
+  GList *l;
+
+  if (transition != GST_STATE_CHANGE_PAUSED_TO_READY)
+    return;
+
+  g_mutex_lock (&self->lock);
+  GST_OBJECT_LOCK (element);
+  for (l = element->sinkpads; l; l = l->next) {
+    if ((stats = g_object_get_qdata ((GObject *) l->data, data_quark)))
+      log_stats (stats);
+  }
+  GST_OBJECT_UNLOCK (element);
+  g_mutex_unlock (&self->lock);
+}
+
+/* tracer class */
+
+static void
+free_stats (GstQueueStats * stats)
+{
+  g_free (stats->element);
+  g_free (stats->pad);
+  g_slice_free (GstQueueStats, stats);
+}
+
+static void
+gst_queuelevels_tracer_finalize (GObject * obj)
+{
+  GstQueueLevelsTracer *self = GST_QUEUELEVELS_TRACER (obj);
+  GList *l;
+
+  /* final report */
+  for (l = self->stats; l; l = l->next)
+    log_stats (l->data);
+  g_list_free_full (self->stats, (GDestroyNotify) free_stats);
+  g_mutex_clear (&self->lock);
+
+  G_OBJECT_CLASS (parent_class)->finalize (obj);
+}
+
+static void
+gst_queuelevels_tracer_class_init (GstQueueLevelsTracerClass * klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+  gobject_class->finalize = gst_queuelevels_tracer_finalize;
+
+  data_quark = g_quark_from_static_string ("gstqueuelevels:data");
+
+  /* announce trace formats */
+  /* *INDENT-OFF* */
+  tr_level = gst_tracer_record_new ("queue-level.class",
+      "ts", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT64,
+          "description", G_TYPE_STRING, "event ts",
+          NULL),
+      "element", GST_TYPE_STRUCTURE, gst_structure_new ("scope",
+          "type", G_TYPE_GTYPE, G_TYPE_STRING,
+          "related-to", GST_TYPE_TRACER_VALUE_SCOPE, GST_TRACER_VALUE_SCOPE_ELEMENT,
+          NULL),
+      "pad", GST_TYPE_STRUCTURE, gst_structure_new ("scope",
+          "type", G_TYPE_GTYPE, G_TYPE_STRING,
+          "related-to", GST_TYPE_TRACER_VALUE_SCOPE, GST_TRACER_VALUE_SCOPE_PAD,
+          NULL),
+      "buffers", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT,
+          "description", G_TYPE_STRING, "number of queued buffers",
+          NULL),
+      "bytes", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT,
+          "description", G_TYPE_STRING, "number of queued bytes",
+          NULL),
+      "time", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT64,
+          "description", G_TYPE_STRING, "amount of queued data in ns",
+          NULL),
+      NULL);
+  tr_stats = gst_tracer_record_new ("queue-stats.class",
+      "element", GST_TYPE_STRUCTURE, gst_structure_new ("scope",
+          "type", G_TYPE_GTYPE, G_TYPE_STRING,
+          "related-to", GST_TYPE_TRACER_VALUE_SCOPE, GST_TRACER_VALUE_SCOPE_ELEMENT,
+          NULL),
+      "pad", GST_TYPE_STRUCTURE, gst_structure_new ("scope",
+          "type", G_TYPE_GTYPE, G_TYPE_STRING,
+          "related-to", GST_TYPE_TRACER_VALUE_SCOPE, GST_TRACER_VALUE_SCOPE_PAD,
+          NULL),
+      "overruns", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT64,
+          "description", G_TYPE_STRING, "number of times the queue ran full",
+          "flags", GST_TYPE_TRACER_VALUE_FLAGS, GST_TRACER_VALUE_FLAGS_AGGREGATED,
+          NULL),
+      "underruns", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT64,
+          "description", G_TYPE_STRING, "number of times the queue ran empty",
+          "flags", GST_TYPE_TRACER_VALUE_FLAGS, GST_TRACER_VALUE_FLAGS_AGGREGATED,
+          NULL),
+      "leaks", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT64,
+          "description", G_TYPE_STRING, "number of dropped items",
+          "flags", GST_TYPE_TRACER_VALUE_FLAGS, GST_TRACER_VALUE_FLAGS_AGGREGATED,
+          NULL),
+      "blocked", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT64,
+          "description", G_TYPE_STRING, "time in ns upstream waited on a full queue",
+          "flags", GST_TYPE_TRACER_VALUE_FLAGS, GST_TRACER_VALUE_FLAGS_AGGREGATED,
+          NULL),
+      "starved", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT64,
+          "description", G_TYPE_STRING, "time in ns downstream waited on an empty queue",
+          "flags", GST_TYPE_TRACER_VALUE_FLAGS, GST_TRACER_VALUE_FLAGS_AGGREGATED,
+          NULL),
+      "max-buffers", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT,
+          "description", G_TYPE_STRING, "maximum number of queued buffers",
+          "flags", GST_TYPE_TRACER_VALUE_FLAGS, GST_TRACER_VALUE_FLAGS_AGGREGATED,
+          NULL),
+      "max-bytes", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT,
+          "description", G_TYPE_STRING, "maximum number of queued bytes",
+          "flags", GST_TYPE_TRACER_VALUE_FLAGS, GST_TRACER_VALUE_FLAGS_AGGREGATED,
+          NULL),
+      "max-time", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT64,
+          "description", G_TYPE_STRING, "maximum amount of queued data in ns",
+          "flags", GST_TYPE_TRACER_VALUE_FLAGS, GST_TRACER_VALUE_FLAGS_AGGREGATED,
+          NULL),
+      NULL);
+  /* *INDENT-ON* */
+}
+
+static void
+gst_queuelevels_tracer_init (GstQueueLevelsTracer * self)
+{
+  GstTracer *tracer = GST_TRACER (self);
+
+  g_mutex_init (&self->lock);
+
+  gst_tracing_register_hook (tracer, "queue-enqueue",
+      G_CALLBACK (do_queue_enqueue));
+  gst_tracing_register_hook (tracer, "queue-dequeue",
+      G_CALLBACK (do_queue_dequeue));
+  gst_tracing_register_hook (tracer, "queue-underrun",
+      G_CALLBACK (do_queue_underrun));
+  gst_tracing_register_hook (tracer, "queue-overrun",
+      G_CALLBACK (do_queue_overrun));
+  gst_tracing_register_hook (tracer, "queue-leak",
+      G_CALLBACK (do_queue_leak));
+  gst_tracing_register_hook (tracer, "element-change-state-post",
+      G_CALLBACK (do_element_change_state_post));
+}
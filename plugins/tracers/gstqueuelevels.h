@@ -0,0 +1,68 @@
+/* GStreamer
+ *
+ * gstqueuelevels.h: tracing module that logs queue fill levels
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __GST_QUEUELEVELS_TRACER_H__
+#define __GST_QUEUELEVELS_TRACER_H__
+
+#include <gst/gst.h>
+#include <gst/gsttracer.h>
+
+G_BEGIN_DECLS
+
+#define GST_TYPE_QUEUELEVELS_TRACER \
+  (gst_queuelevels_tracer_get_type())
+#define GST_QUEUELEVELS_TRACER(obj) \
+  (G_TYPE_CHECK_INSTANCE_CAST((obj),GST_TYPE_QUEUELEVELS_TRACER,GstQueueLevelsTracer))
+#define GST_QUEUELEVELS_TRACER_CLASS(klass) \
+  (G_TYPE_CHECK_CLASS_CAST((klass),GST_TYPE_QUEUELEVELS_TRACER,GstQueueLevelsTracerClass))
+#define GST_IS_QUEUELEVELS_TRACER(obj) \
+  (G_TYPE_CHECK_INSTANCE_TYPE((obj),GST_TYPE_QUEUELEVELS_TRACER))
+#define GST_IS_QUEUELEVELS_TRACER_CLASS(klass) \
+  (G_TYPE_CHECK_CLASS_TYPE((klass),GST_TYPE_QUEUELEVELS_TRACER))
+#define GST_QUEUELEVELS_TRACER_CAST(obj) ((GstQueueLevelsTracer *)(obj))
+
+typedef struct _GstQueueLevelsTracer GstQueueLevelsTracer;
+typedef struct _GstQueueLevelsTracerClass GstQueueLevelsTracerClass;
+
+/**
+ * GstQueueLevelsTracer:
+ *
+ * Opaque #GstQueueLevelsTracer data structure
+ */
+struct _GstQueueLevelsTracer {
+  GstTracer 	 parent;
+
+  /*< private >*/
+  GMutex lock;
+  /* all GstQueueStats, they outlive the queues for the final report */
+  GList *stats;
+};
+
+struct _GstQueueLevelsTracerClass {
+  GstTracerClass parent_class;
+
+  /* signals */
+};
+
+G_GNUC_INTERNAL GType gst_queuelevels_tracer_get_type (void);
+
+G_END_DECLS
+
+#endif /* __GST_QUEUELEVELS_TRACER_H__ */
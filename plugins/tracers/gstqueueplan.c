@@ -0,0 +1,536 @@
+/* GStreamer
+ *
+ * gstqueueplan.c: tracing module that logs where to add queues
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+/**
+ * SECTION:gstqueueplan
+ * @short_description: log where to add queues
+ *
+ * A tracing module that measures the processing time of each element, the
+ * same way the proctime tracer does, and uses it to suggest where queues
+ * should be added to spread the work over more threads.
+ *
+ * When a pipeline goes from PAUSED to READY, its elements are grouped into
+ * linear chains of elements that are linked one to one and ran in the same
+ * streaming thread. Every chain is then split into at most as many parts as
+ * there are threads, such that the part doing the most work does as little
+ * as possible. A queueplan record is logged for every split point, naming
+ * the element after which a queue should be added.
+ *
+ * The number of threads defaults to the number of processors and can be
+ * set with the threads parameter, e.g. GST_TRACERS="queueplan(threads=4)".
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include "gstqueueplan.h"
+
+GST_DEBUG_CATEGORY_STATIC (gst_queueplan_debug);
+#define GST_CAT_DEFAULT gst_queueplan_debug
+
+#define _do_init \
+    GST_DEBUG_CATEGORY_INIT (gst_queueplan_debug, "queueplan", 0, "queueplan tracer");
+#define gst_queueplan_tracer_parent_class parent_class
+G_DEFINE_TYPE_WITH_CODE (GstQueuePlanTracer, gst_queueplan_tracer,
+    GST_TYPE_TRACER, _do_init);
+
+static GQuark data_quark;
+
+static GstTracerRecord *tr_queueplan;
+
+/* used for elements that were called from several threads */
+#define MANY_THREADS ((GThread *) GINT_TO_POINTER (1))
+
+typedef struct
+{
+  GstClockTime sum;
+  GThread *thread;
+} GstQueuePlanStats;
+
+/* an element that is processing a buffer in the current thread */
+typedef struct
+{
+  GstQueuePlanStats *stats;     /* NULL for bins */
+  GstClockTime start;
+  /* time spent downstream while this element was pushing */
+  GstClockTime downstream;
+} GstQueuePlanFrame;
+
+static void
+free_frames (GArray * frames)
+{
+  g_array_free (frames, TRUE);
+}
+
+static GPrivate frames_key = G_PRIVATE_INIT ((GDestroyNotify) free_frames);
+
+/* data helpers */
+
+static void
+free_stats (GstQueuePlanStats * stats)
+{
+  g_slice_free (GstQueuePlanStats, stats);
+}
+
+/* see gstproctime.c */
+static GstElement *
+get_real_pad_parent (GstPad * pad)
+{
+  GstObject *parent;
+
+  if (!pad)
+    return NULL;
+
+  parent = GST_OBJECT_PARENT (pad);
+
+  /* if parent of pad is a ghost-pad, then pad is a proxy_pad */
+  if (parent && GST_IS_GHOST_PAD (parent)) {
+    pad = GST_PAD_CAST (parent);
+    parent = GST_OBJECT_PARENT (pad);
+  }
+  return GST_ELEMENT_CAST (parent);
+}
+
+/* call with the lock */
+static GstQueuePlanStats *
+get_element_stats (GstElement * element)
+{
+  GstQueuePlanStats *stats;
+
+  if (!(stats = g_object_get_qdata ((GObject *) element, data_quark))) {
+    stats = g_slice_new0 (GstQueuePlanStats);
+    g_object_set_qdata_full ((GObject *) element, data_quark, stats,
+        (GDestroyNotify) free_stats);
+  }
+  return stats;
+}
+
+/* Get the element that receives the data pushed on @pad, looking through
+ * ghost pads. Does not return bins. */
+static GstElement *
+get_downstream_element (GstPad * pad)
+{
+  GstPad *peer, *next;
+  GstObject *parent;
+  GstElement *element = NULL;
+
+  peer = gst_pad_get_peer (pad);
+  while (peer) {
+    parent = GST_OBJECT_PARENT (peer);
+
+    if (GST_IS_GHOST_PAD (peer)) {
+      /* the sink ghost pad of a bin, go inside */
+      next = gst_ghost_pad_get_target (GST_GHOST_PAD_CAST (peer));
+    } else if (parent && GST_IS_GHOST_PAD (parent)) {
+      /* the internal pad of a src ghost pad, go outside */
+      next = gst_pad_get_peer (GST_PAD_CAST (parent));
+    } else {
+      element = (GstElement *) gst_pad_get_parent (peer);
+      gst_object_unref (peer);
+      break;
+    }
+    gst_object_unref (peer);
+    peer = next;
+  }
+  return element;
+}
+
+/* Get the element following @element in a linear chain, or %NULL */
+static GstElement *
+get_next_in_chain (GstElement * element)
+{
+  GstElement *next = NULL;
+  GstPad *srcpad = NULL;
+
+  GST_OBJECT_LOCK (element);
+  if (element->numsrcpads == 1)
+    srcpad = gst_object_ref (element->srcpads->data);
+  GST_OBJECT_UNLOCK (element);
+
+  if (!srcpad)
+    return NULL;
+
+  next = get_downstream_element (srcpad);
+  gst_object_unref (srcpad);
+
+  if (next && (next->numsinkpads != 1 || GST_IS_BIN (next))) {
+    gst_object_unref (next);
+    next = NULL;
+  }
+  return next;
+}
+
+/* Get the smallest per thread load that @n_costs elements can be split into
+ * with at most @threads parts */
+static GstClockTime
+get_best_load (const GstClockTime * costs, guint n_costs, guint threads)
+{
+  GstClockTime lo = 0, hi = 0, load, mid;
+  guint i, parts;
+
+  for (i = 0; i < n_costs; i++) {
+    lo = MAX (lo, costs[i]);
+    hi += costs[i];
+  }
+
+  /* the biggest element always ends up alone in one thread, search the
+   * smallest load between that and no split at all */
+  while (lo < hi) {
+    mid = lo + (hi - lo) / 2;
+
+    parts = 1;
+    load = 0;
+    for (i = 0; i < n_costs; i++) {
+      if (load + costs[i] > mid) {
+        parts++;
+        load = 0;
+      }
+      load += costs[i];
+    }
+
+    if (parts <= threads)
+      hi = mid;
+    else
+      lo = mid + 1;
+  }
+  return lo;
+}
+
+/* call with the lock */
+static void
+plan_chain (GstQueuePlanTracer * self, GPtrArray * chain)
+{
+  GstQueuePlanStats *stats;
+  GstClockTime *costs, best, total = 0, load = 0;
+  GstElement *element, *next;
+  guint i;
+
+  costs = g_new (GstClockTime, chain->len);
+  for (i = 0; i < chain->len; i++) {
+    stats = g_object_get_qdata (g_ptr_array_index (chain, i), data_quark);
+    costs[i] = stats->sum;
+    total += costs[i];
+  }
+
+  best = get_best_load (costs, chain->len, self->threads);
+  if (best < total) {
+    GST_INFO ("chain of %u elements, %" GST_TIME_FORMAT " in one thread, %"
+        GST_TIME_FORMAT " in %u threads", chain->len, GST_TIME_ARGS (total),
+        GST_TIME_ARGS (best), self->threads);
+
+    for (i = 0; i < chain->len; i++) {
+      if (i > 0 && load + costs[i] > best) {
+        element = g_ptr_array_index (chain, i - 1);
+        next = g_ptr_array_index (chain, i);
+        gst_tracer_record_log (tr_queueplan, GST_OBJECT_NAME (element),
+            GST_OBJECT_NAME (next), load, total, best);
+        load = 0;
+      }
+      load += costs[i];
+    }
+  }
+  g_free (costs);
+}
+
+/* call with the lock */
+static void
+plan_pipeline (GstQueuePlanTracer * self, GstElement * pipeline)
+{
+  GstIterator *it;
+  GValue item = G_VALUE_INIT;
+  GHashTable *next_of, *has_prev;
+  GHashTableIter iter;
+  GstQueuePlanStats *stats, *next_stats;
+  GstElement *element, *next;
+  GPtrArray *chain;
+  gboolean done = FALSE;
+
+  next_of = g_hash_table_new_full (NULL, NULL, gst_object_unref,
+      gst_object_unref);
+  has_prev = g_hash_table_new (NULL, NULL);
+
+  /* link up the elements that ran in the same thread */
+  it = gst_bin_iterate_recurse (GST_BIN_CAST (pipeline));
+  while (!done) {
+    switch (gst_iterator_next (it, &item)) {
+      case GST_ITERATOR_OK:
+        element = g_value_get_object (&item);
+        stats = g_object_get_qdata ((GObject *) element, data_quark);
+        if (!stats || !stats->thread || stats->thread == MANY_THREADS)
+          break;
+        if (!(next = get_next_in_chain (element)))
+          break;
+        next_stats = g_object_get_qdata ((GObject *) next, data_quark);
+        if (next_stats && next_stats->thread == stats->thread) {
+          g_hash_table_insert (next_of, gst_object_ref (element), next);
+          g_hash_table_add (has_prev, next);
+        } else {
+          gst_object_unref (next);
+        }
+        break;
+      case GST_ITERATOR_RESYNC:
+        g_hash_table_remove_all (next_of);
+        g_hash_table_remove_all (has_prev);
+        gst_iterator_resync (it);
+        break;
+      default:
+        done = TRUE;
+        break;
+    }
+    g_value_reset (&item);
+  }
+  g_value_unset (&item);
+  gst_iterator_free (it);
+
+  /* walk all chains from their first element */
+  chain = g_ptr_array_new ();
+  g_hash_table_iter_init (&iter, next_of);
+  while (g_hash_table_iter_next (&iter, (gpointer *) & element, NULL)) {
+    if (g_hash_table_contains (has_prev, element))
+      continue;
+
+    g_ptr_array_set_size (chain, 0);
+    for (; element; element = g_hash_table_lookup (next_of, element))
+      g_ptr_array_add (chain, element);
+    plan_chain (self, chain);
+  }
+  g_ptr_array_free (chain, TRUE);
+
+  g_hash_table_destroy (has_prev);
+  g_hash_table_destroy (next_of);
+}
+
+/* call with the lock */
+static void
+reset_pipeline (GstElement * pipeline)
+{
+  GstIterator *it;
+  GValue item = G_VALUE_INIT;
+  GstQueuePlanStats *stats;
+  gboolean done = FALSE;
+
+  it = gst_bin_iterate_recurse (GST_BIN_CAST (pipeline));
+  while (!done) {
+    switch (gst_iterator_next (it, &item)) {
+      case GST_ITERATOR_OK:
+        stats = g_object_get_qdata (g_value_get_object (&item), data_quark);
+        if (stats) {
+          stats->sum = 0;
+          stats->thread = NULL;
+        }
+        break;
+      case GST_ITERATOR_RESYNC:
+        gst_iterator_resync (it);
+        break;
+      default:
+        done = TRUE;
+        break;
+    }
+    g_value_reset (&item);
+  }
+  g_value_unset (&item);
+  gst_iterator_free (it);
+}
+
+/* hooks */
+
+static void
+do_enter (GstQueuePlanTracer * self, guint64 ts, GstPad * pad)
+{
+  GstElement *parent = get_real_pad_parent (pad);
+  GArray *frames;
+  GstQueuePlanFrame frame;
+  GThread *thread;
+
+  if (!(frames = g_private_get (&frames_key))) {
+    frames = g_array_new (FALSE, FALSE, sizeof (GstQueuePlanFrame));
+    g_private_set (&frames_key, frames);
+  }
+
+  frame.stats = NULL;
+  if (parent && !GST_IS_BIN (parent)) {
+    thread = g_thread_self ();
+
+    g_mutex_lock (&self->lock);
+    frame.stats = get_element_stats (parent);
+    if (!frame.stats->thread)
+      frame.stats->thread = thread;
+    else if (frame.stats->thread != thread)
+      frame.stats->thread = MANY_THREADS;
+    g_mutex_unlock (&self->lock);
+  }
+  frame.start = ts;
+  frame.downstream = 0;
+  g_array_append_val (frames, frame);
+}
+
+static void
+do_leave (GstQueuePlanTracer * self, guint64 ts)
+{
+  GArray *frames = g_private_get (&frames_key);
+  GstQueuePlanFrame *frame;
+  GstClockTime total;
+
+  if (!frames || frames->len == 0)
+    return;
+
+  frame = &g_array_index (frames, GstQueuePlanFrame, frames->len - 1);
+  total = GST_CLOCK_DIFF (frame->start, ts);
+
+  if (frame->stats && total > frame->downstream) {
+    g_mutex_lock (&self->lock);
+    frame->stats->sum += total - frame->downstream;
+    g_mutex_unlock (&self->lock);
+  }
+  g_array_set_size (frames, frames->len - 1);
+
+  /* the upstream element was waiting for us */
+  if (frames->len > 0)
+    g_array_index (frames, GstQueuePlanFrame, frames->len - 1).downstream +=
+        total;
+}
+
+static void
+do_push_buffer_pre (GstQueuePlanTracer * self, guint64 ts, GstPad * pad)
+{
+  do_enter (self, ts, GST_PAD_PEER (pad));
+}
+
+static void
+do_push_buffer_post (GstQueuePlanTracer * self, guint64 ts, GstPad * pad)
+{
+  do_leave (self, ts);
+}
+
+static void
+do_element_change_state_post (GstQueuePlanTracer * self, guint64 ts,
+    GstElement * element, GstStateChange transition,
+    GstStateChangeReturn result)
+{
+  if (transition != GST_STATE_CHANGE_PAUSED_TO_READY ||
+      !GST_IS_PIPELINE (element))
+    return;
+
+  g_mutex_lock (&self->lock);
+  plan_pipeline (self, element);
+  reset_pipeline (element);
+  g_mutex_unlock (&self->lock);
+}
+
+/* tracer class */
+
+static void
+gst_queueplan_tracer_constructed (GObject * obj)
+{
+  GstQueuePlanTracer *self = GST_QUEUEPLAN_TRACER (obj);
+  GstStructure *s;
+  gchar *params, *tmp;
+  gint threads;
+
+  G_OBJECT_CLASS (parent_class)->constructed (obj);
+
+  g_object_get (self, "params", &params, NULL);
+  if (!params)
+    return;
+
+  tmp = g_strdup_printf ("queueplan,%s", params);
+  if ((s = gst_structure_from_string (tmp, NULL))) {
+    if (gst_structure_get_int (s, "threads", &threads) && threads > 0)
+      self->threads = threads;
+    gst_structure_free (s);
+  } else {
+    GST_WARNING_OBJECT (self, "invalid params '%s'", params);
+  }
+  g_free (tmp);
+  g_free (params);
+}
+
+static void
+gst_queueplan_tracer_finalize (GObject * obj)
+{
+  GstQueuePlanTracer *self = GST_QUEUEPLAN_TRACER (obj);
+
+  g_mutex_clear (&self->lock);
+
+  G_OBJECT_CLASS (parent_class)->finalize (obj);
+}
+
+static void
+gst_queueplan_tracer_class_init (GstQueuePlanTracerClass * klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+  gobject_class->constructed = gst_queueplan_tracer_constructed;
+  gobject_class->finalize = gst_queueplan_tracer_finalize;
+
+  data_quark = g_quark_from_static_string ("gstqueueplan:data");
+
+  /* announce trace formats */
+  /* *INDENT-OFF* */
+  tr_queueplan = gst_tracer_record_new ("queueplan.class",
+      "element", GST_TYPE_STRUCTURE, gst_structure_new ("scope",
+          "type", G_TYPE_GTYPE, G_TYPE_STRING,
+          "related-to", GST_TYPE_TRACER_VALUE_SCOPE, GST_TRACER_VALUE_SCOPE_ELEMENT,
+          NULL),
+      "next", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_STRING,
+          "description", G_TYPE_STRING, "the element after the queue",
+          NULL),
+      "load", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT64,
+          "description", G_TYPE_STRING,
+          "processing time in ns of the part of the chain before the queue",
+          "flags", GST_TYPE_TRACER_VALUE_FLAGS, GST_TRACER_VALUE_FLAGS_AGGREGATED,
+          NULL),
+      "chain-load", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT64,
+          "description", G_TYPE_STRING,
+          "processing time in ns of the whole chain",
+          "flags", GST_TYPE_TRACER_VALUE_FLAGS, GST_TRACER_VALUE_FLAGS_AGGREGATED,
+          NULL),
+      "max-load", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT64,
+          "description", G_TYPE_STRING,
+          "processing time in ns of the busiest thread after the split",
+          "flags", GST_TYPE_TRACER_VALUE_FLAGS, GST_TRACER_VALUE_FLAGS_AGGREGATED,
+          NULL),
+      NULL);
+  /* *INDENT-ON* */
+}
+
+static void
+gst_queueplan_tracer_init (GstQueuePlanTracer * self)
+{
+  GstTracer *tracer = GST_TRACER (self);
+
+  g_mutex_init (&self->lock);
+  self->threads = g_get_num_processors ();
+
+  gst_tracing_register_hook (tracer, "pad-push-pre",
+      G_CALLBACK (do_push_buffer_pre));
+  gst_tracing_register_hook (tracer, "pad-push-list-pre",
+      G_CALLBACK (do_push_buffer_pre));
+  gst_tracing_register_hook (tracer, "pad-push-post",
+      G_CALLBACK (do_push_buffer_post));
+  gst_tracing_register_hook (tracer, "pad-push-list-post",
+      G_CALLBACK (do_push_buffer_post));
+  gst_tracing_register_hook (tracer, "element-change-state-post",
+      G_CALLBACK (do_element_change_state_post));
+}
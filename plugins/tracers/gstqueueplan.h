@@ -0,0 +1,68 @@
+/* GStreamer
+ *
+ * gstqueueplan.h: tracing module that logs where to add queues
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __GST_QUEUEPLAN_TRACER_H__
+#define __GST_QUEUEPLAN_TRACER_H__
+
+#include <gst/gst.h>
+#include <gst/gsttracer.h>
+
+G_BEGIN_DECLS
+
+#define GST_TYPE_QUEUEPLAN_TRACER \
+  (gst_queueplan_tracer_get_type())
+#define GST_QUEUEPLAN_TRACER(obj) \
+  (G_TYPE_CHECK_INSTANCE_CAST((obj),GST_TYPE_QUEUEPLAN_TRACER,GstQueuePlanTracer))
+#define GST_QUEUEPLAN_TRACER_CLASS(klass) \
+  (G_TYPE_CHECK_CLASS_CAST((klass),GST_TYPE_QUEUEPLAN_TRACER,GstQueuePlanTracerClass))
+#define GST_IS_QUEUEPLAN_TRACER(obj) \
+  (G_TYPE_CHECK_INSTANCE_TYPE((obj),GST_TYPE_QUEUEPLAN_TRACER))
+#define GST_IS_QUEUEPLAN_TRACER_CLASS(klass) \
+  (G_TYPE_CHECK_CLASS_TYPE((klass),GST_TYPE_QUEUEPLAN_TRACER))
+#define GST_QUEUEPLAN_TRACER_CAST(obj) ((GstQueuePlanTracer *)(obj))
+
+typedef struct _GstQueuePlanTracer GstQueuePlanTracer;
+typedef struct _GstQueuePlanTracerClass GstQueuePlanTracerClass;
+
+/**
+ * GstQueuePlanTracer:
+ *
+ * Opaque #GstQueuePlanTracer data structure
+ */
+struct _GstQueuePlanTracer {
+  GstTracer 	 parent;
+
+  /*< private >*/
+  GMutex lock;
+  /* number of threads to spread a chain over */
+  guint threads;
+};
+
+struct _GstQueuePlanTracerClass {
+  GstTracerClass parent_class;
+
+  /* signals */
+};
+
+G_GNUC_INTERNAL GType gst_queueplan_tracer_get_type (void);
+
+G_END_DECLS
+
+#endif /* __GST_QUEUEPLAN_TRACER_H__ */
@@ -23,6 +23,13 @@
  * @short_description: log resource usage stats
  *
  * A tracing module that take rusage() snapshots and logs them.
+ *
+ * It also reads the cpu time of the streaming thread when a pad pushes to or
+ * pulls from its peer and when that returns. This attributes the cpu time of
+ * a thread to the elements running in it. The inclusive time of an element
+ * contains the time spent in the elements downstream of it, the exclusive
+ * time does not. Both are logged as an "element-rusage" entry when the
+ * element goes from PAUSED to READY and when the tracer is shut down.
  */
 
 #ifdef HAVE_CONFIG_H
@@ -56,7 +63,9 @@ G_DEFINE_TYPE_WITH_CODE (GstRUsageTracer, gst_rusage_tracer, GST_TYPE_TRACER,
 /* number of cpus to scale cpu-usage in threads */
 static glong num_cpus = 1;
 
-static GstTracerRecord *tr_proc, *tr_thread;
+static GstTracerRecord *tr_proc, *tr_thread, *tr_element;
+
+static GQuark data_quark;
 
 typedef struct
 {
@@ -65,6 +74,33 @@ typedef struct
   GstTraceValues *tvs_thread;
 } GstThreadStats;
 
+typedef struct
+{
+  gchar *name;
+  guint64 calls;
+  guint64 reported;
+  /* cpu time including and excluding the elements downstream */
+  GstClockTime inclusive;
+  GstClockTime exclusive;
+} GstElementRUsage;
+
+/* an element running in the current thread */
+typedef struct
+{
+  GstElementRUsage *stats;      /* NULL for bins */
+  GstClockTime start;
+  /* cpu time spent downstream while this element was pushing */
+  GstClockTime downstream;
+} GstRUsageFrame;
+
+static void
+free_frames (GArray * frames)
+{
+  g_array_free (frames, TRUE);
+}
+
+static GPrivate frames_key = G_PRIVATE_INIT ((GDestroyNotify) free_frames);
+
 /* data helper */
 
 static void
@@ -140,6 +176,81 @@ update_trace_value (GstTraceValues * self, GstClockTime nts,
 }
 
 
+static GstClockTime
+get_thread_cpu_time (void)
+{
+#ifdef HAVE_CLOCK_GETTIME
+  struct timespec now;
+
+  if (!clock_gettime (CLOCK_THREAD_CPUTIME_ID, &now))
+    return GST_TIMESPEC_TO_TIME (now);
+#endif
+#ifdef RUSAGE_THREAD
+  {
+    struct rusage ru;
+
+    if (!getrusage (RUSAGE_THREAD, &ru))
+      return GST_TIMEVAL_TO_TIME (ru.ru_utime) +
+          GST_TIMEVAL_TO_TIME (ru.ru_stime);
+  }
+#endif
+  return GST_CLOCK_TIME_NONE;
+}
+
+/* see gstproctime.c */
+static GstElement *
+get_real_pad_parent (GstPad * pad)
+{
+  GstObject *parent;
+
+  if (!pad)
+    return NULL;
+
+  parent = GST_OBJECT_PARENT (pad);
+
+  /* if parent of pad is a ghost-pad, then pad is a proxy_pad */
+  if (parent && GST_IS_GHOST_PAD (parent)) {
+    pad = GST_PAD_CAST (parent);
+    parent = GST_OBJECT_PARENT (pad);
+  }
+  return GST_ELEMENT_CAST (parent);
+}
+
+/* call with the lock */
+static GstElementRUsage *
+get_element_stats (GstRUsageTracer * self, GstElement * element)
+{
+  GstElementRUsage *stats;
+
+  if (!(stats = g_object_get_qdata ((GObject *) element, data_quark))) {
+    stats = g_slice_new0 (GstElementRUsage);
+    stats->name = g_strdup (GST_OBJECT_NAME (element));
+    /* owned by the tracer, the element might go away before the report */
+    g_object_set_qdata ((GObject *) element, data_quark, stats);
+    self->elements = g_list_prepend (self->elements, stats);
+  }
+  return stats;
+}
+
+/* call with the lock */
+static void
+log_element_stats (GstElementRUsage * stats)
+{
+  if (stats->calls == stats->reported)
+    return;
+
+  gst_tracer_record_log (tr_element, stats->name, stats->calls,
+      stats->inclusive, stats->exclusive);
+  stats->reported = stats->calls;
+}
+
+static void
+free_element_stats (GstElementRUsage * stats)
+{
+  g_free (stats->name);
+  g_slice_free (GstElementRUsage, stats);
+}
+
 static void
 free_thread_stats (gpointer data)
 {
@@ -253,16 +364,108 @@ do_stats (GstTracer * obj, guint64 ts)
   /* *INDENT-ON* */
 }
 
+static void
+do_enter (GstRUsageTracer * self, GstPad * pad)
+{
+  GstElement *parent = get_real_pad_parent (pad);
+  GArray *frames;
+  GstRUsageFrame frame;
+
+  if (!GST_CLOCK_TIME_IS_VALID (frame.start = get_thread_cpu_time ()))
+    return;
+
+  if (!(frames = g_private_get (&frames_key))) {
+    frames = g_array_new (FALSE, FALSE, sizeof (GstRUsageFrame));
+    g_private_set (&frames_key, frames);
+  }
+
+  frame.stats = NULL;
+  if (parent && !GST_IS_BIN (parent)) {
+    g_mutex_lock (&self->lock);
+    frame.stats = get_element_stats (self, parent);
+    g_mutex_unlock (&self->lock);
+  }
+  frame.downstream = 0;
+  g_array_append_val (frames, frame);
+}
+
+static void
+do_leave (GstRUsageTracer * self)
+{
+  GArray *frames = g_private_get (&frames_key);
+  GstRUsageFrame *frame;
+  GstClockTime now, total;
+
+  if (!frames || frames->len == 0)
+    return;
+
+  now = get_thread_cpu_time ();
+  frame = &g_array_index (frames, GstRUsageFrame, frames->len - 1);
+  total = now > frame->start ? now - frame->start : 0;
+
+  if (frame->stats) {
+    GstElementRUsage *stats = frame->stats;
+
+    g_mutex_lock (&self->lock);
+    stats->calls++;
+    stats->inclusive += total;
+    stats->exclusive += total > frame->downstream ?
+        total - frame->downstream : 0;
+    g_mutex_unlock (&self->lock);
+  }
+  g_array_set_size (frames, frames->len - 1);
+
+  /* the upstream element was waiting for us */
+  if (frames->len > 0)
+    g_array_index (frames, GstRUsageFrame, frames->len - 1).downstream +=
+        total;
+}
+
+static void
+do_peer_call_pre (GstRUsageTracer * self, guint64 ts, GstPad * pad)
+{
+  do_enter (self, GST_PAD_PEER (pad));
+}
+
+static void
+do_peer_call_post (GstRUsageTracer * self, guint64 ts, GstPad * pad)
+{
+  do_leave (self);
+}
+
+static void
+do_element_change_state_post (GstRUsageTracer * self, guint64 ts,
+    GstElement * element, GstStateChange transition,
+    GstStateChangeReturn result)
+{
+  GstElementRUsage *stats;
+
+  if (transition != GST_STATE_CHANGE_PAUSED_TO_READY)
+    return;
+
+  g_mutex_lock (&self->lock);
+  if ((stats = g_object_get_qdata ((GObject *) element, data_quark)))
+    log_element_stats (stats);
+  g_mutex_unlock (&self->lock);
+}
+
 /* tracer class */
 
 static void
 gst_rusage_tracer_finalize (GObject * obj)
 {
   GstRUsageTracer *self = GST_RUSAGE_TRACER (obj);
+  GList *l;
 
   g_hash_table_destroy (self->threads);
   free_trace_values (self->tvs_proc);
 
+  /* final report */
+  for (l = self->elements; l; l = l->next)
+    log_element_stats (l->data);
+  g_list_free_full (self->elements, (GDestroyNotify) free_element_stats);
+  g_mutex_clear (&self->lock);
+
   G_OBJECT_CLASS (parent_class)->finalize (obj);
 }
 
@@ -282,6 +485,8 @@ gst_rusage_tracer_class_init (GstRUsageTracerClass * klass)
   }
   GST_DEBUG ("rusage: num_cpus=%ld", num_cpus);
 
+  data_quark = g_quark_from_static_string ("gstrusage:data");
+
   /* announce trace formats */
   /* *INDENT-OFF* */
   tr_thread = gst_tracer_record_new ("thread-rusage.class",
@@ -344,6 +549,27 @@ gst_rusage_tracer_class_init (GstRUsageTracerClass * klass)
           "max", G_TYPE_UINT64, G_MAXUINT64,
           NULL),
       NULL);
+  tr_element = gst_tracer_record_new ("element-rusage.class",
+      "element", GST_TYPE_STRUCTURE, gst_structure_new ("scope",
+          "type", G_TYPE_GTYPE, G_TYPE_STRING,
+          "related-to", GST_TYPE_TRACER_VALUE_SCOPE, GST_TRACER_VALUE_SCOPE_ELEMENT,
+          NULL),
+      "calls", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT64,
+          "description", G_TYPE_STRING, "number of times the element was entered",
+          "flags", GST_TYPE_TRACER_VALUE_FLAGS, GST_TRACER_VALUE_FLAGS_AGGREGATED,
+          NULL),
+      "inclusive", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT64,
+          "description", G_TYPE_STRING, "cpu time in ns including the elements downstream",
+          "flags", GST_TYPE_TRACER_VALUE_FLAGS, GST_TRACER_VALUE_FLAGS_AGGREGATED,
+          NULL),
+      "exclusive", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT64,
+          "description", G_TYPE_STRING, "cpu time in ns spent in the element itself",
+          "flags", GST_TYPE_TRACER_VALUE_FLAGS, GST_TRACER_VALUE_FLAGS_AGGREGATED,
+          NULL),
+      NULL);
   /* *INDENT-ON* */
 }
 
@@ -353,6 +579,22 @@ gst_rusage_tracer_init (GstRUsageTracer * self)
   GstTracer *tracer = GST_TRACER (self);
 
   gst_tracing_register_hook (tracer, NULL, G_CALLBACK (do_stats));
+  gst_tracing_register_hook (tracer, "pad-push-pre",
+      G_CALLBACK (do_peer_call_pre));
+  gst_tracing_register_hook (tracer, "pad-push-list-pre",
+      G_CALLBACK (do_peer_call_pre));
+  gst_tracing_register_hook (tracer, "pad-push-post",
+      G_CALLBACK (do_peer_call_post));
+  gst_tracing_register_hook (tracer, "pad-push-list-post",
+      G_CALLBACK (do_peer_call_post));
+  gst_tracing_register_hook (tracer, "pad-pull-range-pre",
+      G_CALLBACK (do_peer_call_pre));
+  gst_tracing_register_hook (tracer, "pad-pull-range-post",
+      G_CALLBACK (do_peer_call_post));
+  gst_tracing_register_hook (tracer, "element-change-state-post",
+      G_CALLBACK (do_element_change_state_post));
+
+  g_mutex_init (&self->lock);
 
   self->threads = g_hash_table_new_full (NULL, NULL, NULL, free_thread_stats);
   self->tvs_proc = make_trace_values (GST_SECOND);
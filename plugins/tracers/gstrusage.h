@@ -69,6 +69,11 @@ struct _GstRUsageTracer {
   /* for ts calibration */
   gpointer main_thread_id;
   guint64 tproc_base;
+
+  /* per element cpu time */
+  GMutex lock;
+  /* all GstElementRUsage, they outlive the elements for the final report */
+  GList *elements;
 };
 
 struct _GstRUsageTracerClass {
@@ -0,0 +1,432 @@
+/* GStreamer
+ *
+ * gststartup.c: tracing module that logs the startup timeline
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+/**
+ * SECTION:gststartup
+ * @short_description: log the startup timeline of pipelines
+ *
+ * A tracing module that logs what happens until the sinks of a pipeline get
+ * their first buffer: plugins being loaded, elements being created, the
+ * upwards state changes of all elements, the sinks completing their preroll
+ * and the first buffer arriving at each sink. Each record names the pipeline
+ * the element is in at that time.
+ *
+ * State changes are logged with their total duration and with the time spent
+ * in the element itself, which excludes the state changes of the children of
+ * a bin and the plugins loaded meanwhile.
+ *
+ * gst-stats collects the records into a timeline for every pipeline and shows
+ * the critical path up to the last sink receiving its first buffer.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include "gststartup.h"
+
+GST_DEBUG_CATEGORY_STATIC (gst_startup_debug);
+#define GST_CAT_DEFAULT gst_startup_debug
+
+#define _do_init \
+    GST_DEBUG_CATEGORY_INIT (gst_startup_debug, "startup", 0, "startup tracer");
+#define gst_startup_tracer_parent_class parent_class
+G_DEFINE_TYPE_WITH_CODE (GstStartupTracer, gst_startup_tracer,
+    GST_TYPE_TRACER, _do_init);
+
+/* set on sinks once they got their first buffer */
+static GQuark data_quark;
+
+static GstTracerRecord *tr_plugin;
+static GstTracerRecord *tr_element;
+static GstTracerRecord *tr_state;
+static GstTracerRecord *tr_mark;
+
+/* a state change or plugin load that is in progress in the current thread */
+typedef struct
+{
+  GstElement *element;          /* NULL for plugins */
+  GstClockTime start;
+  /* time spent in nested state changes and plugin loads */
+  GstClockTime nested;
+} GstStartupFrame;
+
+static void
+free_frames (GArray * frames)
+{
+  g_array_free (frames, TRUE);
+}
+
+static GPrivate frames_key = G_PRIVATE_INIT ((GDestroyNotify) free_frames);
+
+/* data helpers */
+
+static void
+push_frame (GstElement * element, GstClockTime ts)
+{
+  GArray *frames;
+  GstStartupFrame frame;
+
+  if (!(frames = g_private_get (&frames_key))) {
+    frames = g_array_new (FALSE, FALSE, sizeof (GstStartupFrame));
+    g_private_set (&frames_key, frames);
+  }
+
+  frame.element = element;
+  frame.start = ts;
+  frame.nested = 0;
+  g_array_append_val (frames, frame);
+}
+
+static gboolean
+pop_frame (GstElement * element, GstClockTime ts, GstClockTime * start,
+    GstClockTime * duration, GstClockTime * self_time)
+{
+  GArray *frames = g_private_get (&frames_key);
+  GstStartupFrame *frame;
+  gint i;
+
+  if (!frames)
+    return FALSE;
+
+  for (i = frames->len - 1; i >= 0; i--) {
+    if (g_array_index (frames, GstStartupFrame, i).element == element)
+      break;
+  }
+  if (i < 0)
+    return FALSE;
+
+  frame = &g_array_index (frames, GstStartupFrame, i);
+  *start = frame->start;
+  *duration = GST_CLOCK_DIFF (frame->start, ts);
+  *self_time = *duration > frame->nested ? *duration - frame->nested : 0;
+  g_array_set_size (frames, i);
+
+  /* the enclosing state change was waiting for us */
+  if (i > 0)
+    g_array_index (frames, GstStartupFrame, i - 1).nested += *duration;
+
+  return TRUE;
+}
+
+static GstElement *
+get_pipeline (GstElement * element)
+{
+  GstObject *parent;
+
+  while ((parent = GST_OBJECT_PARENT (element)))
+    element = GST_ELEMENT_CAST (parent);
+
+  return element;
+}
+
+static gboolean
+is_sink (GstObject * object)
+{
+  return object && GST_IS_ELEMENT (object) && !GST_IS_BIN (object) &&
+      GST_OBJECT_FLAG_IS_SET (object, GST_ELEMENT_FLAG_SINK);
+}
+
+static const gchar *
+get_transition_name (GstStateChange transition)
+{
+  switch (transition) {
+    case GST_STATE_CHANGE_NULL_TO_READY:
+      return "NULL_TO_READY";
+    case GST_STATE_CHANGE_READY_TO_PAUSED:
+      return "READY_TO_PAUSED";
+    case GST_STATE_CHANGE_PAUSED_TO_PLAYING:
+      return "PAUSED_TO_PLAYING";
+    default:
+      /* we only care about starting up */
+      return NULL;
+  }
+}
+
+static void
+log_mark (GstElement * element, GstClockTime ts, const gchar * mark)
+{
+  gst_tracer_record_log (tr_mark, ts, GST_OBJECT_NAME (element),
+      GST_OBJECT_NAME (get_pipeline (element)), mark);
+}
+
+static void
+do_first_buffer (GstStartupTracer * self, GstClockTime ts, GstObject * sink)
+{
+  gboolean first = FALSE;
+
+  if (!is_sink (sink) || g_object_get_qdata ((GObject *) sink, data_quark))
+    return;
+
+  g_mutex_lock (&self->lock);
+  if (!g_object_get_qdata ((GObject *) sink, data_quark)) {
+    g_object_set_qdata ((GObject *) sink, data_quark, GINT_TO_POINTER (1));
+    first = TRUE;
+  }
+  g_mutex_unlock (&self->lock);
+
+  if (first)
+    log_mark (GST_ELEMENT_CAST (sink), ts, "first-buffer");
+}
+
+/* hooks */
+
+static void
+do_plugin_load_pre (GstStartupTracer * self, GstClockTime ts,
+    const gchar * filename)
+{
+  push_frame (NULL, ts);
+}
+
+static void
+do_plugin_load_post (GstStartupTracer * self, GstClockTime ts,
+    const gchar * filename, GstPlugin * plugin)
+{
+  GstClockTime start, duration, self_time;
+  gchar *name;
+
+  if (!pop_frame (NULL, ts, &start, &duration, &self_time))
+    return;
+
+  if (plugin)
+    name = g_strdup (gst_plugin_get_name (plugin));
+  else
+    name = g_path_get_basename (filename);
+  gst_tracer_record_log (tr_plugin, start, duration, name);
+  g_free (name);
+}
+
+static void
+do_element_new (GstStartupTracer * self, GstClockTime ts,
+    GstElement * element)
+{
+  gst_tracer_record_log (tr_element, ts, GST_OBJECT_NAME (element),
+      G_OBJECT_TYPE_NAME (element));
+}
+
+static void
+do_element_change_state_pre (GstStartupTracer * self, GstClockTime ts,
+    GstElement * element, GstStateChange transition)
+{
+  /* starting again, log the next first buffer too */
+  if (transition == GST_STATE_CHANGE_READY_TO_PAUSED &&
+      is_sink (GST_OBJECT_CAST (element))) {
+    g_mutex_lock (&self->lock);
+    g_object_set_qdata ((GObject *) element, data_quark, NULL);
+    g_mutex_unlock (&self->lock);
+  }
+
+  push_frame (element, ts);
+}
+
+static void
+do_element_change_state_post (GstStartupTracer * self, GstClockTime ts,
+    GstElement * element, GstStateChange transition,
+    GstStateChangeReturn result)
+{
+  GstClockTime start, duration, self_time;
+  const gchar *name;
+
+  if (!pop_frame (element, ts, &start, &duration, &self_time))
+    return;
+
+  if (!(name = get_transition_name (transition)))
+    return;
+
+  gst_tracer_record_log (tr_state, start, duration, self_time,
+      GST_OBJECT_NAME (element), GST_OBJECT_NAME (get_pipeline (element)),
+      name, gst_element_state_change_return_get_name (result));
+}
+
+static void
+do_element_post_message_pre (GstStartupTracer * self, GstClockTime ts,
+    GstElement * element, GstMessage * message)
+{
+  GstState old_state, new_state;
+
+  switch (GST_MESSAGE_TYPE (message)) {
+    case GST_MESSAGE_ASYNC_DONE:
+      if (is_sink (GST_OBJECT_CAST (element)))
+        log_mark (element, ts, "preroll");
+      break;
+    case GST_MESSAGE_STATE_CHANGED:
+      /* only the pipeline reaching a new state is interesting */
+      if (GST_OBJECT_PARENT (element) || !GST_IS_PIPELINE (element) ||
+          GST_MESSAGE_SRC (message) != GST_OBJECT_CAST (element))
+        break;
+      gst_message_parse_state_changed (message, &old_state, &new_state, NULL);
+      if (new_state == GST_STATE_READY && old_state == GST_STATE_NULL)
+        log_mark (element, ts, "ready");
+      else if (new_state == GST_STATE_PAUSED && old_state == GST_STATE_READY)
+        log_mark (element, ts, "paused");
+      else if (new_state == GST_STATE_PLAYING)
+        log_mark (element, ts, "playing");
+      break;
+    default:
+      break;
+  }
+}
+
+static void
+do_push_buffer_pre (GstStartupTracer * self, GstClockTime ts, GstPad * pad)
+{
+  GstPad *peer = GST_PAD_PEER (pad);
+
+  if (peer)
+    do_first_buffer (self, ts, GST_OBJECT_PARENT (peer));
+}
+
+static void
+do_pull_range_post (GstStartupTracer * self, GstClockTime ts, GstPad * pad,
+    GstBuffer * buffer, GstFlowReturn res)
+{
+  if (res == GST_FLOW_OK)
+    do_first_buffer (self, ts, GST_OBJECT_PARENT (pad));
+}
+
+/* tracer class */
+
+static void
+gst_startup_tracer_finalize (GObject * obj)
+{
+  GstStartupTracer *self = GST_STARTUP_TRACER (obj);
+
+  g_mutex_clear (&self->lock);
+
+  G_OBJECT_CLASS (parent_class)->finalize (obj);
+}
+
+static void
+gst_startup_tracer_class_init (GstStartupTracerClass * klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+  gobject_class->finalize = gst_startup_tracer_finalize;
+
+  data_quark = g_quark_from_static_string ("gststartup:data");
+
+  /* announce trace formats */
+  /* *INDENT-OFF* */
+  tr_plugin = gst_tracer_record_new ("startup-plugin.class",
+      "ts", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT64,
+          "description", G_TYPE_STRING, "start of loading the plugin",
+          NULL),
+      "duration", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT64,
+          "description", G_TYPE_STRING, "time in ns to load the plugin",
+          NULL),
+      "plugin", GST_TYPE_STRUCTURE, gst_structure_new ("scope",
+          "type", G_TYPE_GTYPE, G_TYPE_STRING,
+          "related-to", GST_TYPE_TRACER_VALUE_SCOPE, GST_TRACER_VALUE_SCOPE_PROCESS,
+          NULL),
+      NULL);
+  tr_element = gst_tracer_record_new ("startup-element.class",
+      "ts", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT64,
+          "description", G_TYPE_STRING, "creation of the element",
+          NULL),
+      "element", GST_TYPE_STRUCTURE, gst_structure_new ("scope",
+          "type", G_TYPE_GTYPE, G_TYPE_STRING,
+          "related-to", GST_TYPE_TRACER_VALUE_SCOPE, GST_TRACER_VALUE_SCOPE_ELEMENT,
+          NULL),
+      "type", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_STRING,
+          "description", G_TYPE_STRING, "type name of the element",
+          NULL),
+      NULL);
+  tr_state = gst_tracer_record_new ("startup-state.class",
+      "ts", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT64,
+          "description", G_TYPE_STRING, "start of the state change",
+          NULL),
+      "duration", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT64,
+          "description", G_TYPE_STRING, "time in ns of the state change",
+          NULL),
+      "self", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT64,
+          "description", G_TYPE_STRING,
+          "time in ns of the state change without nested state changes",
+          NULL),
+      "element", GST_TYPE_STRUCTURE, gst_structure_new ("scope",
+          "type", G_TYPE_GTYPE, G_TYPE_STRING,
+          "related-to", GST_TYPE_TRACER_VALUE_SCOPE, GST_TRACER_VALUE_SCOPE_ELEMENT,
+          NULL),
+      "pipeline", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_STRING,
+          "description", G_TYPE_STRING, "the toplevel bin of the element",
+          NULL),
+      "transition", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_STRING,
+          "description", G_TYPE_STRING, "the state change",
+          NULL),
+      "result", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_STRING,
+          "description", G_TYPE_STRING, "the result of the state change",
+          NULL),
+      NULL);
+  tr_mark = gst_tracer_record_new ("startup-mark.class",
+      "ts", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT64,
+          "description", G_TYPE_STRING, "event ts",
+          NULL),
+      "element", GST_TYPE_STRUCTURE, gst_structure_new ("scope",
+          "type", G_TYPE_GTYPE, G_TYPE_STRING,
+          "related-to", GST_TYPE_TRACER_VALUE_SCOPE, GST_TRACER_VALUE_SCOPE_ELEMENT,
+          NULL),
+      "pipeline", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_STRING,
+          "description", G_TYPE_STRING, "the toplevel bin of the element",
+          NULL),
+      "mark", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_STRING,
+          "description", G_TYPE_STRING,
+          "preroll or first-buffer for sinks, the reached state for pipelines",
+          NULL),
+      NULL);
+  /* *INDENT-ON* */
+}
+
+static void
+gst_startup_tracer_init (GstStartupTracer * self)
+{
+  GstTracer *tracer = GST_TRACER (self);
+
+  g_mutex_init (&self->lock);
+
+  gst_tracing_register_hook (tracer, "plugin-load-pre",
+      G_CALLBACK (do_plugin_load_pre));
+  gst_tracing_register_hook (tracer, "plugin-load-post",
+      G_CALLBACK (do_plugin_load_post));
+  gst_tracing_register_hook (tracer, "element-new",
+      G_CALLBACK (do_element_new));
+  gst_tracing_register_hook (tracer, "element-change-state-pre",
+      G_CALLBACK (do_element_change_state_pre));
+  gst_tracing_register_hook (tracer, "element-change-state-post",
+      G_CALLBACK (do_element_change_state_post));
+  gst_tracing_register_hook (tracer, "element-post-message-pre",
+      G_CALLBACK (do_element_post_message_pre));
+  gst_tracing_register_hook (tracer, "pad-push-pre",
+      G_CALLBACK (do_push_buffer_pre));
+  gst_tracing_register_hook (tracer, "pad-push-list-pre",
+      G_CALLBACK (do_push_buffer_pre));
+  gst_tracing_register_hook (tracer, "pad-pull-range-post",
+      G_CALLBACK (do_pull_range_post));
+}
@@ -0,0 +1,66 @@
+/* GStreamer
+ *
+ * gststartup.h: tracing module that logs the startup timeline
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __GST_STARTUP_TRACER_H__
+#define __GST_STARTUP_TRACER_H__
+
+#include <gst/gst.h>
+#include <gst/gsttracer.h>
+
+G_BEGIN_DECLS
+
+#define GST_TYPE_STARTUP_TRACER \
+  (gst_startup_tracer_get_type())
+#define GST_STARTUP_TRACER(obj) \
+  (G_TYPE_CHECK_INSTANCE_CAST((obj),GST_TYPE_STARTUP_TRACER,GstStartupTracer))
+#define GST_STARTUP_TRACER_CLASS(klass) \
+  (G_TYPE_CHECK_CLASS_CAST((klass),GST_TYPE_STARTUP_TRACER,GstStartupTracerClass))
+#define GST_IS_STARTUP_TRACER(obj) \
+  (G_TYPE_CHECK_INSTANCE_TYPE((obj),GST_TYPE_STARTUP_TRACER))
+#define GST_IS_STARTUP_TRACER_CLASS(klass) \
+  (G_TYPE_CHECK_CLASS_TYPE((klass),GST_TYPE_STARTUP_TRACER))
+#define GST_STARTUP_TRACER_CAST(obj) ((GstStartupTracer *)(obj))
+
+typedef struct _GstStartupTracer GstStartupTracer;
+typedef struct _GstStartupTracerClass GstStartupTracerClass;
+
+/**
+ * GstStartupTracer:
+ *
+ * Opaque #GstStartupTracer data structure
+ */
+struct _GstStartupTracer {
+  GstTracer 	 parent;
+
+  /*< private >*/
+  GMutex lock;
+};
+
+struct _GstStartupTracerClass {
+  GstTracerClass parent_class;
+
+  /* signals */
+};
+
+G_GNUC_INTERNAL GType gst_startup_tracer_get_type (void);
+
+G_END_DECLS
+
+#endif /* __GST_STARTUP_TRACER_H__ */
@@ -54,6 +54,7 @@ static GstTracerRecord *tr_element_query;
 static GstTracerRecord *tr_event;
 static GstTracerRecord *tr_message;
 static GstTracerRecord *tr_query;
+static GstTracerRecord *tr_object_cache;
 
 typedef struct
 {
@@ -511,6 +512,14 @@ do_query_post (GstStatsTracer * self, guint64 ts, GstPad * this_pad,
       qry, ts, TRUE, res);
 }
 
+static void
+do_mini_object_cache_stats (GstStatsTracer * self, guint64 ts,
+    const gchar * cache, guint64 hits, guint64 misses)
+{
+  gst_tracer_record_log (tr_object_cache,
+      (guint64) (guintptr) g_thread_self (), ts, cache, hits, misses);
+}
+
 /* tracer class */
 
 static void
@@ -673,6 +682,34 @@ gst_stats_tracer_class_init (GstStatsTracerClass * klass)
           "flags", GST_TYPE_TRACER_VALUE_FLAGS, GST_TRACER_VALUE_FLAGS_OPTIONAL,
           NULL),
       NULL);
+  tr_object_cache = gst_tracer_record_new ("object-cache.class",
+      "thread-id", GST_TYPE_STRUCTURE, gst_structure_new ("scope",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT64,
+          "related-to", GST_TYPE_TRACER_VALUE_SCOPE, GST_TRACER_VALUE_SCOPE_THREAD,
+          NULL),
+      "ts", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT64,
+          "description", G_TYPE_STRING, "event ts",
+          NULL),
+      "name", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_STRING,
+          "description", G_TYPE_STRING, "name of the cache",
+          NULL),
+      "hits", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT64,
+          "description", G_TYPE_STRING, "objects reused from the cache",
+          "flags", GST_TYPE_TRACER_VALUE_FLAGS, GST_TRACER_VALUE_FLAGS_AGGREGATED,
+          "min", G_TYPE_UINT64, G_GUINT64_CONSTANT (0),
+          "max", G_TYPE_UINT64, G_MAXUINT64,
+          NULL),
+      "misses", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT64,
+          "description", G_TYPE_STRING, "objects allocated from the slice allocator",
+          "flags", GST_TYPE_TRACER_VALUE_FLAGS, GST_TRACER_VALUE_FLAGS_AGGREGATED,
+          "min", G_TYPE_UINT64, G_GUINT64_CONSTANT (0),
+          "max", G_TYPE_UINT64, G_MAXUINT64,
+          NULL),
+      NULL);
   tr_new_element = gst_tracer_record_new ("new-element.class",
       "thread-id", GST_TYPE_STRUCTURE, gst_structure_new ("scope",
           "type", G_TYPE_GTYPE, G_TYPE_UINT64,
@@ -765,4 +802,6 @@ gst_stats_tracer_init (GstStatsTracer * self)
       G_CALLBACK (do_query_pre));
   gst_tracing_register_hook (tracer, "pad-query-post",
       G_CALLBACK (do_query_post));
+  gst_tracing_register_hook (tracer, "mini-object-cache-stats",
+      G_CALLBACK (do_mini_object_cache_stats));
 }
@@ -25,8 +25,14 @@
 
 #include <gst/gst.h>
 #include "gstlatency.h"
+#include "gstlockstats.h"
 #include "gstlog.h"
+#include "gstpoolstats.h"
+#include "gstproctime.h"
+#include "gstqueuelevels.h"
+#include "gstqueueplan.h"
 #include "gstrusage.h"
+#include "gststartup.h"
 #include "gststats.h"
 
 static gboolean
@@ -34,14 +40,31 @@ plugin_init (GstPlugin * plugin)
 {
   if (!gst_tracer_register (plugin, "latency", gst_latency_tracer_get_type ()))
     return FALSE;
+  if (!gst_tracer_register (plugin, "lockstats",
+          gst_lockstats_tracer_get_type ()))
+    return FALSE;
 #ifndef GST_DISABLE_GST_DEBUG
   if (!gst_tracer_register (plugin, "log", gst_log_tracer_get_type ()))
     return FALSE;
 #endif
+  if (!gst_tracer_register (plugin, "poolstats",
+          gst_poolstats_tracer_get_type ()))
+    return FALSE;
+  if (!gst_tracer_register (plugin, "proctime",
+          gst_proctime_tracer_get_type ()))
+    return FALSE;
+  if (!gst_tracer_register (plugin, "queuelevels",
+          gst_queuelevels_tracer_get_type ()))
+    return FALSE;
+  if (!gst_tracer_register (plugin, "queueplan",
+          gst_queueplan_tracer_get_type ()))
+    return FALSE;
 #ifdef HAVE_GETRUSAGE
   if (!gst_tracer_register (plugin, "rusage", gst_rusage_tracer_get_type ()))
     return FALSE;
 #endif
+  if (!gst_tracer_register (plugin, "startup", gst_startup_tracer_get_type ()))
+    return FALSE;
   if (!gst_tracer_register (plugin, "stats", gst_stats_tracer_get_type ()))
     return FALSE;
   return TRUE;
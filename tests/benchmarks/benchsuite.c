@@ -0,0 +1,634 @@
+/* GStreamer
+ *
+ * benchsuite.c: runs a set of core benchmark scenarios and reports
+ * machine-readable results
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Every scenario is run for a number of warmup rounds followed by a number
+ * of measured repetitions, the time per operation of each repetition is
+ * collected and summarized as percentiles. The results are written as JSON,
+ * one scenario per line, and can be compared against a previous run with
+ * --baseline, in which case the exit code is non-zero if the median of any
+ * scenario got slower than the threshold. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <gst/gst.h>
+#include <gst/base/gstadapter.h>
+
+#define REGISTRY_CHILD_ARG "--registry-load-child"
+
+typedef struct
+{
+  const gchar *name;
+  const gchar *description;
+  /* operations done by one call to run */
+  guint ops;
+  gpointer (*setup) (void);
+  void (*run) (gpointer data, guint ops);
+  void (*teardown) (gpointer data);
+} BenchScenario;
+
+typedef struct
+{
+  gdouble min, max, mean, p50, p90, p99;
+} BenchResult;
+
+static gchar *self_path;
+
+/* pad push */
+
+typedef struct
+{
+  GstPad *src, *sink;
+  GstBuffer *buf;
+  GMutex lock;
+  GCond cond;
+  guint count, target;
+  GstElement *element;
+} PadData;
+
+static GstFlowReturn
+bench_chain_drop (GstPad * pad, GstObject * parent, GstBuffer * buf)
+{
+  gst_buffer_unref (buf);
+  return GST_FLOW_OK;
+}
+
+static gboolean
+bench_event_drop (GstPad * pad, GstObject * parent, GstEvent * event)
+{
+  gst_event_unref (event);
+  return TRUE;
+}
+
+static void
+bench_push_sticky_events (GstPad * src)
+{
+  GstCaps *caps;
+  GstSegment segment;
+
+  gst_pad_push_event (src, gst_event_new_stream_start ("bench"));
+  caps = gst_caps_new_empty_simple ("application/x-bench");
+  gst_pad_push_event (src, gst_event_new_caps (caps));
+  gst_caps_unref (caps);
+  gst_segment_init (&segment, GST_FORMAT_BYTES);
+  gst_pad_push_event (src, gst_event_new_segment (&segment));
+}
+
+static gpointer
+pad_push_setup (void)
+{
+  PadData *data = g_new0 (PadData, 1);
+
+  g_mutex_init (&data->lock);
+  g_cond_init (&data->cond);
+
+  data->src = gst_pad_new ("src", GST_PAD_SRC);
+  data->sink = gst_pad_new ("sink", GST_PAD_SINK);
+  gst_pad_set_chain_function (data->sink, bench_chain_drop);
+  gst_pad_set_event_function (data->sink, bench_event_drop);
+  gst_pad_link (data->src, data->sink);
+  gst_pad_set_active (data->sink, TRUE);
+  gst_pad_set_active (data->src, TRUE);
+  bench_push_sticky_events (data->src);
+  data->buf = gst_buffer_new_allocate (NULL, 1024, NULL);
+
+  return data;
+}
+
+static void
+pad_push_run (gpointer user_data, guint ops)
+{
+  PadData *data = user_data;
+  guint i;
+
+  for (i = 0; i < ops; i++)
+    gst_pad_push (data->src, gst_buffer_ref (data->buf));
+}
+
+static void
+pad_teardown (gpointer user_data)
+{
+  PadData *data = user_data;
+
+  if (data->element)
+    gst_element_set_state (data->element, GST_STATE_NULL);
+  gst_pad_set_active (data->src, FALSE);
+  gst_pad_set_active (data->sink, FALSE);
+  gst_object_unref (data->src);
+  gst_object_unref (data->sink);
+  if (data->element)
+    gst_object_unref (data->element);
+  gst_buffer_unref (data->buf);
+  g_mutex_clear (&data->lock);
+  g_cond_clear (&data->cond);
+  g_free (data);
+}
+
+/* queue handoff */
+
+static GstFlowReturn
+bench_chain_count (GstPad * pad, GstObject * parent, GstBuffer * buf)
+{
+  PadData *data = gst_pad_get_element_private (pad);
+
+  gst_buffer_unref (buf);
+
+  g_mutex_lock (&data->lock);
+  if (++data->count == data->target)
+    g_cond_signal (&data->cond);
+  g_mutex_unlock (&data->lock);
+
+  return GST_FLOW_OK;
+}
+
+static gpointer
+queue_handoff_setup (void)
+{
+  PadData *data = g_new0 (PadData, 1);
+  GstPad *pad;
+
+  g_mutex_init (&data->lock);
+  g_cond_init (&data->cond);
+
+  data->element = gst_element_factory_make ("queue", NULL);
+  if (data->element == NULL) {
+    g_printerr ("queue element not available\n");
+    exit (-2);
+  }
+
+  data->src = gst_pad_new ("src", GST_PAD_SRC);
+  data->sink = gst_pad_new ("sink", GST_PAD_SINK);
+  gst_pad_set_element_private (data->sink, data);
+  gst_pad_set_chain_function (data->sink, bench_chain_count);
+  gst_pad_set_event_function (data->sink, bench_event_drop);
+
+  pad = gst_element_get_static_pad (data->element, "sink");
+  gst_pad_link (data->src, pad);
+  gst_object_unref (pad);
+  pad = gst_element_get_static_pad (data->element, "src");
+  gst_pad_link (pad, data->sink);
+  gst_object_unref (pad);
+
+  gst_pad_set_active (data->sink, TRUE);
+  gst_element_set_state (data->element, GST_STATE_PLAYING);
+  gst_pad_set_active (data->src, TRUE);
+  bench_push_sticky_events (data->src);
+  data->buf = gst_buffer_new_allocate (NULL, 1024, NULL);
+
+  return data;
+}
+
+static void
+queue_handoff_run (gpointer user_data, guint ops)
+{
+  PadData *data = user_data;
+  guint i;
+
+  g_mutex_lock (&data->lock);
+  data->count = 0;
+  data->target = ops;
+  g_mutex_unlock (&data->lock);
+
+  for (i = 0; i < ops; i++)
+    gst_pad_push (data->src, gst_buffer_ref (data->buf));
+
+  /* wait for the queue thread to have handed off everything */
+  g_mutex_lock (&data->lock);
+  while (data->count < data->target)
+    g_cond_wait (&data->cond, &data->lock);
+  g_mutex_unlock (&data->lock);
+}
+
+/* bus post */
+
+static gpointer
+bus_post_setup (void)
+{
+  return gst_bus_new ();
+}
+
+static void
+bus_post_run (gpointer user_data, guint ops)
+{
+  GstBus *bus = user_data;
+  GstMessage *msg;
+  guint i;
+
+  for (i = 0; i < ops; i++)
+    gst_bus_post (bus, gst_message_new_element (NULL,
+            gst_structure_new_empty ("bench")));
+
+  while ((msg = gst_bus_pop (bus)))
+    gst_message_unref (msg);
+}
+
+static void
+bus_post_teardown (gpointer user_data)
+{
+  gst_object_unref (user_data);
+}
+
+/* registry load, a fresh process doing gst_init() with a warm registry
+ * cache */
+
+static gpointer
+registry_load_setup (void)
+{
+  return NULL;
+}
+
+static void
+registry_load_run (gpointer user_data, guint ops)
+{
+  gchar *argv[] = { self_path, (gchar *) REGISTRY_CHILD_ARG, NULL };
+  GError *err = NULL;
+  gint status;
+  guint i;
+
+  for (i = 0; i < ops; i++) {
+    if (!g_spawn_sync (NULL, argv, NULL,
+            G_SPAWN_STDOUT_TO_DEV_NULL | G_SPAWN_STDERR_TO_DEV_NULL, NULL,
+            NULL, NULL, NULL, &status, &err)) {
+      g_printerr ("could not spawn %s: %s\n", self_path, err->message);
+      exit (-2);
+    }
+  }
+}
+
+static void
+registry_load_teardown (gpointer user_data)
+{
+}
+
+/* caps intersection */
+
+typedef struct
+{
+  GstCaps *a, *b;
+} CapsData;
+
+static gpointer
+caps_intersect_setup (void)
+{
+  CapsData *data = g_new0 (CapsData, 1);
+
+  data->a = gst_caps_from_string ("video/x-raw, "
+      "format = (string) { I420, YV12, NV12, RGB, BGRA }, "
+      "width = (int) [ 16, 4096 ], height = (int) [ 16, 4096 ], "
+      "framerate = (fraction) [ 0/1, 2147483647/1 ]; "
+      "video/x-raw(memory:GLMemory), format = (string) { RGBA, NV12 }, "
+      "width = (int) [ 1, 8192 ], height = (int) [ 1, 8192 ], "
+      "framerate = (fraction) [ 0/1, 2147483647/1 ]");
+  data->b = gst_caps_from_string ("video/x-raw, format = (string) NV12, "
+      "width = (int) 1920, height = (int) 1080, framerate = (fraction) 30/1; "
+      "video/x-raw, format = (string) I420, width = (int) 1280, "
+      "height = (int) 720, framerate = (fraction) 25/1");
+
+  return data;
+}
+
+static void
+caps_intersect_run (gpointer user_data, guint ops)
+{
+  CapsData *data = user_data;
+  guint i;
+
+  for (i = 0; i < ops; i++)
+    gst_caps_unref (gst_caps_intersect (data->a, data->b));
+}
+
+static void
+caps_intersect_teardown (gpointer user_data)
+{
+  CapsData *data = user_data;
+
+  gst_caps_unref (data->a);
+  gst_caps_unref (data->b);
+  g_free (data);
+}
+
+/* adapter scanning, start codes in MPEG-TS packet sized buffers */
+
+#define ADAPTER_DATA_SIZE (256 * 1024)
+#define ADAPTER_BUFFER_SIZE (1316)
+#define ADAPTER_NAL_SIZE (997)
+
+typedef struct
+{
+  GstAdapter *adapter;
+  GPtrArray *buffers;
+} AdapterData;
+
+static gpointer
+adapter_scan_setup (void)
+{
+  AdapterData *data = g_new0 (AdapterData, 1);
+  GRand *rand;
+  guint8 *bytes;
+  gsize i;
+
+  rand = g_rand_new_with_seed (0);
+  bytes = g_malloc (ADAPTER_DATA_SIZE);
+  for (i = 0; i < ADAPTER_DATA_SIZE; i++)
+    bytes[i] = g_rand_int_range (rand, 0, 256);
+  for (i = 0; i + 4 <= ADAPTER_DATA_SIZE; i += ADAPTER_NAL_SIZE) {
+    bytes[i] = bytes[i + 1] = 0;
+    bytes[i + 2] = 1;
+  }
+  g_rand_free (rand);
+
+  data->buffers = g_ptr_array_new_with_free_func ((GDestroyNotify)
+      gst_buffer_unref);
+  for (i = 0; i < ADAPTER_DATA_SIZE; i += ADAPTER_BUFFER_SIZE) {
+    gsize len = MIN (ADAPTER_BUFFER_SIZE, ADAPTER_DATA_SIZE - i);
+
+    g_ptr_array_add (data->buffers,
+        gst_buffer_new_wrapped (g_memdup (bytes + i, len), len));
+  }
+  g_free (bytes);
+
+  data->adapter = gst_adapter_new ();
+
+  return data;
+}
+
+static void
+adapter_scan_run (gpointer user_data, guint ops)
+{
+  AdapterData *data = user_data;
+  gssize pos;
+  guint i, j;
+
+  for (i = 0; i < ops; i++) {
+    gsize off = 0;
+
+    for (j = 0; j < data->buffers->len; j++)
+      gst_adapter_push (data->adapter,
+          gst_buffer_ref (g_ptr_array_index (data->buffers, j)));
+
+    while ((pos = gst_adapter_masked_scan_uint32 (data->adapter, 0xffffff00,
+                0x00000100, off, ADAPTER_DATA_SIZE - off)) != -1) {
+      off = pos + 3;
+      if (off + 4 > ADAPTER_DATA_SIZE)
+        break;
+    }
+    gst_adapter_clear (data->adapter);
+  }
+}
+
+static void
+adapter_scan_teardown (gpointer user_data)
+{
+  AdapterData *data = user_data;
+
+  g_object_unref (data->adapter);
+  g_ptr_array_unref (data->buffers);
+  g_free (data);
+}
+
+static const BenchScenario scenarios[] = {
+  {"pad-push", "push a buffer over a linked pad", 100000,
+      pad_push_setup, pad_push_run, pad_teardown},
+  {"queue-handoff", "push a buffer through a queue to another thread", 20000,
+      queue_handoff_setup, queue_handoff_run, pad_teardown},
+  {"bus-post", "post and pop a message on a bus", 10000,
+      bus_post_setup, bus_post_run, bus_post_teardown},
+  {"registry-load", "start a process and load the registry cache", 2,
+      registry_load_setup, registry_load_run, registry_load_teardown},
+  {"caps-intersect", "intersect two ranged video caps", 2000,
+      caps_intersect_setup, caps_intersect_run, caps_intersect_teardown},
+  {"adapter-scan", "scan 256KB of buffers in an adapter for start codes", 10,
+      adapter_scan_setup, adapter_scan_run, adapter_scan_teardown}
+};
+
+static gint
+compare_double (gconstpointer a, gconstpointer b)
+{
+  gdouble da = *(const gdouble *) a, db = *(const gdouble *) b;
+
+  return (da > db) - (da < db);
+}
+
+/* nearest-rank percentile of sorted values */
+static gdouble
+percentile (const gdouble * vals, guint n, guint p)
+{
+  guint rank = (p * n + 99) / 100;
+
+  return vals[MAX (rank, 1) - 1];
+}
+
+static void
+run_scenario (const BenchScenario * scenario, guint warmup,
+    guint repetitions, BenchResult * result)
+{
+  GstClockTime start;
+  gdouble *vals, sum = 0.0;
+  gpointer data;
+  guint i;
+
+  vals = g_new (gdouble, repetitions);
+
+  data = scenario->setup ();
+  for (i = 0; i < warmup; i++)
+    scenario->run (data, scenario->ops);
+  for (i = 0; i < repetitions; i++) {
+    start = gst_util_get_timestamp ();
+    scenario->run (data, scenario->ops);
+    vals[i] = (gdouble) GST_CLOCK_DIFF (start, gst_util_get_timestamp ()) /
+        scenario->ops;
+    sum += vals[i];
+  }
+  scenario->teardown (data);
+
+  qsort (vals, repetitions, sizeof (gdouble), compare_double);
+  result->min = vals[0];
+  result->max = vals[repetitions - 1];
+  result->mean = sum / repetitions;
+  result->p50 = percentile (vals, repetitions, 50);
+  result->p90 = percentile (vals, repetitions, 90);
+  result->p99 = percentile (vals, repetitions, 99);
+
+  g_free (vals);
+}
+
+static void
+append_double (GString * s, const gchar * name, gdouble val)
+{
+  gchar buf[G_ASCII_DTOSTR_BUF_SIZE];
+
+  g_string_append_printf (s, ", \"%s\": %s", name,
+      g_ascii_formatd (buf, sizeof (buf), "%.2f", val));
+}
+
+/* the baseline is a previous output of this program, which has all fields
+ * of a scenario on one line */
+static gboolean
+baseline_lookup (const gchar * contents, const gchar * name, gdouble * p50)
+{
+  const gchar *s, *v, *eol;
+  gchar *key;
+
+  key = g_strdup_printf ("\"name\": \"%s\"", name);
+  s = strstr (contents, key);
+  g_free (key);
+  if (s == NULL)
+    return FALSE;
+
+  eol = strchr (s, '\n');
+  v = strstr (s, "\"p50\": ");
+  if (v == NULL || (eol != NULL && v > eol))
+    return FALSE;
+
+  *p50 = g_ascii_strtod (v + strlen ("\"p50\": "), NULL);
+
+  return TRUE;
+}
+
+gint
+main (gint argc, gchar * argv[])
+{
+  gint warmup = 3, repetitions = 30;
+  gdouble threshold = 10.0;
+  gchar *filter = NULL, *output = NULL, *baseline = NULL;
+  gchar *contents = NULL;
+  GOptionEntry options[] = {
+    {"warmup", 'w', 0, G_OPTION_ARG_INT, &warmup,
+        "Number of unmeasured runs per scenario (default 3)", "N"},
+    {"repetitions", 'r', 0, G_OPTION_ARG_INT, &repetitions,
+        "Number of measured runs per scenario (default 30)", "N"},
+    {"filter", 'f', 0, G_OPTION_ARG_STRING, &filter,
+        "Only run scenarios whose name contains STRING", "STRING"},
+    {"output", 'o', 0, G_OPTION_ARG_FILENAME, &output,
+        "Write the JSON results to FILE instead of stdout", "FILE"},
+    {"baseline", 'b', 0, G_OPTION_ARG_FILENAME, &baseline,
+        "Compare against the JSON results in FILE", "FILE"},
+    {"threshold", 't', 0, G_OPTION_ARG_DOUBLE, &threshold,
+        "Median slowdown in percent reported as regression (default 10)",
+        "PERCENT"},
+    {NULL}
+  };
+  GOptionContext *ctx;
+  GError *err = NULL;
+  GString *json;
+  gchar *version;
+  guint i, regressions = 0;
+  gboolean first = TRUE;
+
+  /* child process of the registry-load scenario */
+  if (argc == 2 && strcmp (argv[1], REGISTRY_CHILD_ARG) == 0) {
+    gst_init (NULL, NULL);
+    return 0;
+  }
+
+  ctx = g_option_context_new ("- GStreamer core benchmark suite");
+  g_option_context_add_main_entries (ctx, options, NULL);
+  g_option_context_add_group (ctx, gst_init_get_option_group ());
+  if (!g_option_context_parse (ctx, &argc, &argv, &err)) {
+    g_print ("Error initializing: %s\n", GST_STR_NULL (err->message));
+    g_clear_error (&err);
+    g_option_context_free (ctx);
+    return 1;
+  }
+  g_option_context_free (ctx);
+
+  if (repetitions <= 0 || warmup < 0) {
+    g_print ("number of repetitions must be greater than 0\n");
+    exit (-3);
+  }
+
+  if (baseline && !g_file_get_contents (baseline, &contents, NULL, &err)) {
+    g_print ("could not read baseline: %s\n", err->message);
+    g_clear_error (&err);
+    exit (-3);
+  }
+
+  self_path = argv[0];
+
+  json = g_string_new ("{\n");
+  version = gst_version_string ();
+  g_string_append_printf (json, "  \"version\": \"%s\",\n", version);
+  g_free (version);
+  g_string_append_printf (json, "  \"warmup\": %d,\n", warmup);
+  g_string_append_printf (json, "  \"repetitions\": %d,\n", repetitions);
+  g_string_append (json, "  \"unit\": \"ns/op\",\n  \"scenarios\": [");
+
+  for (i = 0; i < G_N_ELEMENTS (scenarios); i++) {
+    const BenchScenario *scenario = &scenarios[i];
+    BenchResult res;
+    gdouble base;
+
+    if (filter && strstr (scenario->name, filter) == NULL)
+      continue;
+
+    g_printerr ("running %s: %s\n", scenario->name, scenario->description);
+    run_scenario (scenario, warmup, repetitions, &res);
+
+    g_string_append_printf (json, "%s\n    {\"name\": \"%s\", \"ops\": %u",
+        first ? "" : ",", scenario->name, scenario->ops);
+    append_double (json, "min", res.min);
+    append_double (json, "mean", res.mean);
+    append_double (json, "p50", res.p50);
+    append_double (json, "p90", res.p90);
+    append_double (json, "p99", res.p99);
+    append_double (json, "max", res.max);
+    g_string_append (json, "}");
+    first = FALSE;
+
+    if (contents && baseline_lookup (contents, scenario->name, &base)) {
+      gdouble change = base > 0.0 ? (res.p50 - base) * 100.0 / base : 0.0;
+
+      if (change > threshold) {
+        g_printerr ("  REGRESSION: median %.2f ns/op, baseline %.2f "
+            "(%+.1f%%)\n", res.p50, base, change);
+        regressions++;
+      } else {
+        g_printerr ("  median %.2f ns/op, baseline %.2f (%+.1f%%)\n",
+            res.p50, base, change);
+      }
+    } else {
+      g_printerr ("  median %.2f ns/op\n", res.p50);
+    }
+  }
+  g_string_append (json, "\n  ]\n}\n");
+
+  if (output) {
+    if (!g_file_set_contents (output, json->str, json->len, &err)) {
+      g_print ("could not write %s: %s\n", output, err->message);
+      g_clear_error (&err);
+      exit (-3);
+    }
+  } else {
+    g_print ("%s", json->str);
+  }
+
+  if (regressions)
+    g_printerr ("%u scenario(s) regressed more than %.1f%%\n", regressions,
+        threshold);
+
+  g_string_free (json, TRUE);
+  g_free (contents);
+  g_free (filter);
+  g_free (output);
+  g_free (baseline);
+
+  return regressions ? 1 : 0;
+}
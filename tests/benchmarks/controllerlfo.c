@@ -0,0 +1,70 @@
+/* GStreamer
+ *
+ * controllerlfo.c: benchmark for the value arrays of the lfo control-source
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <stdio.h>
+
+#include <gst/gst.h>
+#include <gst/controller/gstlfocontrolsource.h>
+
+/* one minute of audio at 44100 Hz, in blocks like an audio element uses */
+#define NUM_BLOCKS 41344
+#define BLOCK_SIZE 64
+
+gint
+main (gint argc, gchar * argv[])
+{
+  GstControlSource *cs;
+  GstClockTime bt, ct, ts, sample_duration;
+  GstClockTimeDiff elapsed;
+  GEnumClass *waveforms;
+  gdouble values[BLOCK_SIZE];
+  guint i, w;
+
+  gst_init (&argc, &argv);
+
+  sample_duration = gst_util_uint64_scale_int (1, GST_SECOND, 44100);
+  waveforms = g_type_class_ref (GST_TYPE_LFO_WAVEFORM);
+
+  cs = gst_lfo_control_source_new ();
+  g_object_set (cs, "frequency", 3.3, "amplitude", 0.4, "offset", 0.5, NULL);
+
+  for (w = 0; w < waveforms->n_values; w++) {
+    g_object_set (cs, "waveform", waveforms->values[w].value, NULL);
+
+    ts = 0;
+    bt = gst_util_get_timestamp ();
+    for (i = 0; i < NUM_BLOCKS; i++) {
+      gst_control_source_get_value_array (cs, ts, sample_duration, BLOCK_SIZE,
+          values);
+      ts += BLOCK_SIZE * sample_duration;
+    }
+    ct = gst_util_get_timestamp ();
+    elapsed = GST_CLOCK_DIFF (bt, ct);
+
+    printf ("%-12s: %" GST_TIME_FORMAT " - %.0lf samples/s\n",
+        waveforms->values[w].value_nick, GST_TIME_ARGS (elapsed),
+        (gdouble) NUM_BLOCKS * BLOCK_SIZE * GST_SECOND / MAX (elapsed, 1));
+  }
+
+  g_type_class_unref (waveforms);
+  gst_object_unref (cs);
+
+  return 0;
+}
@@ -0,0 +1,112 @@
+/* GStreamer
+ *
+ * gstclocklinreg.c: benchmark for the linear regression of clock slaving
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <gst/gst.h>
+
+/* not public API */
+#include "../../gst/gstclock-linreg.c"
+
+gint
+main (gint argc, gchar * argv[])
+{
+  GstClockTime *times, *obs;
+  GstClockTime m_num, m_denom, b, xbase, start, end;
+  GstClockTimeDiff dur;
+  GstClockRegression reg;
+  gdouble r_squared;
+  gint i, window, nobs;
+  GRand *rand;
+
+  gst_init (&argc, &argv);
+
+  if (argc != 3) {
+    g_print ("usage: %s <window_size> <nobservations>\n", argv[0]);
+    exit (-1);
+  }
+
+  window = atoi (argv[1]);
+  nobs = atoi (argv[2]);
+
+  if (window < 2 || window > 1024 || nobs <= window) {
+    g_print ("window size must be in 2-1024 and smaller than the number "
+        "of observations\n");
+    exit (-3);
+  }
+
+  /* a slave running 100ppm fast with some jitter, observed every 100ms */
+  rand = g_rand_new_with_seed (0);
+  obs = g_new (GstClockTime, 2 * nobs);
+  for (i = 0; i < nobs; i++) {
+    GstClockTime master = 162097661044916 + i * 100 * GST_MSECOND;
+
+    obs[2 * i] = 291668893789203 + i * 100 * GST_MSECOND +
+        i * 10 * GST_USECOND + g_rand_int_range (rand, 0, 50 * GST_USECOND);
+    obs[2 * i + 1] = master;
+  }
+  times = g_new0 (GstClockTime, 4 * window);
+
+  /* what GstClock used to do: a full regression over the window for every
+   * new observation */
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < nobs; i++) {
+    times[4 * (i % window)] = obs[2 * i];
+    times[4 * (i % window) + 2] = obs[2 * i + 1];
+    if (i >= window)
+      _priv_gst_do_linear_regression (times, window, &m_num, &m_denom, &b,
+          &xbase, &r_squared);
+  }
+  end = gst_util_get_timestamp ();
+  dur = GST_CLOCK_DIFF (start, end);
+  g_print ("*** total %" GST_TIME_FORMAT " - average %" GST_TIME_FORMAT
+      "  - Done %d full regressions, rate %f\n", GST_TIME_ARGS (dur),
+      GST_TIME_ARGS (dur / (nobs - window)), nobs - window,
+      (gdouble) m_num / m_denom);
+
+  /* the sliding window, as GstClock does now */
+  _priv_gst_linear_regression_reset (&reg);
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < nobs; i++) {
+    if (i >= window)
+      _priv_gst_linear_regression_remove (&reg, times[4 * (i % window)],
+          times[4 * (i % window) + 2]);
+    times[4 * (i % window)] = obs[2 * i];
+    times[4 * (i % window) + 2] = obs[2 * i + 1];
+    _priv_gst_linear_regression_add (&reg, obs[2 * i], obs[2 * i + 1]);
+    if (i % window == window - 1)
+      _priv_gst_linear_regression_rebuild (&reg, times, window);
+    if (i >= window)
+      _priv_gst_linear_regression_get (&reg, obs[2 * i], &m_num, &m_denom,
+          &b, &r_squared);
+  }
+  end = gst_util_get_timestamp ();
+  dur = GST_CLOCK_DIFF (start, end);
+  g_print ("*** total %" GST_TIME_FORMAT " - average %" GST_TIME_FORMAT
+      "  - Done %d sliding window updates, rate %f\n", GST_TIME_ARGS (dur),
+      GST_TIME_ARGS (dur / (nobs - window)), nobs - window,
+      (gdouble) m_num / m_denom);
+
+  g_free (times);
+  g_free (obs);
+  g_rand_free (rand);
+
+  return 0;
+}
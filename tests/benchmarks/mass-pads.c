@@ -0,0 +1,133 @@
+/* GStreamer
+ *
+ * mass-pads.c: report the memory used per pad and per element
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <stdlib.h>
+#include <gst/gst.h>
+
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+#define OBJECT_COUNT (100000)
+
+/* GSlice hides allocations from malloc, run with G_SLICE=always-malloc for
+ * exact numbers */
+static gsize
+heap_used (void)
+{
+#ifdef __GLIBC__
+  struct mallinfo info = mallinfo ();
+
+  return (gsize) info.uordblks + (gsize) info.hblkhd;
+#else
+  return 0;
+#endif
+}
+
+static void
+report (const gchar * what, guint count, gsize before, gsize after,
+    GstClockTime elapsed)
+{
+  if (before == 0 && after == 0) {
+    g_print ("%" GST_TIME_FORMAT " - %u %s, bytes per object not available\n",
+        GST_TIME_ARGS (elapsed), count, what);
+  } else {
+    g_print ("%" GST_TIME_FORMAT " - %u %s, %.1f bytes each\n",
+        GST_TIME_ARGS (elapsed), count, what,
+        (gdouble) (after - before) / count);
+  }
+}
+
+gint
+main (gint argc, gchar * argv[])
+{
+  GstPad **pads;
+  GstElement *bin, *element;
+  GstSegment segment;
+  guint i, count = OBJECT_COUNT;
+  GstClockTime start, end;
+  gsize before, after;
+
+  gst_init (&argc, &argv);
+
+  if (argc > 1)
+    count = atoi (argv[1]);
+  if (count == 0)
+    count = 1;
+
+  pads = g_new0 (GstPad *, count);
+  gst_segment_init (&segment, GST_FORMAT_TIME);
+
+  /* pads as created by elements, never activated */
+  before = heap_used ();
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < count; i++)
+    pads[i] = gst_pad_new (NULL, GST_PAD_SRC);
+  end = gst_util_get_timestamp ();
+  after = heap_used ();
+  report ("idle pads", count, before, after, end - start);
+
+  for (i = 0; i < count; i++)
+    gst_object_unref (pads[i]);
+
+  /* active pads that carry the usual sticky events */
+  before = heap_used ();
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < count; i++) {
+    pads[i] = gst_pad_new (NULL, GST_PAD_SRC);
+    gst_pad_set_active (pads[i], TRUE);
+    gst_pad_push_event (pads[i], gst_event_new_stream_start ("mass-pads"));
+    gst_pad_push_event (pads[i], gst_event_new_segment (&segment));
+  }
+  end = gst_util_get_timestamp ();
+  after = heap_used ();
+  report ("active pads", count, before, after, end - start);
+
+  for (i = 0; i < count; i++) {
+    gst_pad_set_active (pads[i], FALSE);
+    gst_object_unref (pads[i]);
+  }
+  g_free (pads);
+
+  /* elements with their two pads, in a bin */
+  bin = gst_bin_new (NULL);
+  g_assert (bin);
+  element = gst_element_factory_make ("identity", NULL);
+  if (!element) {
+    g_print ("no element named \"identity\" found, aborting...\n");
+    return 1;
+  }
+  /* make sure the class is initialized before measuring */
+  gst_object_unref (element);
+
+  before = heap_used ();
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < count; i++) {
+    element = gst_element_factory_make ("identity", NULL);
+    gst_bin_add (GST_BIN (bin), element);
+  }
+  end = gst_util_get_timestamp ();
+  after = heap_used ();
+  report ("identity elements", count, before, after, end - start);
+
+  gst_object_unref (bin);
+
+  return 0;
+}
@@ -0,0 +1,296 @@
+/* GStreamer
+ *
+ * mass-pipelines.c: measure the cost of many small independent pipelines
+ * in one process
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Runs N pipelines of fakesrc ! identity ! queue ! fakesink side by side,
+ * for N = 1, 4, 16, ... up to the maximum given on the command line. For
+ * each N it reports the threads created, the resident memory per pipeline,
+ * the time a pipeline takes to preroll, the context switches per second
+ * while streaming and the time from the creation of a buffer in fakesrc to
+ * its arrival in fakesink.
+ *
+ * With sync, the buffers are timestamped and the sinks synchronize to the
+ * clock, the latency then includes the time the buffers wait in the queue
+ * for their render time. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <gst/gst.h>
+
+#ifdef G_OS_UNIX
+#include <unistd.h>
+#include <sys/resource.h>
+#endif
+
+#define MAX_PIPELINES (1024)
+#define BUFFER_COUNT (1000)
+/* keep the queues short so that the latency is not only the queue length */
+#define QUEUE_BUFFERS (4)
+/* with sync, buffers of BUFFER_SIZE bytes at BUFFER_RATE per second */
+#define BUFFER_SIZE (1000)
+#define BUFFER_RATE (100)
+
+typedef struct
+{
+  GstElement *pipeline;
+  GstBus *bus;
+
+  /* only written from the streaming thread of the sink */
+  guint64 latency_sum;
+  guint64 latency_max;
+  guint buffers;
+} Pipeline;
+
+/* buffers created while prerolling only count from here */
+static GstClockTime streaming_start;
+
+/* number of threads in the process, 0 if not available */
+static guint
+thread_count (void)
+{
+  guint count = 0;
+#ifdef __linux__
+  GDir *dir;
+
+  if ((dir = g_dir_open ("/proc/self/task", 0, NULL))) {
+    while (g_dir_read_name (dir))
+      count++;
+    g_dir_close (dir);
+  }
+#endif
+  return count;
+}
+
+/* resident memory of the process in bytes, 0 if not available */
+static gsize
+resident_size (void)
+{
+  gsize rss = 0;
+#ifdef __linux__
+  gchar *contents;
+  gulong size, resident;
+
+  if (g_file_get_contents ("/proc/self/statm", &contents, NULL, NULL)) {
+    if (sscanf (contents, "%lu %lu", &size, &resident) == 2)
+      rss = (gsize) resident * sysconf (_SC_PAGESIZE);
+    g_free (contents);
+  }
+#endif
+  return rss;
+}
+
+/* voluntary and involuntary context switches of all threads */
+static guint64
+context_switches (void)
+{
+#ifdef G_OS_UNIX
+  struct rusage ru;
+
+  if (getrusage (RUSAGE_SELF, &ru) == 0)
+    return (guint64) ru.ru_nvcsw + (guint64) ru.ru_nivcsw;
+#endif
+  return 0;
+}
+
+static void
+src_handoff (GstElement * src, GstBuffer * buf, GstPad * pad, gpointer data)
+{
+  /* the buffer was just created, store the time it left fakesrc in a
+   * field nothing after it looks at */
+  GST_BUFFER_OFFSET_END (buf) = gst_util_get_timestamp ();
+}
+
+static void
+sink_handoff (GstElement * sink, GstBuffer * buf, GstPad * pad,
+    Pipeline * p)
+{
+  guint64 latency;
+
+  latency = gst_util_get_timestamp () - MAX (GST_BUFFER_OFFSET_END (buf),
+      streaming_start);
+  p->latency_sum += latency;
+  p->latency_max = MAX (p->latency_max, latency);
+  p->buffers++;
+}
+
+static void
+pipeline_init (Pipeline * p, guint buffers, gboolean sync)
+{
+  GstElement *src, *identity, *queue, *sink;
+
+  memset (p, 0, sizeof (Pipeline));
+
+  p->pipeline = gst_pipeline_new (NULL);
+  src = gst_element_factory_make ("fakesrc", NULL);
+  identity = gst_element_factory_make ("identity", NULL);
+  queue = gst_element_factory_make ("queue", NULL);
+  sink = gst_element_factory_make ("fakesink", NULL);
+  g_assert (src && identity && queue && sink);
+
+  g_object_set (src, "num-buffers", buffers, "signal-handoffs", TRUE, NULL);
+  if (sync) {
+    g_object_set (src, "sizetype", 2, "sizemax", BUFFER_SIZE,
+        "datarate", BUFFER_SIZE * BUFFER_RATE, NULL);
+  }
+  g_object_set (identity, "silent", TRUE, NULL);
+  g_object_set (queue, "max-size-buffers", QUEUE_BUFFERS, "max-size-bytes", 0,
+      "max-size-time", (guint64) 0, NULL);
+  g_object_set (sink, "sync", sync, "signal-handoffs", TRUE, NULL);
+
+  g_signal_connect (src, "handoff", G_CALLBACK (src_handoff), NULL);
+  g_signal_connect (sink, "handoff", G_CALLBACK (sink_handoff), p);
+
+  gst_bin_add_many (GST_BIN (p->pipeline), src, identity, queue, sink, NULL);
+  if (!gst_element_link_many (src, identity, queue, sink, NULL))
+    g_assert_not_reached ();
+
+  p->bus = gst_element_get_bus (p->pipeline);
+}
+
+static void
+pipeline_clear (Pipeline * p)
+{
+  gst_element_set_state (p->pipeline, GST_STATE_NULL);
+  gst_object_unref (p->bus);
+  gst_object_unref (p->pipeline);
+}
+
+static void
+run (guint n_pipelines, guint buffers, gboolean sync)
+{
+  Pipeline *pipelines;
+  GstMessage *msg;
+  guint i, threads_before, threads;
+  gsize rss_before, rss_created, rss_running;
+  guint64 switches, latency_sum = 0, latency_max = 0, n_buffers = 0;
+  GstClockTime start, end, preroll, preroll_max = 0, preroll_sum = 0;
+
+  threads_before = thread_count ();
+  rss_before = resident_size ();
+
+  pipelines = g_new (Pipeline, n_pipelines);
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < n_pipelines; i++)
+    pipeline_init (&pipelines[i], buffers, sync);
+  end = gst_util_get_timestamp ();
+  rss_created = resident_size ();
+
+  g_print ("%" GST_TIME_FORMAT " - creating %u pipelines\n",
+      GST_TIME_ARGS (end - start), n_pipelines);
+
+  /* preroll one after the other, this starts all the streaming threads */
+  for (i = 0; i < n_pipelines; i++) {
+    start = gst_util_get_timestamp ();
+    if (gst_element_set_state (pipelines[i].pipeline,
+            GST_STATE_PAUSED) == GST_STATE_CHANGE_FAILURE)
+      g_assert_not_reached ();
+    if (gst_element_get_state (pipelines[i].pipeline, NULL, NULL,
+            GST_CLOCK_TIME_NONE) == GST_STATE_CHANGE_FAILURE)
+      g_assert_not_reached ();
+    preroll = gst_util_get_timestamp () - start;
+    preroll_sum += preroll;
+    preroll_max = MAX (preroll_max, preroll);
+  }
+  threads = thread_count ();
+  rss_running = resident_size ();
+
+  g_print ("%" GST_TIME_FORMAT " - average preroll, %" GST_TIME_FORMAT
+      " max\n", GST_TIME_ARGS (preroll_sum / n_pipelines),
+      GST_TIME_ARGS (preroll_max));
+  if (threads_before > 0)
+    g_print ("%d threads created, %.2f per pipeline\n",
+        (gint) (threads - threads_before),
+        (gdouble) (gint) (threads - threads_before) / n_pipelines);
+  if (rss_before > 0)
+    g_print ("%.1f KiB per pipeline created, %.1f KiB per pipeline "
+        "prerolled\n", ((gdouble) rss_created - rss_before) / 1024.0
+        / n_pipelines, ((gdouble) rss_running - rss_before) / 1024.0
+        / n_pipelines);
+
+  /* stream all of them at the same time */
+  switches = context_switches ();
+  start = streaming_start = gst_util_get_timestamp ();
+  for (i = 0; i < n_pipelines; i++) {
+    if (gst_element_set_state (pipelines[i].pipeline,
+            GST_STATE_PLAYING) == GST_STATE_CHANGE_FAILURE)
+      g_assert_not_reached ();
+  }
+  for (i = 0; i < n_pipelines; i++) {
+    msg = gst_bus_timed_pop_filtered (pipelines[i].bus, GST_CLOCK_TIME_NONE,
+        GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+    if (GST_MESSAGE_TYPE (msg) == GST_MESSAGE_ERROR)
+      g_assert_not_reached ();
+    gst_message_unref (msg);
+  }
+  end = gst_util_get_timestamp ();
+  switches = context_switches () - switches;
+
+  for (i = 0; i < n_pipelines; i++) {
+    latency_sum += pipelines[i].latency_sum;
+    latency_max = MAX (latency_max, pipelines[i].latency_max);
+    n_buffers += pipelines[i].buffers;
+  }
+
+  g_print ("%" GST_TIME_FORMAT " - putting %u buffers through each\n",
+      GST_TIME_ARGS (end - start), buffers);
+  g_print ("%.0f context switches per second\n",
+      (gdouble) switches * GST_SECOND / MAX (end - start, 1));
+  if (n_buffers > 0)
+    g_print ("%" GST_TIME_FORMAT " - average buffer latency, %"
+        GST_TIME_FORMAT " max\n", GST_TIME_ARGS (latency_sum / n_buffers),
+        GST_TIME_ARGS (latency_max));
+
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < n_pipelines; i++)
+    pipeline_clear (&pipelines[i]);
+  end = gst_util_get_timestamp ();
+  g_free (pipelines);
+
+  g_print ("%" GST_TIME_FORMAT " - shutting down %u pipelines\n",
+      GST_TIME_ARGS (end - start), n_pipelines);
+}
+
+gint
+main (gint argc, gchar * argv[])
+{
+  guint n, max_pipelines = MAX_PIPELINES, buffers = BUFFER_COUNT;
+  gboolean sync = FALSE;
+
+  gst_init (&argc, &argv);
+
+  if (argc > 1)
+    max_pipelines = atoi (argv[1]);
+  if (argc > 2)
+    buffers = atoi (argv[2]);
+  if (argc > 3)
+    sync = strcmp (argv[3], "sync") == 0;
+  if (max_pipelines == 0)
+    max_pipelines = 1;
+
+  for (n = 1; n <= max_pipelines; n *= 4) {
+    g_print ("*** benchmarking %u pipelines: fakesrc num-buffers=%u ! "
+        "identity ! queue ! fakesink sync=%s\n", n, buffers,
+        sync ? "true" : "false");
+    run (n, buffers, sync);
+  }
+
+  return 0;
+}
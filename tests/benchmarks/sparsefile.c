@@ -0,0 +1,117 @@
+/* GStreamer
+ *
+ * sparsefile.c: benchmark for range lookups in seek heavy access patterns
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <gst/gst.h>
+
+/* not public API for now */
+#include "../../plugins/elements/gstsparsefile.c"
+
+#define BLOCK_SIZE (4096)
+
+gint
+main (gint argc, gchar * argv[])
+{
+  GstSparseFile *file;
+  GstClockTime start, end;
+  GstClockTimeDiff dur;
+  guint8 data[BLOCK_SIZE] = { 0, };
+  gsize rstart, rstop;
+  guint *order;
+  gint i, nblocks, nlookups;
+  GRand *rand;
+
+  gst_init (&argc, &argv);
+
+  if (argc != 3) {
+    g_print ("usage: %s <nranges> <nlookups>\n", argv[0]);
+    exit (-1);
+  }
+
+  nblocks = atoi (argv[1]) * 2;
+  nlookups = atoi (argv[2]);
+
+  if (nblocks <= 0 || nlookups <= 0) {
+    g_print ("number of ranges and lookups must be greater than 0\n");
+    exit (-3);
+  }
+
+  rand = g_rand_new_with_seed (0);
+
+  /* only write the even blocks, in random order, as if the file was
+   * downloaded while seeking around. This leaves nranges ranges. */
+  order = g_new (guint, nblocks / 2);
+  for (i = 0; i < nblocks / 2; i++)
+    order[i] = i * 2;
+  for (i = nblocks / 2 - 1; i > 0; i--) {
+    guint j = g_rand_int_range (rand, 0, i + 1), tmp = order[i];
+
+    order[i] = order[j];
+    order[j] = tmp;
+  }
+
+  /* no fd, we only measure the range bookkeeping */
+  file = gst_sparse_file_new ();
+
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < nblocks / 2; i++)
+    gst_sparse_file_write (file, (gsize) order[i] * BLOCK_SIZE, data,
+        BLOCK_SIZE, NULL, NULL);
+  end = gst_util_get_timestamp ();
+  dur = GST_CLOCK_DIFF (start, end);
+  g_print ("*** total %" GST_TIME_FORMAT " - average %" GST_TIME_FORMAT
+      "  - Done writing %d blocks, %u ranges\n", GST_TIME_ARGS (dur),
+      GST_TIME_ARGS (dur / (nblocks / 2)), nblocks / 2,
+      gst_sparse_file_n_ranges (file));
+
+  /* random seeks, like a demuxer checking what it can read */
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < nlookups; i++) {
+    gsize offset = (gsize) g_rand_int_range (rand, 0, nblocks) * BLOCK_SIZE;
+
+    gst_sparse_file_get_range_before (file, offset, &rstart, &rstop);
+    gst_sparse_file_get_range_after (file, offset, &rstart, &rstop);
+    gst_sparse_file_read (file, offset, data, BLOCK_SIZE, NULL, NULL);
+  }
+  end = gst_util_get_timestamp ();
+  dur = GST_CLOCK_DIFF (start, end);
+  g_print ("*** total %" GST_TIME_FORMAT " - average %" GST_TIME_FORMAT
+      "  - Done %d random lookups\n", GST_TIME_ARGS (dur),
+      GST_TIME_ARGS (dur / nlookups), nlookups);
+
+  /* fill the holes, merging all ranges into one */
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < nblocks / 2; i++)
+    gst_sparse_file_write (file, (gsize) (order[i] + 1) * BLOCK_SIZE, data,
+        BLOCK_SIZE, NULL, NULL);
+  end = gst_util_get_timestamp ();
+  dur = GST_CLOCK_DIFF (start, end);
+  g_print ("*** total %" GST_TIME_FORMAT " - average %" GST_TIME_FORMAT
+      "  - Done filling %d holes, %u ranges\n", GST_TIME_ARGS (dur),
+      GST_TIME_ARGS (dur / (nblocks / 2)), nblocks / 2,
+      gst_sparse_file_n_ranges (file));
+
+  gst_sparse_file_free (file);
+  g_free (order);
+  g_rand_free (rand);
+
+  return 0;
+}
@@ -0,0 +1,122 @@
+/* GStreamer
+ *
+ * startcode.c: benchmark for start code scanning in GstByteReader and
+ * GstAdapter
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <gst/gst.h>
+#include <gst/base/gstbytereader.h>
+#include <gst/base/gstadapter.h>
+
+#define DATA_SIZE (1024 * 1024)
+#define BUFFER_SIZE (1316)
+
+gint
+main (gint argc, gchar * argv[])
+{
+  GstByteReader reader;
+  GstAdapter *adapter;
+  GstClockTime start, end;
+  GstClockTimeDiff dur;
+  guint8 *data;
+  guint i, nloops, nalsize, found;
+  gssize pos;
+  GRand *rand;
+
+  gst_init (&argc, &argv);
+
+  if (argc != 3) {
+    g_print ("usage: %s <nalsize> <nloops>\n", argv[0]);
+    exit (-1);
+  }
+
+  nalsize = atoi (argv[1]);
+  nloops = atoi (argv[2]);
+
+  if (nalsize < 4 || nloops <= 0) {
+    g_print ("nal size must be at least 4 and loops greater than 0\n");
+    exit (-3);
+  }
+
+  /* random payload with a start code every nalsize bytes, like an H.264
+   * elementary stream */
+  rand = g_rand_new_with_seed (0);
+  data = g_malloc (DATA_SIZE);
+  for (i = 0; i < DATA_SIZE; i++)
+    data[i] = g_rand_int_range (rand, 0, 256);
+  for (i = 0; i + 4 <= DATA_SIZE; i += nalsize) {
+    data[i] = data[i + 1] = 0;
+    data[i + 2] = 1;
+  }
+
+  start = gst_util_get_timestamp ();
+  found = 0;
+  for (i = 0; i < nloops; i++) {
+    guint off = 0;
+
+    gst_byte_reader_init (&reader, data, DATA_SIZE);
+    while ((pos = (gint) gst_byte_reader_find_start_code (&reader, off,
+                DATA_SIZE - off, NULL)) != -1) {
+      found++;
+      off = pos + 3;
+      if (off + 4 > DATA_SIZE)
+        break;
+    }
+  }
+  end = gst_util_get_timestamp ();
+  dur = GST_CLOCK_DIFF (start, end);
+  g_print ("*** total %" GST_TIME_FORMAT " - average %" GST_TIME_FORMAT
+      "  - Done byte reader scans, %u start codes\n", GST_TIME_ARGS (dur),
+      GST_TIME_ARGS (dur / nloops), found);
+
+  adapter = gst_adapter_new ();
+  start = gst_util_get_timestamp ();
+  found = 0;
+  for (i = 0; i < nloops; i++) {
+    gsize off = 0, avail;
+
+    for (avail = 0; avail < DATA_SIZE; avail += BUFFER_SIZE) {
+      gsize len = MIN (BUFFER_SIZE, DATA_SIZE - avail);
+
+      gst_adapter_push (adapter,
+          gst_buffer_new_wrapped_full (GST_MEMORY_FLAG_READONLY,
+              data + avail, len, 0, len, NULL, NULL));
+    }
+    while ((pos = gst_adapter_masked_scan_uint32_peek (adapter, 0xffffff00,
+                0x00000100, off, DATA_SIZE - off, NULL)) != -1) {
+      found++;
+      off = pos + 3;
+      if (off + 4 > DATA_SIZE)
+        break;
+    }
+    gst_adapter_clear (adapter);
+  }
+  end = gst_util_get_timestamp ();
+  dur = GST_CLOCK_DIFF (start, end);
+  g_print ("*** total %" GST_TIME_FORMAT " - average %" GST_TIME_FORMAT
+      "  - Done adapter scans, %u start codes\n", GST_TIME_ARGS (dur),
+      GST_TIME_ARGS (dur / nloops), found);
+
+  g_object_unref (adapter);
+  g_free (data);
+  g_rand_free (rand);
+
+  return 0;
+}
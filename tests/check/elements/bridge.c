@@ -0,0 +1,149 @@
+/* GStreamer
+ *
+ * unit test for bridgesink and bridgesrc
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <gst/check/gstcheck.h>
+#include <gst/check/gstharness.h>
+#include <gst/gst.h>
+
+GST_START_TEST (test_bridge_buffers)
+{
+  GstHarness *hsrc1, *hsrc2, *hsink;
+  GstBuffer *buf, *out;
+
+  hsrc1 = gst_harness_new ("bridgesrc");
+  gst_harness_play (hsrc1);
+  hsrc2 = gst_harness_new ("bridgesrc");
+  gst_harness_play (hsrc2);
+
+  hsink = gst_harness_new ("bridgesink");
+  gst_harness_set_src_caps_str (hsink, "mycaps");
+
+  /* all bridgesrcs get the very same buffer */
+  buf = gst_buffer_new_allocate (NULL, 16, NULL);
+  fail_unless_equals_int (gst_harness_push (hsink, gst_buffer_ref (buf)),
+      GST_FLOW_OK);
+
+  out = gst_harness_pull (hsrc1);
+  fail_unless (out == buf);
+  gst_buffer_unref (out);
+  out = gst_harness_pull (hsrc2);
+  fail_unless (out == buf);
+  gst_buffer_unref (out);
+  gst_buffer_unref (buf);
+
+  /* stream-start, caps and segment */
+  fail_unless_equals_int (gst_harness_events_received (hsrc1), 3);
+  fail_unless_equals_int (gst_harness_events_received (hsrc2), 3);
+
+  gst_harness_teardown (hsink);
+  gst_harness_teardown (hsrc1);
+  gst_harness_teardown (hsrc2);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_bridge_late_src)
+{
+  GstHarness *hsrc, *hsink;
+  GstEvent *event;
+  GstCaps *caps, *sink_caps;
+  GstBuffer *buf, *out;
+
+  hsink = gst_harness_new ("bridgesink");
+  gst_harness_set_src_caps_str (hsink, "mycaps");
+
+  /* nobody is listening */
+  fail_unless_equals_int (gst_harness_push (hsink, gst_buffer_new ()),
+      GST_FLOW_OK);
+
+  /* a new bridgesrc gets the sticky events first */
+  hsrc = gst_harness_new ("bridgesrc");
+  gst_harness_play (hsrc);
+
+  event = gst_harness_pull_event (hsrc);
+  fail_unless_equals_int (GST_EVENT_TYPE (event), GST_EVENT_STREAM_START);
+  gst_event_unref (event);
+  event = gst_harness_pull_event (hsrc);
+  fail_unless_equals_int (GST_EVENT_TYPE (event), GST_EVENT_CAPS);
+  gst_event_parse_caps (event, &caps);
+  sink_caps = gst_pad_get_current_caps (hsink->srcpad);
+  fail_unless (gst_caps_is_equal_fixed (caps, sink_caps));
+  gst_caps_unref (sink_caps);
+  gst_event_unref (event);
+  event = gst_harness_pull_event (hsrc);
+  fail_unless_equals_int (GST_EVENT_TYPE (event), GST_EVENT_SEGMENT);
+  gst_event_unref (event);
+
+  buf = gst_buffer_new ();
+  fail_unless_equals_int (gst_harness_push (hsink, gst_buffer_ref (buf)),
+      GST_FLOW_OK);
+  out = gst_harness_pull (hsrc);
+  fail_unless (out == buf);
+  gst_buffer_unref (out);
+  gst_buffer_unref (buf);
+
+  gst_harness_teardown (hsink);
+  gst_harness_teardown (hsrc);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_bridge_allocation)
+{
+  GstHarness *hsrc, *hsink;
+  GstQuery *query;
+  GstCaps *caps;
+
+  hsrc = gst_harness_new ("bridgesrc");
+  gst_harness_play (hsrc);
+  hsink = gst_harness_new ("bridgesink");
+  gst_harness_set_src_caps_str (hsink, "mycaps");
+
+  /* answered by the harness downstream of the bridgesrc */
+  caps = gst_caps_from_string ("mycaps");
+  query = gst_query_new_allocation (caps, FALSE);
+  fail_unless (gst_pad_peer_query (hsink->srcpad, query));
+  fail_unless_equals_int (gst_query_get_n_allocation_params (query), 1);
+  gst_query_unref (query);
+  gst_caps_unref (caps);
+
+  gst_harness_teardown (hsink);
+  gst_harness_teardown (hsrc);
+}
+
+GST_END_TEST;
+
+static Suite *
+bridge_suite (void)
+{
+  Suite *s = suite_create ("bridge");
+  TCase *tc_chain;
+
+  tc_chain = tcase_create ("general");
+  tcase_add_test (tc_chain, test_bridge_buffers);
+  tcase_add_test (tc_chain, test_bridge_late_src);
+  tcase_add_test (tc_chain, test_bridge_allocation);
+
+  suite_add_tcase (s, tc_chain);
+
+  return s;
+}
+
+GST_CHECK_MAIN (bridge)
@@ -252,6 +252,40 @@ GST_START_TEST (test_accept_caps_query)
 
 GST_END_TEST;
 
+GST_START_TEST (test_caps_property_change_after_query)
+{
+  GstElement *filter;
+  GstCaps *audio_caps, *video_caps, *caps;
+  GstPad *sinkpad;
+
+  filter = gst_check_setup_element ("capsfilter");
+  sinkpad = gst_element_get_static_pad (filter, "sink");
+
+  audio_caps = gst_caps_from_string ("audio/x-raw, rate=(int)44100");
+  video_caps = gst_caps_from_string ("video/x-raw, width=(int)320");
+
+  g_object_set (filter, "caps", audio_caps, NULL);
+  fail_unless (gst_pad_query_accept_caps (sinkpad, audio_caps));
+  fail_unless (gst_pad_query_accept_caps (sinkpad, audio_caps));
+  caps = gst_pad_query_caps (sinkpad, audio_caps);
+  fail_unless (gst_caps_is_equal (caps, audio_caps));
+  gst_caps_unref (caps);
+
+  /* the remembered results must not survive a filter change */
+  g_object_set (filter, "caps", video_caps, NULL);
+  fail_if (gst_pad_query_accept_caps (sinkpad, audio_caps));
+  caps = gst_pad_query_caps (sinkpad, audio_caps);
+  fail_unless (gst_caps_is_empty (caps));
+  gst_caps_unref (caps);
+
+  gst_caps_unref (audio_caps);
+  gst_caps_unref (video_caps);
+  gst_object_unref (sinkpad);
+  gst_check_teardown_element (filter);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_push_pending_events)
 {
   GstElement *filter;
@@ -481,6 +515,7 @@ capsfilter_suite (void)
   tcase_add_test (tc_chain, test_caps_property);
   tcase_add_test (tc_chain, test_caps_query);
   tcase_add_test (tc_chain, test_accept_caps_query);
+  tcase_add_test (tc_chain, test_caps_property_change_after_query);
   tcase_add_test (tc_chain, test_push_pending_events);
   tcase_add_test (tc_chain, test_caps_change_mode_delayed);
 
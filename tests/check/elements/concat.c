@@ -168,6 +168,61 @@ GST_START_TEST (test_concat_simple_time)
 
 GST_END_TEST;
 
+GST_START_TEST (test_concat_prebuffer)
+{
+  GstElement *concat;
+  GstPad *sink1, *sink2, *src, *output_sink;
+
+  got_eos = FALSE;
+  buffer_count = 0;
+  gst_segment_init (&current_segment, GST_FORMAT_UNDEFINED);
+
+  concat = gst_element_factory_make ("concat", NULL);
+  fail_unless (concat != NULL);
+  g_object_set (concat, "max-prebuffer-buffers", N_BUFFERS, NULL);
+
+  sink1 = gst_element_get_request_pad (concat, "sink_%u");
+  fail_unless (sink1 != NULL);
+
+  sink2 = gst_element_get_request_pad (concat, "sink_%u");
+  fail_unless (sink2 != NULL);
+
+  src = gst_element_get_static_pad (concat, "src");
+  output_sink = gst_pad_new ("sink", GST_PAD_SINK);
+  fail_unless (output_sink != NULL);
+  fail_unless (gst_pad_link (src, output_sink) == GST_PAD_LINK_OK);
+
+  gst_pad_set_chain_function (output_sink, output_chain_time);
+  gst_pad_set_event_function (output_sink, output_event_time);
+
+  gst_pad_set_active (output_sink, TRUE);
+  fail_unless (gst_element_set_state (concat,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS);
+
+  /* the second stream is kept completely without blocking */
+  push_buffers_time (sink2);
+  fail_unless_equals_int (buffer_count, 0);
+  fail_if (got_eos);
+
+  /* and sent with continuous running time when the first one is done */
+  push_buffers_time (sink1);
+  fail_unless (got_eos);
+  fail_unless_equals_int (buffer_count, 2 * N_BUFFERS);
+
+  gst_element_set_state (concat, GST_STATE_NULL);
+  gst_pad_unlink (src, output_sink);
+  gst_object_unref (src);
+  gst_element_release_request_pad (concat, sink1);
+  gst_object_unref (sink1);
+  gst_element_release_request_pad (concat, sink2);
+  gst_object_unref (sink2);
+  gst_pad_set_active (output_sink, FALSE);
+  gst_object_unref (output_sink);
+  gst_object_unref (concat);
+}
+
+GST_END_TEST;
+
 static GstFlowReturn
 output_chain_bytes (GstPad * pad, GstObject * parent, GstBuffer * buffer)
 {
@@ -300,6 +355,7 @@ concat_suite (void)
   tc_chain = tcase_create ("concat");
   tcase_add_test (tc_chain, test_concat_simple_time);
   tcase_add_test (tc_chain, test_concat_simple_bytes);
+  tcase_add_test (tc_chain, test_concat_prebuffer);
   suite_add_tcase (s, tc_chain);
 
   return s;
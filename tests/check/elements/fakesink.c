@@ -1168,6 +1168,45 @@ GST_START_TEST (test_last_message_deep_notify)
 
 GST_END_TEST;
 
+GST_START_TEST (test_stats)
+{
+  GstElement *pipe, *src, *sink;
+  GstStructure *stats;
+  GstMessage *m;
+  guint64 buffers, bytes;
+
+  pipe = gst_pipeline_new ("pipeline");
+  src = gst_element_factory_make ("fakesrc", NULL);
+  gst_util_set_object_arg (G_OBJECT (src), "sizetype", "fixed");
+  g_object_set (src, "num-buffers", NUM_BUFFERS, "sizemax", 10, NULL);
+  sink = gst_element_factory_make ("fakesink", NULL);
+  g_object_set (sink, "enable-stats", TRUE, NULL);
+
+  gst_bin_add_many (GST_BIN (pipe), src, sink, NULL);
+  fail_unless (gst_element_link (src, sink));
+
+  fail_unless_equals_int (gst_element_set_state (pipe, GST_STATE_PLAYING),
+      GST_STATE_CHANGE_ASYNC);
+
+  m = gst_bus_timed_pop_filtered (GST_ELEMENT_BUS (pipe), -1, GST_MESSAGE_EOS);
+  gst_message_unref (m);
+
+  g_object_get (sink, "stats", &stats, NULL);
+  fail_unless (gst_structure_get_uint64 (stats, "buffers", &buffers));
+  fail_unless (gst_structure_get_uint64 (stats, "bytes", &bytes));
+  fail_unless (gst_structure_has_field_typed (stats, "throughput",
+          G_TYPE_DOUBLE));
+  fail_unless_equals_uint64 (buffers, NUM_BUFFERS);
+  fail_unless_equals_uint64 (bytes, NUM_BUFFERS * 10);
+  gst_structure_free (stats);
+
+  fail_unless_equals_int (gst_element_set_state (pipe, GST_STATE_NULL),
+      GST_STATE_CHANGE_SUCCESS);
+  gst_object_unref (pipe);
+}
+
+GST_END_TEST;
+
 static Suite *
 fakesink_suite (void)
 {
@@ -1184,6 +1223,7 @@ fakesink_suite (void)
   tcase_add_test (tc_chain, test_position);
   tcase_add_test (tc_chain, test_notify_race);
   tcase_add_test (tc_chain, test_last_message_notify);
+  tcase_add_test (tc_chain, test_stats);
   tcase_skip_broken_test (tc_chain, test_last_message_deep_notify);
 
   return s;
@@ -166,6 +166,45 @@ GST_START_TEST (test_sizetype_fixed)
 
 GST_END_TEST;
 
+GST_START_TEST (test_pool_buffer_lists)
+{
+  GstElement *src;
+  GList *l;
+
+  src = setup_fakesrc ();
+
+  gst_util_set_object_arg (G_OBJECT (src), "data", "pool");
+  gst_util_set_object_arg (G_OBJECT (src), "sizetype", "fixed");
+  g_object_set (G_OBJECT (src), "sizemax", 1024, "buffer-list-size", 4,
+      "num-buffers", 10, NULL);
+
+  fail_unless (gst_element_set_state (src,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+
+  while (!have_eos) {
+    g_usleep (1000);
+  }
+
+  /* num-buffers counts the lists */
+  fail_unless_equals_int (g_list_length (buffers), 40);
+  for (l = buffers; l; l = l->next) {
+    GstBuffer *buf = l->data;
+
+    fail_unless_equals_int (gst_buffer_get_size (buf), 1024);
+    fail_unless (buf->pool != NULL);
+  }
+  gst_check_drop_buffers ();
+
+  fail_unless (gst_element_set_state (src,
+          GST_STATE_NULL) == GST_STATE_CHANGE_SUCCESS, "could not set to null");
+
+  /* cleanup */
+  cleanup_fakesrc (src);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_sizetype_random)
 {
   GstElement *src;
@@ -326,6 +365,7 @@ fakesrc_suite (void)
   tcase_add_test (tc_chain, test_sizetype_empty);
   tcase_add_test (tc_chain, test_sizetype_fixed);
   tcase_add_test (tc_chain, test_sizetype_random);
+  tcase_add_test (tc_chain, test_pool_buffer_lists);
   tcase_add_test (tc_chain, test_no_preroll);
   tcase_add_test (tc_chain, test_reuse_push);
 
@@ -118,6 +118,50 @@ GST_START_TEST (test_num_buffers)
 
 GST_END_TEST;
 
+GST_START_TEST (test_batch)
+{
+  GstElement *src;
+  gint pipe_fd[2];
+  gchar data[4096];
+  GList *l;
+
+#ifndef G_OS_WIN32
+  fail_if (pipe (pipe_fd) < 0);
+#else
+  fail_if (_pipe (pipe_fd, 8192, _O_BINARY) < 0);
+#endif
+
+  /* all data is available at once and ends up in one list */
+  memset (data, 0, 4096);
+  fail_unless_equals_int (write (pipe_fd[1], data, 4096), 4096);
+  close (pipe_fd[1]);
+
+  have_eos = FALSE;
+  src = setup_fdsrc ();
+  g_object_set (G_OBJECT (src), "fd", pipe_fd[0], "blocksize", 1024,
+      "batch-size", 8, NULL);
+  fail_unless (gst_element_set_state (src,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+
+  while (!have_eos)
+    g_usleep (1000);
+
+  fail_unless_equals_int (g_list_length (buffers), 4);
+  for (l = buffers; l; l = l->next)
+    fail_unless_equals_int (gst_buffer_get_size (l->data), 1024);
+  gst_check_drop_buffers ();
+
+  fail_unless (gst_element_set_state (src,
+          GST_STATE_NULL) == GST_STATE_CHANGE_SUCCESS, "could not set to null");
+
+  /* cleanup */
+  cleanup_fdsrc (src);
+  close (pipe_fd[0]);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_nonseeking)
 {
   GstElement *src;
@@ -206,6 +250,7 @@ fdsrc_suite (void)
   suite_add_tcase (s, tc_chain);
   tcase_add_test (tc_chain, test_num_buffers);
   tcase_add_test (tc_chain, test_nonseeking);
+  tcase_add_test (tc_chain, test_batch);
   tcase_add_test (tc_chain, test_seeking);
 
   return s;
@@ -24,6 +24,7 @@
 #endif
 
 #include <stdio.h>
+#include <string.h>
 
 #include <glib.h>
 #include <glib/gstdio.h>
@@ -370,6 +371,135 @@ GST_START_TEST (test_flush)
 
 GST_END_TEST;
 
+GST_START_TEST (test_async_write)
+{
+  GstElement *filesink;
+  gchar *tmp_fn;
+  GstSegment segment;
+
+  tmp_fn = create_temporary_file ();
+  if (tmp_fn == NULL)
+    return;
+  filesink = setup_filesink ();
+
+  GST_LOG ("using temp file '%s'", tmp_fn);
+  g_object_set (filesink, "location", tmp_fn, "io-mode", 1,
+      "max-bytes-in-flight", (guint64) 100, NULL);
+
+  fail_unless_equals_int (gst_element_set_state (filesink, GST_STATE_PLAYING),
+      GST_STATE_CHANGE_ASYNC);
+
+  fail_unless (gst_pad_push_event (mysrcpad,
+          gst_event_new_stream_start ("test")));
+
+  gst_segment_init (&segment, GST_FORMAT_BYTES);
+  fail_unless (gst_pad_push_event (mysrcpad, gst_event_new_segment (&segment)));
+
+  /* the position includes the bytes that are not written yet */
+  PUSH_BYTES (1);
+  PUSH_BYTES (99);
+  PUSH_BYTES (8800);
+  CHECK_QUERY_POSITION (filesink, GST_FORMAT_BYTES, 8900);
+  PUSH_BUFFER_LIST (2, 50);
+  CHECK_QUERY_POSITION (filesink, GST_FORMAT_BYTES, 9000);
+
+  /* seeking waits for the pending writes */
+  segment.start = 8800;
+  if (gst_pad_push_event (mysrcpad, gst_event_new_segment (&segment))) {
+    CHECK_QUERY_POSITION (filesink, GST_FORMAT_BYTES, 8800);
+    CHECK_WRITTEN_BYTES (8900, 50, 9000);
+    PUSH_BYTES (1);
+    PUSH_BYTES (9256);
+    CHECK_QUERY_POSITION (filesink, GST_FORMAT_BYTES, 18057);
+  }
+
+  /* EOS waits until everything is written */
+  fail_unless (gst_pad_push_event (mysrcpad, gst_event_new_eos ()));
+  CHECK_WRITTEN_BYTES (8801, 9256, 18057);
+
+  fail_unless_equals_int (gst_element_set_state (filesink, GST_STATE_NULL),
+      GST_STATE_CHANGE_SUCCESS);
+
+  cleanup_filesink (filesink);
+
+  g_remove (tmp_fn);
+  g_free (tmp_fn);
+}
+
+GST_END_TEST;
+
+static GstPadProbeReturn
+count_fd_chunk_buffers (GstPad * pad, GstPadProbeInfo * info, gpointer data)
+{
+  GstBuffer *buf = GST_PAD_PROBE_INFO_BUFFER (info);
+  guint *count = data;
+
+  if (gst_memory_is_type (gst_buffer_peek_memory (buf, 0), "FdChunkMemory"))
+    (*count)++;
+
+  return GST_PAD_PROBE_OK;
+}
+
+GST_START_TEST (test_filesrc_sendfile)
+{
+  GstElement *pipe, *src, *sink;
+  GstMessage *msg;
+  GstPad *pad;
+  gchar *in_fn, *out_fn, *in_data, *out_data;
+  gsize i, size = 100 * 1024 + 123, out_size;
+  guint count = 0;
+
+  in_fn = create_temporary_file ();
+  out_fn = create_temporary_file ();
+  if (in_fn == NULL || out_fn == NULL)
+    return;
+
+  in_data = g_malloc (size);
+  for (i = 0; i < size; i++)
+    in_data[i] = i % 251;
+  fail_unless (g_file_set_contents (in_fn, in_data, size, NULL));
+
+  pipe = gst_pipeline_new (NULL);
+  src = gst_element_factory_make ("filesrc", NULL);
+  sink = gst_element_factory_make ("filesink", NULL);
+  g_object_set (src, "location", in_fn, "blocksize", 4096, NULL);
+  g_object_set (sink, "location", out_fn, NULL);
+  gst_bin_add_many (GST_BIN (pipe), src, sink, NULL);
+  fail_unless (gst_element_link (src, sink));
+
+  pad = gst_element_get_static_pad (sink, "sink");
+  gst_pad_add_probe (pad, GST_PAD_PROBE_TYPE_BUFFER, count_fd_chunk_buffers,
+      &count, NULL);
+  gst_object_unref (pad);
+
+  fail_if (gst_element_set_state (pipe, GST_STATE_PLAYING) ==
+      GST_STATE_CHANGE_FAILURE);
+  msg = gst_bus_timed_pop_filtered (GST_ELEMENT_BUS (pipe), -1,
+      GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  fail_unless_equals_int (GST_MESSAGE_TYPE (msg), GST_MESSAGE_EOS);
+  gst_message_unref (msg);
+  gst_element_set_state (pipe, GST_STATE_NULL);
+  gst_object_unref (pipe);
+
+#ifdef HAVE_SYS_SENDFILE_H
+  /* filesink asked for file backed memory and sent it with sendfile() */
+  fail_unless (count > 0);
+#endif
+
+  fail_unless (g_file_get_contents (out_fn, &out_data, &out_size, NULL));
+  fail_unless_equals_uint64 (out_size, size);
+  fail_unless (memcmp (in_data, out_data, size) == 0);
+
+  g_free (out_data);
+  g_free (in_data);
+  g_remove (in_fn);
+  g_remove (out_fn);
+  g_free (in_fn);
+  g_free (out_fn);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_coverage)
 {
   GstElement *filesink;
@@ -485,6 +615,8 @@ filesink_suite (void)
   tcase_add_test (tc_chain, test_uri_interface);
   tcase_add_test (tc_chain, test_seeking);
   tcase_add_test (tc_chain, test_flush);
+  tcase_add_test (tc_chain, test_async_write);
+  tcase_add_test (tc_chain, test_filesrc_sendfile);
 
   return s;
 }
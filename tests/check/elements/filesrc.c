@@ -18,6 +18,10 @@
  * Boston, MA 02110-1301, USA.
  */
 
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
 #include <unistd.h>
 #include <sys/types.h>
 #include <sys/stat.h>
@@ -298,6 +302,74 @@ GST_START_TEST (test_pull)
 
 GST_END_TEST;
 
+GST_START_TEST (test_pull_mmap)
+{
+  GstElement *src;
+  GstPad *pad;
+  GstFlowReturn ret;
+  GstBuffer *buffer1, *buffer2;
+  GstMapInfo info;
+  gchar *contents;
+  gsize size;
+
+  fail_unless (g_file_get_contents (TESTFILE, &contents, &size, NULL));
+  fail_unless (size > 200);
+
+  src = setup_filesrc ();
+
+  g_object_set (G_OBJECT (src), "location", TESTFILE, "use-mmap", TRUE,
+      "mmapsize", (guint64) 64, NULL);
+  fail_unless (gst_element_set_state (src,
+          GST_STATE_READY) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to ready");
+
+  pad = gst_element_get_static_pad (src, "src");
+  fail_unless (pad != NULL);
+  fail_unless (gst_pad_activate_mode (pad, GST_PAD_MODE_PULL, TRUE));
+  fail_unless (gst_element_set_state (src,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+
+  /* the data points into the mapped file and can't be written */
+  buffer1 = NULL;
+  ret = gst_pad_get_range (pad, 0, 100, &buffer1);
+  fail_unless (ret == GST_FLOW_OK);
+  fail_unless (gst_buffer_get_size (buffer1) == 100);
+  fail_unless (GST_MEMORY_IS_READONLY (gst_buffer_peek_memory (buffer1, 0)));
+  fail_unless (gst_buffer_map (buffer1, &info, GST_MAP_READ));
+  fail_unless (memcmp (info.data, contents, 100) == 0);
+  gst_buffer_unmap (buffer1, &info);
+
+  /* reading outside of the window maps a new one, the first buffer stays
+   * valid */
+  buffer2 = NULL;
+  ret = gst_pad_get_range (pad, size - 50, 100, &buffer2);
+  fail_unless (ret == GST_FLOW_OK);
+  fail_unless (gst_buffer_get_size (buffer2) == 50);
+  fail_unless (gst_buffer_map (buffer2, &info, GST_MAP_READ));
+  fail_unless (memcmp (info.data, contents + size - 50, 50) == 0);
+  gst_buffer_unmap (buffer2, &info);
+  gst_buffer_unref (buffer2);
+
+  ret = gst_pad_get_range (pad, size, 10, &buffer2);
+  fail_unless (ret == GST_FLOW_EOS);
+
+  fail_unless (gst_element_set_state (src,
+          GST_STATE_NULL) == GST_STATE_CHANGE_SUCCESS, "could not set to null");
+
+  /* still mapped after stopping */
+  fail_unless (gst_buffer_map (buffer1, &info, GST_MAP_READ));
+  fail_unless (memcmp (info.data, contents, 100) == 0);
+  gst_buffer_unmap (buffer1, &info);
+  gst_buffer_unref (buffer1);
+
+  gst_object_unref (pad);
+  cleanup_filesrc (src);
+  g_free (contents);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_coverage)
 {
   GstElement *src;
@@ -530,6 +602,9 @@ filesrc_suite (void)
   tcase_add_test (tc_chain, test_seeking);
   tcase_add_test (tc_chain, test_reverse);
   tcase_add_test (tc_chain, test_pull);
+#ifdef HAVE_MMAP
+  tcase_add_test (tc_chain, test_pull_mmap);
+#endif
   tcase_add_test (tc_chain, test_coverage);
   tcase_add_test (tc_chain, test_uri_interface);
   tcase_add_test (tc_chain, test_uri_query);
@@ -373,6 +373,54 @@ GST_START_TEST (test_funnel_gap_event)
 
 GST_END_TEST;
 
+static gpointer
+push_buffer_thread (gpointer data)
+{
+  GstPad *pad = data;
+
+  return GINT_TO_POINTER (gst_pad_push (pad, gst_buffer_new ()));
+}
+
+GST_START_TEST (test_funnel_combine_pushes)
+{
+  struct TestData td;
+  GThread *thread;
+  GstFlowReturn ret;
+
+  setup_test_objects (&td, chain_ok);
+  g_object_set (td.funnel, "combine-pushes", TRUE, NULL);
+
+  bufcount = 0;
+
+  fail_unless (gst_pad_push (td.mysrc1, gst_buffer_new ()) == GST_FLOW_OK);
+  fail_unless (bufcount == 1);
+
+  /* while someone else pushes on the srcpad, the buffer is queued and the
+   * pushing thread doesn't block */
+  GST_PAD_STREAM_LOCK (td.funnelsrc);
+  thread = g_thread_new ("push", push_buffer_thread, td.mysrc2);
+  ret = GPOINTER_TO_INT (g_thread_join (thread));
+  fail_unless_equals_int (ret, GST_FLOW_OK);
+  fail_unless (bufcount == 1);
+  GST_PAD_STREAM_UNLOCK (td.funnelsrc);
+
+  /* the next push sends both */
+  fail_unless (gst_pad_push (td.mysrc1, gst_buffer_new ()) == GST_FLOW_OK);
+  fail_unless (bufcount == 3);
+
+  /* serialized events don't overtake queued buffers */
+  GST_PAD_STREAM_LOCK (td.funnelsrc);
+  thread = g_thread_new ("push", push_buffer_thread, td.mysrc2);
+  g_thread_join (thread);
+  GST_PAD_STREAM_UNLOCK (td.funnelsrc);
+  fail_unless (gst_pad_push_event (td.mysrc2, gst_event_new_gap (0, 1)));
+  fail_unless (bufcount == 4);
+
+  release_test_objects (&td);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_funnel_stress)
 {
   GstHarness *h0 = gst_harness_new_with_padnames ("funnel", "sink_0", "src");
@@ -418,6 +466,7 @@ funnel_suite (void)
   tcase_add_test (tc_chain, test_funnel_simple);
   tcase_add_test (tc_chain, test_funnel_eos);
   tcase_add_test (tc_chain, test_funnel_gap_event);
+  tcase_add_test (tc_chain, test_funnel_combine_pushes);
   tcase_add_test (tc_chain, test_funnel_stress);
   suite_add_tcase (s, tc_chain);
 
@@ -180,6 +180,38 @@ GST_START_TEST (test_stopping_element_unschedules_sync)
 
 GST_END_TEST;
 
+GST_START_TEST (test_pace_burst)
+{
+  GstHarness *h =
+      gst_harness_new_parse ("queue ! identity pace-rate=1000 pace-burst=1000");
+  GstTestClock *clock;
+  gint i;
+
+  gst_harness_use_testclock (h);
+  gst_harness_set_src_caps_str (h, "mycaps");
+
+  /* a full bucket lets the first 1000 bytes through without waiting */
+  for (i = 0; i < 11; i++)
+    gst_harness_push (h, gst_buffer_new_allocate (NULL, 100, NULL));
+
+  /* and only the 11th buffer waits for the clock */
+  fail_unless (gst_harness_wait_for_clock_id_waits (h, 1, 42));
+  fail_unless_equals_int (10, gst_harness_buffers_received (h));
+
+  /* 100 more bytes take 100ms at 1000 bytes per second */
+  fail_unless (gst_harness_crank_single_clock_wait (h));
+  for (i = 0; i < 11; i++)
+    gst_buffer_unref (gst_harness_pull (h));
+  clock = gst_harness_get_testclock (h);
+  fail_unless_equals_uint64 (100 * GST_MSECOND,
+      gst_clock_get_time (GST_CLOCK (clock)));
+  gst_object_unref (clock);
+
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
 static Suite *
 identity_suite (void)
 {
@@ -191,6 +223,7 @@ identity_suite (void)
   tcase_add_test (tc_chain, test_signal_handoffs);
   tcase_add_test (tc_chain, test_sync_on_timestamp);
   tcase_add_test (tc_chain, test_stopping_element_unschedules_sync);
+  tcase_add_test (tc_chain, test_pace_burst);
 
 
   return s;
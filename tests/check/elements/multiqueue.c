@@ -508,7 +508,7 @@ push_n_buffers (struct PadData *pad_data, gint num_buffers,
 }
 
 static void
-run_output_order_test (gint n_linked)
+run_output_order_test (gint n_linked, guint drain_threads)
 {
   /* This test creates a multiqueue with 2 linked output, and 3 outputs that
    * return 'not-linked' when data is pushed, then verifies that all buffers
@@ -541,6 +541,7 @@ run_output_order_test (gint n_linked)
       "max-size-time", (guint64) 0,
       "extra-size-bytes", (guint) 0,
       "extra-size-buffers", (guint) 0, "extra-size-time", (guint64) 0, NULL);
+  g_object_set (mq, "drain-threads", drain_threads, NULL);
 
   construct_n_pads (mq, pad_data, NPADS, n_linked);
   for (i = 0; i < NPADS; i++) {
@@ -595,8 +596,18 @@ run_output_order_test (gint n_linked)
 
 GST_START_TEST (test_output_order)
 {
-  run_output_order_test (2);
-  run_output_order_test (0);
+  run_output_order_test (2, 0);
+  run_output_order_test (0, 0);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_output_order_drain_thread)
+{
+  /* a single thread drains all pads in running time order, which is also
+   * the order the buffers were pushed in */
+  run_output_order_test (2, 1);
+  run_output_order_test (0, 1);
 }
 
 GST_END_TEST;
@@ -1503,6 +1514,7 @@ multiqueue_suite (void)
   /* Disabled, The test (and not multiqueue itself) is racy.
    * See https://bugzilla.gnome.org/show_bug.cgi?id=708661 */
   tcase_skip_broken_test (tc_chain, test_output_order);
+  tcase_add_test (tc_chain, test_output_order_drain_thread);
 
   tcase_add_test (tc_chain, test_not_linked_eos);
 
@@ -495,6 +495,176 @@ GST_START_TEST (test_leaky_downstream)
 
 GST_END_TEST;
 
+/* the offset identifies the buffer, it might get copied to set DISCONT */
+static void
+push_frame (guint64 offset, gboolean delta)
+{
+  GstBuffer *buffer;
+
+  buffer = gst_buffer_new_and_alloc (4);
+  GST_BUFFER_OFFSET (buffer) = offset;
+  if (delta)
+    GST_BUFFER_FLAG_SET (buffer, GST_BUFFER_FLAG_DELTA_UNIT);
+  gst_pad_push (mysrcpad, buffer);
+}
+
+/* set queue size to 3 buffers, leaking delta units
+ * push a keyframe, two deltas, a keyframe and a delta
+ * check that only the deltas got leaked, oldest first
+ */
+GST_START_TEST (test_leaky_downstream_delta)
+{
+  GstBuffer *buffer;
+  GstSegment segment;
+
+  g_object_set (G_OBJECT (queue), "max-size-buffers", 3, "leaky", 3, NULL);
+
+  block_src ();
+
+  UNDERRUN_LOCK ();
+  fail_unless (gst_element_set_state (queue,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+  UNDERRUN_WAIT ();
+  UNDERRUN_UNLOCK ();
+
+  gst_segment_init (&segment, GST_FORMAT_BYTES);
+  gst_pad_push_event (mysrcpad, gst_event_new_stream_start ("test"));
+  gst_pad_push_event (mysrcpad, gst_event_new_segment (&segment));
+
+  push_frame (0, FALSE);
+  push_frame (1, TRUE);
+  push_frame (2, TRUE);
+  push_frame (3, FALSE);
+  push_frame (4, TRUE);
+
+  UNDERRUN_LOCK ();
+  mysinkpad = setup_sink_pad (queue, &sinktemplate);
+  unblock_src ();
+  UNDERRUN_WAIT ();
+  UNDERRUN_UNLOCK ();
+
+  fail_unless_equals_int (g_list_length (buffers), 3);
+
+  buffer = g_list_nth (buffers, 0)->data;
+  fail_unless_equals_int (GST_BUFFER_OFFSET (buffer), 0);
+  fail_if (GST_BUFFER_FLAG_IS_SET (buffer, GST_BUFFER_FLAG_DISCONT));
+  buffer = g_list_nth (buffers, 1)->data;
+  fail_unless_equals_int (GST_BUFFER_OFFSET (buffer), 3);
+  fail_unless (GST_BUFFER_FLAG_IS_SET (buffer, GST_BUFFER_FLAG_DISCONT));
+  buffer = g_list_nth (buffers, 2)->data;
+  fail_unless_equals_int (GST_BUFFER_OFFSET (buffer), 4);
+
+  fail_unless (gst_element_set_state (queue,
+          GST_STATE_NULL) == GST_STATE_CHANGE_SUCCESS, "could not set to null");
+}
+
+GST_END_TEST;
+
+/* set queue size to 3 buffers, leaking GOPs
+ * push a keyframe, two deltas, then a keyframe and two deltas
+ * check that the whole first GOP got leaked
+ */
+GST_START_TEST (test_leaky_downstream_gop)
+{
+  GstBuffer *buffer;
+  GstSegment segment;
+  gint i;
+
+  g_object_set (G_OBJECT (queue), "max-size-buffers", 3, "leaky", 4, NULL);
+
+  block_src ();
+
+  UNDERRUN_LOCK ();
+  fail_unless (gst_element_set_state (queue,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+  UNDERRUN_WAIT ();
+  UNDERRUN_UNLOCK ();
+
+  gst_segment_init (&segment, GST_FORMAT_BYTES);
+  gst_pad_push_event (mysrcpad, gst_event_new_stream_start ("test"));
+  gst_pad_push_event (mysrcpad, gst_event_new_segment (&segment));
+
+  for (i = 0; i < 6; i++)
+    push_frame (i, i % 3 != 0);
+
+  UNDERRUN_LOCK ();
+  mysinkpad = setup_sink_pad (queue, &sinktemplate);
+  unblock_src ();
+  UNDERRUN_WAIT ();
+  UNDERRUN_UNLOCK ();
+
+  fail_unless_equals_int (g_list_length (buffers), 3);
+
+  for (i = 0; i < 3; i++) {
+    buffer = g_list_nth (buffers, i)->data;
+    fail_unless_equals_int (GST_BUFFER_OFFSET (buffer), i + 3);
+  }
+  buffer = g_list_nth (buffers, 0)->data;
+  fail_unless (GST_BUFFER_FLAG_IS_SET (buffer, GST_BUFFER_FLAG_DISCONT));
+
+  fail_unless (gst_element_set_state (queue,
+          GST_STATE_NULL) == GST_STATE_CHANGE_SUCCESS, "could not set to null");
+}
+
+GST_END_TEST;
+
+static GstFlowReturn
+chain_list_func (GstPad * pad, GstObject * parent, GstBufferList * list)
+{
+  GList **lists = g_object_get_data (G_OBJECT (pad), "lists");
+
+  *lists = g_list_append (*lists,
+      GUINT_TO_POINTER (gst_buffer_list_length (list)));
+  gst_buffer_list_unref (list);
+
+  return GST_FLOW_OK;
+}
+
+/* block the queue, push 5 buffers and check that the backlog is pushed as a
+ * single buffer list when downstream handles lists */
+GST_START_TEST (test_auto_buffer_list)
+{
+  GstSegment segment;
+  GList *lists = NULL;
+  gint i;
+
+  block_src ();
+
+  UNDERRUN_LOCK ();
+  fail_unless (gst_element_set_state (queue,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+  UNDERRUN_WAIT ();
+  UNDERRUN_UNLOCK ();
+
+  gst_segment_init (&segment, GST_FORMAT_BYTES);
+  gst_pad_push_event (mysrcpad, gst_event_new_stream_start ("test"));
+  gst_pad_push_event (mysrcpad, gst_event_new_segment (&segment));
+
+  for (i = 0; i < 5; i++)
+    push_frame (i, FALSE);
+
+  UNDERRUN_LOCK ();
+  mysinkpad = setup_sink_pad (queue, &sinktemplate);
+  gst_pad_set_chain_list_function (mysinkpad, chain_list_func);
+  g_object_set_data (G_OBJECT (mysinkpad), "lists", &lists);
+  unblock_src ();
+  UNDERRUN_WAIT ();
+  UNDERRUN_UNLOCK ();
+
+  fail_unless_equals_int (g_list_length (buffers), 0);
+  fail_unless_equals_int (g_list_length (lists), 1);
+  fail_unless_equals_int (GPOINTER_TO_UINT (lists->data), 5);
+  g_list_free (lists);
+
+  fail_unless (gst_element_set_state (queue,
+          GST_STATE_NULL) == GST_STATE_CHANGE_SUCCESS, "could not set to null");
+}
+
+GST_END_TEST;
+
 /* set queue size to 6 buffers and 7 seconds
  * push 7 buffers with and without duration
  * check current-level-time
@@ -1146,6 +1316,56 @@ GST_START_TEST (test_initial_events_nodelay)
 
 GST_END_TEST;
 
+static GstPadProbeReturn
+count_reconfigure_probe (GstPad * pad, GstPadProbeInfo * info,
+    gpointer user_data)
+{
+  if (GST_EVENT_TYPE (GST_PAD_PROBE_INFO_EVENT (info)) ==
+      GST_EVENT_RECONFIGURE)
+    g_atomic_int_inc ((gint *) user_data);
+
+  return GST_PAD_PROBE_OK;
+}
+
+GST_START_TEST (test_reconfigure_coalesced)
+{
+  GstSegment segment;
+  gint count = 0;
+  gint i;
+
+  mysinkpad = gst_check_setup_sink_pad (queue, &sinktemplate);
+  gst_pad_set_active (mysinkpad, TRUE);
+
+  gst_pad_add_probe (mysrcpad, GST_PAD_PROBE_TYPE_EVENT_UPSTREAM,
+      count_reconfigure_probe, &count, NULL);
+
+  fail_unless (gst_element_set_state (queue,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+
+  /* upstream did not renegotiate after the first one */
+  for (i = 0; i < 10; i++)
+    fail_unless (gst_pad_push_event (mysinkpad, gst_event_new_reconfigure ()));
+  fail_unless_equals_int (g_atomic_int_get (&count), 1);
+
+  /* once it did, the next one goes upstream again */
+  fail_unless (gst_pad_check_reconfigure (mysrcpad));
+  fail_unless (gst_pad_push_event (mysinkpad, gst_event_new_reconfigure ()));
+  fail_unless_equals_int (g_atomic_int_get (&count), 2);
+
+  /* and after data went through */
+  gst_segment_init (&segment, GST_FORMAT_BYTES);
+  gst_pad_push_event (mysrcpad, gst_event_new_stream_start ("test"));
+  gst_pad_push_event (mysrcpad, gst_event_new_segment (&segment));
+  fail_unless (gst_pad_push (mysrcpad, gst_buffer_new ()) == GST_FLOW_OK);
+  fail_unless (gst_pad_push_event (mysinkpad, gst_event_new_reconfigure ()));
+  fail_unless_equals_int (g_atomic_int_get (&count), 3);
+
+  gst_element_set_state (queue, GST_STATE_NULL);
+}
+
+GST_END_TEST;
+
 static Suite *
 queue_suite (void)
 {
@@ -1158,6 +1378,9 @@ queue_suite (void)
   tcase_add_test (tc_chain, test_non_leaky_overrun);
   tcase_add_test (tc_chain, test_leaky_upstream);
   tcase_add_test (tc_chain, test_leaky_downstream);
+  tcase_add_test (tc_chain, test_leaky_downstream_delta);
+  tcase_add_test (tc_chain, test_leaky_downstream_gop);
+  tcase_add_test (tc_chain, test_auto_buffer_list);
   tcase_add_test (tc_chain, test_time_level);
   tcase_add_test (tc_chain, test_time_level_task_not_started);
   tcase_add_test (tc_chain, test_queries_while_flushing);
@@ -1168,6 +1391,7 @@ queue_suite (void)
   tcase_add_test (tc_chain, test_sticky_not_linked);
   tcase_add_test (tc_chain, test_time_level_buffer_list);
   tcase_add_test (tc_chain, test_initial_events_nodelay);
+  tcase_add_test (tc_chain, test_reconfigure_coalesced);
 
   return s;
 }
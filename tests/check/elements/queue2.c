@@ -124,6 +124,72 @@ GST_START_TEST (test_simple_pipeline_ringbuffer)
 
 GST_END_TEST;
 
+static guint8 ring_pattern_byte;
+static gboolean ring_pattern_ok;
+
+static void
+ring_pattern_handoff (GstElement * sink, GstBuffer * buf, GstPad * pad,
+    gpointer user_data)
+{
+  GstMapInfo map;
+  gsize i;
+
+  gst_buffer_map (buf, &map, GST_MAP_READ);
+  for (i = 0; i < map.size; i++) {
+    if (map.data[i] != ring_pattern_byte++)
+      ring_pattern_ok = FALSE;
+  }
+  gst_buffer_unmap (buf, &map);
+}
+
+GST_START_TEST (test_simple_pipeline_ringbuffer_temp_file)
+{
+  GstElement *pipe, *queue2, *input, *output;
+  GstMessage *msg;
+  gchar *template;
+
+  ring_pattern_byte = 0;
+  ring_pattern_ok = TRUE;
+
+  pipe = gst_pipeline_new ("pipeline");
+
+  input = gst_element_factory_make ("fakesrc", NULL);
+  fail_unless (input != NULL, "failed to create 'fakesrc' element");
+  /* pattern-span, so corruption when wrapping around the ring shows up */
+  g_object_set (input, "num-buffers", 256, "sizetype", 3, "filltype", 5,
+      NULL);
+
+  output = gst_element_factory_make ("fakesink", NULL);
+  fail_unless (output != NULL, "failed to create 'fakesink' element");
+  g_object_set (output, "signal-handoffs", TRUE, NULL);
+  g_signal_connect (output, "handoff", G_CALLBACK (ring_pattern_handoff),
+      NULL);
+
+  queue2 = setup_queue2 (pipe, input, output);
+  template = g_build_filename (g_get_tmp_dir (), "gstqueue2-XXXXXX", NULL);
+  g_object_set (queue2, "ring-buffer-max-size", (guint64) 1024 * 50,
+      "temp-template", template, NULL);
+  g_free (template);
+
+  gst_element_set_state (pipe, GST_STATE_PLAYING);
+
+  msg = gst_bus_poll (GST_ELEMENT_BUS (pipe),
+      GST_MESSAGE_EOS | GST_MESSAGE_ERROR, -1);
+
+  fail_if (GST_MESSAGE_TYPE (msg) == GST_MESSAGE_ERROR,
+      "Expected EOS message, got ERROR message");
+  gst_message_unref (msg);
+
+  fail_unless (ring_pattern_ok, "data corrupted in the ring buffer");
+
+  GST_LOG ("Got EOS, cleaning up");
+
+  gst_element_set_state (pipe, GST_STATE_NULL);
+  gst_object_unref (pipe);
+}
+
+GST_END_TEST;
+
 static void
 do_test_simple_shutdown_while_running (guint64 ring_buffer_max_size)
 {
@@ -343,6 +409,7 @@ queue2_suite (void)
   tcase_add_test (tc_chain, test_simple_create_destroy);
   tcase_add_test (tc_chain, test_simple_pipeline);
   tcase_add_test (tc_chain, test_simple_pipeline_ringbuffer);
+  tcase_add_test (tc_chain, test_simple_pipeline_ringbuffer_temp_file);
   tcase_add_test (tc_chain, test_simple_shutdown_while_running);
   tcase_add_test (tc_chain, test_simple_shutdown_while_running_ringbuffer);
   tcase_add_test (tc_chain, test_filled_read);
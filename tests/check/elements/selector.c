@@ -381,6 +381,60 @@ GST_START_TEST (test_output_selector_buffer_count)
 
 GST_END_TEST;
 
+/* In multi-active mode every active src pad gets all buffers */
+GST_START_TEST (test_output_selector_multi_active)
+{
+  GList *output_pads = NULL, *input_pads = NULL;
+  GstElement *sel = gst_check_setup_element ("output-selector");
+  GstPad *input_pad = gst_check_setup_src_pad (sel, &srctemplate);
+  GstPad *selpad;
+  GstBuffer *buf;
+  gint i;
+
+  input_pads = g_list_append (input_pads, input_pad);
+  gst_pad_set_active (input_pad, TRUE);
+  for (i = 0; i < 3; i++)
+    output_pads = g_list_append (output_pads, setup_output_pad (sel, NULL));
+
+  g_object_set (sel, "multi-active", TRUE, NULL);
+
+  fail_unless (gst_element_set_state (sel,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+  push_newsegment_events (input_pads);
+
+  buf = gst_buffer_new_and_alloc (1);
+  push_input_buffers (input_pads, buf, 5);
+  count_output_buffers (output_pads, 5);
+
+  /* deactivate the last pad, the others keep receiving */
+  selpad = gst_pad_get_peer (GST_PAD (g_list_last (output_pads)->data));
+  g_object_set (selpad, "active", FALSE, NULL);
+  gst_object_unref (selpad);
+
+  push_input_buffers (input_pads, buf, 5);
+  gst_buffer_unref (buf);
+
+  for (i = 0; i < 3; i++) {
+    GstPad *output_pad = g_list_nth_data (output_pads, i);
+
+    fail_unless_equals_int (GPOINTER_TO_INT (g_object_get_data (G_OBJECT
+                (output_pad), "buffer_count")), i < 2 ? 10 : 5);
+  }
+
+  fail_unless (gst_element_set_state (sel,
+          GST_STATE_NULL) == GST_STATE_CHANGE_SUCCESS, "could not set to null");
+
+  gst_pad_set_active (input_pad, FALSE);
+  gst_check_teardown_src_pad (sel);
+  g_list_foreach (output_pads, (GFunc) cleanup_pad, sel);
+  g_list_free (output_pads);
+  g_list_free (input_pads);
+  gst_check_teardown_element (sel);
+}
+
+GST_END_TEST;
+
 /* Push buffers to input pads and check the 
    amount of buffers arrived to output pad */
 GST_START_TEST (test_input_selector_buffer_count)
@@ -622,6 +676,67 @@ GST_START_TEST (test_input_selector_switch_to_eos_stream)
 GST_END_TEST;
 
 
+static GstBuffer *
+input_selector_new_buffer (GstClockTime pts, gboolean keyframe)
+{
+  GstBuffer *buf = gst_buffer_new ();
+
+  GST_BUFFER_PTS (buf) = pts;
+  if (!keyframe)
+    GST_BUFFER_FLAG_SET (buf, GST_BUFFER_FLAG_DELTA_UNIT);
+
+  return buf;
+}
+
+GST_START_TEST (test_input_selector_cache_gop)
+{
+  GList *l;
+  gint i;
+
+  setup_input_selector_with_2_streams (2);
+  g_object_set (selector, "cache-gop", TRUE, NULL);
+
+  /* the inactive stream doesn't block, its GOP is kept */
+  fail_unless (gst_pad_push (stream1_pad, input_selector_new_buffer (0,
+              FALSE)) == GST_FLOW_OK);
+  for (i = 1; i < 4; i++)
+    fail_unless (gst_pad_push (stream1_pad,
+            input_selector_new_buffer (i * GST_SECOND,
+                i == 1)) == GST_FLOW_OK);
+  fail_unless (buffers == NULL);
+
+  input_selector_push_buffer (2, INPUT_SELECTOR_FORWARD);
+
+  /* after switching, stream1 starts from its last keyframe */
+  g_object_set (selector, "active-pad", GST_PAD_PEER (stream1_pad), NULL);
+  fail_unless (gst_pad_push (stream1_pad,
+          input_selector_new_buffer (4 * GST_SECOND, FALSE)) == GST_FLOW_OK);
+
+  fail_unless_equals_int (g_list_length (buffers), 4);
+  for (l = buffers, i = 1; l; l = l->next, i++) {
+    GstBuffer *buf = l->data;
+
+    fail_unless_equals_uint64 (GST_BUFFER_PTS (buf), i * GST_SECOND);
+    fail_unless_equals_int (GST_BUFFER_FLAG_IS_SET (buf,
+            GST_BUFFER_FLAG_DELTA_UNIT), i != 1);
+    fail_unless_equals_int (GST_BUFFER_FLAG_IS_SET (buf,
+            GST_BUFFER_FLAG_DISCONT), i == 1);
+  }
+  g_list_free_full (buffers, (GDestroyNotify) gst_buffer_unref);
+  buffers = NULL;
+
+  /* and continues normally */
+  fail_unless (gst_pad_push (stream1_pad,
+          input_selector_new_buffer (5 * GST_SECOND, FALSE)) == GST_FLOW_OK);
+  fail_unless_equals_int (g_list_length (buffers), 1);
+  g_list_free_full (buffers, (GDestroyNotify) gst_buffer_unref);
+  buffers = NULL;
+
+  teardown_input_selector_with_2_streams ();
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_output_selector_no_srcpad_negotiation)
 {
   GstElement *sel;
@@ -829,10 +944,12 @@ selector_suite (void)
 
   suite_add_tcase (s, tc_chain);
   tcase_add_test (tc_chain, test_output_selector_buffer_count);
+  tcase_add_test (tc_chain, test_output_selector_multi_active);
   tcase_add_test (tc_chain, test_input_selector_buffer_count);
   tcase_add_test (tc_chain, test_input_selector_empty_stream);
   tcase_add_test (tc_chain, test_input_selector_shorter_stream);
   tcase_add_test (tc_chain, test_input_selector_switch_to_eos_stream);
+  tcase_add_test (tc_chain, test_input_selector_cache_gop);
   tcase_add_test (tc_chain, test_output_selector_no_srcpad_negotiation);
 
   tc_chain = tcase_create ("output-selector-negotiation");
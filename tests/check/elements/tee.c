@@ -597,6 +597,94 @@ GST_START_TEST (test_flow_aggregation)
 
 GST_END_TEST;
 
+static GstFlowReturn
+_writable_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+{
+  GList **writable = g_object_get_data (G_OBJECT (pad), "writable");
+
+  *writable = g_list_append (*writable,
+      GINT_TO_POINTER (gst_buffer_is_writable (buffer)));
+  gst_buffer_unref (buffer);
+  return GST_FLOW_OK;
+}
+
+GST_START_TEST (test_writable_last)
+{
+  GstPad *mysrc, *mysink1, *mysink2;
+  GstPad *teesink, *teesrc1, *teesrc2;
+  GstElement *tee;
+  GstSegment segment;
+  GList *writable = NULL;
+
+  tee = gst_element_factory_make ("tee", NULL);
+  fail_unless (tee != NULL);
+  teesink = gst_element_get_static_pad (tee, "sink");
+  teesrc1 = gst_element_get_request_pad (tee, "src_%u");
+  teesrc2 = gst_element_get_request_pad (tee, "src_%u");
+
+  mysink1 = gst_pad_new ("mysink1", GST_PAD_SINK);
+  gst_pad_set_chain_function (mysink1, _writable_chain);
+  g_object_set_data (G_OBJECT (mysink1), "writable", &writable);
+  gst_pad_set_active (mysink1, TRUE);
+  mysink2 = gst_pad_new ("mysink2", GST_PAD_SINK);
+  gst_pad_set_chain_function (mysink2, _writable_chain);
+  g_object_set_data (G_OBJECT (mysink2), "writable", &writable);
+  gst_pad_set_active (mysink2, TRUE);
+
+  mysrc = gst_pad_new ("mysrc", GST_PAD_SRC);
+  gst_pad_set_active (mysrc, TRUE);
+  gst_segment_init (&segment, GST_FORMAT_BYTES);
+  gst_pad_push_event (mysrc, gst_event_new_stream_start ("test"));
+  gst_pad_push_event (mysrc, gst_event_new_segment (&segment));
+
+  fail_unless (gst_pad_link (mysrc, teesink) == GST_PAD_LINK_OK);
+  fail_unless (gst_pad_link (teesrc1, mysink1) == GST_PAD_LINK_OK);
+  fail_unless (gst_pad_link (teesrc2, mysink2) == GST_PAD_LINK_OK);
+
+  fail_unless (gst_element_set_state (tee,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS);
+
+  /* the last pad gets the reference of tee */
+  fail_unless (gst_pad_push (mysrc, gst_buffer_new ()) == GST_FLOW_OK);
+  fail_unless_equals_int (g_list_length (writable), 2);
+  fail_unless (GPOINTER_TO_INT (writable->data) == FALSE);
+  fail_unless (GPOINTER_TO_INT (writable->next->data) == TRUE);
+  g_list_free (writable);
+  writable = NULL;
+
+  /* the writable pad is pushed on last */
+  g_object_set (tee, "writable-pad", teesrc1, NULL);
+  fail_unless (gst_pad_push (mysrc, gst_buffer_new ()) == GST_FLOW_OK);
+  fail_unless_equals_int (g_list_length (writable), 2);
+  fail_unless (GPOINTER_TO_INT (writable->data) == FALSE);
+  fail_unless (GPOINTER_TO_INT (writable->next->data) == TRUE);
+  g_list_free (writable);
+  writable = NULL;
+
+  /* releasing the pad unsets the property */
+  fail_unless (gst_pad_unlink (teesrc1, mysink1) == TRUE);
+  gst_element_release_request_pad (tee, teesrc1);
+  gst_object_unref (teesrc1);
+  g_object_get (tee, "writable-pad", &teesrc1, NULL);
+  fail_unless (teesrc1 == NULL);
+
+  fail_unless (gst_element_set_state (tee,
+          GST_STATE_NULL) == GST_STATE_CHANGE_SUCCESS);
+
+  fail_unless (gst_pad_unlink (mysrc, teesink) == TRUE);
+  fail_unless (gst_pad_unlink (teesrc2, mysink2) == TRUE);
+  gst_element_release_request_pad (tee, teesrc2);
+  gst_object_unref (teesrc2);
+  gst_object_unref (teesink);
+  gst_object_unref (tee);
+
+  gst_object_unref (mysink1);
+  gst_object_unref (mysink2);
+  gst_object_unref (mysrc);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_request_pads)
 {
   GstElement *tee;
@@ -698,6 +786,90 @@ GST_START_TEST (test_allow_not_linked)
 
 GST_END_TEST;
 
+/* fakesrc ! tee parallel=true ! fakesink, without queues. The sinks block in
+ * preroll, so this only reaches PLAYING when tee pushes on all src pads from
+ * their own threads. */
+GST_START_TEST (test_parallel)
+{
+#define NUM_PARALLEL_SINKS 4
+#define NUM_PARALLEL_BUFFERS 50
+  GstElement *pipeline, *src, *tee;
+  GstElement *sinks[NUM_PARALLEL_SINKS];
+  GstPad *req_pads[NUM_PARALLEL_SINKS];
+  guint counts[NUM_PARALLEL_SINKS];
+  GstBus *bus;
+  GstMessage *msg;
+  gint i, policy;
+  guint64 dropped;
+
+  for (policy = 0; policy < 3; policy++) {
+    pipeline = gst_pipeline_new ("pipeline");
+    src = gst_check_setup_element ("fakesrc");
+    g_object_set (src, "num-buffers", NUM_PARALLEL_BUFFERS, NULL);
+    tee = gst_check_setup_element ("tee");
+    g_object_set (tee, "parallel", TRUE, "parallel-policy", policy,
+        "max-backlog", 2, NULL);
+    fail_unless (gst_bin_add (GST_BIN (pipeline), src));
+    fail_unless (gst_bin_add (GST_BIN (pipeline), tee));
+    fail_unless (gst_element_link (src, tee));
+
+    for (i = 0; i < NUM_PARALLEL_SINKS; ++i) {
+      GstPad *sinkpad;
+
+      counts[i] = 0;
+
+      sinks[i] = gst_check_setup_element ("fakesink");
+      fail_unless (gst_bin_add (GST_BIN (pipeline), sinks[i]));
+      g_object_set (sinks[i], "signal-handoffs", TRUE, NULL);
+      g_signal_connect (sinks[i], "handoff", (GCallback) handoff, &counts[i]);
+
+      req_pads[i] = gst_element_get_request_pad (tee, "src_%u");
+      fail_unless (req_pads[i] != NULL);
+
+      sinkpad = gst_element_get_static_pad (sinks[i], "sink");
+      fail_unless_equals_int (gst_pad_link (req_pads[i], sinkpad),
+          GST_PAD_LINK_OK);
+      gst_object_unref (sinkpad);
+    }
+
+    bus = gst_element_get_bus (pipeline);
+    fail_if (bus == NULL);
+    gst_element_set_state (pipeline, GST_STATE_PLAYING);
+
+    msg = gst_bus_poll (bus, GST_MESSAGE_EOS | GST_MESSAGE_ERROR, -1);
+    fail_if (GST_MESSAGE_TYPE (msg) != GST_MESSAGE_EOS);
+    gst_message_unref (msg);
+
+    g_object_get (tee, "dropped", &dropped, NULL);
+    /* fire-and-forget */
+    if (policy == 2) {
+      guint total = 0;
+
+      for (i = 0; i < NUM_PARALLEL_SINKS; ++i) {
+        fail_unless (counts[i] <= NUM_PARALLEL_BUFFERS);
+        total += counts[i];
+      }
+      fail_unless_equals_int (total + dropped,
+          NUM_PARALLEL_SINKS * NUM_PARALLEL_BUFFERS);
+    } else {
+      for (i = 0; i < NUM_PARALLEL_SINKS; ++i)
+        fail_unless_equals_int (counts[i], NUM_PARALLEL_BUFFERS);
+      fail_unless_equals_int (dropped, 0);
+    }
+
+    gst_element_set_state (pipeline, GST_STATE_NULL);
+    gst_object_unref (bus);
+
+    for (i = 0; i < NUM_PARALLEL_SINKS; ++i) {
+      gst_element_release_request_pad (tee, req_pads[i]);
+      gst_object_unref (req_pads[i]);
+    }
+    gst_object_unref (pipeline);
+  }
+}
+
+GST_END_TEST;
+
 static Suite *
 tee_suite (void)
 {
@@ -714,8 +886,10 @@ tee_suite (void)
   tcase_add_test (tc_chain, test_release_while_second_buffer_alloc);
   tcase_add_test (tc_chain, test_internal_links);
   tcase_add_test (tc_chain, test_flow_aggregation);
+  tcase_add_test (tc_chain, test_writable_last);
   tcase_add_test (tc_chain, test_request_pads);
   tcase_add_test (tc_chain, test_allow_not_linked);
+  tcase_add_test (tc_chain, test_parallel);
 
   return s;
 }
@@ -0,0 +1,117 @@
+/* GStreamer
+ *
+ * unit test for the typefind element
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <gst/check/gstcheck.h>
+#include <gst/check/gstharness.h>
+#include <gst/gst.h>
+
+#define TEST_MAGIC "GstTypeFindTest"
+
+static gint typefind_count;
+
+static void
+test_typefind_function (GstTypeFind * tf, gpointer user_data)
+{
+  const guint8 *data;
+
+  g_atomic_int_inc (&typefind_count);
+
+  data = gst_type_find_peek (tf, 0, strlen (TEST_MAGIC));
+  if (data && memcmp (data, TEST_MAGIC, strlen (TEST_MAGIC)) == 0)
+    gst_type_find_suggest_simple (tf, GST_TYPE_FIND_MAXIMUM,
+        "application/x-gst-typefind-test", NULL);
+}
+
+static GstBuffer *
+make_test_buffer (guint8 fill)
+{
+  GstBuffer *buf;
+  GstMapInfo map;
+
+  buf = gst_buffer_new_allocate (NULL, 4096, NULL);
+  gst_buffer_map (buf, &map, GST_MAP_WRITE);
+  memset (map.data, fill, map.size);
+  memcpy (map.data, TEST_MAGIC, strlen (TEST_MAGIC));
+  gst_buffer_unmap (buf, &map);
+
+  return buf;
+}
+
+static void
+run_typefind (gboolean use_cache, guint8 fill)
+{
+  GstHarness *h;
+  GstCaps *caps;
+
+  h = gst_harness_new ("typefind");
+  g_object_set (h->element, "use-cache", use_cache, NULL);
+  gst_harness_play (h);
+
+  fail_unless_equals_int (gst_harness_push (h, make_test_buffer (fill)),
+      GST_FLOW_OK);
+  gst_buffer_unref (gst_harness_pull (h));
+
+  g_object_get (h->element, "caps", &caps, NULL);
+  fail_unless (caps != NULL);
+  fail_unless (gst_structure_has_name (gst_caps_get_structure (caps, 0),
+          "application/x-gst-typefind-test"));
+  gst_caps_unref (caps);
+
+  gst_harness_teardown (h);
+}
+
+GST_START_TEST (test_typefind_cache)
+{
+  fail_unless (gst_type_find_register (NULL, "test/typefind-cache",
+          GST_RANK_PRIMARY, test_typefind_function, NULL, NULL, NULL, NULL));
+
+  run_typefind (TRUE, 0);
+  fail_unless_equals_int (typefind_count, 1);
+
+  /* same data, the typefind functions are not called again */
+  run_typefind (TRUE, 0);
+  fail_unless_equals_int (typefind_count, 1);
+
+  /* unless the cache is disabled */
+  run_typefind (FALSE, 0);
+  fail_unless_equals_int (typefind_count, 2);
+
+  /* or the start of the stream is different */
+  run_typefind (TRUE, 1);
+  fail_unless_equals_int (typefind_count, 3);
+  run_typefind (TRUE, 1);
+  fail_unless_equals_int (typefind_count, 3);
+}
+
+GST_END_TEST;
+
+static Suite *
+typefind_suite (void)
+{
+  Suite *s = suite_create ("typefind");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_typefind_cache);
+
+  return s;
+}
+
+GST_CHECK_MAIN (typefind);
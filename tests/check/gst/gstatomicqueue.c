@@ -31,6 +31,101 @@ GST_START_TEST (test_create_free)
 
 GST_END_TEST;
 
+GST_START_TEST (test_bounded_push_pop)
+{
+  GstAtomicQueue *aq;
+  gint i;
+
+  /* rounded up to 4 */
+  aq = gst_atomic_queue_new_bounded (3);
+
+  fail_unless (gst_atomic_queue_pop (aq) == NULL);
+  fail_unless (gst_atomic_queue_peek (aq) == NULL);
+
+  for (i = 1; i <= 4; i++)
+    fail_unless (gst_atomic_queue_try_push (aq, GINT_TO_POINTER (i)));
+  fail_if (gst_atomic_queue_try_push (aq, GINT_TO_POINTER (5)));
+  fail_unless_equals_int (gst_atomic_queue_length (aq), 4);
+
+  fail_unless_equals_int (GPOINTER_TO_INT (gst_atomic_queue_peek (aq)), 1);
+  fail_unless_equals_int (GPOINTER_TO_INT (gst_atomic_queue_pop (aq)), 1);
+  fail_unless (gst_atomic_queue_try_push (aq, GINT_TO_POINTER (5)));
+
+  /* wraps around */
+  for (i = 2; i <= 5; i++)
+    fail_unless_equals_int (GPOINTER_TO_INT (gst_atomic_queue_pop (aq)), i);
+  fail_unless (gst_atomic_queue_pop (aq) == NULL);
+  fail_unless_equals_int (gst_atomic_queue_length (aq), 0);
+
+  gst_atomic_queue_unref (aq);
+}
+
+GST_END_TEST;
+
+#define N_THREADS 4
+#define N_ITEMS 10000
+
+static gpointer
+bounded_writer (gpointer data)
+{
+  GstAtomicQueue *aq = data;
+  gint i;
+
+  /* never push NULL, it can't be told apart from an empty queue */
+  for (i = 1; i <= N_ITEMS; i++)
+    gst_atomic_queue_push (aq, GINT_TO_POINTER (i));
+
+  return NULL;
+}
+
+static gpointer
+bounded_reader (gpointer data)
+{
+  GstAtomicQueue *aq = data;
+  gint received = 0;
+  gint64 sum = 0;
+  gpointer item;
+
+  while (received < N_ITEMS) {
+    if ((item = gst_atomic_queue_pop (aq))) {
+      sum += GPOINTER_TO_INT (item);
+      received++;
+    } else {
+      g_thread_yield ();
+    }
+  }
+  return g_memdup (&sum, sizeof (sum));
+}
+
+GST_START_TEST (test_bounded_threads)
+{
+  GstAtomicQueue *aq;
+  GThread *writers[N_THREADS], *readers[N_THREADS];
+  gint64 total = 0;
+  gint i;
+
+  aq = gst_atomic_queue_new_bounded (16);
+
+  for (i = 0; i < N_THREADS; i++) {
+    readers[i] = g_thread_new ("reader", bounded_reader, aq);
+    writers[i] = g_thread_new ("writer", bounded_writer, aq);
+  }
+  for (i = 0; i < N_THREADS; i++) {
+    gint64 *sum;
+
+    g_thread_join (writers[i]);
+    sum = g_thread_join (readers[i]);
+    total += *sum;
+    g_free (sum);
+  }
+  fail_unless (total == (gint64) N_THREADS * N_ITEMS * (N_ITEMS + 1) / 2);
+  fail_unless (gst_atomic_queue_pop (aq) == NULL);
+
+  gst_atomic_queue_unref (aq);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_atomic_queue_suite (void)
 {
@@ -39,6 +134,8 @@ gst_atomic_queue_suite (void)
 
   suite_add_tcase (s, tc_chain);
   tcase_add_test (tc_chain, test_create_free);
+  tcase_add_test (tc_chain, test_bounded_push_pop);
+  tcase_add_test (tc_chain, test_bounded_threads);
 
   return s;
 }
@@ -704,6 +704,47 @@ GST_START_TEST (test_add_self)
 
 GST_END_TEST;
 
+GST_START_TEST (test_get_by_name)
+{
+  GstElement *bin, *child_bin, *e, *found;
+  gchar name[16];
+  gint i;
+
+  bin = gst_bin_new (NULL);
+  child_bin = gst_bin_new ("child");
+  fail_unless (gst_bin_add (GST_BIN (bin), child_bin));
+
+  for (i = 0; i < 1000; i++) {
+    g_snprintf (name, sizeof (name), "e%d", i);
+    e = gst_element_factory_make ("identity", name);
+    fail_unless (gst_bin_add (GST_BIN (i % 2 ? bin : child_bin), e));
+  }
+
+  /* names must be unique within a bin, not across bins */
+  e = gst_element_factory_make ("identity", "e1");
+  ASSERT_WARNING (fail_if (gst_bin_add (GST_BIN (bin), e)));
+  fail_unless (gst_bin_add (GST_BIN (child_bin), e));
+  fail_unless (gst_bin_remove (GST_BIN (child_bin), e));
+
+  found = gst_bin_get_by_name (GST_BIN (bin), "e500");
+  fail_unless (found != NULL);
+  fail_unless (GST_OBJECT_PARENT (found) == GST_OBJECT (child_bin));
+  fail_unless (gst_bin_get_by_name (GST_BIN (child_bin), "e501") == NULL);
+
+  /* the name can be used again after removal */
+  fail_unless (gst_bin_remove (GST_BIN (child_bin), found));
+  fail_unless (gst_bin_get_by_name (GST_BIN (bin), "e500") == NULL);
+  e = gst_element_factory_make ("identity", "e500");
+  fail_unless (gst_bin_add (GST_BIN (bin), e));
+  fail_unless (gst_bin_get_by_name (GST_BIN (bin), "e500") == e);
+  gst_object_unref (e);
+  gst_object_unref (found);
+
+  gst_object_unref (bin);
+}
+
+GST_END_TEST;
+
 
 /* g_print ("%10s: %4d => %4d\n", GST_OBJECT_NAME (msg->src), old, new); */
 
@@ -1531,6 +1572,398 @@ GST_END_TEST;
 
 
 
+GST_START_TEST (test_task_pool)
+{
+  GstElement *pipeline, *queue, *mq;
+  GstTaskPool *pool, *task_pool;
+  GstMessage *msg;
+  GstPad *pad;
+  GstBus *bus;
+
+  /* the source and queue tasks block on full queues downstream, make sure
+   * there is a thread left for the multiqueue */
+  pool = gst_work_stealing_task_pool_new (4);
+  gst_task_pool_prepare (pool, NULL);
+
+  pipeline = gst_parse_launch ("fakesrc num-buffers=100 ! queue name=q ! "
+      "multiqueue name=mq ! fakesink sync=false", NULL);
+  fail_unless (pipeline != NULL);
+  g_object_set (pipeline, "task-pool", pool, NULL);
+  g_object_get (pipeline, "task-pool", &task_pool, NULL);
+  fail_unless (task_pool == pool);
+  gst_object_unref (task_pool);
+
+  fail_unless (gst_element_set_state (pipeline, GST_STATE_PLAYING) !=
+      GST_STATE_CHANGE_FAILURE);
+
+  bus = gst_element_get_bus (pipeline);
+  msg = gst_bus_timed_pop_filtered (bus, GST_CLOCK_TIME_NONE,
+      GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  fail_unless_equals_int (GST_MESSAGE_TYPE (msg), GST_MESSAGE_EOS);
+  gst_message_unref (msg);
+  gst_object_unref (bus);
+
+  /* all streaming tasks were moved to the pool */
+  queue = gst_bin_get_by_name (GST_BIN (pipeline), "q");
+  pad = gst_element_get_static_pad (queue, "src");
+  fail_unless (gst_task_get_scheduleable (GST_PAD_TASK (pad)));
+  task_pool = gst_task_get_pool (GST_PAD_TASK (pad));
+  fail_unless (task_pool == pool);
+  gst_object_unref (task_pool);
+  gst_object_unref (pad);
+  gst_object_unref (queue);
+
+  mq = gst_bin_get_by_name (GST_BIN (pipeline), "mq");
+  pad = gst_element_get_static_pad (mq, "src_0");
+  fail_unless (gst_task_get_scheduleable (GST_PAD_TASK (pad)));
+  gst_object_unref (pad);
+  gst_object_unref (mq);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (pipeline);
+
+  gst_task_pool_cleanup (pool);
+  gst_object_unref (pool);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_coalesce_latency)
+{
+  GstElement *pipeline, *bin, *src;
+  GstMessage *msg;
+  GstBus *bus;
+  gint i;
+
+  pipeline = gst_pipeline_new (NULL);
+  bin = gst_bin_new (NULL);
+  src = gst_element_factory_make ("fakesrc", NULL);
+  fail_unless (gst_bin_add (GST_BIN (bin), src));
+  fail_unless (gst_bin_add (GST_BIN (pipeline), bin));
+  g_object_set (pipeline, "coalesce-latency", TRUE, NULL);
+  /* only the toplevel bin coalesces */
+  g_object_set (bin, "coalesce-latency", TRUE, NULL);
+
+  bus = gst_element_get_bus (pipeline);
+
+  for (i = 0; i < 3; i++)
+    gst_element_post_message (src, gst_message_new_latency (GST_OBJECT (src)));
+  msg = gst_bus_pop_filtered (bus, GST_MESSAGE_LATENCY);
+  fail_unless (msg != NULL);
+  fail_unless (GST_MESSAGE_SRC (msg) == GST_OBJECT (src));
+  gst_message_unref (msg);
+  fail_if (gst_bus_have_pending (bus));
+
+  /* after recalculating, the next LATENCY message is posted again */
+  gst_bin_recalculate_latency (GST_BIN (pipeline));
+  gst_element_post_message (src, gst_message_new_latency (GST_OBJECT (src)));
+  gst_element_post_message (src, gst_message_new_latency (GST_OBJECT (src)));
+  msg = gst_bus_pop_filtered (bus, GST_MESSAGE_LATENCY);
+  fail_unless (msg != NULL);
+  gst_message_unref (msg);
+  fail_if (gst_bus_have_pending (bus));
+
+  gst_object_unref (bus);
+  gst_object_unref (pipeline);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_parallel_state_changes)
+{
+  GstElement *pipeline, *sink;
+  gboolean parallel;
+  GstState state;
+  gint i;
+
+  pipeline = gst_parse_launch ("fakesrc num-buffers=10 ! tee name=t "
+      "t. ! queue ! fakesink name=s0 t. ! queue ! fakesink name=s1 "
+      "t. ! queue ! fakesink name=s2 t. ! queue ! fakesink name=s3", NULL);
+  fail_unless (pipeline != NULL);
+  g_object_set (pipeline, "parallel-state-changes", TRUE, NULL);
+  g_object_get (pipeline, "parallel-state-changes", &parallel, NULL);
+  fail_unless (parallel);
+
+  /* the second time the cached order is used */
+  for (i = 0; i < 2; i++) {
+    fail_unless (gst_element_set_state (pipeline, GST_STATE_PAUSED) !=
+        GST_STATE_CHANGE_FAILURE);
+    fail_unless_equals_int (gst_element_get_state (pipeline, &state, NULL,
+            GST_CLOCK_TIME_NONE), GST_STATE_CHANGE_SUCCESS);
+    fail_unless_equals_int (state, GST_STATE_PAUSED);
+
+    sink = gst_bin_get_by_name (GST_BIN (pipeline), "s3");
+    fail_unless_equals_int (GST_STATE (sink), GST_STATE_PAUSED);
+    gst_object_unref (sink);
+
+    fail_unless_equals_int (gst_element_set_state (pipeline, GST_STATE_NULL),
+        GST_STATE_CHANGE_SUCCESS);
+  }
+
+  gst_object_unref (pipeline);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_clone)
+{
+  GstElement *pipeline, *clone, *inner, *src, *orig, *e;
+  GstPad *pad, *peer;
+  gint num_buffers;
+
+  pipeline = gst_parse_launch ("fakesrc name=src num-buffers=3 ! "
+      "( name=inner identity name=id ) ! tee name=t ! queue ! "
+      "fakesink name=s0 sync=false t. ! queue ! fakesink name=s1 sync=false",
+      NULL);
+  fail_unless (pipeline != NULL);
+
+  clone = gst_bin_clone (GST_BIN (pipeline), "clone");
+  fail_unless (clone != NULL);
+  fail_unless (GST_IS_PIPELINE (clone));
+  fail_unless_equals_string (GST_OBJECT_NAME (clone), "clone");
+
+  src = gst_bin_get_by_name (GST_BIN (clone), "src");
+  fail_unless (src != NULL);
+  orig = gst_bin_get_by_name (GST_BIN (pipeline), "src");
+  fail_unless (src != orig);
+  gst_object_unref (orig);
+  g_object_get (src, "num-buffers", &num_buffers, NULL);
+  fail_unless_equals_int (num_buffers, 3);
+
+  /* the source is linked to the ghost pad of the inner bin */
+  inner = gst_bin_get_by_name (GST_BIN (clone), "inner");
+  fail_unless (inner != NULL);
+  pad = gst_element_get_static_pad (src, "src");
+  peer = gst_pad_get_peer (pad);
+  fail_unless (peer != NULL);
+  fail_unless (GST_IS_GHOST_PAD (peer));
+  fail_unless (GST_OBJECT_PARENT (peer) == GST_OBJECT (inner));
+  gst_object_unref (peer);
+  gst_object_unref (pad);
+  gst_object_unref (src);
+
+  e = gst_bin_get_by_name (GST_BIN (inner), "id");
+  fail_unless (e != NULL);
+  gst_object_unref (e);
+  gst_object_unref (inner);
+
+  /* the request pads of the tee were requested again */
+  e = gst_bin_get_by_name (GST_BIN (clone), "t");
+  fail_unless_equals_int (e->numsrcpads, 2);
+  gst_object_unref (e);
+
+  fail_unless (gst_element_set_state (clone, GST_STATE_PLAYING) !=
+      GST_STATE_CHANGE_FAILURE);
+  fail_unless (gst_element_get_state (clone, NULL, NULL,
+          GST_CLOCK_TIME_NONE) == GST_STATE_CHANGE_SUCCESS);
+  gst_element_set_state (clone, GST_STATE_NULL);
+
+  gst_object_unref (clone);
+  gst_object_unref (pipeline);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_iterate_snapshot)
+{
+  GstElement *bin, *src, *sink, *identity;
+  GstIterator *it, *copy;
+  GValue item = { 0, };
+  GstPad *pad;
+  guint count;
+
+  bin = gst_bin_new (NULL);
+  src = gst_element_factory_make ("fakesrc", NULL);
+  sink = gst_element_factory_make ("fakesink", NULL);
+  gst_bin_add_many (GST_BIN (bin), src, sink, NULL);
+
+  it = gst_bin_iterate_elements_snapshot (GST_BIN (bin));
+  ASSERT_OBJECT_REFCOUNT (src, "src", 2);
+
+  /* changes after the snapshot do not make it resync */
+  identity = gst_element_factory_make ("identity", NULL);
+  gst_bin_add (GST_BIN (bin), identity);
+  gst_object_ref (sink);
+  gst_bin_remove (GST_BIN (bin), sink);
+
+  copy = gst_iterator_copy (it);
+  count = 0;
+  while (gst_iterator_next (it, &item) == GST_ITERATOR_OK) {
+    fail_unless (g_value_get_object (&item) == src ||
+        g_value_get_object (&item) == sink);
+    g_value_reset (&item);
+    count++;
+  }
+  fail_unless_equals_int (count, 2);
+  fail_unless_equals_int (gst_iterator_next (copy, &item), GST_ITERATOR_OK);
+  g_value_reset (&item);
+  gst_iterator_free (it);
+  gst_iterator_free (copy);
+
+  /* freeing the iterators drops their refs */
+  ASSERT_OBJECT_REFCOUNT (src, "src", 1);
+  ASSERT_OBJECT_REFCOUNT (sink, "sink", 1);
+  gst_object_unref (sink);
+
+  it = gst_element_iterate_pads_snapshot (identity);
+  pad = gst_element_get_static_pad (identity, "src");
+  gst_element_remove_pad (identity, pad);
+  count = 0;
+  while (gst_iterator_next (it, &item) == GST_ITERATOR_OK) {
+    g_value_reset (&item);
+    count++;
+  }
+  fail_unless_equals_int (count, 2);
+  g_value_unset (&item);
+  gst_iterator_free (it);
+  ASSERT_OBJECT_REFCOUNT (pad, "pad", 1);
+  gst_object_unref (pad);
+
+  gst_object_unref (bin);
+}
+
+GST_END_TEST;
+
+/* a bin that counts the messages of its children it sees */
+typedef GstBin TestCountBin;
+typedef GstBinClass TestCountBinClass;
+
+static GType test_count_bin_get_type (void);
+G_DEFINE_TYPE (TestCountBin, test_count_bin, GST_TYPE_BIN);
+
+static gint count_bin_messages;
+
+static void
+test_count_bin_handle_message (GstBin * bin, GstMessage * message)
+{
+  g_atomic_int_inc (&count_bin_messages);
+  GST_BIN_CLASS (test_count_bin_parent_class)->handle_message (bin, message);
+}
+
+static void
+test_count_bin_class_init (TestCountBinClass * klass)
+{
+  klass->handle_message = test_count_bin_handle_message;
+}
+
+static void
+test_count_bin_init (TestCountBin * bin)
+{
+}
+
+static void
+post_element_message (GstElement * element)
+{
+  gst_element_post_message (element, gst_message_new_element (GST_OBJECT
+          (element), gst_structure_new_empty ("test")));
+}
+
+GST_START_TEST (test_post_message_direct)
+{
+  GstElement *pipeline, *outer, *inner, *identity;
+  GstBus *bus;
+  GstMessage *msg;
+
+  pipeline = gst_pipeline_new (NULL);
+  outer = g_object_new (test_count_bin_get_type (), NULL);
+  inner = gst_bin_new (NULL);
+  identity = gst_element_factory_make ("identity", NULL);
+  gst_bin_add (GST_BIN (inner), identity);
+  gst_bin_add (GST_BIN (outer), inner);
+  gst_bin_add (GST_BIN (pipeline), outer);
+  bus = gst_element_get_bus (pipeline);
+
+  /* the bin does not declare what it handles and sees everything */
+  post_element_message (identity);
+  fail_unless_equals_int (count_bin_messages, 1);
+  msg = gst_bus_pop_filtered (bus, GST_MESSAGE_ELEMENT);
+  fail_unless (msg != NULL);
+  fail_unless (GST_MESSAGE_SRC (msg) == GST_OBJECT (identity));
+  gst_message_unref (msg);
+
+  /* now element messages go straight to the pipeline bus */
+  gst_bin_class_set_handled_messages (g_type_class_peek
+      (test_count_bin_get_type ()), GST_MESSAGE_EOS);
+  post_element_message (identity);
+  fail_unless_equals_int (count_bin_messages, 1);
+  msg = gst_bus_pop_filtered (bus, GST_MESSAGE_ELEMENT);
+  fail_unless (msg != NULL);
+  fail_unless (GST_MESSAGE_SRC (msg) == GST_OBJECT (identity));
+  gst_message_unref (msg);
+
+  /* but still respect the accepted types of the buses in between */
+  gst_bus_set_accept_types (GST_ELEMENT_BUS (identity), GST_MESSAGE_EOS);
+  post_element_message (identity);
+  fail_unless (gst_bus_pop_filtered (bus, GST_MESSAGE_ELEMENT) == NULL);
+  gst_bus_set_accept_types (GST_ELEMENT_BUS (identity), GST_MESSAGE_ANY);
+
+  /* and handled types still go through the bins */
+  gst_element_post_message (identity,
+      gst_message_new_latency (GST_OBJECT (identity)));
+  fail_unless_equals_int (count_bin_messages, 2);
+
+  gst_object_unref (bus);
+  gst_object_unref (pipeline);
+}
+
+GST_END_TEST;
+
+#ifndef GST_DISABLE_GST_DEBUG
+GST_START_TEST (test_graph_snapshot)
+{
+  GstDebugGraphSnapshot *first, *second;
+  GstElement *pipeline, *src, *sink, *identity;
+  gchar *data;
+
+  pipeline = gst_pipeline_new (NULL);
+  src = gst_element_factory_make ("fakesrc", "src");
+  sink = gst_element_factory_make ("fakesink", "sink");
+  gst_bin_add_many (GST_BIN (pipeline), src, sink, NULL);
+  fail_unless (gst_element_link (src, sink));
+
+  first = gst_debug_graph_snapshot_new (GST_BIN (pipeline));
+  data = gst_debug_graph_snapshot_to_dot_data (first,
+      GST_DEBUG_GRAPH_SHOW_ALL);
+  fail_unless (g_str_has_prefix (data, "digraph pipeline {"));
+  fail_unless (strstr (data, "cluster_src_") != NULL);
+  fail_unless (strstr (data, "cluster_sink_") != NULL);
+  g_free (data);
+
+  /* everything is new without an earlier snapshot */
+  data = gst_debug_graph_snapshot_diff (NULL, first, 0);
+  fail_unless (strstr (data, "+element src_") != NULL);
+  fail_unless (strstr (data, "+link src_") != NULL);
+  g_free (data);
+
+  /* nothing changed */
+  second = gst_debug_graph_snapshot_new (GST_BIN (pipeline));
+  data = gst_debug_graph_snapshot_diff (first, second, 0);
+  fail_unless_equals_string (data, "");
+  g_free (data);
+  gst_debug_graph_snapshot_free (second);
+
+  /* insert an element */
+  identity = gst_element_factory_make ("identity", "identity");
+  gst_element_unlink (src, sink);
+  gst_bin_add (GST_BIN (pipeline), identity);
+  fail_unless (gst_element_link_many (src, identity, sink, NULL));
+
+  second = gst_debug_graph_snapshot_new (GST_BIN (pipeline));
+  data = gst_debug_graph_snapshot_diff (first, second, 0);
+  fail_unless (strstr (data, "-link src_") != NULL);
+  fail_unless (strstr (data, "+element identity_") != NULL);
+  fail_unless (strstr (data, "+pad identity_") != NULL);
+  fail_unless (strstr (data, "-element") == NULL);
+  g_free (data);
+
+  gst_debug_graph_snapshot_free (first);
+  gst_debug_graph_snapshot_free (second);
+  gst_object_unref (pipeline);
+}
+
+GST_END_TEST;
+#endif
+
 static Suite *
 gst_bin_suite (void)
 {
@@ -1553,6 +1986,7 @@ gst_bin_suite (void)
   tcase_add_test (tc_chain, test_state_change_error_message);
   tcase_add_test (tc_chain, test_add_linked);
   tcase_add_test (tc_chain, test_add_self);
+  tcase_add_test (tc_chain, test_get_by_name);
   tcase_add_test (tc_chain, test_iterate_sorted);
   tcase_add_test (tc_chain, test_link_structure_change);
   tcase_add_test (tc_chain, test_state_failure_remove);
@@ -1560,6 +1994,15 @@ gst_bin_suite (void)
   tcase_add_test (tc_chain, test_state_change_skip);
   tcase_add_test (tc_chain, test_duration_is_max);
   tcase_add_test (tc_chain, test_duration_unknown_overrides);
+  tcase_add_test (tc_chain, test_task_pool);
+  tcase_add_test (tc_chain, test_coalesce_latency);
+  tcase_add_test (tc_chain, test_parallel_state_changes);
+  tcase_add_test (tc_chain, test_clone);
+  tcase_add_test (tc_chain, test_iterate_snapshot);
+  tcase_add_test (tc_chain, test_post_message_direct);
+#ifndef GST_DISABLE_GST_DEBUG
+  tcase_add_test (tc_chain, test_graph_snapshot);
+#endif
 
   /* fails on OSX build bot for some reason, and is a bit silly anyway */
   if (0)
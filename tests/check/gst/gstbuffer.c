@@ -909,6 +909,156 @@ GST_START_TEST (test_parent_buffer_meta)
 
 GST_END_TEST;
 
+GST_START_TEST (test_no_merge)
+{
+  GstBuffer *buf, *copy;
+  GstMemory *mem;
+  guint8 data[64];
+  guint i, max, merges;
+
+  max = gst_buffer_get_max_memory ();
+  fail_unless (max < G_N_ELEMENTS (data));
+
+  for (i = 0; i < G_N_ELEMENTS (data); i++)
+    data[i] = i;
+
+  /* without the flag, the memory blocks are merged */
+  merges = gst_buffer_get_merge_count ();
+  buf = gst_buffer_new ();
+  for (i = 0; i <= max; i++)
+    gst_buffer_append_memory (buf,
+        gst_memory_new_wrapped (GST_MEMORY_FLAG_READONLY, data + i, 1, 0, 1,
+            NULL, NULL));
+  fail_unless (gst_buffer_n_memory (buf) <= max);
+  fail_unless (gst_buffer_get_merge_count () > merges);
+  gst_buffer_unref (buf);
+
+  /* with the flag the memory array grows and no memory is copied */
+  merges = gst_buffer_get_merge_count ();
+  buf = gst_buffer_new ();
+  GST_BUFFER_FLAG_SET (buf, GST_BUFFER_FLAG_NO_MERGE);
+  for (i = 1; i < G_N_ELEMENTS (data); i++)
+    gst_buffer_append_memory (buf,
+        gst_memory_new_wrapped (GST_MEMORY_FLAG_READONLY, data + i, 1, 0, 1,
+            NULL, NULL));
+  gst_buffer_prepend_memory (buf,
+      gst_memory_new_wrapped (GST_MEMORY_FLAG_READONLY, data, 1, 0, 1,
+          NULL, NULL));
+  fail_unless_equals_int (gst_buffer_n_memory (buf), G_N_ELEMENTS (data));
+  fail_unless_equals_int (gst_buffer_get_merge_count (), merges);
+  fail_unless_equals_int (gst_buffer_get_size (buf), G_N_ELEMENTS (data));
+  fail_unless (gst_buffer_memcmp (buf, 0, data, sizeof (data)) == 0);
+
+  for (i = 0; i < G_N_ELEMENTS (data); i++) {
+    GstMapInfo info;
+
+    mem = gst_buffer_peek_memory (buf, i);
+    fail_unless (gst_memory_map (mem, &info, GST_MAP_READ));
+    fail_unless (info.data == data + i);
+    gst_memory_unmap (mem, &info);
+  }
+
+  /* copies keep the flag and share all the memory */
+  copy = gst_buffer_copy (buf);
+  fail_unless (GST_BUFFER_FLAG_IS_SET (copy, GST_BUFFER_FLAG_NO_MERGE));
+  fail_unless_equals_int (gst_buffer_n_memory (copy), G_N_ELEMENTS (data));
+  fail_unless (gst_buffer_peek_memory (copy, 40) ==
+      gst_buffer_peek_memory (buf, 40));
+  gst_buffer_unref (copy);
+
+  gst_buffer_remove_memory_range (buf, 8, 48);
+  fail_unless_equals_int (gst_buffer_n_memory (buf), 16);
+  fail_unless_equals_int (gst_buffer_get_size (buf), 16);
+  gst_buffer_unref (buf);
+}
+
+GST_END_TEST;
+
+
+GST_START_TEST (test_map_memories)
+{
+  GstBuffer *buf;
+  GstMemory *mem, *sub;
+  GstMapInfo infos[4];
+
+  mem = gst_allocator_alloc (NULL, 100, NULL);
+  sub = gst_memory_share (mem, 10, 20);
+  fail_unless (GST_MEMORY_IS_READONLY (sub));
+
+  buf = gst_buffer_new ();
+  gst_buffer_append_memory (buf, gst_allocator_alloc (NULL, 50, NULL));
+  gst_buffer_append_memory (buf, sub);
+
+  fail_unless (gst_buffer_map_memories (buf, infos, G_N_ELEMENTS (infos)));
+  fail_unless (infos[0].memory == gst_buffer_peek_memory (buf, 0));
+  fail_unless_equals_int (infos[0].size, 50);
+  fail_unless (infos[1].memory == sub);
+  fail_unless_equals_int (infos[1].size, 20);
+  fail_unless (infos[2].memory == NULL);
+  fail_unless (infos[3].memory == NULL);
+
+  /* nothing was merged and the memories kept their refcount */
+  fail_unless_equals_int (gst_buffer_n_memory (buf), 2);
+  ASSERT_MINI_OBJECT_REFCOUNT (sub, "memory", 1);
+
+  /* a write map of the parent still fails while it's shared */
+  fail_if (gst_memory_is_writable (mem));
+
+  gst_buffer_unmap_memories (buf, infos, G_N_ELEMENTS (infos));
+
+  /* mappings from gst_memory_map() can be mixed with it */
+  fail_unless (gst_memory_map (sub, &infos[0], GST_MAP_READ));
+  fail_unless (gst_memory_map (sub, &infos[1], GST_MAP_READ));
+  fail_if (gst_memory_map (sub, &infos[2], GST_MAP_WRITE));
+  gst_memory_unmap (sub, &infos[1]);
+  gst_memory_unmap (sub, &infos[0]);
+
+  /* too few infos */
+  ASSERT_CRITICAL (gst_buffer_map_memories (buf, infos, 1));
+
+  gst_buffer_unref (buf);
+  gst_memory_unref (mem);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_headroom)
+{
+  GstAllocationParams params;
+  GstBuffer *buf, *sub;
+  gsize offset, maxsize;
+
+  gst_allocation_params_init (&params);
+  params.prefix = 16;
+  params.padding = 8;
+  buf = gst_buffer_new_allocate (NULL, 100, &params);
+  fail_unless (buf != NULL);
+
+  fail_unless (gst_buffer_prepend_headroom (buf, 12));
+  fail_unless_equals_int (gst_buffer_get_sizes (buf, &offset, &maxsize), 112);
+  fail_unless_equals_int (offset, 4);
+  fail_unless (gst_buffer_append_tailroom (buf, 8));
+  fail_unless_equals_int (gst_buffer_get_size (buf), 120);
+  fail_unless_equals_int (gst_buffer_n_memory (buf), 1);
+
+  /* not enough room left, buffer stays untouched */
+  fail_if (gst_buffer_prepend_headroom (buf, 5));
+  fail_if (gst_buffer_append_tailroom (buf, 1));
+  fail_unless_equals_int (gst_buffer_get_size (buf), 120);
+  fail_unless (gst_buffer_prepend_headroom (buf, 4));
+
+  /* memory shared with another buffer can not grow */
+  gst_buffer_resize (buf, 8, 100);
+  sub = gst_buffer_copy_region (buf, GST_BUFFER_COPY_MEMORY, 0, 100);
+  fail_if (gst_buffer_prepend_headroom (buf, 8));
+  fail_if (gst_buffer_append_tailroom (buf, 8));
+  gst_buffer_unref (sub);
+  fail_unless (gst_buffer_prepend_headroom (buf, 8));
+
+  gst_buffer_unref (buf);
+}
+
+GST_END_TEST;
 
 static Suite *
 gst_buffer_suite (void)
@@ -933,6 +1083,9 @@ gst_buffer_suite (void)
   tcase_add_test (tc_chain, test_find);
   tcase_add_test (tc_chain, test_fill);
   tcase_add_test (tc_chain, test_parent_buffer_meta);
+  tcase_add_test (tc_chain, test_no_merge);
+  tcase_add_test (tc_chain, test_map_memories);
+  tcase_add_test (tc_chain, test_headroom);
 
   return s;
 }
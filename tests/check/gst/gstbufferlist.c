@@ -427,6 +427,48 @@ GST_START_TEST (test_expand_and_remove)
 
 GST_END_TEST;
 
+GST_START_TEST (test_reset)
+{
+  GstBuffer *buf;
+  guint i, round;
+
+  for (round = 0; round < 3; round++) {
+    /* more than the inline storage */
+    for (i = 0; i < 40; i++)
+      gst_buffer_list_add (list, gst_buffer_new_allocate (NULL, i + 1, NULL));
+    fail_unless_equals_int (gst_buffer_list_length (list), 40);
+
+    buf = gst_buffer_list_get (list, 39);
+    fail_unless_equals_int (gst_buffer_get_size (buf), 40);
+    gst_buffer_ref (buf);
+
+    gst_buffer_list_reset (list);
+    fail_unless_equals_int (gst_buffer_list_length (list), 0);
+    ASSERT_BUFFER_REFCOUNT (buf, "buf", 1);
+    gst_buffer_unref (buf);
+  }
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_recycle)
+{
+  GstBufferList *l;
+  guint i;
+
+  /* freed lists are recycled, recycled lists must be empty */
+  for (i = 0; i < 100; i++) {
+    l = gst_buffer_list_new ();
+    fail_unless_equals_int (gst_buffer_list_length (l), 0);
+    fail_unless (gst_buffer_list_is_writable (l));
+    gst_buffer_list_add (l, gst_buffer_new ());
+    gst_buffer_list_add (l, gst_buffer_new ());
+    gst_buffer_list_unref (l);
+  }
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_buffer_list_suite (void)
 {
@@ -442,6 +484,8 @@ gst_buffer_list_suite (void)
   tcase_add_test (tc_chain, test_copy_deep);
   tcase_add_test (tc_chain, test_foreach);
   tcase_add_test (tc_chain, test_expand_and_remove);
+  tcase_add_test (tc_chain, test_reset);
+  tcase_add_test (tc_chain, test_recycle);
 
   return s;
 }
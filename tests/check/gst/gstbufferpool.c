@@ -248,6 +248,419 @@ GST_START_TEST (test_flushing_pool_returns_flushing)
 
 GST_END_TEST;
 
+static GstBufferPool *
+create_cached_pool (guint size, guint min_buf, guint max_buf, guint cache_size)
+{
+  GstBufferPool *pool = gst_buffer_pool_new ();
+  GstStructure *conf = gst_buffer_pool_get_config (pool);
+  GstCaps *caps = gst_caps_new_empty_simple ("test/data");
+
+  gst_buffer_pool_config_set_params (conf, caps, size, min_buf, max_buf);
+  gst_buffer_pool_config_set_thread_cache_size (conf, cache_size);
+  gst_buffer_pool_set_config (pool, conf);
+  gst_caps_unref (caps);
+
+  return pool;
+}
+
+GST_START_TEST (test_thread_cache_config)
+{
+  GstBufferPool *pool = create_cached_pool (10, 0, 0, 8);
+  GstStructure *conf;
+
+  conf = gst_buffer_pool_get_config (pool);
+  ck_assert_int_eq (gst_buffer_pool_config_get_thread_cache_size (conf), 8);
+  gst_structure_free (conf);
+
+  conf = gst_buffer_pool_get_config (pool);
+  gst_structure_remove_field (conf, "thread-cache-size");
+  ck_assert_int_eq (gst_buffer_pool_config_get_thread_cache_size (conf), 0);
+  gst_structure_free (conf);
+
+  gst_object_unref (pool);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_thread_cache_recycle)
+{
+  GstBufferPool *pool = create_cached_pool (10, 0, 0, 4);
+  GstBuffer *buf1 = NULL, *buf2 = NULL, *prev1, *prev2;
+
+  gst_buffer_pool_set_active (pool, TRUE);
+  gst_buffer_pool_acquire_buffer (pool, &buf1, NULL);
+  gst_buffer_pool_acquire_buffer (pool, &buf2, NULL);
+  prev1 = buf1;
+  prev2 = buf2;
+  gst_buffer_unref (buf1);
+  gst_buffer_unref (buf2);
+
+  /* cached buffers are handed out in LIFO order */
+  gst_buffer_pool_acquire_buffer (pool, &buf2, NULL);
+  gst_buffer_pool_acquire_buffer (pool, &buf1, NULL);
+  fail_unless (buf1 == prev1, "got a fresh buffer instead of previous");
+  fail_unless (buf2 == prev2, "got a fresh buffer instead of previous");
+
+  gst_buffer_unref (buf1);
+  gst_buffer_unref (buf2);
+  gst_buffer_pool_set_active (pool, FALSE);
+  gst_object_unref (pool);
+}
+
+GST_END_TEST;
+
+static gpointer
+acquire_dontwait_func (gpointer data)
+{
+  GstBufferPool *pool = data;
+  GstBufferPoolAcquireParams params = { 0, };
+  GstBuffer *buf = NULL;
+  GstFlowReturn ret;
+
+  params.flags = GST_BUFFER_POOL_ACQUIRE_FLAG_DONTWAIT;
+  ret = gst_buffer_pool_acquire_buffer (pool, &buf, &params);
+  if (ret == GST_FLOW_OK)
+    gst_buffer_unref (buf);
+
+  return GINT_TO_POINTER (ret);
+}
+
+GST_START_TEST (test_thread_cache_max_buffers)
+{
+  GstBufferPool *pool = create_cached_pool (10, 0, 2, 4);
+  GstBuffer *buf1 = NULL, *buf2 = NULL;
+  GThread *thread;
+  GstFlowReturn ret;
+
+  gst_buffer_pool_set_active (pool, TRUE);
+  gst_buffer_pool_acquire_buffer (pool, &buf1, NULL);
+  gst_buffer_pool_acquire_buffer (pool, &buf2, NULL);
+
+  /* all buffers are in use */
+  thread = g_thread_new ("acquire", acquire_dontwait_func, pool);
+  ret = GPOINTER_TO_INT (g_thread_join (thread));
+  ck_assert_int_eq (ret, GST_FLOW_EOS);
+
+  /* the released buffers end up in the cache of this thread, another thread
+   * must still be able to get them */
+  gst_buffer_unref (buf1);
+  gst_buffer_unref (buf2);
+  thread = g_thread_new ("acquire", acquire_dontwait_func, pool);
+  ret = GPOINTER_TO_INT (g_thread_join (thread));
+  ck_assert_int_eq (ret, GST_FLOW_OK);
+
+  gst_buffer_pool_set_active (pool, FALSE);
+  gst_object_unref (pool);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_thread_cache_flushing)
+{
+  GstBufferPool *pool = create_cached_pool (10, 2, 2, 4);
+  GstBuffer *buf = NULL;
+  GstFlowReturn ret;
+
+  gst_buffer_pool_set_active (pool, TRUE);
+  ret = gst_buffer_pool_acquire_buffer (pool, &buf, NULL);
+  ck_assert_int_eq (ret, GST_FLOW_OK);
+  gst_buffer_unref (buf);
+
+  gst_buffer_pool_set_flushing (pool, TRUE);
+  ret = gst_buffer_pool_acquire_buffer (pool, &buf, NULL);
+  ck_assert_int_eq (ret, GST_FLOW_FLUSHING);
+
+  gst_buffer_pool_set_flushing (pool, FALSE);
+  ret = gst_buffer_pool_acquire_buffer (pool, &buf, NULL);
+  ck_assert_int_eq (ret, GST_FLOW_OK);
+  gst_buffer_unref (buf);
+
+  /* deactivating frees the cached buffers so that we can reconfigure */
+  fail_unless (gst_buffer_pool_set_active (pool, FALSE));
+  fail_unless (gst_buffer_pool_set_config (pool,
+          gst_buffer_pool_get_config (pool)));
+  fail_unless (gst_buffer_pool_set_active (pool, TRUE));
+  fail_unless (gst_buffer_pool_set_active (pool, FALSE));
+  gst_object_unref (pool);
+}
+
+GST_END_TEST;
+
+static gpointer
+acquire_wait_func (gpointer data)
+{
+  GstBufferPool *pool = data;
+  GstBuffer *buf = NULL;
+  GstFlowReturn ret;
+
+  ret = gst_buffer_pool_acquire_buffer (pool, &buf, NULL);
+  if (ret == GST_FLOW_OK)
+    gst_buffer_unref (buf);
+
+  return GINT_TO_POINTER (ret);
+}
+
+GST_START_TEST (test_wait_for_release)
+{
+  GstBufferPool *pool = create_pool (10, 0, 1);
+  GstBuffer *buf = NULL;
+  GThread *thread;
+  GstFlowReturn ret;
+
+  gst_buffer_pool_set_active (pool, TRUE);
+  ret = gst_buffer_pool_acquire_buffer (pool, &buf, NULL);
+  ck_assert_int_eq (ret, GST_FLOW_OK);
+
+  /* the waiting thread gets the released buffer */
+  thread = g_thread_new ("acquire", acquire_wait_func, pool);
+  g_usleep (G_USEC_PER_SEC / 100);
+  gst_buffer_unref (buf);
+  ret = GPOINTER_TO_INT (g_thread_join (thread));
+  ck_assert_int_eq (ret, GST_FLOW_OK);
+
+  /* or is woken up by flushing */
+  ret = gst_buffer_pool_acquire_buffer (pool, &buf, NULL);
+  ck_assert_int_eq (ret, GST_FLOW_OK);
+  thread = g_thread_new ("acquire", acquire_wait_func, pool);
+  g_usleep (G_USEC_PER_SEC / 100);
+  gst_buffer_pool_set_flushing (pool, TRUE);
+  ret = GPOINTER_TO_INT (g_thread_join (thread));
+  ck_assert_int_eq (ret, GST_FLOW_FLUSHING);
+
+  gst_buffer_unref (buf);
+  gst_buffer_pool_set_active (pool, FALSE);
+  gst_object_unref (pool);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_pool_stats)
+{
+  GstBufferPool *pool = create_pool (10, 1, 0);
+  GstAllocationStats stats;
+  GstBuffer *buf1, *buf2;
+
+  gst_buffer_pool_get_stats (pool, &stats);
+  fail_unless_equals_uint64 (stats.allocated, 0);
+
+  gst_buffer_pool_set_active (pool, TRUE);
+  gst_buffer_pool_acquire_buffer (pool, &buf1, NULL);
+  gst_buffer_pool_acquire_buffer (pool, &buf2, NULL);
+  gst_buffer_pool_get_stats (pool, &stats);
+  fail_unless_equals_uint64 (stats.allocated, 2);
+  fail_unless_equals_uint64 (stats.live_bytes, 20);
+
+  /* recycling doesn't allocate */
+  gst_buffer_unref (buf2);
+  gst_buffer_pool_acquire_buffer (pool, &buf2, NULL);
+  gst_buffer_pool_get_stats (pool, &stats);
+  fail_unless_equals_uint64 (stats.allocated, 2);
+
+  gst_buffer_unref (buf1);
+  gst_buffer_unref (buf2);
+  gst_buffer_pool_set_active (pool, FALSE);
+  gst_buffer_pool_get_stats (pool, &stats);
+  fail_unless_equals_uint64 (stats.freed, 2);
+  fail_unless_equals_uint64 (stats.live_bytes, 0);
+  fail_unless_equals_uint64 (stats.peak_bytes, 20);
+  fail_unless_equals_uint64 (stats.failed, 0);
+
+  gst_object_unref (pool);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_trim_idle)
+{
+  GstBufferPool *pool = gst_buffer_pool_new ();
+  GstStructure *conf = gst_buffer_pool_get_config (pool);
+  GstAllocationStats stats;
+  GstBuffer *bufs[4];
+  gint i;
+
+  gst_buffer_pool_config_set_params (conf, NULL, 10, 1, 0);
+  fail_unless_equals_uint64 (gst_buffer_pool_config_get_trim_idle_time (conf),
+      GST_CLOCK_TIME_NONE);
+  gst_buffer_pool_config_set_trim_idle_time (conf, 20 * GST_MSECOND);
+  fail_unless_equals_uint64 (gst_buffer_pool_config_get_trim_idle_time (conf),
+      20 * GST_MSECOND);
+  fail_unless (gst_buffer_pool_set_config (pool, conf));
+  gst_buffer_pool_set_active (pool, TRUE);
+
+  for (i = 0; i < 4; i++)
+    gst_buffer_pool_acquire_buffer (pool, &bufs[i], NULL);
+  for (i = 0; i < 4; i++)
+    gst_buffer_unref (bufs[i]);
+
+  /* the unused buffers are freed down to the minimum */
+  for (i = 0; i < 500; i++) {
+    gst_buffer_pool_get_stats (pool, &stats);
+    if (stats.freed == 3)
+      break;
+    g_usleep (10 * 1000);
+  }
+  fail_unless_equals_uint64 (stats.freed, 3);
+  fail_unless_equals_uint64 (stats.live_bytes, 10);
+
+  /* and allocated again when needed */
+  for (i = 0; i < 2; i++)
+    gst_buffer_pool_acquire_buffer (pool, &bufs[i], NULL);
+  gst_buffer_pool_get_stats (pool, &stats);
+  fail_unless_equals_uint64 (stats.allocated, 5);
+  for (i = 0; i < 2; i++)
+    gst_buffer_unref (bufs[i]);
+
+  gst_buffer_pool_set_active (pool, FALSE);
+  gst_object_unref (pool);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_prefault)
+{
+  GstBufferPool *pool = gst_buffer_pool_new ();
+  GstStructure *conf = gst_buffer_pool_get_config (pool);
+  GstBuffer *buf;
+
+  gst_buffer_pool_config_set_params (conf, NULL, 100000, 1, 0);
+  fail_if (gst_buffer_pool_config_get_prefault (conf));
+  fail_if (gst_buffer_pool_config_get_lock_memory (conf));
+  gst_buffer_pool_config_set_prefault (conf, TRUE);
+  gst_buffer_pool_config_set_lock_memory (conf, TRUE);
+  fail_unless (gst_buffer_pool_config_get_prefault (conf));
+  fail_unless (gst_buffer_pool_config_get_lock_memory (conf));
+  fail_unless (gst_buffer_pool_set_config (pool, conf));
+
+  /* locking may fail because of the limits, the buffers still work */
+  fail_unless (gst_buffer_pool_set_active (pool, TRUE));
+  fail_unless_equals_int (gst_buffer_pool_acquire_buffer (pool, &buf, NULL),
+      GST_FLOW_OK);
+  gst_buffer_memset (buf, 0, 0xff, 100000);
+  gst_buffer_unref (buf);
+
+  gst_buffer_pool_set_active (pool, FALSE);
+  gst_object_unref (pool);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_reuse_memory)
+{
+  GstBufferPool *pool = gst_buffer_pool_new ();
+  GstStructure *conf = gst_buffer_pool_get_config (pool);
+  GstMemory *mem1, *mem2;
+  GstBuffer *buf1, *buf2;
+
+  gst_buffer_pool_config_set_params (conf, NULL, 100, 2, 0);
+  gst_buffer_pool_config_set_reuse_memory (conf, TRUE);
+  fail_unless (gst_buffer_pool_set_config (pool, conf));
+  fail_unless (gst_buffer_pool_set_active (pool, TRUE));
+  gst_buffer_pool_acquire_buffer (pool, &buf1, NULL);
+  gst_buffer_pool_acquire_buffer (pool, &buf2, NULL);
+  mem1 = gst_buffer_peek_memory (buf1, 0);
+  mem2 = gst_buffer_peek_memory (buf2, 0);
+  gst_buffer_unref (buf1);
+  gst_buffer_unref (buf2);
+  fail_unless (gst_buffer_pool_set_active (pool, FALSE));
+
+  /* a smaller size reuses the buffers */
+  conf = gst_buffer_pool_get_config (pool);
+  gst_buffer_pool_config_set_params (conf, NULL, 60, 2, 0);
+  fail_unless (gst_buffer_pool_set_config (pool, conf));
+  fail_unless (gst_buffer_pool_set_active (pool, TRUE));
+  gst_buffer_pool_acquire_buffer (pool, &buf1, NULL);
+  fail_unless_equals_int (gst_buffer_get_size (buf1), 60);
+  fail_unless (gst_buffer_peek_memory (buf1, 0) == mem1 ||
+      gst_buffer_peek_memory (buf1, 0) == mem2);
+  gst_buffer_unref (buf1);
+  fail_unless (gst_buffer_pool_set_active (pool, FALSE));
+
+  /* a bigger size can't */
+  conf = gst_buffer_pool_get_config (pool);
+  gst_buffer_pool_config_set_params (conf, NULL, 200, 1, 0);
+  fail_unless (gst_buffer_pool_set_config (pool, conf));
+  fail_unless (gst_buffer_pool_set_active (pool, TRUE));
+  gst_buffer_pool_acquire_buffer (pool, &buf1, NULL);
+  fail_unless_equals_int (gst_buffer_get_size (buf1), 200);
+  gst_buffer_unref (buf1);
+  fail_unless (gst_buffer_pool_set_active (pool, FALSE));
+
+  gst_object_unref (pool);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_caps_only_reconfig)
+{
+  GstBufferPool *pool = create_pool (10, 0, 0);
+  GstStructure *conf;
+  GstCaps *caps, *other;
+  GstBuffer *buf, *prev;
+
+  fail_unless (gst_buffer_pool_set_active (pool, TRUE));
+  gst_buffer_pool_acquire_buffer (pool, &buf, NULL);
+
+  /* active and with an outstanding buffer */
+  other = gst_caps_new_empty_simple ("test/other");
+  conf = gst_buffer_pool_get_config (pool);
+  gst_buffer_pool_config_set_params (conf, other, 10, 0, 0);
+  fail_unless (gst_buffer_pool_set_config (pool, conf));
+
+  conf = gst_buffer_pool_get_config (pool);
+  fail_unless (gst_buffer_pool_config_get_params (conf, &caps, NULL, NULL,
+          NULL));
+  fail_unless (gst_caps_is_equal (caps, other));
+
+  /* other changes still need a deactivated pool */
+  gst_buffer_pool_config_set_params (conf, other, 20, 0, 0);
+  fail_if (gst_buffer_pool_set_config (pool, conf));
+  gst_caps_unref (other);
+
+  prev = buf;
+  gst_buffer_unref (buf);
+  gst_buffer_pool_acquire_buffer (pool, &buf, NULL);
+  fail_unless (buf == prev);
+  gst_buffer_unref (buf);
+
+  gst_buffer_pool_set_active (pool, FALSE);
+  gst_object_unref (pool);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_restore_headroom)
+{
+  GstBufferPool *pool = gst_buffer_pool_new ();
+  GstStructure *conf = gst_buffer_pool_get_config (pool);
+  GstAllocationParams params;
+  GstBuffer *buf1, *buf2;
+  gsize offset;
+
+  gst_allocation_params_init (&params);
+  params.prefix = 12;
+  gst_buffer_pool_config_set_params (conf, NULL, 100, 1, 1);
+  gst_buffer_pool_config_set_allocator (conf, NULL, &params);
+  fail_unless (gst_buffer_pool_set_config (pool, conf));
+  fail_unless (gst_buffer_pool_set_active (pool, TRUE));
+
+  gst_buffer_pool_acquire_buffer (pool, &buf1, NULL);
+  fail_unless (gst_buffer_prepend_headroom (buf1, 12));
+  fail_unless_equals_int (gst_buffer_get_size (buf1), 112);
+  gst_buffer_unref (buf1);
+
+  /* the buffer is recycled with its headroom */
+  gst_buffer_pool_acquire_buffer (pool, &buf2, NULL);
+  fail_unless (buf1 == buf2);
+  fail_unless_equals_int (gst_buffer_get_sizes (buf2, &offset, NULL), 100);
+  fail_unless_equals_int (offset, 12);
+  gst_buffer_unref (buf2);
+
+  fail_unless (gst_buffer_pool_set_active (pool, FALSE));
+  gst_object_unref (pool);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_buffer_pool_suite (void)
 {
@@ -266,6 +679,17 @@ gst_buffer_pool_suite (void)
   tcase_add_test (tc_chain, test_pool_activation_and_config);
   tcase_add_test (tc_chain, test_pool_config_validate);
   tcase_add_test (tc_chain, test_flushing_pool_returns_flushing);
+  tcase_add_test (tc_chain, test_thread_cache_config);
+  tcase_add_test (tc_chain, test_thread_cache_recycle);
+  tcase_add_test (tc_chain, test_thread_cache_max_buffers);
+  tcase_add_test (tc_chain, test_thread_cache_flushing);
+  tcase_add_test (tc_chain, test_wait_for_release);
+  tcase_add_test (tc_chain, test_pool_stats);
+  tcase_add_test (tc_chain, test_trim_idle);
+  tcase_add_test (tc_chain, test_prefault);
+  tcase_add_test (tc_chain, test_reuse_memory);
+  tcase_add_test (tc_chain, test_caps_only_reconfig);
+  tcase_add_test (tc_chain, test_restore_headroom);
 
   return s;
 }
@@ -198,6 +198,64 @@ GST_END_TEST;
 
 /* test if adding a signal watch for different message types calls the
  * respective callbacks. */
+static gboolean
+collect_buffering_func (GstBus * bus, GstMessage * message, GString * res)
+{
+  gint percent;
+
+  gst_message_parse_buffering (message, &percent);
+  g_string_append_printf (res, "%s:%d ", GST_MESSAGE_SRC_NAME (message),
+      percent);
+
+  return TRUE;
+}
+
+/* test that a watch dispatches multiple messages per main loop iteration
+ * and only the newest of coalesced messages */
+GST_START_TEST (test_watch_coalesce)
+{
+  GstObject *a, *b;
+  GString *res;
+  guint id;
+
+  test_bus = gst_bus_new ();
+  a = gst_object_ref_sink (gst_pad_new ("a", GST_PAD_SRC));
+  b = gst_object_ref_sink (gst_pad_new ("b", GST_PAD_SRC));
+  res = g_string_new (NULL);
+
+  id = gst_bus_add_watch (test_bus, (GstBusFunc) collect_buffering_func, res);
+  fail_if (id == 0);
+
+  gst_bus_post (test_bus, gst_message_new_buffering (a, 10));
+  gst_bus_post (test_bus, gst_message_new_buffering (a, 20));
+  gst_bus_post (test_bus, gst_message_new_buffering (b, 50));
+  gst_bus_post (test_bus, gst_message_new_buffering (a, 30));
+
+  /* all messages in one iteration */
+  g_main_context_iteration (NULL, FALSE);
+  fail_unless_equals_string (res->str, "a:10 a:20 b:50 a:30 ");
+  g_string_truncate (res, 0);
+
+  g_object_set (test_bus, "coalesce-types", GST_MESSAGE_BUFFERING, NULL);
+  gst_bus_post (test_bus, gst_message_new_buffering (a, 10));
+  gst_bus_post (test_bus, gst_message_new_buffering (a, 20));
+  gst_bus_post (test_bus, gst_message_new_buffering (b, 50));
+  gst_bus_post (test_bus, gst_message_new_buffering (a, 30));
+  gst_bus_post (test_bus, gst_message_new_buffering (a, 40));
+
+  while (g_main_context_pending (NULL))
+    g_main_context_iteration (NULL, FALSE);
+  fail_unless_equals_string (res->str, "a:20 b:50 a:40 ");
+
+  fail_unless (gst_bus_remove_watch (test_bus));
+  g_string_free (res, TRUE);
+  gst_object_unref (a);
+  gst_object_unref (b);
+  gst_object_unref (test_bus);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_watch_with_custom_context)
 {
   GMainContext *ctx;
@@ -809,6 +867,63 @@ GST_START_TEST (test_async_message)
 
 GST_END_TEST;
 
+GST_START_TEST (test_accept_types)
+{
+  GstElement *pipeline, *bin, *element;
+  GstBus *bus;
+
+  bus = gst_bus_new ();
+  fail_unless_equals_int (gst_bus_get_accept_types (bus), GST_MESSAGE_ANY);
+
+  gst_bus_set_accept_types (bus, GST_MESSAGE_ERROR | GST_MESSAGE_EOS);
+  fail_unless_equals_int (gst_bus_get_accept_types (bus),
+      GST_MESSAGE_ERROR | GST_MESSAGE_EOS);
+
+  /* other messages are dropped when posted */
+  fail_unless (gst_bus_post (bus, gst_message_new_application (NULL, NULL)));
+  fail_if (gst_bus_have_pending (bus));
+  fail_unless (gst_bus_post (bus, gst_message_new_eos (NULL)));
+  fail_unless (gst_bus_have_pending (bus));
+  gst_bus_set_flushing (bus, TRUE);
+  gst_object_unref (bus);
+
+  pipeline = gst_pipeline_new (NULL);
+  bin = gst_bin_new (NULL);
+  element = gst_bin_new (NULL);
+  gst_bin_add (GST_BIN (bin), element);
+
+  /* no bus, nothing is posted */
+  fail_if (gst_element_message_will_be_posted (element, GST_MESSAGE_ERROR));
+
+  gst_bin_add (GST_BIN (pipeline), bin);
+  fail_unless (gst_element_message_will_be_posted (element, GST_MESSAGE_QOS));
+  fail_unless (gst_element_message_will_be_posted (element,
+          GST_MESSAGE_BUFFERING));
+
+  bus = gst_pipeline_get_bus (GST_PIPELINE (pipeline));
+  gst_bus_set_accept_types (bus, GST_MESSAGE_ERROR);
+  fail_if (gst_element_message_will_be_posted (element, GST_MESSAGE_QOS));
+  fail_if (gst_element_message_will_be_posted (element,
+          GST_MESSAGE_BUFFERING));
+  fail_if (gst_element_message_will_be_posted (element,
+          GST_MESSAGE_STREAM_STATUS));
+  fail_unless (gst_element_message_will_be_posted (element,
+          GST_MESSAGE_ERROR));
+  /* the bins still need these */
+  fail_unless (gst_element_message_will_be_posted (element,
+          GST_MESSAGE_ASYNC_DONE));
+  fail_unless (gst_element_message_will_be_posted (element, GST_MESSAGE_EOS));
+
+  gst_element_post_message (element,
+      gst_message_new_buffering (GST_OBJECT (element), 50));
+  fail_if (gst_bus_have_pending (bus));
+
+  gst_object_unref (bus);
+  gst_object_unref (pipeline);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_bus_suite (void)
 {
@@ -821,6 +936,7 @@ gst_bus_suite (void)
   tcase_add_test (tc_chain, test_hammer_bus);
   tcase_add_test (tc_chain, test_watch);
   tcase_add_test (tc_chain, test_watch_with_poll);
+  tcase_add_test (tc_chain, test_watch_coalesce);
   tcase_add_test (tc_chain, test_watch_with_custom_context);
   tcase_add_test (tc_chain, test_add_watch_with_custom_context);
   tcase_add_test (tc_chain, test_remove_watch);
@@ -828,6 +944,7 @@ gst_bus_suite (void)
   tcase_add_test (tc_chain, test_timed_pop_thread);
   tcase_add_test (tc_chain, test_timed_pop_filtered);
   tcase_add_test (tc_chain, test_timed_pop_filtered_with_timeout);
+  tcase_add_test (tc_chain, test_accept_types);
   tcase_add_test (tc_chain, test_custom_main_context);
   tcase_add_test (tc_chain, test_async_message);
   return s;
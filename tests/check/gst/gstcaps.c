@@ -467,6 +467,130 @@ GST_START_TEST (test_merge_same)
 
 GST_END_TEST;
 
+static const gchar *merge_formats[] = { "I420", "YV12", "NV12", "NV21",
+  "YUY2", "UYVY", "RGB", "BGR", "RGBx", "BGRx", "xRGB", "xBGR"
+};
+
+static GstCaps *
+create_format_caps (const gchar * features)
+{
+  GstCaps *caps;
+  guint i;
+
+  caps = gst_caps_new_empty ();
+  for (i = 0; i < G_N_ELEMENTS (merge_formats); i++) {
+    gst_caps_append_structure_full (caps,
+        gst_structure_new ("video/x-raw", "format", G_TYPE_STRING,
+            merge_formats[i], "width", GST_TYPE_INT_RANGE, 1, 1920, NULL),
+        features ? gst_caps_features_new (features, NULL) : NULL);
+  }
+  return caps;
+}
+
+GST_START_TEST (test_merge_many)
+{
+  GstCaps *c1, *c2, *test;
+
+  /* exact duplicates are dropped */
+  c1 = create_format_caps (NULL);
+  c2 = create_format_caps (NULL);
+  c1 = gst_caps_merge (c1, c2);
+  fail_unless_equals_int (gst_caps_get_size (c1),
+      G_N_ELEMENTS (merge_formats));
+  test = create_format_caps (NULL);
+  fail_unless (gst_caps_is_strictly_equal (c1, test));
+  gst_caps_unref (test);
+
+  /* subsets too, also with explicit system memory features */
+  c2 = gst_caps_from_string ("video/x-raw(memory:SystemMemory), "
+      "format=NV12, width=640; video/x-raw, format=NV12, width=4000");
+  c1 = gst_caps_merge (c1, c2);
+  fail_unless_equals_int (gst_caps_get_size (c1),
+      G_N_ELEMENTS (merge_formats) + 1);
+  gst_caps_unref (c1);
+
+  /* but not with other features */
+  c1 = create_format_caps (NULL);
+  c2 = create_format_caps ("memory:GLMemory");
+  c1 = gst_caps_merge (c1, c2);
+  fail_unless_equals_int (gst_caps_get_size (c1),
+      2 * G_N_ELEMENTS (merge_formats));
+  c2 = gst_caps_from_string ("video/x-raw(memory:GLMemory), "
+      "format=RGB, width=640");
+  c1 = gst_caps_merge (c1, c2);
+  fail_unless_equals_int (gst_caps_get_size (c1),
+      2 * G_N_ELEMENTS (merge_formats));
+
+  /* ANY features express the non ANY ones, not the other way around */
+  c2 = gst_caps_from_string ("video/x-raw(ANY), format=RGB, width=640");
+  c1 = gst_caps_merge (c1, c2);
+  fail_unless_equals_int (gst_caps_get_size (c1),
+      2 * G_N_ELEMENTS (merge_formats) + 1);
+  c2 = gst_caps_from_string ("video/x-raw(memory:VASurface), "
+      "format=RGB, width=640");
+  c1 = gst_caps_merge (c1, c2);
+  fail_unless_equals_int (gst_caps_get_size (c1),
+      2 * G_N_ELEMENTS (merge_formats) + 1);
+  gst_caps_unref (c1);
+
+  /* simplify removes the duplicates of larger caps the same way */
+  c1 = gst_caps_merge (create_format_caps (NULL),
+      create_format_caps ("memory:GLMemory"));
+  gst_caps_append (c1, create_format_caps (NULL));
+  gst_caps_append (c1, create_format_caps ("memory:GLMemory"));
+  fail_unless_equals_int (gst_caps_get_size (c1),
+      4 * G_N_ELEMENTS (merge_formats));
+  c1 = gst_caps_simplify (c1);
+  test = gst_caps_merge (create_format_caps (NULL),
+      create_format_caps ("memory:GLMemory"));
+  fail_unless (gst_caps_is_equal (c1, test));
+  gst_caps_unref (test);
+  gst_caps_unref (c1);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_interned_strings)
+{
+  GstCaps *c1, *c2, *c3;
+  GstStructure *s1, *s2;
+  const GValue *list1, *list2;
+
+  c1 = gst_caps_from_string ("video/x-h264, stream-format=avc, "
+      "alignment={ au, nal }");
+  c2 = gst_caps_copy (c1);
+  s1 = gst_caps_get_structure (c1, 0);
+  s2 = gst_caps_get_structure (c2, 0);
+
+  /* copies of parsed caps share their strings */
+  fail_unless (gst_structure_get_string (s1, "stream-format") ==
+      gst_structure_get_string (s2, "stream-format"));
+  list1 = gst_structure_get_value (s1, "alignment");
+  list2 = gst_structure_get_value (s2, "alignment");
+  fail_unless (g_value_get_string (gst_value_list_get_value (list1, 1)) ==
+      g_value_get_string (gst_value_list_get_value (list2, 1)));
+
+  /* and still compare equal to strings that are not shared */
+  c3 = gst_caps_new_simple ("video/x-h264", "stream-format", G_TYPE_STRING,
+      "avc", "alignment", G_TYPE_STRING, "nal", NULL);
+  fail_unless (gst_caps_is_subset (c3, c2));
+  fail_if (gst_structure_get_string (gst_caps_get_structure (c3, 0),
+          "stream-format") == gst_structure_get_string (s2, "stream-format"));
+
+  /* modifying a copy leaves the original alone */
+  gst_structure_set (s2, "stream-format", G_TYPE_STRING, "byte-stream", NULL);
+  fail_unless_equals_string (gst_structure_get_string (s1, "stream-format"),
+      "avc");
+  fail_unless_equals_string (gst_structure_get_string (s2, "stream-format"),
+      "byte-stream");
+
+  gst_caps_unref (c3);
+  gst_caps_unref (c2);
+  gst_caps_unref (c1);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_merge_subset)
 {
   GstCaps *c1, *c2, *test;
@@ -1385,6 +1509,113 @@ GST_START_TEST (test_filter_and_map_in_place)
 
 GST_END_TEST;
 
+GST_START_TEST (test_static_caps_cache)
+{
+  static GstStaticCaps scaps1 =
+      GST_STATIC_CAPS ("video/x-raw, format = (string) { I420, YV12 }, "
+      "width = (int) [ 1, 100 ]");
+  static GstStaticCaps scaps1_dup =
+      GST_STATIC_CAPS ("video/x-raw, format = (string) { I420, YV12 }, "
+      "width = (int) [ 1, 100 ]");
+  static GstStaticCaps scaps2 =
+      GST_STATIC_CAPS ("video/x-raw, width = (int) [ 50, 200 ]; audio/x-raw");
+  GstCaps *caps1, *caps1_dup, *caps2, *copy, *expected;
+  GstCaps *res1, *res2, *res3;
+
+  caps1 = gst_static_caps_get (&scaps1);
+  caps1_dup = gst_static_caps_get (&scaps1_dup);
+  caps2 = gst_static_caps_get (&scaps2);
+  fail_unless (caps1 != caps1_dup);
+
+  expected = gst_caps_from_string ("video/x-raw, "
+      "format = (string) { I420, YV12 }, width = (int) [ 50, 100 ]");
+
+  /* the second intersection of static caps comes from the cache */
+  res1 = gst_caps_intersect (caps1, caps2);
+  fail_unless (gst_caps_is_equal (res1, expected));
+  res2 = gst_caps_intersect (caps1, caps2);
+  fail_unless (res1 == res2);
+  gst_caps_unref (res2);
+
+  /* equal static caps share the cached result */
+  res2 = gst_caps_intersect (caps1_dup, caps2);
+  fail_unless (res1 == res2);
+  gst_caps_unref (res2);
+
+  /* the other mode is cached separately */
+  res2 = gst_caps_intersect_full (caps1, caps2, GST_CAPS_INTERSECT_FIRST);
+  fail_unless (gst_caps_is_equal (res2, expected));
+  gst_caps_unref (res2);
+
+  /* copies can be modified and are not cached */
+  copy = gst_caps_copy (caps1);
+  res3 = gst_caps_intersect (copy, caps2);
+  fail_unless (res3 != res1);
+  fail_unless (gst_caps_is_equal (res3, expected));
+  gst_caps_unref (res3);
+  gst_caps_set_simple (copy, "width", G_TYPE_INT, 300, NULL);
+  fail_if (gst_caps_can_intersect (copy, caps1));
+  fail_if (gst_caps_is_subset (copy, caps1));
+  gst_caps_unref (copy);
+
+  fail_unless (gst_caps_can_intersect (caps1, caps2));
+  fail_unless (gst_caps_can_intersect (caps1, caps2));
+  fail_if (gst_caps_is_subset (caps1, caps2));
+  fail_if (gst_caps_is_subset (caps1, caps2));
+  fail_unless (gst_caps_is_subset (caps1, caps1_dup));
+  fail_unless (gst_caps_is_subset (caps1_dup, caps1));
+  fail_if (gst_caps_is_subset (caps2, caps1));
+
+  gst_caps_unref (expected);
+  gst_caps_unref (res1);
+  gst_caps_unref (caps1);
+  gst_caps_unref (caps1_dup);
+  gst_caps_unref (caps2);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_binary_serialization)
+{
+  const gchar *strings[] = {
+    "ANY",
+    "EMPTY",
+    "audio/x-raw, format=(string){ S16LE, F32LE }, rate=(int)[ 1, 384000 ]",
+    "video/x-raw(memory:Custom, meta:Foo), width=(int)320; video/x-raw",
+    "video/x-raw(ANY), framerate=(fraction)[ 0/1, 2147483647/1 ]",
+  };
+  GstCaps *caps, *res;
+  GBytes *bytes;
+  const guint8 *data;
+  gsize size, consumed;
+  guint i;
+
+  for (i = 0; i < G_N_ELEMENTS (strings); i++) {
+    caps = gst_caps_from_string (strings[i]);
+    fail_unless (caps != NULL);
+
+    bytes = gst_caps_serialize_binary (caps);
+    fail_unless (bytes != NULL);
+    data = g_bytes_get_data (bytes, &size);
+
+    consumed = 0;
+    res = gst_caps_deserialize_binary (data, size, &consumed);
+    fail_unless (res != NULL, "could not deserialize %s", strings[i]);
+    fail_unless_equals_uint64 (consumed, size);
+    fail_unless (gst_caps_is_strictly_equal (caps, res), "%s != %"
+        GST_PTR_FORMAT, strings[i], res);
+    fail_unless_equals_int (gst_caps_is_any (caps), gst_caps_is_any (res));
+    gst_caps_unref (res);
+
+    fail_unless (gst_caps_deserialize_binary (data, size - 1, NULL) == NULL);
+
+    g_bytes_unref (bytes);
+    gst_caps_unref (caps);
+  }
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_caps_suite (void)
 {
@@ -1403,6 +1634,8 @@ gst_caps_suite (void)
   tcase_add_test (tc_chain, test_merge_fundamental);
   tcase_add_test (tc_chain, test_merge_same);
   tcase_add_test (tc_chain, test_merge_subset);
+  tcase_add_test (tc_chain, test_merge_many);
+  tcase_add_test (tc_chain, test_interned_strings);
   tcase_add_test (tc_chain, test_intersect);
   tcase_add_test (tc_chain, test_intersect2);
   tcase_add_test (tc_chain, test_intersect_list_duplicate);
@@ -1419,6 +1652,8 @@ gst_caps_suite (void)
   tcase_add_test (tc_chain, test_foreach);
   tcase_add_test (tc_chain, test_map_in_place);
   tcase_add_test (tc_chain, test_filter_and_map_in_place);
+  tcase_add_test (tc_chain, test_static_caps_cache);
+  tcase_add_test (tc_chain, test_binary_serialization);
 
   return s;
 }
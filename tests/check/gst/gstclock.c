@@ -307,6 +307,57 @@ GST_START_TEST (test_regression)
 
 GST_END_TEST;
 
+GST_START_TEST (test_regression_streaming)
+{
+  GstClockTime m_num, m_den, internal, external, s_num, s_den, s_external;
+  gdouble r_squared, s_r_squared, rate, s_rate;
+  GstClockRegression reg;
+  gint i, j;
+
+  /* all observations at once, must agree with the batch regression */
+  for (i = 0; i < G_N_ELEMENTS (times); i++) {
+    fail_unless (_priv_gst_do_linear_regression (times[i].v, times[i].n,
+            &m_num, &m_den, &external, &internal, &r_squared));
+
+    _priv_gst_linear_regression_rebuild (&reg, times[i].v, times[i].n);
+    fail_unless (_priv_gst_linear_regression_get (&reg, internal, &s_num,
+            &s_den, &s_external, &s_r_squared));
+
+    rate = ((gdouble) (m_num) / m_den);
+    s_rate = ((gdouble) (s_num) / s_den);
+    fail_unless (ABS (rate - s_rate) < 0.001,
+        "Regression %d: rate %f != %f", i, s_rate, rate);
+    fail_unless (ABS (GST_CLOCK_DIFF (external, s_external)) < GST_MSECOND,
+        "Regression %d: external %" G_GUINT64_FORMAT " != %" G_GUINT64_FORMAT,
+        i, s_external, external);
+    fail_unless (ABS (r_squared - s_r_squared) < 0.01);
+  }
+
+  /* slide a window of 32 over the 64 observations of times1 */
+  _priv_gst_linear_regression_reset (&reg);
+  for (i = 0, j = 0; i < 64; i++, j += 4) {
+    if (i >= 32)
+      _priv_gst_linear_regression_remove (&reg, times1[j - 4 * 32],
+          times1[j - 4 * 32 + 2]);
+    _priv_gst_linear_regression_add (&reg, times1[j], times1[j + 2]);
+  }
+  fail_unless_equals_int (reg.n, 32);
+
+  fail_unless (_priv_gst_do_linear_regression (times1 + 4 * 32, 32,
+          &m_num, &m_den, &external, &internal, &r_squared));
+  fail_unless (_priv_gst_linear_regression_get (&reg, internal, &s_num,
+          &s_den, &s_external, &s_r_squared));
+
+  rate = ((gdouble) (m_num) / m_den);
+  s_rate = ((gdouble) (s_num) / s_den);
+  fail_unless (ABS (rate - s_rate) < 0.001, "rate %f != %f", s_rate, rate);
+  fail_unless (ABS (GST_CLOCK_DIFF (external, s_external)) < GST_MSECOND,
+      "external %" G_GUINT64_FORMAT " != %" G_GUINT64_FORMAT, s_external,
+      external);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_clock_suite (void)
 {
@@ -316,6 +367,7 @@ gst_clock_suite (void)
   suite_add_tcase (s, tc_chain);
   tcase_add_test (tc_chain, test_set_master_refcount);
   tcase_add_test (tc_chain, test_regression);
+  tcase_add_test (tc_chain, test_regression_streaming);
 
   return s;
 }
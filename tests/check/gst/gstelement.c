@@ -50,6 +50,49 @@ GST_START_TEST (test_add_remove_pad)
 
 GST_END_TEST;
 
+GST_START_TEST (test_get_static_pad_many)
+{
+  GstElement *e;
+  GstPad *p;
+  gchar *name;
+  gint i;
+
+  e = gst_element_factory_make ("fakesrc", "source");
+
+  for (i = 0; i < 100; i++) {
+    name = g_strdup_printf ("src_%d", i);
+    fail_unless (gst_element_add_pad (e, gst_pad_new (name, GST_PAD_SRC)));
+    g_free (name);
+  }
+
+  for (i = 0; i < 100; i++) {
+    name = g_strdup_printf ("src_%d", i);
+    p = gst_element_get_static_pad (e, name);
+    fail_unless (p != NULL);
+    fail_unless_equals_string (GST_PAD_NAME (p), name);
+    fail_unless (gst_element_remove_pad (e, p));
+    gst_object_unref (p);
+    g_free (name);
+  }
+
+  fail_unless (gst_element_get_static_pad (e, "src_42") == NULL);
+  /* the original pad of fakesrc is still found */
+  p = gst_element_get_static_pad (e, "src");
+  fail_unless (p != NULL);
+  gst_object_unref (p);
+
+  /* names are unique */
+  fail_unless (gst_element_add_pad (e, gst_pad_new ("src_42", GST_PAD_SRC)));
+  p = gst_pad_new ("src_42", GST_PAD_SRC);
+  gst_object_ref_sink (p);
+  ASSERT_CRITICAL (gst_element_add_pad (e, p));
+  gst_object_unref (p);
+
+  gst_object_unref (e);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_add_pad_unref_element)
 {
   GstElement *e;
@@ -355,6 +398,7 @@ gst_element_suite (void)
 
   suite_add_tcase (s, tc_chain);
   tcase_add_test (tc_chain, test_add_remove_pad);
+  tcase_add_test (tc_chain, test_get_static_pad_many);
   tcase_add_test (tc_chain, test_add_pad_unref_element);
   tcase_add_test (tc_chain, test_error_no_bus);
   tcase_add_test (tc_chain, test_link);
@@ -119,6 +119,70 @@ GST_START_TEST (test_can_sink_all_caps)
 
 GST_END_TEST;
 
+/* filtering a list must give the same result as filtering each factory on
+ * its own */
+static void
+check_list_filter (GList * factories, const gchar * caps_str,
+    GstPadDirection direction, gboolean subsetonly)
+{
+  GList *filtered, *expected = NULL, *walk, *w1, *w2;
+  GstCaps *caps;
+
+  caps = gst_caps_from_string (caps_str);
+  fail_unless (caps != NULL);
+
+  filtered = gst_element_factory_list_filter (factories, caps, direction,
+      subsetonly);
+
+  for (walk = factories; walk; walk = walk->next) {
+    GList single = { walk->data, NULL, NULL };
+
+    expected = g_list_concat (expected,
+        gst_element_factory_list_filter (&single, caps, direction,
+            subsetonly));
+  }
+
+  fail_unless_equals_int (g_list_length (filtered), g_list_length (expected));
+  for (w1 = filtered, w2 = expected; w1 && w2; w1 = w1->next, w2 = w2->next)
+    fail_unless (w1->data == w2->data);
+
+  gst_plugin_feature_list_free (filtered);
+  gst_plugin_feature_list_free (expected);
+  gst_caps_unref (caps);
+}
+
+GST_START_TEST (test_list_filter)
+{
+  GList *factories, *filtered, *walk;
+  GstCaps *caps;
+  gboolean found = FALSE;
+
+  factories = gst_element_factory_list_get_elements
+      (GST_ELEMENT_FACTORY_TYPE_ANY, GST_RANK_NONE);
+  fail_unless (factories != NULL);
+
+  check_list_filter (factories, "foo/x-bar", GST_PAD_SINK, FALSE);
+  check_list_filter (factories, "foo/x-bar", GST_PAD_SRC, TRUE);
+  check_list_filter (factories, "ANY", GST_PAD_SINK, FALSE);
+  check_list_filter (factories, "EMPTY", GST_PAD_SINK, TRUE);
+
+  /* identity can sink anything */
+  caps = gst_caps_new_empty_simple ("foo/x-bar");
+  filtered = gst_element_factory_list_filter (factories, caps, GST_PAD_SINK,
+      FALSE);
+  for (walk = filtered; walk; walk = walk->next) {
+    if (!strcmp (GST_OBJECT_NAME (walk->data), "identity"))
+      found = TRUE;
+  }
+  fail_unless (found);
+  gst_plugin_feature_list_free (filtered);
+  gst_caps_unref (caps);
+
+  gst_plugin_feature_list_free (factories);
+}
+
+GST_END_TEST;
+
 /* check if the elementfactory of a class is filled (see #131079) */
 GST_START_TEST (test_class)
 {
@@ -175,6 +239,7 @@ gst_element_factory_suite (void)
   tcase_add_test (tc_chain, test_create);
   tcase_add_test (tc_chain, test_can_sink_any_caps);
   tcase_add_test (tc_chain, test_can_sink_all_caps);
+  tcase_add_test (tc_chain, test_list_filter);
 
   return s;
 }
@@ -0,0 +1,142 @@
+/* GStreamer
+ *
+ * gstelementpool.c: Unit test for GstElementPool
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <gst/check/gstcheck.h>
+
+GST_START_TEST (test_reuse)
+{
+  GstElementPool *pool;
+  GstElement *e1, *e2;
+  gboolean silent;
+  guint sleep_time;
+
+  pool = gst_element_pool_new ();
+
+  e1 = gst_element_pool_make (pool, "identity", "first");
+  fail_unless (e1 != NULL);
+  fail_unless (g_object_is_floating (e1));
+  gst_object_ref_sink (e1);
+  g_object_set (e1, "silent", FALSE, "sleep-time", 10, NULL);
+
+  gst_element_pool_release (pool, e1);
+  fail_unless_equals_int (gst_element_pool_get_n_idle (pool), 1);
+
+  /* we get the same element back, with the default properties */
+  e2 = gst_element_pool_make (pool, "identity", "second");
+  fail_unless (e2 == e1);
+  fail_unless (g_object_is_floating (e2));
+  fail_unless_equals_int (gst_element_pool_get_n_idle (pool), 0);
+  fail_unless_equals_string (GST_OBJECT_NAME (e2), "second");
+  g_object_get (e2, "silent", &silent, "sleep-time", &sleep_time, NULL);
+  fail_unless (silent);
+  fail_unless_equals_int (sleep_time, 0);
+
+  /* other factories create new elements */
+  e1 = gst_element_pool_make (pool, "fakesink", NULL);
+  fail_unless (e1 != NULL);
+  gst_object_ref_sink (e1);
+  gst_element_pool_release (pool, e1);
+
+  gst_object_ref_sink (e2);
+  gst_element_pool_release (pool, e2);
+  fail_unless_equals_int (gst_element_pool_get_n_idle (pool), 2);
+
+  gst_element_pool_clear (pool);
+  fail_unless_equals_int (gst_element_pool_get_n_idle (pool), 0);
+
+  gst_object_unref (pool);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_release_pads)
+{
+  GstElementPool *pool;
+  GstElement *sink, *tee;
+  GstPad *pad;
+
+  pool = gst_element_pool_new ();
+
+  tee = gst_object_ref_sink (gst_element_pool_make (pool, "tee", NULL));
+  sink = gst_element_factory_make ("fakesink", NULL);
+  gst_object_ref_sink (sink);
+  fail_unless (gst_element_link (tee, sink));
+  fail_unless_equals_int (tee->numsrcpads, 1);
+
+  /* links are removed and request pads released */
+  gst_element_pool_release (pool, tee);
+  fail_unless_equals_int (gst_element_pool_get_n_idle (pool), 1);
+  pad = gst_element_get_static_pad (sink, "sink");
+  fail_if (gst_pad_is_linked (pad));
+  gst_object_unref (pad);
+
+  tee = gst_object_ref_sink (gst_element_pool_make (pool, "tee", NULL));
+  fail_unless_equals_int (tee->numsrcpads, 0);
+  fail_unless_equals_int (tee->numsinkpads, 1);
+
+  /* elements with a parent are still in use */
+  gst_bin_add (GST_BIN (gst_bin_new (NULL)), sink);
+  gst_element_pool_release (pool, sink);
+  gst_object_unref (GST_OBJECT_PARENT (sink));
+  fail_unless_equals_int (gst_element_pool_get_n_idle (pool), 0);
+
+  gst_object_unref (tee);
+  gst_object_unref (pool);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_max_idle)
+{
+  GstElementPool *pool;
+  GstElement *e1, *e2;
+
+  pool = gst_element_pool_new ();
+  gst_element_pool_set_max_idle (pool, 1);
+
+  e1 = gst_object_ref_sink (gst_element_pool_make (pool, "identity", NULL));
+  e2 = gst_object_ref_sink (gst_element_pool_make (pool, "identity", NULL));
+  gst_element_pool_release (pool, e1);
+  gst_element_pool_release (pool, e2);
+  fail_unless_equals_int (gst_element_pool_get_n_idle (pool), 1);
+
+  gst_element_pool_set_max_idle (pool, 0);
+  fail_unless_equals_int (gst_element_pool_get_n_idle (pool), 0);
+
+  gst_object_unref (pool);
+}
+
+GST_END_TEST;
+
+static Suite *
+gst_element_pool_suite (void)
+{
+  Suite *s = suite_create ("GstElementPool");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_reuse);
+  tcase_add_test (tc_chain, test_release_pads);
+  tcase_add_test (tc_chain, test_max_idle);
+
+  return s;
+}
+
+GST_CHECK_MAIN (gst_element_pool);
@@ -1321,7 +1321,103 @@ GST_START_TEST (test_activate_sink_switch_mode)
 
 GST_END_TEST;
 
-static Suite *
+static gint bypass_chain_count;
+
+static GstFlowReturn
+bypass_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+{
+  bypass_chain_count++;
+  gst_buffer_unref (buffer);
+  return GST_FLOW_NOT_NEGOTIATED;
+}
+
+static GstFlowReturn
+bypass_chain_eos (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+{
+  gst_buffer_unref (buffer);
+  return GST_FLOW_EOS;
+}
+
+static GstPadProbeReturn
+bypass_count_probe (GstPad * pad, GstPadProbeInfo * info, gpointer user_data)
+{
+  (*(gint *) user_data)++;
+  return GST_PAD_PROBE_OK;
+}
+
+GST_START_TEST (test_ghost_pads_bypass)
+{
+  GstPad *src, *ghost, *sink, *sink2, *internal;
+  GstSegment segment;
+  gint probe_count = 0;
+  gulong id;
+
+  src = gst_pad_new ("src", GST_PAD_SRC);
+  sink = gst_pad_new ("sink", GST_PAD_SINK);
+  gst_pad_set_chain_function (sink, bypass_chain);
+
+  ghost = gst_ghost_pad_new ("ghostsink", sink);
+  fail_unless (ghost != NULL);
+  internal = GST_PAD_CAST (gst_proxy_pad_get_internal (GST_PROXY_PAD (ghost)));
+  fail_unless (gst_pad_link (src, ghost) == GST_PAD_LINK_OK);
+
+  fail_if (gst_ghost_pad_get_bypass (GST_GHOST_PAD (ghost)));
+  gst_ghost_pad_set_bypass (GST_GHOST_PAD (ghost), TRUE);
+  fail_unless (gst_ghost_pad_get_bypass (GST_GHOST_PAD (ghost)));
+
+  gst_pad_set_active (sink, TRUE);
+  gst_pad_set_active (ghost, TRUE);
+  gst_pad_set_active (src, TRUE);
+
+  gst_segment_init (&segment, GST_FORMAT_BYTES);
+  fail_unless (gst_pad_push_event (src, gst_event_new_stream_start ("test")));
+  fail_unless (gst_pad_push_event (src, gst_event_new_segment (&segment)));
+
+  /* buffers skip the ghost pads but the flow return is updated on them */
+  bypass_chain_count = 0;
+  fail_unless_equals_int (gst_pad_push (src, gst_buffer_new ()),
+      GST_FLOW_NOT_NEGOTIATED);
+  fail_unless_equals_int (bypass_chain_count, 1);
+  fail_unless_equals_int (gst_pad_get_last_flow_return (internal),
+      GST_FLOW_NOT_NEGOTIATED);
+
+  /* probes make the data take the normal path again */
+  id = gst_pad_add_probe (internal, GST_PAD_PROBE_TYPE_BUFFER,
+      bypass_count_probe, &probe_count, NULL);
+  fail_unless_equals_int (gst_pad_push (src, gst_buffer_new ()),
+      GST_FLOW_NOT_NEGOTIATED);
+  fail_unless_equals_int (bypass_chain_count, 2);
+  fail_unless_equals_int (probe_count, 1);
+  gst_pad_remove_probe (internal, id);
+
+  fail_unless_equals_int (gst_pad_push (src, gst_buffer_new ()),
+      GST_FLOW_NOT_NEGOTIATED);
+  fail_unless_equals_int (bypass_chain_count, 3);
+  fail_unless_equals_int (probe_count, 1);
+
+  /* the bypass path follows a new target */
+  sink2 = gst_pad_new ("sink2", GST_PAD_SINK);
+  gst_pad_set_chain_function (sink2, bypass_chain_eos);
+  gst_pad_set_active (sink2, TRUE);
+  fail_unless (gst_ghost_pad_set_target (GST_GHOST_PAD (ghost), sink2));
+  fail_unless_equals_int (gst_pad_push (src, gst_buffer_new ()),
+      GST_FLOW_EOS);
+  fail_unless_equals_int (gst_pad_push (src, gst_buffer_new ()),
+      GST_FLOW_EOS);
+  fail_unless_equals_int (bypass_chain_count, 3);
+  fail_unless_equals_int (gst_pad_get_last_flow_return (internal),
+      GST_FLOW_EOS);
+
+  gst_object_unref (internal);
+  gst_object_unref (src);
+  gst_object_unref (ghost);
+  gst_object_unref (sink);
+  gst_object_unref (sink2);
+}
+
+GST_END_TEST;
+
+Suite *
 gst_ghost_pad_suite (void)
 {
   Suite *s = suite_create ("GstGhostPad");
@@ -1346,6 +1442,7 @@ gst_ghost_pad_suite (void)
   tcase_add_test (tc_chain, test_ghost_pads_change_when_linked);
   tcase_add_test (tc_chain, test_ghost_pads_internal_link);
   tcase_add_test (tc_chain, test_ghost_pads_remove_while_playing);
+  tcase_add_test (tc_chain, test_ghost_pads_bypass);
 
   tcase_add_test (tc_chain, test_activate_src);
   tcase_add_test (tc_chain, test_activate_sink_and_src);
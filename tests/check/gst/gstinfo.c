@@ -333,6 +333,68 @@ GST_START_TEST (info_old_printf_extensions)
 
 GST_END_TEST;
 
+GST_START_TEST (info_ptr_format_cached)
+{
+  GstCaps *caps, *ref;
+  gchar *big;
+  GList *l;
+
+  gst_debug_remove_log_function (gst_debug_log_default);
+  gst_debug_add_log_function (printf_extension_log_func, NULL, NULL);
+
+  gst_debug_set_default_threshold (GST_LEVEL_LOG);
+
+  save_messages = TRUE;
+
+  caps = gst_caps_new_simple ("foo/bar", "width", G_TYPE_INT, 320, NULL);
+
+  /* shared caps keep their string around */
+  ref = gst_caps_ref (caps);
+  GST_LOG ("caps %" GST_PTR_FORMAT, caps);
+  GST_LOG ("caps %" GST_PTR_FORMAT, caps);
+  gst_caps_unref (ref);
+
+  /* which must not be used anymore once they were changed */
+  gst_caps_set_simple (caps, "width", G_TYPE_INT, 640, NULL);
+  ref = gst_caps_ref (caps);
+  GST_LOG ("caps %" GST_PTR_FORMAT, caps);
+  gst_caps_unref (ref);
+
+  /* messages that don't fit the reused buffer */
+  big = g_strnfill (100000, 'x');
+  GST_LOG ("%s", big);
+  GST_LOG ("a%sb", big + 50000);
+  GST_LOG ("short");
+
+  fail_unless_equals_int (g_list_length (messages), 6);
+  l = messages;
+  fail_unless_equals_string (l->data, "caps foo/bar, width=(int)320");
+  l = l->next;
+  fail_unless_equals_string (l->data, "caps foo/bar, width=(int)320");
+  l = l->next;
+  fail_unless_equals_string (l->data, "caps foo/bar, width=(int)640");
+  l = l->next;
+  fail_unless_equals_string (l->data, big);
+  l = l->next;
+  fail_unless_equals_int (strlen (l->data), 50002);
+  fail_unless (((gchar *) l->data)[0] == 'a');
+  fail_unless (((gchar *) l->data)[50001] == 'b');
+  l = l->next;
+  fail_unless_equals_string (l->data, "short");
+
+  g_free (big);
+  gst_caps_unref (caps);
+
+  gst_debug_set_default_threshold (GST_LEVEL_NONE);
+  gst_debug_add_log_function (gst_debug_log_default, NULL, NULL);
+  gst_debug_remove_log_function (printf_extension_log_func);
+  save_messages = FALSE;
+  g_list_free_full (messages, (GDestroyNotify) g_free);
+  messages = NULL;
+}
+
+GST_END_TEST;
+
 GST_START_TEST (info_register_same_debug_category_twice)
 {
   GstDebugCategory *cat1 = NULL, *cat2 = NULL;
@@ -401,6 +463,186 @@ GST_START_TEST (info_set_and_unset_multiple)
   fail_unless (cat3 = GST_LEVEL_WARNING);
 }
 
+GST_END_TEST;
+
+GST_START_TEST (info_set_threshold_patterns)
+{
+  GstDebugLevel orig = gst_debug_get_default_threshold ();
+  GstDebugCategory *foo, *foo_bar, *other, *late, *again;
+
+  gst_debug_set_default_threshold (GST_LEVEL_WARNING);
+
+  GST_DEBUG_CATEGORY_INIT (foo, "testcat-foo", 0, "test category");
+  GST_DEBUG_CATEGORY_INIT (foo_bar, "testcat-foo-bar", 0, "test category");
+  GST_DEBUG_CATEGORY_INIT (other, "other-testcat", 0, "test category");
+  fail_unless_equals_int (gst_debug_category_get_threshold (foo),
+      GST_LEVEL_WARNING);
+
+  /* later entries win */
+  gst_debug_set_threshold_from_string
+      ("testcat-*:5,*-testcat:4,testcat-foo:6,test?at-foo-bar:3", FALSE);
+  fail_unless_equals_int (gst_debug_category_get_threshold (foo),
+      GST_LEVEL_LOG);
+  fail_unless_equals_int (gst_debug_category_get_threshold (foo_bar),
+      GST_LEVEL_FIXME);
+  fail_unless_equals_int (gst_debug_category_get_threshold (other),
+      GST_LEVEL_INFO);
+
+  /* categories registered later get the same treatment */
+  GST_DEBUG_CATEGORY_INIT (late, "testcat-late", 0, "test category");
+  fail_unless_equals_int (gst_debug_category_get_threshold (late),
+      GST_LEVEL_DEBUG);
+
+  /* registering a name again gives the existing category */
+  GST_DEBUG_CATEGORY_INIT (again, "testcat-foo", 0, "test category");
+  fail_unless (again == foo);
+
+  /* the inline check follows the category threshold */
+  fail_unless (_GST_CAT_LEVEL_ENABLED (foo, GST_LEVEL_LOG));
+  fail_if (_GST_CAT_LEVEL_ENABLED (foo_bar, GST_LEVEL_INFO));
+
+  gst_debug_unset_threshold_for_name ("testcat-*");
+  gst_debug_unset_threshold_for_name ("*-testcat");
+  gst_debug_unset_threshold_for_name ("testcat-foo");
+  gst_debug_unset_threshold_for_name ("test?at-foo-bar");
+  fail_unless_equals_int (gst_debug_category_get_threshold (foo_bar),
+      GST_LEVEL_WARNING);
+  fail_unless_equals_int (gst_debug_category_get_threshold (late),
+      GST_LEVEL_WARNING);
+
+  gst_debug_set_default_threshold (orig);
+
+  gst_debug_category_free (foo);
+  gst_debug_category_free (foo_bar);
+  gst_debug_category_free (other);
+  gst_debug_category_free (late);
+}
+
+GST_END_TEST;
+
+static guint limit_count;
+
+static void
+limit_log_func (GstDebugCategory * category, GstDebugLevel level,
+    const gchar * file, const gchar * function, gint line, GObject * object,
+    GstDebugMessage * message, gpointer unused)
+{
+  if (g_str_equal (category->name, "testlimit")
+      && !strstr (gst_debug_message_get (message), "suppressed"))
+    limit_count++;
+}
+
+GST_START_TEST (info_call_site_limits)
+{
+  GstDebugLevel orig = gst_debug_get_default_threshold ();
+  GstDebugCategory *cat;
+  gint i;
+
+  gst_debug_remove_log_function (gst_debug_log_default);
+  gst_debug_add_log_function (limit_log_func, NULL, NULL);
+
+  GST_DEBUG_CATEGORY_INIT (cat, "testlimit", 0, "test category");
+
+  /* one in four */
+  gst_debug_set_threshold_from_string ("testlimit:6@1/4", FALSE);
+  fail_unless_equals_int (gst_debug_category_get_threshold (cat),
+      GST_LEVEL_LOG);
+  limit_count = 0;
+  for (i = 0; i < 20; i++)
+    GST_CAT_LOG (cat, "sampled %d", i);
+  fail_unless_equals_int (limit_count, 5);
+
+  /* three per second, the loop may cross into the next second */
+  gst_debug_set_threshold_from_string ("testlimit:6@3/s", FALSE);
+  limit_count = 0;
+  for (i = 0; i < 100; i++)
+    GST_CAT_LOG (cat, "limited %d", i);
+  fail_unless (limit_count >= 3 && limit_count <= 6);
+
+  /* without a limit everything goes through */
+  gst_debug_set_threshold_from_string ("testlimit:6", FALSE);
+  limit_count = 0;
+  for (i = 0; i < 20; i++)
+    GST_CAT_LOG (cat, "unlimited %d", i);
+  fail_unless_equals_int (limit_count, 20);
+
+  /* broken limits are ignored */
+  gst_debug_set_threshold_from_string ("testlimit:2@0/s,testlimit:2@3/2",
+      FALSE);
+  fail_unless_equals_int (gst_debug_category_get_threshold (cat),
+      GST_LEVEL_LOG);
+
+  gst_debug_unset_threshold_for_name ("testlimit");
+  gst_debug_set_default_threshold (orig);
+  gst_debug_add_log_function (gst_debug_log_default, NULL, NULL);
+  gst_debug_remove_log_function (limit_log_func);
+  gst_debug_category_free (cat);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (info_ring_buffer_logger)
+{
+  gchar **logs;
+  gint i;
+
+  gst_debug_remove_log_function (gst_debug_log_default);
+  gst_debug_add_ring_buffer_logger (1024, 0);
+  gst_debug_set_default_threshold (GST_LEVEL_LOG);
+
+  GST_INFO ("first message");
+  for (i = 0; i < 100; i++)
+    GST_INFO ("message %d", i);
+
+  logs = gst_debug_ring_buffer_logger_get_logs ();
+  fail_unless (logs != NULL);
+  fail_unless_equals_int (g_strv_length (logs), 1);
+  /* the old messages were dropped, the last ones are kept */
+  fail_unless (strlen (logs[0]) <= 1024);
+  fail_unless (strstr (logs[0], "first message") == NULL);
+  fail_unless (strstr (logs[0], "message 99\n") != NULL);
+  g_strfreev (logs);
+
+  /* clean up */
+  gst_debug_set_default_threshold (GST_LEVEL_NONE);
+  gst_debug_remove_ring_buffer_logger ();
+  logs = gst_debug_ring_buffer_logger_get_logs ();
+  fail_unless_equals_int (g_strv_length (logs), 0);
+  g_strfreev (logs);
+  gst_debug_add_log_function (gst_debug_log_default, NULL, NULL);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (info_async_logger)
+{
+  guint dropped;
+  gint i;
+
+  gst_debug_remove_log_function (gst_debug_log_default);
+  dropped = gst_debug_async_logger_get_dropped ();
+
+  /* waits for the writer instead of dropping */
+  gst_debug_add_async_logger (2, GST_DEBUG_ASYNC_WAIT, FALSE);
+  gst_debug_set_threshold_for_name ("default", GST_LEVEL_LOG);
+  for (i = 0; i < 10; i++)
+    GST_INFO ("async message %d", i);
+
+  /* replacing the logger writes out the queued messages first */
+  gst_debug_add_async_logger (16, GST_DEBUG_ASYNC_WAIT, TRUE);
+  for (i = 0; i < 10; i++)
+    GST_INFO ("async \"json\" message\t%d", i);
+  gst_debug_remove_async_logger ();
+  fail_unless_equals_int (gst_debug_async_logger_get_dropped (), dropped);
+
+  /* removing it twice is fine */
+  gst_debug_remove_async_logger ();
+
+  /* clean up */
+  gst_debug_unset_threshold_for_name ("default");
+  gst_debug_add_log_function (gst_debug_log_default, NULL, NULL);
+}
+
 GST_END_TEST;
 #endif
 
@@ -439,9 +681,14 @@ gst_info_suite (void)
   tcase_add_test (tc_chain, info_dump_mem);
   tcase_add_test (tc_chain, info_fixme);
   tcase_add_test (tc_chain, info_old_printf_extensions);
+  tcase_add_test (tc_chain, info_ptr_format_cached);
   tcase_add_test (tc_chain, info_register_same_debug_category_twice);
   tcase_add_test (tc_chain, info_set_and_unset_single);
   tcase_add_test (tc_chain, info_set_and_unset_multiple);
+  tcase_add_test (tc_chain, info_set_threshold_patterns);
+  tcase_add_test (tc_chain, info_call_site_limits);
+  tcase_add_test (tc_chain, info_ring_buffer_logger);
+  tcase_add_test (tc_chain, info_async_logger);
 #endif
 
   return s;
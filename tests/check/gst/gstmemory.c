@@ -598,6 +598,161 @@ GST_START_TEST (test_lock)
 
 GST_END_TEST;
 
+GST_START_TEST (test_hugepages)
+{
+  GstAllocator *alloc;
+  GstAllocationParams params;
+  GstMemory *mem, *sub, *copy;
+  GstMapInfo info;
+  gsize maxalloc;
+
+  alloc = gst_allocator_find (GST_ALLOCATOR_SYSMEM_HUGEPAGES);
+  /* only available with mmap() */
+  if (alloc == NULL)
+    return;
+
+  gst_allocation_params_init (&params);
+  params.flags = GST_MEMORY_FLAG_ZERO_PREFIXED | GST_MEMORY_FLAG_ZERO_PADDED;
+  params.align = 4095;
+  params.prefix = 16;
+  params.padding = 32;
+
+  mem = gst_allocator_alloc (alloc, 1000, &params);
+  fail_unless (mem != NULL);
+  fail_unless (mem->allocator == alloc);
+  fail_unless (gst_memory_is_type (mem, GST_ALLOCATOR_SYSMEM));
+  fail_unless_equals_int (gst_memory_get_sizes (mem, NULL, &maxalloc), 1000);
+  fail_unless (maxalloc >= 1000 + 32);
+  fail_unless_equals_int (mem->offset, 16);
+
+  fail_unless (gst_memory_map (mem, &info, GST_MAP_WRITE));
+  fail_unless (((guintptr) info.data - 16) % 4096 == 0);
+  fail_unless (info.data[-1] == 0);
+  fail_unless (info.data[1000] == 0);
+  memset (info.data, 0xaa, info.size);
+  gst_memory_unmap (mem, &info);
+
+  sub = gst_memory_share (mem, 10, 20);
+  fail_unless (gst_memory_map (sub, &info, GST_MAP_READ));
+  fail_unless (info.data[0] == 0xaa);
+  gst_memory_unmap (sub, &info);
+  gst_memory_unref (sub);
+
+  copy = gst_memory_copy (mem, 0, -1);
+  fail_unless (copy->allocator == alloc);
+  fail_unless (gst_memory_map (copy, &info, GST_MAP_READ));
+  fail_unless_equals_int (info.size, 1000);
+  fail_unless (info.data[999] == 0xaa);
+  gst_memory_unmap (copy, &info);
+  gst_memory_unref (copy);
+  gst_memory_unref (mem);
+
+  /* bigger than the biggest size class, gets its own huge pages */
+  gst_allocation_params_init (&params);
+  mem = gst_allocator_alloc (alloc, 3840 * 2160 * 3 / 2, &params);
+  fail_unless (mem != NULL);
+  fail_unless (gst_memory_map (mem, &info, GST_MAP_WRITE));
+  fail_unless ((guintptr) info.data % (2 * 1024 * 1024) == 0);
+  memset (info.data, 0x55, info.size);
+  gst_memory_unmap (mem, &info);
+  gst_memory_unref (mem);
+
+  gst_object_unref (alloc);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_allocator_stats)
+{
+  GstAllocator *alloc;
+  GstAllocationStats stats;
+  GstAllocationParams params;
+  GstMemory *early, *mem, *sub;
+
+  alloc = gst_allocator_find (NULL);
+  fail_unless (alloc != NULL);
+  fail_if (gst_allocator_get_stats (alloc, &stats));
+
+  /* allocated before the stats were enabled, not counted when freed */
+  early = gst_allocator_alloc (alloc, 100, NULL);
+
+  gst_allocator_set_stats_enabled (alloc, TRUE);
+  fail_unless (gst_allocator_get_stats (alloc, &stats));
+  fail_unless_equals_uint64 (stats.allocated, 0);
+  fail_unless_equals_uint64 (stats.live_bytes, 0);
+
+  gst_allocation_params_init (&params);
+  params.prefix = 16;
+  mem = gst_allocator_alloc (alloc, 1000, &params);
+  fail_unless (gst_allocator_get_stats (alloc, &stats));
+  fail_unless_equals_uint64 (stats.allocated, 1);
+  fail_unless_equals_uint64 (stats.live_bytes, mem->maxsize);
+  fail_unless (stats.live_bytes >= 1016);
+
+  /* sub memory doesn't allocate */
+  sub = gst_memory_share (mem, 10, 20);
+  gst_memory_unref (sub);
+  gst_memory_unref (early);
+  fail_unless (gst_allocator_get_stats (alloc, &stats));
+  fail_unless_equals_uint64 (stats.allocated, 1);
+  fail_unless_equals_uint64 (stats.freed, 0);
+
+  gst_memory_unref (mem);
+  fail_unless (gst_allocator_get_stats (alloc, &stats));
+  fail_unless_equals_uint64 (stats.freed, 1);
+  fail_unless_equals_uint64 (stats.live_bytes, 0);
+  fail_unless (stats.peak_bytes >= 1016);
+  fail_unless_equals_uint64 (stats.failed, 0);
+
+  gst_allocator_set_stats_enabled (alloc, FALSE);
+  fail_if (gst_allocator_get_stats (alloc, &stats));
+  gst_object_unref (alloc);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_share_packets)
+{
+  GstAllocator *alloc;
+  GstMemory *mem, *packets[348];
+  gint refcount;
+  guint i;
+  GstMapInfo info;
+
+  alloc = gst_allocator_find (NULL);
+  refcount = GST_OBJECT_REFCOUNT_VALUE (alloc);
+
+  mem = gst_allocator_alloc (NULL, 348 * 188, NULL);
+  for (i = 0; i < G_N_ELEMENTS (packets); i++) {
+    packets[i] = gst_memory_share (mem, i * 188, 188);
+    fail_unless (packets[i]->parent == mem);
+    fail_unless (packets[i]->allocator == alloc);
+  }
+  ASSERT_MINI_OBJECT_REFCOUNT (mem, "memory", 1 + G_N_ELEMENTS (packets));
+  fail_unless_equals_int (GST_OBJECT_REFCOUNT_VALUE (alloc), refcount);
+
+  fail_unless (gst_memory_is_span (packets[0], packets[1], NULL));
+  fail_unless (gst_memory_map (packets[1], &info, GST_MAP_READ));
+  gst_memory_unmap (packets[1], &info);
+
+  for (i = 0; i < G_N_ELEMENTS (packets); i++)
+    gst_memory_unref (packets[i]);
+  ASSERT_MINI_OBJECT_REFCOUNT (mem, "memory", 1);
+  fail_unless (gst_memory_is_writable (mem));
+
+  /* the parent can be shared again after the headers were released */
+  packets[0] = gst_memory_share (mem, 188, 188);
+  fail_unless_equals_int (packets[0]->offset, 188);
+  fail_unless_equals_int (packets[0]->size, 188);
+  gst_memory_unref (packets[0]);
+
+  gst_memory_unref (mem);
+  fail_unless_equals_int (GST_OBJECT_REFCOUNT_VALUE (alloc), refcount);
+  gst_object_unref (alloc);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_memory_suite (void)
 {
@@ -617,6 +772,9 @@ gst_memory_suite (void)
   tcase_add_test (tc_chain, test_map_resize);
   tcase_add_test (tc_chain, test_alloc_params);
   tcase_add_test (tc_chain, test_lock);
+  tcase_add_test (tc_chain, test_hugepages);
+  tcase_add_test (tc_chain, test_allocator_stats);
+  tcase_add_test (tc_chain, test_share_packets);
 
   return s;
 }
@@ -0,0 +1,176 @@
+/* GStreamer
+ *
+ * gstmemorybudget.c: Unit test for GstMemoryBudget
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <gst/check/gstcheck.h>
+
+GST_START_TEST (test_fair_share)
+{
+  GstMemoryBudget *budget;
+  GstMemoryBudgetClient *c1, *c2;
+
+  budget = gst_memory_budget_new (1000);
+  c1 = gst_memory_budget_add_client (budget, 100);
+  c2 = gst_memory_budget_add_client (budget, 100);
+
+  /* c1 can not take memory reserved for the share of c2 */
+  fail_unless (gst_memory_budget_client_try_acquire (c1, 400));
+  fail_if (gst_memory_budget_client_is_exhausted (c1));
+  fail_if (gst_memory_budget_client_try_acquire (c1, 101));
+  fail_unless (gst_memory_budget_client_try_acquire (c1, 100));
+  fail_unless (gst_memory_budget_client_is_exhausted (c1));
+
+  /* so c2 always gets its share */
+  fail_unless (gst_memory_budget_client_try_acquire (c2, 500));
+  fail_unless_equals_uint64 (gst_memory_budget_get_used (budget), 1000);
+
+  /* queues account whole buffers and may go over the limit */
+  gst_memory_budget_client_acquire (c2, 100);
+  fail_unless (gst_memory_budget_client_is_exhausted (c2));
+  fail_unless_equals_uint64 (gst_memory_budget_client_get_used (c2), 600);
+
+  /* the share of c2 stays reserved while it is registered */
+  gst_memory_budget_client_release (c2, 600);
+  fail_unless (gst_memory_budget_client_is_exhausted (c1));
+  gst_memory_budget_remove_client (budget, c2);
+  fail_if (gst_memory_budget_client_is_exhausted (c1));
+  fail_unless (gst_memory_budget_client_try_acquire (c1, 500));
+
+  gst_memory_budget_client_release (c1, 1000);
+  fail_unless_equals_uint64 (gst_memory_budget_get_used (budget), 0);
+
+  gst_memory_budget_remove_client (budget, c1);
+  gst_object_unref (budget);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_priority)
+{
+  GstMemoryBudget *budget;
+  GstMemoryBudgetClient *c1, *c2;
+
+  budget = gst_memory_budget_new (1000);
+  c1 = gst_memory_budget_add_client (budget, 300);
+  c2 = gst_memory_budget_add_client (budget, 100);
+
+  fail_unless (gst_memory_budget_client_try_acquire (c1, 750));
+  fail_if (gst_memory_budget_client_try_acquire (c1, 1));
+  fail_if (gst_memory_budget_client_try_acquire (c2, 251));
+  fail_unless (gst_memory_budget_client_try_acquire (c2, 250));
+
+  /* removing a client gives its share to the others */
+  gst_memory_budget_remove_client (budget, c2);
+  fail_unless_equals_uint64 (gst_memory_budget_get_used (budget), 750);
+  fail_unless (gst_memory_budget_client_try_acquire (c1, 250));
+  fail_unless (gst_memory_budget_client_is_exhausted (c1));
+
+  /* no limit */
+  gst_memory_budget_set_limit (budget, 0);
+  fail_if (gst_memory_budget_client_is_exhausted (c1));
+  fail_unless (gst_memory_budget_client_try_acquire (c1, 1000));
+
+  gst_memory_budget_remove_client (budget, c1);
+  fail_unless_equals_uint64 (gst_memory_budget_get_used (budget), 0);
+  gst_object_unref (budget);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_context)
+{
+  GstMemoryBudget *budget, *budget2 = NULL;
+  GstContext *context;
+
+  budget = gst_memory_budget_new (1000);
+  context = gst_context_new_memory_budget (budget);
+  fail_unless (gst_context_is_persistent (context));
+  fail_unless (gst_context_get_memory_budget (context, &budget2));
+  fail_unless (budget == budget2);
+  gst_object_unref (budget2);
+  gst_context_unref (context);
+
+  context = gst_context_new ("other", FALSE);
+  fail_if (gst_context_get_memory_budget (context, &budget2));
+  gst_context_unref (context);
+
+  gst_object_unref (budget);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_buffer_pool)
+{
+  GstMemoryBudget *budget;
+  GstBufferPool *pool;
+  GstStructure *config;
+  GstBuffer *buf1, *buf2, *buf3;
+  GstBufferPoolAcquireParams params = { 0, };
+
+  budget = gst_memory_budget_new (20);
+  pool = gst_buffer_pool_new ();
+  config = gst_buffer_pool_get_config (pool);
+  gst_buffer_pool_config_set_params (config, NULL, 10, 0, 0);
+  gst_buffer_pool_config_set_memory_budget (config, budget);
+  fail_unless (gst_buffer_pool_set_config (pool, config));
+  gst_buffer_pool_set_active (pool, TRUE);
+
+  params.flags = GST_BUFFER_POOL_ACQUIRE_FLAG_DONTWAIT;
+  fail_unless_equals_int (gst_buffer_pool_acquire_buffer (pool, &buf1,
+          &params), GST_FLOW_OK);
+  fail_unless_equals_int (gst_buffer_pool_acquire_buffer (pool, &buf2,
+          &params), GST_FLOW_OK);
+  fail_unless_equals_uint64 (gst_memory_budget_get_used (budget), 20);
+
+  /* the pool only grows while the budget allows */
+  fail_unless_equals_int (gst_buffer_pool_acquire_buffer (pool, &buf3,
+          &params), GST_FLOW_EOS);
+
+  /* and recycles its own buffers otherwise */
+  gst_buffer_unref (buf2);
+  fail_unless_equals_int (gst_buffer_pool_acquire_buffer (pool, &buf3,
+          &params), GST_FLOW_OK);
+
+  gst_buffer_unref (buf1);
+  gst_buffer_unref (buf3);
+  gst_buffer_pool_set_active (pool, FALSE);
+  fail_unless_equals_uint64 (gst_memory_budget_get_used (budget), 0);
+
+  gst_object_unref (pool);
+  gst_object_unref (budget);
+}
+
+GST_END_TEST;
+
+static Suite *
+gst_memory_budget_suite (void)
+{
+  Suite *s = suite_create ("GstMemoryBudget");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_fair_share);
+  tcase_add_test (tc_chain, test_priority);
+  tcase_add_test (tc_chain, test_context);
+  tcase_add_test (tc_chain, test_buffer_pool);
+
+  return s;
+}
+
+GST_CHECK_MAIN (gst_memory_budget);
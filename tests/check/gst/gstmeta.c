@@ -248,6 +248,73 @@ GST_START_TEST (test_meta_locked)
 
 GST_END_TEST;
 
+static gboolean
+foreach_remove_test_meta (GstBuffer * buffer, GstMeta ** meta,
+    gpointer user_data)
+{
+  if ((*meta)->info->api == GST_META_TEST_API_TYPE)
+    *meta = NULL;
+  return TRUE;
+}
+
+GST_START_TEST (test_meta_lookup)
+{
+  GstBuffer *buffer, *parent;
+  GstParentBufferMeta *pmeta;
+  GstMetaTest *meta, *first;
+  gpointer state = NULL;
+  guint i, n;
+
+  buffer = gst_buffer_new_and_alloc (4);
+  parent = gst_buffer_new ();
+
+  fail_unless (GST_META_TEST_GET (buffer) == NULL);
+  fail_unless (gst_buffer_get_parent_buffer_meta (buffer) == NULL);
+
+  /* more metadata than fits in the buffer itself */
+  first = GST_META_TEST_ADD (buffer);
+  first->pts = 0;
+  for (i = 1; i < 10; i++) {
+    meta = GST_META_TEST_ADD (buffer);
+    fail_unless (meta != NULL);
+    meta->pts = i;
+  }
+  fail_unless (GST_META_TEST_GET (buffer) != NULL);
+  fail_unless (gst_buffer_get_parent_buffer_meta (buffer) == NULL);
+
+  pmeta = gst_buffer_add_parent_buffer_meta (buffer, parent);
+  fail_unless (gst_buffer_get_parent_buffer_meta (buffer) == pmeta);
+
+  n = 0;
+  while (gst_buffer_iterate_meta (buffer, &state))
+    n++;
+  fail_unless_equals_int (n, 11);
+
+  /* the other metadata of the same API is still found */
+  fail_unless (gst_buffer_remove_meta (buffer, (GstMeta *) first));
+  meta = GST_META_TEST_GET (buffer);
+  fail_unless (meta != NULL);
+  fail_unless (meta->pts == 9);
+
+  gst_buffer_foreach_meta (buffer, foreach_remove_test_meta, NULL);
+  fail_unless (GST_META_TEST_GET (buffer) == NULL);
+  fail_unless (gst_buffer_get_parent_buffer_meta (buffer) == pmeta);
+
+  fail_unless (gst_buffer_remove_meta (buffer, (GstMeta *) pmeta));
+  fail_unless (gst_buffer_get_parent_buffer_meta (buffer) == NULL);
+
+  /* room is reused after all metadata is gone */
+  meta = GST_META_TEST_ADD (buffer);
+  meta->pts = 42;
+  fail_unless (GST_META_TEST_GET (buffer) == meta);
+  fail_unless (GST_META_TEST_GET (buffer)->pts == 42);
+
+  gst_buffer_unref (buffer);
+  gst_buffer_unref (parent);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_buffermeta_suite (void)
 {
@@ -257,6 +324,7 @@ gst_buffermeta_suite (void)
   suite_add_tcase (s, tc_chain);
   tcase_add_test (tc_chain, test_meta_test);
   tcase_add_test (tc_chain, test_meta_locked);
+  tcase_add_test (tc_chain, test_meta_lookup);
 
   return s;
 }
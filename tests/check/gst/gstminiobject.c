@@ -21,6 +21,16 @@
  * Boston, MA 02110-1301, USA.
  */
 
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#ifdef HAVE_VALGRIND_H
+# include <valgrind/valgrind.h>
+#else
+# define RUNNING_ON_VALGRIND FALSE
+#endif
+
 #include <gst/check/gstcheck.h>
 
 GST_START_TEST (test_copy)
@@ -446,6 +456,54 @@ GST_START_TEST (test_dup_null_mini_object)
 
 GST_END_TEST;
 
+GST_START_TEST (test_object_cache)
+{
+  GstBuffer *buffer;
+  GstEvent *event;
+  gpointer old;
+
+  buffer = gst_buffer_new_and_alloc (4);
+  GST_BUFFER_PTS (buffer) = 10;
+  GST_BUFFER_FLAG_SET (buffer, GST_BUFFER_FLAG_DISCONT);
+  gst_buffer_unref (buffer);
+
+  buffer = gst_buffer_new ();
+  old = buffer;
+  GST_BUFFER_PTS (buffer) = 20;
+  GST_BUFFER_FLAG_SET (buffer, GST_BUFFER_FLAG_HEADER);
+  gst_buffer_append_memory (buffer, gst_allocator_alloc (NULL, 4, NULL));
+  gst_buffer_unref (buffer);
+
+  /* a reused struct is fully reset */
+  buffer = gst_buffer_new ();
+#ifndef GST_DISABLE_OBJECT_CACHE
+  if (!RUNNING_ON_VALGRIND && g_getenv ("GST_OBJECT_CACHE") == NULL)
+    fail_unless (buffer == old);
+#endif
+  fail_unless (GST_BUFFER_PTS (buffer) == GST_CLOCK_TIME_NONE);
+  fail_unless_equals_int (GST_BUFFER_FLAGS (buffer), 0);
+  fail_unless_equals_int (gst_buffer_n_memory (buffer), 0);
+  fail_unless (GST_MINI_OBJECT_REFCOUNT_VALUE (buffer) == 1);
+  gst_buffer_unref (buffer);
+
+  event = gst_event_new_flush_stop (TRUE);
+  old = event;
+  GST_EVENT_TIMESTAMP (event) = 30;
+  gst_event_unref (event);
+
+  event = gst_event_new_eos ();
+#ifndef GST_DISABLE_OBJECT_CACHE
+  if (!RUNNING_ON_VALGRIND && g_getenv ("GST_OBJECT_CACHE") == NULL)
+    fail_unless (event == old);
+#endif
+  fail_unless (GST_EVENT_TYPE (event) == GST_EVENT_EOS);
+  fail_unless (gst_event_get_structure (event) == NULL);
+  fail_unless (GST_EVENT_TIMESTAMP (event) == GST_CLOCK_TIME_NONE);
+  gst_event_unref (event);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_mini_object_suite (void)
 {
@@ -465,6 +523,7 @@ gst_mini_object_suite (void)
   //tcase_add_test (tc_chain, test_recycle_threaded);
   tcase_add_test (tc_chain, test_value_collection);
   tcase_add_test (tc_chain, test_dup_null_mini_object);
+  tcase_add_test (tc_chain, test_object_cache);
   return s;
 }
 
@@ -536,6 +536,46 @@ GST_START_TEST (test_fake_object_has_as_ancestor)
 
 GST_END_TEST;
 
+static void
+deep_notify_count (GstObject * object, GstObject * orig, GParamSpec * pspec,
+    gint * count)
+{
+  (*count)++;
+}
+
+/* deep-notify handlers connected with a detail only get that property */
+GST_START_TEST (test_fake_object_deep_notify)
+{
+  GstObject *parent, *child;
+  gint all = 0, name = 0;
+
+  parent = g_object_new (gst_fake_object_get_type (), NULL);
+  child = g_object_new (gst_fake_object_get_type (), NULL);
+  fail_unless (gst_object_set_parent (child, parent));
+
+  /* no handlers */
+  g_object_notify (G_OBJECT (child), "name");
+
+  g_signal_connect (parent, "deep-notify::name",
+      G_CALLBACK (deep_notify_count), &name);
+  g_object_notify (G_OBJECT (child), "parent");
+  fail_unless_equals_int (name, 0);
+  g_object_notify (G_OBJECT (child), "name");
+  fail_unless_equals_int (name, 1);
+
+  g_signal_connect (parent, "deep-notify", G_CALLBACK (deep_notify_count),
+      &all);
+  g_object_notify (G_OBJECT (child), "parent");
+  g_object_notify (G_OBJECT (child), "name");
+  fail_unless_equals_int (name, 2);
+  fail_unless_equals_int (all, 2);
+
+  gst_object_unparent (child);
+  gst_object_unref (parent);
+}
+
+GST_END_TEST;
+
 /* test: try renaming a parented object, make sure it fails */
 
 static Suite *
@@ -559,6 +599,7 @@ gst_object_suite (void)
   tcase_add_test (tc_chain, test_fake_object_parentage_dispose);
 
   tcase_add_test (tc_chain, test_fake_object_has_as_ancestor);
+  tcase_add_test (tc_chain, test_fake_object_deep_notify);
   //tcase_add_checked_fixture (tc_chain, setup, teardown);
 
   return s;
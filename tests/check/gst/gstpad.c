@@ -2255,6 +2255,70 @@ GST_START_TEST (test_sticky_events)
 
 GST_END_TEST;
 
+GST_START_TEST (test_sticky_events_lookup)
+{
+  GstPad *srcpad;
+  GstEvent *event;
+  GstSegment seg;
+  GstCaps *caps;
+
+  srcpad = gst_pad_new ("src", GST_PAD_SRC);
+  fail_unless (srcpad != NULL);
+  gst_pad_set_active (srcpad, TRUE);
+
+  fail_unless (gst_pad_get_sticky_event (srcpad, GST_EVENT_CAPS, 0) == NULL);
+
+  /* store out of sequence, tags first */
+  fail_unless (gst_pad_push_event (srcpad,
+          gst_event_new_stream_start ("test")));
+  fail_unless (gst_pad_push_event (srcpad,
+          gst_event_new_tag (gst_tag_list_new (GST_TAG_TITLE, "a", NULL))));
+  caps = gst_caps_new_empty_simple ("foo/bar");
+  fail_unless (gst_pad_push_event (srcpad, gst_event_new_caps (caps)));
+  gst_caps_unref (caps);
+  gst_segment_init (&seg, GST_FORMAT_TIME);
+  fail_unless (gst_pad_push_event (srcpad, gst_event_new_segment (&seg)));
+  fail_unless (gst_pad_push_event (srcpad,
+          gst_event_new_tag (gst_tag_list_new_empty ())));
+
+  /* all types are found, also after inserting before them */
+  event = gst_pad_get_sticky_event (srcpad, GST_EVENT_STREAM_START, 0);
+  fail_unless (event != NULL);
+  gst_event_unref (event);
+  event = gst_pad_get_sticky_event (srcpad, GST_EVENT_CAPS, 0);
+  fail_unless (event != NULL);
+  gst_event_unref (event);
+  event = gst_pad_get_sticky_event (srcpad, GST_EVENT_SEGMENT, 0);
+  fail_unless (event != NULL);
+  gst_event_unref (event);
+  event = gst_pad_get_sticky_event (srcpad, GST_EVENT_TAG, 1);
+  fail_unless (event != NULL);
+  gst_event_unref (event);
+  fail_unless (gst_pad_get_sticky_event (srcpad, GST_EVENT_TAG, 2) == NULL);
+  fail_unless (gst_pad_get_sticky_event (srcpad, GST_EVENT_EOS, 0) == NULL);
+
+  /* stream-start removes the stored EOS */
+  fail_unless (gst_pad_push_event (srcpad, gst_event_new_eos ()));
+  event = gst_pad_get_sticky_event (srcpad, GST_EVENT_EOS, 0);
+  fail_unless (event != NULL);
+  gst_event_unref (event);
+  fail_unless (gst_pad_push_event (srcpad,
+          gst_event_new_stream_start ("test2")));
+  fail_unless (gst_pad_get_sticky_event (srcpad, GST_EVENT_EOS, 0) == NULL);
+  event = gst_pad_get_sticky_event (srcpad, GST_EVENT_TAG, 0);
+  fail_unless (event != NULL);
+  gst_event_unref (event);
+
+  /* deactivating clears everything */
+  gst_pad_set_active (srcpad, FALSE);
+  fail_unless (gst_pad_get_sticky_event (srcpad, GST_EVENT_CAPS, 0) == NULL);
+  fail_unless (gst_pad_get_sticky_event (srcpad, GST_EVENT_TAG, 0) == NULL);
+
+  gst_object_unref (srcpad);
+}
+
+GST_END_TEST;
+
 static GstFlowReturn next_return;
 
 static GstFlowReturn
@@ -2332,6 +2396,175 @@ GST_START_TEST (test_last_flow_return_push)
 
 GST_END_TEST;
 
+static guint batch_chain_calls;
+static guint batch_chain_buffers;
+
+static GstFlowReturn
+test_batch_chain_list (GstPad * pad, GstObject * parent, GstBufferList * list)
+{
+  batch_chain_calls++;
+  batch_chain_buffers += gst_buffer_list_length (list);
+  gst_buffer_list_unref (list);
+
+  return GST_FLOW_OK;
+}
+
+static GstBuffer *
+create_timestamped_buffer (gsize size, GstClockTime pts)
+{
+  GstBuffer *buffer = gst_buffer_new_allocate (NULL, size, NULL);
+
+  GST_BUFFER_PTS (buffer) = pts;
+  return buffer;
+}
+
+GST_START_TEST (test_push_batching)
+{
+  GstPad *srcpad, *sinkpad;
+  GstSegment seg;
+  guint i;
+
+  srcpad = gst_pad_new ("src", GST_PAD_SRC);
+  fail_unless (srcpad != NULL);
+  sinkpad = gst_pad_new ("sink", GST_PAD_SINK);
+  fail_unless (sinkpad != NULL);
+  gst_pad_set_chain_list_function (sinkpad, test_batch_chain_list);
+  gst_pad_link (srcpad, sinkpad);
+  gst_pad_set_active (srcpad, TRUE);
+  gst_pad_set_active (sinkpad, TRUE);
+
+  gst_pad_push_event (srcpad, gst_event_new_stream_start ("test"));
+  gst_segment_init (&seg, GST_FORMAT_TIME);
+  gst_pad_push_event (srcpad, gst_event_new_segment (&seg));
+
+  batch_chain_calls = batch_chain_buffers = 0;
+  gst_pad_set_batching (srcpad, 3, 0, GST_CLOCK_TIME_NONE);
+  fail_unless (GST_PAD_IS_BATCHING (srcpad));
+
+  /* count threshold */
+  for (i = 0; i < 7; i++)
+    fail_unless (gst_pad_push (srcpad, gst_buffer_new ()) == GST_FLOW_OK);
+  fail_unless_equals_int (batch_chain_calls, 2);
+  fail_unless_equals_int (batch_chain_buffers, 6);
+
+  /* serialized events push the pending buffers first */
+  fail_unless (gst_pad_push_event (srcpad,
+          gst_event_new_custom (GST_EVENT_CUSTOM_DOWNSTREAM,
+              gst_structure_new_empty ("test"))));
+  fail_unless_equals_int (batch_chain_calls, 3);
+  fail_unless_equals_int (batch_chain_buffers, 7);
+
+  /* explicit push, nothing pending */
+  fail_unless (gst_pad_push_batch (srcpad) == GST_FLOW_OK);
+  fail_unless_equals_int (batch_chain_calls, 3);
+
+  /* bytes threshold */
+  gst_pad_set_batching (srcpad, 100, 100, GST_CLOCK_TIME_NONE);
+  fail_unless (gst_pad_push (srcpad, create_timestamped_buffer (60,
+              GST_CLOCK_TIME_NONE)) == GST_FLOW_OK);
+  fail_unless_equals_int (batch_chain_calls, 3);
+  fail_unless (gst_pad_push (srcpad, create_timestamped_buffer (60,
+              GST_CLOCK_TIME_NONE)) == GST_FLOW_OK);
+  fail_unless_equals_int (batch_chain_calls, 4);
+  fail_unless_equals_int (batch_chain_buffers, 9);
+
+  /* latency threshold */
+  gst_pad_set_batching (srcpad, 100, 0, 20 * GST_MSECOND);
+  for (i = 0; i < 3; i++)
+    fail_unless (gst_pad_push (srcpad, create_timestamped_buffer (1,
+                i * 10 * GST_MSECOND)) == GST_FLOW_OK);
+  fail_unless_equals_int (batch_chain_calls, 5);
+  fail_unless_equals_int (batch_chain_buffers, 12);
+
+  /* flushing discards the pending buffers */
+  fail_unless (gst_pad_push (srcpad, gst_buffer_new ()) == GST_FLOW_OK);
+  gst_pad_push_event (srcpad, gst_event_new_flush_start ());
+  gst_pad_push_event (srcpad, gst_event_new_flush_stop (TRUE));
+  fail_unless (gst_pad_push_batch (srcpad) == GST_FLOW_OK);
+  fail_unless_equals_int (batch_chain_calls, 5);
+  fail_unless_equals_int (batch_chain_buffers, 12);
+
+  /* disabling pushes the pending buffers */
+  gst_pad_push_event (srcpad, gst_event_new_stream_start ("test"));
+  gst_pad_push_event (srcpad, gst_event_new_segment (&seg));
+  fail_unless (gst_pad_push (srcpad, gst_buffer_new ()) == GST_FLOW_OK);
+  gst_pad_set_batching (srcpad, 0, 0, GST_CLOCK_TIME_NONE);
+  fail_if (GST_PAD_IS_BATCHING (srcpad));
+  fail_unless_equals_int (batch_chain_calls, 6);
+  fail_unless_equals_int (batch_chain_buffers, 13);
+
+  gst_object_unref (srcpad);
+  gst_object_unref (sinkpad);
+}
+
+GST_END_TEST;
+
+static gint probe_mask_calls;
+
+static GstPadProbeReturn
+probe_mask_cb (GstPad * pad, GstPadProbeInfo * info, gpointer data)
+{
+  probe_mask_calls++;
+  return GST_PAD_PROBE_OK;
+}
+
+GST_START_TEST (test_probe_mask_fast_path)
+{
+  GstPad *srcpad, *sinkpad;
+  GstSegment seg;
+  gulong id, buffer_id;
+
+  srcpad = gst_pad_new ("src", GST_PAD_SRC);
+  fail_unless (srcpad != NULL);
+  sinkpad = gst_pad_new ("sink", GST_PAD_SINK);
+  fail_unless (sinkpad != NULL);
+  gst_pad_set_chain_function (sinkpad, gst_check_chain_func);
+  gst_pad_link (srcpad, sinkpad);
+  gst_pad_set_active (srcpad, TRUE);
+  gst_pad_set_active (sinkpad, TRUE);
+
+  gst_pad_push_event (srcpad, gst_event_new_stream_start ("test"));
+  gst_segment_init (&seg, GST_FORMAT_TIME);
+  gst_pad_push_event (srcpad, gst_event_new_segment (&seg));
+
+  /* an event probe is not called for buffers */
+  probe_mask_calls = 0;
+  id = gst_pad_add_probe (srcpad, GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM,
+      probe_mask_cb, NULL, NULL);
+  fail_unless (gst_pad_push (srcpad, gst_buffer_new ()) == GST_FLOW_OK);
+  fail_unless_equals_int (probe_mask_calls, 0);
+
+  /* a buffer probe added next to it is */
+  buffer_id = gst_pad_add_probe (srcpad, GST_PAD_PROBE_TYPE_BUFFER,
+      probe_mask_cb, NULL, NULL);
+  fail_unless (gst_pad_push (srcpad, gst_buffer_new ()) == GST_FLOW_OK);
+  fail_unless_equals_int (probe_mask_calls, 1);
+
+  /* and no longer after removing it */
+  gst_pad_remove_probe (srcpad, buffer_id);
+  fail_unless (gst_pad_push (srcpad, gst_buffer_new ()) == GST_FLOW_OK);
+  fail_unless_equals_int (probe_mask_calls, 1);
+
+  /* the event probe still works */
+  fail_unless (gst_pad_push_event (srcpad,
+          gst_event_new_custom (GST_EVENT_CUSTOM_DOWNSTREAM,
+              gst_structure_new_empty ("test"))));
+  fail_unless_equals_int (probe_mask_calls, 2);
+
+  /* flush events only reach probes that ask for them */
+  gst_pad_push_event (srcpad, gst_event_new_flush_start ());
+  gst_pad_push_event (srcpad, gst_event_new_flush_stop (TRUE));
+  fail_unless_equals_int (probe_mask_calls, 2);
+
+  gst_pad_remove_probe (srcpad, id);
+  gst_check_drop_buffers ();
+
+  gst_object_unref (srcpad);
+  gst_object_unref (sinkpad);
+}
+
+GST_END_TEST;
+
 static GstFlowReturn
 test_lastflow_getrange (GstPad * pad, GstObject * parent, guint64 offset,
     guint length, GstBuffer ** buf)
@@ -2418,6 +2651,115 @@ GST_START_TEST (test_last_flow_return_pull)
 
 GST_END_TEST;
 
+static GstFlowReturn
+test_ranges_getrange (GstPad * pad, GstObject * parent, guint64 offset,
+    guint length, GstBuffer ** buf)
+{
+  if (offset >= 100)
+    return GST_FLOW_EOS;
+
+  *buf = gst_buffer_new_allocate (NULL, length, NULL);
+  GST_BUFFER_OFFSET (*buf) = offset;
+  return GST_FLOW_OK;
+}
+
+static gint getranges_calls;
+
+static GstFlowReturn
+test_ranges_getranges (GstPad * pad, GstObject * parent,
+    const GstPadRange * ranges, guint n_ranges, GstBuffer ** buffers)
+{
+  GstFlowReturn ret = GST_FLOW_OK;
+  guint i;
+
+  getranges_calls++;
+  for (i = 0; i < n_ranges && ret == GST_FLOW_OK; i++)
+    ret = test_ranges_getrange (pad, parent, ranges[i].offset,
+        ranges[i].size, &buffers[i]);
+
+  return ret;
+}
+
+static GstPadProbeReturn
+test_ranges_probe (GstPad * pad, GstPadProbeInfo * info, gpointer user_data)
+{
+  (*(gint *) user_data)++;
+  return GST_PAD_PROBE_OK;
+}
+
+GST_START_TEST (test_pull_ranges)
+{
+  GstPad *srcpad, *sinkpad;
+  GstPadRange ranges[] = { {10, 5}, {50, 20}, {90, 10} };
+  GstBuffer *buffers[3];
+  gint probed = 0;
+  gulong id;
+  guint i;
+
+  srcpad = gst_pad_new ("src", GST_PAD_SRC);
+  sinkpad = gst_pad_new ("sink", GST_PAD_SINK);
+  gst_pad_set_getrange_function (srcpad, test_ranges_getrange);
+  gst_pad_set_activate_function (sinkpad, test_lastflow_activate_pull_func);
+  fail_unless (gst_pad_link (srcpad, sinkpad) == GST_PAD_LINK_OK);
+  gst_pad_set_active (sinkpad, TRUE);
+
+  /* without a getranges function each range is pulled separately */
+  fail_unless_equals_int (gst_pad_pull_ranges (sinkpad, ranges, 3, buffers),
+      GST_FLOW_OK);
+  for (i = 0; i < 3; i++) {
+    fail_unless_equals_uint64 (GST_BUFFER_OFFSET (buffers[i]),
+        ranges[i].offset);
+    fail_unless_equals_int (gst_buffer_get_size (buffers[i]), ranges[i].size);
+    gst_buffer_unref (buffers[i]);
+  }
+
+  gst_pad_set_getranges_function (srcpad, test_ranges_getranges);
+  fail_unless_equals_int (gst_pad_pull_ranges (sinkpad, ranges, 3, buffers),
+      GST_FLOW_OK);
+  fail_unless_equals_int (getranges_calls, 1);
+  for (i = 0; i < 3; i++) {
+    fail_unless_equals_uint64 (GST_BUFFER_OFFSET (buffers[i]),
+        ranges[i].offset);
+    gst_buffer_unref (buffers[i]);
+  }
+  fail_unless_equals_int (gst_pad_get_last_flow_return (sinkpad),
+      GST_FLOW_OK);
+
+  /* the buffers before the failed range are kept */
+  ranges[1].offset = 100;
+  fail_unless_equals_int (gst_pad_pull_ranges (sinkpad, ranges, 3, buffers),
+      GST_FLOW_EOS);
+  fail_unless_equals_int (getranges_calls, 2);
+  fail_unless (buffers[0] != NULL);
+  fail_unless (buffers[1] == NULL);
+  fail_unless (buffers[2] == NULL);
+  gst_buffer_unref (buffers[0]);
+  fail_unless_equals_int (gst_pad_get_last_flow_return (sinkpad),
+      GST_FLOW_EOS);
+  ranges[1].offset = 50;
+
+  /* probes see every range */
+  id = gst_pad_add_probe (srcpad, GST_PAD_PROBE_TYPE_PULL |
+      GST_PAD_PROBE_TYPE_BUFFER, test_ranges_probe, &probed, NULL);
+  fail_unless_equals_int (gst_pad_pull_ranges (sinkpad, ranges, 3, buffers),
+      GST_FLOW_OK);
+  fail_unless_equals_int (getranges_calls, 2);
+  fail_unless_equals_int (probed, 3);
+  for (i = 0; i < 3; i++)
+    gst_buffer_unref (buffers[i]);
+  gst_pad_remove_probe (srcpad, id);
+
+  gst_pad_unlink (srcpad, sinkpad);
+  fail_unless_equals_int (gst_pad_pull_ranges (sinkpad, ranges, 3, buffers),
+      GST_FLOW_NOT_LINKED);
+  fail_unless (buffers[0] == NULL);
+
+  gst_object_unref (srcpad);
+  gst_object_unref (sinkpad);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_flush_stop_inactive)
 {
   GstPad *sinkpad, *srcpad;
@@ -2685,6 +3027,270 @@ GST_START_TEST (test_proxy_accept_caps_with_incompatible_proxy)
 
 GST_END_TEST;
 
+static gint allocation_queries;
+
+static gboolean
+allocation_query_func (GstPad * pad, GstObject * parent, GstQuery * query)
+{
+  GstBufferPool *pool;
+
+  if (GST_QUERY_TYPE (query) != GST_QUERY_ALLOCATION)
+    return gst_pad_query_default (pad, parent, query);
+
+  allocation_queries++;
+  pool = gst_buffer_pool_new ();
+  gst_query_add_allocation_pool (query, pool, 100, 2, 0);
+  gst_query_add_allocation_meta (query, GST_PARENT_BUFFER_META_API_TYPE,
+      NULL);
+  gst_object_unref (pool);
+
+  return TRUE;
+}
+
+GST_START_TEST (test_cache_allocation)
+{
+  GstPad *sinkpad;
+  GstQuery *query;
+  GstCaps *caps1, *caps2;
+  GstBufferPool *pool1, *pool2;
+  guint size, min, max;
+
+  allocation_queries = 0;
+  sinkpad = gst_pad_new ("sink", GST_PAD_SINK);
+  gst_pad_set_query_function (sinkpad, allocation_query_func);
+  GST_PAD_SET_CACHE_ALLOCATION (sinkpad);
+  gst_pad_set_active (sinkpad, TRUE);
+
+  caps1 = gst_caps_new_empty_simple ("test/one");
+  caps2 = gst_caps_new_empty_simple ("test/two");
+
+  query = gst_query_new_allocation (caps1, TRUE);
+  fail_unless (gst_pad_query (sinkpad, query));
+  gst_query_parse_nth_allocation_pool (query, 0, &pool1, NULL, NULL, NULL);
+  gst_query_unref (query);
+  fail_unless_equals_int (allocation_queries, 1);
+
+  /* same caps, answered from the cache */
+  query = gst_query_new_allocation (caps1, TRUE);
+  fail_unless (gst_pad_query (sinkpad, query));
+  fail_unless_equals_int (allocation_queries, 1);
+  fail_unless_equals_int (gst_query_get_n_allocation_pools (query), 1);
+  gst_query_parse_nth_allocation_pool (query, 0, &pool2, &size, &min, &max);
+  fail_unless (pool1 == pool2);
+  fail_unless_equals_int (size, 100);
+  fail_unless_equals_int (min, 2);
+  fail_unless_equals_int (max, 0);
+  fail_unless (gst_query_find_allocation_meta (query,
+          GST_PARENT_BUFFER_META_API_TYPE, NULL));
+  gst_object_unref (pool2);
+  gst_query_unref (query);
+
+  /* other caps or need-pool values are not */
+  query = gst_query_new_allocation (caps2, TRUE);
+  fail_unless (gst_pad_query (sinkpad, query));
+  gst_query_unref (query);
+  fail_unless_equals_int (allocation_queries, 2);
+  query = gst_query_new_allocation (caps2, FALSE);
+  fail_unless (gst_pad_query (sinkpad, query));
+  gst_query_unref (query);
+  fail_unless_equals_int (allocation_queries, 3);
+
+  /* reconfiguring invalidates the cache */
+  gst_pad_push_event (sinkpad, gst_event_new_reconfigure ());
+  query = gst_query_new_allocation (caps2, FALSE);
+  fail_unless (gst_pad_query (sinkpad, query));
+  gst_query_unref (query);
+  fail_unless_equals_int (allocation_queries, 4);
+
+  /* and so does unsetting the flag */
+  GST_PAD_UNSET_CACHE_ALLOCATION (sinkpad);
+  query = gst_query_new_allocation (caps2, FALSE);
+  fail_unless (gst_pad_query (sinkpad, query));
+  gst_query_unref (query);
+  fail_unless_equals_int (allocation_queries, 5);
+
+  gst_object_unref (pool1);
+  gst_caps_unref (caps1);
+  gst_caps_unref (caps2);
+  gst_pad_set_active (sinkpad, FALSE);
+  gst_object_unref (sinkpad);
+}
+
+GST_END_TEST;
+
+static gint caps_queries;
+
+static gboolean
+caps_query_func (GstPad * pad, GstObject * parent, GstQuery * query)
+{
+  GstCaps *caps;
+
+  switch (GST_QUERY_TYPE (query)) {
+    case GST_QUERY_CAPS:
+      caps_queries++;
+      caps = gst_caps_new_empty_simple ("test/caps");
+      gst_query_set_caps_result (query, caps);
+      gst_caps_unref (caps);
+      return TRUE;
+    case GST_QUERY_ACCEPT_CAPS:
+      caps_queries++;
+      gst_query_parse_accept_caps (query, &caps);
+      gst_query_set_accept_caps_result (query,
+          gst_caps_is_equal (caps, GST_CAPS_ANY));
+      return TRUE;
+    default:
+      return gst_pad_query_default (pad, parent, query);
+  }
+}
+
+GST_START_TEST (test_caps_cache)
+{
+  GstPad *srcpad, *sinkpad;
+  GstCaps *caps, *filter;
+
+  caps_queries = 0;
+  srcpad = gst_pad_new ("src", GST_PAD_SRC);
+  sinkpad = gst_pad_new ("sink", GST_PAD_SINK);
+  gst_pad_set_query_function (sinkpad, caps_query_func);
+  gst_pad_set_caps_cache_enabled (sinkpad, TRUE);
+  fail_unless (gst_pad_get_caps_cache_enabled (sinkpad));
+  gst_pad_set_active (srcpad, TRUE);
+  gst_pad_set_active (sinkpad, TRUE);
+  fail_unless (gst_pad_link (srcpad, sinkpad) == GST_PAD_LINK_OK);
+
+  /* linking queried the caps, start counting from here */
+  caps_queries = 0;
+  filter = gst_caps_new_empty_simple ("test/caps");
+
+  caps = gst_pad_peer_query_caps (srcpad, NULL);
+  gst_caps_unref (caps);
+  caps = gst_pad_peer_query_caps (srcpad, NULL);
+  fail_unless (gst_caps_is_equal (caps, filter));
+  gst_caps_unref (caps);
+  fail_unless_equals_int (caps_queries, 1);
+
+  /* a different filter is not cached yet */
+  caps = gst_pad_peer_query_caps (srcpad, filter);
+  gst_caps_unref (caps);
+  fail_unless_equals_int (caps_queries, 2);
+
+  fail_unless (gst_pad_peer_query_accept_caps (srcpad, GST_CAPS_ANY));
+  fail_unless (gst_pad_peer_query_accept_caps (srcpad, GST_CAPS_ANY));
+  fail_unless_equals_int (caps_queries, 3);
+  fail_if (gst_pad_peer_query_accept_caps (srcpad, filter));
+  fail_if (gst_pad_peer_query_accept_caps (srcpad, filter));
+  fail_unless_equals_int (caps_queries, 4);
+
+  /* reconfigure clears the cache */
+  gst_pad_push_event (sinkpad, gst_event_new_reconfigure ());
+  caps = gst_pad_peer_query_caps (srcpad, filter);
+  gst_caps_unref (caps);
+  fail_unless_equals_int (caps_queries, 5);
+
+  /* and so does relinking */
+  fail_unless (gst_pad_unlink (srcpad, sinkpad));
+  fail_unless (gst_pad_link (srcpad, sinkpad) == GST_PAD_LINK_OK);
+  caps_queries = 0;
+  fail_if (gst_pad_peer_query_accept_caps (srcpad, filter));
+  fail_unless_equals_int (caps_queries, 1);
+
+  /* disabled cache */
+  gst_pad_set_caps_cache_enabled (sinkpad, FALSE);
+  fail_if (gst_pad_peer_query_accept_caps (srcpad, filter));
+  fail_unless_equals_int (caps_queries, 2);
+
+  gst_caps_unref (filter);
+  gst_pad_set_active (srcpad, FALSE);
+  gst_pad_set_active (sinkpad, FALSE);
+  gst_object_unref (srcpad);
+  gst_object_unref (sinkpad);
+}
+
+GST_END_TEST;
+
+static GList *queued_order;
+
+static gboolean
+queued_event_func (GstPad * pad, GstObject * parent, GstEvent * event)
+{
+  if (GST_EVENT_TYPE (event) == GST_EVENT_CUSTOM_DOWNSTREAM)
+    queued_order = g_list_append (queued_order, event);
+  else
+    gst_event_unref (event);
+  return TRUE;
+}
+
+static GstFlowReturn
+queued_chain_func (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+{
+  queued_order = g_list_append (queued_order, buffer);
+  return GST_FLOW_OK;
+}
+
+GST_START_TEST (test_queue_event)
+{
+  GstPad *srcpad, *sinkpad;
+  GstEvent *ev1, *ev2;
+  GstBuffer *buffer;
+  GstSegment segment;
+
+  srcpad = gst_pad_new ("src", GST_PAD_SRC);
+  sinkpad = gst_pad_new ("sink", GST_PAD_SINK);
+  gst_pad_set_event_function (sinkpad, queued_event_func);
+  gst_pad_set_chain_function (sinkpad, queued_chain_func);
+  fail_unless (gst_pad_link (srcpad, sinkpad) == GST_PAD_LINK_OK);
+
+  /* not queued while flushing */
+  ev1 = gst_event_new_custom (GST_EVENT_CUSTOM_DOWNSTREAM,
+      gst_structure_new_empty ("one"));
+  fail_if (gst_pad_queue_event (srcpad, ev1));
+
+  gst_pad_set_active (srcpad, TRUE);
+  gst_pad_set_active (sinkpad, TRUE);
+  gst_pad_push_event (srcpad, gst_event_new_stream_start ("test"));
+  gst_segment_init (&segment, GST_FORMAT_TIME);
+  gst_pad_push_event (srcpad, gst_event_new_segment (&segment));
+
+  ev1 = gst_event_new_custom (GST_EVENT_CUSTOM_DOWNSTREAM,
+      gst_structure_new_empty ("one"));
+  ev2 = gst_event_new_custom (GST_EVENT_CUSTOM_DOWNSTREAM,
+      gst_structure_new_empty ("two"));
+  fail_unless (gst_pad_queue_event (srcpad, ev1));
+  fail_unless (gst_pad_queue_event (srcpad, ev2));
+  fail_unless (queued_order == NULL);
+
+  /* the events go before the next buffer, in order */
+  buffer = gst_buffer_new ();
+  fail_unless_equals_int (gst_pad_push (srcpad, buffer), GST_FLOW_OK);
+  fail_unless_equals_int (g_list_length (queued_order), 3);
+  fail_unless (g_list_nth_data (queued_order, 0) == ev1);
+  fail_unless (g_list_nth_data (queued_order, 1) == ev2);
+  fail_unless (g_list_nth_data (queued_order, 2) == buffer);
+  g_list_free_full (queued_order, (GDestroyNotify) gst_mini_object_unref);
+  queued_order = NULL;
+
+  /* flushing drops them */
+  ev1 = gst_event_new_custom (GST_EVENT_CUSTOM_DOWNSTREAM,
+      gst_structure_new_empty ("one"));
+  fail_unless (gst_pad_queue_event (srcpad, ev1));
+  gst_pad_push_event (srcpad, gst_event_new_flush_start ());
+  gst_pad_push_event (srcpad, gst_event_new_flush_stop (TRUE));
+  gst_pad_push_event (srcpad, gst_event_new_segment (&segment));
+  fail_unless_equals_int (gst_pad_push (srcpad, gst_buffer_new ()),
+      GST_FLOW_OK);
+  fail_unless_equals_int (g_list_length (queued_order), 1);
+  fail_unless (GST_IS_BUFFER (queued_order->data));
+  g_list_free_full (queued_order, (GDestroyNotify) gst_mini_object_unref);
+  queued_order = NULL;
+
+  gst_pad_set_active (srcpad, FALSE);
+  gst_pad_set_active (sinkpad, FALSE);
+  gst_object_unref (srcpad);
+  gst_object_unref (sinkpad);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_pad_suite (void)
 {
@@ -2733,12 +3339,19 @@ gst_pad_suite (void)
   tcase_add_test (tc_chain, test_block_async_full_destroy_dispose);
   tcase_add_test (tc_chain, test_block_async_replace_callback_no_flush);
   tcase_add_test (tc_chain, test_sticky_events);
+  tcase_add_test (tc_chain, test_sticky_events_lookup);
   tcase_add_test (tc_chain, test_last_flow_return_push);
+  tcase_add_test (tc_chain, test_push_batching);
+  tcase_add_test (tc_chain, test_probe_mask_fast_path);
   tcase_add_test (tc_chain, test_last_flow_return_pull);
   tcase_add_test (tc_chain, test_flush_stop_inactive);
   tcase_add_test (tc_chain, test_proxy_accept_caps_no_proxy);
   tcase_add_test (tc_chain, test_proxy_accept_caps_with_proxy);
   tcase_add_test (tc_chain, test_proxy_accept_caps_with_incompatible_proxy);
+  tcase_add_test (tc_chain, test_cache_allocation);
+  tcase_add_test (tc_chain, test_caps_cache);
+  tcase_add_test (tc_chain, test_queue_event);
+  tcase_add_test (tc_chain, test_pull_ranges);
 
   return s;
 }
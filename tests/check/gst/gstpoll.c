@@ -318,6 +318,65 @@ GST_START_TEST (test_poll_controllable)
 
 GST_END_TEST;
 
+#define N_SOCKETS 64
+
+GST_START_TEST (test_poll_many_fds)
+{
+  GstPoll *set;
+  GstPollFD fds[N_SOCKETS];
+  gint socks[N_SOCKETS][2];
+  gchar c = 'x';
+  gint i;
+
+  set = gst_poll_new (TRUE);
+  fail_if (set == NULL, "Failed to create a GstPoll");
+
+  for (i = 0; i < N_SOCKETS; i++) {
+    fail_if (socketpair (PF_UNIX, SOCK_STREAM, 0, socks[i]) < 0);
+    gst_poll_fd_init (&fds[i]);
+    fds[i].fd = socks[i][0];
+    fail_unless (gst_poll_add_fd (set, &fds[i]), "Could not add descriptor");
+    fail_unless (gst_poll_fd_ctl_read (set, &fds[i], TRUE),
+        "Could not mark the descriptor as readable");
+  }
+
+  fail_unless (gst_poll_wait (set, 10 * GST_MSECOND) == 0,
+      "Waiting did not timeout");
+
+  /* only the descriptors we wrote to are readable */
+  fail_unless (write (socks[3][1], &c, 1) == 1);
+  fail_unless (write (socks[N_SOCKETS - 1][1], &c, 1) == 1);
+  fail_unless (gst_poll_wait (set, GST_SECOND) == 2, "Expected 2 readable fds");
+  for (i = 0; i < N_SOCKETS; i++) {
+    gboolean readable = (i == 3 || i == N_SOCKETS - 1);
+
+    fail_unless (gst_poll_fd_can_read (set, &fds[i]) == readable,
+        "Unexpected read state for descriptor %d", i);
+  }
+  fail_unless (read (socks[3][0], &c, 1) == 1);
+
+  /* removing a descriptor moves others around, the remaining data must
+   * still be reported on the right descriptor */
+  fail_unless (gst_poll_remove_fd (set, &fds[0]), "Could not remove descriptor");
+  fail_unless (gst_poll_wait (set, GST_SECOND) == 1, "Expected 1 readable fd");
+  fail_unless (gst_poll_fd_can_read (set, &fds[N_SOCKETS - 1]));
+  fail_if (gst_poll_fd_can_read (set, &fds[3]));
+  fail_unless (read (socks[N_SOCKETS - 1][0], &c, 1) == 1);
+
+  /* timeouts that are not a multiple of milliseconds */
+  fail_unless (gst_poll_wait (set, 1500 * GST_USECOND) == 0,
+      "Waiting did not timeout");
+
+  gst_poll_free (set);
+
+  for (i = 0; i < N_SOCKETS; i++) {
+    close (socks[i][0]);
+    close (socks[i][1]);
+  }
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_poll_suite (void)
 {
@@ -336,6 +395,7 @@ gst_poll_suite (void)
   tcase_add_test (tc_chain, test_poll_wait_restart);
   tcase_add_test (tc_chain, test_poll_wait_flush);
   tcase_add_test (tc_chain, test_poll_controllable);
+  tcase_add_test (tc_chain, test_poll_many_fds);
 #else
   tcase_skip_broken_test (tc_chain, test_poll_basic);
   tcase_skip_broken_test (tc_chain, test_poll_wait);
@@ -343,6 +403,7 @@ gst_poll_suite (void)
   tcase_skip_broken_test (tc_chain, test_poll_wait_restart);
   tcase_skip_broken_test (tc_chain, test_poll_wait_flush);
   tcase_skip_broken_test (tc_chain, test_poll_controllable);
+  tcase_skip_broken_test (tc_chain, test_poll_many_fds);
 #endif
 
   return s;
@@ -242,6 +242,59 @@ GST_START_TEST (test_two_instances)
 
 GST_END_TEST;
 
+GST_START_TEST (test_resave)
+{
+  GstElement *elem;
+  gint val;
+
+  elem = gst_element_factory_make (GST_PRESET_TEST_NAME, NULL);
+  g_object_set (elem, "test", 5, NULL);
+  fail_unless (gst_preset_save_preset (GST_PRESET (elem), "test"));
+  fail_unless (gst_preset_load_preset (GST_PRESET (elem), "test"));
+
+  /* the values of the preset are not stale after saving it again */
+  g_object_set (elem, "test", 7, NULL);
+  fail_unless (gst_preset_save_preset (GST_PRESET (elem), "test"));
+  g_object_set (elem, "test", 0, NULL);
+  fail_unless (gst_preset_load_preset (GST_PRESET (elem), "test"));
+  g_object_get (elem, "test", &val, NULL);
+  fail_unless_equals_int (val, 7);
+
+  gst_object_unref (elem);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_reload)
+{
+  GstElement *elem;
+  gchar *preset_file_name;
+  gint val;
+
+  elem = gst_element_factory_make (GST_PRESET_TEST_NAME, NULL);
+  g_object_set (elem, "test", 5, NULL);
+  fail_unless (gst_preset_save_preset (GST_PRESET (elem), "test"));
+  fail_unless (gst_preset_load_preset (GST_PRESET (elem), "test"));
+
+  /* change the file behind our back */
+  preset_file_name = g_build_filename (g_get_user_data_dir (),
+      "gstreamer-" GST_API_VERSION, "presets", "GstPresetTest.prs", NULL);
+  fail_unless (g_file_set_contents (preset_file_name,
+          "[_presets_]\nelement-name=GstPresetTest\nversion=" VERSION "\n"
+          "[test]\ntest=123\n", -1, NULL));
+  g_free (preset_file_name);
+
+  /* the files are checked at most once per second */
+  g_usleep (G_USEC_PER_SEC + G_USEC_PER_SEC / 10);
+  fail_unless (gst_preset_load_preset (GST_PRESET (elem), "test"));
+  g_object_get (elem, "test", &val, NULL);
+  fail_unless_equals_int (val, 123);
+
+  gst_object_unref (elem);
+}
+
+GST_END_TEST;
+
 
 static void
 remove_preset_file (void)
@@ -294,6 +347,8 @@ gst_preset_suite (void)
     tcase_add_test (tc, test_add);
     tcase_add_test (tc, test_del);
     tcase_add_test (tc, test_two_instances);
+    tcase_add_test (tc, test_resave);
+    tcase_add_test (tc, test_reload);
   }
   tcase_add_unchecked_fixture (tc, test_setup, test_teardown);
 
@@ -980,6 +980,89 @@ GST_START_TEST (segment_negative_applied_rate)
 
 GST_END_TEST;
 
+static void
+check_segment_transform (const GstSegment * segment)
+{
+  GstSegmentTransform trans;
+  guint64 positions[32], results[32];
+  guint64 rt, st, res;
+  gint sign;
+  guint i;
+
+  gst_segment_transform_init (&trans, segment);
+
+  for (i = 0; i < G_N_ELEMENTS (positions) - 1; i++)
+    positions[i] = i * 10;
+  positions[i] = -1;
+
+  for (i = 0; i < G_N_ELEMENTS (positions); i++) {
+    sign = gst_segment_to_running_time_full (segment, GST_FORMAT_TIME,
+        positions[i], &rt);
+    fail_unless_equals_int (gst_segment_transform_to_running_time_full (&trans,
+            positions[i], &res), sign);
+    if (sign != 0)
+      fail_unless_equals_uint64 (res, rt);
+    fail_unless_equals_uint64 (gst_segment_transform_to_running_time (&trans,
+            positions[i]), gst_segment_to_running_time (segment,
+            GST_FORMAT_TIME, positions[i]));
+
+    sign = gst_segment_to_stream_time_full (segment, GST_FORMAT_TIME,
+        positions[i], &st);
+    fail_unless_equals_int (gst_segment_transform_to_stream_time_full (&trans,
+            positions[i], &res), sign);
+    if (sign != 0)
+      fail_unless_equals_uint64 (res, st);
+    fail_unless_equals_uint64 (gst_segment_transform_to_stream_time (&trans,
+            positions[i]), gst_segment_to_stream_time (segment,
+            GST_FORMAT_TIME, positions[i]));
+  }
+
+  gst_segment_transform_to_running_time_array (&trans, positions, results,
+      G_N_ELEMENTS (positions));
+  for (i = 0; i < G_N_ELEMENTS (positions); i++)
+    fail_unless_equals_uint64 (results[i],
+        gst_segment_to_running_time (segment, GST_FORMAT_TIME, positions[i]));
+
+  /* in place */
+  memcpy (results, positions, sizeof (positions));
+  gst_segment_transform_to_stream_time_array (&trans, results, results,
+      G_N_ELEMENTS (positions));
+  for (i = 0; i < G_N_ELEMENTS (positions); i++)
+    fail_unless_equals_uint64 (results[i],
+        gst_segment_to_stream_time (segment, GST_FORMAT_TIME, positions[i]));
+}
+
+GST_START_TEST (segment_transform)
+{
+  GstSegment segment;
+
+  gst_segment_init (&segment, GST_FORMAT_TIME);
+  check_segment_transform (&segment);
+
+  segment.start = 50;
+  segment.stop = 200;
+  segment.time = 30;
+  segment.base = 40;
+  check_segment_transform (&segment);
+
+  segment.offset = 20;
+  segment.rate = 2.0;
+  check_segment_transform (&segment);
+
+  segment.rate = -0.5;
+  check_segment_transform (&segment);
+
+  segment.applied_rate = -2.0;
+  check_segment_transform (&segment);
+
+  segment.rate = 1.0;
+  segment.base = 0;
+  segment.time = 500;
+  check_segment_transform (&segment);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_segment_suite (void)
 {
@@ -1000,6 +1083,7 @@ gst_segment_suite (void)
   tcase_add_test (tc_chain, segment_negative_rate);
   tcase_add_test (tc_chain, segment_negative_applied_rate);
   tcase_add_test (tc_chain, segment_stream_time_full);
+  tcase_add_test (tc_chain, segment_transform);
 
   return s;
 }
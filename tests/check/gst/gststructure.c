@@ -159,6 +159,15 @@ GST_START_TEST (test_from_string)
   fail_unless_equals_int (g_value_get_boolean (val), TRUE);
   gst_structure_free (structure);
 
+  /* core enum types are registered when they are first looked up by name */
+  s = "test-string,value=(GstTocScope)global";
+  structure = gst_structure_from_string (s, NULL);
+  fail_if (structure == NULL, "Could not get structure from string %s", s);
+  fail_unless ((val = gst_structure_get_value (structure, "value")) != NULL);
+  fail_unless (G_VALUE_HOLDS (val, GST_TYPE_TOC_SCOPE));
+  fail_unless_equals_int (g_value_get_enum (val), GST_TOC_SCOPE_GLOBAL);
+  gst_structure_free (structure);
+
   s = "0.10:decoder-video/mpeg, abc=(boolean)false";
   ASSERT_CRITICAL (structure = gst_structure_from_string (s, NULL));
   fail_unless (structure == NULL, "Could not get structure from string %s", s);
@@ -774,6 +783,159 @@ GST_START_TEST (test_flagset)
 
 GST_END_TEST;
 
+static gboolean
+check_field_order (GQuark field_id, const GValue * value, gpointer user_data)
+{
+  gint *expected = user_data;
+  gchar *name = g_strdup_printf ("field%d", *expected);
+
+  fail_unless_equals_string (g_quark_to_string (field_id), name);
+  fail_unless_equals_int (g_value_get_int (value), *expected);
+  g_free (name);
+
+  /* only the even fields are set */
+  *expected += 2;
+
+  return TRUE;
+}
+
+GST_START_TEST (test_many_fields)
+{
+  GstStructure *s, *copy;
+  gchar *name;
+  gint i, val, expected = 0;
+
+  s = gst_structure_new_empty ("test");
+
+  /* more fields than stored inline, in a 'random' order for the index */
+  for (i = 0; i < 64; i++) {
+    name = g_strdup_printf ("field%d", (i * 37) % 64);
+    gst_structure_set (s, name, G_TYPE_INT, (i * 37) % 64, NULL);
+    g_free (name);
+  }
+  fail_unless_equals_int (gst_structure_n_fields (s), 64);
+
+  for (i = 0; i < 64; i++) {
+    name = g_strdup_printf ("field%d", i);
+    fail_unless (gst_structure_get_int (s, name, &val));
+    fail_unless_equals_int (val, i);
+    g_free (name);
+  }
+  fail_if (gst_structure_has_field (s, "field64"));
+
+  /* replacing keeps the number of fields */
+  gst_structure_set (s, "field5", G_TYPE_INT, 5, NULL);
+  fail_unless_equals_int (gst_structure_n_fields (s), 64);
+
+  for (i = 1; i < 64; i += 2) {
+    name = g_strdup_printf ("field%d", i);
+    gst_structure_remove_field (s, name);
+    fail_if (gst_structure_has_field (s, name));
+    g_free (name);
+  }
+  fail_unless_equals_int (gst_structure_n_fields (s), 32);
+
+  /* the fields keep their insertion order, put them back in order */
+  copy = gst_structure_new_empty ("test");
+  for (i = 0; i < 64; i += 2) {
+    name = g_strdup_printf ("field%d", i);
+    gst_structure_set (copy, name, G_TYPE_INT, i, NULL);
+    g_free (name);
+  }
+  fail_unless (gst_structure_is_equal (s, copy));
+  gst_structure_foreach (copy, check_field_order, &expected);
+  fail_unless_equals_int (expected, 64);
+  gst_structure_free (copy);
+
+  copy = gst_structure_copy (s);
+  fail_unless (gst_structure_is_equal (s, copy));
+  fail_unless (gst_structure_get_int (copy, "field62", &val));
+  fail_unless_equals_int (val, 62);
+  gst_structure_free (copy);
+
+  gst_structure_remove_all_fields (s);
+  fail_unless_equals_int (gst_structure_n_fields (s), 0);
+  fail_if (gst_structure_has_field (s, "field0"));
+  gst_structure_set (s, "field0", G_TYPE_INT, 0, NULL);
+  fail_unless (gst_structure_get_int (s, "field0", &val));
+  gst_structure_free (s);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_binary_serialization)
+{
+  GstStructure *s, *nested, *res;
+  GstCaps *caps;
+  GValue list = G_VALUE_INIT, v = G_VALUE_INIT;
+  GBytes *bytes;
+  const guint8 *data;
+  guint8 *broken;
+  gsize size, consumed = 0, i;
+
+  nested = gst_structure_new ("nested", "int", G_TYPE_INT, -5, NULL);
+  caps = gst_caps_from_string ("video/x-raw(memory:Custom), "
+      "width=(int)[1,100]; audio/x-raw");
+
+  s = gst_structure_new ("test/binary",
+      "int", G_TYPE_INT, -123456,
+      "uint", G_TYPE_UINT, G_MAXUINT,
+      "int64", G_TYPE_INT64, G_MININT64,
+      "uint64", G_TYPE_UINT64, G_MAXUINT64,
+      "boolean", G_TYPE_BOOLEAN, TRUE,
+      "float", G_TYPE_FLOAT, 1.5f,
+      "double", G_TYPE_DOUBLE, -0.25,
+      "string", G_TYPE_STRING, "some string",
+      "null-string", G_TYPE_STRING, NULL,
+      "int-range", GST_TYPE_INT_RANGE, 2, 20,
+      "int64-range", GST_TYPE_INT64_RANGE, G_MININT64, G_MAXINT64,
+      "double-range", GST_TYPE_DOUBLE_RANGE, 0.5, 2.0,
+      "fraction", GST_TYPE_FRACTION, 30000, 1001,
+      "fraction-range", GST_TYPE_FRACTION_RANGE, 0, 1, 60, 1,
+      "bitmask", GST_TYPE_BITMASK, G_GUINT64_CONSTANT (0xf0f0f0f0f0f0),
+      "format", GST_TYPE_FORMAT, GST_FORMAT_TIME,
+      "structure", GST_TYPE_STRUCTURE, nested,
+      "caps", GST_TYPE_CAPS, caps, NULL);
+  gst_structure_free (nested);
+  gst_caps_unref (caps);
+
+  g_value_init (&list, GST_TYPE_LIST);
+  g_value_init (&v, G_TYPE_STRING);
+  g_value_set_string (&v, "I420");
+  gst_value_list_append_value (&list, &v);
+  g_value_set_string (&v, "YV12");
+  gst_value_list_append_value (&list, &v);
+  g_value_unset (&v);
+  gst_structure_take_value (s, "list", &list);
+
+  bytes = gst_structure_serialize_binary (s);
+  fail_unless (bytes != NULL);
+  data = g_bytes_get_data (bytes, &size);
+
+  res = gst_structure_deserialize_binary (data, size, &consumed);
+  fail_unless (res != NULL);
+  fail_unless_equals_uint64 (consumed, size);
+  fail_unless (gst_structure_is_equal (s, res));
+  fail_unless (gst_structure_get_value (res, "null-string") != NULL);
+  fail_unless (gst_structure_get_string (res, "null-string") == NULL);
+  gst_structure_free (res);
+
+  /* truncated data is rejected */
+  for (i = 0; i < size; i++)
+    fail_unless (gst_structure_deserialize_binary (data, i, NULL) == NULL);
+
+  /* so is an unknown version */
+  broken = g_memdup (data, size);
+  broken[0] = 0xff;
+  fail_unless (gst_structure_deserialize_binary (broken, size, NULL) == NULL);
+  g_free (broken);
+
+  g_bytes_unref (bytes);
+  gst_structure_free (s);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_structure_suite (void)
 {
@@ -800,6 +962,8 @@ gst_structure_suite (void)
   tcase_add_test (tc_chain, test_map_in_place);
   tcase_add_test (tc_chain, test_filter_and_map_in_place);
   tcase_add_test (tc_chain, test_flagset);
+  tcase_add_test (tc_chain, test_many_fields);
+  tcase_add_test (tc_chain, test_binary_serialization);
   return s;
 }
 
@@ -338,6 +338,51 @@ GST_START_TEST (test_async_order)
 
 GST_END_TEST;
 
+GST_START_TEST (test_async_expire_together)
+{
+#define EXPIRE_COUNT 50
+  GstClock *clock;
+  GstClockID id[EXPIRE_COUNT];
+  GList *cb_list = NULL, *next;
+  GstClockTime base;
+  GstClockReturn result;
+  gint i;
+
+  clock = gst_system_clock_obtain ();
+  fail_unless (clock != NULL, "Could not create instance of GstSystemClock");
+
+  base = gst_clock_get_time (clock);
+
+  /* all entries expire at the same time, they must all be fired in the
+   * order they were scheduled, except for the unscheduled one */
+  for (i = 0; i < EXPIRE_COUNT; i++) {
+    id[i] = gst_clock_new_single_shot_id (clock, base + TIME_UNIT);
+    result = gst_clock_id_wait_async (id[i], store_callback, &cb_list, NULL);
+    fail_unless (result == GST_CLOCK_OK, "Waiting did not return OK");
+  }
+  gst_clock_id_unschedule (id[EXPIRE_COUNT / 2]);
+
+  g_usleep (2 * TIME_UNIT / 1000);
+
+  g_mutex_lock (&store_lock);
+  fail_unless_equals_int (g_list_length (cb_list), EXPIRE_COUNT - 1);
+  for (i = 0, next = cb_list; i < EXPIRE_COUNT; i++) {
+    if (i == EXPIRE_COUNT / 2)
+      continue;
+    fail_unless (next->data == id[i], "Expected notification for id %d", i);
+    next = g_list_next (next);
+  }
+  g_mutex_unlock (&store_lock);
+
+  for (i = 0; i < EXPIRE_COUNT; i++)
+    gst_clock_id_unref (id[i]);
+  g_list_free (cb_list);
+
+  gst_object_unref (clock);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_async_order_stress_test)
 {
 #define ALARM_COUNT 20
@@ -753,6 +798,152 @@ GST_START_TEST (test_resolution)
 
 GST_END_TEST;
 
+GST_START_TEST (test_tsc_clock)
+{
+  GstClock *clock;
+  GstClockTime prev, now, start, start_mono, elapsed, elapsed_mono;
+  gint i;
+
+  /* falls back to the monotonic clock if there is no usable counter */
+  clock = g_object_new (GST_TYPE_SYSTEM_CLOCK, "name", "tsc", "clock-type",
+      GST_CLOCK_TYPE_TSC, NULL);
+  fail_unless (gst_clock_get_resolution (clock) != GST_CLOCK_TIME_NONE);
+
+  prev = gst_clock_get_time (clock);
+  for (i = 0; i < 10000; i++) {
+    now = gst_clock_get_time (clock);
+    fail_unless (GST_CLOCK_TIME_IS_VALID (now));
+    fail_unless (now >= prev);
+    prev = now;
+  }
+
+  /* must run at the same rate as the monotonic clock */
+  start = gst_clock_get_time (clock);
+  start_mono = gst_util_get_timestamp ();
+  g_usleep (50000);
+  elapsed = gst_clock_get_time (clock) - start;
+  elapsed_mono = gst_util_get_timestamp () - start_mono;
+  fail_unless (ABS (GST_CLOCK_DIFF (elapsed, elapsed_mono)) < GST_MSECOND,
+      "elapsed %" GST_TIME_FORMAT " != %" GST_TIME_FORMAT,
+      GST_TIME_ARGS (elapsed), GST_TIME_ARGS (elapsed_mono));
+
+  gst_object_unref (clock);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_precise_wait)
+{
+  GstClock *clock;
+  GstClockID id;
+  GstClockTime base, wakeup_error = GST_CLOCK_TIME_NONE;
+  GstClockReturn ret;
+  gint i;
+
+  clock = g_object_new (GST_TYPE_SYSTEM_CLOCK, "name", "precise", NULL);
+  g_object_set (clock, "precise-wait", 2 * GST_MSECOND, "spin-wait",
+      50 * GST_USECOND, NULL);
+
+  for (i = 0; i < 10; i++) {
+    base = gst_clock_get_time (clock);
+    id = gst_clock_new_single_shot_id (clock, base + 5 * GST_MSECOND);
+    ret = gst_clock_id_wait (id, NULL);
+    fail_unless (ret == GST_CLOCK_OK, "wait returned %d", ret);
+    /* never wake up early */
+    fail_unless (gst_clock_get_time (clock) >= base + 5 * GST_MSECOND);
+    gst_clock_id_unref (id);
+  }
+
+  g_object_get (clock, "wakeup-error", &wakeup_error, NULL);
+  fail_unless (wakeup_error != GST_CLOCK_TIME_NONE);
+  GST_DEBUG ("average wakeup error %" GST_TIME_FORMAT,
+      GST_TIME_ARGS (wakeup_error));
+
+  gst_object_unref (clock);
+}
+
+GST_END_TEST;
+
+typedef struct
+{
+  GstClockTime fired;
+  gint running;
+  gint count;
+  gboolean overlapped;
+} CallbackPoolData;
+
+static gboolean
+slow_callback (GstClock * clock, GstClockTime time, GstClockID id,
+    gpointer user_data)
+{
+  CallbackPoolData *data = user_data;
+
+  if (!g_atomic_int_compare_and_exchange (&data->running, 0, 1))
+    data->overlapped = TRUE;
+  g_usleep (TIME_UNIT / (5 * 1000));
+  g_atomic_int_inc (&data->count);
+  g_atomic_int_set (&data->running, 0);
+
+  return FALSE;
+}
+
+static gboolean
+fired_callback (GstClock * clock, GstClockTime time, GstClockID id,
+    gpointer user_data)
+{
+  CallbackPoolData *data = user_data;
+
+  data->fired = gst_clock_get_time (clock);
+
+  return FALSE;
+}
+
+GST_START_TEST (test_callback_pool)
+{
+  CallbackPoolData slow = { 0, }, fast = { 0, };
+  GstTaskPool *pool;
+  GstClock *clock;
+  GstClockID slow_id, fast_id;
+  GstClockTime base;
+
+  pool = gst_task_pool_new ();
+  gst_task_pool_prepare (pool, NULL);
+  clock = g_object_new (GST_TYPE_SYSTEM_CLOCK, "name", "pooled",
+      "callback-pool", pool, NULL);
+
+  base = gst_clock_get_time (clock);
+
+  /* the slow periodic callback takes longer than its interval */
+  slow_id = gst_clock_new_periodic_id (clock, base + TIME_UNIT / 10,
+      TIME_UNIT / 10);
+  fail_unless (gst_clock_id_wait_async (slow_id, slow_callback, &slow,
+          NULL) == GST_CLOCK_OK);
+  fast_id = gst_clock_new_single_shot_id (clock, base + TIME_UNIT / 2);
+  fail_unless (gst_clock_id_wait_async (fast_id, fired_callback, &fast,
+          NULL) == GST_CLOCK_OK);
+
+  g_usleep (2 * TIME_UNIT / 1000);
+  gst_clock_id_unschedule (slow_id);
+  g_usleep (TIME_UNIT / 1000);
+
+  /* the fast entry was not held up by the slow callbacks */
+  fail_unless (fast.fired >= base + TIME_UNIT / 2);
+  fail_unless (fast.fired < base + TIME_UNIT / 2 + TIME_UNIT / 10);
+
+  /* and the slow callbacks ran one after another */
+  fail_unless (g_atomic_int_get (&slow.count) > 1);
+  fail_if (slow.overlapped);
+
+  gst_clock_id_unref (slow_id);
+  gst_clock_id_unref (fast_id);
+  gst_object_unref (clock);
+
+  gst_task_pool_cleanup (pool);
+  gst_object_unref (pool);
+}
+
+GST_END_TEST;
+
 typedef struct
 {
   GThread *thread_wait;
@@ -912,6 +1103,7 @@ gst_systemclock_suite (void)
   tcase_add_test (tc_chain, test_periodic_shot);
   tcase_add_test (tc_chain, test_periodic_multi);
   tcase_add_test (tc_chain, test_async_order);
+  tcase_add_test (tc_chain, test_async_expire_together);
   tcase_add_test (tc_chain, test_async_order_stress_test);
   tcase_add_test (tc_chain, test_async_sync_interaction);
   tcase_add_test (tc_chain, test_diff);
@@ -919,6 +1111,9 @@ gst_systemclock_suite (void)
   tcase_add_test (tc_chain, test_async_full);
   tcase_add_test (tc_chain, test_set_default);
   tcase_add_test (tc_chain, test_resolution);
+  tcase_add_test (tc_chain, test_precise_wait);
+  tcase_add_test (tc_chain, test_callback_pool);
+  tcase_add_test (tc_chain, test_tsc_clock);
   tcase_add_test (tc_chain, test_stress_cleanup_unschedule);
   tcase_add_test (tc_chain, test_stress_reschedule);
 
@@ -254,6 +254,19 @@ GST_START_TEST (test_merge)
   NEW_LISTS_EMPTY2 (GST_TAG_MERGE_KEEP_ALL);
   check_tags (merge, FTAG, FIXED1, NULL);
 
+  /* the merged list keeps the scope of the first list */
+  GST_DEBUG ("scope");
+  NEW_LISTS_FIXED (GST_TAG_MERGE_REPLACE_ALL);
+  gst_tag_list_set_scope (list, GST_TAG_SCOPE_GLOBAL);
+  gst_tag_list_unref (merge);
+  merge = gst_tag_list_merge (list, list2, GST_TAG_MERGE_REPLACE_ALL);
+  check_tags (merge, FTAG, FIXED3, NULL);
+  fail_unless_equals_int (gst_tag_list_get_scope (merge), GST_TAG_SCOPE_GLOBAL);
+  gst_tag_list_unref (merge);
+  merge = gst_tag_list_merge (NULL, list2, GST_TAG_MERGE_REPLACE);
+  check_tags (merge, FTAG, FIXED3, NULL);
+  fail_unless_equals_int (gst_tag_list_get_scope (merge), GST_TAG_SCOPE_STREAM);
+
   /* clean up */
   if (list)
     gst_tag_list_unref (list);
@@ -626,6 +639,93 @@ GST_START_TEST (test_empty_taglist_serialization)
 
 GST_END_TEST;
 
+GST_START_TEST (test_binary_serialization)
+{
+  GstTagList *tags, *tags2;
+  GstDateTime *dt;
+  GBytes *bytes;
+  const guint8 *data;
+  gsize size, consumed = 0;
+
+  dt = gst_date_time_new_ymd (2016, 5, 20);
+  tags = gst_tag_list_new (GST_TAG_TITLE, "title", GST_TAG_ARTIST, "artist 1",
+      GST_TAG_TRACK_NUMBER, 3, GST_TAG_DURATION, 5 * GST_SECOND,
+      GST_TAG_DATE_TIME, dt, NULL);
+  gst_tag_list_add (tags, GST_TAG_MERGE_APPEND, GST_TAG_ARTIST, "artist 2",
+      NULL);
+  gst_tag_list_set_scope (tags, GST_TAG_SCOPE_GLOBAL);
+  gst_date_time_unref (dt);
+
+  bytes = gst_tag_list_serialize_binary (tags);
+  fail_unless (bytes != NULL);
+  data = g_bytes_get_data (bytes, &size);
+
+  tags2 = gst_tag_list_deserialize_binary (data, size, &consumed);
+  fail_unless (tags2 != NULL);
+  fail_unless_equals_uint64 (consumed, size);
+  fail_unless (gst_tag_list_is_equal (tags, tags2));
+  fail_unless_equals_int (gst_tag_list_get_scope (tags2),
+      GST_TAG_SCOPE_GLOBAL);
+  gst_tag_list_unref (tags2);
+
+  fail_unless (gst_tag_list_deserialize_binary (data, size - 1, NULL) == NULL);
+
+  g_bytes_unref (bytes);
+  gst_tag_list_unref (tags);
+}
+
+GST_END_TEST;
+
+#define N_REGISTER_TAGS 600
+
+static volatile gint register_done;
+
+static gpointer
+lookup_tags_thread (gpointer data)
+{
+  /* lookups keep working while the table grows */
+  while (!g_atomic_int_get (&register_done)) {
+    fail_unless (gst_tag_exists (GST_TAG_TITLE));
+    fail_unless_equals_int (gst_tag_get_type (GST_TAG_TRACK_NUMBER),
+        G_TYPE_UINT);
+    fail_if (gst_tag_exists ("test-tag-does-not-exist"));
+  }
+  return NULL;
+}
+
+GST_START_TEST (test_register_many)
+{
+  GThread *thread;
+  gchar name[32];
+  gint i;
+
+  thread = g_thread_new ("lookup", lookup_tags_thread, NULL);
+
+  for (i = 0; i < N_REGISTER_TAGS; i++) {
+    g_snprintf (name, sizeof (name), "test-tag-%d", i);
+    gst_tag_register (name, GST_TAG_FLAG_META, (i % 2) ? G_TYPE_INT :
+        G_TYPE_STRING, "test tag", "a test tag", NULL);
+  }
+  g_atomic_int_set (&register_done, 1);
+  g_thread_join (thread);
+
+  for (i = 0; i < N_REGISTER_TAGS; i++) {
+    g_snprintf (name, sizeof (name), "test-tag-%d", i);
+    fail_unless (gst_tag_exists (name));
+    fail_unless_equals_int (gst_tag_get_type (name), (i % 2) ? G_TYPE_INT :
+        G_TYPE_STRING);
+    fail_unless_equals_string (gst_tag_get_nick (name), "test tag");
+  }
+
+  /* registering again keeps the first registration */
+  gst_tag_register ("test-tag-0", GST_TAG_FLAG_META, G_TYPE_STRING,
+      "other nick", "other blurb", NULL);
+  fail_unless_equals_string (gst_tag_get_nick ("test-tag-0"), "test tag");
+  fail_unless (gst_tag_exists (GST_TAG_ARTIST));
+}
+
+GST_END_TEST;
+
 
 static Suite *
 gst_tag_suite (void)
@@ -648,6 +748,8 @@ gst_tag_suite (void)
   tcase_add_test (tc_chain, test_writability);
   tcase_add_test (tc_chain, test_serialization);
   tcase_add_test (tc_chain, test_empty_taglist_serialization);
+  tcase_add_test (tc_chain, test_binary_serialization);
+  tcase_add_test (tc_chain, test_register_many);
 
   return s;
 }
@@ -249,6 +249,170 @@ GST_START_TEST (test_create)
 GST_END_TEST;
 
 
+GST_START_TEST (test_cpu_affinity)
+{
+  GstTask *t;
+  gchar *cpus;
+
+  t = gst_task_new (task_func2, &t, NULL);
+  fail_if (t == NULL);
+
+  fail_unless (gst_task_get_cpu_affinity (t) == NULL);
+  fail_unless_equals_int (gst_task_get_numa_node (t), -1);
+
+  fail_unless (gst_task_set_cpu_affinity (t, "0-3,8,10-11"));
+  cpus = gst_task_get_cpu_affinity (t);
+  fail_unless_equals_string (cpus, "0-3,8,10-11");
+  g_free (cpus);
+
+  /* invalid lists are refused and keep the previous affinity */
+  fail_if (gst_task_set_cpu_affinity (t, ""));
+  fail_if (gst_task_set_cpu_affinity (t, "3-1"));
+  fail_if (gst_task_set_cpu_affinity (t, "0,"));
+  fail_if (gst_task_set_cpu_affinity (t, "a"));
+  cpus = gst_task_get_cpu_affinity (t);
+  fail_unless_equals_string (cpus, "0-3,8,10-11");
+  g_free (cpus);
+
+  fail_unless (gst_task_set_cpu_affinity (t, NULL));
+  fail_unless (gst_task_get_cpu_affinity (t) == NULL);
+
+  /* node 0 exists on all Linux systems with sysfs */
+  if (gst_task_set_numa_node (t, 0)) {
+    fail_unless_equals_int (gst_task_get_numa_node (t), 0);
+    cpus = gst_task_get_cpu_affinity (t);
+    fail_unless (cpus != NULL);
+    g_free (cpus);
+
+    fail_unless (gst_task_set_numa_node (t, -1));
+    fail_unless_equals_int (gst_task_get_numa_node (t), -1);
+    fail_unless (gst_task_get_cpu_affinity (t) == NULL);
+  }
+
+  gst_object_unref (t);
+}
+
+GST_END_TEST;
+
+#define WS_N_JOBS 1000
+
+static GstTaskPool *ws_pool;
+static gint ws_done;
+
+static void
+ws_count_func (void *data)
+{
+  g_mutex_lock (&task_lock);
+  if (++ws_done == 2 * WS_N_JOBS)
+    g_cond_signal (&task_cond);
+  g_mutex_unlock (&task_lock);
+}
+
+static void
+ws_job_func (void *data)
+{
+  /* pushed from a worker, runs on the same worker unless stolen */
+  gst_task_pool_push (ws_pool, ws_count_func, NULL, NULL);
+  ws_count_func (NULL);
+}
+
+static void
+ws_task_func (void *data)
+{
+  GstTask *t = *(GstTask **) data;
+
+  g_mutex_lock (&task_lock);
+  if (++ws_done == 10) {
+    gst_task_stop (t);
+    g_cond_signal (&task_cond);
+  }
+  g_mutex_unlock (&task_lock);
+}
+
+GST_START_TEST (test_work_stealing_pool)
+{
+  GstTask *t;
+  gint i;
+
+  ws_pool = gst_work_stealing_task_pool_new (4);
+  fail_unless (GST_IS_WORK_STEALING_TASK_POOL (ws_pool));
+  fail_unless_equals_int (gst_work_stealing_task_pool_get_n_threads
+      (GST_WORK_STEALING_TASK_POOL (ws_pool)), 4);
+  gst_task_pool_prepare (ws_pool, NULL);
+
+  ws_done = 0;
+  g_mutex_lock (&task_lock);
+  for (i = 0; i < WS_N_JOBS; i++)
+    gst_task_pool_push (ws_pool, ws_job_func, NULL, NULL);
+  while (ws_done < 2 * WS_N_JOBS)
+    g_cond_wait (&task_cond, &task_lock);
+  g_mutex_unlock (&task_lock);
+
+  /* a scheduleable task runs one iteration per push */
+  t = gst_task_new (ws_task_func, &t, NULL);
+  g_rec_mutex_init (&task_mutex);
+  gst_task_set_lock (t, &task_mutex);
+  gst_task_set_pool (t, ws_pool);
+  fail_unless (gst_task_set_scheduleable (t, TRUE));
+
+  ws_done = 0;
+  g_mutex_lock (&task_lock);
+  fail_unless (gst_task_start (t));
+  while (ws_done < 10)
+    g_cond_wait (&task_cond, &task_lock);
+  g_mutex_unlock (&task_lock);
+
+  fail_unless (gst_task_join (t));
+  fail_unless_equals_int (ws_done, 10);
+  gst_object_unref (t);
+  g_rec_mutex_clear (&task_mutex);
+
+  gst_task_pool_cleanup (ws_pool);
+  gst_object_unref (ws_pool);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_scheduling)
+{
+  GstTaskSchedulingPolicy policy;
+  GstTask *t;
+  gint priority;
+
+  t = gst_task_new (task_signal_pause_func, &t, NULL);
+  fail_if (t == NULL);
+
+  gst_task_get_scheduling (t, &policy, &priority);
+  fail_unless_equals_int (policy, GST_TASK_SCHEDULING_DEFAULT);
+  fail_unless_equals_int (priority, 0);
+
+  gst_task_set_scheduling (t, GST_TASK_SCHEDULING_FIFO, 50);
+  gst_task_get_scheduling (t, &policy, &priority);
+  fail_unless_equals_int (policy, GST_TASK_SCHEDULING_FIFO);
+  fail_unless_equals_int (priority, 50);
+
+  g_rec_mutex_init (&task_mutex);
+  gst_task_set_lock (t, &task_mutex);
+  g_cond_init (&task_cond);
+  g_mutex_init (&task_lock);
+
+  /* the task runs also when realtime scheduling is not allowed */
+  g_mutex_lock (&task_lock);
+  fail_unless (gst_task_start (t));
+  g_cond_wait (&task_cond, &task_lock);
+  g_mutex_unlock (&task_lock);
+
+  fail_unless (gst_task_stop (t));
+  fail_unless (gst_task_join (t));
+
+  g_cond_clear (&task_cond);
+  g_mutex_clear (&task_lock);
+
+  gst_object_unref (t);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_task_suite (void)
 {
@@ -262,6 +426,9 @@ gst_task_suite (void)
   tcase_add_test (tc_chain, test_lock_start);
   tcase_add_test (tc_chain, test_join);
   tcase_add_test (tc_chain, test_pause_stop_race);
+  tcase_add_test (tc_chain, test_cpu_affinity);
+  tcase_add_test (tc_chain, test_scheduling);
+  tcase_add_test (tc_chain, test_work_stealing_pool);
 
   return s;
 }
@@ -164,6 +164,76 @@ GST_START_TEST (test_element_make_from_uri)
 
 GST_END_TEST;
 
+typedef GstElement TestUriSrc;
+typedef GstElementClass TestUriSrcClass;
+
+static GstURIType
+test_uri_src_get_type_handler (GType type)
+{
+  return GST_URI_SRC;
+}
+
+static const gchar *const *
+test_uri_src_get_protocols (GType type)
+{
+  static const gchar *protocols[] = { "indextest", NULL };
+
+  return protocols;
+}
+
+static gboolean
+test_uri_src_set_uri (GstURIHandler * handler, const gchar * uri,
+    GError ** error)
+{
+  return TRUE;
+}
+
+static void
+test_uri_src_uri_handler_init (gpointer g_iface, gpointer iface_data)
+{
+  GstURIHandlerInterface *iface = (GstURIHandlerInterface *) g_iface;
+
+  iface->get_type = test_uri_src_get_type_handler;
+  iface->get_protocols = test_uri_src_get_protocols;
+  iface->set_uri = test_uri_src_set_uri;
+}
+
+static void
+test_uri_src_class_init (TestUriSrcClass * klass)
+{
+}
+
+static void
+test_uri_src_init (TestUriSrc * src)
+{
+}
+
+G_DEFINE_TYPE_WITH_CODE (TestUriSrc, test_uri_src, GST_TYPE_ELEMENT,
+    G_IMPLEMENT_INTERFACE (GST_TYPE_URI_HANDLER,
+        test_uri_src_uri_handler_init));
+
+GST_START_TEST (test_uri_handler_registered_later)
+{
+  GstElement *element;
+
+  fail_if (gst_uri_protocol_is_supported (GST_URI_SRC, "indextest"));
+
+  /* registering a new handler must be picked up by the lookups */
+  fail_unless (gst_element_register (NULL, "testurisrc", GST_RANK_NONE,
+          test_uri_src_get_type ()));
+  fail_unless (gst_uri_protocol_is_supported (GST_URI_SRC, "indextest"));
+  fail_unless (gst_uri_protocol_is_supported (GST_URI_SRC, "IndexTest"));
+  fail_if (gst_uri_protocol_is_supported (GST_URI_SINK, "indextest"));
+
+  element = gst_element_make_from_uri (GST_URI_SRC, "indextest://foo", NULL,
+      NULL);
+  fail_unless (element != NULL);
+  fail_unless (G_TYPE_CHECK_INSTANCE_TYPE (element, test_uri_src_get_type ()));
+  gst_object_unref (element);
+}
+
+GST_END_TEST;
+
 /* Taken from the GNet unit test and extended with other URIs:
  * https://git.gnome.org/browse/archive/gnet/plain/tests/check/gnet/gneturi.c
  */
@@ -993,6 +1063,7 @@ gst_uri_suite (void)
   tcase_add_test (tc_chain, test_uri_get_location);
   tcase_add_test (tc_chain, test_uri_misc);
   tcase_add_test (tc_chain, test_element_make_from_uri);
+  tcase_add_test (tc_chain, test_uri_handler_registered_later);
 #ifdef G_OS_WIN32
   tcase_add_test (tc_chain, test_win32_uri);
 #endif
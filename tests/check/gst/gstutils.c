@@ -349,6 +349,54 @@ GST_START_TEST (test_math_scale_random)
 
 GST_END_TEST;
 
+GST_START_TEST (test_math_scaler)
+{
+  const guint64 ratios[][2] = {
+    {1, 1}, {0, 7}, {1, 3}, {90000, GST_SECOND}, {GST_SECOND, 48000},
+    {GST_SECOND, 44100}, {1001, 30000}, {G_MAXUINT64, 3},
+    {3, G_MAXUINT64}, {G_MAXUINT64 - 1, G_MAXUINT64}, {1, 1024}
+  };
+  GstUtilScaler scaler;
+  guint64 vals[64], check[64];
+  GRand *rand;
+  guint i, j;
+
+  rand = g_rand_new_with_seed (0);
+
+  for (i = 0; i < G_N_ELEMENTS (ratios); i++) {
+    guint64 num = ratios[i][0], denom = ratios[i][1];
+
+    gst_util_scaler_init (&scaler, num, denom);
+
+    for (j = 0; j < 10000; j++) {
+      guint64 val = ((guint64) g_rand_int (rand)) << 32 | g_rand_int (rand);
+
+      /* mostly small values, like timestamps and sample counts */
+      if (j & 1)
+        val >>= g_rand_int_range (rand, 0, 64);
+
+      fail_unless_equals_uint64 (gst_util_scaler_scale (&scaler, val),
+          gst_util_uint64_scale (val, num, denom));
+      fail_unless_equals_uint64 (gst_util_scaler_scale_round (&scaler, val),
+          gst_util_uint64_scale_round (val, num, denom));
+      fail_unless_equals_uint64 (gst_util_scaler_scale_ceil (&scaler, val),
+          gst_util_uint64_scale_ceil (val, num, denom));
+    }
+
+    for (j = 0; j < G_N_ELEMENTS (vals); j++) {
+      vals[j] = j * GST_MSECOND;
+      check[j] = gst_util_uint64_scale_round (vals[j], num, denom);
+    }
+    gst_util_scaler_scale_array_round (&scaler, vals, G_N_ELEMENTS (vals));
+    for (j = 0; j < G_N_ELEMENTS (vals); j++)
+      fail_unless_equals_uint64 (vals[j], check[j]);
+  }
+
+  g_rand_free (rand);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_guint64_to_gdouble)
 {
   guint64 from[] = { 0, 1, 100, 10000, (guint64) (1) << 63,
@@ -1715,6 +1763,7 @@ gst_utils_suite (void)
   tcase_add_test (tc_chain, test_math_scale_ceil);
   tcase_add_test (tc_chain, test_math_scale_uint64);
   tcase_add_test (tc_chain, test_math_scale_random);
+  tcase_add_test (tc_chain, test_math_scaler);
 #ifdef HAVE_GSL
 #ifdef HAVE_GMP
   tcase_add_test (tc_chain, test_math_scale_gmp);
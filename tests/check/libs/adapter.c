@@ -761,6 +761,105 @@ GST_START_TEST (test_scan)
 
 GST_END_TEST;
 
+GST_START_TEST (test_copy_many_buffers)
+{
+  GstAdapter *adapter;
+  GstBuffer *buffer;
+  guint8 data[16];
+  guint i, j;
+
+  adapter = gst_adapter_new ();
+
+  /* lots of small buffers, some of them empty */
+  for (i = 0; i < 1000; i++) {
+    buffer = gst_buffer_new_and_alloc (i % 7 == 0 ? 0 : 3);
+    if (i % 7 != 0) {
+      guint8 bytes[3];
+
+      for (j = 0; j < 3; j++)
+        bytes[j] = (i * 3 + j) & 0xff;
+      gst_buffer_fill (buffer, 0, bytes, 3);
+    }
+    GST_BUFFER_PTS (buffer) = i * GST_SECOND;
+    gst_adapter_push (adapter, buffer);
+  }
+  fail_unless_equals_int (gst_adapter_available (adapter), (1000 - 143) * 3);
+
+  /* flush a bit so that there is a skip in the head buffer */
+  gst_adapter_flush (adapter, 4);
+
+  for (i = 0; i + 16 <= gst_adapter_available (adapter); i += 13) {
+    gst_adapter_copy (adapter, data, i, 16);
+    for (j = 0; j < 16; j++) {
+      /* byte n of the data comes from buffer n / 3 + the number of empty
+       * buffers before it */
+      guint n = i + j + 4;
+      guint idx = n / 3 + n / 18 + 1;
+
+      fail_unless_equals_int (data[j], (idx * 3 + n % 3) & 0xff);
+    }
+  }
+
+  /* byte 27 is byte 31 of all pushed data, in buffer 12 */
+  fail_unless_equals_uint64 (gst_adapter_prev_pts_at_offset (adapter, 27,
+          NULL), 12 * GST_SECOND);
+  fail_unless_equals_int (gst_adapter_available_fast (adapter), 2);
+
+  g_object_unref (adapter);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_scan_start_code)
+{
+  GstAdapter *adapter;
+  guint8 data[300];
+  guint32 state;
+  guint i, offset;
+
+  for (i = 0; i < sizeof (data); i++)
+    data[i] = 0x20 + (i % 0xc0);
+  /* start codes in the middle of a buffer and across buffer boundaries */
+  data[40] = data[41] = 0;
+  data[42] = 1;
+  data[43] = 0x09;
+  data[98] = data[99] = 0;
+  data[100] = 1;
+  data[101] = 0x41;
+  data[199] = 0;
+  data[200] = 0;
+  data[201] = 1;
+  data[202] = 0x06;
+
+  adapter = gst_adapter_new ();
+  gst_adapter_push (adapter, gst_buffer_new_wrapped (g_memdup (data, 100),
+          100));
+  gst_adapter_push (adapter, gst_buffer_new_wrapped (g_memdup (data + 100,
+              100), 100));
+  gst_adapter_push (adapter, gst_buffer_new_wrapped (g_memdup (data + 200,
+              100), 100));
+
+  offset = gst_adapter_masked_scan_uint32_peek (adapter, 0xffffff00,
+      0x00000100, 0, 300, &state);
+  fail_unless_equals_int (offset, 40);
+  fail_unless_equals_int (state, 0x00000109);
+  offset = gst_adapter_masked_scan_uint32_peek (adapter, 0xffffff00,
+      0x00000100, 41, 259, &state);
+  fail_unless_equals_int (offset, 98);
+  fail_unless_equals_int (state, 0x00000141);
+  offset = gst_adapter_masked_scan_uint32_peek (adapter, 0xffffff00,
+      0x00000100, 99, 201, &state);
+  fail_unless_equals_int (offset, 199);
+  fail_unless_equals_int (state, 0x00000106);
+  offset = gst_adapter_masked_scan_uint32_peek (adapter, 0xffffff00,
+      0x00000100, 200, 100, &state);
+  fail_unless_equals_int (offset, -1);
+
+  gst_object_unref (adapter);
+}
+
+GST_END_TEST;
+
 /* Fill a buffer with a sequence of 32 bit ints and read them back out
  * using take_buffer, checking that they're still in the right order */
 GST_START_TEST (test_take_list)
@@ -1058,6 +1157,8 @@ gst_adapter_suite (void)
   tcase_add_test (tc_chain, test_take_buf_order);
   tcase_add_test (tc_chain, test_timestamp);
   tcase_add_test (tc_chain, test_scan);
+  tcase_add_test (tc_chain, test_scan_start_code);
+  tcase_add_test (tc_chain, test_copy_many_buffers);
   tcase_add_test (tc_chain, test_take_list);
   tcase_add_test (tc_chain, test_get_list);
   tcase_add_test (tc_chain, test_take_buffer_list);
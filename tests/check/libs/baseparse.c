@@ -301,6 +301,28 @@ GST_START_TEST (parser_playback)
 GST_END_TEST;
 
 
+GST_START_TEST (parser_playback_batched)
+{
+  GList *input = NULL;
+  gint i;
+  GstBuffer *buffer;
+
+  setup_parsertester ();
+
+  /* collect 3 frames per list, the last ones are pushed on EOS */
+  g_object_set (parsetest, "batch-latency", GST_SECOND / 10, NULL);
+
+  for (i = 0; i < 10; i++) {
+    buffer = create_test_buffer (i);
+    input = g_list_append (input, buffer);
+  }
+
+  run_parser_playback_test (input, 10, 1.0);
+}
+
+GST_END_TEST;
+
+
 /* Check https://bugzilla.gnome.org/show_bug.cgi?id=721941 */
 GST_START_TEST (parser_reverse_playback_on_passthrough)
 {
@@ -463,6 +485,7 @@ gst_baseparse_suite (void)
 
   suite_add_tcase (s, tc);
   tcase_add_test (tc, parser_playback);
+  tcase_add_test (tc, parser_playback_batched);
   tcase_add_test (tc, parser_empty_stream);
   tcase_add_test (tc, parser_reverse_playback_on_passthrough);
   tcase_add_test (tc, parser_reverse_playback);
@@ -23,6 +23,7 @@
 #endif
 #include <gst/gst.h>
 #include <gst/check/gstcheck.h>
+#include <gst/check/gsttestclock.h>
 #include <gst/base/gstbasesink.h>
 
 GST_START_TEST (basesink_last_sample_enabled)
@@ -242,6 +243,211 @@ GST_START_TEST (basesink_test_eos_after_playing)
 
 GST_END_TEST;
 
+static gpointer
+push_buffer_list (gpointer data)
+{
+  GstPad *pad = data;
+  GstBufferList *list;
+  GstSegment segment;
+  guint i;
+
+  fail_unless (gst_pad_send_event (pad, gst_event_new_stream_start ("test")));
+
+  gst_segment_init (&segment, GST_FORMAT_TIME);
+  fail_unless (gst_pad_send_event (pad, gst_event_new_segment (&segment)));
+
+  /* a burst of buffers 10ms apart */
+  list = gst_buffer_list_new ();
+  for (i = 0; i < 3; i++) {
+    GstBuffer *buf = gst_buffer_new ();
+
+    GST_BUFFER_PTS (buf) = GST_SECOND + i * 10 * GST_MSECOND;
+    GST_BUFFER_DURATION (buf) = 10 * GST_MSECOND;
+    gst_buffer_list_add (list, buf);
+  }
+
+  fail_unless_equals_int (gst_pad_chain_list (pad, list), GST_FLOW_OK);
+
+  return NULL;
+}
+
+static void
+count_handoff (GstElement * sink, GstBuffer * buf, GstPad * pad,
+    guint * count)
+{
+  *count = *count + 1;
+}
+
+GST_START_TEST (basesink_test_list_sync_tolerance)
+{
+  GstElement *pipeline, *sink;
+  GstClock *clock;
+  GstClockID id;
+  GstPad *pad;
+  GThread *thread;
+  guint count = 0;
+
+  clock = gst_test_clock_new ();
+
+  sink = gst_element_factory_make ("fakesink", "sink");
+  g_object_set (sink, "sync", TRUE, "signal-handoffs", TRUE,
+      "list-sync-tolerance", 50 * GST_MSECOND, NULL);
+  g_signal_connect (sink, "handoff", G_CALLBACK (count_handoff), &count);
+
+  pipeline = gst_pipeline_new (NULL);
+  gst_pipeline_use_clock (GST_PIPELINE (pipeline), clock);
+  gst_bin_add (GST_BIN (pipeline), sink);
+
+  pad = gst_element_get_static_pad (sink, "sink");
+
+  gst_element_set_state (pipeline, GST_STATE_PLAYING);
+
+  thread = g_thread_new ("push-thread", push_buffer_list, pad);
+
+  /* only the first buffer of the list waits for the clock */
+  gst_test_clock_wait_for_next_pending_id (GST_TEST_CLOCK (clock), &id);
+  fail_unless_equals_uint64 (gst_clock_id_get_time (id), GST_SECOND);
+  gst_clock_id_unref (id);
+  gst_test_clock_set_time (GST_TEST_CLOCK (clock), GST_SECOND);
+  id = gst_test_clock_process_next_clock_id (GST_TEST_CLOCK (clock));
+  fail_unless (id != NULL);
+  gst_clock_id_unref (id);
+
+  g_thread_join (thread);
+
+  fail_unless_equals_int (count, 3);
+  fail_unless_equals_int (gst_test_clock_peek_id_count (GST_TEST_CLOCK
+          (clock)), 0);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+
+  gst_object_unref (pad);
+  gst_object_unref (pipeline);
+  gst_object_unref (clock);
+}
+
+GST_END_TEST;
+
+static GstPadProbeReturn
+count_qos_probe (GstPad * pad, GstPadProbeInfo * info, guint * count)
+{
+  if (GST_EVENT_TYPE (GST_PAD_PROBE_INFO_EVENT (info)) == GST_EVENT_QOS)
+    *count = *count + 1;
+
+  return GST_PAD_PROBE_OK;
+}
+
+GST_START_TEST (basesink_test_qos_interval)
+{
+  GstElement *pipeline, *sink;
+  GstClock *clock;
+  GstSegment segment;
+  GstPad *pad;
+  guint i, count = 0;
+
+  clock = gst_test_clock_new ();
+
+  sink = gst_element_factory_make ("fakesink", "sink");
+  g_object_set (sink, "sync", TRUE, "async", FALSE, "qos", TRUE,
+      "qos-interval", 50 * GST_MSECOND, NULL);
+
+  pipeline = gst_pipeline_new (NULL);
+  gst_pipeline_use_clock (GST_PIPELINE (pipeline), clock);
+  gst_bin_add (GST_BIN (pipeline), sink);
+
+  pad = gst_element_get_static_pad (sink, "sink");
+  gst_pad_add_probe (pad, GST_PAD_PROBE_TYPE_EVENT_UPSTREAM,
+      (GstPadProbeCallback) count_qos_probe, &count, NULL);
+
+  fail_unless_equals_int (gst_element_set_state (pipeline, GST_STATE_PLAYING),
+      GST_STATE_CHANGE_SUCCESS);
+
+  /* all buffers arrive late */
+  gst_test_clock_set_time (GST_TEST_CLOCK (clock), 10 * GST_SECOND);
+
+  gst_pad_send_event (pad, gst_event_new_stream_start ("test"));
+  gst_segment_init (&segment, GST_FORMAT_TIME);
+  gst_pad_send_event (pad, gst_event_new_segment (&segment));
+
+  for (i = 0; i < 10; i++) {
+    GstBuffer *buffer = gst_buffer_new ();
+
+    GST_BUFFER_PTS (buffer) = i * 10 * GST_MSECOND;
+    GST_BUFFER_DURATION (buffer) = 10 * GST_MSECOND;
+    fail_unless_equals_int (gst_pad_chain (pad, buffer), GST_FLOW_OK);
+  }
+
+  /* the second buffer starts a measurement, then one every 50ms instead of
+   * one for every buffer */
+  fail_unless_equals_int (count, 2);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+
+  gst_object_unref (pad);
+  gst_object_unref (pipeline);
+  gst_object_unref (clock);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (basesink_test_reclaim_last_buffer)
+{
+  GstElement *sink;
+  GstBufferPool *pool;
+  GstStructure *config;
+  GstBufferPoolAcquireParams params = { 0, };
+  GstBuffer *buf, *buf2;
+  GstSample *sample;
+  GstSegment segment;
+  GstPad *pad;
+
+  pool = gst_buffer_pool_new ();
+  config = gst_buffer_pool_get_config (pool);
+  gst_buffer_pool_config_set_params (config, NULL, 10, 1, 1);
+  fail_unless (gst_buffer_pool_set_config (pool, config));
+  fail_unless (gst_buffer_pool_set_active (pool, TRUE));
+
+  sink = gst_element_factory_make ("fakesink", "sink");
+  g_object_set (sink, "sync", FALSE, "async", FALSE, NULL);
+  fail_unless_equals_int (gst_element_set_state (sink, GST_STATE_PLAYING),
+      GST_STATE_CHANGE_SUCCESS);
+
+  pad = gst_element_get_static_pad (sink, "sink");
+  gst_pad_send_event (pad, gst_event_new_stream_start ("test"));
+  gst_segment_init (&segment, GST_FORMAT_TIME);
+  gst_pad_send_event (pad, gst_event_new_segment (&segment));
+
+  fail_unless_equals_int (gst_buffer_pool_acquire_buffer (pool, &buf, NULL),
+      GST_FLOW_OK);
+  gst_buffer_memset (buf, 0, 'x', 10);
+  fail_unless_equals_int (gst_pad_chain (pad, buf), GST_FLOW_OK);
+
+  /* the only buffer of the pool is the last-sample of the sink, which gives
+   * it back when the pool runs out of buffers */
+  params.flags = GST_BUFFER_POOL_ACQUIRE_FLAG_DONTWAIT;
+  fail_unless_equals_int (gst_buffer_pool_acquire_buffer (pool, &buf2,
+          &params), GST_FLOW_OK);
+  fail_unless (buf2 == buf);
+
+  /* and keeps a copy */
+  g_object_get (sink, "last-sample", &sample, NULL);
+  fail_unless (sample != NULL);
+  fail_unless (gst_sample_get_buffer (sample) != buf2);
+  fail_unless_equals_int (gst_buffer_memcmp (gst_sample_get_buffer (sample),
+          0, "xxxxxxxxxx", 10), 0);
+  gst_sample_unref (sample);
+  gst_buffer_unref (buf2);
+
+  gst_element_set_state (sink, GST_STATE_NULL);
+  gst_object_unref (pad);
+  gst_object_unref (sink);
+
+  gst_buffer_pool_set_active (pool, FALSE);
+  gst_object_unref (pool);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_basesrc_suite (void)
 {
@@ -253,6 +459,9 @@ gst_basesrc_suite (void)
   tcase_add_test (tc, basesink_last_sample_disabled);
   tcase_add_test (tc, basesink_test_gap);
   tcase_add_test (tc, basesink_test_eos_after_playing);
+  tcase_add_test (tc, basesink_test_list_sync_tolerance);
+  tcase_add_test (tc, basesink_test_qos_interval);
+  tcase_add_test (tc, basesink_test_reclaim_last_buffer);
 
   return s;
 }
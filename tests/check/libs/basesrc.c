@@ -27,6 +27,7 @@
 #include <gst/check/gstcheck.h>
 #include <gst/check/gstconsistencychecker.h>
 #include <gst/base/gstbasesrc.h>
+#include <gst/base/gstpushsrc.h>
 
 static GstPadProbeReturn
 eos_event_counter (GstObject * pad, GstPadProbeInfo * info, guint * p_num_eos)
@@ -768,6 +769,166 @@ GST_START_TEST (basesrc_seek_on_last_buffer)
 
 GST_END_TEST;
 
+/* basesrc_pull_readahead:
+ *   make sure sequential pulls with readahead enabled return the same data,
+ *   in the same order, as reading the ranges directly
+ */
+GST_START_TEST (basesrc_pull_readahead)
+{
+  GstElement *src;
+  GstPad *pad;
+  guint64 offset;
+  guint i, n;
+
+  src = gst_element_factory_make ("fakesrc", "src");
+  g_assert (src != NULL);
+
+  g_object_set (src, "can-activate-pull", TRUE, "sizetype", 2, "sizemax", 16,
+      "readahead", 4, NULL);
+  gst_util_set_object_arg (G_OBJECT (src), "filltype", "pattern-span");
+  fail_unless_equals_int (gst_base_src_get_readahead (GST_BASE_SRC (src)), 4);
+
+  pad = gst_element_get_static_pad (src, "src");
+  fail_unless (gst_pad_activate_mode (pad, GST_PAD_MODE_PULL, TRUE));
+
+  for (n = 0, offset = 0; n < 32; n++, offset += 16) {
+    GstBuffer *buf = NULL;
+    GstMapInfo map;
+
+    fail_unless (gst_pad_get_range (pad, offset, 16, &buf) == GST_FLOW_OK);
+    fail_unless_equals_uint64 (GST_BUFFER_OFFSET (buf), offset);
+
+    fail_unless (gst_buffer_map (buf, &map, GST_MAP_READ));
+    fail_unless_equals_int (map.size, 16);
+    for (i = 0; i < map.size; i++)
+      fail_unless_equals_int (map.data[i], (offset + i) & 0xff);
+    gst_buffer_unmap (buf, &map);
+    gst_buffer_unref (buf);
+  }
+
+  /* random access still works */
+  {
+    GstBuffer *buf = NULL;
+
+    fail_unless (gst_pad_get_range (pad, 8, 16, &buf) == GST_FLOW_OK);
+    fail_unless_equals_uint64 (GST_BUFFER_OFFSET (buf), 8);
+    gst_buffer_unref (buf);
+  }
+
+  fail_unless (gst_pad_activate_mode (pad, GST_PAD_MODE_PULL, FALSE));
+  gst_object_unref (pad);
+  gst_object_unref (src);
+}
+
+GST_END_TEST;
+
+typedef GstPushSrc TestListSrc;
+typedef GstPushSrcClass TestListSrcClass;
+
+static GType test_list_src_get_type (void);
+G_DEFINE_TYPE (TestListSrc, test_list_src, GST_TYPE_PUSH_SRC);
+
+static GstStaticPadTemplate test_list_src_template =
+GST_STATIC_PAD_TEMPLATE ("src", GST_PAD_SRC, GST_PAD_ALWAYS, GST_STATIC_CAPS_ANY);
+
+#define TEST_LIST_LENGTH 4
+
+static guint test_list_src_n_buffers;
+
+static GstFlowReturn
+test_list_src_create_list (GstPushSrc * src, GstBufferList ** list)
+{
+  guint i;
+
+  *list = gst_buffer_list_new ();
+  for (i = 0; i < TEST_LIST_LENGTH; i++) {
+    GstBuffer *buf = gst_buffer_new ();
+
+    GST_BUFFER_PTS (buf) = test_list_src_n_buffers * 10 * GST_MSECOND;
+    GST_BUFFER_DURATION (buf) = 10 * GST_MSECOND;
+    test_list_src_n_buffers++;
+    gst_buffer_list_add (*list, buf);
+  }
+
+  return GST_FLOW_OK;
+}
+
+static void
+test_list_src_class_init (TestListSrcClass * klass)
+{
+  gst_element_class_add_static_pad_template (GST_ELEMENT_CLASS (klass),
+      &test_list_src_template);
+  klass->create_list = test_list_src_create_list;
+}
+
+static void
+test_list_src_init (TestListSrc * src)
+{
+  gst_base_src_set_format (GST_BASE_SRC (src), GST_FORMAT_TIME);
+}
+
+static GstPadProbeReturn
+buffer_list_counter (GstPad * pad, GstPadProbeInfo * info, guint * counts)
+{
+  GstBufferList *list = GST_PAD_PROBE_INFO_BUFFER_LIST (info);
+
+  counts[0]++;
+  counts[1] += gst_buffer_list_length (list);
+
+  return GST_PAD_PROBE_OK;
+}
+
+/* basesrc_push_create_list:
+ *  - buffer lists from create_list are pushed downstream as a whole
+ *  - buffers of the list after the segment stop are dropped
+ */
+GST_START_TEST (basesrc_push_create_list)
+{
+  GstElement *src, *sink, *pipe;
+  GstPad *srcpad;
+  GstBus *bus;
+  GstMessage *msg;
+  guint counts[2] = { 0, 0 };
+
+  pipe = gst_pipeline_new ("pipeline");
+  src = g_object_new (test_list_src_get_type (), NULL);
+  sink = gst_element_factory_make ("fakesink", "sink");
+  test_list_src_n_buffers = 0;
+
+  fail_unless (gst_bin_add (GST_BIN (pipe), src));
+  fail_unless (gst_bin_add (GST_BIN (pipe), sink));
+  fail_unless (gst_element_link (src, sink));
+  g_object_set (sink, "sync", FALSE, NULL);
+
+  srcpad = gst_element_get_static_pad (src, "src");
+  gst_pad_add_probe (srcpad, GST_PAD_PROBE_TYPE_BUFFER_LIST,
+      (GstPadProbeCallback) buffer_list_counter, counts, NULL);
+  gst_object_unref (srcpad);
+
+  /* stop in the middle of the second list */
+  gst_element_set_state (pipe, GST_STATE_READY);
+  fail_unless (gst_element_send_event (src,
+          gst_event_new_seek (1.0, GST_FORMAT_TIME, GST_SEEK_FLAG_NONE,
+              GST_SEEK_TYPE_SET, 0, GST_SEEK_TYPE_SET, 55 * GST_MSECOND)));
+
+  bus = gst_element_get_bus (pipe);
+  gst_element_set_state (pipe, GST_STATE_PLAYING);
+
+  msg = gst_bus_poll (bus, GST_MESSAGE_EOS | GST_MESSAGE_ERROR, -1);
+  fail_unless_equals_int (GST_MESSAGE_TYPE (msg), GST_MESSAGE_EOS);
+  gst_message_unref (msg);
+
+  /* 0-30ms and 40-50ms */
+  fail_unless_equals_int (counts[0], 2);
+  fail_unless_equals_int (counts[1], 6);
+
+  gst_element_set_state (pipe, GST_STATE_NULL);
+  gst_object_unref (bus);
+  gst_object_unref (pipe);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_basesrc_suite (void)
 {
@@ -783,6 +944,8 @@ gst_basesrc_suite (void)
   tcase_add_test (tc, basesrc_eos_events_pull_live_eos);
   tcase_add_test (tc, basesrc_seek_events_rate_update);
   tcase_add_test (tc, basesrc_seek_on_last_buffer);
+  tcase_add_test (tc, basesrc_pull_readahead);
+  tcase_add_test (tc, basesrc_push_create_list);
 
   return s;
 }
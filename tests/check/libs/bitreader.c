@@ -235,6 +235,105 @@ GST_START_TEST (test_position_tracking)
 
 GST_END_TEST;
 
+static void
+put_bits (guint8 * data, guint * pos, guint64 val, guint nbits)
+{
+  while (nbits > 0) {
+    nbits--;
+    if ((val >> nbits) & 1)
+      data[*pos / 8] |= 0x80 >> (*pos % 8);
+    *pos += 1;
+  }
+}
+
+static void
+put_ue (guint8 * data, guint * pos, guint32 val)
+{
+  guint64 v = (guint64) val + 1;
+  guint len = 0;
+
+  while ((v >> len) > 1)
+    len++;
+  put_bits (data, pos, 0, len);
+  put_bits (data, pos, v, len + 1);
+}
+
+GST_START_TEST (test_exp_golomb)
+{
+  static const guint32 ue_values[] = { 0, 1, 2, 3, 6, 7, 255, 1000, 65534,
+    G_MAXUINT16 * 4, 0x7fffffff, G_MAXUINT32 - 1
+  };
+  static const gint32 se_values[] = { 0, 1, -1, 2, -2, 100, -100,
+    G_MAXINT32, -G_MAXINT32
+  };
+  guint8 data[64] = { 0, };
+  GstBitReader reader;
+  guint pos = 0, i;
+  guint32 ue;
+  gint32 se;
+
+  for (i = 0; i < G_N_ELEMENTS (ue_values); i++)
+    put_ue (data, &pos, ue_values[i]);
+  for (i = 0; i < G_N_ELEMENTS (se_values); i++) {
+    gint32 v = se_values[i];
+
+    put_ue (data, &pos, v > 0 ? 2 * (guint32) v - 1 : 2 * (guint32) (-v));
+  }
+
+  gst_bit_reader_init (&reader, data, (pos + 7) / 8);
+  for (i = 0; i < G_N_ELEMENTS (ue_values); i++) {
+    fail_unless (gst_bit_reader_get_ue (&reader, &ue));
+    fail_unless_equals_uint64 (ue, ue_values[i]);
+  }
+  for (i = 0; i < G_N_ELEMENTS (se_values); i++) {
+    fail_unless (gst_bit_reader_get_se (&reader, &se));
+    fail_unless_equals_int (se, se_values[i]);
+  }
+  fail_unless_equals_int (gst_bit_reader_get_pos (&reader), pos);
+
+  /* truncated code and too many leading zeros */
+  memset (data, 0, sizeof (data));
+  pos = 0;
+  put_ue (data, &pos, 1000);
+  gst_bit_reader_init (&reader, data, 2);
+  fail_if (gst_bit_reader_get_ue (&reader, &ue));
+  fail_unless_equals_int (gst_bit_reader_get_pos (&reader), 0);
+  memset (data, 0, sizeof (data));
+  gst_bit_reader_init (&reader, data, sizeof (data));
+  fail_if (gst_bit_reader_get_ue (&reader, &ue));
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_get_bits_unaligned)
+{
+  guint8 data[24];
+  GstBitReader reader;
+  guint i, bit, nbits;
+
+  for (i = 0; i < sizeof (data); i++)
+    data[i] = 0x11 * (i + 1) + i;
+
+  /* compare reads at all bit offsets, also the ones that need more than 8
+   * bytes and the ones near the end, against a bit by bit read */
+  for (bit = 0; bit < 8 * 16; bit++) {
+    for (nbits = 1; nbits <= 64 && bit + nbits <= 8 * sizeof (data); nbits++) {
+      guint64 val, expected = 0;
+
+      for (i = bit; i < bit + nbits; i++)
+        expected = (expected << 1) | ((data[i / 8] >> (7 - i % 8)) & 1);
+
+      gst_bit_reader_init (&reader, data, sizeof (data));
+      fail_unless (gst_bit_reader_skip (&reader, bit));
+      fail_unless (gst_bit_reader_get_bits_uint64 (&reader, &val, nbits));
+      fail_unless_equals_uint64 (val, expected);
+      fail_unless_equals_int (gst_bit_reader_get_pos (&reader), bit + nbits);
+    }
+  }
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_bit_reader_suite (void)
 {
@@ -246,6 +345,8 @@ gst_bit_reader_suite (void)
   tcase_add_test (tc_chain, test_initialization);
   tcase_add_test (tc_chain, test_get_bits);
   tcase_add_test (tc_chain, test_position_tracking);
+  tcase_add_test (tc_chain, test_exp_golomb);
+  tcase_add_test (tc_chain, test_get_bits_unaligned);
 
   return s;
 }
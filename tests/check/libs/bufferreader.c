@@ -0,0 +1,168 @@
+/* GStreamer
+ *
+ * bufferreader.c: Unit test for GstBufferReader
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <gst/check/gstcheck.h>
+#include <gst/base/gstbufferreader.h>
+
+static guint8 data[] = {
+  0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08,
+  0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x10
+};
+
+/* wrap @data in memory blocks of 1, 2, 3, 4 and 6 bytes */
+static GstBuffer *
+create_buffer (void)
+{
+  static const guint sizes[] = { 1, 2, 3, 4, 6 };
+  GstBuffer *buf;
+  guint i, offset = 0;
+
+  buf = gst_buffer_new ();
+  for (i = 0; i < G_N_ELEMENTS (sizes); i++) {
+    gst_buffer_append_memory (buf,
+        gst_memory_new_wrapped (GST_MEMORY_FLAG_READONLY, data, sizeof (data),
+            offset, sizes[i], NULL, NULL));
+    offset += sizes[i];
+  }
+  fail_unless_equals_int (offset, sizeof (data));
+
+  return buf;
+}
+
+GST_START_TEST (test_chunks)
+{
+  GstBufferReader reader;
+  GstBuffer *buf;
+  const guint8 *chunk;
+  gsize size, total = 0;
+  guint n_chunks = 0;
+
+  buf = create_buffer ();
+
+  gst_buffer_reader_init (&reader, buf);
+  fail_unless_equals_int (gst_buffer_reader_get_size (&reader), sizeof (data));
+
+  while (gst_buffer_reader_get_chunk (&reader, &chunk, &size)) {
+    /* the chunks point into the original memory, nothing is copied */
+    fail_unless (chunk == data + total);
+    total += size;
+    n_chunks++;
+  }
+  fail_unless_equals_int (total, sizeof (data));
+  fail_unless_equals_int (n_chunks, 5);
+  fail_unless_equals_int (gst_buffer_reader_get_remaining (&reader), 0);
+
+  /* a partly read chunk returns the rest of the memory block */
+  gst_buffer_reader_clear (&reader);
+  gst_buffer_reader_init (&reader, buf);
+  fail_unless (gst_buffer_reader_skip (&reader, 4));
+  fail_unless (gst_buffer_reader_get_chunk (&reader, &chunk, &size));
+  fail_unless (chunk == data + 4);
+  fail_unless_equals_int (size, 2);
+  fail_unless_equals_int (gst_buffer_reader_get_pos (&reader), 6);
+  gst_buffer_reader_clear (&reader);
+
+  /* the buffer was not merged */
+  fail_unless_equals_int (gst_buffer_n_memory (buf), 5);
+  gst_buffer_unref (buf);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_read_across_memory)
+{
+  GstBufferReader reader;
+  GstBuffer *buf;
+  const guint8 *ptr;
+  guint8 u8;
+  guint16 u16;
+  guint32 u32;
+  guint64 u64;
+
+  buf = create_buffer ();
+  gst_buffer_reader_init (&reader, buf);
+
+  fail_unless (gst_buffer_reader_peek_uint8 (&reader, &u8));
+  fail_unless_equals_int (u8, 0x01);
+  fail_unless (gst_buffer_reader_get_uint8 (&reader, &u8));
+  fail_unless_equals_int (u8, 0x01);
+
+  /* contained in the second memory block */
+  fail_unless (gst_buffer_reader_get_uint16_be (&reader, &u16));
+  fail_unless_equals_int (u16, 0x0203);
+
+  /* crosses from the third into the fourth memory block */
+  fail_unless (gst_buffer_reader_peek_uint32_le (&reader, &u32));
+  fail_unless_equals_int (u32, 0x07060504);
+  fail_unless (gst_buffer_reader_get_uint32_be (&reader, &u32));
+  fail_unless_equals_int (u32, 0x04050607);
+  fail_unless_equals_int (gst_buffer_reader_get_pos (&reader), 7);
+
+  fail_unless (gst_buffer_reader_get_uint64_be (&reader, &u64));
+  fail_unless (u64 == G_GUINT64_CONSTANT (0x08090a0b0c0d0e0f));
+
+  /* not enough data left */
+  fail_if (gst_buffer_reader_get_uint16_le (&reader, &u16));
+  fail_unless_equals_int (gst_buffer_reader_get_remaining (&reader), 1);
+  fail_if (gst_buffer_reader_skip (&reader, 2));
+
+  fail_unless (gst_buffer_reader_get_uint8 (&reader, &u8));
+  fail_unless_equals_int (u8, 0x10);
+  fail_if (gst_buffer_reader_get_uint8 (&reader, &u8));
+
+  /* data within one memory block is not copied */
+  gst_buffer_reader_clear (&reader);
+  gst_buffer_reader_init (&reader, buf);
+  fail_unless (gst_buffer_reader_skip (&reader, 10));
+  fail_unless (gst_buffer_reader_get_data (&reader, 6, &ptr));
+  fail_unless (ptr == data + 10);
+
+  /* data across memory blocks is */
+  gst_buffer_reader_clear (&reader);
+  gst_buffer_reader_init (&reader, buf);
+  fail_unless (gst_buffer_reader_peek_data (&reader, 12, &ptr));
+  fail_unless (memcmp (ptr, data, 12) == 0);
+  fail_unless_equals_int (gst_buffer_reader_get_pos (&reader), 0);
+  gst_buffer_reader_clear (&reader);
+
+  fail_unless_equals_int (gst_buffer_n_memory (buf), 5);
+  gst_buffer_unref (buf);
+}
+
+GST_END_TEST;
+
+static Suite *
+gst_buffer_reader_suite (void)
+{
+  Suite *s = suite_create ("GstBufferReader");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_chunks);
+  tcase_add_test (tc_chain, test_read_across_memory);
+
+  return s;
+}
+
+GST_CHECK_MAIN (gst_buffer_reader);
@@ -567,6 +567,74 @@ GST_START_TEST (test_scan)
 
 GST_END_TEST;
 
+static guint
+find_start_code_slow (const guint8 * data, guint offset, guint size)
+{
+  guint i;
+
+  for (i = offset; i + 4 <= offset + size; i++) {
+    if (data[i] == 0 && data[i + 1] == 0 && data[i + 2] == 1)
+      return i;
+  }
+  return -1;
+}
+
+GST_START_TEST (test_find_start_code)
+{
+  GstByteReader reader;
+  guint8 data[256];
+  guint8 code;
+  guint i, offset;
+
+  /* no zero bytes except for a few start codes and a lone zero run */
+  for (i = 0; i < sizeof (data); i++)
+    data[i] = 0x40 + (i % 0xb0);
+  data[17] = data[18] = 0;
+  data[19] = 1;
+  data[20] = 0x67;
+  data[100] = data[101] = data[102] = 0;
+  data[103] = 0x55;
+  data[150] = data[151] = 0;
+  data[152] = 1;
+  data[153] = 0x65;
+  data[252] = data[253] = 0;
+  data[254] = 1;
+
+  gst_byte_reader_init (&reader, data, sizeof (data));
+
+  fail_unless_equals_int (gst_byte_reader_find_start_code (&reader, 0, 256,
+          &code), 17);
+  fail_unless_equals_int (code, 0x67);
+  fail_unless_equals_int (gst_byte_reader_find_start_code (&reader, 18, 238,
+          &code), 150);
+  fail_unless_equals_int (code, 0x65);
+  /* the byte after the prefix must be inside the scanned range */
+  fail_unless_equals_int (gst_byte_reader_find_start_code (&reader, 151, 104,
+          NULL), -1);
+  fail_unless_equals_int (gst_byte_reader_find_start_code (&reader, 151, 105,
+          NULL), 252);
+
+  /* must match the byte by byte scan everywhere */
+  for (offset = 0; offset < sizeof (data) - 4; offset++) {
+    guint size;
+
+    for (size = 4; offset + size <= sizeof (data); size += 7) {
+      fail_unless_equals_int (gst_byte_reader_find_start_code (&reader,
+              offset, size, NULL), find_start_code_slow (data, offset, size));
+      fail_unless_equals_int (gst_byte_reader_masked_scan_uint32 (&reader,
+              0xffffff00, 0x00000100, offset, size),
+          find_start_code_slow (data, offset, size));
+    }
+  }
+
+  /* offsets are relative to the current position */
+  fail_unless (gst_byte_reader_skip (&reader, 10));
+  fail_unless_equals_int (gst_byte_reader_find_start_code (&reader, 0, 246,
+          NULL), 7);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_string_funcs)
 {
   GstByteReader reader, backup;
@@ -795,6 +863,7 @@ gst_byte_reader_suite (void)
   tcase_add_test (tc_chain, test_get_float_be);
   tcase_add_test (tc_chain, test_position_tracking);
   tcase_add_test (tc_chain, test_scan);
+  tcase_add_test (tc_chain, test_find_start_code);
   tcase_add_test (tc_chain, test_string_funcs);
   tcase_add_test (tc_chain, test_dup_string);
   tcase_add_test (tc_chain, test_sub_reader);
@@ -236,6 +236,48 @@ GST_START_TEST (test_fill)
 }
 
 GST_END_TEST;
+
+GST_START_TEST (test_write_buffer)
+{
+  GstByteWriter writer;
+  GstBuffer *buffer, *buffer2;
+  GstMemory *mem;
+  GstMapInfo map;
+  guint8 *data;
+  guint8 expected[] = { 0x12, 0x34, 0x56, 0x78, 0x1, 0x2, 0x3 };
+
+  buffer = gst_buffer_new_allocate (NULL, 8, NULL);
+  mem = gst_buffer_peek_memory (buffer, 0);
+
+  fail_unless (gst_byte_writer_init_with_buffer (&writer, buffer, FALSE));
+  fail_unless_equals_int (gst_byte_writer_get_remaining (&writer), 8);
+  fail_unless (gst_byte_writer_put_uint32_be (&writer, 0x12345678));
+
+  /* write in place */
+  data = gst_byte_writer_reserve (&writer, 3);
+  fail_unless (data != NULL);
+  data[0] = 0x1;
+  data[1] = 0x2;
+  data[2] = 0x3;
+  fail_unless (gst_byte_writer_commit (&writer, 3));
+  fail_unless_equals_int (gst_byte_writer_get_pos (&writer), 7);
+
+  /* the buffer is not reallocated */
+  fail_if (gst_byte_writer_reserve (&writer, 2) != NULL);
+  fail_if (gst_byte_writer_put_uint16_be (&writer, 0));
+
+  buffer2 = gst_byte_writer_reset_and_get_buffer (&writer);
+  fail_unless (buffer2 == buffer);
+  fail_unless (gst_buffer_peek_memory (buffer2, 0) == mem);
+  fail_unless_equals_int (gst_buffer_get_size (buffer2), 7);
+  fail_unless (gst_buffer_map (buffer2, &map, GST_MAP_READ));
+  fail_unless (memcmp (map.data, expected, 7) == 0);
+  gst_buffer_unmap (buffer2, &map);
+  gst_buffer_unref (buffer2);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_byte_writer_suite (void)
 {
@@ -250,6 +292,7 @@ gst_byte_writer_suite (void)
   tcase_add_test (tc_chain, test_from_data);
   tcase_add_test (tc_chain, test_put_data_strings);
   tcase_add_test (tc_chain, test_fill);
+  tcase_add_test (tc_chain, test_write_buffer);
 
   return s;
 }
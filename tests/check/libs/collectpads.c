@@ -682,6 +682,55 @@ GST_START_TEST (test_collect_default)
 
 GST_END_TEST;
 
+/* The default collected buffer func should pick the oldest buffer, even if
+ * it is not on the first pad */
+GST_START_TEST (test_collect_default_order)
+{
+  GstBuffer *buf1, *buf2;
+  GThread *thread1, *thread2;
+
+  data1 = (TestData *) gst_collect_pads_add_pad (collect,
+      sinkpad1, sizeof (TestData), NULL, TRUE);
+  fail_unless (data1 != NULL);
+
+  data2 = (TestData *) gst_collect_pads_add_pad (collect,
+      sinkpad2, sizeof (TestData), NULL, TRUE);
+  fail_unless (data2 != NULL);
+
+  buf1 = gst_buffer_new ();
+  GST_BUFFER_TIMESTAMP (buf1) = GST_SECOND;
+  buf2 = gst_buffer_new ();
+  GST_BUFFER_TIMESTAMP (buf2) = 0;
+
+  gst_collect_pads_start (collect);
+
+  data1->pad = srcpad1;
+  data1->buffer = buf1;
+  thread1 = g_thread_try_new ("gst-check", push_buffer, data1, NULL);
+  fail_unless_collected (FALSE);
+
+  data2->pad = srcpad2;
+  data2->buffer = buf2;
+  thread2 = g_thread_try_new ("gst-check", push_buffer, data2, NULL);
+
+  fail_unless_collected (TRUE);
+
+  /* the buffer of the second pad was popped first, the one of the first pad
+   * is still pending */
+  fail_unless (outbuf1 == buf1);
+  fail_unless (outbuf2 == NULL);
+
+  g_thread_join (thread1);
+  g_thread_join (thread2);
+
+  gst_collect_pads_stop (collect);
+
+  gst_buffer_unref (buf1);
+  gst_buffer_unref (buf2);
+}
+
+GST_END_TEST;
+
 
 #define NUM_BUFFERS 3
 static void
@@ -1080,6 +1129,7 @@ gst_collect_pads_suite (void)
   suite_add_tcase (suite, buffers);
   tcase_add_checked_fixture (buffers, setup_buffer_cb, teardown);
   tcase_add_test (buffers, test_collect_default);
+  tcase_add_test (buffers, test_collect_default_order);
 
   pipeline = tcase_create ("pipeline");
   suite_add_tcase (suite, pipeline);
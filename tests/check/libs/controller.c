@@ -24,6 +24,7 @@
 #ifdef HAVE_CONFIG_H
 #include "config.h"
 #endif
+#include <math.h>
 #include <gst/gst.h>
 #include <gst/check/gstcheck.h>
 #include <gst/controller/gstinterpolationcontrolsource.h>
@@ -379,6 +380,66 @@ GST_START_TEST (controller_interpolation_none)
 
 GST_END_TEST;
 
+/* test that syncing is skipped while the values don't change and that
+ * editing the control points ends the skipping */
+GST_START_TEST (controller_interpolation_next_change)
+{
+  GstControlSource *cs;
+  GstTimedValueControlSource *tvcs;
+  GstControlBinding *cb;
+  GstElement *elem;
+
+  elem = gst_element_factory_make ("testobj", NULL);
+
+  cs = gst_interpolation_control_source_new ();
+  tvcs = (GstTimedValueControlSource *) cs;
+  cb = gst_direct_control_binding_new (GST_OBJECT (elem), "int", cs);
+  fail_unless (gst_object_add_control_binding (GST_OBJECT (elem), cb));
+
+  g_object_set (cs, "mode", GST_INTERPOLATION_MODE_NONE, NULL);
+  fail_unless (gst_timed_value_control_source_set (tvcs, 1 * GST_SECOND, 0.0));
+  fail_unless (gst_timed_value_control_source_set (tvcs, 2 * GST_SECOND, 0.0));
+  fail_unless (gst_timed_value_control_source_set (tvcs, 3 * GST_SECOND, 0.5));
+
+  /* steps only change at control points with a different value */
+  fail_unless_equals_uint64 (gst_control_binding_get_next_change (cb, 0),
+      1 * GST_SECOND);
+  fail_unless_equals_uint64 (gst_control_binding_get_next_change (cb,
+          1 * GST_SECOND), 3 * GST_SECOND);
+  fail_unless_equals_uint64 (gst_control_binding_get_next_change (cb,
+          4 * GST_SECOND), GST_CLOCK_TIME_NONE);
+
+  /* linear is constant between control points with the same value */
+  g_object_set (cs, "mode", GST_INTERPOLATION_MODE_LINEAR, NULL);
+  fail_unless_equals_uint64 (gst_control_binding_get_next_change (cb,
+          1 * GST_SECOND), 2 * GST_SECOND);
+  fail_unless_equals_uint64 (gst_control_binding_get_next_change (cb,
+          2 * GST_SECOND), 2 * GST_SECOND);
+
+  /* disabled bindings never change */
+  gst_control_binding_set_disabled (cb, TRUE);
+  fail_unless_equals_uint64 (gst_control_binding_get_next_change (cb,
+          2 * GST_SECOND), GST_CLOCK_TIME_NONE);
+  gst_control_binding_set_disabled (cb, FALSE);
+
+  g_object_set (cs, "mode", GST_INTERPOLATION_MODE_NONE, NULL);
+  gst_object_sync_values (GST_OBJECT (elem), 1 * GST_SECOND);
+  fail_unless_equals_int (GST_TEST_OBJ (elem)->val_int, 0);
+
+  /* a new control point before the next change must be picked up */
+  fail_unless (gst_timed_value_control_source_set (tvcs,
+          1500 * GST_MSECOND, 1.0));
+  gst_object_sync_values (GST_OBJECT (elem), 2 * GST_SECOND);
+  fail_unless_equals_int (GST_TEST_OBJ (elem)->val_int, 100);
+  gst_object_sync_values (GST_OBJECT (elem), 3 * GST_SECOND);
+  fail_unless_equals_int (GST_TEST_OBJ (elem)->val_int, 50);
+
+  gst_object_unref (cs);
+  gst_object_unref (elem);
+}
+
+GST_END_TEST;
+
 /* test timed value handling with linear interpolation */
 GST_START_TEST (controller_interpolation_linear)
 {
@@ -728,6 +789,50 @@ GST_START_TEST (controller_interpolation_linear_value_array)
 
 GST_END_TEST;
 
+/* test that get_value_array() gives the same values as get_value() for all
+ * interpolation modes, also when looking up values out of order */
+GST_START_TEST (controller_interpolation_value_array_matches_get)
+{
+  static const GstClockTime cp_ts[] = { 100, 350, 400, 900, 1000, 1750 };
+  static const gdouble cp_val[] = { 0.1, 0.7, 0.2, 0.9, 0.4, 0.5 };
+  GstControlSource *cs;
+  GstTimedValueControlSource *tvcs;
+  gdouble raw_values[40], value;
+  gint mode, i;
+
+  cs = gst_interpolation_control_source_new ();
+  tvcs = (GstTimedValueControlSource *) cs;
+
+  for (i = 0; i < G_N_ELEMENTS (cp_ts); i++)
+    fail_unless (gst_timed_value_control_source_set (tvcs,
+            cp_ts[i] * GST_MSECOND, cp_val[i]));
+
+  for (mode = GST_INTERPOLATION_MODE_NONE;
+      mode <= GST_INTERPOLATION_MODE_CUBIC_MONOTONIC; mode++) {
+    g_object_set (cs, "mode", mode, NULL);
+
+    fail_unless (gst_control_source_get_value_array (cs, 0,
+            53 * GST_MSECOND, G_N_ELEMENTS (raw_values), raw_values));
+
+    /* backwards, so that every lookup misses the previous one */
+    for (i = G_N_ELEMENTS (raw_values) - 1; i >= 0; i--) {
+      GstClockTime ts = i * 53 * GST_MSECOND;
+
+      if (ts < cp_ts[0] * GST_MSECOND) {
+        fail_unless (isnan (raw_values[i]));
+        fail_if (gst_control_source_get_value (cs, ts, &value));
+      } else {
+        fail_unless (gst_control_source_get_value (cs, ts, &value));
+        fail_unless_equals_float (raw_values[i], value);
+      }
+    }
+  }
+
+  gst_object_unref (cs);
+}
+
+GST_END_TEST;
+
 /* test if values below minimum and above maximum are clipped */
 GST_START_TEST (controller_interpolation_linear_invalid_values)
 {
@@ -1131,6 +1236,37 @@ GST_START_TEST (controller_timed_value_count)
 GST_END_TEST;
 
 
+/* test that the value arrays of the lfo control source, which are generated
+ * in blocks, give the same values as get_value() */
+GST_START_TEST (controller_lfo_value_array)
+{
+  GstControlSource *cs;
+  gdouble raw_values[200], value;
+  gint waveform, i;
+
+  cs = gst_lfo_control_source_new ();
+  g_object_set (cs, "frequency", 3.0, "timeshift", 7 * GST_MSECOND,
+      "amplitude", 0.4, "offset", 0.5, NULL);
+
+  for (waveform = GST_LFO_WAVEFORM_SINE;
+      waveform <= GST_LFO_WAVEFORM_TRIANGLE; waveform++) {
+    g_object_set (cs, "waveform", waveform, NULL);
+
+    fail_unless (gst_control_source_get_value_array (cs, 0,
+            11 * GST_MSECOND, G_N_ELEMENTS (raw_values), raw_values));
+
+    for (i = 0; i < G_N_ELEMENTS (raw_values); i++) {
+      fail_unless (gst_control_source_get_value (cs, i * 11 * GST_MSECOND,
+              &value));
+      fail_unless_equals_float (raw_values[i], value);
+    }
+  }
+
+  gst_object_unref (cs);
+}
+
+GST_END_TEST;
+
 /* test lfo control source with sine waveform */
 GST_START_TEST (controller_lfo_sine)
 {
@@ -1526,6 +1662,39 @@ GST_START_TEST (controller_trigger_tolerance)
 
 GST_END_TEST;
 
+/* test that sparse control sources leave the gaps of a typed value array
+ * untouched */
+GST_START_TEST (controller_trigger_value_array)
+{
+  GstControlSource *cs;
+  GstTimedValueControlSource *tvcs;
+  GstElement *elem;
+  gfloat values[4] = { -1.0, -1.0, -1.0, -1.0 };
+
+  elem = gst_element_factory_make ("testobj", NULL);
+
+  cs = gst_trigger_control_source_new ();
+  tvcs = (GstTimedValueControlSource *) cs;
+
+  fail_unless (gst_object_add_control_binding (GST_OBJECT (elem),
+          gst_direct_control_binding_new (GST_OBJECT (elem), "float", cs)));
+
+  fail_unless (gst_timed_value_control_source_set (tvcs, 0 * GST_SECOND, 0.5));
+  fail_unless (gst_timed_value_control_source_set (tvcs, 2 * GST_SECOND, 1.0));
+
+  fail_unless (gst_object_get_value_array (GST_OBJECT (elem), "float",
+          0, GST_SECOND, 4, values));
+  fail_unless_equals_float (values[0], 50.0);
+  fail_unless_equals_float (values[1], -1.0);
+  fail_unless_equals_float (values[2], 100.0);
+  fail_unless_equals_float (values[3], -1.0);
+
+  gst_object_unref (cs);
+  gst_object_unref (elem);
+}
+
+GST_END_TEST;
+
 
 static Suite *
 gst_controller_suite (void)
@@ -1538,6 +1707,7 @@ gst_controller_suite (void)
   tcase_add_test (tc, controller_controlsource_empty1);
   tcase_add_test (tc, controller_controlsource_empty2);
   tcase_add_test (tc, controller_interpolation_none);
+  tcase_add_test (tc, controller_interpolation_next_change);
   tcase_add_test (tc, controller_interpolation_linear);
   tcase_add_test (tc, controller_interpolation_cubic);
   tcase_add_test (tc, controller_interpolation_cubic_too_few_cp);
@@ -1545,6 +1715,7 @@ gst_controller_suite (void)
   tcase_add_test (tc, controller_interpolation_unset_all);
   tcase_add_test (tc, controller_interpolation_linear_absolute_value_array);
   tcase_add_test (tc, controller_interpolation_linear_value_array);
+  tcase_add_test (tc, controller_interpolation_value_array_matches_get);
   tcase_add_test (tc, controller_interpolation_linear_invalid_values);
   tcase_add_test (tc, controller_interpolation_linear_default_values);
   tcase_add_test (tc, controller_interpolation_linear_disabled);
@@ -1552,6 +1723,7 @@ gst_controller_suite (void)
   tcase_add_test (tc, controller_interpolation_linear_before_ts0);
   tcase_add_test (tc, controller_interpolation_linear_enums);
   tcase_add_test (tc, controller_timed_value_count);
+  tcase_add_test (tc, controller_lfo_value_array);
   tcase_add_test (tc, controller_lfo_sine);
   tcase_add_test (tc, controller_lfo_sine_timeshift);
   tcase_add_test (tc, controller_lfo_square);
@@ -1560,6 +1732,7 @@ gst_controller_suite (void)
   tcase_add_test (tc, controller_lfo_triangle);
   tcase_add_test (tc, controller_trigger_exact);
   tcase_add_test (tc, controller_trigger_tolerance);
+  tcase_add_test (tc, controller_trigger_value_array);
 
   return s;
 }
@@ -232,6 +232,70 @@ GST_START_TEST (test_clear)
 
 GST_END_TEST;
 
+GST_START_TEST (test_update_pad_flow)
+{
+  GstFlowCombiner *combiner;
+  GstPad *pad1, *pad2, *pad3;
+
+  pad1 = gst_pad_new ("src1", GST_PAD_SRC);
+  pad2 = gst_pad_new ("src2", GST_PAD_SRC);
+  pad3 = gst_pad_new ("src3", GST_PAD_SRC);
+  gst_pad_set_active (pad1, TRUE);
+  gst_pad_set_active (pad2, TRUE);
+  gst_pad_set_active (pad3, TRUE);
+
+  combiner = gst_flow_combiner_new ();
+  gst_flow_combiner_add_pad (combiner, pad1);
+  gst_flow_combiner_add_pad (combiner, pad2);
+  gst_flow_combiner_add_pad (combiner, pad3);
+
+  fail_unless_equals_int (gst_flow_combiner_update_pad_flow (combiner, pad1,
+          GST_FLOW_OK), GST_FLOW_OK);
+  fail_unless_equals_int (gst_flow_combiner_update_pad_flow (combiner, pad1,
+          GST_FLOW_NOT_LINKED), GST_FLOW_OK);
+  fail_unless_equals_int (gst_flow_combiner_update_pad_flow (combiner, pad2,
+          GST_FLOW_NOT_LINKED), GST_FLOW_OK);
+  fail_unless_equals_int (gst_flow_combiner_update_pad_flow (combiner, pad3,
+          GST_FLOW_NOT_LINKED), GST_FLOW_NOT_LINKED);
+  fail_unless_equals_int (gst_flow_combiner_update_pad_flow (combiner, pad3,
+          GST_FLOW_EOS), GST_FLOW_EOS);
+  fail_unless_equals_int (gst_flow_combiner_update_pad_flow (combiner, pad2,
+          GST_FLOW_OK), GST_FLOW_OK);
+
+  /* an error on one pad is returned until that pad recovers */
+  fail_unless_equals_int (gst_flow_combiner_update_pad_flow (combiner, pad1,
+          GST_FLOW_FLUSHING), GST_FLOW_FLUSHING);
+  fail_unless_equals_int (gst_flow_combiner_update_pad_flow (combiner, pad2,
+          GST_FLOW_OK), GST_FLOW_FLUSHING);
+  fail_unless_equals_int (gst_flow_combiner_update_pad_flow (combiner, pad1,
+          GST_FLOW_OK), GST_FLOW_OK);
+
+  /* a flow return set without the combiner is picked up by
+   * gst_flow_combiner_update_flow() */
+  GST_PAD_LAST_FLOW_RETURN (pad1) = GST_FLOW_EOS;
+  fail_unless_equals_int (gst_flow_combiner_update_pad_flow (combiner, pad2,
+          GST_FLOW_EOS), GST_FLOW_OK);
+  fail_unless_equals_int (gst_flow_combiner_update_flow (combiner,
+          GST_FLOW_EOS), GST_FLOW_EOS);
+  fail_unless_equals_int (gst_flow_combiner_update_pad_flow (combiner, pad3,
+          GST_FLOW_EOS), GST_FLOW_EOS);
+
+  /* removing a pad updates the counts */
+  fail_unless_equals_int (gst_flow_combiner_update_pad_flow (combiner, pad3,
+          GST_FLOW_OK), GST_FLOW_OK);
+  gst_flow_combiner_remove_pad (combiner, pad3);
+  fail_unless_equals_int (gst_flow_combiner_update_pad_flow (combiner, pad2,
+          GST_FLOW_EOS), GST_FLOW_EOS);
+
+  gst_flow_combiner_free (combiner);
+
+  gst_object_unref (pad1);
+  gst_object_unref (pad2);
+  gst_object_unref (pad3);
+}
+
+GST_END_TEST;
+
 static Suite *
 flow_combiner_suite (void)
 {
@@ -241,6 +305,7 @@ flow_combiner_suite (void)
   suite_add_tcase (s, tc_chain);
   tcase_add_test (tc_chain, test_combined_flows);
   tcase_add_test (tc_chain, test_clear);
+  tcase_add_test (tc_chain, test_update_pad_flow);
 
   return s;
 }
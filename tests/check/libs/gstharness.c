@@ -167,6 +167,52 @@ GST_START_TEST (test_forward_event_and_query_to_sink_harness_while_teardown)
 
 GST_END_TEST;
 
+static void
+check_benchmark_result (const GstStructure * s, guint buffers, gsize size)
+{
+  guint pushed, received;
+  guint64 bytes, p50, p99, max;
+
+  fail_unless (gst_structure_has_name (s, "harness-benchmark"));
+  fail_unless (gst_structure_get (s, "buffers", G_TYPE_UINT, &pushed,
+          "received", G_TYPE_UINT, &received, "bytes", G_TYPE_UINT64, &bytes,
+          "latency-p50", G_TYPE_UINT64, &p50,
+          "latency-p99", G_TYPE_UINT64, &p99,
+          "latency-max", G_TYPE_UINT64, &max, NULL));
+  fail_unless_equals_int (pushed, buffers);
+  fail_unless_equals_int (received, buffers);
+  fail_unless_equals_uint64 (bytes, (guint64) buffers * size);
+  fail_unless (p50 <= p99 && p99 <= max);
+}
+
+GST_START_TEST (test_benchmark_push)
+{
+  GstHarness *h[2];
+  GstStructure *s;
+  gint i;
+
+  for (i = 0; i < G_N_ELEMENTS (h); i++) {
+    h[i] = gst_harness_new ("identity");
+    gst_harness_set_src_caps_str (h[i], "mycaps");
+  }
+
+  s = gst_harness_benchmark_push (h[0], 100, 1000);
+  check_benchmark_result (s, 1000, 100);
+  gst_structure_free (s);
+
+  /* the measured buffers are not queued */
+  fail_unless_equals_int (gst_harness_buffers_in_queue (h[0]), 0);
+
+  s = gst_harness_benchmark_push_parallel (h, G_N_ELEMENTS (h), 100, 1000);
+  check_benchmark_result (s, 2000, 100);
+  gst_structure_free (s);
+
+  for (i = 0; i < G_N_ELEMENTS (h); i++)
+    gst_harness_teardown (h[i]);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_harness_suite (void)
 {
@@ -179,6 +225,7 @@ gst_harness_suite (void)
   tcase_add_test (tc_chain, test_src_harness);
   tcase_add_test (tc_chain, test_src_harness_no_forwarding);
   tcase_add_test (tc_chain, test_add_sink_harness_without_sinkpad);
+  tcase_add_test (tc_chain, test_benchmark_push);
 
   tcase_add_test (tc_chain,
       test_forward_event_and_query_to_sink_harness_while_teardown);
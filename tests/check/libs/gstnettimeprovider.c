@@ -106,6 +106,62 @@ GST_START_TEST (test_functioning)
 
 GST_END_TEST;
 
+GST_START_TEST (test_threads)
+{
+  GstNetTimeProvider *ntp;
+  GstNetTimePacket *packet;
+  GstClock *clock;
+  GstClockTime local;
+  GSocketAddress *server_addr;
+  GInetAddress *addr;
+  GSocket *sockets[8];
+  gint i, port = -1;
+
+  clock = gst_system_clock_obtain ();
+  ntp = g_initable_new (GST_TYPE_NET_TIME_PROVIDER, NULL, NULL, "clock", clock,
+      "address", "127.0.0.1", "port", 0, "n-threads", 4, NULL);
+  fail_unless (ntp != NULL, "failed to create net time provider");
+
+  g_object_get (ntp, "port", &port, NULL);
+  fail_unless (port > 0);
+
+  addr = g_inet_address_new_from_string ("127.0.0.1");
+  server_addr = g_inet_socket_address_new (addr, port);
+  g_object_unref (addr);
+
+  /* several clients, the requests are spread over the threads */
+  local = gst_clock_get_time (clock);
+  for (i = 0; i < G_N_ELEMENTS (sockets); i++) {
+    sockets[i] = g_socket_new (G_SOCKET_FAMILY_IPV4, G_SOCKET_TYPE_DATAGRAM,
+        G_SOCKET_PROTOCOL_UDP, NULL);
+    fail_unless (sockets[i] != NULL, "could not create socket");
+
+    packet = gst_net_time_packet_new (NULL);
+    packet->local_time = local + i;
+    fail_unless (gst_net_time_packet_send (packet, sockets[i], server_addr,
+            NULL));
+    g_free (packet);
+  }
+
+  for (i = 0; i < G_N_ELEMENTS (sockets); i++) {
+    packet = gst_net_time_packet_receive (sockets[i], NULL, NULL);
+    fail_unless (packet != NULL, "failed to receive packet");
+    fail_unless (packet->local_time == local + i, "local time not the same");
+    fail_unless (packet->remote_time >= local, "remote time before local");
+    fail_unless (packet->remote_time <= gst_clock_get_time (clock),
+        "remote time in the future");
+    g_free (packet);
+    g_object_unref (sockets[i]);
+  }
+
+  g_object_unref (server_addr);
+
+  gst_object_unref (ntp);
+  gst_object_unref (clock);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_net_time_provider_suite (void)
 {
@@ -115,6 +171,7 @@ gst_net_time_provider_suite (void)
   suite_add_tcase (s, tc_chain);
   tcase_add_test (tc_chain, test_refcounts);
   tcase_add_test (tc_chain, test_functioning);
+  tcase_add_test (tc_chain, test_threads);
 
   return s;
 }
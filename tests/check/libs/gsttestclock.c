@@ -1040,6 +1040,101 @@ GST_START_TEST (test_crank)
 
 GST_END_TEST;
 
+static gboolean
+test_count_async_cb (GstClock * clock,
+    GstClockTime time, GstClockID id, gpointer user_data)
+{
+  guint *count = user_data;
+
+  *count += 1;
+
+  return TRUE;
+}
+
+GST_START_TEST (test_set_time_and_process)
+{
+  GstClock *clock;
+  GstTestClock *test_clock;
+  GstClockID clock_ids[4];
+  guint count = 0;
+  guint i;
+
+  clock = gst_test_clock_new ();
+  test_clock = GST_TEST_CLOCK (clock);
+
+  /* register them out of order */
+  for (i = 0; i < G_N_ELEMENTS (clock_ids); i++) {
+    clock_ids[i] = gst_clock_new_single_shot_id (clock,
+        ((i * 3) % 4 + 1) * GST_SECOND);
+    fail_unless_equals_int (gst_clock_id_wait_async (clock_ids[i],
+            test_count_async_cb, &count, NULL), GST_CLOCK_OK);
+  }
+  fail_unless_equals_int (gst_test_clock_peek_id_count (test_clock), 4);
+
+  /* nothing is due yet */
+  fail_unless_equals_int (gst_test_clock_set_time_and_process (test_clock,
+          GST_SECOND / 2), 0);
+
+  /* the ids for 1 and 2 seconds are released in one go */
+  fail_unless_equals_int (gst_test_clock_set_time_and_process (test_clock,
+          2 * GST_SECOND), 2);
+  fail_unless_equals_int (count, 2);
+  fail_unless_equals_int (gst_test_clock_peek_id_count (test_clock), 2);
+  fail_unless (gst_test_clock_peek_next_pending_id (test_clock, NULL));
+  fail_unless_equals_uint64 (gst_test_clock_get_next_entry_time (test_clock),
+      3 * GST_SECOND);
+
+  fail_unless_equals_int (gst_test_clock_set_time_and_process (test_clock,
+          10 * GST_SECOND), 2);
+  fail_unless_equals_int (count, 4);
+  fail_unless_equals_int (gst_test_clock_peek_id_count (test_clock), 0);
+  fail_unless_equals_uint64 (gst_clock_get_time (clock), 10 * GST_SECOND);
+
+  for (i = 0; i < G_N_ELEMENTS (clock_ids); i++)
+    gst_clock_id_unref (clock_ids[i]);
+  gst_object_unref (clock);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_fast_forward)
+{
+  GstClock *clock;
+  GstTestClock *test_clock;
+  GstClockID clock_id;
+  guint count = 0;
+
+  clock = gst_test_clock_new ();
+  test_clock = GST_TEST_CLOCK (clock);
+
+  /* nothing pending, returns after the idle timeout */
+  fail_unless_equals_int (gst_test_clock_fast_forward (test_clock,
+          GST_CLOCK_TIME_NONE, 10 * GST_MSECOND), 0);
+  fail_unless_equals_uint64 (gst_clock_get_time (clock), 0);
+
+  /* a periodic id every 10ms, run through 10 seconds of clock time */
+  clock_id = gst_clock_new_periodic_id (clock, 10 * GST_MSECOND,
+      10 * GST_MSECOND);
+  fail_unless_equals_int (gst_clock_id_wait_async (clock_id,
+          test_count_async_cb, &count, NULL), GST_CLOCK_OK);
+
+  fail_unless_equals_int (gst_test_clock_fast_forward (test_clock,
+          10 * GST_SECOND, GST_SECOND), 1000);
+  fail_unless_equals_int (count, 1000);
+  fail_unless_equals_uint64 (gst_clock_get_time (clock), 10 * GST_SECOND);
+
+  /* the next period is still pending */
+  fail_unless_equals_int (gst_test_clock_peek_id_count (test_clock), 1);
+  fail_unless_equals_uint64 (gst_test_clock_get_next_entry_time (test_clock),
+      10 * GST_SECOND + 10 * GST_MSECOND);
+
+  gst_clock_id_unschedule (clock_id);
+  gst_clock_id_unref (clock_id);
+  gst_object_unref (clock);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_test_clock_suite (void)
 {
@@ -1072,6 +1167,8 @@ gst_test_clock_suite (void)
   tcase_add_test (tc_chain, test_periodic_async);
   tcase_add_test (tc_chain, test_periodic_uniqueness);
   tcase_add_test (tc_chain, test_crank);
+  tcase_add_test (tc_chain, test_set_time_and_process);
+  tcase_add_test (tc_chain, test_fast_forward);
 
   return s;
 }
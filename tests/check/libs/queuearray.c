@@ -262,6 +262,139 @@ GST_START_TEST (test_array_grow_from_prealloc1)
 
 GST_END_TEST;
 
+GST_START_TEST (test_array_push_pop_n)
+{
+  GstQueueArray *array;
+  gpointer in[20], out[20];
+  guint i;
+
+  for (i = 0; i < 20; i++)
+    in[i] = GINT_TO_POINTER (i);
+
+  /* power of 2 size */
+  array = gst_queue_array_new (8);
+
+  /* move head and tail to the middle so that the spans wrap around */
+  gst_queue_array_push_tail_n (array, in, 5);
+  fail_unless_equals_int (gst_queue_array_pop_head_n (array, out, 5), 5);
+  for (i = 0; i < 5; i++)
+    fail_unless_equals_int (GPOINTER_TO_INT (out[i]), i);
+
+  gst_queue_array_push_tail_n (array, in, 6);
+  fail_unless_equals_int (gst_queue_array_get_length (array), 6);
+  for (i = 0; i < 6; i++)
+    fail_unless_equals_int (GPOINTER_TO_INT (gst_queue_array_peek_nth (array,
+                i)), i);
+  fail_unless (gst_queue_array_peek_nth (array, 6) == NULL);
+
+  /* grows while wrapped */
+  gst_queue_array_push_tail_n (array, in + 6, 14);
+  fail_unless_equals_int (gst_queue_array_get_length (array), 20);
+  for (i = 0; i < 20; i++)
+    fail_unless_equals_int (GPOINTER_TO_INT (gst_queue_array_peek_nth (array,
+                i)), i);
+
+  /* single element API keeps working */
+  fail_unless_equals_int (GPOINTER_TO_INT (gst_queue_array_pop_head (array)),
+      0);
+  gst_queue_array_push_tail (array, GINT_TO_POINTER (20));
+
+  fail_unless_equals_int (gst_queue_array_pop_head_n (array, out, 20), 20);
+  for (i = 0; i < 20; i++)
+    fail_unless_equals_int (GPOINTER_TO_INT (out[i]), i + 1);
+  fail_unless_equals_int (gst_queue_array_pop_head_n (array, out, 20), 0);
+  fail_unless (gst_queue_array_is_empty (array));
+
+  gst_queue_array_free (array);
+}
+
+GST_END_TEST;
+
+typedef struct
+{
+  guint64 a;
+  guint32 b;
+} TestStruct;
+
+GST_START_TEST (test_array_struct_n)
+{
+  GstQueueArray *array;
+  TestStruct in[10], out[10], *p;
+  guint i;
+
+  for (i = 0; i < 10; i++) {
+    in[i].a = i;
+    in[i].b = 100 + i;
+  }
+
+  /* not a power of 2 size */
+  array = gst_queue_array_new_for_struct (sizeof (TestStruct), 3);
+
+  gst_queue_array_push_tail_struct (array, &in[0]);
+  gst_queue_array_push_tail_struct (array, &in[1]);
+  fail_unless (gst_queue_array_pop_head_struct (array) != NULL);
+
+  gst_queue_array_push_tail_n (array, in + 2, 8);
+  fail_unless_equals_int (gst_queue_array_get_length (array), 9);
+
+  p = gst_queue_array_peek_nth_struct (array, 8);
+  fail_unless (p != NULL);
+  fail_unless_equals_int (p->b, 109);
+  fail_unless (gst_queue_array_peek_nth_struct (array, 9) == NULL);
+
+  fail_unless_equals_int (gst_queue_array_pop_head_n (array, out, 4), 4);
+  for (i = 0; i < 4; i++) {
+    fail_unless_equals_int (out[i].a, i + 1);
+    fail_unless_equals_int (out[i].b, 101 + i);
+  }
+
+  gst_queue_array_free (array);
+}
+
+GST_END_TEST;
+
+static gint
+compare_test_struct (gconstpointer a, gconstpointer b)
+{
+  const TestStruct *s = a;
+
+  return s->b != GPOINTER_TO_UINT (b);
+}
+
+GST_START_TEST (test_array_struct_find)
+{
+  GstQueueArray *array;
+  TestStruct in, out;
+  guint i, idx;
+
+  array = gst_queue_array_new_for_struct (sizeof (TestStruct), 4);
+
+  /* wrap around */
+  for (i = 0; i < 6; i++) {
+    in.a = i;
+    in.b = 100 + i;
+    gst_queue_array_push_tail_struct (array, &in);
+    if (i < 3)
+      gst_queue_array_pop_head_struct (array);
+  }
+
+  idx = gst_queue_array_find (array, compare_test_struct,
+      GUINT_TO_POINTER (104));
+  fail_unless (idx != -1);
+  fail_unless (gst_queue_array_drop_struct (array, idx, &out));
+  fail_unless_equals_int (out.a, 4);
+  fail_unless_equals_int (gst_queue_array_get_length (array), 2);
+
+  fail_unless_equals_int (gst_queue_array_find (array, compare_test_struct,
+          GUINT_TO_POINTER (104)), -1);
+  fail_unless_equals_int (((TestStruct *)
+          gst_queue_array_peek_nth_struct (array, 1))->b, 105);
+
+  gst_queue_array_free (array);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_queue_array_suite (void)
 {
@@ -277,6 +410,9 @@ gst_queue_array_suite (void)
   tcase_add_test (tc_chain, test_array_grow_end);
   tcase_add_test (tc_chain, test_array_drop2);
   tcase_add_test (tc_chain, test_array_grow_from_prealloc1);
+  tcase_add_test (tc_chain, test_array_push_pop_n);
+  tcase_add_test (tc_chain, test_array_struct_n);
+  tcase_add_test (tc_chain, test_array_struct_find);
 
   return s;
 }
@@ -0,0 +1,136 @@
+/* GStreamer
+ *
+ * unit test for GstScratchArena
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <gst/check/gstcheck.h>
+#include <gst/base/gstscratcharena.h>
+
+GST_START_TEST (test_alloc_release)
+{
+  GstScratchArena *arena;
+  GstScratchArenaMark mark;
+  guint8 *a, *b, *c, *big;
+  gint i;
+
+  arena = gst_scratch_arena_get ();
+  fail_unless (arena != NULL);
+  fail_unless (gst_scratch_arena_get () == arena);
+
+  a = gst_scratch_arena_alloc (arena, 3);
+  fail_unless (a != NULL);
+  fail_unless (GPOINTER_TO_SIZE (a) % 16 == 0);
+  memset (a, 0xaa, 3);
+
+  gst_scratch_arena_mark (arena, &mark);
+  b = gst_scratch_arena_alloc0 (arena, 100);
+  fail_unless (GPOINTER_TO_SIZE (b) % 16 == 0);
+  fail_unless (b >= a + 3);
+  for (i = 0; i < 100; i++)
+    fail_unless_equals_int (b[i], 0);
+
+  /* memory after the mark is reused */
+  gst_scratch_arena_release (arena, &mark);
+  c = gst_scratch_arena_alloc (arena, 100);
+  fail_unless (c == b);
+  fail_unless_equals_int (a[0], 0xaa);
+
+  /* larger than a block, the earlier memory stays valid */
+  gst_scratch_arena_mark (arena, &mark);
+  big = gst_scratch_arena_alloc (arena, 1024 * 1024);
+  memset (big, 0x55, 1024 * 1024);
+  fail_unless_equals_int (a[2], 0xaa);
+  gst_scratch_arena_release (arena, &mark);
+
+  /* and the large block is reused after a reset */
+  gst_scratch_arena_reset (arena);
+  fail_unless (gst_scratch_arena_alloc (arena, 3) == a);
+  c = gst_scratch_arena_alloc (arena, 1024 * 1024);
+  fail_unless (c == big);
+
+  gst_scratch_arena_reset (arena);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_enter_leave)
+{
+  GstScratchArena *arena;
+  GstScratchArenaMark outer, inner;
+  gpointer a, b;
+
+  arena = gst_scratch_arena_get ();
+  gst_scratch_arena_reset (arena);
+
+  /* like an element pushing to a downstream element */
+  gst_scratch_arena_enter (&outer);
+  a = gst_scratch_arena_alloc (arena, 64);
+
+  gst_scratch_arena_enter (&inner);
+  b = gst_scratch_arena_alloc (arena, 64);
+  fail_unless (b != a);
+  gst_scratch_arena_leave (&inner);
+
+  fail_unless (gst_scratch_arena_alloc (arena, 64) == b);
+  gst_scratch_arena_leave (&outer);
+
+  fail_unless (gst_scratch_arena_alloc (arena, 64) == a);
+  gst_scratch_arena_reset (arena);
+}
+
+GST_END_TEST;
+
+static gpointer
+other_thread_func (gpointer data)
+{
+  return gst_scratch_arena_get ();
+}
+
+GST_START_TEST (test_per_thread)
+{
+  GThread *thread;
+  gpointer other;
+
+  thread = g_thread_new ("scratch", other_thread_func, NULL);
+  other = g_thread_join (thread);
+
+  fail_unless (other != NULL);
+  fail_unless (other != gst_scratch_arena_get ());
+}
+
+GST_END_TEST;
+
+static Suite *
+scratch_arena_suite (void)
+{
+  Suite *s = suite_create ("GstScratchArena");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_alloc_release);
+  tcase_add_test (tc_chain, test_enter_leave);
+  tcase_add_test (tc_chain, test_per_thread);
+
+  return s;
+}
+
+GST_CHECK_MAIN (scratch_arena);
@@ -25,6 +25,7 @@
 #endif
 
 #include <glib/gstdio.h>
+#include <fcntl.h>
 
 #include <gst/check/gstcheck.h>
 
@@ -211,6 +212,151 @@ GST_START_TEST (test_write_merge)
 
 GST_END_TEST;
 
+GST_START_TEST (test_many_ranges)
+{
+  GstSparseFile *file;
+  gint fd, i;
+  gchar *name;
+
+  name = g_strdup ("cachefile-testXXXXXX");
+  fd = g_mkstemp (name);
+  fail_if (fd == -1);
+
+  file = gst_sparse_file_new ();
+  gst_sparse_file_set_fd (file, fd);
+
+  /* write every other block of 10 bytes, backwards */
+  for (i = 99; i >= 0; i--)
+    fail_unless (expect_write (file, i * 20, 10, 10, 0));
+  fail_unless (gst_sparse_file_n_ranges (file) == 100);
+
+  for (i = 0; i < 100; i++) {
+    expect_range_before (file, i * 20 + 15, i * 20, i * 20 + 10);
+    expect_range_after (file, i * 20 + 5, i * 20, i * 20 + 10);
+    if (i < 99)
+      expect_range_after (file, i * 20 + 10, i * 20 + 20, i * 20 + 30);
+    fail_unless (expect_read (file, i * 20, 10, 10, 0));
+    fail_unless (expect_read (file, i * 20, 11, 0, 0));
+  }
+
+  /* fill the odd blocks, everything merges */
+  for (i = 0; i < 99; i++)
+    fail_unless (expect_write (file, i * 20 + 10, 10, 10, 10));
+  fail_unless (gst_sparse_file_n_ranges (file) == 1);
+  expect_range_before (file, 1500, 0, 1990);
+  expect_range_after (file, 1500, 0, 1990);
+
+  g_unlink (name);
+  gst_sparse_file_free (file);
+  g_free (name);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_add_range)
+{
+  GstSparseFile *file;
+  GError *error = NULL;
+  guint8 data[100], res[100];
+  gint fd, i;
+  gchar *name;
+
+  for (i = 0; i < 100; i++)
+    data[i] = i;
+
+  name = g_strdup ("cachefile-testXXXXXX");
+  fd = g_mkstemp (name);
+  fail_if (fd == -1);
+
+  file = gst_sparse_file_new ();
+  gst_sparse_file_set_fd (file, fd);
+  fail_unless (gst_sparse_file_write (file, 0, data, 100, NULL, NULL) == 100);
+  fail_unless (gst_sparse_file_write (file, 150, data, 100, NULL,
+          NULL) == 100);
+  gst_sparse_file_free (file);
+
+  /* reopen the file and restore the ranges */
+  fd = g_open (name, O_RDWR, 0);
+  fail_if (fd == -1);
+
+  file = gst_sparse_file_new ();
+  gst_sparse_file_set_fd (file, fd);
+  fail_unless (gst_sparse_file_n_ranges (file) == 0);
+
+  gst_sparse_file_add_range (file, 150, 250);
+  gst_sparse_file_add_range (file, 0, 50);
+  gst_sparse_file_add_range (file, 40, 100);
+  fail_unless (gst_sparse_file_n_ranges (file) == 2);
+  expect_range_after (file, 0, 0, 100);
+  expect_range_after (file, 100, 150, 250);
+
+  fail_unless (gst_sparse_file_read (file, 150, res, 100, NULL,
+          &error) == 100);
+  fail_unless (memcmp (res, data, 100) == 0);
+  fail_unless (gst_sparse_file_read (file, 0, res, 100, NULL, &error) == 100);
+  fail_unless (memcmp (res, data, 100) == 0);
+
+  /* the hole is still missing */
+  fail_unless (expect_read (file, 50, 100, 0, 0));
+
+  g_unlink (name);
+  gst_sparse_file_free (file);
+  g_free (name);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_write_coalesce)
+{
+  GstSparseFile *file;
+  GError *error = NULL;
+  guint8 data[300], res[300];
+  gint fd, i;
+  gchar *name, *contents;
+  gsize length;
+
+  for (i = 0; i < 300; i++)
+    data[i] = i;
+
+  name = g_strdup ("cachefile-testXXXXXX");
+  fd = g_mkstemp (name);
+  fail_if (fd == -1);
+
+  file = gst_sparse_file_new ();
+  gst_sparse_file_set_fd (file, fd);
+
+  /* small adjacent writes */
+  for (i = 0; i < 200; i += 10)
+    fail_unless (gst_sparse_file_write (file, i, data + i, 10, NULL,
+            NULL) == 10);
+  fail_unless (gst_sparse_file_n_ranges (file) == 1);
+
+  /* pending data can be read back */
+  fail_unless (gst_sparse_file_read (file, 20, res, 100, NULL, &error) == 100);
+  fail_unless (memcmp (res, data + 20, 100) == 0);
+
+  /* a write elsewhere and a read across both */
+  fail_unless (gst_sparse_file_write (file, 200, data + 200, 100, NULL,
+          NULL) == 100);
+  fail_unless (gst_sparse_file_read (file, 0, res, 300, NULL, &error) == 300);
+  fail_unless (memcmp (res, data, 300) == 0);
+
+  /* everything is in the file after a flush */
+  fail_unless (gst_sparse_file_write (file, 300, data, 50, NULL, NULL) == 50);
+  fail_unless (gst_sparse_file_flush (file, &error));
+  fail_unless (g_file_get_contents (name, &contents, &length, NULL));
+  fail_unless_equals_int (length, 350);
+  fail_unless (memcmp (contents, data, 300) == 0);
+  fail_unless (memcmp (contents + 300, data, 50) == 0);
+  g_free (contents);
+
+  g_unlink (name);
+  gst_sparse_file_free (file);
+  g_free (name);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_cachefile_suite (void)
 {
@@ -220,6 +366,9 @@ gst_cachefile_suite (void)
   suite_add_tcase (s, tc_chain);
   tcase_add_test (tc_chain, test_write_read);
   tcase_add_test (tc_chain, test_write_merge);
+  tcase_add_test (tc_chain, test_many_ranges);
+  tcase_add_test (tc_chain, test_add_range);
+  tcase_add_test (tc_chain, test_write_coalesce);
 
   return s;
 }
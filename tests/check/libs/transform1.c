@@ -211,6 +211,58 @@ transform_ip_1 (GstBaseTransform * trans, GstBuffer * buf)
   return GST_FLOW_OK;
 }
 
+/* passthrough without vmethods, buffers bypass the element after the first
+ * one until the next event or until the element needs to see them again */
+GST_START_TEST (basetransform_chain_pt_bypass)
+{
+  TestTransData *trans;
+  GstBuffer *buffer;
+  GstPad *sinkpad;
+
+  trans = gst_test_trans_new ();
+  sinkpad = GST_BASE_TRANSFORM_SINK_PAD (trans->trans);
+
+  gst_test_trans_push_segment (trans);
+  fail_if (GST_PAD_IS_BYPASS (sinkpad));
+
+  fail_unless (gst_test_trans_push (trans,
+          gst_buffer_new_and_alloc (20)) == GST_FLOW_OK);
+  fail_unless (GST_PAD_IS_BYPASS (sinkpad));
+
+  fail_unless (gst_test_trans_push (trans,
+          gst_buffer_new_and_alloc (10)) == GST_FLOW_OK);
+  fail_unless (GST_PAD_IS_BYPASS (sinkpad));
+
+  buffer = gst_test_trans_pop (trans);
+  fail_unless (buffer != NULL);
+  fail_unless (gst_buffer_get_size (buffer) == 20);
+  gst_buffer_unref (buffer);
+  buffer = gst_test_trans_pop (trans);
+  fail_unless (buffer != NULL);
+  fail_unless (gst_buffer_get_size (buffer) == 10);
+  gst_buffer_unref (buffer);
+
+  /* events end the bypass */
+  gst_test_trans_push_segment (trans);
+  fail_if (GST_PAD_IS_BYPASS (sinkpad));
+  fail_unless (gst_test_trans_push (trans,
+          gst_buffer_new_and_alloc (10)) == GST_FLOW_OK);
+  fail_unless (GST_PAD_IS_BYPASS (sinkpad));
+  gst_buffer_unref (gst_test_trans_pop (trans));
+
+  /* QoS needs to see all buffers */
+  gst_base_transform_set_qos_enabled (GST_BASE_TRANSFORM (trans->trans), TRUE);
+  fail_if (GST_PAD_IS_BYPASS (sinkpad));
+  fail_unless (gst_test_trans_push (trans,
+          gst_buffer_new_and_alloc (10)) == GST_FLOW_OK);
+  fail_if (GST_PAD_IS_BYPASS (sinkpad));
+  gst_buffer_unref (gst_test_trans_pop (trans));
+
+  gst_test_trans_free (trans);
+}
+
+GST_END_TEST;
+
 /* basic in-place, check if the _ip function is called, buffer should
  * be writable. no setcaps is set */
 GST_START_TEST (basetransform_chain_ip1)
@@ -274,6 +326,84 @@ GST_START_TEST (basetransform_chain_ip1)
 
 GST_END_TEST;
 
+static gint transform_slice_1_mask;
+
+static GstFlowReturn
+transform_slice_1 (GstBaseTransform * trans, GstBuffer * inbuf,
+    GstBuffer * outbuf, guint slice, guint n_slices)
+{
+  GstMapInfo map;
+  gsize offset, size;
+
+  fail_unless (inbuf == outbuf);
+  fail_unless_equals_int (n_slices, 4);
+
+  g_atomic_int_or (&transform_slice_1_mask, 1 << slice);
+
+  /* fill our part of the buffer with the slice number */
+  fail_unless (gst_buffer_map (outbuf, &map, GST_MAP_WRITE));
+  size = map.size / n_slices;
+  offset = slice * size;
+  memset (map.data + offset, slice, size);
+  gst_buffer_unmap (outbuf, &map);
+
+  return GST_FLOW_OK;
+}
+
+/* in-place with slices, check if all slices of the buffer are processed
+ * instead of the _ip function */
+GST_START_TEST (basetransform_chain_ip_slices)
+{
+  TestTransData *trans;
+  GstBuffer *buffer;
+  GstFlowReturn res;
+  GstMapInfo map;
+  guint i;
+
+  klass_transform_ip = transform_ip_1;
+  klass_transform_slice = transform_slice_1;
+  trans = gst_test_trans_new ();
+  g_object_set (trans->trans, "n-threads", 4, NULL);
+
+  gst_test_trans_push_segment (trans);
+
+  buffer = gst_buffer_new_and_alloc (20);
+
+  transform_ip_1_called = FALSE;
+  transform_slice_1_mask = 0;
+  res = gst_test_trans_push (trans, buffer);
+  fail_unless (res == GST_FLOW_OK);
+  fail_unless (transform_ip_1_called == FALSE);
+  fail_unless_equals_int (transform_slice_1_mask, 0xf);
+
+  buffer = gst_test_trans_pop (trans);
+  fail_unless (buffer != NULL);
+  fail_unless (gst_buffer_map (buffer, &map, GST_MAP_READ));
+  for (i = 0; i < 20; i++)
+    fail_unless_equals_int (map.data[i], i / 5);
+  gst_buffer_unmap (buffer, &map);
+  gst_buffer_unref (buffer);
+
+  /* with one thread the _ip function is used again */
+  g_object_set (trans->trans, "n-threads", 1, NULL);
+
+  buffer = gst_buffer_new_and_alloc (20);
+
+  transform_slice_1_mask = 0;
+  res = gst_test_trans_push (trans, buffer);
+  fail_unless (res == GST_FLOW_OK);
+  fail_unless (transform_ip_1_called == TRUE);
+  fail_unless_equals_int (transform_slice_1_mask, 0);
+
+  buffer = gst_test_trans_pop (trans);
+  fail_unless (buffer != NULL);
+  gst_buffer_unref (buffer);
+
+  gst_test_trans_free (trans);
+}
+
+GST_END_TEST;
+
 static gboolean set_caps_1_called;
 
 static gboolean
@@ -890,9 +1020,11 @@ gst_basetransform_suite (void)
   /* pass through */
   tcase_add_test (tc, basetransform_chain_pt1);
   tcase_add_test (tc, basetransform_chain_pt2);
+  tcase_add_test (tc, basetransform_chain_pt_bypass);
   /* in place */
   tcase_add_test (tc, basetransform_chain_ip1);
   tcase_add_test (tc, basetransform_chain_ip2);
+  tcase_add_test (tc, basetransform_chain_ip_slices);
   /* copy transform */
   tcase_add_test (tc, basetransform_chain_ct1);
   tcase_add_test (tc, basetransform_chain_ct2);
@@ -34,6 +34,9 @@ static const guint8 vorbisid[30] = { 0x01, 0x76, 0x6f, 0x72, 0x62, 0x69, 0x73,
 };
 
 static void foobar_typefind (GstTypeFind * tf, gpointer unused);
+static void magic_typefind (GstTypeFind * tf, gpointer unused);
+static void range_typefind (GstTypeFind * tf, gpointer unused);
+static void no_magic_typefind (GstTypeFind * tf, gpointer unused);
 
 static GstStaticCaps foobar_caps = GST_STATIC_CAPS ("foo/x-bar");
 
@@ -72,6 +75,88 @@ GST_START_TEST (test_buffer_range)
 
 GST_END_TEST;
 
+/* functions are only called when their magic matches */
+GST_START_TEST (test_magic)
+{
+  static const guint8 magic[] = { 0x01, 'v', 'o', 'r', 'b', 'i', 's' };
+  static const guint8 no_magic[] = { 'f', 'L', 'a', 'C' };
+  GstBuffer *buf;
+  GstCaps *caps;
+
+  fail_unless (gst_type_find_register_magic (NULL, "foo/x-magic",
+          GST_RANK_PRIMARY + 60, magic_typefind, NULL, NULL, 0, magic,
+          sizeof (magic), NULL, NULL));
+  fail_unless (gst_type_find_register_magic (NULL, "foo/x-no-magic",
+          GST_RANK_PRIMARY + 100, no_magic_typefind, NULL, NULL, 0, no_magic,
+          sizeof (no_magic), NULL, NULL));
+
+  buf = gst_buffer_new_wrapped_full (GST_MEMORY_FLAG_READONLY,
+      (gpointer) vorbisid, 30, 0, 30, NULL, NULL);
+
+  caps = gst_type_find_helper_for_buffer (NULL, buf, NULL);
+  fail_unless (caps != NULL);
+  fail_unless (gst_structure_has_name (gst_caps_get_structure (caps, 0),
+          "foo/x-magic"));
+
+  gst_caps_unref (caps);
+  gst_buffer_unref (buf);
+}
+
+GST_END_TEST;
+
+#define RANGE_SIZE 10000
+
+static guint n_pulls;
+
+static GstFlowReturn
+range_getrange (GstObject * obj, GstObject * parent, guint64 offset,
+    guint length, GstBuffer ** buffer)
+{
+  GstMapInfo map;
+  guint i;
+
+  n_pulls++;
+
+  if (offset >= RANGE_SIZE)
+    return GST_FLOW_EOS;
+
+  length = MIN (length, RANGE_SIZE - offset);
+  *buffer = gst_buffer_new_allocate (NULL, length, NULL);
+  gst_buffer_map (*buffer, &map, GST_MAP_WRITE);
+  for (i = 0; i < length; i++)
+    map.data[i] = (offset + i) & 0xff;
+  gst_buffer_unmap (*buffer, &map);
+  GST_BUFFER_OFFSET (*buffer) = offset;
+
+  return GST_FLOW_OK;
+}
+
+/* overlapping peeks are served from the cache */
+GST_START_TEST (test_get_range_cache)
+{
+  GstObject *obj;
+  GstCaps *caps;
+
+  fail_unless (gst_type_find_register (NULL, "foo/x-range",
+          GST_RANK_PRIMARY + 200, range_typefind, NULL, NULL, NULL, NULL));
+
+  obj = GST_OBJECT (gst_element_factory_make ("identity", NULL));
+  n_pulls = 0;
+
+  caps = gst_type_find_helper_get_range (obj, NULL, range_getrange,
+      RANGE_SIZE, NULL, NULL);
+  fail_unless (caps != NULL);
+  fail_unless (gst_structure_has_name (gst_caps_get_structure (caps, 0),
+          "foo/x-range"));
+  /* the first block, the second block and the last, short, block */
+  fail_unless_equals_int (n_pulls, 3);
+
+  gst_caps_unref (caps);
+  gst_object_unref (obj);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_typefindhelper_suite (void)
 {
@@ -80,6 +165,8 @@ gst_typefindhelper_suite (void)
 
   suite_add_tcase (s, tc_chain);
   tcase_add_test (tc_chain, test_buffer_range);
+  tcase_add_test (tc_chain, test_magic);
+  tcase_add_test (tc_chain, test_get_range_cache);
 
   return s;
 }
@@ -121,3 +208,40 @@ foobar_typefind (GstTypeFind * tf, gpointer unused)
 
   gst_type_find_suggest (tf, GST_TYPE_FIND_MAXIMUM, FOOBAR_CAPS);
 }
+
+static void
+magic_typefind (GstTypeFind * tf, gpointer unused)
+{
+  gst_type_find_suggest_simple (tf, GST_TYPE_FIND_MAXIMUM, "foo/x-magic",
+      NULL);
+}
+
+static void
+no_magic_typefind (GstTypeFind * tf, gpointer unused)
+{
+  fail ("typefind function called for stream without its magic");
+}
+
+static void
+check_range (const guint8 * data, guint64 offset, guint size)
+{
+  guint i;
+
+  fail_unless (data != NULL);
+  for (i = 0; i < size; i++)
+    fail_unless_equals_int (data[i], (offset + i) & 0xff);
+}
+
+static void
+range_typefind (GstTypeFind * tf, gpointer unused)
+{
+  check_range (gst_type_find_peek (tf, 0, 10), 0, 10);
+  check_range (gst_type_find_peek (tf, 5, 10), 5, 10);
+  /* spans the first two blocks */
+  check_range (gst_type_find_peek (tf, 4090, 20), 4090, 20);
+  check_range (gst_type_find_peek (tf, -10, 10), RANGE_SIZE - 10, 10);
+  fail_unless (gst_type_find_peek (tf, 9000, 2000) == NULL);
+
+  gst_type_find_suggest_simple (tf, GST_TYPE_FIND_MAXIMUM, "foo/x-range",
+      NULL);
+}
@@ -709,6 +709,64 @@ GST_START_TEST (test_parsing)
 
 GST_END_TEST;
 
+GST_START_TEST (test_template)
+{
+  GstParseTemplate *templ;
+  GstElement *pipeline, *src, *sink;
+  GError *err = NULL;
+  GstPad *pad, *peer;
+  gint i, num_buffers;
+
+  templ = gst_parse_template_new ("fakesrc name=src num-buffers=5 ! "
+      "video/x-raw ! ( identity ) ! fakesink name=sink sync=false", 0, &err);
+  fail_unless (templ != NULL);
+  fail_unless (err == NULL);
+
+  for (i = 0; i < 3; i++) {
+    pipeline = gst_parse_template_instantiate (templ, &err);
+    fail_unless (pipeline != NULL);
+    fail_unless (err == NULL);
+    fail_unless (GST_IS_PIPELINE (pipeline));
+
+    src = gst_bin_get_by_name (GST_BIN (pipeline), "src");
+    fail_unless (src != NULL);
+    g_object_get (src, "num-buffers", &num_buffers, NULL);
+    fail_unless_equals_int (num_buffers, 5);
+
+    /* the caps filter was kept */
+    pad = gst_element_get_static_pad (src, "src");
+    peer = gst_pad_get_peer (pad);
+    fail_unless (peer != NULL);
+    gst_object_unref (peer);
+    gst_object_unref (pad);
+    gst_object_unref (src);
+
+    sink = gst_bin_get_by_name (GST_BIN (pipeline), "sink");
+    fail_unless (sink != NULL);
+    gst_object_unref (sink);
+
+    fail_unless (gst_element_set_state (pipeline, GST_STATE_PLAYING) !=
+        GST_STATE_CHANGE_FAILURE);
+    fail_unless (gst_element_get_state (pipeline, NULL, NULL,
+            GST_CLOCK_TIME_NONE) == GST_STATE_CHANGE_SUCCESS);
+    gst_element_set_state (pipeline, GST_STATE_NULL);
+    gst_object_unref (pipeline);
+  }
+  gst_parse_template_unref (templ);
+
+  /* errors are always fatal */
+  if (!g_getenv ("GST_DEBUG"))
+    gst_debug_set_default_threshold (GST_LEVEL_NONE);
+
+  templ = gst_parse_template_new ("fakesrc ! coffeesink", 0, &err);
+  fail_unless (templ == NULL);
+  fail_unless (err != NULL);
+  fail_unless_equals_int (err->code, GST_PARSE_ERROR_NO_SUCH_ELEMENT);
+  g_error_free (err);
+}
+
+GST_END_TEST;
+
 static Suite *
 parse_suite (void)
 {
@@ -727,6 +785,7 @@ parse_suite (void)
   tcase_add_test (tc_chain, test_flags);
   tcase_add_test (tc_chain, test_missing_elements);
   tcase_add_test (tc_chain, test_parsing);
+  tcase_add_test (tc_chain, test_template);
   return s;
 }
 
@@ -0,0 +1,847 @@
+/* GStreamer
+ *
+ * gst-launch-stats.c: pipeline statistics for gst-launch
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* The --stats mode of gst-launch. Instead of going through the debug log
+ * like the stats, rusage, proctime, queuelevels and poolstats tracers, an
+ * in-process tracer attaches to the same hooks and keeps the numbers in
+ * memory:
+ *
+ * - buffers and bytes arriving in each sink
+ * - the exclusive processing time of each element, that is the time between
+ *   a push into the element and the return of that push, minus the time
+ *   spent in the elements downstream of it in the same thread
+ * - the cpu time of each streaming thread
+ * - the fill levels and underruns/overruns of queues
+ * - how long buffer pool acquires block, acquires waiting longer than
+ *   STARVED_THRESHOLD are counted as starved
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+/* for gst_tracing_register_hook() */
+#define GST_USE_UNSTABLE_API
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#ifdef HAVE_SYS_RESOURCE_H
+#ifndef __USE_GNU
+# define __USE_GNU              /* RUSAGE_THREAD */
+#endif
+#include <sys/resource.h>
+#endif
+
+#include "tools.h"
+#include "gst-launch-stats.h"
+
+#ifndef GST_DISABLE_GST_TRACER_HOOKS
+
+#define STARVED_THRESHOLD (GST_MSECOND)
+
+#define GST_TYPE_LAUNCH_STATS (gst_launch_stats_get_type ())
+#define GST_LAUNCH_STATS(obj) \
+  (G_TYPE_CHECK_INSTANCE_CAST ((obj), GST_TYPE_LAUNCH_STATS, GstLaunchStats))
+
+typedef struct
+{
+  gchar *name;
+  gboolean is_sink;
+  guint64 buffers, bytes;
+  guint64 last_buffers, last_bytes;
+  guint64 calls;
+  GstClockTime time;
+} ElementStats;
+
+typedef struct
+{
+  gchar *name;
+  GstClockTime cpu;
+  GstClockTime last_cpu;
+} ThreadStats;
+
+typedef struct
+{
+  gchar *name;
+  guint buffers, bytes;
+  guint max_buffers, max_bytes;
+  guint64 time, max_time;
+  guint underruns, overruns, leaks;
+} QueueStats;
+
+typedef struct
+{
+  gchar *name;
+  guint64 acquires, starved;
+  GstClockTime wait, max_wait;
+} PoolStats;
+
+/* an element processing a push in the current thread */
+typedef struct
+{
+  GstElement *element;
+  GstClockTime start;
+  GstClockTime child;
+} Frame;
+
+/* per thread state, only touched from its own thread */
+typedef struct
+{
+  GArray *frames;
+  GstClockTime acquire_ts;
+  ThreadStats *stats;
+} ThreadState;
+
+typedef struct
+{
+  GstTracer parent;
+
+  GMutex lock;
+  GHashTable *elements;
+  GHashTable *threads;
+  GHashTable *queues;
+  GHashTable *pools;
+
+  GstClockTime start;
+  GstClockTime last_report;
+
+  /* periodic reports */
+  GThread *thread;
+  GCond cond;
+  gboolean running;
+  guint interval;
+} GstLaunchStats;
+
+typedef struct
+{
+  GstTracerClass parent_class;
+} GstLaunchStatsClass;
+
+static GType gst_launch_stats_get_type (void);
+G_DEFINE_TYPE (GstLaunchStats, gst_launch_stats, GST_TYPE_TRACER);
+
+static GstLaunchStats *launch_stats;
+
+static void
+thread_state_free (gpointer data)
+{
+  ThreadState *state = data;
+
+  g_array_free (state->frames, TRUE);
+  g_slice_free (ThreadState, state);
+}
+
+static GPrivate thread_state_key = G_PRIVATE_INIT (thread_state_free);
+
+static void
+element_stats_free (gpointer data)
+{
+  ElementStats *stats = data;
+
+  g_free (stats->name);
+  g_slice_free (ElementStats, stats);
+}
+
+static void
+thread_stats_free (gpointer data)
+{
+  ThreadStats *stats = data;
+
+  g_free (stats->name);
+  g_slice_free (ThreadStats, stats);
+}
+
+static void
+queue_stats_free (gpointer data)
+{
+  QueueStats *stats = data;
+
+  g_free (stats->name);
+  g_slice_free (QueueStats, stats);
+}
+
+static void
+pool_stats_free (gpointer data)
+{
+  PoolStats *stats = data;
+
+  g_free (stats->name);
+  g_slice_free (PoolStats, stats);
+}
+
+static GstClockTime
+get_thread_cpu_time (void)
+{
+#if defined (HAVE_CLOCK_GETTIME) && defined (CLOCK_THREAD_CPUTIME_ID)
+  struct timespec now;
+
+  if (!clock_gettime (CLOCK_THREAD_CPUTIME_ID, &now))
+    return GST_TIMESPEC_TO_TIME (now);
+#endif
+#ifdef RUSAGE_THREAD
+  {
+    struct rusage ru;
+
+    if (!getrusage (RUSAGE_THREAD, &ru))
+      return GST_TIMEVAL_TO_TIME (ru.ru_utime) +
+          GST_TIMEVAL_TO_TIME (ru.ru_stime);
+  }
+#endif
+  return GST_CLOCK_TIME_NONE;
+}
+
+/* the element owning @pad, looking through ghost pads */
+static GstElement *
+get_pad_element (GstPad * pad)
+{
+  GstObject *parent;
+
+  if (pad == NULL)
+    return NULL;
+
+  parent = GST_OBJECT_PARENT (pad);
+  if (parent && GST_IS_PAD (parent))
+    parent = GST_OBJECT_PARENT (parent);
+
+  return (parent && GST_IS_ELEMENT (parent)) ? GST_ELEMENT_CAST (parent) :
+      NULL;
+}
+
+/* call with the lock */
+static ElementStats *
+get_element_stats (GstLaunchStats * self, GstElement * element)
+{
+  ElementStats *stats = g_hash_table_lookup (self->elements, element);
+
+  if (stats == NULL) {
+    stats = g_slice_new0 (ElementStats);
+    stats->name = gst_object_get_name (GST_OBJECT_CAST (element));
+    stats->is_sink = GST_OBJECT_FLAG_IS_SET (element, GST_ELEMENT_FLAG_SINK)
+        && !GST_IS_BIN (element);
+    g_hash_table_insert (self->elements, element, stats);
+  }
+  return stats;
+}
+
+static ThreadState *
+get_thread_state (GstLaunchStats * self, GstPad * pad)
+{
+  ThreadState *state = g_private_get (&thread_state_key);
+  GstClockTime cpu;
+
+  if (state == NULL) {
+    GstElement *element = get_pad_element (pad);
+
+    state = g_slice_new0 (ThreadState);
+    state->frames = g_array_new (FALSE, FALSE, sizeof (Frame));
+    state->stats = g_slice_new0 (ThreadStats);
+    /* name the thread after the element that first pushed from it, which
+     * is the one running the task */
+    if (element)
+      state->stats->name = g_strdup_printf ("%s:%s",
+          GST_OBJECT_NAME (element), GST_OBJECT_NAME (pad));
+    else
+      state->stats->name = g_strdup_printf ("%p", g_thread_self ());
+    g_private_set (&thread_state_key, state);
+
+    g_mutex_lock (&self->lock);
+    g_hash_table_insert (self->threads, g_thread_self (), state->stats);
+    g_mutex_unlock (&self->lock);
+  }
+
+  cpu = get_thread_cpu_time ();
+  if (GST_CLOCK_TIME_IS_VALID (cpu))
+    state->stats->cpu = cpu;
+
+  return state;
+}
+
+static void
+push_enter (GstLaunchStats * self, GstClockTime ts, GstPad * pad,
+    guint buffers, gsize bytes)
+{
+  ThreadState *state = get_thread_state (self, pad);
+  Frame frame;
+
+  frame.element = get_pad_element (GST_PAD_PEER (pad));
+  frame.start = ts;
+  frame.child = 0;
+  g_array_append_val (state->frames, frame);
+
+  if (frame.element) {
+    ElementStats *stats;
+
+    g_mutex_lock (&self->lock);
+    stats = get_element_stats (self, frame.element);
+    if (stats->is_sink) {
+      stats->buffers += buffers;
+      stats->bytes += bytes;
+    }
+    g_mutex_unlock (&self->lock);
+  }
+}
+
+static void
+push_leave (GstLaunchStats * self, GstClockTime ts, GstPad * pad)
+{
+  ThreadState *state = get_thread_state (self, pad);
+  GstClockTime incl, excl;
+  Frame *frame;
+
+  if (state->frames->len == 0)
+    return;
+
+  frame = &g_array_index (state->frames, Frame, state->frames->len - 1);
+  incl = ts > frame->start ? ts - frame->start : 0;
+  excl = incl > frame->child ? incl - frame->child : 0;
+
+  if (frame->element && !GST_IS_BIN (frame->element)) {
+    ElementStats *stats;
+
+    g_mutex_lock (&self->lock);
+    stats = get_element_stats (self, frame->element);
+    stats->time += excl;
+    stats->calls++;
+    g_mutex_unlock (&self->lock);
+  }
+
+  g_array_set_size (state->frames, state->frames->len - 1);
+  if (state->frames->len > 0)
+    g_array_index (state->frames, Frame, state->frames->len - 1).child += incl;
+}
+
+static void
+do_push_buffer_pre (GstLaunchStats * self, GstClockTime ts, GstPad * pad,
+    GstBuffer * buffer)
+{
+  push_enter (self, ts, pad, 1, gst_buffer_get_size (buffer));
+}
+
+static void
+do_push_buffer_list_pre (GstLaunchStats * self, GstClockTime ts,
+    GstPad * pad, GstBufferList * list)
+{
+  guint i, len = gst_buffer_list_length (list);
+  gsize bytes = 0;
+
+  for (i = 0; i < len; i++)
+    bytes += gst_buffer_get_size (gst_buffer_list_get (list, i));
+
+  push_enter (self, ts, pad, len, bytes);
+}
+
+static void
+do_push_buffer_post (GstLaunchStats * self, GstClockTime ts, GstPad * pad,
+    GstFlowReturn res)
+{
+  push_leave (self, ts, pad);
+}
+
+static void
+do_pull_range_pre (GstLaunchStats * self, GstClockTime ts, GstPad * pad,
+    guint64 offset, guint size)
+{
+  ThreadState *state = get_thread_state (self, pad);
+  Frame frame;
+
+  /* the upstream element is doing the work */
+  frame.element = get_pad_element (GST_PAD_PEER (pad));
+  frame.start = ts;
+  frame.child = 0;
+  g_array_append_val (state->frames, frame);
+}
+
+static void
+do_pull_range_post (GstLaunchStats * self, GstClockTime ts, GstPad * pad,
+    GstBuffer * buffer, GstFlowReturn res)
+{
+  GstElement *element = get_pad_element (pad);
+
+  push_leave (self, ts, pad);
+
+  if (buffer && element) {
+    ElementStats *stats;
+
+    g_mutex_lock (&self->lock);
+    stats = get_element_stats (self, element);
+    if (stats->is_sink) {
+      stats->buffers++;
+      stats->bytes += gst_buffer_get_size (buffer);
+    }
+    g_mutex_unlock (&self->lock);
+  }
+}
+
+/* call with the lock */
+static QueueStats *
+get_queue_stats (GstLaunchStats * self, GstElement * queue)
+{
+  QueueStats *stats = g_hash_table_lookup (self->queues, queue);
+
+  if (stats == NULL) {
+    stats = g_slice_new0 (QueueStats);
+    stats->name = gst_object_get_name (GST_OBJECT_CAST (queue));
+    g_hash_table_insert (self->queues, queue, stats);
+  }
+  return stats;
+}
+
+static void
+do_queue_level (GstLaunchStats * self, GstClockTime ts, GstElement * queue,
+    GstPad * pad, guint buffers, guint bytes, guint64 time)
+{
+  QueueStats *stats;
+
+  g_mutex_lock (&self->lock);
+  stats = get_queue_stats (self, queue);
+  stats->buffers = buffers;
+  stats->bytes = bytes;
+  stats->time = time;
+  stats->max_buffers = MAX (stats->max_buffers, buffers);
+  stats->max_bytes = MAX (stats->max_bytes, bytes);
+  stats->max_time = MAX (stats->max_time, time);
+  g_mutex_unlock (&self->lock);
+}
+
+static void
+do_queue_underrun (GstLaunchStats * self, GstClockTime ts,
+    GstElement * queue, GstPad * pad)
+{
+  g_mutex_lock (&self->lock);
+  get_queue_stats (self, queue)->underruns++;
+  g_mutex_unlock (&self->lock);
+}
+
+static void
+do_queue_overrun (GstLaunchStats * self, GstClockTime ts,
+    GstElement * queue, GstPad * pad)
+{
+  g_mutex_lock (&self->lock);
+  get_queue_stats (self, queue)->overruns++;
+  g_mutex_unlock (&self->lock);
+}
+
+static void
+do_queue_leak (GstLaunchStats * self, GstClockTime ts, GstElement * queue,
+    GstPad * pad, GstMiniObject * item)
+{
+  g_mutex_lock (&self->lock);
+  get_queue_stats (self, queue)->leaks++;
+  g_mutex_unlock (&self->lock);
+}
+
+static void
+do_pool_acquire_pre (GstLaunchStats * self, GstClockTime ts,
+    GstBufferPool * pool)
+{
+  get_thread_state (self, NULL)->acquire_ts = ts;
+}
+
+static void
+do_pool_acquire_post (GstLaunchStats * self, GstClockTime ts,
+    GstBufferPool * pool, GstBuffer * buffer, GstFlowReturn res)
+{
+  ThreadState *state = get_thread_state (self, NULL);
+  GstClockTime wait;
+  PoolStats *stats;
+
+  wait = ts > state->acquire_ts ? ts - state->acquire_ts : 0;
+
+  g_mutex_lock (&self->lock);
+  stats = g_hash_table_lookup (self->pools, pool);
+  if (stats == NULL) {
+    stats = g_slice_new0 (PoolStats);
+    stats->name = gst_object_get_name (GST_OBJECT_CAST (pool));
+    g_hash_table_insert (self->pools, pool, stats);
+  }
+  stats->acquires++;
+  stats->wait += wait;
+  stats->max_wait = MAX (stats->max_wait, wait);
+  if (wait > STARVED_THRESHOLD)
+    stats->starved++;
+  g_mutex_unlock (&self->lock);
+}
+
+static gdouble
+rate (guint64 val, GstClockTime duration)
+{
+  return duration > 0 ? (gdouble) val * GST_SECOND / duration : 0.0;
+}
+
+/* call with the lock */
+static void
+print_report (GstLaunchStats * self, GstClockTime now, gboolean final)
+{
+  GstClockTime duration, since;
+  GHashTableIter iter;
+  gpointer value;
+
+  duration = now - self->start;
+  since = final ? duration : now - self->last_report;
+
+  g_print (final ? _("Statistics after %" GST_TIME_FORMAT ":\n") :
+      _("Statistics at %" GST_TIME_FORMAT ":\n"), GST_TIME_ARGS (duration));
+
+  g_hash_table_iter_init (&iter, self->elements);
+  while (g_hash_table_iter_next (&iter, NULL, &value)) {
+    ElementStats *stats = value;
+
+    if (!stats->is_sink)
+      continue;
+    if (final) {
+      g_print ("  sink %s: %" G_GUINT64_FORMAT " buffers, %" G_GUINT64_FORMAT
+          " bytes, %.1f buffers/s, %.1f bytes/s\n", stats->name,
+          stats->buffers, stats->bytes, rate (stats->buffers, since),
+          rate (stats->bytes, since));
+    } else {
+      g_print ("  sink %s: %.1f buffers/s, %.1f bytes/s\n", stats->name,
+          rate (stats->buffers - stats->last_buffers, since),
+          rate (stats->bytes - stats->last_bytes, since));
+      stats->last_buffers = stats->buffers;
+      stats->last_bytes = stats->bytes;
+    }
+  }
+
+  g_hash_table_iter_init (&iter, self->threads);
+  while (g_hash_table_iter_next (&iter, NULL, &value)) {
+    ThreadStats *stats = value;
+    GstClockTime cpu = final ? stats->cpu : stats->cpu - stats->last_cpu;
+
+    g_print ("  thread %s: cpu %" GST_TIME_FORMAT " (%.1f%%)\n", stats->name,
+        GST_TIME_ARGS (cpu), rate (cpu, since) * 100.0 / GST_SECOND);
+    stats->last_cpu = stats->cpu;
+  }
+
+  g_hash_table_iter_init (&iter, self->queues);
+  while (g_hash_table_iter_next (&iter, NULL, &value)) {
+    QueueStats *stats = value;
+
+    g_print ("  queue %s: %u buffers, %u bytes, %" GST_TIME_FORMAT
+        " (max %u buffers, %u bytes, %" GST_TIME_FORMAT "), %u underruns, "
+        "%u overruns, %u leaked\n", stats->name, stats->buffers, stats->bytes,
+        GST_TIME_ARGS (stats->time), stats->max_buffers, stats->max_bytes,
+        GST_TIME_ARGS (stats->max_time), stats->underruns, stats->overruns,
+        stats->leaks);
+  }
+
+  if (!final)
+    return;
+
+  g_hash_table_iter_init (&iter, self->elements);
+  while (g_hash_table_iter_next (&iter, NULL, &value)) {
+    ElementStats *stats = value;
+
+    if (stats->calls == 0)
+      continue;
+    g_print ("  element %s: %" GST_TIME_FORMAT " processing (%.1f%%), %"
+        G_GUINT64_FORMAT " calls, %" G_GUINT64_FORMAT " ns/call\n",
+        stats->name, GST_TIME_ARGS (stats->time),
+        rate (stats->time, duration) * 100.0 / GST_SECOND, stats->calls,
+        stats->time / stats->calls);
+  }
+
+  g_hash_table_iter_init (&iter, self->pools);
+  while (g_hash_table_iter_next (&iter, NULL, &value)) {
+    PoolStats *stats = value;
+
+    g_print ("  pool %s: %" G_GUINT64_FORMAT " acquires, %" G_GUINT64_FORMAT
+        " starved, waited %" GST_TIME_FORMAT " (max %" GST_TIME_FORMAT ")\n",
+        stats->name, stats->acquires, stats->starved,
+        GST_TIME_ARGS (stats->wait), GST_TIME_ARGS (stats->max_wait));
+  }
+}
+
+static void
+json_append_name (GString * json, const gchar * name)
+{
+  gchar *escaped = g_strescape (name, NULL);
+
+  g_string_append_printf (json, "{\"name\": \"%s\"", escaped);
+  g_free (escaped);
+}
+
+static void
+json_append_double (GString * json, const gchar * name, gdouble val)
+{
+  gchar buf[G_ASCII_DTOSTR_BUF_SIZE];
+
+  g_string_append_printf (json, ", \"%s\": %s", name,
+      g_ascii_formatd (buf, sizeof (buf), "%.2f", val));
+}
+
+/* call with the lock */
+static gchar *
+make_json (GstLaunchStats * self, GstClockTime now)
+{
+  GstClockTime duration = now - self->start;
+  GHashTableIter iter;
+  gpointer value;
+  GString *json;
+  const gchar *sep;
+
+  json = g_string_new ("{\n");
+  g_string_append_printf (json, "  \"duration\": %" G_GUINT64_FORMAT ",\n",
+      duration);
+
+  g_string_append (json, "  \"sinks\": [");
+  sep = "";
+  g_hash_table_iter_init (&iter, self->elements);
+  while (g_hash_table_iter_next (&iter, NULL, &value)) {
+    ElementStats *stats = value;
+
+    if (!stats->is_sink)
+      continue;
+    g_string_append_printf (json, "%s\n    ", sep);
+    json_append_name (json, stats->name);
+    g_string_append_printf (json, ", \"buffers\": %" G_GUINT64_FORMAT
+        ", \"bytes\": %" G_GUINT64_FORMAT, stats->buffers, stats->bytes);
+    json_append_double (json, "buffers-per-second",
+        rate (stats->buffers, duration));
+    json_append_double (json, "bytes-per-second",
+        rate (stats->bytes, duration));
+    g_string_append (json, "}");
+    sep = ",";
+  }
+
+  g_string_append (json, "\n  ],\n  \"elements\": [");
+  sep = "";
+  g_hash_table_iter_init (&iter, self->elements);
+  while (g_hash_table_iter_next (&iter, NULL, &value)) {
+    ElementStats *stats = value;
+
+    if (stats->calls == 0)
+      continue;
+    g_string_append_printf (json, "%s\n    ", sep);
+    json_append_name (json, stats->name);
+    g_string_append_printf (json, ", \"time\": %" G_GUINT64_FORMAT
+        ", \"calls\": %" G_GUINT64_FORMAT "}", stats->time, stats->calls);
+    sep = ",";
+  }
+
+  g_string_append (json, "\n  ],\n  \"threads\": [");
+  sep = "";
+  g_hash_table_iter_init (&iter, self->threads);
+  while (g_hash_table_iter_next (&iter, NULL, &value)) {
+    ThreadStats *stats = value;
+
+    g_string_append_printf (json, "%s\n    ", sep);
+    json_append_name (json, stats->name);
+    g_string_append_printf (json, ", \"cpu-time\": %" G_GUINT64_FORMAT "}",
+        stats->cpu);
+    sep = ",";
+  }
+
+  g_string_append (json, "\n  ],\n  \"queues\": [");
+  sep = "";
+  g_hash_table_iter_init (&iter, self->queues);
+  while (g_hash_table_iter_next (&iter, NULL, &value)) {
+    QueueStats *stats = value;
+
+    g_string_append_printf (json, "%s\n    ", sep);
+    json_append_name (json, stats->name);
+    g_string_append_printf (json, ", \"max-buffers\": %u, \"max-bytes\": %u"
+        ", \"max-time\": %" G_GUINT64_FORMAT ", \"underruns\": %u"
+        ", \"overruns\": %u, \"leaks\": %u}", stats->max_buffers,
+        stats->max_bytes, stats->max_time, stats->underruns, stats->overruns,
+        stats->leaks);
+    sep = ",";
+  }
+
+  g_string_append (json, "\n  ],\n  \"pools\": [");
+  sep = "";
+  g_hash_table_iter_init (&iter, self->pools);
+  while (g_hash_table_iter_next (&iter, NULL, &value)) {
+    PoolStats *stats = value;
+
+    g_string_append_printf (json, "%s\n    ", sep);
+    json_append_name (json, stats->name);
+    g_string_append_printf (json, ", \"acquires\": %" G_GUINT64_FORMAT
+        ", \"starved\": %" G_GUINT64_FORMAT ", \"wait\": %" G_GUINT64_FORMAT
+        ", \"max-wait\": %" G_GUINT64_FORMAT "}", stats->acquires,
+        stats->starved, stats->wait, stats->max_wait);
+    sep = ",";
+  }
+  g_string_append (json, "\n  ]\n}\n");
+
+  return g_string_free (json, FALSE);
+}
+
+static gpointer
+report_thread (gpointer data)
+{
+  GstLaunchStats *self = data;
+  gint64 end_time;
+
+  g_mutex_lock (&self->lock);
+  end_time = g_get_monotonic_time () + self->interval * G_TIME_SPAN_SECOND;
+  while (self->running) {
+    if (!g_cond_wait_until (&self->cond, &self->lock, end_time)) {
+      GstClockTime now = gst_util_get_timestamp ();
+
+      print_report (self, now, FALSE);
+      self->last_report = now;
+      end_time += self->interval * G_TIME_SPAN_SECOND;
+    }
+  }
+  g_mutex_unlock (&self->lock);
+
+  return NULL;
+}
+
+static void
+gst_launch_stats_finalize (GObject * object)
+{
+  GstLaunchStats *self = GST_LAUNCH_STATS (object);
+
+  g_hash_table_destroy (self->elements);
+  g_hash_table_destroy (self->threads);
+  g_hash_table_destroy (self->queues);
+  g_hash_table_destroy (self->pools);
+  g_mutex_clear (&self->lock);
+  g_cond_clear (&self->cond);
+
+  G_OBJECT_CLASS (gst_launch_stats_parent_class)->finalize (object);
+}
+
+static void
+gst_launch_stats_class_init (GstLaunchStatsClass * klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+  gobject_class->finalize = gst_launch_stats_finalize;
+}
+
+static void
+gst_launch_stats_init (GstLaunchStats * self)
+{
+  GstTracer *tracer = GST_TRACER (self);
+
+  g_mutex_init (&self->lock);
+  g_cond_init (&self->cond);
+  self->elements = g_hash_table_new_full (NULL, NULL, NULL,
+      element_stats_free);
+  self->threads = g_hash_table_new_full (NULL, NULL, NULL, thread_stats_free);
+  self->queues = g_hash_table_new_full (NULL, NULL, NULL, queue_stats_free);
+  self->pools = g_hash_table_new_full (NULL, NULL, NULL, pool_stats_free);
+
+  gst_tracing_register_hook (tracer, "pad-push-pre",
+      G_CALLBACK (do_push_buffer_pre));
+  gst_tracing_register_hook (tracer, "pad-push-list-pre",
+      G_CALLBACK (do_push_buffer_list_pre));
+  gst_tracing_register_hook (tracer, "pad-push-post",
+      G_CALLBACK (do_push_buffer_post));
+  gst_tracing_register_hook (tracer, "pad-push-list-post",
+      G_CALLBACK (do_push_buffer_post));
+  gst_tracing_register_hook (tracer, "pad-pull-range-pre",
+      G_CALLBACK (do_pull_range_pre));
+  gst_tracing_register_hook (tracer, "pad-pull-range-post",
+      G_CALLBACK (do_pull_range_post));
+  gst_tracing_register_hook (tracer, "queue-enqueue",
+      G_CALLBACK (do_queue_level));
+  gst_tracing_register_hook (tracer, "queue-dequeue",
+      G_CALLBACK (do_queue_level));
+  gst_tracing_register_hook (tracer, "queue-underrun",
+      G_CALLBACK (do_queue_underrun));
+  gst_tracing_register_hook (tracer, "queue-overrun",
+      G_CALLBACK (do_queue_overrun));
+  gst_tracing_register_hook (tracer, "queue-leak",
+      G_CALLBACK (do_queue_leak));
+  gst_tracing_register_hook (tracer, "buffer-pool-acquire-pre",
+      G_CALLBACK (do_pool_acquire_pre));
+  gst_tracing_register_hook (tracer, "buffer-pool-acquire-post",
+      G_CALLBACK (do_pool_acquire_post));
+}
+
+gboolean
+gst_launch_stats_start (guint interval)
+{
+  g_return_val_if_fail (launch_stats == NULL, FALSE);
+
+  /* the hooks keep a ref, which is dropped in gst_deinit() */
+  launch_stats = g_object_new (GST_TYPE_LAUNCH_STATS, NULL);
+  launch_stats->start = launch_stats->last_report = gst_util_get_timestamp ();
+  launch_stats->interval = interval;
+
+  if (interval > 0) {
+    launch_stats->running = TRUE;
+    launch_stats->thread = g_thread_new ("gst-launch-stats", report_thread,
+        launch_stats);
+  }
+
+  return TRUE;
+}
+
+void
+gst_launch_stats_stop (const gchar * json_file)
+{
+  GstLaunchStats *self = launch_stats;
+  GstClockTime now;
+  gchar *json = NULL;
+
+  if (self == NULL)
+    return;
+
+  if (self->thread) {
+    g_mutex_lock (&self->lock);
+    self->running = FALSE;
+    g_cond_signal (&self->cond);
+    g_mutex_unlock (&self->lock);
+    g_thread_join (self->thread);
+    self->thread = NULL;
+  }
+
+  now = gst_util_get_timestamp ();
+  g_mutex_lock (&self->lock);
+  print_report (self, now, TRUE);
+  if (json_file)
+    json = make_json (self, now);
+  g_mutex_unlock (&self->lock);
+
+  if (json) {
+    GError *err = NULL;
+
+    if (!g_file_set_contents (json_file, json, -1, &err)) {
+      g_printerr (_("Could not write statistics to %s: %s\n"), json_file,
+          err->message);
+      g_clear_error (&err);
+    }
+    g_free (json);
+  }
+
+  gst_object_unref (self);
+  launch_stats = NULL;
+}
+
+#else /* GST_DISABLE_GST_TRACER_HOOKS */
+
+gboolean
+gst_launch_stats_start (guint interval)
+{
+  g_printerr (_("Statistics are not available, tracer hooks are disabled\n"));
+  return FALSE;
+}
+
+void
+gst_launch_stats_stop (const gchar * json_file)
+{
+}
+
+#endif /* GST_DISABLE_GST_TRACER_HOOKS */
@@ -41,6 +41,7 @@
 #endif
 #include <locale.h>             /* for LC_ALL */
 #include "tools.h"
+#include "gst-launch-stats.h"
 
 extern volatile gboolean glib_on_error_halt;
 
@@ -909,6 +910,9 @@ main (int argc, char *argv[])
   gboolean verbose = FALSE;
   gboolean no_fault = FALSE;
   gboolean eos_on_shutdown = FALSE;
+  gboolean stats = FALSE;
+  gint stats_interval = 5;
+  gchar *stats_json = NULL;
 #if 0
   gboolean check_index = FALSE;
 #endif
@@ -934,6 +938,16 @@ main (int argc, char *argv[])
         N_("Do not install a fault handler"), NULL},
     {"eos-on-shutdown", 'e', 0, G_OPTION_ARG_NONE, &eos_on_shutdown,
         N_("Force EOS on sources before shutting the pipeline down"), NULL},
+    {"stats", 0, 0, G_OPTION_ARG_NONE, &stats,
+          N_("Gather and print pipeline statistics (throughput, processing "
+              "time, cpu usage, queue levels, buffer pool starvation)"), NULL},
+    {"stats-interval", 0, 0, G_OPTION_ARG_INT, &stats_interval,
+          N_("Print statistics every SECONDS seconds when --stats is used, "
+              "0 to only print them on exit (default: 5)"),
+        N_("SECONDS")},
+    {"stats-json", 0, 0, G_OPTION_ARG_FILENAME, &stats_json,
+          N_("Also write the statistics to FILE as JSON (implies --stats)"),
+        N_("FILE")},
 #if 0
     {"index", 'i', 0, G_OPTION_ARG_NONE, &check_index,
         N_("Gather and print index statistics"), NULL},
@@ -1056,6 +1070,9 @@ main (int argc, char *argv[])
     gst_bus_set_sync_handler (bus, bus_sync_handler, (gpointer) pipeline, NULL);
     gst_object_unref (bus);
 
+    if (stats || stats_json)
+      gst_launch_stats_start (MAX (stats_interval, 0));
+
     PRINT (_("Setting pipeline to PAUSED ...\n"));
     ret = gst_element_set_state (pipeline, GST_STATE_PAUSED);
 
@@ -1155,6 +1172,7 @@ main (int argc, char *argv[])
 
       PRINT (_("Execution ended after %" GST_TIME_FORMAT "\n"),
           GST_TIME_ARGS (diff));
+      gst_launch_stats_stop (stats_json);
     }
 
     PRINT (_("Setting pipeline to PAUSED ...\n"));
@@ -1181,6 +1199,9 @@ main (int argc, char *argv[])
 #endif
 
   end:
+    /* in case we bailed out early */
+    gst_launch_stats_stop (stats_json);
+
     PRINT (_("Setting pipeline to NULL ...\n"));
     gst_element_set_state (pipeline, GST_STATE_NULL);
   }
@@ -1190,5 +1211,7 @@ main (int argc, char *argv[])
 
   gst_deinit ();
 
+  g_free (stats_json);
+
   return res;
 }
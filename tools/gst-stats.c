@@ -29,10 +29,6 @@
 
 #include "tools.h"
 
-/* log parser */
-static GRegex *raw_log = NULL;
-static GRegex *ansi_log = NULL;
-
 /* global statistics */
 static GHashTable *threads = NULL;
 static GPtrArray *elements = NULL;
@@ -88,6 +84,32 @@ typedef struct
   guint cpuload;
 } GstThreadStats;
 
+/* startup timeline, see the startup tracer */
+static GHashTable *startup_pipelines = NULL;
+static GHashTable *startup_elements = NULL;
+static GPtrArray *startup_plugins = NULL;
+
+typedef struct
+{
+  GstClockTime ts, duration, self;
+  /* element or plugin name */
+  gchar *name;
+  /* state change or mark */
+  gchar *what;
+} GstStartupEntry;
+
+typedef struct
+{
+  gchar *name;
+  GPtrArray *states, *marks;
+} GstStartupPipeline;
+
+typedef struct
+{
+  GstClockTime ts;
+  gchar *label;
+} GstStartupStep;
+
 /* stats helper */
 
 static void
@@ -409,6 +431,101 @@ do_proc_rusage_stats (GstStructure * s)
   have_cpuload = TRUE;
 }
 
+static GstStartupEntry *
+new_startup_entry (GstStructure * s, const gchar * name_field)
+{
+  GstStartupEntry *entry = g_slice_new0 (GstStartupEntry);
+
+  gst_structure_get (s, "ts", G_TYPE_UINT64, &entry->ts,
+      name_field, G_TYPE_STRING, &entry->name, NULL);
+  if (!entry->name)
+    entry->name = g_strdup ("");
+  last_ts = MAX (last_ts, entry->ts);
+  return entry;
+}
+
+static void
+free_startup_entry (gpointer data)
+{
+  GstStartupEntry *entry = data;
+
+  g_free (entry->name);
+  g_free (entry->what);
+  g_slice_free (GstStartupEntry, entry);
+}
+
+static void
+free_startup_pipeline (gpointer data)
+{
+  GstStartupPipeline *pipeline = data;
+
+  g_free (pipeline->name);
+  g_ptr_array_free (pipeline->states, TRUE);
+  g_ptr_array_free (pipeline->marks, TRUE);
+  g_slice_free (GstStartupPipeline, pipeline);
+}
+
+static GstStartupPipeline *
+get_startup_pipeline (GstStructure * s)
+{
+  GstStartupPipeline *pipeline;
+  const gchar *name = gst_structure_get_string (s, "pipeline");
+
+  if (!name)
+    name = "";
+
+  pipeline = g_hash_table_lookup (startup_pipelines, name);
+  if (G_UNLIKELY (!pipeline)) {
+    pipeline = g_slice_new0 (GstStartupPipeline);
+    pipeline->name = g_strdup (name);
+    pipeline->states = g_ptr_array_new_with_free_func (free_startup_entry);
+    pipeline->marks = g_ptr_array_new_with_free_func (free_startup_entry);
+    g_hash_table_insert (startup_pipelines, pipeline->name, pipeline);
+  }
+  return pipeline;
+}
+
+static void
+do_startup_plugin_stats (GstStructure * s)
+{
+  GstStartupEntry *entry = new_startup_entry (s, "plugin");
+
+  gst_structure_get (s, "duration", G_TYPE_UINT64, &entry->duration, NULL);
+  g_ptr_array_add (startup_plugins, entry);
+}
+
+static void
+do_startup_element_stats (GstStructure * s)
+{
+  GstStartupEntry *entry = new_startup_entry (s, "element");
+
+  /* element names are reused, keep the latest one */
+  g_hash_table_replace (startup_elements, entry->name, entry);
+}
+
+static void
+do_startup_state_stats (GstStructure * s)
+{
+  GstStartupEntry *entry = new_startup_entry (s, "element");
+
+  gst_structure_get (s, "duration", G_TYPE_UINT64, &entry->duration,
+      "self", G_TYPE_UINT64, &entry->self,
+      "transition", G_TYPE_STRING, &entry->what, NULL);
+  if (!entry->what)
+    entry->what = g_strdup ("");
+  g_ptr_array_add (get_startup_pipeline (s)->states, entry);
+}
+
+static void
+do_startup_mark_stats (GstStructure * s)
+{
+  GstStartupEntry *entry = new_startup_entry (s, "element");
+
+  if (!gst_structure_get (s, "mark", G_TYPE_STRING, &entry->what, NULL))
+    entry->what = g_strdup ("");
+  g_ptr_array_add (get_startup_pipeline (s)->marks, entry);
+}
+
 /* reporting */
 
 static gint
@@ -617,56 +734,252 @@ process_leaf_bins (gpointer key, gpointer value, gpointer user_data)
   return FALSE;
 }
 
-/* main */
+static gint
+sort_startup_entry_by_duration (gconstpointer e1, gconstpointer e2)
+{
+  const GstStartupEntry *entry1 = *(const GstStartupEntry **) e1;
+  const GstStartupEntry *entry2 = *(const GstStartupEntry **) e2;
 
-static gboolean
-init (void)
+  return (entry2->duration > entry1->duration) -
+      (entry2->duration < entry1->duration);
+}
+
+static gint
+sort_startup_entry_by_self (gconstpointer e1, gconstpointer e2)
 {
-  /* compile the parser regexps */
-  /* 0:00:00.004925027 31586      0x1c5c600 DEBUG           GST_REGISTRY gstregistry.c:463:gst_registry_add_plugin:<registry0> adding plugin 0x1c79160 for filename "/usr/lib/gstreamer-1.0/libgstxxx.so" */
-  raw_log = g_regex_new (
-      /* 1: ts */
-      "^([0-9:.]+) +"
-      /* 2: pid */
-      "([0-9]+) +"
-      /* 3: thread */
-      "(0x[0-9a-fA-F]+) +"
-      /* 4: level */
-      "([A-Z]+) +"
-      /* 5: category */
-      "([a-zA-Z_-]+) +"
-      /* 6: file:line:func: */
-      "([^:]*:[0-9]+:[^:]*:) +"
-      /* 7: (obj)? log-text */
-      "(.*)$", 0, 0, NULL);
-  if (!raw_log) {
-    GST_WARNING ("failed to compile the 'raw' parser");
-    return FALSE;
+  const GstStartupEntry *entry1 = *(const GstStartupEntry **) e1;
+  const GstStartupEntry *entry2 = *(const GstStartupEntry **) e2;
+
+  return (entry2->self > entry1->self) - (entry2->self < entry1->self);
+}
+
+static gint
+sort_startup_steps (gconstpointer s1, gconstpointer s2)
+{
+  const GstStartupStep *step1 = s1;
+  const GstStartupStep *step2 = s2;
+
+  return (step1->ts > step2->ts) - (step1->ts < step2->ts);
+}
+
+static void
+add_startup_step (GArray * steps, GstClockTime ts, gchar * label)
+{
+  GstStartupStep step = { ts, label };
+
+  g_array_append_val (steps, step);
+}
+
+/* the first entry with @name and @what, for each @name if @name is %NULL,
+ * and the one of these that happened last if @last is set */
+static GstStartupEntry *
+find_startup_entry (GPtrArray * entries, const gchar * name,
+    const gchar * what, gboolean last)
+{
+  GHashTable *seen = g_hash_table_new (g_str_hash, g_str_equal);
+  GstStartupEntry *entry, *found = NULL;
+  guint i;
+
+  for (i = 0; i < entries->len; i++) {
+    entry = g_ptr_array_index (entries, i);
+    if (strcmp (entry->what, what) || (name && strcmp (entry->name, name)))
+      continue;
+    if (g_hash_table_contains (seen, entry->name))
+      continue;
+    g_hash_table_add (seen, entry->name);
+
+    if (!found || (last && entry->ts > found->ts))
+      found = entry;
+    if (!last)
+      break;
   }
+  g_hash_table_destroy (seen);
+  return found;
+}
 
-  ansi_log = g_regex_new (
-      /* 1: ts */
-      "^([0-9:.]+) +"
-      /* 2: pid */
-      "\\\e\\\[[0-9;]+m *([0-9]+)\\\e\\\[00m +"
-      /* 3: thread */
-      "(0x[0-9a-fA-F]+) +"
-      /* 4: level */
-      "(?:\\\e\\\[[0-9;]+m)?([A-Z]+) +\\\e\\\[00m +"
-      /* 5: category */
-      "\\\e\\\[[0-9;]+m +([a-zA-Z_-]+) +"
-      /* 6: file:line:func: */
-      "([^:]*:[0-9]+:[^:]*:)(?:\\\e\\\[00m)? +"
-      /* 7: (obj)? log-text */
-      "(.*)$", 0, 0, NULL);
-  if (!raw_log) {
-    GST_WARNING ("failed to compile the 'ansi' parser");
-    return FALSE;
+static GstClockTime
+get_plugin_load_time (GstClockTime start, GstClockTime end)
+{
+  GstClockTime total = 0;
+  guint i;
+
+  for (i = 0; i < startup_plugins->len; i++) {
+    GstStartupEntry *entry = g_ptr_array_index (startup_plugins, i);
+
+    if (entry->ts >= start && entry->ts < end)
+      total += entry->duration;
+  }
+  return total;
+}
+
+static void
+print_startup_transition (GstStartupPipeline * pipeline, const gchar * what)
+{
+  GPtrArray *list = g_ptr_array_new ();
+  GstStartupEntry *entry;
+  guint i;
+
+  for (i = 0; i < pipeline->states->len; i++) {
+    entry = g_ptr_array_index (pipeline->states, i);
+    if (!strcmp (entry->what, what))
+      g_ptr_array_add (list, entry);
+  }
+  if (list->len) {
+    printf ("  %s, slowest elements:\n", what);
+    g_ptr_array_sort (list, sort_startup_entry_by_self);
+    for (i = 0; i < MIN (list->len, 5); i++) {
+      entry = g_ptr_array_index (list, i);
+      printf ("    %-30.30s %" GST_TIME_FORMAT "\n", entry->name,
+          GST_TIME_ARGS (entry->self));
+    }
+  }
+  g_ptr_array_free (list, TRUE);
+}
+
+/* The state changes of the pipeline happen one after the other and the first
+ * buffer of the last sink is the end of the startup. Show everything that
+ * happened in between in order, with the time since the previous step. */
+static void
+print_startup_pipeline (gpointer key, gpointer value, gpointer user_data)
+{
+  static const gchar *transitions[] = { "NULL_TO_READY", "READY_TO_PAUSED",
+    "PAUSED_TO_PLAYING"
+  };
+  static const gchar *states[] = { "ready", "paused", "playing" };
+  GstStartupPipeline *pipeline = value;
+  GArray *steps = g_array_new (FALSE, FALSE, sizeof (GstStartupStep));
+  GstStartupEntry *entry, *created, *last_sink = NULL;
+  GstClockTime prev = GST_CLOCK_TIME_NONE, plugins;
+  GstStartupStep *step;
+  guint i;
+
+  /* skip elements that were used on their own */
+  for (i = 0; i < pipeline->states->len; i++) {
+    entry = g_ptr_array_index (pipeline->states, i);
+    if (strcmp (entry->name, pipeline->name))
+      break;
+  }
+  if (i == pipeline->states->len && pipeline->marks->len == 0) {
+    g_array_free (steps, TRUE);
+    return;
+  }
+
+  printf ("Pipeline %s:\n", pipeline->name);
+
+  /* the elements of the pipeline were created first */
+  created = NULL;
+  for (i = 0; i < pipeline->states->len; i++) {
+    entry = g_ptr_array_index (pipeline->states, i);
+    entry = g_hash_table_lookup (startup_elements, entry->name);
+    if (entry && (!created || entry->ts < created->ts))
+      created = entry;
+  }
+  if (created)
+    add_startup_step (steps, created->ts,
+        g_strdup_printf ("first element created (%s)", created->name));
+
+  for (i = 0; i < G_N_ELEMENTS (transitions); i++) {
+    entry = find_startup_entry (pipeline->states, pipeline->name,
+        transitions[i], FALSE);
+    if (entry) {
+      add_startup_step (steps, entry->ts,
+          g_strdup_printf ("%s started", transitions[i]));
+      add_startup_step (steps, entry->ts + entry->duration,
+          g_strdup_printf ("%s done", transitions[i]));
+    }
+    entry = find_startup_entry (pipeline->marks, pipeline->name, states[i],
+        FALSE);
+    if (entry)
+      add_startup_step (steps, entry->ts,
+          g_strdup_printf ("pipeline %s", states[i]));
+  }
+  if ((entry = find_startup_entry (pipeline->marks, NULL, "preroll", TRUE)))
+    add_startup_step (steps, entry->ts,
+        g_strdup_printf ("last sink prerolled (%s)", entry->name));
+  if ((last_sink = find_startup_entry (pipeline->marks, NULL, "first-buffer",
+              TRUE)))
+    add_startup_step (steps, last_sink->ts,
+        g_strdup_printf ("last sink got its first buffer (%s)",
+            last_sink->name));
+
+  g_array_sort (steps, sort_startup_steps);
+  if (steps->len) {
+    step = &g_array_index (steps, GstStartupStep, 0);
+    if (last_sink)
+      printf ("  first buffer in all sinks after %" GST_TIME_FORMAT "\n",
+          GST_TIME_ARGS (last_sink->ts - step->ts));
+
+    puts ("  critical path:");
+    for (i = 0; i < steps->len; i++) {
+      step = &g_array_index (steps, GstStartupStep, i);
+      if (GST_CLOCK_TIME_IS_VALID (prev)) {
+        printf ("    %" GST_TIME_FORMAT " +%" GST_TIME_FORMAT " %s",
+            GST_TIME_ARGS (step->ts), GST_TIME_ARGS (step->ts - prev),
+            step->label);
+        if ((plugins = get_plugin_load_time (prev, step->ts)))
+          printf (", %" GST_TIME_FORMAT " loading plugins",
+              GST_TIME_ARGS (plugins));
+        puts ("");
+      } else {
+        printf ("    %" GST_TIME_FORMAT " %18s %s\n", GST_TIME_ARGS (step->ts),
+            "", step->label);
+      }
+      prev = step->ts;
+      g_free (step->label);
+    }
+  }
+  g_array_free (steps, TRUE);
+
+  for (i = 0; i < G_N_ELEMENTS (transitions); i++)
+    print_startup_transition (pipeline, transitions[i]);
+  puts ("");
+}
+
+static void
+print_startup_stats (void)
+{
+  GstClockTime total = 0;
+  GstStartupEntry *entry;
+  guint i;
+
+  puts ("Startup Statistics:");
+  if (startup_plugins->len) {
+    for (i = 0; i < startup_plugins->len; i++)
+      total += ((GstStartupEntry *) g_ptr_array_index (startup_plugins,
+              i))->duration;
+    printf ("Plugins loaded: %u in %" GST_TIME_FORMAT ", slowest:\n",
+        startup_plugins->len, GST_TIME_ARGS (total));
+
+    g_ptr_array_sort (startup_plugins, sort_startup_entry_by_duration);
+    for (i = 0; i < MIN (startup_plugins->len, 10); i++) {
+      entry = g_ptr_array_index (startup_plugins, i);
+      printf ("  %-30.30s %" GST_TIME_FORMAT " at %" GST_TIME_FORMAT "\n",
+          entry->name, GST_TIME_ARGS (entry->duration),
+          GST_TIME_ARGS (entry->ts));
+    }
+    puts ("");
   }
+  g_hash_table_foreach (startup_pipelines, print_startup_pipeline, NULL);
+}
+
+/* main */
 
+static gboolean
+init (void)
+{
   elements = g_ptr_array_new_with_free_func (free_element_stats);
   pads = g_ptr_array_new_with_free_func (free_pad_stats);
   threads = g_hash_table_new_full (NULL, NULL, NULL, free_thread_stats);
+  startup_pipelines = g_hash_table_new_full (g_str_hash, g_str_equal, NULL,
+      free_startup_pipeline);
+  startup_elements = g_hash_table_new_full (g_str_hash, g_str_equal, NULL,
+      free_startup_entry);
+  startup_plugins = g_ptr_array_new_with_free_func (free_startup_entry);
+
+  /* core enum and flags types are only registered on first use, make sure
+   * the ones the core tracers log can be looked up by name */
+  gst_buffer_flags_get_type ();
+  gst_pad_direction_get_type ();
 
   return TRUE;
 }
@@ -680,11 +993,12 @@ done (void)
     g_ptr_array_free (elements, TRUE);
   if (threads)
     g_hash_table_destroy (threads);
-
-  if (raw_log)
-    g_regex_unref (raw_log);
-  if (ansi_log)
-    g_regex_unref (ansi_log);
+  if (startup_pipelines)
+    g_hash_table_destroy (startup_pipelines);
+  if (startup_elements)
+    g_hash_table_destroy (startup_elements);
+  if (startup_plugins)
+    g_ptr_array_free (startup_plugins, TRUE);
 }
 
 static void
@@ -757,90 +1071,550 @@ print_stats (void)
     puts ("");
     g_slist_free (list);
   }
+
+  /* startup timeline */
+  if (g_hash_table_size (startup_pipelines) || startup_plugins->len)
+    print_startup_stats ();
+}
+
+/* returns FALSE for entries we don't know */
+static gboolean
+do_stats (GstStructure * s)
+{
+  const gchar *name = gst_structure_get_name (s);
+
+  if (!strcmp (name, "new-pad")) {
+    new_pad_stats (s);
+  } else if (!strcmp (name, "new-element")) {
+    new_element_stats (s);
+  } else if (!strcmp (name, "buffer")) {
+    do_buffer_stats (s);
+  } else if (!strcmp (name, "event")) {
+    do_event_stats (s);
+  } else if (!strcmp (name, "message")) {
+    do_message_stats (s);
+  } else if (!strcmp (name, "query")) {
+    do_query_stats (s);
+  } else if (!strcmp (name, "thread-rusage")) {
+    do_thread_rusage_stats (s);
+  } else if (!strcmp (name, "proc-rusage")) {
+    do_proc_rusage_stats (s);
+  } else if (!strcmp (name, "startup-plugin")) {
+    do_startup_plugin_stats (s);
+  } else if (!strcmp (name, "startup-element")) {
+    do_startup_element_stats (s);
+  } else if (!strcmp (name, "startup-state")) {
+    do_startup_state_stats (s);
+  } else if (!strcmp (name, "startup-mark")) {
+    do_startup_mark_stats (s);
+  } else {
+    return FALSE;
+  }
+  return TRUE;
 }
 
+/* binary tracer output, see GST_TRACER_BINARY_FILE in gsttracerrecord.c */
+
+#define TRACE_FILE_MAGIC "GSTTRACE"
+#define TRACE_FILE_VERSION 1
+
+typedef struct
+{
+  gchar *name;
+  gchar code;
+  GType type;
+} TraceField;
+
+typedef struct
+{
+  gchar *name;
+  guint n_fields;
+  TraceField *fields;
+} TraceClass;
+
 static void
-collect_stats (const gchar * filename)
+free_trace_class (TraceClass * klass)
 {
-  FILE *log;
+  guint i;
 
-  if ((log = fopen (filename, "rt"))) {
-    gchar line[5001];
-
-    /* probe format */
-    if (fgets (line, 5000, log)) {
-      GMatchInfo *match_info;
-      GRegex *parser;
-      GstStructure *s;
-      guint lnr = 0;
-      gchar *level, *data;
-
-      if (strchr (line, 27)) {
-        parser = ansi_log;
-        GST_INFO ("format is 'ansi'");
-      } else {
-        parser = raw_log;
-        GST_INFO ("format is 'raw'");
-      }
-      rewind (log);
-
-      /* parse the log */
-      while (!feof (log)) {
-        if (fgets (line, 5000, log)) {
-          if (g_regex_match (parser, line, 0, &match_info)) {
-            /* filter by level */
-            level = g_match_info_fetch (match_info, 4);
-            if (!strcmp (level, "TRACE")) {
-              data = g_match_info_fetch (match_info, 7);
-              if ((s = gst_structure_from_string (data, NULL))) {
-                const gchar *name = gst_structure_get_name (s);
-
-                if (!strcmp (name, "new-pad")) {
-                  new_pad_stats (s);
-                } else if (!strcmp (name, "new-element")) {
-                  new_element_stats (s);
-                } else if (!strcmp (name, "buffer")) {
-                  do_buffer_stats (s);
-                } else if (!strcmp (name, "event")) {
-                  do_event_stats (s);
-                } else if (!strcmp (name, "message")) {
-                  do_message_stats (s);
-                } else if (!strcmp (name, "query")) {
-                  do_query_stats (s);
-                } else if (!strcmp (name, "thread-rusage")) {
-                  do_thread_rusage_stats (s);
-                } else if (!strcmp (name, "proc-rusage")) {
-                  do_proc_rusage_stats (s);
-                } else {
-                  // TODO(ensonic): parse the xxx.class log lines
-                  if (!g_str_has_suffix (data, ".class")) {
-                    GST_WARNING ("unknown log entry: '%s'", data);
-                  }
-                }
-                gst_structure_free (s);
-              } else {
-                GST_WARNING ("unknown log entry: '%s'", data);
-              }
-            }
-          } else {
-            if (*line) {
-              GST_WARNING ("foreign log entry: %s:%d:'%s'", filename, lnr,
-                  g_strchomp (line));
-            }
-          }
-          g_match_info_free (match_info);
-          match_info = NULL;
-          lnr++;
-        } else {
-          if (!feof (log)) {
-            // TODO(ensonic): run wc -L on the log file
-            fprintf (stderr, "line too long");
-          }
+  for (i = 0; i < klass->n_fields; i++)
+    g_free (klass->fields[i].name);
+  g_free (klass->fields);
+  g_free (klass->name);
+  g_free (klass);
+}
+
+static gboolean
+read_bytes (const guint8 ** data, const guint8 * end, gpointer dest, guint len)
+{
+  if ((gsize) (end - *data) < len)
+    return FALSE;
+  memcpy (dest, *data, len);
+  *data += len;
+  return TRUE;
+}
+
+static gchar *
+read_string (const guint8 ** data, const guint8 * end)
+{
+  guint32 len;
+  gchar *str;
+
+  if (!read_bytes (data, end, &len, sizeof (len)) ||
+      (gsize) (end - *data) < len)
+    return NULL;
+  str = g_strndup ((const gchar *) *data, len);
+  *data += len;
+  return str;
+}
+
+static TraceClass *
+read_trace_class (const guint8 * data, const guint8 * end, guint32 * id)
+{
+  TraceClass *klass = g_new0 (TraceClass, 1);
+  guint32 n_fields;
+  guint i;
+
+  if (!read_bytes (&data, end, id, sizeof (*id)) ||
+      !(klass->name = read_string (&data, end)) ||
+      !read_bytes (&data, end, &n_fields, sizeof (n_fields)))
+    goto error;
+
+  klass->fields = g_new0 (TraceField, n_fields);
+  for (i = 0; i < n_fields; i++) {
+    TraceField *field = &klass->fields[i];
+    gchar *type_name;
+
+    klass->n_fields++;
+    if (!(field->name = read_string (&data, end)) ||
+        !read_bytes (&data, end, &field->code, 1) ||
+        !(type_name = read_string (&data, end)))
+      goto error;
+    field->type = g_type_from_name (type_name);
+    if (!field->type)
+      GST_WARNING ("unknown type '%s' for field '%s'", type_name, field->name);
+    g_free (type_name);
+  }
+  return klass;
+
+error:
+  free_trace_class (klass);
+  return NULL;
+}
+
+static GstStructure *
+read_trace_entry (TraceClass * klass, const guint8 * data, const guint8 * end,
+    guint64 ts)
+{
+  GstStructure *s = gst_structure_new_empty (klass->name);
+  guint i;
+
+  for (i = 0; i < klass->n_fields; i++) {
+    TraceField *field = &klass->fields[i];
+    GValue v = G_VALUE_INIT;
+    union
+    {
+      gint32 i;
+      guint32 u;
+      gint64 I;
+      guint64 U;
+      gdouble d;
+    } val;
+    gchar *str = NULL;
+
+    switch (field->code) {
+      case 'i':
+      case 'u':
+        if (!read_bytes (&data, end, &val, 4))
+          goto error;
+        break;
+      case 'l':
+      case 'L':
+      case 'I':
+      case 'U':
+      case 'd':
+        if (!read_bytes (&data, end, &val, 8))
+          goto error;
+        break;
+      case 's':
+      case 'v':
+        if (!(str = read_string (&data, end)))
+          goto error;
+        break;
+      default:
+        goto error;
+    }
+    if (!field->type) {
+      if (field->code == 's' || field->code == 'v')
+        g_free (str);
+      continue;
+    }
+
+    g_value_init (&v, field->type);
+    switch (field->code) {
+      case 'i':
+        switch (G_TYPE_FUNDAMENTAL (field->type)) {
+          case G_TYPE_BOOLEAN:
+            g_value_set_boolean (&v, val.i);
+            break;
+          case G_TYPE_ENUM:
+            g_value_set_enum (&v, val.i);
+            break;
+          case G_TYPE_CHAR:
+            g_value_set_schar (&v, val.i);
+            break;
+          default:
+            g_value_set_int (&v, val.i);
+            break;
         }
+        break;
+      case 'u':
+        switch (G_TYPE_FUNDAMENTAL (field->type)) {
+          case G_TYPE_FLAGS:
+            g_value_set_flags (&v, val.u);
+            break;
+          case G_TYPE_UCHAR:
+            g_value_set_uchar (&v, val.u);
+            break;
+          default:
+            g_value_set_uint (&v, val.u);
+            break;
+        }
+        break;
+      case 'l':
+        g_value_set_long (&v, val.I);
+        break;
+      case 'L':
+        g_value_set_ulong (&v, val.U);
+        break;
+      case 'I':
+        g_value_set_int64 (&v, val.I);
+        break;
+      case 'U':
+        g_value_set_uint64 (&v, val.U);
+        break;
+      case 'd':
+        if (G_TYPE_FUNDAMENTAL (field->type) == G_TYPE_FLOAT)
+          g_value_set_float (&v, val.d);
+        else
+          g_value_set_double (&v, val.d);
+        break;
+      case 's':
+        g_value_take_string (&v, str);
+        break;
+      case 'v':
+        if (!gst_value_deserialize (&v, str))
+          GST_WARNING ("can't deserialize field '%s': %s", field->name, str);
+        g_free (str);
+        break;
+    }
+    gst_structure_take_value (s, field->name, &v);
+  }
+  return s;
+
+error:
+  GST_WARNING ("truncated '%s' entry at %" GST_TIME_FORMAT, klass->name,
+      GST_TIME_ARGS (ts));
+  gst_structure_free (s);
+  return NULL;
+}
+
+static void
+collect_binary_stats (FILE * log)
+{
+  GHashTable *classes;
+  guint32 header[2];
+  guint8 *buf = NULL;
+  guint buf_size = 0;
+
+  if (fread (header, sizeof (guint32), 2, log) != 2 ||
+      header[0] != TRACE_FILE_VERSION || header[1] != 0x01020304) {
+    GST_WARNING ("unsupported binary trace version or byte order");
+    return;
+  }
+
+  classes = g_hash_table_new_full (NULL, NULL, NULL,
+      (GDestroyNotify) free_trace_class);
+
+  while (TRUE) {
+    guint32 size, id;
+    guint64 ts;
+    TraceClass *klass;
+    GstStructure *s;
+
+    if (fread (&size, sizeof (size), 1, log) != 1)
+      break;
+    if (size < 16) {
+      GST_WARNING ("corrupt binary trace entry");
+      break;
+    }
+    size -= sizeof (size);
+    if (size > buf_size) {
+      buf_size = size;
+      buf = g_realloc (buf, buf_size);
+    }
+    if (fread (buf, 1, size, log) != size) {
+      GST_WARNING ("truncated binary trace");
+      break;
+    }
+    memcpy (&id, buf, sizeof (id));
+    memcpy (&ts, buf + 4, sizeof (ts));
+
+    if (id == 0) {
+      if ((klass = read_trace_class (buf + 12, buf + size, &id)))
+        g_hash_table_insert (classes, GUINT_TO_POINTER (id), klass);
+      else
+        GST_WARNING ("corrupt record declaration");
+    } else if ((klass = g_hash_table_lookup (classes, GUINT_TO_POINTER (id)))) {
+      if ((s = read_trace_entry (klass, buf + 12, buf + size, ts))) {
+        if (!do_stats (s))
+          GST_DEBUG ("unhandled entry: '%s'", klass->name);
+        gst_structure_free (s);
       }
     } else {
-      GST_WARNING ("empty log");
+      GST_WARNING ("entry for undeclared record %u", id);
     }
+  }
+  g_free (buf);
+  g_hash_table_destroy (classes);
+}
+
+/* text log, split into chunks of whole lines that are parsed in parallel and
+ * then handed to do_stats() in order from the main thread. Only a bounded
+ * number of chunks is in flight so memory use does not grow with the log. */
+
+#define LOG_CHUNK_SIZE (1024 * 1024)
+
+typedef struct
+{
+  gchar *data;
+  gsize size;
+  /* parsed GstStructures of the TRACE lines, in log order */
+  GPtrArray *structures;
+
+  GMutex lock;
+  GCond cond;
+  gboolean done;
+} LogChunk;
+
+/* skip blanks and ansi color sequences */
+static inline gchar *
+skip_blanks (gchar * p)
+{
+  while (TRUE) {
+    if (*p == ' ') {
+      p++;
+    } else if (p[0] == '\033' && p[1] == '[') {
+      p += 2;
+      while (*p && *p != 'm')
+        p++;
+      if (*p)
+        p++;
+    } else {
+      break;
+    }
+  }
+  return p;
+}
+
+static inline gchar *
+skip_token (gchar * p)
+{
+  while (*p && *p != ' ' && *p != '\033')
+    p++;
+  return p;
+}
+
+/* Split a line of the default debug log, colored or not:
+ * 0:00:00.004925027 31586      0x1c5c600 DEBUG           GST_REGISTRY gstregistry.c:463:gst_registry_add_plugin:<registry0> adding plugin ...
+ * and return the message of TRACE lines in @data. Returns FALSE for lines
+ * that are not from the debug log. */
+static gboolean
+parse_log_line (gchar * line, gchar ** data)
+{
+  gchar *p = line, *end = NULL, *level = NULL;
+  guint i;
+
+  *data = NULL;
+
+  /* ts, pid, thread, level, category, file:line:func: */
+  for (i = 0; i < 6; i++) {
+    p = skip_blanks (p);
+    end = skip_token (p);
+    if (end == p)
+      return FALSE;
+    if ((i == 0 && !g_ascii_isdigit (*p)) ||
+        (i == 2 && strncmp (p, "0x", 2)))
+      return FALSE;
+    if (i == 3)
+      level = p;
+    p = end;
+  }
+  if (end[-1] != ':')
+    return FALSE;
+
+  if (!strncmp (level, "TRACE", 5) && (level[5] == ' ' || level[5] == '\033'))
+    *data = skip_blanks (p);
+  return TRUE;
+}
+
+static void
+parse_log_chunk (LogChunk * chunk, gpointer user_data)
+{
+  gchar *line = chunk->data, *end = chunk->data + chunk->size, *nl, *data;
+  GstStructure *s;
+
+  chunk->structures = g_ptr_array_new ();
+
+  while (line < end) {
+    if (!(nl = memchr (line, '\n', end - line)))
+      nl = end;
+    *nl = '\0';
+    if (nl > line && nl[-1] == '\r')
+      nl[-1] = '\0';
+
+    if (parse_log_line (line, &data)) {
+      if (data) {
+        if ((s = gst_structure_from_string (data, NULL)))
+          g_ptr_array_add (chunk->structures, s);
+        else
+          GST_WARNING ("unknown log entry: '%s'", data);
+      }
+    } else if (*line) {
+      GST_WARNING ("foreign log entry: '%s'", line);
+    }
+    line = nl + 1;
+  }
+  g_free (chunk->data);
+  chunk->data = NULL;
+
+  g_mutex_lock (&chunk->lock);
+  chunk->done = TRUE;
+  g_cond_signal (&chunk->cond);
+  g_mutex_unlock (&chunk->lock);
+}
+
+/* read the next LOG_CHUNK_SIZE bytes or more up to the end of a line, the
+ * rest of the last line is kept in @carry */
+static LogChunk *
+read_log_chunk (FILE * log, GString * carry)
+{
+  GString *buf = g_string_sized_new (carry->len + LOG_CHUNK_SIZE);
+  LogChunk *chunk;
+  gsize pos, len;
+  gchar *p;
+
+  g_string_append_len (buf, carry->str, carry->len);
+  g_string_truncate (carry, 0);
+
+  while (TRUE) {
+    pos = buf->len;
+    g_string_set_size (buf, pos + LOG_CHUNK_SIZE);
+    len = fread (buf->str + pos, 1, LOG_CHUNK_SIZE, log);
+    g_string_set_size (buf, pos + len);
+    if (len == 0)
+      break;
+
+    for (p = buf->str + buf->len; p > buf->str + pos; p--) {
+      if (p[-1] == '\n')
+        break;
+    }
+    if (p > buf->str + pos) {
+      g_string_append_len (carry, p, buf->str + buf->len - p);
+      g_string_truncate (buf, p - buf->str);
+      break;
+    }
+  }
+
+  if (buf->len == 0) {
+    g_string_free (buf, TRUE);
+    return NULL;
+  }
+
+  chunk = g_new0 (LogChunk, 1);
+  g_mutex_init (&chunk->lock);
+  g_cond_init (&chunk->cond);
+  chunk->size = buf->len;
+  chunk->data = g_string_free (buf, FALSE);
+  return chunk;
+}
+
+static void
+process_log_chunk (LogChunk * chunk)
+{
+  GstStructure *s;
+  guint i;
+
+  g_mutex_lock (&chunk->lock);
+  while (!chunk->done)
+    g_cond_wait (&chunk->cond, &chunk->lock);
+  g_mutex_unlock (&chunk->lock);
+
+  for (i = 0; i < chunk->structures->len; i++) {
+    s = g_ptr_array_index (chunk->structures, i);
+    if (!do_stats (s)) {
+      // TODO(ensonic): parse the xxx.class log lines
+      if (!g_str_has_suffix (gst_structure_get_name (s), ".class")) {
+        GST_WARNING ("unknown log entry: '%s'", gst_structure_get_name (s));
+      }
+    }
+    gst_structure_free (s);
+  }
+  g_ptr_array_free (chunk->structures, TRUE);
+  g_mutex_clear (&chunk->lock);
+  g_cond_clear (&chunk->cond);
+  g_free (chunk);
+}
+
+static void
+collect_text_stats (FILE * log)
+{
+  guint n_threads = g_get_num_processors ();
+  GQueue pending = G_QUEUE_INIT;
+  GString *carry = g_string_new (NULL);
+  GThreadPool *pool;
+  LogChunk *chunk;
+  gboolean empty = TRUE;
+
+  pool = g_thread_pool_new ((GFunc) parse_log_chunk, NULL, n_threads, FALSE,
+      NULL);
+
+  while ((chunk = read_log_chunk (log, carry))) {
+    empty = FALSE;
+    g_queue_push_tail (&pending, chunk);
+    g_thread_pool_push (pool, chunk, NULL);
+    if (g_queue_get_length (&pending) >= 2 * n_threads)
+      process_log_chunk (g_queue_pop_head (&pending));
+  }
+  while ((chunk = g_queue_pop_head (&pending)))
+    process_log_chunk (chunk);
+
+  if (empty)
+    GST_WARNING ("empty log");
+
+  g_thread_pool_free (pool, FALSE, TRUE);
+  g_string_free (carry, TRUE);
+}
+
+static void
+collect_stats (const gchar * filename)
+{
+  FILE *log;
+
+  if ((log = fopen (filename, "rb"))) {
+    gchar magic[8];
+
+    if (fread (magic, 1, 8, log) == 8 && !memcmp (magic, TRACE_FILE_MAGIC, 8)) {
+      GST_INFO ("format is 'binary'");
+      collect_binary_stats (log);
+      fclose (log);
+      return;
+    }
+    fclose (log);
+  }
+
+  if ((log = fopen (filename, "rt"))) {
+    collect_text_stats (log);
     fclose (log);
   }
 }
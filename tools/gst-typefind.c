@@ -29,69 +29,165 @@
 #include <string.h>
 #include <locale.h>
 
+#include <gst/base/gsttypefindhelper.h>
+
 #include "tools.h"
 
+/* how much of a local file is handed to the typefind helper, this is what the
+ * typefind element considers as well before giving up */
+#define TYPEFIND_HEADER_SIZE (4 * 1024 * 1024)
+
+static gboolean machine_readable = FALSE;
+
+/* the state of one worker, the pipeline is reused for all the files that are
+ * not handled by the fast path */
+typedef struct
+{
+  GstElement *pipeline;
+  GstElement *source;
+  GstCaps *caps;
+} TypeFinder;
+
+/* sentinel pushed on the queue to stop the workers */
+static gchar stop_worker;
+
 static void
 have_type_handler (GstElement * typefind, guint probability,
-    const GstCaps * caps, GstCaps ** p_caps)
+    const GstCaps * caps, TypeFinder * finder)
 {
-  if (p_caps) {
-    *p_caps = gst_caps_copy (caps);
-  }
+  gst_caps_replace (&finder->caps, (GstCaps *) caps);
 }
 
 static void
-typefind_file (const gchar * filename)
+type_finder_init (TypeFinder * finder)
 {
-  GstStateChangeReturn sret;
-  GstElement *pipeline;
-  GstElement *source;
   GstElement *typefind;
   GstElement *fakesink;
-  GstState state;
-  GstCaps *caps = NULL;
-  GDir *dir;
 
-  if ((dir = g_dir_open (filename, 0, NULL))) {
-    const gchar *entry;
+  finder->caps = NULL;
+  finder->pipeline = gst_pipeline_new ("pipeline");
 
-    while ((entry = g_dir_read_name (dir))) {
-      gchar *path;
+  finder->source = gst_element_factory_make ("filesrc", "source");
+  g_assert (GST_IS_ELEMENT (finder->source));
+  typefind = gst_element_factory_make ("typefind", "typefind");
+  g_assert (GST_IS_ELEMENT (typefind));
+  fakesink = gst_element_factory_make ("fakesink", "fakesink");
+  g_assert (GST_IS_ELEMENT (fakesink));
 
-      path = g_strconcat (filename, G_DIR_SEPARATOR_S, entry, NULL);
-      typefind_file (path);
-      g_free (path);
+  gst_bin_add_many (GST_BIN (finder->pipeline), finder->source, typefind,
+      fakesink, NULL);
+  gst_element_link_many (finder->source, typefind, fakesink, NULL);
+
+  g_signal_connect (G_OBJECT (typefind), "have-type",
+      G_CALLBACK (have_type_handler), finder);
+}
+
+static void
+type_finder_clear (TypeFinder * finder)
+{
+  gst_element_set_state (finder->pipeline, GST_STATE_NULL);
+  gst_object_unref (finder->pipeline);
+  gst_caps_replace (&finder->caps, NULL);
+}
+
+/* prints one line per file with a single call so that the output of the
+ * workers does not get interleaved */
+static void
+print_result (const gchar * filename, GstCaps * caps, const gchar * error)
+{
+  gchar *caps_str = caps ? gst_caps_to_string (caps) : NULL;
+
+  if (machine_readable) {
+    gchar *msg;
+
+    /* status, caps or error message, file name. The file name comes last so
+     * that it can contain anything but a newline */
+    if (error) {
+      msg = g_strdup (error);
+      g_strdelimit (msg, "\t\n", ' ');
+      g_print ("FAILED\t%s\t%s\n", msg, filename);
+      g_free (msg);
+    } else if (caps_str) {
+      g_print ("OK\t%s\t%s\n", caps_str, filename);
+    } else {
+      g_print ("NONE\t\t%s\n", filename);
     }
+  } else {
+    if (error)
+      g_printerr ("%s - FAILED: %s\n", filename, error);
+    else
+      g_print ("%s - %s\n", filename, caps_str ? caps_str : "No type found");
+  }
 
-    g_dir_close (dir);
-    return;
+  g_free (caps_str);
+}
+
+/* types a local file from its mapped header without building a pipeline,
+ * returns FALSE when the pipeline has to be used */
+static gboolean
+typefind_file_mapped (const gchar * filename)
+{
+  GMappedFile *mapped;
+  GstBuffer *buffer;
+  GstCaps *caps;
+  gsize size;
+
+  if (!g_file_test (filename, G_FILE_TEST_IS_REGULAR))
+    return FALSE;
+
+  mapped = g_mapped_file_new (filename, FALSE, NULL);
+  if (mapped == NULL)
+    return FALSE;
+
+  size = g_mapped_file_get_length (mapped);
+  if (size == 0) {
+    g_mapped_file_unref (mapped);
+    return FALSE;
   }
 
-  pipeline = gst_pipeline_new ("pipeline");
+  buffer = gst_buffer_new ();
+  gst_buffer_append_memory (buffer,
+      gst_memory_new_wrapped (GST_MEMORY_FLAG_READONLY,
+          g_mapped_file_get_contents (mapped), size, 0,
+          MIN (size, TYPEFIND_HEADER_SIZE), mapped,
+          (GDestroyNotify) g_mapped_file_unref));
+
+  caps = gst_type_find_helper_for_buffer (NULL, buffer, NULL);
+  gst_buffer_unref (buffer);
+
+  /* the typefind element can look further into big files, let it try */
+  if (caps == NULL && size > TYPEFIND_HEADER_SIZE)
+    return FALSE;
+
+  if (caps) {
+    print_result (filename, caps, NULL);
+    gst_caps_unref (caps);
+  } else {
+    print_result (filename, NULL, "Could not determine type of stream.");
+  }
 
-  source = gst_element_factory_make ("filesrc", "source");
-  g_assert (GST_IS_ELEMENT (source));
-  typefind = gst_element_factory_make ("typefind", "typefind");
-  g_assert (GST_IS_ELEMENT (typefind));
-  fakesink = gst_element_factory_make ("fakesink", "fakesink");
-  g_assert (GST_IS_ELEMENT (typefind));
+  return TRUE;
+}
 
-  gst_bin_add_many (GST_BIN (pipeline), source, typefind, fakesink, NULL);
-  gst_element_link_many (source, typefind, fakesink, NULL);
+static void
+typefind_file (const gchar * filename, TypeFinder * finder)
+{
+  GstStateChangeReturn sret;
+  GstState state;
 
-  g_signal_connect (G_OBJECT (typefind), "have-type",
-      G_CALLBACK (have_type_handler), &caps);
+  if (typefind_file_mapped (filename))
+    return;
 
-  g_object_set (source, "location", filename, NULL);
+  g_object_set (finder->source, "location", filename, NULL);
 
   GST_DEBUG ("Starting typefinding for %s", filename);
 
   /* typefind will only commit to PAUSED if it actually finds a type;
    * otherwise the state change fails */
-  gst_element_set_state (GST_ELEMENT (pipeline), GST_STATE_PAUSED);
+  gst_element_set_state (finder->pipeline, GST_STATE_PAUSED);
 
   /* wait until state change either completes or fails */
-  sret = gst_element_get_state (GST_ELEMENT (pipeline), &state, NULL, -1);
+  sret = gst_element_get_state (finder->pipeline, &state, NULL, -1);
 
   switch (sret) {
     case GST_STATE_CHANGE_FAILURE:{
@@ -99,49 +195,97 @@ typefind_file (const gchar * filename)
       GstBus *bus;
       GError *err = NULL;
 
-      bus = gst_pipeline_get_bus (GST_PIPELINE (pipeline));
+      bus = gst_pipeline_get_bus (GST_PIPELINE (finder->pipeline));
       msg = gst_bus_poll (bus, GST_MESSAGE_ERROR, 0);
       gst_object_unref (bus);
 
       if (msg) {
         gst_message_parse_error (msg, &err, NULL);
-        g_printerr ("%s - FAILED: %s\n", filename, err->message);
+        print_result (filename, NULL, err->message);
         g_clear_error (&err);
         gst_message_unref (msg);
       } else {
-        g_printerr ("%s - FAILED: unknown error\n", filename);
+        print_result (filename, NULL, "unknown error");
       }
       break;
     }
-    case GST_STATE_CHANGE_SUCCESS:{
-      if (caps) {
-        gchar *caps_str;
-
-        caps_str = gst_caps_to_string (caps);
-        g_print ("%s - %s\n", filename, caps_str);
-        g_free (caps_str);
-        gst_caps_unref (caps);
-      } else {
-        g_print ("%s - %s\n", filename, "No type found");
-      }
+    case GST_STATE_CHANGE_SUCCESS:
+      print_result (filename, finder->caps, NULL);
       break;
-    }
     default:
       g_assert_not_reached ();
   }
 
-  gst_element_set_state (pipeline, GST_STATE_NULL);
-  gst_object_unref (pipeline);
+  /* going back to NULL flushes the bus and resets the elements for the next
+   * file */
+  gst_element_set_state (finder->pipeline, GST_STATE_NULL);
+  gst_caps_replace (&finder->caps, NULL);
+}
+
+/* calls @func for @filename or, if it is a directory, for all the files in
+ * it */
+static void
+foreach_file (const gchar * filename, GFunc func, gpointer user_data)
+{
+  GDir *dir;
+
+  if ((dir = g_dir_open (filename, 0, NULL))) {
+    const gchar *entry;
+
+    while ((entry = g_dir_read_name (dir))) {
+      gchar *path;
+
+      path = g_strconcat (filename, G_DIR_SEPARATOR_S, entry, NULL);
+      foreach_file (path, func, user_data);
+      g_free (path);
+    }
+
+    g_dir_close (dir);
+    return;
+  }
+
+  func ((gpointer) filename, user_data);
+}
+
+static void
+queue_file (const gchar * filename, GAsyncQueue * queue)
+{
+  g_async_queue_push (queue, g_strdup (filename));
+}
+
+static gpointer
+typefind_worker (GAsyncQueue * queue)
+{
+  TypeFinder finder;
+  gchar *filename;
+
+  type_finder_init (&finder);
+
+  while ((filename = g_async_queue_pop (queue)) != &stop_worker) {
+    typefind_file (filename, &finder);
+    g_free (filename);
+  }
+
+  type_finder_clear (&finder);
+
+  return NULL;
 }
 
 int
 main (int argc, char *argv[])
 {
   gchar **filenames = NULL;
-  guint num, i;
+  guint num, i, n_workers;
+  gint jobs = 1;
   GError *err = NULL;
   GOptionContext *ctx;
   GOptionEntry options[] = {
+    {"jobs", 'j', 0, G_OPTION_ARG_INT, &jobs,
+        N_("Number of files to type in parallel, 0 for one per processor"),
+        N_("N")},
+    {"machine-readable", 0, 0, G_OPTION_ARG_NONE, &machine_readable,
+        N_("Print one tab separated line per file: status, type and name"),
+        NULL},
     GST_TOOLS_GOPTION_VERSION,
     {G_OPTION_REMAINING, 0, 0, G_OPTION_ARG_FILENAME_ARRAY, &filenames, NULL},
     {NULL}
@@ -170,6 +314,8 @@ main (int argc, char *argv[])
 
   gst_tools_print_version ();
 
+  n_workers = jobs > 0 ? jobs : g_get_num_processors ();
+
   if (filenames == NULL || *filenames == NULL) {
     g_print ("Please give one or more filenames to %s\n\n", g_get_prgname ());
     return 1;
@@ -177,8 +323,33 @@ main (int argc, char *argv[])
 
   num = g_strv_length (filenames);
 
-  for (i = 0; i < num; ++i) {
-    typefind_file (filenames[i]);
+  if (n_workers == 1) {
+    TypeFinder finder;
+
+    type_finder_init (&finder);
+    for (i = 0; i < num; ++i)
+      foreach_file (filenames[i], (GFunc) typefind_file, &finder);
+    type_finder_clear (&finder);
+  } else {
+    GAsyncQueue *queue;
+    GThread **workers;
+
+    queue = g_async_queue_new ();
+    workers = g_new (GThread *, n_workers);
+    for (i = 0; i < n_workers; ++i)
+      workers[i] = g_thread_new ("typefind", (GThreadFunc) typefind_worker,
+          queue);
+
+    for (i = 0; i < num; ++i)
+      foreach_file (filenames[i], (GFunc) queue_file, queue);
+
+    for (i = 0; i < n_workers; ++i)
+      g_async_queue_push (queue, &stop_worker);
+    for (i = 0; i < n_workers; ++i)
+      g_thread_join (workers[i]);
+
+    g_free (workers);
+    g_async_queue_unref (queue);
   }
 
   g_strfreev (filenames);